@@ -0,0 +1,56 @@
+# flow5 Python run
+#
+# Runs a sweep of foil analyses from Python threads and a plane analysis
+# using the fl5 module built from fl5-py.
+# The analyses release the GIL, so the foil tasks run in parallel.
+
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+
+import fl5
+
+
+def run_foil(foil, re):
+    polar = fl5.create_polar(foil, "T1_Re{:.0f}".format(re), fl5.PolarType.T1, re=re)
+    task = fl5.XFoilTask()
+    task.initialize(foil, polar)
+    task.append_range(0.0, 11.0, 1.0)
+    task.append_range(0.0, -7.0, -1.0)
+    task.run()
+    return polar
+
+
+def main():
+    foil = fl5.make_naca_foil(2413, "NACA 2413")
+    foil.repanel(149, 0.7)
+
+    # the database is only modified while the GIL is held, so the tasks may be created from any thread
+    reynolds = [1.0e5, 2.0e5, 5.0e5, 1.0e6]
+    with ThreadPoolExecutor(max_workers=len(reynolds)) as pool:
+        polars = list(pool.map(lambda re: run_foil(foil, re), reynolds))
+
+    for polar in polars:
+        # alpha and cl are views of the polar's C++ arrays
+        imax = int(np.argmax(polar.cl))
+        print("{}: Cl_max={:.3f} at alpha={:.1f}".format(polar.name, polar.cl[imax], polar.alpha[imax]))
+
+    plane = fl5.make_default_plane("The Plane!")
+    wpolar = fl5.create_plane_polar(plane, "a T2 polar", fl5.PolarType.T2, fl5.AnalysisMethod.TRIUNIFORM)
+    wpolar.set_mass(1.0)
+
+    task = fl5.PlaneTask()
+    task.set_objects(plane, wpolar)
+    task.set_opp_list([-5.0, -1.0, 3.0, 7.0])
+    for popp in task.run():
+        span = popp.span_distribs(0)
+        print("alpha={:5.2f}  CL={:8.5f}  max strip Cl={:8.5f}  panels={}".format(
+              popp.alpha, popp.cl, span.cl.max(), popp.cp.size))
+
+    print(wpolar.export(", "))
+
+    fl5.delete_objects()
+
+
+if __name__ == "__main__":
+    main()
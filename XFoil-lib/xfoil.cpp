@@ -21,6 +21,7 @@
 *****************************************************************************/
 
 #
+#include <cmath>
 #include <cstring>
 
 #include "xfoil.h"
@@ -28,8 +29,10 @@
 #define PI 3.141592654
 #define EPSILON 1.e-6
 
-bool XFoil::s_bCancel = false;
+std::atomic<bool> XFoil::s_bCancel(false);
 bool XFoil::s_bFullReport = false;
+bool XFoil::s_bLowRankUpdate = true;
+double XFoil::s_MaxUpdateFraction = 0.3;
 double XFoil::vaccel = 0.01;
 
 XFoil::XFoil()
@@ -82,8 +85,6 @@ XFoil::XFoil()
     matyp = 1;
     minf1 = 0.0;
 
-    //---- drop tolerance for bl system solver
-    vaccel = 0.01;
     //---- default viscous parameters
     retyp = 1;
     reinf1 = 0.0;
@@ -110,18 +111,23 @@ bool XFoil::initialize()
     memset(Hk,     0, sizeof(Hk));
     memset(RTheta, 0, sizeof(RTheta));
 
-    memset(aij,    0, sizeof(aij));
+    aij.clear();
     memset(aijpiv, 0, sizeof(aijpiv));
+    m_nRef = 0;
+    m_bDijRef = false;
+    m_bAijUpdate = false;
+    m_UpdateRank = 0;
+    m_bMaskPanels = false;
     memset(apanel, 0, sizeof(apanel));
-    memset(bij,    0, sizeof(bij));
+    bij.clear();
     memset(blsav,  0, sizeof(blsav));
-    memset(cij,    0, sizeof(cij));
+    cij.clear();
     memset(cpi,    0, sizeof(cpi));
     memset(cpv,    0, sizeof(cpv));
     memset(ctau,   0, sizeof(ctau));
     memset(ctq,    0, sizeof(ctq));
     memset(delt,   0, sizeof(delt));
-    memset(dij,    0, sizeof(dij));
+    dij.clear();
     memset(dis,    0, sizeof(dis));
     memset(dq,     0, sizeof(dq));
     memset(dqdg,   0, sizeof(dqdg));
@@ -144,7 +150,7 @@ bool XFoil::initialize()
     memset(nbl,    0, sizeof(nbl));
     memset(nx,     0, sizeof(nx));
     memset(ny,     0, sizeof(ny));
-    memset(q,      0, sizeof(q));
+    q.clear();
     memset(qf0,    0, sizeof(qf0));
     memset(qf1,    0, sizeof(qf1));
     memset(qf2,    0, sizeof(qf2));
@@ -165,7 +171,7 @@ bool XFoil::initialize()
     memset(va,     0, sizeof(va));
     memset(vb,     0, sizeof(vb));
     memset(vdel,   0, sizeof(vdel));
-    memset(vm,     0, sizeof(vm));
+    for(int k=0; k<4; k++) vm[k].clear();
     memset(vs1,    0, sizeof(vs1));
     memset(vs2,    0, sizeof(vs2));
     memset(vsm,    0, sizeof(vsm));
@@ -282,6 +288,9 @@ bool XFoil::initialize()
     //    lppsho = false;
     leiw   = false;
     lscini = false;
+    m_bFFT = false;
+    m_ZcFactorNc = 0;
+    m_ZcFactorAgte = 0.0;
 
     //    lclip  = false;
     //    lvlab  = true;
@@ -641,7 +650,8 @@ bool XFoil::initialize()
     xpref2 = 1.0;
 
     //---- drop tolerance for bl system solver
-    vaccel = 0.01;
+    m_VAccel = vaccel;
+    m_bFullReport = s_bFullReport;
 
 
 
@@ -1610,6 +1620,33 @@ bool XFoil::blprv(double xsi, double ami, double cti, double thi,
 
 
 
+/** y[l] -= a*x[l] for l in [l0, l1]; x and y are distinct rows of the mass influence matrices */
+static inline void subtractRow(int l0, int l1, double a, double const * __restrict x, double * __restrict y)
+{
+    for(int l=l0; l<=l1; l++) y[l] -= a*x[l];
+}
+
+
+static inline void scaleRow(int l0, int l1, double a, double * __restrict y)
+{
+    for(int l=l0; l<=l1; l++) y[l] *= a;
+}
+
+
+/** yk[l] -= ak*x[l] for the three rows of an equation block in a single pass over x */
+static inline void subtractRow3(int l0, int l1, double a1, double a2, double a3, double const * __restrict x,
+                                double * __restrict y1, double * __restrict y2, double * __restrict y3)
+{
+    for(int l=l0; l<=l1; l++)
+    {
+        double const xl = x[l];
+        y1[l] -= a1*xl;
+        y2[l] -= a2*xl;
+        y3[l] -= a3*xl;
+    }
+}
+
+
 /** -----------------------------------------------------------------
  *      custom solver for coupled viscous-inviscid newton system:
  *
@@ -1635,18 +1672,24 @@ bool XFoil::blsolve()
     double pivot(0), vtmp(0), vtmp1(0), vtmp2(0), vtmp3(0);
 
     ivte1 = isys[iblte[1]][1];
+
+    // vm is stored by equation, i.e. vm[k][iv][l], so that the row operations below
+    // run over contiguous memory; the row pointers are fetched once per row
+    double *vmk[4] = {nullptr, nullptr, nullptr, nullptr};
+    double *vmi[4] = {nullptr, nullptr, nullptr, nullptr};
     //
     for (iv=1; iv<=nsys; iv++)
     {
         //
         ivp = iv + 1;
+        for (k=1; k<=3; k++) vmi[k] = vm[k][iv];
         //
         //====== invert va[iv] block
         //
         //------ normalize first row
         pivot = 1.0 / va[1][1][iv];
         va[1][2][iv] *= pivot;
-        for (l=iv;l<= nsys;l++) vm[1][l][iv] *= pivot;
+        scaleRow(iv, nsys, pivot, vmi[1]);
         vdel[1][1][iv] *= pivot;
         vdel[1][2][iv] *= pivot;
         //
@@ -1655,39 +1698,36 @@ bool XFoil::blsolve()
         {
             vtmp = va[k][1][iv];
             va[k][2][iv] -= vtmp*va[1][2][iv];
-            for (int l=iv; l<=nsys; l++) vm[k][l][iv] -= vtmp*vm[1][l][iv];
+            subtractRow(iv, nsys, vtmp, vmi[1], vmi[k]);
             vdel[k][1][iv] -= vtmp*vdel[1][1][iv];
             vdel[k][2][iv] -= vtmp*vdel[1][2][iv];
         }
         //
         //------ normalize second row
         pivot = 1.0 / va[2][2][iv];
-        for (l=iv; l<= nsys; l++) vm[2][l][iv] *=pivot;
+        scaleRow(iv, nsys, pivot, vmi[2]);
         vdel[2][1][iv] *= pivot;
         vdel[2][2][iv] *= pivot;
         //
         //------ eliminate lower second column in va block
         k = 3;
         vtmp = va[k][2][iv];
-        for (l=iv; l<=nsys; l++) vm[k][l][iv] -= vtmp*vm[2][l][iv];
+        subtractRow(iv, nsys, vtmp, vmi[2], vmi[k]);
         vdel[k][1][iv] -= vtmp*vdel[2][1][iv];
         vdel[k][2][iv] -= vtmp*vdel[2][2][iv];
 
         //------ normalize third row
-        pivot = 1.0/vm[3][iv][iv];
-        for (l=ivp; l<=nsys; l++) vm[3][l][iv] *= pivot;
+        pivot = 1.0/vmi[3][iv];
+        scaleRow(ivp, nsys, pivot, vmi[3]);
         vdel[3][1][iv] *= pivot;
         vdel[3][2][iv] *= pivot;
         //
         //
         //------ eliminate upper third column in va block
-        vtmp1 = vm[1][iv][iv];
-        vtmp2 = vm[2][iv][iv];
-        for(l=ivp;l<= nsys;l++)
-        {
-            vm[1][l][iv] -= vtmp1*vm[3][l][iv];
-            vm[2][l][iv] -= vtmp2*vm[3][l][iv];
-        }
+        vtmp1 = vmi[1][iv];
+        vtmp2 = vmi[2][iv];
+        subtractRow(ivp, nsys, vtmp1, vmi[3], vmi[1]);
+        subtractRow(ivp, nsys, vtmp2, vmi[3], vmi[2]);
         vdel[1][1][iv] -= vtmp1*vdel[3][1][iv];
         vdel[2][1][iv] -= vtmp2*vdel[3][1][iv];
         vdel[1][2][iv] -= vtmp1*vdel[3][2][iv];
@@ -1695,7 +1735,7 @@ bool XFoil::blsolve()
 
         //------ eliminate upper second column in va block
         vtmp = va[1][2][iv];
-        for (l=ivp; l<=nsys;l++) vm[1][l][iv] -= vtmp*vm[2][l][iv];
+        subtractRow(ivp, nsys, vtmp, vmi[2], vmi[1]);
 
         vdel[1][1][iv] -= vtmp*vdel[2][1][iv];
         vdel[1][2][iv] -= vtmp*vdel[2][2][iv];
@@ -1706,10 +1746,11 @@ bool XFoil::blsolve()
             //====== eliminate vb(iv+1) block][ rows  1 -> 3
             for (k=1; k<= 3;k++)
             {
+                double *row = vm[k][ivp];
                 vtmp1 = vb[k][ 1][ivp];
                 vtmp2 = vb[k][ 2][ivp];
-                vtmp3 = vm[k][iv][ivp];
-                for(l=ivp; l<= nsys;l++) vm[k][l][ivp] -= (vtmp1*vm[1][l][iv]+ vtmp2*vm[2][l][iv]+vtmp3*vm[3][l][iv]);
+                vtmp3 = row[iv];
+                for(l=ivp; l<= nsys;l++) row[l] -= (vtmp1*vmi[1][l]+ vtmp2*vmi[2][l]+vtmp3*vmi[3][l]);
                 vdel[k][1][ivp] -= (vtmp1*vdel[1][1][iv]+vtmp2*vdel[2][1][iv]+ vtmp3*vdel[3][1][iv]);
                 vdel[k][2][ivp] -= (vtmp1*vdel[1][2][iv]+vtmp2*vdel[2][2][iv]+ vtmp3*vdel[3][2][iv]);
             }
@@ -1721,11 +1762,12 @@ bool XFoil::blsolve()
                 //
                 for(k=1;k<=3;k++)
                 {
+                    double *row = vm[k][ivz];
                     vtmp1 = vz[k][1];
                     vtmp2 = vz[k][2];
                     for (l=ivp;l<= nsys;l++)
                     {
-                        vm[k][l][ivz] -=(vtmp1*vm[1][l][iv]+ vtmp2*vm[2][l][iv]);
+                        row[l] -=(vtmp1*vmi[1][l]+ vtmp2*vmi[2][l]);
                     }
                     vdel[k][1][ivz] -= (vtmp1*vdel[1][1][iv]+ vtmp2*vdel[2][1][iv]);
                     vdel[k][2][ivz] -= (vtmp1*vdel[1][2][iv]+ vtmp2*vdel[2][2][iv]);
@@ -1737,27 +1779,39 @@ bool XFoil::blsolve()
                 //====== eliminate lower vm column
                 for(kv=iv+2; kv<= nsys;kv++)
                 {
-                    vtmp1 = vm[1][iv][kv];
-                    vtmp2 = vm[2][iv][kv];
-                    vtmp3 = vm[3][iv][kv];
+                    for (k=1; k<=3; k++) vmk[k] = vm[k][kv];
+                    vtmp1 = vmk[1][iv];
+                    vtmp2 = vmk[2][iv];
+                    vtmp3 = vmk[3][iv];
+
+                    bool b1 = fabs(vtmp1)>m_VAccel;
+                    bool b2 = fabs(vtmp2)>m_VAccel;
+                    bool b3 = fabs(vtmp3)>m_VAccel;
+
+                    if(b1 && b2 && b3)
+                    {
+                        // the usual case: the three rows are eliminated in one pass over the pivot row
+                        subtractRow3(ivp, nsys, vtmp1, vtmp2, vtmp3, vmi[3], vmk[1], vmk[2], vmk[3]);
+                    }
+                    else
+                    {
+                        if(b1) subtractRow(ivp, nsys, vtmp1, vmi[3], vmk[1]);
+                        if(b2) subtractRow(ivp, nsys, vtmp2, vmi[3], vmk[2]);
+                        if(b3) subtractRow(ivp, nsys, vtmp3, vmi[3], vmk[3]);
+                    }
 
-                    if(fabs(vtmp1)>vaccel)
+                    if(b1)
                     {
-                        for(l=ivp;l<= nsys;l++) vm[1][l][kv] -= vtmp1*vm[3][l][iv];
                         vdel[1][1][kv] -= vtmp1*vdel[3][1][iv];
                         vdel[1][2][kv] -= vtmp1*vdel[3][2][iv];
                     }
-
-                    if(fabs(vtmp2)>vaccel)
+                    if(b2)
                     {
-                        for (l=ivp;l<=nsys;l++) vm[2][l][kv] -= vtmp2*vm[3][l][iv];
                         vdel[2][1][kv] -= vtmp2*vdel[3][1][iv];
                         vdel[2][2][kv] -= vtmp2*vdel[3][2][iv];
                     }
-
-                    if(fabs(vtmp3)>vaccel)
+                    if(b3)
                     {
-                        for(l=ivp;l<=nsys;l++) vm[3][l][kv] -= vtmp3*vm[3][l][iv];
                         vdel[3][1][kv] -= vtmp3*vdel[3][1][iv];
                         vdel[3][2][kv] -= vtmp3*vdel[3][2][iv];
                     }
@@ -1768,23 +1822,32 @@ bool XFoil::blsolve()
     }//1000
 
 
-    for (iv=nsys; iv>=2; iv--)
+    //------ eliminate upper vm columns
+    //       each line is back-substituted with the solved third variables of all the lines below it,
+    //       so that the upper triangle is read along its rows rather than down its columns;
+    //       the terms are subtracted in the same order as a column sweep, which gives the same round-off
+    double const *del1 = vdel[3][1];
+    double const *del2 = vdel[3][2];
+    for (kv=nsys-1; kv>=1; kv--)
     {
-        //------ eliminate upper vm columns
-        vtmp = vdel[3][1][iv];
-        for (kv=iv-1; kv>=1;kv--)
+        for (k=1; k<=3; k++) vmk[k] = vm[k][kv];
+        double s11 = vdel[1][1][kv], s21 = vdel[2][1][kv], s31 = vdel[3][1][kv];
+        double s12 = vdel[1][2][kv], s22 = vdel[2][2][kv], s32 = vdel[3][2][kv];
+        for (iv=nsys; iv>kv; iv--)
         {
-            vdel[1][1][kv] -= vm[1][iv][kv]*vtmp;
-            vdel[2][1][kv] -= vm[2][iv][kv]*vtmp;
-            vdel[3][1][kv] -= vm[3][iv][kv]*vtmp;
-        }
-        vtmp = vdel[3][2][iv];
-        for (kv=iv-1; kv>=1;kv--)
-        {
-            vdel[1][2][kv] -= vm[1][iv][kv]*vtmp;
-            vdel[2][2][kv] -= vm[2][iv][kv]*vtmp;
-            vdel[3][2][kv] -= vm[3][iv][kv]*vtmp;
-        }
+            s11 -= vmk[1][iv]*del1[iv];
+            s21 -= vmk[2][iv]*del1[iv];
+            s31 -= vmk[3][iv]*del1[iv];
+            s12 -= vmk[1][iv]*del2[iv];
+            s22 -= vmk[2][iv]*del2[iv];
+            s32 -= vmk[3][iv]*del2[iv];
+        }
+        vdel[1][1][kv] = s11;
+        vdel[2][1][kv] = s21;
+        vdel[3][1][kv] = s31;
+        vdel[1][2][kv] = s12;
+        vdel[2][2][kv] = s22;
+        vdel[3][2][kv] = s32;
     }
     return true;
 }
@@ -2519,7 +2582,7 @@ bool XFoil::cpcalc(int n, double q[], double qinf, double minf, double cp[])
 
 void XFoil::writeString(const std::string &str, bool bFullReport)
 {
-    if(!bFullReport && !s_bFullReport) return;
+    if(!bFullReport && !m_bFullReport) return;
     m_Report.append(str);
 }
 
@@ -2940,7 +3003,7 @@ bool XFoil::Gauss(int nn, double z[][6], double r[5]){
   *                                                     *
   *                              mark drela  1984       *
   ****************************************************** */
-bool XFoil::Gauss(int nn, double z[IQX][IQX], double r[IQX]){
+bool XFoil::Gauss(int nn, XFoilMatrix &z, double r[IQX]){
     // techwinder : only one rhs is enough ! nrhs = 1
     // dimension z(nsiz,nsiz), r(nsiz,nrhs)
 
@@ -3503,6 +3566,38 @@ bool XFoil::getxyf(double x[], double xp[], double y[], double yp[], double s[],
 
 
 
+/**
+ * Sizes the influence matrices to the current number of panel nodes n,
+ * following the same rules as the fixed dimensions IQX = n+6, IWX and IZX = IQX+IWX.
+ * The matrices are reallocated only if the node count has changed,
+ * in which case their content is invalidated.
+ */
+void XFoil::sizeArrays()
+{
+    int nq = std::min(IQX, std::max(n, 0)+6);
+    int nw = std::min(IWX, n/8+2) + 1; // same as xyWake(), 1-based
+    int nz = std::min(IZX, nq+nw);
+
+    if(aij.rows()==nq && dij.rows()==nz) return;
+
+    aij.resize(nq, nq);
+    q.resize(nq, nq);
+    bij.resize(nq, nz);
+    dij.resize(nz, nz);
+    cij.resize(nw, nq);
+    for(int k=1; k<4; k++) vm[k].resize(nz, nz);
+
+    lqaij = false;
+    ladij = false;
+    lwdij = false;
+
+    // the reference factorization does not match the new size
+    m_nRef = 0;
+    m_bDijRef = false;
+    m_bAijUpdate = false;
+}
+
+
 /** --------------------------------------------------------------
  *     Calculates two surface vorticity (gamma) distributions
  *     for alpha = 0, 90  degrees.  These are superimposed
@@ -3516,6 +3611,40 @@ bool XFoil::ggcalc()
     double bbb[IQX];
     //    double psiinf;
 
+    sizeArrays();
+
+    // the factors of the reference geometry are moved aside before the new matrix is assembled in aij;
+    // the copy is shared until aij is written
+    bool bUpdate = s_bLowRankUpdate && m_nRef==n+1;
+    if(bUpdate && !m_bAijUpdate) m_LURef = aij;
+
+    // the rows of the nodes which have not moved are unchanged, except in the columns of the nodes near the moved ones;
+    // these are the only coefficients evaluated in the rows of the fixed nodes, from the panels which contribute to them
+    std::vector<unsigned char> bMoved(n+2, 0), bColumn(n+2, 0);
+    int nMoved = 0;
+    if(bUpdate)
+    {
+        for(int i=1; i<=n; i++)
+        {
+            if(x[i]!=m_xRef[i] || y[i]!=m_yRef[i])
+            {
+                bMoved[i] = 1;
+                nMoved++;
+            }
+        }
+        // the columns of dpsi/dgam depend on the nodes i-1 to i+1 and those of dpsi/dm on the nodes i-3 to i+3;
+        // the contributions to these columns come from the panels i-2 to i+1
+        m_PanelMask.assign(n+2, 0);
+        for(int i=1; i<=n; i++)
+        {
+            if(!bMoved[i]) continue;
+            for(int k=i-3; k<=i+3; k++) bColumn[(k-1+n)%n+1] = 1;
+            for(int k=i-6; k<=i+6; k++) m_PanelMask[(k-1+n)%n+1] = 1;
+        }
+        m_PanelMask[n] = 1; // the TE panel is evaluated at the end of the loop over the panels in psilin()
+    }
+    bool bPartial = bUpdate && nMoved<n/2;
+
     cosa = cos(alfa);
     sina = sin(alfa);
 
@@ -3540,7 +3669,9 @@ bool XFoil::ggcalc()
     for (int i=1; i<=n; i++)
     {
         //------ calculate psi and dpsi/dgamma array for current node
+        m_bMaskPanels = bPartial && !bMoved[i];
         psilin(i, x[i], y[i], nx[i], ny[i], psi, psi_n, false, true);
+        m_bMaskPanels = false;
 
 //        psiinf = qinf*(cosa*y[i] - sina*x[i]);
 
@@ -3549,15 +3680,25 @@ bool XFoil::ggcalc()
         res1 =  qinf*y[i];
         res2 = -qinf*x[i];
 
-        //------ dres/dgamma
-        for (int j=1; j<=n; j++)
+        if(bPartial && !bMoved[i])
         {
-            aij[i][j] = dzdg[j];
+            double const *a0 = m_aijRef[i];
+            double const *b0 = m_bijRef[i];
+            for (int j=1; j<=n; j++) aij[i][j] = bColumn[j] ?  dzdg[j] : a0[j];
+            for (int j=1; j<=n; j++) bij[i][j] = bColumn[j] ? -dzdm[j] : b0[j];
         }
-
-        for (int j=1; j<=n; j++)
+        else
         {
-            bij[i][j] = -dzdm[j];
+            //------ dres/dgamma
+            for (int j=1; j<=n; j++)
+            {
+                aij[i][j] = dzdg[j];
+            }
+
+            for (int j=1; j<=n; j++)
+            {
+                bij[i][j] = -dzdm[j];
+            }
         }
 
         //------ dres/dpsio
@@ -3624,17 +3765,28 @@ bool XFoil::ggcalc()
         gamu[n][2] = -sbis;
     }
 
-    //---- lu-factor coefficient matrix aij
-    ludcmp(n+1,aij,aijpiv);
+    //---- lu-factor coefficient matrix aij, or update the factors of the reference geometry
+    int rank = 0;
+    if(bUpdate && updateAijFactorization(rank))
+    {
+        writeString("   Updating the factorization of the reference geometry with rank " + std::to_string(rank) + "\n");
+    }
+    else
+    {
+        m_bAijUpdate = false;
+        m_LURef = XFoilMatrix();
+        storeReferenceAij();
+        ludcmp(n+1,aij,aijpiv);
+    }
     lqaij = true;
 
     //---- solve system for the two vorticity distributions
     for (int iu=0; iu<IQX; iu++) bbb[iu] = gamu[iu][1];//techwinder : create a dummy array
-    baksub(n+1, aij, aijpiv, bbb);
+    aijSolve(bbb);
     for (int iu=0; iu<IQX; iu++) gamu[iu][1] = bbb[iu];
 
     for (int iu=0; iu<IQX; iu++) bbb[iu] = gamu[iu][2];//techwinder : create a dummy array
-    baksub(n+1, aij, aijpiv, bbb);
+    aijSolve(bbb);
     for (int iu=0; iu<IQX; iu++) gamu[iu][2] = bbb[iu] ;
 
 
@@ -3652,7 +3804,325 @@ bool XFoil::ggcalc()
 
 
 
-bool XFoil::baksub(int n, double a[IQX][IQX], int indx[], double b[])
+/**
+ * Keeps a copy of the assembled matrix aij and of the surface source influences bij as the reference
+ * of the next low-rank updates; to be called before aij is factorized.
+ * The copies share their data with aij and bij until these are overwritten.
+ */
+void XFoil::storeReferenceAij()
+{
+    if(!s_bLowRankUpdate)
+    {
+        m_aijRef = XFoilMatrix();
+        m_bijRef = XFoilMatrix();
+        m_dijRef = XFoilMatrix();
+        m_nRef = 0;
+        m_bDijRef = false;
+        return;
+    }
+    m_aijRef = aij;
+    m_bijRef = bij;
+    m_xRef.assign(x, x+n+1);
+    m_yRef.assign(y, y+n+1);
+    m_nRef = n+1;
+    m_bDijRef = false;
+}
+
+
+/**
+ * Approximates the difference a-a0 of two matrices of nrows x ncols by U.Vt, to a tolerance relative to the
+ * largest coefficient of a0, with the adaptive cross approximation with full pivoting.
+ * When only the nodes aft of a flap hinge have moved, the influences between the fixed nodes and between the moved
+ * nodes are unchanged, and the two blocks of changed influences between the two sets are smooth, i.e. of low
+ * numerical rank, except near the hinge. The rows are split into those which have changed in most of their columns
+ * and the others, and the changed coefficients of each group are approximated separately, so that the cost is
+ * proportional to the size of these blocks instead of that of the matrix.
+ * @param U the matrix whose columns 1 to rank are those of U; resized to nrows+1 x maxrank+1
+ * @param Vt the matrix whose rows 1 to rank are those of Vt; resized to maxrank+1 x ncols+1
+ * @return the rank, or -1 if the difference cannot be approximated with maxrank terms.
+ */
+int XFoil::lowRankDifference(int nrows, int ncols, XFoilMatrix const &a, XFoilMatrix const &a0, int maxrank,
+                             XFoilMatrix &U, XFoilMatrix &Vt) const
+{
+    // the differences below this fraction of the matrix' largest coefficient are round-off errors
+    // in the rotated geometry and are ignored
+    double const RELATIVETOLERANCE = 1.0e-12;
+
+    double amax = 0.0;
+    for(int i=1; i<=nrows; i++)
+        for(int j=1; j<=ncols; j++) amax = std::max(amax, fabs(a0[i][j]));
+    double tol = RELATIVETOLERANCE*amax;
+
+    // count the changed coefficients in each row
+    std::vector<int> nChanged(nrows+1, 0);
+    for(int i=1; i<=nrows; i++)
+    {
+        for(int j=1; j<=ncols; j++)
+            if(fabs(a[i][j]-a0[i][j])>tol) nChanged[i]++;
+    }
+
+    // the changed coefficients of each group of rows, i.e. the blocks to approximate
+    std::vector<int> rowgroup[2], colgroup[2];
+    size_t blocksize = 0;
+    for(int g=0; g<2; g++)
+    {
+        for(int i=1; i<=nrows; i++)
+        {
+            bool bDense = nChanged[i]>ncols/2;
+            if(nChanged[i]>0 && bDense==(g==1)) rowgroup[g].push_back(i);
+        }
+        std::vector<unsigned char> bCol(ncols+1, 0);
+        for(int i : rowgroup[g])
+        {
+            for(int j=1; j<=ncols; j++)
+                if(!bCol[j] && fabs(a[i][j]-a0[i][j])>tol) bCol[j] = 1;
+        }
+        for(int j=1; j<=ncols; j++) if(bCol[j]) colgroup[g].push_back(j);
+        blocksize += rowgroup[g].size()*colgroup[g].size();
+    }
+
+    // the whole geometry has changed, e.g. another foil with the same node count
+    if(double(blocksize)>0.6*double(nrows)*double(ncols)) return -1;
+
+    U.resize(nrows+1, maxrank+1);
+    U.clear();
+    Vt.resize(maxrank+1, ncols+1);
+    Vt.clear();
+
+    int rank = 0;
+    for(int g=0; g<2; g++)
+    {
+        std::vector<int> const &rows = rowgroup[g];
+        std::vector<int> const &cols = colgroup[g];
+        int nr = int(rows.size());
+        int nc = int(cols.size());
+        if(nr==0 || nc==0) continue;
+
+        // the residual block, row-major
+        std::vector<double> R(size_t(nr)*size_t(nc));
+        int imax=0, jmax=0;
+        double rmax = 0.0;
+        for(int i=0; i<nr; i++)
+        {
+            for(int j=0; j<nc; j++)
+            {
+                double d = a[rows[i]][cols[j]]-a0[rows[i]][cols[j]];
+                R[size_t(i)*nc+j] = d;
+                if(fabs(d)>rmax)
+                {
+                    rmax = fabs(d);
+                    imax = i;
+                    jmax = j;
+                }
+            }
+        }
+
+        std::vector<double> u(nr), v(nc);
+        while(rmax>tol)
+        {
+            if(rank>=maxrank) return -1;
+            rank++;
+
+            double pivot = R[size_t(imax)*nc+jmax];
+            for(int i=0; i<nr; i++) u[i] = R[size_t(i)*nc+jmax]/pivot;
+            for(int j=0; j<nc; j++) v[j] = R[size_t(imax)*nc+j];
+            for(int i=0; i<nr; i++) U[rows[i]][rank] = u[i];
+            double *vt = Vt[rank];
+            for(int j=0; j<nc; j++) vt[cols[j]] = v[j];
+
+            // subtract the cross and find the next pivot in the same pass
+            rmax = 0.0;
+            for(int i=0; i<nr; i++)
+            {
+                double ui = u[i];
+                double *ri = R.data() + size_t(i)*nc;
+                for(int j=0; j<nc; j++)
+                {
+                    ri[j] -= ui*v[j];
+                    if(fabs(ri[j])>rmax)
+                    {
+                        rmax = fabs(ri[j]);
+                        imax = i;
+                        jmax = j;
+                    }
+                }
+            }
+        }
+    }
+    return rank;
+}
+
+
+/**
+ * Compares the new matrix A assembled in aij with the reference matrix A0, and makes the
+ * Sherman-Morrison-Woodbury update of the factorization of A0 if the difference is of low rank,
+ * as is the case when only the nodes aft of a flap hinge have moved.
+ * With A-A0 = U.Vt,
+ *     A^-1 = A0^-1 - Z.(I+Vt.Z)^-1.Vt.A0^-1,   with Z = A0^-1.U
+ * which costs rank(U) back-substitutions instead of a factorization.
+ * The factors of A0 must be in m_LURef and their pivots in aijpiv.
+ * @param rank the rank of the update
+ * @return true if the update was made, false if the rank is too large, in which case aij holds A, to be factorized.
+ */
+bool XFoil::updateAijFactorization(int &rank)
+{
+    int N = n+1;
+    int maxrank = int(s_MaxUpdateFraction*double(N));
+    m_bAijUpdate = false;
+    m_UpdateRank = 0;
+
+    rank = lowRankDifference(N, N, aij, m_aijRef, maxrank, m_UpdateZ, m_UpdateVt);
+    if(rank<0) return false;
+
+    m_UpdateRank = rank;
+    m_bAijUpdate = true;
+    if(rank==0) return true;
+
+    int m = rank;
+
+    // Z = A0^-1.U
+    baksub(N, m_LURef, aijpiv, m_UpdateZ, 1, m);
+
+    // K = I + Vt.Z
+    m_UpdateK.resize(m+1, m+1);
+    m_UpdateK.clear();
+    for(int a=1; a<=m; a++)
+    {
+        double const *va = m_UpdateVt[a];
+        double *ka = m_UpdateK[a];
+        for(int k=1; k<=N; k++)
+        {
+            if(va[k]==0.0) continue;
+            double const *zk = m_UpdateZ[k];
+            for(int b=1; b<=m; b++) ka[b] += va[k]*zk[b];
+        }
+        ka[a] += 1.0;
+    }
+
+    m_UpdatePiv.assign(m+1, 0);
+    ludcmp(m, m_UpdateK, m_UpdatePiv.data());
+    for(int a=1; a<=m; a++)
+    {
+        double kaa = m_UpdateK[a][a];
+        if(kaa==0.0 || !std::isfinite(kaa))
+        {
+            // A is singular or the update is ill-conditioned; refactorize
+            m_bAijUpdate = false;
+            m_UpdateRank = 0;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * Applies the low-rank correction to the block of solutions X0=A0^-1.B:
+ *     X = X0 - Z.K^-1.Vt.X0
+ * The element (i,j) of X, with i=1..n+1 and j=0..nrhs-1, is b[i*stride+j].
+ */
+void XFoil::applyAijUpdate(double *b, size_t stride, int nrhs)
+{
+    int N = n+1;
+    int m = m_UpdateRank;
+    if(m==0 || nrhs<=0) return;
+
+    // T = Vt.X0
+    XFoilMatrix T;
+    T.resize(m+1, nrhs+1);
+    for(int a=1; a<=m; a++)
+    {
+        double const *va = m_UpdateVt[a];
+        double *ta = T[a]+1;
+        for(int k=1; k<=N; k++)
+        {
+            if(va[k]==0.0) continue;
+            double const *xk = b + size_t(k)*stride;
+            for(int j=0; j<nrhs; j++) ta[j] += va[k]*xk[j];
+        }
+    }
+
+    // S = K^-1.T
+    baksub(m, m_UpdateK, m_UpdatePiv.data(), T, 1, nrhs);
+
+    // X = X0 - Z.S
+    for(int i=1; i<=N; i++)
+    {
+        double const *zi = m_UpdateZ[i];
+        double *xi = b + size_t(i)*stride;
+        for(int c=1; c<=m; c++)
+        {
+            if(zi[c]==0.0) continue;
+            double const *sc = T[c]+1;
+            for(int j=0; j<nrhs; j++) xi[j] -= zi[c]*sc[j];
+        }
+    }
+}
+
+
+/** Solves aij.x=b in place, with the factors of aij or with the updated factors of the reference matrix */
+bool XFoil::aijSolve(double b[])
+{
+    if(!m_bAijUpdate) return baksub(n+1, aij, aijpiv, b);
+
+    baksub(n+1, m_LURef, aijpiv, b);
+    applyAijUpdate(b, 1, 1);
+    return true;
+}
+
+
+/** Solves aij.X=B in place for the columns j0 to j0+nrhs-1 of b; @see aijSolve(double[]) */
+bool XFoil::aijSolve(XFoilMatrix &b, int j0, int nrhs)
+{
+    if(!m_bAijUpdate) return baksub(n+1, aij, aijpiv, b, j0, nrhs);
+
+    baksub(n+1, m_LURef, aijpiv, b, j0, nrhs);
+    applyAijUpdate(b[0]+j0, size_t(b.cols()), nrhs);
+    return true;
+}
+
+
+/**
+ * Makes the surface source influences A^-1.B from those of the reference geometry A0^-1.B0 when the factorization
+ * has been updated. With B-B0 = UB.VBt,
+ *     A0^-1.B = A0^-1.B0 + (A0^-1.UB).VBt
+ * which costs rank(UB) back-substitutions, and the low-rank correction of A^-1 is then applied to all the columns.
+ * @return false if the reference is not available or if the rank is too large, in which case bij is unchanged.
+ */
+bool XFoil::updateSourceInfluence()
+{
+    int N = n+1;
+    if(!m_bDijRef || m_nRef!=N) return false;
+
+    XFoilMatrix W, VBt;
+    int rank = lowRankDifference(N, n, bij, m_bijRef, int(s_MaxUpdateFraction*double(N)), W, VBt);
+    if(rank<0) return false;
+
+    // W = A0^-1.UB
+    if(rank>0) baksub(N, m_LURef, aijpiv, W, 1, rank);
+
+    // A0^-1.B
+    for(int i=1; i<=N; i++)
+    {
+        double *bi = bij[i];
+        double const *di = m_dijRef[i];
+        double const *wi = W[i];
+        for(int k=1; k<=n; k++) bi[k] = di[k];
+        for(int a=1; a<=rank; a++)
+        {
+            if(wi[a]==0.0) continue;
+            double const *va = VBt[a];
+            for(int k=1; k<=n; k++) bi[k] += wi[a]*va[k];
+        }
+    }
+
+    applyAijUpdate(bij[0]+1, size_t(bij.cols()), n);
+    return true;
+}
+
+
+bool XFoil::baksub(int n, XFoilMatrix const &a, int indx[], double b[])
 {
     double sum(0);
     int i(0), ii(0), ll(0), j(0);
@@ -3682,6 +4152,62 @@ bool XFoil::baksub(int n, double a[IQX][IQX], int indx[], double b[])
 }
 
 
+/**
+ * Back-substitutes the columns j0 to j0+nrhs-1 of b in place with the lu factors made by ludcmp.
+ * The right-hand sides are contiguous in each row of b, so that they are all updated by the inner loops;
+ * the columns are processed in blocks which stay in the cache while the factors are streamed.
+ */
+bool XFoil::baksub(int n, XFoilMatrix const &a, int const indx[], XFoilMatrix &b, int j0, int nrhs)
+{
+    int const blocksize = 64;
+
+    for(int c0=0; c0<nrhs; c0+=blocksize)
+    {
+        int nc = std::min(blocksize, nrhs-c0);
+
+        //---- row interchanges, in the order of the factorization
+        for (int i=1; i<=n; i++)
+        {
+            int ll = indx[i];
+            if(ll==i) continue;
+            double *bi = b[i]+j0+c0;
+            double *bl = b[ll]+j0+c0;
+            for (int c=0; c<nc; c++) std::swap(bi[c], bl[c]);
+        }
+
+        //---- forward substitution with the unit lower factor
+        for (int i=2; i<=n; i++)
+        {
+            double const *ai = a[i];
+            double *bi = b[i]+j0+c0;
+            for (int k=1; k<i; k++)
+            {
+                double aik = ai[k];
+                if(aik==0.0) continue;
+                double const *bk = b[k]+j0+c0;
+                for (int c=0; c<nc; c++) bi[c] -= aik*bk[c];
+            }
+        }
+
+        //---- back substitution with the upper factor
+        for (int i=n; i>=1; i--)
+        {
+            double const *ai = a[i];
+            double *bi = b[i]+j0+c0;
+            for (int k=i+1; k<=n; k++)
+            {
+                double aik = ai[k];
+                if(aik==0.0) continue;
+                double const *bk = b[k]+j0+c0;
+                for (int c=0; c<nc; c++) bi[c] -= aik*bk[c];
+            }
+            for (int c=0; c<nc; c++) bi[c] /= ai[i];
+        }
+    }
+    return true;
+}
+
+
 bool XFoil::hct(double hk, double msq, double &hc, double &hc_hk, double &hc_msq)
 {
     //---- density shape parameter    (from whitfield)
@@ -4124,6 +4650,24 @@ bool XFoil::initXFoilAnalysis(double Re, double alpha, double Mach, double NCrit
 }
 
 
+/**
+ * Builds the part of the analysis which depends only on the paneled geometry, i.e. the factorized
+ * vorticity influence matrix, the unit vorticity distributions and the surface source influence matrix.
+ * An instance in this state can be copied to start analyses at any Re, Mach, NCrit, trip or alpha
+ * without repeating the inviscid factorization. Must be called after initXFoilGeometry().
+ */
+bool XFoil::prepareInviscid()
+{
+    if(n<=0) return false;
+    if(!lgamu || !lqaij)
+    {
+        if(!ggcalc()) return false;
+    }
+    if(!ladij) return dijcalc();
+    return true;
+}
+
+
 /**     logical function inside(x,y,n, xf,yf)
  *      dimension x(n),y(n)
  *-------------------------------------
@@ -4239,7 +4783,7 @@ bool XFoil::lefind(double &sle, double x[], double xp[], double y[], double yp[]
  *    *******************************************************
 */
 
-bool XFoil::ludcmp(int n, double a[IQX][IQX], int indx[IQX])
+bool XFoil::ludcmp(int n, XFoilMatrix &a, int indx[IQX])
 {
     //    bool bimaxok = false;
     int imax(0);//added techwinder
@@ -4262,42 +4806,39 @@ bool XFoil::ludcmp(int n, double a[IQX][IQX], int indx[IQX])
         vv[i] = 1.0/aamax;
     }
 
+    // right-looking elimination: the trailing rows are updated by the pivot row,
+    // so that the inner loop runs along the contiguous rows of the row-major matrix
     for(j=1; j<=n;j++)
     {
-        for(i=1; i<=j-1; i++)
-        {
-            sum = a[i][j];
-            for (k=1;k<= i-1;k++) sum = sum - a[i][k]*a[k][j];
-            a[i][j] = sum;
-        }
-
         aamax = 0.0;
-
+        imax = j;
         for (i=j; i<=n; i++){
-            sum = a[i][j];
-            for (k=1;k<= j-1;k++) sum = sum - a[i][k]*a[k][j];
-            a[i][j] = sum ;
-            dum = (vv[i]*fabs(sum));
+            dum = (vv[i]*fabs(a[i][j]));
             if(dum>=aamax){
                 imax = i;
                 aamax = dum;
-                //                bimaxok = true;
             }
         }
-        //        ASSERT(bimaxok);// to check imax has been initialized
+
         if(j!=imax) {
-            for (k=1; k<= n; k++){
-                dum = a[imax][k];
-                a[imax][k] = a[j][k];
-                a[j][k] = dum;
-            }
+            double *aimax = a[imax];
+            double *aj = a[j];
+            for (k=1; k<= n; k++) std::swap(aimax[k], aj[k]);
             vv[imax] = vv[j];
         }
 
         indx[j] = imax;
         if(j!=n) {
-            dum = 1.0/a[j][j];
-            for(i=j+1; i<=n; i++) a[i][j] = a[i][j]*dum;
+            double const *aj = a[j];
+            dum = 1.0/aj[j];
+            for(i=j+1; i<=n; i++)
+            {
+                double *ai = a[i];
+                ai[j] *= dum;
+                sum = ai[j];
+                if(sum==0.0) continue;
+                for (k=j+1; k<=n; k++) ai[k] -= sum*aj[k];
+            }
         }
     }
     return true;
@@ -4752,7 +5293,7 @@ stop110:
             }
 
             tran = false;
-            if(s_bCancel) return false;
+            if(bRunCancelled()) return false;
         }//1000 continue
     }// 2000 continue
     return true;
@@ -5962,6 +6503,9 @@ bool XFoil::psilin(int iNode, double xi, double yi, double nxi, double nyi, doub
         //------ skip null panel
         if(fabs(dso)<1.0e-7) goto stop10;
 
+        //------ skip the panels which do not contribute to the coefficients evaluated in the partial assembly of ggcalc()
+        if(m_bMaskPanels && !m_PanelMask[jo]) goto stop10;
+
         dsio = 1.0 /dso;
 
         apan = apanel[jo];
@@ -6458,39 +7002,54 @@ bool XFoil::pswlin(int i, double xi, double yi, double nxi, double nyi, double &
 
 
 
+/** ------------------------------------------------------
+ *      calculates the source influence matrix for the
+ *      airfoil surface; depends only on the paneling
+ * ------------------------------------------------------ */
+bool XFoil::dijcalc()
+{
+    sizeArrays();
+
+    //---- multiply all the dpsi/sig vectors by inverse of factored dpsi/dgam matrix
+    if(!m_bAijUpdate || !updateSourceInfluence())
+        aijSolve(bij, 1, n);
+
+    // the reference for the source influences of the next geometries
+    if(!m_bAijUpdate && m_nRef==n+1)
+    {
+        m_dijRef = bij;
+        m_bDijRef = true;
+    }
+
+    for (int j=1; j<=n; j++)
+    {
+        //------- store resulting dgam/dsig = dqtan/dsig vector
+        for (int i=1; i<=n; i++)
+        {
+            dij[i][j] = bij[i][j];
+        }
+    }
+    ladij = true;
+    return true;
+}
+
+
 /** -----------------------------------------------------
  *        calculates source panel influence coefficient
  *        matrix for current airfoil and wake geometry.
  * ------------------------------------------------------ */
 bool XFoil::qdcalc()
 {
-    int i(0), j(0), k(0), iu(0), iw(0);
+    int i(0), j(0), k(0), iw(0);
     double psi(0), psi_n(0);
-    double bbb[IQX];
-    memset(bbb, 0, IQX*sizeof(double));
+
+    sizeArrays();
 
     //TRACE("calculating source influence matrix ...\n");
     std::string str = "   Calculating source influence matrix ...\n";
     writeString(str);
 
-    if(!ladij)
-    {
-        //----- calculate source influence matrix for airfoil surface if it doesn't exist
-        for (j=1; j<=n; j++)
-        {
-            //------- multiply each dpsi/sig vector by inverse of factored dpsi/dgam matrix
-            for (iu=0; iu<IQX; iu++) bbb[iu] = bij[iu][j];//techwinder : create a dummy array
-            baksub(n+1,aij,aijpiv,bbb);
-            for (iu=0; iu<IQX; iu++) bij[iu][j] = bbb[iu];
-
-            //------- store resulting dgam/dsig = dqtan/dsig vector
-            for (i=1; i<=n; i++)
-            {
-                dij[i][j] = bij[i][j];
-            }
-        }
-        ladij = true;
-    }
+    if(!ladij) dijcalc();
 
     //---- set up coefficient matrix of dpsi/dm on wake
     for (i=1; i<=n; i++)
@@ -6524,15 +7083,8 @@ for(int i=1; i<=n; i++)
     qDebug(strong.toStdString().c_str());
 }*/
 
-    //---- multiply by inverse of factored dpsi/dgam matrix
-    for(j=n+1; j<=n+nw;j++)
-    {
-        //        baksub(iqx,n+1,aijpiv,j);
-        for (iu=0; iu<IQX; iu++) bbb[iu] = bij[iu][j];//techwinder: create a dummy array
-
-        baksub(n+1,aij,aijpiv,bbb);
-        for (iu=0; iu<IQX; iu++) bij[iu][j] = bbb[iu];
-    }
+    //---- multiply by inverse of factored dpsi/dgam matrix, all the wake columns at once
+    aijSolve(bij, n+1, nw);
 
     //---- set the source influence matrix for the wake sources
     for(i=1; i<=n; i++)
@@ -7073,17 +7625,26 @@ bool XFoil::setbl()
     int i(0), ibl(0), iv(0),iw(0), j(0), js(0), jv(0), jbl(0), is(0);
     int ile1(0),ile2(0),ite1(0),ite2(0),jvte1(0),jvte2(0);
 
+    sizeArrays();
+
     double usav[IVX+1][ISX];
-    double u1_m[2*IVX+1], u2_m[2*IVX+1];
-    double d1_m[2*IVX+1], d2_m[2*IVX+1];
+    double um_a[2*IVX+1], um_b[2*IVX+1];
+    double dm_a[2*IVX+1], dm_b[2*IVX+1];
     double ule1_m[2*IVX+1], ule2_m[2*IVX+1];
     double ute1_m[2*IVX+1], ute2_m[2*IVX+1];
+    double xi_m[2*IVX+1];   // xi_ule1*ule1_m + xi_ule2*ule2_m, depends only on the side
+    double vtj[2*IVX+1];    // vti of each system line
+    int jpan[2*IVX+1];      // panel index of each system line
+
+    // the "1" and "2" sensitivities are swapped instead of copied when stepping to the next station
+    double *u1_m = um_a, *u2_m = um_b;
+    double *d1_m = dm_a, *d2_m = dm_b;
 
     for(int i=0; i<IVX+1; i++) memset(usav[i], 0, ISX*sizeof(double));
-    memset(u1_m, 0, (2*IVX+1)*sizeof(double));
-    memset(u2_m, 0, (2*IVX+1)*sizeof(double));
-    memset(d1_m, 0, (2*IVX+1)*sizeof(double));
-    memset(d2_m, 0, (2*IVX+1)*sizeof(double));
+    memset(um_a, 0, (2*IVX+1)*sizeof(double));
+    memset(um_b, 0, (2*IVX+1)*sizeof(double));
+    memset(dm_a, 0, (2*IVX+1)*sizeof(double));
+    memset(dm_b, 0, (2*IVX+1)*sizeof(double));
     memset(ule1_m, 0, (2*IVX+1)*sizeof(double));
     memset(ule2_m, 0, (2*IVX+1)*sizeof(double));
     memset(ute1_m, 0, (2*IVX+1)*sizeof(double));
@@ -7189,12 +7750,16 @@ bool XFoil::setbl()
     dule2 = uedg[2][2] - usav[2][2];
 
     //---- set le and te ue sensitivities wrt all m values
+    //     and gather the panel indexes and vti of the system lines, so that the
+    //     per-station loops below run over contiguous arrays indexed by jv
     for(js=1; js<= 2;js++)
     {
         for(jbl=2;jbl<= nbl[js];jbl++)
         {
             j  = ipan[jbl][js];
             jv = isys[jbl][js];
+            jpan[jv] = j;
+            vtj[jv]  = vti[jbl][js];
             ule1_m[jv] = -vti[         2][1]*vti[jbl][js]*dij[ile1][j];
             ule2_m[jv] = -vti[         2][2]*vti[jbl][js]*dij[ile2][j];
             ute1_m[jv] = -vti[iblte[1]][1]*vti[jbl][js]*dij[ite1][j];
@@ -7212,14 +7777,10 @@ bool XFoil::setbl()
     for(is=1;is<=2;is++)
     {
         //---- there is no station "1" at similarity, so zero everything out
-        for(js=1; js<= 2;js++)
+        for(jv=1; jv<=nsys; jv++)
         {
-            for(jbl=2;jbl<= nbl[js];jbl++)
-            {
-                jv = isys[jbl][js];
-                u1_m[jv] = 0.0;
-                d1_m[jv] = 0.0;
-            }
+            u1_m[jv] = 0.0;
+            d1_m[jv] = 0.0;
         }
         u1_a = 0.0;
         d1_a = 0.0;
@@ -7227,6 +7788,17 @@ bool XFoil::setbl()
         due1 = 0.0;
         dds1 = 0.0;
 
+        //---- set xi sensitivities wrt le ue changes, and wrt all m values through them
+        if(is==1) {
+            xi_ule1 =  sst_go;
+            xi_ule2 = -sst_gp;
+        }
+        else{
+            xi_ule1 = -sst_go;
+            xi_ule2 =  sst_gp;
+        }
+        for(jv=1; jv<=nsys; jv++) xi_m[jv] = xi_ule1*ule1_m[jv] + xi_ule2*ule2_m[jv];
+
         //---- similarity station pressure gradient parameter  x/u du/dx
         ibl = 2;
         bule = 1.0;
@@ -7271,15 +7843,12 @@ bool XFoil::setbl()
             d2_m2 =  1.0/uei;
             d2_u2 = -dsi /uei;
 
-            for(js=1; js<= 2;js++)
+            double const *dij_i = dij[i];
+            double const vti_i = -vti[ibl][is];
+            for(jv=1; jv<=nsys; jv++)
             {
-                for(jbl=2;jbl<= nbl[js];jbl++)
-                {
-                    j  = ipan[jbl][js];
-                    jv = isys[jbl][js];
-                    u2_m[jv] = -vti[ibl][is]*vti[jbl][js]*dij[i][j];
-                    d2_m[jv] = d2_u2*u2_m[jv];
-                }
+                u2_m[jv] = vti_i*vtj[jv]*dij_i[jpan[jv]];
+                d2_m[jv] = d2_u2*u2_m[jv];
             }
             d2_m[iv] = d2_m[iv] + d2_m2;
 
@@ -7327,15 +7896,8 @@ bool XFoil::setbl()
                 cte_tte2 = (ctau[iblte[2]][2] - cte)/tte;
 
                 //----- re-define d1 sensitivities wrt m since d1 depends on both te ds values
-                for (js=1; js<= 2;js++)
-                {
-                    for (jbl=2; jbl<= nbl[js];jbl++)
-                    {
-                        j  = ipan[jbl][js];
-                        jv = isys[jbl][js];
-                        d1_m[jv] = dte_ute1*ute1_m[jv] + dte_ute2*ute2_m[jv];
-                    }
-                }
+                for (jv=1; jv<=nsys; jv++)
+                    d1_m[jv] = dte_ute1*ute1_m[jv] + dte_ute2*ute2_m[jv];
                 d1_m[jvte1] = d1_m[jvte1] + dte_mte1;
                 d1_m[jvte2] = d1_m[jvte2] + dte_mte2;
 
@@ -7356,23 +7918,22 @@ bool XFoil::setbl()
             delt[ibl][is] = de2;
             uslp[ibl][is] = 1.60/(1.0+us2);
 
-            //---- set xi sensitivities wrt le ue changes
-            if(is==1) {
-                xi_ule1 =  sst_go;
-                xi_ule2 = -sst_gp;
-            }
-            else{
-                xi_ule1 = -sst_go;
-                xi_ule2 =  sst_gp;
-            }
-
             //---- stuff bl system coefficients into main jacobian matrix
-
-            for( jv=1; jv<= nsys;jv++){
-                vm[1][jv][iv] = vs1[1][3]*d1_m[jv] + vs1[1][4]*u1_m[jv]
-                        + vs2[1][3]*d2_m[jv] + vs2[1][4]*u2_m[jv]
-                        + (vs1[1][5] + vs2[1][5] + vsx[1])
-                        *(xi_ule1*ule1_m[jv] + xi_ule2*ule2_m[jv]);
+            //     the three mass-influence rows of the station are filled in a single pass
+            {
+                double *vm1_iv = vm[1][iv];
+                double *vm2_iv = vm[2][iv];
+                double *vm3_iv = vm[3][iv];
+                double const a1 = vs1[1][3], b1 = vs1[1][4], c1 = vs2[1][3], e1 = vs2[1][4], x1 = vs1[1][5] + vs2[1][5] + vsx[1];
+                double const a2 = vs1[2][3], b2 = vs1[2][4], c2 = vs2[2][3], e2 = vs2[2][4], x2 = vs1[2][5] + vs2[2][5] + vsx[2];
+                double const a3 = vs1[3][3], b3 = vs1[3][4], c3 = vs2[3][3], e3 = vs2[3][4], x3 = vs1[3][5] + vs2[3][5] + vsx[3];
+                for(jv=1; jv<=nsys; jv++)
+                {
+                    double const d1 = d1_m[jv], v1 = u1_m[jv], d2 = d2_m[jv], v2 = u2_m[jv], xm = xi_m[jv];
+                    vm1_iv[jv] = a1*d1 + b1*v1 + c1*d2 + e1*v2 + x1*xm;
+                    vm2_iv[jv] = a2*d1 + b2*v1 + c2*d2 + e2*v2 + x2*xm;
+                    vm3_iv[jv] = a3*d1 + b3*v1 + c3*d2 + e3*v2 + x3*xm;
+                }
             }
 
             vb[1][1][iv] = vs1[1][1];
@@ -7395,12 +7956,6 @@ bool XFoil::setbl()
                     + (vs1[1][5] + vs2[1][5] + vsx[1])
                     *(xi_ule1*dule1 + xi_ule2*dule2);
 
-            for(jv=1; jv<= nsys;jv++){
-                vm[2][jv][iv] = vs1[2][3]*d1_m[jv] + vs1[2][4]*u1_m[jv]
-                        + vs2[2][3]*d2_m[jv] + vs2[2][4]*u2_m[jv]
-                        + (vs1[2][5] + vs2[2][5] + vsx[2])
-                        *(xi_ule1*ule1_m[jv] + xi_ule2*ule2_m[jv]);
-            }
             vb[2][1][iv]    = vs1[2][1];
             vb[2][2][iv]    = vs1[2][2];
 
@@ -7422,14 +7977,6 @@ bool XFoil::setbl()
                     *(xi_ule1*dule1 + xi_ule2*dule2);
 
 
-            //memory overlap problem
-            for(jv=1; jv<= nsys;jv++){
-                vm[3][jv][iv] = vs1[3][3]*d1_m[jv] + vs1[3][4]*u1_m[jv]
-                        + vs2[3][3]*d2_m[jv] + vs2[3][4]*u2_m[jv]
-                        + (vs1[3][5] + vs2[3][5] + vsx[3])
-                        *(xi_ule1*ule1_m[jv] + xi_ule2*ule2_m[jv]);
-            }
-
             vb[3][1][iv] = vs1[3][1];
             vb[3][2][iv] = vs1[3][2];
 
@@ -7504,13 +8051,8 @@ bool XFoil::setbl()
                 blmid(3);
             }
 
-            for(js=1; js<= 2;js++){
-                for(jbl=2; jbl<= nbl[js];jbl++){
-                    jv = isys[jbl][js];
-                    u1_m[jv] = u2_m[jv];
-                    d1_m[jv] = d2_m[jv];
-                }
-            }
+            std::swap(u1_m, u2_m);
+            std::swap(d1_m, d2_m);
 
             u1_a = u2_a;
             d1_a = d2_a;
@@ -8846,7 +9388,7 @@ bool XFoil::trchek()
     //TRACE("trchek2 - n2 convergence failed\n");
     str = "trchek2 - n2 convergence failed\n";
     writeString(str, true);
-    if(s_bCancel) return false;
+    if(bRunCancelled()) return false;
 stop101:
 
     //---- test for free or forced transition
@@ -10677,6 +11219,25 @@ bool XFoil::eiwset(int nc1)
         }
     }
 
+    //---- set up the FFT of the sums over the nc-1 distinct points, if a power of 2
+    int nfft = nc-1;
+    m_bFFT = nfft>=2 && (nfft & (nfft-1))==0;
+    if(m_bFFT)
+    {
+        int nbits = 0;
+        while((1<<nbits)<nfft) nbits++;
+        for(int j=0; j<nfft; j++)
+        {
+            int r = 0;
+            for(int b=0; b<nbits; b++) if(j & (1<<b)) r |= 1<<(nbits-1-b);
+            m_FFTBitRev[j] = r;
+        }
+        for(int k=0; k<nfft/2; k++) m_FFTTwiddle[k] = eiw[k+1][1];
+    }
+
+    // the factors of z'(w) depend on wc
+    m_ZcFactorNc = 0;
+
     return true;
 
 }
@@ -10832,6 +11393,38 @@ void XFoil::scinit(int n, double x[], double xp[], double y[], double yp[], doub
 }
 
 
+/**
+ * In-place FFT of the nc-1 values of a, i.e. a[k] <- sum_j a[j] exp(sign i 2 PI jk/(nc-1)).
+ * The twiddle factors are those of eiw, so that the sums match the slow transforms.
+ */
+void XFoil::fftCircle(std::complex<double> *a, int sign)
+{
+    int nfft = nc-1;
+    for(int j=0; j<nfft; j++)
+    {
+        int r = m_FFTBitRev[j];
+        if(r>j) std::swap(a[j], a[r]);
+    }
+
+    for(int len=2; len<=nfft; len*=2)
+    {
+        int half = len/2;
+        int stride = nfft/len;
+        for(int i0=0; i0<nfft; i0+=len)
+        {
+            for(int k=0; k<half; k++)
+            {
+                std::complex<double> w = m_FFTTwiddle[k*stride];
+                if(sign<0) w = conjg(w);
+                std::complex<double> t = w*a[i0+k+half];
+                a[i0+k+half] = a[i0+k] - t;
+                a[i0+k]     += t;
+            }
+        }
+    }
+}
+
+
 void XFoil::ftp()
 {
     //----------------------------------------------------------------
@@ -10840,6 +11433,17 @@ void XFoil::ftp()
 
     std::complex<double> zsum=0;
 
+    if(m_bFFT)
+    {
+        //---- w = 0 and w = 2 PI are the same point; the trapezoidal end weights add up
+        m_FFTWork[0] = 0.5*(piq[1] + piq[nc]);
+        for(int ic=2; ic<=nc-1; ic++) m_FFTWork[ic-1] = piq[ic];
+        fftCircle(m_FFTWork, 1);
+        for(int m=0; m<=mc; m++) cn[m] = m_FFTWork[m]*dwc/PI;
+        cn[0] = 0.5*cn[0];
+        return;
+    }
+
     for (int m=0; m<= mc;m++){
         zsum = std::complex<double>(0.0,0.0);
         for(int ic=2; ic<= nc-1; ic++)
@@ -10861,6 +11465,15 @@ void XFoil::piqsum()
     //---------------------------------------------
     std::complex<double> zsum=0;
 
+    if(m_bFFT && mc<nc-1)
+    {
+        for(int m=0; m<nc-1; m++) m_FFTWork[m] = m<=mc ? cn[m] : std::complex<double>(0.0,0.0);
+        fftCircle(m_FFTWork, -1);
+        for(int ic=1; ic<=nc-1; ic++) piq[ic] = m_FFTWork[ic-1];
+        piq[nc] = piq[1];
+        return;
+    }
+
     for(int ic=1; ic <= nc; ic++){
         zsum = std::complex<double>(0.0,0.0);
         for(int m=0; m<= mc; m++){
@@ -10926,6 +11539,26 @@ void XFoil::zcnorm(int mtest)
 }
 
 
+/**
+ * Sets the factors of z'(w) = [2 sin(w/2)]^(1-agte) exp(piq + i hwc) which do not depend on piq,
+ * so that zccalc() does not recompute them at each iteration of the mapping.
+ */
+void XFoil::setZcFactors()
+{
+    for(int ic=1; ic<=nc; ic++)
+    {
+        double sinw = 2.0*sin(0.5*wc[ic]);
+        double sinwe = 0.0;
+        if(sinw>0.0) sinwe = pow(sinw,(1.0-agte));
+
+        double hwc = 0.5*(wc[ic]-PI)*(1.0+agte) - 0.5*PI;
+        m_ZcFactor[ic] = sinwe * exp(std::complex<double>(0.0,hwc));
+    }
+    m_ZcFactorNc = nc;
+    m_ZcFactorAgte = agte;
+}
+
+
 void XFoil::zccalc(int mtest)
 {
     //--------------------------------------------------------
@@ -10938,26 +11571,18 @@ void XFoil::zccalc(int mtest)
     //      include 'circle.inc'
     std::complex<double> dzdw1=0, dzdw2=0, dz_piq1=0, dz_piq2=0;
 
+    if(m_ZcFactorNc!=nc || m_ZcFactorAgte!=agte) setZcFactors();
+
     //---- integrate upper airfoil surface coordinates from x,y = 4,0
     int ic = 1;
     zc[ic] = std::complex<double>(4.0,0.0);
     for (int m=1; m<= mtest; m++) zc_cn[ic][m] = std::complex<double>(0.0,0.0);
 
-    double sinw = 2.0*sin(0.5*wc[ic]);
-    double sinwe = 0.0;
-    if(sinw>0.0) sinwe = pow(sinw,(1.0-agte));
-
-    double hwc = 0.5*(wc[ic]-PI)*(1.0+agte) - 0.5*PI;
-    dzdw1 = sinwe * exp( piq[ic] + std::complex<double>(0.0,hwc) );
+    dzdw1 = m_ZcFactor[ic] * exp(piq[ic]);
 
     for (ic=2; ic<= nc; ic++){
 
-        sinw = 2.0*sin(0.5*wc[ic]);
-        sinwe = 0.0;
-        if(sinw>0.0) sinwe = pow(sinw,(1.0-agte));
-
-        hwc = 0.5*(wc[ic]-PI)*(1.0+agte) - 0.5*PI;
-        dzdw2 = sinwe * exp( piq[ic] + std::complex<double>(0.0,hwc));
+        dzdw2 = m_ZcFactor[ic] * exp(piq[ic]);
 
         zc[ic]  = 0.5*(dzdw1+dzdw2)*dwc + zc[ic-1];
         dz_piq1 = 0.5*(dzdw1      )*dwc;
@@ -12110,6 +12735,8 @@ bool XFoil::mixed(int kqsp)
     double res=0;
     double dnmax=0, dgmax=0;
 
+    sizeArrays();
+
     //---- distance of internal control point ahead of sharp te
     //    (fraction of smaller panel length adjacent to te)
     bwt = 0.1;
@@ -13183,3 +13810,14 @@ void XFoil::createXBL()
         xbl[iblte[1]+iblw][1] = xbl[iblte[2]+iblw][2];
 }
 
+
+
+/** The memory used by the instance, in bytes: the fixed size arrays and the influence matrices */
+size_t XFoil::memoryFootprint() const
+{
+    size_t n = sizeof(XFoil) + q.memorySize() + aij.memorySize() + bij.memorySize() + dij.memorySize() + cij.memorySize();
+    n += m_aijRef.memorySize() + m_LURef.memorySize() + m_bijRef.memorySize() + m_dijRef.memorySize();
+    n += m_UpdateVt.memorySize() + m_UpdateZ.memorySize() + m_UpdateK.memorySize();
+    for(int k=0; k<4; k++) n += vm[k].memorySize();
+    return n;
+}
@@ -39,8 +39,12 @@ See http://raphael.mit.edu/xfoil for more information.
 */
 
 
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <complex>
+#include <memory>
+#include <vector>
 
 
 #include <xfoil-lib_global.h>
@@ -68,6 +72,67 @@ struct blData
 
 
 
+/**
+ * A row-major 2d array sized to the current foil, indexed as a[i][j] like the fixed-size arrays which it replaces.
+ * The storage is only reallocated when the dimensions change.
+ * Copies share the storage until one of them is written to, so that the XFoil instances copied
+ * from a prepared foil do not duplicate the matrices which they only read.
+ */
+class XFoilMatrix
+{
+    public:
+        XFoilMatrix() : m_pData(std::make_shared<std::vector<double>>()) {}
+        XFoilMatrix(XFoilMatrix const &m) {*this = m;}
+        XFoilMatrix &operator=(XFoilMatrix const &m)
+        {
+            m_nRows = m.m_nRows;
+            m_nCols = m.m_nCols;
+            m_pData = m.m_pData;
+            m_bShared = true;
+            if(!m.m_bShared) m.m_bShared = true; // set once, so that concurrent copies of a shared source only read the flag
+            return *this;
+        }
+
+        void resize(int nRows, int nCols)
+        {
+            if(nRows==m_nRows && nCols==m_nCols) return;
+            m_nRows = nRows;
+            m_nCols = nCols;
+            m_pData = std::make_shared<std::vector<double>>(size_t(nRows)*size_t(nCols), 0.0);
+            m_bShared = false;
+        }
+        void clear()
+        {
+            if(m_bShared)
+            {
+                m_pData = std::make_shared<std::vector<double>>(m_pData->size(), 0.0);
+                m_bShared = false;
+            }
+            else std::fill(m_pData->begin(), m_pData->end(), 0.0);
+        }
+
+        int rows() const {return m_nRows;}
+        int cols() const {return m_nCols;}
+        size_t memorySize() const {return m_pData->size()*sizeof(double);}
+
+        double *operator[](int i) {if(m_bShared) detach(); return m_pData->data()+size_t(i)*size_t(m_nCols);}
+        double const *operator[](int i) const {return m_pData->data()+size_t(i)*size_t(m_nCols);}
+
+    private:
+        void detach()
+        {
+            if(m_pData.use_count()>1) m_pData = std::make_shared<std::vector<double>>(*m_pData);
+            m_bShared = false;
+        }
+
+    private:
+        int m_nRows{0};
+        int m_nCols{0};
+        std::shared_ptr<std::vector<double>> m_pData;
+        mutable bool m_bShared{false};
+};
+
+
 class XFOILLIBSHARED_EXPORT XFoil
 {
     public:
@@ -91,10 +156,12 @@ class XFOILLIBSHARED_EXPORT XFoil
         void ExecMDES();
         bool ExecQDES();
         bool initialize();
+        size_t memoryFootprint() const;
         bool initXFoilGeometry(int fn, const double *fx, const double *fy, double *fnx, double *fny,
                                bool bFLap=false, double xhinge=0.0, double yhinge=0.0);
         bool initXFoilAnalysis(double Re, double alpha, double Mach, double NCrit, double XtrTop, double XtrBot,
                                int reType, int maType, bool bViscous);
+        bool prepareInviscid();
 
         void splqsp(int kqsp);
         void qspcir();
@@ -136,6 +203,25 @@ class XFOILLIBSHARED_EXPORT XFoil
         double ClSpec() const {return clspec;}
         void setClSpec(double cl) {clspec=cl;}
 
+        /** the residuals of the last Newton step of the BL */
+        double BLRmsChange()    const {return rmsbl;}
+        double BLMaxChange()    const {return rmxbl;}
+        int BLMaxChangeStation() const {return imxbl;}
+        int BLMaxChangeSide()   const {return ismxbl;}
+        double BLRelaxation()   const {return rlx;}
+
+
+        /** the run settings of this instance, initialized from the process-wide defaults */
+        double runVAccel() const {return m_VAccel;}
+        void setRunVAccel(double accel) {m_VAccel=accel;}
+        bool bRunFullReport() const {return m_bFullReport;}
+        void setRunFullReport(bool bFull) {m_bFullReport=bFull;}
+
+        /** The token is shared with the owner of the run, which may set it from any thread to stop
+         *  this instance only; the static flag still cancels all the instances. */
+        void setCancelToken(std::shared_ptr<std::atomic<bool>> const &pToken) {m_pCancelToken=pToken;}
+        std::shared_ptr<std::atomic<bool>> const &cancelToken() const {return m_pCancelToken;}
+        bool bRunCancelled() const {return s_bCancel || (m_pCancelToken && m_pCancelToken->load());}
 
         static bool isCancelled() {return s_bCancel;}
         static void setCancel(bool bCancel) {s_bCancel=bCancel;}
@@ -143,6 +229,15 @@ class XFOILLIBSHARED_EXPORT XFoil
         static bool bFullReport() {return s_bFullReport;}
         static double VAccel() {return vaccel;}
         static void setVAccel(double accel) {vaccel=accel;}
+        /** In low-rank update mode, a geometry with the same node count as the last factorized one, e.g. the same foil
+         *  with a different flap deflection, updates the factorization of aij and the source influences of dij
+         *  for the rows and columns which have changed instead of rebuilding them */
+        static void setLowRankUpdate(bool bUpdate) {s_bLowRankUpdate=bUpdate;}
+        static bool bLowRankUpdate() {return s_bLowRankUpdate;}
+        /** Sets the max. rank of the update as a fraction of the system size, above which the matrix is refactorized */
+        static void setMaxUpdateFraction(double fraction) {s_MaxUpdateFraction=fraction;}
+        /** @return true if the current factorization was obtained by low-rank update of the reference factorization */
+        bool bUpdatedFactorization() const {return m_bAijUpdate;}
 
     private:
 
@@ -162,6 +257,8 @@ class XFOILLIBSHARED_EXPORT XFoil
         void zlefind(std::complex<double>*zle, std::complex<double>zc[],double wc[],int nc, std::complex<double>piq[], double agte);
         void piqsum();
         void ftp();
+        void fftCircle(std::complex<double> *a, int sign);
+        void setZcFactors();
         void scinit(int n, double x[], double xp[], double y[], double yp[], double s[], double sle);
         void mapgen(int n, double x[],double y[]);
 
@@ -197,7 +294,8 @@ class XFOILLIBSHARED_EXPORT XFoil
                     double acrit, double &ax,
                     double &ax_hk1, double &ax_t1, double &ax_rt1, double &ax_a1,
                     double &ax_hk2, double &ax_t2, double &ax_rt2, double &ax_a2);
-        bool baksub(int n, double a[IQX][IQX],int indx[], double b[]);
+        bool baksub(int n, XFoilMatrix const &a, int indx[], double b[]);
+        bool baksub(int n, XFoilMatrix const &a, int const indx[], XFoilMatrix &b, int j0, int nrhs);
         bool bldif(int ityp);
         bool blkin();
         bool blmid(int ityp);
@@ -218,7 +316,7 @@ class XFOILLIBSHARED_EXPORT XFoil
 
         bool gamqv();
         bool Gauss(int nn, double z[][6], double r[5]);
-        bool Gauss(int nn, double z[IQX][IQX], double r[IQX]);
+        bool Gauss(int nn, XFoilMatrix &z, double r[IQX]);
         bool geopar(double x[], double xp[], double y[], double yp[], double s[],
                    int n, double t[], double &sle, double &chord,
                    double &area, double &radle, double &angte,
@@ -236,6 +334,14 @@ class XFOILLIBSHARED_EXPORT XFoil
         void sortol(double tol,int &kk,double s[],double w[]);
         bool getxyf(double x[],double xp[],double y[],double yp[],double s[], int n, double &tops, double &bots,double xf,double &yf);
         bool ggcalc();
+        bool aijSolve(double b[]);
+        bool aijSolve(XFoilMatrix &b, int j0, int nrhs);
+        void storeReferenceAij();
+        bool updateAijFactorization(int &rank);
+        void applyAijUpdate(double *b, size_t stride, int nrhs);
+        bool updateSourceInfluence();
+        int lowRankDifference(int nrows, int ncols, XFoilMatrix const &a, XFoilMatrix const &a0, int maxrank,
+                              XFoilMatrix &U, XFoilMatrix &Vt) const;
         bool hct(double hk, double msq, double &hc, double &hc_hk, double &hc_msq);
         bool hkin(double h, double msq, double &hk, double &hk_h, double &hk_msq);
         bool hsl(double hk, double &hs, double &hs_hk, double &hs_rt, double &hs_msq);
@@ -244,7 +350,7 @@ class XFOILLIBSHARED_EXPORT XFoil
         bool iblsys();
         bool lefind(double &sle, double x[], double xp[], double y[], double yp[], double s[], int n);
         void lerscl(double *x, double *xp, double* y, double *yp, double *s, int n, double doc, double rfac, double *xnew,double *ynew);
-        bool ludcmp(int n, double a[IQX][IQX],int indx[IQX]);
+        bool ludcmp(int n, XFoilMatrix &a, int indx[IQX]);
         bool mhinge();
         bool mrchdu();
         bool mrchue();
@@ -252,6 +358,7 @@ class XFOILLIBSHARED_EXPORT XFoil
         bool psilin(int i, double xi,double yi,double nxi, double nyi, double &psi, double &psi_ni, bool geolin, bool siglin);
         bool pswlin(int i,double xi, double yi, double nxi, double nyi, double &psi, double &psi_ni);
         bool qdcalc();
+        bool dijcalc();
         bool qiset();
         bool qvfue();
         bool qwcalc();
@@ -261,6 +368,7 @@ class XFOILLIBSHARED_EXPORT XFoil
         bool setbl();
         bool setexp(double s[],double ds1,double smax,int nn);
         bool sinvrt(double &si,double xi,double x[],double xs[],double s[],int n);
+        void sizeArrays();
 
         void splina(double x[], double xs[], double s[], int n);
         bool splind(double *x, double *xs, double *s, int n, double xs1, double xs2);
@@ -288,12 +396,18 @@ class XFOILLIBSHARED_EXPORT XFoil
 
 
     public:
-        static double vaccel;
-        static bool s_bCancel;
-        static bool s_bFullReport;
+        static double vaccel;                 /**< the default drop tolerance for new instances */
+        static std::atomic<bool> s_bCancel;   /**< cancels all the instances */
+        static bool s_bFullReport;            /**< the default report level for new instances */
+        static bool s_bLowRankUpdate;
+        static double s_MaxUpdateFraction;    /**< the max. rank of the low-rank update, as a fraction of the system size */
 
         std::string m_Report;
 
+        double m_VAccel;
+        bool m_bFullReport;
+        std::shared_ptr<std::atomic<bool>> m_pCancelToken;
+
         double agte,ag0,qim0,qimold;
         double ssple, dwc,algam,clgam,cmgam;
         double clspec;
@@ -367,6 +481,17 @@ class XFOILLIBSHARED_EXPORT XFoil
         std::complex<double> zc[ICX+1], zc_cn[ICX+1][IMX4+1];
         std::complex<double> cnsav[IMX+1];
 
+        /** the radix-2 FFT of the circle-plane sums of ftp() and piqsum(), set up by eiwset() when nc-1 is a power of 2 */
+        bool m_bFFT;
+        int m_FFTBitRev[ICX];
+        std::complex<double> m_FFTTwiddle[ICX], m_FFTWork[ICX];
+
+        /** the factors [2 sin(w/2)]^(1-agte) exp(i hwc) of z'(w), which only depend on the circle-plane points
+         *  and on the TE angle; cached for zccalc() until either changes */
+        std::complex<double> m_ZcFactor[ICX+1];
+        int m_ZcFactorNc;
+        double m_ZcFactorAgte;
+
         int retyp, matyp;
         double rlx;
 
@@ -446,11 +571,31 @@ class XFOILLIBSHARED_EXPORT XFoil
     //    double sigte_a,gamte_a;
         double dste,aste;
         double qinv[IZX],qinvu[IZX][3], qinv_a[IZX];
-        double q[IQX][IQX],dq[IQX],dzdg[IQX],dzdn[IQX],dzdm[IZX],dqdg[IQX];
+        XFoilMatrix q;
+        double dq[IQX],dzdg[IQX],dzdn[IQX],dzdm[IZX],dqdg[IQX];
         double dqdm[IZX],qtan1,qtan2,z_qinf,z_alfa,z_qdof0,z_qdof1,z_qdof2,z_qdof3;
-        double aij[IQX][IQX];
-        double bij[IQX][IZX],dij[IZX][IZX];
-        double cij[IWX][IQX];
+        // the large influence matrices are sized to the foil's node count in sizeArrays(); the dimensions are at most IQX, IZX and IWX
+        XFoilMatrix aij;       /**< [IQX][IQX] */
+        XFoilMatrix bij;       /**< [IQX][IZX] */
+        XFoilMatrix dij;       /**< [IZX][IZX] */
+        XFoilMatrix cij;       /**< [IWX][IQX] */
+
+        // low-rank update of the factorization of aij: A = A0 + U.Vt, with U.Vt the cross approximation of A-A0
+        XFoilMatrix m_aijRef;  /**< the reference matrix A0 before factorization */
+        XFoilMatrix m_LURef;   /**< the LU factors of A0 while aij holds the matrix of the new geometry; the pivots are in aijpiv */
+        XFoilMatrix m_bijRef;  /**< the surface source influences B0 of the reference geometry before back-substitution */
+        XFoilMatrix m_dijRef;  /**< A0^-1.B0, including the row of psio */
+        std::vector<double> m_xRef, m_yRef;  /**< the nodes of the reference geometry */
+        std::vector<unsigned char> m_PanelMask;  /**< the panels evaluated by psilin() in the partial assembly of aij and bij */
+        bool m_bMaskPanels;              /**< true if psilin() skips the panels which are not in m_PanelMask */
+        int m_nRef;                      /**< the size n+1 of the reference system, 0 if none */
+        bool m_bDijRef;                  /**< true if m_dijRef holds A0^-1.B0 */
+        bool m_bAijUpdate;               /**< true if the factorization of aij is that of A0 corrected by the update */
+        int m_UpdateRank;                /**< the rank of the update, i.e. the number of columns of U */
+        XFoilMatrix m_UpdateVt;          /**< the rows of Vt, 1 to m_UpdateRank */
+        XFoilMatrix m_UpdateZ;           /**< A0^-1.U, columns 1 to m_UpdateRank */
+        XFoilMatrix m_UpdateK;           /**< the LU factors of the capacitance matrix I+Vt.A0^-1.U */
+        std::vector<int> m_UpdatePiv;    /**< the pivot indices of the capacitance matrix */
         double hopi,qopi;
 
 
@@ -491,7 +636,8 @@ class XFOILLIBSHARED_EXPORT XFoil
         double cfm, cfm_ms, cfm_re, cfm_u1, cfm_t1, cfm_d1, cfm_u2, cfm_t2, cfm_d2;
         double xt, xt_a1, xt_ms, xt_re, xt_xf, xt_x1, xt_t1, xt_d1, xt_u1,
               xt_x2, xt_t2, xt_d2, xt_u2;
-        double va[4][3][IZX],vb[4][3][IZX],vdel[4][3][IZX],vm[4][IZX][IZX],vz[4][3];
+        double va[4][3][IZX],vb[4][3][IZX],vdel[4][3][IZX],vz[4][3];
+        XFoilMatrix vm[4];     /**< [4][IZX][IZX], indexed vm[k][equation][variable] so that the BL solver works on contiguous rows; vm[0] is unused */
 
     //    int ncpref, napol[9], npol, ipact, nlref, icolp[9],icolr[9],imatyp[9],iretyp[9], nxypol[9],npolref, ndref[4][9];
     //    double c1sav[74], c2sav[74];
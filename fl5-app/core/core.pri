@@ -12,6 +12,7 @@ HEADERS += \
     $$PWD/displayoptions.h \
     $$PWD/enums_core.h \
     $$PWD/fontstruct.h \
+    $$PWD/imagewriter.h \
     $$PWD/saveoptions.h \
     $$PWD/stlreaderdlg.h \
     $$PWD/xflcore.h \
@@ -20,6 +21,7 @@ HEADERS += \
 
 SOURCES += \
     $$PWD/displayoptions.cpp \
+    $$PWD/imagewriter.cpp \
     $$PWD/saveoptions.cpp \
     $$PWD/stlreaderdlg.cpp \
     $$PWD/xflcore.cpp \
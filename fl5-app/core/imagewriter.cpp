@@ -0,0 +1,89 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+
+#include "imagewriter.h"
+
+
+ImageWriter::ImageWriter(int maxPending)
+{
+    m_MaxPending = std::max(1, maxPending);
+    m_bFinished = false;
+    m_nWritten = m_nErrors = 0;
+    m_Thread = std::thread(&ImageWriter::run, this);
+}
+
+
+ImageWriter::~ImageWriter()
+{
+    finish();
+}
+
+
+/**
+ * Queues the image for writing. The format is deduced from the file's extension.
+ * Blocks if the maximum number of pending images has been reached.
+ */
+void ImageWriter::write(QImage const &img, QString const &pathname)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Condition.wait(lock, [this]{return int(m_Queue.size())<m_MaxPending;});
+    m_Queue.push_back({img, pathname});
+    m_Condition.notify_all();
+}
+
+
+/** Writes the pending images and stops the thread. */
+void ImageWriter::finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_bFinished = true;
+    }
+    m_Condition.notify_all();
+    if(m_Thread.joinable()) m_Thread.join();
+}
+
+
+void ImageWriter::run()
+{
+    while(true)
+    {
+        std::pair<QImage, QString> job;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Condition.wait(lock, [this]{return m_bFinished || !m_Queue.empty();});
+            if(m_Queue.empty()) return; // finished and nothing left to write
+            job = std::move(m_Queue.front());
+            m_Queue.pop_front();
+        }
+        m_Condition.notify_all(); // room in the queue
+
+        if(job.first.save(job.second)) m_nWritten++;
+        else                           m_nErrors++;
+    }
+}
+
@@ -0,0 +1,71 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <QImage>
+#include <QString>
+
+
+/**
+ * @class ImageWriter
+ * @brief Encodes and saves images on a background thread.
+ *
+ * Used by the batch exports so that the rendering of the next image overlaps with the
+ * compression and the disk I/O of the previous ones. The queue is bounded so that a slow
+ * disk cannot accumulate an unlimited number of images in memory.
+ */
+class ImageWriter
+{
+    public:
+        ImageWriter(int maxPending=8);
+        ~ImageWriter();
+
+        void write(QImage const &img, QString const &pathname);
+        void finish();
+
+        int nWritten() const {return m_nWritten;}
+        int nErrors()  const {return m_nErrors;}
+
+    private:
+        void run();
+
+    private:
+        std::thread m_Thread;
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        std::deque<std::pair<QImage, QString>> m_Queue;
+
+        int m_MaxPending;
+        bool m_bFinished;
+        int m_nWritten;
+        int m_nErrors;
+};
+
@@ -23,6 +23,8 @@
 *****************************************************************************/
 
 
+#include <algorithm>
+
 #include <QDir>
 #include <QDirIterator>
 #include <QTime>
@@ -31,6 +33,7 @@
 #include "saveoptions.h"
 
 #include <api/fileio.h>
+#include <api/opp3d.h>
 #include <api/trace.h>
 
 xfl::enumTextFileType SaveOptions::s_ExportFileType;  /**< Defines if the list separator for the output text files should be a space or a comma. */
@@ -101,6 +104,8 @@ void SaveOptions::loadSettings(QSettings &settings)
         FileIO::saveOpps(  settings.value("SaveOpps",            FileIO::bOpps()).toBool());
         FileIO::savePOpps( settings.value("SavePOpps",           FileIO::bPOpps()).toBool());
         FileIO::saveBtOpps(settings.value("SaveBtOpps",          FileIO::bBtOpps()).toBool());
+        Opp3d::setFieldStorage(Opp3d::enumFieldStorage(std::clamp(settings.value("OppFieldStorage", int(Opp3d::fieldStorage())).toInt(), 0, 2)));
+        Opp3d::setWakeStorage(Opp3d::enumWakeStorage(std::clamp(settings.value("OppWakeStorage", int(Opp3d::wakeStorage())).toInt(), 0, 2)));
 
         int k = settings.value("ExportFormat", 0).toInt();
         if(k) s_ExportFileType = xfl::CSV;
@@ -140,6 +145,8 @@ void SaveOptions::saveSettings(QSettings &settings)
         settings.setValue("SaveOpps",            FileIO::bOpps());
         settings.setValue("SavePOpps",           FileIO::bPOpps());
         settings.setValue("SaveBtOpps",          FileIO::bBtOpps());
+        settings.setValue("OppFieldStorage",     int(Opp3d::fieldStorage()));
+        settings.setValue("OppWakeStorage",      int(Opp3d::wakeStorage()));
 
         if(s_ExportFileType==xfl::TXT) settings.setValue("ExportFormat", 0);
         else                           settings.setValue("ExportFormat", 1);
@@ -163,6 +163,7 @@ void StlReaderDlg::onImportFromStlFile()
     if(m_bIsRunning)
     {
         m_bCancel = true;
+        m_StlReader.cancel();
         return;
     }
 
@@ -221,62 +222,17 @@ void StlReaderDlg::postMessageEvent(QString const &msg)
 
 bool StlReaderDlg::importTrianglesFromStlFile(QString const &FileName, double unitfactor)
 {
-    QFile stlfile(FileName);
-    if (!stlfile.open(QIODevice::ReadOnly))
-    {
-        postMessageEvent("Unable to open the file:" + FileName + "\n");
-        return false;
-    }
     QApplication::setOverrideCursor(Qt::BusyCursor);
 
     std::vector<Triangle3d> triangles;
+    bool bSuccess = m_StlReader.readFile(FileName.toStdString(), unitfactor, triangles);
 
-    QString solidname;
-
-    //Try the text format first
-    bool bText=true;
-    QTextStream textstream(&stlfile);
-    QString strong = textstream.readLine(80);
-    if(textstream.status()!=QTextStream::Ok)
-    {
-        bText=false;
-    }
-    else
+    if(bSuccess)
     {
-        if(strong.contains("solid"))
-        {
-            // continue testing, some binary STL files use 'solid' keyword in header
-            strong = textstream.readLine(80);
-            int pos = strong.indexOf("facet", Qt::CaseInsensitive);
-            if(pos<0)
-            {
-                bText = false;
-            }
-        }
-        else bText=false;
+        if(m_StlReader.isText()) postMessageEvent("\nImported from a text file\n\n");
+        else                     postMessageEvent("\nImported from a binary file\n\n");
     }
-    textstream.seek(0);
-
-    bool bSuccess = false;
-    if(bText)
-    {
-        postMessageEvent("\nImporting from a text file\n\n");
-        bSuccess = importStlTextFile(textstream, unitfactor, triangles, solidname);
-    }
-    else
-    {
-        postMessageEvent("\nImporting from a binary file\n\n");
-        //Try the binary format
-        QDataStream inStream(&stlfile);
-        inStream.setByteOrder(QDataStream::LittleEndian);
-        //    uint u = inStream.byteOrder();
-
-        bSuccess = importStlBinaryFile(inStream, unitfactor, triangles, solidname);
-    }
-
-    stlfile.close();
-
-
+    postMessageEvent(QString::fromStdString(m_StlReader.log()));
 
     if(!bSuccess || m_bCancel)
     {
@@ -285,305 +241,41 @@ bool StlReaderDlg::importTrianglesFromStlFile(QString const &FileName, double un
         m_Triangle.clear();
         m_bIsRunning = false;
         m_ppbImport->setText("Import file");
+        QApplication::restoreOverrideCursor();
         return bSuccess;
     }
 
-    m_Triangle = triangles;
-
-    m_ppbImport->setText("Import file");
-    m_bIsRunning = false;
-    m_bCancel = false;
-
-    QApplication::restoreOverrideCursor();
-    return bSuccess;
-}
-
-
-bool StlReaderDlg::importStlBinaryFile(QDataStream &binstream, double unitfactor, std::vector<Triangle3d> &trianglelist,
-                                       QString &solidname)
-{
-    QString strong;
-    qint8  ch=0;
-    strong.clear();
-    solidname = "STL_binary_solid";
-    //80 character header, avoid word "solid"
-    //                       0123456789 123456789 123456789 123456789 123456789 123456789 123456789 123456789
-    for(int j=0; j<80;j++)
-    {
-        strong += " ";
-        binstream >> ch;
-        strong[j] = char(ch);
-    }
-
-    int nTriangles=0;
-    binstream >> nTriangles;
-
-    trianglelist.reserve(nTriangles);
-
-    Vector3d N, v[3];
-    float xmin=LARGEVALUE, xmax=-LARGEVALUE;
-    float ymin=LARGEVALUE, ymax=-LARGEVALUE;
-    float zmin=LARGEVALUE, zmax=-LARGEVALUE;
-    float x=0, y=0, z=0;
-    float nx=0, ny=0, nz=0;
-    char buffer[12];
-    int nNegTriangles=0;
-
-    for (int j=0; j<nTriangles; j++)
-    {
-        // the normal
-        xfl::readFloat(binstream, nx);
-        xfl::readFloat(binstream, ny);
-        xfl::readFloat(binstream, nz);
-        N.set(double(nx), double(ny), double(nz));
-
-        for(int iv=0; iv<3; iv++)
-        {
-            //vertex 0
-            xfl::readFloat(binstream, x);
-            xfl::readFloat(binstream, y);
-            xfl::readFloat(binstream, z);
-            x *= float(unitfactor);
-            y *= float(unitfactor);
-            z *= float(unitfactor);
-            xmin = std::min(x,xmin);   xmax = std::max(x,xmax);
-            ymin = std::min(y,ymin);   ymax = std::max(y,ymax);
-            zmin = std::min(z,zmin);   zmax = std::max(z,zmax);
-            v[iv].set(double(x), double(y), double(z));
-
-        }
-
-        trianglelist.push_back({v[0], v[1], v[2]});
-        Triangle3d &t3d = trianglelist.back();
-        if(t3d.normal().dot(N)<.0)
-        {
-            // re-order vertices to have a positive oriented triangle
-            Vector3d tmp = t3d.vertexAt(1);
-            t3d.setVertex(1, t3d.vertexAt(2));
-            t3d.setVertex(2, tmp);
-            t3d.setTriangle();
-
-            nNegTriangles++;
-        }
-
-        t3d.setNormal(N);
-
-        //add, then remove if nullptr; this avoids double construction
-/*        if(t3d.isNull())
-        {
-            trianglelist.pop_back();
-            nNullTriangles++;
-        }*/
-
-        //        trianglelist.back().displayNodes("BNodes==");
-        binstream.readRawData(buffer, 2);
-
-        if(j%1000==0)
-        {
-            QString strange;
-            strange = QString::asprintf("   imported %d triangles\n", int(trianglelist.size()-1));
-            postMessageEvent(strange);
-            
-            if(m_bCancel)
-                return false;
-        }
-    }
-
-    QString logmsg;
-    strong = QString::asprintf("Read %d STL triangles, made %d panels\n", nTriangles, int(trianglelist.size()));
-    logmsg+=strong;
-    strong = QString::asprintf("Reordered vertices of %d inverted triangles\n", nNegTriangles);
-    logmsg+=strong;
-
+    QString strong, logmsg;
+    strong = QString::asprintf("Read %d STL triangles\n", int(triangles.size()));
+    logmsg += strong;
+    strong = QString::asprintf("Reordered vertices of %d inverted triangles\n", m_StlReader.nInverted());
+    logmsg += strong;
 
+    Vector3d const &bmin = m_StlReader.boxMin();
+    Vector3d const &bmax = m_StlReader.boxMax();
     logmsg += "\nBounding box:\n";
 
-    strong  = QString::asprintf("   xmin=%13g ", xmin*Units::mtoUnit() ) + Units::lengthUnitQLabel();
-    strong += QString::asprintf("   xmax=%13g ", xmax*Units::mtoUnit() ) + Units::lengthUnitQLabel() + EOLch;
+    strong  = QString::asprintf("   xmin=%13g ", bmin.x*Units::mtoUnit() ) + Units::lengthUnitQLabel();
+    strong += QString::asprintf("   xmax=%13g ", bmax.x*Units::mtoUnit() ) + Units::lengthUnitQLabel() + EOLch;
     logmsg += strong;
 
-    strong  = QString::asprintf("   ymin=%13g ", ymin*Units::mtoUnit() ) + Units::lengthUnitQLabel();
-    strong += QString::asprintf("   ymax=%13g ", ymax*Units::mtoUnit() ) + Units::lengthUnitQLabel() + EOLch;
+    strong  = QString::asprintf("   ymin=%13g ", bmin.y*Units::mtoUnit() ) + Units::lengthUnitQLabel();
+    strong += QString::asprintf("   ymax=%13g ", bmax.y*Units::mtoUnit() ) + Units::lengthUnitQLabel() + EOLch;
     logmsg += strong;
 
-    strong  = QString::asprintf("   zmin=%13g ", zmin*Units::mtoUnit() ) + Units::lengthUnitQLabel();
-    strong += QString::asprintf("   zmax=%13g ", zmax*Units::mtoUnit() ) + Units::lengthUnitQLabel() + EOLch;
+    strong  = QString::asprintf("   zmin=%13g ", bmin.z*Units::mtoUnit() ) + Units::lengthUnitQLabel();
+    strong += QString::asprintf("   zmax=%13g ", bmax.z*Units::mtoUnit() ) + Units::lengthUnitQLabel() + EOLch;
     logmsg += strong + EOLch;
 
-
     postMessageEvent(logmsg+"\n");
-    return true;
-}
 
+    m_Triangle = std::move(triangles);
 
-bool StlReaderDlg::importStlTextFile(QTextStream &textstream, double unitfactor, std::vector<Triangle3d> &trianglelist,
-                                     QString &solidname)
-{
-    QString strong;
-    int iLine=-1;
-    //header
-    do
-    {
-        strong = textstream.readLine();
-        postMessageEvent(strong+"\n");
-        iLine++;
-    }
-    while(!strong.length());
-
-    if(!strong.contains("solid", Qt::CaseInsensitive))
-    {
-        postMessageEvent("Error reading header: keyword \'solid\' not found");
-        return false;
-    }
-    
-    solidname = strong.replace("solid", "").trimmed();
-
-    double xmin=LARGEVALUE, xmax=-LARGEVALUE;
-    double ymin=LARGEVALUE, ymax=-LARGEVALUE;
-    double zmin=LARGEVALUE, zmax=-LARGEVALUE;
-    Vector3d v[3], N;
-    double x=0,y=0,z=0;
-    double nx=0, ny=0, nz=0;
-    int nTriangles=0;
-    int nNegTriangles = 0;
-
-    QString log;
-    while(!textstream.atEnd())
-    {
-        strong = textstream.readLine();
-        iLine++;
-        if(textstream.status() != QTextStream::Ok)
-        {
-            log = QString::asprintf("Unknown error reading line %d", iLine);
-            postMessageEvent(log);
-            return false;
-        }
-
-        if(strong.contains("endsolid", Qt::CaseInsensitive)) break;
-
-        if(strong.contains("facet", Qt::CaseInsensitive) && strong.contains("normal", Qt::CaseInsensitive))
-        {
-            //read a triangle
-            strong.replace("facet","");
-            strong.replace("normal","");
-            strong.replace("FACET","");
-            strong.replace("NORMAL","");
-            strong = strong.trimmed();
-            if(xfl::readValues(strong,nx,ny,nz)==3)
-            {
-                strong = textstream.readLine();
-                iLine++;
-                if(strong.contains("outer", Qt::CaseInsensitive) && strong.contains("loop", Qt::CaseInsensitive))
-                {
-                    for(int iv=0; iv<3; iv++)
-                    {
-                        strong = textstream.readLine();
-                        iLine++;
-                        if(strong.contains("vertex", Qt::CaseInsensitive))
-                        {
-                            strong = strong.replace("vertex","").trimmed();
-                            if(xfl::readValues(strong,x,y,z)==3)
-                            {
-                                x*=unitfactor;
-                                y*=unitfactor;
-                                z*=unitfactor;
-                                xmin = std::min(x,xmin);   xmax = std::max(x,xmax);
-                                ymin = std::min(y,ymin);   ymax = std::max(y,ymax);
-                                zmin = std::min(z,zmin);   zmax = std::max(z,zmax);
-                                v[iv].set(x,y,z);
-                            }
-                            else
-                            {
-                                log = QString::asprintf("Error reading triangles: could not read 3 values on line %d", iLine);
-                                return false;
-                            }
-                        }
-                        else
-                        {
-                            log = QString::asprintf("Error reading triangles: keyword \'vertex\' not found on line %d", iLine);
-                            return false;
-                        }
-                    }
-                    strong = textstream.readLine();
-                    iLine++;
-                    if(!strong.contains("endloop", Qt::CaseInsensitive))
-                    {
-                        log = QString::asprintf("Error reading triangles: keyword \'endloop\' not found on line %d", iLine);
-                        return false;
-                    }
-                }
-                else
-                {
-                    log = QString::asprintf("Error reading triangles: keyword \'outer loop\' not found on line %d", iLine);
-                    return false;
-                }
-            }
-        }
-        else
-        {
-            log = QString::asprintf("Error reading triangles: keyword \'facet\' not found on line %d", iLine);
-            return false;
-        }
-        strong = textstream.readLine();
-        if(!strong.contains("endfacet", Qt::CaseInsensitive))
-        {
-            log = QString::asprintf("Error reading triangles: keyword \'endfacet\' not found on line %d", iLine);
-            return false;
-        }
-
-        trianglelist.push_back({v[0], v[1], v[2]});
-        Triangle3d &t3d = trianglelist.back();
-        N.set(nx,ny,nz);
-        if(t3d.normal().dot(N)<.0)
-        {
-            // re-order vertices to have a positive oriented triangle
-            Vector3d tmp = t3d.vertexAt(1);
-            t3d.setVertex(1, t3d.vertexAt(2));
-            t3d.setVertex(2, tmp);
-            t3d.setTriangle();
-
-            nNegTriangles++;
-        }
-        t3d.setNormal(N);
-        nTriangles++;
-/*        if(trianglelist.back().isNull())
-        {
-            nullsize++;
-            trianglelist.pop_back();
-        }*/
-        iLine++;
-        if(iLine%1000==0)
-        {
-            QString strange;
-            strange = QString::asprintf("   imported %d triangles\n", int(trianglelist.size())-1);
-            postMessageEvent(strange);
-            
-            if(m_bCancel) return false;
-        }
-    }
-
-    log = QString::asprintf("Read %d STL triangles successfully\n", nTriangles);
-    strong = QString::asprintf("Reordered vertices of %d inverted triangles\n", nNegTriangles);
-    log+=strong;
-
-    strong = QString::asprintf("Final triangle count is %d\n\n", int(trianglelist.size()));
-    log += strong;
-
-    log += "Bounding box:\n";
-
-    strong  = QString::asprintf("   xmin=%13g ", xmin*Units::mtoUnit() ) + Units::lengthUnitQLabel();
-    strong += QString::asprintf("   xmax=%13g ", xmax*Units::mtoUnit() ) + Units::lengthUnitQLabel() + EOLch;
-    log += strong;
-
-    strong  = QString::asprintf("   ymin=%13g ", ymin*Units::mtoUnit() ) + Units::lengthUnitQLabel();
-    strong += QString::asprintf("   ymax=%13g ", ymax*Units::mtoUnit() ) + Units::lengthUnitQLabel() + EOLch;
-    log += strong;
-
-    strong  = QString::asprintf("   zmin=%13g ", zmin*Units::mtoUnit() ) + Units::lengthUnitQLabel();
-    strong += QString::asprintf("   zmax=%13g ", zmax*Units::mtoUnit() ) + Units::lengthUnitQLabel() + EOLch;
-    log += strong + EOLch;
+    m_ppbImport->setText("Import file");
+    m_bIsRunning = false;
+    m_bCancel = false;
 
-    postMessageEvent(log+"\n");
-    return true;
+    QApplication::restoreOverrideCursor();
+    return bSuccess;
 }
 
@@ -32,6 +32,7 @@
 #include <QComboBox>
 #include <QSettings>
 
+#include <api/stlreader.h>
 #include <api/triangle3d.h>
 
 class PlainTextOutput;
@@ -48,8 +49,6 @@ class StlReaderDlg : public QDialog
         std::vector<Triangle3d> const & triangleList() const {return m_Triangle;}
 
         bool importTrianglesFromStlFile(const QString &FileName, double unitfactor);
-        bool importStlBinaryFile(QDataStream &binstream, double unitfactor, std::vector<Triangle3d> &trianglelist, QString &solidname);
-        bool importStlTextFile(QTextStream &textstream, double unitfactor, std::vector<Triangle3d> &trianglelist, QString &solidname);
 
         static void loadSettings(QSettings &settings);
         static void saveSettings(QSettings &settings);
@@ -78,6 +77,7 @@ class StlReaderDlg : public QDialog
         QPushButton *m_ppbImport;
 
         std::vector<Triangle3d> m_Triangle;
+        StlReader m_StlReader;
         bool m_bCancel;
         bool m_bIsRunning;
 
@@ -263,12 +263,6 @@ QColor xfl::colour(QVector<QColor> const &clrs, float tau)
 }
 
 
-fl5Color xfl::randomfl5Color(bool bLightColor)
-{
-    return tofl5Clr(randomColor(bLightColor));
-}
-
-
 QColor xfl::randomColor(bool bLightColor)
 {
     QColor clr;
@@ -417,84 +411,3 @@ int xfl::readValues(QString const &theline, double &x, double &y, double &z)
 }
 
 
-/** from Qt examples WordCount
- * startDir = QDir::home().absolutePath()
- * filters = QStringList() << "*.cpp" << "*.h" ;
-*/
-QStringList xfl::findFiles(const QString &startDir, QStringList const &filters, bool bRecursive)
-{
-    QStringList names;
-    QDir dir(startDir);
-
-    for (QString const &file : dir.entryList(filters, QDir::Files))
-    {
-        names += startDir + '/' + file;
-    }
-
-    if(bRecursive)
-    {
-        for(QString const& subdir : dir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot))
-        {
-            names += findFiles(startDir + '/' + subdir, filters, bRecursive);
-        }
-    }
-
-    return names;
-}
-
-
-bool xfl::findFile(QString const &filename, QString const &startDir, QStringList const &filters, bool bRecursive, QString &filePathName)
-{
-    QDir dir(startDir);
-
-    for(QString const &file : dir.entryList(filters, QDir::Files))
-    {
-        if(file.compare(filename, Qt::CaseInsensitive)==0)
-        {
-            filePathName = startDir + '/' + file;
-            return true;
-        }
-    }
-
-    if(bRecursive)
-    {
-        for(QString const &subdir : dir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot))
-        {
-            if(findFile(filename, startDir + '/' + subdir, filters, bRecursive, filePathName))
-                return true;
-        }
-    }
-
-    return false;
-}
-
-
-/**
- * Reads one line from an AVL-format text file
- */
-bool xfl::readAVLString(QTextStream &in, int &Line, QString &strong)
-{
-    bool isCommentLine = true;
-    int pos=0;
-    if(in.atEnd()) return false;
-
-    while(isCommentLine && !in.atEnd())
-    {
-        isCommentLine = false;
-
-        strong = in.readLine();
-
-        strong = strong.trimmed();
-        pos = strong.indexOf("#",0);
-        if(pos>=0) strong = strong.left(pos);
-        pos = strong.indexOf("!",0);
-        if(pos>=0) strong = strong.left(pos);
-
-        if(strong.isEmpty()) isCommentLine = true;
-
-        Line++;
-    }
-
-    return true;
-}
-
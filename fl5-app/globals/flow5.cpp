@@ -62,6 +62,7 @@
 #include <globals/mainframe.h>
 #include <interfaces/opengl/views/gl3dview.h>
 #include <interfaces/script/xflscriptexec.h>
+#include <interfaces/script/xflworker.h>
 #include <interfaces/widgets/customdlg/objectpropsdlg.h>
 #include <interfaces/widgets/customwts/popup.h>
 #include <options/prefsdlg.h>
@@ -79,23 +80,34 @@ Flow5App::Flow5App(int &argc, char** argv) : QApplication(argc, argv)
     //    Version = QString::asprintf("v%d.%02d", MAJOR_VERSION, MINOR_VERSION);
     Flow5App::setApplicationVersion(QString::fromStdString(fl5::versionName(true)));
     setWindowIcon(QIcon(":/icons/f5.png"));
+    xfl::startupMark("Application constructed");
     /** usage
      * flow5 -h (--help)                   : help
      * flow5 -v (--version)                : version
      * flow5 -s (--script)  scriptFileName : run scriptFileName
      * flow5 -s -p (--script)  scriptFileName : run scriptFileName progress/verbose mode
      * flow5 -o (--ogl) version            : run the program with the specified OpenGL version
+     * flow5 -w (--worker)                 : run as a worker process of a distributed batch analysis
      * flow5 projectFileName.xfl           : run and open projectFileName.xfl
      * flow5                               : run the program
      */
 
     m_pMainFrame = nullptr;
 
-    bool bScript=false, bShowProgress=false;
+    bool bScript=false, bShowProgress=false, bWorker=false;
     QString scriptPathName;
     QString tracefilename = QDir::tempPath() + "/flow5_trace.log";
     int OGLversion = -1;
-    parseCmdLine(*this, scriptPathName, tracefilename, bScript, bShowProgress, OGLversion);
+    parseCmdLine(*this, scriptPathName, tracefilename, bScript, bShowProgress, bWorker, OGLversion);
+
+    m_ExitStatus = 0;
+    if(bWorker)
+    {
+        // headless: the request is read on stdin and the results are written on stdout
+        m_ExitStatus = XflWorker::runWorker();
+        m_bDone = true;
+        return;
+    }
 
 
     if(xfl::g_bTrace)
@@ -171,6 +183,7 @@ Flow5App::Flow5App(int &argc, char** argv) : QApplication(argc, argv)
     }
 
     m_pMainFrame->show();
+    xfl::startupMark("Main frame shown");
 
     if(xfl::g_bTrace)
     {
@@ -237,6 +250,8 @@ Flow5App::Flow5App(int &argc, char** argv) : QApplication(argc, argv)
     }
 #endif
 
+    xfl::startupMark("Initial project loaded");
+    m_pMainFrame->displayMessage(xfl::startupReport() + "\n", false);
     m_pMainFrame->displayMessage("Done app initialization\n\n", false);
 //    splash.finish(m_pMainFrame);
 
@@ -300,7 +315,7 @@ bool Flow5App::event(QEvent *pEvent)
 
 void Flow5App::parseCmdLine(Flow5App &fl5app,
                             QString &scriptfilename, QString &tracefilename,
-                            bool &bScript, bool &bShowProgress,
+                            bool &bScript, bool &bShowProgress, bool &bWorker,
                             int &OGLVersion) const
 {
     QCommandLineParser parser;
@@ -326,9 +341,16 @@ void Flow5App::parseCmdLine(Flow5App &fl5app,
 
     QCommandLineOption ScriptOption(QStringList() << "s" << "script");
     ScriptOption.setValueName("file");
-    ScriptOption.setDescription("Runs the script file");
+    ScriptOption.setDescription("Runs the script file. "
+                                "On a machine without display, add the option -platform offscreen "
+                                "to render the images requested by the script without showing the main window.");
     parser.addOption(ScriptOption);
 
+    QCommandLineOption WorkerOption(QStringList() << "w" << "worker");
+    WorkerOption.setDescription("Runs as a worker process of a distributed batch analysis; "
+                                "the request is read on the standard input and the results are written on the standard output.");
+    parser.addOption(WorkerOption);
+
     QCommandLineOption TraceOption(QStringList() << "t" << "trace");
     TraceOption.setValueName("file");
     TraceOption.setDefaultValue(QDir::tempPath() + "/flow5_trace.log");
@@ -340,6 +362,7 @@ void Flow5App::parseCmdLine(Flow5App &fl5app,
 
     bShowProgress = parser.isSet(ShowProgressOption);
     bScript = parser.isSet(ScriptOption);
+    bWorker = parser.isSet(WorkerOption);
     tracefilename = parser.value(TraceOption);
     scriptfilename = parser.value(ScriptOption);
 
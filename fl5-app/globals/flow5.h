@@ -34,12 +34,13 @@ class Flow5App : public QApplication
     public:
         Flow5App(int&, char**);
         bool done() const {return m_bDone;}
+        int exitStatus() const {return m_ExitStatus;}
 
     protected:
         bool event(QEvent *pEvent) override;
 
     private:
-        void parseCmdLine(Flow5App &app, QString &scriptFileName, QString &tracefilename, bool &bScript, bool &bShowProgress, int &OGLVersion) const;
+        void parseCmdLine(Flow5App &app, QString &scriptFileName, QString &tracefilename, bool &bScript, bool &bShowProgress, bool &bWorker, int &OGLVersion) const;
 
 
         void startTrace(const QString &filename);
@@ -47,6 +48,7 @@ class Flow5App : public QApplication
     private:
         MainFrame *m_pMainFrame;
         bool m_bDone;
+        int m_ExitStatus;  /**< the exit code of the process if the app is done at construction */
 };
 
 
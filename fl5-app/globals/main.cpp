@@ -34,6 +34,7 @@
 
 //#include <sys/resource.h>
 #include "flow5.h"
+#include <api/trace.h>
 #include <interfaces/opengl/views/gl3dview.h>
 
 void customLogHandler(QtMsgType type, const QMessageLogContext& context, const QString& msg)
@@ -139,6 +140,8 @@ int main(int argc, char *argv[])
     //QLoggingCategory::setFilterRules(QStringLiteral("flow5.debug = true"));
     //QLoggingCategory::defaultCategory()->setEnabled(QtDebugMsg, true);
 
+    xfl::startupMark("Entered main");
+
     qInstallMessageHandler(&customLogHandler);
 
 
@@ -165,12 +168,13 @@ int main(int argc, char *argv[])
         }
     }
     setOGLDefaultFormat(version);
+    xfl::startupMark("OpenGL default format set");
 
     Flow5App app(argc, argv);
     Flow5App::setApplicationDisplayName("flow5");
 
 
-    if(app.done()) return 0;
+    if(app.done()) return app.exitStatus();
     else           return app.exec();
 }
 
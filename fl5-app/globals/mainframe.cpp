@@ -24,6 +24,8 @@
 
 #define _MATH_DEFINES_DEFINED
 
+#include <algorithm>
+
 
 #include <QScreen>
 #include <QMenuBar>
@@ -43,10 +45,9 @@
 #include <QDesktopServices>
 #include <QFileDialog>
 
-#include <gmsh.h>
-
 
 #include <core/displayoptions.h>
+#include <core/imagewriter.h>
 #include <core/saveoptions.h>
 #include <api/trace.h>
 #include <core/xflcore.h>
@@ -85,6 +86,7 @@
 #include <interfaces/graphs/globals/graphsvgwriter.h>
 #include <interfaces/graphs/graph/curve.h>
 #include <interfaces/mesh/afmesher.h>
+#include <interfaces/mesh/gmesh_globals.h>
 #include <interfaces/mesh/gmesherwt.h>
 #include <interfaces/mesh/mesherwt.h>
 #include <interfaces/opengl/globals/opengldlg.h>
@@ -188,6 +190,7 @@
 #include <api/fl5core.h>
 #include <api/foil.h>
 #include <api/geom_global.h>
+#include <api/memorybudget.h>
 #include <api/objects2d.h>
 #include <api/objects2d_globals.h>
 #include <api/objects3d.h>
@@ -266,6 +269,7 @@ MainFrame::MainFrame(QWidget *parent) : QMainWindow(parent)
     createToolbars();
     createStatusBar();
     hideDockWindows();
+    xfl::startupMark("Dock windows, menus and toolbars created");
 
     m_pXDirect->m_pFoilTable->setTableFontStruct(DisplayOptions::tableFontStruct());
     m_pXDirect->m_pFoilExplorer->setTreeFont(DisplayOptions::treeFontStruct().font());
@@ -288,6 +292,7 @@ MainFrame::MainFrame(QWidget *parent) : QMainWindow(parent)
 
     loadSettings();
     updateRecentFileActions();
+    xfl::startupMark("Settings loaded");
 
     QString strange;
     QScreen const *pScreen = QGuiApplication::primaryScreen();
@@ -338,9 +343,8 @@ MainFrame::MainFrame(QWidget *parent) : QMainWindow(parent)
 
     connectSignals();
 
-    gmsh::initialize();
-    gmsh::option::setNumber("General.Terminal", 0);  
-    gmsh::option::setNumber("Geometry.OCCParallel", 1.0);
+    // gmsh is initialized on first use by gmesh::initialize()
+    xfl::startupMark("Main frame constructed");
 }
 
 
@@ -419,7 +423,7 @@ void MainFrame::connectSignals()
 
 MainFrame::~MainFrame()
 {
-    gmsh::finalize();
+    gmesh::finalize();
 
     if(xfl::g_pTraceFile) xfl::g_pTraceFile->close();
 
@@ -748,6 +752,10 @@ void MainFrame::createMainFrameActions()
     m_pViewTraceFile = new QAction("View trace file", this);
     m_pViewTraceFile->setShortcut(QKeySequence(Qt::ALT | Qt::Key_T));
     connect(m_pViewTraceFile, SIGNAL(triggered()), SLOT(onTraceFile()));
+
+    m_pMemoryUsageAct = new QAction("Memory usage", this);
+    m_pMemoryUsageAct->setStatusTip("Shows the memory used by the objects and by the running analyses");
+    connect(m_pMemoryUsageAct, SIGNAL(triggered()), SLOT(onMemoryUsage()));
 }
 
 
@@ -1003,6 +1011,7 @@ void MainFrame::createMenus()
         m_pFileMenu->addSeparator();
         m_pFileMenu->addAction(m_pShowLogWindow);
         m_pFileMenu->addAction(m_pViewTraceFile);
+        m_pFileMenu->addAction(m_pMemoryUsageAct);
 
         m_pSeparatorAct = m_pFileMenu->addSeparator();
         for (int i=0; i<m_pRecentFileActs.size(); i++)
@@ -1830,6 +1839,80 @@ void MainFrame::onTraceFile()
 }
 
 
+void MainFrame::onMemoryUsage()
+{
+    struct Usage
+    {
+        size_t m_Bytes;
+        std::string m_Name;
+    };
+
+    QString props;
+    auto sizeString = [](size_t bytes) {return QString::fromStdString(MemoryBudget::sizeString(bytes)).rightJustified(10);};
+
+    // lists the largest objects of a category, in decreasing order of size
+    auto listObjects = [&props, &sizeString](QString const &category, std::vector<Usage> &usage)
+    {
+        if(usage.empty()) return;
+        std::sort(usage.begin(), usage.end(), [](Usage const &a, Usage const &b) {return a.m_Bytes>b.m_Bytes;});
+        size_t total = 0;
+        for(Usage const &u : usage) total += u.m_Bytes;
+
+        props += QString::asprintf("%s: %d objects, ", category.toStdString().c_str(), int(usage.size())) + sizeString(total).trimmed() + "\n";
+        int nMax = std::min(int(usage.size()), 20);
+        for(int i=0; i<nMax; i++)
+            props += "   " + sizeString(usage.at(i).m_Bytes) + "   " + QString::fromStdString(usage.at(i).m_Name) + "\n";
+        if(nMax<int(usage.size()))
+            props += QString::asprintf("   ... and %d more\n", int(usage.size())-nMax);
+        props += "\n";
+    };
+
+    props += "Memory used by the objects:\n";
+    props += "   Foils         " + sizeString(Objects2d::memoryFootprint())   + "\n";
+    props += "   Planes        " + sizeString(Objects3d::memoryFootprint())   + "\n";
+    props += "   Boats         " + sizeString(SailObjects::memoryFootprint()) + "\n";
+    props += "Memory reserved by the running analyses:\n";
+    props += "   " + sizeString(MemoryBudget::reserved()).trimmed();
+    if(MemoryBudget::isLimited()) props += QString::asprintf(" of the %.0f MB budget\n\n", MemoryBudget::budget());
+    else                          props += ", no budget set\n\n";
+
+    std::vector<Usage> usage;
+
+    for(Foil const *pFoil : Objects2d::foils())            usage.push_back({pFoil->memoryFootprint(), pFoil->name()});
+    listObjects("Foils", usage);
+    usage.clear();
+    for(Polar const *pPolar : Objects2d::polars())         usage.push_back({pPolar->memoryFootprint(), pPolar->foilName() + " / " + pPolar->name()});
+    listObjects("Foil polars", usage);
+    usage.clear();
+    for(OpPoint const *pOpp : Objects2d::operatingPoints()) usage.push_back({pOpp->memoryFootprint(), pOpp->name()});
+    listObjects("Foil operating points", usage);
+    usage.clear();
+
+    for(Plane const *pPlane : Objects3d::planes())               usage.push_back({pPlane->memoryFootprint(), pPlane->name()});
+    listObjects("Planes", usage);
+    usage.clear();
+    for(PlanePolar const *pWPolar : Objects3d::planePolars())    usage.push_back({pWPolar->memoryFootprint(), pWPolar->planeName() + " / " + pWPolar->name()});
+    listObjects("Plane polars", usage);
+    usage.clear();
+    for(PlaneOpp const *pPOpp : Objects3d::planeOpps())          usage.push_back({pPOpp->memoryFootprint(), pPOpp->planeName() + " / " + pPOpp->title(false)});
+    listObjects("Plane operating points", usage);
+    usage.clear();
+
+    for(Boat const *pBoat : SailObjects::boats())                usage.push_back({pBoat->memoryFootprint(), pBoat->name()});
+    listObjects("Boats", usage);
+    usage.clear();
+    for(BoatPolar const *pBtPolar : SailObjects::boatPolars())   usage.push_back({pBtPolar->memoryFootprint(), pBtPolar->boatName() + " / " + pBtPolar->name()});
+    listObjects("Boat polars", usage);
+    usage.clear();
+    for(BoatOpp const *pBtOpp : SailObjects::boatOpps())         usage.push_back({pBtOpp->memoryFootprint(), pBtOpp->boatName() + " / " + pBtOpp->title(false)});
+    listObjects("Boat operating points", usage);
+
+    ObjectPropsDlg *pOPDlg = new ObjectPropsDlg(this);
+    pOPDlg->initDialog(QString("Memory usage"), props);
+    pOPDlg->show();
+}
+
+
 bool MainFrame::onCloseProject()
 {
     if(!s_bSaved)
@@ -2084,8 +2167,7 @@ void MainFrame::onInsertProject()
     }
     else if(end==".fl5")
     {
-        QDataStream ar(&XFile);
-        bool bLoadPlanes = loader.serializeProjectFl5(ar, false);
+        bool bLoadPlanes = loader.loadProjectFl5(XFile);
         if(!bLoadPlanes)
         {
             onShowLogWindow(true);
@@ -2511,19 +2593,18 @@ bool MainFrame::saveProject(const QString &filepath)
     }
     else
     {
+        fpb.close();
         if(QFile::remove(PathName))
         {
-            if(!fpb.copy(PathName))
+            // moving the file is a metadata operation if the temporary directory is on the same volume;
+            // QFile falls back to a copy otherwise
+            if(!QFile::rename(backupFileName, PathName))
             {
                 QString strange = "Error copying the backup file\n" + backupFileName + " to\n"+PathName;
                 displayMessage(strange, true);
                 onShowLogWindow(true);
                 return false;
             }
-            else
-            {
-                QFile::remove(backupFileName);
-            }
         }
         else
         {
@@ -2536,7 +2617,6 @@ bool MainFrame::saveProject(const QString &filepath)
     }
 
     m_FilePath = PathName;
-    fpb.close();
 
     saveSettings();
 
@@ -3921,6 +4001,85 @@ bool MainFrame::exportAllPOpps(const QString &pathname, bool bCSV, bool bPanelDa
     return true;
 }
 
+/**
+ * Renders the 3d view of each plane operating point and the plane polar graphs to png files.
+ * The operating points are rendered plane after plane, so that the plane's geometry buffers
+ * are built once. The images are encoded and saved on a background thread while the next
+ * operating point is rendered.
+ */
+bool MainFrame::exportAllPOppImages(QString const &pathname, QSize const &size)
+{
+    ImageWriter writer;
+    QString fileName;
+
+    for(int p=0; p<Objects3d::nPlanes(); p++)
+    {
+        Plane *pPlane = Objects3d::planeAt(p);
+        if(!pPlane) continue;
+
+        QString PlaneSubDirPath = pathname + QDir::separator() + QString::fromStdString(pPlane->name());
+        QDir ExportPlaneDir(PlaneSubDirPath);
+        if(!ExportPlaneDir.exists())
+        {
+            if(!ExportPlaneDir.mkpath(PlaneSubDirPath)) return false;
+        }
+
+        m_pXPlane->setPlane(pPlane);
+
+        for(int l=0; l<Objects3d::nPolars(); l++)
+        {
+            PlanePolar *pWPolar = Objects3d::plPolarAt(l);
+            if(!pWPolar) continue;
+            if(pWPolar->planeName().compare(pPlane->name())!=0) continue;
+
+            QString PolarName = QString::fromStdString(pWPolar->name());
+            PolarName.replace("/", "_");
+            PolarName.replace(".", "_");
+            QString WPolarSubDirPath = PlaneSubDirPath + QDir::separator() + PolarName;
+            QDir ExportWPolarDir(WPolarSubDirPath);
+            if(!ExportWPolarDir.exists())
+            {
+                if(!ExportWPolarDir.mkpath(WPolarSubDirPath)) return false;
+            }
+
+            m_pXPlane->setPolar(pWPolar);
+
+            for(int k=0; k<Objects3d::nPOpps(); k++)
+            {
+                PlaneOpp *pPOpp = Objects3d::POppAt(k);
+                if(pPOpp->planeName().compare(pPlane->name())!=0)   continue;
+                if(pPOpp->polarName().compare(pWPolar->name())!=0) continue;
+
+                m_pXPlane->setPlaneOpp(pPOpp);
+
+                QImage img = m_pXPlane->m_pgl3dXPlaneView->renderToImage(size);
+                if(img.isNull())
+                {
+                    m_pLogWt->onOutputMessage("No OpenGL context is available to render the images\n");
+                    return false;
+                }
+
+                fileName = QString::fromStdString(pPOpp->title(false));
+                fileName.replace("/", "_");
+                fileName.replace(".", "_");
+                writer.write(img, WPolarSubDirPath + QDir::separator() + fileName + ".png");
+            }
+        }
+    }
+
+    if(Objects3d::nPolars()>0)
+    {
+        m_pXPlane->createWPolarCurves();
+        m_pWPolarTiles->makeLegend(true);
+        writer.write(m_pWPolarTiles->grab().toImage(), pathname + QDir::separator() + "plane_polars.png");
+    }
+
+    writer.finish();
+
+    m_pLogWt->onOutputMessage(QString::asprintf("%d images have been written\n", writer.nWritten()));
+    return writer.nErrors()==0;
+}
+
 
 bool MainFrame::exportAllStlMesh(QString const &pathname)
 {
@@ -4255,6 +4414,7 @@ void MainFrame::executeScript(QString const &XmlScriptName, bool bShowProgressSt
 //    m_pScriptExecutor->moveToThread(QApplication::instance()->thread());
 
     if(!m_pScriptExecutor) m_pScriptExecutor = new XflScriptExec;
+    XflScriptExec::setDefaultLineWidth(Curve::defaultLineWidth());
     m_pScriptExecutor->setEventDestination(nullptr);
 
     if(bShowProgressStdIO)
@@ -4315,6 +4475,7 @@ void MainFrame::onExecuteScript()
     if(!m_pScriptExecutor)
     {
         m_pScriptExecutor = new XflScriptExec;
+        XflScriptExec::setDefaultLineWidth(Curve::defaultLineWidth());
         m_pScriptExecutor->moveToThread(&m_ScriptThread);
         connect(&m_ScriptThread,   &QThread::finished, m_pScriptExecutor, &QObject::deleteLater);
         connect(this, &MainFrame::runScript, m_pScriptExecutor, &XflScriptExec::runScript);
@@ -4406,6 +4567,22 @@ void MainFrame::handleScriptResults()
         }
     }
 
+    if(m_pScriptExecutor->exportXdmf())
+    {
+        QString xdmfdirpath = m_pScriptExecutor->outputDirPath()+QDir::separator()+"XDMF";
+        m_pLogWt->onOutputMessage("Exporting the operating points to XDMF files in directory: "+xdmfdirpath+EOLch);
+        if(!m_pScriptExecutor->exportOppsToXdmf(xdmfdirpath))
+            m_pLogWt->onOutputMessage("Error exporting the operating points to XDMF files\n");
+    }
+
+    if(m_pScriptExecutor->exportPOppImages())
+    {
+        QString imagedirpath = m_pScriptExecutor->outputDirPath()+QDir::separator()+"Images";
+        m_pLogWt->onOutputMessage("Rendering the operating point images to directory: "+imagedirpath+EOLch);
+        if(!exportAllPOppImages(imagedirpath, m_pScriptExecutor->imageSize()))
+            m_pLogWt->onOutputMessage("Error rendering the operating point images\n");
+    }
+
     if(m_pScriptExecutor->makeProjectFile())
     {
         QString FilePath = m_pScriptExecutor->projectFilePathName();
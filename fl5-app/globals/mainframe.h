@@ -161,6 +161,7 @@ class MainFrame : public QMainWindow
         bool exportAllWPolars(const QString &pathName, bool bCSV);
         bool exportAllBtPolars(QString const &pathname, bool bCSV);
         bool exportAllPOpps(QString const &pathName, bool bCSV, bool bPanelData);
+        bool exportAllPOppImages(QString const &pathname, QSize const &size);
         bool exportAllBtOpps(const QString &pathname, bool bCSV, bool bPanelData) const;
 
     signals:
@@ -224,6 +225,7 @@ class MainFrame : public QMainWindow
         void onShowGraphLegend();
         void onShowLogWindow(bool bShow=true);
         void onTraceFile();
+        void onMemoryUsage();
         int onTestRun();
 
         //___________________________________________Variables_______________________________
@@ -296,6 +298,7 @@ class MainFrame : public QMainWindow
         QAction *m_pShowLogWindow;
         QAction *m_pRestoreToolbarsAct;
         QAction *m_pViewLogFile, *m_pViewTraceFile;
+        QAction *m_pMemoryUsageAct;
 
         //Graph Actions
         QAction *m_pCurGraphDlgAct, *m_pResetCurGraphScales;
@@ -41,6 +41,7 @@
 #include <api/boat.h>
 #include <api/boatopp.h>
 #include <api/boatpolar.h>
+#include <api/fieldsampler.h>
 #include <api/planeopp.h>
 #include <api/planepolar.h>
 #include <api/planexfl.h>
@@ -417,7 +418,7 @@ void CrossFlowCtrls::makeXPlaneVelocityVectors()
     if(!pOpp3d) return;
 
     double xmax(0.0);
-    if(pOpp3d && pOpp3d->m_Vorton.size()) xmax = pOpp3d->m_Vorton.back().front().position().x;
+    if(pOpp3d && pOpp3d->hasVortons()) xmax = pOpp3d->vortonWake().rowFront(pOpp3d->vortonRows()-1).x;
     else                                  xmax = pPolar3d->wakeLength();
     m_pLabLen1->setText(QString::asprintf("%.2f", xmax*Units::mtoUnit()*1.1)+Units::lengthUnitQLabel());
 
@@ -442,10 +443,14 @@ void CrossFlowCtrls::makeXPlaneVelocityVectors()
         }
     }
 
-    if(pOpp3d->isQuadMethod())
-        m_pgl3dXPlaneView->computeP4VelocityVectors(pOpp3d, m_GridNodesVel, m_GridVectors, xfl::isMultiThreaded());
-    else
-        m_pgl3dXPlaneView->computeP3VelocityVectors(pOpp3d, m_GridNodesVel, m_GridVectors, xfl::isMultiThreaded());
+    // same nodes as above, with the y index varying fastest
+    double d = 1.0/double(std::max(s_nVelocitySamples-1, 1));
+    FieldSampler sampler;
+    sampler.setSlice({xpos, -s_Width, -0.5*s_Height}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0},
+                     s_nVelocitySamples, s_nVelocitySamples, 2.0*s_Width*d, s_Height*d);
+    m_pgl3dXPlaneView->sampleField(pOpp3d, sampler);
+    for(int idx=0; idx<m_GridVectors.size() && idx<sampler.nNodes(); idx++)
+        m_GridVectors[idx] = sampler.velocity(idx);
 
     gl3dXPlaneView::s_bResetglGridVelocities = true;
     m_pgl3dXPlaneView->update();
@@ -460,7 +465,7 @@ void CrossFlowCtrls::makeXSailVelocityVectors()
 
     if(!pOpp3d) return;
 
-    if(pOpp3d && pOpp3d->m_Vorton.size()) xmax = pOpp3d->m_Vorton.back().front().position().x;
+    if(pOpp3d && pOpp3d->hasVortons()) xmax = pOpp3d->vortonWake().rowFront(pOpp3d->vortonRows()-1).x;
     else                                  xmax = pPolar3d->wakeLength();
     m_pLabLen1->setText(QString::asprintf("%.2f", xmax*Units::mtoUnit()*1.1)+Units::lengthUnitQLabel());
 
@@ -501,9 +506,9 @@ void CrossFlowCtrls::makeOmegaMap()
     if(!pPOpp) return;
 
     double xmax = 1.0;
-    if(pPOpp && pPOpp->m_Vorton.size())
+    if(pPOpp && pPOpp->hasVortons())
     {
-        xmax = pPOpp->m_Vorton.back().front().position().x;
+        xmax = pPOpp->vortonWake().rowFront(pPOpp->vortonRows()-1).x;
         m_pLabLen1->setText(QString::asprintf("%.2f", xmax*Units::mtoUnit()*1.1)+Units::lengthUnitQLabel());
     }
 
@@ -605,14 +610,11 @@ void CrossFlowCtrls::makeVorticityRow(int irow, double x, double z, Opp3d const
 
         // from the vortons
         omega.set(0,0,0);
-        for(uint ir=0; ir<pOpp3d->m_Vorton.size(); ir++)
+        VortonWake const &wake = pOpp3d->vortonWake();
+        for(int i=0; i<wake.count(); i++)
         {
-            for(uint jc=0; jc<pOpp3d->m_Vorton.at(ir).size(); jc++)
-            {
-                Vorton const &vtn = pOpp3d->m_Vorton.at(ir).at(jc);
-                omp = vtn.vorticity(pt);
-                omega += omp;
-            }
+            omp = wake.vorton(i).vorticity(pt);
+            omega += omp;
         }
 
         switch (s_OmegaDir)
@@ -57,6 +57,7 @@ double StreamLineCtrls::s_YOffset = 0.0;
 double StreamLineCtrls::s_ZOffset = 0.0;
 int    StreamLineCtrls::s_NStreamLines = 11;
 double StreamLineCtrls::s_DeltaL=0.05;
+bool   StreamLineCtrls::s_bCacheVelocity=true;
 
 
 
@@ -91,6 +92,12 @@ void StreamLineCtrls::setupLayout()
                 m_pfeMaxLength->setToolTip(tip);
                 m_pfeMaxLength->setEnabled(false);
 
+                m_pchCacheVelocity = new QCheckBox("Cache the velocity field");
+                m_pchCacheVelocity->setToolTip("<p>If checked, the velocities are interpolated from a lattice shared by all the streamlines, "
+                                               "with a cell size which grows with the segment length. "
+                                               "This is much faster for dense plots, but smooths the velocity field "
+                                               "close to the panels and to the wake.</p>");
+
                 QLabel *pLab4 = new QLabel("Streamwise segments:");
                 QLabel *pLab5 = new QLabel("1<sup>st</sup> segment:");
                 QLabel *pLab6 = new QLabel("Progression factor:");
@@ -109,6 +116,7 @@ void StreamLineCtrls::setupLayout()
                 pLengthLayout->addWidget(pLab7,             5,1, Qt::AlignVCenter |Qt::AlignRight);
                 pLengthLayout->addWidget(m_pfeMaxLength,    5,2);
                 pLengthLayout->addWidget(m_plabLengthUnit1, 5,3);
+                pLengthLayout->addWidget(m_pchCacheVelocity, 6,2,1,2);
 
                 pLengthLayout->setColumnStretch(1,1);
                 pLengthLayout->setColumnStretch(3,1);
@@ -265,6 +273,7 @@ void StreamLineCtrls::connectSignals()
     connect(m_pieNStreamLines,      SIGNAL(intChanged(int)),       SLOT(onCalcStreamlines()));
 
     connect(m_pchUseWingColour,     SIGNAL(clicked(bool)),         SLOT(onCalcStreamlines()));
+    connect(m_pchCacheVelocity,     SIGNAL(clicked(bool)),         SLOT(onCalcStreamlines()));
     connect(m_plbStreamLines,       SIGNAL(clickedLB(LineStyle)),  SLOT(onStreamStyle()));
 }
 
@@ -286,6 +295,7 @@ void StreamLineCtrls::initWidget()
     m_pslZOffset->setValue(s_ZOffset);
     m_plbStreamLines->setTheStyle(W3dPrefs::s_StreamStyle);
     m_pchUseWingColour->setChecked(W3dPrefs::s_bUseWingColour);
+    m_pchCacheVelocity->setChecked(s_bCacheVelocity);
 
     m_pieNStreamLines->setValue(s_NStreamLines);
     m_pfeDeltaPos->setValue(s_DeltaL*Units::mtoUnit());
@@ -335,6 +345,7 @@ void StreamLineCtrls::loadSettings(QSettings &settings)
 
         s_NStreamLines = settings.value("NStreamLines", s_NStreamLines).toInt();
         s_DeltaL       = settings.value("DeltaPos",     s_DeltaL).toDouble();
+        s_bCacheVelocity = settings.value("CacheVelocity", s_bCacheVelocity).toBool();
 
 
     }
@@ -353,6 +364,7 @@ void StreamLineCtrls::saveSettings(QSettings &settings)
         settings.setValue("XFactor",        s_XFactor);
         settings.setValue("NStreamLines",   s_NStreamLines);
         settings.setValue("DeltaPos",       s_DeltaL);
+        settings.setValue("CacheVelocity",  s_bCacheVelocity);
 
     }
     settings.endGroup();
@@ -392,6 +404,7 @@ void StreamLineCtrls::readStreamParams()
     m_pfeDeltaPos->setEnabled(    s_pos==Y_LINE || s_pos==Z_LINE);
 
     W3dPrefs::s_bUseWingColour = m_pchUseWingColour->isChecked();
+    s_bCacheVelocity = m_pchCacheVelocity->isChecked();
 }
 
 
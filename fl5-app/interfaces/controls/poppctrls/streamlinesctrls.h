@@ -79,6 +79,8 @@ class StreamLineCtrls : public QWidget
         static void setL0(double ll0) {s_L0=ll0;}
         static double l0() {return s_L0;}
 
+        static bool bCacheVelocity() {return s_bCacheVelocity;}
+
         static void loadSettings(QSettings &settings);
         static void saveSettings(QSettings &settings);
 
@@ -107,6 +109,7 @@ class StreamLineCtrls : public QWidget
 
         LineBtn *m_plbStreamLines;
         QCheckBox *m_pchUseWingColour;
+        QCheckBox *m_pchCacheVelocity;
 
         QSlider *m_pslXOffset, *m_pslZOffset;
         ExponentialSlider *m_pslYOffset;
@@ -128,6 +131,7 @@ class StreamLineCtrls : public QWidget
         static double s_XFactor;
         static int s_NStreamLines;
         static double s_DeltaL;
+        static bool s_bCacheVelocity;
 
 };
 
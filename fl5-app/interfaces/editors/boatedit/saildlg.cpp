@@ -851,11 +851,12 @@ void SailDlg::customEvent(QEvent *pEvent)
 {
     if(pEvent->type() == MESH_UPDATE_EVENT)
     {
+        MeshEvent *pMeshEvent = dynamic_cast<MeshEvent*>(pEvent);
+        if(!pMeshEvent->isFinal()) return; // intermediate mesher progress
+
         QApplication::restoreOverrideCursor();
         m_bIsMeshing = false;
 
-        MeshEvent *pMeshEvent = dynamic_cast<MeshEvent*>(pEvent);
-
         QString strange;
         strange = "   making mesh from triangles\n";
         m_ppto->onAppendQText(strange);
@@ -278,6 +278,7 @@ void SailOccDlg::customEvent(QEvent *pEvent)
     else if(pEvent->type() == MESH_UPDATE_EVENT)
     {      
         MeshEvent *pMeshEvent = dynamic_cast<MeshEvent*>(pEvent);
+        if(!pMeshEvent->isFinal()) return; // intermediate mesher progress
         QString strange;
         SailOcc *pOccSail = dynamic_cast<SailOcc*>(m_pSail);
         pOccSail->clearTEIndexes();
@@ -145,31 +145,8 @@ void FoilTEGapDlg::onApply()
     double gap = m_pdeGap->value()/100.0;
     s_BlendLength  = m_pdeBlend->value()/100;
 
-    double dg = (gap-m_pRefFoil->TEGap());
-    double length = m_pRefFoil->length();
-
-    CubicSpline CS = m_pRefFoil->cubicSpline(); //  make it non-const
-
-    for(int i=0; i<CS.ctrlPointCount(); i++)
-    {
-        double arg = m_pRefFoil->TE().x - CS.controlPoint(i).x;
-        //decay exponentially
-        double dth = exp(-arg/(1.0-s_BlendLength)*length);
-//        double u = CS.tmin() + CS.t(i)/(CS.tmax()-CS.tmin());
-        double u = double(i) / double(CS.ctrlPointCount()-1);
-        if(u<m_pRefFoil->CSfracLE())
-        {
-            // top surface
-            m_pBufferFoil->setBaseNode(i, m_pBufferFoil->xb(i), m_pBufferFoil->yb(i) + dth * dg/2.0);
-        }
-        else
-        {
-            // bot surface
-            m_pBufferFoil->setBaseNode(i, m_pBufferFoil->xb(i), m_pBufferFoil->yb(i) - dth * dg/2.0);
-        }
-    }
-
-    m_pBufferFoil->initGeometry();
+    // the buffer foil has been reset to the reference foil
+    m_pBufferFoil->setTEGap(gap, s_BlendLength);
 
     m_pBufferFoil->setName(m_pRefFoil->name()+QString::asprintf("_TEgap %.2f%%", m_pBufferFoil->TEGap()*100.0).toStdString());
 
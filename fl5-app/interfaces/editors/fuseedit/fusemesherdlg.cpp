@@ -537,6 +537,15 @@ void FuseMesherDlg::onCheckMesh()
     if(dlg.checkMinAngles()) qVec = QVector<int>(anglelist.begin(),  anglelist.end());
     if(dlg.checkMinArea())   qVec = QVector<int>(arealist.begin(),   arealist.end());
     if(dlg.checkMinSize())   qVec = QVector<int>(sizelist.begin(),   sizelist.end());
+    if(dlg.checkIntersections())
+    {
+        std::string str;
+        std::vector<int> intersectlist, overlaplist;
+        m_pFuse->triMesh().checkIntersections(str, PanelCheckDlg::intersectionGap(), intersectlist, overlaplist, xfl::isMultiThreaded());
+        log += str;
+        qVec.append(QVector<int>(intersectlist.begin(), intersectlist.end()));
+        qVec.append(QVector<int>(overlaplist.begin(),   overlaplist.end()));
+    }
     m_pglFuseView->appendHighlightList(qVec);
 
     m_ppto->onAppendStdText(log + "\n");
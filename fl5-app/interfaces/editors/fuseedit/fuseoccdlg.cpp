@@ -37,6 +37,7 @@
 
 #include "fuseoccdlg.h"
 
+#include <core/xflcore.h>
 #include <interfaces/editors/fuseedit/shapefixerdlg.h>
 #include <interfaces/exchange/cadexportdlg.h>
 #include <interfaces/mesh/afmesher.h>
@@ -326,6 +327,7 @@ void FuseOccDlg::customEvent(QEvent *pEvent)
         if(!m_pFuseOcc) return;
 
         MeshEvent *pMeshEvent = dynamic_cast<MeshEvent*>(pEvent);
+        if(!pMeshEvent->isFinal()) return; // intermediate mesher progress
 
         std::string str;
         str = "   Making mesh from triangles\n";
@@ -627,6 +629,15 @@ void FuseOccDlg::onCheckMesh()
     if(dlg.checkMinAngles()) qVec = QVector<int>(anglelist.begin(), anglelist.end());
     if(dlg.checkMinArea())   qVec = QVector<int>(arealist.begin(),  arealist.end());
     if(dlg.checkMinSize())   qVec = QVector<int>(sizelist.begin(),  sizelist.end());
+    if(dlg.checkIntersections())
+    {
+        std::string str;
+        std::vector<int> intersectlist, overlaplist;
+        m_pFuseOcc->triMesh().checkIntersections(str, PanelCheckDlg::intersectionGap(), intersectlist, overlaplist, xfl::isMultiThreaded());
+        log += str;
+        qVec.append(QVector<int>(intersectlist.begin(), intersectlist.end()));
+        qVec.append(QVector<int>(overlaplist.begin(),   overlaplist.end()));
+    }
     m_pglFuseView->appendHighlightList(qVec);
     updateStdOutput(log + "\n");
 
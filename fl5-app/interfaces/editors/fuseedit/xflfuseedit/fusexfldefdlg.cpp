@@ -1159,7 +1159,7 @@ void FuseXflDefDlg::setPicture()
     int iActiveFrameIndex = m_pFuseXfl->activeFrameIndex();
 
     Fuse const *pTmpBodyXfl = m_UndoStack.at(m_StackPos);
-    m_pFuseXfl->duplicateFuse(*pTmpBodyXfl);
+    m_pFuseXfl->duplicateFuseDefinition(*pTmpBodyXfl);
     fillFrameDataTable();
     fillPointDataTable();
 
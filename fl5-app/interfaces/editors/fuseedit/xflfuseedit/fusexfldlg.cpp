@@ -453,7 +453,8 @@ void FuseXflDlg::clearStack(int pos)
 
 
 /**
- * Copies the current Fuse object to a new Fuse and pushes it on the stack.
+ * Copies the definition of the current Fuse object to a new Fuse and pushes it on the stack.
+ * The triangulations and the mesh are not copied, since they are rebuilt when the picture is restored.
  */
 void FuseXflDlg::takePicture()
 {
@@ -463,11 +464,8 @@ void FuseXflDlg::takePicture()
     //clear the downstream part of the stack which becomes obsolete
     clearStack(m_StackPos);
 
-    // append a copy of the current object
-
-    Fuse* pFuseXfl = m_pFuseXfl->clone();
-    pFuseXfl->duplicateFuse(*m_pFuseXfl);
-    m_UndoStack.append(pFuseXfl);
+    // append a copy of the current object's definition
+    m_UndoStack.append(m_pFuseXfl->snapshot());
 
     // the new current position is the top of the stack
     m_StackPos = m_UndoStack.size()-1;
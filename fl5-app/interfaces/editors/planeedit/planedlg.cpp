@@ -402,6 +402,15 @@ void PlaneDlg::onCheckMesh()
     if(dlg.checkMinAngles()) qVec = QVector<int>(anglelist.begin(),  anglelist.end());
     if(dlg.checkMinArea())   qVec = QVector<int>(arealist.begin(),   arealist.end());
     if(dlg.checkMinSize())   qVec = QVector<int>(sizelist.begin(),   sizelist.end());
+    if(dlg.checkIntersections())
+    {
+        std::string str;
+        std::vector<int> intersectlist, overlaplist;
+        m_pPlane->refTriMesh().checkIntersections(str, PanelCheckDlg::intersectionGap(), intersectlist, overlaplist, xfl::isMultiThreaded());
+        log += str;
+        qVec.append(QVector<int>(intersectlist.begin(), intersectlist.end()));
+        qVec.append(QVector<int>(overlaplist.begin(),   overlaplist.end()));
+    }
     m_pglPlaneView->appendHighlightList(qVec);
 
     updateStdOutput(log + "\n");
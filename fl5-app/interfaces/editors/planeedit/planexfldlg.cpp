@@ -525,6 +525,7 @@ void PlaneXflDlg::customEvent(QEvent *pEvent)
     else if(pEvent->type() == MESH_UPDATE_EVENT)
     {
         MeshEvent *pMeshEvent = dynamic_cast<MeshEvent*>(pEvent);
+        if(!pMeshEvent->isFinal()) return; // intermediate mesher progress
 
         Fuse *pFuse = m_pPlaneXfl->fuse(0);
         if(!pFuse) return;
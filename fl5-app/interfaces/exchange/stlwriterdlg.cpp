@@ -34,6 +34,8 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QDialogButtonBox>
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrent>
 
 #include "stlwriterdlg.h"
 
@@ -54,6 +56,7 @@ QByteArray STLWriterDlg::s_Geometry;
 
 
 bool STLWriterDlg::s_bBinary = true;
+bool STLWriterDlg::s_bOBJ = false;
 int STLWriterDlg::s_iChordPanels = 13;
 int STLWriterDlg::s_iSpanPanels = 17;
 
@@ -66,12 +69,15 @@ STLWriterDlg::STLWriterDlg(QWidget *pParent) : QDialog(pParent)
     m_pFuse = nullptr;
     m_pWing = nullptr;
     m_pSail = nullptr;
+    m_bIsRunning = false;
 
     setupLayout();
 
     m_UnitFactor=1.0;
-    m_prbBinary->setEnabled(false);
-    m_prbASCII->setEnabled(false);
+
+    connect(this, SIGNAL(outputMsg(QString)), m_pptoOutputLog, SLOT(onAppendQText(QString)));
+    connect(this, SIGNAL(exportFinished(bool)), SLOT(onExportFinished(bool)));
+    connect(&m_ProgressTimer, SIGNAL(timeout()), SLOT(onProgress()));
 }
 
 
@@ -85,8 +91,10 @@ void STLWriterDlg::setupLayout()
             {
                 m_prbBinary = new QRadioButton("Binary");
                 m_prbASCII  = new QRadioButton("ASCII");
+                m_prbOBJ    = new QRadioButton("OBJ");
                 pFormatLayout->addWidget(m_prbBinary);
                 pFormatLayout->addWidget(m_prbASCII);
+                pFormatLayout->addWidget(m_prbOBJ);
             }
             pExportFormat->setLayout(pFormatLayout);
         }
@@ -145,9 +153,9 @@ void STLWriterDlg::setupLayout()
         QDialogButtonBox *pButtonBox = new QDialogButtonBox(QDialogButtonBox::Close);
         connect(pButtonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
 
-        QPushButton *pExportButton  = new QPushButton("Export Part");
-        connect(pExportButton, SIGNAL(clicked(bool)), this, SLOT(onExporttoSTL()));
-        pExportButton->setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Minimum);
+        m_ppbExport  = new QPushButton("Export Part");
+        connect(m_ppbExport, SIGNAL(clicked(bool)), this, SLOT(onExporttoSTL()));
+        m_ppbExport->setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Minimum);
 
         m_pptoOutputLog = new PlainTextOutput;
 
@@ -155,7 +163,7 @@ void STLWriterDlg::setupLayout()
         pMainLayout->addWidget(m_plwNameList);
         pMainLayout->addWidget(pResolutionBox);
         pMainLayout->addLayout(pUnitLayout);
-        pMainLayout->addWidget(pExportButton);
+        pMainLayout->addWidget(m_ppbExport);
         pMainLayout->addWidget(m_pptoOutputLog);
 
         pMainLayout->addWidget(pButtonBox);
@@ -171,6 +179,18 @@ void STLWriterDlg::accept()
 }
 
 
+void STLWriterDlg::reject()
+{
+    if(m_bIsRunning)
+    {
+        // the writer references the parts, so wait for the export thread to stop
+        m_StlWriter.cancel();
+        m_Future.waitForFinished();
+    }
+    QDialog::reject();
+}
+
+
 void STLWriterDlg::showEvent(QShowEvent *pEvent)
 {
     QDialog::showEvent(pEvent);
@@ -191,8 +211,9 @@ void STLWriterDlg::initDialog(PlaneXfl *pPlane, WingXfl *pWing, Fuse *pFuse, Sai
     m_pFuse = pFuse;
     m_pWing = pWing;
     m_pSail = pSail;
-    m_prbBinary->setChecked(s_bBinary);
-    m_prbASCII->setChecked(!s_bBinary);
+    m_prbBinary->setChecked(s_bBinary && !s_bOBJ);
+    m_prbASCII->setChecked(!s_bBinary && !s_bOBJ);
+    m_prbOBJ->setChecked(s_bOBJ);
     m_pieChordPanels->setValue(s_iChordPanels);
     m_pieSpanPanels->setValue(s_iSpanPanels);
 
@@ -225,6 +246,7 @@ void STLWriterDlg::initDialog(PlaneXfl *pPlane, WingXfl *pWing, Fuse *pFuse, Sai
 void STLWriterDlg::readParams()
 {
     s_bBinary = m_prbBinary->isChecked();
+    s_bOBJ    = m_prbOBJ->isChecked();
     s_iChordPanels = m_pieChordPanels->value();
     s_iSpanPanels  = m_pieSpanPanels->value();
 
@@ -281,16 +303,23 @@ void STLWriterDlg::onSetLabels()
 
 
 /**
- * Exports the geometrical data of the acitve wing or plane to a text file readable by AVL
- *@todo AVL expects consistency of the units, need to check all lines and cases
+ * Exports the triangulation of the selected parts to an STL or OBJ file.
+ * The file is written in a separate thread; the export button is used to cancel it.
  */
 void STLWriterDlg::onExporttoSTL()
 {
+    if(m_bIsRunning)
+    {
+        m_StlWriter.cancel();
+        return;
+    }
+
     readParams();
 
     if (!m_pPlane && !m_pWing && !m_pFuse && !m_pSail) return;
 
-    QString filter ="STL File (*.stl)";
+    QString ext = s_bOBJ ? ".obj" : ".stl";
+    QString filter = s_bOBJ ? "OBJ File (*.obj)" : "STL File (*.stl)";
     QString FileName;
 
     if      (m_pFuse)  FileName = QString::fromStdString(m_pFuse->name()).trimmed();
@@ -299,363 +328,121 @@ void STLWriterDlg::onExporttoSTL()
     else if (m_pPlane) FileName = QString::fromStdString(m_pPlane->name()).trimmed();
     FileName.replace('/', '_');
     FileName.replace(' ', '_');
+    QString solidname = FileName;
 
     QFileDialog Fdlg(this);
-    FileName = Fdlg.getSaveFileName(this, "Export to STL file",
-                                    SaveOptions::STLDirName() + "/"+FileName+".stl",
-                                    "STL File (*.stl)",
+    FileName = Fdlg.getSaveFileName(this, s_bOBJ ? "Export to OBJ file" : "Export to STL file",
+                                    SaveOptions::STLDirName() + "/"+FileName+ext,
+                                    filter,
                                     &filter);
 
     if(!FileName.length()) return;
 
-    bool bBinary = STLWriterDlg::s_bBinary;
+    int pos = FileName.indexOf(ext, Qt::CaseInsensitive);
+    if(pos<0) FileName += ext;
 
-    int pos = FileName.indexOf(".stl", Qt::CaseInsensitive);
-    if(pos<0) FileName += ".stl";
+    if     (s_bOBJ)    m_StlWriter.setFormat(StlWriter::OBJ);
+    else if(s_bBinary) m_StlWriter.setFormat(StlWriter::BINARYSTL);
+    else               m_StlWriter.setFormat(StlWriter::TEXTSTL);
+    m_StlWriter.setResolution(s_iChordPanels, s_iSpanPanels);
+    m_StlWriter.setMultiThreaded(xfl::isMultiThreaded());
+    m_StlWriter.clearParts();
 
-    QFile XFile(FileName);
-
-
-    if (!XFile.open(QIODevice::WriteOnly))
-    {
-        QMessageBox::warning(window(), "Warning", "Could not open the file for writing");
-        return;
-    }
-
-    int nTriangles = 0;
+    // the parts are referenced by the writer, and their existing triangulations are written without copy
     if(m_pPlane)
     {
-        if(bBinary)
+        m_StlWriter.setScaleFactor(1.0);
+        for(int i=0; i<m_SelectedList.size(); i++)
         {
-            QDataStream out(&XFile);
-            // stl format uses Little-Endian byte order
-            out.setByteOrder(QDataStream::LittleEndian);
-//            nTriangles = exportWingToSTLBinary(m_pWing, out, STLWriterDlg::s_iChordPanels, STLWriterDlg::s_iSpanPanels, m_UnitFactor);
-
-            std::vector<Triangle3d> triangles;
-            for(int i=0; i<m_SelectedList.size(); i++)
-            {
-                WingXfl const *pWing = m_pPlane->wingFromName(m_SelectedList.at(i).toStdString());
-                Fuse const *pFuse = m_pPlane->fuseFromName(m_SelectedList.at(i).toStdString());
-                if(pWing)
-                {
-                    makeSTLTriangulation(pWing, triangles, s_iChordPanels, s_iSpanPanels, 1.0);
-                }
-                else if(pFuse)
-                {
-                    triangles.insert(triangles.end(), pFuse->triangles().begin(), pFuse->triangles().end());
-                }
-            }
-            nTriangles = Objects3d::exportTriangulation(out, 1.0, triangles);
-        }
-        else
-        {
-            QTextStream out(&XFile);
-            nTriangles = exportWingToSTLText(m_pWing, out, STLWriterDlg::s_iChordPanels, STLWriterDlg::s_iSpanPanels, 1.0);
+            WingXfl const *pWing = m_pPlane->wingFromName(m_SelectedList.at(i).toStdString());
+            Fuse const *pFuse = m_pPlane->fuseFromName(m_SelectedList.at(i).toStdString());
+            if     (pWing) m_StlWriter.addWing(pWing);
+            else if(pFuse) m_StlWriter.addTriangles(pFuse->name(), pFuse->triangles());
         }
     }
     else if(m_pWing)
     {
-        if(bBinary)
-        {
-            QDataStream out(&XFile);
-            // stl format uses Little-Endian byte order
-            out.setByteOrder(QDataStream::LittleEndian);
-            std::vector<Triangle3d> triangles;
-            makeSTLTriangulation(m_pWing, triangles, s_iChordPanels, s_iSpanPanels, 1.0);
-            nTriangles = Objects3d::exportTriangulation(out, 1.0, triangles);
-        }
-        else
-        {
-            QTextStream out(&XFile);
-            nTriangles = exportWingToSTLText(m_pWing, out, STLWriterDlg::s_iChordPanels, STLWriterDlg::s_iSpanPanels, 1.0);
-        }
+        m_StlWriter.setScaleFactor(1.0);
+        m_StlWriter.addWing(m_pWing);
     }
     else if(m_pFuse)
     {
-        if(bBinary)
-        {
-            QDataStream out(&XFile);
-            out.setByteOrder(QDataStream::LittleEndian);
-            nTriangles = Objects3d::exportTriangulation(out, m_UnitFactor, m_pFuse->triangles());
-        }
-        else
-        {
-//            QTextStream out(&XFile);
-        }
+        m_StlWriter.setScaleFactor(m_UnitFactor);
+        m_StlWriter.addTriangles(m_pFuse->name(), m_pFuse->triangles());
     }
     else if(m_pSail)
     {
-        if(bBinary)
-        {
-            QDataStream out(&XFile);
-            // stl format uses Little-Endian byte order
-            out.setByteOrder(QDataStream::LittleEndian);
-            nTriangles = exportSailToSTLBinary(m_pSail, out, STLWriterDlg::s_iChordPanels, STLWriterDlg::s_iSpanPanels, m_UnitFactor);
-        }
+        // the tessellation of the CAD and STL sails does not depend on the resolution,
+        // so that it is only made if the sail has none
+        if(!m_pSail->isExternalSail() || m_pSail->triangles().empty())
+            Objects3d::makeSailTriangulation(m_pSail, s_iChordPanels, s_iSpanPanels);
+        m_StlWriter.setScaleFactor(m_UnitFactor);
+        m_StlWriter.addTriangles(m_pSail->name(), m_pSail->triangles());
     }
 
-    m_pptoOutputLog->insertPlainText("The part has been successfully exported to the STL file");
-    m_pptoOutputLog->insertPlainText("\n");
-    QString strong;
-    strong = QString::asprintf("Total triangles: %d", nTriangles);
-    m_pptoOutputLog->insertPlainText(strong);
-    XFile.close();
-}
+    if(!m_StlWriter.nParts())
+    {
+        m_pptoOutputLog->onAppendQText("No part selected for export\n");
+        return;
+    }
 
+    m_bIsRunning = true;
+    m_ppbExport->setText("Cancel");
+    m_pptoOutputLog->onAppendQText("Exporting to the file " + QFileInfo(FileName).fileName() + "\n");
+    m_ProgressTimer.start(250);
+
+    //running this function in a separate thread to keep the UI responsive
+#if (QT_VERSION >= QT_VERSION_CHECK(6,0,0))
+    m_Future = QtConcurrent::run(&STLWriterDlg::writeFile, this, FileName, solidname);
+#else
+    m_Future = QtConcurrent::run(this, &STLWriterDlg::writeFile, FileName, solidname);
+#endif
+}
 
 
-int STLWriterDlg::exportWingToSTLText(WingXfl const *pWing, QTextStream &outstream, int CHORDPANELS, int SPANPANELS, double scalefactor) const
+/** Runs in the export thread */
+bool STLWriterDlg::writeFile(QString const &FileName, QString const &solidname)
 {
-    Q_UNUSED(scalefactor)
-    /***
-     * solid name
-     *
-     *       facet normal ni nj nk
-     *         outer loop
-     *           vertex v1x v1y v1z
-     *           vertex v2x v2y v2z
-     *           vertex v3x v3y v3z
-     *      endloop
-     *   endfacet
-     *
-     * endsolid name
-    */
-    QString name = QString::fromStdString(pWing->name());
-    name.replace(" ","");
-    QString strong = "solid " + name + "\n";
-    outstream << strong;
-
-    Vector3d N, Pt;
-
-    std::vector<Node> PtLeft(CHORDPANELS+1);
-    std::vector<Node> PtRight(CHORDPANELS+1);
-    std::vector<Node> PtBotLeft(CHORDPANELS+1);
-    std::vector<Node> PtBotRight(CHORDPANELS+1);
-
-    //Number of triangles
-    // nSurfaces
-    //   *CHORDPANELS*SPANPANELS   quads
-    //   *2                        2 triangles/quad
-    //   *2                        top and bottom surfaces
-    // 2 Tip patches
-    //   1 LE triangle
-    //   1 TE triangle
-    //   CHORDPANELS-1  quads
-    //   *2 triangles/quad
-
-    int nTriangles = pWing->nSurfaces() * CHORDPANELS * SPANPANELS * 2 *2
-            + 2* ((CHORDPANELS-2) * 2 + 2);
-    N.set(0.0, 0.0, 0.0);
-    int iTriangles = 0;
-
-    for (int j=0; j<pWing->nSurfaces(); j++)
-    {
-        //top surface
-        for(int is=0; is<SPANPANELS; is++)
-        {
-            pWing->surfaceAt(j).getSidePoints_1(xfl::TOPSURFACE, nullptr,
-                                                PtLeft, PtRight, CHORDPANELS+1, xfl::COSINE);
+    bool bSuccess = m_StlWriter.write(FileName.toStdString(), solidname.toStdString());
+    emit outputMsg(QString::fromStdString(m_StlWriter.log()));
+    emit exportFinished(bSuccess);
+    return bSuccess;
+}
 
-            double tauA = double(is)  /double(SPANPANELS);
-            double tauB = double(is+1)/double(SPANPANELS);
-            double tau = (tauA+tauB)/2.0;
-            for(int ic=0; ic<CHORDPANELS; ic++)
-            {
-                N = (PtLeft[ic].normal()+PtLeft[ic+1].normal()) * (1.0-tau) + (PtRight[ic].normal()+PtRight[ic+1].normal()) * tau;
-                N.normalize();
-
-                //1st triangle
-                outstream << QString::asprintf("  facet normal %13.7f  %13.7f  %13.7f\n",  N.x, N.y, N.z);
-                outstream << "    outer loop\n";
-                Pt = PtLeft[ic]   * (1.0-tauA) + PtRight[ic]   * tauA;
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  Pt.x, Pt.y, Pt.z);
-                Pt = PtLeft[ic+1] * (1.0-tauA) + PtRight[ic+1] * tauA;
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  Pt.x, Pt.y, Pt.z);
-                Pt = PtLeft[ic]   * (1.0-tauB) + PtRight[ic]   * tauB;
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  Pt.x, Pt.y, Pt.z);
-                outstream << "    endloop\n  endfacet\n";
-
-                //2nd triangle
-                outstream << QString::asprintf("  facet normal %13.7f  %13.7f  %13.7f\n",  N.x, N.y, N.z);
-                outstream << "    outer loop\n";
-                Pt = PtLeft[ic]   * (1.0-tauB) + PtRight[ic]   * tauB;
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  Pt.x, Pt.y, Pt.z);
-                Pt = PtLeft[ic+1] * (1.0-tauA) + PtRight[ic+1] * tauA;
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  Pt.x, Pt.y, Pt.z);
-                Pt = PtLeft[ic+1] * (1.0-tauB) + PtRight[ic+1] * tauB;
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  Pt.x, Pt.y, Pt.z);
-                outstream << "    endloop\n  endfacet\n";
-                iTriangles +=2;
-            }
-        }
 
-        //bottom surface
-        for(int is=0; is<SPANPANELS; is++)
-        {
-            pWing->surfaceAt(j).getSidePoints_1(xfl::BOTSURFACE, nullptr, PtLeft, PtRight, CHORDPANELS+1, xfl::COSINE);
-
-            double tauA = double(is)   / double(SPANPANELS);
-            double tauB = double(is+1) / double(SPANPANELS);
-            double tau = (tauA+tauB)/2.0;
-            for(int ic=0; ic<CHORDPANELS; ic++)
-            {
-                //left side vertices
-                N = (PtLeft[ic].normal()+PtLeft[ic+1].normal()) * (1.0-tau) + (PtRight[ic].normal()+PtRight[ic+1].normal()) * tau;
-                N.normalize();
-
-                //1st triangle
-                outstream << QString::asprintf("facet normal %13.7f  %13.7f  %13.7f\n",  N.x, N.y, N.z);
-                outstream << "    outer loop\n";
-                Pt = PtLeft[ic]   * (1.0-tauA) + PtRight[ic]   * tauA;
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  Pt.x, Pt.y, Pt.z);
-                Pt = PtLeft[ic+1] * (1.0-tauA) + PtRight[ic+1] * tauA;
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  Pt.x, Pt.y, Pt.z);
-                Pt = PtLeft[ic]   * (1.0-tauB) + PtRight[ic]   * tauB;
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  Pt.x, Pt.y, Pt.z);
-                outstream << "    endloop\n  endfacet\n";
-
-                //2nd triangle
-                outstream << QString::asprintf("facet normal %13.7f  %13.7f  %13.7f\n",  N.x, N.y, N.z);
-                outstream << "    outer loop\n";
-                Pt = PtLeft[ic+1] * (1.0-tauA) + PtRight[ic+1] * tauA;
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  Pt.x, Pt.y, Pt.z);
-                Pt = PtLeft[ic+1] * (1.0-tauB) + PtRight[ic+1] * tauB;
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  Pt.x, Pt.y, Pt.z);
-                Pt = PtLeft[ic]   * (1.0-tauB) + PtRight[ic]   * tauB;
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  Pt.x, Pt.y, Pt.z);
-                outstream << "    endloop\n  endfacet\n";
-                iTriangles +=2;
-            }
-        }
-    }
+void STLWriterDlg::onProgress()
+{
+    if(m_bIsRunning)
+        m_ppbExport->setText(QString::asprintf("Cancel (%d%%)", int(m_StlWriter.progress()*100.0)));
+}
 
-    Q_ASSERT(iTriangles==pWing->nSurfaces() * CHORDPANELS * SPANPANELS * 2 *2);
 
-    //TIP PATCHES
+void STLWriterDlg::onExportFinished(bool bSuccess)
+{
+    m_ProgressTimer.stop();
+    m_bIsRunning = false;
+    m_ppbExport->setText("Export Part");
 
-    for(int j=0; j<pWing->nSurfaces(); j++)
+    if(bSuccess)
     {
-        Surface const &surf = pWing->surfaceAt(j);
-
-        if(surf.isTipLeft())
-        {
-            surf.getSidePoints_1(xfl::TOPSURFACE, nullptr, PtLeft,    PtRight, CHORDPANELS+1, xfl::COSINE);
-            surf.getSidePoints_1(xfl::BOTSURFACE, nullptr, PtBotLeft, PtBotRight, CHORDPANELS+1, xfl::COSINE);
-
-            N = surf.normal();
-            N.rotateX(90.0);
-
-            //L.E. triangle
-            outstream << QString::asprintf("  facet normal %13.7f  %13.7f  %13.7f\n",  N.x, N.y, N.z);
-            outstream << "    outer loop\n";
-            outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtBotLeft[0].x, PtBotLeft[0].y, PtBotLeft[0].z);
-            outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtLeft[1].x, PtLeft[1].y, PtLeft[1].z);
-            outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtBotLeft[1].x, PtBotLeft[1].y, PtBotLeft[1].z);
-            outstream << "    endloop\n  endfacet\n";
-            iTriangles +=1;
-
-            for(int ic=1; ic<CHORDPANELS-1; ic++)
-            {
-                //1st triangle
-                outstream << QString::asprintf("  facet normal %13.7f  %13.7f  %13.7f\n",  N.x, N.y, N.z);
-                outstream << "    outer loop\n";
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtBotLeft[ic].x, PtBotLeft[ic].y, PtBotLeft[ic].z);
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtLeft[ic].x, PtLeft[ic].y, PtLeft[ic].z);
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtBotLeft[ic+1].x, PtBotLeft[ic+1].y, PtBotLeft[ic+1].z);
-                outstream << "    endloop\n  endfacet\n";
-                //2nd triangle
-                outstream << QString::asprintf("  facet normal %13.7f  %13.7f  %13.7f\n",  N.x, N.y, N.z);
-                outstream << "    outer loop\n";
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtBotLeft[ic+1].x, PtBotLeft[ic+1].y, PtBotLeft[ic+1].z);
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtLeft[ic].x, PtLeft[ic].y, PtLeft[ic].z);
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtLeft[ic+1].x, PtLeft[ic+1].y, PtLeft[ic+1].z);
-                outstream << "    endloop\n  endfacet\n";
-                iTriangles +=2;
-            }
-            //T.E. triangle
-            int ic = CHORDPANELS-1;
-            outstream << QString::asprintf("  facet normal %13.7f  %13.7f  %13.7f\n",  N.x, N.y, N.z);
-            outstream << "    outer loop\n";
-            outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtBotLeft[ic].x, PtBotLeft[ic].y, PtBotLeft[ic].z);
-            outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtLeft[ic].x, PtLeft[ic].y, PtLeft[ic].z);
-            outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtBotLeft[ic+1].x, PtBotLeft[ic+1].y, PtBotLeft[ic+1].z);
-            outstream << "    endloop\n  endfacet\n";
-            iTriangles +=1;
-        }
-
-        if(surf.isTipRight())
-        {
-            surf.getSidePoints_1(xfl::TOPSURFACE, nullptr, PtLeft,    PtRight,    CHORDPANELS+1, xfl::COSINE);
-            surf.getSidePoints_1(xfl::BOTSURFACE, nullptr, PtBotLeft, PtBotRight, CHORDPANELS+1, xfl::COSINE);
-
-            N = surf.normal();
-            N.rotateX(-90.0);
-
-            //L.E. triangle
-            outstream << QString::asprintf("  facet normal %13.7f  %13.7f  %13.7f\n",  N.x, N.y, N.z);
-            outstream << "    outer loop\n";
-            outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtBotRight[0].x, PtBotRight[0].y, PtBotRight[0].z);
-            outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtRight[1].x, PtRight[1].y, PtRight[1].z);
-            outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtBotRight[1].x, PtBotRight[1].y, PtBotRight[1].z);
-            outstream << "    endloop\n  endfacet\n";
-            iTriangles +=1;
-
-            for(int ic=1; ic<CHORDPANELS-1; ic++)
-            {
-                //1st triangle
-                outstream << QString::asprintf("  facet normal %13.7f  %13.7f  %13.7f\n",  N.x, N.y, N.z);
-                outstream << "    outer loop\n";
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtBotRight[ic].x, PtBotRight[ic].y, PtBotRight[ic].z);
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtRight[ic].x, PtRight[ic].y, PtRight[ic].z);
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtBotRight[ic+1].x, PtBotRight[ic+1].y, PtBotRight[ic+1].z);
-                outstream << "    endloop\n  endfacet\n";
-                //2nd triangle
-                outstream << QString::asprintf("  facet normal %13.7f  %13.7f  %13.7f\n",  N.x, N.y, N.z);
-                outstream << "    outer loop\n";
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtBotRight[ic+1].x, PtBotRight[ic+1].y, PtBotRight[ic+1].z);
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtRight[ic].x, PtRight[ic].y, PtRight[ic].z);
-                outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtRight[ic+1].x, PtRight[ic+1].y, PtRight[ic+1].z);
-                outstream << "    endloop\n  endfacet\n";
-                iTriangles +=2;
-            }
-            //T.E. triangle
-            int ic = CHORDPANELS-1;
-            outstream << QString::asprintf("  facet normal %13.7f  %13.7f  %13.7f\n",  N.x, N.y, N.z);
-            outstream << "    outer loop\n";
-            outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtBotRight[ic].x, PtBotRight[ic].y, PtBotRight[ic].z);
-            outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtRight[ic].x, PtRight[ic].y, PtRight[ic].z);
-            outstream << QString::asprintf("      vertex %13.7f  %13.7f  %13.7f\n",  PtBotRight[ic+1].x, PtBotRight[ic+1].y, PtBotRight[ic+1].z);
-            outstream << "    endloop\n  endfacet\n";
-            iTriangles +=1;
-        }
+        m_pptoOutputLog->onAppendQText("The part has been successfully exported\n");
+        m_pptoOutputLog->onAppendQText(QString::asprintf("Total triangles: %d\n\n", m_StlWriter.nTriangles()));
     }
+    else
+        m_pptoOutputLog->onAppendQText("\n");
 
-    Q_ASSERT(iTriangles==nTriangles);
-
-    strong = "endsolid " + name + "\n";
-    outstream << strong;
-
-
-    return nTriangles;
+    // the triangle lists of the parts are no longer needed by the writer
+    m_StlWriter.clearParts();
 }
 
 
-int STLWriterDlg::exportSailToSTLBinary(Sail *pSail, QDataStream &outStream, int CHORDPANELS, int SPANPANELS, double scalefactor) const
-{
-    // make a triangulation for export
-//    pSail->makeTriangulation(CHORDPANELS, SPANPANELS);
-    Objects3d::makeSailTriangulation(pSail, CHORDPANELS, SPANPANELS);
-
-    return Objects3d::exportTriangulation(outStream, scalefactor, pSail->triangles());
-}
-
 
 void STLWriterDlg::loadSettings(QSettings &settings)
 {
     settings.beginGroup("StlWriterDlg");
     {
         s_bBinary         = settings.value("Binary", true).toBool();
+        s_bOBJ            = settings.value("OBJ", false).toBool();
         s_iChordPanels    = settings.value("ChordPanels", 13).toInt();
         s_iSpanPanels     = settings.value("SpanPanels", 17).toInt();
         s_LengthUnitIndex = settings.value("LengthUnitIndex", 0).toInt();
@@ -670,6 +457,7 @@ void STLWriterDlg::saveSettings(QSettings &settings)
     settings.beginGroup("StlWriterDlg");
     {
         settings.setValue("Binary", s_bBinary);
+        settings.setValue("OBJ", s_bOBJ);
         settings.setValue("ChordPanels", s_iChordPanels);
         settings.setValue("SpanPanels", s_iSpanPanels);
         settings.setValue("LengthUnitIndex",s_LengthUnitIndex);
@@ -679,132 +467,3 @@ void STLWriterDlg::saveSettings(QSettings &settings)
 }
 
 
-/** For STL export --> fuse intersections not taken into acount */
-void STLWriterDlg::makeSTLTriangulation(const WingXfl *pWingXfl, std::vector<Triangle3d> &triangles, int CHORDPANELS, int SPANPANELS, double scalefactor) const
-{
-//    int nTriangles = m_Surface.count() * CHORDPANELS * SPANPANELS * 2 *2  + 2* ((CHORDPANELS-2) * 2 + 2);
-    Vector3d Pt[3];
-    std::vector<Node> PtTopLeft(CHORDPANELS+1);
-    std::vector<Node> PtTopRight(CHORDPANELS+1);
-    std::vector<Node> PtBotLeft(CHORDPANELS+1);
-    std::vector<Node> PtBotRight(CHORDPANELS+1);
-
-    for (int j=0; j<pWingXfl->nSurfaces(); j++)
-    {
-        Surface const &surf = pWingXfl->surfaceAt(j);
-        Foil const *pFoilA = surf.foilA();
-        Foil const *pFoilB = surf.foilB();
-
-        for(int is=0; is<SPANPANELS; is++)
-        {
-            surf.getSidePoints_1(xfl::TOPSURFACE, nullptr, PtTopLeft, PtTopRight, CHORDPANELS+1, xfl::COSINE);
-            for(uint ip=0; ip<PtTopLeft.size(); ip++) PtTopLeft[ip] *=scalefactor;
-            for(uint ip=0; ip<PtTopLeft.size(); ip++) PtTopRight[ip]*=scalefactor;
-
-            surf.getSidePoints_1(xfl::BOTSURFACE, nullptr, PtBotLeft, PtBotRight, CHORDPANELS+1, xfl::COSINE);
-            for(uint ip=0; ip<PtBotLeft.size(); ip++) PtBotLeft[ip] *=scalefactor;
-            for(uint ip=0; ip<PtBotLeft.size(); ip++) PtBotRight[ip]*=scalefactor;
-
-            double tauA = double(is)   /double(SPANPANELS);
-            double tauB = double(is+1) /double(SPANPANELS);
-
-            //top surface
-            for(int ic=0; ic<CHORDPANELS; ic++)
-            {
-                //left side vertices
-                //1st triangle
-                Pt[0] = PtTopLeft[ic]   * (1.0-tauA) + PtTopRight[ic]   * tauA;
-                Pt[1] = PtTopLeft[ic+1] * (1.0-tauA) + PtTopRight[ic+1] * tauA;
-                Pt[2] = PtTopLeft[ic]   * (1.0-tauB) + PtTopRight[ic]   * tauB;
-                Triangle3d t3d0(Pt);
-                if(!t3d0.isNull()) triangles.push_back(t3d0);
-
-                //2nd triangle
-                Pt[0] = PtTopLeft[ic+1] * (1.0-tauA) + PtTopRight[ic+1] * tauA;
-                Pt[1] = PtTopLeft[ic+1] * (1.0-tauB) + PtTopRight[ic+1] * tauB;
-                Pt[2] = PtTopLeft[ic]   * (1.0-tauB) + PtTopRight[ic]   * tauB;
-                Triangle3d t3d1(Pt);
-                if(!t3d1.isNull()) triangles.push_back(t3d1);
-            }
-
-            // bot surface
-            for(int ic=0; ic<CHORDPANELS; ic++)
-            {
-                //1st triangle
-                Pt[0] = PtBotLeft[ic]   * (1.0-tauA) + PtBotRight[ic]   * tauA;
-                Pt[1] = PtBotLeft[ic]   * (1.0-tauB) + PtBotRight[ic]   * tauB;
-                Pt[2] = PtBotLeft[ic+1] * (1.0-tauA) + PtBotRight[ic+1] * tauA;
-                Triangle3d t3d0(Pt);
-                if(!t3d0.isNull()) triangles.push_back(t3d0);
-
-                //2nd triangle
-                Pt[0] = PtBotLeft[ic+1] * (1.0-tauA) + PtBotRight[ic+1] * tauA;
-                Pt[1] = PtBotLeft[ic]   * (1.0-tauB) + PtBotRight[ic]   * tauB;
-                Pt[2] = PtBotLeft[ic+1] * (1.0-tauB) + PtBotRight[ic+1] * tauB;
-                Triangle3d t3d1(Pt);
-                if(!t3d1.isNull()) triangles.push_back(t3d1);
-            }
-
-            // Trailing edge panels if gap on either side
-            if(pFoilA->TEGap()>0 || pFoilB->TEGap()>0)
-            {
-                //1st triangle
-                Pt[0] = PtBotLeft.back() * (1.0-tauA) + PtBotRight.back() * tauA;
-                Pt[1] = PtTopLeft.back() * (1.0-tauB) + PtTopRight.back() * tauB;
-                Pt[2] = PtTopLeft.back() * (1.0-tauA) + PtTopRight.back() * tauA;
-                Triangle3d t3d0(Pt);
-                if(!t3d0.isNull()) triangles.push_back(t3d0);
-
-                //2nd triangle
-                Pt[0] = PtBotLeft.back() * (1.0-tauA) + PtBotRight.back() * tauA;
-                Pt[1] = PtBotLeft.back() * (1.0-tauB) + PtBotRight.back() * tauB;
-                Pt[2] = PtTopLeft.back() * (1.0-tauB) + PtTopRight.back() * tauB;
-                Triangle3d t3d1(Pt);
-                if(!t3d1.isNull()) triangles.push_back(t3d1);
-            }
-        }
-    }
-
-    //TIP PATCHES
-    for (int j=0; j<pWingXfl->nSurfaces(); j++)
-    {
-        Surface const &surf = pWingXfl->surfaceAt(j);
-        if(surf.isTipLeft())
-        {
-            surf.getSidePoints_1(xfl::TOPSURFACE, nullptr, PtTopLeft, PtTopRight, CHORDPANELS+1, xfl::COSINE);
-            for(uint ip=0; ip<PtTopLeft.size(); ip++) PtTopLeft[ip] *=scalefactor;
-            surf.getSidePoints_1(xfl::BOTSURFACE, nullptr, PtBotLeft, PtBotRight, CHORDPANELS+1, xfl::COSINE);
-            for(uint ip=0; ip<PtTopLeft.size(); ip++) PtBotLeft[ip] *=scalefactor;
-
-            for(int ic=0; ic<CHORDPANELS; ic++)
-            {
-                //1st triangle
-                Triangle3d t3d0({PtBotLeft[ic], PtTopLeft[ic+1], PtTopLeft[ic]});
-                if(!t3d0.isNull()) triangles.push_back(t3d0);
-
-                //2nd triangle
-                Triangle3d t3d1({PtBotLeft[ic], PtBotLeft[ic+1], PtTopLeft[ic+1]});
-                if(!t3d1.isNull()) triangles.push_back(t3d1);
-            }
-        }
-
-        if(surf.isTipRight())
-        {
-            surf.getSidePoints_1(xfl::TOPSURFACE, nullptr, PtTopLeft, PtTopRight, CHORDPANELS+1, xfl::COSINE);
-            for(uint ip=0; ip<PtTopRight.size(); ip++) PtTopRight[ip]*=scalefactor;
-            surf.getSidePoints_1(xfl::BOTSURFACE, nullptr, PtBotLeft, PtBotRight, CHORDPANELS+1, xfl::COSINE);
-            for(uint ip=0; ip<PtBotRight.size(); ip++) PtBotRight[ip]*=scalefactor;
-
-            for(int ic=0; ic<CHORDPANELS; ic++)
-            {
-                //1st triangle
-                Triangle3d t3d0({PtBotRight[ic], PtTopRight[ic], PtTopRight[ic+1]});
-                if(!t3d0.isNull()) triangles.push_back(t3d0);
-
-                //2nd triangle
-                Triangle3d t3d1({PtBotRight[ic], PtTopRight[ic+1], PtBotRight[ic+1]});
-                if(!t3d1.isNull()) triangles.push_back(t3d1);
-            }
-        }
-    }
-}
@@ -33,7 +33,11 @@
 #include <QPlainTextEdit>
 #include <QComboBox>
 #include <QSettings>
+#include <QPushButton>
+#include <QTimer>
+#include <QFuture>
 
+#include <api/stlwriter.h>
 
 
 class PlaneXfl;
@@ -43,8 +47,6 @@ class Fuse;
 class Sail;
 class IntEdit;
 class PlainTextOutput;
-class Triangle3d;
-class TriMesh;
 
 class STLWriterDlg : public QDialog
 {
@@ -54,16 +56,11 @@ class STLWriterDlg : public QDialog
         STLWriterDlg(QWidget *pParent);
         void initDialog(PlaneXfl *pPlane, WingXfl *pWing, Fuse *pFuse, Sail *pSail);
 
-        int exportWingToSTLText(const WingXfl *pWing, QTextStream &outStream, int CHORDPANELS, int SPANPANELS, double scalefactor) const;
-
-        int exportSailToSTLBinary(Sail *pSail, QDataStream &outStream, int CHORDPANELS, int SPANPANELS, double scalefactor) const;
-
-        void makeSTLTriangulation(WingXfl const *pWingXfl, std::vector<Triangle3d> &triangles, int CHORDPANELS, int SPANPANELS, double scalefactor=1.0) const;
-
 
         QSize sizeHint() const override {return QSize(700,700);}
 
         void accept() override;
+        void reject() override;
         void showEvent(QShowEvent *pEvent) override;
         void hideEvent(QHideEvent *pEvent) override;
 
@@ -71,16 +68,24 @@ class STLWriterDlg : public QDialog
         static void saveSettings(QSettings &settings);
 
         static bool s_bBinary;
+        static bool s_bOBJ;
         static int s_iChordPanels;
         static int s_iSpanPanels;
 
     private:
         void setupLayout();
         void readParams();
+        bool writeFile(QString const &FileName, QString const &solidname);
+
+    signals:
+        void outputMsg(QString);
+        void exportFinished(bool);
 
     private slots:
         void onSetLabels();
         void onExporttoSTL();
+        void onExportFinished(bool bSuccess);
+        void onProgress();
 
     private:
         PlaneXfl const *m_pPlane;
@@ -91,13 +96,19 @@ class STLWriterDlg : public QDialog
 
 
         IntEdit *m_pieChordPanels, *m_pieSpanPanels;
-        QRadioButton *m_prbBinary, *m_prbASCII;
+        QRadioButton *m_prbBinary, *m_prbASCII, *m_prbOBJ;
+        QPushButton *m_ppbExport;
         QListWidget *m_plwNameList;
         QLabel *m_plabChord, *m_plabSpan;
         PlainTextOutput *m_pptoOutputLog;
         QComboBox *m_pcbLengthUnitSel;
         QStringList m_SelectedList;
 
+        StlWriter m_StlWriter;
+        QFuture<bool> m_Future;
+        QTimer m_ProgressTimer;
+        bool m_bIsRunning;
+
 
         static int s_LengthUnitIndex;
         static QByteArray s_Geometry;
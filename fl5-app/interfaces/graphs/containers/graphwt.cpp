@@ -56,6 +56,8 @@ GraphWt::GraphWt(QWidget *pParent) : QWidget(pParent)
 
     m_bOverlayRectangle = false;
 
+    m_StaticKey = 0;
+
     m_bTransGraph = false;
     m_bXPressed = m_bYPressed = false;
 
@@ -132,7 +134,31 @@ void GraphWt::paintEvent(QPaintEvent* )
     painter.setBackgroundMode(Qt::TransparentMode);
     painter.setBackground(BackBrush);
 
-    m_pGraph->drawGraph(painter, rect());
+    if(m_pGraph->hasLiveCurve())
+    {
+        // draw the static part from the cache, so that appending points to a live curve
+        // only costs the drawing of that curve
+        qreal dpr = devicePixelRatioF();
+        QSize pixsize(int(width()*dpr), int(height()*dpr));
+        if(m_StaticPixmap.size()!=pixsize || m_StaticKey!=m_pGraph->staticKey(rect()))
+        {
+            m_StaticPixmap = QPixmap(pixsize);
+            m_StaticPixmap.setDevicePixelRatio(dpr);
+            m_StaticPixmap.fill(m_pGraph->backgroundColor());
+            QPainter pixpainter(&m_StaticPixmap);
+            pixpainter.setBackgroundMode(Qt::TransparentMode);
+            pixpainter.setBackground(BackBrush);
+            m_pGraph->drawGraph(pixpainter, rect(), false);
+            m_StaticKey = m_pGraph->staticKey(rect()); // the scales may have been set while drawing
+        }
+        painter.drawPixmap(0, 0, m_StaticPixmap);
+        m_pGraph->drawLiveCurves(painter, rect());
+    }
+    else
+    {
+        m_StaticPixmap = QPixmap();
+        m_pGraph->drawGraph(painter, rect());
+    }
 
     if(m_bOverlayRectangle)
     {
@@ -193,6 +219,8 @@ void GraphWt::resizeEvent (QResizeEvent * pEvent)
     QPoint pos3(width()-m_plabInfoOutput->width()-10, height()-m_plabInfoOutput->height()-10);
     m_plabInfoOutput->move(pos3);
 
+    m_StaticPixmap = QPixmap();
+
     if(m_pGraph)
     {
         m_pGraph->invalidate();
@@ -841,6 +869,7 @@ void GraphWt::onGraphSettings()
 
     emit graphChanged(m_pGraph);
     m_pGraph->invalidate();
+    m_StaticPixmap = QPixmap(); // fonts, grids and titles are not part of the static key
     update();
 }
 
@@ -28,6 +28,7 @@
 #include <QTimer>
 #include <QElapsedTimer>
 #include <QLabel>
+#include <QPixmap>
 
 #include <core/fontstruct.h>
 #include <interfaces/graphs/graph/graph.h>
@@ -151,5 +152,8 @@ class GraphWt : public QWidget
 
 
         QLabel *m_plabInfoOutput;
+
+        QPixmap m_StaticPixmap;   /**< the graph without its live curves, redrawn only when Graph::staticKey() changes */
+        quint64 m_StaticKey;
 };
 
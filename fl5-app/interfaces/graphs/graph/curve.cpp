@@ -22,6 +22,8 @@
 
 *****************************************************************************/
 
+#include <cmath>
+
 #include <core/xflcore.h>
 #include <interfaces/graphs/graph/curve.h>
 #include <interfaces/graphs/graph/graph.h>
@@ -43,6 +45,12 @@ Curve::Curve()
     m_bLeftAxis = true;
 
     m_iSelectedPt = -1;
+
+    m_bLive = false;
+    m_Revision = 0;
+    m_DecScaleX = m_DecScaleY = 0.0;
+    m_DecRevision = -1;
+    m_nDecimated = m_OpenColumn = m_nOpenColumn = 0;
 }
 
 
@@ -53,6 +61,12 @@ Curve::Curve(Curve const &curve)
     m_bLeftAxis = curve.m_bLeftAxis;
     m_iSelectedPt = -1;
     m_pts = curve.m_pts;
+
+    m_bLive = false;
+    m_Revision = 0;
+    m_DecScaleX = m_DecScaleY = 0.0;
+    m_DecRevision = -1;
+    m_nDecimated = m_OpenColumn = m_nOpenColumn = 0;
 }
 
 
@@ -101,6 +115,7 @@ void Curve::popFront()
     {
         m_pts.pop_front();
         m_Tag.pop_front();
+        m_Revision++;
     }
 }
 
@@ -108,6 +123,7 @@ void Curve::popFront()
 void Curve::setPoints(std::vector<double> const &xc, std::vector<double> const&yc)
 {
     m_pts.clear();
+    m_Revision++;
     for(uint i=0; i<std::min(xc.size(), yc.size()); i++)
     {
         m_pts.append({xc.at(i), yc.at(i)});
@@ -118,6 +134,7 @@ void Curve::setPoints(std::vector<double> const &xc, std::vector<double> const&y
 void Curve::setPoints(QVector<double> const &xc, QVector<double> const&yc)
 {
     m_pts.clear();
+    m_Revision++;
     for(int i=0; i<std::min(xc.size(), yc.size()); i++)
     {
         m_pts.append({xc.at(i), yc.at(i)});
@@ -140,6 +157,60 @@ void Curve::copyData(Curve const*pCurve)
 {
     if(!pCurve) return;
     m_pts = pCurve->m_pts;
+    m_Revision++;
+}
+
+
+/**
+ * Returns the points to draw as a polyline at the given scales, keeping in each pixel column
+ * only the first, the lowest, the highest and the last point.
+ * The result is cached until the scales or the points change; appended points are processed
+ * incrementally from the last column, so that a live curve is not decimated again in full.
+ * Since the columns are counted from the origin rather than from the viewport, a translation
+ * of the graph does not invalidate the cache.
+ */
+QPolygonF const &Curve::decimated(double scalex, double scaley) const
+{
+    if(scalex!=m_DecScaleX || scaley!=m_DecScaleY || m_DecRevision!=m_Revision || m_nDecimated>m_pts.size())
+    {
+        m_Decimated.clear();
+        m_DecScaleX = scalex;
+        m_DecScaleY = scaley;
+        m_DecRevision = m_Revision;
+        m_nDecimated = m_OpenColumn = m_nOpenColumn = 0;
+    }
+
+    if(m_nDecimated==m_pts.size()) return m_Decimated;
+
+    // re-open the last column, which the appended points may continue
+    m_Decimated.resize(m_Decimated.size()-m_nOpenColumn);
+
+    int i = m_OpenColumn;
+    while(i<m_pts.size())
+    {
+        int i0 = i;
+        double column = std::floor(m_pts.at(i).x()*scalex);
+        int imin = i, imax = i;
+        for(i++; i<m_pts.size() && std::floor(m_pts.at(i).x()*scalex)==column; i++)
+        {
+            if(m_pts.at(i).y()*scaley<m_pts.at(imin).y()*scaley) imin = i;
+            if(m_pts.at(i).y()*scaley>m_pts.at(imax).y()*scaley) imax = i;
+        }
+
+        // keep the order of the points so that the polyline runs through the column as the curve does
+        int const idx[] = {i0, std::min(imin, imax), std::max(imin, imax), i-1};
+        m_OpenColumn = i0;
+        m_nOpenColumn = 0;
+        for(int k=0; k<4; k++)
+        {
+            if(k>0 && idx[k]==idx[k-1]) continue;
+            m_Decimated.append(m_pts.at(idx[k]));
+            m_nOpenColumn++;
+        }
+    }
+    m_nDecimated = int(m_pts.size());
+
+    return m_Decimated;
 }
 
 
@@ -60,9 +60,9 @@ class Curve
         int  appendPoint(double xn, double yn, QString const &tag);
         void popFront();
 
-        void clear() {m_pts.clear(); m_Tag.clear();}
+        void clear() {m_pts.clear(); m_Tag.clear(); m_Revision++;}
         void reset() {clear();}
-        void resize(int n) {m_pts.resize(n);}
+        void resize(int n) {m_pts.resize(n); m_Revision++;}
 
         double x(int ic) const {if(ic>=0 && ic<m_pts.size()) return m_pts.at(ic).x(); else return 0;}
         double y(int ic) const {if(ic>=0 && ic<m_pts.size()) return m_pts.at(ic).y(); else return 0;}
@@ -79,10 +79,16 @@ class Curve
         void copyData(const Curve *pCurve);
         void duplicate(const Curve *pCurve);
 
-        void setPoint(int ic, double xc, double yc) {if(ic>=0 && ic<m_pts.size()) {m_pts[ic]={xc,yc};}}
+        void setPoint(int ic, double xc, double yc) {if(ic>=0 && ic<m_pts.size()) {m_pts[ic]={xc,yc}; m_Revision++;}}
         void setPoints(std::vector<double> const &xc, std::vector<double> const&yc);
         void setPoints(QVector<double> const &xc, QVector<double> const&yc);
-        void setPoints(QPolygonF const &pts) {m_pts=pts;}
+        void setPoints(QPolygonF const &pts) {m_pts=pts; m_Revision++;}
+
+        QPolygonF const &decimated(double scalex, double scaley) const;
+        int revision() const {return m_Revision;}
+
+        bool isLive() const {return m_bLive;}
+        void setLive(bool bLive) {m_bLive=bLive;}
 
         int selectedPoint() const {return m_iSelectedPt;}
         void setSelectedPoint(int n) {m_iSelectedPt = n;}
@@ -140,7 +146,7 @@ class Curve
     public:
         //	Curve Data
 
-        QPolygonF m_pts;          /**< the array of points */
+        QPolygonF m_pts;          /**< the array of points; modify through the methods so that the decimation cache follows */
 
         QStringList m_Tag;
 
@@ -151,6 +157,17 @@ class Curve
 
         bool m_bLeftAxis;
 
+        bool m_bLive;                         /**< true if points are appended to the curve while it is displayed */
+        int m_Revision;                       /**< incremented on each change of the points other than an append */
+
+        // the min/max per pixel column decimation of the points for the last requested scales
+        mutable QPolygonF m_Decimated;
+        mutable double m_DecScaleX, m_DecScaleY;
+        mutable int m_DecRevision;
+        mutable int m_nDecimated;             /**< the number of points processed into m_Decimated */
+        mutable int m_OpenColumn;             /**< the index of the first point of the last pixel column, which may be continued by appended points */
+        mutable int m_nOpenColumn;            /**< the number of points of m_Decimated in the last pixel column */
+
         static int s_DefaultLineWidth;
         static bool s_bAlignChildren;
 };
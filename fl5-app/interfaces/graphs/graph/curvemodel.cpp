@@ -362,3 +362,50 @@ QColor CurveModel::color(int idx)
     if(idx<0 || idx>=s_CurveColor.size()) return Qt::gray;
     return s_CurveColor[idx%s_CurveColor.size()];
 }
+
+
+static quint64 variablePair(int XVar, int YVar)
+{
+    return (quint64(quint32(XVar))<<32) | quint64(quint32(YVar));
+}
+
+
+/**
+ * Returns the points cached for the object's curve of YVar vs. XVar, or nullptr if there are none or if they were
+ * extracted from another revision of the object's data.
+ * The pointer is valid until the next call to a non-const cache function.
+ */
+QPolygonF const *CurveModel::cachedPoints(void const *pObject, int XVar, int YVar, qint64 revision) const
+{
+    auto it = m_PointCache.constFind(pObject);
+    if(it==m_PointCache.constEnd()) return nullptr;
+    auto jt = it->constFind(variablePair(XVar, YVar));
+    if(jt==it->constEnd() || jt->m_Revision!=revision) return nullptr;
+    return &jt->m_Pts;
+}
+
+
+/** Stores the points of the object's curve of YVar vs. XVar; the entries of the object for older revisions are discarded */
+void CurveModel::cachePoints(void const *pObject, int XVar, int YVar, qint64 revision, QPolygonF const &pts)
+{
+    QHash<quint64, CachedPoints> &entries = m_PointCache[pObject];
+    for(auto it=entries.begin(); it!=entries.end();)
+    {
+        if(it->m_Revision!=revision) it = entries.erase(it);
+        else                         ++it;
+    }
+    CachedPoints &entry = entries[variablePair(XVar, YVar)];
+    entry.m_Revision = revision;
+    entry.m_Pts = pts;
+}
+
+
+/** Removes the points of the objects which are not in the set, e.g. those of the polars which have been deleted */
+void CurveModel::trimCache(QSet<void const*> const &objects)
+{
+    for(auto it=m_PointCache.begin(); it!=m_PointCache.end();)
+    {
+        if(!objects.contains(it.key())) it = m_PointCache.erase(it);
+        else                            ++it;
+    }
+}
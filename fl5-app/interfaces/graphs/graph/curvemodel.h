@@ -25,6 +25,8 @@
 
 #pragma once
 
+#include <QHash>
+#include <QSet>
 #include <QVector>
 
 
@@ -68,13 +70,28 @@ class CurveModel
         bool selectCurve(QString const & curvename);
         bool isCurveSelected(Curve const *pCurve) const {return m_SelectedCurve==pCurve;}
 
+        QPolygonF const *cachedPoints(void const *pObject, int XVar, int YVar, qint64 revision) const;
+        void cachePoints(void const *pObject, int XVar, int YVar, qint64 revision, QPolygonF const &pts);
+        void trimCache(QSet<void const*> const &objects);
+        void clearCache() {m_PointCache.clear();}
+
         static void setColorList(const QVector<QColor> &colors) {s_CurveColor=colors;}
         static QColor color(int idx);
 
+    private:
+        /** The points of an object's curve for a pair of variables, and the revision of the object's data from which they were extracted */
+        struct CachedPoints
+        {
+            qint64 m_Revision{-1};
+            QPolygonF m_Pts;
+        };
+
     private:
         QVector<Curve*> m_oaCurve;
         Curve const* m_SelectedCurve;
 
+        QHash<void const*, QHash<quint64, CachedPoints>> m_PointCache; /**< by object, then by pair of variables; survives the deletion of the curves */
+
 
         static QVector<QColor> s_CurveColor;
 };
@@ -23,6 +23,7 @@
 *****************************************************************************/
 
 #include <cmath>
+#include <cstring>
 
 #include <QApplication>
 #include <QClipboard>
@@ -43,6 +44,8 @@ bool Graph::s_bAntiAliasing = true;
 bool Graph::s_bHighlightObject = true;
 bool Graph::s_bShowMousePos = true;
 
+int Graph::s_DecimationThreshold = 256;
+
 Graph::Graph()
 {
     m_pCurveModel = nullptr;
@@ -493,7 +496,12 @@ Curve* Graph::getClosestPoint(double x, double y, double &xSel, double &ySel, in
 }
 
 
-void Graph::drawGraph(QPainter &painter, QRectF const &graphrect)
+/**
+ * Draws the graph's frame, grids, axes, curves and titles.
+ * @param bLiveCurves if false, the curves flagged as live are skipped so that the result can be
+ * cached in a pixmap and the live curves drawn on top with drawLiveCurves().
+ */
+void Graph::drawGraph(QPainter &painter, QRectF const &graphrect, bool bLiveCurves)
 {
     QColor color;
     painter.save();
@@ -527,8 +535,10 @@ void Graph::drawGraph(QPainter &painter, QRectF const &graphrect)
     if(m_pCurveModel)
     {
         for (int ic=0; ic<m_pCurveModel->curveCount(); ic++)
+        {
+            if(!bLiveCurves && curve(ic)->isLive()) continue;
             drawCurve(ic, painter);
-
+        }
     }
 
     drawTitles(painter, graphrect);
@@ -538,6 +548,79 @@ void Graph::drawGraph(QPainter &painter, QRectF const &graphrect)
 }
 
 
+/** Draws only the curves flagged as live, on top of a graph previously drawn without them. */
+void Graph::drawLiveCurves(QPainter &painter, QRectF const &graphrect) const
+{
+    if(!m_pCurveModel) return;
+
+    painter.save();
+    painter.setRenderHint(QPainter::Antialiasing, s_bAntiAliasing);
+    painter.setClipRect(graphrect);
+    for (int ic=0; ic<m_pCurveModel->curveCount(); ic++)
+    {
+        if(curve(ic)->isLive()) drawCurve(ic, painter);
+    }
+    painter.setClipping(false);
+    painter.restore();
+}
+
+
+bool Graph::hasLiveCurve() const
+{
+    if(!m_pCurveModel) return false;
+    for (int ic=0; ic<m_pCurveModel->curveCount(); ic++)
+    {
+        if(curve(ic)->isLive()) return true;
+    }
+    return false;
+}
+
+
+/**
+ * Returns a key which changes whenever the image of the graph without its live curves would change,
+ * i.e. the viewport, the scales, the colours, and the data and style of the static curves.
+ * The caller is expected to invalidate its cache as well when the graph's settings are edited.
+ */
+quint64 Graph::staticKey(QRectF const &graphrect) const
+{
+    quint64 key = 14695981039346656037ULL;
+    auto mix = [&key](quint64 v) {key = (key ^ v) * 1099511628211ULL;};
+    auto mixd = [&mix](double d) {quint64 v=0; memcpy(&v, &d, sizeof(double)); mix(v);};
+
+    mixd(graphrect.left());  mixd(graphrect.top());  mixd(graphrect.width()); mixd(graphrect.height());
+    mixd(m_XAxis.axmin());   mixd(m_XAxis.axmax());  mixd(m_XAxis.scale());
+    for(int iy=0; iy<2; iy++)
+    {
+        mixd(m_YAxis[iy].axmin()); mixd(m_YAxis[iy].axmax()); mixd(m_YAxis[iy].scale());
+        mixd(m_ptOffset[iy].x());  mixd(m_ptOffset[iy].y());
+    }
+    mix(m_BkColor.rgba());
+    mix(m_bInitialized ? 1 : 0);
+    mix(s_bHighlightObject ? 1 : 0);
+
+    if(m_pCurveModel)
+    {
+        for (int ic=0; ic<m_pCurveModel->curveCount(); ic++)
+        {
+            Curve const *pCurve = curve(ic);
+            if(pCurve->isLive()) continue;
+            mix(quint64(quintptr(pCurve)));
+            mix(quint64(pCurve->revision()));
+            mix(quint64(pCurve->size()));
+            mix(pCurve->qColor().rgba());
+            mix(quint64(pCurve->stipple()));
+            mix(quint64(pCurve->width()));
+            mix(quint64(pCurve->symbol()));
+            mix(pCurve->isVisible() ? 1 : 0);
+            mix(quint64(pCurve->tagSize()));
+            mix(quint64(pCurve->selectedPoint()+1));
+            mix(m_pCurveModel->isCurveSelected(pCurve) ? 1 : 0);
+        }
+    }
+    return key;
+}
+
+
 void Graph::drawGrids(QPainter &painter)
 {
 
@@ -650,7 +733,10 @@ void Graph::drawCurve(int nIndex, QPainter &painter) const
 
         if(pCurve->stipple()!=Line::NOLINE)
         {
-            painter.drawPolyline(pCurve->points());
+            if(pCurve->size()>s_DecimationThreshold)
+                painter.drawPolyline(pCurve->decimated(m_XAxis.scale(), scaley));
+            else
+                painter.drawPolyline(pCurve->points());
         }
 
         painter.resetTransform();
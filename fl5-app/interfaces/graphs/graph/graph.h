@@ -239,7 +239,10 @@ class Graph
 
     public:
         void toClipboard();
-        virtual void drawGraph(QPainter &painter, const QRectF &graphRect);
+        virtual void drawGraph(QPainter &painter, const QRectF &graphRect, bool bLiveCurves=true);
+        void drawLiveCurves(QPainter &painter, QRectF const &graphRect) const;
+        bool hasLiveCurve() const;
+        quint64 staticKey(QRectF const &graphRect) const;
         void drawAxes(QPainter &painter) const;
         void drawYAxis(int iy, QPainter &painter) const;
         void drawCurve(int nIndex, QPainter &painter) const;
@@ -392,5 +395,6 @@ class Graph
         static bool s_bHighlightObject;       /**< true if the active OpPoint should be highlighted on the polar curve. */
         static bool s_bShowMousePos;
 
+        static int s_DecimationThreshold;     /**< the number of points above which the curves are decimated per pixel column before drawing */
 };
 
@@ -51,6 +51,8 @@
 #endif
 
 #include <algorithm>
+#include <array>
+#include <unordered_map>
 
 #include <BOPTools_AlgoTools3D.hxx>
 #include <BRepAdaptor_Curve.hxx>
@@ -71,9 +73,12 @@
 #include "afmesher.h"
 
 #include <api/constants.h>
+#include <api/delaunay2d.h>
 #include <api/occ_globals.h>
+#include <api/pointhash.h>
 #include <api/pslg2d.h>
 #include <api/sail.h>
+#include <api/threadpool.h>
 #include <api/triangle3d.h>
 #include <api/units.h>
 #include <api/xflmesh.h>
@@ -97,6 +102,7 @@ double AFMesher::s_GrowthFactor = 1.0;
 double AFMesher::s_MaxEdgeLength = 0.25;
 int AFMesher::s_MaxPanelCount = 1000;
 bool AFMesher::s_bDelaunay = true;
+bool AFMesher::s_bConstrainedDelaunay = false;
 
 int AFMesher::s_AnimationPause = 30;
 bool AFMesher::s_bIsAnimating = false;
@@ -150,20 +156,19 @@ void AFMesher::triangulateShells()
 
 bool AFMesher::triangulateShell(TopoDS_Shell const &shell, std::vector<Triangle3d> &triangles, QString &logmsg)
 {
-    QString strange;
-
     s_Triangles.clear();
     s_SLG.clear();
 
     logmsg.clear();
 
     TopExp_Explorer ShellExplorer;
-    int nFace=0;
-
+    std::vector<TopoDS_Face> faces;
     for(ShellExplorer.Init(shell,TopAbs_FACE); ShellExplorer.More(); ShellExplorer.Next())
     {
-        nFace++;
+        faces.push_back(TopoDS::Face(ShellExplorer.Current()));
     }
+    int nFace = int(faces.size());
+
     m_FaceTriangles.resize(nFace);
     m_Segs.resize(nFace);
     for(int o=0; o<nFace; o++)
@@ -172,37 +177,23 @@ bool AFMesher::triangulateShell(TopoDS_Shell const &shell, std::vector<Triangle3
         m_Segs[o].clear();
     }
 
-/*    if(s_bMultiThread && !s_bIsAnimating)
+    if(s_bIsAnimating)
     {
-        QFutureSynchronizer<void> futureSync;
-        int iFace = 0;
-        for(ShellExplorer.Init(shell, TopAbs_FACE); ShellExplorer.More(); ShellExplorer.Next())
+        // the animation shows the progression of the fronts one face at a time
+        for(int iFace=0; iFace<nFace; iFace++)
         {
             if(s_TraceFaceIdx<0 || iFace==s_TraceFaceIdx)
-            {
-                TopoDS_Face const &aFace = TopoDS::Face(ShellExplorer.Current());
-                futureSync.addFuture(QtConcurrent::run(this, &AFMesher::triangulateFace,
-                                                       aFace, iFace));
-            }
-            iFace++;
+                triangulateFace(faces.at(iFace), iFace);
         }
-        futureSync.waitForFinished();
     }
-    else*/
+    else
     {
-        int iFace = 0;
-        for(ShellExplorer.Init(shell, TopAbs_FACE); ShellExplorer.More(); ShellExplorer.Next())
+        // the faces are meshed independently and write to their own arrays
+        ThreadPool::pool().parallelFor(nFace, [this, &faces](int iFace)
         {
             if(s_TraceFaceIdx<0 || iFace==s_TraceFaceIdx)
-            {
-                TopoDS_Face const &aFace = TopoDS::Face(ShellExplorer.Current());
-                strange.clear();
-                if(!triangulateFace(aFace, iFace))
-                {
-                }
-            }
-            iFace++;
-        }
+                triangulateFace(faces.at(iFace), iFace);
+        });
     }
 
     s_SLG.clear();
@@ -257,6 +248,14 @@ bool AFMesher::triangulateFace(TopoDS_Face const &aFace, int iFace)
     for(int i=0; i<innerslg.size(); i++)
         m_Segs[iFace].append(innerslg[i]);
 
+    if(s_bConstrainedDelaunay)
+    {
+        bool bMeshed = makeDelaunayTriangles(aFace, contourpslg2d, innerpslg2d, m_FaceTriangles[iFace], strange);
+        logmsg += strange;
+        postMessageEvent(logmsg);
+        return bMeshed;
+    }
+
     if(!makeTriangles(aFace, m_Segs[iFace], m_FaceTriangles[iFace], s_MaxEdgeLength, s_MaxPanelCount, strange))
     {
         logmsg += strange;
@@ -512,12 +511,11 @@ bool AFMesher::makeTriangles(TopoDS_Face const &aFace,
                              double MaxEdgeLength, double MaxPanelCount,
                              QString &logmsg) const
 {
-    std::vector<Triangle3d> starttriangles = s_Triangles; // for animation
+    std::vector<Triangle3d> starttriangles; // for animation
+    if(s_bIsAnimating) starttriangles = s_Triangles;
 
     SLG3d &front = slg3d;
 
-    std::vector<Node> frontnodes;
-    front.makeNodes(frontnodes);
     Triangle3d triangle;
 
     int iseg=0;
@@ -537,6 +535,9 @@ bool AFMesher::makeTriangles(TopoDS_Face const &aFace,
         return true;
     }
 
+    // the neighbourhood searches are made on a grid rather than over the whole front
+    front.makeIndex();
+
     while(front.size()>0)
     {
         iter++;
@@ -622,7 +623,7 @@ bool AFMesher::makeTriangles(TopoDS_Face const &aFace,
                 QString strange;
                 strange = QString::asprintf("***Unconverged: Could not build triangle at iteration %d\n", iter);
                 logmsg += strange;
-                slg3d = front;
+                front.clearIndex();
                 return false;
             }
 
@@ -834,11 +835,139 @@ bool AFMesher::makeTriangles(TopoDS_Face const &aFace,
         logmsg += strange;
     }
 
-    slg3d = front;
+    front.clearIndex();
     return true;
 }
 
 
+/**
+ * Triangulates the face in its parametric space with the constrained Delaunay mesher, then maps the triangles on the surface.
+ * The parameters are scaled with the mean first derivatives of the surface, so that the parametric triangles
+ * are close in shape to the surface triangles. The contour is not split, so that the nodes on the edges shared
+ * with the other faces are the same as with the advancing front mesher.
+ */
+bool AFMesher::makeDelaunayTriangles(TopoDS_Face const &aFace, PSLG2d const &contourpslg2d, QVector<PSLG2d> const &innerpslg2d,
+                                     std::vector<Triangle3d> &facetriangles, QString &logmsg) const
+{
+    double umin=0, umax=0, vmin=0, vmax=0;
+    BRepTools::UVBounds(aFace, umin, umax, vmin, vmax);
+    double du = umax-umin;
+    double dv = vmax-vmin;
+
+    Handle(Geom_Surface) aSurface = BRep_Tool::Surface(aFace);
+
+    double su=0, sv=0;
+    int ns=0;
+    try
+    {
+        gp_Pnt Pt;
+        gp_Vec D1U, D1V;
+        for(int i=1; i<=3; i++)
+        {
+            for(int j=1; j<=3; j++)
+            {
+                aSurface->D1(umin+du*double(i)/4.0, vmin+dv*double(j)/4.0, Pt, D1U, D1V);
+                su += D1U.Magnitude();
+                sv += D1V.Magnitude();
+                ns++;
+            }
+        }
+    }
+    catch(Standard_Failure &failure)
+    {
+        logmsg += "   makeDelaunayTriangles:: standard exception" + QString(failure.GetMessageString()) + "\n";
+        return false;
+    }
+    su /= double(ns);
+    sv /= double(ns);
+    if(su<PRECISION || sv<PRECISION) su = sv = 1.0;
+
+    // the scaled PSLGs, with the face on the left of the segments
+    std::vector<PSLG2d> pslgs(1+innerpslg2d.size());
+    pslgs[0] = contourpslg2d;
+    pslgs[0].setSplittable(false);
+    for(int i=0; i<innerpslg2d.size(); i++)
+    {
+        pslgs[i+1] = innerpslg2d.at(i);
+        pslgs[i+1].setSplittable(m_bSplittableInnerPSLG);
+    }
+    double area = 0.0;
+    for(PSLG2d &pslg : pslgs)
+    {
+        for(Segment2d &seg : pslg)
+            seg.setVertices(Vector2d(seg.vertexAt(0).x*su, seg.vertexAt(0).y*sv), Vector2d(seg.vertexAt(1).x*su, seg.vertexAt(1).y*sv));
+    }
+    for(Segment2d const &seg : pslgs.front())
+        area += seg.vertexAt(0).x*seg.vertexAt(1).y - seg.vertexAt(1).x*seg.vertexAt(0).y;
+    if(area<0.0)
+    {
+        for(PSLG2d &pslg : pslgs) pslg.reverse();
+    }
+
+    Delaunay2d delaunay;
+    delaunay.setMaxEdgeLength(s_MaxEdgeLength);
+    delaunay.setMaxTriangles(s_MaxPanelCount);
+    delaunay.setMapping([&aSurface, su, sv](double u, double v)
+    {
+        gp_Pnt Pt = aSurface->Value(u/su, v/sv);
+        return Vector3d(Pt.X(), Pt.Y(), Pt.Z());
+    });
+
+    bool bRecovered = false;
+    try
+    {
+        bRecovered = delaunay.triangulate(pslgs);
+    }
+    catch(Standard_Failure &failure)
+    {
+        logmsg += "   makeDelaunayTriangles:: standard exception" + QString(failure.GetMessageString()) + "\n";
+        return false;
+    }
+    logmsg += QString::fromStdString(delaunay.log());
+    if(delaunay.nTriangles()==0) return false;
+
+    // the nodes and their normals, as in makeFaceSLG3dFrom2d()
+    std::vector<Node> nodes(delaunay.nNodes());
+    double insidefrac = 0.05;
+    for(int in=0; in<delaunay.nNodes(); in++)
+    {
+        double u = delaunay.node(in).x/su;
+        double v = delaunay.node(in).y/sv;
+        GeomLProp_SLProps props(aSurface, u, v, 1, 1.e-6);
+        gp_Pnt Pt = props.Value();
+        nodes[in].set(Pt.X(), Pt.Y(), Pt.Z());
+
+        u = qMax(u, umin+insidefrac*du);    u=qMin(u, umax-insidefrac*du);  // it can occur that the normal is undefined on the edge itself
+        v = qMax(v, vmin+insidefrac*dv);    v=qMin(v, vmax-insidefrac*dv);
+        props.SetParameters(u,v);
+        if(props.IsNormalDefined())
+        {
+            gp_Dir Dir = props.Normal();
+            nodes[in].setNormal(Dir.X(), Dir.Y(), Dir.Z());
+        }
+        if(s_bCancel) return false;
+    }
+
+    // the triangles are oriented positively around the face normal, i.e. opposite to the surface normal for a reversed face
+    bool bReversed = aFace.Orientation()==TopAbs_REVERSED;
+    facetriangles.reserve(facetriangles.size()+delaunay.nTriangles());
+    for(int it=0; it<delaunay.nTriangles(); it++)
+    {
+        std::array<int,3> const &tri = delaunay.triangle(it);
+        Node const &n0 = nodes.at(tri[0]);
+        Node const &n1 = nodes.at(tri[1]);
+        Node const &n2 = nodes.at(tri[2]);
+        Triangle3d t3d(n0, n1, n2);
+        Vector3d N = n0.normal() + n1.normal() + n2.normal();
+        if((t3d.normal().dot(N)<0.0) != bReversed) t3d.setTriangle(n0, n2, n1);
+        facetriangles.push_back(t3d);
+    }
+
+    logmsg += QString::asprintf("         made %d triangles with %d segment splits\n", delaunay.nTriangles(), delaunay.nSplitSegments());
+    return bRecovered;
+}
+
+
 void AFMesher::postAnimateEvent() const
 {
     MeshEvent *pMeshEvent = new MeshEvent();
@@ -997,83 +1126,179 @@ void AFMesher::makeFacePSLG2d(const TopoDS_Face &aFace,
 }
 
 
+/**
+ * Makes the Delaunay flips of the triangles' edges.
+ * The edges are identified by the indexes of their end nodes, so that the triangles adjacent to an edge
+ * are found without a search. Initially all the inner edges are tested; in the next rounds, only the
+ * edges of the quadrilaterals which have been flipped are tested again, until no edge needs flipping.
+ * @param nFlips the number of flips made
+ * @param nIter the number of rounds
+ */
 void AFMesher::makeDelaunayFlips(std::vector<Triangle3d> &triangles, int &nFlips, int &nIter) const
 {
     nFlips = 0;
-//    makeConnections(); // no use, connections change at each flip
     nIter = 0;
-    int iterflips=0;
 
-    do
+    int const maxrounds = 100;
+    int nTriangles = int(triangles.size());
+
+    // index the vertices
+    PointHash hash(1.e-5);
+    hash.reserve(nTriangles);
+    std::vector<Vector3d> nodes;
+    std::vector<std::array<int,3>> vertex(nTriangles);
+    std::vector<int> candidates;
+    for(int it=0; it<nTriangles; it++)
     {
-        iterflips=0;
-        for(uint it=0; it<triangles.size(); it++)
+        for(int ivtx=0; ivtx<3; ivtx++)
         {
-            Triangle3d &t2d = triangles[it];
-            for(uint it2=it+1; it2<triangles.size(); it2++)
+            Vector3d const &vtx = triangles.at(it).vertexAt(ivtx);
+            int index = -1;
+            hash.candidates(vtx, candidates);
+            for(int in : candidates)
             {
-                Triangle3d &t2n = triangles[it2];
-                for(int ie0=0; ie0<3; ie0++)
+                if(nodes.at(in).isSame(vtx, 1.e-6))
                 {
-                    Segment3d testedge = t2d.edge(ie0); // copy to modify in-place
-
-                    int ien = t2n.edgeIndex(testedge, 1.e-6);
-                    if(ien>=0)
-                    {
-                        // compare opposite angles
-                        double alpha0 = t2d.angle(ie0);
-                        double alphan = t2n.angle(ien);
-
-                        if(alpha0+alphan>181.0) // +1° in case of two 90° angles which cause infinite flips
-                        {
-                            //perform Delaunay flip
-                            Node vtx0 = t2d.vertexAt(ie0); // copy to modify in-place
-                            Node vtxn = t2n.vertexAt(ien); // copy to modify in-place
-                            t2d.setTriangle(vtx0, testedge.vertexAt(0), vtxn);
-                            t2n.setTriangle(vtx0, vtxn, testedge.vertexAt(1));
-                            nFlips++;
-                            iterflips++;
-                            break;
-                        }
-                    }
+                    index = in;
+                    break;
                 }
-                if(s_bCancel) break;
             }
-            if(it%10==0)
+            if(index<0)
             {
-                
+                index = int(nodes.size());
+                nodes.push_back(vtx);
+                hash.insert(vtx, index);
             }
-            if(s_bCancel) break;
+            vertex[it][ivtx] = index;
         }
+    }
 
-        QString strange = QString::asprintf("     %2d flips at iteration %2d\n", iterflips, nIter+1);
-        postMessageEvent(strange);
+    // map the edges to their adjacent triangles
+    struct EdgeTriangles
+    {
+        int m_iTriangle[2]{-1,-1};
+        bool m_bManifold{true};
+        bool m_bQueued{false};
+    };
+    auto edgeKey = [](int n0, int n1) {return (uint64_t(std::min(n0,n1))<<32) | uint64_t(std::max(n0,n1));};
+
+    std::unordered_map<uint64_t, EdgeTriangles> edges;
+    edges.reserve(3*nTriangles/2+1);
+    for(int it=0; it<nTriangles; it++)
+    {
+        for(int ie=0; ie<3; ie++)
+        {
+            EdgeTriangles &et = edges[edgeKey(vertex[it][(ie+1)%3], vertex[it][(ie+2)%3])];
+            if     (et.m_iTriangle[0]<0) et.m_iTriangle[0] = it;
+            else if(et.m_iTriangle[1]<0) et.m_iTriangle[1] = it;
+            else                         et.m_bManifold = false;
+        }
+    }
 
-        nIter++;
+    std::vector<uint64_t> queue, nextqueue;
+    auto enqueue = [&edges, &nextqueue](uint64_t key)
+    {
+        EdgeTriangles &et = edges[key];
+        if(et.m_bQueued || !et.m_bManifold || et.m_iTriangle[1]<0) return;
+        et.m_bQueued = true;
+        nextqueue.push_back(key);
+    };
+
+    for(int it=0; it<nTriangles; it++)
+    {
+        for(int ie=0; ie<3; ie++) enqueue(edgeKey(vertex[it][(ie+1)%3], vertex[it][(ie+2)%3]));
+    }
+
+    while(nextqueue.size() && nIter<maxrounds && !s_bCancel)
+    {
+        queue.swap(nextqueue);
+        nextqueue.clear();
+        for(uint64_t key : queue) edges[key].m_bQueued = false;
+
+        for(uint64_t key : queue)
+        {
+            auto itedge = edges.find(key);
+            if(itedge==edges.end()) continue;
+            int t0 = itedge->second.m_iTriangle[0];
+            int t1 = itedge->second.m_iTriangle[1];
+            if(t0<0 || t1<0 || t0==t1) continue;
+            int n0 = int(key>>32);
+            int n1 = int(key & 0xffffffff);
+
+            // the vertices opposite to the edge
+            int ie0=-1, ien=-1;
+            for(int ivtx=0; ivtx<3; ivtx++)
+            {
+                if(vertex[t0][ivtx]!=n0 && vertex[t0][ivtx]!=n1) ie0 = ivtx;
+                if(vertex[t1][ivtx]!=n0 && vertex[t1][ivtx]!=n1) ien = ivtx;
+            }
+            if(ie0<0 || ien<0) continue;
+            // the flip would duplicate an existing edge
+            if(edges.count(edgeKey(vertex[t0][ie0], vertex[t1][ien]))) continue;
+
+            Triangle3d &t2d = triangles[t0];
+            Triangle3d &t2n = triangles[t1];
+
+            // compare opposite angles
+            double alpha0 = t2d.angle(ie0);
+            double alphan = t2n.angle(ien);
+            if(alpha0+alphan<=181.0) continue; // +1° in case of two 90° angles which cause infinite flips
+
+            //perform Delaunay flip
+            Node vtx0 = t2d.vertexAt(ie0); // copy to modify in-place
+            Node vtxn = t2n.vertexAt(ien); // copy to modify in-place
+            Segment3d testedge = t2d.edge(ie0); // copy to modify in-place
+            t2d.setTriangle(vtx0, testedge.vertexAt(0), vtxn);
+            t2n.setTriangle(vtx0, vtxn, testedge.vertexAt(1));
+            nFlips++;
+
+            int a = vertex[t0][ie0];
+            int b = vertex[t0][(ie0+1)%3];
+            int c = vertex[t0][(ie0+2)%3];
+            int d = vertex[t1][ien];
+            vertex[t0] = {a, b, d};
+            vertex[t1] = {a, d, c};
+
+            // the edge bc is replaced by ad, and the edges bd and ca change sides
+            EdgeTriangles flipped = itedge->second;
+            edges.erase(itedge);
+            flipped.m_bQueued = false;
+            flipped.m_iTriangle[0] = t0;
+            flipped.m_iTriangle[1] = t1;
+            edges[edgeKey(a,d)] = flipped;
+
+            for(int &t : edges[edgeKey(b,d)].m_iTriangle) {if(t==t1) t=t0;}
+            for(int &t : edges[edgeKey(c,a)].m_iTriangle) {if(t==t0) t=t1;}
+
+            enqueue(edgeKey(a,b));
+            enqueue(edgeKey(b,d));
+            enqueue(edgeKey(d,c));
+            enqueue(edgeKey(c,a));
+        }
 
-        if(s_bCancel) break;
+        nIter++;
     }
-    while(iterflips>0 && nIter<10);
 }
 
 
 /** Builds the edge SLG for the free mesh.
     Only used for thin sails of the NURBS or SPLINE types.*/
-void AFMesher::makeEdgeSLG(Sail *pSail, SLG3d & slg) const
+/**
+ * Makes the parameters of the vertices of the sail's contour, in the order of the sides, so that the
+ * lengths of the contour's segments follow the sail's edge splits.
+ * The first and the last vertex are both at (0,0).
+ */
+void AFMesher::makeEdgeUV(Sail *pSail, std::vector<Vector2d> &uv) const
 {
-//    int nVtx = (m_NXPanels+1)*2+(m_NZPanels+1)*2 - 3;
     int nVtx = 1;
     std::vector<EdgeSplit> const& es = pSail->edgeSplit().front();
 
     for(int i=0; i<4; i++) nVtx += es[i].nSegs();
 
-    slg.resize(nVtx-1);
-
-    QVector<Node> Vtx(nVtx);
+    uv.resize(nVtx);
     int ivtx=0;
-    Vtx[ivtx++].set(pSail->edgeNode(0,0));
+    uv[ivtx++].set(0,0);
 
-    Node P0, P1;
     int nSegs(0);
     double umin(0), umax(0),vmin(0), vmax(0);
     double u0(0), u1(0), v0(0), v1(0);
@@ -1122,8 +1347,6 @@ void AFMesher::makeEdgeSLG(Sail *pSail, SLG3d & slg) const
             v0 = vmin;
             v1 = vmax;
 
-            P0 = pSail->edgeNode(u0, v0);
-            P1 = pSail->edgeNode(u1, v1);
             iter = 0;
             do
             {
@@ -1141,10 +1364,24 @@ void AFMesher::makeEdgeSLG(Sail *pSail, SLG3d & slg) const
             }
             while(fabs(length-tl)>eps && iter++<20);
 
-            Vtx[ivtx++] = pSail->edgeNode((u0+u1)/2.0, (v0+v1)/2.0);
+            uv[ivtx++].set((u0+u1)/2.0, (v0+v1)/2.0);
         }
-        Vtx[ivtx++] = pSail->edgeNode(umax, vmax);
+        uv[ivtx++].set(umax, vmax);
     }
+}
+
+
+void AFMesher::makeEdgeSLG(Sail *pSail, SLG3d & slg) const
+{
+    std::vector<Vector2d> uv;
+    makeEdgeUV(pSail, uv);
+    if(uv.size()<2) return;
+
+    slg.resize(uv.size()-1);
+
+    QVector<Node> Vtx(int(uv.size()));
+    for(int i=0; i<Vtx.size(); i++)
+        Vtx[i] = pSail->edgeNode(uv.at(i).x, uv.at(i).y);
 
     for(int i=0; i<Vtx.size()-1; i++)
     {
@@ -1153,6 +1390,62 @@ void AFMesher::makeEdgeSLG(Sail *pSail, SLG3d & slg) const
 }
 
 
+/**
+ * Meshes the sail in its parametric space with the constrained Delaunay mesher.
+ * The parameters are scaled with the chord and the span of the sail, so that the parametric triangles are close
+ * in shape to the surface triangles. The contour vertices are the same as with the advancing front mesher.
+ */
+bool AFMesher::makeSailDelaunayTriangles(Sail *pSail, QString &logmsg)
+{
+    std::vector<Vector2d> uv;
+    makeEdgeUV(pSail, uv);
+    if(uv.size()<4) return false;
+
+    double su = 0.5*(pSail->edgeLength(0,0,1,0) + pSail->edgeLength(0,1,1,1));
+    double sv = 0.5*(pSail->edgeLength(0,0,0,1) + pSail->edgeLength(1,0,1,1));
+    if(su<PRECISION || sv<PRECISION) su = sv = 1.0;
+
+    // the contour runs clockwise in the (u,v) plane: reverse it to have the sail on the left
+    std::vector<PSLG2d> pslgs(1);
+    for(int i=int(uv.size())-1; i>=1; i--)
+    {
+        Vector2d vtx0(uv.at(i).x*su,   uv.at(i).y*sv);
+        Vector2d vtx1(uv.at(i-1).x*su, uv.at(i-1).y*sv);
+        if(vtx0.distanceTo(vtx1)>PRECISION) pslgs[0].appendSegment(vtx0, vtx1);
+    }
+    pslgs[0].setSplittable(false);
+
+    Delaunay2d delaunay;
+    delaunay.setMaxEdgeLength(pSail->maxElementSize());
+    delaunay.setMaxTriangles(s_MaxPanelCount);
+    delaunay.setMapping([pSail, su, sv](double u, double v) {return pSail->point(u/su, v/sv);});
+
+    bool bRecovered = delaunay.triangulate(pslgs);
+    logmsg += QString::fromStdString(delaunay.log());
+    if(delaunay.nTriangles()==0) return false;
+
+    std::vector<Node> nodes(delaunay.nNodes());
+    for(int in=0; in<delaunay.nNodes(); in++)
+        nodes[in] = pSail->edgeNode(delaunay.node(in).x/su, delaunay.node(in).y/sv);
+
+    // orient the triangles along the sail's normal, as in the advancing front mesh
+    m_Triangles.reserve(m_Triangles.size()+delaunay.nTriangles());
+    for(int it=0; it<delaunay.nTriangles(); it++)
+    {
+        std::array<int,3> const &tri = delaunay.triangle(it);
+        Node const &n0 = nodes.at(tri[0]);
+        Node const &n1 = nodes.at(tri[1]);
+        Node const &n2 = nodes.at(tri[2]);
+        Triangle3d t3d(n0, n1, n2);
+        if(t3d.normal().dot(n0.normal()+n1.normal()+n2.normal())<0.0) t3d.setTriangle(n0, n2, n1);
+        m_Triangles.push_back(t3d);
+    }
+
+    logmsg += QString::asprintf("   made %d triangles\n", delaunay.nTriangles());
+    return bRecovered;
+}
+
+
 bool AFMesher::makeThinSailMesh()
 {
     if(!m_pSail)
@@ -1184,11 +1477,24 @@ bool AFMesher::makeThinSailMesh()
 
     logmsg = QString::asprintf("   made %d free edges\n", int(slg3d.size()));
 
+    if(s_bConstrainedDelaunay)
+    {
+        m_bError = !makeSailDelaunayTriangles(m_pSail, logmsg);
+        postMessageEvent(logmsg);
+
+        s_SLG = slg3d;
+        MeshEvent *pMeshEvent = new MeshEvent(m_Triangles);
+        qApp->postEvent(m_pParent, pMeshEvent);
+
+        emit meshFinished();
+        thread()->exit(0); // exit event loop so that finished() is emitted
+        return !m_bError;
+    }
+
     SLG3d front = slg3d;
     std::vector<int> intersected;
     std::vector<Vector3d> I;
-    std::vector<Node> frontnodes, insidenodes, closenodes;
-    front.makeNodes(frontnodes);
+    std::vector<Node> insidenodes, closenodes;
     Triangle3d triangle, t3d, t3d_test;
     Segment3d baseseg, previous, next, seg1, seg2;
     int iseg=0, inext=0, iprevious=0, iter=0;
@@ -1210,6 +1516,9 @@ bool AFMesher::makeThinSailMesh()
         return true;
     }
 
+    // the neighbourhood searches are made on a grid rather than over the whole front
+    front.makeIndex();
+
     while(front.size()>0)
     {
         iter++;
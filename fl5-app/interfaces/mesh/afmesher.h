@@ -28,6 +28,7 @@
 
 
 #include <api/triangle3d.h>
+#include <api/vector2d.h>
 #include <api/edgesplit.h>
 #include <api/flow5events.h>
 #include <interfaces/mesh/slg3d.h>
@@ -88,6 +89,9 @@ class AFMesher : public QObject
         static void setDelaunayFlips(bool b) {s_bDelaunay=b;}
         static bool bDelaunayFlips() {return s_bDelaunay;}
 
+        static void setConstrainedDelaunay(bool b) {s_bConstrainedDelaunay=b;}
+        static bool bConstrainedDelaunay() {return s_bConstrainedDelaunay;}
+
 
         static void setMaxPanelCount(int imax) {s_MaxPanelCount=imax;}
         static int maxPanelCount() {return s_MaxPanelCount;}
@@ -108,10 +112,14 @@ class AFMesher : public QObject
 
         void makeFaceSLG3dFrom2d(TopoDS_Face const &aFace, PSLG2d const &pslg2d, SLG3d &pslg3d, QString &logmsg) const;
         void makeFaceSLG3d(const TopoDS_Face &aFace, QVector<SLG3d> &innerslg, SLG3d &contourpslgUV, QString &logmsg) const;
+        bool makeDelaunayTriangles(TopoDS_Face const &aFace, PSLG2d const &contourpslg2d, QVector<PSLG2d> const &innerpslg2d,
+                                   std::vector<Triangle3d> &facetriangles, QString &logmsg) const;
 
         // Sail mesh
         bool makeEquiTriangleOnSail(const Sail *pSail, Segment3d const &baseseg, double maxedgelength, double growthfactor, Triangle3d &triangle);
+        void makeEdgeUV(Sail *pSail, std::vector<Vector2d> &uv) const;
         void makeEdgeSLG(Sail *pSail, SLG3d & slg) const;
+        bool makeSailDelaunayTriangles(Sail *pSail, QString &logmsg);
 
     signals:
         void meshFinished();
@@ -157,6 +165,7 @@ class AFMesher : public QObject
         static double s_GrowthFactor;
         static int s_MaxPanelCount;
         static bool s_bDelaunay;
+        static bool s_bConstrainedDelaunay; /** if true, the faces and the sails are meshed in their parametric space with the constrained Delaunay mesher */
 };
 
 
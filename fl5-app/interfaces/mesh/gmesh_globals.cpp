@@ -23,8 +23,10 @@
 *****************************************************************************/
 
 #include <QDebug>
+#include <QElapsedTimer>
 
 #include <filesystem>
+#include <mutex>
 
 
 
@@ -48,6 +50,43 @@
 #include <api/wingxfl.h>
 #include <api/sailocc.h>
 #include <api/occ_globals.h>
+#include <api/trace.h>
+
+
+namespace
+{
+    std::once_flag s_GmshOnce;
+    bool s_bGmshInitialized = false;
+}
+
+
+/**
+ * Initializes gmsh and sets the application's default options, on the first call only.
+ * Must be called before any gmsh function which builds a model or accesses the options,
+ * so that the cost of the initialization is only paid by sessions which use gmsh.
+ */
+void gmesh::initialize()
+{
+    std::call_once(s_GmshOnce, []()
+    {
+        QElapsedTimer t;
+        t.start();
+        gmsh::initialize();
+        gmsh::option::setNumber("General.Terminal", 0);
+        gmsh::option::setNumber("Geometry.OCCParallel", 1.0);
+        s_bGmshInitialized = true;
+        xfl::trace(QString::asprintf("gmsh initialized in %lld ms\n", t.elapsed()));
+    });
+}
+
+
+/** Finalizes gmsh if it has been initialized */
+void gmesh::finalize()
+{
+    if(!s_bGmshInitialized) return;
+    gmsh::finalize();
+    s_bGmshInitialized = false;
+}
 
 
 
@@ -81,6 +120,8 @@ void gmesh::listMainOptions(std::string &list)
 
 std::string gmesh::getNumberOption(std::string name)
 {
+    gmesh::initialize();
+
     int nchar = 37;
     double number(0);
     gmsh::option::getNumber(name, number);
@@ -93,6 +134,8 @@ std::string gmesh::getNumberOption(std::string name)
 
 std::string gmesh::getStringOption(std::string name)
 {
+    gmesh::initialize();
+
     int nchar = 37;
     std::string optionvalue;
     gmsh::option::getString(name, optionvalue);
@@ -389,6 +432,8 @@ std::string gmesh::tempFile()
 
 bool gmesh::importBRepList(std::vector<std::string> const &breps, std::string &brep)
 {
+    gmesh::initialize();
+
     // no option to gmsh::merge from a string in v4.14.1,
     // so write them one by one to a file and import back
     std::string temppath = tempFile();
@@ -476,6 +521,8 @@ bool gmesh::gmshtoBRep(std::string &brep)
 /** It would really be nice to have gmesh::merge(std::string) */
 bool gmesh::BReptoGmsh(std::string const &brep)
 {
+    gmesh::initialize();
+
     std::string temppath = tempFile();
 
 
@@ -496,6 +543,8 @@ bool gmesh::BReptoGmsh(std::string const &brep)
 
 bool gmesh::BRepstoGmsh(const std::vector<std::string> &brep)
 {
+    gmesh::initialize();
+
     std::string temppath = tempFile();
 
 
@@ -519,6 +568,8 @@ bool gmesh::BRepstoGmsh(const std::vector<std::string> &brep)
 
 void gmesh::bRepToStepFile(const std::string &brep, const std::string &pathname)
 {
+    gmesh::initialize();
+
     std::string temppath = tempFile();
 
     xfl::stringToFile(brep, temppath);
@@ -566,6 +617,8 @@ void gmesh::getBoundingBox(Vector3d &botleft, Vector3d &topright)
 
 bool gmesh::rotateBrep(std::string const&brep, Vector3d const &O, Vector3d const &axis, double theta, std::string &rotated)
 {
+    gmesh::initialize();
+
     if(fabs(theta)<ANGLEPRECISION) return false;
 
     gmsh::clear();
@@ -592,6 +645,8 @@ bool gmesh::rotateBrep(std::string const&brep, Vector3d const &O, Vector3d const
 
 bool gmesh::scaleBrep(std::string const&brep, Vector3d const &O, double sx, double sy, double sz, std::string &scaled)
 {
+    gmesh::initialize();
+
     gmsh::clear();
     gmsh::model::add("BRep");
 
@@ -616,6 +671,8 @@ bool gmesh::scaleBrep(std::string const&brep, Vector3d const &O, double sx, doub
 
 bool gmesh::translateBrep(std::string const&brep, Vector3d const &T, std::string &translated)
 {
+    gmesh::initialize();
+
     gmsh::clear();
     gmsh::model::add("BRep");
 
@@ -641,6 +698,8 @@ bool gmesh::translateBrep(std::string const&brep, Vector3d const &T, std::string
 // untested
 bool gmesh::wingToBRep(const WingXfl *pWing, std::string &brep, QString &log)
 {
+    gmesh::initialize();
+
     if(!pWing) return false;
 
     gmsh::clear();
@@ -753,6 +812,8 @@ bool gmesh::wingToBRep(const WingXfl *pWing, std::string &brep, QString &log)
 
 bool gmesh::fuseQuadsToBRep(FuseFlatFaces const*pFuse, std::string &brep, std::string &log)
 {
+    gmesh::initialize();
+
     if(!pFuse) return false;
 
     gmsh::clear();
@@ -836,6 +897,8 @@ bool gmesh::fuseQuadsToBRep(FuseFlatFaces const*pFuse, std::string &brep, std::s
 
 bool gmesh::fuseNurbsToBRep(FuseNurbs const*pFuse, std::string &brep, std::string &log)
 {
+    gmesh::initialize();
+
     if(!pFuse) return false;
 
     gmsh::clear();
@@ -875,6 +938,8 @@ bool gmesh::fuseNurbsToBRep(FuseNurbs const*pFuse, std::string &brep, std::strin
 bool gmesh::intersectBrep(std::string const &brep, std::vector<Node> const &A, std::vector<Node> const &B,
                           std::vector<Vector3d> &I, std::vector<bool> &bIntersect)
 {
+    gmesh::initialize();
+
     assert(A.size()==B.size());
     assert(A.size()==I.size());
     assert(A.size()==bIntersect.size());
@@ -1033,6 +1098,8 @@ bool gmesh::intersectBrep(std::string const &brep, std::vector<Node> const &A, s
 
 void gmesh::tessellateBRep(std::string const&BRep, GmshParams const &params, std::vector<Triangle3d> &triangles, QString &log)
 {
+    gmesh::initialize();
+
     gmsh::clear();
     gmsh::model::add("BRep");
 
@@ -1059,6 +1126,8 @@ void gmesh::tessellateBRep(std::string const&BRep, GmshParams const &params, std
 
 void gmesh::tessellateShape(TopoDS_Shape const&Shape, GmshParams const &params, std::vector<Triangle3d> &triangles, QString &log)
 {
+    gmesh::initialize();
+
     gmsh::clear();
     gmsh::model::add("TopoDS_Shape");
 
@@ -1075,6 +1144,8 @@ void gmesh::tessellateShape(TopoDS_Shape const&Shape, GmshParams const &params,
 /** @todo unusable: importShapesNativePointer throws an unknown exception */
 void gmesh::tessellateFace(TopoDS_Face const&Face, GmshParams const &params, std::vector<Triangle3d> &triangles, QString &log)
 {
+    gmesh::initialize();
+
     gmsh::clear();
     gmsh::model::add("Face");
 
@@ -48,6 +48,9 @@ struct GmshParams;
 
 namespace gmesh
 {
+    void initialize();
+    void finalize();
+
     void listMainOptions(std::string &list);
     std::string getNumberOption(std::string name);
     std::string getStringOption(std::string name);
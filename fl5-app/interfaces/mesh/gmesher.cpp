@@ -27,35 +27,64 @@
 #define _MATH_DEFINES_DEFINED
 
 
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+#include <QCoreApplication>
+
 #include "gmesher.h"
 #include <api/sail.h>
 #include <api/sailnurbs.h>
+#include <api/triangle3d.h>
+
+#include <interfaces/mesh/gmesh_globals.h>
+#include <interfaces/mesh/meshevent.h>
 
 #include <gmsh.h>
 
 
 GMesher::GMesher(QObject *parent) : QObject{parent}
 {
-
+    m_pEventDest = nullptr;
 }
 
 
-void setGmshParams(double emin, double emax, int iAlgo, int iCurvature)
+/** The number of threads used by gmsh for the given parameters; 0 means all the available cores */
+int GMesher::threadCount(GmshParams const &params)
 {
-    gmsh::option::setNumber("Mesh.Algorithm", iAlgo);
-    gmsh::option::setNumber("Mesh.MeshSizeMin", emin);
-    gmsh::option::setNumber("Mesh.MeshSizeMax", emax);
-    gmsh::option::setNumber("Mesh.MeshSizeFromCurvature", iCurvature);
+    if(params.m_nThreads>0) return params.m_nThreads;
+    return std::max(1, int(std::thread::hardware_concurrency()));
 }
 
 
+/**
+ * Meshes the current gmsh model.
+ * The curves are meshed first, then the surfaces are meshed in parallel by gmsh,
+ * one surface per thread. The triangles of each surface are then posted to the event
+ * destination as they are read so that the progress can be displayed before the
+ * full mesh has been converted.
+ */
 void GMesher::onMeshCurrentModel()
 {
+    gmesh::initialize();
+
     bool bError = false;
 
+    int nThreads = threadCount(m_GmshParams);
+
     try
     {
+        gmsh::option::setNumber("General.NumThreads",    nThreads);
+        gmsh::option::setNumber("Mesh.MaxNumThreads1D",  nThreads);
+        gmsh::option::setNumber("Mesh.MaxNumThreads2D",  nThreads);
+
+        emit displayMessage(QString::asprintf("Meshing with %d thread(s)\n", nThreads));
+
+        gmsh::model::mesh::generate(1);
         gmsh::model::mesh::generate(2);
+
+        streamSurfaces();
     }
     catch(...)
     {
@@ -65,6 +94,51 @@ void GMesher::onMeshCurrentModel()
 }
 
 
+void GMesher::streamSurfaces()
+{
+    if(!m_pEventDest) return;
+
+    gmsh::vectorpair dimTags;
+    gmsh::model::getEntities(dimTags, 2);
 
+    std::vector<std::size_t> elementTags, elementNodeTags;
+    std::vector<std::size_t> nodeTags;
+    std::vector<double> coord, parametricCoord;
+    std::unordered_map<std::size_t, int> nodeindex;
 
+    int nSurfaces = int(dimTags.size());
+    for(int is=0; is<nSurfaces; is++)
+    {
+        int tag = dimTags.at(is).second;
+
+        gmsh::model::mesh::getElementsByType(2, elementTags, elementNodeTags, tag);
+        gmsh::model::mesh::getNodes(nodeTags, coord, parametricCoord, 2, tag, true, false);
+
+        nodeindex.clear();
+        nodeindex.reserve(nodeTags.size());
+        for(uint in=0; in<nodeTags.size(); in++) nodeindex[nodeTags.at(in)] = int(in);
+
+        std::vector<Triangle3d> triangles;
+        triangles.reserve(elementTags.size());
+        for(uint it=0; 3*it+2<elementNodeTags.size(); it++)
+        {
+            Vector3d vtx[3];
+            bool bValid = true;
+            for(int iv=0; iv<3; iv++)
+            {
+                auto pos = nodeindex.find(elementNodeTags.at(3*it+iv));
+                if(pos==nodeindex.end())
+                {
+                    bValid = false;
+                    break;
+                }
+                vtx[iv].set(coord.at(3*pos->second), coord.at(3*pos->second+1), coord.at(3*pos->second+2));
+            }
+            if(bValid) triangles.push_back(Triangle3d(vtx));
+        }
+
+        emit displayMessage(QString::asprintf("   surface %d/%d: %d triangles\n", is+1, nSurfaces, int(triangles.size())));
+        QCoreApplication::postEvent(m_pEventDest, new MeshEvent(triangles));
+    }
+}
 
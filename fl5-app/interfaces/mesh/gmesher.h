@@ -28,6 +28,7 @@
 #include <QObject>
 
 #include <api/flow5events.h>
+#include <api/gmshparams.h>
 
 
 class GMesher : public QObject
@@ -36,16 +37,23 @@ class GMesher : public QObject
     public:
         GMesher(QObject *parent = nullptr);
 
-        void setGmshParams(double emin, double emax, int iAlgo, int iCurvature);
+        void setGmshParams(GmshParams const &params) {m_GmshParams=params;}
+        void setEventDestination(QObject *pDest) {m_pEventDest=pDest;}
+
+        static int threadCount(GmshParams const &params);
 
     public slots:
         void onMeshCurrentModel();
 
+    private:
+        void streamSurfaces();
+
     signals:
         void meshDone(bool bError);
         void displayMessage(QString const &msg);
 
     private:
-
+        GmshParams m_GmshParams;
+        QObject *m_pEventDest; /**< the object to which the surface meshes are posted as they are read */
 };
 
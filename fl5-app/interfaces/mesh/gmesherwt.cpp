@@ -69,6 +69,7 @@
 
 
 int GMesherWt::s_idxAlgo = 0;
+int GMesherWt::s_nThreads = 0;
 
 GMesherWt::GMesherWt(QWidget *pParent) : QFrame{pParent}
 {
@@ -84,6 +85,7 @@ GMesherWt::GMesherWt(QWidget *pParent) : QFrame{pParent}
     setupLayout();
 
     m_pWorker = new GMesher;
+    m_pWorker->setEventDestination(this);
     m_pWorker->moveToThread(&m_MeshThread);
     connect(&m_MeshThread, &QThread::finished,          m_pWorker,  &QObject::deleteLater);
     connect(this,          &GMesherWt::meshCurrent,     m_pWorker,  &GMesher::onMeshCurrentModel);
@@ -94,9 +96,6 @@ GMesherWt::GMesherWt(QWidget *pParent) : QFrame{pParent}
 
     connect(&m_LogTimer, SIGNAL(timeout()), SLOT(onCheckLogger()));
 
-
-    gmsh::option::setNumber("General.NumThreads", 16);
-
     std::string list;
     gmesh::listMainOptions(list);
     m_ppto->onAppendStdText(list);
@@ -145,6 +144,11 @@ void GMesherWt::setupLayout()
                                         "Recommendation: between 10 and 50.</p>");
             QLabel *plab2Pi = new QLabel("<p>/2&pi;</p>");
 
+            QLabel *plabThreads = new QLabel("Threads=");
+            m_pieThreads = new IntEdit(s_nThreads);
+            m_pieThreads->setToolTip("<p>The number of threads used by gmsh to mesh the surfaces in parallel.<br>"
+                                     "Set to 0 to use all the available cores.</p>");
+
             QLabel *plabAlgo = new QLabel("Algorithm:");
             m_pcbMeshAlgo = new QComboBox;
             {
@@ -210,7 +214,9 @@ void GMesherWt::setupLayout()
             pMeshOptionLayout->addWidget(plab2Pi,            3, 3);
             pMeshOptionLayout->addWidget(plabAlgo,           4, 1);
             pMeshOptionLayout->addWidget(m_pcbMeshAlgo,      4, 2);
-            pMeshOptionLayout->addWidget(m_ppbMesh,          5, 1, 1, 2);
+            pMeshOptionLayout->addWidget(plabThreads,        5, 1);
+            pMeshOptionLayout->addWidget(m_pieThreads,       5, 2);
+            pMeshOptionLayout->addWidget(m_ppbMesh,          6, 1, 1, 2);
             pMeshOptionLayout->setColumnStretch(4,1);
         }
 
@@ -227,6 +233,8 @@ void GMesherWt::setupLayout()
 
 bool GMesherWt::readMeshSize()
 {
+    gmesh::initialize();
+
     GmshParams m_GmshParams;
 
     double const MINSIZE = 0.0001;
@@ -244,6 +252,8 @@ bool GMesherWt::readMeshSize()
     m_GmshParams.m_MinSize = m_pfeMinSize->value()/Units::mtoUnit();
     m_GmshParams.m_MaxSize = m_pfeMaxSize->value()/Units::mtoUnit();
     m_GmshParams.m_nCurvature = m_pieFromCurvature->value();
+    s_nThreads = std::max(0, m_pieThreads->value());
+    m_GmshParams.m_nThreads = s_nThreads;
     if     (m_pFuse) m_pFuse->setGmshParams(m_GmshParams);
     else if(m_pSail) m_pSail->setGmshParams(m_GmshParams);
 
@@ -251,6 +261,9 @@ bool GMesherWt::readMeshSize()
     gmsh::option::setNumber("Mesh.MeshSizeMax", m_GmshParams.m_MaxSize);
     gmsh::option::setNumber("Mesh.MeshSizeFromCurvature", m_GmshParams.m_nCurvature);
 
+    // the worker is idle until meshCurrent() is emitted
+    m_pWorker->setGmshParams(m_GmshParams);
+
     return true;
 }
 
@@ -284,6 +297,7 @@ void GMesherWt::loadSettings(QSettings &settings)
     settings.beginGroup("GMesherWt");
     {
         s_idxAlgo = settings.value("Algorithm", s_idxAlgo).toInt();
+        s_nThreads = settings.value("NumThreads", s_nThreads).toInt();
     }
     settings.endGroup();
 }
@@ -294,6 +308,7 @@ void GMesherWt::saveSettings(QSettings &settings)
     settings.beginGroup("GMesherWt");
     {
         settings.setValue("Algorithm", s_idxAlgo);
+        settings.setValue("NumThreads", s_nThreads);
     }
     settings.endGroup();
 }
@@ -457,8 +472,32 @@ void GMesherWt::convertFromGmsh()
 }
 
 
+/**
+ * Receives the surface meshes as they are read by the worker and forwards the
+ * triangles accumulated so far to the parent as a non-final mesh event.
+ */
+void GMesherWt::customEvent(QEvent *pEvent)
+{
+    if(pEvent->type() == MESH_UPDATE_EVENT)
+    {
+        MeshEvent const *pMeshEvent = dynamic_cast<MeshEvent*>(pEvent);
+        if(!pMeshEvent) return;
+
+        m_StreamedTriangles.insert(m_StreamedTriangles.end(), pMeshEvent->triangles().begin(), pMeshEvent->triangles().end());
+
+        MeshEvent *pUpdateEvent = new MeshEvent(m_StreamedTriangles);
+        pUpdateEvent->setFinal(false);
+        qApp->postEvent(m_pParent, pUpdateEvent);
+    }
+    else
+        QFrame::customEvent(pEvent);
+}
+
+
 void GMesherWt::onHandleMeshResults(bool bError)
 {
+    m_StreamedTriangles.clear();
+
     while(QApplication::overrideCursor()!=nullptr)
         QApplication::restoreOverrideCursor();
 
@@ -524,6 +563,8 @@ void GMesherWt::onHandleMeshResults(bool bError)
 
 void GMesherWt::meshNURBSSail()
 {
+    gmesh::initialize();
+
     SailNurbs *pNurbsSail = dynamic_cast<SailNurbs*>(m_pSail);
     if(!pNurbsSail) return;
 
@@ -582,6 +623,8 @@ void GMesherWt::meshNURBSSail()
 
 void GMesherWt::meshSplineSail()
 {
+    gmesh::initialize();
+
     SailSpline *pSplineSail = dynamic_cast<SailSpline*>(m_pSail);
     if(!pSplineSail) return;
 
@@ -692,6 +735,8 @@ void GMesherWt::meshSplineSail()
 
 void GMesherWt::meshOccSail()
 {
+    gmesh::initialize();
+
     SailOcc *pOccSail = dynamic_cast<SailOcc*>(m_pSail);
     if(!pOccSail) return;
 
@@ -726,6 +771,8 @@ void GMesherWt::meshOccSail()
 
 void GMesherWt::meshFuseShellsThinSurfaces()
 {
+    gmesh::initialize();
+
     if(!m_pFuse) return;
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
@@ -845,6 +892,8 @@ void GMesherWt::meshFuseShellsThinSurfaces()
 
 void GMesherWt::meshFuseShellsThickSurfaces()
 {
+    gmesh::initialize();
+
     if(!m_pFuse) return;
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
@@ -969,6 +1018,7 @@ void GMesherWt::onMesh()
     if(!readMeshSize()) return;
 
     m_ppto->clear();
+    m_StreamedTriangles.clear();
 
     setEnabled(false);
     if(m_pFuse)
@@ -71,6 +71,9 @@ class GMesherWt : public QFrame
         static void loadSettings(QSettings &settings);
         static void saveSettings(QSettings &settings);
 
+    protected:
+        void customEvent(QEvent *pEvent) override;
+
     private slots:
         void onCheckLogger();
         void onHandleMeshResults(bool bError);
@@ -98,6 +101,7 @@ class GMesherWt : public QFrame
     private:
         FloatEdit *m_pfeMinSize, *m_pfeMaxSize;
         IntEdit *m_pieFromCurvature;
+        IntEdit *m_pieThreads;
         QComboBox *m_pcbMeshAlgo;
 
         QPushButton *m_ppbMesh;
@@ -116,6 +120,7 @@ class GMesherWt : public QFrame
 
         std::vector<Triangle3d> m_Triangles; /**< the resulting triangles */
         std::vector<Node> m_Nodes;
+        std::vector<Triangle3d> m_StreamedTriangles; /**< the triangles of the surfaces streamed so far by the mesher */
 
         QVector<QVector<Vector3d>> m_Curves;
 
@@ -128,5 +133,6 @@ class GMesherWt : public QFrame
         QVector<WingXfl> m_Wings; /** if not empty, used to embed mid lines in the fuse mesh */
 
         static int s_idxAlgo;
+        static int s_nThreads;
 };
 
@@ -132,6 +132,13 @@ void MesherWt::setupLayout()
                      "Recommendation: activate!</p>";
             m_pchDelaunayFlip->setToolTip(tip);
 
+            m_pchConstrainedDelaunay = new QCheckBox("Constrained Delaunay mesher");
+            tip = "<p>Meshes the faces and the sails in their parametric space with a constrained Delaunay "
+                  "triangulation refined to the max. edge length, instead of the advancing front method.<br>"
+                  "Faster on large faces; the search radius, the growth factor and the Delaunay flips do not apply.<br>"
+                  "The nodes on the edges of the faces are the same with both methods.</p>";
+            m_pchConstrainedDelaunay->setToolTip(tip);
+
             m_pchSplitInnerPSLG = new QCheckBox("Splittable inner edges");
             m_pchSplitInnerPSLG->setToolTip("<p>In the case of FACEs with nested holes, allows the inner EDGEs to be split.<br>"
                                             "Recommendation: activate only in the case of FACEs with inner holes.</p>");
@@ -154,8 +161,9 @@ void MesherWt::setupLayout()
             pParamsLayout->addWidget(plabGrowthFact,               6,1);
             pParamsLayout->addWidget(m_pdeGrowthFactor,            6,2);
             pParamsLayout->addWidget(m_pchDelaunayFlip,            7,1,1,3);
-            pParamsLayout->addWidget(m_pchSplitInnerPSLG,          8,1,1,3);
-            pParamsLayout->addWidget(m_ppbMakeTriMesh,             9,1,1,3);
+            pParamsLayout->addWidget(m_pchConstrainedDelaunay,     8,1,1,3);
+            pParamsLayout->addWidget(m_pchSplitInnerPSLG,          9,1,1,3);
+            pParamsLayout->addWidget(m_ppbMakeTriMesh,            10,1,1,3);
             pParamsLayout->setColumnStretch(3,1);
         }
 
@@ -238,6 +246,7 @@ void MesherWt::loadSettings(QSettings &settings)
         double nodemergedist = settings.value("NodeMergeDistance", XflMesh::nodeMergeDistance()).toDouble();
         if(nodemergedist<1.e-6) nodemergedist=1.e-4;
         XflMesh::setNodeMergeDistance(nodemergedist);
+        AFMesher::setConstrainedDelaunay(settings.value("ConstrainedDelaunay", AFMesher::bConstrainedDelaunay()).toBool());
     }
     settings.endGroup();
 }
@@ -252,6 +261,7 @@ void MesherWt::saveSettings(QSettings &settings)
         settings.setValue("SearchRadiusCoef",  AFMesher::searchRadiusFactor());
         settings.setValue("GrowthFactor",      AFMesher::growthFactor());
         settings.setValue("NodeMergeDistance", XflMesh::nodeMergeDistance());
+        settings.setValue("ConstrainedDelaunay", AFMesher::bConstrainedDelaunay());
     }
     settings.endGroup();
 }
@@ -264,6 +274,7 @@ void MesherWt::connectSignals()
     connect(m_pdeNodeMergeDistance, SIGNAL(floatChanged(float)),  SLOT(onReadParams()));
     connect(m_pieMaxPanelCount,     SIGNAL(intChanged(int)),      SLOT(onReadParams()));
     connect(m_pchDelaunayFlip,      SIGNAL(clicked(bool)),        SLOT(onReadParams()));
+    connect(m_pchConstrainedDelaunay, SIGNAL(clicked(bool)),      SLOT(onReadParams()));
 
     connect(m_pieFaceIdx,           SIGNAL(intChanged(int)),      SLOT(onReadMeshDebugParams()));
     connect(m_pieIter,              SIGNAL(intChanged(int)),      SLOT(onReadMeshDebugParams()));
@@ -416,6 +427,8 @@ void MesherWt::setControls()
     m_pchDelaunayFlip->setChecked(AFMesher::bDelaunayFlips());
     m_pdeSearchRadiusFactor->setValue(AFMesher::searchRadiusFactor());
     m_pdeGrowthFactor->setValue(AFMesher::growthFactor());
+    m_pchConstrainedDelaunay->setChecked(AFMesher::bConstrainedDelaunay());
+    enableControls();
 
     m_pieFaceIdx->setValue(AFMesher::traceFaceIndex());
     m_pieIter->setValue(AFMesher::maxIterations());
@@ -444,6 +457,17 @@ void MesherWt::onReadParams()
     AFMesher::setGrowthFactor(      m_pdeGrowthFactor->value());
     XflMesh::setNodeMergeDistance(  m_pdeNodeMergeDistance->value()/Units::mtoUnit());
     AFMesher::setDelaunayFlips(     m_pchDelaunayFlip->isChecked());
+    AFMesher::setConstrainedDelaunay(m_pchConstrainedDelaunay->isChecked());
+    enableControls();
+}
+
+
+void MesherWt::enableControls()
+{
+    bool bAF = !m_pchConstrainedDelaunay->isChecked();
+    m_pdeSearchRadiusFactor->setEnabled(bAF);
+    m_pdeGrowthFactor->setEnabled(bAF);
+    m_pchDelaunayFlip->setEnabled(bAF);
 }
 
 
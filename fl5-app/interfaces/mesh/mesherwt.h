@@ -96,6 +96,7 @@ class MesherWt : public QFrame
         void setupLayout();
         void connectSignals();
         void setControls();
+        void enableControls();
 
     private:
         QWidget *m_pParent;
@@ -117,6 +118,7 @@ class MesherWt : public QFrame
         FloatEdit *m_pdeSearchRadiusFactor;
         FloatEdit *m_pdeGrowthFactor;
         QCheckBox *m_pchDelaunayFlip;
+        QCheckBox *m_pchConstrainedDelaunay;
 
         QPushButton *m_ppbMakeTriMesh;
 
@@ -42,11 +42,13 @@ bool PanelCheckDlg::s_bCheckMinAngle(false);
 bool PanelCheckDlg::s_bCheckMinArea(false);
 bool PanelCheckDlg::s_bCheckMinSize(false);
 bool PanelCheckDlg::s_bCheckQuadWarp(false);
+bool PanelCheckDlg::s_bCheckIntersections(false);
 double PanelCheckDlg::s_Quality(1.414);
 double PanelCheckDlg::s_MinAngle(10.0);
 double PanelCheckDlg::s_MinArea(0.00001);
 double PanelCheckDlg::s_MinSize(0.001);
 double PanelCheckDlg::s_MaxQuadWarp(10.0); //degrees
+double PanelCheckDlg::s_IntersectionGap(0.01);
 
 
 PanelCheckDlg::PanelCheckDlg(bool bQuads)
@@ -60,21 +62,25 @@ PanelCheckDlg::PanelCheckDlg(bool bQuads)
     m_pdeMinArea->setValue(s_MinArea*Units::m2toUnit());
     m_pdeMinSize->setValue(s_MinSize*Units::mtoUnit());
     m_pdeMaxQuadWarp->setValue(s_MaxQuadWarp);
+    m_pdeIntersectionGap->setValue(s_IntersectionGap);
 
     m_pchCheckSkinny->setEnabled(!m_bQuads);
     m_pchCheckQuadWarp->setEnabled(m_bQuads);
+    m_pchCheckIntersections->setEnabled(!m_bQuads);
 
     m_pchCheckSkinny->setChecked(s_bCheckSkinny);
     m_pchCheckAngle->setChecked(s_bCheckMinAngle);
     m_pchCheckArea->setChecked(s_bCheckMinArea);
     m_pchCheckSize->setChecked(s_bCheckMinSize);
     m_pchCheckQuadWarp->setChecked(s_bCheckQuadWarp);
+    m_pchCheckIntersections->setChecked(s_bCheckIntersections);
 
     m_pdeQuality->setEnabled(s_bCheckSkinny);
     m_pdeMinAngle->setEnabled(s_bCheckMinAngle);
     m_pdeMaxQuadWarp->setEnabled(s_bCheckQuadWarp);
     m_pdeMinSize->setEnabled(s_bCheckMinSize);
     m_pdeMinArea->setEnabled(s_bCheckMinArea);
+    m_pdeIntersectionGap->setEnabled(!m_bQuads && s_bCheckIntersections);
 }
 
 
@@ -97,12 +103,14 @@ void PanelCheckDlg::setupLayout()
             m_pchCheckArea     = new QCheckBox("Check area");
             m_pchCheckSize     = new QCheckBox("Check small panels");
             m_pchCheckQuadWarp = new QCheckBox("Quad warp angle");
+            m_pchCheckIntersections = new QCheckBox("Intersections and overlaps");
 
             m_pdeQuality  = new FloatEdit(s_Quality,3);
             m_pdeMinAngle = new FloatEdit(s_MinAngle,3);
             m_pdeMinArea  = new FloatEdit(s_MinArea*Units::m2toUnit());
             m_pdeMinSize  = new FloatEdit(s_MinSize*Units::mtoUnit());
             m_pdeMaxQuadWarp = new FloatEdit(s_MaxQuadWarp,3);
+            m_pdeIntersectionGap = new FloatEdit(s_IntersectionGap,3);
 
             QString qualitytip("<p>A triangle whose circumradius-to-shortest edge ratio is greater "
                                "than a minimum value B is said to be skinny.\n"
@@ -114,6 +122,12 @@ void PanelCheckDlg::setupLayout()
             m_pchCheckSkinny->setToolTip(qualitytip);
             m_pdeQuality->setToolTip(qualitytip);
 
+            QString intersecttip("<p>Lists the pairs of panels which intersect, and the pairs of nearly parallel panels "
+                                 "whose distance is less than the gap times the shortest edge, e.g. at the junction of "
+                                 "parts meshed separately. Such panels make the influence matrix singular.</p>");
+            m_pchCheckIntersections->setToolTip(intersecttip);
+            m_pdeIntersectionGap->setToolTip(intersecttip);
+
             QString warptip = QString("<p>The minimum dihedral angle formed by the planes intersecting in the diagonals</p>");
             m_pchCheckQuadWarp->setToolTip(warptip);
             m_pdeMaxQuadWarp->setToolTip(warptip);
@@ -133,20 +147,22 @@ void PanelCheckDlg::setupLayout()
             pCheckLayout->addWidget(pLabTriangles,      1,1,1,4);
             pCheckLayout->addWidget(m_pchCheckSkinny,   2,2);
             pCheckLayout->addWidget(m_pdeQuality,       2,3);
-            pCheckLayout->addWidget(pLabQuads,          3,1,1,4);
-            pCheckLayout->addWidget(m_pchCheckQuadWarp, 4,2);
-            pCheckLayout->addWidget(m_pdeMaxQuadWarp,   4,3);
-            pCheckLayout->addWidget(pLabAngle1,         4,4);
-            pCheckLayout->addWidget(pLabAll,            5,1,1,4);
-            pCheckLayout->addWidget(m_pchCheckAngle,    6,2);
-            pCheckLayout->addWidget(m_pdeMinAngle,      6,3);
-            pCheckLayout->addWidget(pLabAngle0,         6,4);
-            pCheckLayout->addWidget(m_pchCheckSize,     7,2);
-            pCheckLayout->addWidget(m_pdeMinSize,       7,3);
-            pCheckLayout->addWidget(pLabSize,           7,4);
-            pCheckLayout->addWidget(m_pchCheckArea,     8,2);
-            pCheckLayout->addWidget(m_pdeMinArea,       8,3);
-            pCheckLayout->addWidget(pLabArea,           8,4);
+            pCheckLayout->addWidget(m_pchCheckIntersections, 3,2);
+            pCheckLayout->addWidget(m_pdeIntersectionGap,    3,3);
+            pCheckLayout->addWidget(pLabQuads,          4,1,1,4);
+            pCheckLayout->addWidget(m_pchCheckQuadWarp, 5,2);
+            pCheckLayout->addWidget(m_pdeMaxQuadWarp,   5,3);
+            pCheckLayout->addWidget(pLabAngle1,         5,4);
+            pCheckLayout->addWidget(pLabAll,            6,1,1,4);
+            pCheckLayout->addWidget(m_pchCheckAngle,    7,2);
+            pCheckLayout->addWidget(m_pdeMinAngle,      7,3);
+            pCheckLayout->addWidget(pLabAngle0,         7,4);
+            pCheckLayout->addWidget(m_pchCheckSize,     8,2);
+            pCheckLayout->addWidget(m_pdeMinSize,       8,3);
+            pCheckLayout->addWidget(pLabSize,           8,4);
+            pCheckLayout->addWidget(m_pchCheckArea,     9,2);
+            pCheckLayout->addWidget(m_pdeMinArea,       9,3);
+            pCheckLayout->addWidget(pLabArea,           9,4);
             pCheckLayout->setColumnStretch(4,1);
         }
 
@@ -189,6 +205,7 @@ void PanelCheckDlg::setupLayout()
     connect(m_pchCheckArea,     SIGNAL(clicked(bool)), SLOT(onCheckMinArea()));
     connect(m_pchCheckSize,     SIGNAL(clicked(bool)), SLOT(onCheckMinSize()));
     connect(m_pchCheckQuadWarp, SIGNAL(clicked(bool)), SLOT(onCheckQuadWarp()));
+    connect(m_pchCheckIntersections, SIGNAL(clicked(bool)), SLOT(onCheckIntersections()));
 }
 
 
@@ -199,6 +216,7 @@ void PanelCheckDlg::accept()
     s_MinArea     = m_pdeMinArea->value()/Units::m2toUnit();
     s_MinSize     = m_pdeMinSize->value()/Units::mtoUnit();
     s_MaxQuadWarp = m_pdeMaxQuadWarp->value();
+    s_IntersectionGap = m_pdeIntersectionGap->value();
     QDialog::accept();
 }
 
@@ -238,6 +256,13 @@ void PanelCheckDlg::onCheckQuadWarp()
 }
 
 
+void PanelCheckDlg::onCheckIntersections()
+{
+    s_bCheckIntersections = m_pchCheckIntersections->isChecked();
+    m_pdeIntersectionGap->setEnabled(!m_bQuads && s_bCheckIntersections);
+}
+
+
 void PanelCheckDlg::setPanelIndexes(QVector<int> intvalues)
 {
     QString strange;
@@ -306,6 +331,7 @@ void PanelCheckDlg::loadSettings(QSettings &settings)
         s_MinArea     = settings.value("MinArea",          s_MinArea).toDouble();
         s_MinSize     = settings.value("MinSize",          s_MinSize).toDouble();
         s_MaxQuadWarp = settings.value("MaxQuadWarp",      s_MaxQuadWarp).toDouble();
+        s_IntersectionGap = settings.value("IntersectionGap", s_IntersectionGap).toDouble();
     }
     settings.endGroup();
 }
@@ -321,6 +347,7 @@ void PanelCheckDlg::saveSettings(QSettings &settings)
         settings.setValue("MinArea",          s_MinArea);
         settings.setValue("MinSize",          s_MinSize);
         settings.setValue("MaxQuadWarp",      s_MaxQuadWarp);
+        settings.setValue("IntersectionGap",  s_IntersectionGap);
     }
     settings.endGroup();
 
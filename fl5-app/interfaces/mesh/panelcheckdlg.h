@@ -46,6 +46,7 @@ class PanelCheckDlg : public QDialog
         bool checkMinArea()     const {return s_bCheckMinArea;}
         bool checkMinSize()     const {return s_bCheckMinSize;}
         bool checkMinQuadWarp() const {return s_bCheckQuadWarp;}
+        bool checkIntersections() const {return s_bCheckIntersections;}
 
         void setPanelIndexes(QVector<int> intvalues);
         QVector<int> panelIndexes() const;
@@ -56,6 +57,7 @@ class PanelCheckDlg : public QDialog
         static double minArea()       {return s_MinArea;}
         static double minSize()       {return s_MinSize;}
         static double maxQuadWarp()   {return s_MaxQuadWarp;}
+        static double intersectionGap() {return s_IntersectionGap;}
 
         static void loadSettings(QSettings &settings);
         static void saveSettings(QSettings &settings);
@@ -68,21 +70,22 @@ class PanelCheckDlg : public QDialog
         void onCheckMinArea();
         void onCheckMinSize();
         void onCheckQuadWarp();
+        void onCheckIntersections();
 
     private:
         void setupLayout();
 
     private:
         FloatEdit *m_pdeQuality, *m_pdeMinAngle, *m_pdeMinArea, *m_pdeMinSize;
-        FloatEdit *m_pdeMaxQuadWarp;
+        FloatEdit *m_pdeMaxQuadWarp, *m_pdeIntersectionGap;
         QCheckBox *m_pchCheckSkinny, *m_pchCheckAngle, *m_pchCheckArea, *m_pchCheckSize;
-        QCheckBox *m_pchCheckQuadWarp;
+        QCheckBox *m_pchCheckQuadWarp, *m_pchCheckIntersections;
         PlainTextOutput *m_pptePanelIndexes, *m_ppteNodeIndexes;
 
         bool m_bQuads;
 
-        static bool s_bCheckSkinny, s_bCheckMinAngle, s_bCheckMinArea, s_bCheckMinSize, s_bCheckQuadWarp;
-        static double s_Quality, s_MinAngle, s_MinArea, s_MinSize, s_MaxQuadWarp;
+        static bool s_bCheckSkinny, s_bCheckMinAngle, s_bCheckMinArea, s_bCheckMinSize, s_bCheckQuadWarp, s_bCheckIntersections;
+        static double s_Quality, s_MinAngle, s_MinArea, s_MinSize, s_MaxQuadWarp, s_IntersectionGap;
 
         static QByteArray s_Geometry;
 };
@@ -22,6 +22,9 @@
 
 *****************************************************************************/
 
+#include <algorithm>
+#include <cmath>
+
 #include <QString>
 
 /** It's not a planar-SLG, but it still is a Straight Line Graph */
@@ -35,6 +38,27 @@
 SLG3d::SLG3d()
 {
     m_bSplittable = true;
+    m_CellSize = 0.0;
+    m_MaxLength = 0.0;
+}
+
+
+/** The spatial index is not copied */
+SLG3d::SLG3d(SLG3d const &slg) : std::vector<Segment3d>(slg)
+{
+    m_bSplittable = slg.m_bSplittable;
+    m_CellSize = 0.0;
+    m_MaxLength = 0.0;
+}
+
+
+SLG3d &SLG3d::operator=(SLG3d const &slg)
+{
+    if(this==&slg) return *this;
+    std::vector<Segment3d>::operator=(slg);
+    m_bSplittable = slg.m_bSplittable;
+    clearIndex();
+    return *this;
 }
 
 /*
@@ -65,6 +89,7 @@ void SLG3d::appendSegment(Segment3d const &seg)
 {
     push_back(seg);
     back().setSplittable(m_bSplittable);
+    if(hasIndex()) indexSegment(int(size())-1);
 }
 
 
@@ -72,30 +97,43 @@ void SLG3d::appendSegment(Vector3d const &vtx0, Vector3d const &vtx1)
 {
     push_back({vtx0, vtx1});
     back().setSplittable(m_bSplittable);
+    if(hasIndex()) indexSegment(int(size())-1);
 }
 
 
 void SLG3d::append(SLG3d const &slg)
 {
+    int n0 = int(size());
     insert(end(), slg.begin(), slg.end());
+    if(hasIndex())
+    {
+        for(int is=n0; is<int(size()); is++) indexSegment(is);
+    }
 }
 
 
 void SLG3d::removeAt(unsigned int index)
 {
+    if(hasIndex())
+    {
+        unindexSegment(int(index));
+        shiftIndex(int(index)+1, -1);
+    }
     erase(begin() + index);
 }
 
 
 void SLG3d::insertAt(unsigned int index)
 {
-    insert(begin() + index, Segment3d());
+    insertAt(index, Segment3d());
 }
 
 
 void SLG3d::insertAt(unsigned int index, Segment3d const &seg)
 {
+    if(hasIndex()) shiftIndex(int(index), +1);
     insert(begin() + index, seg);
+    if(hasIndex()) indexSegment(int(index));
 }
 
 
@@ -138,8 +176,13 @@ void SLG3d::makeNodes(std::vector<Node> &nodes) const
 void SLG3d::nodesInTriangle(Triangle3d const &t3d, std::vector<Node> &insidenodes) const
 {
     Vector3d proj;
-    for(int is=0; is<int(size()); is++)
+    std::vector<int> indexes;
+    if(hasIndex()) candidates(m_StartGrid, t3d.CoG_g(), t3d.maxEdgeLength()/2.0, indexes);
+    int nCandidates = hasIndex() ? int(indexes.size()) : int(size());
+
+    for(int ic=0; ic<nCandidates; ic++)
     {
+        int is = hasIndex() ? indexes.at(ic) : ic;
         Node const &nd = at(is).vertexAt(0);
         // discard distant nodes not only to save time, but
         // also to avoid projections from opposite side of the slg
@@ -162,6 +205,14 @@ void SLG3d::nodesInTriangle(Triangle3d const &t3d, std::vector<Node> &insidenode
 int SLG3d::removeSegments(Segment3d const &seg)
 {
     int nremoved=0;
+    if(hasIndex())
+    {
+        std::vector<int> same;
+        indexedSegment(seg, 1.e-6, &same);
+        for(int it=int(same.size())-1; it>=0; it--) removeAt(same.at(it));
+        return int(same.size());
+    }
+
     for(int it=int(size()-1); it>=0; it--)
     {
 
@@ -184,8 +235,13 @@ void SLG3d::listPrevious(int iseg, std::vector<int> &previous)
     if(iseg<0||iseg>=int(size())) return;
 
     Segment3d const &seg = at(iseg);
-    for(int it=0; it<int(size()); it++)
+    std::vector<int> indexes;
+    if(hasIndex()) candidates(m_EndGrid, seg.vertexAt(0), 1.e-6, indexes);
+    int nCandidates = hasIndex() ? int(indexes.size()) : int(size());
+
+    for(int ic=0; ic<nCandidates; ic++)
     {
+        int it = hasIndex() ? indexes.at(ic) : ic;
         if(it!=iseg)
         {
             if(at(it).vertexAt(1).isSame(seg.vertexAt(0),1.e-6))
@@ -203,8 +259,13 @@ void SLG3d::listNext(int iseg, std::vector<int> &next)
     if(iseg<0||iseg>=int(size())) return;
 
     Segment3d const &seg = at(iseg);
-    for(int it=0; it<int(size()); it++)
+    std::vector<int> indexes;
+    if(hasIndex()) candidates(m_StartGrid, seg.vertexAt(1), 1.e-6, indexes);
+    int nCandidates = hasIndex() ? int(indexes.size()) : int(size());
+
+    for(int ic=0; ic<nCandidates; ic++)
     {
+        int it = hasIndex() ? indexes.at(ic) : ic;
         if(it!=iseg)
         {
             if(at(it).vertexAt(0).isSame(seg.vertexAt(1),1.e-6))
@@ -288,8 +349,14 @@ bool SLG3d::intersect(Segment3d const & segment, std::vector<int> &intersected,
     // define a 2d referential using the segment's CoG, the segment's unit dir and the normal
     Segment2d seg2d({-segment.length()/2, 0}, {segment.length()/2.0, 0}); // aligned with the x-axis
 
-    for(int is=0; is<int(size()); is++)
+    // the CoG of a segment is within half its length of its start vertex
+    std::vector<int> indexes;
+    if(hasIndex()) candidates(m_StartGrid, segment.CoG(), dist+m_MaxLength/2.0, indexes);
+    int nCandidates = hasIndex() ? int(indexes.size()) : int(size());
+
+    for(int ic=0; ic<nCandidates; ic++)
     {
+        int is = hasIndex() ? indexes.at(ic) : ic;
         Segment3d const &frontseg = at(is);
 
          // not interested in the segment's self intersection
@@ -387,8 +454,13 @@ double SLG3d::boxDiag(double &deltax, double &deltay, double &deltaz) const
  * first vertices of each segment need to be checked */
 void SLG3d::nodesAroundCenter(Vector3d const &center, double radius, std::vector<Node> &closenodes)
 {
-    for(int is=0; is<int(size()); is++)
+    std::vector<int> indexes;
+    if(hasIndex()) candidates(m_StartGrid, center, radius, indexes);
+    int nCandidates = hasIndex() ? int(indexes.size()) : int(size());
+
+    for(int ic=0; ic<nCandidates; ic++)
     {
+        int is = hasIndex() ? indexes.at(ic) : ic;
         Node const &nd = at(is).vertexAt(0);
         double dist = nd.distanceTo(center);
 //        qDebug()<<"dist, raidus"<<dist<<radius;
@@ -399,15 +471,150 @@ void SLG3d::nodesAroundCenter(Vector3d const &center, double radius, std::vector
 }
 
 
+/**
+ * Builds the spatial index of the segments, used to find the segments and nodes in the neighbourhood
+ * of a point without scanning the whole SLG.
+ * The queries return the same segments in the same order as without the index.
+ * @param cellsize the size of the grid cells; if 0, twice the average length of the segments
+ */
+void SLG3d::makeIndex(double cellsize)
+{
+    clearIndex();
+    if(empty()) return;
+
+    if(cellsize<=0.0)
+    {
+        for(Segment3d const &seg : *this) cellsize += seg.length();
+        cellsize *= 2.0/double(size());
+    }
+    if(cellsize<=0.0) return;
 
+    m_CellSize = cellsize;
+    m_StartGrid.reserve(size());
+    m_EndGrid.reserve(size());
+    for(int is=0; is<int(size()); is++) indexSegment(is);
+}
 
 
+void SLG3d::clearIndex()
+{
+    m_CellSize = 0.0;
+    m_MaxLength = 0.0;
+    m_StartGrid.clear();
+    m_EndGrid.clear();
+}
+
+
+SLG3d::CellKey SLG3d::cellKey(Vector3d const &pt) const
+{
+    return {int64_t(std::floor(pt.x/m_CellSize)), int64_t(std::floor(pt.y/m_CellSize)), int64_t(std::floor(pt.z/m_CellSize))};
+}
+
+
+void SLG3d::indexSegment(int iseg)
+{
+    Segment3d const &seg = at(iseg);
+    m_StartGrid[cellKey(seg.vertexAt(0))].push_back(iseg);
+    m_EndGrid[cellKey(seg.vertexAt(1))].push_back(iseg);
+    m_MaxLength = std::max(m_MaxLength, seg.length());
+}
 
 
+void SLG3d::unindexSegment(int iseg)
+{
+    Segment3d const &seg = at(iseg);
+    for(int ivtx=0; ivtx<2; ivtx++)
+    {
+        SegmentGrid &grid = ivtx==0 ? m_StartGrid : m_EndGrid;
+        auto it = grid.find(cellKey(seg.vertexAt(ivtx)));
+        if(it==grid.end()) continue;
+        std::vector<int> &cell = it->second;
+        cell.erase(std::remove(cell.begin(), cell.end(), iseg), cell.end());
+        if(cell.empty()) grid.erase(it);
+    }
+}
 
 
+/** Adds delta to the indexes greater or equal to from, after an insertion or a removal in the array */
+void SLG3d::shiftIndex(int from, int delta)
+{
+    for(SegmentGrid *pGrid : {&m_StartGrid, &m_EndGrid})
+    {
+        for(auto &cell : *pGrid)
+        {
+            for(int &idx : cell.second)
+            {
+                if(idx>=from) idx += delta;
+            }
+        }
+    }
+}
 
 
+/**
+ * Lists in increasing order the indexes of the segments stored in the cells which overlap
+ * the cube of half-side radius centred on the point.
+ * The caller is responsible for the exact test.
+ */
+void SLG3d::candidates(SegmentGrid const &grid, Vector3d const &pt, double radius, std::vector<int> &indexes) const
+{
+    indexes.clear();
+    CellKey kmin = cellKey({pt.x-radius, pt.y-radius, pt.z-radius});
+    CellKey kmax = cellKey({pt.x+radius, pt.y+radius, pt.z+radius});
 
+    double nCells = double(kmax.m_i-kmin.m_i+1) * double(kmax.m_j-kmin.m_j+1) * double(kmax.m_k-kmin.m_k+1);
+    if(nCells>double(grid.size()))
+    {
+        // cheaper to visit the occupied cells
+        for(auto const &cell : grid)
+        {
+            CellKey const &key = cell.first;
+            if(key.m_i<kmin.m_i || key.m_i>kmax.m_i) continue;
+            if(key.m_j<kmin.m_j || key.m_j>kmax.m_j) continue;
+            if(key.m_k<kmin.m_k || key.m_k>kmax.m_k) continue;
+            indexes.insert(indexes.end(), cell.second.begin(), cell.second.end());
+        }
+    }
+    else
+    {
+        for(int64_t i=kmin.m_i; i<=kmax.m_i; i++)
+        {
+            for(int64_t j=kmin.m_j; j<=kmax.m_j; j++)
+            {
+                for(int64_t k=kmin.m_k; k<=kmax.m_k; k++)
+                {
+                    auto it = grid.find({i,j,k});
+                    if(it!=grid.end()) indexes.insert(indexes.end(), it->second.begin(), it->second.end());
+                }
+            }
+        }
+    }
+    std::sort(indexes.begin(), indexes.end());
+}
 
 
+/**
+ * Returns the index of the first segment which is the same as the input segment, in either direction, or -1.
+ * If pAll is not null, it is filled with the indexes of all such segments in increasing order.
+ */
+int SLG3d::indexedSegment(Segment3d const &seg, double precision, std::vector<int> *pAll) const
+{
+    std::vector<int> indexes, reversed;
+    candidates(m_StartGrid, seg.vertexAt(0), precision, indexes);
+    candidates(m_StartGrid, seg.vertexAt(1), precision, reversed);
+    indexes.insert(indexes.end(), reversed.begin(), reversed.end());
+    std::sort(indexes.begin(), indexes.end());
+    indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+
+    if(pAll) pAll->clear();
+    for(int is : indexes)
+    {
+        if(at(is).isSame(seg, precision))
+        {
+            if(!pAll) return is;
+            pAll->push_back(is);
+        }
+    }
+    if(pAll && pAll->size()) return pAll->front();
+    return -1;
+}
@@ -31,6 +31,9 @@
  */
 
 
+#include <cstdint>
+#include <unordered_map>
+
 #include <api/segment3d.h>
 
 class Triangle3d;
@@ -40,6 +43,8 @@ class SLG3d : public std::vector<Segment3d>
     public:
         SLG3d();
 //        SLG3d(const std::vector<Segment3d> &segs);
+        SLG3d(SLG3d const &slg);
+        SLG3d &operator=(SLG3d const &slg);
 
         int cleanNullSegments();
 
@@ -84,12 +89,46 @@ class SLG3d : public std::vector<Segment3d>
 
         void list(std::string &logmsg, bool bLong=false);
 
+        void makeIndex(double cellsize=0.0);
+        void clearIndex();
+        bool hasIndex() const {return m_CellSize>0.0;}
+
+    private:
+        struct CellKey
+        {
+            int64_t m_i{0}, m_j{0}, m_k{0};
+            bool operator==(CellKey const &key) const {return m_i==key.m_i && m_j==key.m_j && m_k==key.m_k;}
+        };
+
+        struct CellKeyHash
+        {
+            size_t operator()(CellKey const &key) const
+            {
+                return size_t(key.m_i*73856093) ^ size_t(key.m_j*19349663) ^ size_t(key.m_k*83492791);
+            }
+        };
+
+        typedef std::unordered_map<CellKey, std::vector<int>, CellKeyHash> SegmentGrid;
+
+        CellKey cellKey(Vector3d const &pt) const;
+        void indexSegment(int iseg);
+        void unindexSegment(int iseg);
+        void shiftIndex(int from, int delta);
+        void candidates(SegmentGrid const &grid, Vector3d const &pt, double radius, std::vector<int> &indexes) const;
+        int indexedSegment(Segment3d const &seg, double precision, std::vector<int> *pAll=nullptr) const;
+
     private:
         bool m_bSplittable; /** If true, the PSLG can be split during the refinement of the PSLG.
                                 By default a contour PSLG is not splittable to force a unique number of
                                 points on shared edges.
                                 Inner PSLG are spliitable, as are free edge PSLG if they can be identified. */
 
+        /** The optional spatial index of the segments, by the cells of their start and end vertices.
+         *  While it is active, the SLG must be modified only with the insert, append and remove methods. */
+        double m_CellSize;   /** 0 if there is no index */
+        double m_MaxLength;  /** the length of the longest segment inserted since the index was made */
+        SegmentGrid m_StartGrid, m_EndGrid;
+
 };
 
 
@@ -109,6 +148,11 @@ inline bool SLG3d::isVertex(Vector3d const &vtx, int &iSeg, double precision) co
 
 inline bool SLG3d::isSegment(Segment3d const &seg, int &iSeg, double precision) const
 {
+    if(hasIndex())
+    {
+        iSeg = indexedSegment(seg, precision);
+        return iSeg>=0;
+    }
     for(iSeg=0; iSeg<int(size()); iSeg++)
     {
         if(at(iSeg).isSame(seg, precision)) return true;
@@ -120,6 +164,7 @@ inline bool SLG3d::isSegment(Segment3d const &seg, int &iSeg, double precision)
 
 inline int SLG3d::isSegment(Segment3d const &seg, double precision) const
 {
+    if(hasIndex()) return indexedSegment(seg, precision);
     for(int iSeg=0; iSeg<int(size()); iSeg++)
     {
         if(at(iSeg).isSame(seg, precision)) return iSeg;
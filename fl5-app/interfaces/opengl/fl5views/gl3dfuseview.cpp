@@ -183,18 +183,14 @@ void gl3dFuseView::glRenderView()
     }
     else if(m_pFuse->isOccType())
     {
-        if(m_bSurfaces)
-            paintTriangles3Vtx(m_vboSurface, m_pFuse->color(), false, isLightOn());
-        if(m_bTessellation)
-            paintSegments(m_vboTess, W3dPrefs::s_OutlineStyle);
+        paintLodMesh(m_LodSurface, xfl::fromfl5Clr(m_pFuse->color()), m_bSurfaces, m_bTessellation, W3dPrefs::s_OutlineStyle, isLightOn());
 
         if(m_bOutline)
             paintSegments(m_vboOutline, W3dPrefs::s_OutlineStyle);
     }
     else if(m_pFuse->isStlType())
     {
-        if(m_bSurfaces) paintTriangles3Vtx(m_vboSurface, m_pFuse->color(), false, isLightOn());
-        if(m_bOutline)  paintSegments(m_vboOutline, W3dPrefs::s_OutlineStyle);
+        paintLodMesh(m_LodSurface, xfl::fromfl5Clr(m_pFuse->color()), m_bSurfaces, m_bOutline, W3dPrefs::s_OutlineStyle, isLightOn());
     }
 
     if(m_bMeshPanels)
@@ -307,14 +303,12 @@ void gl3dFuseView::glMake3dObjects()
         }
         else if(m_pFuse->isXflType() || m_pFuse->isOccType())
         {
-            gl::makeTriangulation3Vtx(m_pFuse->triangulation(), Vector3d(), m_vboSurface, false);
-            gl::makeTrianglesOutline(m_pFuse->triangles(), Vector3d(), m_vboTess);
+            m_LodSurface.build(m_pFuse->triangulation(), false);
             gl::glMakeShellOutline(m_pFuse->shells(), Vector3d(), m_vboOutline);
         }
         else if(m_pFuse->isStlType())
         {
-            gl::makeTriangulation3Vtx(m_pFuse->triangulation(), Vector3d(), m_vboSurface, true);
-            gl::makeTrianglesOutline(m_pFuse->triangulation().triangles(), Vector3d(), m_vboOutline);
+            m_LodSurface.build(m_pFuse->triangulation(), true);
         }
     }
 
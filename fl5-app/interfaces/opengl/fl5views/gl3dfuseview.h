@@ -28,6 +28,7 @@
 
 #include <interfaces/opengl/fl5views/gl3dxflview.h>
 #include <api/fuse.h>
+#include <interfaces/opengl/globals/gl_lod.h>
 
 
 class gl3dFuseView : public gl3dXflView
@@ -72,6 +73,7 @@ class gl3dFuseView : public gl3dXflView
         QOpenGLBuffer m_vboHighlight;
         QOpenGLBuffer m_vboTriPanels, m_vboTriPanelEdges;
         QOpenGLBuffer m_vboFrames;
+        glLodMesh m_LodSurface;             /**< the triangulation of the OCC and STL fuses */
 
         int m_nHighlightLines, m_HighlightLineSize;
 
@@ -63,7 +63,7 @@ gl3dOptimXflView::gl3dOptimXflView(QWidget *pParent) : gl3dPlaneXflView(pParent)
 
 gl3dOptimXflView::~gl3dOptimXflView()
 {
-    if(m_vboContours.isCreated())      m_vboContours.destroy();
+    if(m_vboCpGeom.isCreated())        m_vboCpGeom.destroy();
     if(m_vboCp.isCreated())            m_vboCp.destroy();
     if(m_vboSectionArrows.isCreated()) m_vboSectionArrows.destroy();
 }
@@ -218,8 +218,9 @@ void gl3dOptimXflView::glMake3dObjects()
         TriMesh::makeNodeValues(m_pPlaneXfl->triMesh().nodes(), m_pPlaneXfl->triMesh().panels(),
                                 val, m_NodeValue, lmin, lmax, 1.0);
 
-        gl::makeTriLinColorMap(m_pPlaneXfl->triMesh().panels(), m_pPlaneXfl->triMesh().nodes(), m_NodeValue, lmin, lmax, m_vboCp);
-        gl::makeTriangleContoursOnMesh(m_pPlaneXfl->triMesh().panels(), m_NodeValue, lmin, lmax, m_vboContours);
+        // the contours are extracted from the values by the shader
+        gl::makeTriColourMapGeometry(m_pPlaneXfl->triMesh().panels(), m_vboCpGeom);
+        gl::makeTriLinColourMapValues(m_pPlaneXfl->triMesh().panels(), m_pPlaneXfl->triMesh().nNodes(), m_NodeValue, lmin, lmax, m_vboCp);
 
         m_ColourLegend.setRange(lmin, lmax);
         m_ColourLegend.makeLegend();
@@ -240,8 +241,7 @@ void gl3dOptimXflView::glRenderView()
 
     if(m_pPOpp)
     {
-        if(m_bShowCp)       paintColourMap(m_vboCp);
-        if(m_bShowContours) paintSegments(m_vboContours, W3dPrefs::s_ContourLineStyle);
+        paintColourMap(m_vboCpGeom, m_vboCp, QMatrix4x4(), m_bShowCp, m_bShowContours);
     }
 }
 
@@ -80,8 +80,7 @@ class gl3dOptimXflView : public gl3dPlaneXflView
 
         PlaneOpp const*m_pPOpp;
 
-        QOpenGLBuffer m_vboCp;
-        QOpenGLBuffer m_vboContours;
+        QOpenGLBuffer m_vboCpGeom, m_vboCp;
 
         ColourLegend m_ColourLegend;
 
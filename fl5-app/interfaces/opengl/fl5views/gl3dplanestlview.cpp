@@ -57,7 +57,6 @@ gl3dPlaneSTLView::gl3dPlaneSTLView(QWidget *pParent) : gl3dXflView(pParent)
 gl3dPlaneSTLView::~gl3dPlaneSTLView()
 {
     if(m_vboHighlightPanel3.isCreated())  m_vboHighlightPanel3.destroy();
-    if(m_vboTriangulation.isCreated())    m_vboTriangulation.destroy();
     if(m_vboTriMesh.isCreated())          m_vboTriMesh.destroy();
     if(m_vboTriEdges.isCreated())         m_vboTriEdges.destroy();
     if(m_vboTriangleNormals.isCreated())  m_vboTriangleNormals.destroy();
@@ -222,8 +221,7 @@ void gl3dPlaneSTLView::glMake3dObjects()
 
     if(m_bResetglPlane)
     {
-        gl::makeTriangulation3Vtx(m_pPlaneSTL->triangulation(), Vector3d(), m_vboTriangulation, true);
-        gl::makeTrianglesOutline(m_pPlaneSTL->triangles(), Vector3d(), m_vboOutline);
+        m_LodTriangulation.build(m_pPlaneSTL->triangulation(), true);
     }
 
     if(m_bResetglSegments)
@@ -280,11 +278,8 @@ void gl3dPlaneSTLView::glRenderView()
     }
     m_shadSurf.release();
 
-    if(m_bSurfaces)
-        paintTriangles3Vtx(m_vboTriangulation, m_pPlaneSTL->surfaceColor(), false, isLightOn());
-
-   if(m_bOutline || m_bTessellation)
-       paintSegments(m_vboOutline, W3dPrefs::s_OutlineStyle);
+    paintLodMesh(m_LodTriangulation, xfl::fromfl5Clr(m_pPlaneSTL->surfaceColor()), m_bSurfaces, m_bOutline || m_bTessellation,
+                 W3dPrefs::s_OutlineStyle, isLightOn());
 
     if(m_Segments.size())
         paintSegments(m_vboSegments, W3dPrefs::highlightColor(), 1, Line::SOLID, true);
@@ -25,6 +25,7 @@
 #pragma once
 
 #include <interfaces/opengl/fl5views/gl3dxflview.h>
+#include <interfaces/opengl/globals/gl_lod.h>
 
 
 class PlaneSTL;
@@ -59,8 +60,7 @@ class gl3dPlaneSTLView : public gl3dXflView
         bool m_bResetglPlane;
         bool m_bResetglNormals;
 
-        QOpenGLBuffer m_vboTriangulation;
-        QOpenGLBuffer m_vboOutline;
+        glLodMesh m_LodTriangulation;
         QOpenGLBuffer m_vboTriMesh, m_vboTriEdges;
         QOpenGLBuffer m_vboTriangleNormals;
 };
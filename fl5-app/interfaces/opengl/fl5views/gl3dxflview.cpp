@@ -280,15 +280,19 @@ void gl3dXflView::paintPartMasses(Vector3d const &pos, double volumeMass, QStrin
                      tagcolor);
     }
 
+    // the unselected masses are painted in a single instanced draw
+    std::vector<Vector3d> positions;
+    positions.reserve(ptMasses.size());
     for(int im=0; im<int(ptMasses.size()); im++)
     {
-        QColor massclr;
-        if(im==iSelectedMass) massclr = Qt::red;
-        else                  massclr= W3dPrefs::s_MassColor;
-        paintSphere(ptMasses.at(im).position() +pos,
-                    W3dPrefs::s_MassRadius/double(m_glScalef),
-                    massclr,
-                    true);
+        if(im!=iSelectedMass) positions.push_back(ptMasses.at(im).position() +pos);
+    }
+    paintSphereInstances(positions, float(W3dPrefs::s_MassRadius/double(m_glScalef)), W3dPrefs::s_MassColor, false, true);
+
+    for(int im=0; im<int(ptMasses.size()); im++)
+    {
+        if(im==iSelectedMass)
+            paintSphere(ptMasses.at(im).position() +pos, W3dPrefs::s_MassRadius/double(m_glScalef), Qt::red, true);
         glRenderText(ptMasses.at(im).position().x + pos.x,
                      ptMasses.at(im).position().y + pos.y,
                      ptMasses.at(im).position().z + pos.z + delta,
@@ -698,6 +702,71 @@ bool gl3dXflView::pickPanel3(QPoint const &point, std::vector<Panel3> const&pane
 }
 
 
+/** Clears the pick tree; to be called each time the list of pickable panels changes */
+void gl3dXflView::clearPickTree()
+{
+    m_PickTree.clear();
+    m_PickTriangle.clear();
+    m_PickPanel.clear();
+}
+
+
+/** Builds the pick tree of the list of triangular panels */
+void gl3dXflView::makePickTree(std::vector<Panel3> const &panels)
+{
+    clearPickTree();
+    m_PickTriangle.reserve(panels.size());
+    m_PickPanel.reserve(panels.size());
+    for(uint i3=0; i3<panels.size(); i3++)
+    {
+        Panel3 const &p3 = panels.at(i3);
+        m_PickTriangle.push_back(Triangle3d(p3.vertexAt(0), p3.vertexAt(1), p3.vertexAt(2)));
+        m_PickPanel.push_back(int(i3));
+    }
+    m_PickTree.build(m_PickTriangle);
+}
+
+
+/** Builds the pick tree of the list of quad panels, each split in two triangles */
+void gl3dXflView::makePickTree(std::vector<Panel4> const &panels)
+{
+    clearPickTree();
+    m_PickTriangle.reserve(2*panels.size());
+    m_PickPanel.reserve(2*panels.size());
+    for(uint i4=0; i4<panels.size(); i4++)
+    {
+        Panel4 const &p4 = panels.at(i4);
+        m_PickTriangle.push_back(Triangle3d(p4.vertex(0), p4.vertex(1), p4.vertex(2)));
+        m_PickTriangle.push_back(Triangle3d(p4.vertex(0), p4.vertex(2), p4.vertex(3)));
+        m_PickPanel.push_back(int(i4));
+        m_PickPanel.push_back(int(i4));
+    }
+    m_PickTree.build(m_PickTriangle);
+}
+
+
+/**
+ * Finds the panel of the pick tree which is closest to the viewer under the mouse point,
+ * in O(log n) operations instead of testing each panel.
+ * @param I the intersection point on the panel
+ * @return the index of the panel in the list used to build the tree, or -1 if none is picked
+ */
+int gl3dXflView::pickTreePanel(QPoint const &point, Vector3d &I) const
+{
+    if(!m_PickTree.isBuilt()) return -1;
+
+    Vector3d AA, BB;
+    screenToWorld(point, 0.0, AA);
+    screenToWorld(point, 1.0, BB);
+
+    Node Inter;
+    int it = m_PickTree.nearestTriangle(m_PickTriangle, AA, BB, Inter);
+    if(it<0 || it>=int(m_PickPanel.size())) return -1;
+    I = Inter;
+    return m_PickPanel.at(it);
+}
+
+
 bool gl3dXflView::pickTriangle3d(QPoint const &point, std::vector<Triangle3d> const&panels, Vector3d &I)
 {
     Vector3d Inter, AA, BB;
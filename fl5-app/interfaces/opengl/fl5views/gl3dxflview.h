@@ -42,6 +42,7 @@
 
 #include <api/vector2d.h>
 #include <api/segment3d.h>
+#include <api/trianglebvh.h>
 
 #define MAXCPCOLORS    21
 
@@ -227,6 +228,12 @@ class gl3dXflView : public gl3dView
         virtual bool pickPanel3(QPoint const &point, const std::vector<Panel3> &panels, Vector3d &I);
         bool pickTriangle3d(QPoint const &point, const std::vector<Triangle3d> &panels, Vector3d &I);
 
+        void clearPickTree();
+        void makePickTree(std::vector<Panel3> const &panels);
+        void makePickTree(std::vector<Panel4> const &panels);
+        bool hasPickTree() const {return m_PickTree.isBuilt();}
+        int pickTreePanel(QPoint const &point, Vector3d &I) const;
+
         bool pickShapeVertex(QPoint const &point, TopoDS_ListOfShape const&shapes, Vector3d &I);
 
         void paintMeasure();
@@ -299,6 +306,10 @@ class gl3dXflView : public gl3dView
         QVector<Segment3d> m_Segments;
         QOpenGLBuffer m_vboSegments; // free edge highlighting
 
+        TriangleBVH m_PickTree;                 /**< the hierarchy of the pickable panels, made on the first pick after each change of the panel list */
+        std::vector<Triangle3d> m_PickTriangle; /**< the triangles of the pickable panels, two per quad */
+        std::vector<int> m_PickPanel;           /**< the index in the panel list of the panel to which each triangle belongs */
+
         Segment3d m_Measure;
 
         QLabel *m_plabBotLeft;
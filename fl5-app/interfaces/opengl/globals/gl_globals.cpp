@@ -1278,6 +1278,10 @@ void gl::lookUpQuadKey(int key, int *i)
 }
 
 
+/**
+ * Makes the instance buffer of the node force arrows, to be painted with gl3dView::paintArrowInstances().
+ * Each arrow is defined by 9 floats: the origin, the vector from the origin to the tip, and the colour.
+ */
 void gl::makeNodeForces(std::vector<Node> const &nodes, std::vector<double> const &CpNodes,
                         float qDyn,
                         double &rmin, double &rmax, bool bAuto, double scale,
@@ -1290,17 +1294,6 @@ void gl::makeNodeForces(std::vector<Node> const &nodes, std::vector<double> cons
         return;
     }
 
-    Quaternion Qt; // Quaternion operator to align the reference arrow with the panel's normal
-    Vector3d Omega; // rotation vector to align the reference arrow with the panel's normal
-//for(int in=0; in<nNodes; in++) qDebug(" %3d   %13g", nodes.at(in).index(), CpNodes.at(in));
-
-    //The vectors defining the reference arrow
-    Vector3d Ra(0.0,0.0,1.0);
-    Vector3d R1( 0.05, 0.0, -0.1);
-    Vector3d R2(-0.05, 0.0, -0.1);
-    //The three vectors defining the arrow on the panel
-    Vector3d P, P1, P2;
-
     //define the range of values to set the colors in accordance
 
     float coef = 0.00001f;
@@ -1325,15 +1318,12 @@ void gl::makeNodeForces(std::vector<Node> const &nodes, std::vector<double> cons
 
     float range = rmax - rmin;
 
-    // vertices array size:
+    // instance array size:
     //        nNodes x 1 arrow
-    //      x3 lines per arrow
-    //      x2 vertices per line
-    //        x6 = 3 vertex components + 3 color components
+    //        x9 = 3 origin components + 3 vector components + 3 color components
+    QVector<float> forceInstanceArray(nNodes * 9);
 
-    int forceVertexSize = nNodes * 3 * 2 * 6;
-    QVector<float> forceVertexArray(forceVertexSize);
-    QColor clr;
+    Vector3d O, P;
     int iv=0;
     for (int p=0; p<nNodes; p++)
     {
@@ -1345,115 +1335,30 @@ void gl::makeNodeForces(std::vector<Node> const &nodes, std::vector<double> cons
         //scale force for display
         force *= scale *coef;
 
-        clr = ColourLegend::colour(tau);
-        float r = clr.redF();
-        float g = clr.greenF();
-        float b = clr.blueF();
+        QColor clr = ColourLegend::colour(tau);
 
-        Qt.from2UnitVectors(Ra, node.normal());
-        Qt.conjugate(Ra,  P);
-        Qt.conjugate(R1, P1);
-        Qt.conjugate(R2, P2);
+        O.set(node.x, node.y, node.z);
+        P = node.normal() * double(force);
 
-        // Scale the pressure vector
-        P  *= double(force);
-        P1 *= double(force);
-        P2 *= double(force);
+        // compression, point towards the surface; depression, point outwards from the surface
+        if(CpNodes[node.index()]>0) O += P;
+        P.set(-P.x, -P.y, -P.z);
 
-        if(CpNodes[node.index()]>0)
-        {
-            // compression, point towards the surface
-            forceVertexArray[iv++] = node.xf();
-            forceVertexArray[iv++] = node.yf();
-            forceVertexArray[iv++] = node.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = node.xf()+P.xf();
-            forceVertexArray[iv++] = node.yf()+P.yf();
-            forceVertexArray[iv++] = node.zf()+P.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-
-            forceVertexArray[iv++] = node.xf();
-            forceVertexArray[iv++] = node.yf();
-            forceVertexArray[iv++] = node.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = node.xf()-P1.xf();
-            forceVertexArray[iv++] = node.yf()-P1.yf();
-            forceVertexArray[iv++] = node.zf()-P1.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-
-            forceVertexArray[iv++] = node.xf();
-            forceVertexArray[iv++] = node.yf();
-            forceVertexArray[iv++] = node.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = node.xf()-P2.xf();
-            forceVertexArray[iv++] = node.yf()-P2.yf();
-            forceVertexArray[iv++] = node.zf()-P2.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-        }
-        else
-        {
-            // depression, point outwards from the surface
-            P.set(-P.x, -P.y, -P.z);
-
-            forceVertexArray[iv++] = node.xf();
-            forceVertexArray[iv++] = node.yf();
-            forceVertexArray[iv++] = node.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = node.xf()+P.xf();
-            forceVertexArray[iv++] = node.yf()+P.yf();
-            forceVertexArray[iv++] = node.zf()+P.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-
-            forceVertexArray[iv++] = node.xf()+P.xf();
-            forceVertexArray[iv++] = node.yf()+P.yf();
-            forceVertexArray[iv++] = node.zf()+P.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = node.xf()+P.xf()-P1.xf();
-            forceVertexArray[iv++] = node.yf()+P.yf()-P1.yf();
-            forceVertexArray[iv++] = node.zf()+P.zf()-P1.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-
-            forceVertexArray[iv++] = node.xf()+P.xf();
-            forceVertexArray[iv++] = node.yf()+P.yf();
-            forceVertexArray[iv++] = node.zf()+P.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = node.xf()+P.xf()-P2.xf();
-            forceVertexArray[iv++] = node.yf()+P.yf()-P2.yf();
-            forceVertexArray[iv++] = node.zf()+P.zf()-P2.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-        }
+        forceInstanceArray[iv++] = O.xf();
+        forceInstanceArray[iv++] = O.yf();
+        forceInstanceArray[iv++] = O.zf();
+        forceInstanceArray[iv++] = P.xf();
+        forceInstanceArray[iv++] = P.yf();
+        forceInstanceArray[iv++] = P.zf();
+        forceInstanceArray[iv++] = clr.redF();
+        forceInstanceArray[iv++] = clr.greenF();
+        forceInstanceArray[iv++] = clr.blueF();
     }
 
-//    Q_ASSERT(iv==forceVertexSize);
-
     vbo.destroy();
     vbo.create();
     vbo.bind();
-    vbo.allocate(forceVertexArray.data(), forceVertexSize * int(sizeof(GLfloat)));
+    vbo.allocate(forceInstanceArray.data(), iv * int(sizeof(GLfloat)));
     vbo.release();
 }
 
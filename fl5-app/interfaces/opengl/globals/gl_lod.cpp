@@ -0,0 +1,259 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+
+#include "gl_lod.h"
+
+
+int glLodMesh::s_ChunkSize = 16384;
+int glLodMesh::s_MaxLevels = 6;
+double glLodMesh::s_PixelTolerance = 1.5;
+
+
+glLodMesh::glLodMesh()
+{
+}
+
+
+glLodMesh::~glLodMesh()
+{
+    if(m_vbo.isCreated()) m_vbo.destroy();
+}
+
+
+void glLodMesh::clear()
+{
+    m_Chunk.clear();
+    m_CellSize.clear();
+    if(m_vbo.isCreated()) m_vbo.destroy();
+}
+
+
+/**
+ * Builds the chunks and their levels of detail, and uploads them to the vertex buffer.
+ * Must be called with the view's OpenGL context current.
+ * @param bFlatNormals if true, the triangles' normals are used, otherwise the nodes' normals are used.
+ */
+void glLodMesh::build(Triangulation const &triangulation, bool bFlatNormals)
+{
+    clear();
+
+    int nTriangles = triangulation.nTriangles();
+    if(nTriangles<=0) return;
+
+    // bounding box and mean edge length
+    Vector3d BBMin( 1.e10,  1.e10,  1.e10);
+    Vector3d BBMax(-1.e10, -1.e10, -1.e10);
+    double meanedge = 0.0;
+    for(int it=0; it<nTriangles; it++)
+    {
+        Triangle3d const &t3 = triangulation.triangleAt(it);
+        for(int k=0; k<3; k++)
+        {
+            Vector3d const &P = t3.vertexAt(k);
+            BBMin.x = std::min(BBMin.x, P.x);   BBMax.x = std::max(BBMax.x, P.x);
+            BBMin.y = std::min(BBMin.y, P.y);   BBMax.y = std::max(BBMax.y, P.y);
+            BBMin.z = std::min(BBMin.z, P.z);   BBMax.z = std::max(BBMax.z, P.z);
+            meanedge += P.distanceTo(t3.vertexAt(k+1));
+        }
+    }
+    meanedge /= double(3*nTriangles);
+
+    // assign the triangles to the chunks from the position of their centroid
+    int nc = std::max(1, int(std::round(std::cbrt(double(nTriangles)/double(s_ChunkSize)))));
+    Vector3d Size = BBMax-BBMin;
+    std::vector<std::vector<int>> chunktriangles(nc*nc*nc);
+    for(int it=0; it<nTriangles; it++)
+    {
+        Triangle3d const &t3 = triangulation.triangleAt(it);
+        Vector3d G = (t3.vertexAt(0)+t3.vertexAt(1)+t3.vertexAt(2))/3.0;
+        int i = Size.x>0.0 ? std::clamp(int(double(nc)*(G.x-BBMin.x)/Size.x), 0, nc-1) : 0;
+        int j = Size.y>0.0 ? std::clamp(int(double(nc)*(G.y-BBMin.y)/Size.y), 0, nc-1) : 0;
+        int k = Size.z>0.0 ? std::clamp(int(double(nc)*(G.z-BBMin.z)/Size.z), 0, nc-1) : 0;
+        chunktriangles[(i*nc+j)*nc+k].push_back(it);
+    }
+    chunktriangles.erase(std::remove_if(chunktriangles.begin(), chunktriangles.end(),
+                                        [](std::vector<int> const &tris){return tris.empty();}),
+                         chunktriangles.end());
+    int nChunks = int(chunktriangles.size());
+
+    m_Chunk.resize(nChunks);
+    for(Chunk &ch : m_Chunk)
+    {
+        ch.m_Min.set( 1.e10,  1.e10,  1.e10);
+        ch.m_Max.set(-1.e10, -1.e10, -1.e10);
+    }
+
+    // the vertex data of each chunk and level
+    std::vector<std::vector<std::vector<float>>> data(nChunks);
+
+    auto addVertex = [this](std::vector<float> &array, int ic, Vector3d const &P, Vector3d const &N)
+    {
+        array.push_back(P.xf());  array.push_back(P.yf());  array.push_back(P.zf());
+        array.push_back(N.xf());  array.push_back(N.yf());  array.push_back(N.zf());
+        Chunk &ch = m_Chunk[ic];
+        ch.m_Min.x = std::min(ch.m_Min.x, P.x);   ch.m_Max.x = std::max(ch.m_Max.x, P.x);
+        ch.m_Min.y = std::min(ch.m_Min.y, P.y);   ch.m_Max.y = std::max(ch.m_Max.y, P.y);
+        ch.m_Min.z = std::min(ch.m_Min.z, P.z);   ch.m_Max.z = std::max(ch.m_Max.z, P.z);
+    };
+
+    // level 0: the original triangles
+    m_CellSize.push_back(0.0);
+    for(int ic=0; ic<nChunks; ic++)
+    {
+        data[ic].push_back(std::vector<float>());
+        std::vector<float> &array = data[ic].back();
+        array.reserve(chunktriangles[ic].size()*18);
+        for(int it : chunktriangles[ic])
+        {
+            Triangle3d const &t3 = triangulation.triangleAt(it);
+            for(int k=0; k<3; k++)
+            {
+                int inode = t3.nodeIndex(k);
+                if(!bFlatNormals && inode>=0 && inode<triangulation.nNodes())
+                    addVertex(array, ic, t3.vertexAt(k), triangulation.nodeAt(inode).normal());
+                else
+                    addVertex(array, ic, t3.vertexAt(k), t3.normal());
+            }
+        }
+    }
+
+    // coarser levels: vertex clustering on grids of doubling size
+    int nPrevious = nTriangles;
+    std::vector<int> cornercluster(3*nTriangles);
+    for(int level=1; level<s_MaxLevels && nPrevious>64; level++)
+    {
+        double h = 2.0*meanedge * double(1<<(level-1));
+        if(h<=0.0) break;
+
+        std::unordered_map<uint64_t, int> clusterindex;
+        std::vector<Vector3d> sumpos, sumnormal;
+        std::vector<int> count;
+
+        for(int it=0; it<nTriangles; it++)
+        {
+            Triangle3d const &t3 = triangulation.triangleAt(it);
+            for(int k=0; k<3; k++)
+            {
+                Vector3d const &P = t3.vertexAt(k);
+                uint64_t ix = uint64_t(std::clamp(int((P.x-BBMin.x)/h), 0, (1<<21)-1));
+                uint64_t iy = uint64_t(std::clamp(int((P.y-BBMin.y)/h), 0, (1<<21)-1));
+                uint64_t iz = uint64_t(std::clamp(int((P.z-BBMin.z)/h), 0, (1<<21)-1));
+                uint64_t key = (ix<<42) | (iy<<21) | iz;
+
+                auto result = clusterindex.insert({key, int(count.size())});
+                int icl = result.first->second;
+                if(result.second)
+                {
+                    sumpos.push_back(Vector3d());
+                    sumnormal.push_back(Vector3d());
+                    count.push_back(0);
+                }
+                sumpos[icl] += P;
+                sumnormal[icl] += t3.normal()*t3.area();
+                count[icl]++;
+                cornercluster[3*it+k] = icl;
+            }
+        }
+
+        for(int icl=0; icl<int(count.size()); icl++)
+        {
+            sumpos[icl] *= 1.0/double(count[icl]);
+            sumnormal[icl].normalize();
+        }
+
+        int nLevel = 0;
+        std::vector<std::vector<float>> leveldata(nChunks);
+        for(int ic=0; ic<nChunks; ic++)
+        {
+            std::set<std::array<int,3>> done;
+            for(int it : chunktriangles[ic])
+            {
+                int c0 = cornercluster[3*it];
+                int c1 = cornercluster[3*it+1];
+                int c2 = cornercluster[3*it+2];
+                if(c0==c1 || c1==c2 || c2==c0) continue; // collapsed triangle
+
+                std::array<int,3> sorted = {c0, c1, c2};
+                std::sort(sorted.begin(), sorted.end());
+                if(!done.insert(sorted).second) continue; // duplicate triangle
+
+                if(bFlatNormals)
+                {
+                    Vector3d N = (sumpos[c1]-sumpos[c0]) * (sumpos[c2]-sumpos[c0]);
+                    if(N.norm()<=0.0) continue;
+                    N.normalize();
+                    addVertex(leveldata[ic], ic, sumpos[c0], N);
+                    addVertex(leveldata[ic], ic, sumpos[c1], N);
+                    addVertex(leveldata[ic], ic, sumpos[c2], N);
+                }
+                else
+                {
+                    addVertex(leveldata[ic], ic, sumpos[c0], sumnormal[c0]);
+                    addVertex(leveldata[ic], ic, sumpos[c1], sumnormal[c1]);
+                    addVertex(leveldata[ic], ic, sumpos[c2], sumnormal[c2]);
+                }
+                nLevel++;
+            }
+        }
+
+        // stop when the simplification no longer pays for the memory
+        if(nLevel>(3*nPrevious)/4 || nLevel==0) break;
+
+        m_CellSize.push_back(h);
+        for(int ic=0; ic<nChunks; ic++) data[ic].push_back(std::move(leveldata[ic]));
+        nPrevious = nLevel;
+    }
+
+    // pack everything in one buffer
+    size_t buffersize = 0;
+    for(int ic=0; ic<nChunks; ic++)
+        for(std::vector<float> const &array : data[ic]) buffersize += array.size();
+
+    std::vector<float> vertexarray;
+    vertexarray.reserve(buffersize);
+    for(int ic=0; ic<nChunks; ic++)
+    {
+        Chunk &ch = m_Chunk[ic];
+        for(std::vector<float> const &array : data[ic])
+        {
+            ch.m_First.push_back(int(vertexarray.size()/6)); // always a multiple of 3
+            ch.m_Count.push_back(int(array.size()/6));
+            vertexarray.insert(vertexarray.end(), array.begin(), array.end());
+        }
+    }
+
+    m_vbo.create();
+    m_vbo.bind();
+    m_vbo.allocate(vertexarray.data(), int(vertexarray.size() * sizeof(GLfloat)));
+    m_vbo.release();
+}
+
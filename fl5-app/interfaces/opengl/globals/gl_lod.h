@@ -0,0 +1,90 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <vector>
+
+#include <QOpenGLBuffer>
+
+#include <api/triangulation.h>
+#include <api/vector3d.h>
+
+
+/**
+ * @class glLodMesh
+ * @brief A triangulation split in spatial chunks, each with a pyramid of simplified levels of detail.
+ *
+ * The chunks are the cells of a regular grid over the bounding box of the triangulation.
+ * Level 0 holds the original triangles; each coarser level is made by vertex clustering
+ * on a grid twice as coarse as the previous level's. The clusters are built over the whole
+ * triangulation, so that the simplified chunks still join without cracks.
+ *
+ * All the levels of all chunks are stored in a single vertex buffer with the layout of
+ * gl::makeTriangulation3Vtx(), i.e. three non-indexed vertices per triangle, each made of
+ * 3 position and 3 normal components. Each level of each chunk is a contiguous range which
+ * starts on a triangle boundary, so that the shader can rebuild the barycentric coordinates
+ * of the fragments from gl_VertexID.
+ */
+class glLodMesh
+{
+    public:
+        struct Chunk
+        {
+            Vector3d m_Min, m_Max;      /**< the bounding box of the chunk's vertices, all levels included */
+            std::vector<int> m_First;   /**< the index of the first vertex of each level in the buffer */
+            std::vector<int> m_Count;   /**< the number of vertices of each level */
+        };
+
+    public:
+        glLodMesh();
+        ~glLodMesh();
+
+        void build(Triangulation const &triangulation, bool bFlatNormals);
+        void clear();
+
+        bool isEmpty() const {return m_Chunk.empty();}
+
+        int nChunks() const {return int(m_Chunk.size());}
+        Chunk const &chunk(int ic) const {return m_Chunk.at(ic);}
+
+        int nLevels() const {return int(m_CellSize.size());}
+        double cellSize(int level) const {return m_CellSize.at(level);}
+
+        QOpenGLBuffer &vbo() {return m_vbo;}
+
+        static double pixelTolerance() {return s_PixelTolerance;}
+        static void setPixelTolerance(double pixels) {s_PixelTolerance=pixels;}
+
+    private:
+        std::vector<Chunk> m_Chunk;
+        std::vector<double> m_CellSize;  /**< the clustering size of each level; 0 for the full resolution level */
+        QOpenGLBuffer m_vbo;
+
+        static int s_ChunkSize;          /**< the target number of triangles in a chunk */
+        static int s_MaxLevels;
+        static double s_PixelTolerance;  /**< the maximal screen size in pixels of a cluster at draw time */
+};
+
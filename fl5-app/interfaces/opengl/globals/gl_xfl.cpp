@@ -41,6 +41,7 @@
 #include <api/sailspline.h>
 #include <api/sailwing.h>
 #include <api/wingsailsection.h>
+#include <api/vortonwake.h>
 
 
 
@@ -1643,105 +1644,196 @@ void gl::makeTriLinColorMap(std::vector<Panel3> const &panel3, std::vector<Node>
 }
 
 
-/** Implementation of the "marching triangles" algorithm.
- *  https://en.wikipedia.org/wiki/Marching_squares#Contouring_triangle_meshes
-*/
-void gl::makeTriangleContoursOnMesh(std::vector<Panel3> const &panel3list,
-                                    std::vector<double> const &Cp,
-                                    double lmin, double lmax,
-                                    QOpenGLBuffer &vbo)
+/** Fills the vbo with the vertices of the two triangles of each quad panel, in the order used by makeQuadNodeClrMap() */
+void gl::makeQuadColourMapGeometry(std::vector<Panel4> const &panel4list, QOpenGLBuffer &vbo)
 {
-    if(panel3list.size()<1)     {vbo.destroy();  return;}
+    // vertices array size:
+    //        nPanels
+    //      x2 triangles per panels
+    //      x3 nodes per triangle
+    //        x3 vertex components
+    int nodeVertexSize = int(panel4list.size()) * 2 * 3 * 3;
+    QVector<float> nodeVertexArray(nodeVertexSize);
 
-    float range = lmax - lmin;
+    int const order[] = {1,2,0, 3,0,2};
+    int iv=0;
+    for (uint i4=0; i4<panel4list.size(); i4++)
+    {
+        Panel4 const &p4 = panel4list.at(i4);
+        for(int k=0; k<6; k++)
+        {
+            nodeVertexArray[iv++] = p4.m_Node[order[k]].xf();
+            nodeVertexArray[iv++] = p4.m_Node[order[k]].yf();
+            nodeVertexArray[iv++] = p4.m_Node[order[k]].zf();
+        }
+    }
+    Q_ASSERT(iv==nodeVertexSize);
+
+    vbo.destroy();
+    vbo.create();
+    vbo.bind();
+    vbo.allocate(nodeVertexArray.data(), nodeVertexSize * int(sizeof(GLfloat)));
+    vbo.release();
+}
 
-    //define the threshold values for the contours
-    int nContours = W3dPrefs::s_NContourLines;
 
-    // nContours+1 to skip useless min and max iso-contours
-    QVector<float> contour(nContours);
-//    qDebug("      lmin = %17g", lmin);
-    for(int ic=0; ic<nContours; ic++)
+/** Fills the vbo with the three vertices of each triangular panel */
+void gl::makeTriColourMapGeometry(std::vector<Panel3> const &panel3list, QOpenGLBuffer &vbo)
+{
+    int nodeVertexSize = int(panel3list.size()) * 3 * 3;
+    QVector<float> nodeVertexArray(nodeVertexSize);
+
+    int iv=0;
+    for (uint i3=0; i3<panel3list.size(); i3++)
     {
-        contour[ic] = lmin + float(ic+1)/float(nContours+1)*range;
-//        qDebug("Contour_%2d = %17g", ic, contour[ic]);
+        Panel3 const &p3 = panel3list.at(i3);
+        for(int ivtx=0; ivtx<3; ivtx++)
+        {
+            nodeVertexArray[iv++] = p3.vertexAt(ivtx).xf();
+            nodeVertexArray[iv++] = p3.vertexAt(ivtx).yf();
+            nodeVertexArray[iv++] = p3.vertexAt(ivtx).zf();
+        }
+    }
+    Q_ASSERT(iv==nodeVertexSize);
+
+    vbo.destroy();
+    vbo.create();
+    vbo.bind();
+    vbo.allocate(nodeVertexArray.data(), nodeVertexSize * int(sizeof(GLfloat)));
+    vbo.release();
+}
+
+
+/** Uploads the scalar values in place if the buffer already has the right size, which is the case when only the operating point has changed */
+static void uploadColourMapValues(QVector<float> const &values, QOpenGLBuffer &vbo)
+{
+    int nBytes = values.size() * int(sizeof(GLfloat));
+    if(vbo.isCreated() && vbo.size()==nBytes)
+    {
+        vbo.bind();
+        vbo.write(0, values.constData(), nBytes);
+        vbo.release();
+        return;
     }
-//    qDebug("      lmax = %17g\n", lmax);
 
-    QVector<Segment3d> segs;
+    vbo.destroy();
+    vbo.create();
+    vbo.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    vbo.bind();
+    vbo.allocate(values.constData(), nBytes);
+    vbo.release();
+}
 
-    Vector3d I0, I1;// crossover points on edge
-    for(int ic=0; ic<nContours; ic++)
+
+/** Fills the vbo with the normalized value of each vertex of makeQuadColourMapGeometry(), to be mapped on the colour ramp */
+void gl::makeQuadColourMapValues(std::vector<Panel4> const &panel4list, std::vector<double> const &data,
+                                 double &lmin, double &lmax, bool bAuto, QOpenGLBuffer &vbo)
+{
+    if(panel4list.size()<=0 || panel4list.size()>data.size())
     {
-        double threshold = contour.at(ic);
-        for(uint t3=0; t3<panel3list.size(); t3++)
+        vbo.destroy();
+        return;
+    }
+
+    if(bAuto)
+    {
+        lmin =  1000000.0;
+        lmax = -1000000.0;
+        for (uint i4=0; i4<panel4list.size(); i4++)
         {
-            Panel3 const &p3 = panel3list.at(t3);
+            int index = panel4list.at(i4).index();
+            lmin = std::min(lmin, data.at(index));
+            lmax = std::max(lmax, data.at(index));
+        }
+    }
 
-            // check for crossover of contour value
-            // use base 2 key as table index
+    float range = lmax - lmin;
 
-            double tau = 0.0;
-            int i0=-1, i1=-1, i2=-1, i3=-1;
-            int key = 0;
-            int k=1;
-            double val[]= {0,0,0};
-            for(int iVtx=0; iVtx<3; iVtx++)
-            {
-                val[iVtx] = Cp[p3.nodeIndex(iVtx)];
+    QVector<float> values(int(panel4list.size()) * 2 * 3);
+    int iv=0;
+    for (uint i4=0; i4<panel4list.size(); i4++)
+    {
+        float tau = (float(data.at(panel4list.at(i4).index()))-lmin)/range;
+        for(int k=0; k<6; k++) values[iv++] = tau;
+    }
 
-                if(val[iVtx]-threshold<0) // true if there is a crossover
-                {
-                    key += k;
-                }
-                k *= 2;
-            }
+    uploadColourMapValues(values, vbo);
+}
 
-            gl::lookUpTriangularKey(key, i0, i1, i2, i3);
 
-            if(i0>=0 && i1>=0 && i2>=0 && i3>=0)
-            {
-                tau = (threshold - val[i0]) /(val[i1]-val[i0]);
-                I0 = p3.vertexAt(i0)*(1-tau) + p3.vertexAt(i1)*tau;
+/** Fills the vbo with the normalized value of each vertex of makeTriColourMapGeometry(), for the uniform density methods */
+void gl::makeTriUniColourMapValues(std::vector<Panel3> const &panel3list, std::vector<double> const &tab,
+                                   double &lmin, double &lmax, bool bAuto, QOpenGLBuffer &vbo)
+{
+    if(tab.size()<panel3list.size()*3)
+    {
+        vbo.destroy();
+        return;
+    }
 
-                tau = (threshold - val[i2]) /(val[i3]-val[i2]);
-                I1 = p3.vertexAt(i2)*(1-tau) + p3.vertexAt(i3)*tau;
+    int nPanel3 = int(panel3list.size());
 
-                segs.push_back({I0, I1});
+    if(bAuto)
+    {
+        lmin =  1000000.0;
+        lmax = -1000000.0;
+        for (int i3=0; i3<nPanel3; i3++)
+        {
+            int index = panel3list.at(i3).index();
+            for(int ivtx=0; ivtx<3; ivtx++)
+            {
+                lmin = std::min(lmin, tab[index*3+ivtx]);
+                lmax = std::max(lmax, tab[index*3+ivtx]);
             }
         }
     }
 
-    // vertex array size
-    // nsegs
-    // x 2 vertices
-    // x 3 components
-    int nodeVertexSize = segs.size() * 2 * 3;
-    QVector<float> nodeVertexArray(nodeVertexSize);
+    float range = lmax - lmin;
 
+    QVector<float> values(nPanel3 * 3);
     int iv=0;
-    for(int is=0; is<segs.size(); is++)
+    for (int i3=0; i3<nPanel3; i3++)
     {
-        Node const & n0 = segs.at(is).vertexAt(0);
-        Node const & n1 = segs.at(is).vertexAt(1);
-        nodeVertexArray[iv++] = n0.xf();
-        nodeVertexArray[iv++] = n0.yf();
-        nodeVertexArray[iv++] = n0.zf();
-        nodeVertexArray[iv++] = n1.xf();
-        nodeVertexArray[iv++] = n1.yf();
-        nodeVertexArray[iv++] = n1.zf();
+        int index = panel3list.at(i3).index();
+        for(int ivtx=0; ivtx<3; ivtx++)
+            values[iv++] = (float(tab[index*3+ivtx])-lmin) / range;
     }
 
-    Q_ASSERT(iv==nodeVertexSize);
+    uploadColourMapValues(values, vbo);
+}
 
-    vbo.destroy();
-    vbo.create();
-    vbo.bind();
-    vbo.allocate(nodeVertexArray.data(), nodeVertexSize * int(sizeof(GLfloat)));
-    vbo.release();
+
+/** Fills the vbo with the normalized value of each vertex of makeTriColourMapGeometry(), for the linear density methods */
+void gl::makeTriLinColourMapValues(std::vector<Panel3> const &panel3list, int nNodes, std::vector<double> const &nodevalues,
+                                   double lmin, double lmax, QOpenGLBuffer &vbo)
+{
+    int nPanel3 = int(panel3list.size());
+    double range = lmax - lmin;
+
+    QVector<float> values(nPanel3 * 3);
+    int iv=0;
+    for(int p=0; p<nPanel3; p++)
+    {
+        Panel3 const &p3 = panel3list.at(p);
+        for(int i=0; i<3; i++)
+        {
+            int idx = p3.nodeIndex(i);
+            if(0<=idx && idx<nNodes && idx<int(nodevalues.size()))
+                values[iv++] = float((nodevalues[idx]-lmin)/range);
+            else
+                values[iv++] = 1.0f; // out of range, painted with the last colour
+        }
+    }
+
+    uploadColourMapValues(values, vbo);
 }
 
 
+/**
+ * Makes the instance buffer of the panel force arrows, to be painted with gl3dView::paintArrowInstances().
+ * Each arrow is defined by 9 floats: the origin, the vector from the origin to the tip, and the colour.
+ * The compression arrows point towards the surface, the depression arrows point outwards.
+ */
 void gl::makePanelForces(std::vector<Panel4> const &panel4list,
                          const std::vector<double> &Cp, float qDyn, bool bVLM,
                          double &rmin, double &rmax, bool bAuto, double scale,
@@ -1753,16 +1845,6 @@ void gl::makePanelForces(std::vector<Panel4> const &panel4list,
         return;
     }
 
-    Quaternion Qt; // Quaternion operator to align the reference arrow to the panel's normal
-    Vector3d Omega; // rotation vector to align the reference arrow with the panel's normal
-    Vector3d O;
-    //The vectors defining the reference arrow
-    Vector3d R(0.0,0.0,1.0);
-    Vector3d R1( 0.05, 0.0, -0.1);
-    Vector3d R2(-0.05, 0.0, -0.1);
-    //The three vectors defining the arrow on the panel
-    Vector3d P, P1, P2;
-
     //define the range of values to set the colors in accordance
     float coef = 0.00001f;
 
@@ -1782,15 +1864,13 @@ void gl::makePanelForces(std::vector<Panel4> const &panel4list,
 
     float range = rmax - rmin;
 
-    // vertices array size:
+    // instance array size:
     //        nPanels x 1 arrow
-    //      x3 lines per arrow
-    //      x2 vertices per line
-    //        x6 = 3 vertex components + 3 color components
-
-    int forceVertexSize = int(panel4list.size()) * 3 * 2 * 6;
-    QVector<float> forceVertexArray(forceVertexSize);
+    //        x9 = 3 origin components + 3 vector components + 3 color components
+    int forceInstanceSize = int(panel4list.size()) * 9;
+    QVector<float> forceInstanceArray(forceInstanceSize);
 
+    Vector3d O, P;
     int iv=0;
     for(uint p=0; p<panel4list.size(); p++)
     {
@@ -1805,135 +1885,34 @@ void gl::makePanelForces(std::vector<Panel4> const &panel4list,
 
         QColor clr = ColourLegend::colour(tau);
 
-        float r = clr.redF();
-        float g = clr.greenF();
-        float b = clr.blueF();
-
         O.set(p4.ctrlPt(bVLM));
-
-        // Rotate the reference arrow to align it with the panel normal
-        if(R.isSame(P))
-        {
-            Qt.set(0.0, 0.0,0.0,1.0); //Null quaternion
-        }
-        else
-        {
-            float cosa   = float(R.dot(p4.normal()));
-            float sina2  = sqrtf((1.0f - cosa)*0.5f);
-            float cosa2  = sqrtf((1.0f + cosa)*0.5f);
-
-            Omega = R * p4.normal();//crossproduct
-            Omega.normalize();
-            Omega *= double(sina2);
-            Qt.set(double(cosa2), Omega.x, Omega.y, Omega.z);
-        }
-
-        Qt.conjugate(R,  P);
-        Qt.conjugate(R1, P1);
-        Qt.conjugate(R2, P2);
-
-        // Scale the pressure vector
-        P  *= double(force);
-        P1 *= double(force);
-        P2 *= double(force);
-        if(Cp.at(index)>0 && !p4.isMidPanel())
-        {
-            // compression, point towards the surface
-            forceVertexArray[iv++] = O.xf();
-            forceVertexArray[iv++] = O.yf();
-            forceVertexArray[iv++] = O.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = O.xf()+P.xf();
-            forceVertexArray[iv++] = O.yf()+P.yf();
-            forceVertexArray[iv++] = O.zf()+P.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-
-            forceVertexArray[iv++] = O.xf();
-            forceVertexArray[iv++] = O.yf();
-            forceVertexArray[iv++] = O.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = O.xf()-P1.xf();
-            forceVertexArray[iv++] = O.yf()-P1.yf();
-            forceVertexArray[iv++] = O.zf()-P1.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-
-            forceVertexArray[iv++] = O.xf();
-            forceVertexArray[iv++] = O.yf();
-            forceVertexArray[iv++] = O.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = O.xf()-P2.xf();
-            forceVertexArray[iv++] = O.yf()-P2.yf();
-            forceVertexArray[iv++] = O.zf()-P2.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-        }
-        else
-        {
-            // depression, point outwards from the surface
-            P.set(-P.x, -P.y, -P.z);
-
-            forceVertexArray[iv++] = O.xf();
-            forceVertexArray[iv++] = O.yf();
-            forceVertexArray[iv++] = O.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = O.xf()+P.xf();
-            forceVertexArray[iv++] = O.yf()+P.yf();
-            forceVertexArray[iv++] = O.zf()+P.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-
-            forceVertexArray[iv++] = O.xf()+P.xf();
-            forceVertexArray[iv++] = O.yf()+P.yf();
-            forceVertexArray[iv++] = O.zf()+P.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = O.xf()+P.xf()-P1.xf();
-            forceVertexArray[iv++] = O.yf()+P.yf()-P1.yf();
-            forceVertexArray[iv++] = O.zf()+P.zf()-P1.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-
-            forceVertexArray[iv++] = O.xf()+P.xf();
-            forceVertexArray[iv++] = O.yf()+P.yf();
-            forceVertexArray[iv++] = O.zf()+P.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = O.xf()+P.xf()-P2.xf();
-            forceVertexArray[iv++] = O.yf()+P.yf()-P2.yf();
-            forceVertexArray[iv++] = O.zf()+P.zf()-P2.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-        }
-
+        P = p4.normal() * double(force);
+
+        // compression, point towards the surface; depression, point outwards from the surface
+        if(Cp.at(index)>0 && !p4.isMidPanel()) O += P;
+        P.set(-P.x, -P.y, -P.z);
+
+        forceInstanceArray[iv++] = O.xf();
+        forceInstanceArray[iv++] = O.yf();
+        forceInstanceArray[iv++] = O.zf();
+        forceInstanceArray[iv++] = P.xf();
+        forceInstanceArray[iv++] = P.yf();
+        forceInstanceArray[iv++] = P.zf();
+        forceInstanceArray[iv++] = clr.redF();
+        forceInstanceArray[iv++] = clr.greenF();
+        forceInstanceArray[iv++] = clr.blueF();
     }
-    Q_ASSERT(iv==forceVertexSize);
+    Q_ASSERT(iv==forceInstanceSize);
 
     vbo.destroy();
     vbo.create();
     vbo.bind();
-    vbo.allocate(forceVertexArray.data(), forceVertexSize * int(sizeof(GLfloat)));
+    vbo.allocate(forceInstanceArray.data(), forceInstanceSize * int(sizeof(GLfloat)));
     vbo.release();
 }
 
 
+/** @see the Panel4 version */
 void gl::makePanelForces(std::vector<Panel3> const &panel3list, std::vector<double> const &Cp,
                          float qDyn,
                          double &rmin, double &rmax, bool bAuto, double scale,
@@ -1946,15 +1925,6 @@ void gl::makePanelForces(std::vector<Panel3> const &panel3list, std::vector<doub
         return;
     }
 
-    Quaternion Qt; // Quaternion operator to align the reference arrow with the panel's normal
-    Vector3d O;
-    //The vectors defining the reference arrow
-    Vector3d const Ra(0.0,0.0,1.0);
-    Vector3d const R1( 0.05, 0.0, -0.1);
-    Vector3d const R2(-0.05, 0.0, -0.1);
-    //The three vectors defining the arrow on the panel
-    Vector3d P, P1, P2;
-
     //define the range of values to set the colors in accordance
 
     float coef = 0.00001f;
@@ -1978,15 +1948,12 @@ void gl::makePanelForces(std::vector<Panel3> const &panel3list, std::vector<doub
 
     float range = rmax - rmin;
 
-    // vertices array size:
+    // instance array size:
     //        nPanels x 1 arrow
-    //      x3 lines per arrow
-    //      x2 vertices per line
-    //        x6 = 3 vertex components + 3 color components
+    //        x9 = 3 origin components + 3 vector components + 3 color components
+    QVector<float> forceInstanceArray(nPanel3 * 9);
 
-    int forceVertexSize = nPanel3 * 3 * 2 * 6;
-    QVector<float> forceVertexArray(forceVertexSize);
-    QColor clr;
+    Vector3d O, P;
     int iv=0;
     for (int p=0; p<nPanel3; p++)
     {
@@ -1998,290 +1965,103 @@ void gl::makePanelForces(std::vector<Panel3> const &panel3list, std::vector<doub
         //scale force for display
         force *= scale *coef;
 
-        clr = ColourLegend::colour(tau);
-        float r = clr.redF();
-        float g = clr.greenF();
-        float b = clr.blueF();
+        QColor clr = ColourLegend::colour(tau);
 
         O = p3.CoG();
-
-        if(fabs(Ra.dot(p3.normal())-1.0)<0.0001)
-        {
-            P = Ra; P1=R1; P2=R2;
-        }
-        else if(fabs(Ra.dot(p3.normal())+1.0)<0.0001)
-        {
-            P = Ra*-1.0; P1=R1*-1.0; P2=R2*-1.0;
-        }
-        else
-        {
-            Qt.from2UnitVectors(Ra, p3.normal());
-            Qt.conjugate(Ra,  P);
-            Qt.conjugate(R1, P1);
-            Qt.conjugate(R2, P2);
-        }
-
-        // Scale the pressure vector
-        P  *= double(force);
-        P1 *= double(force);
-        P2 *= double(force);
-
-        if(Cp[p3.index()*3]>0 && !p3.isMidPanel())
-        {
-            // compression, point towards the surface
-            forceVertexArray[iv++] = O.xf();
-            forceVertexArray[iv++] = O.yf();
-            forceVertexArray[iv++] = O.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = O.xf()+P.xf();
-            forceVertexArray[iv++] = O.yf()+P.yf();
-            forceVertexArray[iv++] = O.zf()+P.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-
-            forceVertexArray[iv++] = O.xf();
-            forceVertexArray[iv++] = O.yf();
-            forceVertexArray[iv++] = O.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = O.xf()-P1.xf();
-            forceVertexArray[iv++] = O.yf()-P1.yf();
-            forceVertexArray[iv++] = O.zf()-P1.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-
-            forceVertexArray[iv++] = O.xf();
-            forceVertexArray[iv++] = O.yf();
-            forceVertexArray[iv++] = O.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = O.xf()-P2.xf();
-            forceVertexArray[iv++] = O.yf()-P2.yf();
-            forceVertexArray[iv++] = O.zf()-P2.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-        }
-        else
-        {
-            // depression, point outwards from the surface
-            P.set(-P.x, -P.y, -P.z);
-
-            forceVertexArray[iv++] = O.xf();
-            forceVertexArray[iv++] = O.yf();
-            forceVertexArray[iv++] = O.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = O.xf()+P.xf();
-            forceVertexArray[iv++] = O.yf()+P.yf();
-            forceVertexArray[iv++] = O.zf()+P.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-
-            forceVertexArray[iv++] = O.xf()+P.xf();
-            forceVertexArray[iv++] = O.yf()+P.yf();
-            forceVertexArray[iv++] = O.zf()+P.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = O.xf()+P.xf()-P1.xf();
-            forceVertexArray[iv++] = O.yf()+P.yf()-P1.yf();
-            forceVertexArray[iv++] = O.zf()+P.zf()-P1.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-
-            forceVertexArray[iv++] = O.xf()+P.xf();
-            forceVertexArray[iv++] = O.yf()+P.yf();
-            forceVertexArray[iv++] = O.zf()+P.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-            forceVertexArray[iv++] = O.xf()+P.xf()-P2.xf();
-            forceVertexArray[iv++] = O.yf()+P.yf()-P2.yf();
-            forceVertexArray[iv++] = O.zf()+P.zf()-P2.zf();
-            forceVertexArray[iv++] = r;
-            forceVertexArray[iv++] = g;
-            forceVertexArray[iv++] = b;
-        }
+        P = p3.normal() * double(force);
+
+        // compression, point towards the surface; depression, point outwards from the surface
+        if(Cp[p3.index()*3]>0 && !p3.isMidPanel()) O += P;
+        P.set(-P.x, -P.y, -P.z);
+
+        forceInstanceArray[iv++] = O.xf();
+        forceInstanceArray[iv++] = O.yf();
+        forceInstanceArray[iv++] = O.zf();
+        forceInstanceArray[iv++] = P.xf();
+        forceInstanceArray[iv++] = P.yf();
+        forceInstanceArray[iv++] = P.zf();
+        forceInstanceArray[iv++] = clr.redF();
+        forceInstanceArray[iv++] = clr.greenF();
+        forceInstanceArray[iv++] = clr.blueF();
     }
 
-//    Q_ASSERT(iv==forceVertexSize);
-
     vbo.destroy();
     vbo.create();
     vbo.bind();
-    vbo.allocate(forceVertexArray.data(), forceVertexSize * int(sizeof(GLfloat)));
+    vbo.allocate(forceInstanceArray.data(), iv * int(sizeof(GLfloat)));
     vbo.release();
 }
 
 
-/** triangles for the surface shader */
-void gl::makeVortons_spheres(std::vector<std::vector<Vorton>> const &Vortons, QOpenGLBuffer &vbo)
+/** For instance rendering*/
+void gl::makeVortons(std::vector<std::vector<Vorton>> const &vortons, QOpenGLBuffer &vbo)
 {
-    if(!Vortons.size())
+    if(!vortons.size() || !vortons.front().size())
     {
         vbo.destroy();
         return;
     }
 
-    // count the active vortons
+    bool bMidRowOnly = false;
     int nVortons = 0;
-    for(uint irow=0; irow<Vortons.size(); irow++)
+    for(uint i=0; i<vortons.size(); i++)
     {
-        std::vector<Vorton> const &vtnrow = Vortons.at(irow);
-        for(uint jv=0; jv<vtnrow.size(); jv++)
-        {
-            if(vtnrow.at(jv).isActive()) nVortons++;
-        }
+        if(bMidRowOnly && i!=vortons.size()/2) continue;
+        for(Vorton const &vorton : vortons.at(i))
+            if(vorton.isActive()) nVortons++;
     }
+    int buffersize = nVortons*3;
 
-    // make vertices
-    std::vector<Triangle3d> icotriangles;
-    geom::makeSphere(W3dPrefs::s_VortonRadius, 1, icotriangles);
-
-    //Make the triangulation
-    int bufferSize = nVortons * int(icotriangles.size());
-    bufferSize *=4;    // 4 vertices for each triangle
-    bufferSize *=6;    // (3 coords+3 normal components) for each node
-
-    QVector<float> meshvertexarray(bufferSize);
-    bool bFlatNormals = true;
-    Vector3d N;
-
-    int iv = 0;
-
-    for(uint irow=0; irow<Vortons.size(); irow++)
+    QVector<float> pts(buffersize);
+    int iv =0;
+    for(uint i=0; i<vortons.size(); i++)
     {
-        std::vector<Vorton> const &vtnrow = Vortons.at(irow);
-        for(uint jv=0; jv<vtnrow.size(); jv++)
+        std::vector<Vorton> const& vortonrow = vortons.at(i);
+        if(bMidRowOnly)
         {
-            Vorton const &vorton = vtnrow.at(jv);
-            if(!vorton.isActive()) continue;
-
-            for(uint it=0; it<icotriangles.size(); it++)
-            {
-                Triangle3d const &t3d = icotriangles.at(it);
-                N.set(t3d.normal());
-
-                meshvertexarray[iv++] = t3d.vertexAt(0).xf() + vorton.position().xf();
-                meshvertexarray[iv++] = t3d.vertexAt(0).yf() + vorton.position().yf();
-                meshvertexarray[iv++] = t3d.vertexAt(0).zf() + vorton.position().zf();
-                if(bFlatNormals)
-                {
-                    meshvertexarray[iv++] = N.xf();
-                    meshvertexarray[iv++] = N.yf();
-                    meshvertexarray[iv++] = N.zf();
-                }
-                else
-                {
-                    meshvertexarray[iv++] = t3d.vertexAt(0).normal().xf();
-                    meshvertexarray[iv++] = t3d.vertexAt(0).normal().yf();
-                    meshvertexarray[iv++] = t3d.vertexAt(0).normal().zf();
-                }
-
-                meshvertexarray[iv++] = t3d.vertexAt(1).xf() + vorton.position().xf();
-                meshvertexarray[iv++] = t3d.vertexAt(1).yf() + vorton.position().yf();
-                meshvertexarray[iv++] = t3d.vertexAt(1).zf() + vorton.position().zf();
-                if(bFlatNormals)
-                {
-                    meshvertexarray[iv++] = N.xf();
-                    meshvertexarray[iv++] = N.yf();
-                    meshvertexarray[iv++] = N.zf();
-                }
-                else
-                {
-                    meshvertexarray[iv++] = t3d.vertexAt(0).normal().xf();
-                    meshvertexarray[iv++] = t3d.vertexAt(0).normal().yf();
-                    meshvertexarray[iv++] = t3d.vertexAt(0).normal().zf();
-                }
-
-                meshvertexarray[iv++] = t3d.vertexAt(2).xf() + vorton.position().xf();
-                meshvertexarray[iv++] = t3d.vertexAt(2).yf() + vorton.position().yf();
-                meshvertexarray[iv++] = t3d.vertexAt(2).zf() + vorton.position().zf();
-                if(bFlatNormals)
-                {
-                    meshvertexarray[iv++] = N.xf();
-                    meshvertexarray[iv++] = N.yf();
-                    meshvertexarray[iv++] = N.zf();
-                }
-                else
-                {
-                    meshvertexarray[iv++] = t3d.vertexAt(0).normal().xf();
-                    meshvertexarray[iv++] = t3d.vertexAt(0).normal().yf();
-                    meshvertexarray[iv++] = t3d.vertexAt(0).normal().zf();
-                }
-
-                //close the triangle
-                meshvertexarray[iv++] = t3d.vertexAt(0).xf() + vorton.position().xf();
-                meshvertexarray[iv++] = t3d.vertexAt(0).yf() + vorton.position().yf();
-                meshvertexarray[iv++] = t3d.vertexAt(0).zf() + vorton.position().zf();
-                if(bFlatNormals)
-                {
-                    meshvertexarray[iv++] = N.xf();
-                    meshvertexarray[iv++] = N.yf();
-                    meshvertexarray[iv++] = N.zf();
-                }
-                else
-                {
-                    meshvertexarray[iv++] = t3d.vertexAt(0).normal().xf();
-                    meshvertexarray[iv++] = t3d.vertexAt(0).normal().yf();
-                    meshvertexarray[iv++] = t3d.vertexAt(0).normal().zf();
-                }
+            if(i!=vortons.size()/2) continue;
+        }
 
-            }
+        for(uint j=0; j<vortonrow.size(); j++)
+        {
+            Vorton const &vorton = vortonrow.at(j);
+            if(!vorton.isActive()) continue;
+            pts[iv++] = vorton.position().xf();
+            pts[iv++] = vorton.position().yf();
+            pts[iv++] = vorton.position().zf();
         }
     }
-    Q_ASSERT(iv==bufferSize);
 
-    vbo.destroy();
+    if(vbo.isCreated()) vbo.destroy();
     vbo.create();
     vbo.bind();
-    vbo.allocate(meshvertexarray.data(), bufferSize * int(sizeof(GLfloat)));
+    vbo.allocate(pts.data(), buffersize * int(sizeof(GLfloat)));
     vbo.release();
 }
 
 
-/** For instance rendering*/
-void gl::makeVortons(std::vector<std::vector<Vorton>> const &vortons, QOpenGLBuffer &vbo)
+/** Makes the buffer of the active vortons of a stored wake, directly from its single precision arrays */
+void gl::makeVortons(VortonWake const &wake, QOpenGLBuffer &vbo)
 {
-    if(!vortons.size() || !vortons.front().size())
+    int nVortons = 0;
+    for(int i=0; i<wake.count(); i++)
+        if(wake.isActive(i)) nVortons++;
+
+    if(!nVortons)
     {
         vbo.destroy();
         return;
     }
 
-    bool bMidRowOnly = false;
-    int nVortons = 0;
-    if(bMidRowOnly) nVortons = int(vortons.front().size());
-    else            nVortons = int(vortons.size()*vortons.front().size());
     int buffersize = nVortons*3;
-
     QVector<float> pts(buffersize);
     int iv =0;
-    for(uint i=0; i<vortons.size(); i++)
+    for(int i=0; i<wake.count(); i++)
     {
-        std::vector<Vorton> const& vortonrow = vortons.at(i);
-        if(bMidRowOnly)
-        {
-            if(i!=vortons.size()/2) continue;
-        }
-
-        for(uint j=0; j<vortonrow.size(); j++)
-        {
-            Vorton const &vorton = vortonrow.at(j);
-            pts[iv++] = vorton.position().xf();
-            pts[iv++] = vorton.position().yf();
-            pts[iv++] = vorton.position().zf();
-        }
+        if(!wake.isActive(i)) continue;
+        pts[iv++] = wake.xf(i);
+        pts[iv++] = wake.yf(i);
+        pts[iv++] = wake.zf(i);
     }
 
     if(vbo.isCreated()) vbo.destroy();
@@ -37,6 +37,7 @@ class BoatPolar;
 class FuseXfl;
 class Fuse;
 class FuseSections;
+class VortonWake;
 
 // gl related methods using xfl objects
 
@@ -56,11 +57,17 @@ namespace gl
 
     void makeTriLinColorMap(const std::vector<Panel3> &panel3, const std::vector<Node> &NodeList, const std::vector<double> &Cp,
                             double lmin, double lmax, QOpenGLBuffer &vbo);
-    void makeTriangleContoursOnMesh(const std::vector<Panel3> &panel3list, const std::vector<double> &Cp,
-                                    double lmin, double lmax, QOpenGLBuffer &vbo);
 
-    void makeVortons_spheres(std::vector<std::vector<Vorton>> const &Vortons, QOpenGLBuffer &vbo);
+    // colour maps split in a position buffer, made once per mesh, and a scalar buffer updated for each operating point
+    void makeQuadColourMapGeometry(std::vector<Panel4> const &panel4list, QOpenGLBuffer &vbo);
+    void makeTriColourMapGeometry(std::vector<Panel3> const &panel3list, QOpenGLBuffer &vbo);
+    void makeQuadColourMapValues(std::vector<Panel4> const &panel4list, std::vector<double> const &data, double &lmin, double &lmax, bool bAuto, QOpenGLBuffer &vbo);
+    void makeTriUniColourMapValues(std::vector<Panel3> const &panel3list, std::vector<double> const &tab, double &lmin, double &lmax, bool bAuto, QOpenGLBuffer &vbo);
+    void makeTriLinColourMapValues(std::vector<Panel3> const &panel3list, int nNodes, std::vector<double> const &nodevalues, double lmin, double lmax, QOpenGLBuffer &vbo);
+
+
     void makeVortons(std::vector<std::vector<Vorton>> const &Vortons, QOpenGLBuffer &vbo);
+    void makeVortons(VortonWake const &wake, QOpenGLBuffer &vbo);
 
     void makePanelForces(std::vector<Panel4> const &panel4list, const std::vector<double> &Cp, float qDyn, bool bVLM, double &rmin, double &rmax, bool bAuto, double scale, QOpenGLBuffer &vbo);
     void makePanelForces(const std::vector<Panel3> &panel3list, const std::vector<double> &Cp, float qDyn, double &rmin, double &rmax, bool bAuto, double scale, QOpenGLBuffer &vbo);
@@ -2,6 +2,7 @@ HEADERS += \
     $$PWD/gl_occ.h \
     $$PWD/gl_xfl.h \
     $$PWD/gl_globals.h \
+    $$PWD/gl_lod.h \
     $$PWD/opengldlg.h \
 
 
@@ -9,4 +10,5 @@ SOURCES += \
     $$PWD/gl_occ.cpp \
     $$PWD/gl_xfl.cpp \
     $$PWD/gl_globals.cpp \
+    $$PWD/gl_lod.cpp \
     $$PWD/opengldlg.cpp \
@@ -3,10 +3,28 @@
 in vec4 vertexPosition_modelSpace;
 in vec4 vertexColor;
 
+in vec3 instanceOrigin; // used if instanced
+in vec3 instanceVector; // used if instanced; the direction and length of the glyph's z-axis
+
+uniform int Instanced = 0;
+
 out vec4 VtxColor;
 
 void main(void)
 {
     VtxColor = vertexColor;
-    gl_Position =  vertexPosition_modelSpace;// pass through, the processing is done in the geom shader
+
+    if(Instanced==1)
+    {
+        // map the glyph's z-axis to the instance vector, the processing is done in the geom shader
+        float l = length(instanceVector);
+        vec3 w = l>0.0 ? instanceVector/l : vec3(0.0, 0.0, 1.0);
+        vec3 a = abs(w.z)<0.9 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);
+        vec3 u = normalize(cross(a, w));
+        vec3 v = cross(w, u);
+        vec3 p = vertexPosition_modelSpace.xyz * l;
+        gl_Position = vec4(instanceOrigin + p.x*u + p.y*v + p.z*w, 1.0);
+    }
+    else
+        gl_Position =  vertexPosition_modelSpace;// pass through, the processing is done in the geom shader
 }
@@ -0,0 +1,106 @@
+#version 330
+
+// Evaluates the inviscid velocity and Cp fields of a foil at each pixel.
+// The foil is made of linear vortex panels, with the node positions and the
+// unit vorticities for alpha=0 and 90° read from a 1D texture; the vorticity
+// at the current aoa is their combination weighted by the freestream velocity.
+
+#define PI 3.141592654
+
+uniform sampler1D Nodes;     // x, y, gamma_0, gamma_90 per node
+uniform int    NNodes;
+uniform vec2   QInf;         // the unit freestream velocity, i.e. (cos(alpha), sin(alpha))
+uniform int    FieldType;    // 0: Cp, 1: V/Vinf
+uniform vec2   Range;        // the values mapped to the ends of the colour scale
+
+in vec2 pos;
+
+layout(location = 0) out vec4 FragmentColor;
+
+
+float glGetRed(float tau)
+{
+    if     (tau>5.0f/6.0f) return 1.0f;
+    else if(tau>4.0f/6.0f) return (6.0f*(tau-4.0f/6.0f));
+    else if(tau>2.0f/6.0f) return 0.0f;
+    else if(tau>1.0f/6.0f) return 1.0f - (6.0f*(tau-1.0f/6.0f));
+    else                   return 1.0f;
+}
+
+float glGetGreen(float tau)
+{
+    if      (tau<2.0f/6.0f) return 0.0f;
+    else if (tau<3.0f/6.0f) return 6.0f*(tau-2.0f/6.0f);
+    else if (tau<5.0f/6.0f) return 1.0f;
+    else if (tau<6.0f/6.0f) return 1.0f - (6.0f*(tau-5.0f/6.0f));
+    else                    return 0.0f;
+}
+
+float glGetBlue(float tau)
+{
+    if      (tau<0.0f)      return 0.0f;
+    else if (tau<1.0f/6.0f) return 6.0f * tau;
+    else if (tau<3.0f/6.0f) return 1.0f;
+    else if (tau<4.0f/6.0f) return 1.0f - (6.0f*(tau-3.0f/6.0f));
+    else                    return 0.0f;
+}
+
+
+void main(void)
+{
+    vec2 V = QInf;
+    float winding = 0.0f; // the sum of the subtended angles, 2.pi inside the contour
+
+    vec4 nodeA = texelFetch(Nodes, 0, 0);
+    float gA = dot(nodeA.zw, QInf);
+    vec2 PA = pos - nodeA.xy;
+    float logrA = log(dot(PA,PA));
+
+    for(int i=1; i<NNodes; i++)
+    {
+        vec4 nodeB = texelFetch(Nodes, i, 0);
+        float gB = dot(nodeB.zw, QInf);
+        vec2 PB = pos - nodeB.xy;
+        float logrB = log(dot(PB,PB));
+
+        vec2 AB = nodeB.xy - nodeA.xy;
+        float L = length(AB);
+        if(L>1.0e-7f)
+        {
+            vec2 t = AB/L;
+            vec2 n = vec2(-t.y, t.x);
+
+            // the local coordinates w.r.t. node A, the angle subtended by the panel, and ln(rA/rB)
+            float x = dot(PA, t);
+            float y = dot(PA, n);
+            float dtheta = atan(PA.x*PB.y-PA.y*PB.x, dot(PA, PB));
+            float lr = 0.5f*(logrA-logrB);
+
+            float dg = (gB-gA)/L;
+
+            float u =  gA*dtheta + dg*(x*dtheta - y*lr);
+            float v = -gA*lr     - dg*(x*lr - L + y*dtheta);
+            V += (u*t + v*n)/2.0f/PI;
+
+            winding += dtheta;
+        }
+
+        nodeA = nodeB;
+        gA = gB;
+        PA = PB;
+        logrA = logrB;
+    }
+
+    if(abs(winding)>PI)
+    {
+        // inside the foil
+        FragmentColor = vec4(0.1f, 0.1f, 0.1f, 1.0f);
+        return;
+    }
+
+    float q2 = dot(V,V);
+    float value = (FieldType==0) ? 1.0f-q2 : sqrt(q2);
+
+    float tau = clamp((value-Range.x)/(Range.y-Range.x), 0.0f, 1.0f);
+    FragmentColor = vec4(glGetRed(tau), glGetGreen(tau), glGetBlue(tau), 1.0f);
+}
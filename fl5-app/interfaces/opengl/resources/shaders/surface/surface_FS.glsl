@@ -14,6 +14,8 @@ in vec3 Normal_viewSpace;
 in vec2 UV;
 in vec4 FragPosLightSpace;
 in vec4 VSColor;
+in float VSValue;
+in vec3 VSBary;
 
 uniform int HasUniColor = 0; // otherwise the attribute color will be used
 uniform vec4 UniformColor;
@@ -24,6 +26,15 @@ uniform int LightOn;
 uniform vec3 LightPosition_viewSpace;
 uniform vec3 EyePosition_viewSpace;
 uniform sampler2D TheSampler;
+uniform int HasColourRamp = 0; // if true the colour is read from the ramp at the vertex value
+uniform sampler2D ColourRamp;
+uniform int ContourMode = 0;     // 0: no contours; 1: contours over the colour map; 2: contours only
+uniform int nContours;           // the number of iso-lines evenly spaced in the value range, excluding its bounds
+uniform vec4 ContourColor;
+uniform float ContourWidth;      // in pixels
+uniform int EdgeMode = 0;        // 0: no edges; 1: triangle edges over the surface; 2: edges only
+uniform vec4 EdgeColor;
+uniform float EdgeWidth;         // in pixels
 
 uniform vec4 LightColor;
 uniform float LightAmbient, LightDiffuse, LightSpecular;
@@ -82,8 +93,43 @@ void main()
     }
 
     vec4 fragcolor;
-    if(HasUniColor==1) fragcolor = UniformColor;
-    else               fragcolor = VSColor; // incoming from the Vertex Shader
+    if(HasUniColor==1)        fragcolor = UniformColor;
+    else if(HasColourRamp==1) fragcolor = vec4(texture(ColourRamp, vec2(clamp(VSValue, 0.0, 1.0), 0.5)).rgb, 1.0);
+    else                      fragcolor = VSColor; // incoming from the Vertex Shader
+
+    if(ContourMode>0)
+    {
+        // iso-lines where the value crosses one of the contour levels, with a constant width on screen
+        float f = clamp(VSValue, 0.0, 1.0) * float(nContours+1);
+        float dist = abs(fract(f+0.5)-0.5) / max(fwidth(f), 1.e-6);
+        bool bOnLine = f>0.5 && f<float(nContours)+0.5 && dist<0.5*ContourWidth;
+        if(bOnLine)
+        {
+            fragColor = ContourColor;
+            return;
+        }
+        else if(ContourMode==2)
+        {
+            discard;
+            return;
+        }
+    }
+
+    if(EdgeMode>0)
+    {
+        // distance in pixels to the nearest edge of the triangle
+        vec3 d = VSBary / max(fwidth(VSBary), vec3(1.e-6));
+        if(min(min(d.x, d.y), d.z)<0.5*EdgeWidth)
+        {
+            fragColor = EdgeColor;
+            return;
+        }
+        else if(EdgeMode==2)
+        {
+            discard;
+            return;
+        }
+    }
 
 
     if(LightOn==1)
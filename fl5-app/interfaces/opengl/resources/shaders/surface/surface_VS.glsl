@@ -13,6 +13,7 @@ in vec4 vertexPosition_modelSpace;
 in vec3 vertexNormal_modelSpace;
 in vec2 vertexUV;
 in vec4 vertexColor;
+in float vertexValue; // the normalized scalar value, used if the colour ramp is enabled
 
 in vec3  vertexOffset; // used if instanced
 
@@ -28,6 +29,8 @@ out vec3 Normal_viewSpace;
 out vec2 UV;
 out vec4 FragPosLightSpace;
 out vec4 VSColor;
+out float VSValue;
+out vec3 VSBary;   // the barycentric coordinates in the triangle, for the wireframe of the non-indexed triangle arrays
 
 void main()
 {
@@ -55,6 +58,10 @@ void main()
 
     // the vertex color, optional
     VSColor = vertexColor;
+    VSValue = vertexValue;
+
+    int iv = gl_VertexID % 3;
+    VSBary = vec3(float(iv==0), float(iv==1), float(iv==2));
 
     // in case there is a texture
     UV = vertexUV;
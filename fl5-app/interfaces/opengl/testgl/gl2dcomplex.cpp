@@ -125,7 +125,7 @@ void gl2dComplex::initializeGL()
 {
     QString strange, vsrc, fsrc;
     vsrc = ":/shaders/shaders2d/fractal_VS.glsl";
-    m_shadComplex.addShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
+    m_shadComplex.addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
     if(m_shadComplex.log().length())
     {
         strange = QString::asprintf("%s", QString("Frac. vertex shader log:"+m_shadComplex.log()).toStdString().c_str());
@@ -133,7 +133,7 @@ void gl2dComplex::initializeGL()
     }
 
     fsrc = ":/shaders/shaders2d/complex_FS.glsl";
-    m_shadComplex.addShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
+    m_shadComplex.addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
     if(m_shadComplex.log().length())
     {
         strange = QString::asprintf("%s", QString("Complex fragment shader log:"+m_shadComplex.log()).toStdString().c_str());
@@ -202,7 +202,7 @@ void gl2dFractal::initializeGL()
 {
     QString strange, vsrc, fsrc;
     vsrc = ":/shaders/shaders2d/fractal_VS.glsl";
-    m_shadFrac.addShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
+    m_shadFrac.addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
     if(m_shadFrac.log().length())
     {
         strange = QString::asprintf("%s", QString("Frac vertex shader log:"+m_shadFrac.log()).toStdString().c_str());
@@ -210,7 +210,7 @@ void gl2dFractal::initializeGL()
     }
 
     fsrc = ":/shaders/shaders2d/julia_FS.glsl";
-    m_shadFrac.addShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
+    m_shadFrac.addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
     if(m_shadFrac.log().length())
     {
         strange = QString::asprintf("%s", QString("Frac fragment shader log:"+m_shadFrac.log()).toStdString().c_str());
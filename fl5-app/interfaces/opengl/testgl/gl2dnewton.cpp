@@ -186,7 +186,7 @@ void gl2dNewton::initializeGL()
 
     QString strange, vsrc, gsrc, fsrc;
     vsrc = ":/shaders/shaders2d/fractal_VS.glsl";
-    m_shadNewton.addShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
+    m_shadNewton.addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
     if(m_shadNewton.log().length())
     {
         strange = QString::asprintf("%s", QString("Newton vertex shader log:"+m_shadNewton.log()).toStdString().c_str());
@@ -194,7 +194,7 @@ void gl2dNewton::initializeGL()
     }
 
     fsrc = ":/shaders/shaders2d/newton_FS.glsl";
-    m_shadNewton.addShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
+    m_shadNewton.addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
     if(m_shadNewton.log().length())
     {
         strange = QString::asprintf("%s", QString("Newton fragment shader log:"+m_shadNewton.log()).toStdString().c_str());
@@ -258,7 +258,7 @@ void gl2dQuat::initializeGL()
 {
     QString strange, vsrc, fsrc;
     vsrc = ":/shaders/shaders2d/fractal_VS.glsl";
-    m_shadQuat.addShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
+    m_shadQuat.addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
     if(m_shadQuat.log().length())
     {
         strange = QString::asprintf("%s", QString("Frac. vertex shader log:"+m_shadQuat.log()).toStdString().c_str());
@@ -266,7 +266,7 @@ void gl2dQuat::initializeGL()
     }
 
     fsrc = ":/shaders/shaders2d/quat_FS.glsl";
-    m_shadQuat.addShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
+    m_shadQuat.addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
     if(m_shadQuat.log().length())
     {
         strange = QString::asprintf("%s", QString("Quat. fragment shader log:"+m_shadQuat.log()).toStdString().c_str());
@@ -958,7 +958,7 @@ void gl2dView::initializeGL()
 
     //--------- setup the shader to paint stippled thick lines -----------
     vsrc = ":/shaders/line/line_VS.glsl";
-    m_shadLine.addShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
+    m_shadLine.addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
     if(m_shadLine.log().length())
     {
         strange = QString::asprintf("%s", QString("Line vertex shader log:"+m_shadLine.log()).toStdString().c_str());
@@ -966,7 +966,7 @@ void gl2dView::initializeGL()
     }
 
     gsrc = ":/shaders/line/line_GS.glsl";
-    m_shadLine.addShaderFromSourceFile(QOpenGLShader::Geometry, gsrc);
+    m_shadLine.addCacheableShaderFromSourceFile(QOpenGLShader::Geometry, gsrc);
     if(m_shadLine.log().length())
     {
         strange = QString::asprintf("%s", QString("Line geometry shader log:"+m_shadLine.log()).toStdString().c_str());
@@ -974,14 +974,15 @@ void gl2dView::initializeGL()
     }
 
     fsrc = ":/shaders/line/line_FS.glsl";
-    m_shadLine.addShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
+    m_shadLine.addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
     if(m_shadLine.log().length())
     {
         strange = QString::asprintf("%s", QString("Stipple fragment shader log:"+m_shadLine.log()).toStdString().c_str());
         xfl::trace(strange);
     }
 
-    m_shadLine.link();
+    if(!m_shadLine.link()) // the cacheable shaders are only compiled at link time
+        xfl::trace("Line shader link log:"+m_shadLine.log()+"\n");
     m_shadLine.bind();
     {
         m_locLine.m_attrVertex    = m_shadLine.attributeLocation("vertexPosition_modelSpace");
@@ -1001,7 +1002,7 @@ void gl2dView::initializeGL()
     m_shadLine.release();
 
     vsrc = ":/shaders/point/point_VS.glsl";
-    m_shadPoint.addShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
+    m_shadPoint.addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
     if(m_shadPoint.log().length())
     {
         strange = QString::asprintf("%s", QString("Point vertex shader log:"+m_shadPoint.log()).toStdString().c_str());
@@ -1009,7 +1010,7 @@ void gl2dView::initializeGL()
     }
 
     gsrc = ":/shaders/point/point_GS.glsl";
-    m_shadPoint.addShaderFromSourceFile(QOpenGLShader::Geometry, gsrc);
+    m_shadPoint.addCacheableShaderFromSourceFile(QOpenGLShader::Geometry, gsrc);
     if(m_shadPoint.log().length())
     {
         strange = QString::asprintf("%s", QString("Point geometry shader log:"+m_shadPoint.log()).toStdString().c_str());
@@ -1017,14 +1018,15 @@ void gl2dView::initializeGL()
     }
 
     fsrc = ":/shaders/point/point_FS.glsl";
-    m_shadPoint.addShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
+    m_shadPoint.addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
     if(m_shadPoint.log().length())
     {
         strange = QString::asprintf("%s", QString("Point fragment shader log:"+m_shadPoint.log()).toStdString().c_str());
         xfl::trace(strange);
     }
 
-    m_shadPoint.link();
+    if(!m_shadPoint.link()) // the cacheable shaders are only compiled at link time
+        xfl::trace("Point shader link log:"+m_shadPoint.log()+"\n");
     m_shadPoint.bind();
     {
         m_locPoint.m_attrVertex = m_shadPoint.attributeLocation("vertexPosition_modelSpace");
@@ -1046,7 +1048,7 @@ void gl2dView::initializeGL()
     vsrc =  ":/shaders/point2/point2_VS.glsl";
     fsrc =  ":/shaders/point2/point2_FS.glsl";
 
-    m_shadPoint2.addShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
+    m_shadPoint2.addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
     if(m_shadPoint2.log().length())
     {
         strange = QString::asprintf("%s", QString("point2 vertex shader log:"+m_shadPoint2.log()).toStdString().c_str());
@@ -1054,14 +1056,15 @@ void gl2dView::initializeGL()
     }
 
 
-    m_shadPoint2.addShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
+    m_shadPoint2.addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
     if(m_shadPoint2.log().length())
     {
         strange = QString::asprintf("%s", QString("point2 fragment shader log:"+m_shadPoint2.log()).toStdString().c_str());
         xfl::trace(strange);
     }
 
-    m_shadPoint2.link();
+    if(!m_shadPoint2.link()) // the cacheable shaders are only compiled at link time
+        xfl::trace("Point2 shader link log:"+m_shadPoint2.log()+"\n");
     m_shadPoint2.bind();
     {
         m_locPt2.m_attrVertex = m_shadPoint2.attributeLocation("vertexPosition_modelSpace");
@@ -1077,21 +1080,22 @@ void gl2dView::initializeGL()
     //setup the shader to paint coloured surfaces
     vsrc = ":/shaders/surface/surface_VS.glsl";
     fsrc = ":/shaders/surface/surface_FS.glsl";
-    m_shadSurf.addShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
+    m_shadSurf.addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
     if(m_shadSurf.log().length())
     {
         strange = QString::asprintf("%s", QString("Surface vertex shader log:"+m_shadSurf.log()).toStdString().c_str());
         xfl::trace(strange);
     }
 
-    m_shadSurf.addShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
+    m_shadSurf.addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
     if(m_shadSurf.log().length())
     {
         strange = QString::asprintf("%s", QString("Surface fragment shader log:"+m_shadSurf.log()).toStdString().c_str());
         xfl::trace(strange);
     }
 
-    m_shadSurf.link();
+    if(!m_shadSurf.link()) // the cacheable shaders are only compiled at link time
+        xfl::trace("Surf shader link log:"+m_shadSurf.log()+"\n");
     m_shadSurf.bind();
     {
         m_locSurf.m_attrVertex = m_shadSurf.attributeLocation("vertexPosition_modelSpace");
@@ -41,8 +41,10 @@
 #include <api/trace.h>
 #include <api/units.h>
 #include <core/xflcore.h>
+#include <interfaces/opengl/controls/colourlegend.h>
 #include <interfaces/opengl/controls/gllightdlg.h>
 #include <interfaces/opengl/globals/gl_globals.h>
+#include <interfaces/opengl/globals/gl_lod.h>
 #include <interfaces/opengl/views/gl3dview.h>
 #include <interfaces/widgets/customdlg/imagedlg.h>
 #include <api/node.h>
@@ -74,6 +76,8 @@ gl3dView::gl3dView(QWidget *pParent) : QOpenGLWidget(pParent)
     setFormat(s_GlSurfaceFormat);
 
     m_pglLightDlg = nullptr;
+    m_pColourRamp = nullptr;
+    m_pOffscreenFbo = nullptr;
 
     m_bZAnimate = false;
     connect(&m_IdleTimer, SIGNAL(timeout()), SLOT(onIdleAnimate()));
@@ -150,6 +154,20 @@ gl3dView::~gl3dView()
         m_pglLightDlg->close();
         delete m_pglLightDlg;
     }
+
+    if(m_pColourRamp)
+    {
+        makeCurrent();
+        delete m_pColourRamp;
+        doneCurrent();
+    }
+
+    if(m_pOffscreenFbo)
+    {
+        makeCurrent();
+        delete m_pOffscreenFbo;
+        doneCurrent();
+    }
 }
 
 
@@ -221,7 +239,7 @@ void gl3dView::initializeGL()
 
     //--------- setup the shader to paint stippled thick lines -----------
     vsrc = ":/shaders/line/line_VS.glsl";
-    m_shadLine.addShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
+    m_shadLine.addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
     if(m_shadLine.log().length())
     {
         strange = QString::asprintf("%s", QString("Line vertex shader log:"+m_shadLine.log()).toStdString().c_str());
@@ -229,7 +247,7 @@ void gl3dView::initializeGL()
     }
 
     gsrc = ":/shaders/line/line_GS.glsl";
-    m_shadLine.addShaderFromSourceFile(QOpenGLShader::Geometry, gsrc);
+    m_shadLine.addCacheableShaderFromSourceFile(QOpenGLShader::Geometry, gsrc);
     if(m_shadLine.log().length())
     {
         strange = QString::asprintf("%s", QString("Line geometry shader log:"+m_shadLine.log()).toStdString().c_str());
@@ -237,14 +255,15 @@ void gl3dView::initializeGL()
     }
 
     fsrc = ":/shaders/line/line_FS.glsl";
-    m_shadLine.addShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
+    m_shadLine.addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
     if(m_shadLine.log().length())
     {
         strange = QString::asprintf("%s", QString("Line fragment shader log:"+m_shadLine.log()).toStdString().c_str());
         xfl::trace(strange);
     }
 
-    m_shadLine.link();
+    if(!m_shadLine.link()) // the cacheable shaders are only compiled at link time
+        xfl::trace("Line shader link log:"+m_shadLine.log()+"\n");
     m_shadLine.bind();
     {
         m_locLine.m_attrVertex   = m_shadLine.attributeLocation("vertexPosition_modelSpace");
@@ -258,6 +277,9 @@ void gl3dView::initializeGL()
         m_locLine.m_Viewport     = m_shadLine.uniformLocation("Viewport");
         m_locLine.m_Pattern      = m_shadLine.uniformLocation("pattern");
         m_locLine.m_nPatterns    = m_shadLine.uniformLocation("nPatterns");
+        m_locLine.m_attrOffset   = m_shadLine.attributeLocation("instanceOrigin");
+        m_locLine.m_attrVector   = m_shadLine.attributeLocation("instanceVector");
+        m_locLine.m_IsInstanced  = m_shadLine.uniformLocation("Instanced");
         GLint nPatterns = 300; // number of patterns per unit projected length (viewport half width = 1)
         m_shadLine.setUniformValue(m_locLine.m_nPatterns, nPatterns);
     }
@@ -266,21 +288,22 @@ void gl3dView::initializeGL()
     //setup the shader to paint coloured surfaces
     vsrc = ":/shaders/surface/surface_VS.glsl";
     fsrc = ":/shaders/surface/surface_FS.glsl";
-    m_shadSurf.addShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
+    m_shadSurf.addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
     if(m_shadSurf.log().length())
     {
         strange = QString::asprintf("%s", QString("Surface vertex shader log:"+m_shadSurf.log()).toStdString().c_str());
         xfl::trace(strange);
     }
 
-    m_shadSurf.addShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
+    m_shadSurf.addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
     if(m_shadSurf.log().length())
     {
         strange = QString::asprintf("%s", QString("Surface fragment shader log:"+m_shadSurf.log()).toStdString().c_str());
         xfl::trace(strange);
     }
 
-    m_shadSurf.link();
+    if(!m_shadSurf.link()) // the cacheable shaders are only compiled at link time
+        xfl::trace("Surf shader link log:"+m_shadSurf.log()+"\n");
     m_shadSurf.bind();
     {
         m_locSurf.m_attrVertex = m_shadSurf.attributeLocation("vertexPosition_modelSpace");
@@ -288,6 +311,7 @@ void gl3dView::initializeGL()
         m_locSurf.m_attrUV     = m_shadSurf.attributeLocation("vertexUV");
         m_locSurf.m_attrColor  = m_shadSurf.attributeLocation("vertexColor");
         m_locSurf.m_attrOffset = m_shadSurf.attributeLocation("vertexOffset");
+        m_locSurf.m_attrValue  = m_shadSurf.attributeLocation("vertexValue");
 
         m_locSurf.m_ClipPlane    = m_shadSurf.uniformLocation("clipPlane0");
         m_locSurf.m_pvmMatrix    = m_shadSurf.uniformLocation("pvmMatrix");
@@ -300,6 +324,15 @@ void gl3dView::initializeGL()
         m_locSurf.m_TexSampler   = m_shadSurf.uniformLocation("TheSampler");
         m_locSurf.m_IsInstanced  = m_shadSurf.uniformLocation("Instanced");
         m_locSurf.m_Scale      = m_shadSurf.uniformLocation("uScale");
+        m_locSurf.m_HasColourRamp = m_shadSurf.uniformLocation("HasColourRamp");
+        m_locSurf.m_ColourRamp    = m_shadSurf.uniformLocation("ColourRamp");
+        m_locSurf.m_ContourMode   = m_shadSurf.uniformLocation("ContourMode");
+        m_locSurf.m_nContours     = m_shadSurf.uniformLocation("nContours");
+        m_locSurf.m_ContourColor  = m_shadSurf.uniformLocation("ContourColor");
+        m_locSurf.m_ContourWidth  = m_shadSurf.uniformLocation("ContourWidth");
+        m_locSurf.m_EdgeMode      = m_shadSurf.uniformLocation("EdgeMode");
+        m_locSurf.m_EdgeColor     = m_shadSurf.uniformLocation("EdgeColor");
+        m_locSurf.m_EdgeWidth     = m_shadSurf.uniformLocation("EdgeWidth");
 
         m_uHasShadow             = m_shadSurf.uniformLocation("HasShadow");
         m_uShadowLightViewMatrix = m_shadSurf.uniformLocation("LightViewMatrix");
@@ -309,7 +342,7 @@ void gl3dView::initializeGL()
     //--------- setup the shader to paint stippled large points -----------
 
     vsrc = ":/shaders/point/point_VS.glsl";
-    m_shadPoint.addShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
+    m_shadPoint.addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
     if(m_shadPoint.log().length())
     {
         strange = QString::asprintf("%s", QString("Point vertex shader log:"+m_shadPoint.log()).toStdString().c_str());
@@ -317,7 +350,7 @@ void gl3dView::initializeGL()
     }
 
     gsrc = ":/shaders/point/point_GS.glsl";
-    m_shadPoint.addShaderFromSourceFile(QOpenGLShader::Geometry, gsrc);
+    m_shadPoint.addCacheableShaderFromSourceFile(QOpenGLShader::Geometry, gsrc);
     if(m_shadPoint.log().length())
     {
         strange = QString::asprintf("%s", QString("Point geometry shader log:"+m_shadPoint.log()).toStdString().c_str());
@@ -325,14 +358,15 @@ void gl3dView::initializeGL()
     }
 
     fsrc = ":/shaders/point/point_FS.glsl";
-    m_shadPoint.addShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
+    m_shadPoint.addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
     if(m_shadPoint.log().length())
     {
         strange = QString::asprintf("%s", QString("Point fragment shader log:"+m_shadPoint.log()).toStdString().c_str());
         xfl::trace(strange);
     }
 
-    m_shadPoint.link();
+    if(!m_shadPoint.link()) // the cacheable shaders are only compiled at link time
+        xfl::trace("Point shader link log:"+m_shadPoint.log()+"\n");
     m_shadPoint.bind();
     {
         m_locPoint.m_attrVertex = m_shadPoint.attributeLocation("vertexPosition_modelSpace");
@@ -354,7 +388,7 @@ void gl3dView::initializeGL()
     vsrc = ":/shaders/point2/point2_VS.glsl";
     fsrc = ":/shaders/point2/point2_FS.glsl";
 
-    m_shadPoint2.addShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
+    m_shadPoint2.addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
     if(m_shadPoint2.log().length())
     {
         strange = QString::asprintf("%s", QString("point2 vertex shader log:"+m_shadPoint2.log()).toStdString().c_str());
@@ -362,14 +396,15 @@ void gl3dView::initializeGL()
     }
 
 
-    m_shadPoint2.addShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
+    m_shadPoint2.addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
     if(m_shadPoint2.log().length())
     {
         strange = QString::asprintf("%s", QString("point2 fragment shader log:"+m_shadPoint2.log()).toStdString().c_str());
         xfl::trace(strange);
     }
 
-    m_shadPoint2.link();
+    if(!m_shadPoint2.link()) // the cacheable shaders are only compiled at link time
+        xfl::trace("Point2 shader link log:"+m_shadPoint2.log()+"\n");
     m_shadPoint2.bind();
     {
         m_locPt2.m_attrVertex  = m_shadPoint2.attributeLocation("vertexPosition_modelSpace");
@@ -386,21 +421,22 @@ void gl3dView::initializeGL()
     //setup the depth shader
     vsrc = ":/shaders/shadow/depth_VS.glsl";
     fsrc = ":/shaders/shadow/depth_FS.glsl";
-    m_shadDepth.addShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
+    m_shadDepth.addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
     if(m_shadDepth.log().length())
     {
         QString strange = QString::asprintf("%s", QString("Depth vertex shader log:"+m_shadDepth.log()).toStdString().c_str());
         xfl::trace(strange);
     }
 
-    m_shadDepth.addShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
+    m_shadDepth.addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
     if(m_shadDepth.log().length())
     {
         QString strange = QString::asprintf("%s", QString("Depth fragment shader log:"+m_shadDepth.log()).toStdString().c_str());
         xfl::trace(strange);
     }
 
-    m_shadDepth.link();
+    if(!m_shadDepth.link()) // the cacheable shaders are only compiled at link time
+        xfl::trace("Depth shader link log:"+m_shadDepth.log()+"\n");
     m_shadDepth.bind();
     {
         m_attrDepthPos = m_shadDepth.attributeLocation("vertexPosition_modelSpace");
@@ -1322,8 +1358,8 @@ void gl3dView::paintGl3()
 
     float s = 1.0;
 
-    int width  = geometry().width();
-    int height = geometry().height();
+    int width  = m_OffscreenSize.isValid() ? m_OffscreenSize.width()  : geometry().width();
+    int height = m_OffscreenSize.isValid() ? m_OffscreenSize.height() : geometry().height();
 
     // Enable blending
     glEnable(GL_BLEND);
@@ -2049,6 +2085,63 @@ void gl3dView::paintColorSegments(QOpenGLBuffer &vbo, float width, Line::enumLin
 }
 
 
+/**
+ * Paints one unit arrow per instance with a single draw call.
+ * The instance buffer holds 9 floats per arrow: the origin, the vector from the origin to the tip,
+ * and the colour.
+ */
+void gl3dView::paintArrowInstances(QOpenGLBuffer &vboInstances, float width, Line::enumLineStipple stipple)
+{
+    int stride = 9;
+    QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
+
+    m_shadLine.bind();
+    {
+        m_shadLine.setUniformValue(m_locLine.m_HasUniColor, 0);
+        m_shadLine.setUniformValue(m_locLine.m_Thickness, width);
+        m_shadLine.setUniformValue(m_locLine.m_Pattern, gl::stipple(stipple));
+        m_shadLine.setUniformValue(m_locLine.m_IsInstanced, 1);
+
+        m_vboThinArrow.bind();
+        m_shadLine.enableAttributeArray(m_locLine.m_attrVertex);
+        m_shadLine.setAttributeBuffer(m_locLine.m_attrVertex, GL_FLOAT, 0, 3, 3 * sizeof(GLfloat));
+        int nPoints = m_vboThinArrow.size()/3/int(sizeof(float));
+        m_vboThinArrow.release();
+
+        vboInstances.bind();
+        {
+            int nArrows = vboInstances.size()/stride/int(sizeof(float));
+
+            m_shadLine.enableAttributeArray(m_locLine.m_attrOffset);
+            m_shadLine.enableAttributeArray(m_locLine.m_attrVector);
+            m_shadLine.enableAttributeArray(m_locLine.m_attrColor);
+            m_shadLine.setAttributeBuffer(m_locLine.m_attrOffset, GL_FLOAT, 0,                  3, stride * sizeof(GLfloat));
+            m_shadLine.setAttributeBuffer(m_locLine.m_attrVector, GL_FLOAT, 3* sizeof(GLfloat), 3, stride * sizeof(GLfloat));
+            m_shadLine.setAttributeBuffer(m_locLine.m_attrColor,  GL_FLOAT, 6* sizeof(GLfloat), 3, stride * sizeof(GLfloat));
+            glVertexAttribDivisor(m_locLine.m_attrOffset, 1);
+            glVertexAttribDivisor(m_locLine.m_attrVector, 1);
+            glVertexAttribDivisor(m_locLine.m_attrColor,  1);
+
+            glDrawArraysInstanced(GL_LINES, 0, nPoints, nArrows);
+
+            glVertexAttribDivisor(m_locLine.m_attrOffset, 0);
+            glVertexAttribDivisor(m_locLine.m_attrVector, 0);
+            glVertexAttribDivisor(m_locLine.m_attrColor,  0);
+            m_shadLine.disableAttributeArray(m_locLine.m_attrOffset);
+            m_shadLine.disableAttributeArray(m_locLine.m_attrVector);
+            m_shadLine.disableAttributeArray(m_locLine.m_attrColor);
+        }
+        vboInstances.release();
+        m_shadLine.disableAttributeArray(m_locLine.m_attrVertex);
+
+        // leave things as they were
+        m_shadLine.setUniformValue(m_locLine.m_IsInstanced, 0);
+        m_shadLine.setUniformValue(m_locLine.m_HasUniColor, 1);
+    }
+    m_shadLine.release();
+}
+
+
 void gl3dView::paintColourSegments8(QOpenGLBuffer &vbo, LineStyle const &ls)
 {
     paintColourSegments8(vbo, float(ls.m_Width), ls.m_Stipple);
@@ -2341,6 +2434,96 @@ void gl3dView::paintColourMap(QOpenGLBuffer &vbo, QMatrix4x4 const& m_ModelMatri
 }
 
 
+/** Makes the 1D texture of the legend's colours; only uploaded again if the colours have changed */
+void gl3dView::glMakeColourRamp()
+{
+    int const nSamples = 256;
+    QImage ramp(nSamples, 1, QImage::Format_RGB32);
+    for(int i=0; i<nSamples; i++)
+        ramp.setPixel(i, 0, ColourLegend::colour(float(i)/float(nSamples-1)).rgb());
+
+    if(m_pColourRamp && ramp==m_ColourRampImg) return;
+
+    delete m_pColourRamp;
+    m_ColourRampImg = ramp;
+    m_pColourRamp = new QOpenGLTexture(m_ColourRampImg, QOpenGLTexture::DontGenerateMipMaps);
+    m_pColourRamp->setMinMagFilters(QOpenGLTexture::Linear, QOpenGLTexture::Linear);
+    m_pColourRamp->setWrapMode(QOpenGLTexture::ClampToEdge);
+}
+
+
+/**
+ * Paints a colour map from a position buffer and a buffer of normalized values;
+ * the colours are read from the legend's colour ramp in the fragment shader.
+ * The contour lines are extracted per fragment at the levels defined in W3dPrefs, so that
+ * they cost nothing on the CPU and follow the changes of the number of contours at the next frame.
+ * @param bMap if true, the colour map is painted
+ * @param bContours if true, the contour lines are painted
+ */
+void gl3dView::paintColourMap(QOpenGLBuffer &vboGeom, QOpenGLBuffer &vboValues, QMatrix4x4 const& m_ModelMatrix, bool bMap, bool bContours)
+{
+    if(!bMap && !bContours) return;
+    if(!vboGeom.isCreated() || !vboValues.isCreated()) return;
+    // the buffers are only consistent if they hold one value for each vertex
+    int nVertices = vboGeom.size()/3/int(sizeof(float));
+    if(vboValues.size()/int(sizeof(float))!=nVertices) return;
+
+    glMakeColourRamp();
+
+    QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
+
+    m_shadSurf.bind();
+    {
+        m_shadSurf.setUniformValue(m_locSurf.m_vmMatrix,  m_matView*m_ModelMatrix);
+        m_shadSurf.setUniformValue(m_locSurf.m_pvmMatrix, m_matProj*m_matView*m_ModelMatrix);
+        m_shadSurf.setUniformValue(m_locSurf.m_HasUniColor, 0);
+        m_shadSurf.setUniformValue(m_locSurf.m_Light, 0);
+        m_shadSurf.setUniformValue(m_locSurf.m_HasColourRamp, 1);
+        m_shadSurf.setUniformValue(m_locSurf.m_ColourRamp, 1); // texture unit 1, the unit 0 is used by the shadow map
+
+        if(bContours)
+        {
+            m_shadSurf.setUniformValue(m_locSurf.m_ContourMode, bMap ? 1 : 2);
+            m_shadSurf.setUniformValue(m_locSurf.m_nContours, W3dPrefs::s_NContourLines);
+            m_shadSurf.setUniformValue(m_locSurf.m_ContourColor, xfl::fromfl5Clr(W3dPrefs::s_ContourLineStyle.m_Color));
+            m_shadSurf.setUniformValue(m_locSurf.m_ContourWidth, float(W3dPrefs::s_ContourLineStyle.m_Width));
+        }
+
+        m_pColourRamp->bind(1);
+
+        m_shadSurf.enableAttributeArray(m_locSurf.m_attrVertex);
+        m_shadSurf.enableAttributeArray(m_locSurf.m_attrValue);
+
+        vboGeom.bind();
+        m_shadSurf.setAttributeBuffer(m_locSurf.m_attrVertex, GL_FLOAT, 0, 3, 3 * sizeof(GLfloat));
+        vboGeom.release();
+
+        vboValues.bind();
+        m_shadSurf.setAttributeBuffer(m_locSurf.m_attrValue, GL_FLOAT, 0, 1, sizeof(GLfloat));
+        vboValues.release();
+
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(DEPTHFACTOR, DEPTHUNITS);
+
+        glDisable(GL_CULL_FACE); // most colour maps can be viewed from both sides
+        glDrawArrays(GL_TRIANGLES, 0, nVertices);
+
+        glDisable(GL_POLYGON_OFFSET_FILL);
+
+        m_shadSurf.disableAttributeArray(m_locSurf.m_attrValue);
+        m_shadSurf.disableAttributeArray(m_locSurf.m_attrVertex);
+
+        m_pColourRamp->release(1);
+        m_shadSurf.setUniformValue(m_locSurf.m_HasColourRamp, 0);
+        m_shadSurf.setUniformValue(m_locSurf.m_ContourMode, 0);
+    }
+    m_shadSurf.release();
+
+    glEnable(GL_CULL_FACE);
+}
+
+
 void gl3dView::paintThinArrow(Vector3d const &origin, const Vector3d& arrow, LineStyle const &ls, QMatrix4x4 const ModelMatrix)
 {
     paintThinArrow(origin, arrow, xfl::fromfl5Clr(ls.m_Color), float(ls.m_Width), ls.m_Stipple, ModelMatrix);
@@ -2459,6 +2642,117 @@ void gl3dView::paintTriangles3Vtx(QOpenGLBuffer &vbo, const QColor &backclr, boo
 }
 
 
+/**
+ * Draws the triangulation stored in a glLodMesh.
+ * The chunks outside the view frustum are skipped, and each visible chunk is drawn at the coarsest
+ * level whose clustering size is less than glLodMesh::pixelTolerance() on screen.
+ * The edges are drawn by the fragment shader from the barycentric coordinates, so the full resolution
+ * level is always used when they are requested.
+ */
+void gl3dView::paintLodMesh(glLodMesh &lod, QColor const &backclr, bool bSurface, bool bEdges, LineStyle const &edgestyle, bool bLight)
+{
+    if(lod.isEmpty() || (!bSurface && !bEdges)) return;
+
+    QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
+
+    QMatrix4x4 vmMat(m_matView*m_matModel);
+    QMatrix4x4 pvmMat(m_matProj*vmMat);
+    float modelscale = vmMat.mapVector(QVector3D(1.0f,0.0f,0.0f)).length();
+    double halfwidth = m_OffscreenSize.isValid() ? double(m_OffscreenSize.width())/2.0 : double(width())*devicePixelRatioF()/2.0;
+
+    int stride = 6;
+
+    m_shadSurf.bind();
+    {
+        m_shadSurf.setUniformValue(m_locSurf.m_UniColor, backclr);
+        m_shadSurf.setUniformValue(m_locSurf.m_Light, bLight ? 1 : 0);
+        m_shadSurf.setUniformValue(m_locSurf.m_HasUniColor, 1);
+
+        if(bEdges)
+        {
+            m_shadSurf.setUniformValue(m_locSurf.m_EdgeMode,  bSurface ? 1 : 2);
+            m_shadSurf.setUniformValue(m_locSurf.m_EdgeColor, xfl::fromfl5Clr(edgestyle.m_Color));
+            m_shadSurf.setUniformValue(m_locSurf.m_EdgeWidth, float(edgestyle.m_Width)*float(devicePixelRatioF()));
+        }
+
+        if(bSurface)
+        {
+            m_shadSurf.setUniformValue(m_locSurf.m_TwoSided, 0);
+            glEnable(GL_CULL_FACE);
+        }
+        else
+        {
+            // the edges on the back side are visible through the discarded fragments
+            m_shadSurf.setUniformValue(m_locSurf.m_TwoSided, 1);
+            glDisable(GL_CULL_FACE);
+        }
+
+        m_shadSurf.enableAttributeArray(m_locSurf.m_attrVertex);
+        m_shadSurf.enableAttributeArray(m_locSurf.m_attrNormal);
+
+        lod.vbo().bind();
+        {
+            m_shadSurf.setAttributeBuffer(m_locSurf.m_attrVertex, GL_FLOAT, 0,                 3, stride*sizeof(GLfloat));
+            m_shadSurf.setAttributeBuffer(m_locSurf.m_attrNormal, GL_FLOAT, 3*sizeof(GLfloat), 3, stride*sizeof(GLfloat));
+            glEnable(GL_POLYGON_OFFSET_FILL);
+            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+            glPolygonOffset(DEPTHFACTOR, DEPTHUNITS);
+
+            for(int ic=0; ic<lod.nChunks(); ic++)
+            {
+                glLodMesh::Chunk const &ch = lod.chunk(ic);
+
+                // frustum culling: the chunk is hidden if all the corners of its box are outside the same clip plane
+                int outside[6] = {0,0,0,0,0,0};
+                for(int ib=0; ib<8; ib++)
+                {
+                    QVector4D corner(float((ib&1) ? ch.m_Max.x : ch.m_Min.x),
+                                     float((ib&2) ? ch.m_Max.y : ch.m_Min.y),
+                                     float((ib&4) ? ch.m_Max.z : ch.m_Min.z), 1.0f);
+                    QVector4D clip = pvmMat*corner;
+                    if(clip.x()<-clip.w()) outside[0]++;
+                    if(clip.x()> clip.w()) outside[1]++;
+                    if(clip.y()<-clip.w()) outside[2]++;
+                    if(clip.y()> clip.w()) outside[3]++;
+                    if(clip.z()<-clip.w()) outside[4]++;
+                    if(clip.z()> clip.w()) outside[5]++;
+                }
+                if(*std::max_element(outside, outside+6)==8) continue;
+
+                int level = 0;
+                if(!bEdges)
+                {
+                    // the screen size in pixels of a unit length at the chunk's centre
+                    Vector3d C = (ch.m_Min+ch.m_Max)/2.0;
+                    QVector3D vc = vmMat.map(QVector3D(C.xf(), C.yf(), C.zf()));
+                    QVector4D a = m_matProj*QVector4D(vc, 1.0f);
+                    QVector4D b = m_matProj*QVector4D(vc+QVector3D(1.0f,0.0f,0.0f), 1.0f);
+                    if(fabs(a.w())>0.0f && fabs(b.w())>0.0f)
+                    {
+                        double pixels = double(fabs(b.x()/b.w()-a.x()/a.w())) * halfwidth * double(modelscale);
+                        while(level+1<lod.nLevels() && lod.cellSize(level+1)*pixels<glLodMesh::pixelTolerance()
+                              && ch.m_Count.at(level+1)>0)
+                            level++;
+                    }
+                }
+
+                if(ch.m_Count.at(level)>0)
+                    glDrawArrays(GL_TRIANGLES, ch.m_First.at(level), ch.m_Count.at(level));
+            }
+        }
+        lod.vbo().release();
+        glDisable(GL_POLYGON_OFFSET_FILL);
+
+        m_shadSurf.disableAttributeArray(m_locSurf.m_attrVertex);
+        m_shadSurf.disableAttributeArray(m_locSurf.m_attrNormal);
+        m_shadSurf.setUniformValue(m_locSurf.m_EdgeMode, 0); // leave things as they were
+        m_shadSurf.setUniformValue(m_locSurf.m_TwoSided, 0);
+        glEnable(GL_CULL_FACE);
+    }
+    m_shadSurf.release();
+}
+
+
 void gl3dView::paintSphere(Vector3d const &place, float radius, QColor const &sphereColor, bool bLight)
 {
     paintSphere(place.xf(), place.yf(), place.zf(), radius, sphereColor, bLight);
@@ -2576,6 +2870,29 @@ void gl3dView::paintSphereInstances(QOpenGLBuffer &vboPosInstances, float radius
 }
 
 
+/** Paints one sphere at each of the positions with a single draw call */
+void gl3dView::paintSphereInstances(std::vector<Vector3d> const &positions, float radius, QColor const &clr, bool bTwoSided, bool bLight)
+{
+    if(positions.empty()) return;
+
+    QVector<float> pts(int(positions.size())*3);
+    int iv = 0;
+    for(Vector3d const &pos : positions)
+    {
+        pts[iv++] = pos.xf();
+        pts[iv++] = pos.yf();
+        pts[iv++] = pos.zf();
+    }
+
+    if(!m_vboInstances.isCreated()) m_vboInstances.create();
+    m_vboInstances.bind();
+    m_vboInstances.allocate(pts.data(), pts.size() * int(sizeof(GLfloat)));
+    m_vboInstances.release();
+
+    paintSphereInstances(m_vboInstances, radius, clr, bTwoSided, bLight);
+}
+
+
 void gl3dView::onZAnimate(bool bZAnimate)
 {
     m_bZAnimate = bZAnimate;
@@ -3984,43 +4301,64 @@ void gl3dView::onSaveImage()
 //    QImage m_Img = grabFramebuffer();
 //    m_Img.save(FileName);
 
-    QOpenGLFramebufferObjectFormat fboFormat;
-//        fboFormat.setInternalTextureFormat(GL_RGBA);
-    fboFormat.setAttachment(QOpenGLFramebufferObject::Depth);
+    QImage img = renderToImage(QSize(1920, 1080));
+    if(!img.isNull()) img.save(FileName, "PNG");
+}
 
-    QSize m_OffSize = QSize(1920, 1080);
 
-    QOpenGLFramebufferObject *m_pfboOff = new QOpenGLFramebufferObject(m_OffSize, fboFormat);
+/**
+ * Renders the view in an off-screen frame buffer of the requested size and returns the image.
+ * The widget does not need to be visible, only to have a valid OpenGL context, so that this
+ * can be used in batch mode with the offscreen or eglfs platform plugins.
+ * The frame buffer is kept for the next call, so that a series of images of the same size
+ * does not reallocate it. The overlay text is not rendered.
+ */
+QImage gl3dView::renderToImage(QSize const &size)
+{
+    if(!size.isValid() || size.isEmpty()) return QImage();
 
-    m_pfboOff->bind();
+    makeCurrent();
+    if(!context())
     {
-        qDebug()<<"fbo3d:"<<m_pfboOff->isValid()<<m_pfboOff->isBound();
-
-        // Enable blending
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glEnable(GL_DEPTH_TEST);
-
-        // Enable face culling
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-//        glViewport(0,0,m_OffSize.width()*devicePixelRatio(), m_OffSize.height()*devicePixelRatio());
-
-
-        glRenderView();
+        doneCurrent();
+        return QImage();
+    }
 
-        QOpenGLContext::currentContext()->functions()->glFlush();
+    if(!m_pOffscreenFbo || m_pOffscreenFbo->size()!=size)
+    {
+        delete m_pOffscreenFbo;
+        QOpenGLFramebufferObjectFormat fboFormat;
+        fboFormat.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+        fboFormat.setSamples(W3dPrefs::s_bMultiSample ? 4 : 0);
+        m_pOffscreenFbo = new QOpenGLFramebufferObject(size, fboFormat);
+    }
 
-        QImage fb = m_pfboOff->toImage();//.convertToFormat(QImage::Format_RGB32);
-        fb.save(FileName, "PNG");
+    QRectF viewrect = m_GLViewRect;
+    double w = double(size.width());
+    double h = double(size.height());
+    if(w>h) m_GLViewRect.setRect(-1.0, h/w, 1.0, -h/w);
+    else    m_GLViewRect.setRect(-w/h, 1.0, w/h, -1.0);
+    m_OffscreenSize = size;
 
+    QImage img;
+    if(m_pOffscreenFbo->bind())
+    {
+        glViewport(0, 0, size.width(), size.height());
+        glMake3dObjects();
+        paintGl3();
+        glFlush();
+        img = m_pOffscreenFbo->toImage(); // resolves the multisampled buffer
+        m_pOffscreenFbo->release();
     }
-    m_pfboOff->release();
 
-    delete m_pfboOff;
+    // leave things as they were
+    m_OffscreenSize = QSize();
+    m_GLViewRect = viewrect;
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+    glViewport(0, 0, int(width()*devicePixelRatioF()), int(height()*devicePixelRatioF()));
+    doneCurrent();
 
-//    makeCurrent();
+    return img;
 }
 
 
@@ -26,6 +26,7 @@
 #pragma once
 
 #include <QElapsedTimer>
+#include <QImage>
 #include <QOpenGLBuffer>
 #include <QOpenGLDebugLogger>
 #include <QOpenGLFunctions>
@@ -57,6 +58,8 @@
 
 
 class GLLightDlg;
+class QOpenGLFramebufferObject;
+class glLodMesh;
 
 class gl3dView : public QOpenGLWidget, protected QOpenGLExtraFunctions
 {
@@ -94,6 +97,8 @@ class gl3dView : public QOpenGLWidget, protected QOpenGLExtraFunctions
         ArcBall &arcBall() {return m_ArcBall;}
         void hideArcball() {m_bArcball=false; update();}
 
+        QImage renderToImage(QSize const &size);
+
         bool bZAnimation() {return m_bZAnimate;}
         void setZAnimation(bool bZAnimate) {m_bZAnimate=bZAnimate;}
 
@@ -217,6 +222,7 @@ class gl3dView : public QOpenGLWidget, protected QOpenGLExtraFunctions
         void glMakeIcosahedron();
         void glMakeIcoSphere(int nSplits=2);
         void glMakeUnitArrow();
+        void glMakeColourRamp();
         void glMakeCone(float h, float r, int nz, int nh);
 
         void getGLError();
@@ -243,6 +249,7 @@ class gl3dView : public QOpenGLWidget, protected QOpenGLExtraFunctions
         void paintSphere(float xs, float ys, float zs, float radius, const QColor &color, bool bLight=true);
         void paintSphere(const Vector3d &place, float radius, const QColor &sphereColor, bool bLight=true);
         void paintSphereInstances(QOpenGLBuffer &vboPosInstances, float radius, QColor const &clr, bool bTwoSided, bool bLight);
+        void paintSphereInstances(std::vector<Vector3d> const &positions, float radius, QColor const &clr, bool bTwoSided, bool bLight);
 
         void paintIcosahedron(const Vector3d &place, float radius, const QColor &color, LineStyle const &ls, bool bOutline, bool bLight);
 
@@ -251,6 +258,7 @@ class gl3dView : public QOpenGLWidget, protected QOpenGLExtraFunctions
         void paintLineStrip(QOpenGLBuffer &vbo, LineStyle const &ls);
         void paintLineStrip(QOpenGLBuffer &vbo, const QColor &clr, float width, Line::enumLineStipple stipple=Line::SOLID);
         void paintColorSegments(QOpenGLBuffer &vbo, float width, Line::enumLineStipple stipple=Line::SOLID);
+        void paintArrowInstances(QOpenGLBuffer &vboInstances, float width, Line::enumLineStipple stipple=Line::SOLID);
         void paintColourSegments8(QOpenGLBuffer &vbo, LineStyle const &ls);
         void paintColourSegments8(QOpenGLBuffer &vbo, float width, Line::enumLineStipple stipple);
 
@@ -262,6 +270,7 @@ class gl3dView : public QOpenGLWidget, protected QOpenGLExtraFunctions
         void paintThinArrow(Vector3d const &origin, const Vector3d& arrow, const QColor &clr, float w, Line::enumLineStipple stipple,   QMatrix4x4 const ModelMatrix=QMatrix4x4());
         void paintTriangles3Vtx(QOpenGLBuffer &vbo, const fl5Color &backclr, bool bTwoSided, bool bLight);
         void paintTriangles3Vtx(QOpenGLBuffer &vbo, const QColor &backclr, bool bTwoSided, bool bLight);
+        void paintLodMesh(glLodMesh &lod, QColor const &backclr, bool bSurface, bool bEdges, LineStyle const &edgestyle, bool bLight);
 
         void paintTriangleFan(QOpenGLBuffer &vbo, const QColor &clr, bool bLight, bool bCullFaces);
 
@@ -273,6 +282,7 @@ class gl3dView : public QOpenGLWidget, protected QOpenGLExtraFunctions
         void paintTriangles3VtxOutline(QOpenGLBuffer &vbo, QColor clr, int thickness);
 
         void paintColourMap(QOpenGLBuffer &vbo, const QMatrix4x4 &m_ModelMatrix = QMatrix4x4());
+        void paintColourMap(QOpenGLBuffer &vboGeom, QOpenGLBuffer &vboValues, QMatrix4x4 const& m_ModelMatrix, bool bMap=true, bool bContours=false);
 
         void paintPoints(QOpenGLBuffer &vbo, float width, int iShape, bool bLight, const fl5Color &clr, int stride);
         void paintPoints(QOpenGLBuffer &vbo, float width, int iShape, bool bLight, const QColor &clr, int stride);
@@ -342,6 +352,13 @@ class gl3dView : public QOpenGLWidget, protected QOpenGLExtraFunctions
         QOpenGLBuffer m_vboIcoSphere, m_vboIcoSphereEdges;
         QOpenGLBuffer m_vboCone, m_vboConeContour;
         QOpenGLBuffer m_vboThinArrow;
+        QOpenGLBuffer m_vboInstances;   /**< a scratch buffer for the instanced glyphs built at paint time */
+
+        QOpenGLTexture *m_pColourRamp; /**< the legend's colours, sampled by the colour map shader */
+
+        QOpenGLFramebufferObject *m_pOffscreenFbo; /**< the frame buffer used by renderToImage(), kept between calls */
+        QSize m_OffscreenSize;                     /**< the size of the off-screen rendering in progress, or invalid */
+        QImage m_ColourRampImg;
 
         bool m_bArcball;			//true if the arcball is to be displayed
         bool m_bCrossPoint;			//true if the control point on the arcball is to be displayed
@@ -33,6 +33,8 @@ struct ShaderLocations
     int m_attrColor{-1};
     int m_attrUV{-1}; // vertex attribute array containing the texture's UV coordinates
     int m_attrOffset{-1};
+    int m_attrVector{-1}; // the per-instance direction and length of an instanced glyph
+    int m_attrValue{-1};  // the normalized scalar value mapped on the colour ramp
 
     // Uniforms
     int m_vmMatrix{-1}, m_pvmMatrix{-1};
@@ -47,6 +49,9 @@ struct ShaderLocations
     int m_HasUniColor{-1};
     int m_HasTexture{-1};    // uniform defining whether a texture is enabled or not
     int m_IsInstanced{-1};
+    int m_HasColourRamp{-1}, m_ColourRamp{-1};
+    int m_ContourMode{-1}, m_nContours{-1}, m_ContourColor{-1}, m_ContourWidth{-1};
+    int m_EdgeMode{-1}, m_EdgeColor{-1}, m_EdgeWidth{-1};
 
     int m_Pattern{-1}, m_nPatterns{-1};
     int m_Thickness{-1}, m_Viewport{-1};
@@ -3,11 +3,15 @@ HEADERS += \
     $$PWD/optimplanedlg.h \
     $$PWD/particle.h \
     $$PWD/psotask.h \
+    $$PWD/psotaskfoil.h \
     $$PWD/psotaskplane.h \
+    $$PWD/surrogate.h \
 
 SOURCES += \
     $$PWD/optimplanedlg.cpp \
     $$PWD/particle.cpp \
     $$PWD/psotask.cpp \
+    $$PWD/psotaskfoil.cpp \
     $$PWD/psotaskplane.cpp \
+    $$PWD/surrogate.cpp \
 
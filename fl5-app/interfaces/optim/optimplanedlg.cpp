@@ -357,6 +357,17 @@ void OptimPlaneDlg::makeCommonWt()
             m_pchMultiThread = new QCheckBox("Multi-threaded");
             m_pchMultiThread->setChecked(PSOTask::s_bMultiThreaded);
 
+            m_pchSurrogate = new QCheckBox("Surrogate pre-screening");
+            m_pchSurrogate->setChecked(PSOTask::s_bSurrogate);
+            m_pchSurrogate->setToolTip("<p>If activated, the moves of the particles are first evaluated with a model "
+                                       "trained on the particles already analyzed, and only the most promising particles "
+                                       "or those where the model is the least certain are analyzed.</p>");
+            m_pdeSurrogateFraction = new FloatEdit(PSOTask::s_SurrogateFraction*100.0);
+            m_pdeSurrogateFraction->setRange(1.0, 100.0);
+            m_pdeSurrogateFraction->setToolTip("<p>The percentage of the swarm which is analyzed at each iteration in surrogate mode.<br>"
+                                               "Recommendation: 15% to 30%</p>");
+            QLabel *pLabSurrogatePercent = new QLabel("%");
+
             QLabel *pFlow5Link = new QLabel;
             pFlow5Link->setText("<a href=https://flow5.tech/docs/flow5_doc/MOPSO/MOPSO.html>https://flow5.tech/docs/flow5_doc/MOPSO/MOPSO.html</a>");
             pFlow5Link->setOpenExternalLinks(true);
@@ -389,9 +400,13 @@ void OptimPlaneDlg::makeCommonWt()
 
             pSwarmLayout->addWidget(m_pchMultiThread,     9,1,1,3);
 
-            pSwarmLayout->addWidget(pFlow5Link,           11,1,1,2);
+            pSwarmLayout->addWidget(m_pchSurrogate,         10, 1);
+            pSwarmLayout->addWidget(m_pdeSurrogateFraction, 10, 2);
+            pSwarmLayout->addWidget(pLabSurrogatePercent,   10, 3);
+
+            pSwarmLayout->addWidget(pFlow5Link,           12,1,1,2);
 
-            pSwarmLayout->setRowStretch(10,1);
+            pSwarmLayout->setRowStretch(11,1);
         }
         m_pPSOFrame->setLayout(pSwarmLayout);
     }
@@ -527,6 +542,8 @@ void OptimPlaneDlg::onRestorePSODefaults()
     m_pdeCognitiveWeight->setValue(PSOTask::s_CognitiveWeight);
     m_pdeSocialWeight->setValue(   PSOTask::s_SocialWeight);
     m_pdePropRegenerate->setValue( PSOTask::s_ProbRegenerate*100.0);
+    m_pchSurrogate->setChecked(    PSOTask::s_bSurrogate);
+    m_pdeSurrogateFraction->setValue(PSOTask::s_SurrogateFraction*100.0);
 }
 
 
@@ -647,6 +664,8 @@ void OptimPlaneDlg::loadSettings(QSettings &settings)
         PSOTask::s_CognitiveWeight = settings.value("CognitiveWeight", PSOTask::s_CognitiveWeight).toDouble();
         PSOTask::s_SocialWeight    = settings.value("SocialWeight",    PSOTask::s_SocialWeight).toDouble();
         PSOTask::s_ArchiveSize     = settings.value("ArchiveSize",     PSOTask::s_ArchiveSize).toInt();
+        PSOTask::s_bSurrogate        = settings.value("Surrogate",         PSOTask::s_bSurrogate).toBool();
+        PSOTask::s_SurrogateFraction = settings.value("SurrogateFraction", PSOTask::s_SurrogateFraction).toDouble();
 
         s_HSplitterSizes      = settings.value("HSplitterSizes",  QByteArray()).toByteArray();
         s_LeftVSplitterSizes  = settings.value("LeftVSplitterSizes",  QByteArray()).toByteArray();
@@ -669,6 +688,8 @@ void OptimPlaneDlg::saveSettings(QSettings &settings)
         settings.setValue("CognitiveWeight", PSOTask::s_CognitiveWeight);
         settings.setValue("SocialWeight",    PSOTask::s_SocialWeight);
         settings.setValue("ArchiveSize",     PSOTask::s_ArchiveSize);
+        settings.setValue("Surrogate",         PSOTask::s_bSurrogate);
+        settings.setValue("SurrogateFraction", PSOTask::s_SurrogateFraction);
 
         settings.setValue("HSplitterSizes",      s_HSplitterSizes);
         settings.setValue("LeftVSplitterSizes",  s_LeftVSplitterSizes);
@@ -867,6 +888,8 @@ void OptimPlaneDlg::readData()
     PSOTask::s_MaxIter         = m_pieMaxIter->value();
     PSOTask::s_PopSize         = m_pieSwarmSize->value();
     PSOTask::setMultithreaded(m_pchMultiThread->isChecked());
+    PSOTask::s_bSurrogate        = m_pchSurrogate->isChecked();
+    PSOTask::s_SurrogateFraction = m_pdeSurrogateFraction->value()/100.0;
 }
 
 
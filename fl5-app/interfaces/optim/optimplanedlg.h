@@ -182,6 +182,8 @@ class OptimPlaneDlg : public QDialog
         FloatEdit *m_pdePropRegenerate;
         QPushButton *m_ppbRestoreDefault;
         QCheckBox *m_pchMultiThread;
+        QCheckBox *m_pchSurrogate;
+        FloatEdit *m_pdeSurrogateFraction;
 
 
         //Results
@@ -32,6 +32,7 @@ Particle::Particle()
 {
     m_bIsConverged = false;
     m_bIsInParetoFront = false;
+    m_bIsEstimated = false;
     resizeArrays(0, 1, 1);
 }
 
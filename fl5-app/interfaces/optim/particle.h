@@ -79,6 +79,10 @@ class Particle
         void setInParetoFront(bool b) {m_bIsInParetoFront = b;}
         bool isInParetoFront() const {return m_bIsInParetoFront;}
 
+        /** true if the fitness has been predicted by the surrogate model rather than evaluated */
+        void setEstimated(bool b) {m_bIsEstimated = b;}
+        bool isEstimated() const {return m_bIsEstimated;}
+
     private:
         // size = dimension = nVariables
         QVector<double> m_Position;
@@ -93,6 +97,7 @@ class Particle
         QVector<QVector<double>> m_BestPosition; /** the particle's personal best positions achieved so far; size=dimension */
 
         bool m_bIsInParetoFront;
+        bool m_bIsEstimated;
 
         //XFoil specific
         bool m_bIsConverged;
@@ -23,10 +23,17 @@
 *****************************************************************************/
 
 
-#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QRandomGenerator>
 
 #include <interfaces/optim/psotask.h>
 #include <api/constants.h>
+#include <api/threadpool.h>
 
 int    PSOTask::s_ArchiveSize     = 10;
 double PSOTask::s_InertiaWeight   = 0.3;
@@ -36,7 +43,9 @@ double PSOTask::s_ProbRegenerate  = 0.07;
 
 int  PSOTask::s_PopSize           = 17;
 int  PSOTask::s_MaxIter           = 30;
-bool PSOTask::s_bMultiThreaded    = false; /** @todo change */
+bool PSOTask::s_bMultiThreaded    = true;
+bool   PSOTask::s_bSurrogate       = false;
+double PSOTask::s_SurrogateFraction = 0.25;
 
 
 QVector<Vector3d> PSOTask::s_DebugPts;
@@ -47,6 +56,7 @@ PSOTask::PSOTask()
 {
     m_bConverged = false;
     m_Iter = 0;
+    m_nEvaluations = 0;
     m_Status = xfl::PENDING;
 }
 
@@ -140,6 +150,8 @@ void PSOTask::restoreDefaults()
     s_CognitiveWeight   = 0.7;
     s_SocialWeight      = 0.7;
     s_ProbRegenerate    = 0.05;
+    s_bSurrogate        = false;
+    s_SurrogateFraction = 0.25;
 }
 
 
@@ -154,29 +166,12 @@ void PSOTask::onMakeParticleSwarm()
         makeRandomParticle(&particle);
     }
 
-    if(s_bMultiThreaded)
-    {
-//        QThreadPool::globalInstance()->setMaxThreadCount(4);
-         QFutureSynchronizer<void> futureSync;
-        for (int isw=0; isw<m_Swarm.size(); ++isw)
-        {
-           Particle &particle = m_Swarm[isw];
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-           futureSync.addFuture(QtConcurrent::run(QThreadPool::globalInstance(), this, &PSOTask::calcFitness, &particle, false, true));
-#else
-           futureSync.addFuture(QtConcurrent::run(&PSOTask::calcFitness, this, &particle, false, true));
-#endif
-        }
-        futureSync.waitForFinished();
-    }
-    else
-    {
-        for(int i=0; i<m_Swarm.size(); i++)
-        {
-            calcFitness(&m_Swarm[i], false, true);
-            if(isCancelled()) break;
-        }
-    }
+    m_Surrogate.setVariables(m_Variable, int(m_Objective.size()));
+    m_nEvaluations = 0;
+
+    std::vector<Particle*> particles(m_Swarm.size());
+    for(int i=0; i<m_Swarm.size(); i++) particles[i] = &m_Swarm[i];
+    calcSwarmFitness(particles, true);
 
     for(int i=0; i<m_Swarm.size(); i++)
         for(int iobj=0; iobj<m_Objective.size(); iobj++)
@@ -220,33 +215,30 @@ void PSOTask::onStartIterations()
 
 void PSOTask::onIteration()
 {
-    if(s_bMultiThreaded)
+    // the moves are cheap and are made first, then the swarm is evaluated in one pass
+    for (int isw=0; isw<m_Swarm.size(); ++isw)
     {
-        //m_Swarm.detach(); //kill detach issues altogether
-        Particle *particles = new Particle[m_Swarm.size()];
-        for(int ip=0; ip<m_Swarm.size(); ip++)   particles[ip] = m_Swarm.at(ip);
+        moveParticle(&m_Swarm[isw]);
+    }
 
-        QFutureSynchronizer<void> futureSync;
-        for (int isw=0; isw<m_Swarm.size(); ++isw)
+    if(m_Status!=xfl::CANCELLED)
+    {
+        std::vector<Particle*> selection;
+        if(s_bSurrogate && m_Surrogate.train())
+            screenSwarm(selection);
+        else
         {
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-            futureSync.addFuture(QtConcurrent::run(this, &PSOTask::moveParticle, particles+isw));
-#else
-            futureSync.addFuture(QtConcurrent::run(&PSOTask::moveParticle, this, particles+isw));
-#endif
+            for (int isw=0; isw<m_Swarm.size(); ++isw) selection.push_back(&m_Swarm[isw]);
         }
-        futureSync.waitForFinished();
 
-        for(int ip=0; ip<m_Swarm.size(); ip++)  m_Swarm[ip] = particles[ip];
-        delete [] particles;
-    }
-    else
-    {
+        calcSwarmFitness(selection, false);
+
+        // the personal bests are only made of evaluated positions
         for (int isw=0; isw<m_Swarm.size(); ++isw)
         {
             Particle &particle = m_Swarm[isw];
-            moveParticle(&particle);
-            if(m_Status==xfl::CANCELLED) break;
+            for(int i=0; i<m_Objective.size(); i++)  particle.setError(i, error(&particle, i));
+            if(!particle.isEstimated()) particle.updateBest();
         }
     }
 
@@ -295,6 +287,7 @@ void PSOTask::onIteration()
         if     (m_bConverged)             outputMsg("   ---Converged---\n");
         else if(m_Status==xfl::CANCELLED) outputMsg("The task has been cancelled\n");
         else if(m_Iter>=s_MaxIter)        outputMsg("The maximum number of iterations has been reached\n");
+        outputMsg(QString::asprintf("%d fitness evaluations\n", m_nEvaluations));
 
         m_Status = xfl::FINISHED;
 
@@ -377,13 +370,108 @@ void PSOTask::moveParticle(Particle *pParticle) const
     }
 
     checkBounds(*pParticle);
+}
+
+
+/** Evaluates the fitness of the particles, and adds them to the surrogate's training set */
+void PSOTask::calcSwarmFitness(std::vector<Particle*> const &particles, bool bTrace)
+{
+    int nParticles = int(particles.size());
+    if(nParticles<=0) return;
+
+    evaluateParticles(particles, bTrace);
+
+    if(isCancelled()) return;
+
+    m_nEvaluations += nParticles;
+    for(int ip=0; ip<nParticles; ip++)
+    {
+        particles.at(ip)->setEstimated(false);
+        if(s_bSurrogate) m_Surrogate.addSample(*particles.at(ip));
+    }
+}
+
+
+/**
+ * In multithreaded mode, each worker context takes the next pending particle until none is left,
+ * so that the load is balanced when the evaluation times differ between particles.
+ */
+void PSOTask::evaluateParticles(std::vector<Particle*> const &particles, bool bTrace)
+{
+    int nParticles = int(particles.size());
+    int nContexts = s_bMultiThreaded ? std::min(nParticles, ThreadPool::maxThreadCount()) : 1;
+    makeContexts(nContexts);
+
+    std::atomic<int> iNext(0);
+    ThreadPool::pool().parallelFor(nContexts, [this, &particles, nParticles, bTrace, &iNext](int iContext)
+    {
+        for(int ip=iNext++; ip<nParticles; ip=iNext++)
+        {
+            if(isCancelled()) return;
+            calcFitness(particles.at(ip), false, bTrace, iContext);
+        }
+    });
+}
+
+
+/**
+ * Predicts the fitness of the moved particles with the surrogate model, and selects those which will be evaluated.
+ * Most of the analyses are spent on the particles predicted to be non-dominated by the Pareto front, in the order of
+ * their predicted distance to the objectives; the others are spent at the positions where the prediction is the least certain.
+ * The particles which are not selected keep the predicted fitness and are flagged as estimated.
+ */
+void PSOTask::screenSwarm(std::vector<Particle*> &selection)
+{
+    int n = int(m_Swarm.size());
+    int nSelect  = std::clamp(int(ceil(s_SurrogateFraction*double(n))), 1, n);
+    int nExplore = nSelect/3;
+
+    std::vector<double> score(n, 0.0), sigma(n, 1.0);
+    std::vector<bool> bPromising(n, true);
+    std::vector<double> fitness;
+
+    for(int i=0; i<n; i++)
+    {
+        Particle &particle = m_Swarm[i];
+        m_Surrogate.predict(particle, fitness, sigma[i]);
+        for(int iobj=0; iobj<m_Objective.size(); iobj++)
+        {
+            particle.setFitness(iobj, fitness.at(iobj));
+            particle.setError(iobj, error(&particle, iobj));
+
+            double maxerr = m_Objective.at(iobj).m_MaxError;
+            double err = fabs(maxerr)>1.0e-6 ? particle.error(iobj)/maxerr : particle.error(iobj);
+            score[i] += err*err;
+        }
+        particle.setEstimated(true);
 
-    if(m_Status==xfl::CANCELLED) return;
+        for(int ip=0; ip<m_Pareto.size(); ip++)
+        {
+            if(m_Pareto.at(ip).dominates(&particle))
+            {
+                bPromising[i] = false;
+                break;
+            }
+        }
+    }
 
-    calcFitness(pParticle); // note: do not parallelize in derived class
-    for(int i=0; i<m_Objective.size(); i++)  pParticle->setError(i, error(pParticle, i));
+    std::vector<int> order(n);
+    for(int i=0; i<n; i++) order[i] = i;
 
-    pParticle->updateBest();
+    std::sort(order.begin(), order.end(), [&](int i0, int i1)
+    {
+        if(bPromising.at(i0)!=bPromising.at(i1)) return bool(bPromising.at(i0));
+        return score.at(i0)<score.at(i1);
+    });
+    std::vector<int> explore(order.begin()+(nSelect-nExplore), order.end());
+    order.resize(nSelect-nExplore);
+
+    std::sort(explore.begin(), explore.end(), [&](int i0, int i1) {return sigma.at(i0)>sigma.at(i1);});
+    explore.resize(nExplore);
+
+    selection.clear();
+    for(int i : order)   selection.push_back(&m_Swarm[i]);
+    for(int i : explore) selection.push_back(&m_Swarm[i]);
 }
 
 
@@ -472,11 +560,54 @@ void PSOTask::updateErrors()
 }
 
 
+/**
+ * Merges the evaluated particles of the swarm into the Pareto frontier.
+ * The non-dominated particles of the swarm are found first by a sort in lexicographic order of their errors,
+ * since a particle can only be dominated by one which precedes it, so that each particle is compared
+ * only with the non-dominated particles found so far. These are then inserted in the frontier,
+ * which is pruned to the archive size by removing the most crowded particles.
+ */
 void PSOTask::makeParetoFrontier()
 {
+    std::vector<int> candidates;
     for(int j=0; j<m_Swarm.size(); j++)
+    {
+        if(!m_Swarm.at(j).isEstimated()) candidates.push_back(j); // only evaluated positions make the frontier
+    }
+
+    int nObj = m_Objective.size();
+    std::stable_sort(candidates.begin(), candidates.end(), [this, nObj](int j0, int j1)
+    {
+        Particle const &p0 = m_Swarm.at(j0);
+        Particle const &p1 = m_Swarm.at(j1);
+        for(int iobj=0; iobj<nObj; iobj++)
+        {
+            if(p0.error(iobj)<p1.error(iobj)) return true;
+            if(p0.error(iobj)>p1.error(iobj)) return false;
+        }
+        return false;
+    });
+
+    std::vector<int> front;
+    for(int j : candidates)
+    {
+        Particle const &pj = m_Swarm.at(j);
+        bool bIsDominated = false;
+        for(int k : front)
+        {
+            if(m_Swarm.at(k).dominates(&pj))
+            {
+                bIsDominated = true;
+                break;
+            }
+        }
+        if(!bIsDominated) front.push_back(j);
+    }
+
+    for(int j : front)
     {
         Particle const &pj = m_Swarm.at(j);
+
         bool bIsDominated=false;
         for(int ip=0; ip<m_Pareto.size(); ip++)
         {
@@ -506,13 +637,46 @@ void PSOTask::makeParetoFrontier()
         if(m_Status==xfl::CANCELLED) break;
     }
 
-    /** @todo target removal to ensure max dispersion of the Pareto frontier */
-    if(s_ArchiveSize>1)
+    if(s_ArchiveSize>1) pruneParetoFrontier();
+}
+
+
+/**
+ * Removes the particles of the Pareto frontier in excess of the archive size, one at a time,
+ * choosing each time the particle with the smallest crowding distance in the space of the objectives' values,
+ * so that the frontier remains evenly spread. The particles at the ends of the frontier are kept.
+ */
+void PSOTask::pruneParetoFrontier()
+{
+    int nObj = m_Objective.size();
+    std::vector<int> order;
+    std::vector<double> crowding;
+
+    while(m_Pareto.size()>s_ArchiveSize)
     {
-        while(m_Pareto.size()>s_ArchiveSize)
+        int n = m_Pareto.size();
+        crowding.assign(n, 0.0);
+        order.resize(n);
+        for(int iobj=0; iobj<nObj; iobj++)
         {
-            m_Pareto.removeAt(QRandomGenerator::global()->bounded(m_Pareto.size()));
+            for(int i=0; i<n; i++) order[i] = i;
+            std::sort(order.begin(), order.end(), [this, iobj](int i0, int i1) {return m_Pareto.at(i0).fitness(iobj)<m_Pareto.at(i1).fitness(iobj);});
+
+            double range = m_Pareto.at(order.back()).fitness(iobj) - m_Pareto.at(order.front()).fitness(iobj);
+            crowding[order.front()] = LARGEVALUE;
+            crowding[order.back()]  = LARGEVALUE;
+            if(range<1.0e-12) continue;
+            for(int i=1; i<n-1; i++)
+            {
+                double d = (m_Pareto.at(order[i+1]).fitness(iobj) - m_Pareto.at(order[i-1]).fitness(iobj))/range;
+                crowding[order[i]] = std::min(crowding[order[i]]+d, LARGEVALUE);
+            }
         }
+
+        int iMin = int(std::min_element(crowding.begin(), crowding.end())-crowding.begin());
+        if(crowding.at(iMin)>=LARGEVALUE)
+            iMin = QRandomGenerator::global()->bounded(n); // only end points are left
+        m_Pareto.removeAt(iMin);
     }
 }
 
@@ -554,25 +718,12 @@ void listOptVariables(QVector<OptVariable> const &variables)
 
 void PSOTask::updateFitnesses()
 {
-    if(s_bMultiThreaded)
-    {
-        QFutureSynchronizer<void> futureSync;
-        for (int isw=0; isw<m_Swarm.size(); ++isw)
-        {
-           Particle &particle = m_Swarm[isw];
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-           futureSync.addFuture(QtConcurrent::run(QThreadPool::globalInstance(), this, &PSOTask::calcFitness, &particle, false, true));
-#else
-           futureSync.addFuture(QtConcurrent::run(&PSOTask::calcFitness, this, &particle, false, true));
-#endif
-        }
-        futureSync.waitForFinished();
-    }
-    else
-    {
-        for(int i=0; i<m_Swarm.size(); i++)
-            calcFitness(&m_Swarm[i]);
-    }
+    // the objectives may have changed, so the samples are no longer valid
+    m_Surrogate.setVariables(m_Variable, int(m_Objective.size()));
+
+    std::vector<Particle*> particles(m_Swarm.size());
+    for(int i=0; i<m_Swarm.size(); i++) particles[i] = &m_Swarm[i];
+    calcSwarmFitness(particles, false);
 
     for(int i=0; i<m_Swarm.size(); i++)
     {
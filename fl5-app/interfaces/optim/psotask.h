@@ -32,6 +32,7 @@
 #include <api/vector3d.h>
 #include <api/optstructures.h>
 #include <interfaces/optim/particle.h>
+#include <interfaces/optim/surrogate.h>
 #include <api/utils.h>
 
 
@@ -89,6 +90,7 @@ class PSOTask : public QObject
         void listPopulation() const;
 
         bool isConverged() const {return m_bConverged;}
+        int nEvaluations() const {return m_nEvaluations;}
 
 
         void setAnalysisStatus(xfl::enumAnalysisStatus status) {m_Status=status;}
@@ -99,7 +101,7 @@ class PSOTask : public QObject
         bool isFinished()  const {return m_Status==xfl::FINISHED || m_Status==xfl::CANCELLED;}
 
         void restartIterations() {m_Iter=0;}
-        virtual void calcFitness(Particle *pParticle, bool bLong=false, bool bTrace=false) const = 0;
+        virtual void calcFitness(Particle *pParticle, bool bLong=false, bool bTrace=false, int iContext=0) const = 0;
 
         static void setMultithreaded(bool b) {s_bMultiThreaded=b;}
 
@@ -126,15 +128,26 @@ class PSOTask : public QObject
         void postOptEndEvent() const;
         void checkBounds(Particle &particle) const;
         void outputMsg(QString const &msg);
+        virtual double error(Particle const *pParticle, int iObjective) const;
+
+        /** Prepares the nContexts worker contexts used by calcFitness() to evaluate the swarm.
+         *  Called from the task's thread before each evaluation of the swarm. */
+        virtual void makeContexts(int nContexts) {(void)nContexts;}
+
+        /** Evaluates the particles; the default implementation calls calcFitness() for each particle on the worker contexts */
+        virtual void evaluateParticles(std::vector<Particle*> const &particles, bool bTrace);
 
     private:
         virtual void makeRandomParticle(Particle *pParticle) const;
         void moveParticle(Particle *pParticle) const;
+        void calcSwarmFitness(std::vector<Particle*> const &particles, bool bTrace);
+        void screenSwarm(std::vector<Particle*> &selection);
+
+        void pruneParetoFrontier();
 
         void postIterEvent(int iBest);
         void postPSOEvent(int iBest);
 
-        virtual double error(Particle const *pParticle, int iObjective) const;
 
     public slots:
         void onMakeParticleSwarm();
@@ -161,6 +174,9 @@ class PSOTask : public QObject
         bool m_bConverged;
 
         int m_Iter;
+        int m_nEvaluations;   /**< the number of fitness evaluations since the swarm was made */
+
+        Surrogate m_Surrogate;
         QObject *m_pParent;
         xfl::enumAnalysisStatus m_Status;
 
@@ -172,6 +188,8 @@ class PSOTask : public QObject
         static int  s_PopSize;
         static int  s_MaxIter;
         static bool s_bMultiThreaded;
+        static bool s_bSurrogate;           /**< if true, the moves are pre-screened with a surrogate model of the fitness */
+        static double s_SurrogateFraction;  /**< the fraction of the swarm evaluated at each iteration in surrogate mode */
         static int    s_ArchiveSize;
         static double s_InertiaWeight;
         static double s_CognitiveWeight;
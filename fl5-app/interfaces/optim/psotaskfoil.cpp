@@ -0,0 +1,322 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <cmath>
+
+#include <interfaces/optim/psotaskfoil.h>
+#include <api/analysisrange.h>
+#include <api/constants.h>
+#include <api/foil.h>
+#include <api/polar.h>
+#include <api/threadpool.h>
+#include <api/xfoilbatchengine.h>
+
+
+Polar PSOTaskFoil::s_Polar;
+int    PSOTaskFoil::s_nScreenPoints = 2;
+double PSOTaskFoil::s_AbortFactor   = 3.0;
+
+
+namespace
+{
+    /** one single-value range for each design aoa, in the order of the design points */
+    void makeDesignRanges(std::vector<double> const &alpha, std::vector<AnalysisRange> &ranges)
+    {
+        ranges.clear();
+        for(double a : alpha) ranges.push_back({true, a, a, 0.0});
+    }
+}
+
+
+PSOTaskFoil::PSOTaskFoil() : PSOTask()
+{
+    m_pFoil = nullptr;
+}
+
+
+PSOTaskFoil::~PSOTaskFoil()
+{
+    clearBuffers();
+}
+
+
+void PSOTaskFoil::clearBuffers()
+{
+    for(uint i=0; i<m_Foil.size();  i++) delete m_Foil[i];
+    for(uint i=0; i<m_Polar.size(); i++) delete m_Polar[i];
+    m_Foil.clear();
+    m_Polar.clear();
+}
+
+
+void PSOTaskFoil::setStaticPolar(Polar const &polar)
+{
+    s_Polar.copySpecification(polar);
+}
+
+
+void PSOTaskFoil::setFoil(Foil const *pFoil)
+{
+    m_pFoil = pFoil;
+    makeDefaultVariables();
+}
+
+
+/**
+ * Sets the variable ranges around the base foil's values.
+ * The camber is left unchanged if the base foil is symmetric, since it is scaled from the base camber line.
+ */
+void PSOTaskFoil::makeDefaultVariables()
+{
+    if(!m_pFoil) return;
+
+    double t  = m_pFoil->maxThickness();
+    double xt = m_pFoil->xThickness();
+    double c  = m_pFoil->maxCamber();
+    double xc = m_pFoil->xCamber();
+
+    m_Variable.resize(NFOILFIELDS);
+    m_Variable[0] = OptVariable("Thickness",   0.8*t, 1.2*t);
+    m_Variable[1] = OptVariable("X-thickness", std::max(0.05, xt-0.1), std::min(0.9, xt+0.1));
+    if(fabs(c)>1.0e-4)
+    {
+        m_Variable[2] = OptVariable("Camber",   0.5*c, 1.5*c);
+        m_Variable[3] = OptVariable("X-camber", std::max(0.05, xc-0.15), std::min(0.9, xc+0.15));
+    }
+    else
+    {
+        m_Variable[2] = OptVariable("Camber",   c);
+        m_Variable[3] = OptVariable("X-camber", xc);
+    }
+}
+
+
+void PSOTaskFoil::setObjectivePoint(int iobj, int ipt)
+{
+    if(iobj<0) return;
+    if(iobj>=int(m_ObjectivePoint.size())) m_ObjectivePoint.resize(iobj+1, 0);
+    m_ObjectivePoint[iobj] = ipt;
+}
+
+
+void makePSOFoil(Particle const *pParticle, Foil const *pBaseFoil, Foil *pFoil)
+{
+    pFoil->copy(pBaseFoil);
+    pFoil->applyBase();
+
+    if(pFoil->baseCbLine().size()<2) return;
+
+    double x0 = pFoil->baseCbLine().front().x;
+    double x1 = pFoil->baseCbLine().back().x;
+
+    pFoil->setThickness(x0 + (x1-x0)*pParticle->pos(1), pParticle->pos(0));
+    if(fabs(pFoil->maxCamber())>1.0e-4)
+        pFoil->setCamber(x0 + (x1-x0)*pParticle->pos(3), pParticle->pos(2));
+
+    pFoil->makeBaseFromCamberAndThickness();
+    pFoil->rebuildPointSequenceFromBase();
+    pFoil->applyBase();
+}
+
+
+void PSOTaskFoil::makePolar(Polar *pPolar) const
+{
+    pPolar->copySpecification(s_Polar);
+    pPolar->reset();
+}
+
+
+/** Returns the value of the objective's quantity at its design point, or false if the point has not been computed */
+bool PSOTaskFoil::designValue(Polar const &polar, int iObjective, double &value) const
+{
+    int ipt = objectivePoint(iObjective);
+    if(ipt<0 || ipt>=nDesignPoints()) return false;
+
+    double alpha = m_DesignAlpha.at(ipt);
+    for(int k=0; k<polar.dataSize(); k++)
+    {
+        if(fabs(polar.m_Alpha.at(k)-alpha)<0.01)
+        {
+            switch(m_Objective.at(iObjective).m_Index)
+            {
+                default:
+                case CL:   value = polar.m_Cl.at(k);                    break;
+                case CD:   value = polar.m_Cd.at(k);                    break;
+                case CLCD: value = polar.m_Cl.at(k)/polar.m_Cd.at(k);   break;
+                case CM:   value = polar.m_Cm.at(k);                    break;
+            }
+            return std::isfinite(value);
+        }
+    }
+    return false;
+}
+
+
+/** The objectives which could not be computed get the worst possible value */
+void PSOTaskFoil::setFitnesses(Particle *pParticle, Polar const &polar) const
+{
+    for(int iobj=0; iobj<pParticle->nObjectives() && iobj<m_Objective.size(); iobj++)
+    {
+        double value = 0.0;
+        if(!designValue(polar, iobj, value))
+            value = m_Objective.at(iobj).m_Type==xfl::MAXIMIZE ? -LARGEVALUE : LARGEVALUE;
+        pParticle->setFitness(iobj, value);
+    }
+}
+
+
+/**
+ * Called from the XFoil workers after each operating point.
+ * Once s_nScreenPoints design points have been computed, the candidate is aborted if its errors on
+ * the objectives already known exceed both their max. error and s_AbortFactor times the errors of a Pareto particle.
+ * The Pareto front is not modified while the swarm is being evaluated.
+ */
+bool PSOTaskFoil::isClearlyDominated(Polar const &polar) const
+{
+    int nObj = int(m_Objective.size());
+
+    int nDone = 0;
+    for(int ipt=0; ipt<nDesignPoints(); ipt++)
+    {
+        for(int k=0; k<polar.dataSize(); k++)
+        {
+            if(fabs(polar.m_Alpha.at(k)-m_DesignAlpha.at(ipt))<0.01)
+            {
+                nDone++;
+                break;
+            }
+        }
+    }
+    if(nDone<s_nScreenPoints || nDone>=nDesignPoints()) return false;
+
+    Particle candidate;
+    candidate.resizeArrays(int(m_Variable.size()), nObj, 1);
+    std::vector<bool> bKnown(nObj, false);
+    std::vector<double> err(nObj, 0.0);
+    bool bAny = false;
+    for(int iobj=0; iobj<nObj; iobj++)
+    {
+        double value = 0.0;
+        if(designValue(polar, iobj, value))
+        {
+            candidate.setFitness(iobj, value);
+            err[iobj] = error(&candidate, iobj);
+            bKnown[iobj] = bAny = true;
+        }
+    }
+    if(!bAny) return false;
+
+    for(int ip=0; ip<m_Pareto.size(); ip++)
+    {
+        Particle const &pareto = m_Pareto.at(ip);
+        bool bDominated = true;
+        for(int iobj=0; iobj<nObj; iobj++)
+        {
+            if(!bKnown.at(iobj)) continue;
+            if(err.at(iobj)<=s_AbortFactor*pareto.error(iobj) || err.at(iobj)<=m_Objective.at(iobj).m_MaxError)
+            {
+                bDominated = false;
+                break;
+            }
+        }
+        if(bDominated) return true;
+    }
+    return false;
+}
+
+
+/** Evaluates a single particle outside of a swarm evaluation */
+void PSOTaskFoil::calcFitness(Particle *pParticle, bool bLong, bool bTrace, int iContext) const
+{
+    (void)bLong;
+    (void)iContext;
+    if(!m_pFoil) return;
+
+    Foil foil;
+    Polar polar;
+    makePSOFoil(pParticle, m_pFoil, &foil);
+    makePolar(&polar);
+
+    XFoilJob job;
+    job.m_pFoil  = &foil;
+    job.m_pPolar = &polar;
+    makeDesignRanges(m_DesignAlpha, job.m_Ranges);
+
+    XFoilBatchEngine engine;
+    engine.setWorkerCount(1);
+    engine.addJob(job);
+    engine.run();
+
+    setFitnesses(pParticle, polar);
+
+    if(bTrace) postParticleEvent();
+}
+
+
+/**
+ * Evaluates the swarm in one batch. The candidate foils and polars are kept from one iteration to the next.
+ * The early abort is only used once a Pareto front exists, i.e. after the swarm has been made.
+ */
+void PSOTaskFoil::evaluateParticles(std::vector<Particle*> const &particles, bool bTrace)
+{
+    if(!m_pFoil) return;
+
+    int n = int(particles.size());
+    while(int(m_Foil.size())<n)
+    {
+        m_Foil.push_back(new Foil);
+        m_Polar.push_back(new Polar);
+    }
+
+    bool bScreen = m_Pareto.size()>0 && s_nScreenPoints<nDesignPoints();
+
+    XFoilBatchEngine engine;
+    engine.setWorkerCount(s_bMultiThreaded ? ThreadPool::maxThreadCount() : 1);
+
+    for(int ip=0; ip<n; ip++)
+    {
+        makePSOFoil(particles.at(ip), m_pFoil, m_Foil[ip]);
+        makePolar(m_Polar[ip]);
+
+        XFoilJob job;
+        job.m_pFoil  = m_Foil[ip];
+        job.m_pPolar = m_Polar[ip];
+        makeDesignRanges(m_DesignAlpha, job.m_Ranges);
+        if(bScreen) job.m_StopCondition = [this](Polar const &polar) {return isClearlyDominated(polar);};
+        engine.addJob(job);
+    }
+
+    engine.setStartCallback([this, &engine](XFoilJob const &, int)
+    {
+        if(isCancelled()) engine.cancel();
+    });
+    if(bTrace) engine.setResultCallback([this](XFoilJobResult &) {postParticleEvent();});
+
+    engine.run();
+
+    for(int ip=0; ip<n; ip++)
+        setFitnesses(particles.at(ip), *m_Polar.at(ip));
+}
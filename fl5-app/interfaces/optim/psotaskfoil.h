@@ -0,0 +1,92 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <vector>
+
+#include <interfaces/optim/psotask.h>
+
+
+class Foil;
+class Polar;
+
+#define NFOILFIELDS 4        // thickness, x-thickness, camber, x-camber
+
+/**
+ * @class PSOTaskFoil
+ * Optimizes the thickness and camber of a foil against objectives evaluated at a set of design aoa.
+ * The swarm is evaluated in one batch by the XFoilBatchEngine; each worker reuses its XFoil task,
+ * and the candidates which are clearly dominated by the Pareto front after the first design points are aborted.
+ */
+class PSOTaskFoil : public PSOTask
+{
+    public:
+        enum enumQuantity {CL, CD, CLCD, CM};
+
+    public:
+        PSOTaskFoil();
+        ~PSOTaskFoil() override;
+
+        void setFoil(Foil const *pFoil);
+        void makeDefaultVariables();
+
+        void setDesignPoints(std::vector<double> const &alpha) {m_DesignAlpha=alpha;}
+        int nDesignPoints() const {return int(m_DesignAlpha.size());}
+        double designPoint(int ipt) const {return m_DesignAlpha.at(ipt);}
+
+        /** Sets the index of the design point at which the objective is evaluated; the objective's m_Index is the enumQuantity */
+        void setObjectivePoint(int iobj, int ipt);
+        int objectivePoint(int iobj) const {return iobj<int(m_ObjectivePoint.size()) ? m_ObjectivePoint.at(iobj) : 0;}
+
+        static Polar &staticPolar() {return s_Polar;}
+        static void setStaticPolar(Polar const &polar);
+
+        static int    s_nScreenPoints;  /**< the number of design points computed before a dominated candidate may be aborted */
+        static double s_AbortFactor;    /**< a candidate is aborted if its errors exceed those of a Pareto particle by this factor */
+
+    private:
+        void calcFitness(Particle *pParticle, bool bLong=false, bool bTrace=false, int iContext=0) const override;
+        void evaluateParticles(std::vector<Particle*> const &particles, bool bTrace) override;
+
+        void makePolar(Polar *pPolar) const;
+        bool isClearlyDominated(Polar const &polar) const;
+        void setFitnesses(Particle *pParticle, Polar const &polar) const;
+        bool designValue(Polar const &polar, int iObjective, double &value) const;
+        void clearBuffers();
+
+    private:
+        Foil const *m_pFoil;
+        std::vector<double> m_DesignAlpha;  /**< the design aoa, in degrees */
+        std::vector<int> m_ObjectivePoint;  /**< the design point of each objective */
+
+        std::vector<Foil*> m_Foil;          /**< the candidate foils, reused from one iteration to the next */
+        std::vector<Polar*> m_Polar;
+
+        static Polar s_Polar;
+};
+
+
+void makePSOFoil(const Particle *pParticle, const Foil *pBaseFoil, Foil *pFoil);
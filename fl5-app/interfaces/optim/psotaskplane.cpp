@@ -27,17 +27,106 @@
 
 #include <interfaces/optim/psotaskplane.h>
 #include <api/panelanalysis.h>
+#include <api/threadpool.h>
 #include <api/planetask.h>
 #include <api/planeopp.h>
 #include <api/planepolar.h>
 #include <api/planexfl.h>
+#include <api/trimesh.h>
 
 
 PlanePolar PSOTaskPlane::s_WPolar;
 
 
+struct PSOTaskPlane::WorkerContext
+{
+    PlaneXfl m_PlaneXfl;
+    PlanePolar m_WPolar;
+    PlaneTask m_Task;
+};
+
+
 PSOTaskPlane::PSOTaskPlane() : PSOTask()
 {
+    m_pPlaneXfl = nullptr;
+}
+
+
+PSOTaskPlane::~PSOTaskPlane()
+{
+    clearContexts();
+}
+
+
+void PSOTaskPlane::clearContexts()
+{
+    for(uint i=0; i<m_Context.size(); i++) delete m_Context[i];
+    m_Context.clear();
+}
+
+
+/**
+ * Makes one context per worker. The contexts are kept from one iteration to the next,
+ * so that the plane, its meshes and the task are not reallocated for each particle.
+ * The cancellation flags are shared by all the tasks, and are reset here once for the whole swarm.
+ */
+void PSOTaskPlane::makeContexts(int nContexts)
+{
+    Task3d::setCancelled(false);
+    TriMesh::setCancelled(false);
+
+    while(int(m_Context.size())<nContexts) m_Context.push_back(new WorkerContext);
+}
+
+
+/**
+ * Evaluates the derivatives of the objectives w.r.t. each of the optimization variables, by forward differences.
+ * The particle is first analyzed in context 0, then each perturbed particle is analyzed concurrently
+ * with the LU factors of the particle's influence matrix, so that a perturbation costs a few matrix-vector
+ * products in place of a factorization. The perturbed analyses fall back to a full factorization if the mesh
+ * topology changes, or if the defect correction does not converge.
+ * @param dF the derivatives, stored row-major, i.e. dF[iobj*nVariables()+ivar]; zero for a fixed variable.
+ * @return false if the analysis of the particle failed.
+ */
+bool PSOTaskPlane::calcSensitivities(Particle const *pParticle, std::vector<double> &dF)
+{
+    int nVar = nVariables();
+    int nObj = pParticle->nObjectives();
+    dF.assign(size_t(nObj)*size_t(nVar), 0.0);
+
+    makeContexts(nVar+1);
+
+    Particle ref = *pParticle;
+    m_Context.front()->m_Task.setReferenceAnalysis(nullptr);
+    calcFitness(&ref, false, false, 0);
+    if(m_Context.front()->m_WPolar.dataSize()==0) return false;
+
+    PanelAnalysis const *pRefPA = m_Context.front()->m_Task.panelAnalysis();
+
+    ThreadPool::pool().parallelFor(nVar, [this, pParticle, pRefPA, &ref, &dF, nVar, nObj](int ivar)
+    {
+        OptVariable const &var = m_Variable.at(ivar);
+        double range = var.m_Max-var.m_Min;
+        if(range<DELTAVAR) return;
+
+        // the step must exceed the threshold above which makePSOPlane applies a change
+        double h = std::max(1.0e-3*range, 2.0*DELTAVAR);
+        if(pParticle->pos(ivar)+h>var.m_Max) h = -h;
+
+        Particle perturbed = *pParticle;
+        perturbed.setPos(ivar, pParticle->pos(ivar)+h);
+
+        WorkerContext &ctx = *m_Context.at(ivar+1);
+        ctx.m_Task.setReferenceAnalysis(pRefPA);
+        calcFitness(&perturbed, false, false, ivar+1);
+        ctx.m_Task.setReferenceAnalysis(nullptr);
+
+        if(ctx.m_WPolar.dataSize()==0) return;
+        for(int iobj=0; iobj<nObj; iobj++)
+            dF[size_t(iobj)*size_t(nVar)+size_t(ivar)] = (perturbed.fitness(iobj)-ref.fitness(iobj))/h;
+    });
+
+    return true;
 }
 
 
@@ -127,21 +216,28 @@ void makePSOPlane(Particle const *pParticle, PlaneXfl const*pBasePlaneXfl, Plane
 }
 
 
-void PSOTaskPlane::calcFitness(Particle *pParticle, bool bLong, bool bTrace) const
+/**
+ * Evaluates the particle using the worker context iContext.
+ * The contexts are used by one worker at a time, so that the particles can be evaluated concurrently.
+ * The panel analysis may still split its own loops on the thread pool, which handles the nested calls.
+ */
+void PSOTaskPlane::calcFitness(Particle *pParticle, bool bLong, bool bTrace, int iContext) const
 {
     (void)bLong;
-    PlaneXfl *pPlaneXfl = new PlaneXfl;
-    makePSOPlane(pParticle, m_pPlaneXfl, pPlaneXfl);
+    if(iContext<0 || iContext>=int(m_Context.size())) return;
 
-    PanelAnalysis::setMultiThread(false);
+    WorkerContext &ctx = *m_Context.at(iContext);
+    PlaneXfl *pPlaneXfl = &ctx.m_PlaneXfl;
+    PlaneTask *pTask = &ctx.m_Task;
+    PlanePolar &wpolar = ctx.m_WPolar;
 
-    PlaneTask *pTask = new PlaneTask;
-    Task3d::setCancelled(false);
-    TriMesh::setCancelled(false);
+    makePSOPlane(pParticle, m_pPlaneXfl, pPlaneXfl);
+
+    pTask->clearMessages();
     pTask->setAnalysisStatus(xfl::RUNNING);
 
-    PlanePolar wpolar;
     wpolar.duplicateSpec(&s_WPolar);
+    wpolar.clearWPolarData();
     wpolar.setMass(pParticle->pos(1));
     wpolar.setAutoInertia(true); //since the CoG is set as a plane variable
     wpolar.setReferenceChordLength(pPlaneXfl->mac());
@@ -156,9 +252,11 @@ void PSOTaskPlane::calcFitness(Particle *pParticle, bool bLong, bool bTrace) con
 
 
     pTask->run();
-    if(pTask->planeOppList().size()!=0)
+
+    // the operating point is not kept by the task, so read the results from the polar
+    if(wpolar.dataSize()!=0)
     {
-        PlaneOpp *pPOpp = pTask->planeOppList().front();
+        AeroForces const &AF = wpolar.aeroForce(0);
         for(int iobj=0; iobj<pParticle->nObjectives(); iobj++)
         {
             OptObjective const &obj = m_Objective.at(iobj);
@@ -166,41 +264,37 @@ void PSOTaskPlane::calcFitness(Particle *pParticle, bool bLong, bool bTrace) con
             {
                 default:
                 case 0: //Cl
-                    pParticle->setFitness(iobj, pPOpp->aeroForces().CL());
+                    pParticle->setFitness(iobj, AF.CL());
                     break;
                 case 1: //Cd
-                    pParticle->setFitness(iobj, pPOpp->aeroForces().CD());
+                    pParticle->setFitness(iobj, AF.CD());
                     break;
                 case 2: //Cl/Cd
-                    pParticle->setFitness(iobj, pPOpp->aeroForces().CL()/pPOpp->aeroForces().CD());
+                    pParticle->setFitness(iobj, AF.CL()/AF.CD());
                     break;
                 case 3: //Cl(3/2)/Cd
                 {
-                    double Cl = pPOpp->aeroForces().CL();
-                    double Cd = pPOpp->aeroForces().CD();
+                    double Cl = AF.CL();
+                    double Cd = AF.CD();
                     pParticle->setFitness(iobj, sqrt(Cl*Cl*Cl/(Cd*Cd)));
                     break;
                 }
                 case 4: //Cm
-                    pParticle->setFitness(iobj, pPOpp->aeroForces().Cm());
+                    pParticle->setFitness(iobj, AF.Cm());
                     break;
                 case 5: //m.g.Vz
-                    pParticle->setFitness(iobj, pPOpp->aeroForces().Cm());
+                    pParticle->setFitness(iobj, AF.Cm());
                     break;
                 case 6: //bending moment
-                    if(pPOpp->hasWOpp())
-                        pParticle->setFitness(iobj, pPOpp->WOpp(0).m_MaxBending);
+                    if(wpolar.m_MaxBending.size())
+                        pParticle->setFitness(iobj, wpolar.m_MaxBending.front());
                     else
                         pParticle->setFitness(iobj, LARGEVALUE);
                     break;
             }
         }
-        delete pPOpp;
     }
 
-    delete pPlaneXfl;
-    delete pTask;
-
     if(bTrace) postParticleEvent();
 }
 
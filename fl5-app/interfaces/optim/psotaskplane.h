@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <interfaces/optim/psotask.h>
 
 
@@ -42,17 +44,27 @@ class PSOTaskPlane : public PSOTask
 
     public:
         PSOTaskPlane();
+        ~PSOTaskPlane() override;
         void setPlane(PlaneXfl const*pPlaneXfl) {m_pPlaneXfl=pPlaneXfl;}
 
         static PlanePolar &staticPolar() {return s_WPolar;}
         static void setStaticPolar(PlanePolar const &wpolar);
 
+        bool calcSensitivities(Particle const *pParticle, std::vector<double> &dF);
+
     private:
-        void calcFitness(Particle *pParticle, bool bLong=false, bool bTrace=false) const override;
+        /** The plane, polar and task reused by one worker for each of the particles it evaluates */
+        struct WorkerContext;
+
+        void calcFitness(Particle *pParticle, bool bLong=false, bool bTrace=false, int iContext=0) const override;
+        void makeContexts(int nContexts) override;
+        void clearContexts();
 
         static PlanePolar s_WPolar;
         PlaneXfl const *m_pPlaneXfl;
 
+        std::vector<WorkerContext*> m_Context;
+
 };
 
 
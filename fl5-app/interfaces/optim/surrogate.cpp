@@ -0,0 +1,276 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <cmath>
+
+#include <interfaces/optim/surrogate.h>
+#include <interfaces/optim/particle.h>
+#include <interfaces/optim/psotask.h>
+
+
+int Surrogate::s_MaxSamples = 250;
+
+
+namespace
+{
+    /** the regularization added to the diagonal of the kernel matrix */
+    double const NUGGET = 1.0e-6;
+
+    /** In-place Cholesky factorization of the symmetric positive definite matrix A, row major; returns false if A is not SPD */
+    bool choleskyFactorize(std::vector<double> &A, int n)
+    {
+        for(int j=0; j<n; j++)
+        {
+            double d = A[j*n+j];
+            for(int k=0; k<j; k++) d -= A[j*n+k]*A[j*n+k];
+            if(d<=0.0) return false;
+            d = sqrt(d);
+            A[j*n+j] = d;
+
+            for(int i=j+1; i<n; i++)
+            {
+                double s = A[i*n+j];
+                for(int k=0; k<j; k++) s -= A[i*n+k]*A[j*n+k];
+                A[i*n+j] = s/d;
+            }
+            for(int i=0; i<j; i++) A[i*n+j] = 0.0;
+        }
+        return true;
+    }
+
+    /** Solves L.y=b in place */
+    void forwardSubstitute(std::vector<double> const &L, int n, std::vector<double> &b)
+    {
+        for(int i=0; i<n; i++)
+        {
+            double s = b[i];
+            for(int k=0; k<i; k++) s -= L[i*n+k]*b[k];
+            b[i] = s/L[i*n+i];
+        }
+    }
+
+    /** Solves Lt.x=y in place */
+    void backSubstitute(std::vector<double> const &L, int n, std::vector<double> &y)
+    {
+        for(int i=n-1; i>=0; i--)
+        {
+            double s = y[i];
+            for(int k=i+1; k<n; k++) s -= L[k*n+i]*y[k];
+            y[i] = s/L[i*n+i];
+        }
+    }
+}
+
+
+Surrogate::Surrogate()
+{
+    m_nObjectives = 0;
+    m_bTrained = false;
+    m_LengthScale = 1.0;
+}
+
+
+void Surrogate::clear()
+{
+    m_X.clear();
+    m_Y.clear();
+    m_L.clear();
+    m_Alpha.clear();
+    m_bTrained = false;
+}
+
+
+void Surrogate::setVariables(std::vector<OptVariable> const &variables, int nObjectives)
+{
+    clear();
+    m_nObjectives = nObjectives;
+    m_Min.resize(variables.size());
+    m_Range.resize(variables.size());
+    for(uint i=0; i<variables.size(); i++)
+    {
+        m_Min[i] = variables.at(i).m_Min;
+        double range = variables.at(i).m_Max - variables.at(i).m_Min;
+        m_Range[i] = range>DELTAVAR ? range : 0.0;
+    }
+}
+
+
+void Surrogate::normalize(Particle const &particle, std::vector<double> &x) const
+{
+    x.resize(m_Range.size());
+    for(uint i=0; i<m_Range.size(); i++)
+    {
+        if(m_Range.at(i)>0.0 && int(i)<particle.dimension())
+            x[i] = (particle.pos(i)-m_Min.at(i))/m_Range.at(i);
+        else
+            x[i] = 0.0;
+    }
+}
+
+
+double Surrogate::kernel(std::vector<double> const &x0, std::vector<double> const &x1) const
+{
+    double d2 = 0.0;
+    for(uint i=0; i<x0.size(); i++) d2 += (x0.at(i)-x1.at(i))*(x0.at(i)-x1.at(i));
+    return exp(-d2/(2.0*m_LengthScale*m_LengthScale));
+}
+
+
+/** Adds an evaluated particle to the training set; the particles too close to an existing sample are ignored */
+void Surrogate::addSample(Particle const &particle)
+{
+    if(particle.nObjectives()!=m_nObjectives) return;
+
+    std::vector<double> x;
+    normalize(particle, x);
+
+    for(uint is=0; is<m_X.size(); is++)
+    {
+        double d2 = 0.0;
+        for(uint i=0; i<x.size(); i++) d2 += (x.at(i)-m_X.at(is).at(i))*(x.at(i)-m_X.at(is).at(i));
+        if(d2<1.0e-12) return;
+    }
+
+    std::vector<double> y(m_nObjectives);
+    for(int iobj=0; iobj<m_nObjectives; iobj++)
+    {
+        y[iobj] = particle.fitness(iobj);
+        if(!std::isfinite(y[iobj])) return;
+    }
+
+    m_X.push_back(x);
+    m_Y.push_back(y);
+
+    if(int(m_X.size())>s_MaxSamples)
+    {
+        m_X.erase(m_X.begin());
+        m_Y.erase(m_Y.begin());
+    }
+    m_bTrained = false;
+}
+
+
+/**
+ * Builds and factorizes the kernel matrix.
+ * The length scale is twice the mean distance from each sample to its nearest neighbour.
+ * @return false if there are too few samples, or if the factorization failed.
+ */
+bool Surrogate::train()
+{
+    if(m_bTrained) return true;
+
+    int n = nSamples();
+    if(n<3 || m_nObjectives<=0) return false;
+
+    double sum = 0.0;
+    for(int i=0; i<n; i++)
+    {
+        double dmin = 1.e10;
+        for(int j=0; j<n; j++)
+        {
+            if(i==j) continue;
+            double d2 = 0.0;
+            for(uint k=0; k<m_X.at(i).size(); k++) d2 += (m_X.at(i).at(k)-m_X.at(j).at(k))*(m_X.at(i).at(k)-m_X.at(j).at(k));
+            dmin = std::min(dmin, d2);
+        }
+        sum += sqrt(dmin);
+    }
+    m_LengthScale = std::max(2.0*sum/double(n), 1.0e-3);
+
+    m_L.resize(n*n);
+    for(int i=0; i<n; i++)
+    {
+        for(int j=0; j<=i; j++)
+        {
+            double k = kernel(m_X.at(i), m_X.at(j));
+            m_L[i*n+j] = m_L[j*n+i] = k;
+        }
+        m_L[i*n+i] += NUGGET;
+    }
+
+    if(!choleskyFactorize(m_L, n)) return false;
+
+    m_Mean.resize(m_nObjectives);
+    m_Scale.resize(m_nObjectives);
+    m_Alpha.resize(m_nObjectives);
+    for(int iobj=0; iobj<m_nObjectives; iobj++)
+    {
+        double mean=0.0, var=0.0;
+        for(int i=0; i<n; i++) mean += m_Y.at(i).at(iobj);
+        mean /= double(n);
+        for(int i=0; i<n; i++) var += (m_Y.at(i).at(iobj)-mean)*(m_Y.at(i).at(iobj)-mean);
+        double scale = sqrt(var/double(n));
+        if(scale<1.0e-12) scale = 1.0;
+
+        m_Mean[iobj]  = mean;
+        m_Scale[iobj] = scale;
+
+        std::vector<double> &alpha = m_Alpha[iobj];
+        alpha.resize(n);
+        for(int i=0; i<n; i++) alpha[i] = (m_Y.at(i).at(iobj)-mean)/scale;
+        forwardSubstitute(m_L, n, alpha);
+        backSubstitute(m_L, n, alpha);
+    }
+
+    m_bTrained = true;
+    return true;
+}
+
+
+/**
+ * Predicts the fitnesses at the particle's position.
+ * @param sigma the relative standard deviation of the prediction, in [0,1].
+ */
+void Surrogate::predict(Particle const &particle, std::vector<double> &fitness, double &sigma) const
+{
+    fitness.resize(m_nObjectives);
+    if(!m_bTrained)
+    {
+        std::fill(fitness.begin(), fitness.end(), 0.0);
+        sigma = 1.0;
+        return;
+    }
+
+    int n = nSamples();
+    std::vector<double> x;
+    normalize(particle, x);
+
+    std::vector<double> k(n);
+    for(int i=0; i<n; i++) k[i] = kernel(x, m_X.at(i));
+
+    for(int iobj=0; iobj<m_nObjectives; iobj++)
+    {
+        double f = 0.0;
+        for(int i=0; i<n; i++) f += k.at(i)*m_Alpha.at(iobj).at(i);
+        fitness[iobj] = m_Mean.at(iobj) + m_Scale.at(iobj)*f;
+    }
+
+    forwardSubstitute(m_L, n, k);
+    double v = 0.0;
+    for(int i=0; i<n; i++) v += k.at(i)*k.at(i);
+    sigma = sqrt(std::max(0.0, 1.0+NUGGET-v));
+    sigma = std::min(sigma, 1.0);
+}
@@ -0,0 +1,79 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <vector>
+
+#include <api/optstructures.h>
+
+class Particle;
+
+/**
+ * @class Surrogate
+ * A Gaussian process model of the objective functions, trained on the particles which have been evaluated.
+ * The positions are normalized on the variable ranges, and the fitnesses are standardized for each objective.
+ * All the objectives share the same kernel, so that the model is factorized once for all of them.
+ * The predicted standard deviation is relative to the prior, i.e. 0 at a sample and close to 1 far from any sample.
+ */
+class Surrogate
+{
+    public:
+        Surrogate();
+
+        void clear();
+        void setVariables(std::vector<OptVariable> const &variables, int nObjectives);
+
+        void addSample(Particle const &particle);
+        int nSamples() const {return int(m_X.size());}
+
+        bool train();
+        bool isTrained() const {return m_bTrained;}
+
+        void predict(Particle const &particle, std::vector<double> &fitness, double &sigma) const;
+
+        static void setMaxSamples(int n) {s_MaxSamples=n;}
+        static int maxSamples() {return s_MaxSamples;}
+
+    private:
+        void normalize(Particle const &particle, std::vector<double> &x) const;
+        double kernel(std::vector<double> const &x0, std::vector<double> const &x1) const;
+
+    private:
+        int m_nObjectives;
+        std::vector<double> m_Min;                 /**< the lower bound of each variable */
+        std::vector<double> m_Range;               /**< the range of each variable, or 0 if the variable is inactive */
+
+        std::vector<std::vector<double>> m_X;      /**< the normalized positions of the samples */
+        std::vector<std::vector<double>> m_Y;      /**< the fitnesses of the samples */
+
+        bool m_bTrained;
+        double m_LengthScale;
+        std::vector<double> m_L;                   /**< the Cholesky factor of the kernel matrix, row major */
+        std::vector<std::vector<double>> m_Alpha;  /**< the weights of the samples for each objective */
+        std::vector<double> m_Mean, m_Scale;       /**< the standardization of each objective */
+
+        static int s_MaxSamples;                   /**< the oldest samples are discarded beyond this count */
+};
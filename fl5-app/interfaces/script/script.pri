@@ -4,6 +4,7 @@ HEADERS += \
     $$PWD/xflexecutor.h \
     $$PWD/xflscriptexec.h \
     $$PWD/xflscriptreader.h \
+    $$PWD/xflworker.h \
 
 
 
@@ -11,6 +12,7 @@ SOURCES += \
     $$PWD/xflexecutor.cpp \
     $$PWD/xflscriptexec.cpp \
     $$PWD/xflscriptreader.cpp \
+    $$PWD/xflworker.cpp \
 
 
 
@@ -31,17 +31,31 @@
 #include <QCoreApplication>
 #include <QFileInfo>
 #include <QDir>
+#include <QProcess>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
 
-#include <core/xflcore.h>
 #include <interfaces/script/xflexecutor.h>
+#include <interfaces/script/xflworker.h>
 
 #include <api/flow5events.h>
 #include <api/llttask.h>
+#include <api/numa.h>
 #include <api/objects3d.h>
+#include <api/panelanalysis.h>
 #include <api/planeopp.h>
 #include <api/planetask.h>
 #include <api/planexfl.h>
+#include <api/resultsink.h>
 #include <api/task3d.h>
+#include <api/threadpool.h>
 #include <api/trimesh.h>
 #include <api/planepolar.h>
 #include <modules/xplane/analysis/plpolarnamemaker.h>
@@ -60,6 +74,13 @@ XflExecutor::XflExecutor(QObject *pParent) : QObject()
     m_nTaskStarted = m_nTaskDone = 0;
     m_bMakePlaneOpps = false;
     m_bCompStabDerivatives = false;
+
+    m_WorkerRetries = 2;
+    m_WorkerTimeout = 0;
+    m_OppsPerUnit = 0;
+
+    m_MaxConcurrentTasks = 0;
+    m_bNumaPinning = false;
 }
 
 
@@ -92,6 +113,17 @@ void XflExecutor::clearArrays()
     m_T6Range.clear();
     m_T7Range.clear();
     m_T8Range.clear();
+
+    std::lock_guard<std::mutex> lock(m_RecordMutex);
+    m_TaskRecords.clear();
+}
+
+
+/** May be called from the threads of the tasks running concurrently */
+void XflExecutor::addTaskRecord(TaskRecord const &record)
+{
+    std::lock_guard<std::mutex> lock(m_RecordMutex);
+    m_TaskRecords.push_back(record);
 }
 
 
@@ -126,15 +158,19 @@ void XflExecutor::traceStdLog(std::string const &strMsg)
 
 void XflExecutor::traceLog(QString const &strMsg)
 {
-    if(m_bStdOutStream)
     {
-        std::cout<<strMsg.toStdString();
-    }
+        std::lock_guard<std::mutex> lock(m_LogMutex);
 
-    if(m_OutLogStream.device())
-    {
-        m_OutLogStream << strMsg;
-        m_OutLogStream.flush();
+        if(m_bStdOutStream)
+        {
+            std::cout<<strMsg.toStdString();
+        }
+
+        if(m_OutLogStream.device())
+        {
+            m_OutLogStream << strMsg;
+            m_OutLogStream.flush();
+        }
     }
 
     // rebroadcast the event in case we are running from the GUI
@@ -163,6 +199,16 @@ void XflExecutor::onCancel()
 
 /** Makes a PlanePolar object from the input file and sets the polar's name to be the file's name*/
 PlanePolar* XflExecutor::makeWPolar(QString const &fileName, QString const &xmlWPolarDirPath)
+{
+    QString log;
+    PlanePolar *pWPolar = readWPolar(fileName, xmlWPolarDirPath, log);
+    traceLog(log);
+    return pWPolar;
+}
+
+
+/** Reads a plane polar from its xml file; does not access the executor's state so that files can be read concurrently */
+PlanePolar* XflExecutor::readWPolar(QString const &fileName, QString const &xmlWPolarDirPath, QString &log)
 {
     QString pathName;
     QFile xmlFile;
@@ -184,8 +230,7 @@ PlanePolar* XflExecutor::makeWPolar(QString const &fileName, QString const &xmlW
 
     if (pathName.isEmpty() || !xmlFile.open(QIODevice::ReadOnly))
     {
-        QString strange = "   ...could not open the file: "+fileName;
-        traceLog(strange+"\n");
+        log += "   ...could not open the file: "+fileName+"\n";
         return nullptr;
     }
 
@@ -194,14 +239,9 @@ PlanePolar* XflExecutor::makeWPolar(QString const &fileName, QString const &xmlW
 
     if(xwpReader.hasError())
     {
-        QString strange = "   ...error reading the file: "+fileName;
-        traceLog(strange+"\n");
-
-        QString errorMsg;
-        errorMsg = xwpReader.errorString() + "\n";
-        strange = QString::asprintf("      error on line %d column %d\n", int(xwpReader.lineNumber()), int(xwpReader.columnNumber()));
-
-        traceLog(errorMsg+strange);
+        log += "   ...error reading the file: "+fileName+"\n";
+        log += xwpReader.errorString() + "\n";
+        log += QString::asprintf("      error on line %d column %d\n", int(xwpReader.lineNumber()), int(xwpReader.columnNumber()));
         return nullptr;
     }
 
@@ -212,6 +252,29 @@ PlanePolar* XflExecutor::makeWPolar(QString const &fileName, QString const &xmlW
 }
 
 
+/**
+ * Reads the plane polars of a list of xml files in parallel.
+ * The messages are output in the order of the files once all have been read.
+ * @return the polars in the order of the files, with a null pointer for each file which could not be read.
+ */
+QVector<PlanePolar*> XflExecutor::readWPolars(QStringList const &fileNames, QString const &xmlWPolarDirPath)
+{
+    int nFiles = int(fileNames.size());
+    QVector<PlanePolar*> wpolars(nFiles, nullptr);
+    QVector<QString> logs(nFiles);
+
+    ThreadPool::pool().parallelFor(nFiles, [&](int i)
+    {
+        wpolars[i] = readWPolar(fileNames.at(i), xmlWPolarDirPath, logs[i]);
+    });
+
+    for(int i=0; i<nFiles; i++)
+        if(!logs.at(i).isEmpty()) traceLog(logs.at(i));
+
+    return wpolars;
+}
+
+
 /** Making the WPolars for the script */
 void XflExecutor::makeWPolarArray(bool bRunAllPlaneAnalyses, QStringList &WPolarFileList,
                                   QString const &xmlWPolarDirPath, bool bRecursiveDirScan, QString &logmsg)
@@ -239,9 +302,11 @@ void XflExecutor::makeWPolarArray(bool bRunAllPlaneAnalyses, QStringList &WPolar
         }
     }
 
+    QVector<PlanePolar*> wpolars = readWPolars(WPolarFileList, xmlWPolarDirPath);
+
     for(int iwp=0; iwp<WPolarFileList.count(); iwp++)
     {
-        PlanePolar *pWPolar = makeWPolar(WPolarFileList.at(iwp), xmlWPolarDirPath);
+        PlanePolar *pWPolar = wpolars.at(iwp);
         if(pWPolar)
         {
             if(pWPolar->planeName().length())
@@ -351,13 +416,19 @@ void XflExecutor::makeWPolars(QMap<QString, bool> const&Analyses, QString const
         return;
     }
 
+    QStringList fileNames;
     QMapIterator<QString, bool> it(Analyses);
     while (it.hasNext())
     {
         it.next();
-        if(!it.value()) continue; //inactive
+        if(it.value()) fileNames.append(it.key()); // skip the inactive analyses
+    }
 
-        PlanePolar *pWPolar = makeWPolar(it.key(), xmlWPolarDirPath);
+    QVector<PlanePolar*> wpolars = readWPolars(fileNames, xmlWPolarDirPath);
+
+    for(int iwp=0; iwp<fileNames.size(); iwp++)
+    {
+        PlanePolar *pWPolar = wpolars.at(iwp);
 
         if(pWPolar)
         {
@@ -445,7 +516,7 @@ void XflExecutor::makeWPolars(QMap<QString, bool> const&Analyses, QString const
         }
         else
         {
-            logmsg += "   error reading the plane analysis file "+it.key()+ "\n";
+            logmsg += "   error reading the plane analysis file "+fileNames.at(iwp)+ "\n";
         }
     }
     logmsg += "\n";
@@ -704,51 +775,494 @@ void XflExecutor::runPlaneAnalyses()
     QString strong;
     m_AnalysisStatus = xfl::RUNNING;
 
-    // since each task makes use of all allowed threads,
-    // no point in parallelizing the tasks;
-    // each task is run in sequence asynchronously
+    // the operating points are streamed to the results file as they are computed,
+    // so that they need not be kept in memory and survive an interrupted run
+    FileResultSink sink;
+    if(!m_ResultsFilePath.isEmpty())
+    {
+        if(sink.open(m_ResultsFilePath.toStdString()))
+            traceLog("Writing the operating points to the results file "+m_ResultsFilePath+"\n\n");
+        else
+            traceLog("Could not open the results file "+m_ResultsFilePath+"\n\n");
+    }
+
+    // the plane tasks are either dispatched to the worker processes,
+    // or run in this process, several at a time if the thread budget allows
+    bool bDistributed = !m_Workers.isEmpty();
+    if(bDistributed) runDistributedAnalyses(sink.isOpen() ? &sink : nullptr);
+
+    runConcurrentAnalyses(sink.isOpen() ? &sink : nullptr, bDistributed);
+
+    if(sink.isOpen())
+        traceLog(QString::asprintf("%d operating points written to the results file\n\n", sink.nRecords()));
+    sink.close();
+
+    m_AnalysisStatus = xfl::FINISHED;
+
+//    qApp->postEvent(m_pEventDest, new QEvent(TASK3D_END_EVENT));
+}
 
+
+/**
+ * An estimate of the number of floating point operations of the task, used to order the tasks and to share the threads.
+ * The panel methods are dominated by the factorization of the influence matrix, of order N^3,
+ * and by the back-substitutions and the matrix-vector products of each operating point, of order N^2.
+ */
+double XflExecutor::taskCost(Task3d *pTask)
+{
+    if(PlaneTask *pPlaneTask = dynamic_cast<PlaneTask*>(pTask))
+    {
+        PlanePolar const *pWPolar = pPlaneTask->wPolar();
+        Plane const *pPlane = pPlaneTask->plane();
+        PlaneXfl const *pPlaneXfl = dynamic_cast<PlaneXfl const*>(pPlane);
+
+        double N = 0.0;
+        if(!pPlaneXfl)                        N = pPlane->nPanel3();
+        else if(pWPolar->isVLM())             N = pPlaneXfl->VLMPanelTotal();
+        else if(pWPolar->isQuadMethod())      N = pPlaneXfl->quadCount();
+        else if(pWPolar->isTriangleMethod())  N = pPlaneXfl->triangleCount();
+        N = std::max(N, 1.0);
+
+        double nOpps = 0.0;
+        switch(pWPolar->type())
+        {
+            case xfl::T6POLAR: nOpps = pPlaneTask->ctrlOppList().size(); break;
+            case xfl::T7POLAR: nOpps = pPlaneTask->stabOppList().size(); break;
+            case xfl::T8POLAR: nOpps = pPlaneTask->t8OppList().size();   break;
+            default:           nOpps = pPlaneTask->oppList().size();     break;
+        }
+
+        // the T6 and T7 polars rebuild the matrix for each control value
+        if(pWPolar->isType6() || pWPolar->isType7()) return nOpps * (N*N*N/3.0 + N*N);
+        return N*N*N/3.0 + nOpps*N*N;
+    }
+    else if(LLTTask *pLLTTask = dynamic_cast<LLTTask*>(pTask))
+    {
+        double N = LLTTask::nSpanStations();
+        return double(pLLTTask->oppList().size()) * N*N * 100.0; // ~100 non-linear iterations per point
+    }
+    return 0.0;
+}
+
+
+/**
+ * The number of threads allotted to the task in a budget of nThreads. The dense kernels
+ * scale well only if each thread has a sufficient number of matrix rows, so that
+ * the small tasks are run on few threads, and the large tasks on the whole budget.
+ */
+int XflExecutor::taskThreadCount(Task3d *pTask, int nThreads)
+{
+    int const ROWSPERTHREAD = 500;
+
+    if(dynamic_cast<LLTTask*>(pTask)) return 1;
+
+    double N = std::cbrt(3.0*taskCost(pTask)); // about the matrix size for the steady polars
+    return std::max(1, std::min(nThreads, int(N)/ROWSPERTHREAD));
+}
+
+
+/**
+ * Runs the tasks of m_PlaneExecList in this process.
+ * The tasks are launched by decreasing estimated cost, so that the longest tasks do not end up
+ * running last on an otherwise idle machine. Each task is allotted a number of threads for its inner
+ * kernels; a task is launched as soon as the threads it needs are available, and a smaller task
+ * may be launched ahead of a larger one to fill the remaining threads.
+ * Since the tasks build their meshes in the plane object, two tasks on the same plane are never run at the same time.
+ * With NUMA pinning, each task runs on the node with the fewest running tasks, so that its matrix is allocated
+ * and factorized within the node.
+ * @param bSkipPlaneTasks true if the PlaneTasks have been run by the distributed workers.
+ */
+void XflExecutor::runConcurrentAnalyses(ResultSink *pSink, bool bSkipPlaneTasks)
+{
+    int nThreads = PanelAnalysis::bMultiThread() ? ThreadPool::maxThreadCount() : 1;
+    int nMaxRunning = m_MaxConcurrentTasks>0 ? m_MaxConcurrentTasks : nThreads;
+
+    struct Job
+    {
+        int m_iTask{-1};
+        double m_Cost{0.0};
+        int m_nThreads{1};
+        Plane const *m_pPlane{nullptr};
+        bool m_bStarted{false};
+    };
+
+    std::vector<Job> jobs;
     for(int ia=0; ia<m_PlaneExecList.size(); ia++)
     {
         Task3d *pTask = m_PlaneExecList.at(ia);
-//        pTask->setEventDestination(m_pEventDest); // send messages straight to the parent dialog or window
-//        pTask->setEventDestination(nullptr);
-//        connect(pTask, &Task3d::outputMessage, this, &XflExecutor::traceLog);
-//        connect(this, SIGNAL(cancelTask()), pTask, SLOT(onCancel()));
+        if(!pTask) continue;
+        if(bSkipPlaneTasks && dynamic_cast<PlaneTask*>(pTask)) continue;
+
+        Job job;
+        job.m_iTask = ia;
+        job.m_Cost = taskCost(pTask);
+        if     (PlaneTask *pPlaneTask = dynamic_cast<PlaneTask*>(pTask)) job.m_pPlane = pPlaneTask->plane();
+        else if(LLTTask   *pLLTTask   = dynamic_cast<LLTTask*>(pTask))   job.m_pPlane = pLLTTask->plane();
+        jobs.push_back(job);
+    }
+    if(jobs.empty()) return;
+
+    std::stable_sort(jobs.begin(), jobs.end(), [](Job const &a, Job const &b) {return a.m_Cost>b.m_Cost;});
+
+    if(nMaxRunning<=1 || jobs.size()==1)
+    {
+        // each task makes use of all the allowed threads
+        for(Job const &job : jobs)
+        {
+            m_PlaneExecList.at(job.m_iTask)->setThreadCount(0);
+            runTask(job.m_iTask, pSink);
+            if(isCancelled()) break;
+        }
+        return;
+    }
+
+    for(Job &job : jobs) job.m_nThreads = taskThreadCount(m_PlaneExecList.at(job.m_iTask), nThreads);
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    int nFreeThreads = nThreads;
+    int nRunning = 0;
+    std::vector<Plane const*> busyplanes;
+    std::vector<std::thread> threads;
+
+    int nNodes = m_bNumaPinning ? Numa::nNodes() : 1;
+    bool bNumaAware = ThreadPool::isNumaAware();
+    if(nNodes>1) ThreadPool::setNumaAware(true);
+    std::vector<int> nodetasks(nNodes, 0);
+
+    std::unique_lock<std::mutex> lock(mtx);
+    int nStarted = 0;
+    while(nStarted<int(jobs.size()) && !isCancelled())
+    {
+        // the largest pending job which fits in the free threads; a job always starts if nothing is running
+        Job *pNext = nullptr;
+        if(nRunning<nMaxRunning)
+        {
+            for(Job &job : jobs)
+            {
+                if(job.m_bStarted) continue;
+                if(std::find(busyplanes.begin(), busyplanes.end(), job.m_pPlane)!=busyplanes.end()) continue;
+                if(job.m_nThreads<=nFreeThreads || nRunning==0)
+                {
+                    pNext = &job;
+                    break;
+                }
+            }
+        }
+
+        if(!pNext)
+        {
+            cv.wait(lock);
+            continue;
+        }
+
+        pNext->m_bStarted = true;
+        nStarted++;
+        nRunning++;
+        nFreeThreads -= pNext->m_nThreads;
+        busyplanes.push_back(pNext->m_pPlane);
 
-        if(pTask)
+        int node = -1;
+        if(nNodes>1)
         {
-            pTask->setKeepOpps(m_bMakePlaneOpps);
+            node = int(std::min_element(nodetasks.begin(), nodetasks.end())-nodetasks.begin());
+            nodetasks[node]++;
         }
 
-        PlaneTask *pPlaneTask = dynamic_cast<PlaneTask*>(pTask);
-        LLTTask *pLLTTask = dynamic_cast<LLTTask*>(pTask);
+        Job job = *pNext;
+        m_PlaneExecList.at(job.m_iTask)->setThreadCount(job.m_nThreads);
+        threads.push_back(std::thread([this, job, node, pSink, &mtx, &cv, &nFreeThreads, &nRunning, &busyplanes, &nodetasks]()
+        {
+            if(node>=0) Numa::pinCurrentThread(node);
+
+            runTask(job.m_iTask, pSink);
+
+            std::lock_guard<std::mutex> donelock(mtx);
+            nFreeThreads += job.m_nThreads;
+            nRunning--;
+            if(node>=0) nodetasks[node]--;
+            busyplanes.erase(std::find(busyplanes.begin(), busyplanes.end(), job.m_pPlane));
+            cv.notify_all();
+        }));
+    }
+    lock.unlock();
+
+    for(std::thread &th : threads) th.join();
+
+    if(nNodes>1) ThreadPool::setNumaAware(bNumaAware);
+}
+
+
+/** Runs the task m_PlaneExecList[iTask] and reports its completion; may be called concurrently for tasks on different planes */
+void XflExecutor::runTask(int iTask, ResultSink *pSink)
+{
+    QString strong;
+    Task3d *pTask = m_PlaneExecList.at(iTask);
+    if(!pTask) return;
+
+    pTask->setKeepOpps(m_bMakePlaneOpps);
+    pTask->setResultSink(pSink);
+
+    PlaneTask *pPlaneTask = dynamic_cast<PlaneTask*>(pTask);
+    LLTTask *pLLTTask = dynamic_cast<LLTTask*>(pTask);
+
+    TaskRecord record;
+    record.m_Type = "plane";
+    record.m_nThreads = pTask->threadCount();
+    auto start = std::chrono::steady_clock::now();
+
+    if(pPlaneTask)
+    {
+        record.m_Name = QString::fromStdString(pPlaneTask->plane()->name()) + " / " + QString::fromStdString(pPlaneTask->wPolar()->name());
+        strong = "Launching plane analysis: " + QString::fromStdString(pPlaneTask->plane()->name()) + " / " + QString::fromStdString(pPlaneTask->wPolar()->name()) + "\n";
+        if(pTask->threadCount()>0) strong += QString::asprintf("   running on %d threads\n", pTask->threadCount());
+        traceLog(strong);
+
+        emit taskStarted(iTask);
+        runPanelTask(pPlaneTask);
+        record.m_Profile = pPlaneTask->profile().toJson();
+        cleanUpPlaneTask(pPlaneTask);
+    }
+    else if(pLLTTask)
+    {
+        record.m_Name = QString::fromStdString(pLLTTask->plane()->name()) + " / " + QString::fromStdString(pLLTTask->wPolar()->name());
+        strong = "Launching plane analysis: " + QString::fromStdString(pLLTTask->plane()->name()) + " / " + QString::fromStdString(pLLTTask->wPolar()->name()) + "\n";
+        traceLog(strong);
+
+        emit taskStarted(iTask);
+        runLLTTask(pLLTTask);
+
+        cleanUpLLTTask(pLLTTask);
+    }
+    pTask->setResultSink(nullptr);
+
+    record.m_Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    record.m_PeakMemory = xfl::peakMemoryUsage();
+    if     (pTask->isCancelled()) record.m_Status = "cancelled";
+    else if(pTask->hasErrors())   record.m_Status = "errors";
+    else                          record.m_Status = "ok";
+    addTaskRecord(record);
+}
+
+
+/**
+ * Runs the plane tasks on worker processes, e.g. on the nodes of a cluster.
+ * The operating points of each task are split into work units, which are dispatched to the first idle worker.
+ * Each worker is served by a thread which launches one process per unit, writes the request on the process'
+ * standard input and reads the resulting operating points on its standard output.
+ * A unit whose process fails to start, crashes, times out or returns an invalid response is resubmitted
+ * up to m_WorkerRetries times.
+ * The operating points are merged in the polars, in the project and in the sink by the calling thread only.
+ */
+void XflExecutor::runDistributedAnalyses(ResultSink *pSink)
+{
+    using XflWorker::WorkUnit;
+
+    int nWorkers = int(m_Workers.size());
+    int nTasks = int(m_PlaneExecList.size());
 
-        if(pPlaneTask)
+    // make the requests
+    std::vector<QByteArray> headers(nTasks);
+    std::deque<WorkUnit> queue;
+    for(int it=0; it<nTasks; it++)
+    {
+        PlaneTask *pPlaneTask = dynamic_cast<PlaneTask*>(m_PlaneExecList.at(it));
+        if(!pPlaneTask) continue;
+
+        PlanePolar *pWPolar = pPlaneTask->wPolar();
+        headers[it] = XflWorker::makeTaskHeader(pPlaneTask->plane(), pWPolar, pPlaneTask->bComputeDerivatives());
+
+        std::vector<double> values;
+        std::vector<T8Opp> t8opps;
+        switch(pWPolar->type())
         {
-            strong = "Launching plane analysis: " + QString::fromStdString(pPlaneTask->plane()->name()) + " / " + QString::fromStdString(pPlaneTask->wPolar()->name()) + "\n";
-            traceLog(strong);
+            case xfl::T6POLAR: values = pPlaneTask->ctrlOppList(); break;
+            case xfl::T7POLAR: values = pPlaneTask->stabOppList(); break;
+            case xfl::T8POLAR: t8opps = pPlaneTask->t8OppList();   break;
+            default:           values = pPlaneTask->oppList();     break;
+        }
 
-            emit taskStarted(ia);
-            runPanelTask(pPlaneTask);
-            cleanUpPlaneTask(pPlaneTask);
+        int nOpps = int(values.size()+t8opps.size());
+        int chunk = m_OppsPerUnit>0 ? m_OppsPerUnit : (nOpps+nWorkers-1)/nWorkers;
+        chunk = std::max(chunk, 1);
+        for(int i0=0; i0<nOpps; i0+=chunk)
+        {
+            int i1 = std::min(nOpps, i0+chunk);
+            WorkUnit unit;
+            unit.m_iTask = it;
+            if(t8opps.size()) unit.m_T8Opps.assign(t8opps.begin()+i0, t8opps.begin()+i1);
+            else              unit.m_Values.assign(values.begin()+i0, values.begin()+i1);
+            queue.push_back(unit);
         }
-        else if(pLLTTask)
+    }
+
+    int nUnits = int(queue.size());
+    traceLog(QString::asprintf("Dispatching %d work units to %d workers\n\n", nUnits, nWorkers));
+
+    std::mutex mtx;
+    int nInFlight = 0;
+    std::vector<std::pair<WorkUnit, std::vector<PlaneOpp*>>> done;
+    QStringList messages;
+    std::vector<int> nFailedUnits(nTasks, 0), nErrorUnits(nTasks, 0);
+
+    auto workerLoop = [&](int iWorker)
+    {
+        QStringList args = QProcess::splitCommand(m_Workers.at(iWorker));
+        QString program;
+        if(args.isEmpty() || args.front().compare("local", Qt::CaseInsensitive)==0)
         {
-            strong = "Launching plane analysis: " + QString::fromStdString(pLLTTask->plane()->name()) + " / " + QString::fromStdString(pLLTTask->wPolar()->name()) + "\n";
-            traceLog(strong);
+            if(!args.isEmpty()) args.removeFirst();
+            program = QCoreApplication::applicationFilePath();
+            // only the GUI application consumes the platform option; fl5-cli would reject it
+            if(QCoreApplication::instance() && QCoreApplication::instance()->inherits("QGuiApplication"))
+            {
+                args.prepend("offscreen");
+                args.prepend("-platform");
+            }
+        }
+        else
+            program = args.takeFirst();
+        args.append("-w");
 
-            emit taskStarted(ia);
-            runLLTTask(pLLTTask);
+        while(true)
+        {
+            WorkUnit unit;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if(isCancelled() || (queue.empty() && nInFlight==0)) return;
+                if(!queue.empty())
+                {
+                    unit = queue.front();
+                    queue.pop_front();
+                    nInFlight++;
+                }
+            }
+            if(unit.m_iTask<0)
+            {
+                // the units in flight may still fail and be resubmitted
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                continue;
+            }
+
+            QString failure;
+            bool bErrors = false;
+            std::vector<PlaneOpp*> popps;
+
+            QProcess process;
+            process.setProcessChannelMode(QProcess::SeparateChannels);
+            process.start(program, args);
+            if(!process.waitForStarted(30000))
+                failure = "could not be started";
+            else
+            {
+                process.write(XflWorker::makeRequest(headers.at(unit.m_iTask), unit));
+                process.closeWriteChannel();
+
+                auto start = std::chrono::steady_clock::now();
+                bool bFinished = false;
+                while(!bFinished)
+                {
+                    bFinished = process.waitForFinished(500);
+                    if(bFinished) break;
+                    int elapsed = int(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now()-start).count());
+                    if(isCancelled() || process.state()==QProcess::NotRunning || (m_WorkerTimeout>0 && elapsed>m_WorkerTimeout)) break;
+                }
+
+                if(!bFinished && process.state()!=QProcess::NotRunning)
+                {
+                    process.kill();
+                    process.waitForFinished();
+                    failure = isCancelled() ? "was cancelled" : "timed out";
+                }
+                else if(process.exitStatus()!=QProcess::NormalExit || process.exitCode()!=0)
+                    failure = "crashed or exited with an error";
+                else if(!XflWorker::readResponse(process.readAllStandardOutput(), popps, bErrors))
+                    failure = "returned an invalid response";
+            }
 
-            cleanUpLLTTask(pLLTTask);
+            std::lock_guard<std::mutex> lock(mtx);
+            nInFlight--;
+            if(failure.isEmpty())
+            {
+                if(bErrors) nErrorUnits[unit.m_iTask]++;
+                done.push_back({unit, popps});
+            }
+            else
+            {
+                unit.m_nAttempts++;
+                QString strange = QString::asprintf("   Worker %d: the unit of %d operating points of task %d ", iWorker, unit.nOpps(), unit.m_iTask) + failure;
+                if(unit.m_nAttempts<=m_WorkerRetries && !isCancelled())
+                {
+                    strange += ", resubmitting\n";
+                    queue.push_back(unit);
+                }
+                else
+                {
+                    strange += ", abandoning\n";
+                    nFailedUnits[unit.m_iTask]++;
+                }
+                messages.append(strange);
+            }
         }
-        if(isCancelled()) break;
+    };
+
+    std::vector<std::thread> threads;
+    for(int iw=0; iw<nWorkers; iw++) threads.push_back(std::thread(workerLoop, iw));
+
+    int nMerged = 0;
+    auto mergeResults = [&]()
+    {
+        std::vector<std::pair<WorkUnit, std::vector<PlaneOpp*>>> results;
+        QStringList msgs;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            results.swap(done);
+            msgs.swap(messages);
+        }
+        for(QString const &msg : msgs) traceLog(msg);
+
+        for(auto &result : results)
+        {
+            PlaneTask *pPlaneTask = dynamic_cast<PlaneTask*>(m_PlaneExecList.at(result.first.m_iTask));
+            PlanePolar *pWPolar = pPlaneTask->wPolar();
+            for(PlaneOpp *pPOpp : result.second)
+            {
+                // same as PlaneTask::storePOpp()
+                if(!pPOpp->isOut()) pWPolar->addPlaneOpPointData(pPOpp);
+                if(pSink) pSink->addPlaneOpp(pPOpp);
+                if(m_bMakePlaneOpps) Objects3d::insertPlaneOpp(pPOpp);
+                else                 delete pPOpp;
+            }
+            nMerged++;
+            traceLog(QString::asprintf("   %d/%d: ", nMerged, nUnits) + QString::fromStdString(pPlaneTask->plane()->name()) + " / " +
+                     QString::fromStdString(pWPolar->name()) + QString::asprintf(", %d operating points\n", int(result.second.size())));
+        }
+    };
+
+    while(true)
+    {
+        mergeResults();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if(isCancelled() || (queue.empty() && nInFlight==0)) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
 
-    m_AnalysisStatus = xfl::FINISHED;
+    for(std::thread &t : threads) t.join();
+    mergeResults();
 
-//    qApp->postEvent(m_pEventDest, new QEvent(TASK3D_END_EVENT));
+    for(int it=0; it<nTasks; it++)
+    {
+        PlaneTask *pPlaneTask = dynamic_cast<PlaneTask*>(m_PlaneExecList.at(it));
+        if(!pPlaneTask) continue;
+        QString strong = "\n" + QString::fromStdString(pPlaneTask->plane()->name()) + " / " + QString::fromStdString(pPlaneTask->wPolar()->name());
+        if(nFailedUnits.at(it))     strong += QString::asprintf(": %d work units failed\n", nFailedUnits.at(it));
+        else if(nErrorUnits.at(it)) strong += ": completed ... Errors encountered\n";
+        else                        strong += ": completed successfully\n";
+        traceLog(strong);
+    }
+    traceLog("\n");
 }
 
 
@@ -26,8 +26,13 @@
 
 #include <QObject>
 #include <QFile>
+#include <QMap>
 #include <QTextStream>
 
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include <api/analysisrange.h>
 #include <api/t8opp.h>
@@ -39,6 +44,21 @@ class PlanePolar;
 class LLTTask;
 class PlaneTask;
 class Task3d;
+class ResultSink;
+
+
+/** The wall time and memory high-water mark of a completed task, for the run reports */
+struct TaskRecord
+{
+    QString m_Type;            /**< "foil", "plane" or "boat" */
+    QString m_Name;            /**< the object and polar names */
+    QString m_Status;          /**< "ok", "errors" or "cancelled" */
+    double m_Seconds{0.0};     /**< the wall time of the task */
+    size_t m_PeakMemory{0};    /**< the process' peak resident memory in bytes at the end of the task */
+    int m_nThreads{0};         /**< the threads allotted to the task, or 0 if all */
+    std::string m_Profile;     /**< the phase timers and counters of the panel tasks as JSON, cf. TaskProfile::toJson() */
+};
+
 
 class XflExecutor : public QObject
 {
@@ -65,6 +85,8 @@ class XflExecutor : public QObject
         void closeLogFile();
 
         PlanePolar *makeWPolar(const QString &pathName, const QString &xmlWPolarDirPath);
+        static PlanePolar *readWPolar(QString const &fileName, QString const &xmlWPolarDirPath, QString &log);
+        QVector<PlanePolar*> readWPolars(QStringList const &fileNames, QString const &xmlWPolarDirPath);
         void makePlaneTasks(QString &logmsg);
 
         void setPlanes(QList<Plane*> &planes) {m_oaPlane=planes;}
@@ -79,14 +101,34 @@ class XflExecutor : public QObject
         void cleanUpPlaneTask(PlaneTask *pPlaneTask);
 
         void runPlaneAnalyses();
+        void runDistributedAnalyses(ResultSink *pSink);
+        void runConcurrentAnalyses(ResultSink *pSink, bool bSkipPlaneTasks);
+        void runTask(int iTask, ResultSink *pSink);
 
         void setMakePOpps(bool b) {m_bMakePlaneOpps=b;}
+        /** Sets the file to which the plane operating points are written as they are computed; empty to disable */
+        void setResultsFile(QString const &pathname) {m_ResultsFilePath=pathname;}
         void setStabDerivatives(bool b) {m_bCompStabDerivatives=b;}
 
+        /** Sets the commands which launch the worker processes of a distributed run, one per worker;
+         *  "local" launches this executable on the local host. The plane analyses run in this process if the list is empty. */
+        void setWorkers(QStringList const &launchers) {m_Workers=launchers;}
+        void setWorkerSettings(int maxretries, int timeout_s, int oppsperunit) {m_WorkerRetries=maxretries; m_WorkerTimeout=timeout_s; m_OppsPerUnit=oppsperunit;}
+
+        /** Sets the max. number of plane tasks run at the same time in this process; 0 to decide from the task costs, 1 to run them in sequence */
+        void setMaxConcurrentTasks(int nmax) {m_MaxConcurrentTasks=std::max(0, nmax);}
+        /** If true, each of the tasks run at the same time is pinned to one NUMA node with its share of the thread pool;
+         *  has no effect on a single node host */
+        void setNumaPinning(bool bPin) {m_bNumaPinning=bPin;}
+
         QList<PlanePolar*> const & wPolars() const {return m_oaWPolar;}
         QList<Plane*> const& planes() const {return m_oaPlane;}
         QList<Task3d*> &planeTasks() {return m_PlaneExecList;}
 
+        /** The records of the tasks completed since the last call to clearArrays(), in the order of completion */
+        std::vector<TaskRecord> const &taskRecords() const {return m_TaskRecords;}
+        void addTaskRecord(TaskRecord const &record);
+
         void setT12Range(QVector<AnalysisRange> const&range) {m_T12Range=range;}
         void setT3Range( QVector<AnalysisRange> const&range) {m_T3Range =range;}
         void setT5Range( QVector<AnalysisRange> const&range) {m_T5Range =range;}
@@ -96,6 +138,9 @@ class XflExecutor : public QObject
 
         virtual void clearArrays();
 
+        static double taskCost(Task3d *pTask);
+        static int taskThreadCount(Task3d *pTask, int nThreads);
+
     signals:
         void outputMessage(const QString &msg) const;
         void cancelTask();
@@ -119,6 +164,20 @@ class XflExecutor : public QObject
         bool m_bMakePlaneOpps;
         bool m_bCompStabDerivatives;
 
+        QString m_ResultsFilePath;
+
+        QStringList m_Workers;    /**< the launch commands of the worker processes */
+        int m_WorkerRetries;      /**< the max. number of times a failed work unit is resubmitted */
+        int m_WorkerTimeout;      /**< the max. duration of a work unit in seconds, or 0 if unlimited */
+        int m_OppsPerUnit;        /**< the max. number of operating points sent to a worker at once, or 0 to split each task evenly between the workers */
+
+        int m_MaxConcurrentTasks; /**< the max. number of tasks run at the same time, or 0 if only limited by the thread budget */
+        bool m_bNumaPinning;      /**< true if the concurrent tasks are each pinned to a NUMA node */
+        std::mutex m_LogMutex;    /**< serializes the log output of the tasks running concurrently */
+
+        std::vector<TaskRecord> m_TaskRecords;
+        std::mutex m_RecordMutex;
+
         int m_nTaskStarted, m_nTaskDone;
 
         xfl::enumAnalysisStatus m_AnalysisStatus;
@@ -27,13 +27,14 @@
 
 
 #include <QCoreApplication>
-#include <QtConcurrent/QtConcurrentRun>
-#include <QFutureSynchronizer>
 #include <QFileInfo>
 #include <QDir>
 #include <QDateTime>
 #include <QThreadPool>
 
+#include <chrono>
+#include <vector>
+
 
 #include "xflscriptexec.h"
 
@@ -57,22 +58,23 @@
 #include <api/planexfl.h>
 #include <api/polar.h>
 #include <api/sailobjects.h>
+#include <api/taskcheckpoint.h>
 #include <api/utils.h>
 #include <api/planepolar.h>
+#include <api/xfoilbatchengine.h>
 #include <api/xfoiltask.h>
+#include <api/xdmfwriter.h>
 #include <api/xmlboatreader.h>
 #include <api/xmlbtpolarreader.h>
 #include <api/xmlplanereader.h>
 #include <api/xmlpolarreader.h>
 #include <api/xmlplanepolarreader.h>
 
-#include <core/xflcore.h>
-#include <globals/mainframe.h>
 #include <modules/xdirect/analysis/polarnamemaker.h>
-#include <modules/xobjects.h>
 #include <modules/xplane/analysis/plpolarnamemaker.h>
 
 QThread::Priority XflScriptExec::s_ThreadPriority = QThread::NormalPriority;
+int XflScriptExec::s_LineWidth = 2;
 
 
 XflScriptExec::XflScriptExec() : XflExecutor()
@@ -390,10 +392,10 @@ bool XflScriptExec::loadXFoilPolarFiles()
 
         XFoilFile.setFileName(XFoilPolarList.at(ifo));
 
-        Polar *pPolar = Objects3d::importXFoilPolar(XFoilFile, logmsg);
+        Polar *pPolar = objects::importXFoilPolar(XFoilFile, logmsg);
         if(pPolar)
         {
-            pPolar->setLineWidth(Curve::defaultLineWidth());
+            pPolar->setLineWidth(s_LineWidth);
             QString foilname = QString::fromStdString(pPolar->foilName());
             Foil *pFoil = Objects2d::foil(foilname.toStdString());
             if(!pFoil)
@@ -477,7 +479,7 @@ bool XflScriptExec::makeFoils()
             Foil *pFoil = new Foil();
             if(objects::readFoilFile(datPathName.toStdString(), pFoil, iLineError))
             {
-                pFoil->setLineWidth(Curve::defaultLineWidth());
+                pFoil->setLineWidth(s_LineWidth);
                 pFoil->setLineColor(xfl::randomfl5Color());
                 if(m_pScriptReader->m_bRepanelFoils)
                 {
@@ -675,7 +677,7 @@ bool XflScriptExec::preLoadProject()
 
     if(fi.suffix().toLower()=="fl5")
     {
-        bRead = loader.serializeProjectFl5(ar, false);
+        bRead = loader.loadProjectFl5(XFile);
     }
     else if (fi.suffix().toLower()=="xfl")
     {
@@ -793,6 +795,19 @@ bool XflScriptExec::runScript(QString const &scriptpath)
     PanelAnalysis::setDoublePrecision(m_pScriptReader->m_bDoublePrecision);
 
     m_bMakePlaneOpps = m_pScriptReader->bMakePlaneOpps();
+    setWorkers(m_pScriptReader->workers());
+    setWorkerSettings(m_pScriptReader->workerRetries(), m_pScriptReader->workerTimeout(), m_pScriptReader->oppsPerWorkerUnit());
+    setMaxConcurrentTasks(m_pScriptReader->maxConcurrentTasks());
+    setNumaPinning(m_pScriptReader->bNumaPinning());
+    TaskCheckpoint::setEnabled(m_pScriptReader->bCheckpoints());
+    if(m_pScriptReader->bCheckpoints())
+    {
+        // in the output directory, so that running the script again resumes the interrupted analyses
+        TaskCheckpoint::setDirectory((m_OutputPath + QDir::separator() + "checkpoints").toStdString());
+        TaskCheckpoint::setInterval(m_pScriptReader->checkpointInterval());
+    }
+    if(m_pScriptReader->bStreamPlaneOpps())
+        setResultsFile(m_OutputPath + QDir::separator() + fi.baseName() + "_oppoints.fl5r");
     runPlaneAnalyses();
     if(isCancelled()) return false;
 
@@ -901,36 +916,55 @@ void XflScriptExec::runFoilAnalyses()
     }
     QThreadPool::globalInstance()->waitForDone();*/
 
-    QFutureSynchronizer<void> futureSync;
+    XFoilBatchEngine engine;
+    engine.setWorkerCount(m_nThreads);
 
     for(int i=0; i<m_FoilExecList.size(); i++)
     {
-        XFoilTask *pXFoilTask = new XFoilTask();
-//        pXFoilTask->setEventDestination(this);
-        //take the last analysis in the array
         FoilAnalysis *pAnalysis = m_FoilExecList.at(i);
 
         pAnalysis->m_pPolar->setVisible(true);
 
-        //initiate the task
+        XFoilJob job;
+        job.m_pFoil  = &pAnalysis->m_Foil;
+        job.m_pPolar = pAnalysis->m_pPolar;
         if(pAnalysis->m_pPolar->isType12())
-            pXFoilTask->setAnalysisRanges(pAnalysis->range);
-        pXFoilTask->initialize(pAnalysis, false);
+            job.m_Ranges = pAnalysis->range;
+        engine.addJob(job);
+    }
 
+    // the callbacks are serialized by the engine
+    std::vector<std::chrono::steady_clock::time_point> starttimes(m_FoilExecList.size());
+    engine.setStartCallback([this, &starttimes](XFoilJob const &job, int iJob)
+    {
         m_nTaskStarted++;
-        std::string str = "Starting "+ pAnalysis->m_Foil.name()+" / "+ pAnalysis->m_pPolar->name()+"\n";
-        traceStdLog(str);
+        starttimes[iJob] = std::chrono::steady_clock::now();
+        traceStdLog("Starting "+ job.m_pFoil->name()+" / "+ job.m_pPolar->name()+"\n");
+    });
 
-
-
-#if (QT_VERSION >= QT_VERSION_CHECK(6,0,0))
-        futureSync.addFuture(QtConcurrent::run(&XFoilTask::run, pXFoilTask));
-#else
-        QtConcurrent::run(pXFoilTask, &XFoilTask::run);
-#endif
-    }
-
-    futureSync.waitForFinished();
+    engine.setResultCallback([this, &starttimes](XFoilJobResult &result)
+    {
+        // the operating points are not requested, but are owned by the receiver of the result
+        for(OpPoint *pOpp : result.m_OpPoints) delete pOpp;
+        result.m_OpPoints.clear();
+
+        if(!result.m_pFoil || !result.m_pPolar) return;
+
+        TaskRecord record;
+        record.m_Type = "foil";
+        record.m_Name = QString::fromStdString(result.m_pFoil->name()) + " / " + QString::fromStdString(result.m_pPolar->name());
+        std::chrono::steady_clock::time_point const &start = starttimes[result.m_iJob];
+        if(start.time_since_epoch().count()>0) // jobs cancelled before their start have no start time
+            record.m_Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        record.m_PeakMemory = xfl::peakMemoryUsage();
+        record.m_nThreads = 1;
+        if     (result.m_bCancelled) record.m_Status = "cancelled";
+        else if(result.m_bErrors)    record.m_Status = "errors";
+        else                         record.m_Status = "ok";
+        addTaskRecord(record);
+    });
+
+    engine.run();
 
     cleanUpFoilAnalyses();
     if(isCancelled()) strong = "\n_____Foil analysis cancelled_____\n";
@@ -1004,6 +1038,69 @@ bool XflScriptExec::makeExportDirectories()
 }
 
 
+/** Writes the operating points of each plane and boat polar to an XDMF time series in the directory dirpath/plane_or_boat_name */
+bool XflScriptExec::exportOppsToXdmf(QString const &dirpath)
+{
+    bool bOK = true;
+    XdmfWriter writer;
+    QuadMesh emptyquadmesh;
+
+    auto writeSeries = [&](fl5Object const *pObject, QuadMesh const &quadmesh, std::string const &polarname, std::vector<Opp3d const*> const &opps)
+    {
+        if(opps.empty()) return;
+        QString objdirpath = dirpath + QDir::separator() + QString::fromStdString(pObject->name());
+        QDir objdir(objdirpath);
+        if(!objdir.exists() && !objdir.mkpath(objdirpath))
+        {
+            traceLog("Could not make the directory: "+objdirpath+"\n");
+            bOK = false;
+            return;
+        }
+        QString basename = QString::fromStdString(polarname);
+        basename.replace('/', '_').replace('.', '_');
+        if(writer.write(objdirpath.toStdString(), basename.toStdString(), pObject->triMesh(), quadmesh, opps))
+            traceLog("   exported "+QString::asprintf("%d", writer.nWritten())+" operating points of "+QString::fromStdString(pObject->name())+" / "+QString::fromStdString(polarname)+"\n");
+        else bOK = false;
+        if(writer.log().length()) traceLog(QString::fromStdString(writer.log()));
+    };
+
+    for(int iw=0; iw<Objects3d::nPolars(); iw++)
+    {
+        PlanePolar const *pWPolar = Objects3d::plPolarAt(iw);
+        Plane const *pPlane = Objects3d::plane(pWPolar->planeName());
+        if(!pPlane) continue;
+
+        std::vector<Opp3d const*> opps;
+        for(int io=0; io<Objects3d::nPOpps(); io++)
+        {
+            PlaneOpp const *pPOpp = Objects3d::POppAt(io);
+            if(pPOpp->planeName()==pPlane->name() && pPOpp->polarName()==pWPolar->name()) opps.push_back(pPOpp);
+        }
+
+        PlaneXfl const *pPlaneXfl = dynamic_cast<PlaneXfl const*>(pPlane);
+        writeSeries(pPlane, pPlaneXfl ? pPlaneXfl->quadMesh() : emptyquadmesh, pWPolar->name(), opps);
+    }
+
+    for(int ib=0; ib<SailObjects::nBtPolars(); ib++)
+    {
+        BoatPolar const *pBtPolar = SailObjects::btPolar(ib);
+        Boat const *pBoat = SailObjects::boat(pBtPolar->boatName());
+        if(!pBoat) continue;
+
+        std::vector<Opp3d const*> opps;
+        for(int io=0; io<SailObjects::nBtOpps(); io++)
+        {
+            BoatOpp const *pBtOpp = SailObjects::btOpp(io);
+            if(pBtOpp->boatName()==pBoat->name() && pBtOpp->polarName()==pBtPolar->name()) opps.push_back(pBtOpp);
+        }
+
+        writeSeries(pBoat, emptyquadmesh, pBtPolar->name(), opps);
+    }
+
+    return bOK;
+}
+
+
 void XflScriptExec::rePanelFoil(Foil *pFoil)
 {
     pFoil->initGeometry();
@@ -1270,7 +1367,20 @@ void XflScriptExec::runBoatAnalyses()
         strong = "\n   Launching Boat analysis: " + QString::fromStdString(pBoatTask->boat()->name()) + " / " + QString::fromStdString(pBoatTask->btPolar()->name()) + "\n";
         traceLog(strong);
 
+        TaskRecord record;
+        record.m_Type = "boat";
+        record.m_Name = QString::fromStdString(pBoatTask->boat()->name()) + " / " + QString::fromStdString(pBoatTask->btPolar()->name());
+        auto start = std::chrono::steady_clock::now();
+
         launchBoatTask(pBoatTask);
+        record.m_Profile = pBoatTask->profile().toJson();
+
+        record.m_Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        record.m_PeakMemory = xfl::peakMemoryUsage();
+        if     (pBoatTask->isCancelled()) record.m_Status = "cancelled";
+        else if(pBoatTask->hasErrors())   record.m_Status = "errors";
+        else                              record.m_Status = "ok";
+        addTaskRecord(record);
 
         cleanUpBoatTask(pBoatTask);
 
@@ -50,6 +50,7 @@ class XflScriptExec : public XflExecutor
         ~XflScriptExec();
 
         bool makeExportDirectories();
+        bool exportOppsToXdmf(QString const &dirpath);
         bool makeFoils();
         bool readScript(const QString &xmlScriptFileName);
         void makeFoilAnalysisList();
@@ -72,6 +73,9 @@ class XflScriptExec : public XflExecutor
         bool outputPOppText()   const {return m_pScriptReader->outputPOppsText();}
         bool exportPanelCp()    const {return m_pScriptReader->exportPanelCp();}
         bool exportStlMesh()    const {return m_pScriptReader->exportStlMesh();}
+        bool exportXdmf()       const {return m_pScriptReader->exportXdmf();}
+        bool exportPOppImages() const {return m_pScriptReader->exportPOppImages();}
+        QSize const &imageSize() const {return m_pScriptReader->imageSize();}
         bool makeProjectFile()  const {return m_pScriptReader->bMakeProjectFile();}
         bool bCSVOutput()       const {return m_pScriptReader->bCsvTextOutput();}
 
@@ -79,6 +83,9 @@ class XflScriptExec : public XflExecutor
                            double XtrTop=1.0, double XtrBot=1.0, xfl::enumPolarType polarType = xfl::T1POLAR);
 
 
+        /** The line width of the foils and polars made by the script; set from the display settings by the GUI */
+        static void setDefaultLineWidth(int width) {s_LineWidth=width;}
+
     public slots:
         bool runScript(const QString &scriptpath);
 
@@ -115,6 +122,7 @@ class XflScriptExec : public XflExecutor
 
 
         static QThread::Priority s_ThreadPriority;
+        static int s_LineWidth;
 };
 
 
@@ -32,11 +32,9 @@
 #include <api/objects_global.h>
 #include <api/planetask.h>
 #include <api/vorton.h>
+#include <api/utils.h>
 #include <api/xml_globals.h>
 
-#include <core/xflcore.h>
-#include <modules/xobjects.h>
-
 
 XflScriptReader::XflScriptReader() : QXmlStreamReader()
 {
@@ -83,10 +81,20 @@ XflScriptReader::XflScriptReader() : QXmlStreamReader()
 
     m_bMakeProjectFile = true;
     m_bMultiThreading = false;
-    m_bMakePOpps = m_bOutputPOppsText = m_bExportPanelCp = m_bExportStlMesh = false;
+    m_bMakePOpps = m_bOutputPOppsText = m_bExportPanelCp = m_bExportStlMesh = m_bExportXdmf = false;
+    m_bStreamPOpps = false;
+    m_bExportPOppImages = false;
+    m_ImageSize = QSize(1920, 1080);
     m_bCsvOutput = false;
     m_bOutputWPolarsText = false;
     m_nMaxThreads = 1;
+    m_WorkerRetries = 2;
+    m_WorkerTimeout = 0;
+    m_OppsPerWorkerUnit = 0;
+    m_MaxConcurrentTasks = 0;
+    m_bNumaPinning = false;
+    m_bCheckpoints = false;
+    m_CheckpointInterval = 60.0;
     m_bDoublePrecision = true;
     m_bRecursiveDirScan = false;
 
@@ -441,6 +449,40 @@ bool XflScriptReader::readThreadingOptions()
         {
             m_nMaxThreads = readElementText().trimmed().toInt();
         }
+        else if(name().compare(QString("Worker"), Qt::CaseInsensitive)==0)
+        {
+            // e.g. "local", or "ssh node1 /opt/flow5/flow5 -platform offscreen"
+            QString launcher = readElementText().trimmed();
+            if(launcher.length()) m_Workers.append(launcher);
+        }
+        else if(name().compare(QString("Worker_Retries"), Qt::CaseInsensitive)==0)
+        {
+            m_WorkerRetries = std::max(0, readElementText().trimmed().toInt());
+        }
+        else if(name().compare(QString("Worker_Timeout"), Qt::CaseInsensitive)==0)
+        {
+            m_WorkerTimeout = std::max(0, readElementText().trimmed().toInt());
+        }
+        else if(name().compare(QString("Opps_Per_Worker_Task"), Qt::CaseInsensitive)==0)
+        {
+            m_OppsPerWorkerUnit = std::max(0, readElementText().trimmed().toInt());
+        }
+        else if(name().compare(QString("Max_Concurrent_Tasks"), Qt::CaseInsensitive)==0)
+        {
+            m_MaxConcurrentTasks = std::max(0, readElementText().trimmed().toInt());
+        }
+        else if(name().compare(QString("NUMA_Pinning"), Qt::CaseInsensitive)==0)
+        {
+            m_bNumaPinning = xfl::stringToBool(readElementText());
+        }
+        else if(name().compare(QString("Checkpoints"), Qt::CaseInsensitive)==0)
+        {
+            m_bCheckpoints = xfl::stringToBool(readElementText());
+        }
+        else if(name().compare(QString("Checkpoint_Interval"), Qt::CaseInsensitive)==0)
+        {
+            m_CheckpointInterval = std::max(1.0, readElementText().trimmed().toDouble());
+        }
         else
             skipCurrentElement();
     }
@@ -460,6 +502,10 @@ bool XflScriptReader::readPlaneAnalysisOutput()
         {
             m_bMakePOpps = xfl::stringToBool(readElementText());
         }
+        else if(name().compare(QString("stream_oppoints"), Qt::CaseInsensitive)==0)
+        {
+            m_bStreamPOpps = xfl::stringToBool(readElementText());
+        }
         else if(name().compare(QString("make_oppoints_text_file"), Qt::CaseInsensitive)==0)
         {
             m_bOutputPOppsText = xfl::stringToBool(readElementText());
@@ -472,6 +518,22 @@ bool XflScriptReader::readPlaneAnalysisOutput()
         {
             m_bExportStlMesh = xfl::stringToBool(readElementText());
         }
+        else if(name().compare(QString("export_oppoint_xdmf"), Qt::CaseInsensitive)==0)
+        {
+            m_bExportXdmf = xfl::stringToBool(readElementText());
+        }
+        else if(name().compare(QString("export_oppoint_images"), Qt::CaseInsensitive)==0)
+        {
+            m_bExportPOppImages = xfl::stringToBool(readElementText());
+        }
+        else if(name().compare(QString("image_width"), Qt::CaseInsensitive)==0)
+        {
+            m_ImageSize.setWidth(std::max(16, readElementText().trimmed().toInt()));
+        }
+        else if(name().compare(QString("image_height"), Qt::CaseInsensitive)==0)
+        {
+            m_ImageSize.setHeight(std::max(16, readElementText().trimmed().toInt()));
+        }
         else
             skipCurrentElement();
     }
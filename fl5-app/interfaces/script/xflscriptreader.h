@@ -26,6 +26,7 @@
 
 #include <QFile>
 #include <QXmlStreamReader>
+#include <QSize>
 #include <QThread>
 
 #include <api/enums_objects.h>
@@ -100,6 +101,9 @@ class XflScriptReader : public QXmlStreamReader
         bool outputPOppsText()   const {return m_bOutputPOppsText;}
         bool exportPanelCp()     const {return m_bExportPanelCp;}
         bool exportStlMesh()     const {return m_bExportStlMesh;}
+        bool exportXdmf()        const {return m_bExportXdmf;}
+        bool exportPOppImages()  const {return m_bExportPOppImages;}
+        QSize const &imageSize() const {return m_ImageSize;}
         bool bCsvTextOutput()    const {return m_bCsvOutput;}
 
         // Foil access functions
@@ -122,6 +126,7 @@ class XflScriptReader : public QXmlStreamReader
 
         bool bMakeFoilOpps()  const {return m_bMakeOpps;}
         bool bMakePlaneOpps() const {return m_bMakePOpps;}
+        bool bStreamPlaneOpps() const {return m_bStreamPOpps;}
         bool bMakeBtOpps()    const {return m_bMakeBtOpps;}
 
         bool bMakeProjectFile() const {return m_bMakeProjectFile;}
@@ -142,6 +147,15 @@ class XflScriptReader : public QXmlStreamReader
         int nMaxThreads() const {return m_nMaxThreads;}
         QThread::Priority threadPriority() const {return m_ThreadPriority;}
 
+        QStringList const &workers() const {return m_Workers;}
+        int workerRetries() const {return m_WorkerRetries;}
+        int workerTimeout() const {return m_WorkerTimeout;}
+        int oppsPerWorkerUnit() const {return m_OppsPerWorkerUnit;}
+        int maxConcurrentTasks() const {return m_MaxConcurrentTasks;}
+        bool bNumaPinning() const {return m_bNumaPinning;}
+        bool bCheckpoints() const {return m_bCheckpoints;}
+        double checkpointInterval() const {return m_CheckpointInterval;}
+
         bool bDoublePrecision() const {return m_bDoublePrecision;}
 
         bool bRecursiveDirScan() const {return m_bRecursiveDirScan;}
@@ -186,16 +200,29 @@ class XflScriptReader : public QXmlStreamReader
         bool m_bMakeProjectFile;
         int m_nMaxThreads;
 
+        QStringList m_Workers;     /**< the launch commands of the worker processes of a distributed run */
+        int m_WorkerRetries;
+        int m_WorkerTimeout;       /**< in seconds, 0 if unlimited */
+        int m_OppsPerWorkerUnit;   /**< 0 to split each analysis evenly between the workers */
+        int m_MaxConcurrentTasks;  /**< the max. number of plane analyses run at the same time; 0 if only limited by the number of threads */
+        bool m_bNumaPinning;       /**< true if each concurrent plane analysis is pinned to one NUMA node */
+        bool m_bCheckpoints;       /**< true if the plane analyses are checkpointed, so that an interrupted run resumes where it stopped */
+        double m_CheckpointInterval; /**< in seconds, the min. interval between two checkpoints of the wake state */
+
 
         // Plane variables
         QStringList m_PlaneFileList;                   /**< the list of planes >*/
         QStringList m_WPolarFileList;                  /**< the list of plane analyses loaded from xml files >*/
         bool m_bMakePOpps;
+        bool m_bStreamPOpps;
         bool m_bCsvOutput;
         bool m_bOutputWPolarsText;
         bool m_bOutputPOppsText;
         bool m_bExportPanelCp;
         bool m_bExportStlMesh;
+        bool m_bExportXdmf;
+        bool m_bExportPOppImages;
+        QSize m_ImageSize;                             /**< the size in pixels of the exported images >*/
 
         // boat variables
         QStringList m_BoatFileList;                   /**< the list of boats >*/
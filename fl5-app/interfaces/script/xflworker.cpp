@@ -0,0 +1,453 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QThread>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstdio>
+#include <list>
+#ifdef Q_OS_WIN
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#include <interfaces/script/xflworker.h>
+#include <interfaces/script/xflexecutor.h>
+
+#include <api/fileio.h>
+#include <api/foil.h>
+#include <api/objects3d.h>
+#include <api/panelanalysis.h>
+#include <api/planeopp.h>
+#include <api/planepolar.h>
+#include <api/planestl.h>
+#include <api/planetask.h>
+#include <api/planexfl.h>
+
+
+namespace
+{
+    QString const REQUESTTAG("fl5-worker-request");
+    QString const RESPONSETAG("fl5-worker-response");
+    int const PROTOCOLVERSION = 1;
+
+    /** Reads and applies the settings of the analysis */
+    bool readSettings(QDataStream &ar, bool &bDerivatives)
+    {
+        QString tag;
+        int version(0);
+        ar >> tag >> version;
+        if(tag!=REQUESTTAG || version!=PROTOCOLVERSION) return false;
+
+        bool bDouble(true), bInitVTwist(false);
+        double relax(0), alphaprec(0);
+        int maxiters(0);
+        ar >> bDouble >> bInitVTwist >> relax >> alphaprec >> maxiters >> bDerivatives;
+        if(ar.status()!=QDataStream::Ok) return false;
+
+        PanelAnalysis::setDoublePrecision(bDouble);
+        PanelAnalysis::setMultiThread(true);
+        PanelAnalysis::setMaxThreadCount(QThread::idealThreadCount());
+        PlaneTask::setViscousLoopSettings(bInitVTwist, relax, alphaprec, maxiters);
+        return true;
+    }
+
+
+    /** Reads the plane and the polar, and builds the plane */
+    bool readPlane(QDataStream &ar, Plane *&pPlane, PlanePolar *&pWPolar)
+    {
+        int planetype(0);
+        ar >> planetype;
+        if     (planetype==0) pPlane = new PlaneXfl;
+        else if(planetype==1) pPlane = new PlaneSTL;
+        else return false;
+
+        pWPolar = new PlanePolar;
+        if(!pPlane->serializePlaneFl5(ar, false) || !pWPolar->serializeFl5v750(ar, false))
+        {
+            delete pPlane;
+            delete pWPolar;
+            pPlane = nullptr;
+            pWPolar = nullptr;
+            return false;
+        }
+
+        if(pPlane->isXflType()) pPlane->makePlane(true, false, true);
+        return true;
+    }
+
+
+    bool readRange(QDataStream &ar, std::vector<double> &values, std::vector<T8Opp> &t8opps)
+    {
+        int n(0);
+        ar >> n;
+        values.resize(std::max(n,0));
+        for(uint i=0; i<values.size(); i++) ar >> values[i];
+
+        ar >> n;
+        for(int i=0; i<n; i++)
+        {
+            bool bActive(true);
+            double alpha(0), beta(0), vinf(0);
+            ar >> bActive >> alpha >> beta >> vinf;
+            t8opps.push_back(T8Opp(bActive, alpha, beta, vinf));
+        }
+        return ar.status()==QDataStream::Ok;
+    }
+
+
+    /**
+     * Runs the analysis and writes the response.
+     * The operating points are inserted in the project by the task; they are deleted once written if bDeleteOpps is true.
+     */
+    void runTask(Plane *pPlane, PlanePolar *pWPolar, bool bDerivatives, std::vector<double> const &values, std::vector<T8Opp> const &t8opps,
+                 QByteArray &response, bool bDeleteOpps)
+    {
+        PlaneTask task;
+        task.setObjects(pPlane, pWPolar);
+        task.setComputeDerivatives(bDerivatives);
+        task.setKeepOpps(true);
+        switch(pWPolar->type())
+        {
+            case xfl::T6POLAR: task.setCtrlOppList(values); break;
+            case xfl::T7POLAR: task.setStabOppList(values); break;
+            case xfl::T8POLAR: task.setT8OppList(t8opps);   break;
+            default:           task.setOppList(values);     break;
+        }
+
+        XflExecutor executor;
+        executor.runPanelTask(&task);
+
+        QDataStream out(&response, QIODevice::WriteOnly);
+        out << RESPONSETAG << PROTOCOLVERSION;
+        out << (task.hasErrors() || task.isCancelled());
+        out << int(task.planeOppList().size());
+        for(PlaneOpp *pPOpp : task.planeOppList())
+            pPOpp->serializeFl5(out, true);
+
+        if(bDeleteOpps)
+        {
+            for(PlaneOpp *pPOpp : task.planeOppList())
+                Objects3d::deletePlaneOpp(pPOpp);
+        }
+    }
+
+
+    /** Reads the request, runs the task and writes the response; returns false if the request could not be processed */
+    bool processRequest(QByteArray const &request, QByteArray &response)
+    {
+        QDataStream ar(request);
+
+        bool bDerivatives(false);
+        if(!readSettings(ar, bDerivatives)) return false;
+
+        FileIO fileio;
+        if(!fileio.serialize2dObjectsFl5(ar, false, 500760)) return false;
+
+        Plane *pPlane = nullptr;
+        PlanePolar *pWPolar = nullptr;
+        if(!readPlane(ar, pPlane, pWPolar)) return false;
+
+        std::vector<double> values;
+        std::vector<T8Opp> t8opps;
+        if(!readRange(ar, values, t8opps)) return false;
+
+        runTask(pPlane, pWPolar, bDerivatives, values, t8opps, response, false);
+        return true;
+    }
+
+
+    /** The planes and polars built by the service from the recent task headers, the most recently used first */
+    struct ServiceEntry
+    {
+        QByteArray m_Key;              /**< the hash of the task header */
+        QByteArray m_FoilsKey;         /**< the hash of the foils and polars of the header */
+        qint64 m_FoilsPos{0};          /**< the position of the foils in the header */
+        Plane *m_pPlane{nullptr};
+        PlanePolar *m_pWPolar{nullptr};
+    };
+
+
+    bool readFrame(QByteArray &frame)
+    {
+        unsigned char prefix[4];
+        if(std::fread(prefix, 1, 4, stdin)!=4) return false;
+        quint32 size = qFromBigEndian<quint32>(prefix);
+        frame.resize(qsizetype(size));
+        return size==0 || std::fread(frame.data(), 1, size, stdin)==size;
+    }
+
+
+    bool writeFrame(QByteArray const &frame)
+    {
+        unsigned char prefix[4];
+        qToBigEndian<quint32>(quint32(frame.size()), prefix);
+        bool bOK = std::fwrite(prefix, 1, 4, stdout)==4 &&
+                   std::fwrite(frame.constData(), 1, size_t(frame.size()), stdout)==size_t(frame.size());
+        return std::fflush(stdout)==0 && bOK;
+    }
+}
+
+
+/**
+ * Serializes the part of the request common to all the work units of a task:
+ * the settings of the analysis, the foils and their polars, the plane and the polar.
+ */
+QByteArray XflWorker::makeTaskHeader(Plane *pPlane, PlanePolar *pWPolar, bool bDerivatives)
+{
+    QByteArray header;
+    QDataStream ar(&header, QIODevice::WriteOnly);
+
+    ar << REQUESTTAG << PROTOCOLVERSION;
+    ar << PanelAnalysis::bDoublePrecision();
+    ar << PlaneTask::bViscInitVTwist() << PlaneTask::viscRelaxFactor() << PlaneTask::maxViscError() << PlaneTask::maxViscIter();
+    ar << bDerivatives;
+
+    // the foil operating points are of no use to the worker
+    bool bSaveOpps = FileIO::bOpps();
+    FileIO::saveOpps(false);
+    FileIO fileio;
+    fileio.storeFoilsFl5(std::vector<Foil*>(), ar, true);
+    FileIO::saveOpps(bSaveOpps);
+
+    if     (pPlane->isXflType()) ar << 0;
+    else if(pPlane->isSTLType()) ar << 1;
+    else                         ar << -1;
+    pPlane->serializePlaneFl5(ar, true);
+    pWPolar->serializeFl5v750(ar, true);
+
+    return header;
+}
+
+
+/** Serializes the operating points of the work unit */
+QByteArray XflWorker::makeRange(WorkUnit const &unit)
+{
+    QByteArray range;
+    QDataStream ar(&range, QIODevice::WriteOnly);
+
+    ar << int(unit.m_Values.size());
+    for(double v : unit.m_Values) ar << v;
+
+    ar << int(unit.m_T8Opps.size());
+    for(T8Opp const &t8 : unit.m_T8Opps)
+        ar << t8.isActive() << t8.alpha() << t8.beta() << t8.Vinf();
+
+    return range;
+}
+
+
+QByteArray XflWorker::makeRequest(QByteArray const &taskheader, WorkUnit const &unit)
+{
+    QByteArray request(taskheader);
+    request.append(makeRange(unit));
+    return request;
+}
+
+
+/** Makes the content of a request frame of the service mode; the header is kept separate so that the service can identify it */
+QByteArray XflWorker::makeServiceRequest(QByteArray const &taskheader, WorkUnit const &unit)
+{
+    QByteArray request;
+    QDataStream ar(&request, QIODevice::WriteOnly);
+    ar << taskheader << makeRange(unit);
+    return request;
+}
+
+
+/**
+ * Reads the operating points returned by a worker.
+ * @param bErrors true on output if the worker's task has reported errors
+ * @return false if the response is incomplete or malformed, in which case popps is empty.
+ */
+bool XflWorker::readResponse(QByteArray const &response, std::vector<PlaneOpp*> &popps, bool &bErrors)
+{
+    popps.clear();
+    bErrors = false;
+
+    QDataStream ar(response);
+    QString tag;
+    int version(0), n(0);
+    ar >> tag >> version;
+    if(tag!=RESPONSETAG || version!=PROTOCOLVERSION) return false;
+
+    ar >> bErrors >> n;
+    bool bRead = ar.status()==QDataStream::Ok && n>=0;
+    for(int i=0; bRead && i<n; i++)
+    {
+        PlaneOpp *pPOpp = new PlaneOpp;
+        bRead = pPOpp->serializeFl5(ar, false) && ar.status()==QDataStream::Ok;
+        if(bRead) popps.push_back(pPOpp);
+        else      delete pPOpp;
+    }
+
+    if(!bRead)
+    {
+        for(PlaneOpp *pPOpp : popps) delete pPOpp;
+        popps.clear();
+    }
+    return bRead;
+}
+
+
+/**
+ * The entry point of the worker mode: processes the request read on the standard input.
+ * Nothing else may be written on the standard output, which carries the binary response.
+ * @return the process exit code
+ */
+int XflWorker::runWorker()
+{
+#ifdef Q_OS_WIN
+    _setmode(_fileno(stdin),  _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    QFile infile;
+    if(!infile.open(stdin, QIODevice::ReadOnly)) return 1;
+    QByteArray request = infile.readAll();
+    infile.close();
+
+    QByteArray response;
+    if(!processRequest(request, response)) return 1;
+
+    QFile outfile;
+    if(!outfile.open(stdout, QIODevice::WriteOnly)) return 1;
+    outfile.write(response);
+    outfile.flush();
+    outfile.close();
+    return 0;
+}
+
+
+/**
+ * The entry point of the service mode: processes the requests read on the standard input until it is closed.
+ * Each request and each response is a frame made of its size as a 4-byte big-endian integer followed by its content.
+ * A request is made by makeServiceRequest(), and a response is read by readResponse(); an empty response
+ * means that the request could not be processed.
+ *
+ * The planes and polars built from the last cacheSize task headers are kept, so that a request for a task
+ * already seen is not deserialized nor built again, and the foils and their polars are only reloaded when
+ * they differ from those of the previous request. The process-wide caches of the LU factorizations, of the
+ * influence blocks, of the plane operating points and of the XFoil results stay warm between requests.
+ * Nothing else may be written on the standard output, which carries the binary responses.
+ * @return the process exit code
+ */
+int XflWorker::runService(int cacheSize)
+{
+#ifdef Q_OS_WIN
+    _setmode(_fileno(stdin),  _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    cacheSize = std::max(cacheSize, 1);
+    std::list<ServiceEntry> entries;
+    QByteArray loadedfoils; // the hash of the foils and polars in the project
+
+    QByteArray frame;
+    while(readFrame(frame))
+    {
+        QByteArray response;
+        QByteArray header, range;
+        {
+            QDataStream framear(frame);
+            framear >> header >> range;
+            if(framear.status()!=QDataStream::Ok) header.clear();
+        }
+
+        QBuffer buffer(&header);
+        buffer.open(QIODevice::ReadOnly);
+        QDataStream ar(&buffer);
+
+        bool bDerivatives(false);
+        bool bOK = header.size()>0 && readSettings(ar, bDerivatives);
+
+        QByteArray key = QCryptographicHash::hash(header, QCryptographicHash::Sha256);
+        auto it = std::find_if(entries.begin(), entries.end(), [&key](ServiceEntry const &entry) {return entry.m_Key==key;});
+
+        if(bOK && it!=entries.end())
+        {
+            entries.splice(entries.begin(), entries, it);
+            ServiceEntry &entry = entries.front();
+            if(entry.m_FoilsKey!=loadedfoils)
+            {
+                buffer.seek(entry.m_FoilsPos);
+                FileIO fileio;
+                bOK = fileio.serialize2dObjectsFl5(ar, false, 500760);
+                loadedfoils = bOK ? entry.m_FoilsKey : QByteArray();
+            }
+        }
+        else if(bOK)
+        {
+            ServiceEntry entry;
+            entry.m_Key = key;
+            entry.m_FoilsPos = buffer.pos();
+            FileIO fileio;
+            bOK = fileio.serialize2dObjectsFl5(ar, false, 500760);
+            entry.m_FoilsKey = QCryptographicHash::hash(header.mid(entry.m_FoilsPos, buffer.pos()-entry.m_FoilsPos), QCryptographicHash::Sha256);
+            loadedfoils = bOK ? entry.m_FoilsKey : QByteArray();
+
+            bOK = bOK && readPlane(ar, entry.m_pPlane, entry.m_pWPolar);
+            if(bOK)
+            {
+                entries.push_front(entry);
+                while(int(entries.size())>cacheSize)
+                {
+                    delete entries.back().m_pPlane;
+                    delete entries.back().m_pWPolar;
+                    entries.pop_back();
+                }
+            }
+        }
+
+        std::vector<double> values;
+        std::vector<T8Opp> t8opps;
+        if(bOK)
+        {
+            QDataStream rangear(range);
+            bOK = readRange(rangear, values, t8opps);
+        }
+
+        if(bOK)
+        {
+            ServiceEntry const &entry = entries.front();
+            entry.m_pWPolar->clearWPolarData();
+            runTask(entry.m_pPlane, entry.m_pWPolar, bDerivatives, values, t8opps, response, true);
+        }
+
+        if(!writeFrame(response)) break;
+    }
+
+    for(ServiceEntry &entry : entries)
+    {
+        delete entry.m_pPlane;
+        delete entry.m_pWPolar;
+    }
+    return 0;
+}
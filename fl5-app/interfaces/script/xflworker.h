@@ -0,0 +1,71 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+#include <api/t8opp.h>
+
+class Plane;
+class PlanePolar;
+class PlaneOpp;
+
+
+/**
+ * @brief The messages exchanged with the worker processes of a distributed batch run, and the worker's entry point.
+ *
+ * A request holds the foils and their polars, one plane, one plane polar and a range of operating points.
+ * The worker is launched with the option -w, reads one request on its standard input, runs the analysis
+ * and writes the resulting operating points on its standard output before exiting.
+ * The launch command may be any program which forwards the standard channels, e.g. ssh to run on another host.
+ * In the service mode, launched with the option --serve, the process remains resident and processes a sequence
+ * of framed requests, keeping the recently used planes and the solver caches warm between them.
+ */
+namespace XflWorker
+{
+    /** A range of operating points of one of the executor's plane tasks */
+    struct WorkUnit
+    {
+        int m_iTask{-1};                 /**< the index of the task in the executor's list */
+        std::vector<double> m_Values;    /**< the aoa, control or stability values of the T12357 polars */
+        std::vector<T8Opp> m_T8Opps;     /**< the operating points of the T8 polars */
+        int m_nAttempts{0};              /**< the number of failed runs of this unit */
+
+        int nOpps() const {return int(m_Values.size()+m_T8Opps.size());}
+    };
+
+    QByteArray makeTaskHeader(Plane *pPlane, PlanePolar *pWPolar, bool bDerivatives);
+    QByteArray makeRange(WorkUnit const &unit);
+    QByteArray makeRequest(QByteArray const &taskheader, WorkUnit const &unit);
+    QByteArray makeServiceRequest(QByteArray const &taskheader, WorkUnit const &unit);
+    bool readResponse(QByteArray const &response, std::vector<PlaneOpp*> &popps, bool &bErrors);
+
+    int runWorker();
+    int runService(int cacheSize);
+}
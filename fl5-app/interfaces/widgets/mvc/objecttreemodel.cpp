@@ -22,6 +22,9 @@
 
 *****************************************************************************/
 
+#include <vector>
+
+#include <QSet>
 
 #include <interfaces/widgets/mvc/objecttreeitem.h>
 #include <interfaces/widgets/mvc/objecttreemodel.h>
@@ -246,6 +249,71 @@ ObjectTreeItem* ObjectTreeModel::appendRow(ObjectTreeItem*pParentItem, std::stri
 }
 
 
+/**
+ * Updates the children of the item to match the list of rows, given in the order of the existing children.
+ * The children which are no longer in the list are removed, the missing rows are inserted and the style and check
+ * state of the others are updated, so that the views are only notified of the changes, by blocks of contiguous rows,
+ * instead of rebuilding the children and their expanded and selected state.
+ * Falls back to a rebuild of the children if their order differs from the order of the list.
+ */
+void ObjectTreeModel::mergeRows(ObjectTreeItem *pParentItem, QVector<Row> const &rows)
+{
+    if(!pParentItem) return;
+    QModelIndex parentindex = index(pParentItem->parentItem(), pParentItem);
+    int nr = rows.size();
+
+    QSet<QString> names;
+    for(Row const &row : rows) names.insert(row.m_Name);
+
+    // remove the obsolete children
+    int ic = pParentItem->rowCount()-1;
+    while(ic>=0)
+    {
+        int last = ic;
+        while(ic>=0 && !names.contains(pParentItem->child(ic)->name())) ic--;
+        if(ic<last) removeRows(ic+1, last-ic, parentindex);
+        else ic--;
+    }
+
+    // match the remaining children with the rows
+    std::vector<int> match(pParentItem->rowCount());
+    int jr = 0;
+    for(ic=0; ic<pParentItem->rowCount(); ic++)
+    {
+        while(jr<nr && rows.at(jr).m_Name!=pParentItem->child(ic)->name()) jr++;
+        if(jr>=nr)
+        {
+            removeRows(0, pParentItem->rowCount(), parentindex);
+            match.clear();
+            break;
+        }
+        match[ic] = jr++;
+    }
+
+    // insert the missing rows before each matched child, and update the child
+    int ir = 0;
+    for(ic=0; ic<=int(match.size()); ic++)
+    {
+        int jnext = ic<int(match.size()) ? match.at(ic) : nr;
+        if(jnext>ir)
+        {
+            beginInsertRows(parentindex, ir, jnext-1);
+            for(int i=ir; i<jnext; i++) pParentItem->insertRow(i, rows.at(i).m_Name, rows.at(i).m_LS, rows.at(i).m_State);
+            endInsertRows();
+        }
+        if(jnext<nr)
+        {
+            ObjectTreeItem *pItem = pParentItem->child(jnext);
+            pItem->setTheStyle(rows.at(jnext).m_LS);
+            pItem->setCheckState(rows.at(jnext).m_State);
+        }
+        ir = jnext+1;
+    }
+
+    if(nr>0) emit dataChanged(index(0, 0, pParentItem), index(nr-1, 2, pParentItem));
+}
+
+
 
 
 
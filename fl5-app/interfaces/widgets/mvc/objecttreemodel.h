@@ -26,15 +26,26 @@
 #include <QAbstractItemModel>
 #include <QModelIndex>
 #include <QVariant>
+#include <QVector>
+
+#include <api/linestyle.h>
 
 class ObjectTreeItem;
-struct LineStyle;
 
 
 class ObjectTreeModel : public QAbstractItemModel
 {
     Q_OBJECT
 
+    public:
+        /** The data of one child row, used to update the children of an item in one call */
+        struct Row
+        {
+            QString m_Name;
+            LineStyle m_LS;
+            Qt::CheckState m_State{Qt::Unchecked};
+        };
+
     public:
         ObjectTreeModel(QObject *parent = 0);
         ~ObjectTreeModel();
@@ -63,6 +74,8 @@ class ObjectTreeModel : public QAbstractItemModel
         ObjectTreeItem* appendRow(ObjectTreeItem*pParentItem, QString const &name, LineStyle const &ls, Qt::CheckState state);
         ObjectTreeItem* appendRow(ObjectTreeItem*pParentItem, std::string const &name, LineStyle const &ls, Qt::CheckState state);
 
+        void mergeRows(ObjectTreeItem *pParentItem, QVector<Row> const &rows);
+
     private:
         ObjectTreeItem *m_pRootItem;
 };
@@ -35,6 +35,7 @@
 #include <modules/xdirect/xdirect.h>
 #include <core/xflcore.h>
 #include <api/xfoiltask.h>
+#include <api/xfoilresultcache.h>
 #include <interfaces/widgets/customwts/floatedit.h>
 #include <interfaces/widgets/customwts/intedit.h>
 
@@ -83,6 +84,25 @@ void Analysis2dSettings::setupLayout()
 
         m_pchFullReport     = new QCheckBox("Show full log report after an XFoil analysis");
         m_pchKeepErrorsOpen = new QCheckBox("Keep XFoil interface open if analysis errors");
+        m_pchAdaptiveSequence = new QCheckBox("Adaptive steps in aoa and Cl sequences");
+        m_pchAdaptiveSequence->setToolTip("<p>If an operating point fails to converge, restart from the last converged point "
+                                          "and reach the failed point in smaller steps instead of reinitializing the boundary layer.<br>"
+                                          "Recovers points close to stall at the cost of additional iterations.</p>");
+
+        QLabel *plabSegments = new QLabel("Concurrent segments per range=");
+        m_pieSegments = new IntEdit;
+        m_pieSegments->setToolTip("<p>Split each aoa or Cl range into this number of continuation segments, "
+                                  "which are analysed concurrently from the point closest to zero.<br>"
+                                  "Reduces the time to complete a single polar on a multi-core computer. "
+                                  "Some points past stall may converge on another branch than in a sequential run.<br>"
+                                  "Recommendation: 1, i.e. sequential, when running batch analyses of several polars.</p>");
+
+        m_pchResultCache = new QCheckBox("Cache the XFoil results on disk");
+        m_pchResultCache->setToolTip("<p>Store the results of the batch analyses and of the on-the-fly drag calculations "
+                                     "of the 3d analyses, and read them back when the same foil geometry is "
+                                     "analysed again with the same parameters.</p>");
+        QPushButton *ppbClearCache = new QPushButton("Clear cache");
+        connect(ppbClearCache, SIGNAL(clicked()), SLOT(onClearCache()));
 
         pSettingsLayout->addWidget(plabVaccel,          1,1, Qt::AlignRight);
         pSettingsLayout->addWidget(m_pdeVAccel,         1,2);
@@ -91,11 +111,16 @@ void Analysis2dSettings::setupLayout()
 
         pSettingsLayout->addWidget(plabCdError,         3,1, Qt::AlignRight);
         pSettingsLayout->addWidget(m_pfeCdError,        3,2);
+        pSettingsLayout->addWidget(plabSegments,        4,1, Qt::AlignRight);
+        pSettingsLayout->addWidget(m_pieSegments,       4,2);
 
         pSettingsLayout->addWidget(m_pchFullReport,     5,1);
         pSettingsLayout->addWidget(m_pchKeepErrorsOpen, 6,1);
+        pSettingsLayout->addWidget(m_pchAdaptiveSequence, 7,1);
+        pSettingsLayout->addWidget(m_pchResultCache,    8,1);
+        pSettingsLayout->addWidget(ppbClearCache,       8,2);
         pSettingsLayout->setColumnStretch(4,1);
-        pSettingsLayout->setRowStretch(8,1);
+        pSettingsLayout->setRowStretch(9,1);
     }
 
     m_pButtonBox = new QDialogButtonBox(QDialogButtonBox::Close | QDialogButtonBox::Reset);
@@ -169,6 +194,9 @@ void Analysis2dSettings::onButton(QAbstractButton *pButton)
         XFoil::vaccel = 0.01;
         XFoilTask::setCdError(1.0e-3);
         XFoilTask::setMaxIterations(100);
+        XFoilTask::setDefaultAdaptiveSequence(false);
+        XFoilTask::setDefaultSegments(1);
+        XFoilResultCache::setEnabled(false);
         initWidget();
     }
     else if (m_pButtonBox->button(QDialogButtonBox::Close) == pButton)  reject();
@@ -182,6 +210,9 @@ void Analysis2dSettings::initWidget()
     m_pchFullReport->setChecked(XFoil::bFullReport());
     m_pchKeepErrorsOpen->setChecked(XDirect::bKeepOpenOnErrors());
     m_pfeCdError->setValue(XFoilTask::CdError());
+    m_pchAdaptiveSequence->setChecked(XFoilTask::bDefaultAdaptiveSequence());
+    m_pieSegments->setValue(XFoilTask::defaultSegments());
+    m_pchResultCache->setChecked(XFoilResultCache::isEnabled());
 }
 
 
@@ -193,5 +224,14 @@ void Analysis2dSettings::readData()
     XFoil::vaccel = m_pdeVAccel->value();
     XFoilTask::setCdError(m_pfeCdError->value());
     XFoilTask::setMaxIterations(m_pieIterLimit->value());
+    XFoilTask::setDefaultAdaptiveSequence(m_pchAdaptiveSequence->isChecked());
+    XFoilTask::setDefaultSegments(m_pieSegments->value());
+    XFoilResultCache::setEnabled(m_pchResultCache->isChecked());
+}
+
+
+void Analysis2dSettings::onClearCache()
+{
+    XFoilResultCache::clear();
 }
 
@@ -56,10 +56,12 @@ class Analysis2dSettings : public QDialog
 
     private slots:
         void onButton(QAbstractButton *pButton);
+        void onClearCache();
 
     private:
-        QCheckBox *m_pchFullReport, *m_pchKeepErrorsOpen;
+        QCheckBox *m_pchFullReport, *m_pchKeepErrorsOpen, *m_pchAdaptiveSequence, *m_pchResultCache;
         IntEdit *m_pieIterLimit;
+        IntEdit *m_pieSegments;
         FloatEdit * m_pdeVAccel;
         FloatEdit *m_pfeCdError;
 
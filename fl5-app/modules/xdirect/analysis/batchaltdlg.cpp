@@ -362,16 +362,6 @@ void BatchAltDlg::onAnalyze()
 
     XFoilTask::setCancelled(false);
 
-    // failsafe: clean up any remaining tasks from a previous batch
-    if(m_Tasks.size()!=0)
-    {
-        m_ppto->appendPlainText("Uncleaned !\n");
-        for(uint it=0; it<m_Tasks.size(); it++)
-            delete m_Tasks.at(it);
-
-        m_Tasks.clear();
-    }
-
     QApplication::setOverrideCursor(Qt::BusyCursor);
 
     m_ppto->appendPlainText("\nStarted/Done/Total\n");
@@ -379,7 +369,7 @@ void BatchAltDlg::onAnalyze()
 #if (QT_VERSION >= QT_VERSION_CHECK(6,0,0))
             QFuture<void> future = QtConcurrent::run(&BatchAltDlg::batchLaunch, this);
 #else
-            QtConcurrent::run(pXFoilTask, &XFoilTask::run);
+            QtConcurrent::run(this, &BatchAltDlg::batchLaunch);
 #endif
 }
 
@@ -25,6 +25,7 @@
 #include <iostream>
 
 #include <QDateTime>
+#include <QFileInfo>
 #include <QGroupBox>
 #include <QHBoxLayout>
 #include <QPushButton>
@@ -43,7 +44,9 @@
 #include <api/objects2d.h>
 #include <api/oppoint.h>
 #include <api/polar.h>
+#include <api/resultsink.h>
 #include <api/utils.h>
+#include <api/xfoilbatchengine.h>
 #include <api/xfoiltask.h>
 
 
@@ -66,6 +69,8 @@ bool BatchDlg::s_bAlpha    = true;
 
 
 bool BatchDlg::s_bUpdatePolarView = false;
+bool BatchDlg::s_bStoreOpp = false;
+bool BatchDlg::s_bStreamOpps = false;
 XDirect * BatchDlg::s_pXDirect;
 
 QByteArray BatchDlg::s_Geometry;
@@ -171,11 +176,19 @@ void BatchDlg::makeCommonWts()
                     QVBoxLayout *pOptionsLayout = new QVBoxLayout;
                     {
                         m_pchStoreOpp        = new QCheckBox("Store operating points");
+                        m_pchStoreOpp->setToolTip("Keep the operating points in memory and add them to the project.\n"
+                                                  "Each operating point holds the full boundary layer arrays;\n"
+                                                  "uncheck to keep only the polar data.");
+
+                        m_pchStreamOpps      = new QCheckBox("Stream operating points to file");
+                        m_pchStreamOpps->setToolTip("Write the operating points to a results file in the temporary directory\n"
+                                                    "as they are computed, without keeping them in memory.");
 
                         m_pchUpdatePolarView = new QCheckBox("Update polar view");
                         m_pchUpdatePolarView->setToolTip("Update the polar graphs after the completion of each foil/polar pair.\nUncheck for increased analysis speed.");
 
                         pOptionsLayout->addWidget(m_pchStoreOpp);
+                        pOptionsLayout->addWidget(m_pchStreamOpps);
                         pOptionsLayout->addWidget(m_pchUpdatePolarView);
                     }
                     m_pfrOptions->setLayout(pOptionsLayout);
@@ -208,11 +221,6 @@ void BatchDlg::makeCommonWts()
 
 void BatchDlg::cleanUp()
 {
-    for(uint it=0; it<m_Tasks.size(); it++)
-        delete m_Tasks.at(it);
-
-    m_Tasks.clear();
-
     if(m_pXFile->isOpen())
     {
         QTextStream out(m_pXFile);
@@ -240,6 +248,28 @@ void BatchDlg::customEvent(QEvent * pEvent)
         MessageEvent const *pMsgEvent = dynamic_cast<MessageEvent*>(pEvent);
         m_ppto->onAppendQText(pMsgEvent->msg());
     }
+    else if(pEvent->type() == XFOIL_JOB_END_EVENT)
+    {
+        XFoilJobEvent *pJobEvent = static_cast<XFoilJobEvent *>(pEvent);
+        m_nTaskDone++; //one down, more to go
+        QString strong = QString::asprintf("%3d/%3d/%3d  ", m_nTaskStarted, m_nTaskDone, m_nAnalysis);
+        std::string str = "   ...Finished "+ pJobEvent->foilName()+" / "+ pJobEvent->polarName()+"\n";
+
+        m_ppto->onAppendQText(strong + QString::fromStdString(str));
+
+        if(s_bUpdatePolarView)
+        {
+            s_pXDirect->createPolarCurves();
+            s_pXDirect->updateView();
+        }
+
+        bool bStoreOpp = m_pchStoreOpp->isChecked();
+        for(OpPoint *pOpp : pJobEvent->operatingPoints())
+        {
+            Objects2d::addOpPoint(pOpp, bStoreOpp);
+            if(!bStoreOpp) delete pOpp;
+        }
+    }
     else if(pEvent->type() == XFOIL_TASK_END_EVENT)
     {
         XFoilTaskEvent *pXFEvent = static_cast<XFoilTaskEvent *>(pEvent);
@@ -335,7 +365,8 @@ void BatchDlg::initDialog()
     m_ppto->clear();
     m_ppto->setFont(DisplayOptions::tableFont());
 
-    m_pchStoreOpp->setChecked(XDirect::bStoreOpps());
+    m_pchStoreOpp->setChecked(s_bStoreOpp);
+    m_pchStreamOpps->setChecked(s_bStreamOpps);
     m_pchUpdatePolarView->setChecked(s_bUpdatePolarView);
 
 
@@ -404,6 +435,8 @@ void BatchDlg::loadSettings(QSettings &settings)
     {
         s_HSplitterSizes = settings.value("HSplitterSizes").toByteArray();
         s_Geometry = settings.value("WindowGeom", QByteArray()).toByteArray();
+        s_bStoreOpp   = settings.value("StoreOpps",   s_bStoreOpp).toBool();
+        s_bStreamOpps = settings.value("StreamOpps",  s_bStreamOpps).toBool();
     }
     settings.endGroup();
 }
@@ -415,6 +448,8 @@ void BatchDlg::saveSettings(QSettings &settings)
     {
         settings.setValue("VSplitterSizes",  s_HSplitterSizes);
         settings.setValue("WindowGeom",      s_Geometry);
+        settings.setValue("StoreOpps",       s_bStoreOpp);
+        settings.setValue("StreamOpps",      s_bStreamOpps);
     }
     settings.endGroup();
 }
@@ -426,7 +461,8 @@ void BatchDlg::readParams()
     s_bAlpha = m_prbAlpha->isChecked();
 
     s_bUpdatePolarView = m_pchUpdatePolarView->isChecked();
-    XDirect::setStoreOpps(m_pchStoreOpp->isChecked());
+    s_bStoreOpp   = m_pchStoreOpp->isChecked();
+    s_bStreamOpps = m_pchStreamOpps->isChecked();
 }
 
 
@@ -479,99 +515,83 @@ void BatchDlg::onUpdatePolarView()
 }
 
 
+/**
+ * Runs the analysis pairs on the XFoilBatchEngine, with one reused XFoil instance per worker thread.
+ * Unless requested, the operating points are neither kept in memory nor returned,
+ * so that the memory used by the batch does not grow with the number of operating points.
+ */
 void BatchDlg::batchLaunch()
 {
-    QString strong;
+    bool bStoreOpp = s_bStoreOpp;
 
-    std::vector<std::thread> threads;
+    // the results file is named after the log file
+    FileResultSink sink;
+    if(s_bStreamOpps)
+    {
+        QString pathname = m_pXFile ? m_pXFile->fileName() : SaveOptions::newLogFileName();
+        QFileInfo fi(pathname);
+        pathname = fi.path() + "/" + fi.completeBaseName() + "_opps.res";
+        QString strong;
+        if(sink.open(pathname.toStdString()))
+            strong = "Writing the operating points to the results file "+pathname+"\n\n";
+        else
+            strong = "Could not open the results file "+pathname+"\n\n";
+        qApp->postEvent(this, new MessageEvent(strong));
+    }
+
+    XFoilBatchEngine engine;
+    engine.setWorkerCount(QThread::idealThreadCount());
 
     for(FoilAnalysis &analysis : m_AnalysisPair)
     {
-        XFoilTask *pXFoilTask = new XFoilTask();
-        m_Tasks.push_back(pXFoilTask);
-
         analysis.m_pPolar->setVisible(true);
 
-        pXFoilTask->setAoAAnalysis(s_bAlpha);
-
-        pXFoilTask->clearRanges();
+        XFoilJob job;
+        job.m_pFoil     = &analysis.m_Foil;
+        job.m_pPolar    = analysis.m_pPolar;
+        job.m_bAlpha    = s_bAlpha;
+        job.m_bKeepOpps = bStoreOpp;
+        job.m_pResultSink = sink.isOpen() ? &sink : nullptr;
 
         switch (analysis.m_pPolar->type())
         {
             case xfl::T1POLAR:
             case xfl::T2POLAR:
-            {
-                for (AnalysisRange const &rg : m_pT12RangeTable->ranges())
-                {
-                    pXFoilTask->appendRange(rg);
-                }
-
+                job.m_Ranges = m_pT12RangeTable->ranges();
                 break;
-            }
             case xfl::T4POLAR:
-            {
-                for (AnalysisRange const &rg : m_pT4RangeTable->ranges())
-                {
-                    pXFoilTask->appendRange(rg);
-                }
-
+                job.m_Ranges = m_pT4RangeTable->ranges();
                 break;
-            }
             case xfl::T6POLAR:
-            {
-                for (AnalysisRange const &rg : m_pT6RangeTable->ranges())
-                {
-                    pXFoilTask->appendRange(rg);
-                }
-
+                job.m_Ranges = m_pT6RangeTable->ranges();
                 break;
-            }
             default:
                 break;
         }
+        engine.addJob(job);
+    }
 
-        bool bStoreOpp = m_pchStoreOpp->isChecked();
-        pXFoilTask->initialize(analysis.m_Foil, analysis.m_pPolar, bStoreOpp);
-
-        //launch it
+    engine.setStartCallback([this](XFoilJob const &job, int)
+    {
         m_nTaskStarted++;
-
-        strong = QString::asprintf("%3d/%3d/%3d  ", m_nTaskStarted, m_nTaskDone, m_nAnalysis);
-        strong += QString::fromStdString("Starting "+ analysis.m_Foil.name()+'/'+analysis.m_pPolar->name() + "\n");
+        QString strong = QString::asprintf("%3d/%3d/%3d  ", m_nTaskStarted, m_nTaskDone, m_nAnalysis);
+        strong += QString::fromStdString("Starting "+ job.m_pFoil->name()+'/'+job.m_pPolar->name() + "\n");
         qApp->postEvent(this, new MessageEvent(strong));
-        threads.push_back(std::thread(&XFoilTask::run, pXFoilTask));
-    }
+    });
 
-    std::vector<bool> bFinished(m_Tasks.size(), false);
-    bool bAllFinished(false);
-    do
+    engine.setResultCallback([this](XFoilJobResult &result)
     {
-        bAllFinished = true;
-        for(uint itask=0; itask<m_Tasks.size(); itask++)
-        {
-            XFoilTask*pTask = m_Tasks.at(itask);
-            if(pTask->isFinished())
-            {
-                if(!bFinished.at(itask))
-                {
-                    // notify
-                    XFoilTaskEvent *pTaskEvent = new XFoilTaskEvent(pTask);
-                    qApp->postEvent(this, pTaskEvent);
-                    // toggle flag
-                    bFinished[itask] = true;
-                }
-            }
-            else
-                bAllFinished = false;
-//            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        }
-    }
-    while(!bAllFinished);
+        if(!result.m_pFoil || !result.m_pPolar) return;
+        qApp->postEvent(this, new XFoilJobEvent(result.m_pFoil->name(), result.m_pPolar->name(), result.m_OpPoints));
+        result.m_OpPoints.clear(); // ownership passed to the event
+    });
 
-    for(uint iblock=0; iblock<threads.size(); iblock++)
-    {
-        threads[iblock].join();
+    engine.run();
 
+    if(sink.isOpen())
+    {
+        qApp->postEvent(this, new MessageEvent(QString::asprintf("\n%d operating points written to the results file\n", sink.nRecords())));
+        sink.close();
     }
 
     qApp->postEvent(this, new QEvent(XFOIL_BATCH_END_EVENT)); // done and clean
@@ -109,6 +109,7 @@ class BatchDlg : public QDialog
     protected:
         QCheckBox *m_pchUpdatePolarView;
         QCheckBox *m_pchStoreOpp;
+        QCheckBox *m_pchStreamOpps;
 
         QRadioButton *m_prbAlpha, *m_prbCl;
 
@@ -139,7 +140,6 @@ class BatchDlg : public QDialog
         int m_nAnalysis;            /**< the number of analysis pairs to run */
 
         QVector<FoilAnalysis> m_AnalysisPair;  /**< the list of all analysis to be performed. Once performed, an analysis is removed from the list. */
-        std::vector<XFoilTask*> m_Tasks;
 
 
     protected:
@@ -148,6 +148,8 @@ class BatchDlg : public QDialog
         static QByteArray s_Geometry;
         static XDirect* s_pXDirect;           /**< a void pointer to the unique instance of the QXDirect class */
         static bool s_bUpdatePolarView;    /**< true if the polar graphs should be updated during the analysis */
+        static bool s_bStoreOpp;           /**< true if the operating points should be kept in memory and added to the database */
+        static bool s_bStreamOpps;         /**< true if the operating points should be streamed to a results file as they are computed */
 
         static QByteArray s_HSplitterSizes;
 
@@ -683,22 +683,24 @@ void FoilExplorer::addOpps(Polar *pPolar)
                 ObjectTreeItem *pOldPolarItem = pFoilItem->child(jr);
                 if(pOldPolarItem)
                 {
-                    const QModelIndex &oldPolarChild = m_pModel->index(pFoilItem, pOldPolarItem);
                     if(pOldPolarItem->name().toStdString().compare(pPolar->name())==0)
                     {
-                        //clear the children
-                        m_pModel->removeRows(0, pOldPolarItem->rowCount(), oldPolarChild);
-                        //insert POpps
+                        // update the children, notifying only the added and removed OpPoints
+                        QVector<ObjectTreeModel::Row> rows;
                         for(int kr=0; kr<Objects2d::nOpPoints(); kr++)
                         {
                             OpPoint * pOpp = Objects2d::opPointAt(kr);
                             if(pOpp->foilName().compare(pPolar->foilName())==0 && pOpp->polarName().compare(pPolar->name())==0)
                             {
-                                LineStyle ls(pOpp->theStyle());
-                                ls.m_bIsEnabled = !s_pXDirect->isPolarView();
-                                m_pModel->appendRow(pOldPolarItem, pOpp->name(), ls, Qt::PartiallyChecked);
+                                ObjectTreeModel::Row row;
+                                row.m_Name = QString::fromStdString(pOpp->name());
+                                row.m_LS = pOpp->theStyle();
+                                row.m_LS.m_bIsEnabled = !s_pXDirect->isPolarView();
+                                row.m_State = Qt::PartiallyChecked;
+                                rows.append(row);
                             }
                         }
+                        m_pModel->mergeRows(pOldPolarItem, rows);
                         return;
                     }
                 }
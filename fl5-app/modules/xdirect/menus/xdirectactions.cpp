@@ -190,6 +190,10 @@ void XDirectActions::makeActions()
     m_pShowInviscidCurve->setToolTip("<p>Display the operating point's inviscid curve</p>");
     connect(m_pShowInviscidCurve, SIGNAL(triggered(bool)), m_pXDirect, SLOT(onCpi(bool)));
 
+    m_pFlowFieldAct = new QAction("Inviscid flow field", this);
+    m_pFlowFieldAct->setToolTip("<p>Display the inviscid velocity or pressure field around the active foil</p>");
+    connect(m_pFlowFieldAct, SIGNAL(triggered()), m_pXDirect, SLOT(onFlowField()));
+
     m_pExportFoilCpGraphAct = new QAction("to file", this);
     connect(m_pExportFoilCpGraphAct, SIGNAL(triggered(bool)), m_pXDirect, SLOT(onExportCpGraph()));
 
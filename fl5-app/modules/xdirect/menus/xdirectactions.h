@@ -55,7 +55,7 @@ class XDirectActions : QObject
         QAction *m_pHidePolarOpps, *m_pShowPolarOpps, *m_pDeletePolarOpps;
         QAction *m_pExportCurOpp, *m_pCopyCurOppData, *m_pDeleteCurOpp;
         QAction *m_pGetFoilProps, *m_pGetPolarProps, *m_pGetOppProps;
-        QAction *m_pResetFoilScale, *m_pShowInviscidCurve;
+        QAction *m_pResetFoilScale, *m_pShowInviscidCurve, *m_pFlowFieldAct;
         QAction *m_pExportFoilCpGraphAct, *m_pExportToClipBoard;
         QAction *m_pExportCurFoilDat, *m_pExportCurFoilSVG;
         QAction *m_pDeleteCurFoil, *m_pRenameCurFoil, *m_pDuplicateCurFoil, *m_pFoilDescription;
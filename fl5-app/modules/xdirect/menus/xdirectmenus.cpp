@@ -268,6 +268,7 @@ void XDirectMenus::createOppMenus()
             m_pXDirectCpGraphMenu->addSeparator();
             m_pXDirectCpGraphMenu->addAction(m_pMainFrame->m_pOpenGraphInNewWindow);
         }
+        m_pOpPointMenu->addAction(pActions->m_pFlowFieldAct);
         m_pOpPointMenu->addSeparator();
         QMenu *pAllOppsMenu = m_pOpPointMenu->addMenu("Operating points");
         {
@@ -0,0 +1,373 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <QGridLayout>
+#include <QMouseEvent>
+#include <QVBoxLayout>
+
+#include "gl2dfoilflow.h"
+
+#include <core/displayoptions.h>
+#include <core/xflcore.h>
+#include <interfaces/widgets/customwts/floatedit.h>
+#include <api/foil.h>
+#include <api/trace.h>
+#include <api/utils.h>
+
+
+int gl2dFoilFlow::s_iField = 0;
+float gl2dFoilFlow::s_Range[2][2] = {{-1.5f, 1.0f}, {0.0f, 2.0f}};
+QByteArray gl2dFoilFlow::s_Geometry;
+
+
+gl2dFoilFlow::gl2dFoilFlow(QWidget *pParent) : gl2dView(pParent)
+{
+    setWindowTitle("Inviscid flow field");
+    setMouseTracking(true);
+
+    m_fScale = 1.5f;
+    m_RefLength = 1.0/1.5;
+    m_bAxes = false;
+
+    m_bSolved = false;
+    m_bResetNodes = false;
+    m_pNodeTexture = nullptr;
+
+    m_locNodes = m_locNNodes = m_locQInf = m_locFieldType = m_locRange = -1;
+
+    m_pCmdFrame = new QFrame(this);
+    {
+        m_pCmdFrame->setCursor(Qt::ArrowCursor);
+
+        m_pCmdFrame->setFrameShape(QFrame::NoFrame);
+        m_pCmdFrame->setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
+
+        QVBoxLayout *pFrameLayout = new QVBoxLayout;
+        {
+            QLabel *plabTitle = new QLabel("<p>Inviscid linear vortex panel solution,<br>"
+                                           "evaluated per pixel in the fragment shader</p>");
+
+            QGridLayout *pParamLayout = new QGridLayout;
+            {
+                m_plabAlpha = new QLabel;
+                m_plabAlpha->setFont(DisplayOptions::textFont());
+                m_pslAlpha = new QSlider(Qt::Horizontal);
+                m_pslAlpha->setMinimum(-200);
+                m_pslAlpha->setMaximum( 200);
+                m_pslAlpha->setTickInterval(50);
+                m_pslAlpha->setTickPosition(QSlider::TicksBelow);
+                connect(m_pslAlpha, SIGNAL(valueChanged(int)), SLOT(onAlpha()));
+
+                QLabel *plabField = new QLabel("Field:");
+                m_pcbField = new QComboBox;
+                m_pcbField->addItems({"Cp", "V/V"+INFch});
+                m_pcbField->setCurrentIndex(s_iField);
+                connect(m_pcbField, SIGNAL(activated(int)), SLOT(onField()));
+
+                QLabel *plabRange = new QLabel("Range:");
+                m_pfeMin = new FloatEdit(s_Range[s_iField][0]);
+                m_pfeMax = new FloatEdit(s_Range[s_iField][1]);
+                connect(m_pfeMin, SIGNAL(floatChanged(float)), SLOT(update()));
+                connect(m_pfeMax, SIGNAL(floatChanged(float)), SLOT(update()));
+
+                pParamLayout->addWidget(m_plabAlpha, 1, 1);
+                pParamLayout->addWidget(m_pslAlpha,  1, 2, 1, 2);
+                pParamLayout->addWidget(plabField,   2, 1);
+                pParamLayout->addWidget(m_pcbField,  2, 2, 1, 2);
+                pParamLayout->addWidget(plabRange,   3, 1);
+                pParamLayout->addWidget(m_pfeMin,    3, 2);
+                pParamLayout->addWidget(m_pfeMax,    3, 3);
+            }
+
+            pFrameLayout->addWidget(plabTitle);
+            pFrameLayout->addLayout(pParamLayout);
+            pFrameLayout->addWidget(m_ppbSaveImg);
+        }
+
+        m_pCmdFrame->setLayout(pFrameLayout);
+
+        m_pCmdFrame->setStyleSheet("QFrame{background-color: transparent; color: white}"
+                                   "QLabel{background-color: transparent; color: white}");
+    }
+}
+
+
+gl2dFoilFlow::~gl2dFoilFlow()
+{
+    if(m_pNodeTexture)
+    {
+        makeCurrent();
+        delete m_pNodeTexture;
+        m_vboContour.destroy();
+        doneCurrent();
+    }
+}
+
+
+void gl2dFoilFlow::showEvent(QShowEvent *pEvent)
+{
+    gl2dView::showEvent(pEvent);
+    restoreGeometry(s_Geometry);
+}
+
+
+void gl2dFoilFlow::hideEvent(QHideEvent *pEvent)
+{
+    QWidget::hideEvent(pEvent);
+    s_Geometry = saveGeometry();
+}
+
+
+/**
+ * Builds the panel solution for the foil and the texture of its unit vorticities.
+ * The vorticities for an arbitrary aoa are the combination cos(a).gamma_0 + sin(a).gamma_90.
+ */
+void gl2dFoilFlow::setFoil(Foil const *pFoil, double alpha)
+{
+    m_bSolved = false;
+    m_NodeData.clear();
+    if(!pFoil || pFoil->nNodes()<3) return;
+
+    setWindowTitle(QString::fromStdString(pFoil->name()) + " - inviscid flow field");
+
+    m_Stream2d.setFoil(pFoil);
+    m_bSolved = m_Stream2d.solve();
+
+    if(m_bSolved)
+    {
+        int nNodes = m_Stream2d.nNodes();
+        m_NodeData.resize(nNodes*4);
+
+        m_Stream2d.calcSolution(0.0, 1.0);
+        for(int i=0; i<nNodes; i++)
+        {
+            // centre the foil in the view
+            m_NodeData[4*i]   = float(m_Stream2d.node2d(i).x-0.5);
+            m_NodeData[4*i+1] = float(m_Stream2d.node2d(i).y);
+            m_NodeData[4*i+2] = float(m_Stream2d.gamma(i));
+        }
+
+        m_Stream2d.calcSolution(90.0, 1.0);
+        for(int i=0; i<nNodes; i++)
+            m_NodeData[4*i+3] = float(m_Stream2d.gamma(i));
+    }
+    else
+    {
+        xfl::trace("gl2dFoilFlow: the panel influence matrix is singular\n");
+    }
+
+    m_pslAlpha->blockSignals(true);
+    m_pslAlpha->setValue(int(std::round(alpha*10.0)));
+    m_pslAlpha->blockSignals(false);
+    onAlpha();
+
+    m_bResetNodes = true;
+    update();
+}
+
+
+void gl2dFoilFlow::onAlpha()
+{
+    m_plabAlpha->setText(ALPHAch + QString::asprintf("=%5.1f", alpha()) + DEGch);
+    if(m_bSolved) m_Stream2d.calcSolution(alpha(), 1.0);
+    update();
+}
+
+
+void gl2dFoilFlow::onField()
+{
+    s_Range[s_iField][0] = m_pfeMin->valuef();
+    s_Range[s_iField][1] = m_pfeMax->valuef();
+    s_iField = m_pcbField->currentIndex();
+    m_pfeMin->setValue(s_Range[s_iField][0]);
+    m_pfeMax->setValue(s_Range[s_iField][1]);
+    update();
+}
+
+
+void gl2dFoilFlow::initializeGL()
+{
+    QString strange, vsrc, fsrc;
+    vsrc = ":/shaders/shaders2d/fractal_VS.glsl";
+    m_shadFlow.addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, vsrc);
+    if(m_shadFlow.log().length())
+    {
+        strange = QString::asprintf("%s", QString("Flow vertex shader log:"+m_shadFlow.log()).toStdString().c_str());
+        xfl::trace(strange);
+    }
+
+    fsrc = ":/shaders/shaders2d/foilflow_FS.glsl";
+    m_shadFlow.addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, fsrc);
+    if(m_shadFlow.log().length())
+    {
+        strange = QString::asprintf("%s", QString("Flow fragment shader log:"+m_shadFlow.log()).toStdString().c_str());
+        xfl::trace(strange);
+    }
+
+    if(!m_shadFlow.link()) // the cacheable shaders are only compiled at link time
+        xfl::trace("Flow shader link log:"+m_shadFlow.log()+"\n");
+    m_shadFlow.bind();
+    {
+        m_locViewTrans  = m_shadFlow.uniformLocation("ViewTrans");
+        m_locViewScale  = m_shadFlow.uniformLocation("ViewScale");
+        m_locViewRatio  = m_shadFlow.uniformLocation("ViewRatio");
+        m_locNodes      = m_shadFlow.uniformLocation("Nodes");
+        m_locNNodes     = m_shadFlow.uniformLocation("NNodes");
+        m_locQInf       = m_shadFlow.uniformLocation("QInf");
+        m_locFieldType  = m_shadFlow.uniformLocation("FieldType");
+        m_locRange      = m_shadFlow.uniformLocation("Range");
+        m_attrVertexPosition = m_shadFlow.attributeLocation("VertexPosition");
+    }
+    m_shadFlow.release();
+
+    gl2dView::initializeGL();
+}
+
+
+void gl2dFoilFlow::glMake2dObjects()
+{
+    if(!m_bResetNodes) return;
+    m_bResetNodes = false;
+
+    delete m_pNodeTexture;
+    m_pNodeTexture = nullptr;
+    if(m_vboContour.isCreated()) m_vboContour.destroy();
+
+    int nNodes = int(m_NodeData.size())/4;
+    if(nNodes<2) return;
+
+    m_pNodeTexture = new QOpenGLTexture(QOpenGLTexture::Target1D);
+    m_pNodeTexture->setFormat(QOpenGLTexture::RGBA32F);
+    m_pNodeTexture->setSize(nNodes);
+    m_pNodeTexture->setMinMagFilters(QOpenGLTexture::Nearest, QOpenGLTexture::Nearest);
+    m_pNodeTexture->setWrapMode(QOpenGLTexture::ClampToEdge);
+    m_pNodeTexture->allocateStorage(QOpenGLTexture::RGBA, QOpenGLTexture::Float32);
+    m_pNodeTexture->setData(QOpenGLTexture::RGBA, QOpenGLTexture::Float32, m_NodeData.data());
+
+    // the closed contour as a line strip
+    std::vector<GLfloat> pts((nNodes+1)*3);
+    for(int i=0; i<=nNodes; i++)
+    {
+        int k = i%nNodes;
+        pts[3*i]   = m_NodeData[4*k];
+        pts[3*i+1] = m_NodeData[4*k+1];
+        pts[3*i+2] = 0.0f;
+    }
+    m_vboContour.create();
+    m_vboContour.bind();
+    m_vboContour.allocate(pts.data(), int(pts.size()*sizeof(GLfloat)));
+    m_vboContour.release();
+}
+
+
+void gl2dFoilFlow::glRenderView()
+{
+    QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
+
+    glDisable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+
+    double w = m_rectView.width();
+    QVector2D off(-m_ptOffset.x()/width()*w, m_ptOffset.y()/width()*w);
+
+    if(m_pNodeTexture && m_shadFlow.bind())
+    {
+        int stride = 2;
+        double a = alpha()*PI/180.0;
+
+        m_pNodeTexture->bind(0);
+
+        m_shadFlow.setUniformValue(m_locViewRatio, float(width())/float(height()));
+        m_shadFlow.setUniformValue(m_locViewTrans, off);
+        m_shadFlow.setUniformValue(m_locViewScale, m_fScale);
+        m_shadFlow.setUniformValue(m_locNodes,     0);
+        m_shadFlow.setUniformValue(m_locNNodes,    m_pNodeTexture->width());
+        m_shadFlow.setUniformValue(m_locQInf,      QVector2D(float(cos(a)), float(sin(a))));
+        m_shadFlow.setUniformValue(m_locFieldType, s_iField);
+        m_shadFlow.setUniformValue(m_locRange,     QVector2D(m_pfeMin->valuef(), m_pfeMax->valuef()));
+
+        m_vboQuad.bind();
+        {
+            m_shadFlow.enableAttributeArray(m_attrVertexPosition);
+            m_shadFlow.setAttributeBuffer(m_attrVertexPosition, GL_FLOAT, 0, stride, stride*sizeof(GLfloat));
+
+            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+            glDisable(GL_CULL_FACE);
+
+            int nvtx = m_vboQuad.size()/stride/int(sizeof(float));
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, nvtx);
+
+            m_shadFlow.disableAttributeArray(m_attrVertexPosition);
+        }
+        m_vboQuad.release();
+
+        m_pNodeTexture->release(0);
+        m_shadFlow.release();
+    }
+
+    if(m_vboContour.isCreated())
+    {
+        QMatrix4x4 vmMat(m_matView*m_matModel);
+        QMatrix4x4 pvmMat(m_matProj*vmMat);
+        m_shadLine.bind();
+        {
+            m_shadLine.setUniformValue(m_locLine.m_Viewport, QVector2D(float(m_GLViewRect.width()), float(m_GLViewRect.height())));
+            m_shadLine.setUniformValue(m_locLine.m_vmMatrix,  vmMat);
+            m_shadLine.setUniformValue(m_locLine.m_pvmMatrix, pvmMat);
+        }
+        m_shadLine.release();
+        paintLineStrip(m_vboContour, Qt::white, 2.0f, Line::SOLID);
+    }
+
+    if (!m_bInitialized)
+    {
+        m_bInitialized = true;
+        emit ready2d();
+    }
+}
+
+
+void gl2dFoilFlow::mouseMoveEvent(QMouseEvent *pEvent)
+{
+    if(m_bSolved && pEvent->buttons()==Qt::NoButton)
+    {
+        // full CPU evaluation, including the blunt TE panel
+        Vector2d pt = screenToWorld(pEvent->pos());
+        pt.x += 0.5;
+        Vector2d vel;
+        m_Stream2d.getVelocity(alpha(), 1.0, pt, vel);
+        double q2 = vel.x*vel.x + vel.y*vel.y;
+        setOutputInfo(QString::asprintf("x    = %9.5f\ny    = %9.5f\nV/Vinf= %9.5f\nCp   = %9.5f", pt.x, pt.y, sqrt(q2), 1.0-q2));
+    }
+    gl2dView::mouseMoveEvent(pEvent);
+}
+
+
+void gl2dFoilFlow::onSaveImage()
+{
+    QString filename = "FlowField.png";
+    QString description = QString::asprintf("Made with flow5");
+    saveImage(filename, description);
+}
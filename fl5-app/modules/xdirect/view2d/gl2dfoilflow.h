@@ -0,0 +1,99 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <QOpenGLShaderProgram>
+#include <QOpenGLTexture>
+#include <QComboBox>
+#include <QLabel>
+#include <QSlider>
+
+#include <interfaces/opengl/views/gl2dview.h>
+#include <api/stream2d.h>
+
+class Foil;
+class FloatEdit;
+
+/**
+ * @class gl2dFoilFlow
+ * @brief Displays the inviscid flow field around a foil.
+ *
+ * The vortex panel solution is computed once by Stream2d for alpha=0 and 90°;
+ * the nodes and their unit vorticities are uploaded to a 1D texture and the
+ * fragment shader sums the panel influences at each pixel, so that panning,
+ * zooming and changing the aoa do not involve the CPU.
+ * The point under the mouse is evaluated on the CPU with the complete solution.
+ */
+class gl2dFoilFlow : public gl2dView
+{
+    Q_OBJECT
+    public:
+        gl2dFoilFlow(QWidget *pParent = nullptr);
+        ~gl2dFoilFlow() override;
+
+        void setFoil(Foil const *pFoil, double alpha);
+
+    private:
+        QPointF defaultOffset() override {return QPointF(0.0f,0.0f);}
+        void showEvent(QShowEvent *pEvent) override;
+        void hideEvent(QHideEvent *pEvent) override;
+        void mouseMoveEvent(QMouseEvent *pEvent) override;
+
+        void initializeGL() override;
+        void glRenderView() override;
+        void glMake2dObjects() override;
+
+        double alpha() const {return double(m_pslAlpha->value())/10.0;}
+
+    private slots:
+        void onSaveImage() override;
+        void onAlpha();
+        void onField();
+
+    private:
+        Stream2d m_Stream2d;
+        bool m_bSolved;
+
+        QOpenGLShaderProgram m_shadFlow;
+        // shader uniforms
+        int m_locNodes, m_locNNodes, m_locQInf, m_locFieldType, m_locRange;
+
+        QOpenGLTexture *m_pNodeTexture;
+        QOpenGLBuffer m_vboContour;
+
+        std::vector<float> m_NodeData; /** x, y, gamma_0, gamma_90 for each foil node */
+        bool m_bResetNodes;
+
+        QSlider *m_pslAlpha;
+        QLabel *m_plabAlpha;
+        QComboBox *m_pcbField;
+        FloatEdit *m_pfeMin, *m_pfeMax;
+
+        static int s_iField;
+        static float s_Range[2][2];
+        static QByteArray s_Geometry;
+};
+
@@ -1071,6 +1071,7 @@ void OpPointWt::paintBLXFoil(QPainter &painter, OpPoint const* pOpPoint, double
     double sina = sin(alpha);
 
     if(!pOpPoint->bViscResults() || !pOpPoint->m_bBL) return;
+    if(pOpPoint->m_BLXFoil.xd1.size()<2 || pOpPoint->m_BLXFoil.xd2.empty() || pOpPoint->m_BLXFoil.xd3.empty()) return;
 
     painter.save();
 
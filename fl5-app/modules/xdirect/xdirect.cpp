@@ -82,10 +82,12 @@
 #include <modules/xdirect/mgt/foilplrlistdlg.h>
 #include <modules/xdirect/view2d/dfoillegendwt.h>
 #include <modules/xdirect/view2d/dfoilwt.h>
+#include <modules/xdirect/view2d/gl2dfoilflow.h>
 #include <modules/xdirect/view2d/oppointwt.h>
 #include <modules/xdirect/xdirect.h>
 #include <modules/xobjects.h>
 
+#include <api/columnfile.h>
 #include <api/constants.h>
 #include <api/fileio.h>
 #include <api/fl5core.h>
@@ -98,6 +100,7 @@
 #include <api/polar.h>
 #include <api/utils.h>
 #include <api/xfoiltask.h>
+#include <api/xfoilresultcache.h>
 #include <api/xmlpolarreader.h>
 #include <api/xmlpolarwriter.h>
 
@@ -592,7 +595,7 @@ void XDirect::createPolarCurves()
                 pCurve = pGraph->addCurve(QString::fromStdString(pPolar->foilName() + " / " + pPolar->name()));
                 pCurve->setTheStyle(pPolar->theStyle());
 
-                fillCurve(pCurve, pPolar, pGraph->xVariable(), pGraph->yVariable(0), pOppHigh);
+                fillCurve(pCurve, pPolar, pGraph->xVariable(), pGraph->yVariable(0), pOppHigh, pGraph->curveModel());
 
                 if(pGraph->yVariable(0) == 6)    pTr2Curve = pGraph->addCurve();
                 else                            pTr2Curve = nullptr;
@@ -602,7 +605,7 @@ void XDirect::createPolarCurves()
                 if(pTr2Curve)
                 {
                     pTr2Curve->setTheStyle(pPolar->theStyle());
-                    fillCurve(pTr2Curve, pPolar, pGraph->xVariable(), 7, pOppHigh);
+                    fillCurve(pTr2Curve, pPolar, pGraph->xVariable(), 7, pOppHigh, pGraph->curveModel());
                     pCurve->setName(QString::fromStdString(pPolar->foilName() + " / " + pPolar->name() + " / Xtr1"));
                     pTr2Curve->setName(QString::fromStdString(pPolar->foilName() + " / " + pPolar->name() + " / Xtr2"));
                     pPolar->appendCurve(pTr2Curve);
@@ -613,7 +616,7 @@ void XDirect::createPolarCurves()
                     pCurve = pGraph->addCurve(QString::fromStdString(pPolar->name()), AXIS::RIGHTYAXIS);
                     pCurve->setTheStyle(pPolar->theStyle());
 
-                    fillCurve(pCurve, pPolar, pGraph->xVariable(), pGraph->yVariable(1), pOppHigh);
+                    fillCurve(pCurve, pPolar, pGraph->xVariable(), pGraph->yVariable(1), pOppHigh, pGraph->curveModel());
 
                     if(pGraph->yVariable(0) == 6)    pTr2Curve = pGraph->addCurve();
                     else                            pTr2Curve = nullptr;
@@ -623,7 +626,7 @@ void XDirect::createPolarCurves()
                     if(pTr2Curve)
                     {
                         pTr2Curve->setTheStyle(pPolar->theStyle());
-                        fillCurve(pTr2Curve, pPolar, pGraph->xVariable(), 7, pOppHigh);
+                        fillCurve(pTr2Curve, pPolar, pGraph->xVariable(), 7, pOppHigh, pGraph->curveModel());
                         pCurve->setName(QString::fromStdString(pPolar->foilName() + " / " + pPolar->name() + " / Xtr1"));
                         pTr2Curve->setName(QString::fromStdString(pPolar->foilName() + " / " + pPolar->name() + " / Xtr2"));
                         pPolar->appendCurve(pTr2Curve);
@@ -633,8 +636,14 @@ void XDirect::createPolarCurves()
             }
         }
     }
+
+    // discard the cached points of the deleted polars
+    QSet<void const*> polars;
+    for(int k=0; k<Objects2d::nPolars(); k++) polars.insert(Objects2d::polarAt(k));
+
     for(int ig=0; ig<m_PlrGraph.size(); ig++)
     {
+        if(m_PlrGraph[ig]->curveModel()) m_PlrGraph[ig]->curveModel()->trimCache(polars);
         m_PlrGraph[ig]->invalidate();
     }
     emit curvesUpdated();
@@ -647,6 +656,9 @@ void XDirect::fillBLXFoilCurves(OpPoint *pOpp, Graph *pGraph, bool bInviscid)
 
     pGraph->setYInverted(0,false);
 
+    // the BL variables are not saved, and may have been released
+    if(pGraph->yVariable(0)!=0 && !pOpp->m_BLXFoil.hasStations()) return;
+
     switch(pGraph->yVariable(0))
     {
         case 0:  // Cp
@@ -1023,6 +1035,9 @@ void XDirect::loadSettings(QSettings &settings)
         XFoilTask::setCdError(      settings.value("CdError",     XFoilTask::CdError()).toDouble());
         XFoil::setVAccel(settings.value("VAccel", XFoil::VAccel()).toDouble());
         XFoil::setFullReport(settings.value("FullReport", XFoil::bFullReport()).toBool());
+        XFoilTask::setDefaultAdaptiveSequence(settings.value("AdaptiveSequence", XFoilTask::bDefaultAdaptiveSequence()).toBool());
+        XFoilTask::setDefaultSegments(settings.value("RangeSegments", XFoilTask::defaultSegments()).toInt());
+        XFoilResultCache::setEnabled(settings.value("ResultCache", XFoilResultCache::isEnabled()).toBool());
     }
     settings.endGroup();
 
@@ -1111,6 +1126,9 @@ void XDirect::saveSettings(QSettings &settings)
         settings.setValue("CdError",     XFoilTask::CdError());
         settings.setValue("VAccel",      XFoil::VAccel());
         settings.setValue("FullReport",  XFoil::bFullReport());
+        settings.setValue("AdaptiveSequence", XFoilTask::bDefaultAdaptiveSequence());
+        settings.setValue("RangeSegments", XFoilTask::defaultSegments());
+        settings.setValue("ResultCache", XFoilResultCache::isEnabled());
     }
     settings.endGroup();
 
@@ -1877,12 +1895,21 @@ void XDirect::onExportCurPolar()
     FileName.replace("/", " ");
     FileName = QFileDialog::getSaveFileName(s_pMainFrame, "Export Polar",
                                             SaveOptions::lastDirName() + "/"+FileName,
-                                            "Text File (*.txt);;Comma Separated Values (*.csv)",
+                                            "Text File (*.txt);;Comma Separated Values (*.csv);;Columnar binary (*.fl5c)",
                                             &filter);
     if(!FileName.length()) return;
 
     int pos = FileName.lastIndexOf("/");
     if(pos>0) SaveOptions::setLastDirName(FileName.left(pos));
+
+    if(filter.indexOf("*.fl5c")>0)
+    {
+        if(!FileName.endsWith(".fl5c")) FileName += ".fl5c";
+        if(!ColumnFile::exportPolar(FileName.toStdString(), *s_pCurPolar))
+            s_pMainFrame->displayMessage("Error writing the file "+FileName+"\n", true);
+        return;
+    }
+
     pos = FileName.lastIndexOf(".csv");
     if (pos>0) SaveOptions::setExportFileType(xfl::CSV);
     else       SaveOptions::setExportFileType(xfl::TXT);
@@ -2148,7 +2175,7 @@ void XDirect::onImportXFoilPolars()
     {
         logmsg.clear();
         QFile XFile(pathNames.at(iFile));
-        pPolar = Objects3d::importXFoilPolar(XFile, logmsg);
+        pPolar = objects::importXFoilPolar(XFile, logmsg);
         if(!pPolar)
         {
             s_pMainFrame->onShowLogWindow(true);
@@ -2978,6 +3005,18 @@ void XDirect::onPolarProps()
 }
 
 
+/** Opens a stand-alone view of the inviscid flow field around the active foil, at the active opp's aoa. */
+void XDirect::onFlowField()
+{
+    if(!s_pCurFoil) return;
+    gl2dFoilFlow *pFlowView = new gl2dFoilFlow;
+    pFlowView->setAttribute(Qt::WA_DeleteOnClose);
+    pFlowView->setFoil(s_pCurFoil, s_pCurOpp ? s_pCurOpp->aoa() : 0.0);
+    pFlowView->show();
+    pFlowView->activateWindow();
+}
+
+
 void XDirect::onOpPointProps()
 {
     if(!s_pCurOpp) return;
@@ -4241,52 +4280,68 @@ void XDirect::onAFoilLECircle()
 }
 
 
-void XDirect::fillCurve(Curve *pCurve, Polar const *pPolar, int XVar, int YVar, OpPoint const *pHighlightOpp) const
+/**
+ * Fills the curve with the polar's values of YVar vs. XVar.
+ * The points are taken from the cache of the curve model if they have been extracted from the current revision
+ * of the polar's data, so that switching the variables or the highlighted point does not read the polar again.
+ */
+void XDirect::fillCurve(Curve *pCurve, Polar const *pPolar, int XVar, int YVar, OpPoint const *pHighlightOpp, CurveModel *pCache) const
 {
     pCurve->clear();
-
-    std::vector<double> const &pX = pPolar->getVariable(XVar);
-    std::vector<double> const &pY = pPolar->getVariable(YVar);
-    double fx = 1.0;
-    double fy = 1.0;
-
     pCurve->setSelectedPoint(-1);
 
-    for(int i=0; i<pPolar->dataSize(); i++)
+    QPolygonF const *pCached = pCache ? pCache->cachedPoints(pPolar, XVar, YVar, pPolar->dataRevision()) : nullptr;
+    if(pCached)
+    {
+        pCurve->setPoints(*pCached);
+    }
+    else
     {
-        if (XVar==12)
+        std::vector<double> const &pX = pPolar->getVariable(XVar);
+        std::vector<double> const &pY = pPolar->getVariable(YVar);
+        double fx = 1.0;
+        double fy = 1.0;
+
+        for(int i=0; i<pPolar->dataSize(); i++)
         {
-            if(pX.at(i)>0.0)
+            if (XVar==12)
             {
+                if(pX.at(i)>0.0)
+                {
+                    if (YVar==12)
+                    {
+                        if(pY.at(i)>0.0)
+                        {
+                            pCurve->appendPoint(1.0/sqrt(pX.at(i)), 1.0/sqrt(pY.at(i)));
+                        }
+                    }
+                    else
+                    {
+                        pCurve->appendPoint(1.0/sqrt(pX.at(i)), pY.at(i)*fy);
+                    }
+                }
+            }
+            else{
                 if (YVar==12)
                 {
                     if(pY.at(i)>0.0)
                     {
-                        pCurve->appendPoint(1.0/sqrt(pX.at(i)), 1.0/sqrt(pY.at(i)));
+                        pCurve->appendPoint(pX.at(i)*fx, 1.0/sqrt(pY.at(i)));
                     }
                 }
                 else
                 {
-                    pCurve->appendPoint(1.0/sqrt(pX.at(i)), pY.at(i)*fy);
+                    pCurve->appendPoint(pX.at(i)*fx, pY.at(i)*fy);
                 }
             }
         }
-        else{
-            if (YVar==12)
-            {
-                if(pY.at(i)>0.0)
-                {
-                    pCurve->appendPoint(pX.at(i)*fx, 1.0/sqrt(pY.at(i)));
-                }
-            }
-            else
-            {
-                pCurve->appendPoint(pX.at(i)*fx, pY.at(i)*fy);
-            }
-        }
+        if(pCache) pCache->cachePoints(pPolar, XVar, YVar, pPolar->dataRevision(), pCurve->points());
+    }
 
-        // highlight the operating point
-        if (pHighlightOpp)
+    // highlight the operating point
+    if (pHighlightOpp)
+    {
+        for(int i=0; i<pPolar->dataSize(); i++)
         {
             if(pPolar->isControlPolar())
             {
@@ -85,7 +85,7 @@ class XDirect : public QObject
         void createOppCurves();
         void createPolarCurves();
 
-        void fillCurve(Curve *pCurve, const Polar *pPolar, int XVar, int YVar, OpPoint const *pHighlightOpp) const;
+        void fillCurve(Curve *pCurve, const Polar *pPolar, int XVar, int YVar, OpPoint const *pHighlightOpp, CurveModel *pCache) const;
 
         void importAnalysisFromXML(QFile &xmlFile);
 
@@ -208,6 +208,7 @@ class XDirect : public QObject
         void onExportPolarOpps() ;
         void onExportXMLAnalysis();
         void onFillFoil(bool);
+        void onFlowField();
         void onFinishAnalysis();
         void onFoilCoordinates();
         void onFoilFrom1Spline();
@@ -19,6 +19,7 @@ HEADERS += \
     $$PWD/mgt/foilplrlistdlg.h \
     $$PWD/view2d/dfoillegendwt.h \
     $$PWD/view2d/dfoilwt.h \
+    $$PWD/view2d/gl2dfoilflow.h \
     $$PWD/view2d/oppointwt.h \
     $$PWD/xdirect.h \
 
@@ -44,6 +45,7 @@ SOURCES += \
     $$PWD/mgt/foilplrlistdlg.cpp \
     $$PWD/view2d/dfoillegendwt.cpp \
     $$PWD/view2d/dfoilwt.cpp \
+    $$PWD/view2d/gl2dfoilflow.cpp \
     $$PWD/view2d/oppointwt.cpp \
     $$PWD/xdirect.cpp \
 
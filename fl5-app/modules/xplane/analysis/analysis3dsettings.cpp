@@ -52,6 +52,7 @@
 #include <interfaces/graphs/graph/graph.h>
 #include <api/boattask.h>
 #include <api/llttask.h>
+#include <api/memorybudget.h>
 #include <api/panelanalysis.h>
 #include <api/planetask.h>
 #include <api/task3d.h>
@@ -64,7 +65,9 @@
 #include <interfaces/widgets/customwts/intedit.h>
 
 bool Analysis3dSettings::s_bStabDerivatives = true;
+bool Analysis3dSettings::s_bCoarsePreview = false;
 bool Analysis3dSettings::s_bKeepOpenOnErrors = true;
+int Analysis3dSettings::s_BlockThreads = 0;
 int Analysis3dSettings::s_iPage = 0;
 QByteArray Analysis3dSettings::s_WindowGeometry;
 
@@ -100,6 +103,8 @@ void Analysis3dSettings::onResetDefaults()
     Vortex::setCoreRadius(0.000001);
     Vortex::setVortexModel(Vortex::POTENTIAL);
 
+    Task3d::setMaxVortons(0);
+
     WingXfl::setMinSurfaceLength(.001);
     Panel4::setVortexFracPos(0.25);
     Panel4::setCtrlPtFracPos(0.75);
@@ -107,6 +112,9 @@ void Analysis3dSettings::onResetDefaults()
     Panel3::setQuadratureOrder(5);
     Panel::setRFF(10);
 
+    s_BlockThreads = 0;
+    PanelAnalysis::setBlasThreads(0);
+
     setData();
 }
 
@@ -264,8 +272,23 @@ void Analysis3dSettings::setupLayout()
                 pPrecisionLayout->addWidget(pLabPrecision,1,1,1,2);
                 pPrecisionLayout->addWidget(m_prbSinglePrecision,2,2);
                 pPrecisionLayout->addWidget(m_prbDoublePrecision,3,2);
+
+                QLabel *pLabBudget = new QLabel("Memory budget of the analyses=");
+                m_pfeMemoryBudget = new FloatEdit(0.0, 0);
+                QLabel *pLabMB = new QLabel("MB");
+                QString budgettip = "<p>The max. memory which the running analyses may allocate for their influence matrices. "
+                                    "If an analysis would exceed the budget, it switches to the compressed matrix and the iterative "
+                                    "solver if the method supports it, or does not start.<br>"
+                                    "The matrices mapped to scratch files are not counted.<br>"
+                                    "Set to 0 for no limit.</p>";
+                pLabBudget->setToolTip(budgettip);
+                m_pfeMemoryBudget->setToolTip(budgettip);
+                pPrecisionLayout->addWidget(pLabBudget,        5,1,1,2);
+                pPrecisionLayout->addWidget(m_pfeMemoryBudget, 6,2);
+                pPrecisionLayout->addWidget(pLabMB,            6,3);
+
                 pPrecisionLayout->setColumnStretch(3,2);
-                pPrecisionLayout->setRowStretch(4,1);
+                pPrecisionLayout->setRowStretch(7,1);
             }
 
             pSolverFrame->setLayout(pPrecisionLayout);
@@ -416,11 +439,20 @@ void Analysis3dSettings::setupLayout()
                 m_pchVortonRedist = new QCheckBox("Vorton redistribution");
                 m_pchVortonRedist->setToolTip(tip);
 
+                QLabel *plabMaxVortons = new QLabel("Max. number of vortons=");
+                m_pieMaxVortons = new IntEdit;
+                m_pieMaxVortons->setToolTip("<p>When the vorton redistribution is active, the nearby vortons are merged "
+                                            "once the number of active vortons exceeds this budget.<br>"
+                                            "The total circulation and impulse are conserved.<br>"
+                                            "Set to 0 to disable the merging.</p>");
+
                 QLabel *pLabCoreSize = new QLabel("The vorton core size and VPW length have been moved to the analysis definition.");
 
                 pVPWBoxLayout->addWidget(m_pchVortonStrengthEx, 1, 1, 1, 2);
                 pVPWBoxLayout->addWidget(m_pchVortonRedist,     2, 1, 1, 2);
-                pVPWBoxLayout->addWidget(pLabCoreSize,          3, 1, 1, 3);
+                pVPWBoxLayout->addWidget(plabMaxVortons,        3, 1, Qt::AlignRight);
+                pVPWBoxLayout->addWidget(m_pieMaxVortons,       3, 2);
+                pVPWBoxLayout->addWidget(pLabCoreSize,          4, 1, 1, 3);
                 pVPWBoxLayout->setRowStretch(5,1);
                 pVPWBoxLayout->setColumnStretch(4,1);
             }
@@ -465,17 +497,24 @@ void Analysis3dSettings::loadSettings(QSettings &settings)
 
         s_bKeepOpenOnErrors = settings.value("KeepOpenOnErrors",  s_bKeepOpenOnErrors).toBool();
         s_bStabDerivatives  = settings.value("StabDerivatives",   s_bStabDerivatives).toBool();
+        s_bCoarsePreview    = settings.value("CoarsePreview",     s_bCoarsePreview).toBool();
 
         PanelAnalysis::setDoublePrecision(settings.value("DoublePrecision", true).toBool());
+        MemoryBudget::setBudget(settings.value("MemoryBudget", MemoryBudget::budget()).toDouble());
 
         Task3d::setMaxNRHS(           settings.value("MaxNRHS",            Task3d::maxNRHS()).toInt());
 
+        // written by fl5-bench --scaling
+        s_BlockThreads = settings.value("BlockThreads", s_BlockThreads).toInt();
+        PanelAnalysis::setBlasThreads(settings.value("BlasThreads", PanelAnalysis::blasThreads()).toInt());
+
         PlaneTask::setViscInitVTwist(    settings.value("ViscInitVTwist",     PlaneTask::bViscInitVTwist()).toBool());
         PlaneTask::setMaxViscIter(       settings.value("MaxViscIter",        PlaneTask::maxViscIter()).toInt());
         PlaneTask::setMaxViscError(      settings.value("MaxViscError",       PlaneTask::maxViscError()).toDouble());
 
         Task3d::setVortonStretch(    settings.value("VortonSE",       Task3d::bVortonStretch()).toBool());
         Task3d::setVortonRedist(settings.value("VortonRedist",   Task3d::bVortonRedist()).toBool());
+        Task3d::setMaxVortons(  settings.value("MaxVortons",     Task3d::maxVortons()).toInt());
 
         switch (settings.value("VortexModel", Vortex::vortexModel()).toInt())
         {
@@ -502,8 +541,10 @@ void Analysis3dSettings::saveSettings(QSettings &settings)
 
         settings.setValue("KeepOpenOnErrors",   s_bKeepOpenOnErrors);
         settings.setValue("StabDerivatives",    s_bStabDerivatives);
+        settings.setValue("CoarsePreview",      s_bCoarsePreview);
 
         settings.setValue("DoublePrecision",    PanelAnalysis::bDoublePrecision());
+        settings.setValue("MemoryBudget",       MemoryBudget::budget());
 
         settings.setValue("ViscInitVTwist",     PlaneTask::bViscInitVTwist());
         settings.setValue("ViscRelaxFactor",    PlaneTask::viscRelaxFactor());
@@ -512,9 +553,13 @@ void Analysis3dSettings::saveSettings(QSettings &settings)
 
         settings.setValue("VortonSE",           Task3d::bVortonStretch());
         settings.setValue("VortonRedist",       Task3d::bVortonRedist());
+        settings.setValue("MaxVortons",         Task3d::maxVortons());
 
         settings.setValue("MaxNRHS",            Task3d::maxNRHS());
 
+        settings.setValue("BlockThreads",       s_BlockThreads);
+        settings.setValue("BlasThreads",        PanelAnalysis::blasThreads());
+
 
         settings.setValue("VortexModel",        Vortex::vortexModel());
         settings.setValue("CoreRadius",        Vortex::coreRadius());
@@ -525,6 +570,17 @@ void Analysis3dSettings::saveSettings(QSettings &settings)
 }
 
 
+/**
+ * @return the number of block threads of the panel analyses: the count recommended by the scaling
+ * benchmark if one has been stored, capped by the thread count of the preferences.
+ */
+int Analysis3dSettings::analysisThreadCount()
+{
+    if(s_BlockThreads>0) return std::min(s_BlockThreads, xfl::maxThreadCount());
+    return xfl::maxThreadCount();
+}
+
+
 void Analysis3dSettings::showEvent(QShowEvent *pEvent)
 {
     QDialog::showEvent(pEvent);
@@ -617,6 +673,7 @@ void Analysis3dSettings::setData()
 
     m_prbSinglePrecision->setChecked(!PanelAnalysis::bDoublePrecision());
     m_prbDoublePrecision->setChecked(PanelAnalysis::bDoublePrecision());
+    m_pfeMemoryBudget->setValue(MemoryBudget::budget());
 
     //Viscous loop
     m_pchViscInitVTwist->setChecked(PlaneTask::bViscInitVTwist());
@@ -631,6 +688,7 @@ void Analysis3dSettings::setData()
     m_pchVortonRedist->setChecked(false);
     m_pchVortonStrengthEx->setEnabled(false);
     m_pchVortonRedist->setEnabled(false);
+    m_pieMaxVortons->setValue(Task3d::maxVortons());
 }
 
 
@@ -646,6 +704,7 @@ void Analysis3dSettings::readData()
     s_bKeepOpenOnErrors = m_pchKeepOpenOnErrors->isChecked();
 
     PanelAnalysis::setDoublePrecision(m_prbDoublePrecision->isChecked());
+    MemoryBudget::setBudget(m_pfeMemoryBudget->value());
 
     Panel3::setQuadratureOrder(m_pieQuadPoints->value());
 
@@ -680,6 +739,7 @@ void Analysis3dSettings::readData()
     // VPW
     Task3d::setVortonStretch(m_pchVortonStrengthEx->isChecked());
     Task3d::setVortonRedist(m_pchVortonRedist->isChecked());
+    Task3d::setMaxVortons(m_pieMaxVortons->value());
 }
 
 
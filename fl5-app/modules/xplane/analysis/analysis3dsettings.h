@@ -62,9 +62,15 @@ class Analysis3dSettings : public QDialog
         static void setStabDerivatives(bool b) {s_bStabDerivatives=b;}
         static bool bStabDerivatives() {return s_bStabDerivatives;}
 
+        /** If true, the panel analyses are preceded by a coarse VLM analysis whose provisional results fill the polar */
+        static void setCoarsePreview(bool b) {s_bCoarsePreview=b;}
+        static bool bCoarsePreview() {return s_bCoarsePreview;}
+
         static void setKeepOpenOnErrors(bool bKeepOpen) {s_bKeepOpenOnErrors=bKeepOpen;}
         static bool keepOpenOnErrors() {return s_bKeepOpenOnErrors;}
 
+        static int analysisThreadCount();
+
         static void loadSettings(QSettings &settings);
         static void saveSettings(QSettings &settings);
 
@@ -110,12 +116,16 @@ class Analysis3dSettings : public QDialog
         FloatEdit *m_pfeControlPos;
 
         QRadioButton *m_prbSinglePrecision, *m_prbDoublePrecision;
+        FloatEdit *m_pfeMemoryBudget;
 
         //Vortex particle wake
         QCheckBox *m_pchVortonRedist, *m_pchVortonStrengthEx;
+        IntEdit *m_pieMaxVortons;
 
         static bool s_bKeepOpenOnErrors;
         static bool s_bStabDerivatives;
+        static bool s_bCoarsePreview;
+        static int s_BlockThreads;         /**< the block thread count recommended by fl5-bench --scaling, or 0 if none */
 
         static int s_iPage;
         static QByteArray s_WindowGeometry;
@@ -665,7 +665,7 @@ void BatchPlaneDlg::calculate()
     Task3d::setCancelled(false);
     TriMesh::setCancelled(false);
     PanelAnalysis::setMultiThread(xfl::isMultiThreaded());
-    PanelAnalysis::setMaxThreadCount(xfl::maxThreadCount());
+    PanelAnalysis::setMaxThreadCount(Analysis3dSettings::analysisThreadCount());
 
     onMessage(QString::fromStdString(fl5::versionName(true)) + "\n");
     QDateTime dt = QDateTime::currentDateTime();
@@ -45,6 +45,7 @@
 #include <api/planetask.h>
 #include <api/planexfl.h>
 #include <api/task3d.h>
+#include <api/threadpool.h>
 #include <api/xmlplanepolarreader.h>
 #include <api/xmlplanepolarwriter.h>
 
@@ -851,16 +852,22 @@ void BatchXmlDlg::onListDirAnalyses()
     SaveOptions::setXmlWPolarDirName(m_pleWPolarDir->text());
     QStringList files = xfl::findFiles(SaveOptions::xmlWPolarDirName(), {"*.xml"}, false);
 
-    // read the files, just to check if they are valid WPolars
+    // read the files in parallel, just to check if they are valid WPolars
+    std::vector<char> bValid(files.size(), false);
+    ThreadPool::pool().parallelFor(int(files.size()), [&files, &bValid](int i)
+    {
+        PlanePolar *pWPolar = readXmlWPolarFile(files.at(i)); // returns a valid pointer if successful, null otherwise
+        bValid[i] = pWPolar!=nullptr;
+        delete pWPolar;
+    });
+
     QStringList validnames;
     for(int i=0; i<files.size(); i++)
     {
-        PlanePolar *pWPolar = readXmlWPolarFile(files.at(i)); // returns a valid pointer if successful, null otherwise
-        if(pWPolar)
+        if(bValid.at(i))
         {
             QFileInfo fi(files.at(i));
             validnames.append(fi.fileName());
-            delete pWPolar;
         }
     }
     validnames.sort();
@@ -73,7 +73,7 @@ class BatchXmlDlg : public QDialog
         void setupLayout();
         void connectSignals();
         void fillPlaneModel();
-        PlanePolar * readXmlWPolarFile(QString path);
+        static PlanePolar * readXmlWPolarFile(QString path);
         void makeTables();
         void fillAnalysisModel();
         void updateAnalysisProperties(const PlanePolar *pWPolar);
@@ -49,6 +49,10 @@
 
 #include <core/saveoptions.h>
 #include <core/xflcore.h>
+#include <interfaces/graphs/containers/graphwt.h>
+#include <interfaces/graphs/controls/graphoptions.h>
+#include <interfaces/graphs/graph/curve.h>
+#include <interfaces/graphs/graph/graph.h>
 #include <interfaces/widgets/customwts/plaintextoutput.h>
 #include <modules/xplane/analysis/analysis3dsettings.h>
 #include <modules/xplane/glview/gl3dxplaneview.h>
@@ -58,6 +62,7 @@
 XPlane *PlaneAnalysisDlg::s_pXPlane = nullptr;
 
 QByteArray PlaneAnalysisDlg::s_Geometry;
+int PlaneAnalysisDlg::s_LiveInterval = 40;
 
 
 PlaneAnalysisDlg::PlaneAnalysisDlg(QWidget *pParent) : QDialog(pParent)
@@ -65,8 +70,26 @@ PlaneAnalysisDlg::PlaneAnalysisDlg(QWidget *pParent) : QDialog(pParent)
     setWindowTitle("Plane analysis");
     setWindowFlag(Qt::WindowStaysOnTopHint);// | Qt::CustomizeWindowHint | Qt::WindowTitleHint);
     setWindowFlag(Qt::WindowMinMaxButtonsHint);
+
+    m_pResidualGraph = new Graph();
+    m_pResidualGraph->setCurveModel(new CurveModel());
+    m_pResidualGraph->setName("VPW iterations");
+    m_pResidualGraph->setXVariableList({"Iteration"});
+    m_pResidualGraph->setYVariableList({"CL"});
+    m_pResidualGraph->setVariables(0, 0);
+    m_pResidualGraph->setAuto(true);
+    m_pLiveCurve = nullptr;
+    m_LiveCtrl = 0.0;
+    m_nLiveOpps = 0;
+
+    m_bPreview = false;
+    m_bPreviewReady = false;
+
     setupLayout();
 
+    m_LiveTimer.setInterval(s_LiveInterval);
+    connect(&m_LiveTimer, SIGNAL(timeout()), SLOT(onLiveUpdate()));
+
     m_pActiveTask = nullptr;
 
     m_pLastPOpp = nullptr;
@@ -76,6 +99,15 @@ PlaneAnalysisDlg::PlaneAnalysisDlg(QWidget *pParent) : QDialog(pParent)
 }
 
 
+PlaneAnalysisDlg::~PlaneAnalysisDlg()
+{
+    m_LiveTimer.stop();
+    m_pResidualGraphWt->setNullGraph();
+    delete m_pResidualGraph->curveModel();
+    delete m_pResidualGraph;
+}
+
+
 void PlaneAnalysisDlg::setupLayout()
 {
     setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Preferred);
@@ -83,6 +115,10 @@ void PlaneAnalysisDlg::setupLayout()
     m_ppto = new PlainTextOutput;
     m_ppto->setReadOnly(true);
 
+    m_pResidualGraphWt = new GraphWt;
+    m_pResidualGraphWt->setGraph(m_pResidualGraph);
+    m_pResidualGraphWt->setVisible(false);
+
     m_plabTaskInfo = new QLabel;
     m_pButtonBox = new QDialogButtonBox();
     {
@@ -112,7 +148,12 @@ void PlaneAnalysisDlg::setupLayout()
 
     QVBoxLayout *pMainLayout = new QVBoxLayout;
     {
-        pMainLayout->addWidget(m_ppto);
+        QHBoxLayout *pOutputLayout = new QHBoxLayout;
+        {
+            pOutputLayout->addWidget(m_ppto, 3);
+            pOutputLayout->addWidget(m_pResidualGraphWt, 2);
+        }
+        pMainLayout->addLayout(pOutputLayout);
         pMainLayout->addWidget(m_plabTaskInfo);
         pMainLayout->addWidget(m_pButtonBox);
     }
@@ -149,6 +190,7 @@ void PlaneAnalysisDlg::showEvent(QShowEvent *pEvent)
         m_ppbStopIter->setVisible(s_pXPlane && s_pXPlane->curPlPolar()->isType6() && s_pXPlane->curPlPolar()->bVortonWake());
     }
     m_pchKeepOpenOnErrors->setChecked(Analysis3dSettings::keepOpenOnErrors());
+    GraphOptions::resetGraphSettings(*m_pResidualGraph);
     m_ppbCloseDialog->setFocus();
 }
 
@@ -173,6 +215,7 @@ void PlaneAnalysisDlg::cleanUp()
 
     QString strange = QString::asprintf("Elapsed: %.2f s\n", double(m_Clock.elapsed())/1000.0);
     onOutputMessage(strange);
+    if(m_pActiveTask) onOutputMessage(QString::fromStdString(m_pActiveTask->profile().summary()) + "\n");
 
     if(pXFile.open(QIODevice::WriteOnly | QIODevice::Text))
     {
@@ -226,6 +269,12 @@ void PlaneAnalysisDlg::onTaskFinished()
 {
     if(!m_pActiveTask) return;
 
+    m_LiveTimer.stop();
+    onLiveUpdate(); // the frames published since the last tick
+    if(m_pLiveCurve) m_pLiveCurve->setLive(false);
+    m_pLiveCurve = nullptr;
+    m_pResidualGraphWt->update();
+
     m_pLastPOpp = nullptr;
 
     if(m_pActiveTask->planeOppList().size())
@@ -328,6 +377,76 @@ bool PlaneAnalysisDlg::bIsRunning() const
 }
 
 
+/**
+ * Drains the frames published by the active task since the last tick and updates the views once.
+ * Only the last wake snapshot is displayed; the earlier ones would not be seen anyway.
+ */
+void PlaneAnalysisDlg::onLiveUpdate()
+{
+    std::shared_ptr<std::vector<std::vector<Vorton>> const> pVortons;
+    double wakectrl = 0.0;
+    bool bResiduals = false;
+    PlaneOpp const *pLastPOpp = nullptr;
+
+    LiveFrame frame;
+    while(m_LiveChannel.pop(frame))
+    {
+        switch(frame.m_Type)
+        {
+            case LiveFrame::WAKE:
+            {
+                pVortons = frame.m_pVortons;
+                wakectrl = frame.m_Ctrl;
+                break;
+            }
+            case LiveFrame::RESIDUAL:
+            {
+                if(!m_pLiveCurve || frame.m_Ctrl!=m_LiveCtrl || frame.m_Iter==0)
+                {
+                    if(m_pLiveCurve) m_pLiveCurve->setLive(false);
+                    m_pLiveCurve = m_pResidualGraph->addCurve();
+                    m_pLiveCurve->setName(QString::asprintf("ctrl=%.3f", frame.m_Ctrl));
+                    m_pLiveCurve->setLive(true);
+                    m_LiveCtrl = frame.m_Ctrl;
+                }
+                m_pLiveCurve->appendPoint(double(frame.m_Iter+1), frame.m_Value);
+                bResiduals = true;
+                break;
+            }
+            case LiveFrame::PLANEOPP:
+            {
+                pLastPOpp = frame.m_pPlaneOpp;
+                m_nLiveOpps++;
+                break;
+            }
+            default: break;
+        }
+    }
+
+    if(pVortons && s_pXPlane)
+        s_pXPlane->setLiveVortons(wakectrl, *pVortons);
+
+    if(m_bPreviewReady.exchange(false) && s_pXPlane)
+    {
+        s_pXPlane->resetCurves();
+        s_pXPlane->updateView();
+    }
+
+    if(bResiduals)
+    {
+        m_pResidualGraph->resetLimits();
+        m_pResidualGraph->invalidate();
+        m_pResidualGraphWt->update();
+    }
+
+    if(pLastPOpp)
+    {
+        m_plabTaskInfo->setText(QString::asprintf("%d operating point(s) completed - last: ctrl=%.3f  alpha=%.3f  CL=%.5f",
+                                                  m_nLiveOpps, pLastPOpp->ctrl(), pLastPOpp->alpha(), pLastPOpp->aeroForces().CL()));
+    }
+}
+
+
 void PlaneAnalysisDlg::onLiveVortons()
 {
     PlaneTask::setLiveUpdate(m_pchLiveVortons->isChecked());
@@ -343,7 +462,7 @@ PlaneTask* PlaneAnalysisDlg::analyze(Plane *pPlane, PlanePolar *pPlPolar, std::v
     Task3d::setCancelled(false);
     TriMesh::setCancelled(false);
     PanelAnalysis::setMultiThread(xfl::isMultiThreaded());
-    PanelAnalysis::setMaxThreadCount(xfl::maxThreadCount());
+    PanelAnalysis::setMaxThreadCount(Analysis3dSettings::analysisThreadCount());
 
     m_Clock.start(); // put pressure on something (Jerry)
 
@@ -369,6 +488,15 @@ PlaneTask* PlaneAnalysisDlg::analyze(Plane *pPlane, PlanePolar *pPlPolar, std::v
 
     m_pActiveTask->setComputeDerivatives(XPlane::bStoreOpps3d() && Analysis3dSettings::bStabDerivatives());
 
+    // the operating points are only streamed if the task keeps them alive until it is deleted
+    m_LiveChannel.clear();
+    m_pActiveTask->setLiveChannel(&m_LiveChannel);
+    m_pResidualGraph->deleteCurves();
+    m_pLiveCurve = nullptr;
+    m_nLiveOpps = 0;
+    m_pResidualGraphWt->setVisible(pPlPolar->bVortonWake());
+    m_LiveTimer.start();
+
     if (pPlPolar->isType123() || pPlPolar->isType4() || pPlPolar->isType5())
                                     m_pActiveTask->setOppList(opplist);
     else if(pPlPolar->isType6())     m_pActiveTask->setCtrlOppList(opplist);
@@ -377,6 +505,11 @@ PlaneTask* PlaneAnalysisDlg::analyze(Plane *pPlane, PlanePolar *pPlPolar, std::v
 
     m_bHasErrors = false;
 
+    // the coarse analysis runs in the worker thread before the task, which replaces the provisional results as they arrive
+    m_bPreview = Analysis3dSettings::bCoarsePreview() && PolarPreview::canPreview(pPlane, pPlPolar);
+    m_bPreviewReady = false;
+    if(m_bPreview) m_pActiveTask->setResultSink(&m_Preview);
+
     // Launch the task async to keep the UI responsive
     QFuture<void> future = QtConcurrent::run(&PlaneAnalysisDlg::runAsync, this);
     (void)future;
@@ -389,6 +522,15 @@ void PlaneAnalysisDlg::runAsync()
 {
     m_pActiveTask->setAnalysisStatus(xfl::RUNNING);
 
+    if(m_bPreview)
+    {
+        qApp->postEvent(this, new MessageEvent(QString("Running the coarse preview\n")));
+        m_Preview.run(dynamic_cast<PlaneXfl*>(m_pActiveTask->plane()), m_pActiveTask->wPolar(),
+                      m_pActiveTask->oppList(), m_pActiveTask->t8OppList());
+        qApp->postEvent(this, new MessageEvent(QString::asprintf("   %d provisional point(s) added to the polar\n\n", m_Preview.nProvisional())));
+        m_bPreviewReady = true;
+    }
+
     std::thread p(&PlaneTask::run, m_pActiveTask);
 
     while(!m_pActiveTask->isFinished() || !m_pActiveTask->m_theMsgQueue.empty())
@@ -399,14 +541,19 @@ void PlaneAnalysisDlg::runAsync()
         VPWReport report = m_pActiveTask->m_theMsgQueue.front();
         m_pActiveTask->m_theMsgQueue.pop();
 
-        // forward to the UI thread for user notification
+        // forward to the UI thread for user notification; the wake and the results are streamed through the live channel
         qApp->postEvent(this, new MessageEvent(report.message()));
-
-        if(report.m_Vortons.size()!=0)
-            s_pXPlane->setLiveVortons(report.m_Ctrl, report.m_Vortons);
     }
 
     p.join();
 
+    if(m_bPreview)
+    {
+        int nLeft = m_Preview.nProvisional();
+        m_Preview.removeProvisional();
+        if(nLeft>0)
+            qApp->postEvent(this, new MessageEvent(QString::asprintf("\n%d provisional point(s) not replaced and removed from the polar\n", nLeft)));
+    }
+
     qApp->postEvent(this, new QEvent(TASK3D_END_EVENT)); // done and clean
 }
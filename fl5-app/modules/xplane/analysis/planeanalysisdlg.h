@@ -31,8 +31,13 @@
 #include <QPushButton>
 #include <QDialogButtonBox>
 #include <QSettings>
+#include <QTimer>
 
+#include <atomic>
+
+#include <api/livechannel.h>
 #include <api/planeopp.h>
+#include <api/polarpreview.h>
 #include <api/t8opp.h>
 
 class PlaneTask;
@@ -43,6 +48,9 @@ class PlanePolar;
 class PlainTextOutput;
 class Panel3;
 class Panel4;
+class Curve;
+class Graph;
+class GraphWt;
 
 class PlaneAnalysisDlg : public QDialog
 {
@@ -50,6 +58,7 @@ class PlaneAnalysisDlg : public QDialog
 
     public:
         PlaneAnalysisDlg(QWidget *pParent=nullptr);
+        ~PlaneAnalysisDlg() override;
 
         void setTask(PlaneTask *pTask){m_pActiveTask = pTask;}
         PlaneTask *analyze(Plane *pPlane, PlanePolar *pPlPolar, const std::vector<double> &opplist, const std::vector<T8Opp> &ranges);
@@ -78,6 +87,7 @@ class PlaneAnalysisDlg : public QDialog
     protected slots:
         void onCancelClose();
         void onKeepOpenErrors();
+        void onLiveUpdate();
         void onLiveVortons();
         void onOutputMessage(const QString &msg);
         void onStopIterations();
@@ -105,6 +115,18 @@ class PlaneAnalysisDlg : public QDialog
 
         QDialogButtonBox *m_pButtonBox;
 
+        LiveChannel m_LiveChannel;    /**< the intermediate results streamed by the active task */
+        QTimer m_LiveTimer;           /**< drains the live channel at the GUI's pace */
+        Graph *m_pResidualGraph;      /**< the history of the VPW iterations */
+        GraphWt *m_pResidualGraphWt;
+        Curve *m_pLiveCurve;          /**< the curve of the operating point being computed */
+        double m_LiveCtrl;
+        int m_nLiveOpps;
+
+        PolarPreview m_Preview;            /**< the provisional results of the coarse analysis, replaced by those of the active task */
+        bool m_bPreview;                   /**< true if the active task is preceded by the coarse analysis */
+        std::atomic<bool> m_bPreviewReady; /**< set by the worker thread when the provisional results are in the polar */
+
         bool m_bHasErrors;
 
         /** @todo replace with planeopplist.back() */
@@ -112,5 +134,6 @@ class PlaneAnalysisDlg : public QDialog
 
         static XPlane *s_pXPlane;
         static QByteArray s_Geometry;
+        static int s_LiveInterval;    /**< the interval in ms at which the views are updated with the live results */
 };
 
@@ -26,6 +26,8 @@
 #define _MATH_DEFINES_DEFINED
 
 
+#include <cmath>
+
 #include <QCoreApplication>
 
 #include "streamlinemaker.h"
@@ -44,15 +46,124 @@
 #include <api/panel3.h>
 #include <api/panel4.h>
 #include <api/vortex.h>
+#include <api/threadpool.h>
 
 bool StreamlineMaker::s_bCancel=false;
+double StreamlineMaker::s_Tolerance=1.0e-3;
 /*
 int StreamlineMaker::m_NX=10;
 double StreamlineMaker::m_L0=0.1;
 double StreamlineMaker::m_XFactor=1.01;
 */
 
-StreamlineMaker::StreamlineMaker(QObject *pParent) : QRunnable()
+StreamVelocityCache::StreamVelocityCache(PanelAnalysis const *pAnalysis, double const *mu, double const *sigma, double cellsize)
+{
+    m_pAnalysis = pAnalysis;
+    m_Mu        = mu;
+    m_Sigma     = sigma;
+    m_CellSize  = std::max(cellsize, 1.0e-6);
+}
+
+
+void StreamVelocityCache::clear()
+{
+    for(int is=0; is<s_nShards; is++)
+    {
+        std::lock_guard<std::mutex> lock(m_Shard[is].m_Mutex);
+        m_Shard[is].m_Node.clear();
+    }
+}
+
+
+int StreamVelocityCache::nNodes()
+{
+    int n=0;
+    for(int is=0; is<s_nShards; is++)
+    {
+        std::lock_guard<std::mutex> lock(m_Shard[is].m_Mutex);
+        n += int(m_Shard[is].m_Node.size());
+    }
+    return n;
+}
+
+
+/** Returns the level of the lattice whose cell size is the largest power of two times h0 not exceeding ds */
+int StreamVelocityCache::level(double ds) const
+{
+    if(ds<=m_CellSize) return 0;
+    return std::min(int(std::floor(std::log2(ds/m_CellSize))), 30);
+}
+
+
+/**
+ * Returns the perturbation velocity at point C interpolated on the lattice of the given level.
+ * The nodes which are not in the cache yet are evaluated in the calling thread.
+ * Two threads may evaluate the same node concurrently; both results are identical so this is harmless.
+ */
+void StreamVelocityCache::velocity(Vector3d const &C, int level, Vector3d &V)
+{
+    V.reset();
+    if(!m_pAnalysis) return;
+
+    double h = m_CellSize * std::ldexp(1.0, level);
+
+    double fx = C.x/h, fy = C.y/h, fz = C.z/h;
+    int64_t i0 = int64_t(std::floor(fx));
+    int64_t j0 = int64_t(std::floor(fy));
+    int64_t k0 = int64_t(std::floor(fz));
+    double tx = fx-double(i0), ty = fy-double(j0), tz = fz-double(k0);
+
+    NodeKey key[8];
+    Vector3d VNode[8];
+    Vector3d PtMissing[8];
+    Vector3d VMissing[8];
+    int iMissing[8];
+    int nMissing = 0;
+
+    for(int ic=0; ic<8; ic++)
+    {
+        key[ic].m_i = i0 + ( ic     & 1);
+        key[ic].m_j = j0 + ((ic>>1) & 1);
+        key[ic].m_k = k0 + ((ic>>2) & 1);
+        key[ic].m_Level = level;
+
+        Shard &sh = shard(key[ic]);
+        std::lock_guard<std::mutex> lock(sh.m_Mutex);
+        auto it = sh.m_Node.find(key[ic]);
+        if(it!=sh.m_Node.end()) VNode[ic] = it->second;
+        else
+        {
+            PtMissing[nMissing].set(double(key[ic].m_i)*h, double(key[ic].m_j)*h, double(key[ic].m_k)*h);
+            iMissing[nMissing] = ic;
+            nMissing++;
+        }
+    }
+
+    if(nMissing>0)
+    {
+        m_pAnalysis->getVelocityVectors(nMissing, PtMissing, m_Mu, m_Sigma, VMissing, Vortex::coreRadius(), false);
+        for(int im=0; im<nMissing; im++)
+        {
+            int ic = iMissing[im];
+            VNode[ic] = VMissing[im];
+            Shard &sh = shard(key[ic]);
+            std::lock_guard<std::mutex> lock(sh.m_Mutex);
+            sh.m_Node[key[ic]] = VMissing[im];
+        }
+    }
+
+    // trilinear interpolation
+    Vector3d V00 = VNode[0]*(1.0-tx) + VNode[1]*tx;
+    Vector3d V10 = VNode[2]*(1.0-tx) + VNode[3]*tx;
+    Vector3d V01 = VNode[4]*(1.0-tx) + VNode[5]*tx;
+    Vector3d V11 = VNode[6]*(1.0-tx) + VNode[7]*tx;
+    Vector3d V0 = V00*(1.0-ty) + V10*ty;
+    Vector3d V1 = V01*(1.0-ty) + V11*ty;
+    V = V0*(1.0-tz) + V1*tz;
+}
+
+
+StreamlineMaker::StreamlineMaker(QObject *pParent)
 {
     m_pParent = pParent;
 
@@ -64,9 +175,9 @@ StreamlineMaker::StreamlineMaker(QObject *pParent) : QRunnable()
     m_L0 = 0.1;
     m_XFactor = 1.0;
 
-    m_pP4Analysis    = nullptr;
-    m_pP3Analysis = nullptr;
+    m_pP4Analysis = nullptr;
     m_pP3Analysis = nullptr;
+    m_pCache      = nullptr;
     m_Index = 0;
     m_pStreamVertexArray = nullptr;
 }
@@ -102,106 +213,143 @@ void StreamlineMaker::setOpp(Polar3d const*pPolar3d, double QInf, double alpha,
 }
 
 
+/** Integrates all the lines on the thread pool and returns when they are complete */
+void StreamlineMaker::runAll(QVector<StreamlineMaker*> const &makers)
+{
+    ThreadPool::pool().parallelFor(makers.size(), [&makers](int i){makers.at(i)->run();});
+}
+
+
+PanelAnalysis const *StreamlineMaker::analysis() const
+{
+    if(m_pP4Analysis) return m_pP4Analysis;
+    return m_pP3Analysis;
+}
+
+
+/** Returns the unit direction of the local total velocity, or a null vector at a stagnation point */
+void StreamlineMaker::direction(Vector3d const &C, Vector3d const &VInf, int level, Vector3d &U) const
+{
+    Vector3d Vel;
+    if(m_pCache)
+        m_pCache->velocity(C, level, Vel);
+    else if(analysis())
+        analysis()->getVelocityVector(C, m_Mu, m_Sigma, Vel, Vortex::coreRadius(), false, false);
+
+    U = Vel + VInf;
+    double norm = U.norm();
+    if(norm>1.0e-10*m_QInf) U *= 1.0/norm;
+    else                    U.reset();
+}
+
+
+/**
+ * Makes one Dormand-Prince 5(4) step of length h along the streamline from point C, where the
+ * unit direction is k1. Returns the 5th order point, the direction at that point for the next step,
+ * and the norm of the estimated position error.
+ */
+void StreamlineMaker::dopriStep(Vector3d const &C, Vector3d const &k1, double h, Vector3d const &VInf, int level,
+                                Vector3d &C5, Vector3d &k7, double &err) const
+{
+    Vector3d k2, k3, k4, k5, k6;
+    direction(C + k1*(h/5.0), VInf, level, k2);
+    direction(C + (k1*(3.0/40.0) + k2*(9.0/40.0))*h, VInf, level, k3);
+    direction(C + (k1*(44.0/45.0) - k2*(56.0/15.0) + k3*(32.0/9.0))*h, VInf, level, k4);
+    direction(C + (k1*(19372.0/6561.0) - k2*(25360.0/2187.0) + k3*(64448.0/6561.0) - k4*(212.0/729.0))*h, VInf, level, k5);
+    direction(C + (k1*(9017.0/3168.0) - k2*(355.0/33.0) + k3*(46732.0/5247.0) + k4*(49.0/176.0) - k5*(5103.0/18656.0))*h, VInf, level, k6);
+
+    C5 = C + (k1*(35.0/384.0) + k3*(500.0/1113.0) + k4*(125.0/192.0) - k5*(2187.0/6784.0) + k6*(11.0/84.0))*h;
+    direction(C5, VInf, level, k7);
+
+    Vector3d E = (k1*(71.0/57600.0) - k3*(71.0/16695.0) + k4*(71.0/1920.0) - k5*(17253.0/339200.0) + k6*(22.0/525.0) - k7*(1.0/40.0))*h;
+    err = E.norm();
+}
+
+
+/**
+ * Integrates the streamline in arc length with adaptive RK45 steps.
+ * The vertices are output at the same x-stations as the fixed step method, i.e. at the distances
+ * downstream of the first segment which follow the geometric progression of the segment lengths.
+ */
 void StreamlineMaker::run()
 {
     int iVtx = 0; // make a new variable to prevent multithread overwriting
-    Vector3d C;
-    Vector3d VT, Vel;
 
     Vector3d winddir, VInf;
     winddir = objects::windDirection(0.0, m_Beta);// alpha=because the wake panels are rotated by aoa
     VInf = winddir * m_QInf;
 
-    // calculate total wake length and compare it to max. length, i.e. the wake length
-    double l0 = m_L0;
-/*    double series=0.0, r=1.0;
-    for(int p=0; p<m_NX; p++)
-    {
-        series +=r;
-        r*=m_XFactor;
-    }
-    double length = series*l0;
-    if(length>=m_pPolar3d->wakeLength())
-    {
-        //adjust first segment length
-        l0 = m_pPolar3d->wakeLength()/series;
-    }*/
-
-    // plot the left trailing point only for the extreme left trailing panel
-    // and only right trailing points afterwards
-    C.x = m_C0.x;
-    C.y = m_C0.y;
-    C.z = m_C0.z;
-
+    Vector3d C = m_C0;
 
     // make the starting point
     m_pStreamVertexArray[iVtx++] = C.xf() + m_TC.xf();
     m_pStreamVertexArray[iVtx++] = C.yf() + m_TC.yf();
     m_pStreamVertexArray[iVtx++] = C.zf() + m_TC.zf();
 
-
     //make the first streamline point from the specified trailing edge velocity
-    double ds = l0;
-    double XXS = l0;
-    VT = m_UnitDir0 * l0;
-    C += VT;
+    double ds = m_L0;
+    double XXS = m_L0;
+    C += m_UnitDir0 * m_L0;
 
     m_C0 = C;
 
+    Vector3d k1, k7, C5;
+    double err = 0.0;
+    double h = ds;
 
-    Vector3d C0;
     // continue the streamline
     for (int i=1; i<m_NX+1; i++)
     {
-        int iter = 0;
-        do
+        int level = m_pCache ? m_pCache->level(ds) : 0;
+        double xTarget = m_C0.x + XXS;
+        double tol = std::max(s_Tolerance*ds, 1.0e-12);
+        double hmin = ds*1.0e-3;
+        double length = 0.0;
+
+        direction(C, VInf, level, k1);
+
+        // limit the length of the segment in case the line does not progress downstream
+        while(C.x<xTarget && length<20.0*ds)
         {
-            C0 = C;
+            if(s_bCancel) break;
+            h = std::max(hmin, std::min(h, ds));
 
-            if(m_pP4Analysis)
-                m_pP4Analysis->getVelocityVector(C,  m_Mu, m_Sigma, Vel, Vortex::coreRadius(), false, true);
-            else if(m_pP3Analysis)
-                m_pP3Analysis->getVelocityVector(C,  m_Mu, m_Sigma, Vel, Vortex::coreRadius(), false, true);
+            dopriStep(C, k1, h, VInf, level, C5, k7, err);
 
+            if(err>tol && h>hmin)
+            {
+                h *= std::max(0.2, 0.9*pow(tol/err, 0.2));
+                continue;
+            }
 
-            if(Vel.norm()/VInf.norm()>0.5)
+            if(C5.x>=xTarget && C5.x-C.x>0.0)
             {
-                // if the radial velocity is excessive, the point is probably
-                // close to a wake line, so reduce the increment
-                VT = Vel + VInf;
-                C += VT.normalized()/10.0*ds;
+                // adjust exactly to the station
+                double t = (xTarget-C.x)/(C5.x-C.x);
+                C += (C5-C)*t;
+                C.x = xTarget;
+                length += h*t;
             }
             else
             {
-                VT = Vel + VInf;
-                C += VT.normalized() * ds;
+                C = C5;
+                k1 = k7;
+                length += h;
             }
-            iter++;
-            if(s_bCancel) break;
-        } while((C.x-m_C0.x)<XXS && iter<20);
 
-        // adjust exactly to XXS
-        if(C.x-C0.x>0.0)
-        {
-            Vector3d U = (C-C0).normalized();
-            C = C0 + U*(m_C0.x+XXS-C0.x);
+            if(err>0.0) h *= std::min(5.0, std::max(0.2, 0.9*pow(tol/err, 0.2)));
+            else        h *= 5.0;
         }
 
         m_pStreamVertexArray[iVtx++] = C.xf() + m_TC.xf();
         m_pStreamVertexArray[iVtx++] = C.yf() + m_TC.yf();
         m_pStreamVertexArray[iVtx++] = C.zf() + m_TC.zf();
 
-//qDebug("  %3d  %13.9f  %13.9f  %13.9f", i, C.x + m_TC.x, C.y + m_TC.y, C.z + m_TC.z);
-
-
         ds *= m_XFactor;
         XXS += ds;
         if(s_bCancel) break;
     }
-//    qDebug("  last  %13.9f  %13.9f  %13.9f", C.x + m_TC.x, C.y + m_TC.y, C.z + m_TC.z);
 
     if(m_pParent)
         qApp->postEvent(static_cast<QObject*>(m_pParent), new StreamEndTaskEvent(m_Index));
 }
-
-
@@ -22,11 +22,14 @@
 
 *****************************************************************************/
 
-
 #pragma once
 
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
 #include <QEvent>
-#include <QRunnable>
+#include <QVector>
 
 #include <api/vector3d.h>
 #include <api/flow5events.h>
@@ -34,6 +37,7 @@
 class PlaneOpp;
 class Vector3d;
 class Polar3d;
+class PanelAnalysis;
 class P4Analysis;
 class P3Analysis;
 class PlaneXfl;
@@ -42,7 +46,64 @@ class Panel3;
 class Panel4;
 
 
-class StreamlineMaker : public QRunnable
+/**
+ * @class StreamVelocityCache
+ * @brief A thread-safe cache of the perturbation velocities, shared by all the streamlines of a plot.
+ *
+ * The velocities are stored at the nodes of nested uniform lattices; the lattice of level l has
+ * a cell size of h0.2^l. A streamline samples the level which matches its current segment length,
+ * so that neighbouring lines at the same distance downstream reuse the same nodes.
+ * The velocity at a point is interpolated trilinearly from the 8 nodes of its cell; the missing
+ * nodes are evaluated in a single batch with the panel loop outermost.
+ */
+class StreamVelocityCache
+{
+    private:
+        struct NodeKey
+        {
+            int64_t m_i{0}, m_j{0}, m_k{0};
+            int m_Level{0};
+            bool operator==(NodeKey const &key) const {return m_i==key.m_i && m_j==key.m_j && m_k==key.m_k && m_Level==key.m_Level;}
+        };
+
+        struct NodeKeyHash
+        {
+            size_t operator()(NodeKey const &key) const
+            {
+                return size_t(key.m_i*73856093) ^ size_t(key.m_j*19349663) ^ size_t(key.m_k*83492791) ^ size_t(key.m_Level*2654435761);
+            }
+        };
+
+        /** the nodes are split in shards to limit the contention between the threads */
+        struct Shard
+        {
+            std::mutex m_Mutex;
+            std::unordered_map<NodeKey, Vector3d, NodeKeyHash> m_Node;
+        };
+
+    public:
+        StreamVelocityCache(PanelAnalysis const *pAnalysis, double const *mu, double const *sigma, double cellsize);
+
+        void clear();
+        int level(double ds) const;
+        void velocity(Vector3d const &C, int level, Vector3d &V);
+        int nNodes();
+
+    private:
+        Shard &shard(NodeKey const &key) {return m_Shard[NodeKeyHash()(key)%s_nShards];}
+
+    private:
+        PanelAnalysis const *m_pAnalysis;
+        double const *m_Mu;
+        double const *m_Sigma;
+        double m_CellSize;    /**< the cell size of level 0 */
+
+        static constexpr int s_nShards = 32;
+        Shard m_Shard[s_nShards];
+};
+
+
+class StreamlineMaker
 {
     public:
         StreamlineMaker(QObject *pParent=nullptr);
@@ -58,9 +119,21 @@ class StreamlineMaker : public QRunnable
         void setP4Analysis(P4Analysis *p4a) {m_pP4Analysis=p4a;}
         void setP3Analysis(P3Analysis *p3a) {m_pP3Analysis=p3a;}
 
+        void setVelocityCache(StreamVelocityCache *pCache) {m_pCache=pCache;}
+
+        static void runAll(QVector<StreamlineMaker*> const &makers);
+
         static void cancelTasks(bool bCancel) {s_bCancel = bCancel;}
         static bool isCancelled() {return s_bCancel;}
 
+        static void setTolerance(double tol) {s_Tolerance=tol;}
+        static double tolerance() {return s_Tolerance;}
+
+    private:
+        PanelAnalysis const *analysis() const;
+        void direction(Vector3d const &C, Vector3d const &VInf, int level, Vector3d &U) const;
+        void dopriStep(Vector3d const &C, Vector3d const &k1, double h, Vector3d const &VInf, int level,
+                       Vector3d &C5, Vector3d &k7, double &err) const;
 
     private:
 
@@ -77,6 +150,8 @@ class StreamlineMaker : public QRunnable
         P4Analysis *m_pP4Analysis;
         P3Analysis *m_pP3Analysis;
 
+        StreamVelocityCache *m_pCache; /**< the velocity cache shared with the other lines, or nullptr if the velocities are evaluated directly */
+
         QVector<Panel3> const * panel3;
         QVector<Panel3> const * wakepanel3;
         QVector<Panel4> const * panel4;
@@ -92,6 +167,7 @@ class StreamlineMaker : public QRunnable
         double m_XFactor;
 
         static bool s_bCancel;
+        static double s_Tolerance;  /**< the RK45 position tolerance, relative to the segment length */
 
 };
 
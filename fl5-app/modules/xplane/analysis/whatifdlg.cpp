@@ -0,0 +1,236 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <cmath>
+
+#include <QApplication>
+#include <QDialogButtonBox>
+#include <QElapsedTimer>
+#include <QGridLayout>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+#include "whatifdlg.h"
+
+#include <api/constants.h>
+#include <api/plane.h>
+#include <api/planeopp.h>
+#include <api/planepolar.h>
+#include <api/planetask.h>
+#include <api/trimesh.h>
+#include <api/units.h>
+#include <core/displayoptions.h>
+#include <modules/xplane/xplane.h>
+
+
+XPlane *WhatIfDlg::s_pXPlane = nullptr;
+
+
+WhatIfDlg::WhatIfDlg(QWidget *pParent) : QDialog(pParent)
+{
+    setWindowTitle("What-if");
+
+    m_pTask  = nullptr;
+    m_pPolar = nullptr;
+    m_pPOpp  = nullptr;
+    m_RefSpeed = 1.0;
+
+    setupLayout();
+}
+
+
+WhatIfDlg::~WhatIfDlg()
+{
+    if(m_pTask)  delete m_pTask;
+    if(m_pPolar) delete m_pPolar;
+    if(m_pPOpp)  delete m_pPOpp;
+}
+
+
+void WhatIfDlg::setupLayout()
+{
+    QVBoxLayout *pMainLayout = new QVBoxLayout;
+    {
+        QGridLayout *pSliderLayout = new QGridLayout;
+        {
+            m_pslAlpha = new QSlider(Qt::Horizontal);
+            m_pslAlpha->setRange(-150, 250);   // tenths of a degree
+            m_pslAlpha->setTickInterval(50);
+            m_pslBeta = new QSlider(Qt::Horizontal);
+            m_pslBeta->setRange(-200, 200);
+            m_pslBeta->setTickInterval(50);
+            m_pslSpeed = new QSlider(Qt::Horizontal);
+            m_pslSpeed->setRange(20, 200);     // percent of the reference speed
+            m_pslSpeed->setTickInterval(20);
+
+            m_plabAlpha = new QLabel;
+            m_plabBeta  = new QLabel;
+            m_plabSpeed = new QLabel;
+
+            int row=1;
+            for(QSlider *pSlider : {m_pslAlpha, m_pslBeta, m_pslSpeed})
+            {
+                pSlider->setTickPosition(QSlider::TicksBelow);
+                pSlider->setMinimumWidth(300);
+                connect(pSlider, &QSlider::valueChanged, this, &WhatIfDlg::onSlider);
+                pSliderLayout->addWidget(pSlider, row++, 2);
+            }
+            pSliderLayout->addWidget(new QLabel(ALPHAch), 1, 1);
+            pSliderLayout->addWidget(new QLabel(BETAch),  2, 1);
+            pSliderLayout->addWidget(new QLabel("V" + INFch), 3, 1);
+            pSliderLayout->addWidget(m_plabAlpha, 1, 3);
+            pSliderLayout->addWidget(m_plabBeta,  2, 3);
+            pSliderLayout->addWidget(m_plabSpeed, 3, 3);
+            pSliderLayout->setColumnStretch(2,1);
+        }
+
+        m_plabResults = new QLabel;
+        m_plabResults->setFont(DisplayOptions::tableFont());
+
+        QDialogButtonBox *pButtonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+        {
+            connect(pButtonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+        }
+
+        pMainLayout->addLayout(pSliderLayout);
+        pMainLayout->addWidget(m_plabResults);
+        pMainLayout->addStretch();
+        pMainLayout->addWidget(pButtonBox);
+    }
+    setLayout(pMainLayout);
+}
+
+
+/**
+ * Solves the flow at the active operating point, or at the polar's first point if there is none,
+ * and keeps the unit solutions for the superposition.
+ * @return false if the polar does not qualify or if the analysis failed.
+ */
+bool WhatIfDlg::initDialog(Plane *pPlane, PlanePolar const *pPlPolar, PlaneOpp const *pPOpp)
+{
+    if(!pPlane || !PlaneTask::canSuperpose(pPlPolar)) return false;
+
+    double alpha = pPlPolar->alphaSpec();
+    double beta  = pPlPolar->betaSpec();
+    double QInf  = pPlPolar->velocity()>PRECISION ? pPlPolar->velocity() : 10.0;
+    if(pPOpp)
+    {
+        alpha = pPOpp->alpha();
+        beta  = pPOpp->beta();
+        QInf  = pPOpp->QInf();
+    }
+    m_RefSpeed = QInf;
+
+    // the solved operating point is added to a copy of the polar, so that the active polar is left unchanged
+    m_pPolar = new PlanePolar;
+    m_pPolar->duplicateSpec(pPlPolar);
+    m_pPolar->setName(pPlPolar->name());
+    m_pPolar->setPlaneName(pPlPolar->planeName());
+
+    m_pTask = new PlaneTask;
+    m_pTask->setKeepOpps(false);
+    m_pTask->setComputeDerivatives(false);
+    m_pTask->setKeepUnitSolutions(true);
+    m_pTask->setObjects(pPlane, m_pPolar);
+
+    if     (m_pPolar->isType8()) m_pTask->setT8OppList({T8Opp(true, alpha, beta, QInf)});
+    else if(m_pPolar->isType4()) m_pTask->setOppList({QInf});
+    else if(m_pPolar->isType5()) m_pTask->setOppList({beta});
+    else                         m_pTask->setOppList({alpha});
+
+    Task3d::setCancelled(false);
+    TriMesh::setCancelled(false);
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    m_pTask->setAnalysisStatus(xfl::RUNNING);
+    m_pTask->run();
+    QApplication::restoreOverrideCursor();
+
+    if(!m_pTask->hasUnitSolutions()) return false;
+
+    m_pslAlpha->blockSignals(true);
+    m_pslBeta->blockSignals(true);
+    m_pslSpeed->blockSignals(true);
+    {
+        m_pslAlpha->setValue(int(std::round(alpha*10.0)));
+        m_pslBeta->setValue(int(std::round(beta*10.0)));
+        m_pslSpeed->setValue(100);
+    }
+    m_pslAlpha->blockSignals(false);
+    m_pslBeta->blockSignals(false);
+    m_pslSpeed->blockSignals(false);
+
+    // the fixed lift and glide polars calculate the balance speed
+    m_pslSpeed->setEnabled(!m_pPolar->isFixedLiftPolar() && !m_pPolar->isGlidePolar());
+
+    onSlider();
+    return true;
+}
+
+
+void WhatIfDlg::setLabels()
+{
+    m_plabAlpha->setText(QString::asprintf("%7.1f", double(m_pslAlpha->value())/10.0) + DEGch);
+    m_plabBeta->setText( QString::asprintf("%7.1f", double(m_pslBeta->value())/10.0)  + DEGch);
+    double QInf = m_RefSpeed*double(m_pslSpeed->value())/100.0;
+    m_plabSpeed->setText(QString::asprintf("%7.2f ", QInf*Units::mstoUnit()) + Units::speedUnitQLabel());
+}
+
+
+void WhatIfDlg::onSlider()
+{
+    if(!m_pTask || !s_pXPlane) return;
+
+    setLabels();
+
+    double alpha = double(m_pslAlpha->value())/10.0;
+    double beta  = double(m_pslBeta->value())/10.0;
+    double QInf  = m_RefSpeed*double(m_pslSpeed->value())/100.0;
+
+    QElapsedTimer t;
+    t.start();
+    PlaneOpp *pPOpp = m_pTask->superposeOpp(alpha, beta, QInf);
+    int elapsed = int(t.elapsed());
+
+    if(!pPOpp)
+    {
+        m_plabResults->setText("No solution at this operating point");
+        return;
+    }
+
+    // display the new operating point before releasing the previous one
+    s_pXPlane->setPlaneOpp(pPOpp);
+    s_pXPlane->updateView();
+    if(m_pPOpp) delete m_pPOpp;
+    m_pPOpp = pPOpp;
+
+    QString strange;
+    strange  = QString::asprintf("CL = %9.5f\n", m_pPOpp->aeroForces().CL());
+    strange += QString::asprintf("CD = %9.5f\n", m_pPOpp->aeroForces().CD());
+    strange += QString::asprintf("Cm = %9.5f\n", m_pPOpp->aeroForces().Cm());
+    if(m_pPolar->isFixedLiftPolar() || m_pPolar->isGlidePolar())
+        strange += "V" + INFch + QString::asprintf(" = %9.3f ", m_pPOpp->QInf()*Units::mstoUnit()) + Units::speedUnitQLabel() + "\n";
+    strange += QString::asprintf("Updated in %d ms", elapsed);
+    m_plabResults->setText(strange);
+}
@@ -0,0 +1,77 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <QDialog>
+#include <QSlider>
+#include <QLabel>
+
+class XPlane;
+class Plane;
+class PlanePolar;
+class PlaneOpp;
+class PlaneTask;
+
+/**
+ * @class WhatIfDlg
+ * @brief Displays in the 3d view the operating points made on the fly from the unit solutions of the active polar.
+ *
+ * The flow is solved once for the current operating point, then each move of the aoa, sideslip or speed sliders
+ * makes a transient operating point by superposition of the three unit solutions, without solving the flow again.
+ * Only the fixed wake polars of type 1 to 5 and 8 are supported. The transient operating points are not stored
+ * in the polar; the active operating point is restored when the dialog is closed.
+ */
+class WhatIfDlg : public QDialog
+{
+    Q_OBJECT
+
+    public:
+        WhatIfDlg(QWidget *pParent=nullptr);
+        ~WhatIfDlg() override;
+
+        bool initDialog(Plane *pPlane, PlanePolar const *pPlPolar, PlaneOpp const *pPOpp);
+
+        static void setXPlane(XPlane *pXPlane) {s_pXPlane=pXPlane;}
+
+    private:
+        void setupLayout();
+        void setLabels();
+
+    private slots:
+        void onSlider();
+
+    private:
+        QSlider *m_pslAlpha, *m_pslBeta, *m_pslSpeed;
+        QLabel *m_plabAlpha, *m_plabBeta, *m_plabSpeed;
+        QLabel *m_plabResults;
+
+        PlaneTask *m_pTask;
+        PlanePolar *m_pPolar;      /**< the copy of the active polar which receives the solved operating point */
+        PlaneOpp *m_pPOpp;         /**< the transient operating point displayed in the 3d view */
+        double m_RefSpeed;         /**< the speed at 100% of the speed slider */
+
+        static XPlane *s_pXPlane;
+};
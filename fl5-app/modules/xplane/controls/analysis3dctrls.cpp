@@ -40,6 +40,7 @@
 #include <modules/xplane/xplane.h>
 
 #include <api/planetask.h>
+#include <api/polarpreview.h>
 #include <core/xflcore.h>
 #include <api/utils.h>
 #include <api/units.h>
@@ -64,6 +65,7 @@ void Analysis3dCtrls::connectSignals()
     connect(m_pXRangeTable,        SIGNAL(pressed(QModelIndex)), SLOT(onSetControls()));
     connect(m_pchStorePOpps,       SIGNAL(clicked(bool)),        SLOT(onOption()));
     connect(m_pchStabDerivatives,  SIGNAL(clicked(bool)),        SLOT(onOption()));
+    connect(m_pchCoarsePreview,    SIGNAL(clicked(bool)),        SLOT(onOption()));
 }
 
 
@@ -100,8 +102,16 @@ void Analysis3dCtrls::setupLayout()
                                              "computed during a T12358 run.<br>"
                                              "Deactivate to save a little computation time."
                                              "</p>");
+            m_pchCoarsePreview = new QCheckBox("Coarse preview");
+            m_pchCoarsePreview->setToolTip("<p>"
+                                           "If activated, a fast VLM analysis of a decimated mesh is run first, "
+                                           "and its provisional results are displayed in the polar until they are replaced "
+                                           "by the results of the full analysis.<br>"
+                                           "The provisional points which have not been replaced are removed at the end of the analysis."
+                                           "</p>");
             pOptionLayout->addWidget(m_pchStorePOpps);
             pOptionLayout->addStretch();
+            pOptionLayout->addWidget(m_pchCoarsePreview);
             pOptionLayout->addWidget(m_pchStabDerivatives);
         }
 
@@ -128,8 +138,10 @@ void Analysis3dCtrls::showEvent(QShowEvent *pEvent)
     setAnalysisRange();
     m_pchStorePOpps->setChecked(XPlane::bStoreOpps3d());
     m_pchStabDerivatives->setChecked(Analysis3dSettings::bStabDerivatives());
+    m_pchCoarsePreview->setChecked(Analysis3dSettings::bCoarsePreview());
     PlanePolar const *pCurPlPolar = s_pXPlane->curPlPolar();
     m_pchStabDerivatives->setEnabled(pCurPlPolar && pCurPlPolar->isLinearPolar() && XPlane::bStoreOpps3d());
+    m_pchCoarsePreview->setEnabled(PolarPreview::canPreview(s_pXPlane->curPlane(), pCurPlPolar));
 }
 
 
@@ -237,6 +249,7 @@ void Analysis3dCtrls::setAnalysisRange()
     {
         m_pchStorePOpps->setEnabled(false);
         m_pchStabDerivatives->setEnabled(false);
+        m_pchCoarsePreview->setEnabled(false);
 
         m_pAnalysisRangeTable->setPolarType(xfl::EXTERNALPOLAR);
         m_pAnalysisRangeTable->fillTable();
@@ -245,6 +258,7 @@ void Analysis3dCtrls::setAnalysisRange()
 
     m_pchStorePOpps->setEnabled(true);
     m_pchStabDerivatives->setEnabled(pCurPlPolar && pCurPlPolar->isLinearPolar() && XPlane::bStoreOpps3d());
+    m_pchCoarsePreview->setEnabled(PolarPreview::canPreview(s_pXPlane->curPlane(), pCurPlPolar));
 
     if(pCurPlPolar->isType8())
     {
@@ -266,8 +280,10 @@ void Analysis3dCtrls::onOption()
 {
     XPlane::setStoreOpps3d(m_pchStorePOpps->isChecked());
     Analysis3dSettings::setStabDerivatives(m_pchStabDerivatives->isChecked());
+    Analysis3dSettings::setCoarsePreview(m_pchCoarsePreview->isChecked());
     PlanePolar const *pCurPlPolar = s_pXPlane->curPlPolar();
     m_pchStabDerivatives->setEnabled(pCurPlPolar && pCurPlPolar->isLinearPolar() && XPlane::bStoreOpps3d());
+    m_pchCoarsePreview->setEnabled(PolarPreview::canPreview(s_pXPlane->curPlane(), pCurPlPolar));
 }
 
 
@@ -278,6 +294,7 @@ void Analysis3dCtrls::onSetControls()
     m_ppbAnalyze->setEnabled(pCurPlPolar);
     m_pchStorePOpps->setEnabled(pCurPlPolar);
     m_pchStabDerivatives->setEnabled(pCurPlPolar && pCurPlPolar->isLinearPolar() && XPlane::bStoreOpps3d());
+    m_pchCoarsePreview->setEnabled(PolarPreview::canPreview(s_pXPlane->curPlane(), pCurPlPolar));
 
     if(!pCurPlPolar)
     {
@@ -90,6 +90,7 @@ class Analysis3dCtrls : public QWidget
 
         QCheckBox *m_pchStorePOpps;
         QCheckBox *m_pchStabDerivatives;
+        QCheckBox *m_pchCoarsePreview;
 
 
         QLabel *m_plabParamName;
@@ -191,11 +191,18 @@ void PlaneExplorer::setTreeFont(const QFont &fnt)
 
 void PlaneExplorer::updatePOpps()
 {
+    POppGroups groups;
+    groupPOpps(groups);
+
+    std::vector<PlaneOpp const*> const noopps;
     for(int iPolar=0; iPolar<Objects3d::nPolars(); iPolar++)
     {
         PlanePolar const*pWPolar = Objects3d::plPolarAt(iPolar);
-        addPOpps(pWPolar);
+        if(!pWPolar) continue;
+        auto it = groups.find({pWPolar->planeName(), pWPolar->name()});
+        fillPOpps(wPolarItem(pWPolar), it!=groups.end() ? it->second : noopps);
     }
+    setOverallCheckStatus();
 }
 
 
@@ -231,6 +238,9 @@ void PlaneExplorer::fillModelView()
 
     ObjectTreeItem *pRootItem = m_pModel->rootItem();
 
+    POppGroups groups;
+    groupPOpps(groups);
+
     for(int iPlane=0; iPlane<Objects3d::nPlanes(); iPlane++)
     {
         Plane const *pPlane = Objects3d::planeAt(iPlane);
@@ -239,8 +249,9 @@ void PlaneExplorer::fillModelView()
         LineStyle ls(pPlane->theStyle());
         ObjectTreeItem *pPlaneItem = m_pModel->appendRow(pRootItem, pPlane->name(), pPlane->theStyle(), planeState(pPlane));
 
-        fillWPolars(pPlaneItem, pPlane);
+        fillWPolars(pPlaneItem, pPlane, groups);
     }
+    setOverallCheckStatus();
 }
 
 
@@ -269,6 +280,15 @@ void PlaneExplorer::updatePlane(const Plane *pPlane)
 
 
 void PlaneExplorer::fillWPolars(ObjectTreeItem *pPlaneItem, const Plane *pPlane)
+{
+    POppGroups groups;
+    groupPOpps(groups);
+    fillWPolars(pPlaneItem, pPlane, groups);
+    setOverallCheckStatus();
+}
+
+
+void PlaneExplorer::fillWPolars(ObjectTreeItem *pPlaneItem, const Plane *pPlane, POppGroups const &groups)
 {
     if(!pPlane || !pPlaneItem) return;
 
@@ -280,9 +300,10 @@ void PlaneExplorer::fillWPolars(ObjectTreeItem *pPlaneItem, const Plane *pPlane)
         {
             LineStyle ls(pWPolar->theStyle());
             ls.m_bIsEnabled = true;
-            m_pModel->appendRow(pPlaneItem, pWPolar->name(), ls, polarState(pWPolar));
+            ObjectTreeItem *pWPolarItem = m_pModel->appendRow(pPlaneItem, pWPolar->name(), ls, polarState(pWPolar));
 
-            addPOpps(pWPolar);
+            auto it = groups.find({pWPolar->planeName(), pWPolar->name()});
+            if(it!=groups.end()) fillPOpps(pWPolarItem, it->second);
         }
     }
 }
@@ -293,9 +314,26 @@ void PlaneExplorer::addPOpps(const PlanePolar *pWPolar)
     if(!pWPolar) pWPolar = s_pXPlane->curPlPolar();
     if(!pWPolar) return;
 
-    bool bAdded(false);
+    ObjectTreeItem *pWPolarItem = wPolarItem(pWPolar);
+    if(pWPolarItem)
+    {
+        std::vector<PlaneOpp const*> popps;
+        for(int iOpp=0; iOpp<Objects3d::nPOpps(); iOpp++)
+        {
+            PlaneOpp const *pPOpp = Objects3d::POppAt(iOpp);
+            if(pPOpp->planeName().compare(pWPolar->planeName())==0 && pPOpp->polarName().compare(pWPolar->name())==0)
+                popps.push_back(pPOpp);
+        }
+        fillPOpps(pWPolarItem, popps);
+    }
 
-    //find this polar's plane parent
+    setOverallCheckStatus();
+}
+
+
+/** @return the tree item of the polar, or nullptr if the polar is not in the tree */
+ObjectTreeItem *PlaneExplorer::wPolarItem(PlanePolar const *pWPolar)
+{
     for(int ir=0; ir<m_pModel->rowCount(); ir++)
     {
         ObjectTreeItem *pPlaneItem = m_pModel->item(ir);
@@ -307,50 +345,55 @@ void PlaneExplorer::addPOpps(const PlanePolar *pWPolar)
             {
                 ObjectTreeItem *pWPolarItem = pPlaneItem->child(jr);
                 if(pWPolarItem->name().compare(QString::fromStdString(pWPolar->name()), Qt::CaseInsensitive)==0)
-                {
-                    QModelIndex polarindex = m_pModel->index(jr, 0, pPlaneItem);
-                    if(pWPolarItem->rowCount())
-                        m_pModel->removeRows(0, pWPolarItem->rowCount(), polarindex);
-
-                    for(int iOpp=0; iOpp<Objects3d::nPOpps(); iOpp++)
-                    {
-                        PlaneOpp const *pPOpp = Objects3d::POppAt(iOpp);
-                        if(pPOpp->planeName().compare(pWPolar->planeName())==0 && pPOpp->polarName().compare(pWPolar->name())==0)
-                        {
-                            QString strange = QString::fromStdString(pPOpp->name());
-                            strange = strange.rightJustified(9);
-                            ObjectTreeItem *pPOppItem = nullptr;
-                            if(s_pXPlane->isPOppView())
-                            {
-                                LineStyle ls(pPOpp->theStyle());
-                                ls.m_bIsEnabled = true;
-                                pPOppItem = m_pModel->appendRow(pWPolarItem, strange, ls, pPOpp->isVisible() ? Qt::Checked : Qt::Unchecked);
-                            }
-                            else
-                            {
-                                LineStyle ls(pPOpp->theStyle());
-                                ls.m_bIsEnabled = false;
-                                pPOppItem = m_pModel->appendRow(pWPolarItem, strange, ls, Qt::PartiallyChecked);
-                            }
-                            (void)pPOppItem;
-/*                            if(pPOpp->isType7() && pPOppItem)
-                            {
-                                for(int iMode=0; iMode<8; iMode++)
-                                {
-                                    m_pModel->appendRow(pPOppItem, QString::asprintf("Mode %d", iMode+1), LineStyle(), Qt::Unchecked);
-                                }
-                            }*/
-                        }
-                    }
-                    bAdded = true;
-                    break;
-                }
+                    return pWPolarItem;
             }
+            return nullptr;
         }
-        if(bAdded) break;
     }
+    return nullptr;
+}
 
-    setOverallCheckStatus();
+
+/**
+ * Updates the operating point items of the polar so that they match the list of operating points.
+ * Only the items which have been added or removed are notified to the view, so that adding the results
+ * of an analysis to a polar with many operating points does not rebuild the polar's branch.
+ */
+void PlaneExplorer::fillPOpps(ObjectTreeItem *pWPolarItem, std::vector<PlaneOpp const*> const &popps)
+{
+    if(!pWPolarItem) return;
+
+    QVector<ObjectTreeModel::Row> rows(int(popps.size()));
+    for(uint iOpp=0; iOpp<popps.size(); iOpp++)
+    {
+        PlaneOpp const *pPOpp = popps.at(iOpp);
+        ObjectTreeModel::Row &row = rows[iOpp];
+        row.m_Name = QString::fromStdString(pPOpp->name()).rightJustified(9);
+        row.m_LS = pPOpp->theStyle();
+        if(s_pXPlane->isPOppView())
+        {
+            row.m_LS.m_bIsEnabled = true;
+            row.m_State = pPOpp->isVisible() ? Qt::Checked : Qt::Unchecked;
+        }
+        else
+        {
+            row.m_LS.m_bIsEnabled = false;
+            row.m_State = Qt::PartiallyChecked;
+        }
+    }
+    m_pModel->mergeRows(pWPolarItem, rows);
+}
+
+
+/** Groups the operating points of the database by plane and polar names, in one pass */
+void PlaneExplorer::groupPOpps(POppGroups &groups)
+{
+    groups.clear();
+    for(int iOpp=0; iOpp<Objects3d::nPOpps(); iOpp++)
+    {
+        PlaneOpp const *pPOpp = Objects3d::POppAt(iOpp);
+        groups[{pPOpp->planeName(), pPOpp->polarName()}].push_back(pPOpp);
+    }
 }
 
 
@@ -25,6 +25,10 @@
 
 #pragma once
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include <QSettings>
 #include <QSplitter>
 #include <QModelIndex>
@@ -127,6 +131,12 @@ class PlaneExplorer : public QWidget
     private:
         void setupLayout();
 
+        typedef std::map<std::pair<std::string, std::string>, std::vector<PlaneOpp const*>> POppGroups;
+        static void groupPOpps(POppGroups &groups);
+        void fillWPolars(ObjectTreeItem *pPlaneItem, const Plane *pPlane, POppGroups const &groups);
+        void fillPOpps(ObjectTreeItem *pWPolarItem, std::vector<PlaneOpp const*> const &popps);
+        ObjectTreeItem *wPolarItem(PlanePolar const *pWPolar);
+
     private:
         ExpandableTreeView *m_pTreeView;
         ObjectTreeModel *m_pModel;
@@ -422,7 +422,7 @@ void POpp3dCtrls::on3dCp()
 
     double qDyn=1.0;
     PlaneOpp *pPOpp = s_pXPlane->m_pCurPOpp;
-    if(pPOpp && m_b3dCp)
+    if(pPOpp && pPOpp->hasFields() && m_b3dCp)
     {
         if(s_pXPlane->m_pCurPOpp->isTriLinearMethod())
         {
@@ -458,7 +458,7 @@ void POpp3dCtrls::onGamma()
 
     double qDyn=1.0;
     PlaneOpp *pPOpp = s_pXPlane->m_pCurPOpp;
-    if(pPOpp && m_bGamma)
+    if(pPOpp && pPOpp->hasFields() && m_bGamma)
     {
         if(pPOpp->isTriLinearMethod())
         {
@@ -492,7 +492,7 @@ void POpp3dCtrls::onPanelForce()
 
     double qDyn=1.0;
     PlaneOpp *pPOpp = s_pXPlane->m_pCurPOpp;
-    if(pPOpp && m_bPanelForce)
+    if(pPOpp && pPOpp->hasFields() && m_bPanelForce)
     {
         qDyn=0.5*s_pXPlane->m_pCurPlPolar->density()*s_pXPlane->m_pCurPOpp->QInf()*s_pXPlane->m_pCurPOpp->QInf();
         qDyn *= Units::PatoUnit();
@@ -49,6 +49,7 @@
 #include <api/p3linanalysis.h>
 #include <api/p3unianalysis.h>
 #include <api/p4analysis.h>
+#include <api/fieldsampler.h>
 #include <api/panel3.h>
 #include <api/panel4.h>
 #include <api/planeopp.h>
@@ -91,6 +92,7 @@ bool gl3dXPlaneView::s_bResetglDownwash(true);
 bool gl3dXPlaneView::s_bResetglPanelGamma(true);
 bool gl3dXPlaneView::s_bResetglPanelCp(true);
 bool gl3dXPlaneView::s_bResetglPanelForce(true);
+bool gl3dXPlaneView::s_bResetglColourMapGeom(true);
 bool gl3dXPlaneView::s_bResetglStream(true);
 bool gl3dXPlaneView::s_bResetglVortons(true);
 
@@ -294,7 +296,7 @@ void gl3dXPlaneView::glRenderPanelBasedBuffers()
                                  W3dPrefs::vortonRadius()/double(m_glScalef), W3dPrefs::vortonColour(), false, true);
         }
 
-        if(m_pCrossFlowCtrls && m_pCrossFlowCtrls->bVorticityMap() && pPOpp->m_Vorton.size())
+        if(m_pCrossFlowCtrls && m_pCrossFlowCtrls->bVorticityMap() && pPOpp->hasVortons())
         {
             paintColourMap(m_pglXPlaneBuffers->m_vboContourClrs, m_matModel);
             paintSegments(m_pglXPlaneBuffers->m_vboContourLines, W3dPrefs::s_ContourLineStyle);
@@ -388,26 +390,21 @@ void gl3dXPlaneView::glRenderPanelBasedBuffers()
 
     if(pPOpp)
     {
-        if(m_pPOpp3dControls->m_b3dCp)
+        bool bFields = pPOpp->hasFields(); // false if only the scalar results have been kept
+        if(bFields && m_pPOpp3dControls->m_b3dCp)
         {
-            if(pPOpp->isQuadMethod())
-                paintColourMap(m_pglXPlaneBuffers->m_vboCp, m_matModel); // two triangles/quad
-            else if(pPOpp->isTriangleMethod())
-            {
-                paintColourMap(m_pglXPlaneBuffers->m_vboCp, m_matModel);
-            }
+            if(pPOpp->isQuadMethod() || pPOpp->isTriangleMethod())
+                paintColourMap(m_pglXPlaneBuffers->m_vboColourMapGeom, m_pglXPlaneBuffers->m_vboCp, m_matModel);
         }
-        else if(m_pPOpp3dControls->m_bGamma)
+        else if(bFields && m_pPOpp3dControls->m_bGamma)
         {
-            if(pPOpp->isQuadMethod())
-                paintColourMap(m_pglXPlaneBuffers->m_vboGamma, m_matModel); // two triangles/quad
-            else if(pPOpp->isTriangleMethod())
-                paintColourMap(m_pglXPlaneBuffers->m_vboGamma, m_matModel);
+            if(pPOpp->isQuadMethod() || pPOpp->isTriangleMethod())
+                paintColourMap(m_pglXPlaneBuffers->m_vboColourMapGeom, m_pglXPlaneBuffers->m_vboGamma, m_matModel);
         }
 
-        if(m_pPOpp3dControls->m_bPanelForce && (pPOpp->isPanelMethod() || pPOpp->isVLMMethod()))
+        if(bFields && m_pPOpp3dControls->m_bPanelForce && (pPOpp->isPanelMethod() || pPOpp->isVLMMethod()))
         {
-            paintColorSegments(m_pglXPlaneBuffers->m_vboPanelForces, 2.0f, Line::SOLID);
+            paintArrowInstances(m_pglXPlaneBuffers->m_vboPanelForces, 2.0f, Line::SOLID);
         }
 
         if(m_pPOpp3dControls->m_bMoments)
@@ -606,7 +603,7 @@ void gl3dXPlaneView::glRenderPOppBasedBuffers()
         }
     }
 
-    if(m_pPOpp3dControls->m_bStreamLines && !pPOpp->isLLTMethod())
+    if(m_pPOpp3dControls->m_bStreamLines && !pPOpp->isLLTMethod() && pPOpp->hasFields())
     {
         if(!s_bResetglStream)
             paintStreamLines(m_pglXPlaneBuffers->m_vboStreamLines, m_StreamLineColours, StreamLineCtrls::nX());
@@ -915,7 +912,7 @@ void gl3dXPlaneView::hideEvent(QHideEvent *pEvent)
 bool gl3dXPlaneView::glMakeStreamLines(const std::vector<Panel3> &panel3list, std::vector<Node>const &nodelist, PlaneOpp const *pPOpp)
 {
     if(m_pglXPlaneBuffers->m_vboStreamLines.isCreated()) m_pglXPlaneBuffers->m_vboStreamLines.destroy();
-    if(!pPOpp || pPOpp->isLLTMethod()) return false;
+    if(!pPOpp || pPOpp->isLLTMethod() || !pPOpp->hasFields()) return false;
 
     if(!s_pXPlane->curPlane()) return false;
 
@@ -1042,20 +1039,25 @@ bool gl3dXPlaneView::glMakeStreamLines(const std::vector<Panel3> &panel3list, st
     {
         m_pP3UniAnalysis->initializeAnalysis(s_pXPlane->curPlPolar(),0);
         m_pP3UniAnalysis->setTriMesh(s_pXPlane->curPlane()->triMesh());
-        m_pP3UniAnalysis->setVortons(pPOpp->m_Vorton);
+        m_pP3UniAnalysis->setVortons(pPOpp->vortons());
     }
     else if(s_pXPlane->curPlPolar()->isTriLinearMethod())
     {
         m_pP3LinAnalysis->initializeAnalysis(s_pXPlane->curPlPolar(),0);
         m_pP3LinAnalysis->setTriMesh(s_pXPlane->curPlane()->triMesh());
-        m_pP3LinAnalysis->setVortons(pPOpp->m_Vorton);
+        m_pP3LinAnalysis->setVortons(pPOpp->vortons());
     }
     m_pP3UniAnalysis->makeWakePanels(Vector3d(1.0, 0.0, 0.0), s_pXPlane->curPlPolar()->bVortonWake());
 
 
-    // multithreaded mode only
+    P3Analysis *pP3Analysis = nullptr;
+    if     (s_pXPlane->curPlPolar()->isTriUniformMethod()) pP3Analysis = m_pP3UniAnalysis;
+    else if(s_pXPlane->curPlPolar()->isTriLinearMethod())  pP3Analysis = m_pP3LinAnalysis;
+
+    // the cache is shared by all the lines
+    StreamVelocityCache velcache(pP3Analysis, pPOpp->gamma().data(), pPOpp->sigma().data(), StreamLineCtrls::l0());
+
     QApplication::setOverrideCursor(Qt::WaitCursor);
-    QFutureSynchronizer<void> futureSync;
     QVector<StreamlineMaker*> makers;
     double range = objectReferenceLength();
 
@@ -1082,20 +1084,16 @@ bool gl3dXPlaneView::glMakeStreamLines(const std::vector<Panel3> &panel3list, st
         StreamlineMaker *pLineMaker = new StreamlineMaker;
         makers.append(pLineMaker);
         pLineMaker->setOpp(s_pXPlane->curPlPolar(), pPOpp->QInf(), 0.0, 0.0, pPOpp->gamma().data(), pPOpp->sigma().data());
-        if     (s_pXPlane->curPlPolar()->isTriUniformMethod()) pLineMaker->setP3Analysis(m_pP3UniAnalysis);
-        else if(s_pXPlane->curPlPolar()->isTriLinearMethod())  pLineMaker->setP3Analysis(m_pP3LinAnalysis);
+        pLineMaker->setP3Analysis(pP3Analysis);
+        if(StreamLineCtrls::bCacheVelocity()) pLineMaker->setVelocityCache(&velcache);
         pLineMaker->initializeLineMaker(in, StreamVertexArray.data()+iv, C, v0List[in], TC,
                                         StreamLineCtrls::nX(), StreamLineCtrls::l0(), StreamLineCtrls::XFactor());
 
- #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-        futureSync.addFuture(QtConcurrent::run(pLineMaker, &StreamlineMaker::run));
-
-#else
-            futureSync.addFuture(QtConcurrent::run(&StreamlineMaker::run, pLineMaker));
-#endif
         iv += (StreamLineCtrls::nX()+1)*3;
     }
-    futureSync.waitForFinished();
+    pP3Analysis->makePanelTree(pPOpp->gamma().data(), pPOpp->sigma().data());
+    StreamlineMaker::runAll(makers);
+    pP3Analysis->clearPanelTree();
 
     for(int i=0; i<makers.size(); i++)
     {
@@ -1117,7 +1115,7 @@ bool gl3dXPlaneView::glMakeStreamLines(const std::vector<Panel3> &panel3list, st
 bool gl3dXPlaneView::glMakeStreamLines(std::vector<Panel4> const &panel4list, PlaneOpp const *pPOpp)
 {
     if(m_pglXPlaneBuffers->m_vboStreamLines.isCreated()) m_pglXPlaneBuffers->m_vboStreamLines.destroy();
-    if(!pPOpp) return false;
+    if(!pPOpp || !pPOpp->hasFields()) return false;
     if(!s_pXPlane->curPlane() || !s_pXPlane->curPlane()->isXflType()) return false;
 
     PlaneXfl const * pPlaneXfl = dynamic_cast<PlaneXfl*>(s_pXPlane->curPlane());
@@ -1259,12 +1257,13 @@ bool gl3dXPlaneView::glMakeStreamLines(std::vector<Panel4> const &panel4list, Pl
         m_pP4Analysis->initializeAnalysis(s_pXPlane->curPlPolar(), 0);
     }
 
-    m_pP4Analysis->setVortons(pPOpp->m_Vorton);
+    m_pP4Analysis->setVortons(pPOpp->vortons());
+
 
+    // the cache is shared by all the lines
+    StreamVelocityCache velcache(m_pP4Analysis, pPOpp->gamma().data(), pPOpp->sigma().data(), StreamLineCtrls::l0());
 
-    // multithreaded mode only
     QApplication::setOverrideCursor(Qt::WaitCursor);
-    QFutureSynchronizer<void> futureSync;
     QVector<StreamlineMaker*> makers;
 //    double range = gl3dScales::referenceLength();
 
@@ -1289,21 +1288,19 @@ bool gl3dXPlaneView::glMakeStreamLines(std::vector<Panel4> const &panel4list, Pl
         }
 
         StreamlineMaker *pLineMaker = new StreamlineMaker(this);
+        makers.append(pLineMaker);
         pLineMaker->setOpp(s_pXPlane->curPlPolar(), pPOpp->QInf(), 0.0, 0.0, pPOpp->gamma().data(), pPOpp->sigma().data());
         pLineMaker->setP4Analysis(m_pP4Analysis);
+        if(StreamLineCtrls::bCacheVelocity()) pLineMaker->setVelocityCache(&velcache);
 
         pLineMaker->initializeLineMaker(in, StreamVertexArray.data()+iv, C, V0, TC,
                                         StreamLineCtrls::nX(), StreamLineCtrls::l0(), StreamLineCtrls::XFactor());
 
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-        futureSync.addFuture(QtConcurrent::run(pLineMaker, &StreamlineMaker::run));
-#else
-        futureSync.addFuture(QtConcurrent::run(&StreamlineMaker::run, pLineMaker));
-#endif
-
         iv += (StreamLineCtrls::nX()+1)*3;
     }
-    futureSync.waitForFinished();
+    m_pP4Analysis->makePanelTree(pPOpp->gamma().data(), pPOpp->sigma().data());
+    StreamlineMaker::runAll(makers);
+    m_pP4Analysis->clearPanelTree();
 
 
     for(int i=0; i<makers.size(); i++)
@@ -1338,7 +1335,7 @@ void gl3dXPlaneView::computeP4VelocityVectors(Opp3d const *pPOpp, QVector<Vector
         m_pP4Analysis->setQuadMesh(pPlaneXfl->quadMesh());
         m_pP4Analysis->initializeAnalysis(s_pXPlane->curPlPolar(), 0);
     }
-    m_pP4Analysis->setVortons(pPOpp->m_Vorton);
+    m_pP4Analysis->setVortons(pPOpp->vortons());
 
 
     if(bMultithread)
@@ -1380,13 +1377,13 @@ void gl3dXPlaneView::computeP3VelocityVectors(Opp3d const *pPOpp, QVector<Vector
     {
         m_pP3UniAnalysis->setTriMesh(pPlane->triMesh());
         m_pP3UniAnalysis->initializeAnalysis(s_pXPlane->curPlPolar(),0);
-        m_pP3UniAnalysis->setVortons(pPOpp->m_Vorton);
+        m_pP3UniAnalysis->setVortons(pPOpp->vortons());
     }
     else if(s_pXPlane->curPlPolar()->isTriLinearMethod())
     {
         m_pP3LinAnalysis->setTriMesh(pPlane->triMesh());
         m_pP3LinAnalysis->initializeAnalysis(s_pXPlane->curPlPolar(),0);
-        m_pP3LinAnalysis->setVortons(pPOpp->m_Vorton);
+        m_pP3LinAnalysis->setVortons(pPOpp->vortons());
     }
 
     if(bMultithread)
@@ -1418,6 +1415,58 @@ void gl3dXPlaneView::computeP3VelocityVectors(Opp3d const *pPOpp, QVector<Vector
 }
 
 
+/** Initializes the analysis of the current polar with the mesh and the vortons of the operating point
+ * and returns it, ready for the evaluation of the velocities. */
+PanelAnalysis *gl3dXPlaneView::prepareVelocityAnalysis(Opp3d const *pPOpp)
+{
+    Plane *pPlane = s_pXPlane->curPlane();
+    PlanePolar const *pWPolar = s_pXPlane->curPlPolar();
+    if(!pPlane || !pWPolar || !pPOpp || !pPOpp->hasFields()) return nullptr;
+
+    if(pWPolar->isQuadMethod())
+    {
+        if(!pPlane->isXflType()) return nullptr;
+        if(m_pP4Analysis->polar3d()!=pWPolar)
+        {
+            PlaneXfl * pPlaneXfl = dynamic_cast<PlaneXfl*>(pPlane);
+            m_pP4Analysis->setQuadMesh(pPlaneXfl->quadMesh());
+            m_pP4Analysis->initializeAnalysis(pWPolar, 0);
+        }
+        m_pP4Analysis->setVortons(pPOpp->vortons());
+        return m_pP4Analysis;
+    }
+    else if(pWPolar->isTriUniformMethod())
+    {
+        m_pP3UniAnalysis->setTriMesh(pPlane->triMesh());
+        m_pP3UniAnalysis->initializeAnalysis(pWPolar,0);
+        m_pP3UniAnalysis->setVortons(pPOpp->vortons());
+        return m_pP3UniAnalysis;
+    }
+    else if(pWPolar->isTriLinearMethod())
+    {
+        m_pP3LinAnalysis->setTriMesh(pPlane->triMesh());
+        m_pP3LinAnalysis->initializeAnalysis(pWPolar,0);
+        m_pP3LinAnalysis->setVortons(pPOpp->vortons());
+        return m_pP3LinAnalysis;
+    }
+    return nullptr;
+}
+
+
+/** Samples the flow field of the operating point on the sampler's grid, in the calling thread */
+void gl3dXPlaneView::sampleField(Opp3d const *pPOpp, FieldSampler &sampler)
+{
+    PanelAnalysis *pAnalysis = prepareVelocityAnalysis(pPOpp);
+    if(!pAnalysis) return;
+
+    // the wake is aligned with the x-axis in the body frame used for the display
+    sampler.setAnalysis(pAnalysis, pPOpp->gamma().data(), pPOpp->sigma().data(), Vector3d(pPOpp->QInf(), 0.0, 0.0));
+    pAnalysis->makePanelTree(pPOpp->gamma().data(), pPOpp->sigma().data());
+    sampler.run();
+    pAnalysis->clearPanelTree();
+}
+
+
 void gl3dXPlaneView::makeQuadVelocityBlock(int iBlock, QVector<Vector3d> const &C, double const *mu, double const*sigma, Vector3d *VField) const
 {
     int blockSize = int(C.size()/m_nBlocks) +1;
@@ -1726,89 +1775,36 @@ void gl3dXPlaneView::mouseMoveEvent(QMouseEvent *pEvent)
 
 bool gl3dXPlaneView::pickTriUniPanel(QPoint const &point)
 {
-    Vector3d I, AA, BB;
-
-    screenToWorld(point, 0.0, AA);
-    screenToWorld(point, 1.0, BB);
-
-    Vector3d U = (BB-AA).normalized();
-
-    QVector4D v4d;
-
     m_PickedPanelIndex = -1;
 
-//    Plane const *pPlane = s_pXPlane->m_pCurPlane;
     PlanePolar const *pWPolar = s_pXPlane->m_pCurPlPolar;
     PlaneOpp const *pPOpp = s_pXPlane->m_pCurPOpp;
 
-    float zmax = LARGEVALUE;
-    if(pPOpp && (m_pPOpp3dControls->m_b3dCp || m_pPOpp3dControls->m_bGamma || m_pPOpp3dControls->m_bPanelForce))
+    if(!hasPickTree()) makePickTree(m_Panel3Visible);
+
+    Vector3d I;
+    int iPick = pickTreePanel(point, I);
+    if(iPick<0 || iPick>=int(m_Panel3Visible.size())) return false;
+
+    Panel3 const &p3 = m_Panel3Visible.at(iPick);
+    int idx = p3.index();
+    m_PickedPoint = I;
+    m_PickedPanelIndex = idx;
+
+    if(pPOpp && pPOpp->hasFields() && (m_pPOpp3dControls->m_b3dCp || m_pPOpp3dControls->m_bGamma || m_pPOpp3dControls->m_bPanelForce))
     {
-        // pick element
-//        for(int i3=0; i3<pPlane->nPanel3(); i3++)
-//        {
-//            Panel3 const &p3 = pPlane->panel3At(i3);
-        for(uint i3=0; i3<m_Panel3Visible.size(); i3++)
+        if(m_pPOpp3dControls->m_bPanelForce)
         {
-            Panel3 const &p3 = m_Panel3Visible.at(i3);
-            int idx=p3.index();
-            if(p3.intersect(AA, U, I))
-            {
-                worldToScreen(p3.CoG(), v4d);
-                if(v4d.z()<zmax)
-                {
-                    zmax = v4d.z();
-                    m_PickedPoint = I;
-
-                    if(m_pPOpp3dControls->m_bPanelForce)
-                    {
-                        double q = 0.5*pWPolar->density()*pPOpp->QInf()*pPOpp->QInf();
-                        m_PickedVal =  pPOpp->Cp(idx*3)* q*Units::PatoUnit();
-                    }
-                    else if(m_pPOpp3dControls->m_bGamma)
-                    {
-                        m_PickedVal = pPOpp->gamma(idx*3);
-                    }
-                    else
-                    {
-                        m_PickedVal = pPOpp->Cp(idx*3);
-                    }
-                    m_PickedPanelIndex = p3.index();
-                }
-            }
+            double q = 0.5*pWPolar->density()*pPOpp->QInf()*pPOpp->QInf();
+            m_PickedVal =  pPOpp->Cp(idx*3)* q*Units::PatoUnit();
         }
-    }
-    else
-    {
-/*        for(int i3=0; i3<pPlane->nPanel3(); i3++)
+        else if(m_pPOpp3dControls->m_bGamma)
         {
-            Panel3 const &p3 = pPlane->panel3At(i3);
-            if(p3.intersect(AA, U, I))
-            {
-                worldToScreen(p3.CoG(), v4d);
-                if(v4d.z()<zmax)
-                {
-                    zmax = v4d.z();
-//                    m_PickedPoint = p3.CoG();
-                    m_PickedPoint = I;
-                    m_PickedPanelIndex = i3;
-                }
-            }
-        }*/
-        for(uint i3=0; i3<m_Panel3Visible.size(); i3++)
+            m_PickedVal = pPOpp->gamma(idx*3);
+        }
+        else
         {
-            Panel3 const &p3 = m_Panel3Visible.at(i3);
-            if(p3.intersect(AA, U, I))
-            {
-                worldToScreen(p3.CoG(), v4d);
-                if(v4d.z()<zmax)
-                {
-                    zmax = v4d.z();
-//                    m_PickedPoint = p3.CoG();
-                    m_PickedPoint = I;
-                    m_PickedPanelIndex = p3.index();
-                }
-            }
+            m_PickedVal = pPOpp->Cp(idx*3);
         }
     }
 
@@ -1816,82 +1812,46 @@ bool gl3dXPlaneView::pickTriUniPanel(QPoint const &point)
 }
 
 
+/**
+ * Picks the visible quad panel under the mouse point.
+ * Only the panels of the visible parts can be picked, as in the case of the triangular meshes.
+ */
 bool gl3dXPlaneView::pickQuadPanel(QPoint const &point)
 {
     PlaneXfl * pPlaneXfl = dynamic_cast<PlaneXfl*>(s_pXPlane->curPlane());
     if(!pPlaneXfl) return false;
 
-    Vector3d I, AA, BB;
-
-    screenToWorld(point, 0.0, AA);
-    screenToWorld(point, 1.0, BB);
+    m_PickedPanelIndex = -1;
 
-    Vector3d U = (BB-AA).normalized();
+    if(!hasPickTree()) makePickTree(m_Panel4Visible);
 
-    QVector4D v4d;
+    Vector3d I;
+    int iPick = pickTreePanel(point, I);
+    if(iPick<0 || iPick>=int(m_Panel4Visible.size())) return false;
 
-    m_PickedPanelIndex = -1;
+    Panel4 const &p4 = m_Panel4Visible.at(iPick);
+    m_PickedPoint = p4.CoG();
+    m_PickedPanelIndex = p4.index();
 
     PlaneOpp const *pPOpp = s_pXPlane->m_pCurPOpp;
-    float zmax = +1.e10;
-    //    double dcrit = 0.05/m_glScaled;
-    if(pPOpp && (m_pPOpp3dControls->m_b3dCp || m_pPOpp3dControls->m_bGamma || m_pPOpp3dControls->m_bPanelForce))
+    if(pPOpp && pPOpp->hasFields() && (m_pPOpp3dControls->m_b3dCp || m_pPOpp3dControls->m_bGamma || m_pPOpp3dControls->m_bPanelForce))
     {
-        if(pPOpp->isQuadMethod() && s_pXPlane->curPlane()->isXflType())
+        if(pPOpp->isQuadMethod())
         {
-            for(uint i4=0; i4<m_Panel4Visible.size(); i4++)
+            if(m_pPOpp3dControls->m_bPanelForce)
             {
-                Panel4 const &p4 = m_Panel4Visible.at(i4);
-                if(p4.intersect(AA, U, I))
-                {
-                    worldToScreen(p4.CoG(), v4d);
-
-                    if(v4d.z()<zmax)
-                    {
-                        zmax = v4d.z();
-                        m_PickedPoint = p4.CoG();
-
-                        if(m_pPOpp3dControls->m_bPanelForce)
-                        {
-                            m_PickedVal =  pPOpp->Cp(p4.index())* 0.5*pPOpp->QInf()*pPOpp->QInf()*Units::PatoUnit();
-                        }
-                        else if(m_pPOpp3dControls->m_bGamma)
-                        {
-                            m_PickedVal = pPOpp->gamma(p4.index());
-                        }
-                        else
-                        {
-                            m_PickedVal = pPOpp->Cp(p4.index());
-                        }
-
-                        m_PickedPanelIndex = p4.index();
-                    }
-                }
+                m_PickedVal =  pPOpp->Cp(p4.index())* 0.5*pPOpp->QInf()*pPOpp->QInf()*Units::PatoUnit();
             }
-        }
-    }
-    else
-    {
-        // pick a panel;
-        if(s_pXPlane->m_pCurPlPolar->isQuadMethod() && s_pXPlane->curPlane()->isXflType())
-        {
-            PlaneXfl const * pPlaneXfl = dynamic_cast<PlaneXfl const*>(s_pXPlane->curPlane());
-
-            for(int i4=0; i4<pPlaneXfl->quadMesh().nPanels(); i4++)
+            else if(m_pPOpp3dControls->m_bGamma)
             {
-                Panel4 const &p4 = pPlaneXfl->quadMesh().panelAt(i4);
-                if(p4.intersect(AA, U, I))
-                {
-                    worldToScreen(p4.CoG(), v4d);
-                    if(v4d.z()<zmax)
-                    {
-                        zmax = v4d.z();
-                        m_PickedPoint = p4.CoG();
-                        m_PickedPanelIndex = p4.index();
-                    }
-                }
+                m_PickedVal = pPOpp->gamma(p4.index());
+            }
+            else
+            {
+                m_PickedVal = pPOpp->Cp(p4.index());
             }
         }
+        else m_PickedPanelIndex = -1;
     }
 
     return m_PickedPanelIndex>=0;
@@ -2173,7 +2133,18 @@ void gl3dXPlaneView::glMakeOppBuffers()
     if(!pPOpp) return;
     if(pPOpp->polarName()!=pWPolar->name() || pPOpp->planeName()!=pWPolar->planeName()) return;
 
-    if(s_bResetglPanelCp || s_bResetglOpp || s_bResetglMesh)
+    if(s_bResetglColourMapGeom || s_bResetglMesh)
+    {
+        // the positions only depend on the mesh; switching operating points only uploads the values
+        if(pWPolar->isQuadMethod())          gl::makeQuadColourMapGeometry(m_Panel4Visible, m_pglXPlaneBuffers->m_vboColourMapGeom);
+        else if(pWPolar->isTriangleMethod()) gl::makeTriColourMapGeometry(m_Panel3Visible, m_pglXPlaneBuffers->m_vboColourMapGeom);
+        s_bResetglColourMapGeom = false;
+    }
+
+    // the operating points stored without their panel fields only display their scalar results
+    bool bFields = pPOpp->hasFields();
+
+    if(bFields && (s_bResetglPanelCp || s_bResetglOpp || s_bResetglMesh))
     {
         double lmin=0, lmax=0;
         if(m_pPOpp3dControls->m_b3dCp)
@@ -2182,7 +2153,7 @@ void gl3dXPlaneView::glMakeOppBuffers()
             {
                 lmin =Opp3dScalesCtrls::CpMin();
                 lmax =Opp3dScalesCtrls::CpMax();
-                gl::makeQuadNodeClrMap(m_Panel4Visible, pPOpp->m_Cp, lmin, lmax, Opp3dScalesCtrls::isAutoCpScale(), m_pglXPlaneBuffers->m_vboCp);
+                gl::makeQuadColourMapValues(m_Panel4Visible, pPOpp->m_Cp, lmin, lmax, Opp3dScalesCtrls::isAutoCpScale(), m_pglXPlaneBuffers->m_vboCp);
                 if(Opp3dScalesCtrls::isAutoCpScale()) m_pPOpp3dControls->m_pOpp3dScalesCtrls->updateCpRange(lmin, lmax);
 
             }
@@ -2192,7 +2163,7 @@ void gl3dXPlaneView::glMakeOppBuffers()
                 {
                     lmin =Opp3dScalesCtrls::CpMin();
                     lmax =Opp3dScalesCtrls::CpMax();
-                    gl::makeTriUniColorMap(m_Panel3Visible, pPOpp->m_Cp, lmin, lmax, Opp3dScalesCtrls::isAutoCpScale(), m_pglXPlaneBuffers->m_vboCp);
+                    gl::makeTriUniColourMapValues(m_Panel3Visible, pPOpp->m_Cp, lmin, lmax, Opp3dScalesCtrls::isAutoCpScale(), m_pglXPlaneBuffers->m_vboCp);
                     if(Opp3dScalesCtrls::isAutoCpScale()) m_pPOpp3dControls->m_pOpp3dScalesCtrls->updateCpRange(lmin, lmax);
                 }
                 else if(pPOpp->isTriLinearMethod())
@@ -2213,8 +2184,8 @@ void gl3dXPlaneView::glMakeOppBuffers()
                         lmax = Opp3dScalesCtrls::CpMax();
                     }
 
-                    gl::makeTriLinColorMap(m_Panel3Visible, pPlane->triMesh().nodes(), pPOpp->m_NodeValue,
-                                         lmin, lmax, m_pglXPlaneBuffers->m_vboCp);
+                    gl::makeTriLinColourMapValues(m_Panel3Visible, pPlane->triMesh().nNodes(), pPOpp->m_NodeValue,
+                                                  lmin, lmax, m_pglXPlaneBuffers->m_vboCp);
 
                 }
             }
@@ -2228,7 +2199,7 @@ void gl3dXPlaneView::glMakeOppBuffers()
         s_bResetglPanelCp = false;
     }
 
-    if(s_bResetglPanelGamma || s_bResetglOpp || s_bResetglMesh)
+    if(bFields && (s_bResetglPanelGamma || s_bResetglOpp || s_bResetglMesh))
     {
         double lmin(0), lmax(0);
         if(m_pPOpp3dControls->m_bGamma)
@@ -2237,16 +2208,16 @@ void gl3dXPlaneView::glMakeOppBuffers()
             {
                 lmin =Opp3dScalesCtrls::s_GammaMin;
                 lmax =Opp3dScalesCtrls::s_GammaMax;
-                gl::makeQuadNodeClrMap(m_Panel4Visible, pPOpp->m_gamma, lmin, lmax, Opp3dScalesCtrls::s_bAutoGammaScale,
-                                     m_pglXPlaneBuffers->m_vboGamma);
+                gl::makeQuadColourMapValues(m_Panel4Visible, pPOpp->m_gamma, lmin, lmax, Opp3dScalesCtrls::s_bAutoGammaScale,
+                                            m_pglXPlaneBuffers->m_vboGamma);
                 if(Opp3dScalesCtrls::s_bAutoGammaScale) m_pPOpp3dControls->m_pOpp3dScalesCtrls->updateGammaRange(lmin, lmax);
             }
             else if(pPOpp->isTriUniformMethod())
             {
                 lmin =Opp3dScalesCtrls::s_GammaMin;
                 lmax =Opp3dScalesCtrls::s_GammaMax;
-                gl::makeTriUniColorMap(m_Panel3Visible, pPOpp->m_gamma, lmin, lmax, Opp3dScalesCtrls::s_bAutoGammaScale,
-                                   m_pglXPlaneBuffers->m_vboGamma);
+                gl::makeTriUniColourMapValues(m_Panel3Visible, pPOpp->m_gamma, lmin, lmax, Opp3dScalesCtrls::s_bAutoGammaScale,
+                                              m_pglXPlaneBuffers->m_vboGamma);
                 if(Opp3dScalesCtrls::s_bAutoGammaScale) m_pPOpp3dControls->m_pOpp3dScalesCtrls->updateGammaRange(lmin, lmax);
             }
             else if(pPOpp->isTriLinearMethod())
@@ -2268,8 +2239,8 @@ void gl3dXPlaneView::glMakeOppBuffers()
                     lmax = Opp3dScalesCtrls::gammaMax();
                 }
 
-                gl::makeTriLinColorMap(m_Panel3Visible,  pPlane->triMesh().nodes(),
-                                     pPOpp->m_NodeValue, lmin, lmax, m_pglXPlaneBuffers->m_vboGamma);
+                gl::makeTriLinColourMapValues(m_Panel3Visible, pPlane->triMesh().nNodes(),
+                                              pPOpp->m_NodeValue, lmin, lmax, m_pglXPlaneBuffers->m_vboGamma);
             }
         }
         if(m_pPOpp3dControls->m_bGamma)
@@ -2281,7 +2252,7 @@ void gl3dXPlaneView::glMakeOppBuffers()
         s_bResetglPanelGamma = false;
     }
 
-    if(s_bResetglPanelForce || s_bResetglOpp || s_bResetglMesh)
+    if(bFields && (s_bResetglPanelForce || s_bResetglOpp || s_bResetglMesh))
     {
         double lmin(0), lmax(0);
         if (m_pPOpp3dControls->m_bPanelForce && pWPolar && pPOpp)
@@ -2380,7 +2351,7 @@ void gl3dXPlaneView::glMakeOppBuffers()
         }
     }
 
-    if((s_bResetglOpp || s_bResetglStream) && m_pPOpp3dControls->m_bStreamLines)
+    if(bFields && (s_bResetglOpp || s_bResetglStream) && m_pPOpp3dControls->m_bStreamLines)
     {
         s_bResetglStream = false; //Prevent multiple recalculations if new repaint signal received before streamline build is done
 
@@ -2398,7 +2369,7 @@ void gl3dXPlaneView::glMakeOppBuffers()
 
     if(s_bResetglOpp || s_bResetglVortons)
     {
-        gl::makeVortons(pPOpp->m_Vorton, m_pglXPlaneBuffers->m_vboVortons);
+        gl::makeVortons(pPOpp->vortonWake(), m_pglXPlaneBuffers->m_vboVortons);
         s_bResetglVortons = false;
     }
 
@@ -2416,7 +2387,7 @@ void gl3dXPlaneView::glMakeOppBuffers()
     {
         if(s_bResetglOpp || s_bResetglVorticity)
         {
-            if(pPOpp->m_Vorton.size())
+            if(pPOpp->hasVortons())
             {
                 double lmin = CrossFlowCtrls::omegaMin();
                 double lmax = CrossFlowCtrls::omegaMax();
@@ -3319,7 +3290,7 @@ void gl3dXPlaneView::glMakeFlowBuffers()
     PlanePolar   const *pWPolar = s_pXPlane->m_pCurPlPolar;
     PlaneOpp const *pPOpp   = s_pXPlane->m_pCurPOpp;
 
-    if(!m_pPOpp3dControls->isFlowActive() || !pPlane || !pWPolar ||!pPOpp || !pPOpp->isTriUniformMethod())
+    if(!m_pPOpp3dControls->isFlowActive() || !pPlane || !pWPolar ||!pPOpp || !pPOpp->isTriUniformMethod() || !pPOpp->hasFields())
     {
         if(m_ssboPanels.isCreated())  m_ssboPanels.destroy();
         if(m_ssboVortons.isCreated()) m_ssboVortons.destroy();
@@ -3332,7 +3303,7 @@ void gl3dXPlaneView::glMakeFlowBuffers()
     {
         m_pP3UniAnalysis->initializeAnalysis(s_pXPlane->curPlPolar(),0);
         m_pP3UniAnalysis->setTriMesh(s_pXPlane->curPlane()->triMesh());
-        m_pP3UniAnalysis->setVortons(pPOpp->m_Vorton);
+        m_pP3UniAnalysis->setVortons(pPOpp->vortons());
         m_pP3UniAnalysis->makeWakePanels(Vector3d(1.0,0,0), pWPolar->bVortonWake());
 
         // Create a VBO and an SSBO for the vortices
@@ -3471,23 +3442,21 @@ void gl3dXPlaneView::glMakeFlowBuffers()
 
         BufferArray.resize(buffersize);
         iv=0;
-        for(uint ir=0; ir<pPOpp->m_Vorton.size(); ir++)
+        VortonWake const &wake = pPOpp->vortonWake();
+        for(int i=0; i<wake.count(); i++)
         {
-            for(uint jc=0; jc<pPOpp->m_Vorton.at(ir).size(); jc++)
-            {
-                Vorton const &vtn = pPOpp->m_Vorton.at(ir).at(jc);
-
-                BufferArray[iv++] = vtn.xf();
-                BufferArray[iv++] = vtn.yf();
-                BufferArray[iv++] = vtn.zf();
-                BufferArray[iv++] = 1.0f;
-
-                BufferArray[iv++] = vtn.vortex().xf();
-                BufferArray[iv++] = vtn.vortex().yf();
-                BufferArray[iv++] = vtn.vortex().zf();
-                if(vtn.isActive())  BufferArray[iv++] = 1.0f;
-                else                BufferArray[iv++] = 0.0f;
-            }
+            Vector3d const omega = wake.vortex(i);
+
+            BufferArray[iv++] = wake.xf(i);
+            BufferArray[iv++] = wake.yf(i);
+            BufferArray[iv++] = wake.zf(i);
+            BufferArray[iv++] = 1.0f;
+
+            BufferArray[iv++] = omega.xf();
+            BufferArray[iv++] = omega.yf();
+            BufferArray[iv++] = omega.zf();
+            if(wake.isActive(i))  BufferArray[iv++] = 1.0f;
+            else                  BufferArray[iv++] = 0.0f;
         }
         Q_ASSERT(iv==buffersize);
 
@@ -35,6 +35,8 @@
 
 
 class CrossFlowCtrls;
+class FieldSampler;
+class PanelAnalysis;
 class PlaneXfl;
 class Panel3;
 class Panel4;
@@ -65,8 +67,8 @@ class gl3dXPlaneView : public gl3dXflView
 
         void setPlane(const Plane *pPlane);
 
-        void setVisiblePanels(std::vector<Panel4> const &p4visible) {m_Panel4Visible=p4visible;}
-        void setVisiblePanels(std::vector<Panel3> const &p3visible) {m_Panel3Visible=p3visible;}
+        void setVisiblePanels(std::vector<Panel4> const &p4visible) {m_Panel4Visible=p4visible; clearPickTree(); s_bResetglColourMapGeom=true;}
+        void setVisiblePanels(std::vector<Panel3> const &p3visible) {m_Panel3Visible=p3visible; clearPickTree(); s_bResetglColourMapGeom=true;}
         void setVisibleNodes(std::vector<Node> const &visiblenodes) {m_NodeVisible = visiblenodes;}
 
         glXPlaneBuffers *viewBuffers() {return m_pglXPlaneBuffers;}
@@ -144,6 +146,8 @@ class gl3dXPlaneView : public gl3dXflView
 
         void computeP4VelocityVectors(const Opp3d *pPOpp, QVector<Vector3d> const &points, QVector<Vector3d> &velvectors, bool bMultithread);
         void computeP3VelocityVectors(const Opp3d *pPOpp, const QVector<Vector3d> &points, QVector<Vector3d> &velvectors, bool bMultithread);
+        PanelAnalysis *prepareVelocityAnalysis(Opp3d const *pPOpp);
+        void sampleField(Opp3d const *pPOpp, FieldSampler &sampler);
 
         void paintOverlay() override;
 
@@ -220,6 +224,7 @@ class gl3dXPlaneView : public gl3dXflView
         static bool s_bResetglPanelGamma;         /**< true if the OpenGL lists need to be re-generated */
         static bool s_bResetglPanelCp;            /**< true if the OpenGL lists need to be re-generated */
         static bool s_bResetglPanelForce;         /**< true if the OpenGL lists need to be re-generated */
+        static bool s_bResetglColourMapGeom;      /**< true if the vertices of the colour maps need to be re-generated; the values are updated for each operating point */
         static bool s_bResetglStream;             /**< true if the streamlines OpenGL list needs to be re-generated */
         static bool s_bResetglVortons;            /**< true if the vortons need to be updated */
 };
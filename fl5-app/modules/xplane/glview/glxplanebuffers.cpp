@@ -73,6 +73,7 @@ void glXPlaneBuffers::clearBuffers()
     if( m_vboGridVelocities.isCreated())       m_vboGridVelocities.destroy();
     if(m_vboContourClrs.isCreated())           m_vboContourClrs.destroy();
     if(m_vboContourLines.isCreated())          m_vboContourLines.destroy();
+    if(m_vboColourMapGeom.isCreated())         m_vboColourMapGeom.destroy();
     if(m_vboCp.isCreated())                    m_vboCp.destroy();
     if(m_vboDownwash.isCreated())                    m_vboDownwash.destroy();
     if(m_vboFrames.isCreated())                m_vboFrames.destroy();
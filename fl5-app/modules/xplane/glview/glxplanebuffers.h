@@ -69,6 +69,7 @@ class glXPlaneBuffers
         double m_LiveAlpha;
         std::vector<std::vector<Vorton>> m_LiveVortons;
 
+        QOpenGLBuffer m_vboColourMapGeom; /**< the vertices of the Cp and gamma colour maps, which only hold the values */
         QOpenGLBuffer m_vboCp;
         QOpenGLBuffer m_vboGamma;
         QOpenGLBuffer m_vboPanelForces;
@@ -35,6 +35,7 @@
 #include <modules/xplane/xplane.h>
 #include <api/enums_objects.h>
 #include <api/planepolar.h>
+#include <api/planetask.h>
 #include <api/planexfl.h>
 
 XPlaneActions::XPlaneActions(XPlane *pXPlane) : QObject(pXPlane)
@@ -482,6 +483,10 @@ void XPlaneActions::makeActions()
     m_pShowOnlyCurPolar->setShortcut(QKeySequence(Qt::CTRL|Qt::SHIFT|Qt::Key_U));
     connect(m_pShowOnlyCurPolar, SIGNAL(triggered()), m_pXPlane, SLOT(onShowOnlyCurPlPolar()));
 
+    m_pWhatIfAct = new QAction("What-if", m_pXPlane);
+    m_pWhatIfAct->setStatusTip("Display in the 3d view the operating points made on the fly by superposition of the unit solutions of the active polar");
+    connect(m_pWhatIfAct, SIGNAL(triggered()), m_pXPlane, SLOT(onWhatIf()));
+
     m_pDeleteCurWPolar = new QAction("Delete", m_pXPlane);
     m_pDeleteCurWPolar->setStatusTip("Delete the active polar");
     connect(m_pDeleteCurWPolar, SIGNAL(triggered()), m_pXPlane, SLOT(onDeleteCurPlPolar()));
@@ -614,6 +619,7 @@ void XPlaneActions::checkActions()
     m_pShowCurWOppOnly->setChecked(m_pXPlane->m_bCurPOppOnly);
 
     m_pCheckFreeEdges->setEnabled(m_pXPlane->curPlPolar());
+    m_pWhatIfAct->setEnabled(m_pXPlane->curPlane() && PlaneTask::canSuperpose(m_pXPlane->curPlPolar()));
 }
 
 
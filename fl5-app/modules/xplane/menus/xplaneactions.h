@@ -59,6 +59,7 @@ class XPlaneActions : public QObject
         QAction *m_pSavePlaneAsProjectAct, *m_pRenameCurPlaneAct, *m_pDeleteCurPlane, *m_pDuplicateCurPlane;
         QAction *m_pEditWPolarPts, *m_pExportCurWPolar, *m_pCopyCurWPolarData, *m_pResetCurWPolar;
         QAction *m_pShowOnlyCurPolar;
+        QAction *m_pWhatIfAct;
         QAction *m_pEditWPolarDef, *m_pEditExtraDrag;
         QAction *m_pShowPolarProps, *m_pShowWOppProps;
         QAction *m_pRenameCurWPolar, *m_pDeleteCurWPolar, *m_pDuplicateCurWPolar;
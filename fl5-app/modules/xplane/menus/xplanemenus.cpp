@@ -554,6 +554,8 @@ void XPlaneMenus::createMainBarMenus()
             m_pCurWPlrMenu->addAction(pActions->m_pResetCurWPolar);
             m_pCurWPlrMenu->addAction(pActions->m_pShowOnlyCurPolar);
             m_pCurWPlrMenu->addSeparator();
+            m_pCurWPlrMenu->addAction(pActions->m_pWhatIfAct);
+            m_pCurWPlrMenu->addSeparator();
             QMenu *pPOppMenu = m_pCurWPlrMenu->addMenu("Associated operating points");
             {
                 pPOppMenu->addAction(pActions->m_pShowWPlrPOpps);
@@ -101,6 +101,7 @@
 #include <modules/xplane/analysis/batchxmldlg.h>
 #include <modules/xplane/analysis/lltanalysisdlg.h>
 #include <modules/xplane/analysis/planeanalysisdlg.h>
+#include <modules/xplane/analysis/whatifdlg.h>
 #include <modules/xplane/controls/analysis3dctrls.h>
 #include <modules/xplane/controls/planeexplorer.h>
 #include <modules/xplane/controls/popp3dctrls.h>
@@ -120,6 +121,7 @@
 #include <test/tests/panelanalysistest.h>
 #include <test/tests/vortontestdlg.h>
 
+#include <api/columnfile.h>
 #include <api/llttask.h>
 #include <api/p3analysis.h>
 #include <api/panelanalysis.h>
@@ -165,6 +167,7 @@ XPlane::XPlane(MainFrame *pMainFrame) : QObject()
     Analysis3dCtrls::setXPlane(this);
     CrossFlowCtrls::setXPlane(this);
     BatchXmlDlg::setXPlane(this);
+    WhatIfDlg::setXPlane(this);
     POpp3dCtrls::setXPlane(this);
     Stab3dCtrls::setXPlane(this);
     StabTimeCtrls::setXPlane(this);
@@ -884,7 +887,7 @@ void XPlane::createWPolarCurves()
 
                 // add left axis curves
                 Curve *pCurveL = pGraph->addCurve(QString::fromStdString(pWPolar->planeName() + " / " + pWPolar->name()), AXIS::LEFTYAXIS, DisplayOptions::isDarkTheme());
-                fillWPlrCurve(pCurveL, pWPolar, pGraph->xVariable(), pGraph->yVariable(0));
+                fillWPlrCurve(pCurveL, pWPolar, pGraph->xVariable(), pGraph->yVariable(0), pGraph->curveModel());
                 pCurveL->setTheStyle(pWPolar->theStyle());
                 pWPolar->appendCurve(pCurveL);
                 if(pWPolar==m_pCurPlPolar) pGraph->selectCurve(pCurveL);
@@ -893,7 +896,7 @@ void XPlane::createWPolarCurves()
                 if(pGraph->hasRightAxis())
                 {
                     Curve *pCurveR = pGraph->addCurve(QString::fromStdString(pWPolar->planeName() + " / " + pWPolar->name()), AXIS::RIGHTYAXIS, DisplayOptions::isDarkTheme());
-                    fillWPlrCurve(pCurveR, pWPolar, pGraph->xVariable(), pGraph->yVariable(1));
+                    fillWPlrCurve(pCurveR, pWPolar, pGraph->xVariable(), pGraph->yVariable(1), pGraph->curveModel());
                     pCurveR->setTheStyle(pWPolar->theStyle());
                     pWPolar->appendCurve(pCurveR);
                     if(pWPolar==m_pCurPlPolar) pGraph->selectCurve(pCurveR);
@@ -902,10 +905,15 @@ void XPlane::createWPolarCurves()
         }
     }
 
+    // discard the cached points of the deleted polars
+    QSet<void const*> polars;
+    for(int k=0; k<Objects3d::nPolars(); k++) polars.insert(Objects3d::plPolarAt(k));
+
     m_bResetCurves = false;
 
     for(int ig=0; ig<m_WPlrGraph.count(); ig++)
     {
+        if(m_WPlrGraph[ig]->curveModel()) m_WPlrGraph[ig]->curveModel()->trimCache(polars);
         m_WPlrGraph[ig]->invalidate();
     }
 }
@@ -1238,32 +1246,46 @@ void XPlane::fillStabCurve(Curve *pCurve, const PlanePolar *pWPolar, int iMode)
 }
 
 
-void XPlane::fillWPlrCurve(Curve *pCurve, PlanePolar const *pWPolar, int XVar, int YVar)
+void XPlane::fillWPlrCurve(Curve *pCurve, PlanePolar const *pWPolar, int XVar, int YVar, CurveModel *pCache)
 {
     pCurve->setSelectedPoint(-1);
-    for (int i=0; i<pWPolar->dataSize(); i++)
+
+    // the points are cached in user-defined units, so a change of units also invalidates them
+    qint64 revision = (qint64(pWPolar->dataRevision())<<32) | qint64(quint32(Units::revision()));
+    QPolygonF const *pCached = pCache ? pCache->cachedPoints(pWPolar, XVar, YVar, revision) : nullptr;
+    if(pCached)
     {
-        double x = pWPolar->variable(XVar, i); // returns the value in user-defined units
-        double y = pWPolar->variable(YVar, i); // returns the value in user-defined units
+        pCurve->setPoints(*pCached);
+    }
+    else
+    {
+        for (int i=0; i<pWPolar->dataSize(); i++)
+        {
+            double x = pWPolar->variable(XVar, i); // returns the value in user-defined units
+            double y = pWPolar->variable(YVar, i); // returns the value in user-defined units
 
+            // do not add negative speeds to the speed polar graphs- negative speeds occur in T1 analyses
+            if(XVar==29 || XVar==30)
+            {
+                if(x<=0.0) continue; // don't append
+            }
+            if(YVar==29 || YVar==30)
+            {
+                if(y<=0.0) continue; // don't append
+            }
 
-        // do not add negative speeds to the speed polar graphs- negative speeds occur in T1 analyses
-        if(XVar==29 || XVar==30)
-        {
-            if(x<=0.0) continue; // don't append
-        }
-        if(YVar==29 || YVar==30)
-        {
-            if(y<=0.0) continue; // don't append
+            pCurve->appendPoint(x,y);
         }
+        if(pCache) pCache->cachePoints(pWPolar, XVar, YVar, revision, pCurve->points());
+    }
 
-        pCurve->appendPoint(x,y);
+    if(m_pCurPOpp && pWPolar==m_pCurPlPolar && Graph::isHighLighting())
+    {
+        double d(0.001);
 
-        if(m_pCurPOpp && pWPolar==m_pCurPlPolar && Graph::isHighLighting())
+        if (m_pCurPlane && pWPolar->planeName()==m_pCurPlane->name() && m_pCurPOpp->polarName() ==pWPolar->name())
         {
-            double d(0.001);
-
-            if (m_pCurPOpp && m_pCurPlane && pWPolar->planeName()==m_pCurPlane->name() && m_pCurPOpp->polarName() ==pWPolar->name())
+            for (int i=0; i<pWPolar->dataSize(); i++)
             {
                 if(pWPolar->type()<xfl::T4POLAR)
                 {
@@ -2784,9 +2806,21 @@ Plane* XPlane::setModPlane(Plane *pModPlane, bool bUsed, bool bAsNew)
 
         return pPlane;
     }
-    else if(bUsed)
+
+    // keep the results which are not affected by the modification
+    Objects3d::enumPlaneEdit edit = Objects3d::GEOMETRYEDIT;
+    if(bUsed) edit = Objects3d::planeEditType(m_pCurPlane, pModPlane);
+    if(edit==Objects3d::STYLEEDIT)        bUsed = false;
+    else if(edit==Objects3d::INERTIAEDIT) bUsed = Objects3d::hasInertiaResults(m_pCurPlane);
+
+    if(bUsed)
     {
-        mdDlg.setQuestion("The modification will erase all results associated to this plane\n"
+        if(edit==Objects3d::INERTIAEDIT)
+            mdDlg.setQuestion("The modification will erase the results of the polars\n"
+                              "which use the plane's inertia\n"
+                              "Continue?");
+        else
+            mdDlg.setQuestion("The modification will erase all results associated to this plane\n"
                               "Continue?");
         mdDlg.initDialog();
 
@@ -2827,7 +2861,10 @@ Plane* XPlane::setModPlane(Plane *pModPlane, bool bUsed, bool bAsNew)
     }
 
     // either not used, or the user has decided to go ahead and overwrite
-    Objects3d::deletePlaneResults(m_pCurPlane, false); // delete polar data and operating points
+    if(edit==Objects3d::GEOMETRYEDIT)
+        Objects3d::deletePlaneResults(m_pCurPlane, false); // delete polar data and operating points
+    else if(edit==Objects3d::INERTIAEDIT)
+        Objects3d::deleteInertiaResults(m_pCurPlane);
     Objects3d::deletePlane(m_pCurPlane, false); // delete the plane, but keep the polars;
     m_pCurPlane = nullptr;
     Objects3d::addPlane(pModPlane); // add the plane to the array - polars are attached implicitely through plane name
@@ -2835,7 +2872,7 @@ Plane* XPlane::setModPlane(Plane *pModPlane, bool bUsed, bool bAsNew)
     if(pModPlane->isXflType())
         pModPlane->setInitialized(false); // mark the plane for rebuild
 
-    m_pCurPOpp = nullptr; // all the plane's oppoints have been deleted
+    m_pCurPOpp = nullptr; // the oppoint may have been deleted with the results
 
     setPlane(pModPlane);
     setPolar(m_pCurPlPolar);
@@ -3377,7 +3414,7 @@ void XPlane::onExportWPolarToFile()
     FileName.replace(".", "_");
     FileName = QFileDialog::getSaveFileName(s_pMainFrame, "Export Polar",
                                             SaveOptions::lastDirName() + "/"+FileName,
-                                            "Text File (*.txt);;Comma Separated Values (*.csv)",
+                                            "Text File (*.txt);;Comma Separated Values (*.csv);;Columnar binary (*.fl5c)",
                                             &filter);
 
     if(!FileName.length()) return;
@@ -3392,6 +3429,22 @@ void XPlane::onExportWPolarToFile()
         SaveOptions::setExportFileType(xfl::CSV);
         if(FileName.indexOf(".csv")<0) FileName +=".csv";
     }
+    else if(filter.indexOf("*.fl5c")>0)
+    {
+        if(!FileName.endsWith(".fl5c")) FileName +=".fl5c";
+
+        // the panel Cp distributions of the polar's operating points are written along with the polar's variables
+        std::vector<Opp3d const*> opps;
+        for(int io=0; io<Objects3d::nPOpps(); io++)
+        {
+            PlaneOpp const *pPOpp = Objects3d::POppAt(io);
+            if(pPOpp->planeName()==m_pCurPlPolar->planeName() && pPOpp->polarName()==m_pCurPlPolar->name())
+                opps.push_back(pPOpp);
+        }
+        if(!ColumnFile::exportPlanePolar(FileName.toStdString(), *m_pCurPlPolar, opps))
+            displayMessage("Error writing the file "+FileName+"\n", true, false);
+        return;
+    }
 
     QFile XFile(FileName);
     if (!XFile.open(QIODevice::WriteOnly | QIODevice::Text)) return;
@@ -4106,6 +4159,37 @@ void XPlane::onShowTargetCurve()
 }
 
 
+/**
+ * Opens the dialog which displays the operating points made by superposition of the unit solutions of the active polar.
+ * The transient operating points are not stored, and the active operating point is restored on exit.
+ */
+void XPlane::onWhatIf()
+{
+    if(!m_pCurPlane || !m_pCurPlPolar) return;
+    if(!PlaneTask::canSuperpose(m_pCurPlPolar))
+    {
+        displayMessage("The what-if mode requires a fixed wake polar of type 1, 2, 3, 4, 5 or 8\n", true, false);
+        return;
+    }
+
+    stopAnimate();
+    if(!is3dView()) on3dView();
+
+    PlaneOpp *pCurPOpp = m_pCurPOpp;
+    {
+        WhatIfDlg dlg(s_pMainFrame);
+        if(dlg.initDialog(m_pCurPlane, m_pCurPlPolar, pCurPOpp))
+            dlg.exec();
+        else
+            displayMessage("The analysis of the active polar failed\n", true, false);
+
+        // back to the stored operating point before the transient one is deleted with the dialog
+        setPlaneOpp(pCurPOpp);
+    }
+    updateView();
+}
+
+
 void XPlane::onShowPanelNormals()
 {
     m_pgl3dXPlaneView->m_bPanelNormals = m_pActions->m_pShowPanelNormals->isChecked();
@@ -6239,7 +6323,7 @@ void XPlane::outputPanelProperties(int panelindex)
         strange = QString::fromStdString(str);
     }
 
-    if(m_pCurPOpp && (m_pPOpp3dCtrls->m_b3dCp || m_pPOpp3dCtrls->m_bGamma || m_pPOpp3dCtrls->m_bPanelForce))
+    if(m_pCurPOpp && m_pCurPOpp->hasFields() && (m_pPOpp3dCtrls->m_b3dCp || m_pPOpp3dCtrls->m_bGamma || m_pPOpp3dCtrls->m_bPanelForce))
     {
         double q = 0.5*m_pCurPlPolar->density() *m_pCurPOpp->m_QInf*m_pCurPOpp->m_QInf;
         double cp(0), gamma(0);
@@ -6420,6 +6504,15 @@ void XPlane::onCheckPanels()
         if(dlg.checkMinAngles()) qVec = QVector<int>(anglelist.begin(),  anglelist.end());
         if(dlg.checkMinArea())   qVec = QVector<int>(arealist.begin(),   arealist.end());
         if(dlg.checkMinSize())   qVec = QVector<int>(sizelist.begin(),   sizelist.end());
+        if(dlg.checkIntersections())
+        {
+            std::string str;
+            std::vector<int> intersectlist, overlaplist;
+            m_pCurPlane->triMesh().checkIntersections(str, PanelCheckDlg::intersectionGap(), intersectlist, overlaplist, xfl::isMultiThreaded());
+            log += str;
+            qVec.append(QVector<int>(intersectlist.begin(), intersectlist.end()));
+            qVec.append(QVector<int>(overlaplist.begin(),   overlaplist.end()));
+        }
         m_pgl3dXPlaneView->appendHighlightList(qVec);
     }
 
@@ -7162,6 +7255,7 @@ void XPlane::exportPanel4DataToString(PlaneOpp const *pPOpp, Plane const *pPlane
     }
 
     if(!pWPolar->isQuadMethod()) return;
+    if(!pPOpp->hasFields()) return;
 
     PlaneXfl const *pPlaneXfl = dynamic_cast<PlaneXfl const*>(pPlane);
 
@@ -123,7 +123,7 @@ class XPlane : public QObject
         void createStabilityCurves();
         void displayStdMessage(std::string const &msg, bool bShowWindow, bool bStatusBar, int duration=5000);
         void displayMessage(QString const &msg, bool bShowWindow, bool bStatusBar, int duration=5000);
-        void fillWPlrCurve(Curve *pCurve, PlanePolar const*pWPolar, int XVar, int YVar);
+        void fillWPlrCurve(Curve *pCurve, PlanePolar const*pWPolar, int XVar, int YVar, CurveModel *pCache);
         void fillStabCurve(Curve *pCurve, PlanePolar const*pWPolar, int iMode);
         void fillWOppCurve(PlanePolar const *pWPolar, const PlaneOpp *pPOpp, int iw, int iVar, Curve *pCurve);
         PlaneXfl *importPlaneFromXML(QFile &xmlFile);
@@ -308,6 +308,7 @@ class XPlane : public QObject
         void onTranslateWing();
         void onUpdateMeshDisplay();
         void onVarSetChanged(int);
+        void onWhatIf();
         void onPolarProperties();
         void onPolarView();
         void onWingCurveSelection();
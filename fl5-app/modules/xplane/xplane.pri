@@ -7,6 +7,7 @@ HEADERS += \
     $$PWD/analysis/planeanalysisdlg.h \
     $$PWD/analysis/plpolarnamemaker.h \
     $$PWD/analysis/streamlinemaker.h \
+    $$PWD/analysis/whatifdlg.h \
     $$PWD/controls/analysis3dctrls.h \
     $$PWD/controls/planeexplorer.h \
     $$PWD/controls/popp3dctrls.h \
@@ -33,6 +34,7 @@ SOURCES += \
     $$PWD/analysis/planeanalysisdlg.cpp \
     $$PWD/analysis/plpolarnamemaker.cpp \
     $$PWD/analysis/streamlinemaker.cpp \
+    $$PWD/analysis/whatifdlg.cpp \
     $$PWD/controls/analysis3dctrls.cpp \
     $$PWD/controls/planeexplorer.cpp \
     $$PWD/controls/popp3dctrls.cpp \
@@ -64,11 +64,16 @@ BoatAnalysisDlg::BoatAnalysisDlg() : QDialog()
     m_pActiveTask = nullptr;
 
     m_bHasErrors = false;
+
+    m_nLiveOpps = 0;
+    m_LiveTimer.setInterval(40);
+    connect(&m_LiveTimer, SIGNAL(timeout()), SLOT(onLiveUpdate()));
 }
 
 
 BoatAnalysisDlg::~BoatAnalysisDlg()
 {
+    m_LiveTimer.stop();
 }
 
 
@@ -223,6 +228,9 @@ void BoatAnalysisDlg::cleanUp()
 
 void BoatAnalysisDlg::onTaskFinished()
 {
+    m_LiveTimer.stop();
+    onLiveUpdate(); // the frames published since the last tick
+
     if(m_pActiveTask)
     {
         m_BtOppList = m_pActiveTask->BtOppList(); // keep track of the pointers before destroying the task;
@@ -310,6 +318,46 @@ void BoatAnalysisDlg::onStopIterations()
 }
 
 
+/** Drains the frames published by the active task since the last tick and updates the views once */
+void BoatAnalysisDlg::onLiveUpdate()
+{
+    std::shared_ptr<std::vector<std::vector<Vorton>> const> pVortons;
+    double wakectrl = 0.0;
+    LiveFrame residual;
+    bool bResidual = false;
+    BoatOpp const *pLastBtOpp = nullptr;
+
+    LiveFrame frame;
+    while(m_LiveChannel.pop(frame))
+    {
+        switch(frame.m_Type)
+        {
+            case LiveFrame::WAKE:
+                pVortons = frame.m_pVortons;
+                wakectrl = frame.m_Ctrl;
+                break;
+            case LiveFrame::RESIDUAL:
+                residual = frame;
+                bResidual = true;
+                break;
+            case LiveFrame::BOATOPP:
+                pLastBtOpp = frame.m_pBoatOpp;
+                m_nLiveOpps++;
+                break;
+            default: break;
+        }
+    }
+
+    if(pVortons && s_pXSail)
+        s_pXSail->setLiveVortons(wakectrl, *pVortons);
+
+    if(pLastBtOpp)
+        m_plabTaskInfo->setText(QString::asprintf("%d operating point(s) completed - last: ctrl=%.3f", m_nLiveOpps, pLastBtOpp->ctrl()));
+    else if(bResidual)
+        m_plabTaskInfo->setText(QString::asprintf("ctrl=%.3f - VPW iteration %d - |F|=%11.5g", residual.m_Ctrl, residual.m_Iter+1, residual.m_Value));
+}
+
+
 void BoatAnalysisDlg::onLiveVortons()
 {
     BoatTask::setLiveUpdate(m_pchLiveVortons->isChecked());
@@ -343,6 +391,11 @@ BoatTask* BoatAnalysisDlg::analyze(Boat *pBoat, BoatPolar *pBoatPolar, std::vect
     m_pActiveTask->setAnalysisRange(opplist);
     m_pActiveTask->initializeTask(this);
 
+    m_LiveChannel.clear();
+    m_pActiveTask->setLiveChannel(&m_LiveChannel);
+    m_nLiveOpps = 0;
+    m_LiveTimer.start();
+
 /*    m_pActiveTask->setEventDestination(this);
     connect(m_pActiveTask,                  &Task3d::outputMessage,    this, &BoatAnalysisDlg::onOutputMessage);
     connect(m_pActiveTask,                  &Task3d::taskFinished,     this,  &BoatAnalysisDlg::onTaskFinished);*/
@@ -374,10 +427,7 @@ void BoatAnalysisDlg::runAsync()
         VPWReport report = m_pActiveTask->m_theMsgQueue.front();
         m_pActiveTask->m_theMsgQueue.pop();
 
-        if(report.m_Vortons.size()!=0)
-            s_pXSail->setLiveVortons(report.m_Ctrl, report.m_Vortons);
-
-        // forward to the UI thread for user notification
+        // forward to the UI thread for user notification; the wake and the results are streamed through the live channel
         qApp->postEvent(this, new MessageEvent(report.message()));
     }
 
@@ -31,6 +31,9 @@
 #include <QCheckBox>
 #include <QPushButton>
 #include <QDialogButtonBox>
+#include <QTimer>
+
+#include <api/livechannel.h>
 
 class PlainTextOutput;
 class Panel3;
@@ -77,6 +80,7 @@ class BoatAnalysisDlg : public QDialog
     protected slots:
         void onTaskFinished();
         void onCancelClose();
+        void onLiveUpdate();
         void onLiveVortons();
         void onKeepOpenErrors();
         void onStopIterations();
@@ -114,6 +118,10 @@ class BoatAnalysisDlg : public QDialog
         std::vector<BoatOpp*> m_BtOppList;
         QDialogButtonBox *m_pButtonBox;
 
+        LiveChannel m_LiveChannel;    /**< the intermediate results streamed by the active task */
+        QTimer m_LiveTimer;           /**< drains the live channel at the GUI's pace */
+        int m_nLiveOpps;
+
 
         static XSail *s_pXSail;
         static QByteArray s_WindowGeometry;
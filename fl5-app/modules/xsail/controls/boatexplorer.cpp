@@ -283,23 +283,22 @@ void BoatExplorer::addBtOpps(BoatPolar* pBtPolar)
                 {
                     m_Selection = BoatExplorer::BTPOLAR; /** @todo remove */
 
-                    QModelIndex polarindex = m_pModel->index(jr, 0, pPlaneItem);
-                    m_pModel->removeRows(0, pBtPolarItem->rowCount(), polarindex);
-
+                    // update the children, notifying only the added and removed BtOpps
+                    QVector<ObjectTreeModel::Row> rows;
                     for(int iOpp=SailObjects::nBtOpps()-1; iOpp>=0; iOpp--)
                     {
                         BoatOpp const *pBtOpp = SailObjects::btOpp(iOpp);
                         if(pBtOpp->boatName().compare(pBtPolar->boatName())==0 && pBtOpp->polarName().compare(pBtPolar->name())==0)
                         {
-                            QString strange;
-                            strange = QString::asprintf("%7.3f", pBtOpp->ctrl());
-
-                            LineStyle ls(pBtOpp->theStyle());
-                            ls.m_bIsEnabled = false;
-                            m_pModel->appendRow(pBtPolarItem, strange, ls, Qt::Unchecked);
-
+                            ObjectTreeModel::Row row;
+                            row.m_Name = QString::asprintf("%7.3f", pBtOpp->ctrl());
+                            row.m_LS = pBtOpp->theStyle();
+                            row.m_LS.m_bIsEnabled = false;
+                            row.m_State = Qt::Unchecked;
+                            rows.append(row);
                         }
                     }
+                    m_pModel->mergeRows(pBtPolarItem, rows);
                     bAdded = true;
                     break;
                 }
@@ -338,6 +338,8 @@ void gl3dXSailView::glMakeMeshBuffers()
     BoatPolar const*pBtPolar = s_pXSail->curBtPolar();
     if(s_bResetglMesh || s_bResetglBoat || s_bResetglSail || s_bResetglHull)
     {
+        clearPickTree();
+
         if(pBtPolar && pBtPolar->isQuadMethod())
         {
             // not activated
@@ -562,7 +564,7 @@ void gl3dXSailView::glMakeOppBuffers()
     {
         if(pBtOpp->hasVortons())
         {
-            gl::makeVortons(pBtOpp->m_Vorton, m_vboVortons);
+            gl::makeVortons(pBtOpp->vortonWake(), m_vboVortons);
 
             if(m_pCrossFlowCtrls->bVorticityMap())
             {
@@ -1010,7 +1012,7 @@ void gl3dXSailView::glRenderPanelBasedBuffers()
 
     if(XSailDisplayCtrls::s_bPanelForce)
     {
-        if(pBtOpp) paintColorSegments(m_vboPanelForces, W3dPrefs::s_LiftStyle.m_Width);
+        if(pBtOpp) paintArrowInstances(m_vboPanelForces, W3dPrefs::s_LiftStyle.m_Width);
     }
 
     if(m_pDisplayCtrls->s_bWakePanels)
@@ -1201,7 +1203,7 @@ void gl3dXSailView::glRenderOppBuffers()
         }
     }
 
-    if(m_pCrossFlowCtrls->bVorticityMap() && pBtOpp && pBtOpp->m_Vorton.size())
+    if(m_pCrossFlowCtrls->bVorticityMap() && pBtOpp && pBtOpp->hasVortons())
     {
         paintColourMap(m_vboContourClrs, m_matModel);
         paintSegments(m_vboContourLines, W3dPrefs::s_ContourLineStyle);
@@ -1462,87 +1464,72 @@ void gl3dXSailView::mouseMoveEvent(QMouseEvent *pEvent)
 
 bool gl3dXSailView::pickTriUniPanel(QPoint const &point)
 {
-    Vector3d I, AA, BB;
-
-    screenToWorld(point, 0.0, AA);
-    screenToWorld(point, 1.0, BB);
-
-    Vector3d U = (BB-AA).normalized();
-
-    QVector4D v4d;
-
     m_PickedPanelIndex = -1;
 
     Boat      *pBoat    = s_pXSail->curBoat();
 //    BoatPolar *pBtPolar = s_pXSail->curBtPolar();
     BoatOpp   *pBtOpp   = s_pXSail->curBtOpp();
 
-    float zmax = +1.e10;
-//    double dcrit = 0.05/m_glScaled;
+    int i3 = pickBoatPanel(point);
+    if(i3<0) return false;
+
+    Panel3 const &p3 = pBoat->panel3(i3);
+    m_PickedPoint = p3.CoG();
     if(pBtOpp && (XSailDisplayCtrls::s_b3dCp || XSailDisplayCtrls::s_bGamma || XSailDisplayCtrls::s_bPanelForce))
     {
-        // pick element
-        for(int i3=0; i3<pBoat->nPanel3(); i3++)
+        if(p3.index()>=0 && p3.index()<pBtOpp->nPanel3())
         {
-            Panel3 const &p3 = pBoat->panel3(i3);
-            if(p3.intersect(AA, U, I))
+            if(XSailDisplayCtrls::s_bPanelForce)
             {
-                worldToScreen(p3.CoG(), v4d);
-                if(v4d.z()<zmax)
-                {
-                    zmax = v4d.z();
-                    m_PickedPoint = p3.CoG();
-                    if(p3.index()>=0 && p3.index()<pBtOpp->nPanel3())
-                    {
-                        if(XSailDisplayCtrls::s_bPanelForce)
-                        {
-                            m_PickedVal =  pBtOpp->Cp(i3*3)* 0.5*pBtOpp->QInf()*pBtOpp->QInf()*Units::PatoUnit();
-                        }
-                        else if(XSailDisplayCtrls::s_bGamma)
-                        {
-                            m_PickedVal = pBtOpp->gamma(i3*3);
-                        }
-                        else
-                        {
-                            m_PickedVal = pBtOpp->Cp(i3*3);
-                        }
-                        m_PickedPanelIndex = i3;
-                    }
-                }
+                m_PickedVal =  pBtOpp->Cp(i3*3)* 0.5*pBtOpp->QInf()*pBtOpp->QInf()*Units::PatoUnit();
+            }
+            else if(XSailDisplayCtrls::s_bGamma)
+            {
+                m_PickedVal = pBtOpp->gamma(i3*3);
             }
+            else
+            {
+                m_PickedVal = pBtOpp->Cp(i3*3);
+            }
+            m_PickedPanelIndex = i3;
         }
     }
     else
     {
-        for(int i3=0; i3<pBoat->nPanel3(); i3++)
-        {
-            Panel3 const &p3 = pBoat->panel3(i3);
-            if(p3.intersect(AA, U, I))
-            {
-                worldToScreen(p3.CoG(), v4d);
-                if(v4d.z()<zmax)
-                {
-                    zmax = v4d.z();
-                    m_PickedPoint = p3.CoG();
-                    m_PickedPanelIndex = i3;
-                }
-            }
-        }
+        m_PickedPanelIndex = i3;
     }
 
     return m_PickedPanelIndex>=0;
 }
 
 
+/**
+ * Picks the boat's panel under the mouse point using the pick tree of the boat's mesh,
+ * which is made on first use after each change of the mesh.
+ * @return the index of the panel, or -1 if none is picked
+ */
+int gl3dXSailView::pickBoatPanel(QPoint const &point)
+{
+    Boat const *pBoat = s_pXSail->curBoat();
+    if(!pBoat) return -1;
+
+    if(!hasPickTree() || int(m_PickPanel.size())!=pBoat->nPanel3())
+        makePickTree(pBoat->triMesh().panels());
+
+    Vector3d I;
+    int i3 = pickTreePanel(point, I);
+    if(i3<0 || i3>=pBoat->nPanel3()) return -1;
+    return i3;
+}
+
+
 bool gl3dXSailView::pickTriLinPanel(QPoint const &point)
 {
-    Vector3d I, AA, BB;
+    Vector3d AA, BB;
 
     screenToWorld(point, 0.0, AA);
     screenToWorld(point, 1.0, BB);
 
-    Vector3d U = (BB-AA).normalized();
-
     QVector4D v4d;
 
     m_PickedPanelIndex = -1;
@@ -1586,20 +1573,11 @@ bool gl3dXSailView::pickTriLinPanel(QPoint const &point)
     else
     {
         // pick a panel;
-
-        for(int i3=0; i3<pBoat->nPanel3(); i3++)
+        int i3 = pickBoatPanel(point);
+        if(i3>=0)
         {
-            Panel3 const &p3 = pBoat->panel3(i3);
-            if(p3.intersect(AA, U, I))
-            {
-                worldToScreen(p3.CoG(), v4d);
-                if(v4d.z()<zmax)
-                {
-                    zmax = v4d.z();
-                    m_PickedPoint = p3.CoG();
-                    m_PickedPanelIndex = i3;
-                }
-            }
+            m_PickedPoint = pBoat->panel3(i3).CoG();
+            m_PickedPanelIndex = i3;
         }
     }
     return m_PickedPanelIndex>=0;
@@ -1840,9 +1818,14 @@ bool gl3dXSailView::glMakeStreamLines(std::vector<Panel3> const &panel3list, Boa
         m_pP3LinAnalysis->setTriMesh(s_pXSail->curBoat()->triMesh());
     }
 
-    // multithreaded mode only
+    P3Analysis *pP3Analysis = nullptr;
+    if     (s_pXSail->curBtPolar()->isTriUniformMethod()) pP3Analysis = m_pP3UniAnalysis;
+    else if(s_pXSail->curBtPolar()->isTriLinearMethod())  pP3Analysis = m_pP3LinAnalysis;
+
+    // the cache is shared by all the lines
+    StreamVelocityCache velcache(pP3Analysis, pBtOpp->gamma().data(), pBtOpp->sigma().data(), StreamLineCtrls::l0());
+
     QApplication::setOverrideCursor(Qt::WaitCursor);
-    QFutureSynchronizer<void> futureSync;
     QVector<StreamlineMaker*> makers;
 
     for (int in=0; in<ptList.size(); in++)
@@ -1857,20 +1840,14 @@ bool gl3dXSailView::glMakeStreamLines(std::vector<Panel3> const &panel3list, Boa
         TPt[in] = TC;
 
         pMaker->setOpp(s_pXSail->curBtPolar(), pBtOpp->QInf(), 0.0, -pBtOpp->beta(), pBtOpp->gamma().data(), pBtOpp->sigma().data());
-        if     (s_pXSail->curBtPolar()->isTriUniformMethod()) pMaker->setP3Analysis(m_pP3UniAnalysis);
-        else if(s_pXSail->curBtPolar()->isTriLinearMethod())  pMaker->setP3Analysis(m_pP3LinAnalysis);
+        pMaker->setP3Analysis(pP3Analysis);
+        if(StreamLineCtrls::bCacheVelocity()) pMaker->setVelocityCache(&velcache);
         pMaker->initializeLineMaker(in, StreamVertexArray.data()+iv, Pt[in], v0List[in], TPt[in],
                                     StreamLineCtrls::nX(), StreamLineCtrls::l0(), StreamLineCtrls::XFactor());
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-        futureSync.addFuture(QtConcurrent::run(pMaker, &StreamlineMaker::run));
-#else
-        futureSync.addFuture(QtConcurrent::run(&StreamlineMaker::run, pMaker));
-#endif
 
-//        pMaker->run();
          iv += (StreamLineCtrls::nX()+1)*3;
     }
-    futureSync.waitForFinished();
+    StreamlineMaker::runAll(makers);
 
     for(int i=0; i<makers.size(); i++)
     {
@@ -1898,13 +1875,13 @@ void gl3dXSailView::computeP3VelocityVectors(Opp3d const *pBtOpp, QVector<Vector
     {
         m_pP3UniAnalysis->setTriMesh(s_pXSail->curBoat()->triMesh());
         m_pP3UniAnalysis->initializeAnalysis(s_pXSail->curBtPolar(), 0);
-        m_pP3UniAnalysis->setVortons(pBtOpp->m_Vorton);
+        m_pP3UniAnalysis->setVortons(pBtOpp->vortons());
     }
     else if(s_pXSail->curBtPolar()->isTriLinearMethod())
     {
         m_pP3LinAnalysis->setTriMesh(s_pXSail->curBoat()->triMesh());
         m_pP3LinAnalysis->initializeAnalysis(s_pXSail->curBtPolar(), 0);
-        m_pP3LinAnalysis->setVortons(pBtOpp->m_Vorton);
+        m_pP3LinAnalysis->setVortons(pBtOpp->vortons());
     }
 
     if(xfl::isMultiThreaded())
@@ -2217,7 +2194,7 @@ void gl3dXSailView::glMakeFlowBuffers()
 
         m_pP3UniAnalysis->initializeAnalysis(pBtPolar,0);
         m_pP3UniAnalysis->setTriMesh(pBoat->triMesh());
-        m_pP3UniAnalysis->setVortons(pBtOpp->m_Vorton);
+        m_pP3UniAnalysis->setVortons(pBtOpp->vortons());
 
         // Create a VBO and an SSBO for the vortices
         // VBO is used for display and SSBO is used in the compute shader
@@ -2350,23 +2327,21 @@ void gl3dXSailView::glMakeFlowBuffers()
 
         BufferArray.resize(buffersize);
         iv=0;
-        for(uint ir=0; ir<pBtOpp->m_Vorton.size(); ir++)
+        VortonWake const &wake = pBtOpp->vortonWake();
+        for(int i=0; i<wake.count(); i++)
         {
-            for(uint jc=0; jc<pBtOpp->m_Vorton.at(ir).size(); jc++)
-            {
-                Vorton const &vtn = pBtOpp->m_Vorton.at(ir).at(jc);
-
-                BufferArray[iv++] = vtn.xf();
-                BufferArray[iv++] = vtn.yf();
-                BufferArray[iv++] = vtn.zf();
-                BufferArray[iv++] = 1.0f;
-
-                BufferArray[iv++] = vtn.vortex().xf();
-                BufferArray[iv++] = vtn.vortex().yf();
-                BufferArray[iv++] = vtn.vortex().zf();
-                if(vtn.isActive())  BufferArray[iv++] = 1.0f;
-                else                BufferArray[iv++] = 0.0f;
-            }
+            Vector3d const omega = wake.vortex(i);
+
+            BufferArray[iv++] = wake.xf(i);
+            BufferArray[iv++] = wake.yf(i);
+            BufferArray[iv++] = wake.zf(i);
+            BufferArray[iv++] = 1.0f;
+
+            BufferArray[iv++] = omega.xf();
+            BufferArray[iv++] = omega.yf();
+            BufferArray[iv++] = omega.zf();
+            if(wake.isActive(i))  BufferArray[iv++] = 1.0f;
+            else                  BufferArray[iv++] = 0.0f;
         }
         Q_ASSERT(iv==buffersize);
 
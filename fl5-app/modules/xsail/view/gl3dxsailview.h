@@ -122,6 +122,7 @@ class gl3dXSailView : public gl3dXflView
 
         bool pickTriUniPanel(QPoint const &point);
         bool pickTriLinPanel(QPoint const &point);
+        int pickBoatPanel(QPoint const &point);
 
         void glMakeMeshBuffers();
         void glMakeOppBuffers();
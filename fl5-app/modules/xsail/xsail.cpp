@@ -40,6 +40,7 @@
 
 
 #include <api/boat.h>
+#include <api/columnfile.h>
 #include <api/boatopp.h>
 #include <api/boatpolar.h>
 #include <api/boattask.h>
@@ -2445,7 +2446,7 @@ void XSail::createBtPolarCurves()
             {
                 Graph *pGraph = m_PlrGraph[ig];
                 Curve *pCurve = pGraph->addCurve(QString::fromStdString(pBoatPolar->boatName() + " / " + pBoatPolar->name()), AXIS::LEFTYAXIS, DisplayOptions::isDarkTheme());
-                fillBtPlrCurve(pCurve, pBoatPolar, pGraph->xVariable(), pGraph->yVariable(0));
+                fillBtPlrCurve(pCurve, pBoatPolar, pGraph->xVariable(), pGraph->yVariable(0), pGraph->curveModel());
                 pCurve->setTheStyle(pBoatPolar->theStyle());
                 pBoatPolar->appendCurve(pCurve);
                 if(pBoatPolar==m_pCurBtPolar)
@@ -2453,7 +2454,7 @@ void XSail::createBtPolarCurves()
                 if(pGraph->hasRightAxis())
                 {
                     Curve *pCurve = pGraph->addCurve(QString::fromStdString(pBoatPolar->boatName() + " / " + pBoatPolar->name()), AXIS::RIGHTYAXIS, DisplayOptions::isDarkTheme());
-                    fillBtPlrCurve(pCurve, pBoatPolar, pGraph->xVariable(), pGraph->yVariable(1));
+                    fillBtPlrCurve(pCurve, pBoatPolar, pGraph->xVariable(), pGraph->yVariable(1), pGraph->curveModel());
                     pCurve->setTheStyle(pBoatPolar->theStyle());
                     pBoatPolar->appendCurve(pCurve);
                     if(pBoatPolar==m_pCurBtPolar)
@@ -2463,38 +2464,58 @@ void XSail::createBtPolarCurves()
         }
     }
 
+    // discard the cached points of the deleted polars
+    QSet<void const*> polars;
+    for(int k=0; k<SailObjects::nBtPolars(); k++) polars.insert(SailObjects::btPolar(k));
+
     m_bResetCurves = false;
 
     for(int ig=0; ig<m_PlrGraph.count(); ig++)
     {
+        if(m_PlrGraph[ig]->curveModel()) m_PlrGraph[ig]->curveModel()->trimCache(polars);
         m_PlrGraph[ig]->invalidate();
     }
     emit curvesUpdated();
 }
 
 
-void XSail::fillBtPlrCurve(Curve *pCurve, BoatPolar const *pBtPolar, int XVar, int YVar)
+void XSail::fillBtPlrCurve(Curve *pCurve, BoatPolar const *pBtPolar, int XVar, int YVar, CurveModel *pCache)
 {
     pCurve->setSelectedPoint(-1);
-    for (int i=0; i<pBtPolar->dataSize(); i++)
+
+    // the points are cached in user-defined units, so a change of units also invalidates them
+    qint64 revision = (qint64(pBtPolar->dataRevision())<<32) | qint64(quint32(Units::revision()));
+    QPolygonF const *pCached = pCache ? pCache->cachedPoints(pBtPolar, XVar, YVar, revision) : nullptr;
+    if(pCached)
+    {
+        pCurve->setPoints(*pCached);
+    }
+    else
     {
-        double x = pBtPolar->getVariable(XVar, i);
-        double y = pBtPolar->getVariable(YVar, i);
+        for (int i=0; i<pBtPolar->dataSize(); i++)
+        {
+            double x = pBtPolar->getVariable(XVar, i);
+            double y = pBtPolar->getVariable(YVar, i);
 
-        //Set user units
-        if(XVar>=4 && XVar<=9)  x *= Units::NtoUnit(); //force
-        if(YVar>=4 && YVar<=9)  y *= Units::NtoUnit(); //force
-        if(XVar>=10)  x *= Units::NmtoUnit();
-        if(YVar>=10)  y *= Units::NmtoUnit();
+            //Set user units
+            if(XVar>=4 && XVar<=9)  x *= Units::NtoUnit(); //force
+            if(YVar>=4 && YVar<=9)  y *= Units::NtoUnit(); //force
+            if(XVar>=10)  x *= Units::NmtoUnit();
+            if(YVar>=10)  y *= Units::NmtoUnit();
 
-        pCurve->appendPoint(x,y);
-        if(m_pCurBtOpp && Graph::isHighLighting())
+            pCurve->appendPoint(x,y);
+        }
+        if(pCache) pCache->cachePoints(pBtPolar, XVar, YVar, revision, pCurve->points());
+    }
+
+    if(m_pCurBtOpp && Graph::isHighLighting())
+    {
+        if(m_pCurBoat
+                && pBtPolar->boatName()==m_pCurBoat->name()
+                && m_pCurBtOpp->polarName() ==pBtPolar->name())
         {
-            if(m_pCurBoat
-                    && pBtPolar->boatName()==m_pCurBoat->name()
-                    && m_pCurBtOpp->polarName() ==pBtPolar->name())
+            for (int i=0; i<pBtPolar->dataSize(); i++)
             {
-
                 if(fabs(pBtPolar->m_Ctrl.at(i)-m_pCurBtOpp->ctrl())<0.01)
                 {
                     pCurve->setSelectedPoint(i);
@@ -2615,7 +2636,7 @@ void XSail::onExportBtPolarToFile()
     FileName.replace(".", "_");
     FileName = QFileDialog::getSaveFileName(s_pMainFrame, "Export polar",
                                             SaveOptions::lastDirName() + "/"+FileName,
-                                            "Text File (*.txt);;Comma Separated Values (*.csv)",
+                                            "Text File (*.txt);;Comma Separated Values (*.csv);;Columnar binary (*.fl5c)",
                                             &filter);
 
     if(!FileName.length()) return;
@@ -2633,6 +2654,21 @@ void XSail::onExportBtPolarToFile()
         SaveOptions::setExportFileType(xfl::CSV);
         if(FileName.indexOf(".csv")<0) FileName +=".csv";
     }
+    else if(filter.indexOf("*.fl5c")>0)
+    {
+        if(!FileName.endsWith(".fl5c")) FileName +=".fl5c";
+
+        std::vector<Opp3d const*> opps;
+        for(int io=0; io<SailObjects::nBtOpps(); io++)
+        {
+            BoatOpp const *pBtOpp = SailObjects::btOpp(io);
+            if(pBtOpp->boatName()==m_pCurBtPolar->boatName() && pBtOpp->polarName()==m_pCurBtPolar->name())
+                opps.push_back(pBtOpp);
+        }
+        if(!ColumnFile::exportBoatPolar(FileName.toStdString(), *m_pCurBtPolar, opps))
+            displayMessage("Error writing the file "+FileName+"\n", true);
+        return;
+    }
 
     QFile XFile(FileName);
     if (!XFile.open(QIODevice::WriteOnly | QIODevice::Text)) return;
@@ -3180,6 +3216,15 @@ void XSail::onCheckPanels()
         if(dlg.checkMinAngles()) qVec = QVector<int>(anglelist.begin(),  anglelist.end());
         if(dlg.checkMinArea())   qVec = QVector<int>(arealist.begin(),   arealist.end());
         if(dlg.checkMinSize())   qVec = QVector<int>(sizelist.begin(),   sizelist.end());
+        if(dlg.checkIntersections())
+        {
+            std::string str;
+            std::vector<int> intersectlist, overlaplist;
+            m_pCurBoat->triMesh().checkIntersections(str, PanelCheckDlg::intersectionGap(), intersectlist, overlaplist, xfl::isMultiThreaded());
+            log += str;
+            qVec.append(QVector<int>(intersectlist.begin(), intersectlist.end()));
+            qVec.append(QVector<int>(overlaplist.begin(),   overlaplist.end()));
+        }
         m_pgl3dXSailView->appendHighlightList(qVec);
     }
 
@@ -129,7 +129,7 @@ class XSail : public QObject
         void connectSignals();
         void createBtPolarCurves();
         void createCpCurves();
-        void fillBtPlrCurve(Curve *pCurve, const BoatPolar *pBtPolar, int XVar, int YVar);
+        void fillBtPlrCurve(Curve *pCurve, const BoatPolar *pBtPolar, int XVar, int YVar, CurveModel *pCache);
         BoatPolar *importBtPolarFromXML(QFile &xmlFile);
         Boat *importBoatFromXML(QFile &xmlFile);
         void makeControlWts();
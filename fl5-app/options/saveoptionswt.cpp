@@ -47,6 +47,7 @@
 #include <interfaces/view2d/foilsvgwriter.h>
 
 #include <api/fileio.h>
+#include <api/opp3d.h>
 
 SaveOptionsWt::SaveOptionsWt(QWidget *parent) : QWidget{parent}
 {
@@ -363,6 +364,7 @@ void SaveOptionsWt::setupLayout()
 
     m_pGroupBox.push_back(new QGroupBox("Operating points"));
     {
+        QVBoxLayout *pOppLayout = new QVBoxLayout;
         QHBoxLayout *pSaveOppLayout = new QHBoxLayout;
         {
             QLabel *pSaveLabel = new QLabel("Save:");
@@ -377,7 +379,37 @@ void SaveOptionsWt::setupLayout()
             pSaveOppLayout->addWidget(m_pchBtOpps);
             pSaveOppLayout->addStretch();
         }
-        m_pGroupBox.back()->setLayout(pSaveOppLayout);
+        QHBoxLayout *pStorageLayout = new QHBoxLayout;
+        {
+            QLabel *pStorageLabel = new QLabel("Field arrays:");
+            m_pcbFieldStorage = new QComboBox;
+            m_pcbFieldStorage->addItems({"Single precision", "Compressed single precision", "Compressed 16-bit fixed point"});
+            m_pcbFieldStorage->setToolTip("<p>Defines how the panel arrays of Cp, doublet and source densities are stored in the project file.<br>"
+                                          "The compressed options reduce the file size, but the operating points stored "
+                                          "with these options cannot be read by earlier versions of flow5.</p>");
+            pStorageLayout->addWidget(pStorageLabel);
+            pStorageLayout->addWidget(m_pcbFieldStorage);
+            pStorageLayout->addStretch();
+        }
+        QHBoxLayout *pWakeLayout = new QHBoxLayout;
+        {
+            QLabel *pWakeLabel = new QLabel("Vorton wakes:");
+            m_pcbWakeStorage = new QComboBox;
+            m_pcbWakeStorage->addItems({"Double precision", "Single precision", "Not stored"});
+            m_pcbWakeStorage->setToolTip("<p>Defines how the final vorton wake of the VPW operating points is kept.<br>"
+                                         "The wakes are held in single precision in memory. The single precision option also "
+                                         "writes them in single precision in the project file, but the operating points stored "
+                                         "with this option cannot be read by earlier versions of flow5.<br>"
+                                         "With the last option, the wakes are discarded at the end of each operating point "
+                                         "and are not available for display.</p>");
+            pWakeLayout->addWidget(pWakeLabel);
+            pWakeLayout->addWidget(m_pcbWakeStorage);
+            pWakeLayout->addStretch();
+        }
+        pOppLayout->addLayout(pSaveOppLayout);
+        pOppLayout->addLayout(pStorageLayout);
+        pOppLayout->addLayout(pWakeLayout);
+        m_pGroupBox.back()->setLayout(pOppLayout);
     }
 
     QVBoxLayout *pMainLayout = new QVBoxLayout;
@@ -398,6 +430,8 @@ void SaveOptionsWt::initWidget()
     m_pchOpps->setChecked(FileIO::bOpps());
     m_pchPOpps->setChecked(FileIO::bPOpps());
     m_pchBtOpps->setChecked(FileIO::bBtOpps());
+    m_pcbFieldStorage->setCurrentIndex(int(Opp3d::fieldStorage()));
+    m_pcbWakeStorage->setCurrentIndex(int(Opp3d::wakeStorage()));
 
     m_pchAutoLoadLast->setChecked(SaveOptions::bAutoLoadLast());
     m_pchAutoSave->setChecked(SaveOptions::bAutoSave());
@@ -478,6 +512,8 @@ void SaveOptionsWt::readData()
     FileIO::saveOpps(  m_pchOpps->isChecked());
     FileIO::savePOpps( m_pchPOpps->isChecked());
     FileIO::saveBtOpps(m_pchBtOpps->isChecked());
+    Opp3d::setFieldStorage(Opp3d::enumFieldStorage(m_pcbFieldStorage->currentIndex()));
+    Opp3d::setWakeStorage(Opp3d::enumWakeStorage(m_pcbWakeStorage->currentIndex()));
     SaveOptions::s_bAutoSave     = m_pchAutoSave->isChecked();
     SaveOptions::s_bXmlWingFoils = m_pchXmlWingFoils->isChecked();
 
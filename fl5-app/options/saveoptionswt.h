@@ -27,6 +27,7 @@
 #include <QWidget>
 #include <QGroupBox>
 #include <QCheckBox>
+#include <QComboBox>
 #include <QSettings>
 #include <QLineEdit>
 #include <QRadioButton>
@@ -71,6 +72,7 @@ class SaveOptionsWt : public QWidget
 
         IntEdit *m_pieSaveInterval;
         QCheckBox *m_pchOpps, *m_pchPOpps, *m_pchBtOpps;
+        QComboBox *m_pcbFieldStorage, *m_pcbWakeStorage;
         QCheckBox *m_pchAutoSave, *m_pchAutoLoadLast;
         QCheckBox *m_pchCleanOnExit;
 
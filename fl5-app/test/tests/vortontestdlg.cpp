@@ -68,8 +68,9 @@ VortonTestDlg::VortonTestDlg(PlaneOpp const *pPOpp) : QDialog()
 
     if(pPOpp)
     {
-        for(int ip=0; ip<pPOpp->vortonRows(); ip++)
-            m_Vortons.insert(m_Vortons.end(), pPOpp->m_Vorton.at(ip).begin(), pPOpp->m_Vorton.at(ip).end());
+        VortonWake const &wake = pPOpp->vortonWake();
+        for(int i=0; i<wake.count(); i++)
+            m_Vortons.push_back(wake.vorton(i));
     }
     else
     {
@@ -0,0 +1,553 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include <QBuffer>
+#include <QDataStream>
+
+#include "benchcases.h"
+#include "benchharness.h"
+
+#include <api/api.h>
+#include <api/boat.h>
+#include <api/boatpolar.h>
+#include <api/boattask.h>
+#include <api/fileio.h>
+#include <api/foil.h>
+#include <api/lucache.h>
+#include <api/matrix.h>
+#include <api/nurbssurface.h>
+#include <api/objects2d.h>
+#include <api/objects3d.h>
+#include <api/objectstore.h>
+#include <api/panel3.h>
+#include <api/panel4.h>
+#include <api/panelanalysis.h>
+#include <api/planepolar.h>
+#include <api/planetask.h>
+#include <api/planexfl.h>
+#include <api/polar.h>
+#include <api/sailnurbs.h>
+#include <api/sailobjects.h>
+#include <api/taskprofile.h>
+#include <api/threadpool.h>
+#include <api/vortex.h>
+#include <api/xfoiltask.h>
+
+
+BenchCases::BenchCases()
+{
+    m_pPlane = nullptr;
+    m_pPlPolar = nullptr;
+    m_pBoat = nullptr;
+    m_pBtPolar = nullptr;
+    m_pPlaneTask = nullptr;
+    m_MatSize = 2000;
+}
+
+
+BenchCases::~BenchCases()
+{
+    delete m_pPlaneTask;
+    m_pLoadStore.reset();
+    globals::deleteObjects();
+}
+
+
+/**
+ * Makes the reference foils, plane and boat and stores them in the default store,
+ * so that they are saved by the project cases.
+ */
+bool BenchCases::makeReferenceObjects()
+{
+    int const NACA[] = {9, 2412, 4415};
+    for(int digits : NACA)
+    {
+        char name[16];
+        snprintf(name, sizeof(name), "NACA %04d", digits);
+        Foil *pFoil = foil::makeNacaFoil(digits, name);
+        if(!pFoil) return false;
+        pFoil->rePanel(149, 0.7);
+        m_Foil.push_back(pFoil);
+
+        Polar *pPolar = Objects2d::createPolar(pFoil, xfl::T1POLAR, 500000.0, 0.0, 9.0, 1.0, 1.0);
+        pPolar->setName("T1_Re0.500_M0.00_N9.0");
+        Objects2d::insertPolar(pPolar);
+        m_FoilPolar.push_back(pPolar);
+    }
+
+    // the default plane, with the foils and panel densities of the plane run example
+    m_pPlane = new PlaneXfl;
+    m_pPlane->setName("Reference plane");
+    Objects3d::insertPlane(m_pPlane);
+    m_pPlane->makeDefaultPlane();
+    for(int iw=0; iw<m_pPlane->nWings(); iw++)
+    {
+        WingXfl *pWing = m_pPlane->wing(iw);
+        std::string foilname = (iw==0) ? m_Foil.at(1)->name() : m_Foil.at(0)->name();
+        for(int isec=0; isec<pWing->nSections(); isec++)
+        {
+            WingSection &sec = pWing->section(isec);
+            sec.setLeftFoilName(foilname);
+            sec.setRightFoilName(foilname);
+            sec.setNX(iw==0 ? 13 : 7);
+            sec.setXDistType(xfl::TANH);
+        }
+        if(iw==0) pWing->rootSection().setNY(19);
+    }
+    m_pPlane->makePlane(false, false, true);
+
+    m_pPlPolar = new PlanePolar;
+    m_pPlPolar->setName("T1 inviscid");
+    m_pPlPolar->setPlaneName(m_pPlane->name());
+    m_pPlPolar->setType(xfl::T1POLAR);
+    m_pPlPolar->setAnalysisMethod(xfl::TRIUNIFORM);
+    m_pPlPolar->setDefaultSpec(m_pPlane);
+    m_pPlPolar->setThinSurfaces(true);
+    m_pPlPolar->setViscous(false);
+    Objects3d::insertPlPolar(m_pPlPolar);
+
+    m_pBoat = new Boat;
+    m_pBoat->setName("Reference boat");
+    m_pBoat->makeDefaultBoat();
+    m_pBoat->makeRefTriMesh(true, true);
+    SailObjects::appendBoat(m_pBoat);
+
+    m_pBtPolar = new BoatPolar;
+    m_pBtPolar->setName("Reference boat polar");
+    m_pBtPolar->setBoatName(m_pBoat->name());
+    m_pBtPolar->setDefaultSpec(m_pBoat);
+    SailObjects::appendBtPolar(m_pBtPolar);
+
+    // fixed field points in a box around the plane
+    std::mt19937 gen(17);
+    std::uniform_real_distribution<double> ux(-0.5, 1.5), uy(-1.6, 1.6), uz(-0.3, 0.5);
+    m_TestPts.resize(500);
+    for(Vector3d &pt : m_TestPts) pt.set(ux(gen), uy(gen), uz(gen));
+
+    m_RefMesh = m_pPlane->triMesh();
+
+    return m_pPlane->nPanel3()>0;
+}
+
+
+void BenchCases::registerCases(BenchHarness &harness)
+{
+    addPanelCases(harness);
+    addMatrixCases(harness);
+    addVortonCases(harness);
+    addXFoilCases(harness);
+    addMeshCases(harness);
+    addProjectCases(harness);
+    addAnalysisCases(harness);
+}
+
+
+void BenchCases::addPanelCases(BenchHarness &harness)
+{
+    BenchCase p3source;
+    p3source.m_Name = "panel3_source_velocity";
+    p3source.m_Group = "micro";
+    p3source.m_Description = "N4023 source velocity of all the plane's triangles at 500 field points";
+    p3source.m_Run = [this]()
+    {
+        std::vector<Panel3> const &panels = m_pPlane->triPanels();
+        double coreradius = Vortex::coreRadius();
+        Vector3d V, VSum;
+        for(Vector3d const &pt : m_TestPts)
+        {
+            for(Panel3 const &p3 : panels)
+            {
+                p3.sourceN4023Velocity(pt, false, V, coreradius);
+                VSum += V;
+            }
+        }
+        (void)VSum;
+    };
+    harness.addCase(p3source);
+
+    BenchCase p3doublet;
+    p3doublet.m_Name = "panel3_doublet_velocity";
+    p3doublet.m_Group = "micro";
+    p3doublet.m_Description = "N4023 doublet velocity of all the plane's triangles at 500 field points";
+    p3doublet.m_Run = [this]()
+    {
+        std::vector<Panel3> const &panels = m_pPlane->triPanels();
+        double coreradius = Vortex::coreRadius();
+        Vector3d V, VSum;
+        for(Vector3d const &pt : m_TestPts)
+        {
+            for(Panel3 const &p3 : panels)
+            {
+                p3.doubletN4023Velocity(pt, false, V, coreradius);
+                VSum += V;
+            }
+        }
+        (void)VSum;
+    };
+    harness.addCase(p3doublet);
+
+    BenchCase p4doublet;
+    p4doublet.m_Name = "panel4_doublet_velocity";
+    p4doublet.m_Group = "micro";
+    p4doublet.m_Description = "N4023 doublet velocity of all the plane's quads at 500 field points";
+    p4doublet.m_Run = [this]()
+    {
+        std::vector<Panel4> const &panels = m_pPlane->quadpanels();
+        double coreradius = Vortex::coreRadius();
+        Vector3d V, VSum;
+        for(Vector3d const &pt : m_TestPts)
+        {
+            for(Panel4 const &p4 : panels)
+            {
+                p4.doubletN4023Velocity(pt, V, coreradius);
+                VSum += V;
+            }
+        }
+        (void)VSum;
+    };
+    harness.addCase(p4doublet);
+}
+
+
+void BenchCases::makeTestMatrix()
+{
+    // diagonally dominant, with a smooth off-diagonal decay as in the panel influence matrices
+    int n = m_MatSize;
+    m_Matrix.resize(size_t(n)*size_t(n));
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> u(-1.0, 1.0);
+    for(int i=0; i<n; i++)
+    {
+        for(int j=0; j<n; j++)
+            m_Matrix[size_t(i)*n+j] = 0.1*u(gen)/(1.0+std::abs(i-j));
+        m_Matrix[size_t(i)*n+i] += 2.0*M_PI;
+    }
+    m_RHS.resize(6*n);
+}
+
+
+void BenchCases::addMatrixCases(BenchHarness &harness)
+{
+    BenchCase assembly;
+    assembly.m_Name = "influence_matrix";
+    assembly.m_Group = "micro";
+    assembly.m_Description = "assembly of the reference plane's triangle influence matrix";
+    assembly.m_Setup = [this]()
+    {
+        LUCache::setEnabled(false);
+        m_pPlane->restoreMesh();
+        m_pPlaneTask = new PlaneTask;
+        m_pPlaneTask->setObjects(m_pPlane, m_pPlPolar);
+        m_pPlaneTask->initializeTask();
+    };
+    assembly.m_Run = [this]()
+    {
+        if(m_pPlaneTask->panelAnalysis()) m_pPlaneTask->panelAnalysis()->makeInfluenceMatrix();
+    };
+    assembly.m_Teardown = [this]()
+    {
+        delete m_pPlaneTask;
+        m_pPlaneTask = nullptr;
+        LUCache::setEnabled(true);
+    };
+    harness.addCase(assembly);
+
+    BenchCase lu;
+    lu.m_Name = "lu_factorize";
+    lu.m_Group = "micro";
+    lu.m_Description = "LU factorization of a dense 2000x2000 matrix";
+    lu.m_Setup = [this]() {makeTestMatrix();};
+    lu.m_Reset = [this]() {m_LU = m_Matrix;};
+    lu.m_Run   = [this]() {matrix::LUfactorize(m_MatSize, m_LU.data(), m_ipiv, ThreadPool::maxThreadCount());};
+    lu.m_Teardown = [this]() {m_LU.clear();};
+    harness.addCase(lu);
+
+    BenchCase backsub;
+    backsub.m_Name = "lu_back_substitution";
+    backsub.m_Group = "micro";
+    backsub.m_Description = "back-substitution of the 6 unit RHS with the factors of the 2000x2000 matrix";
+    backsub.m_Setup = [this]()
+    {
+        makeTestMatrix();
+        m_LU = m_Matrix;
+        matrix::LUfactorize(m_MatSize, m_LU.data(), m_ipiv, ThreadPool::maxThreadCount());
+    };
+    backsub.m_Reset = [this]() {std::fill(m_RHS.begin(), m_RHS.end(), 1.0);};
+    backsub.m_Run   = [this]() {matrix::LUbackSubstitute(m_MatSize, m_LU.data(), m_ipiv, 6, m_RHS.data());};
+    backsub.m_Teardown = [this]() {m_LU.clear(); m_Matrix.clear();};
+    harness.addCase(backsub);
+}
+
+
+void BenchCases::makeVortonSheet()
+{
+    // a rolled-up sheet of vortons downstream of a 3 m span, as in a converged VPW wake
+    int nx = 40, ny = 100;
+    m_Vorton.clear();
+    for(int i=0; i<nx; i++)
+    {
+        double x = 1.0 + double(i)*0.05;
+        for(int j=0; j<ny; j++)
+        {
+            double y = -1.5 + 3.0*double(j)/double(ny-1);
+            double roll = 0.1*double(i)/double(nx) * std::tanh(5.0*std::abs(y)-6.0);
+            Vector3d pos(x, y, roll*y);
+            m_Vorton.push_back(Vorton(pos, Vector3d(1.0, 0.0, 0.0), 0.01*y));
+        }
+    }
+    m_VortonVel.resize(m_Vorton.size());
+}
+
+
+void BenchCases::addVortonCases(BenchHarness &harness)
+{
+    BenchCase advection;
+    advection.m_Name = "vorton_advection";
+    advection.m_Group = "micro";
+    advection.m_Description = "mutual induced velocities of 4000 vortons on the thread pool";
+    advection.m_Setup = [this]() {makeVortonSheet();};
+    advection.m_Run = [this]()
+    {
+        int nVtn = int(m_Vorton.size());
+        int nBlocks = ThreadPool::nBlocks(ThreadPool::maxThreadCount());
+        int blocksize = (nVtn+nBlocks-1)/nBlocks;
+        double coresize = Vortex::coreRadius()*10.0;
+        ThreadPool::pool().parallelFor(nBlocks, [&](int iBlock)
+        {
+            int i1 = std::min(nVtn, (iBlock+1)*blocksize);
+            for(int i=iBlock*blocksize; i<i1; i++)
+            {
+                Vector3d V, VT;
+                for(Vorton const &vtn : m_Vorton)
+                {
+                    vtn.inducedVelocity(m_Vorton.at(i).position(), coresize, V);
+                    VT += V;
+                }
+                m_VortonVel[i] = VT;
+            }
+        });
+    };
+    advection.m_Teardown = [this]() {m_Vorton.clear(); m_VortonVel.clear();};
+    harness.addCase(advection);
+}
+
+
+void BenchCases::addXFoilCases(BenchHarness &harness)
+{
+    // one viscous point per foil; the inviscid factors of the foil are prepared during the warm-up
+    // so that the timing is dominated by the viscous iterations
+    for(uint ifoil=0; ifoil<m_Foil.size(); ifoil++)
+    {
+        BenchCase visc;
+        visc.m_Name = "xfoil_viscous_" + m_Foil.at(ifoil)->name();
+        std::replace(visc.m_Name.begin(), visc.m_Name.end(), ' ', '_');
+        visc.m_Group = "micro";
+        visc.m_Description = "one viscous operating point at 4 degrees, Re=500,000";
+        visc.m_Run = [this, ifoil]()
+        {
+            XFoilTask task;
+            task.initialize(*m_Foil.at(ifoil), m_FoilPolar.at(ifoil), false);
+            task.appendRange({true, 4.0, 4.0, 1.0});
+            task.run();
+        };
+        harness.addCase(visc);
+    }
+
+    BenchCase polar;
+    polar.m_Name = "xfoil_polar";
+    polar.m_Group = "macro";
+    polar.m_Description = "T1 polar of the NACA 2412 from -5 to 12 degrees";
+    polar.m_Run = [this]()
+    {
+        XFoilTask task;
+        task.initialize(*m_Foil.at(1), m_FoilPolar.at(1), false);
+        task.appendRange({true, 0.0, 12.0, 0.5});
+        task.appendRange({true, 0.0, -5.0, 0.5});
+        task.run();
+    };
+    harness.addCase(polar);
+}
+
+
+void BenchCases::addMeshCases(BenchHarness &harness)
+{
+    BenchCase clean;
+    clean.m_Name = "trimesh_clean";
+    clean.m_Group = "micro";
+    clean.m_Description = "merging of the double nodes and removal of the null triangles of the plane's mesh";
+    clean.m_Reset = [this]() {m_WorkMesh = m_RefMesh;};
+    clean.m_Run = [this]()
+    {
+        std::string logmsg;
+        m_WorkMesh.cleanMesh(logmsg);
+    };
+    clean.m_Teardown = [this]() {m_WorkMesh.clearMesh();};
+    harness.addCase(clean);
+
+    BenchCase connect;
+    connect.m_Name = "trimesh_connect";
+    connect.m_Group = "micro";
+    connect.m_Description = "connection of the plane's triangles from the node positions";
+    connect.m_Reset = [this]() {m_WorkMesh = m_RefMesh;};
+    connect.m_Run = [this]() {m_WorkMesh.makeConnectionsFromNodePosition(true, ThreadPool::maxThreadCount()>1);};
+    connect.m_Teardown = [this]() {m_WorkMesh.clearMesh();};
+    harness.addCase(connect);
+
+    BenchCase nurbs;
+    nurbs.m_Name = "nurbs_evaluation";
+    nurbs.m_Group = "micro";
+    nurbs.m_Description = "evaluation of the boat's NURBS sail on a 200x200 grid";
+    nurbs.m_Run = [this]()
+    {
+        Sail const *pSail = m_pBoat->sailAt(0);
+        if(!pSail || !pSail->isNURBSSail()) return;
+        NURBSSurface const &surface = static_cast<SailNurbs const*>(pSail)->nurbs();
+        Vector3d Pt, PtSum;
+        int n = 200;
+        for(int i=0; i<n; i++)
+        {
+            double u = double(i)/double(n-1);
+            for(int j=0; j<n; j++)
+            {
+                surface.getPoint(u, double(j)/double(n-1), Pt);
+                PtSum += Pt;
+            }
+        }
+        (void)PtSum;
+    };
+    harness.addCase(nurbs);
+}
+
+
+void BenchCases::addProjectCases(BenchHarness &harness)
+{
+    BenchCase save;
+    save.m_Name = "project_save";
+    save.m_Group = "macro";
+    save.m_Description = "serialization of the reference project to memory";
+    save.m_Reset = [this]() {m_ProjectBuffer.clear();};
+    save.m_Run = [this]()
+    {
+        QBuffer buffer(&m_ProjectBuffer);
+        buffer.open(QIODevice::WriteOnly);
+        QDataStream ar(&buffer);
+        FileIO saver;
+        saver.serializeProjectFl5(ar, true);
+    };
+    harness.addCase(save);
+
+    BenchCase load;
+    load.m_Name = "project_load";
+    load.m_Group = "macro";
+    load.m_Description = "loading of the reference project from memory into an empty store";
+    load.m_Setup = [this]()
+    {
+        m_ProjectBuffer.clear();
+        QBuffer buffer(&m_ProjectBuffer);
+        buffer.open(QIODevice::WriteOnly);
+        QDataStream ar(&buffer);
+        FileIO saver;
+        saver.serializeProjectFl5(ar, true);
+    };
+    load.m_Reset = [this]() {m_pLoadStore = std::make_unique<ObjectStore>();};
+    load.m_Run = [this]()
+    {
+        ScopedStore scope(m_pLoadStore.get());
+        QBuffer buffer(&m_ProjectBuffer);
+        buffer.open(QIODevice::ReadOnly);
+        QDataStream ar(&buffer);
+        FileIO loader;
+        loader.serializeProjectFl5(ar, false);
+    };
+    load.m_Teardown = [this]() {m_pLoadStore.reset(); m_ProjectBuffer.clear();};
+    harness.addCase(load);
+}
+
+
+void BenchCases::resetPlane()
+{
+    m_pPlane->restoreMesh();
+}
+
+
+/**
+ * Runs the inviscid T1 analysis of the reference plane and returns the phase timings of the task;
+ * this is the reference analysis of the scaling sweep.
+ * The mesh should be restored with resetPlane() before each run, and the LU cache should be disabled by the caller so that each run factorizes its matrix.
+ */
+void BenchCases::runPlaneAnalysis(TaskProfile &profile)
+{
+    PlaneTask task;
+    task.setObjects(m_pPlane, m_pPlPolar);
+    task.setComputeDerivatives(false);
+    task.setKeepOpps(false);
+    task.setOppList({-2.0, 3.0, 8.0});
+    task.run();
+
+    profile.clear();
+    profile.merge(task.profile(), 0);
+}
+
+
+void BenchCases::addAnalysisCases(BenchHarness &harness)
+{
+    // the LU cache is disabled so that each repetition makes and factorizes its matrix
+    BenchCase plane;
+    plane.m_Name = "plane_t1_analysis";
+    plane.m_Group = "macro";
+    plane.m_Description = "inviscid T1 analysis of the reference plane at -2, 3 and 8 degrees";
+    plane.m_Setup = []() {LUCache::setEnabled(false);};
+    plane.m_Reset = [this]() {resetPlane();};
+    plane.m_Run = [this]()
+    {
+        TaskProfile profile;
+        runPlaneAnalysis(profile);
+    };
+    plane.m_Teardown = []() {LUCache::setEnabled(true);};
+    harness.addCase(plane);
+
+    BenchCase boat;
+    boat.m_Name = "boat_analysis";
+    boat.m_Group = "macro";
+    boat.m_Description = "analysis of the reference boat at one operating point";
+    boat.m_Setup = []() {LUCache::setEnabled(false);};
+    boat.m_Reset = [this]() {m_pBoat->restoreMesh();};
+    boat.m_Run = [this]()
+    {
+        BoatTask task;
+        task.setObjects(m_pBoat, m_pBtPolar);
+        task.setKeepOpps(false);
+        task.setAnalysisRange({0.0});
+        task.initializeTask(nullptr);
+        task.run();
+    };
+    boat.m_Teardown = []() {LUCache::setEnabled(true);};
+    harness.addCase(boat);
+}
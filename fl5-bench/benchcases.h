@@ -0,0 +1,115 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+
+#include <api/trimesh.h>
+#include <api/vector3d.h>
+#include <api/vorton.h>
+
+class BenchHarness;
+class Boat;
+class BoatPolar;
+class Foil;
+class ObjectStore;
+class PlanePolar;
+class PlaneTask;
+class PlaneXfl;
+class Polar;
+class TaskProfile;
+
+
+/**
+ * @class BenchCases
+ * @brief Builds the reference objects and registers the benchmark cases which use them.
+ *
+ * The reference set is generated in code in the same way as the API examples,
+ * so that the timings of different releases are measured on identical inputs:
+ * three NACA foils, the default two-wing plane with a fin, and the default boat.
+ */
+class BenchCases
+{
+    public:
+        BenchCases();
+        ~BenchCases();
+
+        bool makeReferenceObjects();
+        void registerCases(BenchHarness &harness);
+
+        void resetPlane();
+        void runPlaneAnalysis(TaskProfile &profile);
+
+        PlaneXfl *plane() const {return m_pPlane;}
+        PlanePolar const *planePolar() const {return m_pPlPolar;}
+        Boat *boat() const {return m_pBoat;}
+        BoatPolar *boatPolar() const {return m_pBtPolar;}
+        std::vector<Foil*> const &foils() const {return m_Foil;}
+        std::vector<Polar*> const &foilPolars() const {return m_FoilPolar;}
+
+    private:
+        void addPanelCases(BenchHarness &harness);
+        void addMatrixCases(BenchHarness &harness);
+        void addVortonCases(BenchHarness &harness);
+        void addXFoilCases(BenchHarness &harness);
+        void addMeshCases(BenchHarness &harness);
+        void addProjectCases(BenchHarness &harness);
+        void addAnalysisCases(BenchHarness &harness);
+
+        void makeTestMatrix();
+        void makeVortonSheet();
+
+    private:
+        std::vector<Foil*> m_Foil;
+        std::vector<Polar*> m_FoilPolar;
+        PlaneXfl *m_pPlane;
+        PlanePolar *m_pPlPolar;
+        Boat *m_pBoat;
+        BoatPolar *m_pBtPolar;
+
+        std::vector<Vector3d> m_TestPts;   /**< the field points around the plane used by the panel kernels */
+
+        int m_MatSize;
+        std::vector<double> m_Matrix;      /**< a dense and well conditioned matrix, row major */
+        std::vector<double> m_LU;          /**< the working copy which is factorized in place */
+        std::vector<int> m_ipiv;
+        std::vector<double> m_RHS;
+
+        std::vector<Vorton> m_Vorton;
+        std::vector<Vector3d> m_VortonVel;
+
+        TriMesh m_RefMesh;                 /**< the plane's mesh before the cases which modify it */
+        TriMesh m_WorkMesh;
+
+        PlaneTask *m_pPlaneTask;           /**< the task which holds the panel analysis of the matrix assembly case */
+
+        QByteArray m_ProjectBuffer;
+        std::unique_ptr<ObjectStore> m_pLoadStore;
+};
+
@@ -0,0 +1,210 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <thread>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include "benchharness.h"
+
+#include <api/fl5core.h>
+#include <api/threadpool.h>
+#include <api/utils.h>
+
+
+BenchHarness::BenchHarness()
+{
+    m_nReps = 10;
+    m_nWarmup = 2;
+    m_bProgress = false;
+    m_Seconds = 0.0;
+}
+
+
+bool BenchHarness::isSelected(BenchCase const &benchcase) const
+{
+    if(m_Filter.pattern().isEmpty()) return true;
+    QString fullname = QString::fromStdString(benchcase.m_Group + "/" + benchcase.m_Name);
+    return m_Filter.match(fullname).hasMatch();
+}
+
+
+void BenchHarness::run()
+{
+    m_Result.clear();
+    auto start = std::chrono::steady_clock::now();
+
+    for(BenchCase const &benchcase : m_Case)
+    {
+        if(!isSelected(benchcase)) continue;
+
+        if(m_bProgress)
+        {
+            QTextStream out(stdout);
+            out << QString::fromStdString(benchcase.m_Group + "/" + benchcase.m_Name) << "..." << Qt::endl;
+        }
+
+        m_Result.push_back(runCase(benchcase));
+    }
+
+    m_Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+}
+
+
+BenchResult BenchHarness::runCase(BenchCase const &benchcase) const
+{
+    BenchResult result;
+    result.m_Name  = benchcase.m_Name;
+    result.m_Group = benchcase.m_Group;
+
+    if(benchcase.m_Setup) benchcase.m_Setup();
+
+    for(int i=0; i<m_nWarmup; i++)
+    {
+        if(benchcase.m_Reset) benchcase.m_Reset();
+        benchcase.m_Run();
+    }
+
+    for(int i=0; i<m_nReps; i++)
+    {
+        if(benchcase.m_Reset) benchcase.m_Reset();
+        auto t0 = std::chrono::steady_clock::now();
+        benchcase.m_Run();
+        result.m_Samples.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count());
+    }
+
+    if(benchcase.m_Teardown) benchcase.m_Teardown();
+
+    std::vector<double> sorted = result.m_Samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    int n = int(sorted.size());
+    result.m_nReps  = n;
+    result.m_Min    = sorted.front();
+    result.m_Max    = sorted.back();
+    result.m_Median = percentile(sorted, 50.0);
+    result.m_P90    = percentile(sorted, 90.0);
+    result.m_P99    = percentile(sorted, 99.0);
+    result.m_Mean   = std::accumulate(sorted.begin(), sorted.end(), 0.0)/double(n);
+
+    double var = 0.0;
+    for(double t : sorted) var += (t-result.m_Mean)*(t-result.m_Mean);
+    result.m_StdDev = n>1 ? sqrt(var/double(n-1)) : 0.0;
+
+    return result;
+}
+
+
+/**
+ * Returns the p-th percentile of the sorted samples, interpolated linearly between the closest ranks.
+ */
+double BenchHarness::percentile(std::vector<double> const &sorted, double p)
+{
+    if(sorted.empty()) return 0.0;
+    double rank = p/100.0 * double(sorted.size()-1);
+    int i0 = int(std::floor(rank));
+    int i1 = std::min(i0+1, int(sorted.size())-1);
+    double t = rank-double(i0);
+    return sorted.at(i0)*(1.0-t) + sorted.at(i1)*t;
+}
+
+
+QString BenchHarness::resultTable() const
+{
+    QString table;
+    table += QString::asprintf("%-36s %5s %12s %12s %12s %12s %12s\n", "case", "reps", "min (ms)", "median (ms)", "p90 (ms)", "p99 (ms)", "max (ms)");
+    for(BenchResult const &result : m_Result)
+    {
+        std::string fullname = result.m_Group + "/" + result.m_Name;
+        table += QString::asprintf("%-36s %5d %12.3f %12.3f %12.3f %12.3f %12.3f\n", fullname.c_str(), result.m_nReps,
+                                   result.m_Min*1000.0, result.m_Median*1000.0, result.m_P90*1000.0, result.m_P99*1000.0, result.m_Max*1000.0);
+    }
+    return table;
+}
+
+
+/**
+ * Writes the results as a JSON document, with the run's settings and the host's
+ * thread count so that the reports of different releases can be compared.
+ */
+bool BenchHarness::writeJson(QString const &pathname, bool bSamples) const
+{
+    QJsonArray cases;
+    for(BenchResult const &result : m_Result)
+    {
+        QJsonObject benchcase;
+        benchcase["name"]     = QString::fromStdString(result.m_Name);
+        benchcase["group"]    = QString::fromStdString(result.m_Group);
+        benchcase["reps"]     = result.m_nReps;
+        benchcase["min_s"]    = result.m_Min;
+        benchcase["median_s"] = result.m_Median;
+        benchcase["p90_s"]    = result.m_P90;
+        benchcase["p99_s"]    = result.m_P99;
+        benchcase["max_s"]    = result.m_Max;
+        benchcase["mean_s"]   = result.m_Mean;
+        benchcase["stddev_s"] = result.m_StdDev;
+        if(bSamples)
+        {
+            QJsonArray samples;
+            for(double t : result.m_Samples) samples.append(t);
+            benchcase["samples_s"] = samples;
+        }
+        cases.append(benchcase);
+    }
+
+    QJsonObject report;
+    report["program"]           = "fl5-bench";
+    report["version"]           = QString::fromStdString(fl5::versionName(true));
+    report["repetitions"]       = m_nReps;
+    report["warmup"]            = m_nWarmup;
+    report["threads"]           = ThreadPool::maxThreadCount();
+    report["hardware_threads"]  = int(std::thread::hardware_concurrency());
+    report["wall_time_s"]       = m_Seconds;
+    report["peak_memory_bytes"] = double(xfl::peakMemoryUsage());
+    report["cases"]             = cases;
+
+    QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    QFile XFile;
+    bool bOpen = false;
+    if(pathname=="-") bOpen = XFile.open(stdout, QIODevice::WriteOnly);
+    else
+    {
+        XFile.setFileName(pathname);
+        bOpen = XFile.open(QIODevice::WriteOnly);
+    }
+    if(!bOpen) return false;
+
+    bool bWritten = XFile.write(json)==json.size();
+    XFile.close();
+    return bWritten;
+}
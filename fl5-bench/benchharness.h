@@ -0,0 +1,108 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <QRegularExpression>
+#include <QString>
+
+
+/**
+ * @struct BenchCase
+ * @brief A benchmark case: the set-up and tear-down are run once, the reset before each repetition
+ * and only the run is timed.
+ */
+struct BenchCase
+{
+    std::string m_Name;
+    std::string m_Group;     /**< "micro" for the kernels, "macro" for the complete analyses and file operations */
+    std::string m_Description;
+    std::function<void()> m_Setup;
+    std::function<void()> m_Reset;
+    std::function<void()> m_Run;
+    std::function<void()> m_Teardown;
+};
+
+
+/** The statistics of the timed repetitions of a case, in seconds */
+struct BenchResult
+{
+    std::string m_Name;
+    std::string m_Group;
+    int m_nReps{0};
+    double m_Min{0}, m_Median{0}, m_P90{0}, m_P99{0}, m_Max{0};
+    double m_Mean{0}, m_StdDev{0};
+    std::vector<double> m_Samples;
+};
+
+
+/**
+ * @class BenchHarness
+ * @brief Runs the registered cases with warm-up repetitions and reports the percentiles of the timed repetitions.
+ */
+class BenchHarness
+{
+    public:
+        BenchHarness();
+
+        void addCase(BenchCase const &benchcase) {m_Case.push_back(benchcase);}
+        std::vector<BenchCase> const &cases() const {return m_Case;}
+
+        void setRepetitions(int nReps) {m_nReps=std::max(1, nReps);}
+        void setWarmup(int nWarmup) {m_nWarmup=std::max(0, nWarmup);}
+        void setFilter(QString const &pattern) {m_Filter.setPattern(pattern);}
+        bool isFilterValid() const {return m_Filter.isValid();}
+        void setProgress(bool bProgress) {m_bProgress=bProgress;}
+
+        bool isSelected(BenchCase const &benchcase) const;
+
+        void run();
+
+        std::vector<BenchResult> const &results() const {return m_Result;}
+
+        QString resultTable() const;
+        bool writeJson(QString const &pathname, bool bSamples) const;
+
+        static double percentile(std::vector<double> const &sorted, double p);
+
+    private:
+        BenchResult runCase(BenchCase const &benchcase) const;
+
+    private:
+        std::vector<BenchCase> m_Case;
+        std::vector<BenchResult> m_Result;
+
+        int m_nReps;
+        int m_nWarmup;
+        QRegularExpression m_Filter;
+        bool m_bProgress;
+        double m_Seconds;
+};
+
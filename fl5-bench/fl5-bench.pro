@@ -0,0 +1,86 @@
+DEFINES += QT_DEPRECATED_WARNINGS
+
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+# The benchmark runner: depends only on QtCore, fl5-lib and XFoil-lib
+TEMPLATE = app
+TARGET = fl5-bench
+
+VERSION = 7.54
+
+QT = core
+
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+OBJECTS_DIR = ./objects
+MOC_DIR     = ./moc
+
+CONFIG(release, debug|release) {
+    CONFIG += optimize_full
+}
+
+INCLUDEPATH += $$PWD/../XFoil-lib/
+INCLUDEPATH += $$PWD/../fl5-lib/
+INCLUDEPATH += $$PWD/../fl5-lib/api
+
+
+linux-g++ {
+    CONFIG += thread
+    DEFINES += LINUX_OS
+
+    # the lib's headers use the OpenCascade types
+    INCLUDEPATH += /usr/local/include/opencascade/
+    INCLUDEPATH += /usr/include/opencascade/
+    LIBS += -L/usr/local/lib/
+
+    LIBS += -L../XFoil-lib -lXFoil
+    LIBS += -L../fl5-lib -lfl5-lib
+}
+
+
+win32-msvc {
+    CONFIG -= debug_and_release debug_and_release_target
+    DEFINES += _UNICODE WIN64
+
+    INCLUDEPATH += D:\bin\OCCT-7_9_2\build\inc
+    LIBS += -LD:\bin\OCCT-7_9_2\build\win64\vc14\lib
+
+    LIBS += -L../XFoil-lib -lXFoil1
+    LIBS += -L../fl5-lib -lfl5-lib
+}
+
+
+macx {
+    QMAKE_MAC_SDK = macosx
+    QMAKE_APPLE_DEVICE_ARCHS = x86_64 arm64
+
+    INCLUDEPATH += /usr/local/include/opencascade
+    LIBS += -L/usr/local/lib
+
+    LIBS += -L$$OUT_PWD/../XFoil-lib -lXFoil
+    LIBS += -L$$OUT_PWD/../fl5-lib -lfl5-lib
+}
+
+
+LIBS += \
+    -lTKBRep \
+    -lTKG3d \
+    -lTKMath \
+    -lTKTopAlgo \
+    -lTKernel \
+
+
+SOURCES += \
+    $$PWD/main.cpp \
+    $$PWD/benchcases.cpp \
+    $$PWD/benchharness.cpp \
+    $$PWD/scalingsweep.cpp \
+    $$PWD/validation.cpp
+
+
+HEADERS += \
+    $$PWD/benchcases.h \
+    $$PWD/benchharness.h \
+    $$PWD/scalingsweep.h \
+    $$PWD/validation.h
@@ -0,0 +1,335 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+/** @file
+ *
+ * The benchmark runner of the flow5 library.
+ *
+ * Usage:
+ * fl5-bench                              : runs all the cases and prints the result table
+ * fl5-bench -l                           : lists the cases
+ * fl5-bench -f "micro/panel" -n 20       : runs the cases which match the regular expression 20 times
+ * fl5-bench -j results.json -s           : also writes the results and the individual samples as JSON; use "-" for the standard output
+ * fl5-bench -t 1                         : runs single-threaded
+ * fl5-bench --scaling --save-settings    : sweeps the block and BLAS thread counts and stores the recommended split
+ * fl5-bench --validate --write-baseline ref.json : runs the reference polars and stores their results as the baseline
+ * fl5-bench --validate --baseline ref.json       : runs the reference polars and reports their errors and runtimes against the baseline
+ *
+ * Exit codes: 0 on success, 1 if the reference objects could not be built or the results not written, 2 on a usage error,
+ * 3 if a validation case has no results or deviates from the baseline by more than the tolerance.
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+
+#include "benchcases.h"
+#include "benchharness.h"
+#include "scalingsweep.h"
+#include "validation.h"
+
+#include <api/fl5core.h>
+#include <api/kernelstats.h>
+#include <api/lucache.h>
+#include <api/panelanalysis.h>
+#include <api/threadpool.h>
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("fl5-bench");
+    QCoreApplication::setApplicationVersion(QString::fromStdString(fl5::versionName(true)));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs the micro and macro benchmarks of the flow5 library on a fixed set of reference objects.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption ListOption(QStringList() << "l" << "list");
+    ListOption.setDescription("Lists the cases and exits.");
+    parser.addOption(ListOption);
+
+    QCommandLineOption FilterOption(QStringList() << "f" << "filter");
+    FilterOption.setValueName("regexp");
+    FilterOption.setDescription("Runs only the cases whose \"group/name\" matches the regular expression.");
+    parser.addOption(FilterOption);
+
+    QCommandLineOption RepsOption(QStringList() << "n" << "reps");
+    RepsOption.setValueName("count");
+    RepsOption.setDescription("The number of timed repetitions of each case; default is 10.");
+    parser.addOption(RepsOption);
+
+    QCommandLineOption WarmupOption(QStringList() << "w" << "warmup");
+    WarmupOption.setValueName("count");
+    WarmupOption.setDescription("The number of untimed runs of each case before the repetitions; default is 2.");
+    parser.addOption(WarmupOption);
+
+    QCommandLineOption ThreadsOption(QStringList() << "t" << "threads");
+    ThreadsOption.setValueName("count");
+    ThreadsOption.setDescription("The maximum number of threads; default is the number of hardware threads.");
+    parser.addOption(ThreadsOption);
+
+    QCommandLineOption JsonOption(QStringList() << "j" << "json");
+    JsonOption.setValueName("file");
+    JsonOption.setDescription("Writes the results as JSON to the file, or to the standard output if the file is \"-\".");
+    parser.addOption(JsonOption);
+
+    QCommandLineOption SamplesOption(QStringList() << "s" << "samples");
+    SamplesOption.setDescription("Includes the individual timings of each repetition in the JSON output.");
+    parser.addOption(SamplesOption);
+
+    QCommandLineOption ProgressOption(QStringList() << "p" << "progress");
+    ProgressOption.setDescription("Shows the name of each case on the standard error output as it runs.");
+    parser.addOption(ProgressOption);
+
+    QCommandLineOption KernelStatsOption(QStringList() << "k" << "kernel-stats");
+    KernelStatsOption.setDescription("Counts the panel kernel calls and prints the statistics on the standard error output after the run; "
+                                     "requires fl5-lib to be built with FL5_KERNEL_STATS.");
+    parser.addOption(KernelStatsOption);
+
+    QCommandLineOption ScalingOption("scaling");
+    ScalingOption.setDescription("Runs the reference plane analysis over a matrix of block and BLAS thread counts "
+                                 "and reports the strong-scaling efficiency of each phase, instead of the cases.");
+    parser.addOption(ScalingOption);
+
+    QCommandLineOption BlockThreadsOption("block-threads");
+    BlockThreadsOption.setDescription("The comma separated block thread counts of the scaling sweep; defaults to the powers of two up to the core count.");
+    BlockThreadsOption.setValueName("counts");
+    parser.addOption(BlockThreadsOption);
+
+    QCommandLineOption BlasThreadsOption("blas-threads");
+    BlasThreadsOption.setDescription("The comma separated BLAS thread counts of the scaling sweep; only used by the MKL builds.");
+    BlasThreadsOption.setValueName("counts");
+    parser.addOption(BlasThreadsOption);
+
+    QCommandLineOption SaveSettingsOption("save-settings");
+    SaveSettingsOption.setDescription("Stores the recommended thread counts of the scaling sweep in the settings of flow5.");
+    parser.addOption(SaveSettingsOption);
+
+    QCommandLineOption ValidateOption("validate");
+    ValidateOption.setDescription("Runs the reference plane, boat and foil polars and compares their coefficients, "
+                                  "span distributions and Cp arrays to the baseline, instead of the cases.");
+    parser.addOption(ValidateOption);
+
+    QCommandLineOption BaselineOption("baseline");
+    BaselineOption.setDescription("The baseline file of the validation.");
+    BaselineOption.setValueName("file");
+    parser.addOption(BaselineOption);
+
+    QCommandLineOption WriteBaselineOption("write-baseline");
+    WriteBaselineOption.setDescription("Writes the results of the validation to the file, to be used as the baseline of the next runs.");
+    WriteBaselineOption.setValueName("file");
+    parser.addOption(WriteBaselineOption);
+
+    QCommandLineOption ToleranceOption("tolerance");
+    ToleranceOption.setDescription("The maximum relative error of the validation; default is 1e-3.");
+    ToleranceOption.setValueName("value");
+    parser.addOption(ToleranceOption);
+
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    BenchHarness harness;
+
+    bool bOK = true;
+    if(parser.isSet(RepsOption))
+    {
+        int nReps = parser.value(RepsOption).toInt(&bOK);
+        if(!bOK || nReps<1)
+        {
+            err << "Invalid repetition count\n\n" << parser.helpText();
+            return 2;
+        }
+        harness.setRepetitions(nReps);
+    }
+    if(parser.isSet(WarmupOption))
+    {
+        int nWarmup = parser.value(WarmupOption).toInt(&bOK);
+        if(!bOK || nWarmup<0)
+        {
+            err << "Invalid warm-up count\n\n" << parser.helpText();
+            return 2;
+        }
+        harness.setWarmup(nWarmup);
+    }
+    if(parser.isSet(ThreadsOption))
+    {
+        int nThreads = parser.value(ThreadsOption).toInt(&bOK);
+        if(!bOK || nThreads<1)
+        {
+            err << "Invalid thread count\n\n" << parser.helpText();
+            return 2;
+        }
+        ThreadPool::setMaxThreadCount(nThreads);
+        PanelAnalysis::setMaxThreadCount(nThreads);
+        PanelAnalysis::setMultiThread(nThreads>1);
+    }
+    if(parser.isSet(FilterOption))
+    {
+        harness.setFilter(parser.value(FilterOption));
+        if(!harness.isFilterValid())
+        {
+            err << "Invalid filter expression\n\n" << parser.helpText();
+            return 2;
+        }
+    }
+    harness.setProgress(parser.isSet(ProgressOption));
+    if(parser.isSet(KernelStatsOption))
+    {
+        if(!KernelStats::isCompiled())
+        {
+            err << "fl5-lib has been built without the kernel statistics\n";
+            return 2;
+        }
+        KernelStats::setEnabled(true);
+    }
+
+    // the per-foil cases are made from the reference objects, so these are built before listing
+    BenchCases benchcases;
+    if(!benchcases.makeReferenceObjects())
+    {
+        err << "Could not build the reference objects\n";
+        return 1;
+    }
+    benchcases.registerCases(harness);
+
+    if(parser.isSet(ScalingOption))
+    {
+        ScalingSweep sweep;
+        std::vector<int> counts;
+        if(parser.isSet(BlockThreadsOption))
+        {
+            if(!ScalingSweep::parseCounts(parser.value(BlockThreadsOption), counts))
+            {
+                err << "Invalid block thread counts\n\n" << parser.helpText();
+                return 2;
+            }
+            sweep.setOuterCounts(counts);
+        }
+        if(parser.isSet(BlasThreadsOption))
+        {
+            if(!ScalingSweep::parseCounts(parser.value(BlasThreadsOption), counts))
+            {
+                err << "Invalid BLAS thread counts\n\n" << parser.helpText();
+                return 2;
+            }
+            sweep.setInnerCounts(counts);
+        }
+        if(parser.isSet(RepsOption))   sweep.setRepetitions(parser.value(RepsOption).toInt());
+        if(parser.isSet(WarmupOption)) sweep.setWarmup(parser.value(WarmupOption).toInt());
+        sweep.setProgress(parser.isSet(ProgressOption));
+
+        // each run factorizes its matrix
+        LUCache::setEnabled(false);
+        sweep.run([&benchcases]() {benchcases.resetPlane();},
+                  [&benchcases](TaskProfile &profile) {benchcases.runPlaneAnalysis(profile);});
+        LUCache::setEnabled(true);
+
+        out << sweep.report();
+
+        if(parser.isSet(SaveSettingsOption))
+        {
+            QString settingsfile;
+            if(!sweep.saveRecommendation(settingsfile))
+            {
+                err << "Could not store the recommended thread counts\n";
+                return 1;
+            }
+            out << "The recommended thread counts have been stored in " << settingsfile << "\n";
+        }
+        return 0;
+    }
+
+    if(parser.isSet(ValidateOption))
+    {
+        ValidationSuite validation(benchcases);
+        if(parser.isSet(ToleranceOption))
+        {
+            double tol = parser.value(ToleranceOption).toDouble(&bOK);
+            if(!bOK || tol<=0.0)
+            {
+                err << "Invalid tolerance\n\n" << parser.helpText();
+                return 2;
+            }
+            validation.setTolerance(tol);
+        }
+        if(parser.isSet(BaselineOption) && !validation.readBaseline(parser.value(BaselineOption)))
+        {
+            err << "Could not read the baseline " << parser.value(BaselineOption) << "\n";
+            return 1;
+        }
+        validation.setProgress(parser.isSet(ProgressOption));
+
+        // each case factorizes its matrix, so that the runtimes are comparable
+        LUCache::setEnabled(false);
+        validation.run();
+        LUCache::setEnabled(true);
+
+        out << validation.report();
+
+        if(parser.isSet(WriteBaselineOption))
+        {
+            if(!validation.writeBaseline(parser.value(WriteBaselineOption)))
+            {
+                err << "Could not write the baseline to " << parser.value(WriteBaselineOption) << "\n";
+                return 1;
+            }
+        }
+        return validation.isWithinTolerance() ? 0 : 3;
+    }
+
+    if(parser.isSet(ListOption))
+    {
+        for(BenchCase const &bc : harness.cases())
+        {
+            if(!harness.isSelected(bc)) continue;
+            out << QString::fromStdString(bc.m_Group + "/" + bc.m_Name).leftJustified(40)
+                << QString::fromStdString(bc.m_Description) << "\n";
+        }
+        return 0;
+    }
+
+    KernelStats::Totals kernelstart = KernelStats::snapshot();
+    harness.run();
+    if(KernelStats::isEnabled())
+        err << QString::fromStdString(KernelStats::report(KernelStats::snapshot()-kernelstart));
+
+    QString jsonpath = parser.value(JsonOption);
+    if(jsonpath!="-") out << harness.resultTable();
+
+    if(parser.isSet(JsonOption))
+    {
+        if(!harness.writeJson(jsonpath, parser.isSet(SamplesOption)))
+        {
+            err << "Could not write the results to " << jsonpath << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
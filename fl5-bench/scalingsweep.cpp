@@ -0,0 +1,298 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include <QSettings>
+#include <QStringList>
+
+#include "benchharness.h"
+#include "scalingsweep.h"
+
+#include <api/panelanalysis.h>
+#include <api/taskprofile.h>
+#include <api/threadpool.h>
+
+
+ScalingSweep::ScalingSweep()
+{
+    m_Outer = m_Inner = defaultCounts();
+    m_nReps = 3;
+    m_nWarmup = 1;
+    m_bProgress = false;
+}
+
+
+/** @return the powers of two up to the number of hardware threads, and that number */
+std::vector<int> ScalingSweep::defaultCounts()
+{
+    int nMax = std::max(1, int(std::thread::hardware_concurrency()));
+    std::vector<int> counts;
+    for(int n=1; n<nMax; n*=2) counts.push_back(n);
+    counts.push_back(nMax);
+    return counts;
+}
+
+
+/** Parses a comma separated list of thread counts; returns false if a count is not a positive integer */
+bool ScalingSweep::parseCounts(QString const &list, std::vector<int> &counts)
+{
+    counts.clear();
+    QStringList fields = list.split(QChar(','), Qt::SkipEmptyParts);
+    for(QString const &field : fields)
+    {
+        bool bOK = false;
+        int n = field.trimmed().toInt(&bOK);
+        if(!bOK || n<1) return false;
+        if(std::find(counts.begin(), counts.end(), n)==counts.end()) counts.push_back(n);
+    }
+    std::sort(counts.begin(), counts.end());
+    return !counts.empty();
+}
+
+
+/**
+ * Runs the analysis for each pair of block and BLAS thread counts, and keeps the median of the timed repetitions.
+ * The reset is called before each run and is not timed.
+ * The thread settings are restored on exit.
+ */
+void ScalingSweep::run(std::function<void()> const &reset, std::function<void(TaskProfile &)> const &analysis)
+{
+    int maxThreads = PanelAnalysis::maxThreadCount();
+    bool bMultiThread = PanelAnalysis::bMultiThread();
+    int blasThreads = PanelAnalysis::blasThreads();
+
+    m_Point.clear();
+    m_Paths.clear();
+
+    for(int outer : m_Outer)
+    {
+        for(int inner : m_Inner)
+        {
+            if(m_bProgress) fprintf(stderr, "%d block threads x %d BLAS threads\n", outer, inner);
+
+            PanelAnalysis::setMaxThreadCount(outer); // also sizes the thread pool
+            PanelAnalysis::setMultiThread(outer>1 || inner>1);
+            PanelAnalysis::setBlasThreads(inner);
+
+            TaskProfile profile;
+            for(int i=0; i<m_nWarmup; i++)
+            {
+                if(reset) reset();
+                analysis(profile);
+            }
+
+            std::vector<double> totals;
+            std::map<std::string, std::vector<double>> phases;
+            for(int i=0; i<m_nReps; i++)
+            {
+                if(reset) reset();
+                auto t0 = std::chrono::steady_clock::now();
+                analysis(profile);
+                totals.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count());
+
+                std::vector<TaskProfile::Phase> phaselist = profile.phases();
+                for(int ip=0; ip<int(phaselist.size()); ip++)
+                {
+                    std::string path = profile.phasePath(ip);
+                    if(std::find(m_Paths.begin(), m_Paths.end(), path)==m_Paths.end()) m_Paths.push_back(path);
+                    phases[path].push_back(phaselist.at(ip).m_Seconds);
+                }
+            }
+
+            ScalingPoint point;
+            point.m_Outer = outer;
+            point.m_Inner = inner;
+            std::sort(totals.begin(), totals.end());
+            point.m_Total = BenchHarness::percentile(totals, 50.0);
+            for(auto &phase : phases)
+            {
+                std::sort(phase.second.begin(), phase.second.end());
+                point.m_Phase[phase.first] = BenchHarness::percentile(phase.second, 50.0);
+            }
+            m_Point.push_back(point);
+        }
+    }
+
+    PanelAnalysis::setMaxThreadCount(maxThreads);
+    PanelAnalysis::setMultiThread(bMultiThread);
+    PanelAnalysis::setBlasThreads(blasThreads);
+}
+
+
+/** @return the configuration with the fewest threads, which serves as the base of the efficiencies */
+ScalingPoint const *ScalingSweep::reference() const
+{
+    ScalingPoint const *pRef = nullptr;
+    for(ScalingPoint const &point : m_Point)
+    {
+        if(!pRef || point.m_Outer*point.m_Inner < pRef->m_Outer*pRef->m_Inner) pRef = &point;
+    }
+    return pRef;
+}
+
+
+double ScalingSweep::efficiency(ScalingPoint const &point, std::string const &path) const
+{
+    ScalingPoint const *pRef = reference();
+    if(!pRef) return 0.0;
+
+    double t0=0, t=0;
+    int nThreads=1, nRef=1;
+    if(path.empty())
+    {
+        // the phases do not overlap, so the whole run uses the larger of the two counts
+        t0 = pRef->m_Total;
+        t  = point.m_Total;
+        nThreads = std::max(point.m_Outer, point.m_Inner);
+        nRef     = std::max(pRef->m_Outer, pRef->m_Inner);
+    }
+    else
+    {
+        auto itRef = pRef->m_Phase.find(path);
+        auto it = point.m_Phase.find(path);
+        if(itRef==pRef->m_Phase.end() || it==point.m_Phase.end()) return 0.0;
+        t0 = itRef->second;
+        t  = it->second;
+        bool bBlas = path.find("LU factorization")!=std::string::npos || path.find("LU update")!=std::string::npos ||
+                     path.find("back-substitution")!=std::string::npos;
+        nThreads = bBlas ? point.m_Inner : point.m_Outer;
+        nRef     = bBlas ? pRef->m_Inner : pRef->m_Outer;
+    }
+    if(t<=0.0) return 0.0;
+    return t0*double(nRef) / (t*double(nThreads));
+}
+
+
+/**
+ * @return the fastest configuration, or the one with the fewest threads among those
+ * within 3% of the fastest, so that the cores are not taken for no gain.
+ */
+ScalingPoint const *ScalingSweep::recommended() const
+{
+    ScalingPoint const *pBest = nullptr;
+    for(ScalingPoint const &point : m_Point)
+        if(!pBest || point.m_Total<pBest->m_Total) pBest = &point;
+    if(!pBest) return nullptr;
+
+    double limit = pBest->m_Total*1.03;
+    ScalingPoint const *pRecommended = pBest;
+    for(ScalingPoint const &point : m_Point)
+    {
+        if(point.m_Total>limit) continue;
+        int n  = std::max(point.m_Outer, point.m_Inner);
+        int nr = std::max(pRecommended->m_Outer, pRecommended->m_Inner);
+        if(n<nr || (n==nr && point.m_Outer+point.m_Inner<pRecommended->m_Outer+pRecommended->m_Inner))
+            pRecommended = &point;
+    }
+    return pRecommended;
+}
+
+
+QString ScalingSweep::report() const
+{
+    QString strange;
+    char line[512];
+    ScalingPoint const *pRef = reference();
+    if(!pRef) return strange;
+
+    strange += "Block  BLAS    Total [s]  Speed-up  Efficiency\n";
+    for(ScalingPoint const &point : m_Point)
+    {
+        snprintf(line, sizeof(line), "%5d %5d %12.4f %9.2f %10.1f%%\n", point.m_Outer, point.m_Inner, point.m_Total,
+                 point.m_Total>0.0 ? pRef->m_Total/point.m_Total : 0.0, efficiency(point, std::string())*100.0);
+        strange += line;
+    }
+
+    // the phases which take at least 1% of the reference time
+    strange += "\nPhase efficiencies [%], block x BLAS threads\n";
+    snprintf(line, sizeof(line), "%-48s", "");
+    strange += line;
+    for(ScalingPoint const &point : m_Point)
+    {
+        char config[32];
+        snprintf(config, sizeof(config), "%dx%d", point.m_Outer, point.m_Inner);
+        snprintf(line, sizeof(line), " %7s", config);
+        strange += line;
+    }
+    strange += "\n";
+
+    for(std::string const &path : m_Paths)
+    {
+        auto it = pRef->m_Phase.find(path);
+        if(it==pRef->m_Phase.end() || it->second<0.01*pRef->m_Total) continue;
+
+        std::string name = path.size()>47 ? "..."+path.substr(path.size()-44) : path;
+        snprintf(line, sizeof(line), "%-48s", name.c_str());
+        strange += line;
+        for(ScalingPoint const &point : m_Point)
+        {
+            snprintf(line, sizeof(line), " %7.1f", efficiency(point, path)*100.0);
+            strange += line;
+        }
+        strange += "\n";
+    }
+
+    ScalingPoint const *pRecommended = recommended();
+    if(pRecommended)
+    {
+        snprintf(line, sizeof(line), "\nRecommended: %d block threads, %d BLAS threads (%.4f s)\n",
+                 pRecommended->m_Outer, pRecommended->m_Inner, pRecommended->m_Total);
+        strange += line;
+    }
+    return strange;
+}
+
+
+/**
+ * Stores the recommended counts in the settings of the application, in the group read by Analysis3dSettings.
+ * @param settingsfile the path of the settings file which has been written
+ */
+bool ScalingSweep::saveRecommendation(QString &settingsfile) const
+{
+    ScalingPoint const *pRecommended = recommended();
+    if(!pRecommended) return false;
+
+#if defined Q_OS_MAC
+    QSettings settings(QSettings::IniFormat,QSettings::UserScope,"flow5", "flow5");
+#elif defined Q_OS_LINUX
+    QSettings settings(QSettings::NativeFormat,QSettings::UserScope,"flow5", "flow5");
+#else
+    QSettings settings(QSettings::IniFormat,QSettings::UserScope,"flow5");
+#endif
+
+    settings.beginGroup("Analysis3dSettings");
+    {
+        settings.setValue("BlockThreads", pRecommended->m_Outer);
+        settings.setValue("BlasThreads",  pRecommended->m_Inner);
+    }
+    settings.endGroup();
+    settings.sync();
+
+    settingsfile = settings.fileName();
+    return settings.status()==QSettings::NoError;
+}
@@ -0,0 +1,91 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <QString>
+
+class TaskProfile;
+
+
+/** The median timings of one thread configuration, in seconds */
+struct ScalingPoint
+{
+    int m_Outer{1};                          /**< the number of block threads */
+    int m_Inner{1};                          /**< the number of BLAS threads */
+    double m_Total{0};
+    std::map<std::string, double> m_Phase;   /**< the median time of each profile phase, by path */
+};
+
+
+/**
+ * @class ScalingSweep
+ * @brief Runs a reference analysis over a matrix of block and BLAS thread counts
+ * and reports the strong-scaling efficiency of each profile phase.
+ *
+ * The efficiency of a configuration is the single-thread time divided by the time and by the thread count
+ * that the phase can use: the BLAS count for the factorization phases, the block count for the others.
+ * The BLAS count only has an effect when fl5-lib is built with INTEL_MKL.
+ */
+class ScalingSweep
+{
+    public:
+        ScalingSweep();
+
+        void setOuterCounts(std::vector<int> const &counts) {m_Outer=counts;}
+        void setInnerCounts(std::vector<int> const &counts) {m_Inner=counts;}
+        void setRepetitions(int nReps) {m_nReps=std::max(1, nReps);}
+        void setWarmup(int nWarmup) {m_nWarmup=std::max(0, nWarmup);}
+        void setProgress(bool bProgress) {m_bProgress=bProgress;}
+
+        void run(std::function<void()> const &reset, std::function<void(TaskProfile &)> const &analysis);
+
+        std::vector<ScalingPoint> const &points() const {return m_Point;}
+        ScalingPoint const *recommended() const;
+
+        QString report() const;
+        bool saveRecommendation(QString &settingsfile) const;
+
+        static std::vector<int> defaultCounts();
+        static bool parseCounts(QString const &list, std::vector<int> &counts);
+
+    private:
+        ScalingPoint const *reference() const;
+        double efficiency(ScalingPoint const &point, std::string const &path) const;
+
+    private:
+        std::vector<int> m_Outer, m_Inner;
+        std::vector<ScalingPoint> m_Point;
+        std::vector<std::string> m_Paths;    /**< the phases in the order of their first appearance */
+
+        int m_nReps;
+        int m_nWarmup;
+        bool m_bProgress;
+};
@@ -0,0 +1,455 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "benchcases.h"
+#include "validation.h"
+
+#include <api/aeroforces.h>
+#include <api/boat.h>
+#include <api/boatopp.h>
+#include <api/boatpolar.h>
+#include <api/boattask.h>
+#include <api/fl5core.h>
+#include <api/foil.h>
+#include <api/objects3d.h>
+#include <api/oppoint.h>
+#include <api/planeopp.h>
+#include <api/planepolar.h>
+#include <api/planetask.h>
+#include <api/planexfl.h>
+#include <api/polar.h>
+#include <api/resultsink.h>
+#include <api/t8opp.h>
+#include <api/xfoiltask.h>
+
+
+namespace
+{
+    /** Captures the results of each operating point as it is pushed by the task, before the task deletes it */
+    class ValidationSink : public ResultSink
+    {
+        public:
+            ValidationSink(std::vector<ValidationPoint> &points) : m_Points(points) {}
+
+            void addPlaneOpp(PlaneOpp *pPOpp) override
+            {
+                ValidationPoint point;
+                fillOpp3d(*pPOpp, point);
+                for(int iw=0; iw<pPOpp->nWOpps(); iw++)
+                {
+                    std::vector<double> const &Cl = pPOpp->WOpp(iw).spanResults().m_Cl;
+                    point.m_SpanCl.insert(point.m_SpanCl.end(), Cl.begin(), Cl.end());
+                }
+                m_Points.push_back(point);
+            }
+
+            void addBoatOpp(BoatOpp *pBtOpp) override
+            {
+                ValidationPoint point;
+                fillOpp3d(*pBtOpp, point);
+                m_Points.push_back(point);
+            }
+
+            void addOpPoint(OpPoint *pOpp) override
+            {
+                ValidationPoint point;
+                char label[64];
+                snprintf(label, sizeof(label), "a=%.3f", pOpp->aoa());
+                point.m_Label = label;
+                point.m_Coef["Cl"]  = pOpp->m_Cl;
+                point.m_Coef["Cd"]  = pOpp->m_Cd;
+                point.m_Coef["Cdp"] = pOpp->m_Cdp;
+                point.m_Coef["Cm"]  = pOpp->m_Cm;
+                std::vector<float> const &Cp = pOpp->bViscResults() ? pOpp->m_Cpv : pOpp->m_Cpi;
+                point.m_Cp.assign(Cp.begin(), Cp.end());
+                m_Points.push_back(point);
+            }
+
+        private:
+            static void fillOpp3d(Opp3d const &opp, ValidationPoint &point)
+            {
+                char label[128];
+                snprintf(label, sizeof(label), "a=%.3f b=%.3f V=%.3f c=%.3f", opp.alpha(), opp.beta(), opp.QInf(), opp.ctrl());
+                point.m_Label = label;
+                AeroForces const &AF = opp.aeroForces();
+                point.m_Coef["CL"] = AF.CL();
+                point.m_Coef["CD"] = AF.CD();
+                point.m_Coef["CY"] = AF.CSide();
+                point.m_Coef["Cl"] = AF.Cli();
+                point.m_Coef["Cm"] = AF.Cm();
+                point.m_Coef["Cn"] = AF.Cn();
+                point.m_Cp = opp.Cp();
+            }
+
+        private:
+            std::vector<ValidationPoint> &m_Points;
+    };
+
+
+    /** @return the max abs difference of the arrays relative to the max abs value of the reference */
+    double arrayError(std::vector<double> const &values, std::vector<double> const &ref)
+    {
+        double maxref = 0.0, maxdiff = 0.0;
+        for(size_t i=0; i<ref.size(); i++)
+        {
+            maxref  = std::max(maxref, std::abs(ref.at(i)));
+            maxdiff = std::max(maxdiff, std::abs(values.at(i)-ref.at(i)));
+        }
+        return maxdiff/std::max(maxref, 1.e-6);
+    }
+
+
+    QJsonArray toJsonArray(std::vector<double> const &values)
+    {
+        QJsonArray array;
+        for(double v : values) array.append(v);
+        return array;
+    }
+
+
+    std::vector<double> fromJsonArray(QJsonArray const &array)
+    {
+        std::vector<double> values;
+        values.reserve(array.size());
+        for(QJsonValue const &v : array) values.push_back(v.toDouble());
+        return values;
+    }
+}
+
+
+ValidationSuite::ValidationSuite(BenchCases &benchcases) : m_BenchCases(benchcases)
+{
+    m_Tolerance = 1.e-3;
+    m_bProgress = false;
+
+    addPlaneCases();
+    addBoatCase();
+    addXFoilCases();
+}
+
+
+/**
+ * Adds one case for each type of plane polar, made from the reference T1 polar
+ * with operating points which are in the linear range of the reference plane.
+ */
+void ValidationSuite::addPlaneCases()
+{
+    struct PlaneCase
+    {
+        xfl::enumPolarType m_Type;
+        std::string m_Description;
+        std::function<void(PlaneTask &)> m_SetOpps;
+    };
+
+    std::vector<PlaneCase> planecases = {
+        {xfl::T1POLAR, "fixed speed at -2, 3 and 8 degrees",      [](PlaneTask &task) {task.setOppList({-2.0, 3.0, 8.0});}},
+        {xfl::T2POLAR, "fixed lift at 1, 3 and 5 degrees",        [](PlaneTask &task) {task.setOppList({1.0, 3.0, 5.0});}},
+        {xfl::T3POLAR, "glide at 1, 3 and 5 degrees",             [](PlaneTask &task) {task.setOppList({1.0, 3.0, 5.0});}},
+        {xfl::T4POLAR, "fixed aoa at 10, 20 and 30 m/s",          [](PlaneTask &task) {task.setOppList({10.0, 20.0, 30.0});}},
+        {xfl::T5POLAR, "sideslip at -4, 0 and 4 degrees",         [](PlaneTask &task) {task.setOppList({-4.0, 0.0, 4.0});}},
+        {xfl::T6POLAR, "control at 0, 0.5 and 1",                 [](PlaneTask &task) {task.setCtrlOppList({0.0, 0.5, 1.0});}},
+        {xfl::T7POLAR, "stability at control 0",                  [](PlaneTask &task) {task.setStabOppList({0.0});}},
+        {xfl::T8POLAR, "prescribed (aoa, sideslip, speed) pairs", [](PlaneTask &task) {task.setT8OppList({{true, 2.0, 0.0, 20.0}, {true, 4.0, 3.0, 25.0}});}},
+    };
+
+    for(PlaneCase const &pc : planecases)
+    {
+        PlanePolar *pPolar = new PlanePolar;
+        pPolar->duplicateSpec(m_BenchCases.planePolar());
+        pPolar->setType(pc.m_Type);
+        pPolar->setPlaneName(m_BenchCases.plane()->name());
+        pPolar->setName("T" + std::to_string(int(pc.m_Type)+1) + " validation");
+        if(pc.m_Type==xfl::T4POLAR || pc.m_Type==xfl::T5POLAR) pPolar->setAlphaSpec(3.0);
+        Objects3d::insertPlPolar(pPolar);
+
+        Case vc;
+        vc.m_Name = "plane_t" + std::to_string(int(pc.m_Type)+1);
+        vc.m_Description = pc.m_Description;
+        vc.m_Reset = [this]() {m_BenchCases.resetPlane();};
+        std::function<void(PlaneTask &)> setopps = pc.m_SetOpps;
+        vc.m_Run = [this, pPolar, setopps](ResultSink *pSink)
+        {
+            PlaneTask task;
+            task.setObjects(m_BenchCases.plane(), pPolar);
+            task.setComputeDerivatives(false);
+            task.setKeepOpps(false);
+            task.setResultSink(pSink);
+            setopps(task);
+            task.run();
+        };
+        m_Case.push_back(vc);
+    }
+}
+
+
+void ValidationSuite::addBoatCase()
+{
+    Case vc;
+    vc.m_Name = "boat";
+    vc.m_Description = "reference boat polar at control 0 and 1";
+    vc.m_Reset = [this]() {m_BenchCases.boat()->restoreMesh();};
+    vc.m_Run = [this](ResultSink *pSink)
+    {
+        BoatTask task;
+        task.setObjects(m_BenchCases.boat(), m_BenchCases.boatPolar());
+        task.setKeepOpps(false);
+        task.setResultSink(pSink);
+        task.setAnalysisRange({0.0, 1.0});
+        task.initializeTask(nullptr);
+        task.run();
+    };
+    m_Case.push_back(vc);
+}
+
+
+void ValidationSuite::addXFoilCases()
+{
+    for(uint ifoil=0; ifoil<m_BenchCases.foils().size(); ifoil++)
+    {
+        Case vc;
+        vc.m_Name = "xfoil_" + m_BenchCases.foils().at(ifoil)->name();
+        std::replace(vc.m_Name.begin(), vc.m_Name.end(), ' ', '_');
+        vc.m_Description = "T1 polar from -4 to 10 degrees, Re=500,000";
+        vc.m_Run = [this, ifoil](ResultSink *pSink)
+        {
+            XFoilTask task;
+            task.initialize(*m_BenchCases.foils().at(ifoil), m_BenchCases.foilPolars().at(ifoil), false);
+            task.setResultSink(pSink);
+            task.appendRange({true, 0.0, 10.0, 1.0});
+            task.appendRange({true, -1.0, -4.0, 1.0});
+            task.run();
+        };
+        m_Case.push_back(vc);
+    }
+}
+
+
+/** Runs each case once, and compares its results to the baseline if one has been read */
+void ValidationSuite::run()
+{
+    m_Result.clear();
+    for(Case const &vc : m_Case)
+    {
+        if(m_bProgress) fprintf(stderr, "%s\n", vc.m_Name.c_str());
+
+        ValidationResult result;
+        result.m_Name = vc.m_Name;
+        result.m_Description = vc.m_Description;
+
+        if(vc.m_Reset) vc.m_Reset();
+        ValidationSink sink(result.m_Point);
+        auto t0 = std::chrono::steady_clock::now();
+        vc.m_Run(&sink);
+        result.m_Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+
+        compare(result);
+        m_Result.push_back(result);
+    }
+}
+
+
+/** Fills the errors of the result from the baseline's case of the same name, point by point */
+void ValidationSuite::compare(ValidationResult &result) const
+{
+    auto it = m_Baseline.find(result.m_Name);
+    if(it==m_Baseline.end()) return;
+
+    ValidationResult const &base = it->second;
+    result.m_bHasBaseline = true;
+    result.m_BaseSeconds = base.m_Seconds;
+
+    if(result.m_Point.size()!=base.m_Point.size())
+    {
+        result.m_Mismatch = std::to_string(result.m_Point.size()) + " points, " + std::to_string(base.m_Point.size()) + " in the baseline";
+        return;
+    }
+
+    for(size_t ip=0; ip<base.m_Point.size(); ip++)
+    {
+        ValidationPoint const &pt = result.m_Point.at(ip);
+        ValidationPoint const &ref = base.m_Point.at(ip);
+        if(pt.m_Label!=ref.m_Label)
+        {
+            result.m_Mismatch = "point " + pt.m_Label + " does not match " + ref.m_Label;
+            return;
+        }
+        if(pt.m_SpanCl.size()!=ref.m_SpanCl.size() || pt.m_Cp.size()!=ref.m_Cp.size())
+        {
+            result.m_Mismatch = "the array sizes of point " + pt.m_Label + " differ from the baseline's";
+            return;
+        }
+
+        for(auto const &coef : ref.m_Coef)
+        {
+            auto jt = pt.m_Coef.find(coef.first);
+            if(jt==pt.m_Coef.end()) continue;
+            // small coefficients, e.g. the side force of a symmetric case, are compared in absolute terms
+            double err = std::abs(jt->second-coef.second)/std::max(std::abs(coef.second), 1.e-3);
+            result.m_CoefError = std::max(result.m_CoefError, err);
+        }
+        result.m_SpanError = std::max(result.m_SpanError, arrayError(pt.m_SpanCl, ref.m_SpanCl));
+        result.m_CpError   = std::max(result.m_CpError,   arrayError(pt.m_Cp,     ref.m_Cp));
+    }
+}
+
+
+/** @return false if a case has no result, has a baseline it could not be matched to, or exceeds the tolerance */
+bool ValidationSuite::isWithinTolerance() const
+{
+    for(ValidationResult const &result : m_Result)
+    {
+        if(result.m_Point.empty()) return false;
+        if(!result.m_bHasBaseline) continue;
+        if(!result.m_Mismatch.empty()) return false;
+        if(result.m_CoefError>m_Tolerance || result.m_SpanError>m_Tolerance || result.m_CpError>m_Tolerance) return false;
+    }
+    return true;
+}
+
+
+QString ValidationSuite::report() const
+{
+    QString table;
+    char line[512];
+    snprintf(line, sizeof(line), "%-20s %7s %10s %10s %8s %10s %10s %10s  %s\n",
+             "case", "points", "time_s", "base_s", "speedup", "coefs", "span_Cl", "Cp", "status");
+    table += line;
+
+    for(ValidationResult const &result : m_Result)
+    {
+        std::string status;
+        if(result.m_Point.empty())           status = "NO RESULTS";
+        else if(!result.m_bHasBaseline)      status = "no baseline";
+        else if(!result.m_Mismatch.empty())  status = "MISMATCH: " + result.m_Mismatch;
+        else if(result.m_CoefError>m_Tolerance || result.m_SpanError>m_Tolerance || result.m_CpError>m_Tolerance) status = "FAIL";
+        else                                 status = "ok";
+
+        if(result.m_bHasBaseline && result.m_Mismatch.empty() && !result.m_Point.empty())
+        {
+            snprintf(line, sizeof(line), "%-20s %7d %10.4f %10.4f %8.2f %10.2e %10.2e %10.2e  %s\n",
+                     result.m_Name.c_str(), int(result.m_Point.size()), result.m_Seconds, result.m_BaseSeconds,
+                     result.m_BaseSeconds/std::max(result.m_Seconds, 1.e-9),
+                     result.m_CoefError, result.m_SpanError, result.m_CpError, status.c_str());
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "%-20s %7d %10.4f %10s %8s %10s %10s %10s  %s\n",
+                     result.m_Name.c_str(), int(result.m_Point.size()), result.m_Seconds, "-", "-", "-", "-", "-", status.c_str());
+        }
+        table += line;
+    }
+
+    snprintf(line, sizeof(line), "\nThe errors are relative to the baseline's values; the tolerance is %.2e\n", m_Tolerance);
+    table += line;
+    return table;
+}
+
+
+/** Writes the results of the last run as the baseline of the next runs */
+bool ValidationSuite::writeBaseline(QString const &pathname) const
+{
+    QJsonArray cases;
+    for(ValidationResult const &result : m_Result)
+    {
+        QJsonArray points;
+        for(ValidationPoint const &pt : result.m_Point)
+        {
+            QJsonObject coefs;
+            for(auto const &coef : pt.m_Coef) coefs[QString::fromStdString(coef.first)] = coef.second;
+
+            QJsonObject point;
+            point["label"]        = QString::fromStdString(pt.m_Label);
+            point["coefficients"] = coefs;
+            point["span_Cl"]      = toJsonArray(pt.m_SpanCl);
+            point["Cp"]           = toJsonArray(pt.m_Cp);
+            points.append(point);
+        }
+
+        QJsonObject vc;
+        vc["name"]        = QString::fromStdString(result.m_Name);
+        vc["description"] = QString::fromStdString(result.m_Description);
+        vc["time_s"]      = result.m_Seconds;
+        vc["points"]      = points;
+        cases.append(vc);
+    }
+
+    QJsonObject baseline;
+    baseline["program"] = "fl5-bench";
+    baseline["version"] = QString::fromStdString(fl5::versionName(true));
+    baseline["cases"]   = cases;
+
+    QFile XFile(pathname);
+    if(!XFile.open(QIODevice::WriteOnly)) return false;
+    QByteArray json = QJsonDocument(baseline).toJson(QJsonDocument::Compact);
+    bool bWritten = XFile.write(json)==json.size();
+    XFile.close();
+    return bWritten;
+}
+
+
+bool ValidationSuite::readBaseline(QString const &pathname)
+{
+    m_Baseline.clear();
+
+    QFile XFile(pathname);
+    if(!XFile.open(QIODevice::ReadOnly)) return false;
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(XFile.readAll(), &error);
+    XFile.close();
+    if(error.error!=QJsonParseError::NoError || !doc.isObject()) return false;
+
+    QJsonArray cases = doc.object()["cases"].toArray();
+    for(QJsonValue const &vcvalue : cases)
+    {
+        QJsonObject vc = vcvalue.toObject();
+        ValidationResult base;
+        base.m_Name        = vc["name"].toString().toStdString();
+        base.m_Description = vc["description"].toString().toStdString();
+        base.m_Seconds     = vc["time_s"].toDouble();
+
+        for(QJsonValue const &ptvalue : vc["points"].toArray())
+        {
+            QJsonObject point = ptvalue.toObject();
+            ValidationPoint pt;
+            pt.m_Label = point["label"].toString().toStdString();
+            QJsonObject coefs = point["coefficients"].toObject();
+            for(auto it=coefs.begin(); it!=coefs.end(); ++it) pt.m_Coef[it.key().toStdString()] = it.value().toDouble();
+            pt.m_SpanCl = fromJsonArray(point["span_Cl"].toArray());
+            pt.m_Cp     = fromJsonArray(point["Cp"].toArray());
+            base.m_Point.push_back(pt);
+        }
+        m_Baseline[base.m_Name] = base;
+    }
+    return !m_Baseline.empty();
+}
@@ -0,0 +1,116 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <QString>
+
+class BenchCases;
+class ResultSink;
+
+
+/** The results of one operating point which are compared to the baseline */
+struct ValidationPoint
+{
+    std::string m_Label;                      /**< the operating conditions, used to match the baseline's points */
+    std::map<std::string, double> m_Coef;     /**< the force and moment coefficients, by name */
+    std::vector<double> m_SpanCl;             /**< the strip lift coefficients of all the wings, end to end */
+    std::vector<double> m_Cp;                 /**< the panel or node pressure coefficients */
+};
+
+
+/** The results of one reference case and their deviation from the baseline */
+struct ValidationResult
+{
+    std::string m_Name;
+    std::string m_Description;
+    double m_Seconds{0};
+    std::vector<ValidationPoint> m_Point;
+
+    bool m_bHasBaseline{false};
+    double m_BaseSeconds{0};
+    double m_CoefError{0};                    /**< the max error of the coefficients, relative to the baseline's value */
+    double m_SpanError{0};                    /**< the max error of the span distributions, relative to the baseline's max |Cl| */
+    double m_CpError{0};                      /**< the max error of the Cp arrays, relative to the baseline's max |Cp| */
+    std::string m_Mismatch;                   /**< not empty if the points could not be matched to the baseline's */
+};
+
+
+/**
+ * @class ValidationSuite
+ * @brief Runs reference analyses and compares their results to a stored baseline.
+ *
+ * The cases are the plane polars of types 1 to 8, the boat polar and the XFoil polars of the reference objects.
+ * Each operating point is captured from the task's ResultSink when it is computed; the baseline is
+ * a JSON file written by a previous run, so that a change in the solvers can be assessed on both
+ * its accuracy and its runtime.
+ */
+class ValidationSuite
+{
+    private:
+        struct Case
+        {
+            std::string m_Name;
+            std::string m_Description;
+            std::function<void()> m_Reset;                /**< not timed */
+            std::function<void(ResultSink *)> m_Run;
+        };
+
+    public:
+        ValidationSuite(BenchCases &benchcases);
+
+        void setTolerance(double tol) {m_Tolerance=tol;}
+        double tolerance() const {return m_Tolerance;}
+        void setProgress(bool bProgress) {m_bProgress=bProgress;}
+
+        void run();
+        std::vector<ValidationResult> const &results() const {return m_Result;}
+
+        bool readBaseline(QString const &pathname);
+        bool writeBaseline(QString const &pathname) const;
+        bool isWithinTolerance() const;
+
+        QString report() const;
+
+    private:
+        void addPlaneCases();
+        void addBoatCase();
+        void addXFoilCases();
+        void compare(ValidationResult &result) const;
+
+    private:
+        BenchCases &m_BenchCases;
+        std::vector<Case> m_Case;
+        std::vector<ValidationResult> m_Result;
+        std::map<std::string, ValidationResult> m_Baseline;
+
+        double m_Tolerance;
+        bool m_bProgress;
+};
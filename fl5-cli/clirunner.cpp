@@ -0,0 +1,314 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <chrono>
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include "clirunner.h"
+
+#include <interfaces/script/xflscriptexec.h>
+
+#include <api/boat.h>
+#include <api/boatpolar.h>
+#include <api/fileio.h>
+#include <api/fl5core.h>
+#include <api/foil.h>
+#include <api/objects2d.h>
+#include <api/objects3d.h>
+#include <api/plane.h>
+#include <api/planepolar.h>
+#include <api/polar.h>
+#include <api/sailobjects.h>
+#include <api/utils.h>
+
+
+CliRunner::CliRunner()
+{
+    m_pExec = new XflScriptExec;
+    m_bProgress = false;
+    m_bScriptOK = false;
+    m_Seconds = 0.0;
+}
+
+
+CliRunner::~CliRunner()
+{
+    delete m_pExec;
+}
+
+
+bool CliRunner::runScript(QString const &scriptpath)
+{
+    m_ScriptPath = scriptpath;
+    m_pExec->setEventDestination(nullptr);
+    m_pExec->setStdOutStream(m_bProgress);
+
+    if(!QFileInfo::exists(scriptpath))
+    {
+        m_pExec->traceLog("Script file "+scriptpath+" not found... aborting\n");
+        m_bScriptOK = false;
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    m_bScriptOK = m_pExec->runScript(scriptpath);
+    if(m_bScriptOK) exportResults();
+    m_Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+    m_pExec->closeLogFile();
+    return m_bScriptOK;
+}
+
+
+bool CliRunner::hasTaskErrors() const
+{
+    for(TaskRecord const &record : m_pExec->taskRecords())
+    {
+        if(record.m_Status.compare("ok")!=0) return true;
+    }
+    return false;
+}
+
+
+/** Writes the outputs requested by the script, as MainFrame::handleScriptResults() does in the GUI */
+void CliRunner::exportResults()
+{
+    bool bCSV = m_pExec->bCSVOutput();
+
+    if(m_pExec->outputPolarBin())
+        m_pExec->traceLog("The binary foil polar files are not available in fl5-cli... skipping\n");
+
+    if(m_pExec->outputPolarText())
+    {
+        if(exportFoilPolars(m_pExec->foilPolarTextOutputDirPath(), bCSV))
+            m_pExec->traceLog("The foil polars have been exported to text files\n");
+        else
+            m_pExec->traceLog("Error exporting the foil polars to text files\n");
+    }
+
+    if(m_pExec->outputWPolarText())
+    {
+        if(exportPlanePolars(m_pExec->outputDirPath(), bCSV))
+            m_pExec->traceLog("The plane polars have been exported to text files\n");
+        else
+            m_pExec->traceLog("Error exporting the plane polars to text files\n");
+
+        if(exportBoatPolars(m_pExec->outputDirPath(), bCSV))
+            m_pExec->traceLog("The boat polars have been exported to text files\n");
+        else
+            m_pExec->traceLog("Error exporting the boat polars to text files\n");
+    }
+
+    if(m_pExec->outputPOppText())
+        m_pExec->traceLog("The text export of the operating points is not available in fl5-cli... skipping\n");
+
+    if(m_pExec->exportStlMesh())
+        m_pExec->traceLog("The STL export of the meshes is not available in fl5-cli... skipping\n");
+
+    if(m_pExec->exportXdmf())
+    {
+        QString xdmfdirpath = m_pExec->outputDirPath()+QDir::separator()+"XDMF";
+        if(m_pExec->exportOppsToXdmf(xdmfdirpath))
+            m_pExec->traceLog("The operating points have been exported to XDMF files in "+xdmfdirpath+"\n");
+        else
+            m_pExec->traceLog("Error exporting the operating points to XDMF files\n");
+    }
+
+    if(m_pExec->makeProjectFile())
+    {
+        QString filepath = m_pExec->projectFilePathName();
+        if(filepath.endsWith(".xfl")) filepath = filepath.replace(".xfl", ".fl5");
+        if(saveProject(filepath))
+            m_pExec->traceLog("The project "+ filepath+" has been saved\n");
+        else
+            m_pExec->traceLog("Error saving the project "+ filepath+"\n");
+    }
+}
+
+
+bool CliRunner::exportFoilPolars(QString const &pathname, bool bCSV) const
+{
+    for(int l=0; l<Objects2d::nPolars(); l++)
+    {
+        Polar const *pPolar = Objects2d::polarAt(l);
+        Foil const *pFoil  = Objects2d::foil(pPolar->foilName());
+        if(!pFoil) continue;
+
+        QString foildirpath = pathname + QDir::separator() + QString::fromStdString(pFoil->name());
+        QDir foildir(foildirpath);
+        if(!foildir.exists() && !foildir.mkpath(foildirpath)) continue;
+
+        QString filename = QString::fromStdString(pPolar->name()) + (bCSV ? ".csv" : ".txt");
+        QFile XFile(foildir.absolutePath() + QDir::separator() + filename);
+        if(!XFile.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+
+        std::string str;
+        pPolar->exportToString(str, false, bCSV);
+        QTextStream out(&XFile);
+        out << QString::fromStdString(str);
+        XFile.close();
+    }
+    return true;
+}
+
+
+bool CliRunner::exportPlanePolars(QString const &pathname, bool bCSV) const
+{
+    std::string sep = bCSV ? ", " : "  ";
+
+    for(int l=0; l<Objects3d::nPolars(); l++)
+    {
+        PlanePolar const *pWPolar = Objects3d::plPolarAt(l);
+        if(!pWPolar) continue;
+        Plane const *pPlane = Objects3d::planeAt(pWPolar->planeName());
+        if(!pPlane || !pPlane->isXflType()) continue;
+
+        QString planedirpath = pathname + QDir::separator() + QString::fromStdString(pPlane->name());
+        QDir planedir(planedirpath);
+        if(!planedir.exists() && !planedir.mkpath(planedirpath)) return false;
+
+        QString filename = QString::fromStdString(pWPolar->name());
+        filename.replace("/", "_");
+        filename.replace(".", "_");
+        QFile XFile(planedirpath + QDir::separator() + filename + (bCSV ? ".csv" : ".txt"));
+        if(!XFile.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+
+        std::string props;
+        pWPolar->getProperties(props, pPlane);
+        QTextStream out(&XFile);
+        out << QString::fromStdString(props);
+        out << QString::fromStdString(pWPolar->exportToString(sep));
+        XFile.close();
+    }
+    return true;
+}
+
+
+bool CliRunner::exportBoatPolars(QString const &pathname, bool bCSV) const
+{
+    std::string sep = bCSV ? ", " : "  ";
+
+    for(int l=0; l<SailObjects::nBtPolars(); l++)
+    {
+        BoatPolar const *pBtPolar = SailObjects::btPolar(l);
+        if(!pBtPolar) continue;
+
+        QString boatdirpath = pathname + QDir::separator() + QString::fromStdString(pBtPolar->boatName());
+        QDir boatdir(boatdirpath);
+        if(!boatdir.exists() && !boatdir.mkpath(boatdirpath)) return false;
+
+        QString filename = QString::fromStdString(pBtPolar->name());
+        filename.replace("/", "_");
+        filename.replace(".", "_");
+        QFile XFile(boatdirpath + QDir::separator() + filename + (bCSV ? ".csv" : ".txt"));
+        if(!XFile.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+
+        std::string props, data;
+        pBtPolar->getProperties(props, bCSV ? xfl::CSV : xfl::TXT);
+        pBtPolar->getBtPolarData(data, sep);
+        QTextStream out(&XFile);
+        out << QString::fromStdString(props) << QString::fromStdString(data);
+        XFile.close();
+    }
+    return true;
+}
+
+
+/** Saves the project; the file is written to a temporary file which replaces the destination on success */
+bool CliRunner::saveProject(QString const &pathname) const
+{
+    QSaveFile fp(pathname);
+    if(!fp.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream ar(&fp);
+    FileIO saver;
+    if(!saver.serializeProjectFl5(ar, true))
+    {
+        fp.cancelWriting();
+        return false;
+    }
+    return fp.commit();
+}
+
+
+/**
+ * Writes the wall time and the peak memory of the run and of each task as a JSON document,
+ * with the phase timers and the counters of the plane and boat tasks.
+ * The memory values are the process' high-water mark at the end of each task; since the mark only increases,
+ * a task's own footprint is the increase over the previous records when the tasks run in sequence.
+ * @param pathname the path of the report file, or "-" to write the report to the standard output.
+ */
+bool CliRunner::writeReport(QString const &pathname) const
+{
+    QJsonArray tasks;
+    for(TaskRecord const &record : m_pExec->taskRecords())
+    {
+        QJsonObject task;
+        task["type"]              = record.m_Type;
+        task["name"]              = record.m_Name;
+        task["status"]            = record.m_Status;
+        task["wall_time_s"]       = record.m_Seconds;
+        task["peak_memory_bytes"] = double(record.m_PeakMemory);
+        task["threads"]           = record.m_nThreads;
+        if(record.m_Profile.size())
+            task["profile"] = QJsonDocument::fromJson(QByteArray::fromStdString(record.m_Profile)).object();
+        tasks.append(task);
+    }
+
+    QJsonObject report;
+    report["program"]           = "fl5-cli";
+    report["version"]           = QString::fromStdString(fl5::versionName(true));
+    report["script"]            = m_ScriptPath;
+    report["status"]            = !m_bScriptOK ? "failed" : (hasTaskErrors() ? "errors" : "ok");
+    report["wall_time_s"]       = m_Seconds;
+    report["peak_memory_bytes"] = double(xfl::peakMemoryUsage());
+    report["tasks"]             = tasks;
+
+    QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    QFile XFile;
+    bool bOpen = false;
+    if(pathname=="-") bOpen = XFile.open(stdout, QIODevice::WriteOnly);
+    else
+    {
+        XFile.setFileName(pathname);
+        bOpen = XFile.open(QIODevice::WriteOnly);
+    }
+    if(!bOpen) return false;
+
+    bool bWritten = XFile.write(json)==json.size();
+    XFile.close();
+    return bWritten;
+}
+
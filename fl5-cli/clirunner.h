@@ -0,0 +1,66 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <QString>
+
+class XflScriptExec;
+
+/**
+ * @class CliRunner
+ * @brief Runs an XML script without the GUI and writes the results which the GUI would export.
+ *
+ * The outputs which depend on the GUI modules, i.e. the binary .plr files, the text files of the
+ * operating points and the STL meshes, are not available and are reported as skipped in the log.
+ */
+class CliRunner
+{
+    public:
+        CliRunner();
+        ~CliRunner();
+
+        void setProgress(bool bProgress) {m_bProgress=bProgress;}
+
+        bool runScript(QString const &scriptpath);
+        bool writeReport(QString const &pathname) const;
+
+        bool hasTaskErrors() const;
+
+    private:
+        void exportResults();
+        bool exportFoilPolars(QString const &pathname, bool bCSV) const;
+        bool exportPlanePolars(QString const &pathname, bool bCSV) const;
+        bool exportBoatPolars(QString const &pathname, bool bCSV) const;
+        bool saveProject(QString const &pathname) const;
+
+    private:
+        XflScriptExec *m_pExec;
+        QString m_ScriptPath;
+        bool m_bProgress;
+        bool m_bScriptOK;
+        double m_Seconds;   /**< the wall time of the script */
+};
+
@@ -0,0 +1,134 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+/** @file
+ *
+ * The headless command-line runner of flow5's XML scripts.
+ *
+ * Usage:
+ * fl5-cli script.xml                 : runs the script
+ * fl5-cli -s script.xml -p           : runs the script and shows the progress on the standard output
+ * fl5-cli script.xml -r report.json  : also writes the timing and memory report; use "-" for the standard output,
+ *                                      which cannot be combined with -p
+ * fl5-cli -w                         : runs as a worker process of a distributed batch analysis
+ * fl5-cli --serve [--cache-size n]   : runs as a resident analysis service on the standard channels
+ *
+ * Exit codes: 0 if the script and all its tasks succeeded, 1 if the script or any task failed, 2 on a usage error.
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+
+#include "clirunner.h"
+
+#include <interfaces/script/xflworker.h>
+
+#include <api/fl5core.h>
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("fl5-cli");
+    QCoreApplication::setApplicationVersion(QString::fromStdString(fl5::versionName(true)));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs a flow5 XML script without the graphical interface.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("script", "The XML script file to run.", "[script]");
+
+    QCommandLineOption ScriptOption(QStringList() << "s" << "script");
+    ScriptOption.setValueName("file");
+    ScriptOption.setDescription("Runs the script file.");
+    parser.addOption(ScriptOption);
+
+    QCommandLineOption ShowProgressOption(QStringList() << "p" << "progress");
+    ShowProgressOption.setDescription("Shows the progress on the standard output during script execution.");
+    parser.addOption(ShowProgressOption);
+
+    QCommandLineOption ReportOption(QStringList() << "r" << "report");
+    ReportOption.setValueName("file");
+    ReportOption.setDescription("Writes the wall time and peak memory of the run and of each task as JSON to the file, "
+                                "or to the standard output if the file is \"-\".");
+    parser.addOption(ReportOption);
+
+    QCommandLineOption WorkerOption(QStringList() << "w" << "worker");
+    WorkerOption.setDescription("Runs as a worker process of a distributed batch analysis; "
+                                "the request is read on the standard input and the results are written on the standard output.");
+    parser.addOption(WorkerOption);
+
+    QCommandLineOption ServiceOption(QStringList() << "serve");
+    ServiceOption.setDescription("Runs as a resident analysis service; the framed requests are read on the standard input "
+                                 "and the responses are written on the standard output until the input is closed.");
+    parser.addOption(ServiceOption);
+
+    QCommandLineOption CacheSizeOption(QStringList() << "cache-size");
+    CacheSizeOption.setValueName("n");
+    CacheSizeOption.setDescription("The number of planes kept built by the service; default is 8.");
+    CacheSizeOption.setDefaultValue("8");
+    parser.addOption(CacheSizeOption);
+
+    parser.process(app);
+
+    if(parser.isSet(WorkerOption))  return XflWorker::runWorker();
+    if(parser.isSet(ServiceOption)) return XflWorker::runService(parser.value(CacheSizeOption).toInt());
+
+    QString scriptpath = parser.value(ScriptOption);
+    if(scriptpath.isEmpty() && !parser.positionalArguments().isEmpty())
+        scriptpath = parser.positionalArguments().first();
+
+    if(scriptpath.isEmpty())
+    {
+        QTextStream err(stderr);
+        err << "No script file specified\n\n" << parser.helpText();
+        return 2;
+    }
+
+    if(parser.isSet(ShowProgressOption) && parser.isSet(ReportOption) && parser.value(ReportOption)=="-")
+    {
+        QTextStream err(stderr);
+        err << "The report cannot be written to the standard output while the progress is shown on it\n";
+        return 2;
+    }
+
+    CliRunner runner;
+    runner.setProgress(parser.isSet(ShowProgressOption));
+    bool bOK = runner.runScript(scriptpath);
+
+    if(parser.isSet(ReportOption))
+    {
+        if(!runner.writeReport(parser.value(ReportOption)))
+        {
+            QTextStream err(stderr);
+            err << "Could not write the report to " << parser.value(ReportOption) << "\n";
+            bOK = false;
+        }
+    }
+
+    return (bOK && !runner.hasTaskErrors()) ? 0 : 1;
+}
+
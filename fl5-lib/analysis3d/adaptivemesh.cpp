@@ -0,0 +1,397 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <cmath>
+#include <mutex>
+#include <numeric>
+
+#include <adaptivemesh.h>
+
+#include <constants.h>
+#include <planeopp.h>
+#include <planepolar.h>
+#include <planetask.h>
+#include <planexfl.h>
+#include <resultsink.h>
+#include <surface.h>
+#include <t8opp.h>
+#include <wingxfl.h>
+
+
+/** The factor applied to the indicator of the skinny and low-angle panels */
+#define ADAPT_QUALITYPENALTY 1.5
+
+/** The fraction of the chord from the leading edge in which the error is considered to be a leading edge error */
+#define ADAPT_LEREGION 0.25
+
+
+namespace
+{
+    class SolutionSink : public ResultSink
+    {
+        public:
+            void addPlaneOpp(PlaneOpp *pPOpp) override
+            {
+                if(!pPOpp) return;
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_bValid = true;
+                m_CL = pPOpp->aeroForces().CL();
+                m_CD = pPOpp->aeroForces().CD();
+                m_Cm = pPOpp->aeroForces().Cm();
+                m_Cp = pPOpp->Cp();
+                m_Mu = pPOpp->gamma();
+            }
+
+            bool m_bValid{false};
+            double m_CL{0}, m_CD{0}, m_Cm{0};
+            std::vector<double> m_Cp, m_Mu;
+
+        private:
+            std::mutex m_Mutex;
+    };
+
+
+    /** @return the relative change from v0 to v1, relative to the reference value below which the change is absolute */
+    double relativeChange(double v0, double v1, double ref)
+    {
+        return fabs(v1-v0)/std::max(fabs(v1), ref);
+    }
+}
+
+
+AdaptiveMesh::AdaptiveMesh()
+{
+    m_pPlane = nullptr;
+    m_pPolar = nullptr;
+    m_Alpha = 2.0;
+    m_Beta = 0.0;
+
+    m_Tolerance = 0.005;
+    m_MaxIter = 5;
+    m_MaxPanels = 20000;
+    m_Fraction = 0.15;
+    m_MinAngle = 10.0;
+
+    m_bConverged = false;
+}
+
+
+/**
+ * Runs the refinement loop.
+ * @return true if the coefficients have converged within the max. number of iterations and panels.
+ */
+bool AdaptiveMesh::run()
+{
+    m_History.clear();
+    m_Log.clear();
+    m_bConverged = false;
+
+    if(!m_pPlane || !m_pPolar)
+    {
+        m_Log = "No plane or polar defined\n";
+        return false;
+    }
+    if(!m_pPolar->isTriangleMethod())
+    {
+        m_Log = "The adaptive refinement requires a triangular panel method\n";
+        return false;
+    }
+
+    std::vector<double> guess;
+    Solution solution;
+    for(int it=0; it<m_MaxIter; it++)
+    {
+        if(!solve(guess, solution))
+        {
+            m_Log += "Iteration " + std::to_string(it+1) + ": the analysis failed\n";
+            return false;
+        }
+
+        Step step;
+        step.m_nPanels = m_pPlane->refTriMesh().nPanels();
+        step.m_CL = solution.m_CL;
+        step.m_CD = solution.m_CD;
+        step.m_Cm = solution.m_Cm;
+        if(m_History.size())
+        {
+            Step const &last = m_History.back();
+            step.m_Change = std::max({relativeChange(last.m_CL, step.m_CL, 1.e-3),
+                                      relativeChange(last.m_CD, step.m_CD, 1.e-4),
+                                      relativeChange(last.m_Cm, step.m_Cm, 1.e-3)});
+        }
+        m_History.push_back(step);
+
+        char line[128];
+        snprintf(line, sizeof(line), "Iteration %2d: %6d panels  CL=%9.5f  CD=%9.6f  Cm=%9.5f  change=%g\n",
+                 it+1, step.m_nPanels, step.m_CL, step.m_CD, step.m_Cm, step.m_Change);
+        m_Log += line;
+
+        if(m_History.size()>1 && step.m_Change<m_Tolerance)
+        {
+            m_bConverged = true;
+            break;
+        }
+        if(it==m_MaxIter-1) break;
+        if(step.m_nPanels>=m_MaxPanels)
+        {
+            m_Log += "The max. number of panels has been reached\n";
+            break;
+        }
+
+        std::vector<double> eta;
+        makeIndicator(solution, eta);
+        m_History.back().m_nRefined = refineMesh(eta, solution, guess);
+        if(m_History.back().m_nRefined==0)
+        {
+            m_Log += "No panel to refine\n";
+            break;
+        }
+    }
+
+    return m_bConverged;
+}
+
+
+/** Solves the operating point on the plane's current mesh, with a T8 copy of the polar */
+bool AdaptiveMesh::solve(std::vector<double> const &initialguess, Solution &solution)
+{
+    PlanePolar polar;
+    polar.duplicateSpec(m_pPolar);
+    polar.setType(xfl::T8POLAR);
+    polar.clearWPolarData();
+
+    double QInf = m_pPolar->velocity();
+    if(QInf<PRECISION) QInf = 1.0;
+
+    SolutionSink sink;
+    PlaneTask task;
+    task.setKeepOpps(false);
+    task.setComputeDerivatives(false);
+    task.setResultSink(&sink);
+    task.setInitialGuess(initialguess);
+    task.setObjects(m_pPlane, &polar);
+    task.setT8OppList({T8Opp(true, m_Alpha, m_Beta, QInf)});
+    task.run();
+
+    int N3 = 3*m_pPlane->refTriMesh().nPanels();
+    solution.m_bValid = sink.m_bValid && int(sink.m_Cp.size())==N3 && int(sink.m_Mu.size())==N3;
+    solution.m_CL = sink.m_CL;
+    solution.m_CD = sink.m_CD;
+    solution.m_Cm = sink.m_Cm;
+    solution.m_Cp = std::move(sink.m_Cp);
+    solution.m_Mu = std::move(sink.m_Mu);
+    return solution.m_bValid;
+}
+
+
+/**
+ * Makes the error indicator of each panel from the variations of the Cp and of the doublet density
+ * within the panel and with its neighbours, each scaled by its max. over the mesh.
+ * The connections are those made by the last analysis.
+ */
+void AdaptiveMesh::makeIndicator(Solution const &solution, std::vector<double> &eta) const
+{
+    TriMesh &mesh = m_pPlane->refTriMesh();
+    int N = mesh.nPanels();
+
+    auto mean = [](std::vector<double> const &v, int i3) {return (v[3*i3]+v[3*i3+1]+v[3*i3+2])/3.0;};
+    std::vector<double> dCp(N, 0.0), dMu(N, 0.0);
+    for(int i3=0; i3<N; i3++)
+    {
+        double const *cp = solution.m_Cp.data() + 3*i3;
+        double const *mu = solution.m_Mu.data() + 3*i3;
+        dCp[i3] = *std::max_element(cp, cp+3) - *std::min_element(cp, cp+3);
+        dMu[i3] = *std::max_element(mu, mu+3) - *std::min_element(mu, mu+3);
+
+        Panel3 const &p3 = mesh.panelAt(i3);
+        for(int k=0; k<3; k++)
+        {
+            int j3 = p3.neighbour(k);
+            if(j3<0 || j3>=N) continue;
+            dCp[i3] = std::max(dCp[i3], fabs(mean(solution.m_Cp, i3)-mean(solution.m_Cp, j3)));
+            dMu[i3] = std::max(dMu[i3], fabs(mean(solution.m_Mu, i3)-mean(solution.m_Mu, j3)));
+        }
+    }
+
+    double maxCp = N>0 ? *std::max_element(dCp.begin(), dCp.end()) : 0.0;
+    double maxMu = N>0 ? *std::max_element(dMu.begin(), dMu.end()) : 0.0;
+    eta.resize(N);
+    for(int i3=0; i3<N; i3++)
+    {
+        eta[i3]  = maxCp>0.0 ? 0.5*dCp[i3]/maxCp : 0.0;
+        eta[i3] += maxMu>0.0 ? 0.5*dMu[i3]/maxMu : 0.0;
+    }
+
+    // the poorly shaped panels degrade the solution around them
+    std::string log;
+    std::vector<int> skinnylist, minanglelist, minarealist, minsizelist;
+    mesh.checkPanels(log, false, true, false, false, skinnylist, minanglelist, minarealist, minsizelist, 0.0, m_MinAngle, 0.0, 0.0);
+    for(int i3=0; i3<N; i3++)
+        if(mesh.panelAt(i3).isSkinny()) skinnylist.push_back(i3);
+    for(std::vector<int> const *plist : {&skinnylist, &minanglelist})
+        for(int i3 : *plist) if(i3>=0 && i3<N) eta[i3] *= ADAPT_QUALITYPENALTY;
+}
+
+
+/**
+ * Refines the mesh where the indicator is the largest.
+ * @param initialguess the doublet densities interpolated on the new mesh; empty if the mesh has been rebuilt
+ * @return the number of refined panels, or the number of refined sections for an xfl-type plane
+ */
+int AdaptiveMesh::refineMesh(std::vector<double> const &eta, Solution const &solution, std::vector<double> &initialguess)
+{
+    initialguess.clear();
+
+    if(m_pPlane->isXflType())
+    {
+        PlaneXfl *pPlaneXfl = dynamic_cast<PlaneXfl*>(m_pPlane);
+        if(!pPlaneXfl) return 0;
+        return refineSections(pPlaneXfl, eta);
+    }
+
+    TriMesh &mesh = m_pPlane->refTriMesh();
+    int N = mesh.nPanels();
+
+    // each split adds three panels at most
+    int nRefine = int(ceil(m_Fraction*double(N)));
+    nRefine = std::min(nRefine, std::max(0, (m_MaxPanels-N)/3));
+    if(nRefine<=0) return 0;
+
+    std::vector<int> order(N);
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(order.begin(), order.begin()+nRefine, order.end(), [&eta](int a, int b){return eta[a]>eta[b];});
+
+    std::vector<bool> bRefine(N, false);
+    for(int i=0; i<nRefine; i++) bRefine[order[i]] = true;
+
+    std::vector<int> parent;
+    std::vector<double> weights;
+    int nSplit = mesh.refinePanels(bRefine, parent, weights, m_Log);
+    m_pPlane->restoreMesh();
+
+    // the vertex values of the children are interpolated in their parent
+    initialguess.resize(3*parent.size());
+    for(int c=0; c<int(parent.size()); c++)
+    {
+        double const *mu = solution.m_Mu.data() + 3*parent[c];
+        for(int k=0; k<3; k++)
+        {
+            double const *w = weights.data() + 9*c + 3*k;
+            initialguess[3*c+k] = w[0]*mu[0] + w[1]*mu[1] + w[2]*mu[2];
+        }
+    }
+
+    return nSplit;
+}
+
+
+/**
+ * Increases the spanwise panel count of the sections of the xfl wings which hold the largest mean indicators,
+ * and the chordwise panel count of the wings whose error is concentrated near the leading edge, then rebuilds the mesh.
+ * @return the number of refined sections
+ */
+int AdaptiveMesh::refineSections(PlaneXfl *pPlaneXfl, std::vector<double> const &eta)
+{
+    struct SectionScore
+    {
+        int m_iWing, m_iSection;
+        double m_Score;
+    };
+    std::vector<SectionScore> scores;
+    std::vector<double> leShare(pPlaneXfl->nWings(), 0.0);
+    int N = int(eta.size());
+
+    for(int iw=0; iw<pPlaneXfl->nWings(); iw++)
+    {
+        WingXfl const *pWing = pPlaneXfl->wingAt(iw);
+        std::vector<double> sectionScore(pWing->nSections(), 0.0);
+        double total=0.0, leading=0.0;
+
+        for(int isurf=0; isurf<pWing->nSurfaces(); isurf++)
+        {
+            Surface const &surf = pWing->surfaceAt(isurf);
+            std::vector<int> const &list = surf.panel3list();
+            if(list.empty()) continue;
+
+            double sum = 0.0;
+            for(int i3 : list)
+            {
+                if(i3<0 || i3>=N) continue;
+                sum += eta[i3];
+
+                // the position of the panel along the local chord
+                Vector3d const &C = m_pPlane->refTriMesh().panelAt(i3).CoG();
+                Vector3d span = surf.LB()-surf.LA();
+                double tau = span.dot(span)>0.0 ? std::min(std::max((C-surf.LA()).dot(span)/span.dot(span), 0.0), 1.0) : 0.0;
+                Vector3d L = surf.LA() + span*tau;
+                Vector3d T = surf.TA() + (surf.TB()-surf.TA())*tau;
+                Vector3d chord = T-L;
+                double xrel = chord.dot(chord)>0.0 ? (C-L).dot(chord)/chord.dot(chord) : 0.0;
+                total += eta[i3];
+                if(xrel<ADAPT_LEREGION) leading += eta[i3];
+            }
+            int is = surf.innerSection();
+            if(is>=0 && is<int(sectionScore.size()))
+                sectionScore[is] = std::max(sectionScore[is], sum/double(list.size()));
+        }
+
+        for(int is=0; is<pWing->nSections()-1; is++)
+            scores.push_back({iw, is, sectionScore.at(is)});
+        leShare[iw] = total>0.0 ? leading/total : 0.0;
+    }
+
+    if(scores.empty()) return 0;
+
+    int nRefine = std::max(1, int(ceil(m_Fraction*double(scores.size()))));
+    nRefine = std::min(nRefine, int(scores.size()));
+    std::partial_sort(scores.begin(), scores.begin()+nRefine, scores.end(),
+                      [](SectionScore const &a, SectionScore const &b){return a.m_Score>b.m_Score;});
+
+    std::vector<bool> bChordwise(pPlaneXfl->nWings(), false);
+    for(int i=0; i<nRefine; i++)
+    {
+        SectionScore const &sc = scores.at(i);
+        WingXfl *pWing = pPlaneXfl->wing(sc.m_iWing);
+        int ny = pWing->nYPanels(sc.m_iSection);
+        pWing->setNYPanels(sc.m_iSection, std::max(ny+1, int(ceil(1.5*ny))));
+        if(leShare.at(sc.m_iWing)>0.5) bChordwise[sc.m_iWing] = true;
+    }
+
+    // the chordwise count is the same for all the sections of a wing
+    for(int iw=0; iw<pPlaneXfl->nWings(); iw++)
+    {
+        if(!bChordwise.at(iw)) continue;
+        WingXfl *pWing = pPlaneXfl->wing(iw);
+        for(int is=0; is<pWing->nSections(); is++)
+        {
+            int nx = pWing->nXPanels(is);
+            pWing->setNXPanels(is, std::max(nx+1, int(ceil(1.5*nx))));
+        }
+        m_Log += "Increased the chordwise panel count of " + pWing->name() + "\n";
+    }
+
+    pPlaneXfl->makePlane(m_pPolar->bThickSurfaces(), true, true);
+    m_Log += "Refined " + std::to_string(nRefine) + " sections: " + std::to_string(pPlaneXfl->refTriMesh().nPanels()) + " panels\n";
+    return nRefine;
+}
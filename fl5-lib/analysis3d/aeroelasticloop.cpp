@@ -0,0 +1,441 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <cmath>
+#include <mutex>
+
+#include <aeroelasticloop.h>
+
+#include <constants.h>
+#include <node.h>
+#include <panelanalysis.h>
+#include <planeopp.h>
+#include <planepolar.h>
+#include <planetask.h>
+#include <planexfl.h>
+#include <resultsink.h>
+#include <spandistribs.h>
+#include <t8opp.h>
+#include <wingxfl.h>
+
+
+namespace
+{
+    class CouplingSink : public ResultSink
+    {
+        public:
+            void addPlaneOpp(PlaneOpp *pPOpp) override
+            {
+                if(!pPOpp) return;
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_bValid = true;
+                m_CL = pPOpp->aeroForces().CL();
+                m_CD = pPOpp->aeroForces().CD();
+                m_Cm = pPOpp->aeroForces().Cm();
+                m_Span.clear();
+                for(int iw=0; iw<pPOpp->nWOpps(); iw++) m_Span.push_back(pPOpp->WOpp(iw).spanResults());
+            }
+
+            bool m_bValid{false};
+            double m_CL{0}, m_CD{0}, m_Cm{0};
+            std::vector<SpanDistribs> m_Span;
+
+        private:
+            std::mutex m_Mutex;
+    };
+}
+
+
+AeroelasticLoop::AeroelasticLoop()
+{
+    m_pPlaneXfl = nullptr;
+    m_pPolar = nullptr;
+    m_Alpha = 2.0;
+    m_Beta = 0.0;
+    m_QInf = 0.0;
+
+    m_Tolerance = 1.0e-3;
+    m_MaxIter = 15;
+    m_Relaxation = 0.8;
+
+    m_bConverged = false;
+    m_bHasRigidMesh = false;
+}
+
+
+void AeroelasticLoop::setBeam(int iWing, Beam const &beam)
+{
+    if(iWing<0) return;
+    if(int(m_Beam.size())<=iWing) m_Beam.resize(iWing+1);
+    m_Beam[iWing] = beam;
+}
+
+
+/**
+ * Runs the coupling loop, starting from the rigid geometry.
+ * @return true if the deflections have converged within the max. number of iterations.
+ */
+bool AeroelasticLoop::run()
+{
+    m_History.clear();
+    m_Log.clear();
+    m_bConverged = false;
+
+    if(!m_pPlaneXfl || !m_pPolar)
+    {
+        m_Log = "No plane or polar defined\n";
+        return false;
+    }
+    if(!m_pPolar->isPanelMethod())
+    {
+        m_Log = "The aeroelastic loop requires a panel method\n";
+        return false;
+    }
+
+    double QInf = m_QInf>PRECISION ? m_QInf : m_pPolar->velocity();
+    if(QInf<PRECISION) QInf = 1.0;
+    double q = 0.5*m_pPolar->density()*QInf*QInf;
+
+    if(m_bHasRigidMesh) restoreRigidMesh();
+    m_RigidTriMesh  = m_pPlaneXfl->refTriMesh();
+    m_RigidQuadMesh = m_pPlaneXfl->refQuadMesh();
+    m_bHasRigidMesh = true;
+
+    PlanePolar polar;
+    polar.duplicateSpec(m_pPolar);
+    polar.setType(xfl::T8POLAR);
+    polar.clearWPolarData();
+
+    int nWings = m_pPlaneXfl->nWings();
+    std::vector<Shape> shapes(nWings);
+
+    // the task which holds the reference factorization; the other one solves the deformed geometry
+    PlaneTask task[2];
+    int iRef = -1;
+
+    for(int it=0; it<m_MaxIter; it++)
+    {
+        int iTask = iRef==0 ? 1 : 0;
+        PlaneTask &t = task[iTask];
+        CouplingSink sink;
+        t.setKeepOpps(false);
+        t.setComputeDerivatives(false);
+        t.setResultSink(&sink);
+        t.setReferenceAnalysis(iRef>=0 ? task[iRef].panelAnalysis() : nullptr);
+        t.setObjects(m_pPlaneXfl, &polar);
+        t.setT8OppList({T8Opp(true, m_Alpha, m_Beta, QInf)});
+        t.run();
+
+        if(!sink.m_bValid || int(sink.m_Span.size())<nWings)
+        {
+            m_Log += "Iteration " + std::to_string(it+1) + ": the analysis failed\n";
+            return false;
+        }
+
+        Step step;
+        step.m_CL = sink.m_CL;
+        step.m_CD = sink.m_CD;
+        step.m_Cm = sink.m_Cm;
+        step.m_bReusedLU = iRef>=0 && t.panelAnalysis() && t.panelAnalysis()->hasFrozenFactorization();
+        if(!step.m_bReusedLU) iRef = iTask;
+
+        if(it==0)
+        {
+            bool bFlexible = false;
+            for(int iw=0; iw<nWings; iw++)
+            {
+                makeShape(iw, sink.m_Span.at(iw), shapes[iw]);
+                bFlexible = bFlexible || shapes.at(iw).m_bFlexible;
+            }
+            if(!bFlexible)
+            {
+                m_Log += "No flexible wing\n";
+                m_History.push_back(step);
+                m_bConverged = true;
+                return true;
+            }
+        }
+
+        double change = 0.0;
+        for(int iw=0; iw<nWings; iw++)
+        {
+            if(!shapes.at(iw).m_bFlexible) continue;
+            solveBeam(iw, sink.m_Span.at(iw), q, shapes[iw], change);
+            for(int side=0; side<2; side++)
+            {
+                std::vector<Station> const &st = shapes.at(iw).m_Station[side];
+                if(st.size() && fabs(st.back().m_w)>fabs(step.m_TipDeflection))
+                {
+                    step.m_TipDeflection = st.back().m_w;
+                    step.m_TipTwist = st.back().m_Theta*180.0/PI;
+                }
+            }
+        }
+        step.m_Change = change;
+        m_History.push_back(step);
+
+        char line[160];
+        snprintf(line, sizeof(line), "Iteration %2d: CL=%9.5f  CD=%9.6f  Cm=%9.5f  tip deflection=%9.5f m  tip twist=%7.3f°  change=%g%s\n",
+                 it+1, step.m_CL, step.m_CD, step.m_Cm, step.m_TipDeflection, step.m_TipTwist, step.m_Change,
+                 step.m_bReusedLU ? "  (previous LU factors)" : "");
+        m_Log += line;
+
+        if(it>0 && change<m_Tolerance)
+        {
+            m_bConverged = true;
+            break;
+        }
+        if(it==m_MaxIter-1) break;
+
+        deformMesh(shapes);
+    }
+
+    return m_bConverged;
+}
+
+
+/** Restores the reference meshes of the plane as they were before the last run */
+void AeroelasticLoop::restoreRigidMesh()
+{
+    if(!m_pPlaneXfl || !m_bHasRigidMesh) return;
+    m_pPlaneXfl->refTriMesh()  = m_RigidTriMesh;
+    m_pPlaneXfl->refQuadMesh() = m_RigidQuadMesh;
+    m_pPlaneXfl->restoreMesh();
+}
+
+
+/**
+ * Makes the stations of each half-wing from the strips of the rigid solution.
+ * The elastic axis passes through the quarter-chord point of each strip shifted along the chord.
+ * @return false if the wing is rigid.
+ */
+bool AeroelasticLoop::makeShape(int iw, SpanDistribs const &span, Shape &shape) const
+{
+    WingXfl const *pWing = m_pPlaneXfl->wingAt(iw);
+    Beam beam = iw<int(m_Beam.size()) ? m_Beam.at(iw) : Beam();
+
+    shape = Shape();
+    shape.m_bFlexible = !pWing->isFin() && (beam.m_EI>0.0 || beam.m_GJ>0.0);
+    if(!shape.m_bFlexible) return false;
+
+    shape.m_yRoot = pWing->position().y;
+    shape.m_HalfSpan = pWing->isTwoSided() ? pWing->planformSpan()/2.0 : pWing->planformSpan();
+
+    int nStrips = int(std::min({span.m_StripPos.size(), span.m_PtC4.size(), span.m_Chord.size()}));
+    for(int m=0; m<nStrips; m++)
+    {
+        int side = span.m_PtC4.at(m).y>=shape.m_yRoot ? 0 : 1;
+        shape.m_Strip[side].push_back(m);
+    }
+
+    for(int side=0; side<2; side++)
+    {
+        std::vector<int> &strips = shape.m_Strip[side];
+        std::sort(strips.begin(), strips.end(), [&span](int m0, int m1) {return fabs(span.m_StripPos.at(m0))<fabs(span.m_StripPos.at(m1));});
+        for(int m : strips)
+        {
+            Station st;
+            st.m_s = fabs(span.m_StripPos.at(m));
+            st.m_d = fabs(span.m_PtC4.at(m).y-shape.m_yRoot);
+            st.m_xEA = span.m_PtC4.at(m).x + (beam.m_xEA-0.25)*span.m_Chord.at(m);
+            st.m_zEA = span.m_PtC4.at(m).z;
+            shape.m_Station[side].push_back(st);
+        }
+    }
+
+    shape.m_bFlexible = shape.m_Station[0].size() || shape.m_Station[1].size();
+    return shape.m_bFlexible;
+}
+
+
+/**
+ * Integrates the beam equations of each half-wing, clamped at the root, with the strip loads as point loads:
+ * w'' = M/EI and theta' = T/GJ, where M is the bending moment of the outboard lift and T the torque of the outboard
+ * lift and pitching moments about the elastic axis.
+ * The new deflection is relaxed; the change is the max. difference between the beam solution and the current shape.
+ */
+void AeroelasticLoop::solveBeam(int iw, SpanDistribs const &span, double q, Shape &shape, double &change) const
+{
+    Beam beam = iw<int(m_Beam.size()) ? m_Beam.at(iw) : Beam();
+    double L = std::max(shape.m_HalfSpan, PRECISION);
+    auto stiffness = [&beam, L](double root, double s) {return root*(1.0+(beam.m_TipRatio-1.0)*std::min(s/L, 1.0));};
+
+    for(int side=0; side<2; side++)
+    {
+        std::vector<Station> &st = shape.m_Station[side];
+        std::vector<int> const &strips = shape.m_Strip[side];
+        int n = int(st.size());
+        if(n==0) continue;
+
+        std::vector<double> lift(n), torque(n);
+        for(int k=0; k<n; k++)
+        {
+            int m = strips.at(k);
+            double area = span.m_StripArea.at(m);
+            lift[k]   = span.m_Cl.at(m)*area*q;
+            torque[k] = lift.at(k)*(st.at(k).m_xEA-span.m_PtC4.at(m).x) + span.m_CmC4.at(m)*q*area*span.m_Chord.at(m);
+        }
+
+        // the grid is the root followed by the stations
+        std::vector<double> g(n+1, 0.0), M(n+1, 0.0);
+        for(int k=0; k<n; k++) g[k+1] = st.at(k).m_s;
+        for(int i=0; i<=n; i++)
+        {
+            for(int k=0; k<n; k++)
+            {
+                if(st.at(k).m_s>g.at(i)) M[i] += lift.at(k)*(st.at(k).m_s-g.at(i));
+            }
+        }
+
+        double slope = 0.0, w = 0.0, theta = 0.0, Toutboard = 0.0;
+        for(int k=0; k<n; k++) Toutboard += torque.at(k);
+
+        double kappa0 = beam.m_EI>0.0 ? M.at(0)/stiffness(beam.m_EI, 0.0) : 0.0;
+        for(int i=0; i<n; i++)
+        {
+            double ds = g.at(i+1)-g.at(i);
+            double kappa1 = beam.m_EI>0.0 ? M.at(i+1)/stiffness(beam.m_EI, g.at(i+1)) : 0.0;
+            double slope1 = slope + 0.5*(kappa0+kappa1)*ds;
+            w += 0.5*(slope+slope1)*ds;
+            slope = slope1;
+            kappa0 = kappa1;
+
+            // the segment carries the torque of the stations outboard of its inner end
+            if(beam.m_GJ>0.0) theta += Toutboard*ds/stiffness(beam.m_GJ, 0.5*(g.at(i)+g.at(i+1)));
+            Toutboard -= torque.at(i);
+
+            Station &s = st[i];
+            change = std::max({change, fabs(w-s.m_w)/L, fabs(theta-s.m_Theta)});
+            s.m_w     += m_Relaxation*(w-s.m_w);
+            s.m_Theta += m_Relaxation*(theta-s.m_Theta);
+        }
+    }
+}
+
+
+/** @return the position of the point P of the rigid wing in the deformed shape */
+Vector3d AeroelasticLoop::deformedPoint(Shape const &shape, Vector3d const &P) const
+{
+    int side = P.y>=shape.m_yRoot ? 0 : 1;
+    if(shape.m_Station[side].empty()) side = 1-side;
+    std::vector<Station> const &st = shape.m_Station[side];
+    if(st.empty()) return P;
+
+    double d = fabs(P.y-shape.m_yRoot);
+    double w=0, theta=0, xEA=0, zEA=0;
+    if(d<=st.front().m_d)
+    {
+        // zero deflection at the root
+        double t = st.front().m_d>PRECISION ? d/st.front().m_d : 1.0;
+        w     = t*st.front().m_w;
+        theta = t*st.front().m_Theta;
+        xEA   = st.front().m_xEA;
+        zEA   = st.front().m_zEA;
+    }
+    else if(d>=st.back().m_d)
+    {
+        w     = st.back().m_w;
+        theta = st.back().m_Theta;
+        xEA   = st.back().m_xEA;
+        zEA   = st.back().m_zEA;
+    }
+    else
+    {
+        int i = 0;
+        while(i<int(st.size())-2 && st.at(i+1).m_d<d) i++;
+        Station const &s0 = st.at(i);
+        Station const &s1 = st.at(i+1);
+        double t = s1.m_d-s0.m_d>PRECISION ? (d-s0.m_d)/(s1.m_d-s0.m_d) : 0.0;
+        w     = s0.m_w     + t*(s1.m_w    -s0.m_w);
+        theta = s0.m_Theta + t*(s1.m_Theta-s0.m_Theta);
+        xEA   = s0.m_xEA   + t*(s1.m_xEA  -s0.m_xEA);
+        zEA   = s0.m_zEA   + t*(s1.m_zEA  -s0.m_zEA);
+    }
+
+    // nose-up rotation about the elastic axis, then deflection
+    double dx = P.x-xEA;
+    double dz = P.z-zEA;
+    double c = cos(theta), s = sin(theta);
+    return {xEA + dx*c + dz*s, P.y, zEA - dx*s + dz*c + w};
+}
+
+
+/**
+ * Moves the nodes of the flexible wings from their rigid position, and rebuilds the panels from the nodes.
+ * The quad panels are rebuilt from their displaced vertices, which are shared by the adjacent panels.
+ */
+void AeroelasticLoop::deformMesh(std::vector<Shape> const &shapes)
+{
+    TriMesh &trimesh = m_pPlaneXfl->refTriMesh();
+    trimesh = m_RigidTriMesh;
+    std::vector<int> owner(trimesh.nNodes(), -1);
+    for(int iw=0; iw<int(shapes.size()); iw++)
+    {
+        if(!shapes.at(iw).m_bFlexible) continue;
+        WingXfl const *pWing = m_pPlaneXfl->wingAt(iw);
+        int i0 = pWing->firstPanel3Index();
+        int i1 = std::min(i0+pWing->nPanel3(), trimesh.nPanels());
+        for(int i3=std::max(i0,0); i3<i1; i3++)
+        {
+            Panel3 const &p3 = trimesh.panelAt(i3);
+            for(int iv=0; iv<3; iv++)
+            {
+                int in = p3.nodeIndex(iv);
+                if(in>=0 && in<int(owner.size()) && owner.at(in)<0) owner[in] = iw;
+            }
+        }
+    }
+    if(trimesh.nPanels()>0)
+    {
+        for(int in=0; in<trimesh.nNodes(); in++)
+        {
+            if(owner.at(in)<0) continue;
+            Vector3d P = deformedPoint(shapes.at(owner.at(in)), trimesh.nodeAt(in));
+            Node &node = trimesh.node(in);
+            node.x = P.x;  node.y = P.y;  node.z = P.z;
+        }
+        TriMesh::rebuildPanelsFromNodes(trimesh.panels(), trimesh.nodes());
+    }
+
+    QuadMesh &quadmesh = m_pPlaneXfl->refQuadMesh();
+    quadmesh = m_RigidQuadMesh;
+    for(int iw=0; iw<int(shapes.size()); iw++)
+    {
+        Shape const &shape = shapes.at(iw);
+        if(!shape.m_bFlexible) continue;
+        WingXfl const *pWing = m_pPlaneXfl->wingAt(iw);
+        int i0 = pWing->firstPanel4Index();
+        int i1 = std::min(i0+pWing->nPanel4(), quadmesh.nPanels());
+        for(int i4=std::max(i0,0); i4<i1; i4++)
+        {
+            Panel4 &p4 = quadmesh.panel(i4);
+            Vector3d LA = deformedPoint(shape, p4.LA());
+            Vector3d LB = deformedPoint(shape, p4.LB());
+            Vector3d TA = deformedPoint(shape, p4.TA());
+            Vector3d TB = deformedPoint(shape, p4.TB());
+            p4.setPanelFrame(LA, LB, TA, TB);
+        }
+    }
+}
@@ -32,12 +32,15 @@
 #include <boatopp.h>
 #include <boatpolar.h>
 #include <fuse.h>
+#include <livechannel.h>
 #include <p3linanalysis.h>
 #include <p3unianalysis.h>
 #include <p4analysis.h>
 #include <panelanalysis.h>
 #include <polar3d.h>
+#include <resultsink.h>
 #include <sail.h>
+#include <threadpool.h>
 #include <vector3d.h>
 
 
@@ -136,6 +139,15 @@ bool BoatTask::initializeTriangleAnalysis()
 
     m_pP3A->initializeAnalysis(m_pPolar3d, 1); // only one point at a time in the case of a boat analysis
 
+    // the hull panels follow the sail panels; their mutual influences are shared with the other
+    // boats which have the same hull, so that a sail plan variant only evaluates the sail rows and columns
+    int nPanels = refmesh.nPanels();
+    int iHull = 0;
+    while(iHull<nPanels && !refmesh.panelAt(iHull).isFusePanel()) iHull++;
+    bool bContiguous = true;
+    for(int i3=iHull; i3<nPanels && bContiguous; i3++) bContiguous = refmesh.panelAt(i3).isFusePanel();
+    if(bContiguous && iHull<nPanels) m_pPA->setSharedBlock(iHull, nPanels-iHull);
+
 //    m_pP3Analysis->makeConnections();
 //    std::string strange;
 //    strange = QString::asprintf("      Time to make connections: %2f s\n", (double)t.elapsed()/1000);
@@ -156,20 +168,36 @@ void BoatTask::loop()
 
     // one operating point at a time
     // linear combinations are not possible due to geometry changes for each control value
+    // the points are grouped by geometry though, so that the matrix is assembled and factorized once per group
 //    int nStations = 0;
 //    for(int is=0; is<m_pBoat->sailCount(); is++)        nStations += m_pBoat->sail(is)->nStations();
 
-    for (m_qRHS=0; m_qRHS<int(m_OppList.size()); m_qRHS++)
+    std::vector<int> order;
+    groupByGeometry(order);
+    std::vector<BoatOpp*> btopps(m_OppList.size(), nullptr);
+    size_t nPrevOpps = m_BtOppList.size();
+
+    std::vector<double> factorkey; // the geometry of the current LU factorization; empty if none
+    std::vector<double> key;
+
+    // without a vorton wake, the solutions of all the points of a geometry group are made in one block
+    std::vector<double> solutions;
+    int qFirstSolution = 0;
+    int nSolutions = 0;
+
+    for (m_qRHS=0; m_qRHS<int(order.size()); m_qRHS++)
     {
         for(uint i=0; i<m_SailForceFF.size();  i++) m_SailForceFF[i].reset();
         for(uint i=0; i<m_SailForceSum.size(); i++) m_SailForceSum[i].reset();
         for(uint i=0; i<m_HullForce.size();    i++) m_HullForce[i].reset();
         for(uint i=0; i<m_SpanDist.size();     i++) m_SpanDist[i].initializeToZero();
 
+        TaskProfile::Scope opphase(&m_Profile, "operating point");
+
         traceStdLog(EOLstr);
         m_bStopVPWIterations = false;
 
-        m_Ctrl = m_OppList.at(m_qRHS);
+        m_Ctrl = m_OppList.at(order.at(m_qRHS));
         strange = QString::asprintf("    Processing control value= %.3f\n", m_Ctrl);
         traceLog(strange);
 
@@ -188,76 +216,137 @@ void BoatTask::loop()
 
         Vector3d winddir = objects::windDirection(alpha, beta);
 
-        //reset the initial geometry before a new angle is processed
-        m_pPA->restorePanels();
         if(m_pBtPolar->bVortonWake())
         {
             m_pPA->clearVortons(); // from the previous operating point calculation
             m_pPA->m_VortexNeg.clear();
         }
 
-        if(m_pP3A)
+        geometryKey(m_Ctrl, key);
+        bool bNewGeometry = (key!=factorkey);
+
+        if(bNewGeometry)
         {
-            m_pBoat->rotateMesh(m_pBtPolar, phi, Ry, m_Ctrl, m_pP3A->m_Panel3);
-        }
+            factorkey.clear();
+
+            //reset the initial geometry before a new angle is processed
+            m_pPA->restorePanels();
 
-        std::string OutString;
-        if(!m_pPolar3d->isVLM()) m_pPA->makeWakePanels(winddir, m_pBtPolar->bVortonWake());
+            if(m_pP3A)
+            {
+                m_pBoat->rotateMesh(m_pBtPolar, phi, Ry, m_Ctrl, m_pP3A->m_Panel3);
+            }
 
-        traceStdLog(OutString+"\n");
+            std::string OutString;
+            if(!m_pPolar3d->isVLM()) m_pPA->makeWakePanels(winddir, m_pBtPolar->bVortonWake());
+
+            traceStdLog(OutString+"\n");
+        }
+        else
+            traceStdLog("      Same geometry as the previous point - reusing the factorized matrix\n");
 
         Vector3d VFree = winddir*qinf;
 
         if (isCancelled()) return;
 
-        m_pPA->makeInfluenceMatrix();
-        if(m_pPA->m_bMatrixError) return;
-        if (isCancelled()) return;
+        // when only the trim of some sails has changed from the reference geometry, the matrix differs
+        // from the reference by the rows and columns of these sails' panels and of the wake columns,
+        // and the reference factorization only needs a low-rank update
+        bool bUpdate = false;
+        if(bNewGeometry)
+        {
+            bUpdate = m_pPA->canUpdateFactorization();
+            if(bUpdate) m_pPA->prepareFactorizationUpdate();
+            {
+                TaskProfile::Scope phase(&m_Profile, "influence matrix");
+                m_pPA->makeInfluenceMatrix();
+                m_Profile.count(TaskProfile::INFLUENCECOEFS, int64_t(m_pPA->matSize())*int64_t(m_pPA->matSize()));
+            }
+            if(m_pPA->m_bMatrixError) return;
+            if (isCancelled()) return;
 #ifdef QT_DEBUG
 //display_mat(m_pPA->m_aijd.data(), m_pPA->nPanels());
 #endif
+        }
 
         if(!m_pPolar3d->isVLM())
         {
             m_pPA->makeSourceStrengths(VFree);
             //compute wake contribution
-            m_pPA->addWakeContribution();
+            if(bNewGeometry)
+            {
+                TaskProfile::Scope phase(&m_Profile, "wake contribution");
+                m_pPA->addWakeContribution();
+            }
         }
 #ifdef QT_DEBUG
 //display_mat(m_pPA->m_aijd.data(), m_pPA->nPanels());
 #endif
         if (isCancelled()) return;
 
-        if (!m_pPA->LUfactorize())
+        if(bNewGeometry)
         {
-            m_bError = true;
-            return;
+            int rank = 0;
+            bool bUpdated = false;
+            if(bUpdate)
+            {
+                TaskProfile::Scope phase(&m_Profile, "LU update");
+                bUpdated = m_pPA->updateFactorization(rank);
+            }
+            if(bUpdated)
+            {
+                traceLog(QString::asprintf("      Low-rank update of the LU factorization, rank %d\n", rank));
+            }
+            else
+            {
+                m_pPA->storeReferenceMatrix();
+                TaskProfile::Scope phase(&m_Profile, "LU factorization");
+                m_Profile.count(TaskProfile::LUFACTORIZATIONS);
+                if (!m_pPA->LUfactorize())
+                {
+                    m_bError = true;
+                    return;
+                }
+            }
+            factorkey = key;
         }
 
-        // make the array of velocity vectors
-#ifdef QT_DEBUG
-//            PanelAnalysis::s_DebugPts.clear();
-//            PanelAnalysis::s_DebugVecs.clear();
-#endif
-        for(uint i=0; i<VField.size(); i++)
+        if(bNewGeometry || !m_pPA->hasRHSCoefficients())
         {
-            m_pBtPolar->apparentWind(m_Ctrl, m_pPA->panelAt(i)->CoG().z, AWS[i]);
-#ifdef QT_DEBUG
-//            PanelAnalysis::s_DebugPts.append(m_pPA->panelAt(i)->CoG());
-//            PanelAnalysis::s_DebugVecs.append(AWS);
-#endif
+            // the RHS of the points with the same geometry are made from coefficients in O(N)
+            TaskProfile::Scope phase(&m_Profile, "RHS");
+            m_pPA->makeRHSCoefficients();
         }
 
+        if(bNewGeometry && !m_pPolar3d->bVortonWake())
+        {
+            qFirstSolution = m_qRHS;
+            nSolutions = solveGeometryGroup(order, m_qRHS, key, solutions);
+            if(nSolutions>1) traceLog(QString::asprintf("      Solved the %d points with the same geometry in one block\n", nSolutions));
+        }
+        int iSolution = m_qRHS-qFirstSolution;
+        bool bSolved = !m_pPolar3d->bVortonWake() && iSolution>=0 && iSolution<nSolutions;
+
+        // make the array of velocity vectors
+        makeApparentWindField(m_Ctrl, AWS);
+
         // go through the loop at least once
         int nWakeIter = 1;
         if(m_pPolar3d->bVortonWake()) nWakeIter = std::max(nWakeIter, m_pPolar3d->VPWIterations());
         if(nWakeIter>1) traceStdLog("      Starting vorton loop\n");
+        Vector3d LastForce;
+        int nSteady = 0;
         for(int ivw=0; ivw<nWakeIter; ivw++)
         {
             if(m_pPolar3d->bVortonWake()) traceLog(QString::asprintf("        VPW iteration %3d/%d\n", ivw+1, nWakeIter));
 
+            TaskProfile::Scope vpwphase(m_pPolar3d->bVortonWake() ? &m_Profile : nullptr, "VPW iteration");
             if(m_pPolar3d->bVortonWake())
+            {
+                m_Profile.count(TaskProfile::VPWITERATIONS);
+                TaskProfile::Scope phase(&m_Profile, "vorton velocities");
                 m_pPA->makeRHSVWVelocities(VField);
+            }
             else
                 for(uint i=0; i<VField.size(); i++) VField[i].reset();
 
@@ -266,11 +355,24 @@ void BoatTask::loop()
                 VField[i] += AWS.at(i);
             }
 
-            m_pPA->makeRHS(VField, m_pPA->m_uRHS, nullptr);
+            if(bSolved)
+            {
+                int n = m_pPA->matSize();
+                memcpy(m_pPA->m_uRHS.data(), solutions.data()+size_t(iSolution)*size_t(n), size_t(n)*sizeof(double));
+            }
+            else
+            {
+                {
+                    TaskProfile::Scope phase(&m_Profile, "RHS");
+                    m_pPA->combineRHSCoefficients(VField, m_pPA->m_uRHS);
+                }
 #ifdef QT_DEBUG
 //      displayArray(m_pPA->m_uRHS);
 #endif
-            m_pPA->backSubUnitRHS(m_pPA->m_uRHS.data(), nullptr, nullptr, nullptr, nullptr, nullptr);
+                TaskProfile::Scope phase(&m_Profile, "back-substitution");
+                m_Profile.count(TaskProfile::RHSSOLVED);
+                m_pPA->backSubUnitRHS(m_pPA->m_uRHS.data(), nullptr, nullptr, nullptr, nullptr, nullptr);
+            }
 #ifdef QT_DEBUG
 //      displayArray(m_pPA->m_uRHS);
 #endif
@@ -285,10 +387,24 @@ void BoatTask::loop()
                     m_pPA->makeVertexDoubletDensities(m_pP3A->m_uRHS, m_pP3A->m_Mu);
             }
 
+            Vector3d ForceFF;
+            if(m_pBtPolar->bVortonWake())
+            {
+                ForceFF = sailForceFF(alpha, beta, qinf);
+                if(m_pLiveChannel) m_pLiveChannel->publishResidual(m_Ctrl, ivw, ForceFF.norm());
+            }
+
+            if(m_pBtPolar->bVortonWake() && hasVPWConverged(ForceFF, LastForce, nSteady))
+            {
+                traceLog(QString::asprintf("        VPW iterations converged after %d iterations\n", ivw+1));
+                break;
+            }
+
             if(m_pBtPolar->bVortonWake())
             {
                 advectVortons(alpha, beta, qinf, 0);
                 makeVortonRow(0);
+                manageVortons();
                 if(s_bLiveUpdate)
                 {
                     traceVPWLog(m_Ctrl);
@@ -310,30 +426,159 @@ void BoatTask::loop()
         traceStdLog("      Computing on body Cp...");
         if(!m_pPolar3d->isVLM())
         {
+            TaskProfile::Scope phase(&m_Profile, "on-body Cp");
             m_pPA->computeOnBodyCp(VField, m_pPA->m_uVLocal, m_pPA->m_Cp);
         }
         if (isCancelled()) return;
         traceStdLog(" done\n");
 
         traceStdLog("      Calculating far field forces...");
-        computeInducedForces(alpha, beta, qinf);
-        computeInducedDrag(alpha, beta, qinf, 0, m_SailForceFF, m_SpanDist);
+        {
+            TaskProfile::Scope phase(&m_Profile, "far field forces");
+            computeInducedForces(alpha, beta, qinf);
+        }
+        {
+            TaskProfile::Scope phase(&m_Profile, "Trefftz drag");
+            computeInducedDrag(alpha, beta, qinf, 0, m_SailForceFF, m_SpanDist);
+        }
         if (isCancelled()) return;
         traceStdLog(" done\n");
 
         strange = QString::asprintf("      Computing boat for control parameter=%.3f\n", m_Ctrl);
         traceLog(strange);
-        BoatOpp *pBtOpp = computeBoat(0);
+        BoatOpp *pBtOpp = nullptr;
+        {
+            TaskProfile::Scope phase(&m_Profile, "operating point results");
+            pBtOpp = computeBoat(0);
+        }
+        applyFieldRetention(m_pBtPolar, pBtOpp, order.at(m_qRHS));
+        if(m_pResultSink) m_pResultSink->addBoatOpp(pBtOpp);
+        if(m_pLiveChannel) m_pLiveChannel->publishBoatOpp(pBtOpp);
         m_BtOppList.push_back(pBtOpp);
+        btopps[order.at(m_qRHS)] = pBtOpp;
 
         if (isCancelled()) return;
     }
 
+    // store the operating points in the order of the analysis range
+    m_BtOppList.resize(nPrevOpps);
+    for(BoatOpp *pBtOpp : btopps)
+        if(pBtOpp) m_BtOppList.push_back(pBtOpp);
+
     if(m_AnalysisStatus!=xfl::CANCELLED) m_AnalysisStatus = xfl::FINISHED; // finish the analysis before sending the final condition_variable
     traceStdLog("\nDone plane task.\n"); // final notification after flag is set to FINISHED so that sender thread may exit
 }
 
 
+/**
+ * Returns the parameters which define the panel geometry of the operating point:
+ * heel and trim angles, sail angles, and the wind direction to which the wake panels are aligned.
+ */
+void BoatTask::geometryKey(double ctrl, std::vector<double> &key) const
+{
+    key.clear();
+    key.push_back(m_pBtPolar->phi(ctrl));
+    key.push_back(m_pBtPolar->Ry(ctrl));
+    for(int is=0; is<m_pBoat->nSails(); is++)
+        key.push_back(m_pBtPolar->sailAngle(is, ctrl));
+    if(!m_pPolar3d->isVLM())
+        key.push_back(m_pBtPolar->AWAInf(ctrl));
+}
+
+
+/**
+ * Makes the apparent wind at the CoG of each panel, with the wind gradient of the polar.
+ */
+void BoatTask::makeApparentWindField(double ctrl, std::vector<Vector3d> &AWS) const
+{
+    int n = m_pPA->nPanels();
+    AWS.resize(n);
+    int nBlocks = std::min(ThreadPool::nBlocks(ThreadPool::maxThreadCount()), std::max(1, n/1000));
+    int blockSize = n/nBlocks + 1;
+    ThreadPool::pool().parallelFor(nBlocks, [&](int iBlock)
+    {
+        int iMax = std::min(n, (iBlock+1)*blockSize);
+        for(int i=iBlock*blockSize; i<iMax; i++)
+            m_pBtPolar->apparentWind(ctrl, m_pPA->panelAt(i)->CoG().z, AWS[i]);
+    });
+}
+
+
+/**
+ * Solves the points which follow q0 in the order and share its geometry, in one back-substitution.
+ * The RHS of the points are made in parallel from the RHS coefficients, so that each costs O(N),
+ * and the wind sweeps on a same geometry only cost one block solve after the factorization.
+ * Only valid without a vorton wake, since the vortons change the velocity field at each iteration.
+ * @param solutions the solutions of the points, one after the other
+ * @return the number of points solved, or 0 if the back-substitution failed
+ */
+int BoatTask::solveGeometryGroup(std::vector<int> const &order, int q0, std::vector<double> const &key, std::vector<double> &solutions)
+{
+    std::vector<double> pointkey;
+    int nGroup = 0;
+    for(int q=q0; q<int(order.size()); q++)
+    {
+        geometryKey(m_OppList.at(order.at(q)), pointkey);
+        if(pointkey!=key) break;
+        nGroup++;
+    }
+    if(nGroup==0) return 0;
+
+    TaskProfile::Scope phase(&m_Profile, "RHS block");
+
+    size_t n = size_t(m_pPA->matSize());
+    solutions.assign(size_t(nGroup)*n, 0.0);
+    ThreadPool::pool().parallelFor(nGroup, [&](int iPoint)
+    {
+        std::vector<Vector3d> AWS;
+        std::vector<double> RHS(m_pPA->m_uRHS.size(), 0.0);
+        makeApparentWindField(m_OppList.at(order.at(q0+iPoint)), AWS);
+        m_pPA->combineRHSCoefficients(AWS, RHS);
+        memcpy(solutions.data()+size_t(iPoint)*n, RHS.data(), n*sizeof(double));
+    });
+
+    m_Profile.count(TaskProfile::RHSSOLVED, nGroup);
+    if(!m_pPA->backSubRHSBlock(solutions.data(), nGroup))
+    {
+        solutions.clear();
+        return 0;
+    }
+    return nGroup;
+}
+
+
+/**
+ * Orders the operating points so that the points which share the same panel geometry are
+ * processed in sequence; the groups are in the order of their first point in the range.
+ */
+void BoatTask::groupByGeometry(std::vector<int> &order) const
+{
+    std::vector<std::vector<double>> groupkeys;
+    std::vector<std::vector<int>> groups;
+    std::vector<double> key;
+
+    for(int i=0; i<int(m_OppList.size()); i++)
+    {
+        geometryKey(m_OppList.at(i), key);
+        uint ig=0;
+        for(ig=0; ig<groupkeys.size(); ig++)
+            if(groupkeys.at(ig)==key) break;
+
+        if(ig==groupkeys.size())
+        {
+            groupkeys.push_back(key);
+            groups.push_back({i});
+        }
+        else
+            groups[ig].push_back(i);
+    }
+
+    order.clear();
+    for(std::vector<int> const &group : groups)
+        order.insert(order.end(), group.begin(), group.end());
+}
+
+
 void BoatTask::scaleResultsToSpeed(int qrhs)
 {
     double qinf = m_pBtPolar->AWSInf(m_Ctrl);
@@ -697,7 +942,7 @@ void BoatTask::makeVortonRow(int qrhs)
         newvortons.pop_back();
 
     // save the new vortons
-    m_pPA->m_Vorton = newvortons;
+    m_pPA->setVortons(newvortons);
 }
 
 
@@ -732,6 +977,34 @@ void BoatTask::computeInducedForces(double alpha, double beta, double QInf)
 }
 
 
+/**
+ * Returns the sum of the sails' far field forces in N/q, body axes,
+ * without modifying the force arrays; used to monitor the convergence of the VPW iterations.
+ */
+Vector3d BoatTask::sailForceFF(double alpha, double beta, double QInf)
+{
+    Vector3d Force;
+    int pos = 0;
+    for(int iw=0; iw<m_pBoat->nSails(); iw++)
+    {
+        Sail *pSail = m_pBoat->sail(iw);
+        if(!m_pBtPolar || !pSail) continue;
+
+        SpanDistribs spandist = pSail->spanDistFF();
+        Vector3d forcebodyaxes;
+        if(m_pBtPolar->isQuadMethod() && m_pP4A)
+            m_pP4A->inducedForce(pSail->nPanel4(), QInf, alpha, beta, pos, forcebodyaxes, spandist);
+        else if(m_pBtPolar->isTriangleMethod() && m_pP3A)
+            m_pP3A->inducedForce(pSail->nPanel3(), QInf, alpha, beta, pos, forcebodyaxes, spandist);
+        Force += forcebodyaxes;
+
+        if      (m_pBtPolar->isTriangleMethod()) pos += pSail->nPanel3();
+        else if (m_pBtPolar->isQuadMethod())     pos += pSail->nPanel4();
+    }
+    return Force;
+}
+
+
 /**
  * Calculates the induced drag half-way down the wake to avoid end effects.
  * Uses the vorton induced velocity if the vorton wake has been defined,
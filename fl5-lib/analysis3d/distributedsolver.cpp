@@ -0,0 +1,290 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#ifdef FL5_MPI
+#include <mpi.h>
+
+// BLACS and ScaLAPACK have no standard C headers
+extern "C"
+{
+    void Cblacs_get(int icontxt, int what, int *val);
+    void Cblacs_gridinit(int *icontxt, char const *order, int nprow, int npcol);
+    void Cblacs_gridinfo(int icontxt, int *nprow, int *npcol, int *myrow, int *mycol);
+    void Cblacs_gridexit(int icontxt);
+    int numroc_(int const *n, int const *nb, int const *iproc, int const *isrcproc, int const *nprocs);
+    void descinit_(int *desc, int const *m, int const *n, int const *mb, int const *nb, int const *irsrc, int const *icsrc,
+                   int const *ictxt, int const *lld, int *info);
+    void pdgetrf_(int const *m, int const *n, double *A, int const *ia, int const *ja, int const *descA, int *ipiv, int *info);
+    void pdgetrs_(char const *trans, int const *n, int const *nrhs, double const *A, int const *ia, int const *ja, int const *descA,
+                  int const *ipiv, double *B, int const *ib, int const *jb, int const *descB, int *info);
+}
+#endif
+
+#include <distributedsolver.h>
+#include <threadpool.h>
+
+
+int DistributedSolver::s_BlockSize(64);
+
+
+struct DistributedSolver::GridData
+{
+    int m_Context{-1};       /**< the BLACS context, -1 if the grid has not been made */
+    int m_nRow{0}, m_nCol{0};
+    int m_MyRow{0}, m_MyCol{0};
+    int m_Desc[9]{};         /**< the ScaLAPACK descriptor of the matrix */
+    int m_LocalRows{0}, m_LocalCols{0};
+    int m_NB{0};             /**< the block size of the factorization */
+    std::vector<double> m_LU;  /**< the local tiles of the factors, column-major with leading dimension m_LocalRows */
+    std::vector<int> m_ipiv;
+};
+
+
+namespace
+{
+    /** @return the number of rows of the process grid, the largest divisor of nRanks not greater than its square root */
+    int gridRows(int nRanks)
+    {
+        int nprow = int(std::sqrt(double(nRanks)));
+        while(nprow>1 && nRanks%nprow!=0) nprow--;
+        return std::max(nprow, 1);
+    }
+
+    /** @return the global index of the local index il in a block-cyclic distribution starting on the process 0 */
+    inline int globalIndex(int il, int nb, int iproc, int nprocs)
+    {
+        return (il/nb)*nb*nprocs + iproc*nb + il%nb;
+    }
+}
+
+
+DistributedSolver::DistributedSolver() : m_pData(new GridData)
+{
+    m_N = 0;
+}
+
+
+DistributedSolver::~DistributedSolver()
+{
+    release();
+#ifdef FL5_MPI
+    if(m_pData->m_Context>=0) Cblacs_gridexit(m_pData->m_Context);
+#endif
+}
+
+
+/** @return true if the library was compiled with MPI support and the job runs on more than one rank */
+bool DistributedSolver::isAvailable()
+{
+#ifdef FL5_MPI
+    int bInit = 0;
+    MPI_Initialized(&bInit);
+    return bInit && nRanks()>1;
+#else
+    return false;
+#endif
+}
+
+
+int DistributedSolver::rank()
+{
+#ifdef FL5_MPI
+    int bInit = 0;
+    MPI_Initialized(&bInit);
+    if(!bInit) return 0;
+    int r = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &r);
+    return r;
+#else
+    return 0;
+#endif
+}
+
+
+int DistributedSolver::nRanks()
+{
+#ifdef FL5_MPI
+    int bInit = 0;
+    MPI_Initialized(&bInit);
+    if(!bInit) return 1;
+    int size = 1;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    return size;
+#else
+    return 1;
+#endif
+}
+
+
+/** @return an estimate of the memory required on each rank for the local tiles of a matrix of size n */
+size_t DistributedSolver::localBytes(int n)
+{
+    int np = nRanks();
+    int nprow = gridRows(np);
+    int npcol = np/nprow;
+    size_t nb = size_t(s_BlockSize);
+    size_t lrows = (size_t(n)/(nb*size_t(nprow))+1)*nb;
+    size_t lcols = (size_t(n)/(nb*size_t(npcol))+1)*nb;
+    return lrows*lcols*sizeof(double);
+}
+
+
+/** Frees the local tiles of the factors; the process grid is kept for the next factorization */
+void DistributedSolver::release()
+{
+    m_pData->m_LU.clear();
+    m_pData->m_LU.shrink_to_fit();
+    m_pData->m_ipiv.clear();
+    m_N = 0;
+}
+
+
+/**
+ * Assembles and factorizes the matrix of size n, of which each rank evaluates only the coefficients of its local tiles.
+ * @param coef the function which returns the coefficient (i,k) of the matrix, i.e. the influence of the unknown k on the row i;
+ * called concurrently from the thread pool.
+ * @return false if the solver is not available, or if the matrix is singular; the result is the same on all the ranks.
+ */
+bool DistributedSolver::factorize(int n, std::function<double(int,int)> const &coef)
+{
+    release();
+#ifdef FL5_MPI
+    if(!isAvailable() || n<=0) return false;
+
+    GridData &d = *m_pData;
+    if(d.m_Context<0)
+    {
+        int np = nRanks();
+        d.m_nRow = gridRows(np);
+        d.m_nCol = np/d.m_nRow;
+        Cblacs_get(-1, 0, &d.m_Context);
+        Cblacs_gridinit(&d.m_Context, "Row", d.m_nRow, d.m_nCol);
+        Cblacs_gridinfo(d.m_Context, &d.m_nRow, &d.m_nCol, &d.m_MyRow, &d.m_MyCol);
+    }
+
+    int const izero = 0;
+    int const ione = 1;
+    d.m_NB = std::min(s_BlockSize, n);
+    d.m_LocalRows = numroc_(&n, &d.m_NB, &d.m_MyRow, &izero, &d.m_nRow);
+    d.m_LocalCols = numroc_(&n, &d.m_NB, &d.m_MyCol, &izero, &d.m_nCol);
+    int lld = std::max(1, d.m_LocalRows);
+    int info = 0;
+    descinit_(d.m_Desc, &n, &n, &d.m_NB, &d.m_NB, &izero, &izero, &d.m_Context, &lld, &info);
+    if(info!=0) return false;
+
+    // the grid's dimensions divide the number of ranks, so that every rank holds tiles
+    d.m_LU.resize(size_t(lld)*size_t(std::max(1, d.m_LocalCols)));
+    d.m_ipiv.resize(size_t(d.m_LocalRows+d.m_NB));
+
+    ThreadPool::pool().parallelFor(d.m_LocalCols, [&](int jl)
+    {
+        int k = globalIndex(jl, d.m_NB, d.m_MyCol, d.m_nCol);
+        double *col = d.m_LU.data() + size_t(jl)*size_t(lld);
+        for(int il=0; il<d.m_LocalRows; il++)
+            col[il] = coef(globalIndex(il, d.m_NB, d.m_MyRow, d.m_nRow), k);
+    });
+
+    pdgetrf_(&n, &n, d.m_LU.data(), &ione, &ione, d.m_Desc, d.m_ipiv.data(), &info);
+
+    // all the ranks must agree on the result
+    int localfail = info!=0 ? 1 : 0;
+    int fail = 0;
+    MPI_Allreduce(&localfail, &fail, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    if(fail)
+    {
+        release();
+        return false;
+    }
+    m_N = n;
+    return true;
+#else
+    (void)n; (void)coef;
+    return false;
+#endif
+}
+
+
+/**
+ * Solves A.X=B, or A^T.X=B if bTranspose, for the block of nRHS vectors stored one after the other in B.
+ * B must be the same on all the ranks; each rank copies its tiles of B, and the solutions of pdgetrs are
+ * summed over the ranks, which own distinct coefficients, so that every rank receives the full solution in place of B.
+ */
+bool DistributedSolver::solve(bool bTranspose, double *B, int nRHS)
+{
+#ifdef FL5_MPI
+    if(m_N<=0 || !B || nRHS<=0) return false;
+
+    GridData &d = *m_pData;
+    int const izero = 0;
+    int const ione = 1;
+    int n = m_N;
+    int lcolsB = numroc_(&nRHS, &d.m_NB, &d.m_MyCol, &izero, &d.m_nCol);
+    int lld = std::max(1, d.m_LocalRows);
+    int descB[9]{};
+    int info = 0;
+    descinit_(descB, &n, &nRHS, &d.m_NB, &d.m_NB, &izero, &izero, &d.m_Context, &lld, &info);
+    if(info!=0) return false;
+
+    std::vector<double> localB(size_t(lld)*size_t(std::max(1, lcolsB)), 0.0);
+    for(int jl=0; jl<lcolsB; jl++)
+    {
+        int j = globalIndex(jl, d.m_NB, d.m_MyCol, d.m_nCol);
+        for(int il=0; il<d.m_LocalRows; il++)
+            localB[size_t(jl)*size_t(lld)+il] = B[size_t(j)*size_t(n) + size_t(globalIndex(il, d.m_NB, d.m_MyRow, d.m_nRow))];
+    }
+
+    char trans = bTranspose ? 'T' : 'N';
+    pdgetrs_(&trans, &n, &nRHS, d.m_LU.data(), &ione, &ione, d.m_Desc, d.m_ipiv.data(), localB.data(), &ione, &ione, descB, &info);
+
+    int localfail = info!=0 ? 1 : 0;
+    int fail = 0;
+    MPI_Allreduce(&localfail, &fail, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    if(fail) return false;
+
+    size_t blocksize = size_t(n)*size_t(nRHS);
+    std::vector<double> X(blocksize, 0.0);
+    for(int jl=0; jl<lcolsB; jl++)
+    {
+        int j = globalIndex(jl, d.m_NB, d.m_MyCol, d.m_nCol);
+        for(int il=0; il<d.m_LocalRows; il++)
+            X[size_t(j)*size_t(n) + size_t(globalIndex(il, d.m_NB, d.m_MyRow, d.m_nRow))] = localB[size_t(jl)*size_t(lld)+il];
+    }
+    // the counts of MPI are ints, so the block is reduced in chunks
+    size_t const chunk = size_t(1)<<28;
+    for(size_t i0=0; i0<blocksize; i0+=chunk)
+    {
+        int count = int(std::min(chunk, blocksize-i0));
+        MPI_Allreduce(X.data()+i0, B+i0, count, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    }
+    return true;
+#else
+    (void)bTranspose; (void)B; (void)nRHS;
+    return false;
+#endif
+}
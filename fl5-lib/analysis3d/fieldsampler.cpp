@@ -0,0 +1,256 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include <fieldsampler.h>
+#include <panelanalysis.h>
+#include <threadpool.h>
+#include <vortex.h>
+
+
+int FieldSampler::s_BlockSize = 64;
+
+
+FieldSampler::FieldSampler()
+{
+    m_pAnalysis = nullptr;
+    m_Mu = m_Sigma = nullptr;
+
+    m_Axis[0].set(1,0,0);
+    m_Axis[1].set(0,1,0);
+    m_Axis[2].set(0,0,1);
+    m_Step[0] = m_Step[1] = m_Step[2] = 1.0;
+    m_nu = m_nv = m_nw = 0;
+
+    m_bRunning   = false;
+    m_bCancel    = false;
+    m_nSlabsDone = 0;
+}
+
+
+FieldSampler::~FieldSampler()
+{
+    cancel();
+    wait();
+}
+
+
+/** The arrays mu and sigma must remain valid until the sampling is complete */
+void FieldSampler::setAnalysis(PanelAnalysis const *pAnalysis, double const *mu, double const *sigma, Vector3d const &VInf)
+{
+    m_pAnalysis = pAnalysis;
+    m_Mu        = mu;
+    m_Sigma     = sigma;
+    m_VInf      = VInf;
+}
+
+
+/**
+ * Defines the grid of nu x nv x nw nodes with its first node at the origin.
+ * The axes are normalized; they are assumed to be orthogonal for the calculation of the vorticity.
+ */
+void FieldSampler::setGrid(Vector3d const &origin, Vector3d const &u, Vector3d const &v, Vector3d const &w,
+                           int nu, int nv, int nw, double du, double dv, double dw)
+{
+    wait();
+
+    m_Origin = origin;
+    m_Axis[0] = u.normalized();
+    m_Axis[1] = v.normalized();
+    m_Axis[2] = w.normalized();
+    m_nu = std::max(nu, 1);
+    m_nv = std::max(nv, 1);
+    m_nw = std::max(nw, 1);
+    m_Step[0] = du;
+    m_Step[1] = dv;
+    m_Step[2] = dw;
+
+    m_Velocity.assign(nNodes(), Vector3d());
+    m_Vorticity.assign(nNodes(), Vector3d());
+    m_Cp.assign(nNodes(), 0.0);
+
+    m_bCancel = false;
+    m_nSlabsDone = 0;
+}
+
+
+/** Defines a grid with a single slab in the plane (u,v) */
+void FieldSampler::setSlice(Vector3d const &origin, Vector3d const &u, Vector3d const &v, int nu, int nv, double du, double dv)
+{
+    setGrid(origin, u, v, u*v, nu, nv, 1, du, dv, 1.0);
+}
+
+
+Vector3d FieldSampler::node(int iu, int iv, int iw) const
+{
+    return m_Origin + m_Axis[0]*(double(iu)*m_Step[0]) + m_Axis[1]*(double(iv)*m_Step[1]) + m_Axis[2]*(double(iw)*m_Step[2]);
+}
+
+
+/** Launches the sampling in a background thread and returns immediately */
+void FieldSampler::start()
+{
+    wait();
+    m_bCancel = false;
+    m_bRunning = true;
+    m_Thread = std::thread(&FieldSampler::run, this);
+}
+
+
+/** Blocks until the background sampling, if any, has finished */
+void FieldSampler::wait()
+{
+    if(m_Thread.joinable()) m_Thread.join();
+}
+
+
+/**
+ * Samples all the slabs in the calling thread.
+ * The vorticity of a slab is made as soon as the next slab has been sampled, and the callback is then called for that slab.
+ */
+void FieldSampler::run()
+{
+    m_bRunning = true;
+    m_nSlabsDone = 0;
+
+    if(m_pAnalysis && nNodes()>0)
+    {
+        for(int iw=0; iw<m_nw; iw++)
+        {
+            if(m_bCancel) break;
+            sampleSlab(iw);
+            if(iw>0)
+            {
+                makeVorticitySlab(iw-1);
+                m_nSlabsDone = iw;
+                if(m_SlabCallback) m_SlabCallback(iw-1);
+            }
+        }
+
+        if(!m_bCancel)
+        {
+            makeVorticitySlab(m_nw-1);
+            m_nSlabsDone = m_nw;
+            if(m_SlabCallback) m_SlabCallback(m_nw-1);
+        }
+    }
+
+    m_bRunning = false;
+}
+
+
+void FieldSampler::sampleSlab(int iw)
+{
+    int nSlab = m_nu*m_nv;
+    int nBlocks = (nSlab+s_BlockSize-1)/s_BlockSize;
+    int i0 = index(0,0,iw);
+    double qinf2 = m_VInf.norm()*m_VInf.norm();
+
+    ThreadPool::pool().parallelFor(nBlocks, [this, iw, i0, nSlab, qinf2](int iBlock)
+    {
+        if(m_bCancel) return;
+
+        int iStart = iBlock*s_BlockSize;
+        int nPts = std::min(s_BlockSize, nSlab-iStart);
+        std::vector<Vector3d> pts(nPts);
+        for(int ip=0; ip<nPts; ip++)
+        {
+            int k = iStart+ip;
+            pts[ip] = node(k%m_nu, k/m_nu, iw);
+        }
+
+        Vector3d *V = m_Velocity.data()+i0+iStart;
+        m_pAnalysis->getVelocityVectors(nPts, pts.data(), m_Mu, m_Sigma, V, Vortex::coreRadius(), false);
+
+        for(int ip=0; ip<nPts; ip++)
+        {
+            Vector3d VT = m_VInf + V[ip];
+            m_Cp[i0+iStart+ip] = qinf2>0.0 ? 1.0 - VT.dot(VT)/qinf2 : 0.0;
+        }
+    });
+}
+
+
+/** Returns the derivative of the velocity along the grid axis iAxis, by central differences inside the grid */
+Vector3d FieldSampler::derivative(int iu, int iv, int iw, int iAxis) const
+{
+    int n[]  = {m_nu, m_nv, m_nw};
+    int i[]  = {iu, iv, iw};
+    if(n[iAxis]<2) return Vector3d();
+
+    int im[] = {iu, iv, iw};
+    int ip[] = {iu, iv, iw};
+    im[iAxis] = std::max(i[iAxis]-1, 0);
+    ip[iAxis] = std::min(i[iAxis]+1, n[iAxis]-1);
+
+    double ds = double(ip[iAxis]-im[iAxis])*m_Step[iAxis];
+    if(fabs(ds)<1.e-12) return Vector3d();
+
+    return (m_Velocity.at(index(ip[0], ip[1], ip[2])) - m_Velocity.at(index(im[0], im[1], im[2]))) * (1.0/ds);
+}
+
+
+void FieldSampler::makeVorticitySlab(int iw)
+{
+    ThreadPool::pool().parallelFor(m_nv, [this, iw](int iv)
+    {
+        double G[9]; // G[3*i+j] = dVi/dxj
+        for(int iu=0; iu<m_nu; iu++)
+        {
+            Vector3d dV[3];
+            for(int a=0; a<3; a++) dV[a] = derivative(iu, iv, iw, a);
+
+            for(int k=0; k<3; k++)
+            {
+                G[0*3+k] = dV[0].x*m_Axis[0].dir(k) + dV[1].x*m_Axis[1].dir(k) + dV[2].x*m_Axis[2].dir(k);
+                G[1*3+k] = dV[0].y*m_Axis[0].dir(k) + dV[1].y*m_Axis[1].dir(k) + dV[2].y*m_Axis[2].dir(k);
+                G[2*3+k] = dV[0].z*m_Axis[0].dir(k) + dV[1].z*m_Axis[1].dir(k) + dV[2].z*m_Axis[2].dir(k);
+            }
+
+            m_Vorticity[index(iu, iv, iw)].set(G[2*3+1]-G[1*3+2], G[0*3+2]-G[2*3+0], G[1*3+0]-G[0*3+1]);
+        }
+    });
+}
+
+
+/**
+ * Writes the RGBA texels of nSlabs consecutive slabs starting at slab iw0, i.e. the three components
+ * of the perturbation velocity and the Cp. The array must have room for 4 floats per node.
+ */
+void FieldSampler::packTexels(int iw0, int nSlabs, float *texels) const
+{
+    int i0 = index(0,0,iw0);
+    int n = nSlabs*m_nu*m_nv;
+    for(int i=0; i<n; i++)
+    {
+        Vector3d const &V = m_Velocity.at(i0+i);
+        texels[4*i]   = V.xf();
+        texels[4*i+1] = V.yf();
+        texels[4*i+2] = V.zf();
+        texels[4*i+3] = float(m_Cp.at(i0+i));
+    }
+}
+
@@ -0,0 +1,285 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <cstring>
+#include <vector>
+
+#ifdef FL5_CUDA
+#include <cuda_runtime.h>
+#include <cusolverDn.h>
+#endif
+
+#include <gpusolver.h>
+
+
+struct GpuSolver::DeviceData
+{
+#ifdef FL5_CUDA
+    cusolverDnHandle_t m_Handle{nullptr};
+    void *m_dLU{nullptr};     /**< the factors, double or float */
+    int *m_dPiv{nullptr};
+    int *m_dInfo{nullptr};
+    void *m_dB{nullptr};      /**< the RHS block, reused from one solve to the next */
+    size_t m_BBytes{0};
+#endif
+};
+
+
+GpuSolver::GpuSolver() : m_pData(new DeviceData)
+{
+    m_N = 0;
+    m_bDouble = true;
+}
+
+
+GpuSolver::~GpuSolver()
+{
+    release();
+#ifdef FL5_CUDA
+    if(m_pData->m_dB) cudaFree(m_pData->m_dB);
+    if(m_pData->m_Handle) cusolverDnDestroy(m_pData->m_Handle);
+#endif
+}
+
+
+/** @return true if the library was compiled with CUDA support and a device is present */
+bool GpuSolver::isAvailable()
+{
+#ifdef FL5_CUDA
+    static bool const bAvailable = []
+    {
+        int count = 0;
+        return cudaGetDeviceCount(&count)==cudaSuccess && count>0;
+    }();
+    return bAvailable;
+#else
+    return false;
+#endif
+}
+
+
+std::string GpuSolver::deviceName()
+{
+#ifdef FL5_CUDA
+    if(!isAvailable()) return std::string();
+    int device = 0;
+    cudaDeviceProp prop;
+    if(cudaGetDevice(&device)!=cudaSuccess || cudaGetDeviceProperties(&prop, device)!=cudaSuccess) return std::string();
+    return std::string(prop.name);
+#else
+    return std::string();
+#endif
+}
+
+
+/** Frees the factors on the device; the RHS buffer and the handle are kept for the next factorization */
+void GpuSolver::release()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+#ifdef FL5_CUDA
+    if(m_pData->m_dLU)   cudaFree(m_pData->m_dLU);
+    if(m_pData->m_dPiv)  cudaFree(m_pData->m_dPiv);
+    if(m_pData->m_dInfo) cudaFree(m_pData->m_dInfo);
+    m_pData->m_dLU   = nullptr;
+    m_pData->m_dPiv  = nullptr;
+    m_pData->m_dInfo = nullptr;
+#endif
+    m_N = 0;
+}
+
+
+/**
+ * Allocates the device arrays and uploads the matrix; the caller must hold the lock.
+ * @return false if the device does not have enough free memory, in which case nothing is allocated.
+ */
+bool GpuSolver::upload(void const *A, int n, bool bDouble)
+{
+#ifdef FL5_CUDA
+    DeviceData &d = *m_pData;
+    if(!d.m_Handle && cusolverDnCreate(&d.m_Handle)!=CUSOLVER_STATUS_SUCCESS)
+    {
+        d.m_Handle = nullptr;
+        return false;
+    }
+
+    size_t bytes = size_t(n)*size_t(n)*(bDouble ? sizeof(double) : sizeof(float));
+    size_t freeBytes=0, totalBytes=0;
+    // leave room for the workspace of getrf and for the RHS
+    if(cudaMemGetInfo(&freeBytes, &totalBytes)!=cudaSuccess || freeBytes < bytes + bytes/8) return false;
+
+    if(   cudaMalloc(&d.m_dLU, bytes)!=cudaSuccess
+       || cudaMalloc(reinterpret_cast<void**>(&d.m_dPiv), size_t(n)*sizeof(int))!=cudaSuccess
+       || cudaMalloc(reinterpret_cast<void**>(&d.m_dInfo), sizeof(int))!=cudaSuccess
+       || cudaMemcpy(d.m_dLU, A, bytes, cudaMemcpyHostToDevice)!=cudaSuccess)
+    {
+        if(d.m_dLU)   cudaFree(d.m_dLU);
+        if(d.m_dPiv)  cudaFree(d.m_dPiv);
+        if(d.m_dInfo) cudaFree(d.m_dInfo);
+        d.m_dLU = nullptr;
+        d.m_dPiv = nullptr;
+        d.m_dInfo = nullptr;
+        return false;
+    }
+    return true;
+#else
+    (void)A; (void)n; (void)bDouble;
+    return false;
+#endif
+}
+
+
+/**
+ * Factorizes the column-major matrix A of size n in double precision.
+ * @param LU the host array which receives the factors, as from LAPACK's dgetrf; may be the same as A
+ * @param ipiv the host array which receives the n pivot indices
+ * @return false if the device is not available, is out of memory, or if the matrix is singular.
+ */
+bool GpuSolver::factorize(double const *A, int n, double *LU, int *ipiv)
+{
+    release();
+    std::lock_guard<std::mutex> lock(m_Mutex);
+#ifdef FL5_CUDA
+    if(!isAvailable() || n<=0 || !upload(A, n, true)) return false;
+
+    DeviceData &d = *m_pData;
+    double *dA = static_cast<double*>(d.m_dLU);
+    int lwork = 0;
+    double *dWork = nullptr;
+    int info = -1;
+    bool bOk =    cusolverDnDgetrf_bufferSize(d.m_Handle, n, n, dA, n, &lwork)==CUSOLVER_STATUS_SUCCESS
+               && cudaMalloc(reinterpret_cast<void**>(&dWork), size_t(lwork)*sizeof(double))==cudaSuccess
+               && cusolverDnDgetrf(d.m_Handle, n, n, dA, n, dWork, d.m_dPiv, d.m_dInfo)==CUSOLVER_STATUS_SUCCESS
+               && cudaMemcpy(&info, d.m_dInfo, sizeof(int), cudaMemcpyDeviceToHost)==cudaSuccess
+               && info==0
+               && cudaMemcpy(LU, dA, size_t(n)*size_t(n)*sizeof(double), cudaMemcpyDeviceToHost)==cudaSuccess
+               && cudaMemcpy(ipiv, d.m_dPiv, size_t(n)*sizeof(int), cudaMemcpyDeviceToHost)==cudaSuccess;
+    if(dWork) cudaFree(dWork);
+
+    if(bOk)
+    {
+        m_N = n;
+        m_bDouble = true;
+    }
+    return bOk;
+#else
+    (void)A; (void)n; (void)LU; (void)ipiv;
+    return false;
+#endif
+}
+
+
+/** Factorizes the column-major matrix A of size n in single precision; @see factorize(double const*, int, double*, int*) */
+bool GpuSolver::factorize(float const *A, int n, float *LU, int *ipiv)
+{
+    release();
+    std::lock_guard<std::mutex> lock(m_Mutex);
+#ifdef FL5_CUDA
+    if(!isAvailable() || n<=0 || !upload(A, n, false)) return false;
+
+    DeviceData &d = *m_pData;
+    float *dA = static_cast<float*>(d.m_dLU);
+    int lwork = 0;
+    float *dWork = nullptr;
+    int info = -1;
+    bool bOk =    cusolverDnSgetrf_bufferSize(d.m_Handle, n, n, dA, n, &lwork)==CUSOLVER_STATUS_SUCCESS
+               && cudaMalloc(reinterpret_cast<void**>(&dWork), size_t(lwork)*sizeof(float))==cudaSuccess
+               && cusolverDnSgetrf(d.m_Handle, n, n, dA, n, dWork, d.m_dPiv, d.m_dInfo)==CUSOLVER_STATUS_SUCCESS
+               && cudaMemcpy(&info, d.m_dInfo, sizeof(int), cudaMemcpyDeviceToHost)==cudaSuccess
+               && info==0
+               && cudaMemcpy(LU, dA, size_t(n)*size_t(n)*sizeof(float), cudaMemcpyDeviceToHost)==cudaSuccess
+               && cudaMemcpy(ipiv, d.m_dPiv, size_t(n)*sizeof(int), cudaMemcpyDeviceToHost)==cudaSuccess;
+    if(dWork) cudaFree(dWork);
+
+    if(bOk)
+    {
+        m_N = n;
+        m_bDouble = false;
+    }
+    return bOk;
+#else
+    (void)A; (void)n; (void)LU; (void)ipiv;
+    return false;
+#endif
+}
+
+
+/**
+ * Back-substitutes the column-major block of nRHS vectors with the factors held on the device.
+ * With single precision factors, the RHS are rounded to single precision for the solve.
+ * @param trans 'N' or 'T', as for LAPACK's getrs
+ * @return false if no factors are held or if the solve failed, in which case B is unchanged.
+ */
+bool GpuSolver::solve(char trans, double *B, int nRHS)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+#ifdef FL5_CUDA
+    if(m_N<=0 || !B || nRHS<=0) return m_N>0;
+
+    DeviceData &d = *m_pData;
+    size_t count = size_t(m_N)*size_t(nRHS);
+    size_t bytes = count*(m_bDouble ? sizeof(double) : sizeof(float));
+    if(bytes>d.m_BBytes)
+    {
+        if(d.m_dB) cudaFree(d.m_dB);
+        d.m_dB = nullptr;
+        d.m_BBytes = 0;
+        if(cudaMalloc(&d.m_dB, bytes)!=cudaSuccess)
+        {
+            d.m_dB = nullptr;
+            return false;
+        }
+        d.m_BBytes = bytes;
+    }
+
+    cublasOperation_t op = (trans=='T' || trans=='t') ? CUBLAS_OP_T : CUBLAS_OP_N;
+    int info = -1;
+    if(m_bDouble)
+    {
+        bool bOk =    cudaMemcpy(d.m_dB, B, bytes, cudaMemcpyHostToDevice)==cudaSuccess
+                   && cusolverDnDgetrs(d.m_Handle, op, m_N, nRHS, static_cast<double const*>(d.m_dLU), m_N, d.m_dPiv,
+                                       static_cast<double*>(d.m_dB), m_N, d.m_dInfo)==CUSOLVER_STATUS_SUCCESS
+                   && cudaMemcpy(&info, d.m_dInfo, sizeof(int), cudaMemcpyDeviceToHost)==cudaSuccess
+                   && info==0;
+        return bOk && cudaMemcpy(B, d.m_dB, bytes, cudaMemcpyDeviceToHost)==cudaSuccess;
+    }
+    else
+    {
+        std::vector<float> fB(count);
+        for(size_t i=0; i<count; i++) fB[i] = float(B[i]);
+        bool bOk =    cudaMemcpy(d.m_dB, fB.data(), bytes, cudaMemcpyHostToDevice)==cudaSuccess
+                   && cusolverDnSgetrs(d.m_Handle, op, m_N, nRHS, static_cast<float const*>(d.m_dLU), m_N, d.m_dPiv,
+                                       static_cast<float*>(d.m_dB), m_N, d.m_dInfo)==CUSOLVER_STATUS_SUCCESS
+                   && cudaMemcpy(&info, d.m_dInfo, sizeof(int), cudaMemcpyDeviceToHost)==cudaSuccess
+                   && info==0
+                   && cudaMemcpy(fB.data(), d.m_dB, bytes, cudaMemcpyDeviceToHost)==cudaSuccess;
+        if(!bOk) return false;
+        for(size_t i=0; i<count; i++) B[i] = double(fB.at(i));
+        return true;
+    }
+#else
+    (void)trans; (void)B; (void)nRHS;
+    return false;
+#endif
+}
+
@@ -0,0 +1,106 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#include <influenceblockcache.h>
+
+
+std::list<InfluenceBlockCache::Entry> InfluenceBlockCache::s_Entries;
+std::mutex InfluenceBlockCache::s_Mutex;
+bool InfluenceBlockCache::s_bEnabled(true);
+double InfluenceBlockCache::s_MaxMemory(512.0);
+
+
+/**
+ * Copies the cached block of size n x n into the array if an entry matches the key.
+ * @return true if the block was found.
+ */
+bool InfluenceBlockCache::fetch(std::uint64_t key, int n, std::vector<double> &block)
+{
+    if(!s_bEnabled || key==0) return false;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    for(auto it=s_Entries.begin(); it!=s_Entries.end(); it++)
+    {
+        if(it->m_Key!=key || it->m_Size!=n) continue;
+
+        block = it->m_Block;
+        s_Entries.splice(s_Entries.begin(), s_Entries, it);
+        return true;
+    }
+    return false;
+}
+
+
+/**
+ * Adds a copy of the block to the cache, evicting the least recently used entries if necessary.
+ */
+void InfluenceBlockCache::store(std::uint64_t key, int n, std::vector<double> const &block)
+{
+    if(!s_bEnabled || key==0) return;
+    if(block.size()!=size_t(n)*size_t(n)) return;
+
+    size_t sz = block.size()*sizeof(double);
+    size_t maxsize = size_t(s_MaxMemory*1024.0*1024.0);
+    if(sz>maxsize) return;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    for(Entry const &entry : s_Entries)
+    {
+        if(entry.m_Key==key && entry.m_Size==n) return; // stored by a concurrent task
+    }
+
+    while(!s_Entries.empty() && totalSize()+sz>maxsize) s_Entries.pop_back();
+
+    s_Entries.emplace_front();
+    Entry &entry = s_Entries.front();
+    entry.m_Key   = key;
+    entry.m_Size  = n;
+    entry.m_Block = block;
+}
+
+
+void InfluenceBlockCache::clear()
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    s_Entries.clear();
+}
+
+
+/** @return the memory used by the cached blocks, in MB */
+double InfluenceBlockCache::memorySize()
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    return double(totalSize())/1024.0/1024.0;
+}
+
+
+size_t InfluenceBlockCache::totalSize()
+{
+    size_t sz = 0;
+    for(Entry const &entry : s_Entries) sz += entry.memorySize();
+    return sz;
+}
+
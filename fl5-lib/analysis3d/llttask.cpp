@@ -33,12 +33,15 @@
 
 
 #include <llttask.h>
+#include <convergencemonitor.h>
 
 #include <objects2d.h>
 #include <planeopp.h>
 #include <planepolar.h>
 #include <planexfl.h>
 #include <polar.h>
+#include <resultsink.h>
+#include <threadpool.h>
 #include <trace.h>
 #include <units.h>
 #include <wingxfl.h>
@@ -47,12 +50,15 @@ int LLTTask::s_IterLim = 100;
 int LLTTask::s_NLLTStations = 20;
 double LLTTask::s_RelaxMax = 20.0;
 double LLTTask::s_CvPrec = 0.01;
+bool LLTTask::s_bMultiThread = true;
 
 
 LLTTask::LLTTask()
 {
+    m_pPlane = nullptr;
     m_pWing = nullptr;
     m_pPlPolar = nullptr;
+    m_pMaster = nullptr;
 
     resetVariables();
 }
@@ -66,6 +72,7 @@ void LLTTask::resetVariables()
     m_bError = m_bWarning = false;
 
     m_QInf0 = 0.0;
+    m_QInfInit = 0.0;
 
     m_CL = 0.0;
     m_CDi = 0.0;
@@ -118,9 +125,6 @@ void LLTTask::resetVariables()
 
 void LLTTask::initializeVelocity(double alpha, double &QInf)
 {
-    Foil *pFoil0(nullptr), *pFoil1(nullptr);
-    double tau(0);
-
     switch (m_pPlPolar->type())
     {
         case xfl::T1POLAR:
@@ -134,11 +138,9 @@ void LLTTask::initializeVelocity(double alpha, double &QInf)
 
             for (int k=1; k<s_NLLTStations; k++)
             {
-                double yob   = cos(k*PI/s_NLLTStations);
-                m_pWing->getFoils(&pFoil0, &pFoil1, yob*m_pWing->planformSpan()/2.0, tau);
-                double alpha0 = Objects2d::getZeroLiftAngle(pFoil0, pFoil1, LARGEVALUE, tau);
+                double alpha0 = Objects2d::getZeroLiftAngle(m_Foil0.at(k), m_Foil1.at(k), LARGEVALUE, m_FoilTau.at(k));
                 double Cl = 2.0*PI*(alpha-alpha0+m_Twist.at(k))*PI/180.0;
-                Lift += Eta(k) * Cl * m_Chord.at(k) /m_pWing->planformSpan();
+                Lift += m_EtaCoef.at(k) * Cl * m_Chord.at(k) /m_pWing->planformSpan();
             }
             if(Lift<=0.0) return;
             QInf  = m_QInf0 / sqrt(Lift);
@@ -190,11 +192,60 @@ double LLTTask::Beta(int m, int k) const
 }
 
 
-void LLTTask::computeWing(double QInf, double Alpha, std::string &ErrMessage)
+/**
+ * Builds the tables which depend only on the geometry and on the number of stations:
+ * the influence coefficients Beta(m,k), the integration coefficients Eta(m) and Sigma(m),
+ * and the foils at each span station.
+ */
+void LLTTask::makeInfluenceTables()
 {
-    Foil* pFoil0(nullptr);
-    Foil* pFoil1(nullptr);
+    int n = s_NLLTStations+1;
+
+    m_BetaTable.resize(n*n);
+    m_EtaCoef.resize(n);
+    m_SigmaCoef.resize(n);
+    m_Foil0.resize(n);
+    m_Foil1.resize(n);
+    m_FoilTau.resize(n);
+
+    std::fill(m_BetaTable.begin(), m_BetaTable.end(), 0);
+
+    for (int k=1; k<s_NLLTStations; k++)
+    {
+        for (int m=1; m<s_NLLTStations; m++)
+            m_BetaTable[k*n+m] = Beta(m,k);
+    }
 
+    for (int m=0; m<n; m++)
+    {
+        m_EtaCoef[m]   = Eta(m);
+        m_SigmaCoef[m] = Sigma(m);
+
+        Foil *pFoil0(nullptr), *pFoil1(nullptr);
+        double tau(0);
+        double yob = cos(double(m)*PI/double(s_NLLTStations));
+        m_pWing->getFoils(&pFoil0, &pFoil1, yob*m_pWing->planformSpan()/2.0, tau);
+        m_Foil0[m] = pFoil0;
+        m_Foil1[m] = pFoil1;
+        m_FoilTau[m] = tau;
+    }
+}
+
+
+/** Interpolates the lift coefficients at all span stations from the foil polars */
+void LLTTask::makeStationCl(double Alpha)
+{
+    bool bOutRe(false), bError(false);
+    for (int k=1; k<s_NLLTStations; k++)
+    {
+        m_Cl[k] = Objects2d::getPlrPointFromAlpha(Polar::CL, m_Foil0.at(k), m_Foil1.at(k), m_Re.at(k),
+                                                  Alpha + m_Ai.at(k) + m_Twist.at(k), m_FoilTau.at(k), bOutRe, bError);
+    }
+}
+
+
+void LLTTask::computeWing(double QInf, double Alpha, std::string &ErrMessage)
+{
     QString ErrorMessage;
 
     double yob(0), tau(0), c4(0), zpos(0);
@@ -215,7 +266,9 @@ void LLTTask::computeWing(double QInf, double Alpha, std::string &ErrMessage)
         bPointOutRe    = false;
         bPointOutAlpha = false;
         yob   = cos(double(m)*PI/double(s_NLLTStations));
-        m_pWing->getFoils(&pFoil0, &pFoil1, yob*m_pWing->planformSpan()/2.0, tau);
+        Foil const *pFoil0 = m_Foil0.at(m);
+        Foil const *pFoil1 = m_Foil1.at(m);
+        tau = m_FoilTau.at(m);
 
         m_Cl[m]     = Objects2d::getPlrPointFromAlpha(Polar::CL, pFoil0, pFoil1, m_Re[m], Alpha+m_Ai[m]+m_Twist[m], tau, bOutRe, bError);
         if(bOutRe) bPointOutRe = true;
@@ -272,8 +325,8 @@ void LLTTask::computeWing(double QInf, double Alpha, std::string &ErrMessage)
 
         m_Cm[m] = Cm_i + Cm_v;                               // N.m/qSc
 
-        eta = Eta(m);
-        sigma = Sigma(m);
+        eta = m_EtaCoef.at(m);
+        sigma = m_SigmaCoef.at(m);
         Integral0           += eta   * m_Cl[m]  * m_Chord[m];
         Integral1           += sigma * m_Cl[m]  * m_Chord[m];
         Integral2           += eta   * m_Cl[m]  * m_Chord[m] * (m_Offset[m]+m_XCPSpanRel[m]*m_Chord[m]);
@@ -400,11 +453,9 @@ bool LLTTask::setLinearSolution(double Alpha)
     std::vector<double> aij(s_NLLTStations*s_NLLTStations, 0);
     std::vector<double> rhs(s_NLLTStations+1, 0);
 
-    Foil *pFoil0=nullptr, *pFoil1=nullptr;
-
     int size = s_NLLTStations-1;
     double dn  = double(s_NLLTStations);
-    double di(0), dj(0), t0(0), st0(0), snt0(0), ch(0), a0(0), slope(0), tau(0), yob(0), twist(0);
+    double di(0), dj(0), t0(0), st0(0), snt0(0), ch(0), a0(0), slope(0), yob(0), twist(0);
     double cs = m_pWing->rootChord();
     double b  = m_pWing->planformSpan();
     traceStdLog("Initializing linear solution\n\n");
@@ -428,8 +479,7 @@ bool LLTTask::setLinearSolution(double Alpha)
             aij[p] = snt0 + ch*PI/b/2.0* dj*snt0/st0;
         }
 
-        m_pWing->getFoils(&pFoil0, &pFoil1, yob*b/2.0, tau);
-        a0 = Objects2d::getZeroLiftAngle(pFoil0, pFoil1, m_Re[i], tau);
+        a0 = Objects2d::getZeroLiftAngle(m_Foil0.at(i), m_Foil1.at(i), m_Re[i], m_FoilTau.at(i));
         rhs[i] = ch/cs * (Alpha-a0+twist)/180.0*PI;
     }
 
@@ -452,9 +502,8 @@ bool LLTTask::setLinearSolution(double Alpha)
             snt0 = sin(dj*t0);
             m_Cl[i] += rhs[j]* snt0;
         }
-        m_pWing->getFoils(&pFoil0, &pFoil1, yob*b/2.0, tau);
-        Objects2d::getLinearizedPolar(pFoil0, pFoil1, m_Re[i], tau, a0, slope);
-        a0 = Objects2d::getZeroLiftAngle(pFoil0, pFoil1, m_Re[i], tau); //better approximation ?
+        Objects2d::getLinearizedPolar(m_Foil0.at(i), m_Foil1.at(i), m_Re[i], m_FoilTau.at(i), a0, slope);
+        a0 = Objects2d::getZeroLiftAngle(m_Foil0.at(i), m_Foil1.at(i), m_Re[i], m_FoilTau.at(i)); //better approximation ?
 
         m_Cl[i] *= slope*cs/m_pWing->getChord(yob);
         m_Ai[i]  = -(Alpha-a0+m_pWing->getTwist(yob)) + m_Cl[i]/slope*180.0/PI;
@@ -465,13 +514,16 @@ bool LLTTask::setLinearSolution(double Alpha)
 }
 
 
-double LLTTask::alphaInduced(int k) const
+/**
+ * @param ClChord the array of the products Cl.chord/span at the span stations
+ */
+double LLTTask::alphaInduced(int k, double const *ClChord) const
 {
+    double const *beta = m_BetaTable.data() + k*(s_NLLTStations+1);
     double ai = 0.0;
     for (int m=1; m<s_NLLTStations; m++)
     {
-        double b =  Beta(m,k);
-        ai += b * m_Cl.at(m) * m_Chord.at(m)/m_pWing->planformSpan();
+        ai += beta[m] * ClChord[m];
     }
     return ai;
 }
@@ -479,54 +531,46 @@ double LLTTask::alphaInduced(int k) const
 
 int LLTTask::iterate(double &QInf, double Alpha)
 {
-    Foil* pFoil0(nullptr);
-    Foil* pFoil1(nullptr);
-
-    bool bOutRe(false), bError(false);
-    double tau (0);
-
     double maxa(0);
+    std::vector<double> ClChord(s_NLLTStations+1, 0);
 
     int iter = 0;
     while(iter<s_IterLim)
     {
         maxa = 0.0;
+        double suma2 = 0.0;
+        int kmax = -1;
+
+        for (int m=1; m<s_NLLTStations; m++)
+            ClChord[m] = m_Cl.at(m) * m_Chord.at(m)/m_pWing->planformSpan();
 
         for (int k=1; k<s_NLLTStations; k++)
         {
             double a        = m_Ai[k];
-            double anext    = -alphaInduced(k);
+            double anext    = -alphaInduced(k, ClChord.data());
             m_Ai[k]  = a +(anext-a)/s_RelaxMax;
+            if(qAbs(a-anext)>maxa) kmax = k;
             maxa   = qMax(maxa, qAbs(a-anext));
+            suma2 += (a-anext)*(a-anext);
         }
 
-        double Lift=0.0;// required for Type 2
-        for (int k=1; k<s_NLLTStations; k++)
-        {
-            double yob = cos(double(k)*PI/double(s_NLLTStations));
-            m_pWing->getFoils(&pFoil0, &pFoil1, yob*m_pWing->planformSpan()/2.0, tau);
-            m_Cl[k] = Objects2d::getPlrPointFromAlpha(Polar::CL, pFoil0, pFoil1, m_Re.at(k), Alpha + m_Ai.at(k)+ m_Twist.at(k), tau, bOutRe, bError);
-            if (m_pPlPolar->isFixedLiftPolar())
-            {
-                Lift += Eta(k) * m_Cl.at(k) * m_Chord.at(k);
-            }
-        }
+        makeStationCl(Alpha);
 
         if(m_pPlPolar->isFixedLiftPolar())
         {
+            double Lift=0.0;// required for Type 2
+            for (int k=1; k<s_NLLTStations; k++)
+                Lift += m_EtaCoef.at(k) * m_Cl.at(k) * m_Chord.at(k);
+
             Lift *= m_pWing->aspectRatio() / m_pWing->planformSpan();
             if(Lift<=0.0)  return -1;
 
             QInf  = m_QInf0 / sqrt(Lift);
 
             for (int k=1; k<s_NLLTStations; k++)
-            {
                 m_Re[k] = m_Chord.at(k) * QInf /m_pPlPolar->viscosity();
 
-                double yob = cos(double(k)*PI/double(s_NLLTStations));
-                m_pWing->getFoils(&pFoil0, &pFoil1, yob*m_pWing->planformSpan()/2.0, tau);
-                m_Cl[k] = Objects2d::getPlrPointFromAlpha(Polar::CL, pFoil0, pFoil1, m_Re.at(k), Alpha + m_Ai.at(k)+ m_Twist.at(k), tau, bOutRe, bError);
-            }
+            makeStationCl(Alpha);
         }
 
         if (maxa<s_CvPrec)
@@ -538,9 +582,28 @@ int LLTTask::iterate(double &QInf, double Alpha)
         m_iter.push_back(iter);
         m_Max_a.push_back(maxa);
 
+        if(m_pConvergenceMonitor)
+        {
+            ResidualSample sample;
+            sample.m_Solver      = ResidualSample::LLT;
+            sample.m_Ctrl        = Alpha;
+            sample.m_Iter        = iter;
+            sample.m_Rms         = sqrt(suma2/double(std::max(1, s_NLLTStations-1)));
+            sample.m_Max         = maxa;
+            sample.m_MaxLocation = kmax;
+            sample.m_Relax       = 1.0/s_RelaxMax;
+            if(m_pConvergenceMonitor->onIteration(sample)!=ConvergenceMonitor::CONTINUE)
+            {
+                iter = s_IterLim; // reported as unconverged
+                break;
+            }
+        }
+
         iter++;
         if(isCancelled()) return -1;
     }
+
+    if(m_pConvergenceMonitor) m_pConvergenceMonitor->onPointEnd(ResidualSample::LLT, Alpha, m_bConverged, iter);
     return iter;
 }
 
@@ -571,11 +634,15 @@ void LLTTask::initializeGeom()
 
         m_StripArea[j] = m_Chord[j]*dy;//m2
     }
+
+    makeInfluenceTables();
 }
 
 
 void LLTTask::run()
 {
+    ScopedStore scope(m_pStore);
+
     if (!m_pPlPolar->isFixedaoaPolar())
     {
         alphaLoop();
@@ -591,17 +658,106 @@ void LLTTask::run()
 }
 
 
+/**
+ * Runs the sweep over the list of operating points.
+ * If multithreading is enabled, the list is split into contiguous sub-ranges which are
+ * evaluated concurrently by worker tasks; each sub-range starts from the linear solution,
+ * and each of its points is then seeded from the previous converged point.
+ * The results are added to the polar in the order of the sweep once all sub-ranges have completed.
+ */
 bool LLTTask::alphaLoop()
 {
-    QString strange;
-    double yob(0), tau(0);
-    Foil *pFoil0(nullptr), *pFoil1(nullptr);
-    bool bOutRe(false), bError(false);
+    xfl::trace("LLTTask::alphaloop\n");
 
-    bool s_bInitCalc = true;
+    int nAlpha = int(m_AoAList.size());
+    int nThreads = m_nThreads>0 ? std::min(m_nThreads, ThreadPool::maxThreadCount()) : ThreadPool::maxThreadCount();
+    int nRanges = s_bMultiThread ? std::min(nAlpha, nThreads) : 1;
 
-    xfl::trace("LLTTask::alphaloop\n");
+    if(nRanges<=1)
+    {
+        sweep();
+        return true;
+    }
 
+    std::vector<LLTTask*> workers(nRanges);
+    for(int ir=0; ir<nRanges; ir++)
+    {
+        workers[ir] = new LLTTask;
+        workers[ir]->copySetup(this);
+        int iStart = ir*nAlpha/nRanges;
+        int iEnd   = (ir+1)*nAlpha/nRanges;
+        workers[ir]->m_AoAList.assign(m_AoAList.begin()+iStart, m_AoAList.begin()+iEnd);
+    }
+
+    ThreadPool::pool().parallelFor(nRanges, [&workers](int ir){workers[ir]->sweep();});
+
+    for(int ir=0; ir<nRanges; ir++)
+    {
+        LLTTask *pWorker = workers[ir];
+        if(pWorker->m_bError)   m_bError   = true;
+        if(pWorker->m_bWarning) m_bWarning = true;
+
+        for(PlaneOpp *pPOpp : pWorker->m_PlaneOppList)
+        {
+            if(!pPOpp->isOut()) // discard failed visc interpolated opps
+                m_pPlPolar->addPlaneOpPointData(pPOpp);
+
+            if(m_pResultSink) m_pResultSink->addPlaneOpp(pPOpp);
+
+            if(m_bKeepOpps) m_PlaneOppList.push_back(pPOpp);
+            else            delete pPOpp;
+        }
+        pWorker->m_PlaneOppList.clear();
+    }
+
+    m_pPlPolar->setVelocity(workers.back()->m_QInfInit);
+
+    for(int ir=0; ir<nRanges; ir++) delete workers[ir];
+
+    return true;
+}
+
+
+/**
+ * Copies the geometry and the influence tables of the master task, so that this task
+ * can evaluate a sub-range of the master's operating points.
+ */
+void LLTTask::copySetup(LLTTask *pMaster)
+{
+    m_pMaster   = pMaster;
+    m_pPlane    = pMaster->m_pPlane;
+    m_pWing     = pMaster->m_pWing;
+    m_pPlPolar  = pMaster->m_pPlPolar;
+    m_QInf0     = pMaster->m_QInf0;
+
+    m_Chord     = pMaster->m_Chord;
+    m_Offset    = pMaster->m_Offset;
+    m_Twist     = pMaster->m_Twist;
+    m_SpanPos   = pMaster->m_SpanPos;
+    m_StripArea = pMaster->m_StripArea;
+
+    m_BetaTable = pMaster->m_BetaTable;
+    m_EtaCoef   = pMaster->m_EtaCoef;
+    m_SigmaCoef = pMaster->m_SigmaCoef;
+    m_Foil0     = pMaster->m_Foil0;
+    m_Foil1     = pMaster->m_Foil1;
+    m_FoilTau   = pMaster->m_FoilTau;
+
+    m_pConvergenceMonitor = pMaster->m_pConvergenceMonitor;
+}
+
+
+/**
+ * Calculates the operating points of m_AoAList in sequence.
+ * A worker task does not modify the polar; it stores its operating points in m_PlaneOppList
+ * for the master task to insert.
+ */
+void LLTTask::sweep()
+{
+    QString strange;
+
+    bool s_bInitCalc = true;
+    m_QInfInit = m_pPlPolar->velocity();
 
     for (int i=0; i<int(m_AoAList.size()); i++)
     {
@@ -618,18 +774,12 @@ bool LLTTask::alphaLoop()
 
         if(s_bInitCalc)
         {
-            double V;
-            initializeVelocity(alpha, V);
-            m_pPlPolar->setVelocity(V);
+            initializeVelocity(alpha, m_QInfInit);
+            if(!m_pMaster) m_pPlPolar->setVelocity(m_QInfInit);
             setLinearSolution(alpha);
         }
         //initialize first iteration
-        for (int k=1; k<s_NLLTStations; k++)
-        {
-            yob   = cos(k*PI/s_NLLTStations);
-            m_pWing->getFoils(&pFoil0, &pFoil1, yob*m_pWing->planformSpan()/2.0, tau);
-            m_Cl[k] = Objects2d::getPlrPointFromAlpha(Polar::CL, pFoil0, pFoil1, m_Re[k], alpha + m_Ai[k] + m_Twist[k], tau, bOutRe, bError);
-        }
+        makeStationCl(alpha);
 
 
         xfl::trace("LLTTask::alphaloop - 1\n");
@@ -637,7 +787,7 @@ bool LLTTask::alphaLoop()
         strange = "Calculating " + ALPHAch + QString::asprintf(" = %5.2f", alpha) + DEGch + "...";
         traceLog(strange);
 
-        double QInf = m_pPlPolar->velocity();
+        double QInf = m_QInfInit;
         int iter = iterate(QInf, alpha);
 
         if (iter==-1 && !isCancelled())
@@ -654,7 +804,7 @@ bool LLTTask::alphaLoop()
             traceOpp(alpha, m_Max_a, strange.toStdString());
 
             std::string str;
-            computeWing(m_pPlPolar->velocity(), alpha, str);// generates wing results,
+            computeWing(m_QInfInit, alpha, str);// generates wing results,
             traceStdLog(str);
             if (m_bWingOut) m_bWarning = true;
             PlaneOpp *pPOpp = createPlaneOpp(QInf, alpha, m_bWingOut);// Adds WOpp point and adds result to polar
@@ -663,11 +813,17 @@ bool LLTTask::alphaLoop()
             xfl::trace("LLTTask::alphaloop -2 \n");
 
             // store the results
-            if(pPOpp)
+            if(pPOpp && m_pMaster)
+            {
+                m_PlaneOppList.push_back(pPOpp);
+            }
+            else if(pPOpp)
             {
                 if(!pPOpp->isOut()) // discard failed visc interpolated opps
                     m_pPlPolar->addPlaneOpPointData(pPOpp);
 
+                if(m_pResultSink) m_pResultSink->addPlaneOpp(pPOpp);
+
                 if(m_bKeepOpps)
                 {
                     m_PlaneOppList.push_back(pPOpp);
@@ -694,8 +850,6 @@ bool LLTTask::alphaLoop()
         xfl::trace("LLTTask::alphaloop - 3\n");
 
     }
-
-    return true;
 }
 
 
@@ -853,8 +1007,8 @@ PlaneOpp* LLTTask::createPlaneOpp(double QInf, double Alpha, bool bWingOut)
     mainwopp.m_MaxBending = Cb;
 
 
-    //add the data to the polar object
-    if(!pNewPOpp->m_bOut)
+    //add the data to the polar object; a worker task leaves the insertion to its master
+    if(!m_pMaster && !pNewPOpp->m_bOut)
         m_pPlPolar->addPlaneOpPointData(pNewPOpp);
 
     return pNewPOpp;
@@ -863,6 +1017,12 @@ PlaneOpp* LLTTask::createPlaneOpp(double QInf, double Alpha, bool bWingOut)
 
 void LLTTask::traceOpp(double alpha, std::vector<double>const &max_a, std::string const &msg)
 {
+    if(m_pMaster)
+    {
+        m_pMaster->traceOpp(alpha, max_a, msg);
+        return;
+    }
+
     LLTOppReport oppreport(alpha, max_a, msg);
 
     // Access the Q under the lock:
@@ -877,6 +1037,12 @@ void LLTTask::traceLog(QString const &str) {traceStdLog(str.toStdString());}
 
 void LLTTask::traceStdLog(std::string const &str)
 {
+    if(m_pMaster)
+    {
+        m_pMaster->traceStdLog(str);
+        return;
+    }
+
     LLTOppReport oppreport(0, std::vector<double>(), str); // only interested in the message
 
     // Access the Q under the lock:
@@ -0,0 +1,127 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+
+#include <lucache.h>
+
+
+std::list<LUCache::Entry> LUCache::s_Entries;
+std::mutex LUCache::s_Mutex;
+bool LUCache::s_bEnabled(true);
+double LUCache::s_MaxMemory(1024.0);
+
+
+/**
+ * Copies the cached factorization into the arrays if an entry matches the key.
+ * The arrays must have been allocated with the size of the stored arrays.
+ * @return true if the factorization was found.
+ */
+bool LUCache::fetch(std::uint64_t key, int n, bool bDouble, double *aijd, size_t nd, float *aijf, size_t nf, std::vector<int> &ipiv)
+{
+    if(!s_bEnabled || key==0) return false;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    for(auto it=s_Entries.begin(); it!=s_Entries.end(); it++)
+    {
+        if(it->m_Key!=key || it->m_Size!=n || it->m_bDouble!=bDouble) continue;
+        if(it->m_aijd.size()!=nd || it->m_aijf.size()!=nf) continue;
+
+        // both arrays are stored in mixed precision mode
+        std::copy(it->m_aijd.begin(), it->m_aijd.end(), aijd);
+        std::copy(it->m_aijf.begin(), it->m_aijf.end(), aijf);
+        ipiv = it->m_ipiv;
+
+        s_Entries.splice(s_Entries.begin(), s_Entries, it);
+        return true;
+    }
+    return false;
+}
+
+
+/**
+ * Adds a copy of the factorization to the cache, evicting the least recently used entries if necessary.
+ */
+void LUCache::store(std::uint64_t key, int n, bool bDouble, double const *aijd, size_t nd, float const *aijf, size_t nf, std::vector<int> const &ipiv)
+{
+    if(!s_bEnabled || key==0) return;
+
+    size_t sz = nd*sizeof(double) + nf*sizeof(float) + ipiv.size()*sizeof(int);
+    size_t maxsize = size_t(s_MaxMemory*1024.0*1024.0);
+    if(sz>maxsize) return;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    for(Entry const &entry : s_Entries)
+    {
+        if(entry.m_Key==key && entry.m_Size==n && entry.m_bDouble==bDouble) return; // stored by a concurrent task
+    }
+
+    while(!s_Entries.empty() && totalSize()+sz>maxsize) s_Entries.pop_back();
+
+    s_Entries.emplace_front();
+    Entry &entry = s_Entries.front();
+    entry.m_Key     = key;
+    entry.m_Size    = n;
+    entry.m_bDouble = bDouble;
+    entry.m_aijd.assign(aijd, aijd+nd);
+    entry.m_aijf.assign(aijf, aijf+nf);
+    entry.m_ipiv = ipiv;
+}
+
+
+void LUCache::clear()
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    s_Entries.clear();
+}
+
+
+/** @return the memory used by the cached factorizations, in MB */
+double LUCache::memorySize()
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    return double(totalSize())/1024.0/1024.0;
+}
+
+
+size_t LUCache::totalSize()
+{
+    size_t sz = 0;
+    for(Entry const &entry : s_Entries) sz += entry.memorySize();
+    return sz;
+}
+
+
+/** FNV-1a hash of the bytes, accumulated in h */
+void LUCache::hash(std::uint64_t &h, void const *data, size_t nBytes)
+{
+    unsigned char const *p = static_cast<unsigned char const*>(data);
+    for(size_t i=0; i<nBytes; i++)
+    {
+        h ^= std::uint64_t(p[i]);
+        h *= 1099511628211ULL;
+    }
+}
+
@@ -0,0 +1,327 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <neuralfoilnet.h>
+#include <matrix.h>
+
+
+std::string NeuralFoilNet::s_ModelDir;
+std::map<std::string, std::shared_ptr<NeuralFoilNet const>> NeuralFoilNet::s_Models;
+std::mutex NeuralFoilNet::s_Mutex;
+
+
+/** the number of operating points evaluated in one pass, to bound the size of the work arrays */
+static int const s_BatchSize = 1024;
+
+
+/**
+ * Reads the network from a file written by neuralfoil_bridge.export_native_model().
+ * Layout, little-endian: "NFNN", int32 version, int32 number of layers, then for each layer
+ * int32 n_out, int32 n_in, float64 weights[n_out][n_in], float64 biases[n_out].
+ */
+bool NeuralFoilNet::load(std::string const &filename, std::string &error)
+{
+    m_Layers.clear();
+
+    std::ifstream file(filename, std::ios::binary);
+    if(!file)
+    {
+        error = "could not open " + filename;
+        return false;
+    }
+
+    char magic[4];
+    int32_t version=0, nLayers=0;
+    file.read(magic, 4);
+    file.read(reinterpret_cast<char*>(&version), sizeof(int32_t));
+    file.read(reinterpret_cast<char*>(&nLayers), sizeof(int32_t));
+    if(!file || std::memcmp(magic, "NFNN", 4)!=0 || version!=1 || nLayers<=0)
+    {
+        error = filename + " is not a NeuralFoil model file";
+        return false;
+    }
+
+    std::vector<Layer> layers(nLayers);
+    std::vector<double> w;
+    for(int l=0; l<nLayers; l++)
+    {
+        int32_t nOut=0, nIn=0;
+        file.read(reinterpret_cast<char*>(&nOut), sizeof(int32_t));
+        file.read(reinterpret_cast<char*>(&nIn),  sizeof(int32_t));
+        if(!file || nOut<=0 || nIn<=0 || (l>0 && nIn!=layers[l-1].m_nOut))
+        {
+            error = "inconsistent layer dimensions in " + filename;
+            return false;
+        }
+
+        Layer &layer = layers[l];
+        layer.m_nIn  = nIn;
+        layer.m_nOut = nOut;
+        w.resize(size_t(nOut)*size_t(nIn));
+        layer.m_Bias.resize(nOut);
+        file.read(reinterpret_cast<char*>(w.data()), std::streamsize(w.size()*sizeof(double)));
+        file.read(reinterpret_cast<char*>(layer.m_Bias.data()), std::streamsize(nOut*sizeof(double)));
+        if(!file)
+        {
+            error = filename + " is truncated";
+            return false;
+        }
+
+        // stored transposed so that a batch is multiplied on the right in row-major order
+        layer.m_Wt.resize(w.size());
+        for(int o=0; o<nOut; o++)
+            for(int i=0; i<nIn; i++)
+                layer.m_Wt[size_t(i)*nOut+o] = w[size_t(o)*nIn+i];
+    }
+
+    if(layers.front().m_nIn!=NINPUTS || layers.back().m_nOut<6)
+    {
+        error = filename + ": unexpected number of inputs or outputs";
+        return false;
+    }
+
+    m_Layers = std::move(layers);
+    return true;
+}
+
+
+/**
+ * Runs the network on the rows of x, in place.
+ * On input x holds nRows of NINPUTS values; on output nRows of the last layer's outputs.
+ */
+void NeuralFoilNet::forward(std::vector<double> &x, int nRows) const
+{
+    std::vector<double> y;
+    for(size_t l=0; l<m_Layers.size(); l++)
+    {
+        Layer const &layer = m_Layers.at(l);
+        y.resize(size_t(nRows)*layer.m_nOut);
+        matrix::matMultLAPACK(x.data(), layer.m_Wt.data(), y.data(), nRows, layer.m_nIn, layer.m_nOut, 1);
+
+        bool bLast = (l==m_Layers.size()-1);
+        for(int r=0; r<nRows; r++)
+        {
+            double *row = y.data() + size_t(r)*layer.m_nOut;
+            for(int o=0; o<layer.m_nOut; o++)
+            {
+                double v = row[o] + layer.m_Bias[o];
+                row[o] = bLast ? v : v/(1.0+std::exp(-v)); // swish activation
+            }
+        }
+        x.swap(y);
+    }
+}
+
+
+/**
+ * Evaluates the points; the foils are referenced by their index in the array of Kulfan parameters.
+ * The results are in the order of the points.
+ */
+void NeuralFoilNet::evaluate(std::vector<KulfanParams> const &foils, std::vector<Point> const &points, std::vector<Result> &results) const
+{
+    results.resize(points.size());
+    if(!isLoaded()) return;
+
+    int nOut = m_Layers.back().m_nOut;
+    std::vector<double> x;
+
+    for(int start=0; start<int(points.size()); start+=s_BatchSize)
+    {
+        int nPts = std::min(s_BatchSize, int(points.size())-start);
+
+        // the rows [0, nPts[ are the points, the rows [nPts, 2*nPts[ their mirror images
+        x.resize(size_t(2*nPts)*NINPUTS);
+        for(int p=0; p<nPts; p++)
+        {
+            Point const &pt = points.at(start+p);
+            KulfanParams const &k = foils.at(pt.m_iFoil);
+            double *row = x.data() + size_t(p)*NINPUTS;
+            double *flip = x.data() + size_t(nPts+p)*NINPUTS;
+
+            double sa = std::sin(pt.m_Alpha*M_PI/180.0);
+            double ca = std::cos(pt.m_Alpha*M_PI/180.0);
+            double flow[7] = {2.0*sa*ca, ca, 1.0-ca*ca, (std::log(pt.m_Re)-12.5)/3.5, (pt.m_NCrit-9.0)/4.5, pt.m_XTrTop, pt.m_XTrBot};
+
+            for(int i=0; i<NWEIGHTS; i++)
+            {
+                row[i]           =  k[i];
+                row[NWEIGHTS+i]  =  k[NWEIGHTS+i];
+                flip[i]          = -k[NWEIGHTS+i];
+                flip[NWEIGHTS+i] = -k[i];
+            }
+            row[2*NWEIGHTS]    =  k[2*NWEIGHTS];
+            flip[2*NWEIGHTS]   = -k[2*NWEIGHTS];
+            row[2*NWEIGHTS+1]  = flip[2*NWEIGHTS+1] = k[2*NWEIGHTS+1]*50.0;
+
+            for(int i=0; i<7; i++) row[NKULFAN+i] = flip[NKULFAN+i] = flow[i];
+            flip[NKULFAN]   = -flow[0];
+            flip[NKULFAN+5] =  flow[6];
+            flip[NKULFAN+6] =  flow[5];
+        }
+
+        forward(x, 2*nPts);
+
+        for(int p=0; p<nPts; p++)
+        {
+            double const *y  = x.data() + size_t(p)*nOut;
+            double const *yf = x.data() + size_t(nPts+p)*nOut;
+
+            // the mirror image has opposite lift and moment, and its upper and lower sides are swapped
+            double conf = (y[0] + yf[0])/2.0;
+            double cl   = (y[1] - yf[1])/2.0;
+            double lncd = (y[2] + yf[2])/2.0;
+            double cm   = (y[3] - yf[3])/2.0;
+            double xtop = (y[4] + yf[5])/2.0;
+            double xbot = (y[5] + yf[4])/2.0;
+
+            Result &res = results[start+p];
+            res.m_Confidence = 1.0/(1.0+std::exp(-conf));
+            res.m_Cl     = cl/2.0;
+            res.m_Cd     = std::exp((lncd-2.0)*2.0);
+            res.m_Cm     = cm/20.0;
+            res.m_XTrTop = std::clamp(xtop, 0.0, 1.0);
+            res.m_XTrBot = std::clamp(xbot, 0.0, 1.0);
+        }
+    }
+}
+
+
+/**
+ * Fits the Kulfan parameters of the foil by linear least squares.
+ * The nodes are ordered from the trailing edge along the upper surface to the trailing edge along
+ * the lower surface; they are first normalized so that the leading edge is at (0,0) and the
+ * trailing edge at (1,0).
+ * Each surface is y = C(x).S(x) + w_LE.x.(1-x)^(n+0.5) +/- x.t_TE/2 with the class function
+ * C(x) = x^0.5.(1-x) and S(x) a Bernstein polynomial of the side's weights.
+ */
+bool NeuralFoilNet::kulfanParameters(std::vector<double> const &x, std::vector<double> const &y, KulfanParams &kulfan)
+{
+    int n = int(std::min(x.size(), y.size()));
+    if(n<NKULFAN) return false;
+
+    int iLE = int(std::min_element(x.begin(), x.begin()+n) - x.begin());
+    double xle = x[iLE], yle = y[iLE];
+    double xte = (x.front()+x[n-1])/2.0,  yte = (y.front()+y[n-1])/2.0;
+    double chord = std::sqrt((xte-xle)*(xte-xle) + (yte-yle)*(yte-yle));
+    if(chord<1.0e-12) return false;
+    double cs = (xte-xle)/chord, sn = (yte-yle)/chord;
+
+    double binom[NWEIGHTS];
+    for(int i=0; i<NWEIGHTS; i++)
+    {
+        binom[i] = 1.0;
+        for(int j=1; j<=i; j++) binom[i] = binom[i]*double(NWEIGHTS-j)/double(j);
+    }
+
+    std::vector<double> ATA(NKULFAN*NKULFAN, 0.0);
+    double ATb[NKULFAN] = {0};
+    double row[NKULFAN];
+
+    for(int p=0; p<n; p++)
+    {
+        double dx = x[p]-xle, dy = y[p]-yle;
+        double xn = std::clamp(( dx*cs + dy*sn)/chord, 0.0, 1.0);
+        double yn =            (-dx*sn + dy*cs)/chord;
+        bool bUpper = p<iLE || (p==iLE && yn>=0.0);
+
+        std::fill(row, row+NKULFAN, 0.0);
+        double C = std::sqrt(xn)*(1.0-xn);
+        int offset = bUpper ? 0 : NWEIGHTS;
+        for(int i=0; i<NWEIGHTS; i++)
+            row[offset+i] = C * binom[i] * std::pow(xn, i) * std::pow(1.0-xn, NWEIGHTS-1-i);
+        row[2*NWEIGHTS]   = xn * std::pow(1.0-xn, NWEIGHTS+0.5);
+        row[2*NWEIGHTS+1] = bUpper ? xn/2.0 : -xn/2.0;
+
+        for(int i=0; i<NKULFAN; i++)
+        {
+            ATb[i] += row[i]*yn;
+            for(int j=0; j<NKULFAN; j++) ATA[i*NKULFAN+j] += row[i]*row[j];
+        }
+    }
+
+    // slight regularization for the foils with too few nodes near the leading edge
+    for(int i=0; i<NKULFAN; i++) ATA[i*NKULFAN+i] += 1.0e-9;
+
+    std::vector<double> L(NKULFAN*NKULFAN);
+    matrix::CholevskiFactor(ATA.data(), L.data(), NKULFAN);
+    if(!matrix::CholevskiSolve(L.data(), ATb, NKULFAN)) return false;
+
+    for(int i=0; i<NKULFAN; i++)
+    {
+        if(!std::isfinite(ATb[i])) return false;
+        kulfan[i] = ATb[i];
+    }
+    kulfan[2*NWEIGHTS+1] = std::max(kulfan[2*NWEIGHTS+1], 0.0);
+    return true;
+}
+
+
+std::string NeuralFoilNet::modelFileName(std::string const &modelsize)
+{
+    std::string dir = s_ModelDir;
+    if(dir.empty())
+    {
+        // same default location as the Python bridge
+        char const *home = std::getenv("HOME");
+        dir = std::string(home ? home : "/home") + "/Loftimizer-V2/flow5/fl5-lib/python/models";
+    }
+    return (std::filesystem::path(dir) / ("nn-" + modelsize + ".fl5nn")).string();
+}
+
+
+void NeuralFoilNet::setModelDirectory(std::string const &dir)
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    s_ModelDir = dir;
+    s_Models.clear();
+}
+
+
+/**
+ * @return the network of the given size, read from its file on first use, or nullptr if the file
+ * could not be read; a failed read is retried on the next call, e.g. after the model has been exported.
+ */
+std::shared_ptr<NeuralFoilNet const> NeuralFoilNet::model(std::string const &modelsize)
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    auto it = s_Models.find(modelsize);
+    if(it!=s_Models.end()) return it->second;
+
+    std::shared_ptr<NeuralFoilNet> pNet = std::make_shared<NeuralFoilNet>();
+    std::string error;
+    if(!pNet->load(modelFileName(modelsize), error)) return nullptr;
+
+    s_Models[modelsize] = pNet;
+    return pNet;
+}
+
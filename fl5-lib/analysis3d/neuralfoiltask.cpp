@@ -22,6 +22,7 @@
 
 ****************************************************************************/
 
+#ifdef NEURALFOIL_PYTHON
 // CRITICAL: Python.h must be included FIRST before any other headers.
 // This is required by the Python C API documentation.
 #define PY_SSIZE_T_CLEAN
@@ -34,17 +35,23 @@
 
 #include <pybind11/embed.h>
 #include <pybind11/stl.h>
+#endif
 
 #include <neuralfoiltask.h>
+#include <neuralfoilnet.h>
 #include <foil.h>
+#include <objects2d.h>
 #include <polar.h>
 
 #include <iostream>
 #include <mutex>
 #include <algorithm>
 #include <cmath>
+#include <set>
 
+#ifdef NEURALFOIL_PYTHON
 namespace py = pybind11;
+#endif
 
 bool NeuralFoilTask::s_bPythonInitialized = false;
 
@@ -98,6 +105,9 @@ NeuralFoilModelSize NeuralFoilTask::stringToModelSize(std::string const &str)
 
 bool NeuralFoilTask::ensurePythonReady()
 {
+#ifndef NEURALFOIL_PYTHON
+    return false;
+#else
     std::lock_guard<std::mutex> lock(s_pythonMutex);
     
     if (s_bPythonInitialized) return true;
@@ -133,6 +143,60 @@ bool NeuralFoilTask::ensurePythonReady()
     std::cerr << "[NeuralFoil] Python initialized with GIL released" << std::endl;
     
     return true;
+#endif
+}
+
+
+bool NeuralFoilTask::exportNativeModel(std::string const &modelStr)
+{
+#ifndef NEURALFOIL_PYTHON
+    (void)modelStr;
+    return false;
+#else
+    // one attempt per model size and session
+    static std::set<std::string> s_attempted;
+    static std::mutex s_exportMutex;
+    {
+        std::lock_guard<std::mutex> lock(s_exportMutex);
+        if (!s_attempted.insert(modelStr).second) return false;
+    }
+
+    if (!ensurePythonReady()) return false;
+
+    std::string filename = NeuralFoilNet::modelFileName(modelStr);
+
+    PyGILState_STATE gstate = PyGILState_Ensure();
+    bool success = false;
+    try {
+        py::module_ bridge = py::module_::import("neuralfoil_bridge");
+        py::dict result = bridge.attr("export_native_model")(modelStr, filename);
+        success = result["success"].cast<bool>();
+        if (!success) {
+            std::cerr << "[NeuralFoil] Model export failed: " << result["error"].cast<std::string>() << std::endl;
+        }
+        else {
+            std::cerr << "[NeuralFoil] Exported the " << modelStr << " model to " << filename << std::endl;
+        }
+    }
+    catch (const std::exception &e) {
+        std::cerr << "[NeuralFoil] Model export error: " << e.what() << std::endl;
+        success = false;
+    }
+    PyGILState_Release(gstate);
+
+    return success;
+#endif
+}
+
+
+std::shared_ptr<NeuralFoilNet const> NeuralFoilTask::nativeModel(NeuralFoilModelSize size)
+{
+    std::string modelStr = modelSizeToString(size);
+    std::shared_ptr<NeuralFoilNet const> pNet = NeuralFoilNet::model(modelStr);
+    if (!pNet && exportNativeModel(modelStr)) {
+        pNet = NeuralFoilNet::model(modelStr);
+    }
+    return pNet;
 }
 
 
@@ -165,17 +229,27 @@ bool NeuralFoilTask::initialize(Foil const &foil, Polar *pPolar)
 
 bool NeuralFoilTask::processClList()
 {
+    if (!m_pPolar) {
+        std::cerr << "[NeuralFoil] No polar set" << std::endl;
+        return false;
+    }
+
+    // Use the native kernel if the model is available, else the Python bridge
+    std::shared_ptr<NeuralFoilNet const> pNet = nativeModel(m_modelSize);
+    if (pNet) {
+        return processClListNative(*pNet);
+    }
+
+#ifndef NEURALFOIL_PYTHON
+    std::cerr << "[NeuralFoil] Model file not found: " << NeuralFoilNet::modelFileName(modelSizeToString(m_modelSize)) << std::endl;
+    return false;
+#else
     // Ensure Python is initialized (lazy init, happens once)
     if (!ensurePythonReady()) {
         std::cerr << "[NeuralFoil] Failed to initialize Python" << std::endl;
         return false;
     }
     
-    if (!m_pPolar) {
-        std::cerr << "[NeuralFoil] No polar set" << std::endl;
-        return false;
-    }
-    
     // Use PyGILState API - this properly acquires the GIL from any thread
     // and releases it when gstate goes out of scope
     PyGILState_STATE gstate = PyGILState_Ensure();
@@ -226,6 +300,7 @@ bool NeuralFoilTask::processClList()
                 m_pPolar->m_XTrBot[i] = xtrBotValues[i];
                 m_pPolar->m_Control[i] = 1.0;  // Mark as converged
             }
+            m_pPolar->setDataModified();
         }
     }
     catch (const py::error_already_set &e) {
@@ -245,6 +320,79 @@ bool NeuralFoilTask::processClList()
     PyGILState_Release(gstate);
     
     return success;
+#endif
+}
+
+
+bool NeuralFoilTask::processClListNative(NeuralFoilNet const &net)
+{
+    std::vector<NeuralFoilNet::KulfanParams> foils(1);
+    if (!NeuralFoilNet::kulfanParameters(m_x, m_y, foils.front())) {
+        std::cerr << "[NeuralFoil] Could not fit the Kulfan parameters of the foil" << std::endl;
+        return false;
+    }
+
+    int n = m_pPolar->dataSize();
+
+    // Same search as the Python bridge, but all the stations are evaluated at once per iteration,
+    // and the Cl slope is updated by secant with the previous iterate
+    std::vector<double> alpha(n), prevAlpha(n, 0.0), prevCl(n, 0.0);
+    std::vector<bool> bHasPrev(n, false);
+    std::vector<NeuralFoilNet::Result> lastResults(n);
+    for (int i = 0; i < n; i++) {
+        alpha[i] = std::clamp(m_pPolar->m_Cl.at(i) * 10.0, -20.0, 20.0);
+    }
+
+    std::vector<int> active(n);
+    for (int i = 0; i < n; i++) active[i] = i;
+
+    std::vector<NeuralFoilNet::Point> pts;
+    std::vector<NeuralFoilNet::Result> res;
+
+    for (int iteration = 0; iteration < 20 && !active.empty(); iteration++) {
+        pts.resize(active.size());
+        for (size_t j = 0; j < active.size(); j++) {
+            int i = active[j];
+            pts[j].m_iFoil  = 0;
+            pts[j].m_Alpha  = alpha[i];
+            pts[j].m_Re     = m_pPolar->m_Re.at(i);
+            pts[j].m_NCrit  = m_NCrit;
+            pts[j].m_XTrTop = m_XTrTop;
+            pts[j].m_XTrBot = m_XTrBot;
+        }
+        net.evaluate(foils, pts, res);
+
+        std::vector<int> next;
+        for (size_t j = 0; j < active.size(); j++) {
+            int i = active[j];
+            lastResults[i] = res[j];
+            double clError = m_pPolar->m_Cl.at(i) - res[j].m_Cl;
+            if (std::abs(clError) < 0.001) continue; // converged
+
+            double slope = 0.1; // ~0.1 Cl per degree
+            if (bHasPrev[i] && std::abs(alpha[i] - prevAlpha[i]) > 1.0e-6) {
+                double s = (res[j].m_Cl - prevCl[i]) / (alpha[i] - prevAlpha[i]);
+                if (s > 0.02 && s < 0.2) slope = s;
+            }
+            prevAlpha[i] = alpha[i];
+            prevCl[i]    = res[j].m_Cl;
+            bHasPrev[i]  = true;
+
+            alpha[i] = std::clamp(alpha[i] + clError / slope, -20.0, 20.0);
+            next.push_back(i);
+        }
+        active.swap(next);
+    }
+
+    for (int i = 0; i < n; i++) {
+        m_pPolar->m_Cd[i] = lastResults[i].m_Cd;
+        m_pPolar->m_Cl[i] = lastResults[i].m_Cl;
+        m_pPolar->m_XTrTop[i] = lastResults[i].m_XTrTop;
+        m_pPolar->m_XTrBot[i] = lastResults[i].m_XTrBot;
+        m_pPolar->m_Control[i] = 1.0;  // Mark as converged, as the Python bridge does
+    }
+    m_pPolar->setDataModified();
+    return true;
 }
 
 
@@ -281,16 +429,8 @@ void NeuralFoilPolarCache::clear()
 
 std::string NeuralFoilPolarCache::computeFoilHash(Foil const &foil)
 {
-    // Simple hash based on number of points and a few key coordinates
-    std::string hash = std::to_string(foil.nNodes());
-    if (foil.nNodes() > 0) {
-        hash += "_" + std::to_string(int(foil.x(0) * 10000));
-        hash += "_" + std::to_string(int(foil.y(0) * 10000));
-        int mid = foil.nNodes() / 2;
-        hash += "_" + std::to_string(int(foil.x(mid) * 10000));
-        hash += "_" + std::to_string(int(foil.y(mid) * 10000));
-    }
-    return hash;
+    // hash of all the active nodes, so that the near-identical foils of an optimisation are told apart
+    return std::to_string(foil.nNodes()) + "_" + std::to_string(Objects2d::foilHash(&foil, false));
 }
 
 
@@ -331,12 +471,6 @@ bool NeuralFoilPolarCache::generatePolarMesh(Foil const &foil,
     // Clear old data
     clear();
     
-    // Ensure Python is ready
-    if (!NeuralFoilTask::ensurePythonReady()) {
-        std::cerr << "[NeuralFoilPolarCache] Failed to initialize Python" << std::endl;
-        return false;
-    }
-    
     // Generate Re values
     m_reValues = generateReValues(reMin, reMax, N_RE_VALUES);
     m_reMin = reMin;
@@ -355,6 +489,22 @@ bool NeuralFoilPolarCache::generatePolarMesh(Foil const &foil,
         y.push_back(foil.y(i));
     }
     
+    // The native kernel evaluates the whole Re x alpha mesh in a single batch
+    std::shared_ptr<NeuralFoilNet const> pNet = NeuralFoilTask::nativeModel(modelSize);
+    if (pNet) {
+        return generatePolarMeshNative(*pNet, x, y, nCrit, xtrTop, xtrBot);
+    }
+
+#ifndef NEURALFOIL_PYTHON
+    std::cerr << "[NeuralFoilPolarCache] Model file not found: " << NeuralFoilNet::modelFileName(NeuralFoilTask::modelSizeToString(modelSize)) << std::endl;
+    return false;
+#else
+    // Ensure Python is ready
+    if (!NeuralFoilTask::ensurePythonReady()) {
+        std::cerr << "[NeuralFoilPolarCache] Failed to initialize Python" << std::endl;
+        return false;
+    }
+    
     std::string modelStr = NeuralFoilTask::modelSizeToString(modelSize);
     
     // Acquire GIL for Python call
@@ -437,6 +587,68 @@ bool NeuralFoilPolarCache::generatePolarMesh(Foil const &foil,
     PyGILState_Release(gstate);
     
     return success;
+#endif
+}
+
+
+bool NeuralFoilPolarCache::generatePolarMeshNative(NeuralFoilNet const &net,
+                                                    std::vector<double> const &x, std::vector<double> const &y,
+                                                    double nCrit, double xtrTop, double xtrBot)
+{
+    std::vector<NeuralFoilNet::KulfanParams> foils(1);
+    if (!NeuralFoilNet::kulfanParameters(x, y, foils.front())) {
+        std::cerr << "[NeuralFoilPolarCache] Could not fit the Kulfan parameters of the foil" << std::endl;
+        clear();
+        return false;
+    }
+
+    // Same alpha mesh as the Python bridge
+    double const alphaStep = 0.25;
+    std::vector<double> alphas;
+    for (double a = m_alphaMin; a < m_alphaMax + alphaStep/2.0; a += alphaStep) alphas.push_back(a);
+    int nAlphas = static_cast<int>(alphas.size());
+    if (nAlphas == 0) return false;
+
+    std::vector<NeuralFoilNet::Point> pts(m_reValues.size() * alphas.size());
+    for (size_t ir = 0; ir < m_reValues.size(); ir++) {
+        for (int ia = 0; ia < nAlphas; ia++) {
+            NeuralFoilNet::Point &pt = pts[ir*nAlphas + ia];
+            pt.m_Alpha  = alphas[ia];
+            pt.m_Re     = m_reValues[ir];
+            pt.m_NCrit  = nCrit;
+            pt.m_XTrTop = xtrTop;
+            pt.m_XTrBot = xtrBot;
+        }
+    }
+
+    std::vector<NeuralFoilNet::Result> res;
+    net.evaluate(foils, pts, res);
+
+    // The Re values are generated in ascending order
+    for (size_t ir = 0; ir < m_reValues.size(); ir++) {
+        double re = m_reValues[ir];
+        Polar* pPolar = new Polar();
+        pPolar->setType(xfl::T1POLAR);
+        pPolar->setReynolds(re);
+        pPolar->setNCrit(nCrit);
+        pPolar->setXTripTop(xtrTop);
+        pPolar->setXTripBot(xtrBot);
+        pPolar->resizeData(nAlphas);
+        for (int ia = 0; ia < nAlphas; ia++) {
+            NeuralFoilNet::Result const &r = res[ir*nAlphas + ia];
+            pPolar->m_Alpha[ia]  = alphas[ia];
+            pPolar->m_Cl[ia]     = r.m_Cl;
+            pPolar->m_Cd[ia]     = r.m_Cd;
+            pPolar->m_XTrTop[ia] = r.m_XTrTop;
+            pPolar->m_XTrBot[ia] = r.m_XTrBot;
+            pPolar->m_Re[ia]     = re;
+        }
+        m_polars.push_back(pPolar);
+    }
+
+    std::cerr << "[NeuralFoilPolarCache] Generated " << m_polars.size()
+              << " polars natively, Re range [" << m_reMin << ", " << m_reMax << "]" << std::endl;
+    return true;
 }
 
 
@@ -32,11 +32,14 @@
 #include <p3analysis.h>
 
 #include <mathelem.h>
+#include <lucache.h>
 #include <matrix.h>
 #include <gaussquadrature.h>
+#include <kernelstats.h>
 #include <polar3d.h>
 #include <objects2d.h>
 #include <stabderivatives.h>
+#include <threadpool.h>
 #include <vortex.h>
 #include <vorton.h>
 
@@ -46,6 +49,7 @@ P3Analysis::P3Analysis() : PanelAnalysis()
 {
     m_nStations = 0;
     m_pRefTriMesh = nullptr;
+    m_bSavedPanels = false;
 }
 
 
@@ -70,10 +74,14 @@ void P3Analysis::releasePanelArrays()
 void P3Analysis::setTriMesh(TriMesh const &trimesh)
 {
     m_pRefTriMesh = &trimesh;
-    m_refPanel3 = trimesh.panels();
 
     m_Panel3 = trimesh.panels();
     m_WakePanel3 = trimesh.wakePanels();
+
+    // the mesh is the reference until a snapshot is made with savePanels()
+    m_refPanel3.clear();
+    m_refWakePanel3.clear();
+    m_bSavedPanels = false;
 }
 
 
@@ -224,33 +232,39 @@ void P3Analysis::getVelocityVector(Vector3d const &C,
                                    double const *Mu, double const *Sigma,
                                    Vector3d &VT, double coreradius, bool bWakeOnly, bool bMultiThread) const
 {
-    tmp_coreradius = coreradius;
-    tmp_bWakeOnly = bWakeOnly;
-    tmp_Mu = Mu;
-    tmp_Sigma = Sigma;
-
-    std::vector<Vector3d> VBlock(m_nBlocks);
-
-    if(bMultiThread)
+    if(!bWakeOnly && hasPanelTree(Mu, Sigma))
     {
-        std::vector<std::thread> threads;
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
+        panelTreeVelocity(C, Mu, Sigma, VT);
+        if(m_pPolar3d->bVortonWake())
         {
-            threads.push_back(std::thread(&P3Analysis::velocityVectorBlock, this, iBlock, C, &VBlock[iBlock]));
+            double vtncorelength = m_pPolar3d->vortonCoreSize()*m_pPolar3d->referenceChordLength();
+            Vector3d VVtn;
+            getVortonVelocity(C, vtncorelength, VVtn, bMultiThread);
+            VT += VVtn;
         }
+        return;
+    }
 
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            threads[iBlock].join();
-        }
-//        std::cout << "P3Analysis::getVelocityVector joined all " << m_nBlocks << " threads" <<std::endl;
+    // the block sums are on the stack for the usual block counts, since this is called for each field point
+    Vector3d VStack[MAXSTACKBLOCKS];
+    std::vector<Vector3d> VHeap;
+    Vector3d *VBlock = VStack;
+    if(m_nBlocks>MAXSTACKBLOCKS)
+    {
+        VHeap.resize(m_nBlocks);
+        VBlock = VHeap.data();
+    }
+
+    if(bMultiThread)
+    {
+        ThreadPool::pool().parallelFor(m_nBlocks, [this, &C, Mu, Sigma, coreradius, bWakeOnly, VBlock](int iBlock)
+            {velocityVectorBlock(iBlock, C, Mu, Sigma, coreradius, bWakeOnly, &VBlock[iBlock]);});
     }
     else
     {
         for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
         {
-            velocityVectorBlock(iBlock, C, &VBlock[iBlock]);
+            velocityVectorBlock(iBlock, C, Mu, Sigma, coreradius, bWakeOnly, &VBlock[iBlock]);
         }
     }
 
@@ -268,33 +282,60 @@ void P3Analysis::getVelocityVector(Vector3d const &C,
 }
 
 
-void P3Analysis::velocityVectorBlock(int iBlock, Vector3d const &C, Vector3d *VT) const
+void P3Analysis::velocityVectorBlock(int iBlock, Vector3d const &C, double const *Mu, double const *Sigma,
+                                     double coreradius, bool bWakeOnly, Vector3d *VT) const
 {
     int blockSize = int(nPanels()/m_nBlocks) +1;
     int iStart = iBlock*blockSize;
     int maxRows = nPanels();
     int iMax = std::min(iStart+blockSize, maxRows);
 
-    Vector3d Vd[3], Vs;
+    KERNEL_SAMPLE(P3VELOCITYBLOCK, std::max(0, iMax-iStart));
+
+    velocityVectorRange(iStart, iMax, 1, &C, Mu, Sigma, coreradius, bWakeOnly, VT);
+}
+
+
+/**
+ * Adds the velocities induced by the panels in the range [iStart, iMax[ and by their wake columns
+ * at each of the nPts points of array C.
+ * The panels are in the outer loop, so that each panel is loaded once for the whole set of points.
+ */
+void P3Analysis::velocityVectorRange(int iStart, int iMax, int nPts, Vector3d const *C, double const *Mu, double const *Sigma,
+                                     double , bool bWakeOnly, Vector3d *VT) const
+{
+    // the targets are evaluated in tiles by the batched kernels
+    Vector3d Vd[3*VELOCITYTILE], Vs[VELOCITYTILE];
     double sign=0;
 
+    KERNEL_SAMPLE(VELOCITYRANGEPOINTS, nPts);
+
     for (int i3=iStart; i3<iMax; i3++)
     {
         Panel3 const &p3 = m_Panel3.at(i3);
 
-        if(!tmp_bWakeOnly)
+        if(!bWakeOnly)
         {
-            if(tmp_Sigma && fabs(tmp_Sigma[i3])>0.0)
+            for(int ip0=0; ip0<nPts; ip0+=VELOCITYTILE)
             {
-                getSourceInfluence(m_pPolar3d, C, p3, C.isSame(p3.CoG()), &Vs, nullptr);
-                *VT += Vs * tmp_Sigma[i3];
-            }
+                int nTile = std::min(VELOCITYTILE, nPts-ip0);
+                Vector3d *VTile = VT+ip0;
 
-            getDoubletInfluence(C, p3, Vd, nullptr, tmp_coreradius, true);
-            VT->x += Vd[0].x*tmp_Mu[3*i3+0] + Vd[1].x*tmp_Mu[3*i3+1] + Vd[2].x*tmp_Mu[3*i3+2];
-            VT->y += Vd[0].y*tmp_Mu[3*i3+0] + Vd[1].y*tmp_Mu[3*i3+1] + Vd[2].y*tmp_Mu[3*i3+2];
-            VT->z += Vd[0].z*tmp_Mu[3*i3+0] + Vd[1].z*tmp_Mu[3*i3+1] + Vd[2].z*tmp_Mu[3*i3+2];
+                if(Sigma && fabs(Sigma[i3])>0.0)
+                {
+                    getSourceVelocities(nTile, C+ip0, p3, Vs);
+                    for(int ip=0; ip<nTile; ip++) VTile[ip] += Vs[ip] * Sigma[i3];
+                }
 
+                getDoubletVelocities(nTile, C+ip0, p3, Vd, true);
+                for(int ip=0; ip<nTile; ip++)
+                {
+                    Vector3d const *V3 = Vd+3*ip;
+                    VTile[ip].x += V3[0].x*Mu[3*i3+0] + V3[1].x*Mu[3*i3+1] + V3[2].x*Mu[3*i3+2];
+                    VTile[ip].y += V3[0].y*Mu[3*i3+0] + V3[1].y*Mu[3*i3+1] + V3[2].y*Mu[3*i3+2];
+                    VTile[ip].z += V3[0].z*Mu[3*i3+0] + V3[1].z*Mu[3*i3+1] + V3[2].z*Mu[3*i3+2];
+                }
+            }
         }
 
         // Is the panel shedding a wake?
@@ -304,39 +345,40 @@ void P3Analysis::velocityVectorBlock(int iBlock, Vector3d const &C, Vector3d *VT
             if(p3.isBotPanel()) sign=-1.0; else sign=1.0;
             if(p3.iWake()<0) continue; // requesting the velocity before the wake has been set - usually the consequence of a repaint signal for streamlines
 
-            //in the case of wake roll-up, only the panels upstream of row nWakeRow
-//            int iRow=0;
             Panel3 const *p3w = &m_WakePanel3[p3.iWake()];
 
             // whether p3 is on the left or right wing, node 1 is its left trailing node and node 2 is its right trailing node
             //Mu3[3*i3+1] is the doublet density at the wing's panel left trailing node, and Mu3[3*i3+3] at the right trailing node
-            double mu3left  = tmp_Mu[3*i3+1];
-            double mu3right = tmp_Mu[3*i3+2];
+            double mu3left  = Mu[3*i3+1];
+            double mu3right = Mu[3*i3+2];
 
             while(p3w)
             {
-                // do not use RFF approximation for wake panels?
-                getDoubletInfluence(C, *p3w, Vd, nullptr, tmp_coreradius, false);
+                // if p3w is a left wake panel, node 0 and 2 are left side and node 1 is right side - cf. TriMesh::makeWakePanels()
+                // if p3w is a right wake panel, node 2 is left side and node 0 and 1 are right side
+                double mu0 = p3w->isLeftSidePanel() ? mu3left : mu3right;
+                double mu1 = mu3right;
+                double mu2 = mu3left;
 
-                if(p3w->isLeftSidePanel())
+                for(int ip0=0; ip0<nPts; ip0+=VELOCITYTILE)
                 {
-                    VT->x += ((Vd[0].x+Vd[2].x)*mu3left +  Vd[1].x       *mu3right) *sign;
-                    VT->y += ((Vd[0].y+Vd[2].y)*mu3left +  Vd[1].y       *mu3right) *sign;
-                    VT->z += ((Vd[0].z+Vd[2].z)*mu3left +  Vd[1].z       *mu3right) *sign;
-                    // if p3w is a left wake panel, node 0 and 2 are left side and node 1 is right side - cf. TriMesh::makeWakePanels()
-                }
-                else
-                {
-                    // if p3w is a right wake panel, node 2 is left side and node 0 and 1 are right side
-                    VT->x += ( Vd[2].x       *mu3left + (Vd[0].x+Vd[1].x)*mu3right) *sign;
-                    VT->y += ( Vd[2].y       *mu3left + (Vd[0].y+Vd[1].y)*mu3right) *sign;
-                    VT->z += ( Vd[2].z       *mu3left + (Vd[0].z+Vd[1].z)*mu3right) *sign;
+                    int nTile = std::min(VELOCITYTILE, nPts-ip0);
+                    Vector3d *VTile = VT+ip0;
+
+                    // do not use RFF approximation for wake panels?
+                    getDoubletVelocities(nTile, C+ip0, *p3w, Vd, false);
+
+                    for(int ip=0; ip<nTile; ip++)
+                    {
+                        Vector3d const *V3 = Vd+3*ip;
+                        VTile[ip].x += (V3[0].x*mu0 + V3[1].x*mu1 + V3[2].x*mu2) *sign;
+                        VTile[ip].y += (V3[0].y*mu0 + V3[1].y*mu1 + V3[2].y*mu2) *sign;
+                        VTile[ip].z += (V3[0].z*mu0 + V3[1].z*mu1 + V3[2].z*mu2) *sign;
+                    }
                 }
                 // is there another wake panel downstream?
                 if(p3w->m_iPD>=0) p3w = m_WakePanel3.data() + p3w->m_iPD;
                 else              p3w = nullptr;
-
-//                iRow++;
             }
         }
         if(isCancelled()) return;
@@ -344,6 +386,126 @@ void P3Analysis::velocityVectorBlock(int iBlock, Vector3d const &C, Vector3d *VT
 }
 
 
+/**
+ * Batched version of getVelocityVector() for a set of points, evaluated in the calling thread.
+ */
+void P3Analysis::getVelocityVectors(int nPts, Vector3d const *C, double const *Mu, double const *Sigma,
+                                    Vector3d *VT, double coreradius, bool bWakeOnly) const
+{
+    if(!bWakeOnly && hasPanelTree(Mu, Sigma))
+    {
+        for(int ip=0; ip<nPts; ip++) panelTreeVelocity(C[ip], Mu, Sigma, VT[ip]);
+    }
+    else
+    {
+        for(int ip=0; ip<nPts; ip++) VT[ip].reset();
+        velocityVectorRange(0, nPanels(), nPts, C, Mu, Sigma, coreradius, bWakeOnly, VT);
+    }
+
+    if(m_pPolar3d->bVortonWake())
+    {
+        double vtncorelength = m_pPolar3d->vortonCoreSize()*m_pPolar3d->referenceChordLength();
+
+        Vector3d VVtn;
+        for(int ip=0; ip<nPts; ip++)
+        {
+            getVortonVelocity(C[ip], vtncorelength, VVtn, false);
+            VT[ip] += VVtn;
+        }
+    }
+}
+
+
+/**
+ * Makes the elements of the panel tree: the panels, with the average of their vertex doublet densities,
+ * and the wake panels, with the densities of the trailing nodes of the panel which sheds their column.
+ */
+void P3Analysis::makePanelTreeElements(double const *Mu, double const *Sigma, std::vector<PanelTree::Element> &elements) const
+{
+    elements.clear();
+    elements.reserve(m_Panel3.size()+m_WakePanel3.size());
+
+    PanelTree::Element elem;
+    for(int i3=0; i3<nPanels(); i3++)
+    {
+        Panel3 const &p3 = m_Panel3.at(i3);
+        elem.m_Position = p3.CoG();
+        elem.m_Radius   = p3.maxSize();
+        elem.m_Source   = Sigma ? Sigma[i3]*p3.area() : 0.0;
+        elem.m_Dipole   = p3.normal() * ((Mu[3*i3+0]+Mu[3*i3+1]+Mu[3*i3+2])/3.0*p3.area());
+        elem.m_Panel    = i3;
+        elem.m_Wake     = -1;
+        elements.push_back(elem);
+
+        if(!p3.isTrailing() || p3.iWake()<0) continue;
+
+        double sign = p3.isBotPanel() ? -1.0 : 1.0;
+        double mu3left  = Mu[3*i3+1];
+        double mu3right = Mu[3*i3+2];
+        int iw3 = p3.iWake();
+        while(iw3>=0)
+        {
+            Panel3 const &p3w = m_WakePanel3.at(iw3);
+            double mu0 = p3w.isLeftSidePanel() ? mu3left : mu3right;
+            elem.m_Position = p3w.CoG();
+            elem.m_Radius   = p3w.maxSize();
+            elem.m_Source   = 0.0;
+            elem.m_Dipole   = p3w.normal() * ((mu0+mu3right+mu3left)/3.0*p3w.area()*sign);
+            elem.m_Panel    = i3;
+            elem.m_Wake     = iw3;
+            elements.push_back(elem);
+            iw3 = p3w.m_iPD;
+        }
+    }
+}
+
+
+/** Returns in VT the velocity induced at point C by the panels and the wake panels, evaluated with the panel tree */
+void P3Analysis::panelTreeVelocity(Vector3d const &C, double const *Mu, double const *Sigma, Vector3d &VT) const
+{
+    m_PanelTree.inducedVelocity(C, VT, [this, Mu, Sigma](PanelTree::Element const &elem, Vector3d const &pt, Vector3d &v)
+        {treeElementVelocity(elem, pt, Mu, Sigma, v);});
+}
+
+
+/** Returns in V the exact velocity induced at point C by an element of the panel tree, as in velocityVectorRange() */
+void P3Analysis::treeElementVelocity(PanelTree::Element const &elem, Vector3d const &C, double const *Mu, double const *Sigma, Vector3d &V) const
+{
+    Vector3d Vd[3], Vs;
+    int i3 = elem.m_Panel;
+    double mu0=0, mu1=0, mu2=0;
+
+    if(elem.m_Wake<0)
+    {
+        Panel3 const &p3 = m_Panel3.at(i3);
+        V.reset();
+        if(Sigma && fabs(Sigma[i3])>0.0)
+        {
+            getSourceVelocities(1, &C, p3, &Vs);
+            V += Vs * Sigma[i3];
+        }
+        getDoubletVelocities(1, &C, p3, Vd, true);
+        mu0 = Mu[3*i3+0];
+        mu1 = Mu[3*i3+1];
+        mu2 = Mu[3*i3+2];
+    }
+    else
+    {
+        Panel3 const &p3w = m_WakePanel3.at(elem.m_Wake);
+        double sign = m_Panel3.at(i3).isBotPanel() ? -1.0 : 1.0;
+        V.reset();
+        getDoubletVelocities(1, &C, p3w, Vd, false);
+        mu0 = (p3w.isLeftSidePanel() ? Mu[3*i3+1] : Mu[3*i3+2]) * sign;
+        mu1 = Mu[3*i3+2] * sign;
+        mu2 = Mu[3*i3+1] * sign;
+    }
+
+    V.x += Vd[0].x*mu0 + Vd[1].x*mu1 + Vd[2].x*mu2;
+    V.y += Vd[0].y*mu0 + Vd[1].y*mu1 + Vd[2].y*mu2;
+    V.z += Vd[0].z*mu0 + Vd[1].z*mu1 + Vd[2].z*mu2;
+}
+
+
 /**
  * Returns the perturbation velocity vector far downstream using a line vortex model for the wake
  * irrespective of the analysis method.
@@ -482,6 +644,76 @@ void P3Analysis::getSourceInfluence(Polar3d const *pPolar3d, Vector3d const &C,
 }
 
 
+/**
+ * Batched version of getDoubletInfluence() for the velocities at the nPts points of array C, with nPts at most VELOCITYTILE;
+ * the velocities induced by the three basis functions at point ip are returned in V[3*ip], V[3*ip+1] and V[3*ip+2].
+ */
+void P3Analysis::getDoubletVelocities(int nPts, Vector3d const *C, Panel3 const &p3, Vector3d *V, bool bUseRFF) const
+{
+    assert(nPts<=VELOCITYTILE);
+    Vector3d VU[VELOCITYTILE];
+
+    if(m_pPolar3d->isTriLinearMethod())
+        p3.doubletBasisVelocity(nPts, C, V, bUseRFF);
+    else
+    {
+        // faster
+        p3.doubletN4023Velocity(nPts, C, VU, Vortex::coreRadius(), bUseRFF);
+        for(int ip=0; ip<nPts; ip++) V[3*ip] = V[3*ip+1] = V[3*ip+2] = VU[ip]/3.0;
+    }
+
+    if(m_pPolar3d->bHPlane())
+    {
+        double coef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+
+        Vector3d CG[VELOCITYTILE];
+        Vector3d VG[3*VELOCITYTILE];
+        for(int ip=0; ip<nPts; ip++) CG[ip].set(C[ip].x, C[ip].y, -C[ip].z-2.0*m_pPolar3d->groundHeight());
+
+        if(m_pPolar3d->isTriLinearMethod())
+            p3.doubletBasisVelocity(nPts, CG, VG, bUseRFF);
+        else
+        {
+            p3.doubletN4023Velocity(nPts, CG, VU, Vortex::coreRadius(), bUseRFF);
+            for(int ip=0; ip<nPts; ip++) VG[3*ip] = VG[3*ip+1] = VG[3*ip+2] = VU[ip]/3.0;
+        }
+
+        for(int k=0; k<3*nPts; k++)
+        {
+            V[k].x += VG[k].x * coef;
+            V[k].y += VG[k].y * coef;
+            V[k].z -= VG[k].z * coef;
+        }
+    }
+}
+
+
+/**
+ * Batched version of getSourceInfluence() for the velocities at the nPts points of array C, with nPts at most VELOCITYTILE.
+ */
+void P3Analysis::getSourceVelocities(int nPts, Vector3d const *C, Panel3 const &p3, Vector3d *V) const
+{
+    assert(nPts<=VELOCITYTILE);
+    p3.sourceN4023Velocity(nPts, C, V, Vortex::coreRadius());
+
+    if(m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect())
+    {
+        double coef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+
+        // the influence of this panel at the symmetric points below the surface
+        Vector3d VG, CG;
+        for(int ip=0; ip<nPts; ip++)
+        {
+            CG.set(C[ip].x, C[ip].y, -C[ip].z-2.0*m_pPolar3d->groundHeight());
+            p3.sourceVelocity(CG, false, VG);
+            V[ip].x += VG.x * coef;
+            V[ip].y += VG.y * coef;
+            V[ip].z -= VG.z * coef;
+        }
+    }
+}
+
+
 /**
  * @brief For a uniform strength analysis, makes the doublet density at the nodes from the values at the panel's center of any two arrays
  */
@@ -651,6 +883,12 @@ void P3Analysis::trailingWakePoint(Panel3 const*pWakePanel, Vector3d &left, Vect
 }
 
 
+/**
+ * Rebuilds the wake panels for the wind direction, and sets the wake indexes of the trailing panels.
+ * The flat wake of the fixed geometry polars is made once per polar along the body's x-axis,
+ * and the wake contribution to the matrix is then reused through the unit RHS, and across polars through the LUCache
+ * whose key includes the wake panels.
+ */
 int P3Analysis::makeWakePanels(const Vector3d &WindDirection, bool bVortonWake)
 {
     if(!bVortonWake)
@@ -685,13 +923,23 @@ void P3Analysis::savePanels()
 {
     m_refPanel3     = m_Panel3;
     m_refWakePanel3 = m_WakePanel3;
+    m_bSavedPanels = true;
 }
 
 
+/** Restores the panels saved by the last call to savePanels(), or the mesh's panels if none were saved since setTriMesh(). */
 void P3Analysis::restorePanels()
 {
-    m_Panel3     = m_refPanel3;
-    m_WakePanel3 = m_refWakePanel3;
+    if(m_bSavedPanels)
+    {
+        m_Panel3     = m_refPanel3;
+        m_WakePanel3 = m_refWakePanel3;
+    }
+    else if(m_pRefTriMesh)
+    {
+        m_Panel3     = m_pRefTriMesh->panels();
+        m_WakePanel3 = m_pRefTriMesh->wakePanels();
+    }
 }
 
 
@@ -782,7 +1030,7 @@ void P3Analysis::trefftzDrag(int nPanel3, double QInf, double alpha, double beta
 {
     Vector3d left, right;
     Vector3d Wg_l, Wg_m, Wg_r;
-    Vector3d u, mid;
+    Vector3d u;
     Vector3d ForceBodyAxes; // Strip and global forces, body axes
     double gLeft(0), gRight(0), gMid(0);
 
@@ -802,7 +1050,31 @@ void P3Analysis::trefftzDrag(int nPanel3, double QInf, double alpha, double beta
 
 //    clearDebugPts();
 
-    // Note: parallelization fails, incompatibility with std::vectors of SpanDistribs
+    // the downwash at the mid wake point of all the strips, evaluated in a single pass over the panels
+    std::vector<Vector3d> WStrip;
+    if(!m_bPrecomputedDownwash)
+    {
+        std::vector<Vector3d> CStrip;
+        for(int i3=0; i3<nPanel3; i3++)
+        {
+            Panel3 const &p3 = m_Panel3.at(i3+pos3);
+            if(p3.isTrailing() && (p3.isBotPanel() || p3.isMidPanel()))
+            {
+                // get the last triangle of the wake column
+                assert(p3.iWake()>=0 && p3.iWake()<nWakePanels());
+                Panel3 const *p3W = m_WakePanel3.data() + p3.iWake();
+
+                // evaluate the induced drag at the half of the wake's length to avoid end effects
+                // exact position is not significant, result is not affected by panel side singularities
+                midWakePoint(p3W, left, right);
+                CStrip.push_back((left + right)/2.0);
+            }
+        }
+        WStrip.resize(CStrip.size());
+        getVelocityVectorsReduced(int(CStrip.size()), CStrip.data(), mu3, sigma3, WStrip.data(), 0.0001, true);
+        for(Vector3d &W : WStrip) W *= 0.5;
+    }
+
     int m=0;
     for(int i3=0; i3<nPanel3; i3++)
     {
@@ -812,24 +1084,8 @@ void P3Analysis::trefftzDrag(int nPanel3, double QInf, double alpha, double beta
         StripForce.set(0,0,0);
         if(p3.isTrailing() && (p3.isBotPanel() || p3.isMidPanel()))
         {
-            // get the last triangle of the wake column
-            assert(p3.iWake()>=0 && p3.iWake()<nWakePanels());
-            Panel3 const *p3W = m_WakePanel3.data() + p3.iWake();
-//            trailingWakePoint(p3W, left, right);
-
-            // evaluate the induced drag at the half of the wake's length to avoid end effects
-            // exact position is not significant, result is not affected by panel side singularities
-
-            midWakePoint(p3W, left, right);
-            mid.set((left + right)/2.0);
-
-//            getVelocityVector(left,  mu3, sigma3, Wg_l, 0.0001, true, s_bMultiThread);
-            getVelocityVector(mid,   mu3, sigma3, Wg_m, 0.0001, true, s_bMultiThread);
-//            getVelocityVector(right, mu3, sigma3, Wg_r, 0.0001, true, s_bMultiThread);
-
-//            Wg_l *= 0.5;
-            Wg_m *= 0.5;
-//            Wg_r *= 0.5;
+            if(m_bPrecomputedDownwash) Wg_m = SpanResFF.m_Vd.at(m);
+            else                       Wg_m = WStrip.at(m);
 
 //s_DebugPts.push_back(mid);
 //s_DebugVecs.push_back(Wg_m);
@@ -895,8 +1151,8 @@ void P3Analysis::trefftzDrag(int nPanel3, double QInf, double alpha, double beta
 * Calculates the moments by a near field method, i.e. direct summation on the panels.
 * The downwash is evaluated far downstream (i.e. where the inluence of the bounded vortices is negligible)
 */
-void P3Analysis::forces(double const *Mu3, double const *Sigma3, double alpha, double beta, Vector3d const &CoG, bool bFuseMi,
-                        std::vector<Vector3d> const &VInf, Vector3d &Force, Vector3d &Moment)
+void P3Analysis::forces(double const *Mu3, double const *Sigma3, double const *Cp3, double alpha, double beta, Vector3d const &CoG, bool bFuseMi,
+                        std::vector<Vector3d> const &VInf, Vector3d &Force, Vector3d &Moment) const
 {
     if(!m_pPolar3d) return;
 
@@ -927,7 +1183,7 @@ void P3Analysis::forces(double const *Mu3, double const *Sigma3, double alpha, d
             {
                 // get the last triangle of the wake column
                 assert(p3.iWake()>=0 && p3.iWake()<nWakePanels());
-                Panel3 *p3W = m_WakePanel3.data() + p3.iWake();
+                Panel3 const *p3W = m_WakePanel3.data() + p3.iWake();
                 trailingWakePoint(p3W, left, right);
                 mid = (left + right)/2.0;
 
@@ -957,7 +1213,7 @@ void P3Analysis::forces(double const *Mu3, double const *Sigma3, double alpha, d
             //Get the strip's lifting force
 
             // get the last triangle of the wake column
-            Panel3 *p3W = m_WakePanel3.data() + p3.iWake();
+            Panel3 const *p3W = m_WakePanel3.data() + p3.iWake();
             trailingWakePoint(p3W, left, right);
             mid = (left + right)/2.0;
 
@@ -991,7 +1247,7 @@ void P3Analysis::forces(double const *Mu3, double const *Sigma3, double alpha, d
         {
             Velocity = VInf.at(i3);
             QInf = Velocity.norm();
-            Cp = (m_Cp[3*i3]+m_Cp[3*i3+1]+m_Cp[3*i3+2])/3.0;
+            Cp = (Cp3[3*i3]+Cp3[3*i3+1]+Cp3[3*i3+2])/3.0;
             PanelForce = p3.normal() * (-Cp) * p3.area() *1/2.*QInf*QInf;      // Newtons/rho
             PanelLeverArm = p3.CoG() - CoG;
             Moment += PanelLeverArm * PanelForce;                     // N.m/rho
@@ -1279,7 +1535,7 @@ bool P3Analysis::computeTrimmedConditions(double mass, Vector3d const &CoG, doub
 
     Vector3d Force, Moment;
     std::vector<Vector3d> VField(nPanels(), VInf);
-    forces(m_Mu.data(), m_Sigma.data(), alphaeq, 0.0, CoG, bFuseMi, VField, Force, Moment);
+    forces(m_Mu.data(), m_Sigma.data(), m_Cp.data(), alphaeq, 0.0, CoG, bFuseMi, VField, Force, Moment);
 
     double Lift   = Force.dot(WindNormal);        //N/rho ; bank effect not included
 //    VerticalCl = Lift*2.0/m_pWPolar->referenceArea() * cos(phi)/m_pWPolar->density();
@@ -1306,25 +1562,36 @@ bool P3Analysis::computeTrimmedConditions(double mass, Vector3d const &CoG, doub
 }
 
 
+/** @return the hash of the panels and of the wake panels which define the influence matrix */
+std::uint64_t P3Analysis::meshHash() const
+{
+    std::uint64_t h = LUCache::hashSeed();
+    LUCache::hash(h, int(m_Panel3.size()));
+    for(Panel3 const &p3 : m_Panel3)     hashPanel(h, p3);
+    LUCache::hash(h, int(m_WakePanel3.size()));
+    for(Panel3 const &p3 : m_WakePanel3) hashPanel(h, p3);
+    return h;
+}
+
+
 void P3Analysis::makeInfluenceMatrix()
 {
 
     m_bMatrixError = false;
 
-    if(s_bMultiThread)
+    makePanelSoA();
+
+    if(!hasDenseMatrix())
     {
-        std::vector<std::thread> threads;
+        makeImplicitMatrix();
+        return;
+    }
 
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            threads.push_back(std::thread(&P3Analysis::makeMatrixBlock, this, iBlock));
-        }
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            threads[iBlock].join();
-        }
-//        std::cout << "P3Analysis::makeInfluenceMatrix joined all " << m_nBlocks << " threads" <<std::endl;
+    fetchSharedBlock();
 
+    if(s_bMultiThread)
+    {
+        ThreadPool::pool().parallelFor(m_nBlocks, [this](int iBlock){makeMatrixBlock(iBlock);});
     }
     else
     {
@@ -1335,6 +1602,8 @@ void P3Analysis::makeInfluenceMatrix()
         }
     }
 
+    storeSharedBlock();
+
 
     if(m_bMatrixError)
     {
@@ -35,6 +35,7 @@
 #include <p3linanalysis.h>
 #include <panel3.h>
 #include <polar3d.h>
+#include <threadpool.h>
 
 
 #if defined ACCELERATE
@@ -46,9 +47,45 @@
     #include <openblas/lapacke.h>
 #endif
 
+
+namespace
+{
+    /**
+     * Stores the 3x3 block of the influence of panel k3 on panel i3 in the rows 3.i3+iBasis and the columns 3.k3+kBasis.
+     * The precision is selected by the caller once for the panel pair, and the image's block is summed
+     * before the store, so that each coefficient is written once.
+     */
+    template<typename T>
+    void storeBlock(T *aij, int N, int i3, int k3, double const *sp)
+    {
+        for(int iBasis=0; iBasis<3; iBasis++)
+        {
+            T *dest = aij + size_t(3*i3+iBasis)*size_t(N) + size_t(3*k3);
+            for(int kBasis=0; kBasis<3; kBasis++) dest[kBasis] = T(sp[3*iBasis+kBasis]);
+        }
+    }
+
+    /**
+     * Adds the contributions of the left and right sides of a wake column to the basis functions 1 and 2 of panel k3,
+     * in the three rows of panel i3.
+     */
+    template<typename T>
+    void addWakeBlock(T *aij, int N, int i3, int k3, double sign, double const *LeftContrib, double const *RightContrib)
+    {
+        for(int ib=0; ib<3; ib++)
+        {
+            T *dest = aij + size_t(3*i3+ib)*size_t(N) + size_t(3*k3);
+            // add the wake's left contribution to basis function 1
+            dest[1] += T(sign * LeftContrib[ib]);
+            // add the wake's right contribution to basis function 2
+            dest[2] += T(sign * RightContrib[ib]);
+        }
+    }
+}
+
+
 P3LinAnalysis::P3LinAnalysis() : P3Analysis()
 {
-    Panel3::makeGQCoeffs();
 }
 
 
@@ -62,14 +99,34 @@ void P3LinAnalysis::makeMatrixBlock(int iBlock)
     int maxRows = nPanels();
     int iMax = std::min(iStart+blockSize, maxRows);
 
+    int nb = sharedBlockRows();
+    int r0 = 3*m_SharedBlockFirst;
+
+    double spG[]={0,0,0,0,0,0,0,0,0};
+    bool bImage = m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect();
+    double coef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+
     for(int i3=iStart; i3<iMax; i3++)
     {
         Panel3 const &p3i = m_Panel3.at(i3);
+        bool bSharedRow = hasSharedBlock() && isInSharedBlock(i3);
 
         for(int k3=0; k3<nPanels(); k3++)
         {
             Panel3 const &p3k = m_Panel3.at(k3);
 
+            if(bSharedRow && isInSharedBlock(k3))
+            {
+                // the coefficients have been fetched from the InfluenceBlockCache; only in double precision
+                for(int iBasis=0; iBasis<3; iBasis++)
+                {
+                    int row = 3*i3 + iBasis;
+                    double const *blockrow = m_SharedBlock.data() + size_t(row-r0)*size_t(nb) + size_t(3*k3-r0);
+                    std::copy(blockrow, blockrow+3, m_aijd.data()+size_t(row)*size_t(N)+size_t(3*k3));
+                }
+                continue;
+            }
+
             if(m_pPolar3d->bNeumann() || p3i.isMidPanel())
                 p3i.scalarProductDoubletVelocity(p3k, sp);
             else
@@ -84,22 +141,8 @@ void P3LinAnalysis::makeMatrixBlock(int iBlock)
                 return;
             }
 
-            for(int iBasis=0; iBasis<3; iBasis++)
+            if(bImage)
             {
-                int row = 3*i3 + iBasis;
-                for(int kBasis=0; kBasis<3; kBasis++)
-                {
-                    int col = 3*k3+kBasis;
-                    if(s_bDoublePrecision)
-                        m_aijd[uint(row*N+col)] = sp[3*iBasis+kBasis];// * p3i->orientationSign();
-                    else
-                        m_aijf[uint(row*N+col)] = float(sp[3*iBasis+kBasis]);// * p3i->orientationSign();
-                }
-            }
-
-            if(m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect())
-            {
-                double coef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
                 // add the contribution of the symmetric panel below the water's surface
                 // This is done slightly differently than for the uniform methods:
                 // make the symmetric panel and reverse its orientation
@@ -107,20 +150,14 @@ void P3LinAnalysis::makeMatrixBlock(int iBlock)
                 for(int in=0; in<3; in++)  S[in].set(p3k.node(in).x, p3k.node(in).y, -p3k.node(in).z-2.0*m_pPolar3d->groundHeight());
                 Panel3 p3kG(S[0], S[2], S[1]);
 
-                if(m_pPolar3d->bNeumann() || p3i.isMidPanel()) p3i.scalarProductDoubletVelocity(p3kG, sp);
-                else                                           p3i.scalarProductDoubletPotential(p3kG, false, sp);
+                if(m_pPolar3d->bNeumann() || p3i.isMidPanel()) p3i.scalarProductDoubletVelocity(p3kG, spG);
+                else                                           p3i.scalarProductDoubletPotential(p3kG, false, spG);
 
-                for(int iBasis=0; iBasis<3; iBasis++)
-                {
-                    int row = 3*i3 + iBasis;
-                    for(int kBasis=0; kBasis<3; kBasis++)
-                    {
-                        int col = 3*k3+kBasis;
-                        if(s_bDoublePrecision) m_aijd[uint(row*N+col)] += sp[3*iBasis+kBasis]*coef;
-                        else                   m_aijf[uint(row*N+col)] += float(sp[3*iBasis+kBasis]*coef);
-                    }
-                }
+                for(int j=0; j<9; j++) sp[j] += spG[j]*coef;
             }
+
+            if(s_bDoublePrecision) storeBlock(m_aijd.data(), N, i3, k3, sp);
+            else                   storeBlock(m_aijf.data(), N, i3, k3, sp);
             if(isCancelled() || m_bMatrixError) break;
         }
         if(isCancelled() || m_bMatrixError) break;
@@ -138,7 +175,6 @@ void P3LinAnalysis::makeWakeMatrixBlock(int iBlock)
     int maxRows = nPanels();
     int iMax = std::min(iStart+blockSize, maxRows);
 
-    int col1=0, col2=0;
     double scalarLeft[]{0,0,0};
     double scalarRight[]{0,0,0};
     double LeftContrib[]{0,0,0}, RightContrib[]{0,0,0};
@@ -178,84 +214,21 @@ void P3LinAnalysis::makeWakeMatrixBlock(int iBlock)
                 {
                     double sign = +1.0;
                     // add wake contribution to mid panel's contribution
-                    for(int ib=0; ib<3; ib++)
-                    {
-                        int row = 3*i3 + ib;
-    //                    col0 = 3*k3;
-                        col1 = 3*k3+1;
-                        col2 = 3*k3+2;
-                        if(s_bDoublePrecision)
-                        {
-                            // add the wake's left contribution to basis function 1
-                            m_aijd[uint(row*N + col1)] += sign * LeftContrib[ib];
-
-                            // add the wake's right contribution to basis function 2
-                            m_aijd[uint(row*N + col2)] += sign * RightContrib[ib];
-                        }
-                        else
-                        {
-                            // add the wake's left contribution to basis function 1
-                            m_aijf[uint(row*N + col1)] += float(sign * LeftContrib[ib]);
-
-                            // add the wake's right contribution to basis function 2
-                            m_aijf[uint(row*N + col2)] += float(sign * RightContrib[ib]);
-                        }
-                    }
+                    if(s_bDoublePrecision) addWakeBlock(m_aijd.data(), N, i3, k3, sign, LeftContrib, RightContrib);
+                    else                   addWakeBlock(m_aijf.data(), N, i3, k3, sign, LeftContrib, RightContrib);
                 }
                 else if(p3k.isBotPanel())
                 {
                     double sign = -1.0;
                     // add wake contribution to bottom panel's contribution
-                    for(int ib=0; ib<3; ib++)
-                    {
-                        int row = 3*i3 + ib;
-    //                    col0 = 3*k3;
-                        col1 = 3*k3+1;
-                        col2 = 3*k3+2;
-                        if(s_bDoublePrecision)
-                        {
-                            // add the wake's left contribution to basis function 1
-                            m_aijd[uint(row*N + col1)] += sign * LeftContrib[ib];
-
-                            // add the wake's right contribution to basis function 2
-                            m_aijd[uint(row*N + col2)] += sign * RightContrib[ib];
-                        }
-                        else
-                        {
-                            // add the wake's left contribution to basis function 1
-                            m_aijf[uint(row*N + col1)] += float(sign * LeftContrib[ib]);
-
-                            // add the wake's right contribution to basis function 2
-                            m_aijf[uint(row*N + col2)] += float(sign * RightContrib[ib]);
-                        }
-                    }
+                    if(s_bDoublePrecision) addWakeBlock(m_aijd.data(), N, i3, k3, sign, LeftContrib, RightContrib);
+                    else                   addWakeBlock(m_aijf.data(), N, i3, k3, sign, LeftContrib, RightContrib);
 
                     // add opposite wake contribution to opposite top TE panel's contribution
                     int k3t = p3k.oppositeIndex();
                     sign = 1.0;
-                    for(int ib=0; ib<3; ib++)
-                    {
-                        int row = 3*i3 + ib;
-    //                    col0 = 3*k3;
-                        col1 = 3*k3t+1;
-                        col2 = 3*k3t+2;
-                        if(s_bDoublePrecision)
-                        {
-                            // add the wake's left contribution to basis function 1
-                            m_aijd[uint(row*N + col1)] += sign * LeftContrib[ib];
-
-                            // add the wake's right contribution to basis function 2
-                            m_aijd[uint(row*N + col2)] += sign * RightContrib[ib];
-                        }
-                        else
-                        {
-                            // add the wake's left contribution to basis function 1
-                            m_aijf[uint(row*N + col1)] += float(sign * LeftContrib[ib]);
-
-                            // add the wake's right contribution to basis function 2
-                            m_aijf[uint(row*N + col2)] += float(sign * RightContrib[ib]);
-                        }
-                    }
+                    if(s_bDoublePrecision) addWakeBlock(m_aijd.data(), N, i3, k3t, sign, LeftContrib, RightContrib);
+                    else                   addWakeBlock(m_aijf.data(), N, i3, k3t, sign, LeftContrib, RightContrib);
                 }
             }
 
@@ -277,6 +250,15 @@ void P3LinAnalysis::makeWakeMatrixBlock(int iBlock)
  * @param scalarRight the scalar product of the right side of the wake column with the wing panel's basis function
  */
 bool P3LinAnalysis::scalarProductWake(Panel3 const &panel0, int iWake, double *scalarLeft, double *scalarRight) const
+{
+    bool bResult = false;
+    gq::withTriangleRule(Panel3::quadratureOrder(), [&](auto rule){bResult = scalarProductWake<decltype(rule)::value>(panel0, iWake, scalarLeft, scalarRight);});
+    return bResult;
+}
+
+
+template<int order>
+bool P3LinAnalysis::scalarProductWake(Panel3 const &panel0, int iWake, double *scalarLeft, double *scalarRight) const
 {
     double sum_Left[]={0.0,0.0,0.0};
     double sum_Right[]={0.0,0.0,0.0};
@@ -290,12 +272,12 @@ bool P3LinAnalysis::scalarProductWake(Panel3 const &panel0, int iWake, double *s
 
     Vector3d ptGlobal;
 
-    GQTriangle gq(Panel3::quadratureOrder());
+    using Rule = GQTriangleRule<order>;
 
-    for(uint igq=0; igq<gq.points().size(); igq++)
+    for(int igq=0; igq<Rule::nPoints; igq++)
     {
-        double x = panel0.m_Sl[0].x*(1.0-gq.points().at(igq).x-gq.points().at(igq).y) + panel0.m_Sl[1].x*gq.points().at(igq).x + panel0.m_Sl[2].x*gq.points().at(igq).y;
-        double y = panel0.m_Sl[0].y*(1.0-gq.points().at(igq).x-gq.points().at(igq).y) + panel0.m_Sl[1].y*gq.points().at(igq).x + panel0.m_Sl[2].y*gq.points().at(igq).y;
+        double x = panel0.m_Sl[0].x*(1.0-Rule::nodes[igq].x-Rule::nodes[igq].y) + panel0.m_Sl[1].x*Rule::nodes[igq].x + panel0.m_Sl[2].x*Rule::nodes[igq].y;
+        double y = panel0.m_Sl[0].y*(1.0-Rule::nodes[igq].x-Rule::nodes[igq].y) + panel0.m_Sl[1].y*Rule::nodes[igq].x + panel0.m_Sl[2].y*Rule::nodes[igq].y;
 
         panel0.localToGlobalPosition(x,y,0.0, ptGlobal.x, ptGlobal.y, ptGlobal.z);
 
@@ -371,10 +353,10 @@ bool P3LinAnalysis::scalarProductWake(Panel3 const &panel0, int iWake, double *s
 
         for(int ib=0; ib<3; ib++)
         {
-            integrandL = gq.weights().at(igq) * value_Left  * panel0.basis(x,y,ib);
+            integrandL = Rule::nodes[igq].w * value_Left  * panel0.basis(x,y,ib);
             sum_Left[ib]  += integrandL;
             if(std::isnan(integrandL) || std::isinf(integrandL)) return false;
-            integrandR = gq.weights().at(igq) * value_Right  * panel0.basis(x,y,ib);
+            integrandR = Rule::nodes[igq].w * value_Right  * panel0.basis(x,y,ib);
             if(std::isnan(integrandR) || std::isinf(integrandR)) return false;
             sum_Right[ib]  += integrandR;
         }
@@ -800,99 +782,66 @@ void P3LinAnalysis::makeUnitRHSBlock(int iBlock)
     int iMax = std::min(iStart+blockSize, maxRows);
 
     double SP[]{0,0,0}; // the 3 scalar products for a given panel
+    double rhs[6][3];   // the 6 unit RHS for the 3 basis functions of the panel
 
     Vector3d Vx(1,0,0), Vy(0,1,0), Vz(0,0,1);
     Vector3d Omx(1,0,0), Omy(0,1,0), Omz(0,0,1);
 
+    Vector3d leverarm_i3;
+    double first[6];
 
-    Vector3d leverarm_i3, leverarm_k3;
-    double sigma=0;
-
-    int iStation = 0;
     for(int i3=iStart; i3<iMax; i3++)
     {
         Panel3 const &p3i = m_Panel3.at(i3);
         leverarm_i3.set(p3i.CoG()-m_pPolar3d->CoG());
 
         int row = 3*i3;
-        if(m_pPolar3d->bNeumann() || p3i.isMidPanel())
+        bool bNeumann = m_pPolar3d->bNeumann() || p3i.isMidPanel();
+        if(bNeumann)
         {
             // first term of RHS is -V.n
             /** @todo if VPanel3 is not uniform on the panel, replace by a scalar product */
-            // assign values one at a time otherwise issues when multithreading
-
-            m_uRHS[row] = m_uRHS[row+1] = m_uRHS[row+2] = -Vx.dot(p3i.normal()) * p3i.area()/3.0;
-            m_vRHS[row] = m_vRHS[row+1] = m_vRHS[row+2] = -Vy.dot(p3i.normal()) * p3i.area()/3.0;
-            m_wRHS[row] = m_wRHS[row+1] = m_wRHS[row+2] = -Vz.dot(p3i.normal()) * p3i.area()/3.0;
-            m_pRHS[row] = m_pRHS[row+1] = m_pRHS[row+2] = - (leverarm_i3 * Omx).dot(p3i.normal()) * p3i.area()/3.0;
-            m_qRHS[row] = m_qRHS[row+1] = m_qRHS[row+2] = - (leverarm_i3 * Omy).dot(p3i.normal()) * p3i.area()/3.0;
-            m_rRHS[row] = m_rRHS[row+1] = m_rRHS[row+2] = - (leverarm_i3 * Omz).dot(p3i.normal()) * p3i.area()/3.0;
+            first[0] = -Vx.dot(p3i.normal()) * p3i.area()/3.0;
+            first[1] = -Vy.dot(p3i.normal()) * p3i.area()/3.0;
+            first[2] = -Vz.dot(p3i.normal()) * p3i.area()/3.0;
+            first[3] = - (leverarm_i3 * Omx).dot(p3i.normal()) * p3i.area()/3.0;
+            first[4] = - (leverarm_i3 * Omy).dot(p3i.normal()) * p3i.area()/3.0;
+            first[5] = - (leverarm_i3 * Omz).dot(p3i.normal()) * p3i.area()/3.0;
         }
         else // Dirichlet or thick surface
         {
-            m_uRHS[row] = m_uRHS[row+1] = m_uRHS[row+2] = 0;
-            m_vRHS[row] = m_vRHS[row+1] = m_vRHS[row+2] = 0;
-            m_wRHS[row] = m_wRHS[row+1] = m_wRHS[row+2] = 0;
-            m_pRHS[row] = m_pRHS[row+1] = m_pRHS[row+2] = 0;
-            m_qRHS[row] = m_qRHS[row+1] = m_qRHS[row+2] = 0;
-            m_rRHS[row] = m_rRHS[row+1] = m_rRHS[row+2] = 0;
+            for(int d=0; d<6; d++) first[d] = 0.0;
         }
+        for(int d=0; d<6; d++)
+            for(int ib=0; ib<3; ib++) rhs[d][ib] = first[d];
 
         // add the scalar products of influences of source panels with the basis functions of panel i3
         for(int k3=0; k3<nPanels(); k3++)
         {
             Panel3 const &p3k = m_Panel3.at(k3);
-            leverarm_k3.set(p3i.CoG()-m_pPolar3d->CoG());
+            // no source singularity on thin surfaces
+            if(p3k.isMidPanel()) continue;
 
-            if(p3k.isMidPanel())
-            {
-                // no source singularity on thin surfaces
-            }
-            else
-            {
-                if(m_pPolar3d->bNeumann() || p3i.isMidPanel())
-                {
-                    p3i.scalarProductSourceVelocity(p3k, i3==k3, SP);
-                }
-                else
-                {
-                    p3i.scalarProductSourcePotential(p3k, i3==k3, SP);
-                }
-
-                sigma = sourceStrength(p3k.normal(), Vx);
-                for(int ib=0; ib<3; ib++)  m_uRHS[row+ib] -= sigma * SP[ib];
+            if(bNeumann) p3i.scalarProductSourceVelocity(p3k, i3==k3, SP);
+            else         p3i.scalarProductSourcePotential(p3k, i3==k3, SP);
 
-                sigma = sourceStrength(p3k.normal(), Vy);
-                for(int ib=0; ib<3; ib++)  m_vRHS[row+ib] -= sigma * SP[ib];
-
-                sigma = sourceStrength(p3k.normal(), Vz);
-                for(int ib=0; ib<3; ib++)  m_wRHS[row+ib] -= sigma * SP[ib];
-
-                // corrected in v7.09
-                sigma = sourceStrength(p3k.normal(), leverarm_k3*Omx);
-//                for(int ib=0; ib<3; ib++)  m_pRHS[row] -= sigma * SP[ib];
-                for(int ib=0; ib<3; ib++)  m_pRHS[row+ib] -= sigma * SP[ib];
-
-                sigma = sourceStrength(p3k.normal(), leverarm_k3*Omy);
-//               for(int ib=0; ib<3; ib++)  m_qRHS[row] -= sigma * SP[ib];
-                for(int ib=0; ib<3; ib++)  m_qRHS[row+ib] -= sigma * SP[ib];
-
-                sigma = sourceStrength(p3k.normal(), leverarm_k3*Omz);
-//                for(int ib=0; ib<3; ib++)  m_rRHS[row] -= sigma * SP[ib];
-                for(int ib=0; ib<3; ib++)  m_rRHS[row+ib] -= sigma * SP[ib];
-            }
+            double const *sigma = m_UnitSigma.data() + 6*k3;
+            for(int d=0; d<6; d++)
+                for(int ib=0; ib<3; ib++) rhs[d][ib] -= sigma[d] * SP[ib];
         }
-        if(m_pPolar3d->bNeumann() || p3i.isMidPanel())
-        {
-            if(p3i.isLeading()) iStation++; // move on to the next strip
-        }
-        else
+
+        for(int ib=0; ib<3; ib++)
         {
-            if(p3i.isTopPanel() && p3i.isTrailing()) iStation++; // move on to the next strip
+            m_uRHS[row+ib] = rhs[0][ib];
+            m_vRHS[row+ib] = rhs[1][ib];
+            m_wRHS[row+ib] = rhs[2][ib];
+            m_pRHS[row+ib] = rhs[3][ib];
+            m_qRHS[row+ib] = rhs[4][ib];
+            m_rRHS[row+ib] = rhs[5][ib];
         }
+
         if(isCancelled()) break;
     }
-    (void)iStation;
 }
 
 /** unused, untested in multithread mode  */
@@ -906,20 +855,7 @@ void P3LinAnalysis::makeSourceInfluenceMatrix()
 
     if(s_bMultiThread)
     {
-
-        std::vector<std::thread> threads;
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-//            futureSync.addFuture(QtConcurrent::run(&P3LinAnalysis::makeSourceMatrixBlock, this, iBlock));
-            threads.push_back(std::thread(&P3LinAnalysis::makeSourceMatrixBlock, this, iBlock));
-        }
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            threads[iBlock].join();
-        }
-        std::cout << "P3LinAnalysis::makeSourceInfluenceMatrix joined all " << m_nBlocks << " threads" <<std::endl;
+        ThreadPool::pool().parallelFor(m_nBlocks, [this](int iBlock){makeSourceMatrixBlock(iBlock);});
     }
     else
     {
@@ -974,15 +910,21 @@ void P3LinAnalysis::makeSourceMatrixBlock(int iBlock)
 
 void P3LinAnalysis::makeUnitDoubletStrengths(double alpha, double beta)
 {
-    int N = 3*nPanels();
     double cosa = cos(alpha*PI/180.0);
     double sina = sin(alpha*PI/180.0);
     double cosb = cos(-beta *PI/180.0); //change of beta sign introduced in v7.24 to be consistent with AVL
     double sinb = sin(-beta *PI/180.0); //change of beta sign introduced in v7.24 to be consistent with AVL
 
+    combineUnitDoubletStrengths(cosa*cosb, sinb, sina*cosb);
+}
+
+
+void P3LinAnalysis::combineUnitDoubletStrengths(double cu, double cv, double cw)
+{
+    int N = 3*nPanels();
     for(int p=0; p<N; p++)
     {
-        m_Mu[p] = cosa*cosb*m_uRHSVertex.at(p) + sinb*m_vRHSVertex.at(p) + sina*cosb* m_wRHSVertex.at(p);
+        m_Mu[p] = cu*m_uRHSVertex.at(p) + cv*m_vRHSVertex.at(p) + cw*m_wRHSVertex.at(p);
     }
 }
 
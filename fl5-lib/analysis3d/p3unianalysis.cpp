@@ -63,89 +63,74 @@ void P3UniAnalysis::makeMatrixBlock(int iBlock)
     int maxRows = nPanels();
     int iMax = std::min(iStart+blocksize, maxRows);
 
-    Vector3d Vb[3];
-    double phiNasa(0);
-    Vector3d vel, velG;
+    std::vector<double> row(N, 0.0);
+    std::vector<unsigned char> bNear(N, 1);
+
     // for each panel
     for(int i3=iStart; i3<iMax; i3++)
     {
-        Panel3 const &p3i = m_Panel3.at(i3);
-
-        for(int k3=0; k3<nPanels(); k3++)
-        {
-            Panel3 const &p3k = m_Panel3.at(k3);
-
-            if(m_pPolar3d->bNeumann() || p3i.isMidPanel())
-            {
-                p3k.doubletBasisVelocity(p3i.CoG(), Vb);
+        influenceRow(i3, row.data(), bNear.data());
 
-                vel = Vb[0]+Vb[1]+Vb[2];
-                if(s_bDoublePrecision) m_aijd[uint(i3*N+k3)] = vel.dot(p3i.normal()); // change sign to be consistent with VLM
-                else                   m_aijf[uint(i3*N+k3)] = float(vel.dot(p3i.normal()));
-
-                if(m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect())
-                {
-                    double coef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
-
-                    // add the contribution of the symmetric panel below the water's surface,
-                    // which is the opposite of the contribution of this panel to the symmetric point
-                    Vector3d  CG(p3i.CoG().x, p3i.CoG().y, -p3i.CoG().z-2.0*m_pPolar3d->groundHeight());
-                    p3k.doubletBasisVelocity(CG, Vb);
-                    velG = Vb[0]+Vb[1]+Vb[2];
-                    velG.z = -velG.z;
-                    if(s_bDoublePrecision) m_aijd[uint(i3*N+k3)] += velG.dot(p3i.normal()) * coef;
-                    else                   m_aijf[uint(i3*N+k3)] += float(velG.dot(p3i.normal()))  * coef;
-                }
-            }
-            else if(m_pPolar3d->bDirichlet())
-            {
-                // Dirichlet B.C.
-                double phib[]{0,0,0};
-                p3k.doubletBasisPotential(p3i.CoG(), i3==k3, phib, true);
-                phiNasa = phib[0]+phib[1]+phib[2];
+        if(!storeMatrixRow(i3, row.data())) return;
+        if(isCancelled()) break;
+    }
+}
 
-                if(s_bDoublePrecision) m_aijd[uint(i3*N+k3)] = phiNasa;
-                else                   m_aijf[uint(i3*N+k3)] = float(phiNasa);
 
-                if(m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect())
-                {
-                    double coef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+/**
+ * Returns the influence of the uniform doublet density on panel k3 at the centroid of panel i3,
+ * including the ground or free surface image, but without the wake contribution.
+ */
+double P3UniAnalysis::influenceCoef(int i3, int k3) const
+{
+    Panel3 const &p3i = m_Panel3.at(i3);
+    Panel3 const &p3k = m_Panel3.at(k3);
 
-                    // add the contribution of the symmetric panel below the water's surface,
-                    // which is the opposite of the contribution of this panel to the symmetric point
-                    Vector3d CG(p3i.CoG().x, p3i.CoG().y, -p3i.CoG().z-2.0*m_pPolar3d->groundHeight());
+    double coef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+    bool bImage = m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect();
 
-                    p3k.doubletBasisPotential(CG, false, phib, true);
-                    phiNasa = phib[0]+phib[1]+phib[2];
+    // the symmetric point below the ground or the water's surface
+    Vector3d CG(p3i.CoG().x, p3i.CoG().y, -p3i.CoG().z-2.0*m_pPolar3d->groundHeight());
 
-                    if(s_bDoublePrecision) m_aijd[uint(i3*N+k3)] += phiNasa * coef;
-                    else                   m_aijf[uint(i3*N+k3)] += float(phiNasa) *coef;
-                }
-            }
+    if(m_pPolar3d->bNeumann() || p3i.isMidPanel())
+    {
+        Vector3d Vb[3];
+        p3k.doubletBasisVelocity(p3i.CoG(), Vb);
+        Vector3d vel = Vb[0]+Vb[1]+Vb[2];
+        double d = vel.dot(p3i.normal()); // change sign to be consistent with VLM
 
-            bool bError = false;
-            if(s_bDoublePrecision)  bError = std::isnan(m_aijd[uint(i3*N+k3)]);
-            else                    bError = std::isnan(m_aijf[uint(i3*N+k3)]);
-            if(bError)
-            {
-                QString strange;
-                strange = QString::asprintf("      *** numerical error when calculating the influence of panel %d on panel %d ***\n", k3, i3);
-                traceLog(strange);
-                m_bMatrixError = true;
-                return;
-            }
+        if(bImage)
+        {
+            // add the contribution of the symmetric panel below the water's surface,
+            // which is the opposite of the contribution of this panel to the symmetric point
+            p3k.doubletBasisVelocity(CG, Vb);
+            Vector3d velG = Vb[0]+Vb[1]+Vb[2];
+            velG.z = -velG.z;
+            d += velG.dot(p3i.normal()) * coef;
+        }
+        return d;
+    }
+    else
+    {
+        // Dirichlet B.C.
+        double phib[]{0,0,0};
+        p3k.doubletBasisPotential(p3i.CoG(), i3==k3, phib, true);
+        double phiNasa = phib[0]+phib[1]+phib[2];
 
-            if(isCancelled()) break;
+        if(bImage)
+        {
+            // add the contribution of the symmetric panel below the water's surface,
+            // which is the opposite of the contribution of this panel to the symmetric point
+            p3k.doubletBasisPotential(CG, false, phib, true);
+            phiNasa += (phib[0]+phib[1]+phib[2]) * coef;
         }
-        if(isCancelled()) break;
+        return phiNasa;
     }
 }
 
 
 void P3UniAnalysis::makeWakeMatrixBlock(int iBlock)
 {
-    int N = nPanels();
-
     int blockSize = int(nPanels()/m_nBlocks) +1;
     int iStart = iBlock*blockSize;
     int maxRows = nPanels();
@@ -199,20 +184,17 @@ void P3UniAnalysis::makeWakeMatrixBlock(int iBlock)
                 if(p3k.isMidPanel())
                 {
                     // add contribution to bot panel
-                    if(s_bDoublePrecision) m_aijd[uint(i3*N+k3)] += MatWakeContrib;
-                    else                   m_aijf[uint(i3*N+k3)] += float(MatWakeContrib);
+                    addMatrixCoef(i3, k3, MatWakeContrib);
                 }
                 else if(p3k.isBotPanel())
                 {
                     // add contribution to bot panel
-                    if(s_bDoublePrecision) m_aijd[uint(i3*N+k3)] += MatWakeContrib * (-1);
-                    else                   m_aijf[uint(i3*N+k3)] += float(MatWakeContrib) * (-1.0f);
+                    addMatrixCoef(i3, k3, -MatWakeContrib);
 
                     // add opposite contribution to opposite top TE panel's contribution
                     int k3t = p3k.oppositeIndex();
                     assert(k3t>=0 && k3t<nPanels());
-                    if(s_bDoublePrecision) m_aijd[uint(i3*N+k3t)] += MatWakeContrib;
-                    else                   m_aijf[uint(i3*N+k3t)] += float(MatWakeContrib);
+                    addMatrixCoef(i3, k3t, MatWakeContrib);
                 }
             }
         }
@@ -466,83 +448,63 @@ void P3UniAnalysis::makeUnitRHSBlock(int iBlock)
     Vector3d Vx(1,0,0), Vy(0,1,0), Vz(0,0,1);
     Vector3d Omx(1,0,0), Omy(0,1,0), Omz(0,0,1);
 
-    double phi = 0.0;
+    double phi = 0.0, val = 0.0;
+    double rhs[6];
     Vector3d V;
-    Vector3d leverarm_i3, leverarm_k3;
+    Vector3d leverarm_i3;
 
-    int iStation = 0;
     for(int i3=iStart; i3<iMax; i3++)
     {
         Panel3 const &p3i = m_Panel3.at(i3);
         leverarm_i3.set(p3i.CoG()-m_pPolar3d->CoG());
-        int row = i3;
 
-        if(m_pPolar3d->bNeumann() || p3i.isMidPanel())
+        bool bNeumann = m_pPolar3d->bNeumann() || p3i.isMidPanel();
+        if(bNeumann)
         {
             // first term of RHS is -V.n
-            m_uRHS[row] = -Vx.dot(p3i.normal());
-            m_vRHS[row] = -Vy.dot(p3i.normal());
-            m_wRHS[row] = -Vz.dot(p3i.normal());
-            m_pRHS[row] = - (leverarm_i3 * Omx).dot(p3i.normal());
-            m_qRHS[row] = - (leverarm_i3 * Omy).dot(p3i.normal());
-            m_rRHS[row] = - (leverarm_i3 * Omz).dot(p3i.normal());
+            rhs[0] = -Vx.dot(p3i.normal());
+            rhs[1] = -Vy.dot(p3i.normal());
+            rhs[2] = -Vz.dot(p3i.normal());
+            rhs[3] = - (leverarm_i3 * Omx).dot(p3i.normal());
+            rhs[4] = - (leverarm_i3 * Omy).dot(p3i.normal());
+            rhs[5] = - (leverarm_i3 * Omz).dot(p3i.normal());
         }
         else
         {
-            m_uRHS[row] = 0;
-            m_vRHS[row] = 0;
-            m_wRHS[row] = 0;
-            m_pRHS[row] = 0;
-            m_qRHS[row] = 0;
-            m_rRHS[row] = 0;
+            for(int d=0; d<6; d++) rhs[d] = 0.0;
         }
 
+        // the influence of each source panel is evaluated once for the six unit motions
         for(int k3=0; k3<nPanels(); k3++)
         {
             Panel3 const &p3k = m_Panel3.at(k3);
-            leverarm_k3.set(p3i.CoG()-m_pPolar3d->CoG());
+            // no source singularity on thin surfaces
+            if(p3k.isMidPanel()) continue;
 
-            if(p3k.isMidPanel())
+            if(bNeumann)
             {
-                // no source singularity on thin surfaces
+                p3k.sourceVelocity(p3i.CoG(), i3==k3, V);
+                val = V.dot(p3i.normal());
             }
-            else
+            else //if(m_pWPolar->bDirichlet())
             {
-                if(m_pPolar3d->bNeumann() || p3i.isMidPanel())
-                {
-                    p3k.sourceVelocity(p3i.CoG(), i3==k3, V);
-                    m_uRHS[i3] -= V.dot(p3i.normal()) * sourceStrength(p3k.normal(), Vx);
-                    m_vRHS[i3] -= V.dot(p3i.normal()) * sourceStrength(p3k.normal(), Vy);
-                    m_wRHS[i3] -= V.dot(p3i.normal()) * sourceStrength(p3k.normal(), Vz);
-                    m_pRHS[i3] -= V.dot(p3i.normal()) * sourceStrength(p3k.normal(), leverarm_k3*Omx);
-                    m_qRHS[i3] -= V.dot(p3i.normal()) * sourceStrength(p3k.normal(), leverarm_k3*Omy);
-                    m_rRHS[i3] -= V.dot(p3i.normal()) * sourceStrength(p3k.normal(), leverarm_k3*Omz);
-                }
-                else //if(m_pWPolar->bDirichlet())
-                {
-                    p3k.sourcePotential(p3i.CoG(), i3==k3, phi);
-                    m_uRHS[i3] -= phi * sourceStrength(p3k.normal(), Vx);
-                    m_vRHS[i3] -= phi * sourceStrength(p3k.normal(), Vy);
-                    m_wRHS[i3] -= phi * sourceStrength(p3k.normal(), Vz);
-                    m_pRHS[i3] -= phi * sourceStrength(p3k.normal(), leverarm_k3*Omx);
-                    m_qRHS[i3] -= phi * sourceStrength(p3k.normal(), leverarm_k3*Omy);
-                    m_rRHS[i3] -= phi * sourceStrength(p3k.normal(), leverarm_k3*Omz);
-                }
+                p3k.sourcePotential(p3i.CoG(), i3==k3, phi);
+                val = phi;
             }
-            if(isCancelled()) break;
-        }
 
-        if(m_pPolar3d->bNeumann() || p3i.isMidPanel())
-        {
-            if(p3i.isLeading()) iStation++; // move on to the next strip
-        }
-        else
-        {
-            if(p3i.isTopPanel() && p3i.isTrailing()) iStation++; // move on to the next strip
+            double const *sigma = m_UnitSigma.data() + 6*k3;
+            for(int d=0; d<6; d++) rhs[d] -= val * sigma[d];
         }
+
+        m_uRHS[i3] = rhs[0];
+        m_vRHS[i3] = rhs[1];
+        m_wRHS[i3] = rhs[2];
+        m_pRHS[i3] = rhs[3];
+        m_qRHS[i3] = rhs[4];
+        m_rRHS[i3] = rhs[5];
+
         if(isCancelled()) break;
     }
-    (void)iStation;
 }
 
 
@@ -550,18 +512,23 @@ void P3UniAnalysis::makeUnitDoubletStrengths(double alpha, double beta)
 {
     //______________________________________________________________________________________
     //    reconstruct all results from cosine and sine unit vectors
-    int N = nPanels();
-
     double cosa = cos(alpha*PI/180.0);
     double sina = sin(alpha*PI/180.0);
     double cosb = cos(-beta*PI/180.0); //change of beta sign introduced in v7.24 to be consistent with AVL
     double sinb = sin(-beta*PI/180.0); //change of beta sign introduced in v7.24 to be consistent with AVL
 
+    combineUnitDoubletStrengths(cosa*cosb, sinb, sina*cosb);
+}
+
+
+void P3UniAnalysis::combineUnitDoubletStrengths(double cu, double cv, double cw)
+{
+    int N = nPanels();
     for(int i3=0; i3<N; i3++)
     {
-        m_Mu[3*i3]   = cosa*cosb*m_uRHS.at(i3) + sinb*m_vRHS.at(i3) + sina*cosb*m_wRHS.at(i3);
-        m_Mu[3*i3+1] = cosa*cosb*m_uRHS.at(i3) + sinb*m_vRHS.at(i3) + sina*cosb*m_wRHS.at(i3);
-        m_Mu[3*i3+2] = cosa*cosb*m_uRHS.at(i3) + sinb*m_vRHS.at(i3) + sina*cosb*m_wRHS.at(i3);
+        m_Mu[3*i3]   = cu*m_uRHS.at(i3) + cv*m_vRHS.at(i3) + cw*m_wRHS.at(i3);
+        m_Mu[3*i3+1] = m_Mu[3*i3];
+        m_Mu[3*i3+2] = m_Mu[3*i3];
     }
 }
 
@@ -28,17 +28,22 @@
 #include <QString>
 #include <QDebug>
 
+#include <array>
 #include <thread>
 #include <iostream>
+#include <map>
 
 
 #include <p4analysis.h>
 
+#include <kernelstats.h>
+#include <lucache.h>
 #include <matrix.h>
 #include <objects2d.h>
 #include <panel4.h>
 #include <polar3d.h>
 #include <stabderivatives.h>
+#include <threadpool.h>
 #include <vortex.h>
 
 
@@ -194,6 +199,18 @@ int P4Analysis::allocateRHS4(int nRHS)
 }
 
 
+/** @return the hash of the panels and of the wake panels which define the influence matrix */
+std::uint64_t P4Analysis::meshHash() const
+{
+    std::uint64_t h = LUCache::hashSeed();
+    LUCache::hash(h, int(m_Panel4.size()));
+    for(Panel4 const &p4 : m_Panel4)     hashPanel(h, p4);
+    LUCache::hash(h, int(m_WakePanel4.size()));
+    for(Panel4 const &p4 : m_WakePanel4) hashPanel(h, p4);
+    return h;
+}
+
+
 /**
  * Alpha is used in the case of Neumann BC for thick surfaces to transfer the knwo part of the doublet densities to the RHS
  * Neumann BC are only active for control polars. T123 and T7 polars should use Dirichlet BC.
@@ -202,22 +219,24 @@ void P4Analysis::makeInfluenceMatrix()
 {
     m_bMatrixError = false;
 
+    makePanelSoA();
+
+    if(!hasDenseMatrix())
+    {
+        makeImplicitMatrix();
+        return;
+    }
+
     s_DebugPts.clear();
     s_DebugVecs.clear();
 
-    if(s_bMultiThread)
-    {
-        std::vector<std::thread> threads;
+    makeVLMSegments();
 
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            threads.push_back(std::thread(&P4Analysis::makeMatrixBlock, this, iBlock));
-        }
+    fetchSharedBlock();
 
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            threads[iBlock].join();
-        }
+    if(s_bMultiThread)
+    {
+        ThreadPool::pool().parallelFor(m_nBlocks, [this](int iBlock){makeMatrixBlock(iBlock);});
     }
     else
     {
@@ -228,6 +247,8 @@ void P4Analysis::makeInfluenceMatrix()
         }
     }
 
+    storeSharedBlock();
+
     if(m_bMatrixError)
     {
         traceStdLog("      Error building the influence matrix\n");
@@ -238,9 +259,6 @@ void P4Analysis::makeInfluenceMatrix()
 void P4Analysis::makeMatrixBlock(int iBlock)
 {
     int N = nPanels();
-    Vector3d C, V;
-
-    double phi=0.0;
 
     // for each panel
     int blocksize = int(double(nPanels())/double(m_nBlocks))+1; // add one to compensate for rounding errors
@@ -248,67 +266,53 @@ void P4Analysis::makeMatrixBlock(int iBlock)
     int maxRows = nPanels();
     int iMax = std::min(iStart+blocksize, maxRows);
 
+    std::vector<double> row(N, 0.0);
+    std::vector<unsigned char> bNear(N, 1);
+    std::vector<Vector3d> segvel(nVLMSegments()), segvelG(m_pPolar3d->bHPlane() ? nVLMSegments() : 0);
+
     // for each panel
     for(int i4=iStart; i4<iMax; i4++)
     {
-        Panel4 const &p4i = m_Panel4.at(i4);
-        //for each Boundary Condition point
-
-        if(p4i.isMidPanel() && m_pPolar3d->isVLM())
-            C = p4i.m_CtrlPt;
+        if(!m_VLMColumnSeg.empty() && m_Panel4.at(i4).isMidPanel())
+            VLMInfluenceRow(i4, row.data(), segvel.data(), segvelG.data());
         else
-            C = p4i.m_CollPt;
-
-        for(int k4=0; k4<nPanels(); k4++)
-        {
-            Panel4 const &p4k = m_Panel4.at(k4);
-            //for each panel, get the unit doublet or vortex influence at the boundary condition pt
-            if(m_pPolar3d->bNeumann() || p4i.isMidPanel())
-            {
-                getDoubletVelocity(C, p4k, V, 0.000, true, true);
-
-                if(std::isnan(V.x) || std::isnan(V.y) || std::isnan(V.z))
-                {
-                    QString strange;
-                    strange = QString::asprintf("      *** numerical error when calculating the influence of panel %d on panel %d ***\n", k4, i4);
-                    traceLog(strange);
-                    m_bMatrixError = true;
-                    return;
-                }
-
-                double d =  V.dot(p4i.normal());
+            influenceRow(i4, row.data(), bNear.data());
 
-                if(s_bDoublePrecision) m_aijd[uint(i4*N+k4)] = d;
-                else                   m_aijf[uint(i4*N+k4)] = float(d);
+        if(!storeMatrixRow(i4, row.data())) return;
+        if(isCancelled()) break;
+    }
+//    display_mat(m_aijf.data(), nPanels(), nPanels());
+}
 
-/*                if(!p4i.isMidPanel())
-                {
-                    // thick body with Neumann BC - should always be a T6 polar and a single Opp, no linear combinations
-                    m_uRHS[i4] -=  d*freeStreamPotential(p4k.CoG(), alpha, beta, 1.0);
-                }*/
-            }
-            else if(m_pPolar3d->bDirichlet())
-            {
-                getDoubletPotential(C, i4==k4, p4k, phi, 0.0, true, true);
 
-                if(std::isnan(phi))
-                {
-                    QString strange;
-                    strange = QString::asprintf("      *** numerical error when calculating the influence of panel %d on panel %d ***\n", k4, i4);
-                    traceLog(strange);
-                    m_bMatrixError = true;
-                    return;
-                }
+/**
+ * Returns the unit doublet or vortex influence of panel k4 at the boundary condition point of panel i4,
+ * i.e. the coefficient of the influence matrix without the wake contribution.
+ */
+double P4Analysis::influenceCoef(int i4, int k4) const
+{
+    Panel4 const &p4i = m_Panel4.at(i4);
+    Panel4 const &p4k = m_Panel4.at(k4);
 
-                if(s_bDoublePrecision)  m_aijd[uint(i4*N+k4)] = phi;
-                else                    m_aijf[uint(i4*N+k4)] = float(phi);
-            }
+    //for each Boundary Condition point
+    Vector3d C;
+    if(p4i.isMidPanel() && m_pPolar3d->isVLM())
+        C = p4i.m_CtrlPt;
+    else
+        C = p4i.m_CollPt;
 
-            if(isCancelled()) break;
-        }
-        if(isCancelled()) break;
+    if(m_pPolar3d->bNeumann() || p4i.isMidPanel())
+    {
+        Vector3d V;
+        getDoubletVelocity(C, p4k, V, 0.000, true, true);
+        return V.dot(p4i.normal());
+    }
+    else
+    {
+        double phi=0.0;
+        getDoubletPotential(C, i4==k4, p4k, phi, 0.0, true, true);
+        return phi;
     }
-//    display_mat(m_aijf.data(), nPanels(), nPanels());
 }
 
 
@@ -322,9 +326,10 @@ void P4Analysis::makeUnitRHSBlock(int iBlock)
     Vector3d Vx(1,0,0), Vy(0,1,0), Vz(0,0,1);
     Vector3d Omx(1,0,0), Omy(0,1,0), Omz(0,0,1);
 
-    double  phi=0;
+    double  phi=0, val=0;
+    double rhs[6];
     Vector3d V, C;
-    Vector3d leverarm_i4, leverarm_k4;
+    Vector3d leverarm_i4;
 
     for (int i4=iStart; i4<iMax; i4++)
     {
@@ -333,69 +338,58 @@ void P4Analysis::makeUnitRHSBlock(int iBlock)
 
         leverarm_i4.set(C-m_pPolar3d->CoG());
 
-        if(p4i.isMidPanel() || m_pPolar3d->bNeumann())
+        bool bNeumann = p4i.isMidPanel() || m_pPolar3d->bNeumann();
+        if(bNeumann)
         {
             // first term of RHS is -V.n
-            m_uRHS[i4] = -Vx.dot(p4i.normal());
-            m_vRHS[i4] = -Vy.dot(p4i.normal());
-            m_wRHS[i4] = -Vz.dot(p4i.normal());
-            m_pRHS[i4] = - (leverarm_i4 * Omx).dot(p4i.normal());
-            m_qRHS[i4] = - (leverarm_i4 * Omy).dot(p4i.normal());
-            m_rRHS[i4] = - (leverarm_i4 * Omz).dot(p4i.normal());
+            rhs[0] = -Vx.dot(p4i.normal());
+            rhs[1] = -Vy.dot(p4i.normal());
+            rhs[2] = -Vz.dot(p4i.normal());
+            rhs[3] = - (leverarm_i4 * Omx).dot(p4i.normal());
+            rhs[4] = - (leverarm_i4 * Omy).dot(p4i.normal());
+            rhs[5] = - (leverarm_i4 * Omz).dot(p4i.normal());
         }
-        else if(m_pPolar3d->bDirichlet())
+        else
         {
-            m_uRHS[i4] = 0;
-            m_vRHS[i4] = 0;
-            m_wRHS[i4] = 0;
-            m_pRHS[i4] = 0;
-            m_qRHS[i4] = 0;
-            m_rRHS[i4] = 0;
+            for(int d=0; d<6; d++) rhs[d] = 0.0;
         }
 
+        // the influence of each source panel is evaluated once for the six unit motions
         for (int k4=0; k4<nPanels(); k4++)
         {
             Panel4 const &p4k = m_Panel4.at(k4);
             // Consider only the panels positioned on thick surfaces,
             // since the source strength is zero on thin surfaces
-            if(p4k.isMidPanel())
+            if(p4k.isMidPanel()) continue;
+
+            // Add to RHS the source influence of panel k4 on panel i4
+            if(bNeumann)
             {
-                // no source singularity on thin surfaces
+                // Using the zero perturbation inside condition.
+                // In the case of thick Neumann surfaces, the velocity is evaluated on the inside point
+                // to ensure Vi = Vinf inside
+                // In the case of thin Neumann surfaces, the source component is zero anyway on the panel
+                getSourceVelocity(C, i4==k4, p4k, V);
+                val = V.dot(p4i.normal());
             }
             else
             {
-                // Add to RHS the source influence of panel k4 on panel i4
-                leverarm_k4.set(p4k.CoG()-m_pPolar3d->CoG());
-
-                if(m_pPolar3d->bNeumann() || p4i.isMidPanel())
-                {
-                    // Using the zero perturbation inside condition.
-                    // In the case of thick Neumann surfaces, the velocity is evaluated on the inside point
-                    // to ensure Vi = Vinf inside
-                    // In the case of thin Neumann surfaces, the source component is zero anyway on the panel
-
-                    getSourceVelocity(C, i4==k4, p4k, V);
-                    m_uRHS[i4] -= V.dot(p4i.normal()) * sourceStrength(p4k.normal(), Vx);
-                    m_vRHS[i4] -= V.dot(p4i.normal()) * sourceStrength(p4k.normal(), Vy);
-                    m_wRHS[i4] -= V.dot(p4i.normal()) * sourceStrength(p4k.normal(), Vz);
-                    m_pRHS[i4] -= V.dot(p4i.normal()) * sourceStrength(p4k.normal(), leverarm_k4*Omx);
-                    m_qRHS[i4] -= V.dot(p4i.normal()) * sourceStrength(p4k.normal(), leverarm_k4*Omy);
-                    m_rRHS[i4] -= V.dot(p4i.normal()) * sourceStrength(p4k.normal(), leverarm_k4*Omz);
-                }
-                else if(m_pPolar3d->bDirichlet())
-                {
-                    //NASA4023 eq. (20)
-                    getSourcePotential(C, p4k, phi);
-                    m_uRHS[i4] -= phi * sourceStrength(p4k.normal(), Vx);
-                    m_vRHS[i4] -= phi * sourceStrength(p4k.normal(), Vy);
-                    m_wRHS[i4] -= phi * sourceStrength(p4k.normal(), Vz);
-                    m_pRHS[i4] -= phi * sourceStrength(p4k.normal(), leverarm_k4*Omx);
-                    m_qRHS[i4] -= phi * sourceStrength(p4k.normal(), leverarm_k4*Omy);
-                    m_rRHS[i4] -= phi * sourceStrength(p4k.normal(), leverarm_k4*Omz);
-                }
+                //NASA4023 eq. (20)
+                getSourcePotential(C, p4k, phi);
+                val = phi;
             }
+
+            double const *sigma = m_UnitSigma.data() + 6*k4;
+            for(int d=0; d<6; d++) rhs[d] -= val * sigma[d];
         }
 
+        m_uRHS[i4] = rhs[0];
+        m_vRHS[i4] = rhs[1];
+        m_wRHS[i4] = rhs[2];
+        m_pRHS[i4] = rhs[3];
+        m_qRHS[i4] = rhs[4];
+        m_rRHS[i4] = rhs[5];
+
         if(isCancelled()) return;
     }
 }
@@ -487,9 +481,6 @@ void P4Analysis::makeWakeMatrixBlock(int iBlock)
     std::vector<double>   PHC(m_nStations, 0);
     std::vector<Vector3d> VHC(m_nStations);
 
-
-    int Size = nPanels();
-
     for(int i4=iStart; i4<iMax; i4++)
     {
         Panel4 const &p4i = m_Panel4.at(i4);
@@ -562,8 +553,7 @@ void P4Analysis::makeWakeMatrixBlock(int iBlock)
                     //we do not add the term Phi_inf_KWPUM - Phi_inf_KWPLM (eq. 44) since it is 0, thin edge
                 }
 
-                if(s_bDoublePrecision) m_aijd[uint(i4*Size+k4)] += MatWakeContrib;
-                else                   m_aijf[uint(i4*Size+k4)] += float(MatWakeContrib);
+                addMatrixCoef(i4, k4, MatWakeContrib);
             }
             if(isCancelled()) return;
         }
@@ -636,6 +626,48 @@ void P4Analysis::getDoubletVelocity(Vector3d const &C, Panel4 const &p4, Vector3
 }
 
 
+/**
+ * Batched version of getDoubletVelocity() for the nPts points of array C, with nPts at most VELOCITYTILE.
+ */
+void P4Analysis::getDoubletVelocities(int nPts, Vector3d const *C, Panel4 const &p4, Vector3d *V,
+                                      double coreradius, bool bUseRFF, bool bIncludingBoundVortex) const
+{
+    assert(nPts<=VELOCITYTILE);
+    bool bVLMVortex = m_pPolar3d->isVLM() && p4.isMidPanel();
+
+    if(bVLMVortex)
+    {
+        for(int ip=0; ip<nPts; ip++)
+            VLMGetVortexInfluence(p4, C[ip], nullptr, V+ip, bIncludingBoundVortex, m_pPolar3d->TrefftzDistance());
+    }
+    else
+        p4.doubletVortexVelocity(nPts, C, V, coreradius, bUseRFF);
+
+    if(m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect())
+    {
+        double coef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+        Vector3d VG[VELOCITYTILE], CG[VELOCITYTILE];
+
+        for(int ip=0; ip<nPts; ip++) CG[ip].set(C[ip].x, C[ip].y, -C[ip].z-2.0*m_pPolar3d->groundHeight());
+
+        if(bVLMVortex)
+        {
+            for(int ip=0; ip<nPts; ip++)
+                VLMGetVortexInfluence(p4, CG[ip], nullptr, VG+ip, bIncludingBoundVortex, m_pPolar3d->TrefftzDistance());
+        }
+        else
+            p4.doubletVortexVelocity(nPts, CG, VG, coreradius, bUseRFF);
+
+        for(int ip=0; ip<nPts; ip++)
+        {
+            V[ip].x += VG[ip].x * coef;
+            V[ip].y += VG[ip].y * coef;
+            V[ip].z -= VG[ip].z * coef;
+        }
+    }
+}
+
+
 /**
  * Returns the influence at point C of a uniform source distribution on the panel pPanel
  * The panel is necessarily located on a thick surface, else the source strength is zero
@@ -683,39 +715,73 @@ void P4Analysis::getSourceVelocity(Vector3d const &C, bool bSelf, Panel4 const &
 }
 
 
+/**
+ * Batched version of getSourceVelocity() for the nPts points of array C, none of which is the panel's collocation point,
+ * with nPts at most VELOCITYTILE.
+ */
+void P4Analysis::getSourceVelocities(int nPts, Vector3d const *C, Panel4 const &p4, Vector3d *V) const
+{
+    assert(nPts<=VELOCITYTILE);
+    // pass argument core radius = 0.0 since wake panels do not have source density
+    p4.sourceN4023Velocity(nPts, C, V, 0.0);
+
+    if(m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect())
+    {
+        double coef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+        Vector3d VG[VELOCITYTILE], CG[VELOCITYTILE];
+
+        for(int ip=0; ip<nPts; ip++) CG[ip].set(C[ip].x, C[ip].y, -C[ip].z-2.0*m_pPolar3d->groundHeight());
+        p4.sourceN4023Velocity(nPts, CG, VG, 0.0);
+
+        for(int ip=0; ip<nPts; ip++)
+        {
+            V[ip].x += VG[ip].x * coef;
+            V[ip].y += VG[ip].y * coef;
+            V[ip].z -= VG[ip].z * coef;
+        }
+    }
+}
+
+
 void P4Analysis::getVelocityVector(Vector3d const &C,
                                    double const *Mu, double const *Sigma, Vector3d &VT, double coreradius,
                                    bool bWakeOnly, bool bMultiThread) const
 {
     if(isCancelled()) return;
-    // only 5 parameters max are allowed in the sub call to the parallized process, so make the others global
-    tmp_coreradius = coreradius;
-    tmp_bWakeOnly = bWakeOnly;
-    tmp_Mu = Mu;
-    tmp_Sigma = Sigma;
 
-    std::vector<Vector3d> VBlock(m_nBlocks);
-
-    if(bMultiThread)
+    if(!bWakeOnly && hasPanelTree(Mu, Sigma))
     {
-        std::vector<std::thread> threads;
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
+        panelTreeVelocity(C, Mu, Sigma, coreradius, VT);
+        if(m_pPolar3d->bVortonWake())
         {
-//            futureSync.addFuture(QtConcurrent::run(&P4Analysis::velocityVectorBlock, this, iBlock, C, &VBlock[iBlock]));
-            threads.push_back(std::thread(&P4Analysis::velocityVectorBlock, this, iBlock, C, &VBlock[iBlock]));
+            double vtncorelength = m_pPolar3d->vortonCoreSize()*m_pPolar3d->referenceChordLength();
+            Vector3d VVtn;
+            getVortonVelocity(C, vtncorelength, VVtn, bMultiThread);
+            VT += VVtn;
         }
+        return;
+    }
 
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            threads[iBlock].join();
-        }
+    // the block sums are on the stack for the usual block counts, since this is called for each field point
+    Vector3d VStack[MAXSTACKBLOCKS];
+    std::vector<Vector3d> VHeap;
+    Vector3d *VBlock = VStack;
+    if(m_nBlocks>MAXSTACKBLOCKS)
+    {
+        VHeap.resize(m_nBlocks);
+        VBlock = VHeap.data();
+    }
+
+    if(bMultiThread)
+    {
+        ThreadPool::pool().parallelFor(m_nBlocks, [this, &C, Mu, Sigma, coreradius, bWakeOnly, VBlock](int iBlock)
+            {velocityVectorBlock(iBlock, C, Mu, Sigma, coreradius, bWakeOnly, &VBlock[iBlock]);});
     }
     else
     {
         for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
         {
-            velocityVectorBlock(iBlock, C, &VBlock[iBlock]);
+            velocityVectorBlock(iBlock, C, Mu, Sigma, coreradius, bWakeOnly, &VBlock[iBlock]);
         }
     }
 
@@ -733,7 +799,8 @@ void P4Analysis::getVelocityVector(Vector3d const &C,
 }
 
 
-void P4Analysis::velocityVectorBlock(int iBlock, Vector3d const &C, Vector3d *VT) const
+void P4Analysis::velocityVectorBlock(int iBlock, Vector3d const &C, double const *Mu, double const *Sigma,
+                                     double coreradius, bool bWakeOnly, Vector3d *VT) const
 {
     // for each panel
     int blocksize = int(double(nPanels())/double(m_nBlocks))+1; // add one to compensate for rounding errors
@@ -741,7 +808,22 @@ void P4Analysis::velocityVectorBlock(int iBlock, Vector3d const &C, Vector3d *VT
     int maxRows = nPanels();
     int iMax = std::min(iStart+blocksize, maxRows);
 
-    Vector3d V, Vs, VV;
+    KERNEL_SAMPLE(P4VELOCITYBLOCK, std::max(0, iMax-iStart));
+
+    velocityVectorRange(iStart, iMax, 1, &C, Mu, Sigma, coreradius, bWakeOnly, VT);
+}
+
+
+/**
+ * Adds the velocities induced by the panels in the range [iStart, iMax[ and by their wake columns
+ * at each of the nPts points of array C.
+ * The panels are in the outer loop, so that each panel is loaded once for the whole set of points.
+ */
+void P4Analysis::velocityVectorRange(int iStart, int iMax, int nPts, Vector3d const *C, double const *Mu, double const *Sigma,
+                                     double coreradius, bool bWakeOnly, Vector3d *VT) const
+{
+    // the targets are evaluated in tiles by the batched kernels
+    Vector3d V[VELOCITYTILE];
     double sign = 0;
 
     for (int i4=iStart; i4<iMax; i4++)
@@ -751,26 +833,28 @@ void P4Analysis::velocityVectorBlock(int iBlock, Vector3d const &C, Vector3d *VT
 
         if(m_pPolar3d->isVLM())
         {
-            getDoubletVelocity(C, p4, V, tmp_coreradius, true, !tmp_bWakeOnly);
-            VT->x += V.x * tmp_Mu[i4];
-            VT->y += V.y * tmp_Mu[i4];
-            VT->z += V.z * tmp_Mu[i4];
+            for(int ip0=0; ip0<nPts; ip0+=VELOCITYTILE)
+            {
+                int nTile = std::min(VELOCITYTILE, nPts-ip0);
+                getDoubletVelocities(nTile, C+ip0, p4, V, coreradius, true, !bWakeOnly);
+                for(int ip=0; ip<nTile; ip++) VT[ip0+ip] += V[ip] * Mu[i4];
+            }
         }
         else
         {
-            if(!tmp_bWakeOnly)
+            if(!bWakeOnly)
             {
-                if(!p4.isMidPanel()) //otherwise Sigma[pp] =0.0, so contribution is zero also
+                for(int ip0=0; ip0<nPts; ip0+=VELOCITYTILE)
                 {
-                    getSourceVelocity(C, false, p4, V);
-                    VT->x += V.x * tmp_Sigma[i4];
-                    VT->y += V.y * tmp_Sigma[i4];
-                    VT->z += V.z * tmp_Sigma[i4];
+                    int nTile = std::min(VELOCITYTILE, nPts-ip0);
+                    if(!p4.isMidPanel()) //otherwise Sigma[pp] =0.0, so contribution is zero also
+                    {
+                        getSourceVelocities(nTile, C+ip0, p4, V);
+                        for(int ip=0; ip<nTile; ip++) VT[ip0+ip] += V[ip] * Sigma[i4];
+                    }
+                    getDoubletVelocities(nTile, C+ip0, p4, V, coreradius, true, true);
+                    for(int ip=0; ip<nTile; ip++) VT[ip0+ip] += V[ip] * Mu[i4];
                 }
-                getDoubletVelocity(C, p4, V, tmp_coreradius, true, true);
-                VT->x += V.x * tmp_Mu[i4];
-                VT->y += V.y * tmp_Mu[i4];
-                VT->z += V.z * tmp_Mu[i4];
             }
 
             // Is the panel pp shedding a wake?
@@ -779,20 +863,19 @@ void P4Analysis::velocityVectorBlock(int iBlock, Vector3d const &C, Vector3d *VT
                 //If so, add the contribution of the wake column shedded by this panel
                 if(p4.isBotPanel()) sign=-1.0; else sign=1.0;
                 int iw4 = p4.iWake();
-//                int irow=0;
                 while(iw4>=0 /* && iw4<wakepanel4.size() */)
                 {
                     assert(iw4<nWakePanels());
                     Panel4 const &p4w = m_WakePanel4.at(iw4);
-                    // do not use RFF approximation for wake panels
-                    getDoubletVelocity(C, p4w, V, tmp_coreradius, false, true);
-
-                    VT->x += V.x * tmp_Mu[i4]*sign;
-                    VT->y += V.y * tmp_Mu[i4]*sign;
-                    VT->z += V.z * tmp_Mu[i4]*sign;
+                    for(int ip0=0; ip0<nPts; ip0+=VELOCITYTILE)
+                    {
+                        int nTile = std::min(VELOCITYTILE, nPts-ip0);
+                        // do not use RFF approximation for wake panels
+                        getDoubletVelocities(nTile, C+ip0, p4w, V, coreradius, false, true);
+                        for(int ip=0; ip<nTile; ip++) VT[ip0+ip] += V[ip] * (Mu[i4]*sign);
+                    }
 
                     iw4 = p4w.m_iPD;
-//                    irow++;
                 }
             }
         }
@@ -800,6 +883,114 @@ void P4Analysis::velocityVectorBlock(int iBlock, Vector3d const &C, Vector3d *VT
 }
 
 
+/**
+ * Makes the elements of the panel tree: the panels, and the wake panels with the doublet density
+ * of the panel which sheds their column.
+ */
+void P4Analysis::makePanelTreeElements(double const *Mu, double const *Sigma, std::vector<PanelTree::Element> &elements) const
+{
+    elements.clear();
+    elements.reserve(m_Panel4.size()+m_WakePanel4.size());
+
+    PanelTree::Element elem;
+    for(int i4=0; i4<nPanels(); i4++)
+    {
+        Panel4 const &p4 = m_Panel4.at(i4);
+        elem.m_Position = p4.CoG();
+        elem.m_Radius   = p4.maxSize();
+        elem.m_Source   = (Sigma && !p4.isMidPanel()) ? Sigma[i4]*p4.area() : 0.0;
+        elem.m_Dipole   = p4.normal() * (Mu[i4]*p4.area());
+        elem.m_Panel    = i4;
+        elem.m_Wake     = -1;
+        elements.push_back(elem);
+
+        if(!p4.isTrailing()) continue;
+
+        double sign = p4.isBotPanel() ? -1.0 : 1.0;
+        int iw4 = p4.iWake();
+        while(iw4>=0)
+        {
+            Panel4 const &p4w = m_WakePanel4.at(iw4);
+            elem.m_Position = p4w.CoG();
+            elem.m_Radius   = p4w.maxSize();
+            elem.m_Source   = 0.0;
+            elem.m_Dipole   = p4w.normal() * (Mu[i4]*sign*p4w.area());
+            elem.m_Panel    = i4;
+            elem.m_Wake     = iw4;
+            elements.push_back(elem);
+            iw4 = p4w.m_iPD;
+        }
+    }
+}
+
+
+/** Returns in VT the velocity induced at point C by the panels and the wake panels, evaluated with the panel tree */
+void P4Analysis::panelTreeVelocity(Vector3d const &C, double const *Mu, double const *Sigma, double coreradius, Vector3d &VT) const
+{
+    m_PanelTree.inducedVelocity(C, VT, [this, Mu, Sigma, coreradius](PanelTree::Element const &elem, Vector3d const &pt, Vector3d &v)
+        {treeElementVelocity(elem, pt, Mu, Sigma, coreradius, v);});
+}
+
+
+/** Returns in V the exact velocity induced at point C by an element of the panel tree, as in velocityVectorRange() */
+void P4Analysis::treeElementVelocity(PanelTree::Element const &elem, Vector3d const &C, double const *Mu, double const *Sigma,
+                                     double coreradius, Vector3d &V) const
+{
+    Vector3d v;
+    int i4 = elem.m_Panel;
+    Panel4 const &p4 = m_Panel4.at(i4);
+
+    if(elem.m_Wake<0)
+    {
+        V.set(0.0,0.0,0.0);
+        if(Sigma && !p4.isMidPanel())
+        {
+            getSourceVelocities(1, &C, p4, &v);
+            V += v * Sigma[i4];
+        }
+        getDoubletVelocities(1, &C, p4, &v, coreradius, true, true);
+        V += v * Mu[i4];
+    }
+    else
+    {
+        double sign = p4.isBotPanel() ? -1.0 : 1.0;
+        // do not use RFF approximation for wake panels
+        getDoubletVelocities(1, &C, m_WakePanel4.at(elem.m_Wake), &v, coreradius, false, true);
+        V = v * (Mu[i4]*sign);
+    }
+}
+
+
+/**
+ * Batched version of getVelocityVector() for a set of points, evaluated in the calling thread.
+ */
+void P4Analysis::getVelocityVectors(int nPts, Vector3d const *C, double const *Mu, double const *Sigma,
+                                    Vector3d *VT, double coreradius, bool bWakeOnly) const
+{
+    for(int ip=0; ip<nPts; ip++) VT[ip].set(0.0,0.0,0.0);
+    if(isCancelled()) return;
+
+    if(!bWakeOnly && hasPanelTree(Mu, Sigma))
+    {
+        for(int ip=0; ip<nPts; ip++) panelTreeVelocity(C[ip], Mu, Sigma, coreradius, VT[ip]);
+    }
+    else
+        velocityVectorRange(0, nPanels(), nPts, C, Mu, Sigma, coreradius, bWakeOnly, VT);
+
+    if(m_pPolar3d->bVortonWake())
+    {
+        double vtncorelength = m_pPolar3d->vortonCoreSize()*m_pPolar3d->referenceChordLength();
+
+        Vector3d VVtn;
+        for(int ip=0; ip<nPts; ip++)
+        {
+            getVortonVelocity(C[ip], vtncorelength, VVtn, false);
+            VT[ip] += VVtn;
+        }
+    }
+}
+
+
 /**
  * Make the velocity field induced by the Vorton wake
  * Includes the influence of the cancelling vortices at the wake panels trailing edges
@@ -998,6 +1189,152 @@ void P4Analysis::VLMGetVortexInfluence(Panel4 const &p4, Vector3d const &C, doub
 }
 
 
+/**
+ * Makes the list of the unique vortex segments of the lattice, and the references of each panel to its segments,
+ * in the order in which VLMGetVortexInfluence() sums them.
+ * The bound and trailing segments are shared by the adjacent horseshoes and rings, so that VLMInfluenceRow()
+ * evaluates each of them once per control point instead of once per panel which owns them.
+ * The list is left empty if the analysis is not a VLM.
+ */
+void P4Analysis::makeVLMSegments()
+{
+    m_VLMSegA.clear();
+    m_VLMSegB.clear();
+    m_VLMColumnSeg.clear();
+    if(!m_pPolar3d || !m_pPolar3d->isVLM()) return;
+
+    double fardist = m_pPolar3d->TrefftzDistance();
+    std::map<std::array<double,6>, int> segmap;
+
+    m_VLMColumnSeg.assign(size_t(VLMSEGMENTS)*m_Panel4.size(), 0);
+
+    // returns the signed reference to the segment AB
+    auto addSegment = [this, &segmap](Vector3d const &A, Vector3d const &B)
+    {
+        std::array<double,6> key {A.x, A.y, A.z, B.x, B.y, B.z};
+        int sign = 1;
+        if(std::lexicographical_compare(key.begin()+3, key.end(), key.begin(), key.begin()+3))
+        {
+            key = {B.x, B.y, B.z, A.x, A.y, A.z};
+            sign = -1;
+        }
+        auto it = segmap.find(key);
+        int s = 0;
+        if(it!=segmap.end()) s = it->second;
+        else
+        {
+            s = int(m_VLMSegA.size());
+            segmap[key] = s;
+            m_VLMSegA.push_back(Vector3d(key[0], key[1], key[2]));
+            m_VLMSegB.push_back(Vector3d(key[3], key[4], key[5]));
+        }
+        return sign*(s+1);
+    };
+    auto farPoint = [fardist](Vector3d const &P) {return Vector3d(P.x+fardist, P.y, P.z);};
+
+    for(int k=0; k<nPanels(); k++)
+    {
+        Panel4 const &p4 = m_Panel4.at(k);
+        if(!p4.isMidPanel()) continue; // not a vortex; evaluated by influenceCoef()
+
+        int *ref = m_VLMColumnSeg.data() + size_t(VLMSEGMENTS)*size_t(k);
+        int n = 0;
+        if(m_pPolar3d->isVLM1())
+        {
+            // horseshoe vortex
+            ref[n++] = addSegment(p4.m_VA, p4.m_VB);
+            ref[n++] = addSegment(farPoint(p4.m_VA), p4.m_VA);
+            ref[n++] = addSegment(p4.m_VB, farPoint(p4.m_VB));
+        }
+        else if(!p4.m_bIsTrailing)
+        {
+            // vortex ring
+            Panel4 const &p4d = m_Panel4.at(p4.index()-1);
+            ref[n++] = addSegment(p4.m_VB,  p4d.m_VB);
+            ref[n++] = addSegment(p4d.m_VB, p4d.m_VA);
+            ref[n++] = addSegment(p4d.m_VA, p4.m_VA);
+            ref[n++] = addSegment(p4.m_VA,  p4.m_VB);
+        }
+        else
+        {
+            // trailing vortex ring, and the horseshoe which simulates the wake; same points as VLMGetVortexInfluence()
+            Vector3d AA1(p4.TA().x + (p4.TA().x-p4.m_VA.x)/3.0, p4.TA().y, p4.TA().z);
+            Vector3d BB1(p4.TB().x + (p4.TB().x-p4.m_VB.x)/3.0, p4.TB().y, p4.TB().z);
+            ref[n++] = addSegment(p4.m_VB, BB1);
+            ref[n++] = addSegment(BB1, AA1);
+            ref[n++] = addSegment(AA1, p4.m_VA);
+            ref[n++] = addSegment(p4.m_VA, p4.m_VB);
+            if(!m_pPolar3d->bVortonWake())
+            {
+                ref[n++] = addSegment(AA1, BB1);
+                ref[n++] = addSegment(farPoint(AA1), AA1);
+                ref[n++] = addSegment(BB1, farPoint(BB1));
+            }
+        }
+    }
+}
+
+
+/**
+ * Makes the row i4 of the influence matrix of a VLM from the unique segments of the lattice.
+ * Equivalent to influenceRow() for a control point on a thin surface, with one evaluation per segment.
+ * @param segvel, segvelG workspaces of size nVLMSegments(); segvelG is only used with a ground or free surface.
+ */
+void P4Analysis::VLMInfluenceRow(int i4, double *row, Vector3d *segvel, Vector3d *segvelG) const
+{
+    Panel4 const &p4i = m_Panel4.at(i4);
+    Vector3d const &C = p4i.m_CtrlPt;
+    Vector3d const &normal = p4i.normal();
+    double coreradius = Vortex::coreRadius();
+    int nSeg = nVLMSegments();
+
+    for(int s=0; s<nSeg; s++) segvel[s] = vortexInducedVelocity(m_VLMSegA[s], m_VLMSegB[s], C, coreradius);
+
+    bool bImage = m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect();
+    double coef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+    if(bImage)
+    {
+        Vector3d CG(C.x, C.y, -C.z-2.0*m_pPolar3d->groundHeight());
+        for(int s=0; s<nSeg; s++) segvelG[s] = vortexInducedVelocity(m_VLMSegA[s], m_VLMSegB[s], CG, coreradius);
+    }
+
+    Vector3d V, VG;
+    for(int k4=0; k4<nPanels(); k4++)
+    {
+        if(!m_Panel4.at(k4).isMidPanel())
+        {
+            row[k4] = influenceCoef(i4, k4);
+            continue;
+        }
+
+        int const *ref = m_VLMColumnSeg.data() + size_t(VLMSEGMENTS)*size_t(k4);
+        V.reset();
+        VG.reset();
+        for(int j=0; j<VLMSEGMENTS && ref[j]!=0; j++)
+        {
+            int s = std::abs(ref[j])-1;
+            if(ref[j]>0)
+            {
+                V += segvel[s];
+                if(bImage) VG += segvelG[s];
+            }
+            else
+            {
+                V -= segvel[s];
+                if(bImage) VG -= segvelG[s];
+            }
+        }
+        if(bImage)
+        {
+            V.x += VG.x * coef;
+            V.y += VG.y * coef;
+            V.z -= VG.z * coef;
+        }
+        row[k4] = V.dot(normal);
+    }
+}
+
+
 /**
 * Calculates the forces using a far-field method.
 * Calculates the moments by a near field method, i.e. direct summation on the panels.
@@ -1007,8 +1344,8 @@ void P4Analysis::VLMGetVortexInfluence(Panel4 const &p4, Vector3d const &C, doub
 * @param Force the resulting force vector
 * @param Moment the resulting moment vector
 */
-void P4Analysis::forces(double const *Mu4, double const *Sigma4, double alpha, double beta, Vector3d const &CoG, bool ,
-                        std::vector<Vector3d> const &VInf, Vector3d &Force, Vector3d &Moment)
+void P4Analysis::forces(double const *Mu4, double const *Sigma4, double const *, double alpha, double beta, Vector3d const &CoG, bool ,
+                        std::vector<Vector3d> const &VInf, Vector3d &Force, Vector3d &Moment) const
 {
     if(!m_pPolar3d) return;
 
@@ -1030,7 +1367,7 @@ void P4Analysis::forces(double const *Mu4, double const *Sigma4, double alpha, d
 //    int m=0;
     for(int i4=0; i4<nPanels(); i4++)
     {
-        Panel4 &p4 = m_Panel4[i4];
+        Panel4 const &p4 = m_Panel4.at(i4);
 
         if(!m_pPolar3d->isVLM())
         {
@@ -1473,6 +1810,41 @@ void P4Analysis::trefftzDrag(int nPanels, double QInf, double alpha, double beta
     double const *Mu4    = m_Mu.data();
     double const *Sigma4 = m_Sigma.data();
 
+    // the downwash at the evaluation point of all the strips, evaluated in a single pass over the panels
+    std::vector<Vector3d> WStrip;
+    if(!m_bPrecomputedDownwash)
+    {
+        std::vector<Vector3d> CStrip;
+        for(int i4=0; i4<nPanels; i4++)
+        {
+            Panel4 const &p4 = m_Panel4.at(i4+pos);
+            if(!m_pPolar3d->isVLM())
+            {
+                if(p4.isTrailing() && (p4.isBotPanel()||p4.isMidPanel()))
+                {
+                    // modified in 7.01 beta 09 to use vortex lines rather than wake panels
+                    // modified in 7.01 beta 12 to use the mid wake point
+                    CStrip.push_back(midWakePoint(m_WakePanel4.data() + p4.iWake()));
+                }
+            }
+            else if(p4.isTrailing())
+            {
+                // evaluate at half the ff distance, so that we get influence of upstream and downstream parts of the vortices
+                // then divide the influence by 2.0 since point ought to be at infinity with no downstream wake
+                C = p4.ctrlPt(true);
+                C.x = m_pPolar3d->TrefftzDistance()/2.0;
+                CStrip.push_back(C);
+            }
+        }
+        WStrip.resize(CStrip.size());
+        getVelocityVectorsReduced(int(CStrip.size()), CStrip.data(), Mu4, Sigma4, WStrip.data(), Vortex::coreRadius(), true);
+
+        // The trailing point sees both the upstream and downstream parts of the trailing vortices
+        // Hence it sees twice the downwash.
+        // So divide by 2 to account for this.
+        for(Vector3d &W : WStrip) W *= 1.0/2.0;
+    }
+
     int m=0;
     for(int i4=0; i4<nPanels; i4++)
     {
@@ -1484,17 +1856,8 @@ void P4Analysis::trefftzDrag(int nPanels, double QInf, double alpha, double beta
         {
             if(p4.isTrailing() && (p4.isBotPanel()||p4.isMidPanel()))
             {
-                Panel4 const *p4w = m_WakePanel4.data() + p4.iWake();
-                // modified in 7.01 beta 09 to use vortex lines rather than wake panels
-//                C = (p4.TA() + p4.TB())/2.0;
-//                C += winddir*m_pPolar3d->TrefftzDistance()/2.0;
-                // modified in 7.01 beta 12 to use the mid wake point
-                C = midWakePoint(p4w);
-
-                getVelocityVector(C, Mu4, Sigma4, Wg, Vortex::coreRadius(), true, s_bMultiThread);
-//                getFarFieldVelocity(C, m_Panel4, Mu4, Wg, Vortex::coreRadius());
-                Wg *= 1.0/2.0;
-//                Wg += winddir;
+                if(m_bPrecomputedDownwash) Wg = SpanResFF.m_Vd.at(m);
+                else                       Wg = WStrip.at(m);
 
                 SpanResFF.m_Vd[m] = Wg;
                 inducedAngle = atan2(Wg.dot(surfacenormal), QInf);
@@ -1538,26 +1901,17 @@ void P4Analysis::trefftzDrag(int nPanels, double QInf, double alpha, double beta
                 assert(p4.isMidPanel());
                 int pp = i4;
                 SpanResFF.m_Gamma[m] = 0.0;
+
+                // the evaluation point depends only on the strip's trailing panel,
+                // so the downwash is the same for all the panels of the strip
+                if(m_bPrecomputedDownwash) Wg = SpanResFF.m_Vd.at(m);
+                else                       Wg = WStrip.at(m);
+
                 do
                 {
                     Panel4 const &pp4 = m_Panel4.at(pp+pos);
                     if(m_pPolar3d->isVLM1() || pp4.isTrailing())
                     {
-                        C = p4.ctrlPt(true);
-
-                        // evaluate at half the ff distance, so that we get influence of upstream and downstream parts of the vortices
-                        // then divide the influence by 2.0 since point ought to be at infinity with no downstream wake
-                        C.x = m_pPolar3d->TrefftzDistance()/2.0;
-
-                        getVelocityVector(C, Mu4, Sigma4, Wg, Vortex::coreRadius(), true, s_bMultiThread);
-
-
-                        // The trailing point sees both the upstream and downstream parts of the trailing vortices
-                        // Hence it sees twice the downwash.
-                        // So divide by 2 to account for this.
-                        Wg *= 1.0/2.0;
-//                        Wg += winddir;
-
                         if(pp4.isTrailing())
                         {
                             SpanResFF.m_Vd[m] = Wg;
@@ -1652,13 +2006,20 @@ void P4Analysis::makeUnitDoubletStrengths(double alpha, double beta)
     double cosb = cos(-beta *PI/180.0); //change of beta sign introduced in v7.24 to be consistent with AVL
     double sinb = sin(-beta *PI/180.0); //change of beta sign introduced in v7.24 to be consistent with AVL
 
+    combineUnitDoubletStrengths(cosa*cosb, sinb, sina*cosb);
+}
+
+
+void P4Analysis::combineUnitDoubletStrengths(double cu, double cv, double cw)
+{
     for(int p=0; p<nPanels(); p++)
     {
-        m_Mu[p] = cosa*cosb*m_uRHS.at(p) + sinb*m_vRHS.at(p) + sina*cosb* m_wRHS.at(p);
+        m_Mu[p] = cu*m_uRHS.at(p) + cv*m_vRHS.at(p) + cw*m_wRHS.at(p);
     }
 }
 
 
+/** Rebuilds the wake panels and nodes for the wind direction; cf. P3Analysis::makeWakePanels() for their reuse. */
 int P4Analysis::makeWakePanels(const Vector3d &WindDirection, bool bVortonWake)
 {
     Vector3d pt;
@@ -1934,7 +2295,7 @@ bool P4Analysis::computeTrimmedConditions(double mass, Vector3d const &CoG, doub
 
     //extra drag is useless when calculating lifting velocity
     Vector3d Force, Moment;
-    forces(m_Mu.data(), m_Sigma.data(), alphaeq, 0.0, CoG, bFuseMi, tmpVField, Force, Moment);
+    forces(m_Mu.data(), m_Sigma.data(), nullptr, alphaeq, 0.0, CoG, bFuseMi, tmpVField, Force, Moment);
 
 
 //    phi = m_pPolar3d->phi() *PI/180.0;
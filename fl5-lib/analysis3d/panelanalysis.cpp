@@ -24,6 +24,7 @@
 
 #define _MATH_DEFINES_DEFINED
 
+#include <cmath>
 #include <iostream>
 #include <thread>
 #include <QString>
@@ -31,12 +32,64 @@
 
 #include <panelanalysis.h>
 
+#include <distributedsolver.h>
 #include <gaussquadrature.h>
+#include <gpusolver.h>
+#include <influenceblockcache.h>
+#include <lucache.h>
+#include <matrix.h>
+#include <memorybudget.h>
 #include <objects_global.h>
 #include <panel.h>
 #include <panel3.h>
+#include <panel4.h>
 #include <polar3d.h>
 #include <stabderivatives.h>
+#include <taskcheckpoint.h>
+#include <threadpool.h>
+#include <utils.h>
+
+
+namespace
+{
+    /**
+     * Zeroes the rows of the N x N matrix by blocks on the thread pool. This is the first touch of the pages
+     * of a freshly allocated matrix, which the OS places on the NUMA node of the thread which writes them:
+     * the rows are split as in the assembly, so that each block tends to be local to the threads which build it,
+     * and all of them are local to the node when the calling thread is pinned to it.
+     */
+    template<typename T>
+    void zeroRowBlocks(T *aij, int N, int nBlocks, bool bMultiThread)
+    {
+        size_t rowsize = size_t(N)*sizeof(T);
+        if(!bMultiThread || nBlocks<=1)
+        {
+            memset(aij, 0, size_t(N)*rowsize);
+            return;
+        }
+        int blocksize = N/nBlocks+1;
+        ThreadPool::pool().parallelFor(nBlocks, [aij, N, blocksize, rowsize](int iBlock)
+        {
+            int i0 = std::min(N, iBlock*blocksize);
+            int i1 = std::min(N, i0+blocksize);
+            if(i1>i0) memset(aij+size_t(i0)*size_t(N), 0, size_t(i1-i0)*rowsize);
+        });
+    }
+
+    /**
+     * Copies one row of influence coefficients into the matrix row.
+     * @return the index of the first NaN coefficient, or -1; the NaN test is a single pass
+     * after the copy, so that the copy loop has no branch.
+     */
+    template<typename T>
+    int storeRow(T *dest, double const *row, int N)
+    {
+        for(int k=0; k<N; k++) dest[k] = T(row[k]);
+        for(int k=0; k<N; k++)
+            if(std::isnan(row[k])) return k;
+        return -1;
+    }
+}
 
 
 
@@ -56,8 +109,18 @@
 #endif*/
 
 bool PanelAnalysis::s_bDoublePrecision(true);
+bool PanelAnalysis::s_bMixedPrecision(false);
+int PanelAnalysis::s_MaxRefinementSteps(5);
+double PanelAnalysis::s_RefinementTolerance(1.0e-12);
+int PanelAnalysis::s_MaxFrozenSteps(12);
+bool PanelAnalysis::s_bLowRankUpdate(true);
+bool PanelAnalysis::s_bGpuSolver(false);
+bool PanelAnalysis::s_bDistributedSolver(false);
+double PanelAnalysis::s_MaxUpdateFraction(0.1);
+double PanelAnalysis::s_PanelTreeTheta(0.0);
 bool PanelAnalysis::s_bMultiThread(true);
 int PanelAnalysis::s_MaxThreads(1);
+int PanelAnalysis::s_BlasThreads(0);
 
 std::vector<Vector3d> PanelAnalysis::s_DebugPts;
 std::vector<Vector3d> PanelAnalysis::s_DebugVecs;
@@ -72,45 +135,178 @@ PanelAnalysis::PanelAnalysis()
     m_bSequence    = false;
     m_bWarning     = false;
 
-    m_nBlocks     = s_MaxThreads;
+    m_nThreads    = s_MaxThreads;
+    m_nBlocks     = ThreadPool::nBlocks(m_nThreads);
+
+    m_bCompressed = false;
+    m_bMatrixFree = false;
+    m_bPrecomputedDownwash = false;
+    m_FactorizationKey = 0;
+    m_SharedBlockFirst = m_SharedBlockSize = 0;
+    m_pFrozenPA = nullptr;
+    m_pGpuSolver = nullptr;
+    m_pDistributedSolver = nullptr;
+    m_bDistributed = false;
+
+    m_MatrixBytes = m_ReferenceBytes = 0;
 
     m_nStations = 0;
+    m_TreeTheta = 0.0;
 
     m_pPolar3d = nullptr;
 
-    tmp_coreradius=0.0;
-    tmp_bWakeOnly=false;
-    tmp_Mu=nullptr;
-    tmp_Sigma=nullptr;
 
 }
 
 
+PanelAnalysis::~PanelAnalysis()
+{
+    releaseMemory(m_MatrixBytes);
+    releaseMemory(m_ReferenceBytes);
+    delete m_pGpuSolver;
+    delete m_pDistributedSolver;
+}
+
+
+/**
+ * Reserves the memory of an array in the MemoryBudget.
+ * The arrays which will be mapped to a scratch file do not use the physical memory and are not reserved.
+ */
+bool PanelAnalysis::reserveMemory(size_t nBytes, size_t &reserved)
+{
+    releaseMemory(reserved);
+    if(MappedStorage::isEnabled() && double(nBytes)>MappedStorage::threshold()*1024.0*1024.0) return true;
+    if(!MemoryBudget::reserve(nBytes)) return false;
+    reserved = nBytes;
+    return true;
+}
+
+
+void PanelAnalysis::releaseMemory(size_t &reserved)
+{
+    MemoryBudget::release(reserved);
+    reserved = 0;
+}
+
+
+/** The memory used by the analysis arrays, in bytes, including the arrays mapped to scratch files */
+size_t PanelAnalysis::memoryFootprint() const
+{
+    size_t n = MemoryBudget::bytes(m_aijd) + MemoryBudget::bytes(m_aijf) + MemoryBudget::bytes(m_ipiv)
+             + MemoryBudget::bytes(m_aijRef) + MemoryBudget::bytes(m_LURef) + MemoryBudget::bytes(m_ipivRef)
+             + MemoryBudget::bytes(m_UpdateDRows) + MemoryBudget::bytes(m_UpdateZ) + MemoryBudget::bytes(m_UpdateK)
+             + m_HMatrix.memorySize() + MemoryBudget::bytes(m_WakeCoef)
+             + MemoryBudget::bytes(m_PrecondLU) + m_Multilevel.memorySize() + MemoryBudget::bytes(m_LastSolution)
+             + MemoryBudget::bytes(m_uRHS) + MemoryBudget::bytes(m_vRHS) + MemoryBudget::bytes(m_wRHS)
+             + MemoryBudget::bytes(m_pRHS) + MemoryBudget::bytes(m_qRHS) + MemoryBudget::bytes(m_rRHS) + MemoryBudget::bytes(m_cRHS)
+             + MemoryBudget::bytes(m_UnitSigma) + MemoryBudget::bytes(m_RHSCoef)
+             + MemoryBudget::bytes(m_uVLocal) + MemoryBudget::bytes(m_vVLocal) + MemoryBudget::bytes(m_wVLocal)
+             + MemoryBudget::bytes(m_Cp) + MemoryBudget::bytes(m_Mu) + MemoryBudget::bytes(m_Sigma)
+             + MemoryBudget::bytes(m_Vorton) + MemoryBudget::bytes(m_VortexNeg);
+    return n;
+}
+
+
 /**
  * Reserves the memory necessary to matrix arrays.
+ * If the dense matrix does not fit in the MemoryBudget, the methods which support it fall back on the
+ * compressed matrix and the iterative solver; the others do not start.
  * @return true if the memory could be allocated, false otherwise.
  */
 bool PanelAnalysis::allocateMatrix(int N)
 {
-    uint matSize = uint(N);
+    m_bCompressed = false;
+    m_bMatrixFree = false;
+    m_bDistributed = false;
+    releaseMemory(m_MatrixBytes);
+    if(m_pDistributedSolver) m_pDistributedSolver->release();
+
+    if(m_pPolar3d && s_bDistributedSolver && DistributedSolver::isAvailable())
+    {
+        if(bCompressibleMatrix() && N==nPanels())
+        {
+            // the matrix is evaluated by tiles on each rank in distributedFactorize(), from the implicit coefficients
+            size_t nBytes = DistributedSolver::localBytes(N);
+            if(!reserveMemory(nBytes, m_MatrixBytes))
+            {
+                traceStdLog("      The local tiles of " + MemoryBudget::sizeString(nBytes) + " of the distributed matrix exceed the memory budget\n");
+                return false;
+            }
+            m_bDistributed = true;
+            m_bMatrixFree = true;
+            m_aijd.clear();
+            m_aijd.shrink_to_fit();
+            m_aijf.clear();
+            m_aijf.shrink_to_fit();
+            return true;
+        }
+        traceStdLog("      The distributed solver is not available for this method, using the local solvers\n");
+    }
+
+    if(m_pPolar3d && (m_pPolar3d->bCompressedMatrix() || m_pPolar3d->bMatrixFree()))
+    {
+        if(bCompressibleMatrix() && N==nPanels())
+        {
+            // the matrix is built in makeInfluenceMatrix(), or not at all
+            m_bMatrixFree = m_pPolar3d->bMatrixFree();
+            m_bCompressed = !m_bMatrixFree;
+            m_aijd.clear();
+            m_aijd.shrink_to_fit();
+            m_aijf.clear();
+            m_aijf.shrink_to_fit();
+            return true;
+        }
+        traceStdLog("      The compressed and matrix-free modes are not available for this method, using the dense matrix\n");
+    }
+
+    size_t matSize = size_t(N);
 
-    uint size2 = matSize * matSize;
+    size_t size2 = matSize * matSize;
     double gb=0;
 
+    size_t nBytes = size2 * (s_bDoublePrecision ? sizeof(double) : sizeof(float));
+    if(bMixedPrecision()) nBytes += size2 * sizeof(float);
+    if(!reserveMemory(nBytes, m_MatrixBytes))
+    {
+        std::string strong = "      The influence matrix of " + MemoryBudget::sizeString(nBytes) + " exceeds the memory budget of "
+                           + QString::asprintf("%.0f MB", MemoryBudget::budget()).toStdString()
+                           + " (" + MemoryBudget::sizeString(MemoryBudget::reserved()) + " in use by the running analyses)\n";
+        if(bCompressibleMatrix() && N==nPanels())
+        {
+            traceStdLog(strong + "      Using the compressed matrix and the iterative solver\n");
+            m_bCompressed = true;
+            m_aijd.clear();
+            m_aijd.shrink_to_fit();
+            m_aijf.clear();
+            m_aijf.shrink_to_fit();
+            return true;
+        }
+        traceStdLog(strong + "      Raise the budget or enable the scratch file storage of the matrix\n");
+        return false;
+    }
+
     try
     {
         if(s_bDoublePrecision)
         {
             m_aijd.resize(size2);
-            memset(m_aijd.data(), 0, size2 * sizeof(double));
+            zeroRowBlocks(m_aijd.data(), N, m_nBlocks, s_bMultiThread);
             m_aijf.clear();
 
             gb = size2 * sizeof(double) /1024/1024;
+
+            if(bMixedPrecision())
+            {
+                // the single precision copy holds the LU factors, the double precision matrix is kept for the residuals
+                gb += size2 * sizeof(float) /1024/1024;
+                m_aijf.resize(size2);
+                zeroRowBlocks(m_aijf.data(), N, m_nBlocks, s_bMultiThread);
+            }
         }
         else
         {
             m_aijf.resize(size2);
-            memset(m_aijf.data(), 0, size2 * sizeof(float));
+            zeroRowBlocks(m_aijf.data(), N, m_nBlocks, s_bMultiThread);
             m_aijd.clear();
 
             gb = size2 * sizeof(float) /1024/1024;
@@ -118,6 +314,7 @@ bool PanelAnalysis::allocateMatrix(int N)
     }
     catch(std::bad_alloc &exception)
     {
+        releaseMemory(m_MatrixBytes);
         QString strong(exception.what());
         strong += ": error allocating memory for the influence matrix\n";
         strong += QString::asprintf("Request for %7.2f Mb failed\n", gb);
@@ -126,6 +323,7 @@ bool PanelAnalysis::allocateMatrix(int N)
     }
     catch(...)
     {
+        releaseMemory(m_MatrixBytes);
         QString strong("Undetermined error during memory allocation for the influence matrix\n");
         strong += QString::asprintf("Request for %7.2f Mb failed\n", gb);
         traceLog(strong);
@@ -134,9 +332,48 @@ bool PanelAnalysis::allocateMatrix(int N)
 
     gb += matSize * sizeof(int)/1024/1024;
 
+    if(MappedStorage::isMapped(s_bDoublePrecision ? static_cast<void const*>(m_aijd.data()) : static_cast<void const*>(m_aijf.data())))
+        traceLog(QString::asprintf("      Influence matrix of %.1f Mb mapped to a scratch file\n", gb));
+
     return true;
 }
 
+/** Sets the number of threads used by the block kernels; the process-wide pool is resized accordingly */
+void PanelAnalysis::setMaxThreadCount(int maxthreads)
+{
+    s_MaxThreads = std::max(maxthreads, 1);
+    ThreadPool::setMaxThreadCount(s_MaxThreads);
+}
+
+
+/**
+ * Sets the number of threads used by this analysis, for when several analyses share the cores.
+ * The count is capped by the process-wide count; the block kernels and the MKL calls are sized accordingly.
+ */
+void PanelAnalysis::setThreadCount(int nThreads)
+{
+    m_nThreads = std::max(1, std::min(nThreads, s_MaxThreads));
+    m_nBlocks  = ThreadPool::nBlocks(m_nThreads);
+}
+
+
+/**
+ * Sets the number of threads of the MKL calls, independently of the number of block threads,
+ * so that the split between the two levels can be tuned; 0 uses the analysis' thread count.
+ */
+void PanelAnalysis::setBlasThreads(int nThreads)
+{
+    s_BlasThreads = std::max(0, nThreads);
+}
+
+
+/** @return the number of threads of this analysis' MKL calls */
+int PanelAnalysis::blasThreadCount() const
+{
+    return s_BlasThreads>0 ? s_BlasThreads : m_nThreads;
+}
+
+
 void PanelAnalysis::traceLog(QString const &str) const
 {
     traceStdLog(str.toStdString());
@@ -144,7 +381,7 @@ void PanelAnalysis::traceLog(QString const &str) const
 
 void PanelAnalysis::traceStdLog(std::string const &str) const
 {
-    m_ErrorLog.append(str);
+    xfl::appendToLog(m_ErrorLog, str, 1<<20);
 }
 
 
@@ -184,6 +421,7 @@ void PanelAnalysis::releasePanelArrays()
 {
     m_uRHS.clear();
     m_wRHS.clear();
+    m_RHSCoef.clear();
 }
 
 
@@ -194,26 +432,55 @@ bool PanelAnalysis::LUfactorize()
 {
 #ifdef INTEL_MKL
     if(s_bMultiThread)
-        MKL_Set_Num_Threads_Local(s_MaxThreads);
+        MKL_Set_Num_Threads_Local(blasThreadCount());
     else
         MKL_Set_Num_Threads_Local(1);
 #endif
 
-    lapack_int n = matSize();
-    lapack_int lda = matSize();
+    clearFactorizationUpdate();
+    releaseGpuFactors();
+
+    if(m_bDistributed) return distributedFactorize();
+
+    if(bIterativeSolve())
+    {
+        if(!makeBlockJacobiPreconditioner()) return false;
+        makeMultilevelPreconditioner();
+        return true;
+    }
+
+    int n = matSize();
     m_ipiv.resize(matSize());
-    lapack_int info = -1;
+    int info = -1;
 
-    if(s_bDoublePrecision)
+    // the CPU factorization is made by blocks of columns so that a cancelled task stops within one block
+    auto cancelled = [this]() {return isCancelled();};
+
+    if(bMixedPrecision())
+    {
+        size_t size2 = size_t(n)*size_t(n);
+        m_aijf.resize(size2);
+        for(size_t i=0; i<size2; i++) m_aijf[i] = float(m_aijd.at(i));
+        if(gpuFactorize(false)) info = 0;
+        else info = matrix::LUfactorizeBlocked(n, m_aijf.data(), m_ipiv.data(), cancelled);
+    }
+    else if(s_bDoublePrecision)
     {
-        dgetrf_(&n, &n, m_aijd.data(), &lda, m_ipiv.data(), &info);
+        if(gpuFactorize(true)) info = 0;
+        else info = matrix::LUfactorizeBlocked(n, m_aijd.data(), m_ipiv.data(), cancelled);
     }
     else
     {
         //solve single precision
-        sgetrf_(&n, &n, m_aijf.data(), &lda, m_ipiv.data(), &info);
+        if(gpuFactorize(false)) info = 0;
+        else info = matrix::LUfactorizeBlocked(n, m_aijf.data(), m_ipiv.data(), cancelled);
     }
 
+    if(isCancelled())
+    {
+        traceStdLog("         LU factorization interrupted\n");
+        return false;
+    }
     if(info>0 || info <0)
     {
         traceStdLog("         Singular Matrix.... Aborting calculation...\n");
@@ -225,166 +492,1326 @@ bool PanelAnalysis::LUfactorize()
 
 
 /**
-* Solves the linear system for the unit RHS, using LU decomposition
+ * Factorizes the matrix on the GPU, in double precision from m_aijd or in single precision from m_aijf.
+ * The factors are copied back in place, so that the host solvers, the LUCache and the checkpoints work unchanged;
+ * the device keeps its copy for the back-substitutions.
+ * @return false if the GPU solver is disabled or unavailable, or if the factorization failed; the matrix is then unchanged.
+ */
+bool PanelAnalysis::gpuFactorize(bool bDouble)
+{
+    if(!s_bGpuSolver || !GpuSolver::isAvailable() || !hasDenseMatrix()) return false;
+
+    if(!m_pGpuSolver) m_pGpuSolver = new GpuSolver;
+    int n = matSize();
+    bool bFactorized = bDouble ? m_pGpuSolver->factorize(m_aijd.data(), n, m_aijd.data(), m_ipiv.data())
+                               : m_pGpuSolver->factorize(m_aijf.data(), n, m_aijf.data(), m_ipiv.data());
+    if(!bFactorized)
+    {
+        traceStdLog("      The GPU factorization failed, reverting to the CPU\n");
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Assembles and factorizes the matrix over the ranks of the MPI job; each rank evaluates the coefficients of its tiles
+ * as in the matrix-free mode, i.e. the panel influences and the wake coefficients made in makeInfluenceMatrix().
+ * The factorization is always made in double precision.
+ */
+bool PanelAnalysis::distributedFactorize()
+{
+    if(!m_pDistributedSolver) m_pDistributedSolver = new DistributedSolver;
+
+    traceLog(QString::asprintf("      Factorizing the matrix over %d ranks\n", DistributedSolver::nRanks()));
+    if(!m_pDistributedSolver->factorize(matSize(), [this](int i, int k) {return matrixCoef(i,k);}))
+    {
+        traceStdLog("         Singular Matrix or distributed solver failure.... Aborting calculation...\n");
+        return false;
+    }
+    return true;
+}
+
+
+/** Discards the device copy of the factors, which no longer match those of the host */
+void PanelAnalysis::releaseGpuFactors()
+{
+    if(m_pGpuSolver) m_pGpuSolver->release();
+}
+
+
+/**
+* Solves the linear system for the unit RHS, using LU decomposition.
+* The non-null RHS are packed in a single column-major block and back-substituted with one call to getrs.
 */
 void PanelAnalysis::backSubUnitRHS(double *uRHS, double *vRHS, double *wRHS, double *pRHS, double *qRHS, double *rRHS)
+{
+    int n = matSize();
+
+    std::vector<double*> rhs;
+    if(uRHS) rhs.push_back(uRHS);
+    if(vRHS) rhs.push_back(vRHS);
+    if(wRHS) rhs.push_back(wRHS);
+    if(pRHS) rhs.push_back(pRHS);
+    if(qRHS) rhs.push_back(qRHS);
+    if(rRHS) rhs.push_back(rRHS);
+
+    if(rhs.size()==0) return;
+
+    if(rhs.size()==1)
+    {
+        backSubRHSBlock(rhs.front(), 1);
+        return;
+    }
+
+    std::vector<double> block(rhs.size()*size_t(n));
+    for(uint ir=0; ir<rhs.size(); ir++)
+        memcpy(block.data()+ir*size_t(n), rhs.at(ir), size_t(n)*sizeof(double));
+
+    if(!backSubRHSBlock(block.data(), int(rhs.size()))) return;
+
+    for(uint ir=0; ir<rhs.size(); ir++)
+        memcpy(rhs.at(ir), block.data()+ir*size_t(n), size_t(n)*sizeof(double));
+}
+
+
+bool PanelAnalysis::backSubRHS(std::vector<double> &RHS)
+{
+    if(int(RHS.size())!=matSize())
+    {
+        traceStdLog("      Error back-solving the RHS: size mismatch\n");
+        return false;
+    }
+    return backSubRHSBlock(RHS.data(), 1);
+}
+
+
+/**
+ * Back-substitutes a block of nRHS right hand side vectors with a single LAPACK call.
+ * The vectors are stored one after the other, i.e. in column-major order with leading dimension matSize().
+ * The solutions overwrite the RHS
+ */
+bool PanelAnalysis::backSubRHSBlock(double *RHS, int nRHS)
+{
+    if(!RHS || nRHS<=0) return true;
+
+    if(m_bDistributed)
+        return m_pDistributedSolver && m_pDistributedSolver->isFactorized(matSize()) && m_pDistributedSolver->solve(false, RHS, nRHS);
+
+    if(bIterativeSolve())
+        return solveIterative(RHS, nRHS);
+
+    if(m_pFrozenPA)
+        return backSubFrozen(RHS, nRHS);
+
+    if(bMixedPrecision())
+        return backSubRefined(RHS, nRHS);
+
+    if(!LUsolve(RHS, nRHS, s_bDoublePrecision)) return false;
+
+    if(hasFactorizationUpdate()) applyFactorizationUpdate(RHS, nRHS);
+    return true;
+}
+
+
+/**
+ * Solves the transposed system A^T.L = G for a block of nG vectors, with the factorization of A.
+ * If G is the gradient of an objective w.r.t. the doublet strengths, L is the adjoint vector from which
+ * the derivative of the objective w.r.t. any geometric variable x is -L.(dA/dx.Mu - dRHS/dx),
+ * i.e. one back-substitution per objective instead of one solve per variable.
+ * @return false if the matrix is not factorized, i.e. with the iterative solver,
+ * or if the factorization has been obtained by low-rank update.
+ */
+bool PanelAnalysis::backSubAdjoint(double *G, int nG)
+{
+    if(!G || nG<=0) return true;
+    if(m_bDistributed)
+        return m_pDistributedSolver && m_pDistributedSolver->isFactorized(matSize()) && m_pDistributedSolver->solve(true, G, nG);
+    if(!hasDenseMatrix() || bIterativeSolve() || hasFactorizationUpdate()) return false;
+
+    if(m_pFrozenPA)
+    {
+        double maxres = 0.0;
+        return refinedSolve(m_pFrozenPA, !bMixedPrecision(), G, nG, true, s_MaxFrozenSteps, maxres) && maxres<s_RefinementTolerance;
+    }
+
+    if(bMixedPrecision())
+        return backSubRefined(G, nG, true);
+
+    return LUsolve(G, nG, s_bDoublePrecision, true);
+}
+
+
+/**
+ * Back-substitutes the block of RHS with the LU factors stored in m_aijd if bDouble, else in m_aijf.
+ * The matrix is stored row-major, i.e. the factors are those of A^T for LAPACK, so that the system A.X=B
+ * is solved with LAPACK's transposed solve, and the adjoint system A^T.X=B with the plain solve.
+ */
+bool PanelAnalysis::LUsolve(double *RHS, int nRHS, bool bDouble, bool bTranspose) const
 {
 #ifdef INTEL_MKL
     if(s_bMultiThread)
-        mkl_set_num_threads(s_MaxThreads);
+        MKL_Set_Num_Threads_Local(blasThreadCount());
     else
-        mkl_set_num_threads(1);
+        MKL_Set_Num_Threads_Local(1);
 #endif
-    char trans = 'T';
-    lapack_int n = matSize();
-    lapack_int lda = matSize();
 
-    //LU solve
-    lapack_int nrhs = 1;
+    char trans = bTranspose ? 'N' : 'T';
+
+    // the host holds the same factors if the device fails
+    if(m_pGpuSolver && m_pGpuSolver->isFactorized(matSize(), bDouble) && m_pGpuSolver->solve(trans, RHS, nRHS))
+        return true;
+
+    lapack_int n = matSize();
+    lapack_int lda = n;
+    lapack_int nrhs = nRHS;
     lapack_int ldb = n;
     lapack_int info = 0;
+    lapack_int *ipiv = const_cast<lapack_int*>(m_ipiv.data());
 
-    if(s_bDoublePrecision)
+    if(bDouble)
     {
+        double *LU = const_cast<double*>(m_aijd.data());
 #ifdef OPENBLAS
-        if(uRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), uRHS, &ldb, &info, 1);
-        if(vRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), vRHS, &ldb, &info, 1);
-        if(wRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), wRHS, &ldb, &info, 1);
-        if(pRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), pRHS, &ldb, &info, 1);
-        if(qRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), qRHS, &ldb, &info, 1);
-        if(rRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), rRHS, &ldb, &info, 1);
+        dgetrs_(&trans, &n, &nrhs, LU, &lda, ipiv, RHS, &ldb, &info, 1);
 #elif defined INTEL_MKL
-        if(uRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), uRHS, &ldb, &info);
-        if(vRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), vRHS, &ldb, &info);
-        if(wRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), wRHS, &ldb, &info);
-        if(pRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), pRHS, &ldb, &info);
-        if(qRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), qRHS, &ldb, &info);
-        if(rRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), rRHS, &ldb, &info);
+        dgetrs_(&trans, &n, &nrhs, LU, &lda, ipiv, RHS, &ldb, &info);
 #elif defined ACCELERATE
-        if(uRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), uRHS, &ldb, &info);
-        if(vRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), vRHS, &ldb, &info);
-        if(wRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), wRHS, &ldb, &info);
-        if(pRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), pRHS, &ldb, &info);
-        if(qRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), qRHS, &ldb, &info);
-        if(rRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), rRHS, &ldb, &info);
+        dgetrs_(&trans, &n, &nrhs, LU, &lda, ipiv, RHS, &ldb, &info);
 #endif
-        if(info!=0)
-        {
-            traceStdLog("Error back-substituting\n");
-        }
     }
     else
     {
         //solve single precision
-        std::vector<float> srhs(n);
-        if(uRHS)
-        {
-            for(int i=0; i<n; i++) srhs[i] = float(uRHS[i]);
+        float *LU = const_cast<float*>(m_aijf.data());
+        size_t blocksize = size_t(n)*size_t(nRHS);
+        std::vector<float> srhs(blocksize);
+        for(size_t i=0; i<blocksize; i++) srhs[i] = float(RHS[i]);
 #ifdef OPENBLAS
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info, 1);
+        sgetrs_(&trans, &n, &nrhs, LU, &lda, ipiv, srhs.data(), &ldb, &info, 1);
 #elif defined INTEL_MKL
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
+        sgetrs_(&trans, &n, &nrhs, LU, &lda, ipiv, srhs.data(), &ldb, &info);
 #elif defined ACCELERATE
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
+        sgetrs_(&trans, &n, &nrhs, LU, &lda, ipiv, srhs.data(), &ldb, &info);
 #endif
-            for(int i=0; i<n; i++) uRHS[i] = double(srhs.at(i));
-        }
-        if(vRHS)
-        {
-            for(int i=0; i<n; i++) srhs[i] = float(vRHS[i]);
-#ifdef OPENBLAS
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info, 1);
-#elif defined INTEL_MKL
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#elif ACCELERATE
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#endif
-            for(int i=0; i<n; i++) vRHS[i] = double(srhs.at(i));
-        }
-        if(wRHS)
-        {
-            for(int i=0; i<n; i++) srhs[i] = float(wRHS[i]);
-#ifdef OPENBLAS
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info, 1);
-#elif defined INTEL_MKL
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#elif defined ACCELERATE
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#endif
-            for(int i=0; i<n; i++) wRHS[i] = double(srhs.at(i));
-        }
-        if(pRHS)
+        for(size_t i=0; i<blocksize; i++) RHS[i] = double(srhs.at(i));
+    }
+
+    if(info!=0)
+    {
+        traceStdLog("      Error back-solving the RHS\n");
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Evaluates the residuals R = B - A.X, or R = B - A^T.X if bTranspose, with the double precision matrix
+ * stored in m_aijd before factorization.
+ * Each row of the matrix is read once for all the RHS; in the transposed case, the threads own
+ * contiguous ranges of columns so that the rows are still read sequentially.
+ */
+void PanelAnalysis::residual(double const *B, double const *X, double *R, int nRHS, bool bTranspose) const
+{
+    int N = matSize();
+    int nBlocks = std::max(1, std::min(m_nBlocks, N));
+
+    if(!bTranspose)
+    {
+        ThreadPool::pool().parallelFor(nBlocks, [this, N, nRHS, nBlocks, B, X, R](int iBlock)
         {
-            for(int i=0; i<n; i++) srhs[i] = float(pRHS[i]);
-#ifdef OPENBLAS
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info, 1);
-#elif defined INTEL_MKL
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#elif defined ACCELERATE
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#endif
-            for(int i=0; i<n; i++) pRHS[i] = double(srhs.at(i));
-        }
-        if(qRHS)
+            for(int i=iBlock; i<N; i+=nBlocks)
+            {
+                double const *row = m_aijd.data() + size_t(i)*size_t(N);
+                for(int j=0; j<nRHS; j++)
+                {
+                    double const *x = X + size_t(j)*N;
+                    double sum = 0.0;
+                    for(int k=0; k<N; k++) sum += row[k]*x[k];
+                    R[size_t(j)*N+i] = B[size_t(j)*N+i] - sum;
+                }
+            }
+        });
+    }
+    else
+    {
+        ThreadPool::pool().parallelFor(nBlocks, [this, N, nRHS, nBlocks, B, X, R](int iBlock)
         {
-            for(int i=0; i<n; i++) srhs[i] = float(qRHS[i]);
-#ifdef OPENBLAS
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info, 1);
-#elif defined INTEL_MKL
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#elif defined ACCELERATE
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#endif
-            for(int i=0; i<n; i++) qRHS[i] = double(srhs.at(i));
-        }
-        if(rRHS)
+            int k0 = int(size_t(N)*size_t(iBlock)/size_t(nBlocks));
+            int k1 = int(size_t(N)*size_t(iBlock+1)/size_t(nBlocks));
+            for(int j=0; j<nRHS; j++)
+                for(int k=k0; k<k1; k++) R[size_t(j)*N+k] = B[size_t(j)*N+k];
+
+            for(int i=0; i<N; i++)
+            {
+                double const *row = m_aijd.data() + size_t(i)*size_t(N);
+                for(int j=0; j<nRHS; j++)
+                {
+                    double xi = X[size_t(j)*N+i];
+                    double *r = R + size_t(j)*N;
+                    for(int k=k0; k<k1; k++) r[k] -= row[k]*xi;
+                }
+            }
+        });
+    }
+}
+
+
+/**
+ * Solves A.X = B, or A^T.X = B if bTranspose, with the LU factors held by pLU, then refines the solutions
+ * with the residuals evaluated with the double precision matrix stored in m_aijd.
+ * The factors are either the single precision factors of the same matrix, or those of a nearby matrix;
+ * in the latter case the refinement is a defect correction which converges as long as the two matrices are close.
+ * The refinement stops when the relative residual of all the RHS is below s_RefinementTolerance,
+ * or after maxsteps steps.
+ * @param bDoubleLU true if the factors are stored in pLU's double precision array
+ * @param maxres the max. relative residual of the RHS on output
+ */
+bool PanelAnalysis::refinedSolve(PanelAnalysis const *pLU, bool bDoubleLU, double *RHS, int nRHS, bool bTranspose, int maxsteps, double &maxres) const
+{
+    int N = matSize();
+    size_t blocksize = size_t(N)*size_t(nRHS);
+
+    std::vector<double> B(RHS, RHS+blocksize);
+    std::vector<double> R(blocksize);
+
+    std::vector<double> bnorm(nRHS, 0.0);
+    for(int j=0; j<nRHS; j++)
+    {
+        double const *b = B.data()+size_t(j)*N;
+        for(int i=0; i<N; i++) bnorm[j] += b[i]*b[i];
+        bnorm[j] = sqrt(bnorm[j]);
+    }
+
+    bool bSuccess = pLU->LUsolve(RHS, nRHS, bDoubleLU, bTranspose);
+
+    maxres = 0.0;
+    for(int iter=0; bSuccess && iter<=maxsteps; iter++)
+    {
+        residual(B.data(), RHS, R.data(), nRHS, bTranspose);
+
+        maxres = 0.0;
+        for(int j=0; j<nRHS; j++)
         {
-            for(int i=0; i<n; i++) srhs[i] = float(rRHS[i]);
-#ifdef OPENBLAS
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info, 1);
-#elif defined INTEL_MKL
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#elif defined ACCELERATE
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#endif
-            for(int i=0; i<n; i++) rRHS[i] = double(srhs.at(i));
+            double const *r = R.data()+size_t(j)*N;
+            double rnorm = 0.0;
+            for(int i=0; i<N; i++) rnorm += r[i]*r[i];
+            if(bnorm[j]>0.0) maxres = std::max(maxres, sqrt(rnorm)/bnorm[j]);
         }
+        if(maxres<s_RefinementTolerance || iter==maxsteps) break;
+
+        bSuccess = pLU->LUsolve(R.data(), nRHS, bDoubleLU, bTranspose);
+        for(size_t i=0; i<blocksize; i++) RHS[i] += R[i];
     }
+
+    return bSuccess;
 }
 
 
-bool PanelAnalysis::backSubRHS(std::vector<double> &RHS)
+/**
+ * Mixed precision solve: the RHS are back-substituted with the single precision LU factors,
+ * then the solutions are refined with the residuals evaluated with the double precision matrix.
+ * The refinement stops when the relative residual of all the RHS is below s_RefinementTolerance,
+ * or after s_MaxRefinementSteps steps.
+ */
+bool PanelAnalysis::backSubRefined(double *RHS, int nRHS, bool bTranspose)
+{
+    double maxres = 0.0;
+    bool bSuccess = refinedSolve(this, false, RHS, nRHS, bTranspose, s_MaxRefinementSteps, maxres);
+
+    if(bSuccess && maxres>=s_RefinementTolerance)
+        traceStdLog(QString::asprintf("      Mixed precision: relative residual %g after %d refinement steps\n", maxres, s_MaxRefinementSteps).toStdString());
+
+    return bSuccess;
+}
+
+
+/**
+ * Uses the LU factors of a nearby matrix to solve the system assembled in m_aijd, which is left unfactorized.
+ * This is intended for the small geometric perturbations of a sensitivity analysis, where the defect correction
+ * costs a few matrix-vector products instead of a new factorization.
+ * The factors must remain valid until the frozen factorization is cleared, and are only used in double precision
+ * with a dense matrix.
+ * @param pRefPA the reference analysis, or nullptr to clear the frozen factorization
+ * @return true if the reference factorization can be used for this analysis' matrix.
+ */
+bool PanelAnalysis::setFrozenFactorization(PanelAnalysis const *pRefPA)
 {
-    int matsize = int(RHS.size());
+    m_pFrozenPA = nullptr;
+    if(!pRefPA || pRefPA==this) return false;
+    if(!s_bDoublePrecision) return false;
+    if(!hasDenseMatrix() || bIterativeSolve()) return false;
+    if(!pRefPA->hasDenseMatrix() || pRefPA->bIterativeSolve() || pRefPA->hasFactorizationUpdate()) return false;
+    if(pRefPA->matSize()!=matSize() || int(pRefPA->m_ipiv.size())!=matSize()) return false;
+
+    size_t size2 = size_t(matSize())*size_t(matSize());
+    if(bMixedPrecision()) { if(pRefPA->m_aijf.size()!=size2) return false; }
+    else                  { if(pRefPA->m_aijd.size()!=size2) return false; }
+
+    m_pFrozenPA = pRefPA;
+    return true;
+}
+
+
+/**
+ * Solves the RHS by defect correction with the frozen factorization;
+ * if the correction does not converge, the matrix is factorized and the RHS are solved directly.
+ */
+bool PanelAnalysis::backSubFrozen(double *RHS, int nRHS)
+{
+    std::vector<double> B(RHS, RHS+size_t(matSize())*size_t(nRHS));
+
+    double maxres = 0.0;
+    if(refinedSolve(m_pFrozenPA, !bMixedPrecision(), RHS, nRHS, false, s_MaxFrozenSteps, maxres) && maxres<s_RefinementTolerance)
+        return true;
+
+    traceStdLog(QString::asprintf("      Frozen factorization: relative residual %g, factorizing the matrix\n", maxres).toStdString());
+    m_pFrozenPA = nullptr;
+    if(!LUfactorize()) return false;
+
+    memcpy(RHS, B.data(), B.size()*sizeof(double));
+    return backSubRHSBlock(RHS, nRHS);
+}
+
+
+/**
+ * @return the key of the factorization of the current matrix in the LUCache, made of the mesh hash
+ * and of the settings which change the matrix coefficients, or 0 if the matrix cannot be cached.
+ */
+std::uint64_t PanelAnalysis::factorizationKey() const
+{
+    if(!m_pPolar3d || !hasDenseMatrix() || bIterativeSolve()) return 0;
+
+    std::uint64_t h = meshHash();
+    if(h==0) return 0;
+
+    LUCache::hash(h, matSize());
+    hashMatrixSettings(h);
+    return h;
+}
+
+
+/** Accumulates the settings which change the coefficients of the influence matrix in the hash */
+void PanelAnalysis::hashMatrixSettings(std::uint64_t &h) const
+{
+    LUCache::hash(h, int(m_pPolar3d->analysisMethod()));
+    LUCache::hash(h, int(m_pPolar3d->bDirichlet()));
+    LUCache::hash(h, int(m_pPolar3d->bGroundEffect()));
+    LUCache::hash(h, int(m_pPolar3d->bFreeSurfaceEffect()));
+    LUCache::hash(h, m_pPolar3d->groundHeight());
+    LUCache::hash(h, m_pPolar3d->TrefftzDistance()); // the far end of the VLM trailing legs
+    LUCache::hash(h, int(s_bDoublePrecision));
+    LUCache::hash(h, int(bMixedPrecision()));
+
+    // the global settings of the influence calculations
+    LUCache::hash(h, Vortex::coreRadius());
+    LUCache::hash(h, Panel::RFF());
+    LUCache::hash(h, Panel4::ctrlPtFracPos());
+    LUCache::hash(h, Panel4::vortexFracPos());
+    LUCache::hash(h, Panel3::quadratureOrder());
+    LUCache::hash(h, int(Panel3::usingNintcheuFataMethod()));
+}
+
+
+/**
+ * @return the key of the shared block in the InfluenceBlockCache, made of the geometry of the block's panels
+ * and of the matrix settings, or 0 if the block cannot be shared.
+ * The key does not depend on the other panels nor on the position of the block in the matrix.
+ */
+std::uint64_t PanelAnalysis::sharedBlockKey() const
+{
+    if(!m_pPolar3d || m_SharedBlockSize<=0) return 0;
+    if(m_SharedBlockFirst<0 || m_SharedBlockFirst+m_SharedBlockSize>nPanels()) return 0;
+    // the rows of a panel are contiguous, and the single precision matrix would not hold the cached coefficients
+    if(nPanels()==0 || matSize()%nPanels()!=0 || !s_bDoublePrecision || !hasDenseMatrix()) return 0;
+
+    std::uint64_t h = InfluenceBlockCache::isEnabled() ? LUCache::hashSeed() : 0;
+    if(h==0) return 0;
+
+    LUCache::hash(h, m_SharedBlockSize);
+    LUCache::hash(h, matSize()/nPanels());
+    // the connections are indices in the whole mesh and do not change the block's coefficients
+    for(int p=m_SharedBlockFirst; p<m_SharedBlockFirst+m_SharedBlockSize; p++)
+        hashPanelGeometry(h, *panelAt(p));
+    hashMatrixSettings(h);
+    return h;
+}
+
+
+/**
+ * Fetches the shared block from the InfluenceBlockCache, so that influenceRow() does not evaluate its coefficients.
+ * To be called before the assembly of the matrix.
+ * @return true if the block was found.
+ */
+bool PanelAnalysis::fetchSharedBlock()
+{
+    m_SharedBlock.clear();
+    std::uint64_t key = sharedBlockKey();
+    if(key==0) return false;
+    if(!InfluenceBlockCache::fetch(key, sharedBlockRows(), m_SharedBlock)) return false;
+    traceLog(QString::asprintf("      Reusing the influence block of %d panels\n", m_SharedBlockSize));
+    return true;
+}
+
+
+/**
+ * Stores the shared block of the assembled matrix in the InfluenceBlockCache;
+ * to be called after the assembly of the matrix and before the wake contribution is added.
+ */
+void PanelAnalysis::storeSharedBlock()
+{
+    if(hasSharedBlock() || m_bMatrixError || isCancelled()) return;
+    std::uint64_t key = sharedBlockKey();
+    if(key==0) return;
+
+    int nb = sharedBlockRows();
+    int r0 = m_SharedBlockFirst * (matSize()/nPanels());
+    size_t N = size_t(matSize());
+    std::vector<double> block(size_t(nb)*size_t(nb));
+    for(int i=0; i<nb; i++)
+    {
+        double const *row = m_aijd.data() + size_t(r0+i)*N + size_t(r0);
+        std::copy(row, row+nb, block.data()+size_t(i)*size_t(nb));
+    }
+    InfluenceBlockCache::store(key, nb, block);
+}
+
+
+/**
+ * Fetches the factorization of the current matrix from the LUCache.
+ * Must be called after allocateMatrix() and after the panels and wake panels have been built.
+ * @return true if the factorization was found, in which case the matrix assembly and the LU factorization can be skipped.
+ */
+bool PanelAnalysis::restoreFactorization()
+{
+    m_FactorizationKey = LUCache::isEnabled() ? factorizationKey() : 0;
+    if(m_FactorizationKey==0) return false;
+
+    if(!LUCache::fetch(m_FactorizationKey, matSize(), s_bDoublePrecision, m_aijd.data(), m_aijd.size(), m_aijf.data(), m_aijf.size(), m_ipiv))
+        return false;
+
+    // the reference matrix does not match these factors
+    clearFactorizationUpdate();
+    releaseGpuFactors();
+    m_aijRef.clear();
+    return true;
+}
+
+
+/** Stores a copy of the current factorization in the LUCache, using the key evaluated in restoreFactorization() */
+void PanelAnalysis::storeFactorization() const
+{
+    if(m_FactorizationKey==0) return;
+    LUCache::store(m_FactorizationKey, matSize(), s_bDoublePrecision, m_aijd.data(), m_aijd.size(), m_aijf.data(), m_aijf.size(), m_ipiv);
+}
+
+
+/**
+ * Reads the factorization of the current matrix from the checkpoint of an interrupted task.
+ * Must be called after allocateMatrix() and after the panels and wake panels have been built.
+ * @return true if the checkpoint holds the factorization of this matrix.
+ */
+bool PanelAnalysis::restoreFactorization(TaskCheckpoint const &checkpoint)
+{
+    std::uint64_t key = factorizationKey();
+    if(!checkpoint.loadFactorization(key, matSize(), s_bDoublePrecision, m_aijd.data(), m_aijd.size(), m_aijf.data(), m_aijf.size(), m_ipiv))
+        return false;
+
+    clearFactorizationUpdate();
+    releaseGpuFactors();
+    m_aijRef.clear();
+    return true;
+}
+
+
+/** Writes the current factorization to the checkpoint of the task */
+void PanelAnalysis::storeFactorization(TaskCheckpoint const &checkpoint) const
+{
+    checkpoint.storeFactorization(factorizationKey(), matSize(), s_bDoublePrecision, m_aijd.data(), m_aijd.size(), m_aijf.data(), m_aijf.size(), m_ipiv);
+}
+
+
+/**
+ * @return true if a reference matrix and its factorization are available, so that the factorization
+ * of the next matrix may be obtained by a low-rank update.
+ */
+bool PanelAnalysis::canUpdateFactorization() const
+{
+    if(!s_bLowRankUpdate || !s_bDoublePrecision || bMixedPrecision()) return false;
+    if(!hasDenseMatrix() || bIterativeSolve()) return false;
+    size_t size2 = size_t(matSize())*size_t(matSize());
+    return m_aijRef.size()==size2 && m_aijd.size()==size2;
+}
+
+
+/**
+ * Moves the LU factors of the reference matrix aside, so that the new matrix can be assembled in m_aijd.
+ * Must be followed by the assembly of the matrix and by a call to updateFactorization().
+ */
+void PanelAnalysis::prepareFactorizationUpdate()
+{
+    size_t size2 = size_t(matSize())*size_t(matSize());
+    std::swap(m_aijd, m_LURef);
+    m_ipivRef = m_ipiv;
+    m_aijd.resize(size2);
+    zeroRowBlocks(m_aijd.data(), matSize(), m_nBlocks, s_bMultiThread);
+}
+
+
+/**
+ * Keeps a copy of the assembled matrix as the reference of the next low-rank updates;
+ * to be called before the matrix is factorized.
+ */
+void PanelAnalysis::storeReferenceMatrix()
+{
+    if(!s_bLowRankUpdate || !s_bDoublePrecision || bMixedPrecision() || !hasDenseMatrix() || bIterativeSolve())
+    {
+        m_aijRef.clear();
+        m_LURef.clear();
+        releaseMemory(m_ReferenceBytes);
+        return;
+    }
+
+    // the reference matrix and its LU factors
+    size_t nBytes = 2 * m_aijd.size() * sizeof(double);
+    if(m_ReferenceBytes!=nBytes && !reserveMemory(nBytes, m_ReferenceBytes))
+    {
+        traceStdLog("      The low-rank update exceeds the memory budget and is disabled\n");
+        m_aijRef.clear();
+        m_LURef.clear();
+        return;
+    }
+    m_aijRef.assign(m_aijd.begin(), m_aijd.end());
+}
+
+
+void PanelAnalysis::clearFactorizationUpdate()
+{
+    m_UpdateRows.clear();
+    m_UpdateCols.clear();
+    m_UpdateDRows.clear();
+    m_UpdateZ.clear();
+    m_UpdateK.clear();
+    m_UpdatePiv.clear();
+}
+
+
+/**
+ * Compares the new matrix A assembled in m_aijd with the reference matrix A0, and makes the
+ * Sherman-Morrison-Woodbury update of the factorization of A0 if the difference is limited to a few rows and columns,
+ * as is the case when only a control surface and the wake have moved.
+ * The difference is written A-A0 = U.Vt, with U = [E_R, D_C] and Vt = [D_R; E_C^t],
+ * where D_R are the changed rows and D_C the changed columns less the rows R. Then
+ *     A^-1 = A0^-1 - Z.(I+Vt.Z)^-1.Vt.A0^-1,   with Z = A0^-1.U
+ * which costs rank(U) back-substitutions instead of a factorization.
+ * @param rank the rank of the update
+ * @return true if the update was made, in which case m_aijd holds the LU factors of A0 again;
+ * false if too many rows and columns have changed, in which case m_aijd holds A, to be factorized.
+ */
+bool PanelAnalysis::updateFactorization(int &rank)
+{
+    // the differences below this fraction of the matrix' largest coefficient are round-off errors
+    // in the rotated geometry and are ignored
+    double const RELATIVETOLERANCE = 1.0e-10;
+
+    int N = matSize();
+    rank = 0;
+    clearFactorizationUpdate();
+
+    double amax = 0.0;
+    for(size_t i=0; i<m_aijRef.size(); i++) amax = std::max(amax, fabs(m_aijRef.at(i)));
+    double tol = RELATIVETOLERANCE*amax;
+
+    auto isChanged = [this, N, tol](int i, int k)
+    {
+        size_t ik = size_t(i)*size_t(N)+size_t(k);
+        return fabs(m_aijd[ik]-m_aijRef[ik])>tol;
+    };
+
+    // count the changed coefficients in each row and column
+    std::vector<int> nRow(N,0), nCol(N,0);
+    for(int i=0; i<N; i++)
+    {
+        for(int k=0; k<N; k++)
+        {
+            if(isChanged(i,k))
+            {
+                nRow[i]++;
+                nCol[k]++;
+            }
+        }
+    }
+
+    // cover the changed coefficients with a few rows and columns: the rows of the moved panels
+    // have changed almost everywhere, the columns of the moved panels and of the panels shedding
+    // a wake have changed almost everywhere, and the other changes are at their intersections
+    std::vector<int> rows, cols;
+    for(int pass=0; pass<2; pass++)
+    {
+        bool bRowsFirst = pass==0;
+        std::vector<int> const &nFirst = bRowsFirst ? nRow : nCol;
+        std::vector<unsigned char> bFirst(N, 0);
+        std::vector<int> first, second;
+        for(int i=0; i<N; i++)
+        {
+            if(nFirst[i]>N/4)
+            {
+                bFirst[i] = 1;
+                first.push_back(i);
+            }
+        }
+        std::vector<unsigned char> bSecond(N, 0);
+        for(int i=0; i<N; i++)
+        {
+            for(int k=0; k<N; k++)
+            {
+                int ifirst  = bRowsFirst ? i : k;
+                int isecond = bRowsFirst ? k : i;
+                if(!bFirst[ifirst] && !bSecond[isecond] && isChanged(i,k)) bSecond[isecond] = 1;
+            }
+        }
+        for(int k=0; k<N; k++) if(bSecond[k]) second.push_back(k);
+
+        if(pass==0 || first.size()+second.size()<rows.size()+cols.size())
+        {
+            rows = bRowsFirst ? first : second;
+            cols = bRowsFirst ? second : first;
+        }
+    }
+
+    int nr = int(rows.size());
+    int nc = int(cols.size());
+    int m = nr + nc;
+    if(m>s_MaxUpdateFraction*double(N)) return false;
+
+    if(m>0)
+    {
+        std::vector<unsigned char> bRow(N, 0);
+        for(int i : rows) bRow[i] = 1;
+
+        m_UpdateRows = rows;
+        m_UpdateCols = cols;
+
+        // D_R
+        m_UpdateDRows.resize(size_t(nr)*size_t(N));
+        for(int a=0; a<nr; a++)
+        {
+            size_t i0 = size_t(rows.at(a))*size_t(N);
+            for(int k=0; k<N; k++) m_UpdateDRows[size_t(a)*N+k] = m_aijd[i0+k]-m_aijRef[i0+k];
+        }
+
+        // U
+        m_UpdateZ.assign(size_t(m)*size_t(N), 0.0);
+        for(int a=0; a<nr; a++) m_UpdateZ[size_t(a)*N+rows.at(a)] = 1.0;
+        for(int b=0; b<nc; b++)
+        {
+            int k = cols.at(b);
+            double *u = m_UpdateZ.data() + size_t(nr+b)*N;
+            for(int i=0; i<N; i++)
+            {
+                if(bRow[i]) continue;
+                size_t ik = size_t(i)*size_t(N)+size_t(k);
+                u[i] = m_aijd[ik]-m_aijRef[ik];
+            }
+        }
+    }
+
+    // restore the factors of A0; the matrix A is not needed anymore
+    std::swap(m_aijd, m_LURef);
+    m_ipiv = m_ipivRef;
+    rank = m;
+    if(m==0) return true;
+
+    // Z = A0^-1.U
+    if(!LUsolve(m_UpdateZ.data(), m, true))
+    {
+        clearFactorizationUpdate();
+        std::swap(m_aijd, m_LURef); // back to A for a full factorization
+        return false;
+    }
+
+    // K = I + Vt.Z
+    m_UpdateK.assign(size_t(m)*size_t(m), 0.0);
+    ThreadPool::pool().parallelFor(m, [this, N, m, nr](int b)
+    {
+        double const *z = m_UpdateZ.data() + size_t(b)*N;
+        for(int a=0; a<nr; a++)
+        {
+            double const *d = m_UpdateDRows.data() + size_t(a)*N;
+            double sum = 0.0;
+            for(int k=0; k<N; k++) sum += d[k]*z[k];
+            m_UpdateK[size_t(b)*m+a] = sum;
+        }
+        for(int a=nr; a<m; a++) m_UpdateK[size_t(b)*m+a] = z[m_UpdateCols.at(a-nr)];
+        m_UpdateK[size_t(b)*m+b] += 1.0;
+    });
+
+    lapack_int lm = m;
+    lapack_int info = 0;
+    m_UpdatePiv.resize(m);
+    dgetrf_(&lm, &lm, m_UpdateK.data(), &lm, m_UpdatePiv.data(), &info);
+    if(info!=0)
+    {
+        // A is singular or the update is ill-conditioned; refactorize
+        clearFactorizationUpdate();
+        std::swap(m_aijd, m_LURef);
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Applies the low-rank correction to the block of solutions X0=A0^-1.B:
+ *     X = X0 - Z.K^-1.Vt.X0
+ */
+void PanelAnalysis::applyFactorizationUpdate(double *RHS, int nRHS) const
+{
+    int N = matSize();
+    int nr = int(m_UpdateRows.size());
+    int m = nr + int(m_UpdateCols.size());
+
+    // T = Vt.X0
+    std::vector<double> T(size_t(m)*size_t(nRHS));
+    for(int j=0; j<nRHS; j++)
+    {
+        double const *x = RHS + size_t(j)*N;
+        for(int a=0; a<nr; a++)
+        {
+            double const *d = m_UpdateDRows.data() + size_t(a)*N;
+            double sum = 0.0;
+            for(int k=0; k<N; k++) sum += d[k]*x[k];
+            T[size_t(j)*m+a] = sum;
+        }
+        for(int a=nr; a<m; a++) T[size_t(j)*m+a] = x[m_UpdateCols.at(a-nr)];
+    }
+
+    // S = K^-1.T
+    char trans = 'N';
+    lapack_int lm = m;
+    lapack_int nrhs = nRHS;
+    lapack_int info = 0;
+    double *K = const_cast<double*>(m_UpdateK.data());   // not modified by getrs
+    lapack_int *piv = const_cast<lapack_int*>(m_UpdatePiv.data());
+#ifdef OPENBLAS
+    dgetrs_(&trans, &lm, &nrhs, K, &lm, piv, T.data(), &lm, &info, 1);
+#elif defined INTEL_MKL
+    dgetrs_(&trans, &lm, &nrhs, K, &lm, piv, T.data(), &lm, &info);
+#elif defined ACCELERATE
+    dgetrs_(&trans, &lm, &nrhs, K, &lm, piv, T.data(), &lm, &info);
+#endif
+
+    // X = X0 - Z.S
+    for(int j=0; j<nRHS; j++)
+    {
+        double *x = RHS + size_t(j)*N;
+        for(int b=0; b<m; b++)
+        {
+            double s = T[size_t(j)*m+b];
+            double const *z = m_UpdateZ.data() + size_t(b)*N;
+            for(int i=0; i<N; i++) x[i] -= z[i]*s;
+        }
+    }
+}
+
+
+/** Accumulates the geometry and the connections of the panel in the hash */
+void PanelAnalysis::hashPanel(std::uint64_t &h, Panel const &panel)
+{
+    hashPanelGeometry(h, panel);
+    LUCache::hash(h, panel.iWake());
+    LUCache::hash(h, panel.iWakeColumn());
+    LUCache::hash(h, panel.iPL());
+    LUCache::hash(h, panel.iPR());
+    LUCache::hash(h, panel.iPU());
+    LUCache::hash(h, panel.iPD());
+    LUCache::hash(h, int(panel.isTrailing()));
+}
+
+
+/** Accumulates the vertices, the normal and the surface position of the panel in the hash */
+void PanelAnalysis::hashPanelGeometry(std::uint64_t &h, Panel const &panel)
+{
+    if(panel.isPanel4())
+    {
+        Panel4 const &p4 = static_cast<Panel4 const&>(panel);
+        for(int in=0; in<4; in++)
+        {
+            Vector3d const &V = p4.vertex(in);
+            LUCache::hash(h, V.x);  LUCache::hash(h, V.y);  LUCache::hash(h, V.z);
+        }
+    }
+    else if(panel.isPanel3())
+    {
+        Panel3 const &p3 = static_cast<Panel3 const&>(panel);
+        for(int in=0; in<3; in++)
+        {
+            Vector3d const &V = p3.vertexAt(in);
+            LUCache::hash(h, V.x);  LUCache::hash(h, V.y);  LUCache::hash(h, V.z);
+        }
+    }
+
+    Vector3d const &N = panel.normal();
+    LUCache::hash(h, N.x);  LUCache::hash(h, N.y);  LUCache::hash(h, N.z);
+    LUCache::hash(h, int(panel.surfacePosition()));
+}
+
+
+/**
+ * @return true if the system is solved with GMRES instead of dense LU; always the case without a dense matrix,
+ * except if the matrix is distributed over the ranks of an MPI job
+ */
+bool PanelAnalysis::bIterativeSolve() const
+{
+    if(m_bDistributed) return false;
+    return !hasDenseMatrix() || (m_pPolar3d && m_pPolar3d->bIterativeSolver());
+}
+
+
+/**
+ * Used in place of the dense matrix assembly in the compressed and matrix-free modes.
+ * Resets the wake coefficients of the trailing panels' columns which are added next by makeWakeContribution(),
+ * and builds the hierarchical approximation of the body panel influences in the compressed mode.
+ */
+void PanelAnalysis::makeImplicitMatrix()
+{
+    int N = nPanels();
+
+    m_WakeColumn.assign(N, -1);
+    m_WakeColumnList.clear();
+    for(int p=0; p<N; p++)
+    {
+        if(panelAt(p)->isTrailing())
+        {
+            m_WakeColumn[p] = int(m_WakeColumnList.size());
+            m_WakeColumnList.push_back(p);
+        }
+    }
+    m_WakeCoef.assign(size_t(N)*m_WakeColumnList.size(), 0.0);
+
+    if(m_bDistributed)
+    {
+        traceLog(QString::asprintf("      Distributed mode: %.1f Mb of wake coefficients and %.1f Mb of tiles on each rank\n",
+                                   double(m_WakeCoef.size()*sizeof(double))/1024.0/1024.0, double(DistributedSolver::localBytes(N))/1024.0/1024.0));
+        return;
+    }
+
+    if(m_bMatrixFree)
+    {
+        traceLog(QString::asprintf("      Matrix-free mode: %.1f Mb of wake coefficients instead of a %.1f Mb matrix\n",
+                                   double(m_WakeCoef.size()*sizeof(double))/1024.0/1024.0, double(N)*double(N)*sizeof(double)/1024.0/1024.0));
+        return;
+    }
+
+    std::vector<Vector3d> rowpts(N), colpts(N);
+    for(int p=0; p<N; p++)
+    {
+        rowpts[p] = panelAt(p)->ctrlPt(m_pPolar3d->isVLM());
+        colpts[p] = panelAt(p)->CoG();
+    }
+
+    m_HMatrix.setTolerance(m_pPolar3d->compressionTolerance());
+    m_HMatrix.build(rowpts, colpts, [this](int i, int k) {return influenceCoef(i,k);});
+
+    double mb     = double(m_HMatrix.memorySize() + m_WakeCoef.size()*sizeof(double))/1024.0/1024.0;
+    double mbfull = double(N)*double(N)*sizeof(double)/1024.0/1024.0;
+    traceLog(QString::asprintf("      Compressed matrix: %d low-rank and %d full blocks, %.1f Mb instead of %.1f Mb\n",
+                               m_HMatrix.nLowRankBlocks(), m_HMatrix.nFullBlocks(), mb, mbfull));
+}
+
+
+/**
+ * Returns the coefficients of row i of the influence matrix, without the wake contribution.
+ * In the case of Dirichlet BC, the far-field potentials are evaluated at once over the packed panel
+ * arrays and only the near panels are integrated exactly.
+ * With a ground or free surface, the images are the influence of the same packed panels at the symmetric
+ * point below the surface; a panel is integrated exactly if it is near either point.
+ * @param bNear workspace of size nPanels()
+ */
+void PanelAnalysis::influenceRow(int i, double *row, unsigned char *bNear) const
+{
+    int N = nPanels();
+    Panel const *pPanel = panelAt(i);
+
+    bool bFarFieldRow = m_pPolar3d->bDirichlet() && !pPanel->isMidPanel() && m_PanelSoA.size()==N;
+    if(bFarFieldRow)
+    {
+        // same in-plane test as the triangle's potential method
+        double inplaneprecision = pPanel->isPanel3() ? INPLANEPRECISION : 0.0;
+        Vector3d C = pPanel->ctrlPt(m_pPolar3d->isVLM());
+        m_PanelSoA.doubletFarFieldPotential(C, inplaneprecision, row, bNear);
+
+        if(m_pPolar3d->bHPlane())
+        {
+            double coef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+            Vector3d CG(C.x, C.y, -C.z-2.0*m_pPolar3d->groundHeight());
+            m_PanelSoA.addDoubletFarFieldPotential(CG, inplaneprecision, coef, row, bNear);
+        }
+    }
+    else
+        memset(bNear, 1, size_t(N));
+
+    // the coefficients of the shared block have been fetched from the cache
+    int k0 = N, k1 = N;
+    if(hasSharedBlock() && isInSharedBlock(i))
+    {
+        k0 = m_SharedBlockFirst;
+        k1 = m_SharedBlockFirst+m_SharedBlockSize;
+        double const *blockrow = m_SharedBlock.data() + size_t(i-m_SharedBlockFirst)*size_t(m_SharedBlockSize);
+        std::copy(blockrow, blockrow+m_SharedBlockSize, row+k0);
+    }
+
+    for(int k=0; k<N; k++)
+    {
+        if(k>=k0 && k<k1) continue;
+        if(bNear[k]) row[k] = influenceCoef(i, k);
+    }
+}
+
+
+/** Copies the panel geometry to the packed arrays used by the far-field kernels */
+void PanelAnalysis::makePanelSoA()
+{
+    m_PanelSoA.resize(nPanels());
+    for(int k=0; k<nPanels(); k++)
+    {
+        Panel const *pPanel = panelAt(k);
+        // vortex rings have no far-field doublet formula
+        bool bEligible = !(pPanel->isPanel4() && pPanel->isMidPanel());
+        m_PanelSoA.setPanel(k, *pPanel, pPanel->CoG(), bEligible);
+    }
+}
+
+
+/**
+ * Stores the row i of the dense matrix from the influence coefficients in double precision.
+ * The precision is tested once for the row rather than once for each coefficient.
+ * @return false and sets the matrix error flag if one of the coefficients is NaN.
+ */
+bool PanelAnalysis::storeMatrixRow(int i, double const *row)
+{
+    int N = matSize();
+    size_t offset = size_t(i)*size_t(N);
+    int iNaN = s_bDoublePrecision ? storeRow(m_aijd.data()+offset, row, N) : storeRow(m_aijf.data()+offset, row, N);
+    if(iNaN<0) return true;
+
+    traceLog(QString::asprintf("      *** numerical error when calculating the influence of panel %d on panel %d ***\n", iNaN, i));
+    m_bMatrixError = true;
+    return false;
+}
+
+
+/** Returns the coefficient (i,k) of the system's matrix, before factorization */
+double PanelAnalysis::matrixCoef(int i, int k) const
+{
+    if(!hasDenseMatrix())
+    {
+        double d = influenceCoef(i,k);
+        int iw = m_WakeColumn.at(k);
+        if(iw>=0) d += m_WakeCoef.at(size_t(i)*m_WakeColumnList.size()+iw);
+        return d;
+    }
+
+    size_t ik = size_t(i)*size_t(matSize()) + size_t(k);
+    return s_bDoublePrecision ? m_aijd.at(ik) : double(m_aijf.at(ik));
+}
+
+
+/**
+ * Builds and factorizes the block-diagonal part of the influence matrix.
+ * The blocks follow the surfaces, since the strongest influences are between panels of the same surface,
+ * and are split if they exceed a max. size to keep the factorization cost low.
+ * The influence matrix is left untouched for the matrix-vector products of the iterative solver.
+ */
+bool PanelAnalysis::makeBlockJacobiPreconditioner()
+{
+    int const MAXBLOCKSIZE = 512;
+
+    int N = matSize();
+    int nrowsperpanel = nPanels()>0 ? N/nPanels() : 1;
+
+    m_PrecondStart.clear();
+    m_PrecondStart.push_back(0);
+    int iSurf = N>0 ? panelAt(0)->surfaceIndex() : -1;
+    for(int r=1; r<N; r++)
+    {
+        int is = panelAt(r/nrowsperpanel)->surfaceIndex();
+        bool bSplit = is!=iSurf || r-m_PrecondStart.back()>=MAXBLOCKSIZE;
+        // keep the rows of a same panel together
+        if(bSplit && r%nrowsperpanel==0) m_PrecondStart.push_back(r);
+        iSurf = is;
+    }
+    m_PrecondStart.push_back(N);
+
+    int nBlocks = int(m_PrecondStart.size())-1;
+    m_PrecondOffset.resize(nBlocks+1);
+    m_PrecondOffset[0] = 0;
+    for(int ib=0; ib<nBlocks; ib++)
+    {
+        size_t nb = size_t(m_PrecondStart.at(ib+1)-m_PrecondStart.at(ib));
+        m_PrecondOffset[ib+1] = m_PrecondOffset.at(ib) + nb*nb;
+    }
+    m_PrecondLU.resize(m_PrecondOffset.back());
+    m_PrecondPiv.resize(N);
+
+    std::vector<int> infos(nBlocks, 0);
+    ThreadPool::pool().parallelFor(nBlocks, [this, &infos](int ib)
+    {
+        int r0 = m_PrecondStart.at(ib);
+        lapack_int nb = m_PrecondStart.at(ib+1)-r0;
+        double *LU = m_PrecondLU.data() + m_PrecondOffset.at(ib);
+        for(int i=0; i<nb; i++)
+        {
+            for(int k=0; k<nb; k++)
+            {
+                LU[i*nb+k] = matrixCoef(r0+i, r0+k);
+            }
+        }
+        lapack_int info = 0;
+        dgetrf_(&nb, &nb, LU, &nb, m_PrecondPiv.data()+r0, &info);
+        infos[ib] = info;
+    });
+
+    for(int ib=0; ib<nBlocks; ib++)
+    {
+        if(infos.at(ib)!=0)
+        {
+            traceStdLog("         Singular preconditioner block.... Aborting calculation...\n");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/** Replaces x by the solution of the block-diagonal system */
+void PanelAnalysis::applyBlockJacobiPreconditioner(double *x) const
+{
+    char trans = 'T';
+    lapack_int nrhs = 1;
+    int nBlocks = int(m_PrecondStart.size())-1;
+    for(int ib=0; ib<nBlocks; ib++)
+    {
+        int r0 = m_PrecondStart.at(ib);
+        lapack_int nb = m_PrecondStart.at(ib+1)-r0;
+        lapack_int info = 0;
+        double *LU = const_cast<double*>(m_PrecondLU.data()) + m_PrecondOffset.at(ib);
+        int *piv = const_cast<int*>(m_PrecondPiv.data()) + r0;
+#ifdef OPENBLAS
+        dgetrs_(&trans, &nb, &nrhs, LU, &nb, piv, x+r0, &nb, &info, 1);
+#else
+        dgetrs_(&trans, &nb, &nrhs, LU, &nb, piv, x+r0, &nb, &info);
+#endif
+    }
+}
+
+
+/**
+ * Builds the coarse levels of the multilevel preconditioner if the polar requires it.
+ * The hierarchy is made by agglomeration of the panels with their neighbours, as set by the mesh connections;
+ * the panels of different surface positions are kept apart so that the doublet jump at the trailing edges
+ * is not averaged. Without the connections, e.g. if the mesh has not been connected, the panels are isolated
+ * and the preconditioner is left empty.
+ */
+void PanelAnalysis::makeMultilevelPreconditioner()
+{
+    m_Multilevel.clear();
+    if(!m_pPolar3d || !m_pPolar3d->bMultilevelPrecond()) return;
+
+    int nP = nPanels();
+    if(nP<=0) return;
+    int nrowsperpanel = matSize()/nP;
+
+    std::vector<std::vector<int>> neighbours(nP);
+    std::vector<int> group(nP);
+    for(int p=0; p<nP; p++)
+    {
+        Panel const *pPanel = panelAt(p);
+        group[p] = int(pPanel->surfacePosition());
+
+        int idx[4]{-1,-1,-1,-1};
+        if(pPanel->isPanel3())
+        {
+            Panel3 const *p3 = static_cast<Panel3 const*>(pPanel);
+            for(int in=0; in<3; in++) idx[in] = p3->neighbour(in);
+        }
+        else
+        {
+            idx[0] = pPanel->iPL();  idx[1] = pPanel->iPR();
+            idx[2] = pPanel->iPU();  idx[3] = pPanel->iPD();
+        }
+        for(int n : idx)
+        {
+            if(n<0 || n>=nP || n==p) continue;
+            neighbours[p].push_back(n);
+            neighbours[n].push_back(p);
+        }
+    }
+    for(std::vector<int> &nb : neighbours)
+    {
+        std::sort(nb.begin(), nb.end());
+        nb.erase(std::unique(nb.begin(), nb.end()), nb.end());
+    }
+
+    bool bBuilt = m_Multilevel.build(nrowsperpanel, neighbours, group,
+                                     [this](int i, int k) {return matrixCoef(i,k);},
+                                     [this](std::vector<int> const &agg, int nAgg, double *Ac) {addAggregatedMatrix(agg, nAgg, Ac);});
+    if(bBuilt)
+        traceStdLog(QString::asprintf("      Multilevel preconditioner: %d coarse levels, %d unknowns at the coarsest level\n",
+                                      m_Multilevel.nLevels(), m_Multilevel.coarseSize()).toStdString());
+    else
+        traceStdLog("      The mesh could not be coarsened, using the block-Jacobi preconditioner only\n");
+}
+
+
+/**
+ * Adds to the nAgg x nAgg row-major array Ac the sums of the matrix coefficients over each pair of aggregates.
+ * The rows are read once, i.e. at the cost of one matrix-vector product, and grouped by aggregate so that
+ * the tasks write in separate rows of Ac.
+ */
+void PanelAnalysis::addAggregatedMatrix(std::vector<int> const &agg, int nAgg, double *Ac) const
+{
+    int N = matSize();
+    int nw = int(m_WakeColumnList.size());
+
+    if(m_bCompressed)
+    {
+        m_HMatrix.addAggregatedMatrix(agg, agg, nAgg, Ac);
+        for(int i=0; i<N; i++)
+        {
+            double *Ai = Ac + size_t(agg.at(i))*size_t(nAgg);
+            double const *wi = m_WakeCoef.data() + size_t(i)*nw;
+            for(int iw=0; iw<nw; iw++) Ai[agg.at(m_WakeColumnList.at(iw))] += wi[iw];
+        }
+        return;
+    }
+
+    std::vector<int> first(nAgg+1, 0), rows(N);
+    for(int r=0; r<N; r++) first[agg.at(r)+1]++;
+    for(int I=0; I<nAgg; I++) first[I+1] += first.at(I);
+    std::vector<int> pos(first.begin(), first.end()-1);
+    for(int r=0; r<N; r++) rows[pos[agg.at(r)]++] = r;
+
+    ThreadPool::pool().parallelFor(nAgg, [this, N, nw, nAgg, &agg, &first, &rows, Ac](int I)
+    {
+        std::vector<double> row(N);
+        std::vector<unsigned char> bNear(N);
+        double *AI = Ac + size_t(I)*size_t(nAgg);
+        for(int ir=first.at(I); ir<first.at(I+1); ir++)
+        {
+            int i = rows.at(ir);
+            if(m_bMatrixFree)
+            {
+                influenceRow(i, row.data(), bNear.data());
+                double const *wi = m_WakeCoef.data() + size_t(i)*nw;
+                for(int iw=0; iw<nw; iw++) row[m_WakeColumnList.at(iw)] += wi[iw];
+            }
+            else
+            {
+                for(int k=0; k<N; k++) row[k] = matrixCoef(i,k);
+            }
+            for(int k=0; k<N; k++) AI[agg.at(k)] += row.at(k);
+        }
+    });
+}
+
+
+/** Applies the block-Jacobi preconditioner and adds the coarse-level corrections, if any */
+void PanelAnalysis::applyPreconditioner(double *x) const
+{
+    if(m_Multilevel.isEmpty())
+    {
+        applyBlockJacobiPreconditioner(x);
+        return;
+    }
+
+    std::vector<double> r(x, x+matSize());
+    applyBlockJacobiPreconditioner(x);
+    m_Multilevel.addCorrection(r.data(), x);
+}
+
+
+/** y = A.x where A is the influence matrix in row-major storage */
+void PanelAnalysis::systemMatVec(double const *x, double *y) const
+{
+    int N = matSize();
+    int nThreads = s_bMultiThread ? m_nThreads : 1;
+    if(!hasDenseMatrix())
+    {
+        if(m_bCompressed) m_HMatrix.matVec(x, y);
+        else
+        {
+            // recompute the rows on the fly
+            int nBlocks = std::max(1, std::min(m_nBlocks, N));
+            ThreadPool::pool().parallelFor(nBlocks, [this, N, nBlocks, x, y](int iBlock)
+            {
+                std::vector<double> row(N);
+                std::vector<unsigned char> bNear(N);
+                for(int i=iBlock; i<N; i+=nBlocks)
+                {
+                    influenceRow(i, row.data(), bNear.data());
+                    double sum = 0.0;
+                    for(int k=0; k<N; k++) sum += row[k]*x[k];
+                    y[i] = sum;
+                }
+            });
+        }
 
-    char trans = 'T';
-    lapack_int lda=matsize, n=matsize, nrhs=1, ldb=n;
-    lapack_int info = 0;
-    if(s_bDoublePrecision)
+        int nw = int(m_WakeColumnList.size());
+        for(int i=0; i<N; i++)
+        {
+            double const *wi = m_WakeCoef.data() + size_t(i)*nw;
+            for(int iw=0; iw<nw; iw++) y[i] += wi[iw]*x[m_WakeColumnList.at(iw)];
+        }
+    }
+    else if(s_bDoublePrecision)
     {
-#ifdef OPENBLAS
-        dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), RHS.data(), &ldb, &info, 1);
-#elif INTEL_MKL
-        dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), RHS.data(), &ldb, &info);
-#endif
+        matrix::matVecMultLapack(m_aijd.data(), x, y, N, N, nThreads);
     }
     else
     {
-        std::vector<float> cf(matsize,0);
-        for(int i=0; i<n; i++)  cf[i] = float(RHS.at(i));
-#ifdef OPENBLAS
-        sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), cf.data(), &n, &info, 1);
-#elif INTEL_MKL
-        sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), cf.data(), &n, &info);
-#endif
-        for(int i=0; i<n; i++) RHS[i] = double(cf.at(i));
+        std::vector<float> xf(N), yf(N);
+        for(int i=0; i<N; i++) xf[i] = float(x[i]);
+        matrix::matVecMultLapack(m_aijf.data(), xf.data(), yf.data(), N, N, nThreads);
+        for(int i=0; i<N; i++) y[i] = double(yf.at(i));
     }
-    if(info!=0)
+}
+
+
+/**
+ * Solves the RHS columns with block-Jacobi preconditioned GMRES, with the coarse-level corrections if the polar requires them.
+ * Each column starts from the last solution found for the same column index,
+ * which is close to the new one in a sequence of operating points.
+ */
+bool PanelAnalysis::solveIterative(double *RHS, int nRHS)
+{
+    int N = matSize();
+    int restart = std::min(N, 50);
+    if(int(m_LastSolution.size())<nRHS) m_LastSolution.resize(nRHS);
+
+    bool bConverged = true;
+    for(int ir=0; ir<nRHS; ir++)
     {
-        traceStdLog("      Error back-solving the RHS\n");
-        return false;
+        double *b = RHS + size_t(ir)*size_t(N);
+        std::vector<double> &x = m_LastSolution[ir];
+        if(int(x.size())!=N) x.assign(N, 0.0);
+
+        double residual = 0.0;
+        int iter = matrix::GMRES(N,
+                                 [this](double const*v, double*w) {systemMatVec(v,w);},
+                                 [this](double*v){applyPreconditioner(v);},
+                                 b, x.data(), restart, m_pPolar3d->iterativeMaxIter(), m_pPolar3d->iterativeTolerance(), residual);
+        if(iter<0)
+        {
+            traceStdLog(QString::asprintf("      GMRES did not converge, residual=%g\n", residual).toStdString());
+            bConverged = false;
+        }
+        memcpy(b, x.data(), size_t(N)*sizeof(double));
     }
-    return true;
+    return bConverged;
 }
 
 
@@ -399,29 +1826,91 @@ void PanelAnalysis::combineUnitRHS(std::vector<double> &RHS, Vector3d const &VIn
 }
 
 
+/**
+ * Makes the RHS of the six unit motions in a single pass over the panel pairs.
+ * The source strengths of the unit motions only depend on the source panel,
+ * so they are made once beforehand and read as one interleaved array by makeUnitRHSBlock().
+ */
 void PanelAnalysis::makeUnitRHSVectors()
 {
+    makeUnitSourceStrengths();
+
     if(s_bMultiThread)
     {
-        std::vector<std::thread> threads;
-
+        ThreadPool::pool().parallelFor(m_nBlocks, [this](int iBlock){makeUnitRHSBlock(iBlock);});
+    }
+    else
+    {
         for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
         {
-//            futureSync.addFuture(QtConcurrent::run(&PanelAnalysis::makeUnitRHSBlock, this, iBlock));
-            threads.push_back(std::thread(&PanelAnalysis::makeUnitRHSBlock, this, iBlock));
+            makeUnitRHSBlock(iBlock);
         }
+    }
+}
 
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
+
+/**
+ * Makes the source strengths of the panels for the unit translations u, v, w and for the
+ * unit rotations p, q, r about the polar's CoG, stored in this order for each panel.
+ * The strengths are zero on thin surfaces.
+ */
+void PanelAnalysis::makeUnitSourceStrengths()
+{
+    Vector3d const Vx(1,0,0), Vy(0,1,0), Vz(0,0,1);
+    Vector3d leverarm;
+
+    m_UnitSigma.resize(6*size_t(nPanels()));
+    for(int k=0; k<nPanels(); k++)
+    {
+        Panel const *panel = panelAt(k);
+        double *sigma = m_UnitSigma.data() + 6*k;
+        if(panel->isMidPanel())
         {
-            threads[iBlock].join();
+            for(int d=0; d<6; d++) sigma[d] = 0.0;
+            continue;
         }
-//        std::cout << "PanelAnalysis::makeUnitRHSVectors joined all " << m_nBlocks << " threads" <<std::endl;
+        leverarm.set(panel->CoG()-m_pPolar3d->CoG());
+        sigma[0] = sourceStrength(panel->normal(), Vx);
+        sigma[1] = sourceStrength(panel->normal(), Vy);
+        sigma[2] = sourceStrength(panel->normal(), Vz);
+        sigma[3] = sourceStrength(panel->normal(), leverarm*Vx);
+        sigma[4] = sourceStrength(panel->normal(), leverarm*Vy);
+        sigma[5] = sourceStrength(panel->normal(), leverarm*Vz);
     }
-    else
+}
+
+
+/**
+ * Makes the coefficients which give the RHS of a non-uniform velocity field in O(N) operations.
+ * In makeRHS(), the free stream and the source strengths of every row are made with the velocity of the row's panel,
+ * so that the RHS of a row is a linear function of that velocity, whose coefficients are the unit RHS u, v and w of the row.
+ * The coefficients are valid until the panels are moved, and are meant for the loops which only change the velocity field,
+ * i.e. the viscous and vorton wake iterations.
+ * The unit RHS vectors are overwritten.
+ */
+void PanelAnalysis::makeRHSCoefficients()
+{
+    makeUnitRHSVectors();
+
+    m_RHSCoef.resize(m_uRHS.size());
+    for(uint r=0; r<m_RHSCoef.size(); r++) m_RHSCoef[r].set(m_uRHS.at(r), m_vRHS.at(r), m_wRHS.at(r));
+}
+
+
+/**
+ * Makes the RHS of the velocity field from the coefficients made by makeRHSCoefficients().
+ * Equivalent to makeRHS() with the panels' own normals.
+ */
+void PanelAnalysis::combineRHSCoefficients(std::vector<Vector3d> const &VField, std::vector<double> &RHS) const
+{
+    int nRows = int(m_RHSCoef.size()/size_t(nPanels())); // 3 rows per panel for linear triangles, 1 otherwise
+    for(int p=0; p<nPanels(); p++)
     {
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
+        Vector3d const &V = VField.at(p);
+        for(int ir=0; ir<nRows; ir++)
         {
-            makeUnitRHSBlock(iBlock);
+            int row = p*nRows+ir;
+            RHS[row] = V.dot(m_RHSCoef.at(row));
         }
     }
 }
@@ -433,19 +1922,8 @@ void PanelAnalysis::makeRHS(const std::vector<Vector3d> &VField, std::vector<dou
 {
     if(s_bMultiThread)
     {
-        std::vector<std::thread> threads;
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-//            futureSync.addFuture(QtConcurrent::run(&PanelAnalysis::makeRHSBlock, this, iBlock, RHS.data(), VField, normals));
-            threads.push_back(std::thread(&PanelAnalysis::makeRHSBlock, this, iBlock, RHS.data(), VField, normals));
-        }
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            threads[iBlock].join();
-        }
-//        std::cout << "PanelAnalysis::makeRHS joined all " << m_nBlocks << " threads" <<std::endl;
+        double *rhs = RHS.data();
+        ThreadPool::pool().parallelFor(m_nBlocks, [this, rhs, &VField, normals](int iBlock){makeRHSBlock(iBlock, rhs, VField, normals);});
     }
     else
     {
@@ -483,21 +1961,7 @@ void PanelAnalysis::makeWakeContribution()
 {
     if(s_bMultiThread)
     {
-        std::vector<std::thread> threads;
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-//            futureSync.addFuture(QtConcurrent::run(&PanelAnalysis::makeWakeMatrixBlock, this, iBlock));
-            threads.push_back(std::thread(&PanelAnalysis::makeWakeMatrixBlock, this, iBlock));
-
-        }
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            threads[iBlock].join();
-        }
-//        std::cout << "PanelAnalysis::makeWakeContribution joined all " << m_nBlocks << " threads" <<std::endl;
-
+        ThreadPool::pool().parallelFor(m_nBlocks, [this](int iBlock){makeWakeMatrixBlock(iBlock);});
     }
     else
     {
@@ -517,27 +1981,18 @@ void PanelAnalysis::makeRHSVWVelocities(std::vector<Vector3d> &VPW, bool bVLM)
     Vector3d C;
     if(s_bMultiThread)
     {
-        int nThreads=std::thread::hardware_concurrency();
+        int nBlocks = std::max(std::min(m_nBlocks, nPanels()), 1);
+        Vector3d *vpw = VPW.data();
 
-        std::vector<std::thread> threads;
-
-        for(int iblock=0; iblock<nThreads; iblock++)
+        ThreadPool::pool().parallelFor(nBlocks, [this, nBlocks, bVLM, vpw](int iblock)
         {
-            int ifirst = (nPanels()/nThreads) *  iblock;
-            int ilast  = (nPanels()/nThreads) * (iblock+1);
-
-            if(iblock==nThreads-1) ilast=nPanels();
+            int ifirst = (nPanels()/nBlocks) *  iblock;
+            int ilast  = (nPanels()/nBlocks) * (iblock+1);
 
-//            futureSync.addFuture(QtConcurrent::run(&PanelAnalysis::makeRHSVWVelocitiesBlock, this, ifirst, ilast, bVLM, VPW.data()));
-            threads.push_back(std::thread(&PanelAnalysis::makeRHSVWVelocitiesBlock, this, ifirst, ilast, bVLM, VPW.data()));
-        }
-
-        for(int iBlock=0; iBlock<nThreads; iBlock++)
-        {
-            threads[iBlock].join();
-        }
-//        std::cout << "PanelAnalysis::makeRHSVWVelocities joined all " << m_nBlocks << " threads" <<std::endl;
+            if(iblock==nBlocks-1) ilast=nPanels();
 
+            makeRHSVWVelocitiesBlock(ifirst, ilast, bVLM, vpw);
+        });
     }
     else
     {
@@ -581,13 +2036,11 @@ void PanelAnalysis::computeTranslationDerivatives(double alphaeq, double u0, Vec
 {
 #ifdef INTEL_MKL
     if(s_bMultiThread)
-        mkl_set_num_threads(s_MaxThreads);
+        MKL_Set_Num_Threads_Local(blasThreadCount());
     else
-        mkl_set_num_threads(1);
+        MKL_Set_Num_Threads_Local(1);
 #endif
 
-    Vector3d Forcem, Momentm;
-    Vector3d Forcep, Momentp;
     Vector3d V0, is, js, ks, WindDirection, WindNormal;
 
     Vector3d Vim, Vjm, Vkm, Vip, Vjp, Vkp;
@@ -680,18 +2133,17 @@ void PanelAnalysis::computeTranslationDerivatives(double alphaeq, double u0, Vec
 
     // make node vertex array
     // only needed for triuniform method to align with TriLinAnalysis
-    std::vector<double> uRHSVertex, pRHSVertex;
-    double *mup = nullptr, *mum=nullptr;
+    std::vector<double> uRHSVertex;
+    double *mup = nullptr;
     if(m_pPolar3d->isTriUniformMethod())
     {
         uRHSVertex.resize(3*N);
-        pRHSVertex.resize(3*N);
     }
 
     if(m_pPolar3d->isQuadMethod())
     {
         mup = m_cRHS.data();
-        forces(mup, Sigma.data()+6*N, alpha, beta, CoG, bFuseMi, VField.at(6), Force0, Moment0);
+        forces(mup, Sigma.data()+6*N, nullptr, alpha, beta, CoG, bFuseMi, VField.at(6), Force0, Moment0);
     }
     else if(m_pPolar3d->isTriangleMethod())
     {
@@ -712,133 +2164,29 @@ void PanelAnalysis::computeTranslationDerivatives(double alphaeq, double u0, Vec
         }
 
         computeOnBodyCp(VInf, m_uVLocal, m_Cp);
-        forces(mup, Sigma.data()+6*N, alpha, beta, CoG, bFuseMi, VField.at(6), Force0, Moment0);
+        forces(mup, Sigma.data()+6*N, m_Cp.data(), alpha, beta, CoG, bFuseMi, VField.at(6), Force0, Moment0);
     }
 
     //________________________________________________
     // 1st ORDER STABILITY DERIVATIVES
-    // x-derivatives________________________
-
-//    alpha = atan2(Vim.z, Vim.x) * 180.0/PI;// =alphaeq....
-    alpha = alphaeq;
-
-    if(m_pPolar3d->isTriUniformMethod())
-    {
-        uRHSVertex.resize(3*N);
-        pRHSVertex.resize(3*N);
-    }
-
-    if(m_pPolar3d->isQuadMethod())
-    {
-        mup = m_UpRHS.data();
-        forces(mup, Sigma.data()+0*N, alpha, beta, CoG, bFuseMi, VField.at(0), Forcep, Momentp);
-        mum = m_UmRHS.data();
-        forces(mum, Sigma.data()+3*N, alpha, beta, CoG, bFuseMi, VField.at(3), Forcem, Momentm);
-    }
-    else if(m_pPolar3d->isTriangleMethod())
-    {
-        // Make the Cp coefficients necessary to calculate the moments
-        // Re-use the methods implemented for unit calculations,
-        // but this time for the delta+ and delta- solutions
-        makeLocalVelocities(m_UpRHS, notanrhs, m_UmRHS, m_uVLocal, m_vVLocal, m_wVLocal, objects::windDirection(alphaeq, 0.0)); // two at a time
-
-        if(m_pPolar3d->isTriUniformMethod())
-        {
-            makeVertexDoubletDensities(m_UpRHS, uRHSVertex);
-            makeVertexDoubletDensities(m_UmRHS, pRHSVertex);
-            mup = uRHSVertex.data();
-            mum = pRHSVertex.data();
-        }
-        else if(m_pPolar3d->isTriLinearMethod())
-        {
-            mup = m_UpRHS.data();
-            mum = m_UmRHS.data();
-        }
-
-        computeOnBodyCp(VField.at(0), m_uVLocal, m_Cp);
-        forces(mup, Sigma.data()+0*N, alpha, beta, CoG, bFuseMi, VField.at(0), Forcep, Momentp);
-
-        computeOnBodyCp(VField.at(3), m_wVLocal, m_Cp);
-        forces(mum, Sigma.data()+3*N, alpha, beta, CoG, bFuseMi, VField.at(3), Forcem, Momentm);
-    }
-
-    SD.Xu = (Forcem - Forcep ).dot(is) /deltaspeed/2.0;
-    SD.Zu = (Forcem - Forcep ).dot(ks) /deltaspeed/2.0;
-    SD.Mu = (Momentm- Momentp).dot(js) /deltaspeed/2.0;
+    std::vector<double> const *RHS[6]{&m_UpRHS, &m_VpRHS, &m_WpRHS, &m_UmRHS, &m_VmRHS, &m_WmRHS};
+    Vector3d F[6], M[6];
+    perturbationForces(alphaeq, CoG, bFuseMi, RHS, Sigma.data(), VField, F, M);
 
+    // x-derivatives________________________
+    SD.Xu = (F[3] - F[0]).dot(is) /deltaspeed/2.0;
+    SD.Zu = (F[3] - F[0]).dot(ks) /deltaspeed/2.0;
+    SD.Mu = (M[3] - M[0]).dot(js) /deltaspeed/2.0;
 
     // y-derivatives________________________
-//    alpha = atan2(Vjm.z, Vjm.x)*180.0/PI;// =alphaeq....
-    alpha = alphaeq;
-    if(m_pPolar3d->isQuadMethod())
-    {
-        mup = m_VpRHS.data();
-        forces(mup, Sigma.data()+1*N, alpha, beta, CoG, bFuseMi, VField.at(1), Forcep, Momentp);
-        mum = m_VmRHS.data();
-        forces(mum, Sigma.data()+4*N, alpha, beta, CoG, bFuseMi, VField.at(4), Forcem, Momentm);
-    }
-    else if(m_pPolar3d->isTriangleMethod())
-    {
-        makeLocalVelocities(m_VpRHS, notanrhs, m_VmRHS, m_uVLocal, m_vVLocal, m_wVLocal, objects::windDirection(alphaeq, 0.0));
-
-        if(m_pPolar3d->isTriUniformMethod())
-        {
-            makeVertexDoubletDensities(m_VpRHS, uRHSVertex);
-            makeVertexDoubletDensities(m_VmRHS, pRHSVertex);
-            mup = uRHSVertex.data();
-            mum = pRHSVertex.data();
-        }
-        else if(m_pPolar3d->isTriLinearMethod())
-        {
-            mup = m_VpRHS.data();
-            mum = m_VmRHS.data();
-        }
-
-        computeOnBodyCp(VField.at(1), m_uVLocal, m_Cp);
-        forces(mup, Sigma.data()+1*N, alpha, beta, CoG, bFuseMi, VField.at(1), Forcep, Momentp);
-
-        computeOnBodyCp(VField.at(4), m_wVLocal, m_Cp);
-        forces(mum, Sigma.data()+4*N, alpha, beta, CoG, bFuseMi, VField.at(4), Forcem, Momentm);
-    }
-    SD.Yv = (Forcem - Forcep).dot(js)   /deltaspeed/2.0;
-    SD.Lv = (Momentm - Momentp).dot(is) /deltaspeed/2.0;
-    SD.Nv = (Momentm - Momentp).dot(ks) /deltaspeed/2.0;
+    SD.Yv = (F[4] - F[1]).dot(js) /deltaspeed/2.0;
+    SD.Lv = (M[4] - M[1]).dot(is) /deltaspeed/2.0;
+    SD.Nv = (M[4] - M[1]).dot(ks) /deltaspeed/2.0;
 
     // z-derivatives________________________
-//    alpha = atan2(Vkm.z, Vkm.x)* 180.0/PI;
-    alpha = alphaeq;
-    if(m_pPolar3d->isQuadMethod())
-    {
-        mup = m_WpRHS.data();
-        forces(mup, Sigma.data()+2*N, alpha, beta, CoG, bFuseMi, VField.at(2), Forcep, Momentp);
-        mum = m_WmRHS.data();
-        forces(mum, Sigma.data()+5*N, alpha, beta, CoG, bFuseMi, VField.at(5), Forcem, Momentm);
-    }
-    else if(m_pPolar3d->isTriangleMethod())
-    {
-        makeLocalVelocities(m_WpRHS, notanrhs, m_WmRHS, m_uVLocal, m_vVLocal, m_wVLocal, objects::windDirection(alphaeq, 0.0));
-        if(m_pPolar3d->isTriUniformMethod())
-        {
-            makeVertexDoubletDensities(m_WpRHS, uRHSVertex);
-            makeVertexDoubletDensities(m_WmRHS, pRHSVertex);
-            mup = uRHSVertex.data();
-            mum = pRHSVertex.data();
-        }
-        else if(m_pPolar3d->isTriLinearMethod())
-        {
-            mup = m_WpRHS.data();
-            mum = m_WmRHS.data();
-        }
-
-        computeOnBodyCp(VField.at(2), m_uVLocal, m_Cp);
-        forces(mup, Sigma.data()+2*N, alpha, beta, CoG, bFuseMi, VField.at(2), Forcep, Momentp);
-
-        computeOnBodyCp(VField.at(5), m_wVLocal, m_Cp);
-        forces(mum, Sigma.data()+5*N, alpha, beta, CoG, bFuseMi, VField.at(5), Forcem, Momentm);
-    }
-    SD.Xw = (Forcem - Forcep).dot(is)   /deltaspeed/2.0;
-    SD.Zw = (Forcem - Forcep).dot(ks)   /deltaspeed/2.0;
-    SD.Mw = (Momentm - Momentp).dot(js) /deltaspeed/2.0;
+    SD.Xw = (F[5] - F[2]).dot(is) /deltaspeed/2.0;
+    SD.Zw = (F[5] - F[2]).dot(ks) /deltaspeed/2.0;
+    SD.Mw = (M[5] - M[2]).dot(js) /deltaspeed/2.0;
 }
 
 
@@ -847,16 +2195,15 @@ void PanelAnalysis::computeAngularDerivatives(double alphaeq, double u0, Vector3
 {
 #ifdef INTEL_MKL
     if(s_bMultiThread)
-        mkl_set_num_threads(s_MaxThreads);
+        MKL_Set_Num_Threads_Local(blasThreadCount());
     else
-        mkl_set_num_threads(1);
+        MKL_Set_Num_Threads_Local(1);
 #endif
 
-    Vector3d Forcem, Momentm, Rism, Rjsm, Rksm;
-    Vector3d Forcep, Momentp, Risp, Rjsp, Rksp;
+    Vector3d Rism, Rjsm, Rksm;
+    Vector3d Risp, Rjsp, Rksp;
     Vector3d V0, is, js, ks, CGM, WindDirection, WindNormal;
 
-    double beta(0.0);
     int N = nPanels();
     int rhssize = 0;
     if(m_pPolar3d->isQuadMethod())
@@ -866,7 +2213,6 @@ void PanelAnalysis::computeAngularDerivatives(double alphaeq, double u0, Vector3
 
     std::vector<double> m_UmRHS(rhssize), m_VmRHS(rhssize), m_WmRHS(rhssize);
     std::vector<double> m_UpRHS(rhssize), m_VpRHS(rhssize), m_WpRHS(rhssize);
-    std::vector<double> notanrhs(rhssize);
 
     std::vector<double> Sigma(6*N);
     std::vector<std::vector<Vector3d>> VField(6);
@@ -940,119 +2286,82 @@ void PanelAnalysis::computeAngularDerivatives(double alphaeq, double u0, Vector3
 
     //________________________________________________
     // 1st ORDER STABILITY DERIVATIVES
-    double const *mup = nullptr;
-    double const *mum = nullptr;
-    std::vector<double> uRHSVertex, pRHSVertex;
-    if(m_pPolar3d->isTriUniformMethod())
-    {
-        uRHSVertex.resize(3*N);
-        pRHSVertex.resize(3*N);
-    }
-
-//    std::vector<Vector3d> VInf(nPanels(), windDirection(alphaeq, 0.0) * u0);
+    std::vector<double> const *RHS[6]{&m_UpRHS, &m_VpRHS, &m_WpRHS, &m_UmRHS, &m_VmRHS, &m_WmRHS};
+    Vector3d F[6], M[6];
+    perturbationForces(alphaeq, CoG, bFuseMi, RHS, Sigma.data(), VField, F, M);
 
     // p-derivatives
-    if(m_pPolar3d->isQuadMethod())
-    {
-        mup = m_UpRHS.data();
-        forces(mup, Sigma.data()+0*N, alphaeq, beta, CoG, bFuseMi, VField.at(0), Forcep, Momentp);
-        mum = m_UmRHS.data();
-        forces(mum, Sigma.data()+3*N, alphaeq, beta, CoG, bFuseMi, VField.at(3), Forcem, Momentm);
-    }
-    else if(m_pPolar3d->isTriangleMethod())
-    {
-        // Make the Cp coefficients necessary to calculate the moments
-        // Re-use the methods implemented for unit calculations,
-        // but this time for the delta+ and delta- solutions
-        makeLocalVelocities(m_UpRHS, notanrhs, m_UmRHS, m_uVLocal, m_vVLocal, m_wVLocal, objects::windDirection(alphaeq, 0.0));
-
-        if(m_pPolar3d->isTriUniformMethod())
-        {
-            makeVertexDoubletDensities(m_UpRHS, uRHSVertex);
-            makeVertexDoubletDensities(m_UmRHS, pRHSVertex);
-            mup = uRHSVertex.data();
-            mum = pRHSVertex.data();
-        }
-        else if(m_pPolar3d->isTriLinearMethod())
-        {
-            mup = m_UpRHS.data();
-            mum = m_UmRHS.data();
-        }
-        computeOnBodyCp(VField.at(0), m_uVLocal, m_Cp);
-        forces(mup, Sigma.data()+0*N, alphaeq, beta, CoG, bFuseMi, VField.at(0), Forcep, Momentp);
-        computeOnBodyCp(VField.at(3), m_wVLocal, m_Cp);
-        forces(mum, Sigma.data()+3*N, alphaeq, beta, CoG, bFuseMi, VField.at(3), Forcem, Momentm);
-    }
-    SD.Yp = (Forcep -Forcem ).dot(js) /rotationrate/2.0;
-    SD.Lp = (Momentp-Momentm).dot(is) /rotationrate/2.0;
-    SD.Np = (Momentp-Momentm).dot(ks) /rotationrate/2.0;
+    SD.Yp = (F[0] - F[3]).dot(js) /rotationrate/2.0;
+    SD.Lp = (M[0] - M[3]).dot(is) /rotationrate/2.0;
+    SD.Np = (M[0] - M[3]).dot(ks) /rotationrate/2.0;
 
     // q-derivatives
-    if(m_pPolar3d->isQuadMethod())
-    {
-        mup = m_VpRHS.data();
-        forces(mup, Sigma.data()+1*N, alphaeq, beta, CoG, bFuseMi, VField.at(1), Forcep, Momentp);
-        mum = m_VmRHS.data();
-        forces(mum, Sigma.data()+4*N, alphaeq, beta, CoG, bFuseMi, VField.at(4), Forcem, Momentm);
-    }
-    else if(m_pPolar3d->isTriangleMethod())
-    {
-        makeLocalVelocities(m_VpRHS, notanrhs, m_VmRHS, m_uVLocal, m_vVLocal, m_wVLocal, objects::windDirection(alphaeq, 0.0));
-
-        if(m_pPolar3d->isTriUniformMethod())
-        {
-            makeVertexDoubletDensities(m_VpRHS, uRHSVertex);
-            makeVertexDoubletDensities(m_VmRHS, pRHSVertex);
-            mup = uRHSVertex.data();
-            mum = pRHSVertex.data();
-        }
-        else if(m_pPolar3d->isTriLinearMethod())
-        {
-            mup = m_VpRHS.data();
-            mum = m_VmRHS.data();
-        }
-        computeOnBodyCp(VField.at(1), m_uVLocal, m_Cp);
-        forces(mup, Sigma.data()+1*N, alphaeq, beta, CoG, bFuseMi, VField.at(1), Forcep, Momentp);
-        computeOnBodyCp(VField.at(4), m_wVLocal, m_Cp);
-        forces(mum, Sigma.data()+4*N, alphaeq, beta, CoG, bFuseMi, VField.at(4), Forcem, Momentm);
-    }
-    SD.Xq = (Forcep -Forcem ).dot(is) /rotationrate/2.0;
-    SD.Zq = (Forcep -Forcem ).dot(ks) /rotationrate/2.0;
-    SD.Mq = (Momentp-Momentm).dot(js) /rotationrate/2.0;
+    SD.Xq = (F[1] - F[4]).dot(is) /rotationrate/2.0;
+    SD.Zq = (F[1] - F[4]).dot(ks) /rotationrate/2.0;
+    SD.Mq = (M[1] - M[4]).dot(js) /rotationrate/2.0;
 
     // r-derivatives
-    if(m_pPolar3d->isQuadMethod())
+    SD.Yr = (F[2] - F[5]).dot(js) /rotationrate/2.0;
+    SD.Lr = (M[2] - M[5]).dot(is) /rotationrate/2.0;
+    SD.Nr = (M[2] - M[5]).dot(ks) /rotationrate/2.0;
+}
+
+
+/**
+ * Evaluates concurrently the forces and moments of the six perturbed solutions of the stability derivatives.
+ * The cases are ordered as the three positive perturbations followed by the three negative ones.
+ * Each case uses its own local velocity and Cp arrays, so that the member arrays are left untouched.
+ * @param RHS the doublet densities of the six cases
+ * @param Sigma the source densities of the six cases, in consecutive blocks of nPanels() values
+ * @param VField the freestream velocity fields of the six cases
+ */
+void PanelAnalysis::perturbationForces(double alphaeq, Vector3d const &CoG, bool bFuseMi,
+                                       std::vector<double> const *RHS[6], double const *Sigma, std::vector<std::vector<Vector3d>> const &VField,
+                                       Vector3d Force[6], Vector3d Moment[6]) const
+{
+    int N = nPanels();
+    bool bTriangle = m_pPolar3d->isTriangleMethod();
+
+    std::vector<std::vector<Vector3d>> VLocal(6);
+    std::vector<std::vector<double>> Cp(6), MuVertex(6);
+
+    if(bTriangle)
     {
-        mup = m_WpRHS.data();
-        forces(mup, Sigma.data()+2*N, alphaeq, beta, CoG, bFuseMi, VField.at(2), Forcep, Momentp);
-        mum = m_WmRHS.data();
-        forces(mum, Sigma.data()+5*N, alphaeq, beta, CoG, bFuseMi, VField.at(5), Forcem, Momentm);
+        // the local velocities are built two at a time, for the positive and negative perturbations of the same axis
+        auto localVelocities = [this, alphaeq, RHS, &VLocal](int iAxis)
+        {
+            std::vector<double> notanrhs(RHS[iAxis]->size());
+            std::vector<Vector3d> notanvelocity(m_uVLocal.size());
+            VLocal[iAxis].resize(m_uVLocal.size());
+            VLocal[iAxis+3].resize(m_uVLocal.size());
+            makeLocalVelocities(*RHS[iAxis], notanrhs, *RHS[iAxis+3], VLocal[iAxis], notanvelocity, VLocal[iAxis+3], objects::windDirection(alphaeq, 0.0));
+        };
+        if(s_bMultiThread) ThreadPool::pool().parallelFor(3, localVelocities);
+        else for(int iAxis=0; iAxis<3; iAxis++) localVelocities(iAxis);
     }
-    else if(m_pPolar3d->isTriangleMethod())
-    {
-        makeLocalVelocities(m_WpRHS, notanrhs, m_WmRHS, m_uVLocal, m_vVLocal, m_wVLocal, objects::windDirection(alphaeq, 0.0));
 
-        if(m_pPolar3d->isTriUniformMethod())
-        {
-            makeVertexDoubletDensities(m_WpRHS, uRHSVertex);
-            makeVertexDoubletDensities(m_WmRHS, pRHSVertex);
-            mup = uRHSVertex.data();
-            mum = pRHSVertex.data();
-        }
-        else if(m_pPolar3d->isTriLinearMethod())
+    auto caseForces = [this, N, bTriangle, alphaeq, &CoG, bFuseMi, RHS, Sigma, &VField, &VLocal, &Cp, &MuVertex, Force, Moment](int ic)
+    {
+        double const *mu = RHS[ic]->data();
+        double const *cp = nullptr;
+        if(bTriangle)
         {
-            mup = m_WpRHS.data();
-            mum = m_WmRHS.data();
+            // make node vertex array
+            // only needed for triuniform method to align with TriLinAnalysis
+            if(m_pPolar3d->isTriUniformMethod())
+            {
+                MuVertex[ic].resize(3*N);
+                makeVertexDoubletDensities(*RHS[ic], MuVertex[ic]);
+                mu = MuVertex[ic].data();
+            }
+            Cp[ic].resize(m_Cp.size());
+            computeOnBodyCp(VField.at(ic), VLocal.at(ic), Cp[ic]);
+            cp = Cp[ic].data();
         }
-        computeOnBodyCp(VField.at(2), m_uVLocal, m_Cp);
-        forces(mup, Sigma.data()+2*N, alphaeq, beta, CoG, bFuseMi, VField.at(2), Forcep, Momentp);
-        computeOnBodyCp(VField.at(5), m_wVLocal, m_Cp);
-        forces(mum, Sigma.data()+5*N, alphaeq, beta, CoG, bFuseMi, VField.at(5), Forcem, Momentm);
-    }
-
-    SD.Yr = (Forcep -Forcem ).dot(js) /rotationrate/2.0;
-    SD.Lr = (Momentp-Momentm).dot(is) /rotationrate/2.0;
-    SD.Nr = (Momentp-Momentm).dot(ks) /rotationrate/2.0;
+        forces(mu, Sigma+ic*N, cp, alphaeq, 0.0, CoG, bFuseMi, VField.at(ic), Force[ic], Moment[ic]);
+    };
+    if(s_bMultiThread) ThreadPool::pool().parallelFor(6, caseForces);
+    else for(int ic=0; ic<6; ic++) caseForces(ic);
 }
 
 /** Sets the vortons from a pre-calculated PlaneOpp.
@@ -1060,6 +2369,100 @@ void PanelAnalysis::computeAngularDerivatives(double alphaeq, double u0, Vector3
 void PanelAnalysis::setVortons(std::vector<std::vector<Vorton>> const &vortons)
 {
     m_Vorton = vortons;
+    makeVortonTree();
+}
+
+
+/** Rebuilds the octree of the vortons; to be called each time the vortons have moved */
+void PanelAnalysis::makeVortonTree()
+{
+    m_VortonTree.clear();
+    if(!m_pPolar3d) return;
+    double theta = m_TreeTheta>0.0 ? m_TreeTheta : m_pPolar3d->vortonTreeTheta();
+    if(theta<=0.0) return;
+
+    m_VortonTree.setTheta(theta);
+    m_VortonTree.build(m_Vorton);
+}
+
+
+/**
+ * Builds the octree of the panels for the doublet and source strengths Mu and Sigma.
+ * The tree is then used by getVelocityVector() and getVelocityVectors() in place of the direct sum
+ * for the queries made with the same arrays, and must be cleared with clearPanelTree() before their values change.
+ * The tree is not built if its opening angle is zero, for VLM, or if the image panels of a ground
+ * or free surface effect are required.
+ */
+void PanelAnalysis::makePanelTree(double const *Mu, double const *Sigma)
+{
+    m_PanelTree.clear();
+    double theta = m_TreeTheta>0.0 ? m_TreeTheta : s_PanelTreeTheta;
+    if(theta<=0.0 || !m_pPolar3d || !Mu) return;
+    if(m_pPolar3d->isVLM() || m_pPolar3d->bHPlane()) return;
+
+    std::vector<PanelTree::Element> elements;
+    makePanelTreeElements(Mu, Sigma, elements);
+
+    m_PanelTree.setTheta(theta);
+    m_PanelTree.build(elements, Mu, Sigma);
+}
+
+
+/**
+ * Evaluates the velocity vectors at the nPts points of array C in the calling thread.
+ * The default implementation calls getVelocityVector() point by point; derived classes may
+ * override it to loop over the panels in the outer loop.
+ */
+void PanelAnalysis::getVelocityVectors(int nPts, Vector3d const *C, double const *Mu, double const *Sigma,
+                                       Vector3d *VT, double coreradius, bool bWakeOnly) const
+{
+    for(int ip=0; ip<nPts; ip++)
+        getVelocityVector(C[ip], Mu, Sigma, VT[ip], coreradius, bWakeOnly, false);
+}
+
+
+/**
+ * Evaluates the velocity vectors at the nPts points of array C, with the panels split in blocks on the thread pool.
+ * Each block sums into its own array, and the arrays are reduced once all the blocks have completed.
+ * Intended for the small sets of points such as the Trefftz plane strips, which are too few
+ * to be split across the threads by getVelocityVectors().
+ */
+void PanelAnalysis::getVelocityVectorsReduced(int nPts, Vector3d const *C, double const *Mu, double const *Sigma,
+                                              Vector3d *VT, double coreradius, bool bWakeOnly) const
+{
+    if(nPts<=0) return;
+
+    int nBlocks = s_bMultiThread ? std::max(1, m_nBlocks) : 1;
+    int blocksize = nPanels()/nBlocks+1;
+    std::vector<Vector3d> VBlock(size_t(nBlocks)*size_t(nPts));
+
+    auto sumBlock = [this, nPts, C, Mu, Sigma, coreradius, bWakeOnly, blocksize, &VBlock](int iBlock)
+    {
+        int iStart = iBlock*blocksize;
+        int iMax = std::min(iStart+blocksize, nPanels());
+        if(iStart<iMax) velocityVectorRange(iStart, iMax, nPts, C, Mu, Sigma, coreradius, bWakeOnly, VBlock.data()+size_t(iBlock)*size_t(nPts));
+    };
+
+    if(nBlocks>1) ThreadPool::pool().parallelFor(nBlocks, sumBlock);
+    else          sumBlock(0);
+
+    for(int ip=0; ip<nPts; ip++)
+    {
+        VT[ip].reset();
+        for(int ib=0; ib<nBlocks; ib++) VT[ip] += VBlock[size_t(ib)*size_t(nPts)+ip];
+    }
+
+    if(m_pPolar3d->bVortonWake())
+    {
+        double vtncorelength = m_pPolar3d->vortonCoreSize()*m_pPolar3d->referenceChordLength();
+
+        Vector3d VVtn;
+        for(int ip=0; ip<nPts; ip++)
+        {
+            getVortonVelocity(C[ip], vtncorelength, VVtn, false);
+            VT[ip] += VVtn;
+        }
+    }
 }
 
 
@@ -1069,29 +2472,22 @@ void PanelAnalysis::setVortons(std::vector<std::vector<Vorton>> const &vortons)
 */
 void PanelAnalysis::getVortonVelocity(Vector3d const &C, double vtncorelength, Vector3d &VelVtn, bool bMultiThread) const
 {
+    (void)bMultiThread; // a thread per vorton row was slower than the single thread evaluation
     VelVtn.reset();
     Vector3d VG, CG;
-    bMultiThread = false;
-    if(bMultiThread)
+    if(!m_VortonTree.isEmpty())
     {
-        // slower than single thread?
-
-        std::vector<std::thread> threads;
-        std::vector<Vector3d> VRow(nVortonRows());
-        for(int iRow=0; iRow<nVortonRows(); iRow++)
-        {
-//            futureSync.addFuture(QtConcurrent::run(&PanelAnalysis::getVortonRowVelocity, this, iRow, C, vtncorelength, &VRow[iRow]));
-            threads.push_back(std::thread(&PanelAnalysis::getVortonRowVelocity, this, iRow, C, vtncorelength, &VRow[iRow]));
-        }
+        m_VortonTree.inducedVelocity(C, vtncorelength, VelVtn);
 
-        for(int iBlock=0; iBlock<nVortonRows(); iBlock++)
+        if(m_pPolar3d->bHPlane())
         {
-            threads[iBlock].join();
+            double coef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+            CG.set(C.x, C.y, -C.z-2.0*m_pPolar3d->groundHeight());
+            m_VortonTree.inducedVelocity(CG, vtncorelength, VG);
+            VelVtn.x += VG.x* coef;
+            VelVtn.y += VG.y* coef;
+            VelVtn.z -= VG.z* coef;
         }
-        std::cout << "PanelAnalysis::getVortonVelocity joined all " << m_nBlocks << " threads" <<std::endl;
-
-        for(uint iRow=0; iRow<VRow.size(); iRow++)
-            VelVtn += VRow.at(iRow);
     }
     else
     {
@@ -1166,6 +2562,12 @@ void PanelAnalysis::getVortonVelocityGradient(Vector3d const &C, double *G) cons
 //    bool bTrace = false;
     double vtncoresize = m_pPolar3d->vortonCoreSize()*m_pPolar3d->referenceChordLength();
 
+    if(!m_VortonTree.isEmpty())
+    {
+        m_VortonTree.velocityGradient(C, vtncoresize, G);
+        return;
+    }
+
     for(int ic=0; ic<nVortonRows(); ic++)
     {
         std::vector<Vorton> const &vtnrow = m_Vorton.at(ic);
@@ -1207,6 +2609,20 @@ void PanelAnalysis::vortonDrag(double alpha, double beta, double QInf, int n0, i
 //    vtncorelength = Vortex::coreRadius();
 
     std::vector<Vorton> const &vorton = m_Vorton.at(iRow);
+
+    // the velocities at the mid points of the strips' vortices are independent, so they are evaluated on the pool
+    std::vector<Vector3d> PStrip(nStations), WStrip(nStations);
+    for(int m=0; m<nStations; m++)
+    {
+        assert(n0+m<int(m_VortexNeg.size()));
+        Vortex const &vortexneg = m_VortexNeg.at(n0+m);
+        double s = 0.5;
+        PStrip[m] = vorton.at(vortexneg.nodeIndex(0)).position()*(1.0-s) + vorton.at(vortexneg.nodeIndex(1)).position()*s;
+    }
+    auto stripVelocity = [this, &PStrip, &WStrip, vtncorelength](int m) {getVortonVelocity(PStrip[m], vtncorelength, WStrip[m]);};
+    if(s_bMultiThread) ThreadPool::pool().parallelFor(nStations, stripVelocity);
+    else               for(int m=0; m<nStations; m++) stripVelocity(m);
+
     int m=0;
     for(int ic=n0; ic<n0+nStations; ic++)
     {
@@ -1227,9 +2643,8 @@ void PanelAnalysis::vortonDrag(double alpha, double beta, double QInf, int n0, i
 
         stripforce.set(0,0,0);
 
-        double s = 0.5;
-        P.set(P0 *(1.0-s) + P1*s);
-        getVortonVelocity(P, vtncorelength, Wg);
+        P = PStrip.at(m);
+        Wg = WStrip.at(m);
 
         if(iRow!=nVortonRows() -1)  Wg *= 1.0/2.0;
 #ifdef QT_DEBUG
@@ -0,0 +1,504 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+#include <planedoe.h>
+
+#include <constants.h>
+#include <lucache.h>
+#include <planetask.h>
+#include <planexfl.h>
+#include <threadpool.h>
+#include <wingxfl.h>
+
+
+/** The minimal difference with the base value above which a wing is rescaled */
+#define DOE_DELTAVAR 0.0001
+
+
+struct PlaneDoE::Context
+{
+    PlaneXfl m_Plane;
+    PlanePolar m_Polar;
+    PlaneTask m_Task;
+};
+
+
+std::string PlaneDoE::Variable::name() const
+{
+    std::string wing  = "wing" + std::to_string(m_iWing) + "_";
+    std::string sec = wing + "sec" + std::to_string(m_iSection) + "_";
+    switch(m_Field)
+    {
+        case MASS:            return "mass";
+        case COGX:            return "cog_x";
+        case COGZ:            return "cog_z";
+        case SPAN:            return wing + "span";
+        case ROOTCHORD:       return wing + "root_chord";
+        case SWEEP:           return wing + "sweep";
+        case TIPTWIST:        return wing + "tip_twist";
+        case SECTIONCHORD:    return sec + "chord";
+        case SECTIONTWIST:    return sec + "twist";
+        case SECTIONOFFSET:   return sec + "offset";
+        case SECTIONDIHEDRAL: return sec + "dihedral";
+    }
+    return std::string();
+}
+
+
+PlaneDoE::PlaneDoE()
+{
+    m_pBasePlane = nullptr;
+    m_Sampling = FULLFACTORIAL;
+    m_nSamples = 0;
+    m_Seed = 0;
+    m_bCancel = false;
+    m_nFailed = 0;
+}
+
+
+PlaneDoE::~PlaneDoE()
+{
+    clearContexts();
+}
+
+
+/**
+ * Sets the plane and the polar from which the variants are built.
+ * The plane must remain unchanged while the DoE runs; the polar's specification is copied.
+ */
+void PlaneDoE::setBase(PlaneXfl const *pPlane, PlanePolar const *pPolar)
+{
+    m_pBasePlane = pPlane;
+    m_BasePolar.duplicateSpec(pPolar);
+    if(pPlane && m_BasePolar.bAutoInertia())
+    {
+        // the inertia variables are applied to the polar, so start from the plane's inertia
+        m_BasePolar.setInertia(pPlane->inertia());
+    }
+    clearContexts();
+}
+
+
+/**
+ * @param nSamples the number of variants of a Latin-hypercube sampling; ignored for a full factorial sampling
+ * @param seed the seed of the random generator, so that a Latin-hypercube sampling can be reproduced
+ */
+void PlaneDoE::setSampling(enumSampling sampling, int nSamples, unsigned int seed)
+{
+    m_Sampling = sampling;
+    m_nSamples = std::max(0, nSamples);
+    m_Seed = seed;
+}
+
+
+int PlaneDoE::nVariants() const
+{
+    if(m_Sampling==LATINHYPERCUBE) return m_Variable.empty() ? 1 : m_nSamples;
+
+    int n = 1;
+    for(Variable const &var : m_Variable) n *= std::max(1, var.m_nLevels);
+    return n;
+}
+
+
+/**
+ * Returns the value of the variable iVar for the variant iVariant.
+ * The full factorial values are decoded from the variant index, the first variable varying fastest.
+ */
+double PlaneDoE::sampleValue(int iVariant, int iVar) const
+{
+    Variable const &var = m_Variable.at(iVar);
+
+    if(m_Sampling==LATINHYPERCUBE)
+        return var.m_Min + (var.m_Max-var.m_Min)*m_LHSValues.at(iVar).at(iVariant);
+
+    int idx = iVariant;
+    for(int i=0; i<iVar; i++) idx /= std::max(1, m_Variable.at(i).m_nLevels);
+    int nLevels = std::max(1, var.m_nLevels);
+    int level = idx % nLevels;
+    if(nLevels==1) return var.m_Min;
+    return var.m_Min + (var.m_Max-var.m_Min)*double(level)/double(nLevels-1);
+}
+
+
+/** Makes the normalized Latin-hypercube samples: one random value in each of the n strata of each variable */
+void PlaneDoE::makeSamples()
+{
+    m_LHSValues.clear();
+    if(m_Sampling!=LATINHYPERCUBE) return;
+
+    std::mt19937 gen(m_Seed);
+    std::uniform_real_distribution<double> jitter(0.0, 1.0);
+    int n = m_nSamples;
+
+    m_LHSValues.resize(m_Variable.size());
+    std::vector<int> strata(n);
+    for(std::vector<double> &values : m_LHSValues)
+    {
+        std::iota(strata.begin(), strata.end(), 0);
+        std::shuffle(strata.begin(), strata.end(), gen);
+        values.resize(n);
+        for(int i=0; i<n; i++) values[i] = (double(strata[i]) + jitter(gen))/double(n);
+    }
+}
+
+
+void PlaneDoE::makeColumns()
+{
+    m_ColumnNames.clear();
+    m_ColumnNames.push_back("variant");
+    for(Variable const &var : m_Variable) m_ColumnNames.push_back(var.name());
+    for(char const *name : {"alpha", "qinf", "CL", "CD", "Cm", "CL/CD", "max_bending"})
+        m_ColumnNames.push_back(name);
+
+    m_Columns.clear();
+    m_Columns.resize(m_ColumnNames.size());
+}
+
+
+/**
+ * Returns the variant indexes grouped by geometry, i.e. the variants of a group differ only by
+ * their inertia variables and share the same panel mesh.
+ */
+std::vector<std::vector<int>> PlaneDoE::geometryGroups() const
+{
+    int nVariants = PlaneDoE::nVariants();
+    std::vector<int> geomvar;
+    for(int iv=0; iv<nVariables(); iv++)
+        if(m_Variable.at(iv).isGeometric()) geomvar.push_back(iv);
+
+    std::vector<std::vector<double>> key(nVariants);
+    for(int i=0; i<nVariants; i++)
+        for(int iv : geomvar) key[i].push_back(sampleValue(i, iv));
+
+    std::vector<int> order(nVariants);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&key](int a, int b){return key[a]<key[b];});
+
+    std::vector<std::vector<int>> groups;
+    for(int i=0; i<nVariants; i++)
+    {
+        if(i==0 || key[order[i]]!=key[order[i-1]]) groups.push_back({});
+        groups.back().push_back(order[i]);
+    }
+    return groups;
+}
+
+
+/**
+ * Runs all the variants and fills the results table.
+ * The groups of variants with the same geometry run concurrently on the thread pool;
+ * in each group the first variant is analysed first so that its factorization is cached
+ * for the others, which then run concurrently.
+ * @return true if the DoE was not cancelled.
+ */
+bool PlaneDoE::run()
+{
+    m_bCancel = false;
+    m_nFailed = 0;
+    m_Log.clear();
+    makeColumns();
+
+    if(!m_pBasePlane)
+    {
+        m_Log = "No base plane defined\n";
+        return false;
+    }
+
+    for(Variable const &var : m_Variable)
+    {
+        if(!var.isGeometric()) continue;
+        if(var.m_iWing<0 || var.m_iWing>=m_pBasePlane->nWings() ||
+           (var.m_Field>=SECTIONCHORD && (var.m_iSection<0 || var.m_iSection>=m_pBasePlane->wingAt(var.m_iWing)->nSections())))
+        {
+            m_Log = "Invalid wing or section index for variable " + var.name() + "\n";
+            return false;
+        }
+    }
+
+    makeSamples();
+    std::vector<std::vector<int>> groups = geometryGroups();
+
+    bool bLUCache = LUCache::isEnabled();
+    LUCache::setEnabled(true);
+
+    ThreadPool::pool().parallelFor(int(groups.size()), [this, &groups](int ig)
+    {
+        std::vector<int> const &group = groups.at(ig);
+        if(m_bCancel) return;
+
+        Context *pCtx = acquireContext();
+        bool bRef = runVariant(group.front(), *pCtx);
+        releaseContext(pCtx);
+
+        if(!bRef || group.size()<2) return;
+
+        ThreadPool::pool().parallelFor(int(group.size())-1, [this, &group](int i)
+        {
+            if(m_bCancel) return;
+            Context *pCtx = acquireContext();
+            runVariant(group.at(i+1), *pCtx);
+            releaseContext(pCtx);
+        });
+    });
+
+    LUCache::setEnabled(bLUCache);
+
+    // the rows were appended in order of completion; sort them by variant, keeping the order of the operating points
+    size_t nRows = m_Columns.front().size();
+    std::vector<size_t> order(nRows);
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<double> const &variant = m_Columns.front();
+    std::stable_sort(order.begin(), order.end(), [&variant](size_t a, size_t b){return variant[a]<variant[b];});
+    for(std::vector<double> &col : m_Columns)
+    {
+        std::vector<double> sorted(nRows);
+        for(size_t i=0; i<nRows; i++) sorted[i] = col[order[i]];
+        col.swap(sorted);
+    }
+
+    clearContexts();
+    return !m_bCancel;
+}
+
+
+/** Cancels the running analyses and skips the pending variants */
+void PlaneDoE::cancel()
+{
+    m_bCancel = true;
+    std::lock_guard<std::mutex> lock(m_ContextMutex);
+    for(Context *pCtx : m_Contexts)
+    {
+        if(std::find(m_FreeContexts.begin(), m_FreeContexts.end(), pCtx)==m_FreeContexts.end())
+            pCtx->m_Task.cancelTask();
+    }
+}
+
+
+/**
+ * Builds the plane and the polar of the variant, following the construction of the optimizer's
+ * plane particles.
+ */
+void PlaneDoE::makeVariant(int iVariant, PlaneXfl &plane, PlanePolar &polar) const
+{
+    plane.duplicate(m_pBasePlane);
+
+    polar.duplicateSpec(&m_BasePolar);
+    polar.clearWPolarData();
+
+    std::vector<bool> bModified(plane.nWings(), false);
+
+    for(int iv=0; iv<nVariables(); iv++)
+    {
+        Variable const &var = m_Variable.at(iv);
+        double value = sampleValue(iVariant, iv);
+
+        if(!var.isGeometric())
+        {
+            polar.setAutoInertia(false);
+            switch(var.m_Field)
+            {
+                case MASS:  polar.setMass(value);  break;
+                case COGX:  polar.setCoGx(value);  break;
+                case COGZ:  polar.setCoGz(value);  break;
+                default: break;
+            }
+            continue;
+        }
+
+        WingXfl const *pRefWing = m_pBasePlane->wingAt(var.m_iWing);
+        WingXfl *pWing = plane.wing(var.m_iWing);
+        bModified[var.m_iWing] = true;
+
+        switch(var.m_Field)
+        {
+            case SPAN:
+                if(fabs(value-pRefWing->planformSpan())>DOE_DELTAVAR) pWing->scaleSpan(value);
+                break;
+            case ROOTCHORD:
+                if(fabs(value-pRefWing->rootChord())>DOE_DELTAVAR) pWing->scaleChord(value);
+                break;
+            case SWEEP:
+                if(fabs(value-pRefWing->averageSweep())>DOE_DELTAVAR) pWing->scaleSweep(value);
+                break;
+            case TIPTWIST:
+                if(fabs(value-pRefWing->twist())>DOE_DELTAVAR) pWing->scaleTwist(value);
+                break;
+            case SECTIONCHORD:    pWing->section(var.m_iSection).setChord(value);    break;
+            case SECTIONTWIST:    pWing->section(var.m_iSection).setTwist(value);    break;
+            case SECTIONOFFSET:   pWing->section(var.m_iSection).setXOffset(value);  break;
+            case SECTIONDIHEDRAL: pWing->section(var.m_iSection).setDihedral(value); break;
+            default: break;
+        }
+    }
+
+    for(int iw=0; iw<plane.nWings(); iw++)
+        if(bModified[iw]) plane.wing(iw)->computeGeometry();
+
+    polar.setReferenceChordLength(plane.mac());
+    polar.setReferenceArea(plane.projectedArea(false));
+    polar.setReferenceSpanLength(plane.projectedSpan());
+}
+
+
+/**
+ * Analyses one variant in the context and appends its operating points to the results.
+ * @return true if the analysis produced at least one operating point.
+ */
+bool PlaneDoE::runVariant(int iVariant, Context &ctx)
+{
+    PlaneXfl &plane = ctx.m_Plane;
+    PlanePolar &polar = ctx.m_Polar;
+    PlaneTask &task = ctx.m_Task;
+
+    makeVariant(iVariant, plane, polar);
+
+    // the context's plane keeps the connections of the parts which have not changed since its previous variant
+    plane.makePlane(polar.bThickSurfaces(), true, polar.isTriangleMethod());
+
+    task.clearMessages();
+    task.setAnalysisStatus(xfl::RUNNING);
+    task.setObjects(&plane, &polar);
+    task.setOppList(m_OppList);
+    task.run();
+
+    int nPts = polar.dataSize();
+    if(nPts==0 || task.hasErrors())
+    {
+        m_nFailed++;
+        std::lock_guard<std::mutex> lock(m_ResultMutex);
+        m_Log += "Variant " + std::to_string(iVariant) + ": no converged operating point\n";
+        if(nPts==0) return false;
+    }
+
+    std::vector<double> values(m_Variable.size());
+    for(int iv=0; iv<nVariables(); iv++) values[iv] = sampleValue(iVariant, iv);
+
+    std::lock_guard<std::mutex> lock(m_ResultMutex);
+    for(int i=0; i<nPts; i++)
+    {
+        AeroForces const &AF = polar.aeroForce(i);
+        int ic = 0;
+        m_Columns[ic++].push_back(double(iVariant));
+        for(double v : values) m_Columns[ic++].push_back(v);
+        m_Columns[ic++].push_back(polar.m_Alpha.at(i));
+        m_Columns[ic++].push_back(polar.m_QInfinite.at(i));
+        m_Columns[ic++].push_back(AF.CL());
+        m_Columns[ic++].push_back(AF.CD());
+        m_Columns[ic++].push_back(AF.Cm());
+        m_Columns[ic++].push_back(fabs(AF.CD())>PRECISION ? AF.CL()/AF.CD() : 0.0);
+        m_Columns[ic++].push_back(i<int(polar.m_MaxBending.size()) ? polar.m_MaxBending.at(i) : 0.0);
+    }
+    return true;
+}
+
+
+PlaneDoE::Context *PlaneDoE::acquireContext()
+{
+    std::lock_guard<std::mutex> lock(m_ContextMutex);
+    if(!m_FreeContexts.empty())
+    {
+        Context *pCtx = m_FreeContexts.back();
+        m_FreeContexts.pop_back();
+        return pCtx;
+    }
+    Context *pCtx = new Context;
+    pCtx->m_Task.setKeepOpps(false);
+    m_Contexts.push_back(pCtx);
+    return pCtx;
+}
+
+
+void PlaneDoE::releaseContext(Context *pCtx)
+{
+    std::lock_guard<std::mutex> lock(m_ContextMutex);
+    m_FreeContexts.push_back(pCtx);
+}
+
+
+void PlaneDoE::clearContexts()
+{
+    std::lock_guard<std::mutex> lock(m_ContextMutex);
+    for(Context *pCtx : m_Contexts) delete pCtx;
+    m_Contexts.clear();
+    m_FreeContexts.clear();
+}
+
+
+std::string PlaneDoE::exportToString(std::string const &separator) const
+{
+    std::ostringstream out;
+    for(int ic=0; ic<nColumns(); ic++)
+        out << (ic>0 ? separator : "") << m_ColumnNames.at(ic);
+    out << "\n";
+
+    out.precision(9);
+    for(int ir=0; ir<nRows(); ir++)
+    {
+        for(int ic=0; ic<nColumns(); ic++)
+            out << (ic>0 ? separator : "") << m_Columns.at(ic).at(ir);
+        out << "\n";
+    }
+    return out.str();
+}
+
+
+/**
+ * Writes the results table in binary columnar form:
+ * the 8 characters "FL5DOE01", the int32 column count, the int64 row count,
+ * then for each column its int32 name length and name,
+ * then the columns one after the other as arrays of doubles in the machine's byte order.
+ */
+bool PlaneDoE::writeColumns(std::string const &pathname) const
+{
+    std::ofstream out(pathname, std::ios::binary);
+    if(!out) return false;
+
+    out.write("FL5DOE01", 8);
+    std::int32_t nCols = std::int32_t(nColumns());
+    std::int64_t nrows = std::int64_t(nRows());
+    out.write(reinterpret_cast<char const*>(&nCols), sizeof(nCols));
+    out.write(reinterpret_cast<char const*>(&nrows), sizeof(nrows));
+
+    for(std::string const &name : m_ColumnNames)
+    {
+        std::int32_t length = std::int32_t(name.size());
+        out.write(reinterpret_cast<char const*>(&length), sizeof(length));
+        out.write(name.data(), length);
+    }
+
+    for(std::vector<double> const &col : m_Columns)
+        out.write(reinterpret_cast<char const*>(col.data()), std::streamsize(col.size()*sizeof(double)));
+
+    return bool(out);
+}
+
@@ -0,0 +1,130 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <QDataStream>
+
+#include <planeoppcache.h>
+#include <planeopp.h>
+
+
+std::list<PlaneOppCache::Entry> PlaneOppCache::s_Entries;
+std::mutex PlaneOppCache::s_Mutex;
+bool PlaneOppCache::s_bEnabled(true);
+double PlaneOppCache::s_MaxMemory(256.0);
+
+
+namespace
+{
+    void setStreamFormat(QDataStream &ar)
+    {
+        ar.setVersion(QDataStream::Qt_4_5);
+        ar.setByteOrder(QDataStream::LittleEndian);
+    }
+}
+
+
+/**
+ * @return a new copy of the cached operating point which matches the key, or nullptr if there is none;
+ * the caller takes ownership of the copy.
+ */
+PlaneOpp *PlaneOppCache::fetch(std::uint64_t key)
+{
+    if(!s_bEnabled || key==0) return nullptr;
+
+    QByteArray data;
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        for(auto it=s_Entries.begin(); it!=s_Entries.end(); it++)
+        {
+            if(it->m_Key!=key) continue;
+            data = it->m_Data;
+            s_Entries.splice(s_Entries.begin(), s_Entries, it);
+            break;
+        }
+    }
+    if(data.isEmpty()) return nullptr;
+
+    QDataStream ar(data);
+    setStreamFormat(ar);
+    PlaneOpp *pPOpp = new PlaneOpp;
+    if(!pPOpp->serializeFl5(ar, false) || ar.status()!=QDataStream::Ok)
+    {
+        delete pPOpp;
+        return nullptr;
+    }
+    return pPOpp;
+}
+
+
+/**
+ * Adds a serialized copy of the operating point to the cache, evicting the least recently used entries if necessary.
+ */
+void PlaneOppCache::store(std::uint64_t key, PlaneOpp *pPOpp)
+{
+    if(!s_bEnabled || key==0 || !pPOpp) return;
+
+    QByteArray data;
+    {
+        QDataStream ar(&data, QIODevice::WriteOnly);
+        setStreamFormat(ar);
+        pPOpp->serializeFl5(ar, true);
+    }
+
+    size_t maxsize = size_t(s_MaxMemory*1024.0*1024.0);
+    if(size_t(data.size())>maxsize) return;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    for(Entry const &entry : s_Entries)
+    {
+        if(entry.m_Key==key) return; // stored by a concurrent task
+    }
+
+    while(!s_Entries.empty() && totalSize()+size_t(data.size())>maxsize) s_Entries.pop_back();
+
+    s_Entries.push_front({key, data});
+}
+
+
+void PlaneOppCache::clear()
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    s_Entries.clear();
+}
+
+
+/** @return the memory used by the cached operating points, in MB */
+double PlaneOppCache::memorySize()
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    return double(totalSize())/1024.0/1024.0;
+}
+
+
+size_t PlaneOppCache::totalSize()
+{
+    size_t sz = 0;
+    for(Entry const &entry : s_Entries) sz += size_t(entry.m_Data.size());
+    return sz;
+}
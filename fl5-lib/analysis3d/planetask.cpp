@@ -26,11 +26,13 @@
 #define _MATH_DEFINES_DEFINED
 
 #include <chrono>
+#include <memory>
 #include <string>
 #include <thread>
 
 
 #include <QString>
+#include <QDataStream>
 #include <QDebug>
 
 
@@ -48,6 +50,9 @@
 #include <planetask.h>
 
 #include <geom_params.h>
+#include <convergencemonitor.h>
+#include <livechannel.h>
+#include <lucache.h>
 #include <mesh_globals.h>
 #include <objects2d.h>
 #include <objects3d.h>
@@ -57,9 +62,13 @@
 #include <p4analysis.h>
 #include <panelanalysis.h>
 #include <planeopp.h>
+#include <planeoppcache.h>
 #include <planepolar.h>
+#include <threadpool.h>
 #include <planexfl.h>
 #include <polar.h>
+#include <polarmeshgenerator.h>
+#include <resultsink.h>
 #include <stabderivatives.h>
 #include <units.h>
 #include <utils.h>
@@ -71,21 +80,51 @@
 #endif
 
 
+namespace
+{
+    /** Restores the task's polar on exit from the loops over the loading polars */
+    struct PolarRestore
+    {
+        PolarRestore(PlanePolar *&pPolar) : m_pRef(pPolar), m_pSaved(pPolar) {}
+        ~PolarRestore() {m_pRef = m_pSaved;}
+        PlanePolar *&m_pRef;
+        PlanePolar *m_pSaved;
+    };
+}
+
+
 bool PlaneTask::s_bViscInitTwist = false;
 double PlaneTask::s_ViscRelax = 0.5;
 double PlaneTask::s_ViscAlphaPrecision = 0.01;
 int PlaneTask::s_ViscMaxIter = 35;
+bool PlaneTask::s_bViscAitken = true;
+bool PlaneTask::s_bSuperposeDownwash = true;
+bool PlaneTask::s_bPipelined = true;
+bool PlaneTask::s_bCheckIntersections = true;
+double PlaneTask::s_IntersectionGap = 0.01;
 
 PlaneTask::PlaneTask() : Task3d()
 {
     m_pPlane  = nullptr;
     m_pPlPolar = nullptr;
+    m_pRefPA = nullptr;
 
     m_Ctrl = -LARGEVALUE;
     m_Alpha = 0.0;
     m_QInf = m_Beta = m_Phi = 0.0;
 
     m_bDerivatives = true;
+    m_bKeepUnitSolutions = false;
+
+    m_ViscOmega = s_ViscRelax;
+    m_ViscRms = 0.0;
+    m_iViscMax = -1;
+
+    m_pMasterTask = nullptr;
+    m_pPostTask   = nullptr;
+    m_pPostPOpp   = nullptr;
+
+    m_pPolarMesh = nullptr;
 
     m_AF.resetAll();
 }
@@ -93,6 +132,15 @@ PlaneTask::PlaneTask() : Task3d()
 
 PlaneTask::~PlaneTask()
 {
+    finishPostTask();
+    if(m_pPolarMesh) delete m_pPolarMesh;
+}
+
+
+void PlaneTask::traceStdLog(std::string const &str)
+{
+    if(m_pMasterTask) m_pMasterTask->traceStdLog(str);
+    else              Task3d::traceStdLog(str);
 }
 
 
@@ -209,7 +257,8 @@ bool PlaneTask::initializeTask()
     if(PanelAnalysis::s_bMultiThread) traceStdLog("Running in multi-threaded mode\n\n");
     else                              traceStdLog("Running in single-threaded mode\n\n");
 
-    if(PanelAnalysis::s_bDoublePrecision) traceStdLog("Linear system calculations in floating point double precision\n\n");
+    if(PanelAnalysis::bMixedPrecision())  traceStdLog("Linear system calculations in mixed precision with iterative refinement\n\n");
+    else if(PanelAnalysis::s_bDoublePrecision) traceStdLog("Linear system calculations in floating point double precision\n\n");
     else                                  traceStdLog("Linear system calculations in floating point single precision\n\n");
 
     if(Panel3::usingNintcheuFataMethod())
@@ -219,6 +268,14 @@ bool PlaneTask::initializeTask()
 
     PlaneXfl *pPlaneXfl = dynamic_cast<PlaneXfl *>(m_pPlane);
 
+    startPolarMesh(pPlaneXfl);
+
+    // release the analysis of the previous run if the task is reused
+    if(m_pPA) delete m_pPA;
+    m_pPA  = nullptr;
+    m_pP3A = nullptr;
+    m_pP4A = nullptr;
+
     if(m_pPlPolar->isQuadMethod())
     {
         traceStdLog("Initializing the quad analysis\n");
@@ -258,6 +315,22 @@ bool PlaneTask::initializeTask()
         }
         traceStdLog("   ...done\n\n");
 
+        if(s_bCheckIntersections)
+        {
+            traceStdLog("Checking panel intersections\n");
+            std::string log;
+            std::vector<int> intersectlist, overlaplist;
+            if(m_pPlane->triMesh().checkIntersections(log, s_IntersectionGap, intersectlist, overlaplist, m_nThreads!=1)>0)
+            {
+                traceStdLog(log);
+                traceStdLog("The mesh has intersecting or overlapping panels, and the influence matrix would be singular.\n"
+                            "Check the mesh with the menu option mesh/check panels, and correct the geometry or the mesh.\n\n");
+                m_bError = true;
+                return false;
+            }
+            traceStdLog("   ...done\n\n");
+        }
+
         if(m_pPlPolar->isTriUniformMethod())
         {
             m_pP3A = new P3UniAnalysis;
@@ -272,6 +345,8 @@ bool PlaneTask::initializeTask()
         }
     }
 
+    if(m_pPA && m_nThreads>0) m_pPA->setThreadCount(m_nThreads);
+
     switch(m_pPlPolar->type())
     {
         case xfl::BOATPOLAR:
@@ -376,7 +451,10 @@ bool PlaneTask::initializeTask()
                 strong = QString::asprintf("   Virtual twist precision = %g", s_ViscAlphaPrecision);
                 strong += DEGch  + EOLch;
                 strange += strong;
-                strong = QString::asprintf("   Relaxation factor       = %g\n\n", s_ViscRelax);
+                if(s_bViscAitken)
+                    strong = QString::asprintf("   Relaxation factor       = %g initially, Aitken adaptive\n\n", s_ViscRelax);
+                else
+                    strong = QString::asprintf("   Relaxation factor       = %g\n\n", s_ViscRelax);
                 strange += strong;
                 traceLog(strange);
             }
@@ -398,6 +476,19 @@ bool PlaneTask::initializeTask()
         }
     }
 
+    // the doublet densities of a previous solution, from which the iterative solver starts
+    if(m_pP3A && m_pPlPolar->isTriangleMethod() && int(m_InitialGuess.size())==3*m_pP3A->nPanels())
+    {
+        if(m_pPlPolar->isTriUniformMethod())
+        {
+            std::vector<double> mu(m_pP3A->nPanels());
+            for(int p=0; p<int(mu.size()); p++) mu[p] = (m_InitialGuess.at(3*p)+m_InitialGuess.at(3*p+1)+m_InitialGuess.at(3*p+2))/3.0;
+            m_pP3A->setInitialSolution(mu);
+        }
+        else
+            m_pP3A->setInitialSolution(m_InitialGuess);
+    }
+
     strange = QString::asprintf("Counted %d elements\n", m_pPA->nPanels());
     strange += QString::asprintf("Matrix size = %d\n\n", m_pPA->matSize());
     traceLog(strange);
@@ -616,17 +707,130 @@ void PlaneTask::loop()
                 m_T8Opps.push_back({true, alpha, beta, qinf});
             }
         }
+        openCheckpoint();
         T123458Loop();
+        finishPostTask();
     }
     else if(m_pPlPolar->isType6())
     {
+        openCheckpoint();
         T6Loop();
+        finishPostTask();
     }
     else if(m_pPlPolar->isType7())
     {
         T7Loop();
     }
 
+    // the checkpoint is kept only if the task was interrupted
+    if(!isCancelled()) m_Checkpoint.remove();
+}
+
+
+/**
+ * @return the key of the checkpoint of this task, made of the mesh hash, of the polar's specification,
+ * of the list of operating points and of the solver settings, or 0 if the task cannot be checkpointed.
+ * The viscous polars are not checkpointed, since their results depend on the foil polars which the key does not capture.
+ */
+std::uint64_t PlaneTask::checkpointKey() const
+{
+    if(m_pPlPolar->isViscous()) return 0;
+    std::uint64_t h = m_pPA ? m_pPA->meshHash() : 0;
+    if(h==0) return 0;
+
+    PlanePolar spec;
+    spec.duplicateSpec(m_pPlPolar);
+    QByteArray bytes;
+    {
+        QDataStream ar(&bytes, QIODevice::WriteOnly);
+        spec.serializeFl5v750(ar, true);
+    }
+    LUCache::hash(h, bytes.constData(), size_t(bytes.size()));
+    std::string planename = m_pPlane->name(), polarname = m_pPlPolar->name();
+    LUCache::hash(h, planename.data(), planename.size());
+    LUCache::hash(h, polarname.data(), polarname.size());
+
+    LUCache::hash(h, int(m_T8Opps.size()));
+    for(T8Opp const &t8opp : m_T8Opps)
+    {
+        LUCache::hash(h, int(t8opp.isActive()));
+        LUCache::hash(h, t8opp.alpha());
+        LUCache::hash(h, t8opp.beta());
+        LUCache::hash(h, t8opp.Vinf());
+    }
+    LUCache::hash(h, int(m_T6CtrlList.size()));
+    for(double ctrl : m_T6CtrlList) LUCache::hash(h, ctrl);
+
+    LUCache::hash(h, int(m_bDerivatives));
+    LUCache::hash(h, int(s_bViscInitTwist));
+    LUCache::hash(h, int(PanelAnalysis::bDoublePrecision()));
+    LUCache::hash(h, int(PanelAnalysis::bMixedPrecision()));
+    LUCache::hash(h, int(s_bSuperposeDownwash));
+    LUCache::hash(h, Vortex::coreRadius());
+    LUCache::hash(h, int(Vortex::vortexModel()));
+    return h;
+}
+
+
+/**
+ * @return the key of the operating point in the PlaneOppCache, made of the mesh hash, of the polar's specification
+ * without its name, style and ranges, of the operating point's values and of the solver settings,
+ * or 0 if the operating point cannot be cached.
+ * The results of viscous polars depend on the foils' polars, on the on the fly XFoil or NeuralFoil settings and
+ * on the viscous loop settings, which are not part of the key, so these operating points are not cached.
+ */
+std::uint64_t PlaneTask::oppKey(T8Opp const &t8opp) const
+{
+    if(!PlaneOppCache::isEnabled() || m_pRefPA || m_LoadingPolars.size()) return 0;
+    if(m_pPlPolar->isViscous()) return 0;
+    std::uint64_t h = m_pPA ? m_pPA->meshHash() : 0;
+    if(h==0) return 0;
+
+    PlanePolar spec;
+    spec.duplicateSpec(m_pPlPolar);
+    spec.setName(std::string());
+    spec.setTheStyle(LineStyle());
+    spec.m_OperatingRange.clear();
+    spec.m_AngleRange.clear();
+    QByteArray bytes;
+    {
+        QDataStream ar(&bytes, QIODevice::WriteOnly);
+        spec.serializeFl5v750(ar, true);
+    }
+    LUCache::hash(h, bytes.constData(), size_t(bytes.size()));
+
+    LUCache::hash(h, t8opp.alpha());
+    LUCache::hash(h, t8opp.beta());
+    LUCache::hash(h, t8opp.Vinf());
+
+    LUCache::hash(h, int(m_bDerivatives));
+    LUCache::hash(h, int(PanelAnalysis::bDoublePrecision()));
+    LUCache::hash(h, int(PanelAnalysis::bMixedPrecision()));
+    LUCache::hash(h, int(s_bSuperposeDownwash));
+    LUCache::hash(h, Vortex::coreRadius());
+    LUCache::hash(h, int(Vortex::vortexModel()));
+    return h;
+}
+
+
+/**
+ * Opens the checkpoint of the task if checkpoints are enabled, and stores the operating points
+ * which were completed by a previous run of the same task, so that the loops skip them.
+ */
+void PlaneTask::openCheckpoint()
+{
+    m_Checkpoint.close();
+    // the operating points of the loading polars are not checkpointed
+    if(!TaskCheckpoint::isEnabled() || m_pMasterTask || m_LoadingPolars.size()) return;
+
+    std::uint64_t key = checkpointKey();
+    if(key==0) return;
+    m_Checkpoint.open(key);
+
+    std::vector<std::pair<int, PlaneOpp*>> opps = m_Checkpoint.loadOpps();
+    if(opps.size())
+        traceLog(QString::asprintf("   Resuming from the checkpoint: %d operating points already computed\n", int(opps.size())));
+    for(std::pair<int, PlaneOpp*> const &opp : opps) storePOpp(opp.second, opp.first);
 }
 
 
@@ -651,6 +855,14 @@ bool PlaneTask::T6Loop()
 
     double AlphaStab(0.0), BetaStab(0.0), QInfStab(1.0);
 
+    // the state of the point which was in progress when a previous run of the task was interrupted
+    TaskCheckpoint::WakeState resumestate;
+    bool bResume = m_Checkpoint.isOpen() && m_Checkpoint.loadWakeState(resumestate) && !m_Checkpoint.isDone(resumestate.m_iOpp);
+
+    // the viscous loop updates the strips and flap moments of the plane's wings, which are read by the post-processing
+    // task in computePlane(), so the operating points are not pipelined in this case
+    bool bPipelined = s_bPipelined && !(m_pPlPolar->isViscous() && m_pPlPolar->bViscousLoop());
+
     for (m_qRHS=0; m_qRHS<m_nRHS; m_qRHS++)
     {
         if(s_bCancel)
@@ -659,6 +871,25 @@ bool PlaneTask::T6Loop()
             return false;
         }
 
+        if(m_Checkpoint.isDone(m_qRHS)) continue; // restored from the checkpoint
+
+        bool bResumePoint = bResume && resumestate.m_iOpp==m_qRHS;
+        if(bResumePoint)
+        {
+            bConvergedLast = resumestate.m_bConvergedLast;
+            if(resumestate.m_gamma.size()==m_gamma.size()) m_gamma = resumestate.m_gamma;
+        }
+        else if(m_Checkpoint.isWakeStateDue())
+        {
+            TaskCheckpoint::WakeState state;
+            state.m_iOpp = m_qRHS;
+            state.m_bConvergedLast = bConvergedLast;
+            state.m_gamma = m_gamma;
+            m_Checkpoint.storeWakeState(state);
+        }
+
+
+        TaskProfile::Scope opphase(&m_Profile, "operating point");
 
         log.clear();
         traceStdLog("\n");
@@ -712,7 +943,7 @@ bool PlaneTask::T6Loop()
         //reset the initial geometry before a new angle is processed
         traceStdLog("\n      Restoring the base mesh\n");
         m_pPlane->restoreMesh();
-        m_pPA->restorePanels();
+        if(m_pP4A) m_pPA->restorePanels(); // the triangle panels are reloaded from the rotated mesh below
 
         traceStdLog("      Setting control positions\n");
 
@@ -723,12 +954,10 @@ bool PlaneTask::T6Loop()
             if(m_pP4A && m_pPlane->isXflType())
             {
                 pPlaneXfl->setRangePositions4(m_pPlPolar, m_Ctrl, str);
-                m_pP4A->setQuadMesh(pPlaneXfl->quadMesh());
             }
             else if(m_pP3A)
             {
                 pPlaneXfl->setRangePositions3(m_pPlPolar, m_Ctrl, str);
-                m_pP3A->setTriMesh(m_pPlane->triMesh());
             }
             log += QString::fromStdString(str);
         }
@@ -762,42 +991,93 @@ bool PlaneTask::T6Loop()
 
 
         auto start = std::chrono::system_clock::now();
+        auto end = start;
+        int duration = 0;
 
-        traceStdLog("      Making the influence matrix...");
-        m_pPA->makeInfluenceMatrix();
+        bool bPlainLU = false;  // true if the matrix holds the LU factors of this control value, without a low-rank update
+        bool bLUStored = false; // true if these factors are in the checkpoint
+        if(m_pPA->restoreFactorization())
+        {
+            m_Profile.count(TaskProfile::LUCACHEHITS);
+            traceStdLog("      Using the cached LU factorization of the influence matrix\n");
+            bPlainLU = true;
+        }
+        else if(bResumePoint && resumestate.m_iWake>0 && m_pPA->restoreFactorization(m_Checkpoint))
+        {
+            traceStdLog("      Using the LU factorization of the checkpoint\n");
+            bPlainLU = bLUStored = true;
+        }
+        else
+        {
+            // only the control surfaces and the wake move from the previous control value,
+            // so that the reference factorization may only need a low-rank update
+            bool bUpdate = m_pPA->canUpdateFactorization();
+            if(bUpdate) m_pPA->prepareFactorizationUpdate();
 
-        auto end = std::chrono::system_clock::now();
-        int duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-        start = end;
-        strange = QString::asprintf("     done in %.3f s\n", double(duration)/1000.0);
+            traceStdLog("      Making the influence matrix...");
+            {
+                TaskProfile::Scope phase(&m_Profile, "influence matrix");
+                m_pPA->makeInfluenceMatrix();
+                m_Profile.count(TaskProfile::INFLUENCECOEFS, int64_t(m_pPA->matSize())*int64_t(m_pPA->matSize()));
+            }
 
-        traceLog(strange);
+            end = std::chrono::system_clock::now();
+            duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+            start = end;
+            strange = QString::asprintf("     done in %.3f s\n", double(duration)/1000.0);
 
-        if(m_pPA->m_bMatrixError) return false;
-        if (isCancelled()) return true;
+            traceLog(strange);
 
-        if(!m_pPlPolar->isVLM())
-        {
-            m_pPA->addWakeContribution();
             if(m_pPA->m_bMatrixError) return false;
-        }
-        if (isCancelled()) return true;
+            if (isCancelled()) return true;
 
-        traceStdLog("      LAPACK - LU factorization...");
+            if(!m_pPlPolar->isVLM())
+            {
+                TaskProfile::Scope phase(&m_Profile, "wake contribution");
+                m_pPA->addWakeContribution();
+                if(m_pPA->m_bMatrixError) return false;
+            }
+            if (isCancelled()) return true;
 
-        if (!m_pPA->LUfactorize())
-        {
-            traceStdLog(" singular matrix, aborting\n");
-            m_bError = true;
-            return true;
-        }
+            int rank = 0;
+            bool bUpdated = false;
+            if(bUpdate)
+            {
+                TaskProfile::Scope phase(&m_Profile, "LU update");
+                bUpdated = m_pPA->updateFactorization(rank);
+            }
+            if(bUpdated)
+            {
+                end = std::chrono::system_clock::now();
+                duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+                start = end;
+                strange = QString::asprintf("      Low-rank update of the LU factorization, rank %d, done in %.3f s\n", rank, double(duration)/1000.0);
+                traceLog(strange);
+            }
+            else
+            {
+                traceStdLog("      LAPACK - LU factorization...");
 
-        end = std::chrono::system_clock::now();
-        duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-        start = end;
-        strange = QString::asprintf("       done in %.3f s\n", double(duration)/1000.0);
+                m_pPA->storeReferenceMatrix();
+                TaskProfile::Scope phase(&m_Profile, "LU factorization");
+                m_Profile.count(TaskProfile::LUFACTORIZATIONS);
+                if (!m_pPA->LUfactorize())
+                {
+                    traceStdLog(" singular matrix, aborting\n");
+                    m_bError = true;
+                    return true;
+                }
+                m_pPA->storeFactorization();
+                bPlainLU = true;
 
-        traceLog(strange);
+                end = std::chrono::system_clock::now();
+                duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+                start = end;
+                strange = QString::asprintf("       done in %.3f s\n", double(duration)/1000.0);
+
+                traceLog(strange);
+            }
+        }
 
         traceStdLog("      Making source strengths...");
         m_pPA->makeSourceStrengths(objects::windDirection(m_Alpha, 0.0)); // unit source strengths
@@ -817,20 +1097,57 @@ bool PlaneTask::T6Loop()
         if(s_bViscInitTwist || !bConvergedLast)     std::fill(m_gamma.begin(), m_gamma.end(), 0);
 
 
+        // the panels do not move during the wake and viscous iterations,
+        // so that the RHS of each iteration is made from coefficients in O(N)
+        {
+            TaskProfile::Scope phase(&m_Profile, "RHS");
+            m_pPA->makeRHSCoefficients();
+        }
+        if (isCancelled()) return true;
+
         traceStdLog("      Starting wake iterations\n");
 
-        for(int ivw=0; ivw<nWakeIter; ivw++)
+        Vector3d LastForce;
+        int nSteady = 0;
+        int iWake0 = 0;
+        if(bResumePoint && resumestate.m_iWake>0 && m_pPlPolar->bVortonWake())
+        {
+            iWake0    = resumestate.m_iWake;
+            m_QInf    = resumestate.m_QInf;
+            QInfStab  = resumestate.m_QInfStab;
+            LastForce = resumestate.m_LastForce;
+            nSteady   = resumestate.m_nSteady;
+            if(resumestate.m_gamma.size()==m_gamma.size()) m_gamma = resumestate.m_gamma;
+            m_pPA->setVortons(resumestate.m_Vortons);
+            m_pPA->m_VortexNeg = resumestate.m_VortexNeg;
+            traceLog(QString::asprintf("      Resuming the wake iterations from the checkpoint at iteration %d\n", iWake0+1));
+        }
+        if(bResumePoint)
+        {
+            bResume = false;
+            resumestate = TaskCheckpoint::WakeState(); // releases the vortons
+        }
+
+        for(int ivw=iWake0; ivw<nWakeIter; ivw++)
         {
             strange.clear();
 
+            TaskProfile::Scope vpwphase(m_pPlPolar->bVortonWake() ? &m_Profile : nullptr, "VPW iteration");
             if(m_pPlPolar->bVortonWake())
+            {
+                m_Profile.count(TaskProfile::VPWITERATIONS);
+                TaskProfile::Scope phase(&m_Profile, "vorton velocities");
                 m_pPA->makeRHSVWVelocities(VVPW);
+            }
 
             bViscLoopError = false;
             int nViscIter = 1;
             if(m_pPlPolar->bViscousLoop()) nViscIter = std::max(nViscIter, s_ViscMaxIter);
+            int nViscDone = 0;
+            resetViscousRelaxation();
             for(int inl=0; inl<nViscIter; inl++)
             {
+                nViscDone = inl+1;
                 Vector3d VInf(objects::windDirection(AlphaStab, BetaStab)*m_QInf);
                 std::fill(VField.begin(), VField.end(), VInf);
                 if(m_pPlane->isXflType())  addTwistedVelField(m_QInf, AlphaStab, VField);
@@ -840,9 +1157,16 @@ bool PlaneTask::T6Loop()
 
 //                m_pPA->makeSourceStrengths(VField);
 
-                m_pPA->makeRHS(VField, m_pPA->m_uRHS, nullptr);
+                {
+                    TaskProfile::Scope phase(&m_Profile, "RHS");
+                    m_pPA->combineRHSCoefficients(VField, m_pPA->m_uRHS);
+                }
 
-                m_pPA->backSubUnitRHS(m_pPA->m_uRHS.data(), nullptr, nullptr, nullptr, nullptr, nullptr);
+                {
+                    TaskProfile::Scope phase(&m_Profile, "back-substitution");
+                    m_Profile.count(TaskProfile::RHSSOLVED);
+                    m_pPA->backSubUnitRHS(m_pPA->m_uRHS.data(), nullptr, nullptr, nullptr, nullptr, nullptr);
+                }
 
 /*                if(ivw==nWakeIter-1)
                 {
@@ -909,8 +1233,27 @@ bool PlaneTask::T6Loop()
                     {
                         str = QString::asprintf("         iter=%3d   error=%9.5f", inl+1, error);
                         str += DEGch + "   ";
+                        str += QString::asprintf(" relax=%5.3f", m_ViscOmega);
                         str += QString::asprintf(" CL=%9.5f", CL);
                         traceLog(str + strange);
+
+                        if(m_pConvergenceMonitor && error>=s_ViscAlphaPrecision)
+                        {
+                            ResidualSample sample;
+                            sample.m_Solver      = ResidualSample::VISCOUSLOOP;
+                            sample.m_Ctrl        = m_Alpha;
+                            sample.m_Iter        = inl;
+                            sample.m_Rms         = m_ViscRms;
+                            sample.m_Max         = error;
+                            sample.m_MaxLocation = m_iViscMax;
+                            sample.m_Relax       = m_ViscOmega;
+                            sample.m_Value       = CL;
+                            if(m_pConvergenceMonitor->onIteration(sample)!=ConvergenceMonitor::CONTINUE)
+                            {
+                                traceLog("         Stopped by the convergence monitor\n");
+                                break;
+                            }
+                        }
                     }
                     else
                     {
@@ -928,11 +1271,13 @@ bool PlaneTask::T6Loop()
 
             if(m_pPlPolar->isViscous() && m_pPlPolar->bViscousLoop())
             {
+                if(m_pConvergenceMonitor)
+                    m_pConvergenceMonitor->onPointEnd(ResidualSample::VISCOUSLOOP, m_Alpha, !bViscLoopError && error<s_ViscAlphaPrecision, nViscDone);
                 if(!bViscLoopError)
                 {
                     if(error<s_ViscAlphaPrecision)
                     {
-                        str = "         --- Converged ---\n\n";
+                        str = QString::asprintf("         --- Converged after %d iterations ---\n\n", nViscDone);
                         traceLog(str);
                         bConvergedLast = true;
                     }
@@ -957,6 +1302,11 @@ bool PlaneTask::T6Loop()
 
             if(bViscLoopError) break; // break wake iterations
             if(m_bStopVPWIterations) break; // user requested interruption
+            if(m_pPolar3d->bVortonWake() && hasVPWConverged(F, LastForce, nSteady))
+            {
+                traceLog(QString::asprintf("      VPW iterations converged after %d iterations\n", ivw+1));
+                break;
+            }
 
             // advect the vortons
 //            advectVortons(AlphaStab, 0, QInfStab, 0);
@@ -965,13 +1315,41 @@ bool PlaneTask::T6Loop()
             // add a vorton row and clean inactive vortons
             if(m_pPolar3d->bVortonWake()) makeVortonRow(0);
 
+            // merge the vortons in excess of the budget
+            manageVortons();
+
             if(s_bLiveUpdate )
             {
                 traceVPWLog(m_Ctrl);
             }
 
             if(m_pPlPolar->bVortonWake())
+            {
                 traceLog(QString::asprintf("      VPW iteration %3d/%3d      CL=%9.5f\n", ivw+1, nWakeIter, CL));
+                if(m_pLiveChannel) m_pLiveChannel->publishResidual(m_Ctrl, ivw, CL);
+            }
+
+            if(m_pPlPolar->bVortonWake() && m_Checkpoint.isWakeStateDue())
+            {
+                // the state is only resumable with the factors of this control value's matrix
+                if(bPlainLU && !bLUStored)
+                {
+                    m_pPA->storeFactorization(m_Checkpoint);
+                    bLUStored = true;
+                }
+                TaskCheckpoint::WakeState state;
+                state.m_iOpp           = m_qRHS;
+                state.m_iWake          = ivw+1;
+                state.m_bConvergedLast = bConvergedLast;
+                state.m_QInf           = m_QInf;
+                state.m_QInfStab       = QInfStab;
+                state.m_LastForce      = LastForce;
+                state.m_nSteady        = nSteady;
+                state.m_gamma          = m_gamma;
+                state.m_Vortons        = m_pPA->m_Vorton;
+                state.m_VortexNeg      = m_pPA->m_VortexNeg;
+                m_Checkpoint.storeWakeState(state);
+            }
 
             if(isCancelled()) return true;
         } // end VPW loop
@@ -992,10 +1370,18 @@ bool PlaneTask::T6Loop()
         strange = QString::asprintf("      Calculating plane for control parameter=%.3f\n", m_Ctrl);
         traceLog(strange);
 
-        PlaneOpp *pPOpp = computePlane(m_Ctrl, m_Alpha, BetaStab, m_Phi, QInfStab, mass, CoG, true);
-        traceStdLog(EOLstr);
+        if(bPipelined)
+        {
+            // build the operating point while the next control value is solved
+            launchPostTask(m_Ctrl, m_Alpha, BetaStab, m_Phi, QInfStab, mass, CoG, true);
+        }
+        else
+        {
+            PlaneOpp *pPOpp = computePlane(m_Ctrl, m_Alpha, BetaStab, m_Phi, QInfStab, mass, CoG, true);
+            traceStdLog(EOLstr);
 
-        storePOpp(pPOpp);
+            storePOpp(pPOpp, m_qRHS);
+        }
 
         if (isCancelled()) return true;
     }
@@ -1084,6 +1470,9 @@ bool PlaneTask::updateVirtualTwist(double QInf, double &error, std::string &logm
 {
     if(!m_pPlane->isXflType()) return false;
 
+    TaskProfile::Scope phase(&m_Profile, "viscous loop");
+    m_Profile.count(TaskProfile::VISCOUSLOOPS);
+
     PlaneXfl *pPlaneXfl = dynamic_cast<PlaneXfl*>(m_pPlane);
 
     QString logg;
@@ -1107,6 +1496,8 @@ bool PlaneTask::updateVirtualTwist(double QInf, double &error, std::string &logm
     }
 
     error = 0.0;
+    m_iViscMax = -1;
+    std::vector<double> residual(m_gamma.size(), 0.0);
 
     int iStation = 0;
     for(int iw=0; iw<pPlaneXfl->nWings(); iw++)
@@ -1167,20 +1558,55 @@ bool PlaneTask::updateVirtualTwist(double QInf, double &error, std::string &logm
                 }
                 double delta = (Cl_visc-Cl_vlm)/2.0/PI *180.0/PI;
 
+                if(fabs(delta)>error) m_iViscMax = iStation;
                 error = std::max(error, fabs(delta));
 
-                m_gamma[iStation] += delta * s_ViscRelax;
+                residual[iStation] = delta;
                 m++; // wing station counter
                 iStation++; // plane station counter
             }
         }
     }
 
+    // Aitken's dynamic relaxation of the fixed point iteration on the virtual twist:
+    // the relaxation factor is updated from the last two residual vectors,
+    // so that it is increased when the convergence is smooth and reduced when the iterations oscillate
+    double omega = s_ViscRelax;
+    if(s_bViscAitken && m_ViscResidual.size()==residual.size())
+    {
+        double num(0), den(0);
+        for(uint i=0; i<residual.size(); i++)
+        {
+            double dr = residual.at(i)-m_ViscResidual.at(i);
+            num += m_ViscResidual.at(i)*dr;
+            den += dr*dr;
+        }
+        if(den>0.0) omega = -m_ViscOmega*num/den;
+        else        omega = m_ViscOmega;
+        omega = std::max(0.05, std::min(omega, 1.0));
+    }
+    m_ViscOmega = omega;
+    m_ViscResidual = residual;
+
+    double sum2 = 0.0;
+    for(double r : residual) sum2 += r*r;
+    m_ViscRms = residual.empty() ? 0.0 : sqrt(sum2/double(residual.size()));
+
+    for(uint i=0; i<residual.size(); i++) m_gamma[i] += omega*residual.at(i);
+
     logmsg = logg.toStdString();
     return true;
 }
 
 
+/** Restarts the relaxation of the viscous loop from the user-defined factor */
+void PlaneTask::resetViscousRelaxation()
+{
+    m_ViscResidual.clear();
+    m_ViscOmega = s_ViscRelax;
+}
+
+
 void PlaneTask::outputStateMatrices(PlaneOpp const *pPOpp)
 {
     QString strange, log;
@@ -1245,6 +1671,8 @@ PlaneOpp* PlaneTask::computePlane(double ctrl, double alpha, double beta, double
         return nullptr; // <=0.0
     }
 
+    TaskProfile::Scope phase(&m_Profile, "operating point results");
+
     PlaneXfl *pPlaneXfl = dynamic_cast<PlaneXfl *>(m_pPlane);
 
     m_QInf = QInf;
@@ -1371,6 +1799,7 @@ PlaneOpp* PlaneTask::computePlane(double ctrl, double alpha, double beta, double
 
         if(m_pPlPolar->isViscous())
         {
+            TaskProfile::Scope viscphase(&m_Profile, "viscous drag");
             for(int iw=0; iw<nWings; iw++)
             {
                 WingXfl *pWing = pPlaneXfl->wing(iw);
@@ -1733,6 +2162,8 @@ double PlaneTask::computeGlideSpeed(double Alpha, double mass, std::string &log)
 
 void PlaneTask::computeInducedForces(double alpha, double beta, double QInf)
 {
+    TaskProfile::Scope phase(&m_Profile, "far field forces");
+
     if(m_pPlane->isXflType())
     {
         int nWings = m_pPlane->nWings();
@@ -1766,6 +2197,8 @@ void PlaneTask::computeInducedForces(double alpha, double beta, double QInf)
 
 void PlaneTask::computeInducedDrag(double alpha, double beta, double QInf)
 {
+    TaskProfile::Scope phase(&m_Profile, "Trefftz drag");
+
     Vector3d FFForceBodyAxes;
 
     PanelAnalysis::clearDebugPts();
@@ -1811,6 +2244,49 @@ void PlaneTask::computeInducedDrag(double alpha, double beta, double QInf)
 }
 
 
+/**
+ * Evaluates the Trefftz plane velocities of the three unit solutions for each wing.
+ * With a fixed wake the evaluation points do not depend on the operating point, and the
+ * wake induced velocities are linear in the doublet densities, so that the velocities of any
+ * operating point are the combination of these three, using the same coefficients as the doublet densities.
+ * Overwrites the doublet densities, the span distributions and the wing forces.
+ */
+void PlaneTask::makeUnitTrefftzVelocities(std::vector<std::vector<Vector3d>> unitVd[3])
+{
+    for(int iu=0; iu<3; iu++)
+    {
+        m_pPA->combineUnitDoubletStrengths(iu==0 ? 1.0 : 0.0, iu==1 ? 1.0 : 0.0, iu==2 ? 1.0 : 0.0);
+        computeInducedDrag(0.0, 0.0, 1.0);
+
+        unitVd[iu].resize(m_SpanDistFF.size());
+        for(uint iw=0; iw<m_SpanDistFF.size(); iw++)
+            unitVd[iu][iw] = m_SpanDistFF.at(iw).m_Vd;
+    }
+}
+
+
+/** Loads the Trefftz plane velocities of the operating point in the span distributions; cf. makeUnitTrefftzVelocities() */
+void PlaneTask::combineUnitTrefftzVelocities(double alpha, double beta, std::vector<std::vector<Vector3d>> const unitVd[3])
+{
+    double cosa = cos(alpha*PI/180.0);
+    double sina = sin(alpha*PI/180.0);
+    double cosb = cos(-beta *PI/180.0); // same sign convention as makeUnitDoubletStrengths()
+    double sinb = sin(-beta *PI/180.0);
+
+    double cu = cosa*cosb;
+    double cv = sinb;
+    double cw = sina*cosb;
+
+    for(uint iw=0; iw<m_SpanDistFF.size(); iw++)
+    {
+        std::vector<Vector3d> &Vd = m_SpanDistFF[iw].m_Vd;
+        Vd.resize(unitVd[0].at(iw).size());
+        for(uint m=0; m<Vd.size(); m++)
+            Vd[m] = unitVd[0][iw].at(m)*cu + unitVd[1][iw].at(m)*cv + unitVd[2][iw].at(m)*cw;
+    }
+}
+
+
 PlaneOpp *PlaneTask::createPlaneOpp(double ctrl, double alpha, double beta, double phi, double QInf, double mass, Vector3d const &CoG,
                                     double const *Cp, double const *Gamma, double const *Sigma, bool bCpOnly) const
 {
@@ -1949,7 +2425,7 @@ PlaneOpp *PlaneTask::createPlaneOpp(double ctrl, double alpha, double beta, doub
 
     if(m_pPlPolar->bVortonWake())
     {
-        pPOpp->m_Vorton = m_pPA->m_Vorton;
+        pPOpp->setVortons(m_pPA->m_Vorton);
         pPOpp->m_VortexNeg = m_pPA->m_VortexNeg;
     }
     return pPOpp;
@@ -1979,29 +2455,39 @@ bool PlaneTask::T7Loop()
     m_pPA->makeLocalVelocities(m_pPA->m_uRHS, m_pPA->m_vRHS, m_pPA->m_wRHS, m_pPA->m_uVLocal, m_pPA->m_vVLocal, m_pPA->m_wVLocal, objects::windDirection(0,0));
     traceStdLog("   done\n");
 
-    Vector3d CoG = m_pPlPolar->CoGCtrl(m_Ctrl);
-    double mass = m_pPlPolar->massCtrl(m_Ctrl);
-
     outstring.clear();
 
     traceLog(outstring);
     if(isCancelled()) return true;
 
-    // next find the balanced and trimmed conditions
-    double AlphaEq(0), u0(0);
-
-    traceStdLog("      Calculating trimmed conditions\n");
+    // the trimmed conditions of each loading polar are found from the same unit solutions,
+    // from which the doublet densities and the far field forces are rebuilt
+    std::vector<PlanePolar*> polars = makeLoadingPolarList();
+    PolarRestore restore(m_pPlPolar);
 
-    if(!m_pPA->computeTrimmedConditions(mass, CoG, AlphaEq, u0, m_pPlPolar->bFuseMi()))
-    {
-        if(isCancelled()) return true;
-        //no zero moment alpha
-        str = QString::asprintf("      Unsuccessful attempt to trim the model for control position = %.2f - skipping.\n\n\n", m_Ctrl);
-        traceLog(str);
-        m_bError = true;
-    }
-    else
+    for(uint ip=0; ip<polars.size(); ip++)
     {
+        m_pPlPolar = polars.at(ip);
+        if(ip>0) traceLog("   Loading polar " + QString::fromStdString(m_pPlPolar->name()) + EOLch);
+
+        Vector3d CoG = m_pPlPolar->CoGCtrl(m_Ctrl);
+        double mass = m_pPlPolar->massCtrl(m_Ctrl);
+
+        // next find the balanced and trimmed conditions
+        double AlphaEq(0), u0(0);
+
+        traceStdLog("      Calculating trimmed conditions\n");
+
+        if(!m_pPA->computeTrimmedConditions(mass, CoG, AlphaEq, u0, m_pPlPolar->bFuseMi()))
+        {
+            if(isCancelled()) return true;
+            //no zero moment alpha
+            str = QString::asprintf("      Unsuccessful attempt to trim the model for control position = %.2f - skipping.\n\n\n", m_Ctrl);
+            traceLog(str);
+            m_bError = true;
+            continue;
+        }
+
         m_QInf = u0;
 
         traceStdLog("      Calculating far field forces...\n");
@@ -2023,7 +2509,7 @@ bool PlaneTask::T7Loop()
         if (isCancelled()) return true;
 
         if(computeStability(pPOpp, true))
-        {          
+        {
             storePOpp(pPOpp);
         }
         traceStdLog("       Done operating point\n\n");
@@ -2035,6 +2521,8 @@ bool PlaneTask::T7Loop()
 
 bool PlaneTask::computeStability(PlaneOpp *pPOpp, bool bOutput)
 {
+    TaskProfile::Scope phase(&m_Profile, "stability derivatives");
+
     std::string str;
     // Compute stability and control derivatives in stability axes
     traceStdLog("             Calculating stability derivatives\n");
@@ -2099,6 +2587,36 @@ bool PlaneTask::T123458Loop()
 {
     QString strange, str, outstring;
 
+    m_uVUnit.clear();
+    m_vVUnit.clear();
+    m_wVUnit.clear();
+    for(int i=0; i<3; i++) m_UnitVd[i].clear();
+    bool bKeepUnit = m_bKeepUnitSolutions && canSuperpose(m_pPlPolar);
+
+    // the operating points computed by a previous task with the same mesh and settings are copied from the cache
+    m_OppKeys.assign(m_T8Opps.size(), 0);
+    std::vector<bool> bCached(m_T8Opps.size(), false);
+    int nCached=0, nActive=0;
+    for(uint io=0; io<m_T8Opps.size(); io++)
+    {
+        if(!m_T8Opps.at(io).isActive() || m_Checkpoint.isDone(int(io))) continue;
+        nActive++;
+        m_OppKeys[io] = oppKey(m_T8Opps.at(io));
+        PlaneOpp *pPOpp = PlaneOppCache::fetch(m_OppKeys.at(io));
+        if(!pPOpp) continue;
+
+        pPOpp->setPlaneName(m_pPlane->name());
+        pPOpp->setPolarName(m_pPlPolar->name());
+        pPOpp->setTheStyle(m_pPlPolar->theStyle());
+        m_OppKeys[io] = 0; // already in the cache
+        storePOpp(pPOpp, int(io));
+        bCached[io] = true;
+        nCached++;
+    }
+    if(nCached>0)
+        traceLog(QString::asprintf("   %d operating point(s) copied from the cache\n", nCached));
+    if(nActive>0 && nCached==nActive && !bKeepUnit) return true;
+
     traceStdLog("\nSolving the problem... \n\n");
 
     m_pPA->m_nStations = m_pPlane->nStations();// for assertion checks only?
@@ -2115,8 +2633,25 @@ bool PlaneTask::T123458Loop()
 
     traceStdLog("     done\n");
 
-    Vector3d CoG = m_pPlPolar->CoGCtrl(m_Ctrl);
-    double mass = m_pPlPolar->massCtrl(m_Ctrl);
+    if(bKeepUnit)
+    {
+        m_uVUnit = uVLocal;
+        m_vVUnit = vVLocal;
+        m_wVUnit = wVLocal;
+    }
+
+    // the loading polars are processed in turn from the solution of each operating point at unit speed
+    std::vector<PlanePolar*> polars = makeLoadingPolarList();
+    PolarRestore restore(m_pPlPolar);
+    std::vector<double> masses;
+    std::vector<Vector3d> CoGs;
+    for(PlanePolar const *pPolar : polars)
+    {
+        masses.push_back(pPolar->massCtrl(m_Ctrl));
+        CoGs.push_back(pPolar->CoGCtrl(m_Ctrl));
+    }
+    // the post-processing task is made for the single polar
+    bool bPipelined = s_bPipelined && !m_bDerivatives && polars.size()==1;
 
     if(isCancelled()) return true;
 
@@ -2125,6 +2660,23 @@ bool PlaneTask::T123458Loop()
     if(m_nRHS>1) strange +="s";
     traceLog(EOLch+strange+EOLch);
 
+    // the wake is fixed, so the Trefftz plane velocities are evaluated once for the whole sweep
+    std::vector<std::vector<Vector3d>> unitVd[3];
+    bool bSuperpose = s_bSuperposeDownwash && !m_pPlPolar->bVortonWake() && (m_nRHS>1 || bKeepUnit);
+    if(bSuperpose)
+    {
+        traceStdLog("   Calculating the unit Trefftz plane velocities...\n");
+        makeUnitTrefftzVelocities(unitVd);
+        if(isCancelled()) return true;
+        if(bKeepUnit)
+        {
+            for(int i=0; i<3; i++) m_UnitVd[i] = unitVd[i];
+        }
+    }
+
+    // the scratch velocity arrays are sized by the first operating point and reused by the next ones
+    std::vector<Vector3d> VLocal, VInf;
+
     for(uint io=0; io<m_T8Opps.size(); io++)
     {
         if(s_bCancel)
@@ -2136,6 +2688,10 @@ bool PlaneTask::T123458Loop()
         T8Opp const &t8opp = m_T8Opps.at(io);
 
         if(!t8opp.isActive()) continue;
+        if(m_Checkpoint.isDone(int(io))) continue; // restored from the checkpoint
+        if(bCached.at(io)) continue;
+
+        TaskProfile::Scope opphase(&m_Profile, "operating point");
         m_qRHS = io;
         m_Alpha = t8opp.alpha();
         m_Beta  = t8opp.beta();
@@ -2164,97 +2720,376 @@ bool PlaneTask::T123458Loop()
         traceStdLog("       Calculating far field forces...\n");
 
         computeInducedForces(m_Alpha, m_Beta, 1.0);
-        computeInducedDrag(  m_Alpha, m_Beta, 1.0);
-
-        if(m_pPlPolar->isType1() || m_pPlPolar->isType5())
-        {
-            m_QInf = m_pPlPolar->velocity();
-        }
-        else if(m_pPlPolar->isType2() || m_pPlPolar->isType3())
-        {
-            std::string str;
-            traceStdLog("       Calculating balance speeds...\n");
-            if (m_pPlPolar->isFixedLiftPolar())
-                m_QInf = computeBalanceSpeeds(m_Alpha, m_pPlPolar->mass(), m_bError, "", str);
-            else if(m_pPlPolar->isGlidePolar())
-                m_QInf = computeGlideSpeed(m_Alpha, m_pPlPolar->mass(), str);
-            strange = "             " + QString::fromStdString(str) + EOLch;
-            traceLog(strange);
-        }
-        else if(m_pPlPolar->isType4())
-        {
-            m_QInf = t8opp.m_Vinf;
-        }
-        else if(m_pPlPolar->isType8())
+        if(bSuperpose)
         {
-            m_QInf = t8opp.m_Vinf;
+            combineUnitTrefftzVelocities(m_Alpha, m_Beta, unitVd);
+            m_pPA->setPrecomputedDownwash(true);
         }
-        else
+        computeInducedDrag(  m_Alpha, m_Beta, 1.0);
+        m_pPA->setPrecomputedDownwash(false);
+
+        for(uint ip=0; ip<polars.size(); ip++)
         {
-            assert(false);
-        }
+            m_pPlPolar = polars.at(ip);
+            if(ip>0) traceLog("     Loading polar " + QString::fromStdString(m_pPlPolar->name()) + EOLch);
 
-        if(m_QInf<0) continue;
+            if(m_pPlPolar->isType1() || m_pPlPolar->isType5())
+            {
+                m_QInf = m_pPlPolar->velocity();
+            }
+            else if(m_pPlPolar->isType2() || m_pPlPolar->isType3())
+            {
+                std::string str;
+                traceStdLog("       Calculating balance speeds...\n");
+                if (m_pPlPolar->isFixedLiftPolar())
+                    m_QInf = computeBalanceSpeeds(m_Alpha, m_pPlPolar->mass(), m_bError, "", str);
+                else if(m_pPlPolar->isGlidePolar())
+                    m_QInf = computeGlideSpeed(m_Alpha, m_pPlPolar->mass(), str);
+                strange = "             " + QString::fromStdString(str) + EOLch;
+                traceLog(strange);
+            }
+            else if(m_pPlPolar->isType4())
+            {
+                m_QInf = t8opp.m_Vinf;
+            }
+            else if(m_pPlPolar->isType8())
+            {
+                m_QInf = t8opp.m_Vinf;
+            }
+            else
+            {
+                assert(false);
+            }
 
-        scaleResultsToSpeed(1.0, m_QInf);
+            if(m_QInf<0) continue;
 
-        if (isCancelled()) return true;
+            scaleResultsToSpeed(1.0, m_QInf);
 
-        traceStdLog("       Calculating on-body pressure coefficients...\n");
-        std::vector<Vector3d> VLocal;
-        std::vector<Vector3d> VInf(m_pPA->nPanels());
-        std::fill(VInf.begin(), VInf.end(), objects::windDirection(m_Alpha, m_Beta));
+            if (isCancelled()) return true;
 
-        // Save a little time by restoring the unit velocty fields instead of recalculating them
-        m_pPA->m_uVLocal = uVLocal;
-        m_pPA->m_vVLocal = vVLocal;
-        m_pPA->m_wVLocal = wVLocal;
+            traceStdLog("       Calculating on-body pressure coefficients...\n");
+            VInf.assign(m_pPA->nPanels(), objects::windDirection(m_Alpha, m_Beta));
 
-        m_pPA->combineLocalVelocities(m_Alpha, m_Beta, VLocal);
-        m_pPA->computeOnBodyCp(VInf, VLocal, m_pPA->m_Cp);
-        if (isCancelled()) return true;
+            // Save a little time by restoring the unit velocty fields instead of recalculating them
+            m_pPA->m_uVLocal = uVLocal;
+            m_pPA->m_vVLocal = vVLocal;
+            m_pPA->m_wVLocal = wVLocal;
 
-        str = "       Calculating plane\n";
-        traceLog(str);
-        PlaneOpp *pPOpp = computePlane(m_Ctrl, m_Alpha, m_Beta, m_pPlPolar->phi(), m_QInf, mass, CoG, false);
-        if(!pPOpp)
-        {
-            traceStdLog("\n          Error generating the operating point... discarding\n\n");
-            continue;
-        }
+            {
+                TaskProfile::Scope phase(&m_Profile, "on-body Cp");
+                m_pPA->combineLocalVelocities(m_Alpha, m_Beta, VLocal);
+                m_pPA->computeOnBodyCp(VInf, VLocal, m_pPA->m_Cp);
+            }
+            if (isCancelled()) return true;
 
-        if (isCancelled()) return true;
+            str = "       Calculating plane\n";
+            traceLog(str);
 
-        if(m_bDerivatives)
-        {
-            traceStdLog("          Calculating derivatives and eigenthings\n");
-            computeStability(pPOpp, true);
-        }
-        else
-        {
-            traceStdLog("          Skipping derivatives and eigenthings\n");
-        }
+            if(bPipelined)
+            {
+                // the derivatives require the analysis' matrix, otherwise the operating point
+                // can be built while the next point is solved
+                launchPostTask(m_Ctrl, m_Alpha, m_Beta, m_pPlPolar->phi(), m_QInf, masses.at(ip), CoGs.at(ip), false);
+                continue;
+            }
 
-        storePOpp(pPOpp);
+            PlaneOpp *pPOpp = computePlane(m_Ctrl, m_Alpha, m_Beta, m_pPlPolar->phi(), m_QInf, masses.at(ip), CoGs.at(ip), false);
 
-        traceStdLog("          Done operating point\n\n");
+            if(pPOpp)
+            {
+                if (isCancelled()) return true;
+
+                if(m_bDerivatives)
+                {
+                    traceStdLog("          Calculating derivatives and eigenthings\n");
+                    computeStability(pPOpp, true);
+                }
+                else
+                {
+                    traceStdLog("          Skipping derivatives and eigenthings\n");
+                }
+
+                storePOpp(pPOpp, ip==0 ? int(io) : -1);
+
+                traceStdLog("          Done operating point\n\n");
+            }
+            else
+                traceStdLog("\n          Error generating the operating point... discarding\n\n");
+
+            // back to the solution at unit speed for the next loading polar
+            if(ip+1<polars.size()) scaleResultsToSpeed(m_QInf, 1.0);
+        }
+        m_pPlPolar = polars.front();
     }
 
     return true;
 }
 
 
-void PlaneTask::storePOpp(PlaneOpp *pPOpp)
+/**
+ * @return true if the operating points of the polar can be made by superposition of the unit solutions,
+ * i.e. if the polar is of type 1 to 5 or 8 with a fixed wake.
+ */
+bool PlaneTask::canSuperpose(PlanePolar const *pPolar)
+{
+    return pPolar && pPolar->isType123458() && !pPolar->bVortonWake();
+}
+
+
+/**
+ * Makes the operating point at the given angles and speed from the unit solutions kept by the last run,
+ * as in the T123458 loop but without solving the flow. The speed is ignored by the fixed lift and glide polars,
+ * which calculate the balance speed. The on the fly viscous polars still run XFoil for each operating point.
+ * @return the new operating point, owned by the caller and neither stored in the polar nor in the cache,
+ * or nullptr if the unit solutions have not been kept or if there is no solution at this aoa.
+ */
+PlaneOpp *PlaneTask::superposeOpp(double alpha, double beta, double QInf)
+{
+    if(!m_pPA || !hasUnitSolutions()) return nullptr;
+
+    m_Ctrl  = 0.0;
+    m_Alpha = alpha;
+    m_Beta  = beta;
+    m_Phi   = m_pPlPolar->phi();
+
+    m_pPA->makeSourceStrengths(objects::windDirection(alpha, beta));
+    m_pPA->makeUnitDoubletStrengths(alpha, beta);
+
+    computeInducedForces(alpha, beta, 1.0);
+    if(m_UnitVd[0].size())
+    {
+        combineUnitTrefftzVelocities(alpha, beta, m_UnitVd);
+        m_pPA->setPrecomputedDownwash(true);
+    }
+    computeInducedDrag(alpha, beta, 1.0);
+    m_pPA->setPrecomputedDownwash(false);
+
+    double mass = m_pPlPolar->massCtrl(m_Ctrl);
+    Vector3d CoG = m_pPlPolar->CoGCtrl(m_Ctrl);
+    std::string str;
+    bool bWarning = false;
+    if     (m_pPlPolar->isFixedLiftPolar()) QInf = computeBalanceSpeeds(alpha, mass, bWarning, "", str);
+    else if(m_pPlPolar->isGlidePolar())     QInf = computeGlideSpeed(alpha, mass, str);
+    if(QInf<PRECISION) return nullptr;
+
+    scaleResultsToSpeed(1.0, QInf);
+
+    m_pPA->m_uVLocal = m_uVUnit;
+    m_pPA->m_vVLocal = m_vVUnit;
+    m_pPA->m_wVLocal = m_wVUnit;
+
+    std::vector<Vector3d> VLocal;
+    std::vector<Vector3d> VInf(m_pPA->nPanels(), objects::windDirection(alpha, beta));
+    m_pPA->combineLocalVelocities(alpha, beta, VLocal);
+    m_pPA->computeOnBodyCp(VInf, VLocal, m_pPA->m_Cp);
+
+    return computePlane(m_Ctrl, alpha, beta, m_Phi, QInf, mass, CoG, false);
+}
+
+
+/**
+ * Makes the task which builds the operating point from a copy of the current solution,
+ * so that the panels and the solution arrays can be modified by the next operating point.
+ * The copy holds the panels and the densities, not the influence matrix.
+ */
+PlaneTask *PlaneTask::makePostTask()
+{
+    PlaneTask *pPost = new PlaneTask;
+    pPost->m_pMasterTask = this;
+    pPost->m_pPlane      = m_pPlane;
+    pPost->m_pPlPolar    = m_pPlPolar;
+    pPost->m_pPolar3d    = m_pPolar3d;
+
+    pPost->m_qRHS  = m_qRHS;
+    pPost->m_Ctrl  = m_Ctrl;
+    pPost->m_Alpha = m_Alpha;
+    pPost->m_Beta  = m_Beta;
+    pPost->m_Phi   = m_Phi;
+    pPost->m_QInf  = m_QInf;
+
+    pPost->m_SpanDistFF = m_SpanDistFF;
+    pPost->m_WingForce  = m_WingForce;
+    pPost->m_PartAF     = m_PartAF;
+    pPost->m_gamma      = m_gamma;
+
+    if(m_pP4A)
+    {
+        int N = m_pP4A->nPanels();
+        pPost->m_pP4A = new P4Analysis;
+        pPost->m_pP4A->m_Panel4 = m_pP4A->m_Panel4;
+        pPost->m_pP4A->m_Mu.assign(   m_pP4A->m_Mu.begin(),    m_pP4A->m_Mu.begin()+N);
+        pPost->m_pP4A->m_Sigma.assign(m_pP4A->m_Sigma.begin(), m_pP4A->m_Sigma.begin()+N);
+        pPost->m_pP4A->m_Cp.assign(   m_pP4A->m_Cp.begin(),    m_pP4A->m_Cp.begin()+N);
+        pPost->m_pPA = pPost->m_pP4A;
+    }
+    else if(m_pP3A)
+    {
+        int N = m_pP3A->nPanels();
+        if(m_pPlPolar->isTriUniformMethod()) pPost->m_pP3A = new P3UniAnalysis;
+        else                                 pPost->m_pP3A = new P3LinAnalysis;
+        pPost->m_pP3A->m_Panel3 = m_pP3A->m_Panel3;
+        pPost->m_pP3A->m_Mu.assign(   m_pP3A->m_Mu.begin(),    m_pP3A->m_Mu.begin()+3*N);
+        pPost->m_pP3A->m_Sigma.assign(m_pP3A->m_Sigma.begin(), m_pP3A->m_Sigma.begin()+N);
+        pPost->m_pP3A->m_Cp.assign(   m_pP3A->m_Cp.begin(),    m_pP3A->m_Cp.begin()+3*N);
+        pPost->m_pPA = pPost->m_pP3A;
+    }
+
+    if(m_pPolar3d->bVortonWake())
+    {
+        pPost->m_pPA->m_Vorton    = m_pPA->m_Vorton;
+        pPost->m_pPA->m_VortexNeg = m_pPA->m_VortexNeg;
+    }
+
+    return pPost;
+}
+
+
+/**
+ * Waits for the operating point in flight, if any, then launches the construction of the
+ * operating point for the current solution in a background thread.
+ * At most one operating point is in flight.
+ */
+void PlaneTask::launchPostTask(double ctrl, double alpha, double beta, double phi, double QInf, double mass, Vector3d const &CoG, bool bInGeomAxes)
+{
+    finishPostTask();
+
+    m_pPostTask = makePostTask();
+#ifdef NEURALFOIL_ENABLED
+    m_pPostTask->m_NFPolarCaches.swap(m_NFPolarCaches); // lent to the post-processing task, returned by finishPostTask()
+#endif
+
+    PlaneTask *pPost = m_pPostTask;
+    m_PostThread = std::thread([this, pPost, ctrl, alpha, beta, phi, QInf, mass, CoG, bInGeomAxes]()
+    {
+        ScopedStore scope(m_pStore);
+        m_pPostPOpp = pPost->computePlane(ctrl, alpha, beta, phi, QInf, mass, CoG, bInGeomAxes);
+    });
+}
+
+
+/**
+ * Starts the computation of the foil polars which are missing to interpolate the viscous drag,
+ * if the option is enabled; the polars are computed in the background while the analysis is initialized.
+ */
+void PlaneTask::startPolarMesh(PlaneXfl const *pPlaneXfl)
+{
+    if(m_pPolarMesh) delete m_pPolarMesh;
+    m_pPolarMesh = nullptr;
+
+    if(!PolarMeshGenerator::isEnabled() || m_pMasterTask || !pPlaneXfl) return;
+    if(!m_pPlPolar->isViscous() || !m_pPlPolar->isViscInterpolated()) return;
+
+    std::vector<double> const &ctrllist = m_pPlPolar->isType7() ? m_T7CtrlList : m_T6CtrlList;
+
+    m_pPolarMesh = new PolarMeshGenerator;
+    std::string log;
+    if(!m_pPolarMesh->inferSpeedRange(m_pPlPolar, m_AngleList, ctrllist, m_T8Opps) ||
+       m_pPolarMesh->makeJobs(pPlaneXfl, m_pPlPolar, log)==0)
+    {
+        delete m_pPolarMesh;
+        m_pPolarMesh = nullptr;
+        return;
+    }
+
+    traceStdLog("Computing the missing foil polars in the background:\n");
+    traceStdLog(log + EOLstr);
+    m_pPolarMesh->start();
+}
+
+
+/** Waits for the missing foil polars and inserts them in the store before the operating points are calculated */
+void PlaneTask::finishPolarMesh()
+{
+    if(!m_pPolarMesh) return;
+
+    std::string log;
+    int nPolars = m_pPolarMesh->finish(log);
+    delete m_pPolarMesh;
+    m_pPolarMesh = nullptr;
+
+    if(log.length()) traceStdLog(log);
+    traceStdLog(QString::asprintf("Inserted %d foil polars for the viscous interpolation\n\n", nPolars).toStdString());
+}
+
+
+/** Waits for the operating point in flight, if any, and stores it */
+void PlaneTask::finishPostTask()
+{
+    if(!m_pPostTask) return;
+
+    if(m_PostThread.joinable()) m_PostThread.join();
+
+    if(m_pPostTask->m_bError) m_bError = true;
+    m_Profile.merge(m_pPostTask->m_Profile);
+    int iOpp = m_pPostTask->m_qRHS;
+#ifdef NEURALFOIL_ENABLED
+    m_NFPolarCaches.swap(m_pPostTask->m_NFPolarCaches);
+#endif
+    delete m_pPostTask;
+    m_pPostTask = nullptr;
+
+    PlaneOpp *pPOpp = m_pPostPOpp;
+    m_pPostPOpp = nullptr;
+    if(pPOpp)
+    {
+        // the post-processing task does not know the previous operating points
+        if(m_PlaneOppList.size()) pPOpp->setLineColor(m_PlaneOppList.back()->lineColor().darker(100));
+        if(m_pPlPolar->isType6()) traceStdLog(EOLstr);
+    }
+    else
+    {
+        if(m_pPlPolar->isType123458()) traceStdLog("\n          Error generating the operating point... discarding\n\n");
+    }
+    storePOpp(pPOpp, iOpp);
+}
+
+
+/**
+ * @return the task's polar followed by the loading polars which differ from it only in mass, CoG or inertia.
+ * The T6 polars are excluded, since each control position has its own geometry and flow solution.
+ */
+std::vector<PlanePolar*> PlaneTask::makeLoadingPolarList()
+{
+    std::vector<PlanePolar*> polars(1, m_pPlPolar);
+    for(PlanePolar *pPolar : m_LoadingPolars)
+    {
+        if(!pPolar || pPolar==m_pPlPolar) continue;
+        if(m_pPlPolar->isType6() || !m_pPlPolar->differsOnlyInInertia(pPolar))
+        {
+            traceStdLog("   The polar " + pPolar->name() + " does not differ from " + m_pPlPolar->name() + " only in mass and inertia - skipping\n");
+            continue;
+        }
+        polars.push_back(pPolar);
+    }
+    if(polars.size()>1)
+        traceLog(QString::asprintf("   Building the operating points of %d loading polars from the same flow solutions\n", int(polars.size())-1));
+    return polars;
+}
+
+
+/**
+ * Adds the operating point to the polar and to the results.
+ * @param iOpp the index of the operating point in the task's list, used to record it in the checkpoint; -1 if unknown.
+ */
+void PlaneTask::storePOpp(PlaneOpp *pPOpp, int iOpp)
 {
     if(!pPOpp) return;
 
+    if(m_Checkpoint.isOpen() && iOpp>=0 && !m_Checkpoint.isDone(iOpp)) m_Checkpoint.appendOpp(iOpp, pPOpp);
+    if(iOpp>=0 && iOpp<int(m_OppKeys.size()) && !pPOpp->isOut()) PlaneOppCache::store(m_OppKeys.at(iOpp), pPOpp);
+
     if(!pPOpp->isOut()) // discard failed visc interpolated opps
         m_pPlPolar->addPlaneOpPointData(pPOpp);
 
+    applyFieldRetention(m_pPlPolar, pPOpp, iOpp);
+
+    if(m_pResultSink) m_pResultSink->addPlaneOpp(pPOpp);
+
     if(m_bKeepOpps)
     {
         m_PlaneOppList.push_back(pPOpp);
         Objects3d::insertPlaneOpp(pPOpp);
+        if(m_pLiveChannel) m_pLiveChannel->publishPlaneOpp(pPOpp);
     }
     else            delete pPOpp;
 
@@ -2372,17 +3207,28 @@ void PlaneTask::computeControlDerivatives(double t7ctrl, double alphaeq, double
 
     double DeltaCtrl = 0.001;
 
+    // first pass: make the RHS of all the active controls and back-substitute them in a single block
+    std::vector<int> activectrls;
     for(int ie=0; ie<m_pPlPolar->nAVLCtrls(); ie++)
     {
-        traceStdLog("             Processing control set " + m_pPlPolar->AVLCtrl(ie).name() + EOLstr);
         SD.ControlNames[ie] = m_pPlPolar->AVLCtrl(ie).name();
         if(!m_pPlPolar->AVLCtrl(ie).hasActiveAngle())
         {
             SD.Xde[ie] = SD.Yde[ie] = SD.Zde[ie] = SD.Lde[ie] = SD.Mde[ie] = SD.Nde[ie] = 0.0;
-            traceStdLog("        No active gain... skipping\n\n");
+            traceStdLog("             Control set " + m_pPlPolar->AVLCtrl(ie).name() + ": no active gain... skipping\n\n");
             continue;
         }
+        activectrls.push_back(ie);
+    }
+    if(activectrls.empty()) return;
+
+    int matsize = m_pPA->matSize();
+    std::vector<double> cRHSBlock(activectrls.size()*size_t(matsize));
+    std::vector<Vector3d> VField(N, V0);
 
+    for(uint ic=0; ic<activectrls.size(); ic++)
+    {
+        int ie = activectrls.at(ic);
         std::string outstring;
         m_pPA->restorePanels();
         if(m_pPlane->isXflType())
@@ -2401,19 +3247,39 @@ void PlaneTask::computeControlDerivatives(double t7ctrl, double alphaeq, double
         m_pPA->makeWakePanels(objects::windDirection(0,0), false);
 
         //create the RHS
-//        traceStdLog("         Making the unit RHS vectors...\n");
-        std::vector<Vector3d> VField(N, V0);
-//        Vector3d Omega;
-//        m_pPA->makeUnitRHSVectors(); // could also use one RHS
-//        m_pPA->combineUnitRHS(m_pPA->m_cRHS, V0, Omega);
-
+        std::fill(VField.begin(), VField.end(), V0);
         m_pPA->makeRHS(VField, m_pPA->m_cRHS, nullptr);
+        memcpy(cRHSBlock.data()+ic*size_t(matsize), m_pPA->m_cRHS.data(), size_t(matsize)*sizeof(double));
+    }
+
+    //LU solve
+    m_pPA->backSubRHSBlock(cRHSBlock.data(), int(activectrls.size()));
+
+    // second pass: compute the forces in the deflected positions
+    for(uint ic=0; ic<activectrls.size(); ic++)
+    {
+        int ie = activectrls.at(ic);
+        traceStdLog("             Processing control set " + m_pPlPolar->AVLCtrl(ie).name() + EOLstr);
 
-/*        std::string strong = "         Calculating the control derivatives\n\n";
-        traceStdLog(strong);*/
+        std::string outstring;
+        m_pPA->restorePanels();
+        if(m_pPlane->isXflType())
+        {
+            PlaneXfl *pPlaneXfl = dynamic_cast<PlaneXfl*>(m_pPlane);
+            if(m_pP4A)
+            {
+                setControlPositions(pPlaneXfl, m_pPlPolar, m_pP4A->m_Panel4, DeltaCtrl, ie, outstring);
+            }
+            else if(m_pP3A)
+            {
+                setControlPositions(pPlaneXfl, m_pPlPolar, m_pP3A->m_Panel3,
+                                    m_pP3A->m_pRefTriMesh->nodes(), DeltaCtrl, ie, outstring);
+            }
+        }
+        m_pPA->makeWakePanels(objects::windDirection(0,0), false);
 
-        //LU solve
-        m_pPA->backSubRHS(m_pPA->m_cRHS);
+        memcpy(m_pPA->m_cRHS.data(), cRHSBlock.data()+ic*size_t(matsize), size_t(matsize)*sizeof(double));
+        std::fill(VField.begin(), VField.end(), V0);
 
         // make node vertex array
         // only needed for triuniform method to align with TriLinAnalysis
@@ -2425,7 +3291,7 @@ void PlaneTask::computeControlDerivatives(double t7ctrl, double alphaeq, double
         if(m_pPlPolar->isQuadMethod())
         {
             muc = m_pPA->m_cRHS.data();
-            m_pPA->forces(muc, sigma, alphaeq, 0.0, CoG, m_pPlPolar->bFuseMi(), VField, Force, Moment);
+            m_pPA->forces(muc, sigma, m_pPA->m_Cp.data(), alphaeq, 0.0, CoG, m_pPlPolar->bFuseMi(), VField, Force, Moment);
         }
         else if(m_pPlPolar->isTriangleMethod())
         {
@@ -2444,7 +3310,7 @@ void PlaneTask::computeControlDerivatives(double t7ctrl, double alphaeq, double
 
             std::fill(VField.begin(), VField.end(), VInf);
             m_pPA->computeOnBodyCp(VField, m_pPA->m_uVLocal, m_pPA->m_Cp);
-            m_pPA->forces(muc, sigma, alphaeq, 0.0, CoG, m_pPlPolar->bFuseMi(), VField, Force, Moment);
+            m_pPA->forces(muc, sigma, m_pPA->m_Cp.data(), alphaeq, 0.0, CoG, m_pPlPolar->bFuseMi(), VField, Force, Moment);
         }
 
         // make the forward difference with nominal results
@@ -2581,7 +3447,22 @@ void PlaneTask::setControlPositions(PlaneXfl const *pPlaneXfl, PlanePolar const
  */
 void PlaneTask::run()
 {
-    if(!initializeTask())
+    ScopedStore scope(m_pStore);
+
+    m_Profile.clear();
+
+    bool bInitialized = false;
+    {
+        TaskProfile::Scope phase(&m_Profile, "initialization");
+        bInitialized = initializeTask();
+    }
+    if(m_pPolarMesh)
+    {
+        TaskProfile::Scope phase(&m_Profile, "polar mesh");
+        if(!bInitialized) m_pPolarMesh->cancel();
+        finishPolarMesh();
+    }
+    if(!bInitialized)
     {
         m_bWarning = m_bError = true;
         m_AnalysisStatus = xfl::FINISHED;
@@ -2597,7 +3478,12 @@ void PlaneTask::run()
         return;
     }
 
-    loop();
+    KernelStats::Totals kernelstart = KernelStats::snapshot();
+    {
+        TaskProfile::Scope phase(&m_Profile, "analysis");
+        loop();
+    }
+    traceKernelStats(kernelstart);
 
     m_bWarning = m_bWarning || m_pPA->m_bWarning;
     m_bError = m_bError || m_pPA->m_bWarning;
@@ -2726,14 +3612,19 @@ bool PlaneTask::computeViscousDrag(WingXfl *pWing, double alpha, double beta, do
 }
 
 
-bool PlaneTask::computeSurfaceDragOTF(Surface const &surf, int iStartStation, double theta, SpanDistribs &spandist)
+/**
+ * Makes the flapped end foils of the surface and the polars holding the Cl and Re values
+ * of the surface's stations, to be processed by computeSectionDragOTF().
+ * @param sideFoil the left and right foils of the surface
+ * @param sidePolar the left and right polars
+ */
+void PlaneTask::makeSurfaceDragOTF(Surface const &surf, int iStartStation, double theta, SpanDistribs const &spandist, Foil *sideFoil, Polar *sidePolar) const
 {
-    Foil foilA, foilB;
+    Foil &foilA = sideFoil[0];
+    Foil &foilB = sideFoil[1];
     foilA.copy(surf.foilA(), true);
     foilB.copy(surf.foilB(), true);
 
-    if(isCancelled()) return false;
-
     const int m = iStartStation;
 
     if(surf.hasTEFlap() && fabs(theta)>FLAPANGLEPRECISION)
@@ -2749,8 +3640,8 @@ bool PlaneTask::computeSurfaceDragOTF(Surface const &surf, int iStartStation, do
         foilB.applyBase();
     }
 
-    // Process right side foil
-    Polar LeftSidePolar;
+    // Process left side foil
+    Polar &LeftSidePolar = sidePolar[0];
     LeftSidePolar.setType(xfl::T1POLAR);
     LeftSidePolar.setReType(1);
     LeftSidePolar.setMaType(1);
@@ -2773,11 +3664,8 @@ bool PlaneTask::computeSurfaceDragOTF(Surface const &surf, int iStartStation, do
     LeftSidePolar.setXTripTop(XTrTop);
     LeftSidePolar.setXTripBot(XTrBot);
 
-    XFoilTask *pLeftTask = new XFoilTask();
-    pLeftTask->initialize(foilA, &LeftSidePolar, false);
-
     // Process right side foil
-    Polar RightSidePolar;
+    Polar &RightSidePolar = sidePolar[1];
     RightSidePolar.setType(xfl::T1POLAR);
     RightSidePolar.setReType(1);
     RightSidePolar.setMaType(1);
@@ -2800,22 +3688,16 @@ bool PlaneTask::computeSurfaceDragOTF(Surface const &surf, int iStartStation, do
     }
     RightSidePolar.setXTripTop(XTrTop);
     RightSidePolar.setXTripBot(XTrBot);
+}
 
 
-    XFoilTask *pRightTask = new XFoilTask();
-    pRightTask->initialize(foilB, &RightSidePolar, false);
-
-//    computeSectionDragOTF(pLeftTask);
-//    computeSectionDragOTF(pRightTask);
-
-    std::thread leftthread  = std::thread(&PlaneTask::computeSectionDragOTF, this, pLeftTask);
-    std::thread rightthread = std::thread(&PlaneTask::computeSectionDragOTF, this, pRightTask);
-    leftthread.join();
-    rightthread.join();
-
-    delete pLeftTask;
-    delete pRightTask;
-
+/**
+ * Interpolates the drag and transition results of the surface's end foils at each station of the surface.
+ */
+bool PlaneTask::collectSurfaceDragOTF(Surface const &surf, int iStartStation, Polar const *sidePolar, SpanDistribs &spandist)
+{
+    Polar const &LeftSidePolar  = sidePolar[0];
+    Polar const &RightSidePolar = sidePolar[1];
 
     bool bCv = true;
     QString logg;
@@ -2926,8 +3808,21 @@ bool PlaneTask::computeViscousDragOTF(WingXfl *pWing, double alpha, double beta,
     int iCtrl = 0;
     int m=0;// wing station counter
 
-    std::vector<std::thread> threads;
+    struct SurfaceOTF
+    {
+        Foil m_Foil[2];     /**< the left and right foils */
+        Polar m_Polar[2];   /**< the stations' Cl and Re on input, the results on output */
+        int m_iStartStation{0};
+    };
+
+    struct SectionJob
+    {
+        int m_iSurf{0};
+        int m_iSide{0};
+        int m_k0{0}, m_k1{0};    /**< the range of the surface's stations processed by this job */
+    };
 
+    std::vector<SurfaceOTF> surfOTF(pWing->nSurfaces());
 
     for (int jsurf=0; jsurf<pWing->nSurfaces(); jsurf++)
     {
@@ -2935,12 +3830,77 @@ bool PlaneTask::computeViscousDragOTF(WingXfl *pWing, double alpha, double beta,
         if(surf.hasTEFlap()) theta = TEFlapAngles.value(iCtrl++);
         else                 theta = 0.0;
 
-        threads.push_back(std::thread(&PlaneTask::computeSurfaceDragOTF, this, surf, m, theta, std::ref(SpanResFF)));
-        //computeSurfaceDragOTF(surf, m, theta, std::ref(SpanResFF));
+        surfOTF[jsurf].m_iStartStation = m;
+        makeSurfaceDragOTF(surf, m, theta, SpanResFF, surfOTF[jsurf].m_Foil, surfOTF[jsurf].m_Polar);
         m += surf.NYPanels();
     }
 
-    for(int isurf=0; isurf<pWing->nSurfaces(); isurf++)        threads[isurf].join();
+    // flatten the surface x side x station matrix into jobs for the thread pool;
+    // the stations of each side are split into as many consecutive blocks as needed to occupy
+    // all the threads, since each block restarts the BL from scratch at its first station
+    int const MINSTATIONSPERJOB = 4;
+    int nThreads = m_nThreads>0 ? std::min(m_nThreads, ThreadPool::maxThreadCount()) : ThreadPool::maxThreadCount();
+    int nSides = 2*pWing->nSurfaces();
+    int nBlocksPerSide = std::max(1, (nThreads+nSides-1)/nSides);
+
+    std::vector<SectionJob> jobs;
+    for (int jsurf=0; jsurf<pWing->nSurfaces(); jsurf++)
+    {
+        int nStations = pWing->surface(jsurf).NYPanels();
+        int nBlocks = std::max(1, std::min(nBlocksPerSide, nStations/MINSTATIONSPERJOB));
+        for(int iSide=0; iSide<2; iSide++)
+        {
+            for(int ib=0; ib<nBlocks; ib++)
+            {
+                SectionJob job;
+                job.m_iSurf = jsurf;
+                job.m_iSide = iSide;
+                job.m_k0 = (ib*nStations)/nBlocks;
+                job.m_k1 = ((ib+1)*nStations)/nBlocks;
+                if(job.m_k1>job.m_k0) jobs.push_back(job);
+            }
+        }
+    }
+
+    ThreadPool::pool().parallelFor(int(jobs.size()), [this, &jobs, &surfOTF](int ijob)
+    {
+        SectionJob const &job = jobs.at(ijob);
+        if(isCancelled()) return;
+
+        Polar &sidePolar = surfOTF[job.m_iSurf].m_Polar[job.m_iSide];
+
+        // each task must have its own foil and polar; the foil's inviscid factorization is shared
+        // between the tasks through the prepared foils of XFoilTask
+        Foil foil;
+        foil.copy(&surfOTF[job.m_iSurf].m_Foil[job.m_iSide], true);
+
+        Polar blockPolar;
+        blockPolar.copySpecification(sidePolar);
+        blockPolar.resizeData(job.m_k1-job.m_k0);
+        for(int k=job.m_k0; k<job.m_k1; k++)
+        {
+            blockPolar.m_Cl[k-job.m_k0] = sidePolar.m_Cl.at(k);
+            blockPolar.m_Re[k-job.m_k0] = sidePolar.m_Re.at(k);
+        }
+
+        // heap allocated: the task holds an XFoil instance, too large for the stack of the pool's threads
+        std::unique_ptr<XFoilTask> pTask = std::make_unique<XFoilTask>();
+        if(pTask->initialize(foil, &blockPolar, false))
+            computeSectionDragOTF(pTask.get());
+
+        for(int k=job.m_k0; k<job.m_k1; k++)
+        {
+            sidePolar.m_Control[k] = blockPolar.m_Control.at(k-job.m_k0);
+            sidePolar.m_Cd[k]      = blockPolar.m_Cd.at(k-job.m_k0);
+            sidePolar.m_XTrTop[k]  = blockPolar.m_XTrTop.at(k-job.m_k0);
+            sidePolar.m_XTrBot[k]  = blockPolar.m_XTrBot.at(k-job.m_k0);
+        }
+    });
+
+    for (int jsurf=0; jsurf<pWing->nSurfaces(); jsurf++)
+    {
+        collectSurfaceDragOTF(pWing->surface(jsurf), surfOTF[jsurf].m_iStartStation, surfOTF[jsurf].m_Polar, SpanResFF);
+    }
 
 
     SpanDistribs &sd = SpanResFF;
@@ -3098,7 +4058,7 @@ void PlaneTask::makeVortonRow(int qrhs)
     }
 
     // save the new vortons
-    m_pPA->m_Vorton = newvortons;
+    m_pPA->setVortons(newvortons);
 }
 
 
@@ -3116,7 +4076,10 @@ bool PlaneTask::setLinearSolution()
     auto start = std::chrono::system_clock::now();
 
     traceStdLog("   Making the unit RHS vectors...");
-    m_pPA->makeUnitRHSVectors();
+    {
+        TaskProfile::Scope phase(&m_Profile, "RHS");
+        m_pPA->makeUnitRHSVectors();
+    }
 
     auto end = std::chrono::system_clock::now();
     int duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
@@ -3127,57 +4090,95 @@ bool PlaneTask::setLinearSolution()
 
     if (isCancelled()) return true;
 
-    traceStdLog("   Making the influence matrix...");
-    m_pPA->makeInfluenceMatrix();
-
-    end = std::chrono::system_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-    start = end;
-    strange = QString::asprintf("       done in %.3f s\n", double(duration)/1000.0);
-
-    traceLog(strange);
+    bool bFrozen = m_pPA->setFrozenFactorization(m_pRefPA);
 
-    if(m_pPA->m_bMatrixError)
+    if(!bFrozen && m_pPA->restoreFactorization())
     {
-        m_bError = true;
-        return false;
+        m_Profile.count(TaskProfile::LUCACHEHITS);
+        traceStdLog("   Using the cached LU factorization of the influence matrix\n");
+        if(m_Checkpoint.isOpen()) m_pPA->storeFactorization(m_Checkpoint);
     }
-    if (isCancelled()) return true;
-
-    if(!m_pPlPolar->isVLM())
+    else if(!bFrozen && m_Checkpoint.isOpen() && m_pPA->restoreFactorization(m_Checkpoint))
     {
-        traceStdLog("   Adding the wake's contribution...");
-        m_pPA->addWakeContribution();
-
+        traceStdLog("   Using the LU factorization of the checkpoint\n");
+    }
+    else
+    {
+        traceStdLog("   Making the influence matrix...");
+        {
+            TaskProfile::Scope phase(&m_Profile, "influence matrix");
+            m_pPA->makeInfluenceMatrix();
+            m_Profile.count(TaskProfile::INFLUENCECOEFS, int64_t(m_pPA->matSize())*int64_t(m_pPA->matSize()));
+        }
 
         end = std::chrono::system_clock::now();
         duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
         start = end;
-        strange = QString::asprintf("    done in %.3f s\n", double(duration)/1000.0);
+        strange = QString::asprintf("       done in %.3f s\n", double(duration)/1000.0);
+
         traceLog(strange);
 
-        if(m_pPA->m_bMatrixError) return false;
-    }
-    if (isCancelled()) return true;
+        if(m_pPA->m_bMatrixError)
+        {
+            m_bError = true;
+            return false;
+        }
+        if (isCancelled()) return true;
 
-    traceStdLog("   LAPACK - LU factorization...");
-    if (!m_pPA->LUfactorize())
-    {
-        traceStdLog(" singular matrix, aborting\n");
+        if(!m_pPlPolar->isVLM())
+        {
+            traceStdLog("   Adding the wake's contribution...");
+            {
+                TaskProfile::Scope phase(&m_Profile, "wake contribution");
+                m_pPA->addWakeContribution();
+            }
 
-        m_bError = true;
-        return false;
-    }
 
-    end = std::chrono::system_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-    start = end;
-    strange = QString::asprintf("         done in %.3f s\n", double(duration)/1000.0);
-    traceLog(strange);
-    if (isCancelled()) return true;
+            end = std::chrono::system_clock::now();
+            duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+            start = end;
+            strange = QString::asprintf("    done in %.3f s\n", double(duration)/1000.0);
+            traceLog(strange);
+
+            if(m_pPA->m_bMatrixError) return false;
+        }
+        if (isCancelled()) return true;
+
+        if(bFrozen)
+        {
+            // the matrix is left unfactorized for the residuals of the defect correction
+            traceStdLog("   Using the LU factorization of the reference geometry\n");
+        }
+        else
+        {
+            traceStdLog("   LAPACK - LU factorization...");
+            TaskProfile::Scope phase(&m_Profile, "LU factorization");
+            m_Profile.count(TaskProfile::LUFACTORIZATIONS);
+            if (!m_pPA->LUfactorize())
+            {
+                traceStdLog(" singular matrix, aborting\n");
+
+                m_bError = true;
+                return false;
+            }
+            m_pPA->storeFactorization();
+            if(m_Checkpoint.isOpen()) m_pPA->storeFactorization(m_Checkpoint);
+
+            end = std::chrono::system_clock::now();
+            duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+            start = end;
+            strange = QString::asprintf("         done in %.3f s\n", double(duration)/1000.0);
+            traceLog(strange);
+        }
+        if (isCancelled()) return true;
+    }
 
     traceStdLog("   Back-substituting RHS...");
-    m_pPA->backSubUnitRHS(m_pPA->m_uRHS.data(), m_pPA->m_vRHS.data(), m_pPA->m_wRHS.data(), m_pPA->m_pRHS.data(), m_pPA->m_qRHS.data(), m_pPA->m_rRHS.data());
+    {
+        TaskProfile::Scope phase(&m_Profile, "back-substitution");
+        m_Profile.count(TaskProfile::RHSSOLVED, 6);
+        m_pPA->backSubUnitRHS(m_pPA->m_uRHS.data(), m_pPA->m_vRHS.data(), m_pPA->m_wRHS.data(), m_pPA->m_pRHS.data(), m_pPA->m_qRHS.data(), m_pPA->m_rRHS.data());
+    }
 
 
     end = std::chrono::system_clock::now();
@@ -0,0 +1,299 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <cmath>
+
+#include <QString>
+
+#include <polarmeshgenerator.h>
+
+#include <foil.h>
+#include <objects2d.h>
+#include <planepolar.h>
+#include <planexfl.h>
+#include <polar.h>
+#include <surface.h>
+#include <wingxfl.h>
+
+
+bool PolarMeshGenerator::s_bEnabled = false;
+int PolarMeshGenerator::s_nReValues = 8;
+double PolarMeshGenerator::s_ReSafety = 1.5;
+double PolarMeshGenerator::s_AlphaMin = -8.0;
+double PolarMeshGenerator::s_AlphaMax = 18.0;
+double PolarMeshGenerator::s_AlphaInc = 0.5;
+double PolarMeshGenerator::s_CLMin = 0.1;
+double PolarMeshGenerator::s_CLMax = 1.5;
+
+
+PolarMeshGenerator::PolarMeshGenerator()
+{
+    m_VMin = m_VMax = 0.0;
+}
+
+
+PolarMeshGenerator::~PolarMeshGenerator()
+{
+    if(isRunning())
+    {
+        m_Engine.cancel();
+        m_Engine.wait();
+    }
+    clear();
+}
+
+
+void PolarMeshGenerator::clear()
+{
+    m_Engine.clearJobs();
+    for(Polar *pPolar : m_Polars) delete pPolar;
+    m_Polars.clear();
+    for(Foil *pFoil : m_Foils) delete pFoil;
+    m_Foils.clear();
+}
+
+
+/**
+ * Infers the range of freestream velocities of the operating points to be analyzed.
+ * The speeds of the polars which balance the weight are not known before the analysis;
+ * they are estimated from the range of lift coefficients CLMin()-CLMax().
+ * @return true if the range is valid.
+ */
+bool PolarMeshGenerator::inferSpeedRange(PlanePolar const *pWPolar, std::vector<double> const &oppList,
+                                         std::vector<double> const &ctrlList, std::vector<T8Opp> const &t8Opps)
+{
+    m_VMin = LARGEVALUE;
+    m_VMax = 0.0;
+    if(!pWPolar) return false;
+
+    auto addSpeed = [this](double v)
+    {
+        if(v<=0.0) return;
+        m_VMin = std::min(m_VMin, v);
+        m_VMax = std::max(m_VMax, v);
+    };
+
+    auto addBalanceSpeeds = [&](double mass)
+    {
+        if(pWPolar->density()<=0.0 || pWPolar->referenceArea()<=0.0) return;
+        double q = 2.0 * 9.81 * mass/pWPolar->density()/pWPolar->referenceArea();
+        addSpeed(sqrt(q/s_CLMax));
+        addSpeed(sqrt(q/s_CLMin));
+    };
+
+    if(pWPolar->isType1() || pWPolar->isType5())
+    {
+        addSpeed(pWPolar->velocity());
+    }
+    else if(pWPolar->isType2() || pWPolar->isType3())
+    {
+        addBalanceSpeeds(pWPolar->mass());
+    }
+    else if(pWPolar->isType4())
+    {
+        for(double qinf : oppList) addSpeed(qinf);
+    }
+    else if(pWPolar->isType6())
+    {
+        for(double ctrl : ctrlList)
+        {
+            if(pWPolar->isAdjustedVelocity()) addBalanceSpeeds(pWPolar->massCtrl(ctrl));
+            else                              addSpeed(pWPolar->QInfCtrl(ctrl));
+        }
+    }
+    else if(pWPolar->isType7())
+    {
+        addBalanceSpeeds(pWPolar->mass());
+    }
+    else if(pWPolar->isType8())
+    {
+        for(T8Opp const &t8opp : t8Opps)
+        {
+            if(t8opp.isActive()) addSpeed(t8opp.Vinf());
+        }
+    }
+
+    if(m_VMax<=0.0)
+    {
+        m_VMin = m_VMax = 0.0;
+        return false;
+    }
+    return true;
+}
+
+
+/** Returns nValues log-spaced Reynolds numbers in [reMin, reMax] */
+std::vector<double> PolarMeshGenerator::reValues(double reMin, double reMax, int nValues)
+{
+    std::vector<double> values(nValues);
+    double logMin = log(reMin);
+    double logMax = log(reMax);
+    for(int i=0; i<nValues; i++)
+    {
+        double t = nValues>1 ? double(i)/double(nValues-1) : 0.0;
+        values[i] = exp(logMin + t*(logMax-logMin));
+    }
+    return values;
+}
+
+
+/**
+ * Makes the polars which are missing for the plane's foils within the inferred Reynolds range.
+ * Must be called after the speed range has been set.
+ * @return the number of polars to compute.
+ */
+int PolarMeshGenerator::makeJobs(PlaneXfl const *pPlane, PlanePolar const *pWPolar, std::string &log)
+{
+    clear();
+    if(!pPlane || !pWPolar || m_VMax<=0.0 || pWPolar->viscosity()<=0.0) return 0;
+
+    // list the foils and the chords of the strips on which they are used
+    std::vector<FoilChords> foils;
+    for(int iw=0; iw<pPlane->nWings(); iw++)
+    {
+        WingXfl const *pWing = pPlane->wingAt(iw);
+        if(!pWing) continue;
+        for(int j=0; j<pWing->nSurfaces(); j++)
+        {
+            Surface const &surf = pWing->surfaceAt(j);
+            for(Foil const *pFoil : {surf.foilA(), surf.foilB()})
+            {
+                if(!pFoil) continue;
+                auto it = std::find_if(foils.begin(), foils.end(), [pFoil](FoilChords const &fc){return fc.m_pFoil==pFoil;});
+                if(it==foils.end())
+                {
+                    foils.push_back({pFoil});
+                    it = foils.end()-1;
+                }
+                for(int k=0; k<surf.NYPanels(); k++)
+                {
+                    double chord = surf.chord(k);
+                    it->m_ChordMin = std::min(it->m_ChordMin, chord);
+                    it->m_ChordMax = std::max(it->m_ChordMax, chord);
+                }
+            }
+        }
+    }
+
+    std::vector<AnalysisRange> ranges;
+    // both branches start close to zero aoa, where XFoil converges from scratch
+    ranges.push_back({true, 0.0,        s_AlphaMin, s_AlphaInc});
+    ranges.push_back({true, s_AlphaInc, s_AlphaMax, s_AlphaInc});
+
+    for(FoilChords const &fc : foils)
+    {
+        if(fc.m_ChordMax<=0.0) continue;
+
+        double reMin = fc.m_ChordMin * m_VMin / pWPolar->viscosity() / s_ReSafety;
+        double reMax = fc.m_ChordMax * m_VMax / pWPolar->viscosity() * s_ReSafety;
+        std::vector<double> revalues = reValues(reMin, reMax, s_nReValues);
+
+        // a Reynolds number is covered if an existing polar is closer than half a step of the mesh
+        double halfstep = 0.5 * std::log(reMax/reMin)/double(s_nReValues-1);
+
+        std::vector<double> existing;
+        for(int ip=0; ip<Objects2d::nPolars(); ip++)
+        {
+            Polar const *pOldPolar = Objects2d::polarAt(ip);
+            if(pOldPolar->foilName()==fc.m_pFoil->name() && pOldPolar->isFixedSpeedPolar() && pOldPolar->hasData())
+                existing.push_back(pOldPolar->Reynolds());
+        }
+
+        Foil *pJobFoil = nullptr;
+        for(double re : revalues)
+        {
+            bool bCovered = false;
+            for(double reold : existing)
+            {
+                if(reold>0.0 && fabs(std::log(re/reold))<halfstep)
+                {
+                    bCovered = true;
+                    break;
+                }
+            }
+            if(bCovered) continue;
+
+            if(!pJobFoil)
+            {
+                pJobFoil = new Foil;
+                pJobFoil->copy(fc.m_pFoil, true);
+                pJobFoil->applyBase();
+                m_Foils.push_back(pJobFoil);
+            }
+
+            Polar *pPolar = Objects2d::createPolar(fc.m_pFoil, xfl::T1POLAR, re, 0.0, pWPolar->NCrit(), pWPolar->XTrTop(), pWPolar->XTrBot());
+            pPolar->setName(QString::asprintf("T1_Re%.3f_M0.00_N%.1f", re/1.0e6, pWPolar->NCrit()).toStdString());
+            m_Polars.push_back(pPolar);
+
+            XFoilJob job;
+            job.m_pFoil   = pJobFoil;
+            job.m_pPolar  = pPolar;
+            job.m_Ranges  = ranges;
+            job.m_bAlpha  = true;
+            m_Engine.addJob(job);
+
+            log += "   " + fc.m_pFoil->name() + QString::asprintf(":  Re = %9.0f\n", re).toStdString();
+        }
+    }
+
+    return nJobs();
+}
+
+
+/** Starts the computation of the polars in the background and returns immediately */
+void PolarMeshGenerator::start()
+{
+    if(nJobs()==0) return;
+    m_Engine.start();
+}
+
+
+/**
+ * Waits for the polars to be computed, and inserts those which have converged points in the current ObjectStore.
+ * @return the number of polars inserted.
+ */
+int PolarMeshGenerator::finish(std::string &log)
+{
+    m_Engine.wait();
+
+    int nInserted = 0;
+    bool bCancelled = m_Engine.isCancelled();
+    for(Polar *pPolar : m_Polars)
+    {
+        if(pPolar->hasData() && !bCancelled)
+        {
+            Objects2d::insertPolar(pPolar);
+            nInserted++;
+        }
+        else
+        {
+            if(!bCancelled) log += "   " + pPolar->foilName() + " / " + pPolar->name() + ": no converged point\n";
+            delete pPolar;
+        }
+    }
+    m_Polars.clear();
+    clear();
+
+    return nInserted;
+}
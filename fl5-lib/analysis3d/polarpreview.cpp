@@ -0,0 +1,175 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#include <cmath>
+
+#include <polarpreview.h>
+
+#include <planeopp.h>
+#include <planepolar.h>
+#include <planetask.h>
+#include <planexfl.h>
+#include <wingxfl.h>
+
+
+PolarPreview::PolarPreview()
+{
+    m_pPolar = nullptr;
+    m_Decimation = 2;
+    m_bPreviewing = false;
+}
+
+
+/** @return true if the polar's analysis is long enough to be worth a preview, and if the plane can be decimated */
+bool PolarPreview::canPreview(Plane const *pPlane, PlanePolar const *pPolar)
+{
+    if(!pPolar || !dynamic_cast<PlaneXfl const*>(pPlane)) return false;
+    return pPolar->isType123458() && (pPolar->isPanel4Method() || pPolar->isTriangleMethod());
+}
+
+
+/**
+ * Runs the coarse analysis of the operating points and adds the provisional results to the polar.
+ * The points for which the polar already holds a result are not previewed.
+ * @return true if at least one provisional point has been added.
+ */
+bool PolarPreview::run(PlaneXfl const *pPlaneXfl, PlanePolar *pPolar, std::vector<double> const &opplist, std::vector<T8Opp> const &t8opps)
+{
+    m_pPolar = pPolar;
+    m_Points.clear();
+    if(!canPreview(pPlaneXfl, pPolar)) return false;
+
+    PlaneXfl plane;
+    plane.duplicate(pPlaneXfl);
+    for(int iw=0; iw<plane.nWings(); iw++)
+    {
+        WingXfl *pWing = plane.wing(iw);
+        for(int is=0; is<pWing->nSections(); is++)
+        {
+            pWing->setNXPanels(is, (pWing->nXPanels(is)+m_Decimation-1)/m_Decimation);
+            pWing->setNYPanels(is, (pWing->nYPanels(is)+m_Decimation-1)/m_Decimation);
+        }
+    }
+    plane.makePlane(false, true, false);
+
+    PlanePolar polar;
+    polar.duplicateSpec(pPolar);
+    polar.setName(pPolar->name());
+    polar.setPlaneName(pPolar->planeName());
+    polar.clearWPolarData();
+    polar.setVLM2();
+    polar.setThinSurfaces(true);
+    polar.setVortonWake(false);
+    polar.setViscousLoop(false);
+    if(polar.isViscous()) polar.setViscInterpolated(true);
+
+    PlaneTask task;
+    task.setKeepOpps(false);
+    task.setComputeDerivatives(false);
+    task.setResultSink(this);
+    task.setObjects(&plane, &polar);
+    if(polar.isType8()) task.setT8OppList(t8opps);
+    else                task.setOppList(opplist);
+
+    m_bPreviewing = true;
+    task.run();
+    m_bPreviewing = false;
+
+    return nProvisional()>0;
+}
+
+
+int PolarPreview::nProvisional() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return int(m_Points.size());
+}
+
+
+/** Removes from the polar the provisional points which have not been replaced by the full analysis */
+void PolarPreview::removeProvisional()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(!m_pPolar) return;
+    for(T8Opp const &pt : m_Points)
+    {
+        for(int i=0; i<m_pPolar->dataSize(); i++)
+        {
+            if(isSamePoint(pt, m_pPolar->m_Alpha.at(i), m_pPolar->m_Beta.at(i), m_pPolar->m_QInfinite.at(i)))
+            {
+                m_pPolar->removeAt(i);
+                break;
+            }
+        }
+    }
+    m_Points.clear();
+}
+
+
+/**
+ * Adds the operating point of the coarse analysis to the polar, or marks the provisional point
+ * as replaced by the operating point of the full analysis.
+ */
+void PolarPreview::addPlaneOpp(PlaneOpp *pPOpp)
+{
+    if(!pPOpp || !m_pPolar || pPOpp->isOut()) return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    T8Opp pt(true, pPOpp->alpha(), pPOpp->beta(), pPOpp->QInf());
+
+    if(m_bPreviewing)
+    {
+        // the results of a previous analysis are not overwritten by provisional ones
+        for(int i=0; i<m_pPolar->dataSize(); i++)
+        {
+            if(isSamePoint(pt, m_pPolar->m_Alpha.at(i), m_pPolar->m_Beta.at(i), m_pPolar->m_QInfinite.at(i))) return;
+        }
+        m_pPolar->addPlaneOpPointData(pPOpp);
+        m_Points.push_back(pt);
+    }
+    else
+    {
+        for(uint ip=0; ip<m_Points.size(); ip++)
+        {
+            if(isSamePoint(m_Points.at(ip), pt.alpha(), pt.beta(), pt.Vinf()))
+            {
+                m_Points.erase(m_Points.begin()+ip);
+                break;
+            }
+        }
+    }
+}
+
+
+/** @return true if the polar stores the two points at the same position, with the tolerance of PlanePolar::addPlaneOpPointData() */
+bool PolarPreview::isSamePoint(T8Opp const &pt, double alpha, double beta, double QInf) const
+{
+    double const d = 0.001;
+    if(m_pPolar->isType123()) return fabs(pt.alpha()-alpha)<d;
+    if(m_pPolar->isType4())   return fabs(pt.Vinf()-QInf)<d;
+    if(m_pPolar->isType5())   return fabs(pt.beta()-beta)<d;
+    return fabs(pt.alpha()-alpha)<d && fabs(pt.beta()-beta)<d && fabs(pt.Vinf()-QInf)<d;
+}
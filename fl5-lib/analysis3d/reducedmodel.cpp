@@ -0,0 +1,532 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <numeric>
+
+#include <reducedmodel.h>
+
+#include <constants.h>
+#include <plane.h>
+#include <planeopp.h>
+#include <planepolar.h>
+#include <planetask.h>
+#include <resultsink.h>
+#include <t8opp.h>
+
+
+/** incremented when the content of the model file changes, so that older files are rejected */
+static int const s_ModelFormat = 1;
+static char const s_ModelTag[8] = {'f','l','5','r','o','m','\0','\0'};
+
+
+namespace
+{
+    /** The part of an operating point which is kept by the model, copied when the task pushes the point */
+    struct Snapshot
+    {
+        double m_Alpha{0}, m_Beta{0};
+        double m_Values[ReducedModel::NVALUES]{};
+        std::vector<double> m_Field;
+    };
+
+    class SnapshotSink : public ResultSink
+    {
+        public:
+            explicit SnapshotSink(ReducedModel::enumField field) : m_Field(field) {}
+
+            void addPlaneOpp(PlaneOpp *pPOpp) override
+            {
+                if(!pPOpp) return;
+                AeroForces const &AF = pPOpp->aeroForces();
+                StabDerivatives const &SD = pPOpp->m_SD;
+
+                Snapshot s;
+                s.m_Alpha = pPOpp->alpha();
+                s.m_Beta  = pPOpp->beta();
+                double *v = s.m_Values;
+                v[ReducedModel::CL]     = AF.CL();
+                v[ReducedModel::CD]     = AF.CD();
+                v[ReducedModel::CY]     = AF.CSide();
+                v[ReducedModel::CLROLL] = AF.Cli();
+                v[ReducedModel::CM]     = AF.Cm();
+                v[ReducedModel::CN]     = AF.Cn();
+                v[ReducedModel::CXQ]    = SD.CXq;
+                v[ReducedModel::CZQ]    = SD.CZq;
+                v[ReducedModel::CMQ]    = SD.Cmq;
+                v[ReducedModel::CYP]    = SD.CYp;
+                v[ReducedModel::CYR]    = SD.CYr;
+                v[ReducedModel::CLP]    = SD.Clp;
+                v[ReducedModel::CLR]    = SD.Clr;
+                v[ReducedModel::CNP]    = SD.Cnp;
+                v[ReducedModel::CNR]    = SD.Cnr;
+                s.m_Field = m_Field==ReducedModel::CPFIELD ? pPOpp->Cp() : pPOpp->gamma();
+
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Snapshots.push_back(std::move(s));
+            }
+
+            std::vector<Snapshot> m_Snapshots;
+
+        private:
+            ReducedModel::enumField m_Field;
+            std::mutex m_Mutex;
+    };
+
+
+    /**
+     * Cyclic Jacobi diagonalization of the symmetric matrix A of size n, column-major; A is destroyed.
+     * On return, lambda holds the eigenvalues and V the eigenvectors in its columns, unsorted.
+     * The correlation matrices of the snapshots are small, so that the simplicity is preferred to the speed.
+     */
+    void jacobiEigen(std::vector<double> &A, int n, std::vector<double> &lambda, std::vector<double> &V)
+    {
+        V.assign(size_t(n)*size_t(n), 0.0);
+        for(int i=0; i<n; i++) V[size_t(i)*n+i] = 1.0;
+        auto a = [&A, n](int i, int j) -> double& {return A[size_t(j)*n+i];};
+
+        for(int sweep=0; sweep<50; sweep++)
+        {
+            double off = 0.0, diag = 0.0;
+            for(int j=0; j<n; j++)
+            {
+                diag += a(j,j)*a(j,j);
+                for(int i=0; i<j; i++) off += a(i,j)*a(i,j);
+            }
+            if(off<=1.0e-24*diag) break;
+
+            for(int p=0; p<n-1; p++)
+            {
+                for(int q=p+1; q<n; q++)
+                {
+                    double apq = a(p,q);
+                    if(fabs(apq)<1.0e-300) continue;
+                    double theta = (a(q,q)-a(p,p))/(2.0*apq);
+                    double t = (theta>=0.0 ? 1.0 : -1.0)/(fabs(theta)+sqrt(theta*theta+1.0));
+                    double c = 1.0/sqrt(t*t+1.0);
+                    double s = t*c;
+                    for(int k=0; k<n; k++)
+                    {
+                        double akp = a(k,p), akq = a(k,q);
+                        a(k,p) = c*akp - s*akq;
+                        a(k,q) = s*akp + c*akq;
+                    }
+                    for(int k=0; k<n; k++)
+                    {
+                        double apk = a(p,k), aqk = a(q,k);
+                        a(p,k) = c*apk - s*aqk;
+                        a(q,k) = s*apk + c*aqk;
+                    }
+                    for(int k=0; k<n; k++)
+                    {
+                        double vkp = V[size_t(p)*n+k], vkq = V[size_t(q)*n+k];
+                        V[size_t(p)*n+k] = c*vkp - s*vkq;
+                        V[size_t(q)*n+k] = s*vkp + c*vkq;
+                    }
+                }
+            }
+        }
+
+        lambda.resize(n);
+        for(int i=0; i<n; i++) lambda[i] = a(i,i);
+    }
+}
+
+
+ReducedModel::ReducedModel()
+{
+    m_Field = CPFIELD;
+    m_nModes = 0;
+    m_Energy = 0.0;
+    m_QInf = 0.0;
+    m_RefArea = m_RefChord = m_RefSpan = 0.0;
+}
+
+
+void ReducedModel::clear()
+{
+    m_Alpha.clear();
+    m_Beta.clear();
+    m_Values.clear();
+    m_Mean.clear();
+    m_Modes.clear();
+    m_Coefs.clear();
+    m_nModes = 0;
+    m_Energy = 0.0;
+}
+
+
+/**
+ * Samples the envelope and builds the model.
+ * The plane must be ready for analysis, as for a PlaneTask. The polar's specification is duplicated
+ * into a T8 polar at the polar's velocity, so that the polar itself is not modified.
+ * @param alphas, betas the angles of the grid, in degrees; sorted on return
+ * @param maxModes the max. number of POD modes which are retained
+ * @return false if the sampling failed or if some nodes of the grid did not converge; the reason is in log().
+ */
+bool ReducedModel::build(Plane *pPlane, PlanePolar const *pPolar, std::vector<double> const &alphas, std::vector<double> const &betas,
+                         enumField field, int maxModes)
+{
+    clear();
+    m_Log.clear();
+    m_Field = field;
+
+    if(!pPlane || !pPolar)
+    {
+        m_Log = "No plane or polar defined\n";
+        return false;
+    }
+    if(alphas.empty())
+    {
+        m_Log = "The envelope has no aoa\n";
+        return false;
+    }
+
+    m_Alpha = alphas;
+    m_Beta = betas.empty() ? std::vector<double>{pPolar->betaSpec()} : betas;
+    std::sort(m_Alpha.begin(), m_Alpha.end());
+    std::sort(m_Beta.begin(), m_Beta.end());
+    m_Alpha.erase(std::unique(m_Alpha.begin(), m_Alpha.end()), m_Alpha.end());
+    m_Beta.erase(std::unique(m_Beta.begin(), m_Beta.end()), m_Beta.end());
+
+    m_QInf = pPolar->velocity();
+    if(m_QInf<PRECISION) m_QInf = 1.0; // the coefficients of an inviscid analysis do not depend on the velocity
+    m_RefArea  = pPolar->referenceArea();
+    m_RefChord = pPolar->referenceChordLength();
+    m_RefSpan  = pPolar->referenceSpanLength();
+
+    PlanePolar polar;
+    polar.duplicateSpec(pPolar);
+    polar.setType(xfl::T8POLAR);
+    polar.clearWPolarData();
+
+    std::vector<T8Opp> opps;
+    for(double beta : m_Beta)
+        for(double alpha : m_Alpha) opps.push_back({true, alpha, beta, m_QInf});
+
+    SnapshotSink sink(field);
+    PlaneTask task;
+    task.setKeepOpps(false);
+    task.setComputeDerivatives(true);
+    task.setResultSink(&sink);
+    task.setObjects(pPlane, &polar);
+    task.setT8OppList(opps);
+    task.run();
+
+    int nA = nAlpha(), nB = nBeta();
+    int nNodes = nA*nB;
+
+    // the points are matched to the nodes by their angles, whatever the order in which they were pushed
+    std::vector<int> nodeSnapshot(nNodes, -1);
+    for(int is=0; is<int(sink.m_Snapshots.size()); is++)
+    {
+        Snapshot const &s = sink.m_Snapshots.at(is);
+        int ia = int(std::min_element(m_Alpha.begin(), m_Alpha.end(), [&s](double a, double b){return fabs(a-s.m_Alpha)<fabs(b-s.m_Alpha);}) - m_Alpha.begin());
+        int ib = int(std::min_element(m_Beta.begin(),  m_Beta.end(),  [&s](double a, double b){return fabs(a-s.m_Beta) <fabs(b-s.m_Beta);})  - m_Beta.begin());
+        if(fabs(m_Alpha.at(ia)-s.m_Alpha)<AOAPRECISION && fabs(m_Beta.at(ib)-s.m_Beta)<AOAPRECISION) nodeSnapshot[ib*nA+ia] = is;
+    }
+
+    int nMissing = int(std::count(nodeSnapshot.begin(), nodeSnapshot.end(), -1));
+    if(nMissing>0)
+    {
+        m_Log = std::to_string(nMissing) + " of the " + std::to_string(nNodes) + " points of the envelope were not computed\n";
+        clear();
+        return false;
+    }
+
+    m_Values.resize(size_t(nNodes)*NVALUES);
+    std::vector<std::vector<double>> fields(nNodes);
+    for(int in=0; in<nNodes; in++)
+    {
+        Snapshot &s = sink.m_Snapshots[nodeSnapshot.at(in)];
+        std::copy(s.m_Values, s.m_Values+NVALUES, m_Values.begin()+size_t(in)*NVALUES);
+        fields[in] = std::move(s.m_Field);
+    }
+
+    makePOD(fields, maxModes);
+
+    m_Log += "Sampled " + std::to_string(nNodes) + " points, retained " + std::to_string(m_nModes) + " modes\n";
+    return true;
+}
+
+
+/**
+ * Makes the POD of the fields with the method of snapshots: the eigenvectors of the correlation matrix
+ * of the fluctuations give the modes as combinations of the snapshots.
+ */
+void ReducedModel::makePOD(std::vector<std::vector<double>> const &snapshots, int maxModes)
+{
+    int nS = int(snapshots.size());
+    size_t nF = snapshots.empty() ? 0 : snapshots.front().size();
+    for(std::vector<double> const &f : snapshots)
+    {
+        if(f.size()!=nF || nF==0)
+        {
+            m_Log += "The fields are not available or have different sizes, no modes retained\n";
+            return;
+        }
+    }
+
+    std::vector<double> mean(nF, 0.0);
+    for(std::vector<double> const &f : snapshots)
+        for(size_t k=0; k<nF; k++) mean[k] += f.at(k)/double(nS);
+
+    std::vector<double> C(size_t(nS)*size_t(nS));
+    for(int i=0; i<nS; i++)
+    {
+        for(int j=i; j<nS; j++)
+        {
+            double c = 0.0;
+            for(size_t k=0; k<nF; k++) c += (snapshots[i][k]-mean[k])*(snapshots[j][k]-mean[k]);
+            C[size_t(j)*nS+i] = C[size_t(i)*nS+j] = c;
+        }
+    }
+
+    std::vector<double> lambda, V;
+    jacobiEigen(C, nS, lambda, V);
+
+    std::vector<int> order(nS);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&lambda](int a, int b){return lambda[a]>lambda[b];});
+
+    double total = 0.0;
+    for(double l : lambda) total += std::max(l, 0.0);
+
+    m_Mean.assign(mean.begin(), mean.end());
+    m_nModes = 0;
+    m_Energy = total>0.0 ? 0.0 : 1.0;
+    if(total<=0.0) return; // uniform field
+
+    std::vector<int> modes;
+    double captured = 0.0;
+    for(int k=0; k<nS && int(modes.size())<maxModes; k++)
+    {
+        double l = lambda[order[k]];
+        if(l<=1.0e-12*total) break;
+        modes.push_back(order[k]);
+        captured += l;
+    }
+    m_nModes = int(modes.size());
+    m_Energy = captured/total;
+
+    m_Modes.resize(size_t(m_nModes)*nF);
+    m_Coefs.resize(size_t(nS)*m_nModes);
+    for(int im=0; im<m_nModes; im++)
+    {
+        int e = modes[im];
+        double sl = sqrt(lambda[e]);
+        for(size_t k=0; k<nF; k++)
+        {
+            double phi = 0.0;
+            for(int s=0; s<nS; s++) phi += V[size_t(e)*nS+s]*(snapshots[s][k]-mean[k]);
+            m_Modes[size_t(im)*nF+k] = float(phi/sl);
+        }
+        for(int s=0; s<nS; s++) m_Coefs[size_t(s)*m_nModes+im] = sl*V[size_t(e)*nS+s];
+    }
+}
+
+
+/** Makes the four nodes and the bilinear weights of the point (alpha, beta), clamped to the envelope */
+void ReducedModel::weights(double alpha, double beta, int *node, double *w) const
+{
+    auto bracket = [](std::vector<double> const &x, double v, int &i0, double &t)
+    {
+        int n = int(x.size());
+        if(n<2 || v<=x.front()) {i0 = 0;   t = 0.0; return;}
+        if(v>=x.back())         {i0 = n-2; t = 1.0; return;}
+        i0 = int(std::upper_bound(x.begin(), x.end(), v) - x.begin()) - 1;
+        t = (v-x[i0])/(x[i0+1]-x[i0]);
+    };
+
+    int ia=0, ib=0;
+    double ta=0, tb=0;
+    bracket(m_Alpha, alpha, ia, ta);
+    bracket(m_Beta,  beta,  ib, tb);
+
+    int nA = nAlpha();
+    int ia1 = std::min(ia+1, nA-1);
+    int ib1 = std::min(ib+1, nBeta()-1);
+    node[0] = ib *nA + ia;   w[0] = (1.0-ta)*(1.0-tb);
+    node[1] = ib *nA + ia1;  w[1] = ta      *(1.0-tb);
+    node[2] = ib1*nA + ia;   w[2] = (1.0-ta)*tb;
+    node[3] = ib1*nA + ia1;  w[3] = ta      *tb;
+}
+
+
+/** @return the interpolated value of the given type at the point (alpha, beta), in degrees */
+double ReducedModel::value(enumValue iValue, double alpha, double beta) const
+{
+    if(isEmpty()) return 0.0;
+    int node[4];
+    double w[4];
+    weights(alpha, beta, node, w);
+    double v = 0.0;
+    for(int i=0; i<4; i++) v += w[i]*m_Values[size_t(node[i])*NVALUES+iValue];
+    return v;
+}
+
+
+/**
+ * @return the coefficients at the point (alpha, beta), in degrees, with the non-dimensional rates
+ * p=p.b/2V, q=q.c/2V and r=r.b/2V. The rate derivatives are those of the stability axes, and
+ * CL and CD are taken as -CZ and -CX for the contributions of the pitch rate.
+ */
+ReducedModel::Coefficients ReducedModel::evaluate(double alpha, double beta, double p, double q, double r) const
+{
+    Coefficients C;
+    if(isEmpty()) return C;
+
+    int node[4];
+    double w[4];
+    weights(alpha, beta, node, w);
+    double v[NVALUES] = {};
+    for(int i=0; i<4; i++)
+    {
+        double const *vn = m_Values.data() + size_t(node[i])*NVALUES;
+        for(int k=0; k<NVALUES; k++) v[k] += w[i]*vn[k];
+    }
+
+    C.m_CL = v[CL] - v[CZQ]*q;
+    C.m_CD = v[CD] - v[CXQ]*q;
+    C.m_CY = v[CY] + v[CYP]*p + v[CYR]*r;
+    C.m_Cl = v[CLROLL] + v[CLP]*p + v[CLR]*r;
+    C.m_Cm = v[CM] + v[CMQ]*q;
+    C.m_Cn = v[CN] + v[CNP]*p + v[CNR]*r;
+    return C;
+}
+
+
+/** Interpolates the nModes() modal coefficients at the point (alpha, beta) into the array a */
+void ReducedModel::modalCoefficients(double alpha, double beta, double *a) const
+{
+    for(int im=0; im<m_nModes; im++) a[im] = 0.0;
+    if(isEmpty() || m_nModes==0) return;
+
+    int node[4];
+    double w[4];
+    weights(alpha, beta, node, w);
+    for(int i=0; i<4; i++)
+    {
+        double const *cn = m_Coefs.data() + size_t(node[i])*m_nModes;
+        for(int im=0; im<m_nModes; im++) a[im] += w[i]*cn[im];
+    }
+}
+
+
+/** Rebuilds the Cp or doublet field at the point (alpha, beta) from the mean and the retained modes */
+void ReducedModel::field(double alpha, double beta, std::vector<double> &f) const
+{
+    size_t nF = m_Mean.size();
+    f.assign(m_Mean.begin(), m_Mean.end());
+    if(m_nModes==0) return;
+
+    std::vector<double> a(m_nModes);
+    modalCoefficients(alpha, beta, a.data());
+    for(int im=0; im<m_nModes; im++)
+    {
+        float const *mode = m_Modes.data() + size_t(im)*nF;
+        for(size_t k=0; k<nF; k++) f[k] += a[im]*double(mode[k]);
+    }
+}
+
+
+/** Writes the model file, through a temporary file so that an interrupted write leaves the previous file intact */
+bool ReducedModel::save(std::string const &path) const
+{
+    std::error_code ec;
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if(!parent.empty()) std::filesystem::create_directories(parent, ec);
+
+    std::string temppath = path + ".tmp";
+    {
+        std::ofstream file(temppath, std::ios::binary | std::ios::trunc);
+        int header[7] = {s_ModelFormat, nAlpha(), nBeta(), int(NVALUES), int(m_Field), fieldSize(), m_nModes};
+        double dims[5] = {m_QInf, m_RefArea, m_RefChord, m_RefSpan, m_Energy};
+        file.write(s_ModelTag, sizeof(s_ModelTag));
+        file.write(reinterpret_cast<char const*>(header), sizeof(header));
+        file.write(reinterpret_cast<char const*>(dims), sizeof(dims));
+        file.write(reinterpret_cast<char const*>(m_Alpha.data()),  std::streamsize(m_Alpha.size()*sizeof(double)));
+        file.write(reinterpret_cast<char const*>(m_Beta.data()),   std::streamsize(m_Beta.size()*sizeof(double)));
+        file.write(reinterpret_cast<char const*>(m_Values.data()), std::streamsize(m_Values.size()*sizeof(double)));
+        file.write(reinterpret_cast<char const*>(m_Mean.data()),   std::streamsize(m_Mean.size()*sizeof(float)));
+        file.write(reinterpret_cast<char const*>(m_Modes.data()),  std::streamsize(m_Modes.size()*sizeof(float)));
+        file.write(reinterpret_cast<char const*>(m_Coefs.data()),  std::streamsize(m_Coefs.size()*sizeof(double)));
+        if(!file)
+        {
+            file.close();
+            std::filesystem::remove(temppath, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(temppath, path, ec);
+    return !ec;
+}
+
+
+bool ReducedModel::load(std::string const &path)
+{
+    clear();
+
+    std::ifstream file(path, std::ios::binary);
+    if(!file) return false;
+
+    char tag[sizeof(s_ModelTag)];
+    int header[7] = {0,0,0,0,0,0,0};
+    double dims[5] = {0,0,0,0,0};
+    if(   !file.read(tag, sizeof(tag)) || !std::equal(tag, tag+sizeof(tag), s_ModelTag)
+       || !file.read(reinterpret_cast<char*>(header), sizeof(header))
+       || !file.read(reinterpret_cast<char*>(dims), sizeof(dims))) return false;
+    if(header[0]!=s_ModelFormat || header[1]<=0 || header[2]<=0 || header[3]!=NVALUES || header[5]<0 || header[6]<0) return false;
+
+    int nA = header[1], nB = header[2], nF = header[5], nM = header[6];
+    m_Field = header[4]==GAMMAFIELD ? GAMMAFIELD : CPFIELD;
+    m_QInf = dims[0];
+    m_RefArea = dims[1];
+    m_RefChord = dims[2];
+    m_RefSpan = dims[3];
+    m_Energy = dims[4];
+
+    m_Alpha.resize(nA);
+    m_Beta.resize(nB);
+    m_Values.resize(size_t(nA)*nB*NVALUES);
+    m_Mean.resize(nF);
+    m_Modes.resize(size_t(nM)*nF);
+    m_Coefs.resize(size_t(nA)*nB*nM);
+    if(   !file.read(reinterpret_cast<char*>(m_Alpha.data()),  std::streamsize(m_Alpha.size()*sizeof(double)))
+       || !file.read(reinterpret_cast<char*>(m_Beta.data()),   std::streamsize(m_Beta.size()*sizeof(double)))
+       || !file.read(reinterpret_cast<char*>(m_Values.data()), std::streamsize(m_Values.size()*sizeof(double)))
+       || !file.read(reinterpret_cast<char*>(m_Mean.data()),   std::streamsize(m_Mean.size()*sizeof(float)))
+       || !file.read(reinterpret_cast<char*>(m_Modes.data()),  std::streamsize(m_Modes.size()*sizeof(float)))
+       || !file.read(reinterpret_cast<char*>(m_Coefs.data()),  std::streamsize(m_Coefs.size()*sizeof(double))))
+    {
+        clear();
+        return false;
+    }
+    m_nModes = nM;
+    return true;
+}
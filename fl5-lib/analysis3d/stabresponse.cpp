@@ -0,0 +1,335 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+#include <stabresponse.h>
+
+#include <planeopp.h>
+#include <threadpool.h>
+
+
+/** The state magnitude above which a response is considered divergent, as in the interactive time responses */
+#define STAB_MAXSTATE 1.e10
+
+
+StabResponse::StabResponse()
+{
+    m_Method = EXPONENTIAL;
+    m_TotalTime = 1.0;
+    m_dt = 0.001;
+    m_nSteps = 1000;
+    m_OutputInterval = 1;
+}
+
+
+void StabResponse::setTime(double totalTime, double dt)
+{
+    m_TotalTime = std::max(totalTime, 0.0);
+    m_dt = dt>0.0 ? dt : 0.001;
+    m_nSteps = int(m_TotalTime/m_dt + 0.5);
+}
+
+
+void StabResponse::clear()
+{
+    m_Scenarios.clear();
+    m_InputTime.clear();
+    m_InputValue.clear();
+    m_InputSamples.clear();
+    m_Y.clear();
+    m_nResults.clear();
+}
+
+
+/**
+ * Adds a control history, linearly interpolated between the points and constant beyond the last one.
+ * @return the index of the history, to be used by the scenarios
+ */
+int StabResponse::addInput(std::vector<double> const &time, std::vector<double> const &value)
+{
+    size_t n = std::min(time.size(), value.size());
+    m_InputTime.push_back(std::vector<double>(time.begin(), time.begin()+n));
+    m_InputValue.push_back(std::vector<double>(value.begin(), value.begin()+n));
+    return int(m_InputTime.size())-1;
+}
+
+
+int StabResponse::addScenario(Scenario const &scenario)
+{
+    m_Scenarios.push_back(scenario);
+    return int(m_Scenarios.size())-1;
+}
+
+
+/**
+ * Adds the free response which starts from the real part of the eigenvector of the given mode.
+ * @param iMode the index of the mode in the system, 0 to 3
+ */
+int StabResponse::addModalScenario(PlaneOpp const *pPOpp, bool bLongitudinal, int iMode, double amplitude)
+{
+    Scenario scenario;
+    scenario.m_pPOpp = pPOpp;
+    scenario.m_bLongitudinal = bLongitudinal;
+    if(pPOpp && iMode>=0 && iMode<4)
+    {
+        int k = bLongitudinal ? iMode : 4+iMode;
+        for(int i=0; i<4; i++) scenario.m_y0[i] = amplitude*pPOpp->m_EigenVector[k][i].real();
+    }
+    return addScenario(scenario);
+}
+
+
+/**
+ * Makes the step map from the exponential of the augmented matrix
+ *       | A  B  0 |
+ *   M = | 0  0  1 |
+ *       | 0  0  0 |
+ * of the state [x, u, u'], which is exact when the control is linear over the step.
+ * The exponential is made by scaling and squaring of its Taylor series.
+ */
+void StabResponse::makeExponentialMap(double const *A, double const *B, double dt, StepMap &map)
+{
+    int const n = 6;
+    double M[36], E[36], T[36], W[36];
+    memset(M, 0, sizeof(M));
+    for(int i=0; i<4; i++)
+    {
+        for(int j=0; j<4; j++) M[i*n+j] = A[i*4+j]*dt;
+        M[i*n+4] = B[i]*dt;
+    }
+    M[4*n+5] = dt;
+
+    double norm = 0.0;
+    for(int i=0; i<n; i++)
+    {
+        double row = 0.0;
+        for(int j=0; j<n; j++) row += fabs(M[i*n+j]);
+        norm = std::max(norm, row);
+    }
+    int nSquare = 0;
+    if(norm>0.5) nSquare = int(ceil(log2(norm/0.5)));
+    double scale = ldexp(1.0, -nSquare);
+    for(int k=0; k<36; k++) M[k] *= scale;
+
+    // Taylor series of the scaled matrix, converged to machine precision for a norm <= 0.5
+    memset(E, 0, sizeof(E));
+    memset(T, 0, sizeof(T));
+    for(int i=0; i<n; i++) E[i*n+i] = T[i*n+i] = 1.0;
+    for(int p=1; p<=14; p++)
+    {
+        for(int i=0; i<n; i++)
+            for(int j=0; j<n; j++)
+            {
+                double s = 0.0;
+                for(int k=0; k<n; k++) s += T[i*n+k]*M[k*n+j];
+                W[i*n+j] = s/double(p);
+            }
+        memcpy(T, W, sizeof(T));
+        for(int k=0; k<36; k++) E[k] += T[k];
+    }
+
+    for(int is=0; is<nSquare; is++)
+    {
+        for(int i=0; i<n; i++)
+            for(int j=0; j<n; j++)
+            {
+                double s = 0.0;
+                for(int k=0; k<n; k++) s += E[i*n+k]*E[k*n+j];
+                W[i*n+j] = s;
+            }
+        memcpy(E, W, sizeof(E));
+    }
+
+    // x1 = Phi.x0 + E4.u0 + E5.(u1-u0)/dt
+    for(int i=0; i<4; i++)
+    {
+        for(int j=0; j<4; j++) map.m_Phi[i*4+j] = E[i*n+j];
+        map.m_G0[i] = E[i*n+4] - E[i*n+5]/dt;
+        map.m_Gm[i] = 0.0;
+        map.m_G1[i] = E[i*n+5]/dt;
+    }
+}
+
+
+/** Makes the step map of the classical RK4 scheme, with the control evaluated at t, t+dt/2 and t+dt */
+void StabResponse::makeRK4Map(double const *A, double const *B, double dt, StepMap &map)
+{
+    // the step is linear in (x, u0, um, u1), so that its coefficients are the images of the unit vectors
+    auto step = [A, B, dt](double const *x, double u0, double um, double u1, double *y)
+    {
+        double k[4][4], yp[4];
+        double const u[] = {u0, um, um, u1};
+        double const c[] = {0.0, 0.5, 0.5, 1.0};
+        for(int s=0; s<4; s++)
+        {
+            for(int i=0; i<4; i++) yp[i] = s==0 ? x[i] : x[i] + c[s]*dt*k[s-1][i];
+            for(int i=0; i<4; i++)
+                k[s][i] = A[i*4+0]*yp[0] + A[i*4+1]*yp[1] + A[i*4+2]*yp[2] + A[i*4+3]*yp[3] + B[i]*u[s];
+        }
+        for(int i=0; i<4; i++) y[i] = x[i] + dt/6.0*(k[0][i] + 2.0*k[1][i] + 2.0*k[2][i] + k[3][i]);
+    };
+
+    double const zero[]{0,0,0,0};
+    double y[4];
+    for(int j=0; j<4; j++)
+    {
+        double e[]{0,0,0,0};
+        e[j] = 1.0;
+        step(e, 0.0, 0.0, 0.0, y);
+        for(int i=0; i<4; i++) map.m_Phi[i*4+j] = y[i];
+    }
+    step(zero, 1.0, 0.0, 0.0, map.m_G0);
+    step(zero, 0.0, 1.0, 0.0, map.m_Gm);
+    step(zero, 0.0, 0.0, 1.0, map.m_G1);
+}
+
+
+/** Samples each control history at the half steps, once for all the scenarios which use it */
+void StabResponse::sampleInputs()
+{
+    m_InputSamples.resize(m_InputTime.size());
+    for(int ii=0; ii<int(m_InputTime.size()); ii++)
+    {
+        std::vector<double> const &t = m_InputTime.at(ii);
+        std::vector<double> const &u = m_InputValue.at(ii);
+        std::vector<double> &samples = m_InputSamples[ii];
+        samples.resize(2*m_nSteps+1);
+        int k = 0;
+        for(int is=0; is<=2*m_nSteps; is++)
+        {
+            double time = double(is)*0.5*m_dt;
+            if(t.empty())               samples[is] = 0.0;
+            else if(time<=t.front())    samples[is] = u.front();
+            else if(time>=t.back())     samples[is] = u.back();
+            else
+            {
+                while(k<int(t.size())-2 && t[k+1]<time) k++;
+                double dt = t[k+1]-t[k];
+                double tau = dt>0.0 ? (time-t[k])/dt : 1.0;
+                samples[is] = u[k] + tau*(u[k+1]-u[k]);
+            }
+        }
+    }
+}
+
+
+void StabResponse::integrate(int iScenario, StepMap const &map)
+{
+    Scenario const &scenario = m_Scenarios.at(iScenario);
+    double *Y = m_Y.data() + size_t(iScenario)*size_t(nOutputs())*4;
+
+    double const *u = nullptr;
+    if(scenario.m_iCtrl>=0 && scenario.m_iInput>=0 && scenario.m_iInput<int(m_InputSamples.size()))
+        u = m_InputSamples.at(scenario.m_iInput).data();
+
+    double const *P = map.m_Phi;
+    double x[4], y[4];
+    memcpy(x, scenario.m_y0, sizeof(x));
+    memcpy(Y, x, sizeof(x));
+    int nOut = 1;
+
+    for(int is=0; is<m_nSteps; is++)
+    {
+        for(int i=0; i<4; i++)
+            y[i] = P[i*4+0]*x[0] + P[i*4+1]*x[1] + P[i*4+2]*x[2] + P[i*4+3]*x[3];
+        if(u)
+        {
+            double u0 = u[2*is], um = u[2*is+1], u1 = u[2*is+2];
+            for(int i=0; i<4; i++) y[i] += map.m_G0[i]*u0 + map.m_Gm[i]*um + map.m_G1[i]*u1;
+        }
+        memcpy(x, y, sizeof(x));
+
+        if(fabs(x[0])>STAB_MAXSTATE || fabs(x[1])>STAB_MAXSTATE || fabs(x[2])>STAB_MAXSTATE || fabs(x[3])>STAB_MAXSTATE) break;
+
+        if((is+1)%m_OutputInterval==0)
+        {
+            memcpy(Y+4*nOut, x, sizeof(x));
+            nOut++;
+        }
+    }
+    m_nResults[iScenario] = nOut;
+}
+
+
+/**
+ * Integrates all the scenarios. The step maps are made once for each combination of operating point,
+ * system and control, then the scenarios are integrated concurrently.
+ */
+void StabResponse::run()
+{
+    int nS = nScenarios();
+    m_Y.assign(size_t(nS)*size_t(nOutputs())*4, 0.0);
+    m_nResults.assign(nS, 0);
+    if(nS==0) return;
+
+    sampleInputs();
+
+    typedef std::tuple<PlaneOpp const*, bool, int> MapKey;
+    std::map<MapKey, int> mapIndex;
+    std::vector<int> scenarioMap(nS, -1);
+    std::vector<StepMap> maps;
+
+    for(int is=0; is<nS; is++)
+    {
+        Scenario const &scenario = m_Scenarios.at(is);
+        PlaneOpp const *pPOpp = scenario.m_pPOpp;
+        if(!pPOpp) continue;
+
+        std::vector<std::vector<double>> const &BCtrl = scenario.m_bLongitudinal ? pPOpp->m_BLong : pPOpp->m_BLat;
+        int iCtrl = (scenario.m_iCtrl>=0 && scenario.m_iCtrl<int(BCtrl.size()) && BCtrl.at(scenario.m_iCtrl).size()>=4) ? scenario.m_iCtrl : -1;
+
+        MapKey key(pPOpp, scenario.m_bLongitudinal, iCtrl);
+        auto it = mapIndex.find(key);
+        if(it!=mapIndex.end())
+        {
+            scenarioMap[is] = it->second;
+            continue;
+        }
+
+        double const *A = scenario.m_bLongitudinal ? &pPOpp->m_ALong[0][0] : &pPOpp->m_ALat[0][0];
+        double B[]{0,0,0,0};
+        if(iCtrl>=0) for(int i=0; i<4; i++) B[i] = BCtrl.at(iCtrl).at(i);
+
+        StepMap map;
+        if(m_Method==RK4) makeRK4Map(A, B, m_dt, map);
+        else              makeExponentialMap(A, B, m_dt, map);
+        maps.push_back(map);
+        scenarioMap[is] = int(maps.size())-1;
+        mapIndex[key] = scenarioMap[is];
+    }
+
+    int nTasks = std::min(nS, ThreadPool::nBlocks(ThreadPool::pool().nWorkers()+1));
+    ThreadPool::pool().parallelFor(nTasks, [this, nS, nTasks, &maps, &scenarioMap](int iTask)
+    {
+        for(int is=iTask; is<nS; is+=nTasks)
+        {
+            if(scenarioMap.at(is)>=0) integrate(is, maps.at(scenarioMap.at(is)));
+        }
+    });
+}
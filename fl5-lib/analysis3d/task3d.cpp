@@ -30,16 +30,23 @@
 //https://developercommunity.visualstudio.com/t/Visual-Studio-17100-Update-leads-to-Pr/10669759?sort=newest
 //#define _DISABLE_CONSTEXPR_MUTEX_CONSTRUCTOR
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <thread>
 
 #include <task3d.h>
 
+#include <livechannel.h>
+#include <objectstore.h>
+#include <opp3d.h>
+
 #include <polar3d.h>
 #include <panelanalysis.h>
 #include <p4analysis.h>
 #include <p3unianalysis.h>
 #include <p3linanalysis.h>
+#include <threadpool.h>
 
 
 bool Task3d::s_bCancel = false;
@@ -51,6 +58,10 @@ bool Task3d::s_bVortonStretch = true;
 bool Task3d::s_bVortonRedist = true;
 
 bool Task3d::s_bLiveUpdate = false;
+double Task3d::s_VPWTolerance = 1.0e-4;
+int Task3d::s_VortonBatchSize = 64;
+int Task3d::s_MaxVortons = 0;
+int Task3d::s_MaxQueuedMessages = 10000;
 
 
 Task3d::Task3d()
@@ -66,6 +77,15 @@ Task3d::Task3d()
     m_bKeepOpps = false;
     m_bStdOut   = false;
 
+    m_pResultSink = nullptr;
+    m_pLiveChannel = nullptr;
+    m_pConvergenceMonitor = nullptr;
+
+    m_nThreads = 0;
+    m_nDroppedMessages = 0;
+
+    m_pStore = &ObjectStore::current();
+
     m_qRHS = -1;
     m_nRHS = 0;
 
@@ -79,6 +99,18 @@ Task3d::~Task3d()
 }
 
 
+/**
+ * Drops the panel fields of the operating point once its polar values have been extracted,
+ * if the retention policy of the polar does not keep them.
+ * @param iOpp the index of the operating point in the task's list; -1 if unknown.
+ */
+void Task3d::applyFieldRetention(Polar3d const *pPolar, Opp3d *pOpp, int iOpp)
+{
+    if(!pPolar || !pOpp) return;
+    if(!pPolar->retainsFields(pOpp, iOpp)) pOpp->clearFields();
+}
+
+
 void Task3d::traceLog(const QString &str)
 {
     traceStdLog(str.toStdString());
@@ -90,10 +122,7 @@ void Task3d::traceStdLog(std::string const &str)
     // notify the parent thread
     VPWReport report;
     report.setMsg(str);
-    // Access the Q under the lock:
-    std::unique_lock<std::mutex> lck(m_mtx);
-    m_theMsgQueue.push(report);
-    m_cv.notify_all();
+    postReport(report);
 
     // output to the terminal
     if(m_bStdOut)
@@ -105,12 +134,51 @@ void Task3d::traceStdLog(std::string const &str)
 
 void Task3d::traceVPWLog(double ctrl)
 {
+    if(m_pLiveChannel)
+    {
+        m_pLiveChannel->publishWake(ctrl, m_pPA->m_Vorton);
+        return;
+    }
+
+    // the wake is not copied if the report would be dropped
+    if(s_MaxQueuedMessages>0)
+    {
+        std::unique_lock<std::mutex> lck(m_mtx);
+        if(int(m_theMsgQueue.size())>=s_MaxQueuedMessages)
+        {
+            m_nDroppedMessages++;
+            return;
+        }
+    }
+
     VPWReport report;
     report.m_Ctrl = ctrl;
     report.m_Vortons = m_pPA->m_Vorton;
+    postReport(report);
+}
+
 
+/**
+ * Pushes the report on the message queue and notifies the calling thread.
+ * If the queue is full, the report is dropped; the number of dropped reports is
+ * notified with the next report which fits in the queue.
+ */
+void Task3d::postReport(VPWReport const &report)
+{
     // Access the Q under the lock:
     std::unique_lock<std::mutex> lck(m_mtx);
+    if(s_MaxQueuedMessages>0 && int(m_theMsgQueue.size())>=s_MaxQueuedMessages)
+    {
+        m_nDroppedMessages++;
+        return;
+    }
+    if(m_nDroppedMessages>0)
+    {
+        VPWReport note;
+        note.setMsg("   ... " + std::to_string(m_nDroppedMessages) + " messages were dropped\n");
+        m_theMsgQueue.push(note);
+        m_nDroppedMessages = 0;
+    }
     m_theMsgQueue.push(report);
     m_cv.notify_all();
 }
@@ -125,8 +193,18 @@ void Task3d::cancelTask()
 }
 
 
+/** Discards the messages which have not been read by the calling thread, e.g. before the task is reused */
+void Task3d::clearMessages()
+{
+    std::unique_lock<std::mutex> lck(m_mtx);
+    std::queue<VPWReport>().swap(m_theMsgQueue);
+    m_nDroppedMessages = 0;
+}
+
+
 void Task3d::run()
 {
+    ScopedStore scope(m_pStore);
     m_AnalysisStatus = xfl::RUNNING;
 
     if(s_bCancel || !m_pPolar3d)
@@ -137,12 +215,25 @@ void Task3d::run()
 
     traceStdLog("Analyzing\n");
 
-    loop();
+    KernelStats::Totals kernelstart = KernelStats::snapshot();
+    {
+        TaskProfile::Scope scope(&m_Profile, "analysis");
+        loop();
+    }
+    traceKernelStats(kernelstart);
 
     if(m_AnalysisStatus!=xfl::CANCELLED) m_AnalysisStatus = xfl::FINISHED;
 }
 
 
+/** Writes the panel kernel counts made since the start snapshot to the log, if the counters are compiled and enabled */
+void Task3d::traceKernelStats(KernelStats::Totals const &start)
+{
+    if(!KernelStats::isCompiled() || !KernelStats::isEnabled()) return;
+    traceStdLog("\n" + KernelStats::report(KernelStats::snapshot()-start) + "\n");
+}
+
+
 void Task3d::setAnalysisStatus(xfl::enumAnalysisStatus status)
 {
     m_AnalysisStatus = status;
@@ -154,6 +245,8 @@ void Task3d::advectVortons(double alpha, double beta, double QInf, int qrhs)
 {
     if(!m_pPolar3d->bVortonWake()) return;
 
+    TaskProfile::Scope scope(&m_Profile, "vorton advection");
+
     if(m_pP4A)
     {
         tmp_Mu    = m_pP4A->m_Mu.data()    + qrhs*m_pP4A->nPanels();
@@ -168,67 +261,199 @@ void Task3d::advectVortons(double alpha, double beta, double QInf, int qrhs)
 
     // update positions and vorticities
     // duplicate the existing vortons which will be replaced all at once at the end of the procedure
-    std::vector<std::vector<Vorton>> newvortons = m_pPA->m_Vorton;
+    // the copy assignments reuse the capacity of the previous iterations
+    tmp_NewVortons = m_pPA->m_Vorton;
+    std::vector<std::vector<Vorton>> &newvortons = tmp_NewVortons;
     double dl = m_pPolar3d->vortonL0() * m_pPolar3d->referenceChordLength(); //m
     tmp_dt = dl/QInf;
     tmp_VInf = objects::windDirection(alpha, beta)*QInf;
     tmp_vortonwakelength = m_pPolar3d->VPWMaxLength()*m_pPolar3d->referenceChordLength();
 
 
-    if(PanelAnalysis::s_bMultiThread)
+    // flatten the active vortons into batches of even size, independently of the row lengths
+    std::vector<Vorton*> &active = tmp_ActiveVortons;
+    active.clear();
+    for(uint irow=0; irow<newvortons.size(); irow++)
     {
-        std::vector<std::thread> threads;
+        for(uint iv=0; iv<newvortons[irow].size(); iv++)
+            if(newvortons[irow][iv].isActive()) active.push_back(&newvortons[irow][iv]);
+    }
+    int nVortons = int(active.size());
+    int nBatches = (nVortons + s_VortonBatchSize-1)/s_VortonBatchSize;
+    m_Profile.count(TaskProfile::VORTONSADVECTED, nVortons);
 
-        for(uint irow=0; irow<newvortons.size(); irow++)
-        {
-            threads.push_back(std::thread(&Task3d::advectVortonRow, this, &newvortons[irow]));
-        }
+    // the velocities of all the vortons are evaluated for the same strengths
+    m_pPA->makePanelTree(tmp_Mu, tmp_Sigma);
 
-        for(uint irow=0; irow<newvortons.size(); irow++)
-        {
-            threads[irow].join();
-        }
-//        std::cout << "Task3d::advectVortons joined all " << newvortons.size() << " threads" <<std::endl;
+    auto advectBatch = [this, &active, nVortons](int ib)
+    {
+        int iStart = ib*s_VortonBatchSize;
+        advectVortonBatch(active.data()+iStart, std::min(s_VortonBatchSize, nVortons-iStart));
+    };
 
+    if(PanelAnalysis::s_bMultiThread)
+    {
+        ThreadPool::pool().parallelFor(nBatches, advectBatch);
     }
     else
     {
-        for(uint irow=0; irow<newvortons.size(); irow++)
-        {
-            advectVortonRow(&newvortons[irow]);
-        }
+        for(int ib=0; ib<nBatches; ib++) advectBatch(ib);
     }
 
+    m_pPA->clearPanelTree();
+
     // save the new vortons
-    m_pPA->m_Vorton = newvortons;
+    m_pPA->setVortons(newvortons);
 
 //    qDebug("Vorton advect %2d elapsed: %9.3f s", m_pPA->m_Vorton.size(), double(t.elapsed())/1000.0);
 }
 
 
-void Task3d::advectVortonRow(std::vector<Vorton> *thisrow)
+/**
+ * Keeps the number of active vortons within the budget s_MaxVortons by merging the nearby vortons.
+ * The vortons are binned in a spatial hash of cubic cells the size of the merge distance;
+ * each vorton absorbs the neighbours of the 27 surrounding cells which are closer than the merge distance,
+ * and which either have a vorticity of the same sense or are negligible. The absorbed vortons are deactivated
+ * rather than erased, so that the rows keep their columns. The vortex vectors and the impulse are conserved
+ * by Vorton::merge().
+ * The first row is left untouched since the negating vortices refer to it.
+ * The merge distance starts at half the vorton step and is increased until the budget is met.
+ */
+void Task3d::manageVortons()
 {
-    Vector3d VT1, VT2, translation, P1;
+    if(!s_bVortonRedist || s_MaxVortons<=0 || !m_pPolar3d->bVortonWake()) return;
+
+    std::vector<std::vector<Vorton>> &vortons = m_pPA->m_Vorton;
 
-    for(uint iv=0; iv<thisrow->size(); iv++)
+    std::vector<Vorton*> active;
+    double maxcirc = 0.0;
+    for(uint irow=1; irow<vortons.size(); irow++)
     {
-        // convect-translate the vorton
-        Vorton &vtn = (*thisrow)[iv];
-        if(vtn.isActive())
+        for(Vorton &vtn : vortons[irow])
+        {
+            if(!vtn.isActive()) continue;
+            active.push_back(&vtn);
+            maxcirc = std::max(maxcirc, vtn.circulation());
+        }
+    }
+    int nActive = int(active.size());
+    if(vortons.size()) for(Vorton const &vtn : vortons.front()) if(vtn.isActive()) nActive++;
+    if(nActive<=s_MaxVortons || maxcirc<=0.0) return;
+
+    TaskProfile::Scope scope(&m_Profile, "vorton merge");
+
+    double negligible = 1.0e-3*maxcirc;
+    double h = 0.5 * m_pPolar3d->vortonL0() * m_pPolar3d->referenceChordLength();
+    if(h<=0.0) return;
+
+    int nMerged = 0;
+    std::vector<std::pair<uint64_t, int>> cells;
+    for(int ipass=0; ipass<6 && nActive>s_MaxVortons; ipass++, h*=1.5)
+    {
+        // the hash keys of the cells, with 21 bits per direction
+        auto cellIndex = [h](double x) {return int64_t(std::floor(x/h)) + (int64_t(1)<<20);};
+        auto cellKey = [](int64_t ix, int64_t iy, int64_t iz)
+        {
+            return (uint64_t(ix&0x1FFFFF)<<42) | (uint64_t(iy&0x1FFFFF)<<21) | uint64_t(iz&0x1FFFFF);
+        };
+
+        cells.clear();
+        for(int i=0; i<int(active.size()); i++)
+        {
+            Vector3d const &p = active[i]->position();
+            cells.push_back({cellKey(cellIndex(p.x), cellIndex(p.y), cellIndex(p.z)), i});
+        }
+        std::sort(cells.begin(), cells.end());
+
+        for(int i=0; i<int(active.size()) && nActive>s_MaxVortons; i++)
         {
-            Vector3d const &P0 = vtn.position();
+            Vorton &vi = *active[i];
+            if(!vi.isActive()) continue;
 
-            //RK2
-            if(m_pPA)  m_pPA->getVelocityVector(P0, tmp_Mu, tmp_Sigma, VT1, Vortex::coreRadius(), false, false);
-            translation.set((tmp_VInf + VT1)*tmp_dt);
-            P1.set(P0 + translation*tmp_dt/2.0);
+            Vector3d const pi = vi.position();
+            int64_t ix = cellIndex(pi.x), iy = cellIndex(pi.y), iz = cellIndex(pi.z);
+            for(int io=0; io<27; io++)
+            {
+                uint64_t key = cellKey(ix+io%3-1, iy+(io/3)%3-1, iz+io/9-1);
+                auto it = std::lower_bound(cells.begin(), cells.end(), std::make_pair(key, 0));
+                for(; it!=cells.end() && it->first==key; it++)
+                {
+                    Vorton &vj = *active[it->second];
+                    if(it->second==i || !vj.isActive()) continue;
+                    if(vj.position().distanceTo(pi)>=h) continue;
+                    bool bNegligible = vi.circulation()<negligible || vj.circulation()<negligible;
+                    if(!bNegligible && vi.vortex().dot(vj.vortex())<=0.0) continue;
+
+                    vi.merge(vj);
+                    vj.setActive(false);
+                    nMerged++;
+                    nActive--;
+                }
+            }
+        }
+
+        // keep the surviving vortons for the next pass
+        active.erase(std::remove_if(active.begin(), active.end(), [](Vorton const *pVtn){return !pVtn->isActive();}), active.end());
+    }
+
+    m_Profile.count(TaskProfile::VORTONSMERGED, nMerged);
+
+    // rebuild the octree from the merged vortons
+    m_pPA->makeVortonTree();
+}
+
+
+/**
+ * Monitors the convergence of the VPW iterations on the far field force.
+ * The iterations are converged once the relative change of the force between two
+ * iterations has been less than s_VPWTolerance for three consecutive iterations.
+ * @param LastForce the force at the previous iteration; updated on return
+ * @param nSteady the number of consecutive iterations below the tolerance; updated on return
+ */
+bool Task3d::hasVPWConverged(Vector3d const &Force, Vector3d &LastForce, int &nSteady) const
+{
+    double fnorm = Force.norm();
+    if(s_VPWTolerance>0.0 && fnorm>PRECISION && (Force-LastForce).norm()/fnorm<s_VPWTolerance) nSteady++;
+    else                                                                                  nSteady = 0;
+    LastForce = Force;
+    return nSteady>=3;
+}
 
-            if(m_pPA)  m_pPA->getVelocityVector(P1, tmp_Mu, tmp_Sigma, VT2, Vortex::coreRadius(), false, false);
-            translation.set((tmp_VInf+VT2)*tmp_dt);
-            vtn.translate(translation);
 
-            if(vtn.position().norm()>tmp_vortonwakelength)
-                vtn.setActive(false);
+/**
+ * Advects a batch of nVtn active vortons with a RK2 scheme.
+ * The positions are read from the analysis' vorton array and the results are written
+ * to the copies pointed to by vtn, which are swapped in once all the batches have completed.
+ * Each stage evaluates the velocities of the whole batch at once, so that the panels
+ * are loaded once per batch rather than once per vorton.
+ */
+void Task3d::advectVortonBatch(Vorton **vtn, int nVtn) const
+{
+    if(!m_pPA || nVtn<=0) return;
+
+    std::vector<Vector3d> P(nVtn), VT(nVtn);
+    Vector3d translation;
+
+    //RK2
+    for(int iv=0; iv<nVtn; iv++) P[iv] = vtn[iv]->position();
+    m_pPA->getVelocityVectors(nVtn, P.data(), tmp_Mu, tmp_Sigma, VT.data(), Vortex::coreRadius(), false);
+
+    for(int iv=0; iv<nVtn; iv++)
+    {
+        translation.set((onsetVelocity(P[iv]) + VT[iv])*tmp_dt);
+        P[iv] += translation*tmp_dt/2.0;
+    }
+    m_pPA->getVelocityVectors(nVtn, P.data(), tmp_Mu, tmp_Sigma, VT.data(), Vortex::coreRadius(), false);
+
+    for(int iv=0; iv<nVtn; iv++)
+    {
+        // convect-translate the vorton
+        Vorton &v = *vtn[iv];
+        translation.set((onsetVelocity(P[iv])+VT[iv])*tmp_dt);
+        v.translate(translation);
+
+        if(v.position().norm()>tmp_vortonwakelength)
+            v.setActive(false);
 
 /*                if(s_bVortonStretch)
             {
@@ -250,7 +475,6 @@ void Task3d::advectVortonRow(std::vector<Vorton> *thisrow)
                 omega.z += domz;
                 vtn.setVortex(omega);
             }*/
-        }
     }
 }
 
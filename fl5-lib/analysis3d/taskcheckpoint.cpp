@@ -0,0 +1,346 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+
+#include <taskcheckpoint.h>
+#include <planeopp.h>
+
+
+bool TaskCheckpoint::s_bEnabled(false);
+std::string TaskCheckpoint::s_Dir;
+double TaskCheckpoint::s_Interval(60.0);
+
+
+namespace
+{
+    /** incremented when the content of the keys or of the files changes, so that older checkpoints are ignored */
+    int const CHECKPOINTFORMAT = 1;
+
+    void setStreamFormat(QDataStream &ar)
+    {
+        ar.setVersion(QDataStream::Qt_4_5);
+        ar.setByteOrder(QDataStream::LittleEndian);
+    }
+
+    /** Replaces the file by the temporary file, so that an interrupted write never leaves a partial file */
+    void moveIntoPlace(std::string const &temppath, std::string const &path)
+    {
+        std::error_code ec;
+        std::filesystem::rename(temppath, path, ec);
+        if(ec) std::filesystem::remove(temppath, ec);
+    }
+}
+
+
+TaskCheckpoint::TaskCheckpoint()
+{
+    m_Key = 0;
+}
+
+
+std::string TaskCheckpoint::directory()
+{
+    if(!s_Dir.empty()) return s_Dir;
+    std::error_code ec;
+    std::filesystem::path dir = std::filesystem::temp_directory_path(ec);
+    if(ec) return std::string();
+    return (dir/"flow5_checkpoints").string();
+}
+
+
+std::string TaskCheckpoint::filePath(char const *extension) const
+{
+    std::string dir = directory();
+    if(dir.empty()) return std::string();
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "cp_%016llx.%s", static_cast<unsigned long long>(m_Key), extension);
+    return (std::filesystem::path(dir)/name).string();
+}
+
+
+/**
+ * Opens the checkpoint of the task with the given key; the files of a previous run with the same key are kept
+ * and are read by the load methods. The wake state is due at the first call to isWakeStateDue().
+ */
+void TaskCheckpoint::open(std::uint64_t key)
+{
+    m_Key = key;
+    m_Done.clear();
+    m_StateTimer.invalidate();
+    if(key==0) return;
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory(), ec);
+}
+
+
+/**
+ * Copies the stored factorization into the arrays if it is the factorization of the matrix with the given key.
+ * The arrays must have been allocated with the size of the stored arrays.
+ * @return true if the factorization was read.
+ */
+bool TaskCheckpoint::loadFactorization(std::uint64_t matrixkey, int n, bool bDouble, double *aijd, size_t nd, float *aijf, size_t nf, std::vector<int> &ipiv) const
+{
+    if(!isOpen() || matrixkey==0) return false;
+
+    std::ifstream file(filePath("lu"), std::ios::binary);
+    if(!file) return false;
+
+    int format=0, size=0, idouble=0, nipiv=0;
+    std::uint64_t key=0, ndstored=0, nfstored=0;
+    file.read(reinterpret_cast<char*>(&format),   sizeof(int));
+    file.read(reinterpret_cast<char*>(&key),      sizeof(std::uint64_t));
+    file.read(reinterpret_cast<char*>(&size),     sizeof(int));
+    file.read(reinterpret_cast<char*>(&idouble),  sizeof(int));
+    file.read(reinterpret_cast<char*>(&ndstored), sizeof(std::uint64_t));
+    file.read(reinterpret_cast<char*>(&nfstored), sizeof(std::uint64_t));
+    file.read(reinterpret_cast<char*>(&nipiv),    sizeof(int));
+    if(!file || format!=CHECKPOINTFORMAT || key!=matrixkey || size!=n || (idouble!=0)!=bDouble) return false;
+    if(ndstored!=nd || nfstored!=nf || nipiv<0) return false;
+
+    std::vector<int> piv(nipiv);
+    file.read(reinterpret_cast<char*>(aijd),       std::streamsize(nd*sizeof(double)));
+    file.read(reinterpret_cast<char*>(aijf),       std::streamsize(nf*sizeof(float)));
+    file.read(reinterpret_cast<char*>(piv.data()), std::streamsize(piv.size()*sizeof(int)));
+    if(!file) return false;
+
+    ipiv.swap(piv);
+    return true;
+}
+
+
+/** Writes the factorization of the matrix with the given key, replacing the previous one */
+void TaskCheckpoint::storeFactorization(std::uint64_t matrixkey, int n, bool bDouble, double const *aijd, size_t nd, float const *aijf, size_t nf, std::vector<int> const &ipiv) const
+{
+    if(!isOpen() || matrixkey==0) return;
+
+    std::string path = filePath("lu");
+    if(path.empty()) return;
+    std::string temppath = path + ".tmp";
+    {
+        std::ofstream file(temppath, std::ios::binary | std::ios::trunc);
+        int idouble = bDouble ? 1 : 0;
+        int nipiv = int(ipiv.size());
+        std::uint64_t ndstored = nd, nfstored = nf;
+        file.write(reinterpret_cast<char const*>(&CHECKPOINTFORMAT), sizeof(int));
+        file.write(reinterpret_cast<char const*>(&matrixkey), sizeof(std::uint64_t));
+        file.write(reinterpret_cast<char const*>(&n),         sizeof(int));
+        file.write(reinterpret_cast<char const*>(&idouble),   sizeof(int));
+        file.write(reinterpret_cast<char const*>(&ndstored),  sizeof(std::uint64_t));
+        file.write(reinterpret_cast<char const*>(&nfstored),  sizeof(std::uint64_t));
+        file.write(reinterpret_cast<char const*>(&nipiv),     sizeof(int));
+        file.write(reinterpret_cast<char const*>(aijd),        std::streamsize(nd*sizeof(double)));
+        file.write(reinterpret_cast<char const*>(aijf),        std::streamsize(nf*sizeof(float)));
+        file.write(reinterpret_cast<char const*>(ipiv.data()), std::streamsize(ipiv.size()*sizeof(int)));
+        if(!file) return; // the temporary file is overwritten by the next attempt
+    }
+    moveIntoPlace(temppath, path);
+}
+
+
+/**
+ * Reads the operating points completed by the previous run, and marks them as done.
+ * The ownership of the operating points is transferred to the caller.
+ * A record truncated by an interrupted write is removed from the file, so that the next records are appended to the last valid one.
+ */
+std::vector<std::pair<int, PlaneOpp*>> TaskCheckpoint::loadOpps()
+{
+    std::vector<std::pair<int, PlaneOpp*>> opps;
+    if(!isOpen()) return opps;
+
+    QFile file(QString::fromStdString(filePath("opp")));
+    if(!file.open(QIODevice::ReadWrite)) return opps;
+
+    QDataStream ar(&file);
+    setStreamFormat(ar);
+    int format=0;
+    ar >> format;
+    if(format!=CHECKPOINTFORMAT)
+    {
+        file.resize(0);
+        return opps;
+    }
+
+    while(!ar.atEnd())
+    {
+        qint64 pos = file.pos();
+        qint32 iOpp=-1;
+        QByteArray data;
+        ar >> iOpp >> data;
+
+        PlaneOpp *pPOpp = nullptr;
+        if(ar.status()==QDataStream::Ok && iOpp>=0)
+        {
+            QDataStream oppar(data);
+            setStreamFormat(oppar);
+            pPOpp = new PlaneOpp;
+            if(!pPOpp->serializeFl5(oppar, false) || oppar.status()!=QDataStream::Ok)
+            {
+                delete pPOpp;
+                pPOpp = nullptr;
+            }
+        }
+        if(!pPOpp)
+        {
+            file.resize(pos);
+            break;
+        }
+
+        if(iOpp>=int(m_Done.size())) m_Done.resize(iOpp+1, false);
+        m_Done[iOpp] = true;
+        opps.push_back({int(iOpp), pPOpp});
+    }
+    return opps;
+}
+
+
+/** Appends the completed operating point to the checkpoint and marks it as done */
+void TaskCheckpoint::appendOpp(int iOpp, PlaneOpp *pPOpp)
+{
+    if(!isOpen() || !pPOpp || iOpp<0) return;
+
+    QByteArray data;
+    QDataStream oppar(&data, QIODevice::WriteOnly);
+    setStreamFormat(oppar);
+    pPOpp->serializeFl5(oppar, true);
+
+    QFile file(QString::fromStdString(filePath("opp")));
+    if(!file.open(QIODevice::WriteOnly|QIODevice::Append)) return;
+
+    QDataStream ar(&file);
+    setStreamFormat(ar);
+    if(file.size()==0) ar << CHECKPOINTFORMAT;
+    ar << qint32(iOpp) << data;
+    file.flush();
+
+    if(iOpp>=int(m_Done.size())) m_Done.resize(iOpp+1, false);
+    m_Done[iOpp] = true;
+}
+
+
+/** @return true if the wake state has never been written, or if it was last written more than one interval ago */
+bool TaskCheckpoint::isWakeStateDue() const
+{
+    if(!isOpen()) return false;
+    return !m_StateTimer.isValid() || double(m_StateTimer.elapsed())>=s_Interval*1000.0;
+}
+
+
+/** Reads the state of the wake iterations written by the previous run */
+bool TaskCheckpoint::loadWakeState(WakeState &state) const
+{
+    if(!isOpen()) return false;
+
+    QFile file(QString::fromStdString(filePath("wake")));
+    if(!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream ar(&file);
+    setStreamFormat(ar);
+
+    int format=0, n=0;
+    ar >> format;
+    if(format!=CHECKPOINTFORMAT) return false;
+
+    WakeState st;
+    ar >> st.m_iOpp >> st.m_iWake >> st.m_bConvergedLast;
+    ar >> st.m_QInf >> st.m_QInfStab;
+    ar >> st.m_LastForce.x >> st.m_LastForce.y >> st.m_LastForce.z;
+    ar >> st.m_nSteady;
+
+    ar >> n;
+    if(ar.status()!=QDataStream::Ok || n<0) return false;
+    st.m_gamma.resize(n);
+    for(int i=0; i<n; i++) ar >> st.m_gamma[i];
+
+    ar >> n;
+    if(ar.status()!=QDataStream::Ok || n<0) return false;
+    st.m_Vortons.resize(n);
+    for(int ir=0; ir<n; ir++)
+        if(!Vorton::serializeArrayFl5(ar, st.m_Vortons[ir], false)) return false;
+
+    if(!Vortex::serializeArrayFl5(ar, st.m_VortexNeg, false)) return false;
+
+    if(ar.status()!=QDataStream::Ok) return false;
+    state = std::move(st);
+    return true;
+}
+
+
+/** Writes the state of the wake iterations, replacing the previous one, and restarts the interval */
+void TaskCheckpoint::storeWakeState(WakeState &state)
+{
+    if(!isOpen()) return;
+
+    std::string path = filePath("wake");
+    if(path.empty()) return;
+    std::string temppath = path + ".tmp";
+    {
+        QFile file(QString::fromStdString(temppath));
+        if(!file.open(QIODevice::WriteOnly|QIODevice::Truncate)) return;
+
+        QDataStream ar(&file);
+        setStreamFormat(ar);
+
+        ar << CHECKPOINTFORMAT;
+        ar << state.m_iOpp << state.m_iWake << state.m_bConvergedLast;
+        ar << state.m_QInf << state.m_QInfStab;
+        ar << state.m_LastForce.x << state.m_LastForce.y << state.m_LastForce.z;
+        ar << state.m_nSteady;
+
+        ar << int(state.m_gamma.size());
+        for(double g : state.m_gamma) ar << g;
+
+        ar << int(state.m_Vortons.size());
+        for(std::vector<Vorton> &row : state.m_Vortons)
+            Vorton::serializeArrayFl5(ar, row, true);
+
+        Vortex::serializeArrayFl5(ar, state.m_VortexNeg, true);
+
+        file.flush();
+        if(ar.status()!=QDataStream::Ok) return;
+    }
+    moveIntoPlace(temppath, path);
+    m_StateTimer.start();
+}
+
+
+/** Removes the files of the checkpoint and closes it */
+void TaskCheckpoint::remove()
+{
+    if(!isOpen()) return;
+    std::error_code ec;
+    std::filesystem::remove(filePath("lu"),   ec);
+    std::filesystem::remove(filePath("opp"),  ec);
+    std::filesystem::remove(filePath("wake"), ec);
+    close();
+}
+
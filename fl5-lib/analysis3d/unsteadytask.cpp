@@ -0,0 +1,294 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#define _MATH_DEFINES_DEFINED
+
+#include <cmath>
+
+#include <QString>
+
+#include <unsteadytask.h>
+
+#include <livechannel.h>
+#include <objects_global.h>
+#include <p3analysis.h>
+#include <p4analysis.h>
+#include <panelanalysis.h>
+#include <plane.h>
+#include <planepolar.h>
+#include <units.h>
+
+
+double UnsteadyTask::s_TreeTheta = 0.5;
+
+
+UnsteadyTask::UnsteadyTask() : PlaneTask()
+{
+    m_nRHS = 1; // a single solution array, overwritten at each time step
+
+    m_nSteps = 100;
+    m_dt = 0.0;
+    m_Time = 0.0;
+    m_bRefPoint = false;
+}
+
+
+/**
+ * Makes a vertical 1-cosine gust of the given amplitude and length, frozen in the air and convected
+ * with the free stream along the x axis; the gust's front is at x0 at t=0.
+ */
+UnsteadyTask::GustField UnsteadyTask::oneMinusCosineGust(double amplitude, double length, double x0, double QInf)
+{
+    return [amplitude, length, x0, QInf](Vector3d const &P, double t)
+    {
+        double s = QInf*t - (P.x-x0); // the distance travelled by the point into the gust
+        if(length<=0.0 || s<=0.0 || s>=length) return Vector3d();
+        return Vector3d(0.0, 0.0, 0.5*amplitude*(1.0-cos(2.0*PI*s/length)));
+    };
+}
+
+
+/** The velocity of the air relative to the body at point P at the current time, excluding the perturbation of the wake */
+Vector3d UnsteadyTask::onsetVelocity(Vector3d const &P) const
+{
+    Vector3d V = m_VInf - m_VBody - m_Omega*(P-m_RefPoint);
+    if(m_Gust) V += m_Gust(P, m_Time);
+    return V;
+}
+
+
+/** Makes the velocity field at the control points from the onset velocity and from the velocities VVPW induced by the vortons */
+void UnsteadyTask::makeOnsetField(std::vector<Vector3d> const &VVPW, std::vector<Vector3d> &VField) const
+{
+    bool bVLM = m_pPlPolar->isVLM();
+    for(int p=0; p<m_pPA->nPanels(); p++)
+        VField[p] = onsetVelocity(m_pPA->panelAt(p)->ctrlPt(bVLM)) + VVPW.at(p);
+}
+
+
+/**
+ * @return the integral of the perturbation potential over the surface, i.e. the sum of phi.n.dS, with phi = -4.pi.mu.
+ * Its time derivative gives the part of the pressure force due to the term dphi/dt in the unsteady Bernoulli equation,
+ * which the far field force of the bound circulation does not account for.
+ */
+Vector3d UnsteadyTask::potentialIntegral() const
+{
+    Vector3d PhiN;
+    for(int p=0; p<m_pPA->nPanels(); p++)
+    {
+        Panel const *pPanel = m_pPA->panelAt(p);
+        double mu = 0.0;
+        if     (m_pP4A) mu = m_pP4A->m_Mu.at(p);
+        else if(m_pP3A) mu = (m_pP3A->m_Mu.at(3*p) + m_pP3A->m_Mu.at(3*p+1) + m_pP3A->m_Mu.at(3*p+2))/3.0;
+        PhiN += pPanel->normal() * (-4.0*PI*mu*pPanel->area());
+    }
+    return PhiN;
+}
+
+
+/** Makes and factorizes the influence matrix, unless its factors are cached */
+bool UnsteadyTask::factorize()
+{
+    if(m_pPA->restoreFactorization())
+    {
+        m_Profile.count(TaskProfile::LUCACHEHITS);
+        traceStdLog("   Using the cached LU factorization of the influence matrix\n");
+        return true;
+    }
+
+    traceStdLog("   Making the influence matrix\n");
+    {
+        TaskProfile::Scope phase(&m_Profile, "influence matrix");
+        m_pPA->makeInfluenceMatrix();
+        m_Profile.count(TaskProfile::INFLUENCECOEFS, int64_t(m_pPA->matSize())*int64_t(m_pPA->matSize()));
+    }
+    if(m_pPA->m_bMatrixError || isCancelled()) return false;
+
+    if(!m_pPlPolar->isVLM())
+    {
+        TaskProfile::Scope phase(&m_Profile, "wake contribution");
+        m_pPA->addWakeContribution();
+        if(m_pPA->m_bMatrixError) return false;
+    }
+    if(isCancelled()) return false;
+
+    traceStdLog("   LU factorization\n");
+    {
+        TaskProfile::Scope phase(&m_Profile, "LU factorization");
+        m_Profile.count(TaskProfile::LUFACTORIZATIONS);
+        if(!m_pPA->LUfactorize())
+        {
+            traceStdLog("   Singular matrix, aborting\n");
+            m_bError = true;
+            return false;
+        }
+    }
+    m_pPA->storeFactorization();
+    return true;
+}
+
+
+void UnsteadyTask::loop()
+{
+    QString strange;
+
+    m_History.clear();
+
+    if(!m_pPlPolar->isType1() || !m_pPlPolar->bVortonWake())
+    {
+        traceStdLog("The time-marching analysis requires a fixed speed polar with a vorton wake... aborting\n");
+        m_bError = true;
+        return;
+    }
+
+    double QInf = m_pPlPolar->velocity();
+    if(QInf<PRECISION)
+    {
+        traceStdLog("Null free stream velocity... aborting\n");
+        m_bError = true;
+        return;
+    }
+
+    m_QInf = QInf;
+    m_Phi  = m_pPlPolar->phi();
+    m_Ctrl = 0.0;
+    m_VInf = objects::windDirection(m_Alpha, m_Beta)*QInf;
+    m_dt   = m_pPolar3d->vortonL0()*m_pPolar3d->referenceChordLength()/QInf;
+    if(!m_bRefPoint) m_RefPoint = m_pPlPolar->CoG();
+
+    double const qDyn = 0.5*m_pPlPolar->density()*QInf*QInf;
+    double const area = m_pPlPolar->referenceArea();
+    Vector3d const windD = objects::windDirection(m_Alpha, m_Beta);
+    Vector3d const windN = objects::windNormal(m_Alpha, m_Beta);
+    Vector3d const windS = objects::windSide(m_Alpha, m_Beta);
+
+    traceStdLog("\nTime-marching analysis\n");
+    strange  = "   " + ALPHAch + QString::asprintf(" = %.3f", m_Alpha) + DEGch + EOLch;
+    strange += "   " + BETAch  + QString::asprintf(" = %.3f", m_Beta)  + DEGch + EOLch;
+    strange += QString::asprintf("   Time step = %g s\n", m_dt);
+    strange += QString::asprintf("   Nbr. of steps = %d\n\n", m_nSteps);
+    traceLog(strange);
+
+    m_pPA->m_nStations = m_pPlane->nStations(); // for assertion checks only
+    m_pPA->setTreeTheta(s_TreeTheta);
+    m_pPA->makeWakePanels(windD, true);
+    m_pPA->clearVortons();
+    m_pPA->m_VortexNeg.clear();
+
+    // the geometry does not move in body axes, so that the matrix is factorized once for the whole run
+    if(!factorize()) return;
+
+    // and the RHS of each time step is made from coefficients in O(N)
+    {
+        TaskProfile::Scope phase(&m_Profile, "RHS");
+        m_pPA->makeRHSCoefficients();
+    }
+    if(isCancelled()) return;
+
+    int N = m_pPA->nPanels();
+    std::vector<Vector3d> VField(N), VVPW(N);
+    Vector3d PhiN, LastPhiN;
+
+    m_History.reserve(m_nSteps);
+    m_bStopVPWIterations = false;
+
+    for(int it=0; it<m_nSteps; it++)
+    {
+        TaskProfile::Scope stepphase(&m_Profile, "time step");
+        m_Profile.count(TaskProfile::VPWITERATIONS);
+
+        m_Time = double(it)*m_dt;
+        m_VBody.reset();
+        m_Omega.reset();
+        if(m_Kinematics) m_Kinematics(m_Time, m_VBody, m_Omega);
+
+        if(m_pPA->nVortonRows()>0)
+        {
+            TaskProfile::Scope phase(&m_Profile, "vorton velocities");
+            m_pPA->makeRHSVWVelocities(VVPW);
+        }
+        else std::fill(VVPW.begin(), VVPW.end(), Vector3d());
+
+        makeOnsetField(VVPW, VField);
+        m_pPA->makeSourceStrengths(VField);
+
+        {
+            TaskProfile::Scope phase(&m_Profile, "RHS");
+            m_pPA->combineRHSCoefficients(VField, m_pPA->m_uRHS);
+        }
+        {
+            TaskProfile::Scope phase(&m_Profile, "back-substitution");
+            m_Profile.count(TaskProfile::RHSSOLVED);
+            m_pPA->backSubUnitRHS(m_pPA->m_uRHS.data(), nullptr, nullptr, nullptr, nullptr, nullptr);
+        }
+
+        if(m_pPlPolar->isQuadMethod())
+            m_pP4A->m_Mu = m_pP4A->m_uRHS;
+        else
+        {
+            if(m_pPlPolar->isTriLinearMethod())
+                m_pP3A->m_Mu = m_pP3A->m_uRHS;
+            if(m_pPlPolar->isTriUniformMethod())
+                m_pPA->makeVertexDoubletDensities(m_pP3A->m_uRHS, m_pP3A->m_Mu);
+        }
+
+        computeInducedForces(m_Alpha, m_Beta, QInf);
+
+        Sample sample;
+        sample.m_Time = m_Time;
+        for(Vector3d const &F : m_WingForce) sample.m_Force += F;
+
+        // the first step is an impulsive start, at which the rate of change of the potential is not defined
+        PhiN = potentialIntegral();
+        if(it>0) sample.m_UnsteadyForce = (PhiN-LastPhiN) * (m_pPlPolar->density()/m_dt/qDyn);
+        LastPhiN = PhiN;
+        sample.m_Force += sample.m_UnsteadyForce;
+
+        sample.m_CL = sample.m_Force.dot(windN)/area;
+        sample.m_CD = sample.m_Force.dot(windD)/area;
+        sample.m_CY = sample.m_Force.dot(windS)/area;
+
+        for(std::vector<Vorton> const &row : m_pPA->m_Vorton)
+            for(Vorton const &vtn : row) if(vtn.isActive()) sample.m_nVortons++;
+
+        m_History.push_back(sample);
+
+        traceLog(QString::asprintf("   step %4d   t=%9.5f s   CL=%9.5f   CD=%9.5f   CY=%9.5f   vortons=%d\n",
+                                   it+1, m_Time, sample.m_CL, sample.m_CD, sample.m_CY, sample.m_nVortons));
+        if(m_pLiveChannel) m_pLiveChannel->publishResidual(m_Time, it, sample.m_CL);
+
+        if(isCancelled()) return;
+        if(m_bStopVPWIterations) break; // user requested interruption
+        if(it==m_nSteps-1) break; // the wake of the last step is not needed
+
+        // advect the vortons with the velocities of this time step, then shed the new row from the trailing wake panels
+        advectVortons(m_Alpha, m_Beta, QInf, 0);
+        makeVortonRow(0);
+        manageVortons();
+
+        if(s_bLiveUpdate) traceVPWLog(m_Time);
+    }
+
+    traceLog(EOLch);
+}
@@ -0,0 +1,116 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+class Plane;
+class PlaneXfl;
+class PlanePolar;
+
+
+/**
+ * @class AdaptiveMesh
+ * @brief Refines the triangular mesh of a plane where the solution varies most, until the force coefficients converge.
+ *
+ * Each iteration solves one operating point with the polar's triangular method, then makes an error indicator for each
+ * panel from the variation of the Cp and of the doublet density within the panel and across its edges; the indicator
+ * is increased for the skinny and low-angle panels found by TriMesh::checkPanels(). The panels with the largest
+ * indicators are refined, and the next iteration starts from the interpolated doublet densities if the polar uses the
+ * iterative solver. The loop stops when the relative changes of CL, CD and Cm are less than the tolerance.
+ *
+ * The structured meshes of the xfl-type planes are refined through their mesh parameters, so that their strips and
+ * stations remain consistent: the sections which hold the largest indicators have their spanwise panel count increased,
+ * and the chordwise count of the wing is increased if the error is concentrated near the leading edge.
+ * The meshes of the other planes are refined locally with TriMesh::refinePanels().
+ * The plane's mesh is modified in place.
+ */
+class FL5LIB_EXPORT AdaptiveMesh
+{
+    public:
+        /** The results of one iteration */
+        struct Step
+        {
+            int m_nPanels{0};
+            double m_CL{0}, m_CD{0}, m_Cm{0};
+            double m_Change{0};      /**< the largest relative change of CL, CD and Cm from the previous iteration */
+            int m_nRefined{0};       /**< the number of panels, or of sections, refined after this iteration */
+        };
+
+    public:
+        AdaptiveMesh();
+
+        void setObjects(Plane *pPlane, PlanePolar const *pPolar) {m_pPlane=pPlane; m_pPolar=pPolar;}
+        void setOperatingPoint(double alpha, double beta=0.0) {m_Alpha=alpha; m_Beta=beta;}
+        /** Sets the max. relative change of CL, CD and Cm between two iterations at convergence */
+        void setTolerance(double tol) {m_Tolerance=tol;}
+        void setMaxIterations(int n) {m_MaxIter=std::max(1,n);}
+        /** Sets the mesh size above which the loop stops without refining */
+        void setMaxPanels(int n) {m_MaxPanels=n;}
+        /** Sets the fraction of the panels with the largest indicators which is refined at each iteration */
+        void setRefinedFraction(double f) {m_Fraction=std::min(std::max(f, 0.01), 1.0);}
+        void setMinAngle(double angle) {m_MinAngle=angle;}
+
+        bool run();
+
+        bool isConverged() const {return m_bConverged;}
+        std::vector<Step> const &history() const {return m_History;}
+        std::string const &log() const {return m_Log;}
+
+    private:
+        struct Solution
+        {
+            bool m_bValid{false};
+            double m_CL{0}, m_CD{0}, m_Cm{0};
+            std::vector<double> m_Cp;     /**< the Cp at the vertices, 3 per panel */
+            std::vector<double> m_Mu;     /**< the doublet densities at the vertices, 3 per panel */
+        };
+
+        bool solve(std::vector<double> const &initialguess, Solution &solution);
+        void makeIndicator(Solution const &solution, std::vector<double> &eta) const;
+        int refineMesh(std::vector<double> const &eta, Solution const &solution, std::vector<double> &initialguess);
+        int refineSections(PlaneXfl *pPlaneXfl, std::vector<double> const &eta);
+
+    private:
+        Plane *m_pPlane;
+        PlanePolar const *m_pPolar;
+        double m_Alpha, m_Beta;
+
+        double m_Tolerance;
+        int m_MaxIter;
+        int m_MaxPanels;
+        double m_Fraction;
+        double m_MinAngle;          /**< the vertex angle below which a panel's indicator is increased, in degrees */
+
+        bool m_bConverged;
+        std::vector<Step> m_History;
+        std::string m_Log;
+};
+
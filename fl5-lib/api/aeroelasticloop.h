@@ -0,0 +1,146 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <fl5lib_global.h>
+#include <quadmesh.h>
+#include <trimesh.h>
+#include <vector3d.h>
+
+class PlaneXfl;
+class PlanePolar;
+class SpanDistribs;
+
+
+/**
+ * @class AeroelasticLoop
+ * @brief Solves the static aeroelastic equilibrium of the flexible wings of a plane at one operating point.
+ *
+ * Each flexible wing is modelled as a clamped beam along its span, with the bending stiffness EI and the torsional
+ * stiffness GJ varying linearly from the root to the tip, and its elastic axis at a fixed fraction of the chord.
+ * Each iteration solves the operating point with a T8 copy of the polar, integrates the strip lift and the pitching
+ * moments about the elastic axis along each half-wing to make the deflection and the twist of the beam, and moves
+ * the nodes of the wing's panels accordingly. The deflection is under-relaxed, and the loop stops when its change
+ * from one iteration to the next is less than the tolerance.
+ *
+ * The topology of the mesh is not modified: the panels are rebuilt from the displaced nodes, so that no remeshing
+ * is required, and the LU factors of the previous factorization are used to solve the deformed system by defect
+ * correction, see PanelAnalysis::setFrozenFactorization(). An iteration then costs the matrix assembly and a few
+ * back-substitutions. If the correction does not converge, the deformed system is factorized and becomes the reference
+ * of the next iterations.
+ *
+ * The reference meshes of the plane are left in the deformed shape; restoreRigidMesh() restores the initial meshes.
+ * The fins are treated as rigid.
+ */
+class FL5LIB_EXPORT AeroelasticLoop
+{
+    public:
+        /** The structural model of a wing */
+        struct Beam
+        {
+            double m_EI{0};          /**< the bending stiffness at the root, in N.m²; the wing is rigid if zero */
+            double m_GJ{0};          /**< the torsional stiffness at the root, in N.m²; no twist if zero */
+            double m_TipRatio{1.0};  /**< the ratio of the tip stiffnesses to the root stiffnesses */
+            double m_xEA{0.35};      /**< the position of the elastic axis, in fraction of the chord */
+        };
+
+        /** The results of one iteration */
+        struct Step
+        {
+            double m_CL{0}, m_CD{0}, m_Cm{0};
+            double m_TipDeflection{0};  /**< the largest tip deflection of the flexible wings, in m */
+            double m_TipTwist{0};       /**< the tip twist of the same wing, in degrees, positive nose-up */
+            double m_Change{0};         /**< the largest change of the deflection relative to the half-span, or of the twist in radians */
+            bool m_bReusedLU{false};    /**< true if the system was solved with the factors of a previous iteration */
+        };
+
+    public:
+        AeroelasticLoop();
+
+        void setObjects(PlaneXfl *pPlaneXfl, PlanePolar const *pPolar) {m_pPlaneXfl=pPlaneXfl; m_pPolar=pPolar;}
+        void setOperatingPoint(double alpha, double beta, double QInf) {m_Alpha=alpha; m_Beta=beta; m_QInf=QInf;}
+        void setBeam(int iWing, Beam const &beam);
+        void setTolerance(double tol) {m_Tolerance=tol;}
+        void setMaxIterations(int n) {m_MaxIter=std::max(1,n);}
+        /** Sets the fraction of the change of the deflection which is applied at each iteration */
+        void setRelaxation(double f) {m_Relaxation=std::min(std::max(f, 0.05), 1.0);}
+
+        bool run();
+        void restoreRigidMesh();
+
+        bool isConverged() const {return m_bConverged;}
+        std::vector<Step> const &history() const {return m_History;}
+        std::string const &log() const {return m_Log;}
+
+    private:
+        /** A span station of one half-wing */
+        struct Station
+        {
+            double m_s{0};            /**< the planform distance to the root */
+            double m_d{0};            /**< the distance of the quarter-chord point to the root in the y direction */
+            double m_xEA{0}, m_zEA{0};
+            double m_w{0};            /**< the deflection, in m */
+            double m_Theta{0};        /**< the twist, in radians, positive nose-up */
+        };
+
+        /** The deformed shape of a wing */
+        struct Shape
+        {
+            bool m_bFlexible{false};
+            double m_yRoot{0};
+            double m_HalfSpan{0};
+            std::vector<int> m_Strip[2];        /**< the strip indexes of the right and left half-wings, from root to tip */
+            std::vector<Station> m_Station[2];
+        };
+
+        bool makeShape(int iw, SpanDistribs const &span, Shape &shape) const;
+        void solveBeam(int iw, SpanDistribs const &span, double q, Shape &shape, double &change) const;
+        Vector3d deformedPoint(Shape const &shape, Vector3d const &P) const;
+        void deformMesh(std::vector<Shape> const &shapes);
+
+    private:
+        PlaneXfl *m_pPlaneXfl;
+        PlanePolar const *m_pPolar;
+        double m_Alpha, m_Beta, m_QInf;
+        std::vector<Beam> m_Beam;
+
+        double m_Tolerance;
+        int m_MaxIter;
+        double m_Relaxation;
+
+        bool m_bConverged;
+        std::vector<Step> m_History;
+        std::string m_Log;
+
+        bool m_bHasRigidMesh;
+        TriMesh m_RigidTriMesh;
+        QuadMesh m_RigidQuadMesh;
+};
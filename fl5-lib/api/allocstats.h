@@ -0,0 +1,46 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+#include <fl5lib_global.h>
+
+
+/**
+ * @class AllocStats
+ * @brief The count of the heap allocations of the process, to check that the steady iterations of the analyses do not allocate.
+ *
+ * The counts are only made when fl5-lib is built with FL5_ALLOC_STATS, which replaces the global operators new and delete.
+ * The replacement applies to the whole process on Linux and macOS; on Windows it only sees the allocations made by fl5-lib.
+ * The counters are process-wide, so that the allocations of the pool's workers are accounted to the phase which runs them.
+ */
+class FL5LIB_EXPORT AllocStats
+{
+    public:
+        static bool isCompiled();
+        static int64_t count();
+        static int64_t bytes();
+};
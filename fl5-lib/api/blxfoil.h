@@ -25,42 +25,71 @@
 #pragma once
 
 
+#include <vector>
+
 #include <QDataStream>
 
 #include <xfoil_params.h>
 
 
+/**
+ * A [station][side] array of boundary layer values which only stores the stations in use,
+ * with the same indexing as XFoil's fixed [IVX][ISX] arrays.
+ */
+class BLArray
+{
+    public:
+        void assign(double const values[][ISX], int nStations) {m_Value.assign(&values[0][0], &values[0][0]+nStations*ISX);}
+        void clear() {m_Value.clear(); m_Value.shrink_to_fit();}
+
+        int nStations() const {return int(m_Value.size())/ISX;}
+        bool isEmpty() const {return m_Value.empty();}
+        size_t bytes() const {return m_Value.capacity()*sizeof(double);}
+
+        double *operator[](int ibl) {return m_Value.data()+ibl*ISX;}
+        double const *operator[](int ibl) const {return m_Value.data()+ibl*ISX;}
+        double *data() {return m_Value.data();}
+
+    private:
+        std::vector<double> m_Value;
+};
+
+
 struct BLXFoil
 {
     public:
         BLXFoil();
 
+        void clearStations();
+        bool hasStations() const {return !uedg.isEmpty();}
+        size_t memoryFootprint() const;
+
         int nd1;                    /**< the number of top side BL points  */
         int nd2;                    /**< the number of bot side BL points  */
         int nd3;                    /**< the number of wake side BL points */
         int nside1, nside2;
 
-        double xd1[IVX];            /**< x-coordinate of the first part of the boundary layer */
-        double yd1[IVX];            /**< y-coordinate of the first part of the boundary layer */
-        double xd2[IVX];            /**< x-coordinate of the second part of the boundary layer */
-        double yd2[IVX];            /**< y-coordinate of the second part of the boundary layer */
-        double xd3[IWX];            /**< x-coordinate of the third part of the boundary layer */
-        double yd3[IWX];            /**< y-coordinate of the third part of the boundary layer */
+        std::vector<double> xd1;    /**< x-coordinate of the first part of the boundary layer */
+        std::vector<double> yd1;    /**< y-coordinate of the first part of the boundary layer */
+        std::vector<double> xd2;    /**< x-coordinate of the second part of the boundary layer */
+        std::vector<double> yd2;    /**< y-coordinate of the second part of the boundary layer */
+        std::vector<double> xd3;    /**< x-coordinate of the third part of the boundary layer */
+        std::vector<double> yd3;    /**< y-coordinate of the third part of the boundary layer */
 
 
         double tklam;               /**< Karman-Tsien parameter minf^2 / [1 + sqrt[1-minf^2]]^2 */
         double qinf;                /**< freestream velocity, usually 1 */
-        double dstr[IVX][ISX];      /**< bl displacement thickness array */
-        double delt[IVX][ISX];      /**< the boundary layer thickness? */
-        double thet[IVX][ISX];      /**< bl momentum thickness array */
-        double tau[IVX][ISX];       /**< wall shear stress array                 [for plotting only] */
-        double dis[IVX][ISX];       /**< dissipation array                       [for plotting only] */
-        double ctau[IVX][ISX];      /**< sqrt[max shear coefficient] array */
-        double ctq[IVX][ISX];       /**< sqrt[equilibrium max shear coefficient] array [  "  ] */
-        double uedg[IVX][ISX];      /**< bl edge velocity array */
-        double xbl[IVX][ISX];       /**< x-coordinate of bl variables */
-        double Hk[IVX][ISX];        /**< Kinematic shape parameter */
-        double RTheta[IVX][ISX];    /**< Momentum thickness Reynolds number */
+        BLArray dstr;               /**< bl displacement thickness array */
+        BLArray delt;               /**< the boundary layer thickness? */
+        BLArray thet;               /**< bl momentum thickness array */
+        BLArray tau;                /**< wall shear stress array                 [for plotting only] */
+        BLArray dis;                /**< dissipation array                       [for plotting only] */
+        BLArray ctau;               /**< sqrt[max shear coefficient] array */
+        BLArray ctq;                /**< sqrt[equilibrium max shear coefficient] array [  "  ] */
+        BLArray uedg;               /**< bl edge velocity array */
+        BLArray xbl;                /**< x-coordinate of bl variables */
+        BLArray Hk;                 /**< Kinematic shape parameter */
+        BLArray RTheta;             /**< Momentum thickness Reynolds number */
 
         int itran[ISX];                  /**< bl array index of transition interval */
 
@@ -38,7 +38,9 @@ class FL5LIB_EXPORT BoatOpp : public Opp3d
     public:
         BoatOpp();
         BoatOpp(Boat *pBoat, BoatPolar *pBtPolar, int nPanel3, int nPanel4);
-        bool serializeBoatOppFl5(QDataStream &ar, bool bIsStoring);
+        bool serializeBoatOppFl5(QDataStream &ar, bool bIsStoring, bool bDeferFields=false);
+
+        size_t memoryFootprint() const override;
         void getProperties(const Boat *pBoat, double density, std::string &props, bool bLongOutput=false) const;
 
         std::string const &boatName() const {return m_BoatName;}
@@ -57,6 +57,8 @@ class FL5LIB_EXPORT BoatPolar : public Polar3d
 
         bool serializeFl5v726(QDataStream &ar, bool bIsStoring) override;
         bool serializeFl5v750(QDataStream &ar, bool bIsStoring) override;
+
+        size_t memoryFootprint() const;
         void clearData();
 
         void addPoint(const BoatOpp *pBtOpp);
@@ -73,7 +73,12 @@ class FL5LIB_EXPORT BoatTask : public Task3d
 
     private:
         void makeVortonRow(int qrhs) override;
+        void geometryKey(double ctrl, std::vector<double> &key) const;
+        void groupByGeometry(std::vector<int> &order) const;
+        void makeApparentWindField(double ctrl, std::vector<Vector3d> &AWS) const;
+        int solveGeometryGroup(std::vector<int> const &order, int q0, std::vector<double> const &key, std::vector<double> &solutions);
         void computeInducedForces(double alpha, double beta, double QInf);
+        Vector3d sailForceFF(double alpha, double beta, double QInf);
         void computeInducedDrag(double alpha, double beta, double QInf, int qrhs,
                                 std::vector<Vector3d> &WingForce, std::vector<SpanDistribs> &SpanDist) const;
 
@@ -44,6 +44,7 @@ class FL5LIB_EXPORT BSpline : public Spline
         bool serializeFl5(QDataStream &ar, bool bIsStoring) override;
 
         Vector2d splinePoint(double u) const override;
+        void splinePoints(double const *u, int n, Vector2d *pt) const override;
         void splineDerivative(double u, double &dx, double &dy) const override;
 
         bool splineKnots();
@@ -58,6 +59,11 @@ class FL5LIB_EXPORT BSpline : public Spline
         static void testApproximation();
         static void testSmooth();
 
+    private:
+        bool hasClampedKnots() const;
+        Vector2d splinePoint_ref(double t) const;
+        void splineDerivative_ref(double t, double &dx, double &dy) const;
+
     private:
         std::vector<double> m_knot;            /**< the array of the values of the spline's knot */
         int m_degree;                   /**< the spline's degree */
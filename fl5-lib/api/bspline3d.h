@@ -71,6 +71,7 @@ class FL5LIB_EXPORT BSpline3d
         void resetSpline();
         bool updateSpline();
         void splinePoint(double t, Vector3d &pt) const;
+        void splinePoints(double const *t, int n, Vector3d *pt) const;
         void splineDerivative(double t, Vector3d &der) const;
         void splineDerivative(BSpline3d &der) const;
         void makeCurve();
@@ -113,6 +114,8 @@ class FL5LIB_EXPORT BSpline3d
 
     private:
         bool splineKnots();
+        bool hasClampedKnots() const;
+        void splinePoint_ref(double t, Vector3d &pt) const;
 
     private:
         int m_iHighlight;                /**< the index of the currently highlighted control point, i.e. the point over which the mouse hovers, or -1 of none. */
@@ -0,0 +1,96 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+class QFile;
+class Polar;
+class PlanePolar;
+class BoatPolar;
+class Opp3d;
+
+
+/**
+ * @class ColumnFile
+ * @brief Writes and reads the results as typed columns in a binary file.
+ *
+ * The file starts with the 8 byte signature "FL5COLS" and the int32 format number, followed by a
+ * sequence of records. All the numbers are little-endian.
+ *  - a text record: int32 kind=0, the name and the value.
+ *  - a dataset record: int32 kind=1, the name, int32 rows, int32 columns, and the rows*columns
+ *    float64 values in row order. A polar variable is a dataset with one column.
+ * The names and text values are stored as an int32 byte count followed by the UTF-8 bytes.
+ * The datasets can be read without parsing, e.g. with numpy.fromfile() at the record's offset.
+ */
+class FL5LIB_EXPORT ColumnFile
+{
+    public:
+        enum enumRecord {TEXT, DATASET};
+
+        /** A record read from a file */
+        struct Record
+        {
+            enumRecord m_Kind{DATASET};
+            std::string m_Name;
+            std::string m_Text;
+            int m_nRows{0};
+            int m_nCols{0};
+            std::vector<double> m_Values;
+        };
+
+    public:
+        ColumnFile();
+        ~ColumnFile();
+
+        bool open(std::string const &pathname);
+        bool close();
+
+        bool writeText(std::string const &name, std::string const &value);
+        bool writeDataset(std::string const &name, double const *values, int nRows, int nCols=1);
+        bool writeColumn(std::string const &name, std::vector<double> const &values) {return writeDataset(name, values.data(), int(values.size()), 1);}
+
+        static bool readFile(std::string const &pathname, std::vector<Record> &records);
+
+        static bool exportPolar(std::string const &pathname, Polar const &polar);
+        static bool exportPlanePolar(std::string const &pathname, PlanePolar const &plpolar, std::vector<Opp3d const*> const &opps = {});
+        static bool exportBoatPolar(std::string const &pathname, BoatPolar const &btpolar, std::vector<Opp3d const*> const &opps = {});
+        static bool importPolar(std::string const &pathname, Polar &polar);
+
+    private:
+        bool writeInt(int value);
+        bool writeString(std::string const &str);
+        bool writeOppsCp(std::vector<Opp3d const*> const &opps);
+
+    private:
+        QFile *m_pFile;
+        bool m_bError;
+};
+
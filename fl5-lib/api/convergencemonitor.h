@@ -0,0 +1,124 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+
+/**
+ * @struct ResidualSample
+ * @brief The state of an iterative solver after one of its iterations.
+ *
+ * The meaning of the fields depends on the solver:
+ *  - XFOIL: the change of the BL variables from the Newton step; the location is the BL station and the side is 1 for the top, 2 for the bottom
+ *  - VISCOUSLOOP: the virtual twist correction of the plane's stations, in degrees; the location is the plane station
+ *  - LLT: the change of the induced angles, in radians; the location is the LLT station
+ */
+struct ResidualSample
+{
+    enum enumSolver {XFOIL, VISCOUSLOOP, LLT};
+
+    enumSolver m_Solver{XFOIL};
+    double m_Ctrl{0.0};       /**< the aoa, Cl or control parameter of the operating point being computed */
+    int m_Iter{0};            /**< the index of the iteration, from 0 */
+    double m_Rms{0.0};        /**< the rms of the change */
+    double m_Max{0.0};        /**< the max abs of the change */
+    int m_MaxLocation{-1};    /**< the index of the station of max change */
+    int m_MaxSide{0};         /**< the BL side of max change, 0 if not applicable */
+    double m_Relax{1.0};      /**< the relaxation factor applied to the change */
+    double m_Value{0.0};      /**< the monitored coefficient: Cl for XFoil, CL for the viscous loop, none for the LLT */
+};
+
+
+/**
+ * @class ConvergenceMonitor
+ * @brief The interface through which the iterative solvers report each iteration and let a supervisor stop the point.
+ *
+ * The monitor is called from the solver's thread, and may be shared by tasks running concurrently.
+ * The XFoil tasks honour RESEED by reinitializing the BL from the inviscid solution;
+ * the other solvers treat it as ABORT. An aborted point is reported as unconverged.
+ */
+class FL5LIB_EXPORT ConvergenceMonitor
+{
+    public:
+        enum enumAction {CONTINUE, ABORT, RESEED};
+
+    public:
+        virtual ~ConvergenceMonitor() = default;
+
+        virtual enumAction onIteration(ResidualSample const &sample) = 0;
+        virtual void onPointEnd(ResidualSample::enumSolver, double /*ctrl*/, bool /*bConverged*/, int /*nIter*/) {}
+};
+
+
+/**
+ * @class StagnationMonitor
+ * @brief A ConvergenceMonitor which records the residual histories and stops the points which stagnate.
+ *
+ * A point is stagnating when the rms has not been reduced by the given factor over the last window of iterations.
+ * It is then reseeded once if requested, and aborted otherwise.
+ * The histories are recorded per thread, so that the instance can be shared by concurrent tasks.
+ */
+class FL5LIB_EXPORT StagnationMonitor : public ConvergenceMonitor
+{
+    public:
+        struct History
+        {
+            ResidualSample::enumSolver m_Solver{ResidualSample::XFOIL};
+            double m_Ctrl{0.0};
+            bool m_bConverged{false};
+            int m_nReseeds{0};
+            int m_iWindowStart{0};       /**< the index of the first sample since the last reseed */
+            bool m_bAborted{false};
+            std::vector<ResidualSample> m_Sample;
+        };
+
+    public:
+        StagnationMonitor(int window=10, double reduction=0.5, bool bReseed=true);
+
+        void setRecording(bool bRecord) {m_bRecord=bRecord;}
+
+        enumAction onIteration(ResidualSample const &sample) override;
+        void onPointEnd(ResidualSample::enumSolver solver, double ctrl, bool bConverged, int nIter) override;
+
+        std::vector<History> histories() const;
+        int nAborted() const;
+        void clear();
+
+    private:
+        int m_Window;
+        double m_Reduction;
+        bool m_bReseed;
+        bool m_bRecord;
+
+        std::map<std::thread::id, History> m_Active;   /**< the point being computed by each thread */
+        std::vector<History> m_Done;
+        mutable std::mutex m_Mutex;
+};
@@ -50,6 +50,7 @@ class FL5LIB_EXPORT CubicSpline : public Spline
 
         bool serializeFl5(QDataStream &ar, bool bIsStoring) override;
         Vector2d splinePoint(double u) const override;
+        void splinePoints(double const *u, int n, Vector2d *pt) const override;
         void splineDerivative(double u, double &dx, double &dy) const override;
 
         void buildMatrix(int size, int coordinate, double *aij, double *RHS);
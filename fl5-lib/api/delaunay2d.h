@@ -0,0 +1,152 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <fl5lib_global.h>
+#include <vector2d.h>
+#include <vector3d.h>
+
+class PSLG2d;
+class Triangle2d;
+
+
+/**
+ * @class Delaunay2d
+ * @brief A constrained Delaunay triangulator of planar straight line graphs, with Ruppert refinement to size and angle targets.
+ *
+ * The PSLG vertices are inserted with the Bowyer-Watson algorithm in a biased randomized insertion order, i.e. in rounds
+ * of doubling size each sorted along a Hilbert curve, so that the walk which locates each new point from the last
+ * triangle made is a few steps long and the triangulation costs O(n.log(n)).
+ * The segments are then recovered by edge flips and the triangles are marked inside the domain by a flood fill which
+ * starts on the left of the segments and stops at the segments; hence the segments must be oriented with the domain on
+ * their left, i.e. counter-clockwise for the contours and clockwise for the holes.
+ *
+ * The refinement inserts the circumcentre of the triangles which are too large or too skinny. If the circumcentre is
+ * beyond, or too close to, a segment, the segment is split at its midpoint instead if it is splittable; the segments of
+ * a PSLG which is not splittable are never modified, so that the vertices are the same on the edges shared by two faces.
+ *
+ * If a mapping is set, the sizes of the triangles are measured on the mapped triangles, e.g. on the 3d surface of which
+ * the PSLG is the parametric contour. The Delaunay criterion and the angles remain the ones of the plane, so that the
+ * parameters should be scaled to make the mapping close to isotropic.
+ */
+class FL5LIB_EXPORT Delaunay2d
+{
+    public:
+        Delaunay2d();
+
+        /** Sets the max. length of the triangle edges, in the units of the mapping if any; 0 for no size target */
+        void setMaxEdgeLength(double length) {m_MaxLength=length;}
+        /** Sets the min. angle of the triangles, in degrees; values above 30 degrees may not converge */
+        void setMinAngle(double angle) {m_MinAngle=std::max(0.0, std::min(angle, 34.0));}
+        void setMaxTriangles(int n) {m_MaxTriangles=n;}
+        void setMapping(std::function<Vector3d(double,double)> const &mapping) {m_Mapping=mapping;}
+
+        bool triangulate(std::vector<PSLG2d> const &pslgs, bool bRefine=true);
+
+        int nNodes() const {return int(m_Nodes.size());}
+        Vector2d const &node(int i) const {return m_Nodes.at(i);}
+        std::vector<Vector2d> const &nodes() const {return m_Nodes;}
+        int nTriangles() const {return int(m_Triangles.size());}
+        /** @return the node indices of the triangle, counter-clockwise */
+        std::array<int,3> const &triangle(int i) const {return m_Triangles.at(i);}
+        void makeTriangles(std::vector<Triangle2d> &triangles) const;
+
+        int nSplitSegments() const {return m_nSplitSegments;}
+        std::string const &log() const {return m_Log;}
+
+    private:
+        /** The vertex i is opposite the edge i, which joins the vertices i+1 and i+2 */
+        struct Tri
+        {
+            int m_v[3]{-1,-1,-1};
+            int m_n[3]{-1,-1,-1};        /**< the neighbour across each edge, or -1 */
+            char m_c[3]{0,0,0};          /**< 0 if the edge is free, 1 if it is a fixed segment, 2 if a splittable segment */
+            bool m_bInside{false};
+            bool m_bAlive{false};
+            bool m_bAccepted{false};     /**< true if the triangle cannot be refined without splitting a fixed segment */
+        };
+
+        struct Segment
+        {
+            int m_a{-1}, m_b{-1};
+            char m_c{1};
+        };
+
+        void clear();
+        void makeSuperTriangle();
+        void insertionOrder(std::vector<Vector2d> const &pts, std::vector<int> &order) const;
+        int locate(Vector2d const &pt, int tstart) const;
+        int insertPoint(Vector2d const &pt, int tstart, int tsplit=-1, int isplit=-1);
+        int newTriangle();
+        void flip(int t, int i);
+        int edgeTriangle(int a, int b, int &iedge) const;
+        void setSegmentFlag(int t, int i, char c);
+        bool recoverSegment(Segment const &seg, std::vector<Segment> &pending);
+        bool markInside();
+        void refine();
+        bool refineTriangle(int t);
+        int walkTo(int t, Vector2d const &pt, int &iblocked) const;
+        int encroachedSegment(int t, Vector2d const &pt, int &iedge) const;
+        bool isBad(int t) const;
+        Vector3d const &mapped(int iv) const;
+        void makeOutput();
+
+        bool inCircle(int t, Vector2d const &p) const;
+        Vector2d circumCentre(int t) const;
+
+    private:
+        double m_MaxLength;
+        double m_MinAngle;
+        int m_MaxTriangles;
+        double m_MinLength;          /**< the triangles with a shorter edge are not refined for their angles */
+        std::function<Vector3d(double,double)> m_Mapping;
+
+        Vector2d m_Origin;           /**< the points are stored in the unit box to make the tolerances absolute */
+        double m_Scale;
+
+        std::vector<Vector2d> m_Pt;                 /**< the points in the unit box; the first three are the vertices of the super-triangle */
+        mutable std::vector<Vector3d> m_Mapped;     /**< the mapped points, evaluated on demand */
+        mutable std::vector<bool> m_bMapped;
+        std::vector<int> m_VtxTri;                  /**< a triangle incident to each point */
+        std::vector<Tri> m_Tri;
+        std::vector<int> m_FreeTri;
+        std::vector<Segment> m_Seg;                 /**< the recovered segments, oriented */
+        std::vector<int> m_NewTri;                  /**< the triangles made by the last insertion */
+        int m_Last;                                 /**< the last triangle made, from which the next point is located */
+        int m_nInside;
+        int m_nSplitSegments;
+
+        std::vector<Vector2d> m_Nodes;
+        std::vector<std::array<int,3>> m_Triangles;
+        std::string m_Log;
+};
@@ -0,0 +1,79 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <fl5lib_global.h>
+
+
+/**
+ * @class DistributedSolver
+ * @brief The dense LU factorization and back-substitutions of a linear system distributed over the ranks of an MPI job.
+ *
+ * All the ranks run the same analysis: each one builds the same mesh and the same RHS, and computes only the coefficients
+ * of its own tiles of the matrix in ScaLAPACK's two-dimensional block-cyclic layout, so that no rank holds the full matrix.
+ * The matrix is factorized with pdgetrf, and the solutions of pdgetrs are gathered on all the ranks, so that the
+ * post-processing of the doublet densities continues unchanged on each of them, and on rank 0 in particular.
+ * The factors are kept for the back-substitutions of all the subsequent RHS, until release() is called.
+ *
+ * The calls are collective: they must be made in the same order on all the ranks, i.e. with one analysis at a time.
+ * The application is responsible for MPI_Init() and MPI_Finalize().
+ * The MPI code is only compiled with FL5_MPI defined; otherwise isAvailable() returns false and the callers use the
+ * local solvers.
+ */
+class FL5LIB_EXPORT DistributedSolver
+{
+    public:
+        DistributedSolver();
+        ~DistributedSolver();
+
+        static bool isAvailable();
+        static int rank();
+        static int nRanks();
+        static size_t localBytes(int n);
+        /** Sets the size of the square tiles of the block-cyclic layout */
+        static void setBlockSize(int nb) {s_BlockSize = nb<8 ? 8 : nb;}
+        static int blockSize() {return s_BlockSize;}
+
+        bool factorize(int n, std::function<double(int,int)> const &coef);
+        bool solve(bool bTranspose, double *B, int nRHS);
+        void release();
+
+        /** @return true if the local tiles hold the factors of a matrix of size n */
+        bool isFactorized(int n) const {return m_N==n && n>0;}
+
+    private:
+        struct GridData;
+        std::unique_ptr<GridData> m_pData;
+
+        int m_N;            /**< the size of the factorized matrix, 0 if none */
+
+        static int s_BlockSize;
+};
+
@@ -0,0 +1,121 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <fl5lib_global.h>
+#include <vector3d.h>
+
+class PanelAnalysis;
+
+
+/**
+ * @class FieldSampler
+ * @brief Samples the velocity, the vorticity and the pressure coefficient of a solved operating point on a regular grid.
+ *
+ * The grid is defined by an origin, three orthogonal unit axes and the number of nodes and the spacing along each axis;
+ * a slice plane is a grid with a single node along its third axis. The nodes are stored with the u index varying fastest.
+ * The grid is sampled one w-slab at a time; the velocities of each slab are evaluated in blocks on the ThreadPool
+ * with the batched kernel PanelAnalysis::getVelocityVectors(), so that the panel loop is outermost.
+ * The vorticity is the curl of the sampled velocity field by central differences, and is available for a slab
+ * once its neighbours have been sampled.
+ *
+ * The sampling may run in a background thread; the slab callback is then called from that thread each time
+ * a slab is complete, so that the caller can stream the results, e.g. to a GPU texture.
+ * The analysis must have been initialized with the mesh, the polar and the vortons of the operating point,
+ * and must not be modified while the sampling is running.
+ */
+class FL5LIB_EXPORT FieldSampler
+{
+    public:
+        FieldSampler();
+        ~FieldSampler();
+
+        void setAnalysis(PanelAnalysis const *pAnalysis, double const *mu, double const *sigma, Vector3d const &VInf);
+        void setGrid(Vector3d const &origin, Vector3d const &u, Vector3d const &v, Vector3d const &w,
+                     int nu, int nv, int nw, double du, double dv, double dw);
+        void setSlice(Vector3d const &origin, Vector3d const &u, Vector3d const &v, int nu, int nv, double du, double dv);
+
+        void setSlabCallback(std::function<void(int)> const &callback) {m_SlabCallback=callback;}
+
+        void run();
+        void start();
+        void wait();
+        void cancel() {m_bCancel=true;}
+        bool isRunning() const {return m_bRunning;}
+        bool isCancelled() const {return m_bCancel;}
+        int nSlabsDone() const {return m_nSlabsDone;}
+
+        int nu() const {return m_nu;}
+        int nv() const {return m_nv;}
+        int nw() const {return m_nw;}
+        int nNodes() const {return m_nu*m_nv*m_nw;}
+        int index(int iu, int iv, int iw) const {return (iw*m_nv+iv)*m_nu+iu;}
+
+        Vector3d node(int iu, int iv, int iw) const;
+        Vector3d const &velocity(int idx)  const {return m_Velocity.at(idx);}
+        Vector3d const &vorticity(int idx) const {return m_Vorticity.at(idx);}
+        double cp(int idx) const {return m_Cp.at(idx);}
+
+        std::vector<Vector3d> const &velocities()  const {return m_Velocity;}
+        std::vector<Vector3d> const &vorticities() const {return m_Vorticity;}
+        std::vector<double>   const &cps()         const {return m_Cp;}
+
+        void packTexels(int iw0, int nSlabs, float *texels) const;
+
+    private:
+        void sampleSlab(int iw);
+        void makeVorticitySlab(int iw);
+        Vector3d derivative(int iu, int iv, int iw, int iAxis) const;
+
+    private:
+        PanelAnalysis const *m_pAnalysis;
+        double const *m_Mu;
+        double const *m_Sigma;
+        Vector3d m_VInf;
+
+        Vector3d m_Origin;
+        Vector3d m_Axis[3];      /**< the unit vectors of the grid's axes */
+        double m_Step[3];        /**< the node spacing along each axis */
+        int m_nu, m_nv, m_nw;
+
+        std::vector<Vector3d> m_Velocity;   /**< the perturbation velocities, without the freestream */
+        std::vector<Vector3d> m_Vorticity;
+        std::vector<double> m_Cp;
+
+        std::function<void(int)> m_SlabCallback;
+
+        std::thread m_Thread;
+        std::atomic<bool> m_bRunning;
+        std::atomic<bool> m_bCancel;
+        std::atomic<int> m_nSlabsDone;
+
+        static int s_BlockSize;
+};
+
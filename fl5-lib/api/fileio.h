@@ -29,6 +29,7 @@
 
 #include <fl5lib_global.h>
 
+class QFile;
 class Foil;
 class Plane;
 class Polar;
@@ -44,6 +45,7 @@ class FL5LIB_EXPORT FileIO : public QObject
 
     public:
         bool serializeProjectFl5(QDataStream &ar, bool bIsStoring);
+        bool loadProjectFl5(QFile &XFile);
         int serializeProjectMetaDataFl5(QDataStream &ar, bool bIsStoring);
 
 
@@ -56,6 +56,9 @@ class FL5LIB_EXPORT fl5Object : public XflObject
         TriMesh & refTriMesh()                  {return m_RefTriMesh;}
         virtual void restoreMesh() {m_TriMesh = m_RefTriMesh;}
 
+        /** the memory used by the object, in bytes; the meshes account for most of it */
+        virtual size_t memoryFootprint() const {return sizeof(*this) + m_RefTriMesh.memoryFootprint() + m_TriMesh.memoryFootprint();}
+
 
 
         std::vector<Panel3> &triPanels()             {return m_TriMesh.panels();}
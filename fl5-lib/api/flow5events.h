@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 #include <QEvent>
 
@@ -43,6 +44,7 @@ const QEvent::Type MESH_UPDATE_EVENT         = static_cast<QEvent::Type>(QEvent:
 const QEvent::Type MESH2D_UPDATE_EVENT       = static_cast<QEvent::Type>(QEvent::User + 114);
 const QEvent::Type LLT_OPP_EVENT             = static_cast<QEvent::Type>(QEvent::User + 115);
 const QEvent::Type TASK3D_END_EVENT        = static_cast<QEvent::Type>(QEvent::User + 116);
+const QEvent::Type XFOIL_JOB_END_EVENT     = static_cast<QEvent::Type>(QEvent::User + 117);
 
 
 
@@ -145,3 +147,22 @@ class FL5LIB_EXPORT XFoilTaskEvent : public QEvent
         XFoilTask *m_pXFoilTask = nullptr;
 };
 
+
+/** Posted when a job of an XFoilBatchEngine has finished; the receiver takes ownership of the operating points */
+class FL5LIB_EXPORT XFoilJobEvent : public QEvent
+{
+    public:
+        XFoilJobEvent(std::string const &foilname, std::string const &polarname, std::vector<OpPoint*> const &opps):
+            QEvent(XFOIL_JOB_END_EVENT), m_FoilName(foilname), m_PolarName(polarname), m_OpPoints(opps)
+        {
+        }
+
+        std::string const &foilName()  const {return m_FoilName;}
+        std::string const &polarName() const {return m_PolarName;}
+        std::vector<OpPoint*> const &operatingPoints() const {return m_OpPoints;}
+
+    private:
+        std::string m_FoilName, m_PolarName;
+        std::vector<OpPoint*> m_OpPoints;
+};
+
@@ -80,6 +80,7 @@ class FL5LIB_EXPORT Foil : public XflObject
         void rebuildPointSequenceFromBase();
 
         bool rePanel(int NPanels, double amplitude);
+        void setTEGap(double gap, double blendLength);
         double normalizeGeometry();
         double deRotate();
 
@@ -134,7 +135,9 @@ class FL5LIB_EXPORT Foil : public XflObject
         void scaleHingeLocations(); // cleaning old files
 
         bool serializeXfl(QDataStream &ar, bool bIsStoring);
-        bool serializeFl5(QDataStream &ar, bool bIsStoring);
+        bool serializeFl5(QDataStream &ar, bool bIsStoring, bool bBaseNodes=true);
+
+        size_t memoryFootprint() const;
 
         void interpolate(Foil const *pFoil1, Foil const *pFoil2, double frac);
 
@@ -181,6 +184,7 @@ class FL5LIB_EXPORT Foil : public XflObject
 
         void resizeBaseArrays(int size) {m_BaseTop.resize(size); m_BaseBot.resize(size);}
 
+        std::vector<Node2d> const &baseNodes() const {return m_BaseNode;}
         void setBaseNodes(std::vector<Node2d> const &Nodes) {m_BaseNode=Nodes;}
 //        void setBaseNodes(std::vector<Node2d> const &Nodes);
         void setBaseNode(int i, double x, double y) {if(i>=0&&i<int(m_BaseNode.size())) m_BaseNode[i].set(x,y);}
@@ -215,6 +219,8 @@ class FL5LIB_EXPORT Foil : public XflObject
         void setTEFlap();
         void setLEFlap();
 
+        void updateSearchFlags();
+
 
     private:
 
@@ -247,6 +253,10 @@ class FL5LIB_EXPORT Foil : public XflObject
 
         std::vector<Node2d> m_CbLine;          /**< the mid camber line points for the flapped foil */
 
+        bool m_bTopIncreasing{false};    /**< true if the x-coordinates of the upper surface points are strictly increasing, in which case they are searched by bisection */
+        bool m_bBotIncreasing{false};    /**< true if the x-coordinates of the lower surface points are strictly increasing */
+        bool m_bCbLineIncreasing{false}; /**< true if the x-coordinates of the camber line points are strictly increasing */
+
 
         bool m_bTEFlap;          /**< true if the foil has a trailing edge flap */
         bool m_bLEFlap;          /**< true if the foil has a leading edge flap */
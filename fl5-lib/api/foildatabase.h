@@ -0,0 +1,123 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+class Foil;
+class Polar;
+
+
+/**
+ * @class FoilDatabase
+ * @brief An index of foil files, searchable by shape and by geometric descriptors without loading the foils.
+ *
+ * Each entry stores the path of the foil's file and a signature of its normalized and derotated geometry:
+ *   - the descriptors: max. thickness and camber and their positions, LE radius and TE gap;
+ *   - the coefficients of a Kulfan CST fit of each surface;
+ *   - the y coordinates of each surface resampled at fixed, cosine-spaced chordwise stations.
+ * The resampled coordinates of all entries are held in a single contiguous array, so that the
+ * k-nearest-neighbour search is a linear scan which remains fast for some tens of thousands of foils.
+ * The index is saved to and read from a single binary file; the foils are read from their own files
+ * only when requested with loadFoil().
+ */
+class FL5LIB_EXPORT FoilDatabase
+{
+    public:
+        /** The number of resampled stations on each surface */
+        static int const s_nStations = 32;
+        /** The number of CST coefficients on each surface, i.e. an order 5 Bernstein polynomial */
+        static int const s_nCST = 6;
+
+        /** The geometric descriptors of a foil, for a unit chord */
+        struct Descriptors
+        {
+            double m_Thickness{0};
+            double m_XThickness{0};
+            double m_Camber{0};
+            double m_XCamber{0};
+            double m_LERadius{0};
+            double m_TEGap{0};
+        };
+
+        struct Entry
+        {
+            std::string m_Name;
+            std::string m_Path;
+            Descriptors m_Descriptors;
+            double m_CSTTop[s_nCST]{};
+            double m_CSTBot[s_nCST]{};
+        };
+
+        /** The result of a search: the index of the entry and its distance to the target */
+        struct Match
+        {
+            int m_Index{-1};
+            double m_Distance{0};
+        };
+
+        /** If set, restricts a search to the entries for which the function returns true */
+        typedef std::function<bool(int)> Filter;
+
+    public:
+        FoilDatabase() = default;
+
+        bool load(std::string const &path);
+        bool save(std::string const &path) const;
+        void clear() {m_Entries.clear(); m_Shapes.clear();}
+
+        int nEntries() const {return int(m_Entries.size());}
+        Entry const &entry(int i) const {return m_Entries.at(i);}
+        float const *shape(int i) const {return m_Shapes.data() + size_t(i)*2*s_nStations;}
+        int indexOf(std::string const &path) const;
+
+        int addFoil(Foil const &foil, std::string const &path);
+        int addFiles(std::vector<std::string> const &paths, std::string &log);
+        void removeEntry(int i);
+
+        std::vector<Match> nearest(Foil const &target, int k, Filter const &filter=Filter()) const;
+        std::vector<Match> nearest(int iEntry, int k, Filter const &filter=Filter()) const;
+        std::vector<Match> nearest(Descriptors const &target, Descriptors const &weights, int k, Filter const &filter=Filter()) const;
+
+        Foil *loadFoil(int i) const;
+        Polar *nearestAnalysedPolar(Foil const &target, double Re, int k=16) const;
+
+        static bool makeEntry(Foil const &foil, Entry &entry, std::vector<float> &shape);
+        static std::vector<double> const &stations();
+
+    private:
+        std::vector<Match> nearestShape(float const *target, int k, Filter const &filter) const;
+        static void fitCST(std::vector<double> const &y, double yTE, double *coefs);
+
+    private:
+        std::vector<Entry> m_Entries;
+        std::vector<float> m_Shapes;  /**< the resampled upper and lower y coordinates, 2*s_nStations values per entry */
+};
+
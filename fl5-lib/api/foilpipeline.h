@@ -0,0 +1,90 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <vector>
+
+#include <fl5lib_global.h>
+
+#include <analysisrange.h>
+
+class Foil;
+class Polar;
+class XFoilBatchEngine;
+
+
+/**
+ * @class FoilPipeline
+ * @brief Applies a sequence of geometric operations to a list of foils, concurrently.
+ *
+ * The operations are those of the foil edition dialogs: normalization, derotation, repanelling,
+ * trailing edge gap, and flaps made permanent. Each foil is processed by one task of the ThreadPool.
+ * The geometry is rebuilt once between two operations, and not again after those which rebuild it themselves.
+ * The processed foils can be queued directly as jobs of an XFoilBatchEngine.
+ */
+class FL5LIB_EXPORT FoilPipeline
+{
+    public:
+        enum enumOperation {NORMALIZE, DEROTATE, REPANEL, TEGAP, TEFLAP, LEFLAP};
+
+        /** One step of the pipeline; the meaning of the parameters depends on the type */
+        struct Operation
+        {
+            enumOperation m_Type{NORMALIZE};
+            int m_nPanels{0};            /**< REPANEL: the number of panels */
+            double m_Amplitude{0.0};     /**< REPANEL: the bunching amplitude */
+            double m_Gap{0.0};           /**< TEGAP: the gap, as a fraction of the chord */
+            double m_Blend{0.0};         /**< TEGAP: the blending length, as a fraction of the chord */
+            double m_XHinge{0.0};        /**< TEFLAP, LEFLAP: the hinge position, as a fraction of the chord */
+            double m_YHinge{0.0};        /**< TEFLAP, LEFLAP: the hinge position, as a fraction of the thickness */
+            double m_Angle{0.0};         /**< TEFLAP, LEFLAP: the flap angle, in degrees */
+        };
+
+    public:
+        FoilPipeline() = default;
+
+        void clearOperations() {m_Operations.clear();}
+        int nOperations() const {return int(m_Operations.size());}
+        Operation const &operation(int i) const {return m_Operations.at(i);}
+
+        void addOperation(Operation const &op) {m_Operations.push_back(op);}
+        void addNormalize();
+        void addDeRotate();
+        void addRePanel(int nPanels, double amplitude);
+        void addTEGap(double gap, double blendLength);
+        void addTEFlap(double xhinge, double yhinge, double angle);
+        void addLEFlap(double xhinge, double yhinge, double angle);
+
+        bool process(Foil &foil) const;
+        int run(std::vector<Foil*> const &foils, std::vector<bool> *pSuccess=nullptr) const;
+
+        static std::vector<Polar*> queueJobs(XFoilBatchEngine &engine, std::vector<Foil*> const &foils, Polar const &polarSpec,
+                                             std::vector<AnalysisRange> const &ranges, bool bAlpha);
+
+    private:
+        std::vector<Operation> m_Operations;
+};
+
@@ -33,6 +33,7 @@
 #include <enums_objects.h>
 #include <occmeshparams.h>
 #include <part.h>
+#include <trianglebvh.h>
 
 #include <fl5lib_global.h>
 
@@ -40,6 +41,7 @@
 class Panel3;
 class Panel4;
 class PlanePolar;
+class Segment3d;
 
 
 class FL5LIB_EXPORT Fuse : public Part
@@ -59,10 +61,12 @@ class FL5LIB_EXPORT Fuse : public Part
 
         virtual Fuse* clone() const = 0;
         virtual void duplicateFuse(const Fuse &aFuse);
+        virtual void duplicateFuseDefinition(const Fuse &aFuse);
 
         virtual void makeFuseGeometry();
         virtual bool intersectFuse(const Vector3d &A, const Vector3d &B, Vector3d &I) const;
         virtual bool intersectFuse(const Vector3d &A, const Vector3d &B, Vector3d &I, bool bRightSide) const;
+        int intersectFuse(std::vector<Segment3d> const &segs, std::vector<Vector3d> &I, std::vector<bool> &bIntersect, bool bRightSide) const;
 
         bool intersectFuseTriangulation(const Vector3d &A, const Vector3d &B, Vector3d &I) const;
 
@@ -114,9 +118,11 @@ class FL5LIB_EXPORT Fuse : public Part
 
         int nPanel4() const override = 0;
 
-        void saveBaseTriangulation() {m_BaseTriangulation = m_Triangulation;}
+        void saveBaseTriangulation() {m_BaseTriangulation = m_Triangulation; m_BaseBVH.clear();}
 
-        void setBaseTriangles(std::vector<Triangle3d> const &trianglelist) {m_BaseTriangulation.setTriangles(trianglelist);}
+        void setBaseTriangles(std::vector<Triangle3d> const &trianglelist) {m_BaseTriangulation.setTriangles(trianglelist); m_BaseBVH.clear();}
+
+        TriangleBVH const &baseBVH() const;
 
         virtual void computeStructuralInertia(Vector3d const &PartPosition) override;
         virtual void computeSurfaceProperties(std::string &log, std::string const &prefix) = 0;
@@ -158,6 +164,7 @@ class FL5LIB_EXPORT Fuse : public Part
 
 
         Triangulation m_BaseTriangulation;  /** the triangulation of the UNCUT fuse; used to make the wing surfaces */
+        mutable TriangleBVH m_BaseBVH;      /** the bounding volume hierarchy of the base triangulation, built on first use */
 
 
         double m_MaxElementSize; /** used by the flow5 mesher */
@@ -55,6 +55,7 @@ class FL5LIB_EXPORT FuseSections : public FuseXfl
         void translateFrame(Vector3d T, int FrameID) override;
         void translate(Vector3d const &T) override;
         void duplicateFuse(const Fuse &aFuse) override;
+        void duplicateFuseDefinition(const Fuse &aFuse) override;
         void insertPoint(int iPt) override;
         void insertPoint(const Vector3d &Real) override;
         void removeSideLine(int SideLine) override;
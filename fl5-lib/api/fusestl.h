@@ -58,7 +58,7 @@ class FL5LIB_EXPORT FuseStl : public Fuse
 
         int makeDefaultTriMesh(std::string &logmsg, const std::string &prefix) override;
 
-        bool intersectFuse(Vector3d const &A, Vector3d const &B, Vector3d &I, bool bMultiThreaded) const override;
+        bool intersectFuse(Vector3d const &A, Vector3d const &B, Vector3d &I, bool bRightSide) const override;
 
         void scale(double XFactor, double YFactor, double ZFactor) override;
         void translate(Vector3d const &T) override;
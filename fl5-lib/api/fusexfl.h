@@ -104,11 +104,14 @@ class FL5LIB_EXPORT FuseXfl : public Fuse
         void getProperties(std::string &props, const std::string &prefix, bool bFull=false) override;
 
         void duplicateFuse(const Fuse &aFuse) override;
+        void duplicateFuseDefinition(const Fuse &aFuse) override;
         void duplicateFuseXfl(const FuseXfl &aFuseXfl);
+        FuseXfl *snapshot() const;
 
         virtual void makeDefaultFuse();
         void makeDefaultHull();
         virtual int makeShape(std::string &log);
+        uint64_t shapeKey() const;
         void makeBodySplineShape(std::string &logmsg);
         void makeBodySplineShape_old(std::string &logmsg);
         void makeBodyFlatPanelShape_with2Triangles(std::string &logmsg);
@@ -121,6 +124,7 @@ class FL5LIB_EXPORT FuseXfl : public Fuse
         void appendRightSideShell(TopoDS_Shell const &rightsideshell);
 
         void getPoint(double u, double v, bool bRight, Vector3d &Pt) const;
+        void getGrid(std::vector<double> const &u, std::vector<double> const &v, bool bRight, std::vector<Vector3d> &grid) const;
         Vector3d Point(double u, double v, bool bRight) const;
         virtual void removeSideLine(int SideLine);
 
@@ -208,6 +212,9 @@ class FL5LIB_EXPORT FuseXfl : public Fuse
         void appendXPanel(int n) {m_xPanels.push_back(n);}
         void appendHPanel(int n) {m_hPanels.push_back(n);}
 
+    private:
+        void copyXflDefinition(const FuseXfl &aFuseXfl);
+
         //____________________VARIABLES_____________________________________________
 
 
@@ -224,6 +231,8 @@ class FL5LIB_EXPORT FuseXfl : public Fuse
 
         int m_iHighlightFrame;                    /**< the currently selected Frame to highlight */
 
+        uint64_t m_ShapeKey;                      /**< the key of the geometry from which the shapes and shells were last built, or 0 if none */
+
         int m_nxNurbsPanels;                           /**< For a NURBS body, the number of mesh elements in the direction of the x-axis */
         int m_nhNurbsPanels;                           /**< For a NURBS body, the number of mesh elements in the hoop direction */
 };
@@ -77,6 +77,12 @@ namespace geom
     FL5LIB_EXPORT double basis(int i, int deg, double t, const double *knots);
     FL5LIB_EXPORT double basisDerivative(int i, int deg, double t, const double *knots);
 
+    int const MAXSPANDEGREE = 15; /**< above this degree, the recursive evaluation of the basis functions is used */
+    FL5LIB_EXPORT int knotSpan(std::vector<double> const &knots, int nCtrl, int deg, double t);
+    FL5LIB_EXPORT int knotSpan(std::vector<double> const &knots, int nCtrl, int deg, double t, int sPrevious);
+    FL5LIB_EXPORT void spanBasis(double const *knots, int s, int deg, double t, double *N);
+    FL5LIB_EXPORT void spanBasisDerivative(double const *knots, int s, int deg, double t, double *dN);
+
     FL5LIB_EXPORT void makeNurbsTriangulation(NURBSSurface const &nurbs, int nx, int nh, std::vector<Triangle3d> &triangles);
 
     FL5LIB_EXPORT int isVector3d(const std::vector<Vector3d> &Nodes, Vector3d &Pt);
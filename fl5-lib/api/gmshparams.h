@@ -32,4 +32,5 @@ struct GmshParams
         double m_MinSize=0.05;// 50 mm
         double m_MaxSize=1.0; // 1 meter
         int m_nCurvature=30;
+        int m_nThreads=0;     // the number of threads used to mesh the surfaces; 0 to use all the cores; machine specific, not serialized
 };
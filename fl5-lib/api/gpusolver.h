@@ -0,0 +1,77 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <fl5lib_global.h>
+
+
+/**
+ * @class GpuSolver
+ * @brief The dense LU factorization and back-substitutions of a linear system on a CUDA device.
+ *
+ * The matrix is uploaded and factorized with cuSOLVER's getrf, in double or single precision, and
+ * the factors and the pivots are copied back to the host so that they can be used by the CPU solvers,
+ * the caches and the checkpoints in the same way as those of LAPACK. The device keeps its copy of the
+ * factors for the back-substitutions of all the subsequent RHS, until release() is called.
+ * The arrays are column-major with the conventions of LAPACK, and the pivots are 1-based.
+ *
+ * The CUDA code is only compiled with FL5_CUDA defined; otherwise isAvailable() returns false
+ * and the callers use the CPU.
+ */
+class FL5LIB_EXPORT GpuSolver
+{
+    public:
+        GpuSolver();
+        ~GpuSolver();
+
+        static bool isAvailable();
+        static std::string deviceName();
+
+        bool factorize(double const *A, int n, double *LU, int *ipiv);
+        bool factorize(float const *A, int n, float *LU, int *ipiv);
+        bool solve(char trans, double *B, int nRHS);
+        void release();
+
+        /** @return true if the device holds the factors of a matrix of size n in the requested precision */
+        bool isFactorized(int n, bool bDouble) const {return m_N==n && n>0 && m_bDouble==bDouble;}
+
+    private:
+        bool upload(void const *A, int n, bool bDouble);
+
+    private:
+        struct DeviceData;
+        std::unique_ptr<DeviceData> m_pData;
+
+        int m_N;            /**< the size of the factorized matrix, 0 if none */
+        bool m_bDouble;
+
+        std::mutex m_Mutex; /**< the back-substitutions may be requested from several threads */
+};
+
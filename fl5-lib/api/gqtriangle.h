@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <type_traits>
 #include <vector>
 
 #include <vector2d.h>
@@ -31,6 +32,13 @@
 
 class FL5LIB_EXPORT GQTriangle
 {
+    public:
+        /** A quadrature point in the coordinates of the normalized triangle (0,0), (1,0), (0,1), and its weight */
+        struct Node
+        {
+            double x, y, w;
+        };
+
     public:
         GQTriangle(int order=3);
         double testIntegral();
@@ -41,6 +49,9 @@ class FL5LIB_EXPORT GQTriangle
         std::vector<Vector2d> const &points() const {return m_point;}
         std::vector<double> const &weights() const {return m_weight;}
 
+        /** Returns the order of the rule used for the requested order; out of range values fall back to 3 and 8 as in makeCoeffs() */
+        static int ruleOrder(int order) {return order<1 ? 3 : (order>8 ? 8 : order);}
+
     private:
 
         int m_iOrder;
@@ -48,3 +59,154 @@ class FL5LIB_EXPORT GQTriangle
         std::vector<double> m_weight;
 };
 
+
+/**
+ * The triangle quadrature rules as compile-time tables.
+ * A kernel templated on the order loops over a constant number of points,
+ * which the compiler can unroll and vectorize, and makes no allocation.
+ */
+template<int order> struct GQTriangleRule;
+
+template<> struct GQTriangleRule<1>
+{
+    static constexpr int nPoints = 1;
+    static constexpr GQTriangle::Node nodes[nPoints] {
+        {0.33333333333333, 0.33333333333333,  1.00000000000000}
+    };
+};
+
+template<> struct GQTriangleRule<2>
+{
+    static constexpr int nPoints = 3;
+    static constexpr GQTriangle::Node nodes[nPoints] {
+        {0.16666666666667, 0.16666666666667,  0.33333333333333},
+        {0.16666666666667, 0.66666666666667,  0.33333333333333},
+        {0.66666666666667, 0.16666666666667,  0.33333333333333}
+    };
+};
+
+template<> struct GQTriangleRule<3>
+{
+    static constexpr int nPoints = 4;
+    static constexpr GQTriangle::Node nodes[nPoints] {
+        {0.33333333333333, 0.33333333333333, -0.56250000000000},
+        {0.20000000000000, 0.20000000000000,  0.52083333333333},
+        {0.20000000000000, 0.60000000000000,  0.52083333333333},
+        {0.60000000000000, 0.20000000000000,  0.52083333333333}
+    };
+};
+
+template<> struct GQTriangleRule<4>
+{
+    static constexpr int nPoints = 6;
+    static constexpr GQTriangle::Node nodes[nPoints] {
+        {0.44594849091597, 0.44594849091597,  0.22338158967801},
+        {0.44594849091597, 0.10810301816807,  0.22338158967801},
+        {0.10810301816807, 0.44594849091597,  0.22338158967801},
+        {0.09157621350977, 0.09157621350977,  0.10995174365532},
+        {0.09157621350977, 0.81684757298046,  0.10995174365532},
+        {0.81684757298046, 0.09157621350977,  0.10995174365532}
+    };
+};
+
+template<> struct GQTriangleRule<5>
+{
+    static constexpr int nPoints = 7;
+    static constexpr GQTriangle::Node nodes[nPoints] {
+        {0.33333333333333, 0.33333333333333,  0.22500000000000},
+        {0.47014206410511, 0.47014206410511,  0.13239415278851},
+        {0.47014206410511, 0.05971587178977,  0.13239415278851},
+        {0.05971587178977, 0.47014206410511,  0.13239415278851},
+        {0.10128650732346, 0.10128650732346,  0.12593918054483},
+        {0.10128650732346, 0.79742698535309,  0.12593918054483},
+        {0.79742698535309, 0.10128650732346,  0.12593918054483}
+    };
+};
+
+template<> struct GQTriangleRule<6>
+{
+    static constexpr int nPoints = 12;
+    static constexpr GQTriangle::Node nodes[nPoints] {
+        {0.24928674517091, 0.24928674517091,  0.11678627572638},
+        {0.24928674517091, 0.50142650965818,  0.11678627572638},
+        {0.50142650965818, 0.24928674517091,  0.11678627572638},
+        {0.06308901449150, 0.06308901449150,  0.05084490637021},
+        {0.06308901449150, 0.87382197101700,  0.05084490637021},
+        {0.87382197101700, 0.06308901449150,  0.05084490637021},
+        {0.31035245103378, 0.63650249912140,  0.08285107561837},
+        {0.63650249912140, 0.05314504984482,  0.08285107561837},
+        {0.05314504984482, 0.31035245103378,  0.08285107561837},
+        {0.63650249912140, 0.31035245103378,  0.08285107561837},
+        {0.31035245103378, 0.05314504984482,  0.08285107561837},
+        {0.05314504984482, 0.63650249912140,  0.08285107561837}
+    };
+};
+
+template<> struct GQTriangleRule<7>
+{
+    static constexpr int nPoints = 13;
+    static constexpr GQTriangle::Node nodes[nPoints] {
+        {0.33333333333333, 0.33333333333333, -0.14957004446768},
+        {0.26034596607904, 0.26034596607904,  0.17561525743321},
+        {0.26034596607904, 0.47930806784192,  0.17561525743321},
+        {0.47930806784192, 0.26034596607904,  0.17561525743321},
+        {0.06513010290222, 0.06513010290222,  0.05334723560884},
+        {0.06513010290222, 0.86973979419557,  0.05334723560884},
+        {0.86973979419557, 0.06513010290222,  0.05334723560884},
+        {0.31286549600487, 0.63844418856981,  0.07711376089026},
+        {0.63844418856981, 0.04869031542532,  0.07711376089026},
+        {0.04869031542532, 0.31286549600487,  0.07711376089026},
+        {0.63844418856981, 0.31286549600487,  0.07711376089026},
+        {0.31286549600487, 0.04869031542532,  0.07711376089026},
+        {0.04869031542532, 0.63844418856981,  0.07711376089026}
+    };
+};
+
+template<> struct GQTriangleRule<8>
+{
+    static constexpr int nPoints = 16;
+    static constexpr GQTriangle::Node nodes[nPoints] {
+        {0.33333333333333, 0.33333333333333,  0.14431560767779},
+        {0.45929258829272, 0.45929258829272,  0.09509163426728},
+        {0.45929258829272, 0.08141482341455,  0.09509163426728},
+        {0.08141482341455, 0.45929258829272,  0.09509163426728},
+        {0.17056930775176, 0.17056930775176,  0.10321737053472},
+        {0.17056930775176, 0.65886138449648,  0.10321737053472},
+        {0.65886138449648, 0.17056930775176,  0.10321737053472},
+        {0.05054722831703, 0.05054722831703,  0.03245849762320},
+        {0.05054722831703, 0.89890554336594,  0.03245849762320},
+        {0.89890554336594, 0.05054722831703,  0.03245849762320},
+        {0.26311282963464, 0.72849239295540,  0.02723031417443},
+        {0.72849239295540, 0.00839477740996,  0.02723031417443},
+        {0.00839477740996, 0.26311282963464,  0.02723031417443},
+        {0.72849239295540, 0.26311282963464,  0.02723031417443},
+        {0.26311282963464, 0.00839477740996,  0.02723031417443},
+        {0.00839477740996, 0.72849239295540,  0.02723031417443}
+    };
+};
+
+
+namespace gq
+{
+    /**
+     * Calls f(std::integral_constant<int, order>()) for the rule order selected at runtime,
+     * so that a kernel templated on the order can be called with the order set by the user.
+     */
+    template<typename Func>
+    inline void withTriangleRule(int order, Func const &f)
+    {
+        switch(GQTriangle::ruleOrder(order))
+        {
+            case 1:  f(std::integral_constant<int, 1>()); break;
+            case 2:  f(std::integral_constant<int, 2>()); break;
+            default:
+            case 3:  f(std::integral_constant<int, 3>()); break;
+            case 4:  f(std::integral_constant<int, 4>()); break;
+            case 5:  f(std::integral_constant<int, 5>()); break;
+            case 6:  f(std::integral_constant<int, 6>()); break;
+            case 7:  f(std::integral_constant<int, 7>()); break;
+            case 8:  f(std::integral_constant<int, 8>()); break;
+        }
+    }
+}
+
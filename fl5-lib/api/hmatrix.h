@@ -0,0 +1,108 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <fl5lib_global.h>
+#include <vector3d.h>
+
+
+/**
+ * @class HMatrix
+ * @brief A hierarchical representation of a dense influence matrix.
+ *
+ * The rows and the columns are clustered in two binary trees built by bisection of the bounding boxes
+ * of their associated points.
+ * The blocks of well separated clusters are approximated by low-rank products U.V^T built by adaptive
+ * cross approximation with partial pivoting, so that only a few of their rows and columns are evaluated.
+ * The other blocks are stored in full.
+ * The matrix is never assembled; its coefficients are evaluated on demand by a thread-safe callback.
+ */
+class FL5LIB_EXPORT HMatrix
+{
+    private:
+        struct Cluster
+        {
+            int m_First{0}, m_Last{0};  /**< the range [first, last[ of the cluster in the permuted ordering */
+            Vector3d m_BoxMin, m_BoxMax;
+            int m_Child[2]{-1,-1};
+            bool isLeaf() const {return m_Child[0]<0;}
+            int size() const {return m_Last-m_First;}
+            double diameter() const {return (m_BoxMax-m_BoxMin).norm();}
+        };
+
+        struct Block
+        {
+            int m_RowCluster{-1}, m_ColCluster{-1};
+            bool m_bLowRank{false};
+            int m_Rank{0};
+            std::vector<double> m_U; /**< nrows x rank, column after column */
+            std::vector<double> m_V; /**< ncols x rank, column after column */
+            std::vector<double> m_D; /**< the full block, row-major */
+        };
+
+    public:
+        HMatrix();
+
+        void clear();
+        bool build(std::vector<Vector3d> const &rowpts, std::vector<Vector3d> const &colpts,
+                   std::function<double(int,int)> const &coef);
+
+        void matVec(double const *x, double *y) const;
+        void addAggregatedMatrix(std::vector<int> const &rowagg, std::vector<int> const &colagg, int nAgg, double *Ac) const;
+
+        int nRows() const {return int(m_RowPerm.size());}
+        int nCols() const {return int(m_ColPerm.size());}
+        bool isEmpty() const {return m_Block.empty();}
+
+        size_t memorySize() const;
+        int nLowRankBlocks() const;
+        int nFullBlocks() const;
+
+        void setTolerance(double tol) {m_Tolerance=tol;}
+        void setAdmissibility(double eta) {m_Eta=eta;}
+        void setLeafSize(int n) {m_LeafSize=n;}
+
+    private:
+        void makeClusterTree(std::vector<Vector3d> const &pts, std::vector<int> &perm, std::vector<Cluster> &tree) const;
+        int splitCluster(std::vector<Vector3d> const &pts, std::vector<int> &perm, std::vector<Cluster> &tree, int first, int last) const;
+        void makeBlockTree(int irc, int icc);
+        bool isAdmissible(Cluster const &rc, Cluster const &cc) const;
+        void fillBlock(Block &block, std::function<double(int,int)> const &coef) const;
+        bool ACA(Block &block, std::function<double(int,int)> const &coef) const;
+
+    private:
+        std::vector<int> m_RowPerm, m_ColPerm;      /**< the original index of each row/column in the permuted ordering */
+        std::vector<Cluster> m_RowTree, m_ColTree;  /**< the cluster trees; the root is the first element */
+        std::vector<Block> m_Block;                 /**< the leaves of the block tree */
+
+        double m_Tolerance;  /**< the relative accuracy of the low-rank approximations */
+        double m_Eta;        /**< the admissibility parameter: min(diam) < eta x dist */
+        int m_LeafSize;      /**< the max. number of points in a leaf cluster */
+};
+
@@ -0,0 +1,79 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+
+/**
+ * @class InfluenceBlockCache
+ * @brief A process-wide cache of the diagonal blocks of the influence matrix shared by several analyses.
+ *
+ * The boats of a design study which share the same hull and differ in their sails have the same
+ * hull-hull block in their influence matrices, so that the block is computed once and copied back
+ * when the next boats are assembled; only the sail rows and columns and the coupling blocks are evaluated.
+ * An entry is identified by a hash of the block's panels and of the settings which define the matrix,
+ * and the entries are evicted in LRU order when the memory budget is exceeded.
+ */
+class FL5LIB_EXPORT InfluenceBlockCache
+{
+    private:
+        struct Entry
+        {
+            std::uint64_t m_Key{0};
+            int m_Size{0};
+            std::vector<double> m_Block;
+            size_t memorySize() const {return m_Block.size()*sizeof(double);}
+        };
+
+    public:
+        static bool fetch(std::uint64_t key, int n, std::vector<double> &block);
+        static void store(std::uint64_t key, int n, std::vector<double> const &block);
+        static void clear();
+
+        static void setEnabled(bool bEnabled) {s_bEnabled=bEnabled;}
+        static bool isEnabled() {return s_bEnabled;}
+
+        /** Sets the max. memory used by the cache, in MB; blocks larger than the budget are not cached */
+        static void setMaxMemory(double MB) {s_MaxMemory=MB;}
+        static double maxMemory() {return s_MaxMemory;}
+        static double memorySize();
+
+    private:
+        static size_t totalSize();
+
+    private:
+        static std::list<Entry> s_Entries;    /**< the most recently used entry first */
+        static std::mutex s_Mutex;
+        static bool s_bEnabled;
+        static double s_MaxMemory;
+};
+
@@ -0,0 +1,97 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <fl5lib_global.h>
+
+
+/**
+ * @class KernelStats
+ * @brief Per-thread counters and histograms of the panel kernels, to tune the far field ratios and the mesh densities.
+ *
+ * The hooks are compiled in when fl5-lib is built with FL5_KERNEL_STATS, and are disabled at run time
+ * by default; a disabled hook costs a relaxed load and a branch.
+ * Each thread writes to its own cache-line aligned block, so that the counts do not cause false sharing
+ * between the workers of the pool; the blocks are only summed when a snapshot is taken.
+ * The counts are process-wide: the snapshots of concurrent tasks include each other's calls.
+ */
+class FL5LIB_EXPORT KernelStats
+{
+    public:
+        enum enumCounter {DOUBLETVELOCITYNEAR, DOUBLETVELOCITYFAR, DOUBLETPOTENTIALNEAR, DOUBLETPOTENTIALFAR,
+                          SOURCEVELOCITYNEAR, SOURCEVELOCITYFAR, SOURCEPOTENTIALNEAR, SOURCEPOTENTIALFAR,
+                          INTEGRALSFAR, NFINTEGRALS, MCINTEGRALS, QUADRATURE, NCOUNTERS};
+
+        enum enumHistogram {P3VELOCITYBLOCK, P4VELOCITYBLOCK, VELOCITYRANGEPOINTS, NHISTOGRAMS};
+
+        /** bin 0 holds the zero values, bin k>0 the values in [2^(k-1), 2^k[, and the last bin the larger values */
+        static constexpr int NBINS = 24;
+
+        struct Totals
+        {
+            std::array<int64_t, NCOUNTERS> m_Count{};
+            std::array<std::array<int64_t, NBINS>, NHISTOGRAMS> m_Histogram{};
+
+            Totals operator-(Totals const &start) const;
+        };
+
+    public:
+        static void setEnabled(bool bEnabled) {s_bEnabled.store(bEnabled, std::memory_order_relaxed);}
+        static bool isEnabled() {return s_bEnabled.load(std::memory_order_relaxed);}
+        static bool isCompiled();
+
+        static void count(enumCounter c, int64_t n=1) {if(isEnabled()) addCount(c, n);}
+        static void sample(enumHistogram h, int64_t value) {if(isEnabled()) addSample(h, value);}
+
+        static Totals snapshot();
+        static void reset();
+        static std::string report(Totals const &totals);
+
+        static char const *counterName(enumCounter c);
+        static char const *histogramName(enumHistogram h);
+
+    private:
+        static void addCount(enumCounter c, int64_t n);
+        static void addSample(enumHistogram h, int64_t value);
+
+    private:
+        static std::atomic<bool> s_bEnabled;
+};
+
+
+#ifdef FL5_KERNEL_STATS
+    #define KERNEL_COUNT(c)     KernelStats::count(KernelStats::c)
+    #define KERNEL_COUNTS(c, n) KernelStats::count(KernelStats::c, n)
+    #define KERNEL_SAMPLE(h, v) KernelStats::sample(KernelStats::h, v)
+#else
+    #define KERNEL_COUNT(c)
+    #define KERNEL_COUNTS(c, n)
+    #define KERNEL_SAMPLE(h, v)
+#endif
@@ -0,0 +1,101 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <fl5lib_global.h>
+#include <vorton.h>
+
+class PlaneOpp;
+class BoatOpp;
+class OpPoint;
+
+
+/**
+ * @struct LiveFrame
+ * @brief One intermediate result published by a running task: a wake snapshot, a residual, or a completed operating point.
+ */
+struct LiveFrame
+{
+    enum enumType {WAKE, RESIDUAL, PLANEOPP, BOATOPP, OPPOINT};
+
+    enumType m_Type{RESIDUAL};
+    double m_Ctrl{0.0};           /**< the control parameter, aoa or Cl of the operating point being computed */
+    int m_Iter{0};                /**< the index of the iteration, for a residual */
+    double m_Value{0.0};          /**< the monitored value at this iteration, e.g. CL for the VPW or the rms of the BL Newton step for XFoil */
+
+    std::shared_ptr<std::vector<std::vector<Vorton>> const> m_pVortons; /**< the wake snapshot, shared with the consumer */
+
+    PlaneOpp const *m_pPlaneOpp{nullptr}; /**< the completed operating points; these are owned by the task and remain valid until the task's results are handed over */
+    BoatOpp const *m_pBoatOpp{nullptr};
+    OpPoint const *m_pOpPoint{nullptr};
+};
+
+
+/**
+ * @class LiveChannel
+ * @brief A lock-free single-producer, single-consumer channel from a running task to the GUI.
+ *
+ * The task's thread publishes the frames, and the GUI thread drains them at its own pace, typically
+ * from a timer. Neither side ever waits for the other: when the ring is full, the new frame is
+ * dropped and counted. The wake is published only once the consumer has taken the previous
+ * snapshot, so that a slow consumer does not cost the solver a copy of the vortons at each step.
+ */
+class FL5LIB_EXPORT LiveChannel
+{
+    public:
+        LiveChannel(int capacity=1024);
+
+        // producer side
+        bool publishWake(double ctrl, std::vector<std::vector<Vorton>> const &vortons);
+        bool publishResidual(double ctrl, int iter, double value);
+        bool publishPlaneOpp(PlaneOpp const *pPOpp);
+        bool publishBoatOpp(BoatOpp const *pBtOpp);
+        bool publishOpPoint(OpPoint const *pOpp);
+
+        // consumer side
+        bool pop(LiveFrame &frame);
+        void clear();
+
+        bool isEmpty() const {return m_Tail.load(std::memory_order_acquire)==m_Head.load(std::memory_order_acquire);}
+        int nDropped() const {return m_nDropped.load();}
+
+    private:
+        bool push(LiveFrame &&frame);
+
+    private:
+        std::vector<LiveFrame> m_Ring;
+        size_t m_Mask;
+
+        std::atomic<size_t> m_Head;       /**< the index of the next frame to write; only modified by the producer */
+        std::atomic<size_t> m_Tail;       /**< the index of the next frame to read; only modified by the consumer */
+        std::atomic<bool> m_bWakePending; /**< true while a wake snapshot is waiting in the ring */
+        std::atomic<int> m_nDropped;
+};
+
@@ -82,6 +82,7 @@ class FL5LIB_EXPORT LLTTask : public Task3d
         void initializeGeom();
 
         void setLLTRange(const std::vector<double> &opplist) {m_AoAList = opplist;}
+        std::vector<double> const &oppList() const {return m_AoAList;}
         void setObjects(PlaneXfl *pPlane, PlanePolar *pWPolar);
 
         void run() override;
@@ -104,16 +105,20 @@ class FL5LIB_EXPORT LLTTask : public Task3d
         static void setConvergencePrecision(double precision) {s_CvPrec = precision;}
         static void setNSpanStations(int nStations){s_NLLTStations=nStations;}
         static void setRelaxationFactor(double relax){s_RelaxMax = relax;}
+        static void setMultiThreaded(bool bMulti) {s_bMultiThread=bMulti;}
 
         static int maxIter() {return s_IterLim;}
         static double convergencePrecision() {return s_CvPrec;}
         static int nSpanStations() {return s_NLLTStations;}
         static double relaxationFactor() {return s_RelaxMax;}
+        static bool bMultiThreaded() {return s_bMultiThread;}
 
     private:
-        double alphaInduced(int k) const;
+        double alphaInduced(int k, double const *ClChord) const;
         double Beta(int m, int k) const;
         double Eta(int m) const;
+        void makeInfluenceTables();
+        void makeStationCl(double Alpha);
         void computeWing(double QInf, double Alpha, std::string &ErrMessage);
         void initializeVelocity(double alpha, double &QInf);
         int iterate(double &QInf, double const Alpha);
@@ -125,6 +130,8 @@ class FL5LIB_EXPORT LLTTask : public Task3d
 
         PlaneOpp *createPlaneOpp(double QInf, double Alpha, bool bWingOut);
         bool alphaLoop();
+        void sweep();
+        void copySetup(LLTTask *pMaster);
 
 
     private:
@@ -147,6 +154,7 @@ class FL5LIB_EXPORT LLTTask : public Task3d
         double m_ICm;                               /**< The wing's induced pitching moment */
         double m_IYm;                               /**< The wing's induced yawing moment */
         double m_QInf0;                             /**< The freestream velocity */
+        double m_QInfInit;                          /**< The freestream velocity of the last linear initialization */
         double m_VCm;                               /**< The wing's viscous pitching moment */
         double m_VYm;                               /**< The wing's viscous yawing moment */
 
@@ -156,6 +164,12 @@ class FL5LIB_EXPORT LLTTask : public Task3d
         std::vector<double> m_Twist;                    /**< twist at the span stations */
         std::vector<double> m_Offset;                   /**< offset at  the span stations */
 
+        std::vector<double> m_BetaTable;                /**< The induced angle influence coefficients Beta(m,k), stored row k first */
+        std::vector<double> m_EtaCoef;                  /**< The lift integration coefficients Eta(m) */
+        std::vector<double> m_SigmaCoef;                /**< The rolling moment integration coefficients Sigma(m) */
+        std::vector<Foil*> m_Foil0, m_Foil1;            /**< The foils which bound each span station */
+        std::vector<double> m_FoilTau;                  /**< The interpolation parameter between the two foils at each span station */
+
         std::vector<double> m_Re;                       /**< Reynolds number at the span stations */
         std::vector<double> m_Ai;                       /**< Induced Angle coefficient at the span stations */
         std::vector<double> m_BendingMoment;            /**< bending moment at the span stations */
@@ -182,10 +196,13 @@ class FL5LIB_EXPORT LLTTask : public Task3d
         static int s_IterLim;                       /**< The maximum number of iterations in the calculation */
         static int s_NLLTStations;                  /**< The number of LLT stations in the spanwise direction */
         static double s_RelaxMax;                   /**< The relaxation factor for the iterations */
+        static bool s_bMultiThread;                 /**< true if the operating points may be split in sub-ranges evaluated concurrently */
         static double s_CvPrec;                     /**< Precision criterion to stop the iterations. The difference in induced angle at any span point between two iterations should be less than the criterion */
 
         std::vector<PlaneOpp*> m_PlaneOppList;
 
+        LLTTask *m_pMaster;                          /**< The task which launched this sub-range of the sweep, or nullptr */
+
 
 
     public:
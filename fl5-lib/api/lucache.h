@@ -0,0 +1,89 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+
+/**
+ * @class LUCache
+ * @brief A process-wide cache of the LU factorizations of the influence matrix.
+ *
+ * The polars of a batch which share the same mesh and the same matrix settings differ only
+ * in their RHS, so that the factorization is computed once and copied back for the next polars.
+ * An entry is identified by a hash of the panel geometry and of the settings which define the matrix,
+ * so that a change in the mesh leads to a different key and the stale entries are never matched;
+ * they are evicted in LRU order when the memory budget is exceeded.
+ */
+class FL5LIB_EXPORT LUCache
+{
+    private:
+        struct Entry
+        {
+            std::uint64_t m_Key{0};
+            int m_Size{0};
+            bool m_bDouble{true};
+            std::vector<double> m_aijd;
+            std::vector<float>  m_aijf;
+            std::vector<int>    m_ipiv;
+            size_t memorySize() const {return m_aijd.size()*sizeof(double) + m_aijf.size()*sizeof(float) + m_ipiv.size()*sizeof(int);}
+        };
+
+    public:
+        static bool fetch(std::uint64_t key, int n, bool bDouble, double *aijd, size_t nd, float *aijf, size_t nf, std::vector<int> &ipiv);
+        static void store(std::uint64_t key, int n, bool bDouble, double const *aijd, size_t nd, float const *aijf, size_t nf, std::vector<int> const &ipiv);
+        static void clear();
+
+        static void setEnabled(bool bEnabled) {s_bEnabled=bEnabled;}
+        static bool isEnabled() {return s_bEnabled;}
+
+        /** Sets the max. memory used by the cache, in MB; factorizations larger than the budget are not cached */
+        static void setMaxMemory(double MB) {s_MaxMemory=MB;}
+        static double maxMemory() {return s_MaxMemory;}
+        static double memorySize();
+
+        static void hash(std::uint64_t &h, void const *data, size_t nBytes);
+        static void hash(std::uint64_t &h, double d) {hash(h, &d, sizeof(double));}
+        static void hash(std::uint64_t &h, int i) {hash(h, &i, sizeof(int));}
+
+        static constexpr std::uint64_t hashSeed() {return 14695981039346656037ULL;}
+
+    private:
+        static size_t totalSize();
+
+    private:
+        static std::list<Entry> s_Entries;    /**< the most recently used entry first */
+        static std::mutex s_Mutex;
+        static bool s_bEnabled;
+        static double s_MaxMemory;
+};
+
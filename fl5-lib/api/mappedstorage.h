@@ -0,0 +1,109 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include <fl5lib_global.h>
+
+
+/**
+ * @class MappedStorage
+ * @brief Allocates large arrays in memory-mapped scratch files instead of the heap.
+ *
+ * The files are created in the scratch directory and removed immediately, so that they disappear
+ * when the mapping is released or if the process is killed. The OS pages the array in and out of the file
+ * instead of the swap file, which makes arrays larger than the physical memory usable, and
+ * lets concurrent processes share the page cache.
+ * Arrays smaller than the threshold, or all arrays when the storage is disabled, are heap allocated.
+ */
+class FL5LIB_EXPORT MappedStorage
+{
+    public:
+        static void *allocate(size_t nBytes);
+        static void deallocate(void *p);
+        static bool isMapped(void const *p);
+
+        static void setEnabled(bool bEnabled) {s_bEnabled=bEnabled;}
+        static bool isEnabled() {return s_bEnabled;}
+
+        static void setScratchDirectory(std::string const &dir) {s_ScratchDir=dir;}
+        static std::string const &scratchDirectory() {return s_ScratchDir;}
+
+        /** Sets the array size in MB above which the arrays are mapped to a file */
+        static void setThreshold(double MB) {s_Threshold=MB;}
+        static double threshold() {return s_Threshold;}
+
+    private:
+        static void *mapScratchFile(size_t nBytes);
+        static void unmap(void *p, size_t nBytes);
+
+    private:
+        static std::unordered_map<void*, size_t> s_Mapped; /**< the mapped arrays and their size */
+        static std::mutex s_Mutex;
+        static bool s_bEnabled;
+        static std::string s_ScratchDir;
+        static double s_Threshold;
+};
+
+
+/**
+ * A std::allocator replacement which allocates through MappedStorage,
+ * so that a std::vector can be backed by a memory-mapped file.
+ * The elements are default-initialized rather than value-initialized, so that resizing a vector
+ * does not write its pages: these are placed by the first thread which writes them.
+ */
+template <typename T>
+class MappedAllocator
+{
+    public:
+        using value_type = T;
+
+        MappedAllocator() = default;
+        template <typename U> MappedAllocator(MappedAllocator<U> const &) {}
+
+        T *allocate(size_t n)
+        {
+            void *p = MappedStorage::allocate(n*sizeof(T));
+            if(!p) throw std::bad_alloc();
+            return static_cast<T*>(p);
+        }
+        void deallocate(T *p, size_t) {MappedStorage::deallocate(p);}
+
+        template <typename U> void construct(U *p) noexcept(std::is_nothrow_default_constructible<U>::value) {::new(static_cast<void*>(p)) U;}
+        template <typename U, typename... Args> void construct(U *p, Args&&... args) {::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);}
+
+        template <typename U> bool operator==(MappedAllocator<U> const &) const {return true;}
+        template <typename U> bool operator!=(MappedAllocator<U> const &) const {return false;}
+};
+
@@ -27,6 +27,7 @@
 
 
 #include <complex>
+#include <functional>
 #include <vector>
 
 #include <fl5lib_global.h>
@@ -173,12 +174,28 @@ namespace matrix
 
     int  solveLinearSystem(int rank, float *M, int nrhs, float *rhs, int nThreads=-1);
     FL5LIB_EXPORT    int  solveLinearSystem(int rank, double *M, int nrhs, double *rhs, int nThreads=-1);
+    FL5LIB_EXPORT    int  LUfactorize(int rank, double *M, std::vector<int> &ipiv, int nThreads=-1);
+    FL5LIB_EXPORT    int  LUfactorizeBlocked(int rank, double *M, int *ipiv, std::function<bool()> const &isCancelled, int blockSize=256);
+    FL5LIB_EXPORT    int  LUfactorizeBlocked(int rank, float  *M, int *ipiv, std::function<bool()> const &isCancelled, int blockSize=256);
+    FL5LIB_EXPORT    int  LUbackSubstitute(int rank, double const *LU, std::vector<int> const &ipiv, int nrhs, double *rhs);
 
 
     bool makeILUC(double const*A, double *ILU, int n, int p);
     bool makeSGS(double const *A, double *SGSLU, int n);
     void ILUC(double const*A, double *ILU, int n, int p);
 
+    /**
+     * Solves A.x=b using the restarted and right-preconditioned GMRES(m) method.
+     * @param matvec computes y=A.x
+     * @param precond applies in place the inverse of the preconditioner; may be empty
+     * @param x the initial guess in input, the solution in output
+     * @param residual in output, the final residual relative to |b|
+     * @return the number of iterations if converged, -1 otherwise
+     */
+    FL5LIB_EXPORT int GMRES(int n, std::function<void(double const*, double*)> const &matvec,
+                            std::function<void(double*)> const &precond,
+                            double const *b, double *x, int restart, int maxiter, double tolerance, double &residual);
+
 
     FL5LIB_EXPORT void setIdentityMatrix(double *M, int n);
 }
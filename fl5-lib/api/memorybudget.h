@@ -0,0 +1,77 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+
+/**
+ * @class MemoryBudget
+ * @brief The accounting of the memory used by the objects and the analyses, and the limit set on the analyses' working memory.
+ *
+ * The analyses reserve their large arrays against the budget before allocating them, and release them when
+ * they are freed. When a reservation does not fit, the analysis falls back on a mode which uses less memory,
+ * or does not start. A budget of 0 means no limit.
+ * The footprint functions return the heap memory held by the containers, i.e. their capacity and not their size.
+ */
+class FL5LIB_EXPORT MemoryBudget
+{
+    public:
+        static void setBudget(double MB) {s_Budget = MB>0.0 ? MB : 0.0;}
+        static double budget() {return s_Budget;}
+        static bool isLimited() {return s_Budget>0.0;}
+
+        static bool reserve(size_t nBytes);
+        static void release(size_t nBytes);
+        static size_t reserved() {return s_Reserved.load();}
+        static bool fits(size_t nBytes);
+
+        static std::string sizeString(size_t nBytes);
+
+        template<typename T, typename Alloc>
+        static size_t bytes(std::vector<T, Alloc> const &v) {return v.capacity()*sizeof(T);}
+
+        static size_t bytes(std::vector<bool> const &v) {return v.capacity()/8;}
+
+        template<typename T>
+        static size_t bytes(std::vector<std::vector<T>> const &v)
+        {
+            size_t n = v.capacity()*sizeof(std::vector<T>);
+            for(std::vector<T> const &row : v) n += bytes(row);
+            return n;
+        }
+
+    private:
+        static double s_Budget;                  /**< the max. memory reserved by the analyses, in MB; 0 if unlimited */
+        static std::atomic<size_t> s_Reserved;   /**< the memory currently reserved by the analyses, in bytes */
+};
+
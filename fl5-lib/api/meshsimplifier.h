@@ -0,0 +1,77 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <triangle3d.h>
+
+/**
+ * @class MeshSimplifier
+ * @brief Decimates a triangle soup by vertex clustering, so that scanned surfaces can be analysed with a reasonable panel count.
+ *
+ * The welded vertices are clustered on a uniform grid. The cells in which the normals spread more than the maximum angle
+ * are split into eight, up to a maximum number of levels, so that the curved regions keep more triangles than the flat ones.
+ * Each cluster is placed at the point which minimizes the quadric error of the planes of its triangles,
+ * and the free edges are clustered separately from the inner vertices so that the outline is preserved.
+ * The triangles whose vertices fall in three different clusters are kept, with their original orientation.
+ * The work is a few linear passes over the triangles; no intermediate mesh is built.
+ */
+class FL5LIB_EXPORT MeshSimplifier
+{
+    public:
+        MeshSimplifier();
+
+        void setMaxTriangles(int n) {m_MaxTriangles=n;}
+        void setEdgeLength(double l) {m_EdgeLength=l;}
+        void setMaxNormalAngle(double deg) {m_MaxNormalAngle=deg;}
+        void setMaxLevels(int n) {m_MaxLevels=n;}
+
+        bool simplify(std::vector<Triangle3d> const &triangles, std::vector<Triangle3d> &simplified);
+
+    private:
+        void weld(std::vector<Triangle3d> const &triangles, double precision);
+        void cluster(double cellsize);
+        void makeTriangles(std::vector<Triangle3d> const &triangles, std::vector<Triangle3d> &simplified) const;
+
+    private:
+        int m_MaxTriangles;       /**< the target triangle count, or 0 if the edge length is used */
+        double m_EdgeLength;      /**< the target edge length, used if greater than 0 */
+        double m_MaxNormalAngle;  /**< the maximum spread of the normals in a cell before it is split, in degrees */
+        int m_MaxLevels;          /**< the maximum number of times a cell is split */
+
+        std::vector<Vector3d> m_Node;         /**< the welded vertices */
+        std::vector<int> m_TriNode;           /**< the three welded vertex indexes of each triangle */
+        std::vector<bool> m_bBoundary;        /**< true if the vertex is on a free edge */
+        std::vector<std::array<int,3>> m_FreeEdge; /**< the two vertices and the triangle of each free edge */
+        std::vector<Vector3d> m_NodeNormal;   /**< the area-weighted normal sum of the triangles around each vertex */
+        std::vector<double> m_NodeArea;       /**< the area of the triangles around each vertex */
+
+        std::vector<int> m_Cluster;           /**< the cluster of each vertex */
+        std::vector<Vector3d> m_ClusterPos;   /**< the representative point of each cluster */
+};
+
@@ -0,0 +1,88 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+
+/**
+ * @class MultilevelPrecond
+ * @brief The coarse levels of a multilevel preconditioner for the panel systems solved with GMRES.
+ *
+ * The hierarchy is built by agglomeration of the mesh: at each level the nodes, i.e. the panels at the first level,
+ * are grouped with their free neighbours in the connectivity graph, which reduces their number about four times;
+ * the aggregates are only made of nodes of the same group, e.g. of the same surface position, so that the top and
+ * bottom panels are not merged at the trailing edges. The transfer operators are piecewise constant:
+ * the restriction sums the rows of each aggregate and the prolongation copies the coarse value to its rows.
+ *
+ * The correction is added to the result of the fine-level smoother, i.e. block-Jacobi, in additive form:
+ *     x += sum_l P_l.D_l^-1.R_l.r + P_c.A_c^-1.R_c.r
+ * where D_l is the diagonal of the Galerkin operator R_l.A.P_l of the intermediate levels and A_c is the Galerkin
+ * operator of the coarsest level, stored in full and factorized by dense LU. The coarse level captures the global
+ * part of the solution which the local smoother does not see, so that the number of iterations does not grow with
+ * the mesh size. The correction does not need any matrix-vector product with the fine matrix.
+ */
+class FL5LIB_EXPORT MultilevelPrecond
+{
+    private:
+        struct Level
+        {
+            int m_nRows{0};
+            std::vector<int> m_Aggregate;  /**< for each fine row, the index of its row at this level */
+            std::vector<double> m_InvDiag; /**< the inverse of the diagonal of the Galerkin operator; empty at the coarsest level and at the levels which are not smoothed */
+        };
+
+    public:
+        MultilevelPrecond();
+
+        void clear();
+        bool build(int nRowsPerNode, std::vector<std::vector<int>> const &neighbours, std::vector<int> const &group,
+                   std::function<double(int,int)> const &coef,
+                   std::function<void(std::vector<int> const &, int, double*)> const &coarseOperator);
+
+        void addCorrection(double const *r, double *x) const;
+
+        bool isEmpty() const {return m_Level.empty();}
+        int nLevels() const {return int(m_Level.size());}
+        int coarseSize() const {return m_Level.empty() ? 0 : m_Level.back().m_nRows;}
+        size_t memorySize() const;
+
+        /** Sets the max. number of rows of the coarsest level */
+        void setMaxCoarseSize(int n) {m_MaxCoarseSize=n;}
+
+    private:
+        static int aggregate(std::vector<std::vector<int>> const &neighbours, std::vector<int> const &group, std::vector<int> &agg);
+
+    private:
+        std::vector<Level> m_Level;       /**< the coarse levels, from the finest to the coarsest */
+        std::vector<double> m_CoarseLU;   /**< the LU factors of the Galerkin operator of the coarsest level, row-major */
+        std::vector<int> m_CoarsePiv;     /**< the pivot indices of the coarsest level */
+        int m_MaxCoarseSize;
+};
@@ -0,0 +1,115 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#pragma once
+
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+
+/**
+ * @class NeuralFoilNet
+ * @brief A native implementation of the NeuralFoil network inference.
+ *
+ * The weights and biases of the multi-layer perceptron are read once from a binary file exported
+ * from the NeuralFoil package by neuralfoil_bridge.export_native_model(), and the inference runs
+ * without Python. The operating points are evaluated in batches: each layer is a single matrix product
+ * of the batch's inputs by the layer's weights, done by the BLAS library.
+ *
+ * The foils are described by their Kulfan (CST) parameters, fitted natively to the node coordinates.
+ * As in NeuralFoil, each point is evaluated for the foil and for its mirror image, and the results
+ * are averaged so that the predictions of symmetric foils are exactly symmetric.
+ */
+class FL5LIB_EXPORT NeuralFoilNet
+{
+    public:
+        static int const NWEIGHTS = 8;               /**< the number of Kulfan weights on each side */
+        static int const NKULFAN  = 2*NWEIGHTS+2;    /**< the upper and lower weights, the leading edge weight and the trailing edge thickness */
+        static int const NINPUTS  = NKULFAN+7;       /**< the Kulfan parameters, three functions of the aoa, Re, NCrit and the two forced transitions */
+
+        typedef std::array<double, NKULFAN> KulfanParams;
+
+        /** An operating point to evaluate; m_iFoil is the index of the foil's Kulfan parameters */
+        struct Point
+        {
+            int m_iFoil{0};
+            double m_Alpha{0};    /**< the aoa, in degrees */
+            double m_Re{1.0e6};
+            double m_NCrit{9.0};
+            double m_XTrTop{1.0};
+            double m_XTrBot{1.0};
+        };
+
+        struct Result
+        {
+            double m_Cl{0};
+            double m_Cd{0};
+            double m_Cm{0};
+            double m_XTrTop{1};
+            double m_XTrBot{1};
+            double m_Confidence{0};   /**< the network's estimate of the reliability of the prediction, in [0,1] */
+        };
+
+    public:
+        bool load(std::string const &filename, std::string &error);
+        bool isLoaded() const {return !m_Layers.empty();}
+        int nLayers() const {return int(m_Layers.size());}
+
+        void evaluate(std::vector<KulfanParams> const &foils, std::vector<Point> const &points, std::vector<Result> &results) const;
+
+        static bool kulfanParameters(std::vector<double> const &x, std::vector<double> const &y, KulfanParams &kulfan);
+
+        static std::shared_ptr<NeuralFoilNet const> model(std::string const &modelsize);
+        static std::string modelFileName(std::string const &modelsize);
+
+        static std::string const &modelDirectory() {return s_ModelDir;}
+        static void setModelDirectory(std::string const &dir);
+
+    private:
+        void forward(std::vector<double> &x, int nRows) const;
+
+    private:
+        struct Layer
+        {
+            int m_nIn{0};
+            int m_nOut{0};
+            std::vector<double> m_Wt;    /**< the transposed weights, n_in rows by n_out columns */
+            std::vector<double> m_Bias;
+        };
+
+        std::vector<Layer> m_Layers;
+
+        static std::string s_ModelDir;    /**< the directory of the exported model files */
+        static std::map<std::string, std::shared_ptr<NeuralFoilNet const>> s_Models;   /**< the models loaded in this session, by size */
+        static std::mutex s_Mutex;
+};
+
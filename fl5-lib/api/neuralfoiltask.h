@@ -27,18 +27,21 @@
  * @brief NeuralFoil on-the-fly viscous analysis task
  * 
  * This class provides a C++ interface to NeuralFoil for calculating 
- * viscous polar data during 3D analysis. It uses pybind11 to embed
- * Python, with careful GIL management to avoid crashes.
+ * viscous polar data during 3D analysis. The network is evaluated by the
+ * native kernel NeuralFoilNet when its model file is available; otherwise
+ * pybind11 is used to embed Python, with careful GIL management to avoid crashes.
  */
 
 #pragma once
 
 #include <objects_global.h>
+#include <memory>
 #include <vector>
 #include <string>
 
 class Foil;
 class Polar;
+class NeuralFoilNet;
 
 /**
  * @brief Available NeuralFoil model sizes
@@ -131,7 +134,19 @@ public:
      */
     static bool isPythonInitialized() { return s_bPythonInitialized; }
 
+    /**
+     * @brief Get the native network of the given size
+     * @return The model, or nullptr if its file is missing and cannot be exported
+     *
+     * If the model file is missing and Python is available, the model is
+     * exported once from the NeuralFoil package by the bridge.
+     */
+    static std::shared_ptr<NeuralFoilNet const> nativeModel(NeuralFoilModelSize size);
+
 private:
+    bool processClListNative(NeuralFoilNet const &net);
+    static bool exportNativeModel(std::string const &modelStr);
+
     Polar *m_pPolar;
     std::vector<double> m_x;    ///< Foil x coordinates
     std::vector<double> m_y;    ///< Foil y coordinates
@@ -224,10 +239,17 @@ private:
     std::string m_foilHash;  ///< Hash to detect foil geometry changes
 
     /**
-     * @brief Compute a simple hash of foil coordinates
+     * @brief Compute a hash of the foil's active coordinates
      */
     static std::string computeFoilHash(Foil const &foil);
 
+    /**
+     * @brief Generate the polars with the native kernel, in a single batch
+     */
+    bool generatePolarMeshNative(NeuralFoilNet const &net,
+                                 std::vector<double> const &x, std::vector<double> const &y,
+                                 double nCrit, double xtrTop, double xtrBot);
+
     /**
      * @brief Generate logarithmically-spaced Re values
      */
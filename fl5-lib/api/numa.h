@@ -0,0 +1,59 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include <fl5lib_global.h>
+
+
+/**
+ * @class Numa
+ * @brief The NUMA nodes of the host, and the pinning of threads to a node.
+ *
+ * The topology is read once from the OS; it is only available on Linux, and the other
+ * platforms are seen as a single node on which pinning has no effect.
+ * A thread pinned to a node allocates its pages there with the OS' first-touch policy,
+ * and the ThreadPool runs the loops called from this thread on the workers of the same node,
+ * when the pool is NUMA-aware.
+ */
+class FL5LIB_EXPORT Numa
+{
+    public:
+        static int nNodes();
+        static std::vector<int> const &nodeCpus(int node);
+
+        static bool pinCurrentThread(int node);
+        static void unpinCurrentThread();
+        /** @return the node to which the calling thread has been pinned, or -1 if none */
+        static int currentThreadNode();
+
+    private:
+        static void readTopology();
+        static std::vector<int> parseCpuList(char const *list);
+
+    private:
+        static std::vector<std::vector<int>> s_NodeCpus;
+};
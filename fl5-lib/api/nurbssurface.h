@@ -97,6 +97,10 @@ class FL5LIB_EXPORT NURBSSurface
         double getv(double pos, double u=0.0) const;
         double getvIntersect(double u, Vector3d r) const;
         void   getPoint(double u, double v, Vector3d &Pt) const;
+        void   getPoints(int nPts, double const *u, double const *v, Vector3d *Pt) const;
+        void   getGrid(std::vector<double> const &u, std::vector<double> const &v, std::vector<Vector3d> &grid) const;
+        void   getuCurve(double u, std::vector<Vector3d> &curve) const;
+        void   getCurvePoint(double u, std::vector<Vector3d> const &curve, double v, Vector3d &Pt) const;
         void   getNormal(double u, double v, Vector3d &N) const;
 
         bool intersectNURBS(const Vector3d &Aa, const Vector3d &Bb, double &u, double &v, Vector3d &I) const;
@@ -148,6 +152,13 @@ class FL5LIB_EXPORT NURBSSurface
 
         void makeDefaultNurbs();
 
+    private:
+        bool hasLocalBasis() const;
+        void spanPoint(int su, double const *Nu, int sv, double const *Nv, Vector3d const *net, Vector3d &Pt) const;
+        void makeCtrlNet(std::vector<Vector3d> &net) const;
+        void getPoint_ref(double u, double v, Vector3d &Pt) const;
+        void getNormal_ref(double u, double v, Vector3d &N) const;
+
     private:
         std::vector<Frame> m_Frame;	        /**< a pointer to the array of Frame objects */
 
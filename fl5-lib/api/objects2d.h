@@ -28,6 +28,7 @@
   * @file This file implements the variables and methods used to manage 3D objects
   */
 
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -35,6 +36,7 @@
 #include <bldata.h>
 #include <enums_objects.h>
 #include <linestyle.h>
+#include <objectstore.h>
 #include <polar.h>
 
 class Foil;
@@ -42,21 +44,22 @@ class OpPoint;
 
 namespace Objects2d
 {
-    extern std::vector <Foil*>    s_oaFoil;
-    extern std::vector <Polar*>   s_oaPolar;  /**< The array of void pointers to the Polar objects. */
-    extern std::vector <OpPoint*> s_oaOpp;    /**< The array of void pointers to the OpPoint objects. */
+    /** The store which is current in the calling thread */
+    FL5LIB_EXPORT inline ObjectStore &store() {return ObjectStore::current();}
 
 
-    FL5LIB_EXPORT  inline std::vector<Foil*>    const & foils()           {return s_oaFoil;}
-    FL5LIB_EXPORT  inline std::vector<Polar*>   const & polars()          {return s_oaPolar;}
-    FL5LIB_EXPORT  inline std::vector<OpPoint*> const & operatingPoints() {return s_oaOpp;}
 
+    FL5LIB_EXPORT  inline std::vector<Foil*>    const & foils()           {return store().m_oaFoil;}
+    FL5LIB_EXPORT  inline std::vector<Polar*>   const & polars()          {return store().m_oaPolar;}
+    FL5LIB_EXPORT  inline std::vector<OpPoint*> const & operatingPoints() {return store().m_oaOpp;}
 
-    FL5LIB_EXPORT inline int nFoils()    {return int(s_oaFoil.size());}
-    FL5LIB_EXPORT inline int nPolars()   {return int(s_oaPolar.size());}
-    FL5LIB_EXPORT inline int nOpPoints() {return int(s_oaOpp.size());}
+
+    FL5LIB_EXPORT inline int nFoils()    {return int(store().m_oaFoil.size());}
+    FL5LIB_EXPORT inline int nPolars()   {return int(store().m_oaPolar.size());}
+    FL5LIB_EXPORT inline int nOpPoints() {return int(store().m_oaOpp.size());}
 
     FL5LIB_EXPORT void      deleteObjects();
+    FL5LIB_EXPORT size_t    memoryFootprint();
     FL5LIB_EXPORT void      deleteFoilResults(Foil *pFoil, bool bDeletePolars=false);
 
     FL5LIB_EXPORT Foil*     foil(std::string const &name);
@@ -73,28 +76,33 @@ namespace Objects2d
 
     FL5LIB_EXPORT std::vector<Foil*> sortedFoils();
 
+    FL5LIB_EXPORT uint64_t  foilHash(Foil const *pFoil, bool bBaseNodes=true);
+    FL5LIB_EXPORT bool      isSameGeometry(Foil const *pFoilA, Foil const *pFoilB);
+    FL5LIB_EXPORT std::vector<int> geometrySources(std::vector<Foil*> const &foilList);
+
     FL5LIB_EXPORT void insertPolar(Polar *pPolar);
     FL5LIB_EXPORT Polar *createPolar(Foil const*pFoil, xfl::enumPolarType PolarType, double Spec, double Mach, double NCrit, double XTop, double XBot);
 
 
-    FL5LIB_EXPORT inline Polar* polarAt(int iPlr) {if(iPlr<0||iPlr>=nPolars()) return nullptr; else return s_oaPolar.at(iPlr);}
+    FL5LIB_EXPORT inline Polar* polarAt(int iPlr) {if(iPlr<0||iPlr>=nPolars()) return nullptr; else return store().m_oaPolar.at(iPlr);}
     FL5LIB_EXPORT Polar* polar(const std::string &foilname, const std::string &polarname);
     FL5LIB_EXPORT Polar* polar(const Foil *pFoil, const std::string &PolarName);
     FL5LIB_EXPORT Polar* polar(const Foil *pFoil, xfl::enumPolarType type, BL::enumBLMethod method, float Re);
-    FL5LIB_EXPORT inline Polar* polar(int i) {if(i>=0 && i<nPolars()) return s_oaPolar.at(i); else return nullptr;}
+    FL5LIB_EXPORT inline Polar* polar(int i) {if(i>=0 && i<nPolars()) return store().m_oaPolar.at(i); else return nullptr;}
     FL5LIB_EXPORT void deletePolar(Polar *pPolar);
-    FL5LIB_EXPORT inline void removePolarAt(int ipl) {if(ipl>=0 && ipl<nPolars()) s_oaPolar.erase(s_oaPolar.begin()+ipl);}
-    FL5LIB_EXPORT inline void appendPolar(Polar*pPolar) {s_oaPolar.push_back(pPolar);}
+    FL5LIB_EXPORT void invalidatePolarIndex();
+    FL5LIB_EXPORT inline void removePolarAt(int ipl) {if(ipl>=0 && ipl<nPolars()) {store().m_oaPolar.erase(store().m_oaPolar.begin()+ipl); invalidatePolarIndex();}}
+    FL5LIB_EXPORT inline void appendPolar(Polar*pPolar) {store().m_oaPolar.push_back(pPolar); invalidatePolarIndex();}
 
-    FL5LIB_EXPORT inline OpPoint*  opPointAt(int iOpp) {return s_oaOpp.at(iOpp);}
+    FL5LIB_EXPORT inline OpPoint*  opPointAt(int iOpp) {return store().m_oaOpp.at(iOpp);}
     FL5LIB_EXPORT OpPoint*  opPointAt(Foil const*pFoil, Polar const *pPolar, double OppParam);
     FL5LIB_EXPORT OpPoint *insertOpPoint(OpPoint *pNewPoint);
     FL5LIB_EXPORT bool deleteOpp(OpPoint *pOpp);
     FL5LIB_EXPORT void addOpPoint(OpPoint *pNewOpp, bool bStoreOpp);
-    FL5LIB_EXPORT inline void removeOpPointAt(int io) {if(io>=0 && io<nOpPoints()) s_oaOpp.erase(s_oaOpp.begin()+io);}
-    FL5LIB_EXPORT inline void appendOpp(OpPoint *pOpp) {s_oaOpp.push_back(pOpp);}
+    FL5LIB_EXPORT inline void removeOpPointAt(int io) {if(io>=0 && io<nOpPoints()) store().m_oaOpp.erase(store().m_oaOpp.begin()+io);}
+    FL5LIB_EXPORT inline void appendOpp(OpPoint *pOpp) {store().m_oaOpp.push_back(pOpp);}
 
-    FL5LIB_EXPORT inline void appendFoil(Foil *pFoil) {s_oaFoil.push_back(pFoil);}
+    FL5LIB_EXPORT inline void appendFoil(Foil *pFoil) {store().m_oaFoil.push_back(pFoil); invalidatePolarIndex();}
 
     FL5LIB_EXPORT double getZeroLiftAngle(Foil const*pFoil0, Foil const*pFoil1, double Re, double Tau);
     FL5LIB_EXPORT void   getStallAngles(Foil const*pFoilA, Foil const*pFoilB, double Re, double Tau, double &negative, double &positive);
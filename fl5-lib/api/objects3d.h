@@ -32,6 +32,7 @@
 #include <vector>
 
 #include <linestyle.h>
+#include <objectstore.h>
 #include <fl5lib_global.h>
 
 class Plane;
@@ -45,20 +46,22 @@ class PlaneOpp;
 
 namespace Objects3d
 {
+    /** The store which is current in the calling thread */
+    FL5LIB_EXPORT inline ObjectStore &store() {return ObjectStore::current();}
+
     // object variable lists
     extern int s_Index;
-    extern std::vector<Plane*> s_oaPlane;   /**< The array of void pointers to the Plane objects. */
-    extern std::vector<PlanePolar*> s_oaPlanePolar;  /**< The array of void pointers to the WPolar objects. */
-    extern std::vector<PlaneOpp*> s_oaPlaneOpp;    /**< The array of void pointers to the PlaneOpp objects. */
 
-    FL5LIB_EXPORT  inline std::vector<Plane*>      const &planes()      {return s_oaPlane;}
-    FL5LIB_EXPORT  inline std::vector<PlanePolar*> const &planePolars() {return s_oaPlanePolar;}
-    FL5LIB_EXPORT  inline std::vector<PlaneOpp*>   const &planeOpps()   {return s_oaPlaneOpp;}
+    FL5LIB_EXPORT  inline std::vector<Plane*>      const &planes()      {return store().m_oaPlane;}
+    FL5LIB_EXPORT  inline std::vector<PlanePolar*> const &planePolars() {return store().m_oaPlanePolar;}
+    FL5LIB_EXPORT  inline std::vector<PlaneOpp*>   const &planeOpps()   {return store().m_oaPlaneOpp;}
 
     FL5LIB_EXPORT  Plane* addPlane(Plane *pPlane);
     FL5LIB_EXPORT  void deleteObjects();
+    FL5LIB_EXPORT  size_t memoryFootprint();
     FL5LIB_EXPORT  void deletePlane(Plane *pPlane, bool bDeleteResults=true);
     FL5LIB_EXPORT  void deletePlaneResults(const Plane *pPlane, bool bDeletePolars=false);
+    FL5LIB_EXPORT  void deleteInertiaResults(const Plane *pPlane);
     FL5LIB_EXPORT  void deleteExternalPolars(Plane const*pPlane);
     FL5LIB_EXPORT  void deleteWPolarResults(PlanePolar *pWPolar);
     FL5LIB_EXPORT  void deletePlPolar(PlanePolar *pPlPolar);
@@ -68,31 +71,32 @@ namespace Objects3d
     FL5LIB_EXPORT  PlaneOpp* planeOpp(Plane const *pPlane, PlanePolar const*pWPolar, const std::string &oppname);
     FL5LIB_EXPORT  PlanePolar* wPolar(const Plane *pPlane, const std::string &WPolarName);
     FL5LIB_EXPORT  bool planeExists(const std::string &planeName);
+    FL5LIB_EXPORT  void invalidateIndex();
 
-    FL5LIB_EXPORT  inline void appendPlane(Plane*pPlane) {s_oaPlane.push_back(pPlane);}
-    FL5LIB_EXPORT  inline void insertPlane(int k, Plane*pPlane) {s_oaPlane.insert(s_oaPlane.begin()+k, pPlane);}
-    FL5LIB_EXPORT  inline void removePlaneAt(int idx) {if(idx<0 ||idx>=int(s_oaPlane.size())) return; s_oaPlane.erase(s_oaPlane.begin()+idx);}
+    FL5LIB_EXPORT  inline void appendPlane(Plane*pPlane) {store().m_oaPlane.push_back(pPlane); invalidateIndex();}
+    FL5LIB_EXPORT  inline void insertPlane(int k, Plane*pPlane) {store().m_oaPlane.insert(store().m_oaPlane.begin()+k, pPlane); invalidateIndex();}
+    FL5LIB_EXPORT  inline void removePlaneAt(int idx) {if(idx<0 ||idx>=int(store().m_oaPlane.size())) return; store().m_oaPlane.erase(store().m_oaPlane.begin()+idx); invalidateIndex();}
     FL5LIB_EXPORT  void insertPlane(Plane *pModPlane);
     FL5LIB_EXPORT  void renamePlane(Plane *pPlane, std::string const &newname);
 
     FL5LIB_EXPORT  void addPlPolar(PlanePolar *pPPolar);
     FL5LIB_EXPORT  void appendPlPolar(PlanePolar *pPPolar);
     FL5LIB_EXPORT  void insertPlPolar(PlanePolar *pNewPPolar);
-    FL5LIB_EXPORT  inline void removePlPolarAt(int idx) {if(idx<0 ||idx>=int(s_oaPlanePolar.size())) return; s_oaPlanePolar.erase(s_oaPlanePolar.begin()+idx);}
+    FL5LIB_EXPORT  inline void removePlPolarAt(int idx) {if(idx<0 ||idx>=int(store().m_oaPlanePolar.size())) return; store().m_oaPlanePolar.erase(store().m_oaPlanePolar.begin()+idx); invalidateIndex();}
     FL5LIB_EXPORT  void renamePlPolar(PlanePolar *pWPolar, std::string const &newname);
 
     FL5LIB_EXPORT  void insertPlaneOpp(PlaneOpp *pPOpp);
     FL5LIB_EXPORT  bool containsPOpp(PlaneOpp *pPOpp);
-    FL5LIB_EXPORT  inline void removePOppAt(int idx) {if(idx<0 ||idx>=int(s_oaPlaneOpp.size())) return; s_oaPlaneOpp.erase(s_oaPlaneOpp.begin()+idx);}
-    FL5LIB_EXPORT  inline void appendPOpp(PlaneOpp *pPOpp) {s_oaPlaneOpp.push_back(pPOpp);}
+    FL5LIB_EXPORT  inline void removePOppAt(int idx) {if(idx<0 ||idx>=int(store().m_oaPlaneOpp.size())) return; store().m_oaPlaneOpp.erase(store().m_oaPlaneOpp.begin()+idx); invalidateIndex();}
+    FL5LIB_EXPORT  inline void appendPOpp(PlaneOpp *pPOpp) {store().m_oaPlaneOpp.push_back(pPOpp); invalidateIndex();}
 
-    FL5LIB_EXPORT  inline int nPlanes()  {return int(s_oaPlane.size());}
-    FL5LIB_EXPORT  inline int nPolars()  {return int(s_oaPlanePolar.size());}
-    FL5LIB_EXPORT  inline int nPOpps()   {return int(s_oaPlaneOpp.size());}
+    FL5LIB_EXPORT  inline int nPlanes()  {return int(store().m_oaPlane.size());}
+    FL5LIB_EXPORT  inline int nPolars()  {return int(store().m_oaPlanePolar.size());}
+    FL5LIB_EXPORT  inline int nPOpps()   {return int(store().m_oaPlaneOpp.size());}
 
-    FL5LIB_EXPORT  inline Plane* planeAt(int ip)    {if(ip>=0 && ip<int(s_oaPlane.size()))  return s_oaPlane.at(ip);  else return nullptr;}
-    FL5LIB_EXPORT  inline PlanePolar* plPolarAt(int iw)  {if(iw>=0 && iw<int(s_oaPlanePolar.size())) return s_oaPlanePolar.at(iw); else return nullptr;}
-    FL5LIB_EXPORT  inline PlaneOpp* POppAt(int io)  {if(io>=0 && io<int(s_oaPlaneOpp.size()))   return s_oaPlaneOpp.at(io);   else return nullptr;}
+    FL5LIB_EXPORT  inline Plane* planeAt(int ip)    {if(ip>=0 && ip<int(store().m_oaPlane.size()))  return store().m_oaPlane.at(ip);  else return nullptr;}
+    FL5LIB_EXPORT  inline PlanePolar* plPolarAt(int iw)  {if(iw>=0 && iw<int(store().m_oaPlanePolar.size())) return store().m_oaPlanePolar.at(iw); else return nullptr;}
+    FL5LIB_EXPORT  inline PlaneOpp* POppAt(int io)  {if(io>=0 && io<int(store().m_oaPlaneOpp.size()))   return store().m_oaPlaneOpp.at(io);   else return nullptr;}
 
     FL5LIB_EXPORT  int  newUniquePartIndex();
 
@@ -106,6 +110,11 @@ namespace Objects3d
     FL5LIB_EXPORT  void setPlPolarPOppStyle(PlanePolar const* pWPolar, bool bStipple, bool bWidth, bool bColor, bool bPoints, int darkfactor);
 
     FL5LIB_EXPORT  bool hasResults(Plane const*pPlane);
+    FL5LIB_EXPORT  bool hasInertiaResults(Plane const*pPlane);
+
+    /** The impact of an edit of a plane on its results, in increasing order */
+    enum enumPlaneEdit {STYLEEDIT, INERTIAEDIT, GEOMETRYEDIT};
+    FL5LIB_EXPORT  enumPlaneEdit planeEditType(Plane const *pPlane, Plane const *pModPlane);
     FL5LIB_EXPORT  bool hasPOpps(Plane const *pPlane);
     FL5LIB_EXPORT  bool hasPOpps(PlanePolar const *pWPolar);
 
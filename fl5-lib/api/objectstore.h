@@ -0,0 +1,179 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fl5lib_global.h>
+#include <polar.h>
+
+class Foil;
+class OpPoint;
+class Plane;
+class PlanePolar;
+class PlaneOpp;
+class Boat;
+class BoatPolar;
+class BoatOpp;
+
+
+/** An entry of the per-foil polar index used by the interpolation functions */
+struct PolarIndexEntry
+{
+    Polar const *m_pPolar{nullptr};
+    int m_Revision{-1};
+    bool m_bFixedSpeed{false};
+    Polar::InterpolationIndex m_Index;
+};
+
+
+/**
+ * A hash index of the objects of one of the store's arrays, by the key of their parent and by their own name.
+ * The index is built on demand by the lookup functions, and is cleared by the functions which modify the array
+ * or rename its objects.
+ */
+template<typename Key, typename T>
+struct NameIndex
+{
+    bool m_bValid{false};
+    std::unordered_map<Key, std::unordered_map<std::string, T*>> m_Map;
+
+    void clear() {m_Map.clear(); m_bValid=false;}
+
+    /** Keeps the first object in the order of the array if several objects share the key and the name */
+    void add(Key const &key, std::string const &name, T *pObj) {m_Map[key].emplace(name, pObj);}
+
+    T *find(Key const &key, std::string const &name) const
+    {
+        auto it = m_Map.find(key);
+        if(it==m_Map.end()) return nullptr;
+        auto jt = it->second.find(name);
+        return jt==it->second.end() ? nullptr : jt->second;
+    }
+};
+
+
+/**
+ * @class ObjectStore
+ * @brief The foils, planes and boats of one project, with their polars and operating points.
+ *
+ * The functions of Objects2d, Objects3d and SailObjects operate on the store which is current
+ * in the calling thread. This is the process-wide default store unless a ScopedStore has been set.
+ * The tasks keep the store which was current when they were created, and the thread pool forwards
+ * the store of the calling thread to its workers, so that independent projects can be analysed
+ * concurrently in the same process.
+ */
+class FL5LIB_EXPORT ObjectStore
+{
+    public:
+        ObjectStore() = default;
+        ~ObjectStore();
+
+        ObjectStore(ObjectStore const &) = delete;
+        ObjectStore &operator=(ObjectStore const &) = delete;
+
+        void deleteObjects();
+
+        /**
+         * Returns the object of the index with the key and the name, first filling the index with the builder if
+         * it has been cleared. The builder is called with the exclusive lock and must not call the lookup functions.
+         */
+        template<typename Key, typename T, typename Builder>
+        T *findIndexed(NameIndex<Key, T> &index, Key const &key, std::string const &name, Builder const &build)
+        {
+            {
+                std::shared_lock<std::shared_mutex> lock(m_NameIndexMutex);
+                if(index.m_bValid) return index.find(key, name);
+            }
+            std::unique_lock<std::shared_mutex> lock(m_NameIndexMutex);
+            if(!index.m_bValid)
+            {
+                index.m_Map.clear();
+                build(index);
+                index.m_bValid = true;
+            }
+            return index.find(key, name);
+        }
+
+        static ObjectStore &current();
+        static ObjectStore *defaultStore();
+        static void setCurrent(ObjectStore *pStore);
+
+    public:
+        std::vector<Foil*>       m_oaFoil;
+        std::vector<Polar*>      m_oaPolar;        /**< The array of pointers to the Polar objects. */
+        std::vector<OpPoint*>    m_oaOpp;          /**< The array of pointers to the OpPoint objects. */
+
+        std::vector<Plane*>      m_oaPlane;        /**< The array of pointers to the Plane objects. */
+        std::vector<PlanePolar*> m_oaPlanePolar;   /**< The array of pointers to the PlanePolar objects. */
+        std::vector<PlaneOpp*>   m_oaPlaneOpp;     /**< The array of pointers to the PlaneOpp objects. */
+
+        std::vector<Boat*>       m_oaBoat;
+        std::vector<BoatPolar*>  m_oaBtPolar;
+        std::vector<BoatOpp*>    m_oaBtOpp;
+        BoatOpp *m_pLastBtOpp{nullptr};
+
+        /** The polars of each foil in the order of the polar array, built on demand */
+        std::unordered_map<std::string, std::vector<PolarIndexEntry>> m_PolarIndex;
+        std::shared_mutex m_PolarIndexMutex;  /**< shared by the interpolations, exclusive when the index is rebuilt */
+
+        /** The name indexes of the lookup functions; the objects without parent are keyed by an empty string */
+        NameIndex<std::string, Foil>           m_FoilIndex;
+        NameIndex<std::string, Polar>          m_FoilPolarIndex;  /**< by foil name */
+        NameIndex<std::string, Plane>          m_PlaneIndex;
+        NameIndex<std::string, PlanePolar>     m_PlPolarIndex;    /**< by plane name */
+        NameIndex<PlanePolar const*, PlaneOpp> m_POppIndex;       /**< by polar */
+        NameIndex<std::string, Boat>           m_BoatIndex;
+        NameIndex<std::string, BoatPolar>      m_BtPolarIndex;    /**< by boat name */
+        NameIndex<BoatPolar const*, BoatOpp>   m_BtOppIndex;      /**< by polar */
+        std::shared_mutex m_NameIndexMutex;
+
+        /** Serializes the insertions which the tasks of this store make concurrently */
+        std::mutex m_InsertMutex;
+};
+
+
+/**
+ * @class ScopedStore
+ * @brief Makes a store current in the calling thread for the lifetime of the object, then restores the previous one.
+ */
+class FL5LIB_EXPORT ScopedStore
+{
+    public:
+        explicit ScopedStore(ObjectStore *pStore);
+        ~ScopedStore();
+
+        ScopedStore(ScopedStore const &) = delete;
+        ScopedStore &operator=(ScopedStore const &) = delete;
+
+    private:
+        ObjectStore *m_pPrevious;
+};
+
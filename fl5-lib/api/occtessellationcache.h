@@ -0,0 +1,112 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <TopoDS_Face.hxx>
+#include <TopoDS_ListOfShape.hxx>
+
+#include <fl5lib_global.h>
+
+#include <triangle3d.h>
+
+class OccMeshParams;
+
+
+/**
+ * @class OccTessellationCache
+ * @brief A content-addressed store of the OCC tessellations of the faces of CAD shapes, and of the imported STEP files.
+ *
+ * The face entries are keyed by a hash of the face's BRep description, i.e. its geometry, its
+ * boundaries, its location and its orientation, and of the mesh parameters, so that only the faces
+ * which have changed are re-meshed when the shape or the parameters are edited. The entries are kept
+ * in memory for the session; if persistence is enabled, they are also written to the cache
+ * directory and read back in the next sessions.
+ *
+ * The STEP imports are keyed by the file's path, size and modification time. If persistence is enabled, the
+ * imported shapes are also written as a BRep sidecar file in the cache directory, which is much faster to read
+ * than the STEP file in the next sessions.
+ */
+class FL5LIB_EXPORT OccTessellationCache
+{
+    private:
+        /** The result of the import of a STEP file */
+        struct StepImport
+        {
+            std::uintmax_t m_Size{0};
+            std::time_t m_Time{0};
+            TopoDS_ListOfShape m_Shapes;
+            double m_Dimension{1.0};
+            std::string m_LogMsg;
+        };
+
+    public:
+        static bool isEnabled() {return s_bEnabled;}
+        static void setEnabled(bool bEnabled) {s_bEnabled=bEnabled;}
+
+        static bool isPersistent() {return s_bPersistent;}
+        static void setPersistent(bool bPersistent) {s_bPersistent=bPersistent;}
+
+        static std::string cacheDirectory();
+        static void setCacheDirectory(std::string const &dir);
+
+        static uint64_t faceKey(TopoDS_Face const &face, OccMeshParams const &params);
+
+        static bool findFace(uint64_t key, std::vector<Triangle3d> &triangles);
+        static void storeFace(uint64_t key, std::vector<Triangle3d> const &triangles);
+
+        static bool findSTEP(std::string const &filename, TopoDS_ListOfShape &shapes, double &dimension, std::string &logmsg);
+        static void storeSTEP(std::string const &filename, TopoDS_ListOfShape const &shapes, double dimension, std::string const &logmsg);
+
+        static void clear();
+
+    private:
+        static std::string filePath(uint64_t key);
+        static std::string stepFilePath(std::string const &filename, std::uintmax_t size, std::time_t time);
+        static bool readSTEPFile(std::string const &path, StepImport &import);
+        static void writeSTEPFile(std::string const &path, StepImport const &import);
+        static bool fileStamp(std::string const &filename, std::uintmax_t &size, std::time_t &time);
+
+    private:
+        static bool s_bEnabled;
+        static bool s_bPersistent;
+        static std::string s_CacheDir;   /**< the cache directory; if empty, a subdirectory of the system's temporary directory */
+
+        /** the face triangulations read from the files or computed in this session, by face key */
+        static std::unordered_map<uint64_t, std::vector<Triangle3d>> s_Faces;
+
+        /** the imported STEP files, by path */
+        static std::unordered_map<std::string, StepImport> s_Steps;
+
+        static std::mutex s_Mutex;
+};
+
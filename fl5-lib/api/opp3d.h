@@ -38,6 +38,7 @@
 #include <polar3d.h>
 #include <vector3d.h>
 #include <vorton.h>
+#include <vortonwake.h>
 #include <vortex.h>
 
 
@@ -53,6 +54,13 @@ class FL5LIB_EXPORT Opp3d : public XflObject
     friend class  gl3dOptimXflView;
     friend class  POpp3dCtrls;
 
+    public:
+        /** The storage of the panel field arrays in the project files */
+        enum enumFieldStorage {RAWFLOAT, PACKEDFLOAT, PACKEDFIXED16};
+
+        /** The storage of the vorton wakes; the wakes are held in single precision in memory in all cases */
+        enum enumWakeStorage {DOUBLEWAKE, FLOATWAKE, NOWAKE};
+
     public:
         Opp3d();
 
@@ -88,12 +96,14 @@ class FL5LIB_EXPORT Opp3d : public XflObject
         double groundHeight() const {return m_GroundHeight;}
         void setGroundHeight(double h) {m_GroundHeight=h;}
 
-        int vortonRows() const {return int(m_Vorton.size());}
-        int vortonCount() const;
-        bool hasVortons() const {return m_Vorton.size()>0;}
+        int vortonRows() const {return m_VortonWake.nRows();}
+        int vortonCount() const {return m_VortonWake.count();}
+        bool hasVortons() const {return !m_VortonWake.isEmpty();}
         void getVortonVelocity(Vector3d const &pt, double CoreSize, Vector3d &V) const;
         std::vector<Vector3d> vortonLines() const;
-        void setVortons(std::vector<std::vector<Vorton>> const &vortons) {m_Vorton=vortons;}
+        VortonWake const &vortonWake() const {return m_VortonWake;}
+        std::vector<std::vector<Vorton>> vortons() const {std::vector<std::vector<Vorton>> vtn; m_VortonWake.makeVortons(vtn); return vtn;}
+        void setVortons(std::vector<std::vector<Vorton>> const &vortons);
         void setVortexNeg(std::vector<Vortex> const &vortexNeg) {m_VortexNeg=vortexNeg;}
 
         double nodeValue(int index) const {if(index>=0 && index<int(m_NodeValue.size())) return m_NodeValue.at(index); else return 0.0;}
@@ -131,10 +141,38 @@ class FL5LIB_EXPORT Opp3d : public XflObject
         bool bThickSurfaces()  const   {return !m_bThinSurface;}
         void setThickSurfaces(bool bThin) {m_bThinSurface=!bThin;}
 
+        bool hasPendingFields() const {return m_PendingFields.size()>0;}
+        bool decodePendingFields();
+
+        /** @return false if the panel fields have been dropped by the retention policy of the polar, or never computed as in the LLT */
+        bool hasFields() const {return m_Cp.size()>0;}
+        virtual void clearFields();
+
+        static enumFieldStorage fieldStorage() {return s_FieldStorage;}
+        static void setFieldStorage(enumFieldStorage storage) {s_FieldStorage=storage;}
+        static enumWakeStorage wakeStorage() {return s_WakeStorage;}
+        static void setWakeStorage(enumWakeStorage storage) {s_WakeStorage=storage;}
+
         virtual std::string title(bool bLong) const = 0;
         virtual std::string const &polarName() const =0;
         virtual void setPolarName(std::string const &name) = 0;
 
+        virtual size_t memoryFootprint() const;
+
+
+    protected:
+        enum enumField {CPFIELD, GAMMAFIELD, SIGMAFIELD};
+
+        /** A stored block of field values, and the arrays to which its interleaved values belong */
+        struct PendingField
+        {
+            xfl::ArrayBlock m_Block;
+            std::vector<enumField> m_Arrays;
+        };
+
+        bool readFields(QDataStream &ar, bool bPacked, int n, std::vector<enumField> const &arrays, bool bDefer);
+        void writeWakeFl5(QDataStream &ar, bool bCompact);
+        bool readWakeFl5(QDataStream &ar, bool bCompact);
 
     protected:
         bool m_bThinSurface;        /**< true if the WingOpp is the results of a calculation on the middle surface */
@@ -156,7 +194,7 @@ class FL5LIB_EXPORT Opp3d : public XflObject
 
 
 
-        std::vector<std::vector<Vorton>> m_Vorton; /** The array of vorton rows. Vortons are organized in rows. Each row is located in a crossflow plane. The number of vortons is varable for each row, due to vortex stretching and vorton redistribution. */
+        VortonWake m_VortonWake;            /** The vorton rows. Vortons are organized in rows. Each row is located in a crossflow plane. The number of vortons is varable for each row, due to vortex stretching and vorton redistribution. */
         std::vector<Vortex> m_VortexNeg;    /** The array of negating vortices at the trailing edge of the trailing wake panel of each wake column. cf. Willis 2005 fig. 3*/
 
 
@@ -169,6 +207,11 @@ class FL5LIB_EXPORT Opp3d : public XflObject
         bool m_bFreeSurface;
         double m_GroundHeight;
 
+        std::vector<PendingField> m_PendingFields; /**< the field blocks read from a project file and not yet decoded */
+
+        static enumFieldStorage s_FieldStorage;  /**< RAWFLOAT writes the arrays value by value in the legacy format; the packed options write them compressed, in single precision or in 16-bit fixed point */
+        static enumWakeStorage s_WakeStorage;    /**< DOUBLEWAKE writes the vortons in the legacy format; FLOATWAKE writes the compact arrays; NOWAKE does not keep the wakes in the operating points */
+
 
 };
 
@@ -112,6 +112,8 @@ class FL5LIB_EXPORT OpPoint : public XflObject
         bool serializeOppXFL(QDataStream &ar, bool bIsStoring, int ArchiveFormat=0);
         bool serializeOppFl5(QDataStream &ar, bool bIsStoring);
 
+        size_t memoryFootprint() const;
+
     public:
         xfl::enumPolarType m_PolarType;   /**< defines the type of the parent PlanePolar */
 
@@ -40,6 +40,7 @@ class FL5LIB_EXPORT P3Analysis : public PanelAnalysis
     friend class  Task3d;
     friend class  PlaneTask;
     friend class  BoatTask;
+    friend class  UnsteadyTask;
 
     public:
         P3Analysis();
@@ -48,6 +49,7 @@ class FL5LIB_EXPORT P3Analysis : public PanelAnalysis
         virtual bool isTriLinMethod() const =0;
 
         void makeInfluenceMatrix() override;
+        std::uint64_t meshHash() const override;
         virtual void makeMatrixBlock(int iBlock) = 0;
 
         bool initializeAnalysis(const Polar3d *pPolar3d, int nRHS) override;
@@ -88,7 +90,7 @@ class FL5LIB_EXPORT P3Analysis : public PanelAnalysis
         void combineLocalVelocities(double alpha, double beta, std::vector<Vector3d> &VLocal) const override;
 
 
-        void forces(const double *Mu3, const double *Sigma3, double alpha, double beta, const Vector3d &CoG, bool bFuseMi, std::vector<Vector3d> const &VInf, Vector3d &Force, Vector3d &Moment) override;
+        void forces(const double *Mu3, const double *Sigma3, const double *Cp3, double alpha, double beta, const Vector3d &CoG, bool bFuseMi, std::vector<Vector3d> const &VInf, Vector3d &Force, Vector3d &Moment) const override;
         void inducedForce(int nPanel3, double QInf, double alpha, double beta, int pos3, Vector3d &ForceBodyAxes, SpanDistribs &distribFF) const override;
         void trefftzDrag(int nPanel3, double QInf, double alpha, double beta, int pos3, Vector3d &Drag, SpanDistribs &distribFF) const override;
 
@@ -96,13 +98,24 @@ class FL5LIB_EXPORT P3Analysis : public PanelAnalysis
 
         void getVelocityVector(Vector3d const &C, double const *Mu, double const *Sigma, Vector3d &VT, double coreradius, bool bWakeOnly, bool bMultiThread) const override;
 
-        void velocityVectorBlock(int iBlock, Vector3d const &C, Vector3d *VT) const;
+        void getVelocityVectors(int nPts, Vector3d const *C, double const *Mu, double const *Sigma,
+                                Vector3d *VT, double coreradius, bool bWakeOnly) const override;
+
+        void velocityVectorBlock(int iBlock, Vector3d const &C, double const *Mu, double const *Sigma,
+                                 double coreradius, bool bWakeOnly, Vector3d *VT) const;
+        void velocityVectorRange(int iStart, int iMax, int nPts, Vector3d const *C, double const *Mu, double const *Sigma,
+                                 double coreradius, bool bWakeOnly, Vector3d *VT) const override;
+        void makePanelTreeElements(double const *Mu, double const *Sigma, std::vector<PanelTree::Element> &elements) const override;
+        void panelTreeVelocity(Vector3d const &C, double const *Mu, double const *Sigma, Vector3d &VT) const;
+        void treeElementVelocity(PanelTree::Element const &elem, Vector3d const &C, double const *Mu, double const *Sigma, Vector3d &V) const;
         void getFarFieldVelocity(const Vector3d &C, const std::vector<Panel3> &panel3, const double *Mu, Vector3d &VT, double coreradius) const;
         void getDebugPotential(Vector3d const &C, bool bSelf, const double *Mu, const double *Sigma, double &phi, bool bSource=true, bool bDoublet=true, bool bWake=true) const;
 
         void makePanelDoubletSurfaceVelocity(int p, const double *Mu, Vector3d &VLocal);
 
         void getSourceInfluence(Polar3d const *pPolar3d, Vector3d const &C, const Panel3 &p3, bool bSelf, Vector3d *V, double *phi) const;
+        void getDoubletVelocities(int nPts, Vector3d const *C, Panel3 const &p3, Vector3d *V, bool bUseRFF) const;
+        void getSourceVelocities(int nPts, Vector3d const *C, Panel3 const &p3, Vector3d *V) const;
         void makeNodeAverage(int iNode, const std::vector<double> &muPanel, std::vector<double> &muLin) const;
 
         void makeStripAreas();
@@ -128,9 +141,10 @@ class FL5LIB_EXPORT P3Analysis : public PanelAnalysis
     protected:
         TriMesh const *m_pRefTriMesh;
         std::vector<Panel3> m_Panel3;               /**< the panel array for the currently loaded plane */
-        std::vector<Panel3> m_refPanel3;
+        std::vector<Panel3> m_refPanel3;            /**< the panels saved by savePanels() */
         std::vector<Panel3> m_WakePanel3;           /**< the wake panel array for the currently loaded plane */
         std::vector<Panel3> m_refWakePanel3;
+        bool m_bSavedPanels;                        /**< true if the reference panels have been saved since the mesh was set; if false, the mesh's panels are the reference */
 
         std::vector<double> m_uRHSVertex, m_vRHSVertex, m_wRHSVertex; /** The unit doublet densities at the triangle's nodes. */
         std::vector<double> m_pRHSVertex, m_qRHSVertex, m_rRHSVertex; /** The unit doublet densities at the triangle's nodes. */
@@ -56,11 +56,13 @@ class FL5LIB_EXPORT P3LinAnalysis : public P3Analysis
         void makeUnitRHSBlock(int iBlock) override;
 
         void makeUnitDoubletStrengths(double alpha, double beta) override;
+        void combineUnitDoubletStrengths(double cu, double cv, double cw) override;
 
         void makeVortons(double dl, double const *mu3Vertex, int pos3, int nPanel3, int nStations, int nVtn0,
                          std::vector<Vorton> &vortons, std::vector<Vortex> &vortexneg) const override;
 
         bool scalarProductWake(const Panel3 &panel0, int iWake, double *scalarLeft, double *scalarRight) const;
+        template<int order> bool scalarProductWake(const Panel3 &panel0, int iWake, double *scalarLeft, double *scalarRight) const;
 
         void testResults(double alpha, double beta, double QInf) const override;
 
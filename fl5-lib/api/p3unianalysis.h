@@ -37,6 +37,8 @@ class FL5LIB_EXPORT P3UniAnalysis : public P3Analysis
 
     protected:
         void makeMatrixBlock(int iBlock) override;
+        double influenceCoef(int i3, int k3) const override;
+        bool bCompressibleMatrix() const override {return true;}
 
         void makeRHSBlock(int iBlock, double *RHS, std::vector<Vector3d> const &VField, Vector3d const*normals) const override;
 
@@ -50,6 +52,7 @@ class FL5LIB_EXPORT P3UniAnalysis : public P3Analysis
         void makeUnitRHSBlock(int iBlock) override;
 
         void makeUnitDoubletStrengths(double alpha, double beta) override;
+        void combineUnitDoubletStrengths(double cu, double cv, double cw) override;
         void makeVertexDoubletDensities(std::vector<double> const &muSrc, std::vector<double> &muNode) const override;
 
         void makeVortons(double dl, double const *mu3Vertex, int pos3, int nPanel3, int nStations, int nVtn0,
@@ -54,6 +54,7 @@ class FL5LIB_EXPORT P4Analysis : public PanelAnalysis
     friend class  Task3d;
     friend class  PlaneTask;
     friend class  BoatTask;
+    friend class  UnsteadyTask;
 
     public:
         P4Analysis();
@@ -75,6 +76,9 @@ class FL5LIB_EXPORT P4Analysis : public PanelAnalysis
 
         void makeInfluenceMatrix() override;
         void makeMatrixBlock(int iBlock);
+        double influenceCoef(int i4, int k4) const override;
+        bool bCompressibleMatrix() const override {return true;}
+        std::uint64_t meshHash() const override;
 
         void makeUnitRHSBlock(int iBlock) override;
         void makeRHSBlock(int iBlock, double *RHS, std::vector<Vector3d> const &VField, const Vector3d *normals) const override;
@@ -85,16 +89,23 @@ class FL5LIB_EXPORT P4Analysis : public PanelAnalysis
         void getDoubletVelocity( Vector3d const &C, const Panel4 &p4, Vector3d &V, double coreradius, bool bUseRFF, bool bIncludingBoundVortex) const;
         void getSourcePotential( Vector3d const &C, const Panel4 &p4, double &phi) const;
         void getSourceVelocity(  Vector3d const &C, bool bSelf, const Panel4 &p4, Vector3d &V) const;
+        void getDoubletVelocities(int nPts, Vector3d const *C, Panel4 const &p4, Vector3d *V, double coreradius, bool bUseRFF, bool bIncludingBoundVortex) const;
+        void getSourceVelocities( int nPts, Vector3d const *C, Panel4 const &p4, Vector3d *V) const;
         void getFarFieldVelocity(Vector3d const &C, const std::vector<Panel4> &panel4, const double *Mu, Vector3d &VT, double coreradius) const;
 
         double getPotential(Vector3d const &C, const double *mu, const double *sigma) const;
         void getVelocityVector(Vector3d const &C,double const *Mu, double const *Sigma, Vector3d &VT, double coreradius,
                                bool bWakeOnly, bool bMultiThread) const override;
+        void getVelocityVectors(int nPts, Vector3d const *C, double const *Mu, double const *Sigma,
+                                Vector3d *VT, double coreradius, bool bWakeOnly) const override;
 
         void VLMGetVortexInfluence(const Panel4 &pPanel, Vector3d const &C, double *phi, Vector3d *V, bool bIncludingBound, double fardist) const;
+        void makeVLMSegments();
+        void VLMInfluenceRow(int i4, double *row, Vector3d *segvel, Vector3d *segvelG) const;
+        int nVLMSegments() const {return int(m_VLMSegA.size());}
 
 
-        void forces(double const *Mu, double const *Sigma, double alpha, double beta, Vector3d const&CoG, bool bFuseMi, const std::vector<Vector3d> &VInf, Vector3d &Force, Vector3d &Moment) override;
+        void forces(double const *Mu, double const *Sigma, double const *Cp, double alpha, double beta, Vector3d const&CoG, bool bFuseMi, const std::vector<Vector3d> &VInf, Vector3d &Force, Vector3d &Moment) const override;
 
         void makeMu(int qrhs) override;
 
@@ -109,8 +120,13 @@ class FL5LIB_EXPORT P4Analysis : public PanelAnalysis
 
         void releasePanelArrays();
 
-        void velocityVectorBlock(int iBlock, Vector3d const &C,
-                                             Vector3d *VT) const;
+        void velocityVectorBlock(int iBlock, Vector3d const &C, double const *Mu, double const *Sigma,
+                                 double coreradius, bool bWakeOnly, Vector3d *VT) const;
+        void velocityVectorRange(int iStart, int iMax, int nPts, Vector3d const *C, double const *Mu, double const *Sigma,
+                                 double coreradius, bool bWakeOnly, Vector3d *VT) const override;
+        void makePanelTreeElements(double const *Mu, double const *Sigma, std::vector<PanelTree::Element> &elements) const override;
+        void panelTreeVelocity(Vector3d const &C, double const *Mu, double const *Sigma, double coreradius, Vector3d &VT) const;
+        void treeElementVelocity(PanelTree::Element const &elem, Vector3d const &C, double const *Mu, double const *Sigma, double coreradius, Vector3d &V) const;
         void getDoubletDerivative(int p, const double *Mu, double &Cp, Vector3d &VTotl, const Vector3d &VInf) const;
 
         Vector3d trailingWakePoint(const Panel4 *pWakePanel) const;
@@ -138,6 +154,7 @@ class FL5LIB_EXPORT P4Analysis : public PanelAnalysis
         int allocateRHS4(int nRHS);
         void scaleResultsToSpeed(double ratio) override;
         void makeUnitDoubletStrengths(double alpha, double beta) override;
+        void combineUnitDoubletStrengths(double cu, double cv, double cw) override;
         void combineLocalVelocities(double alpha, double beta, std::vector<Vector3d> &VLocal) const override;
         void makeLocalVelocities(std::vector<double> const &uRHS, std::vector<double> const &vRHS, std::vector<double> const &wRHS,
                                  std::vector<Vector3d> &uVLocal, std::vector<Vector3d> &vVLocal, std::vector<Vector3d> &wVLocal,
@@ -162,6 +179,11 @@ class FL5LIB_EXPORT P4Analysis : public PanelAnalysis
         std::vector<Panel4> m_RefWakePanel4;      /**< a copy of the reference wake node array if wake needs to be reset */
         std::vector<Vector3d> m_WakeNode;	      /**< the current working wake node array */
         std::vector<Vector3d> m_RefWakeNode;      /**< a copy of the reference wake node array if the flat wake geometry needs to be restored */
+
+        // the vortex segments of the lattice, each shared by the panels which own it
+        static constexpr int VLMSEGMENTS = 7;     /**< the max. number of segments of a panel: a trailing vortex ring and its horseshoe */
+        std::vector<Vector3d> m_VLMSegA, m_VLMSegB; /**< the end points of the unique vortex segments */
+        std::vector<int> m_VLMColumnSeg;          /**< for each panel, VLMSEGMENTS references s to the segments: +(s+1) or -(s+1) if reversed, 0 if unused; empty if the lattice is not used */
 };
 
 
@@ -40,6 +40,7 @@ class FL5LIB_EXPORT Panel
 
         double area() const {return m_Area;}
         double minSize() const {return m_MaxSize;}
+        double maxSize() const {return m_MaxSize;}
 
         void setSurfacePosition(xfl::enumSurfacePosition pos) {m_Pos=pos;}
         xfl::enumSurfacePosition surfacePosition() const {return m_Pos;}
@@ -97,10 +97,12 @@ class FL5LIB_EXPORT Panel3 : public Panel
         inline TRIANGLE::enumPointPosition pointPosition(double xl, double yl, int &iVertex, int &iEdge) const;
 
         void initialize();
+        void makeNFConstants();
         bool isPositiveOrientation() const override {return m_SignedArea>0.0;}
 
         void rotate(Vector3d const &HA, Quaternion &Qt);
         void rotate(Vector3d const &HA, Vector3d const &Axis, double angle) override;
+        void transform(Quaternion const &Qt, Vector3d const &O, Vector3d const &T);
 
         void scalarProductSourcePotential(Panel3 const &SourcePanel, bool bSelf, double *sp) const;
         void scalarProductDoubletPotential(Panel3 const &DoubletPanel, bool bSelf, double *sp) const;
@@ -129,14 +131,17 @@ class FL5LIB_EXPORT Panel3 : public Panel
 
         void sourceN4023Potential(Vector3d const &C, bool bSelf, double &phi, double coreradius) const;
         void sourceN4023Velocity(Vector3d const &C, bool bSelf, Vector3d &Vel, double coreradius) const;
+        void sourceN4023Velocity(int nPts, Vector3d const *C, Vector3d *Vel, double coreradius) const;
         void sourcePotential(const Vector3d &Pt, bool bSelf, double &phi) const;
         void sourceVelocity(const Vector3d &Pt, bool bSelf, Vector3d &Velocity) const;
 
         void doubletN4023Potential(Vector3d const &C, bool bSelf, double &phi, double coreradius, bool bUseRFF=true) const;
         void doubletN4023Velocity(Vector3d const &C, bool bSelf, Vector3d &V, double coreradius, bool bUseRFF=true) const;
+        void doubletN4023Velocity(int nPts, Vector3d const *C, Vector3d *V, double coreradius, bool bUseRFF=true) const;
         void doubletVortexVelocity(Vector3d const &C, Vector3d &V, double coreradius, Vortex::enumVortex vortexmodel, bool bUseRFF) const;
         void doubletBasisPotential(Vector3d const &ptGlobal, bool bSelf, double *phi, bool bUseRFF=true) const;
         void doubletBasisVelocity(Vector3d const &ptGlobal, Vector3d *V, bool bUseRFF=true) const;
+        void doubletBasisVelocity(int nPts, Vector3d const *ptGlobal, Vector3d *V, bool bUseRFF=true) const;
 
         int nodeIndex(int i) const {return m_S[i].index();}
         inline void setVertex(int ivtx, Node const &node);
@@ -236,12 +241,21 @@ class FL5LIB_EXPORT Panel3 : public Panel
         static int quadratureOrder() {return s_iQuadratureOrder;}
         static void setQualityFactor(double qualityfactor) {s_Quality=qualityfactor;}
 
-        static void makeGQCoeffs();
-
     public:
         Vector3d m_Sl[3];             /**< The three triangle vertices, in local coordinates */
         Vector3d m_CoG_l;              /**< the center of gravity's position in local coordinates */
 
+    private:
+        /** The quadrature kernels for a rule order known at compile time; the public functions select them with the current order */
+        template<int order> void scalarProductSourcePotential(Panel3 const &SourcePanel, bool bSelf, double *sp) const;
+        template<int order> void scalarProductDoubletPotential(Panel3 const &DoubletPanel, bool bSelf, double *sp) const;
+        template<int order> void scalarProductSourceVelocity(Panel3 const &SourcePanel, bool bSelf, double *sp) const;
+        template<int order> void scalarProductDoubletVelocity(Panel3 const &DoubletPanel, double *sp) const;
+        template<int order> void sourceQuadraturePotential(Vector3d Pt, double &phi) const;
+        template<int order> void sourceQuadratureVelocity(Vector3d ptGlobal, Vector3d &V) const;
+        template<int order> void doubletQuadraturePotential(Vector3d Pt, double *phi) const;
+        template<int order> void doubletQuadratureVelocity(Vector3d Pt, Vector3d *V) const;
+
     private:
         Node m_S[3];                  /**< the three triangle vertices, in global coordinates*/
         int m_Neighbour[3];         /**< the indexes of the neighbour triangles sharing one of the edge; three at most; -1 if no neighbour */
@@ -260,6 +274,11 @@ class FL5LIB_EXPORT Panel3 : public Panel
         Segment3d m_Edge[3];         /**< the three sides, in global coordinates */
         Vector3d m_S01l, m_S02l, m_S12l;  /**< the three sides, in local coordinates */
 
+        // the field point independent constants of computeNFIntegrals(), made by setFrame()
+        Vector3d m_NFu[4];            /**< the normalized local edges, the first one repeated */
+        double m_NFTheta[3];          /**< the vertex angles */
+        double m_NFCosa[3], m_NFSina[3]; /**< the cosine and sine of the orientation of the edge frames, i.a.w. eq. 21 */
+
         double m_SignedArea;        /**< The panel's signed area; */
         double m_Angle[3];           /** the three internal angles */
 
@@ -270,7 +289,6 @@ class FL5LIB_EXPORT Panel3 : public Panel
 
         static int s_iQuadratureOrder;
         static bool s_bUseNintcheuFata;
-        static GQTriangle s_gq;     /** @todo check time gain if built on the stack */
         static double s_Quality;
 };
 
@@ -328,8 +346,7 @@ inline bool Panel3::isLowAngle(double minangle) const
 
 inline void Panel3::setQuadratureOrder(int order)
 {
-    s_iQuadratureOrder=order;
-    s_gq.makeCoeffs(order);
+    s_iQuadratureOrder=GQTriangle::ruleOrder(order);
 }
 
 
@@ -67,14 +67,17 @@ class FL5LIB_EXPORT Panel4 : public Panel
         void setPanelFrame(Vector3d const &LA, Vector3d const &LB, Vector3d const &TA, Vector3d const &TB);
 
         void doubletVortexVelocity(Vector3d const &C, Vector3d &VTest, double coreradius, bool bUseRFF=true) const;
+        void doubletVortexVelocity(int nPts, Vector3d const *C, Vector3d *V, double coreradius, bool bUseRFF=true) const;
         void doubletN4023Potential(Vector3d const &C, bool bSelf, double &phi, double coreradius, bool bUseRFF=true) const;
         void doubletN4023Velocity(Vector3d const &C, Vector3d &V, double coreradius, bool bUseRFF=true) const;
         void sourceN4023Potential(Vector3d const &C, double &phi, double coreradius) const;
         void sourceN4023Velocity(  Vector3d const &C, bool bSelf, Vector3d &Vel, double coreradius) const;
+        void sourceN4023Velocity(  int nPts, Vector3d const *C, Vector3d *Vel, double coreradius) const;
 
         void rotate(Vector3d const &HA, const Vector3d &Axis, double angle) override;
 
         void rotate(double alpha, double beta, double phi);
+        void rotate(Quaternion const &Qt);
 
         inline void rotateNormal(Quaternion const &Qt);
 
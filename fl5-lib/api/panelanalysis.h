@@ -29,13 +29,22 @@
 
 #include <vorton.h>
 #include <vortex.h>
+#include <vortontree.h>
+#include <paneltree.h>
 #include <aeroforces.h>
 #include <spandistribs.h>
 #include <utils.h>
+#include <hmatrix.h>
+#include <multilevelprecond.h>
+#include <mappedstorage.h>
+#include <panelsoa.h>
 
+class DistributedSolver;
+class GpuSolver;
 class Polar3d;
 class Panel;
 class StabDerivatives;
+class TaskCheckpoint;
 class Vortex;
 
 class FL5LIB_EXPORT PanelAnalysis
@@ -43,10 +52,11 @@ class FL5LIB_EXPORT PanelAnalysis
     friend class  Task3d;
     friend class  PlaneTask;
     friend class  BoatTask;
+    friend class  UnsteadyTask;
 
     public:
         PanelAnalysis();
-        virtual ~PanelAnalysis() = default;
+        virtual ~PanelAnalysis();
 
         void setAnalysisStatus(xfl::enumAnalysisStatus status) {m_AnalysisStatus=status;}
         void cancelAnalysis() {m_AnalysisStatus=xfl::CANCELLED;}
@@ -56,6 +66,7 @@ class FL5LIB_EXPORT PanelAnalysis
         bool isFinished()  const {return m_AnalysisStatus==xfl::FINISHED || m_AnalysisStatus==xfl::CANCELLED;}
 
         bool allocateMatrix(int N);
+        size_t memoryFootprint() const;
 
         virtual Panel *panel(int p) = 0;
         virtual Panel const *panelAt(int p) const = 0;
@@ -66,9 +77,54 @@ class FL5LIB_EXPORT PanelAnalysis
         virtual void savePanels() = 0;
         virtual void restorePanels() = 0;
         virtual void makeInfluenceMatrix() = 0;
+        /** The coefficient of the influence matrix in row i and column k, without the wake contribution.
+         *  Only implemented by the methods which can run without the dense matrix. */
+        virtual double influenceCoef(int , int ) const {return 0.0;}
+        /** true if the method implements influenceCoef(), so that it can run with a compressed matrix or matrix-free */
+        virtual bool bCompressibleMatrix() const {return false;}
+        bool bCompressedMatrix() const {return m_bCompressed;}
+        bool bMatrixFree() const {return m_bMatrixFree;}
+        bool bDistributedMatrix() const {return m_bDistributed;}
+
+        /** If true, trefftzDrag() reads the Trefftz plane velocities from SpanResFF.m_Vd instead of evaluating them */
+        void setPrecomputedDownwash(bool b) {m_bPrecomputedDownwash=b;}
+        bool bPrecomputedDownwash() const {return m_bPrecomputedDownwash;}
+
+        /** A hash of the geometry of the panels and of the wake panels; 0 if the method does not support the LU cache */
+        virtual std::uint64_t meshHash() const {return 0;}
+        std::uint64_t factorizationKey() const;
+        bool restoreFactorization();
+        void storeFactorization() const;
+        bool restoreFactorization(TaskCheckpoint const &checkpoint);
+        void storeFactorization(TaskCheckpoint const &checkpoint) const;
+        bool hasDenseMatrix() const {return !m_bCompressed && !m_bMatrixFree;}
+        /** Sets the initial guess of the iterative solution of the first RHS column; ignored if its size is not matSize() */
+        void setInitialSolution(std::vector<double> const &x) {if(int(x.size())==matSize()) m_LastSolution.assign(1, x);}
+
+        /** Sets the range of panels whose mutual influence block is shared with the other analyses through the InfluenceBlockCache;
+         *  e.g. the hull panels of a boat whose sails change */
+        void setSharedBlock(int first, int count) {m_SharedBlockFirst=first; m_SharedBlockSize=count; m_SharedBlock.clear();}
+        bool hasSharedBlock() const {return !m_SharedBlock.empty();}
+        bool isInSharedBlock(int iPanel) const {return iPanel>=m_SharedBlockFirst && iPanel<m_SharedBlockFirst+m_SharedBlockSize;}
+        /** the number of rows and columns of the shared block, i.e. of its panels' unknowns */
+        int sharedBlockRows() const {return nPanels()>0 ? m_SharedBlockSize*(matSize()/nPanels()) : 0;}
+
+        bool canUpdateFactorization() const;
+        void prepareFactorizationUpdate();
+        bool updateFactorization(int &rank);
+        void storeReferenceMatrix();
+        void clearFactorizationUpdate();
+        bool hasFactorizationUpdate() const {return m_UpdateRows.size()+m_UpdateCols.size()>0;}
+
+        bool setFrozenFactorization(PanelAnalysis const *pRefPA);
+        bool hasFrozenFactorization() const {return m_pFrozenPA!=nullptr;}
+        bool backSubAdjoint(double *G, int nG);
+        void influenceRow(int i, double *row, unsigned char *bNear) const;
+        bool storeMatrixRow(int i, double const *row);
         virtual void makeUnitRHSBlock(int iBlock) = 0;
         virtual void makeRHSBlock(int iBlock, double *RHS, std::vector<Vector3d> const &VField, Vector3d const*normals) const = 0;
         virtual void makeUnitDoubletStrengths(double alpha, double beta) = 0;
+        virtual void combineUnitDoubletStrengths(double cu, double cv, double cw) = 0;
         virtual void makeWakeMatrixBlock(int iBlock) = 0;
 
         virtual void makeMu(int qrhs) = 0;
@@ -78,7 +134,8 @@ class FL5LIB_EXPORT PanelAnalysis
         virtual void combineLocalVelocities(double alpha, double beta, std::vector<Vector3d> &VLocal) const = 0;
         virtual void computeOnBodyCp(std::vector<Vector3d> const &VInf, std::vector<Vector3d> const &VLocal, std::vector<double>&Cp) const = 0;
         virtual bool computeTrimmedConditions(double mass, Vector3d const &CoG, double &alphaeq, double &u0, bool bFuseMi) = 0;
-        virtual void forces(double const *Mu, double const *Sigma, double alpha, double beta, Vector3d const &CoG, bool bFuseMi, std::vector<Vector3d> const &VInf, Vector3d &Force, Vector3d &Moment) = 0;
+        /** Cp is the array of on-body pressure coefficients required by the near field moment of the triangle methods */
+        virtual void forces(double const *Mu, double const *Sigma, double const *Cp, double alpha, double beta, Vector3d const &CoG, bool bFuseMi, std::vector<Vector3d> const &VInf, Vector3d &Force, Vector3d &Moment) const = 0;
         virtual void inducedForce(int nPanel3, double QInf, double alpha, double beta, int pos, Vector3d &ForceBodyAxes, SpanDistribs &SpanResFF) const = 0;
         virtual void trefftzDrag(int nPanel3, double QInf, double alpha, double beta, int pos, Vector3d &Drag, SpanDistribs &SpanResFF) const = 0;
         virtual int  nPanels() const = 0;
@@ -90,9 +147,20 @@ class FL5LIB_EXPORT PanelAnalysis
         virtual void makeRHSVWVelocitiesBlock(int iFirst, int iLast, bool bVLM, Vector3d *Vpanel);
         virtual void makeNegatingVortices(std::vector<Vortex> &negvortices) = 0;
 
+        /** The velocity queries take the solution as arguments and do not write to the analysis, so that any number of threads
+         *  may evaluate them concurrently on the same solved analysis, provided that the panel tree is not rebuilt meanwhile */
         virtual void getVelocityVector(Vector3d const &C, double const *Mu, double const *Sigma, Vector3d &VT, double coreradius, bool bWakeOnly, bool bMultiThread) const = 0;
+        virtual void getVelocityVectors(int nPts, Vector3d const *C, double const *Mu, double const *Sigma, Vector3d *VT, double coreradius, bool bWakeOnly) const;
+        virtual void velocityVectorRange(int iStart, int iMax, int nPts, Vector3d const *C, double const *Mu, double const *Sigma,
+                                         double coreradius, bool bWakeOnly, Vector3d *VT) const = 0;
+        void getVelocityVectorsReduced(int nPts, Vector3d const *C, double const *Mu, double const *Sigma, Vector3d *VT, double coreradius, bool bWakeOnly) const;
+
+        void makePanelTree(double const *Mu, double const *Sigma);
+        void clearPanelTree() {m_PanelTree.clear();}
+        bool hasPanelTree(double const *Mu, double const *Sigma) const {return m_PanelTree.isBuiltFor(Mu, Sigma);}
 
         void makeUnitRHSVectors();
+        void makeUnitSourceStrengths();
         void makeWakeContribution();
 
         void makeSourceStrengths(Vector3d const &WindDirection);
@@ -104,11 +172,17 @@ class FL5LIB_EXPORT PanelAnalysis
 
         void combineUnitRHS(std::vector<double> &RHS, const Vector3d &VInf, const Vector3d &Omega);
         void makeRHS(const std::vector<Vector3d> &VField, std::vector<double> &RHS, const Vector3d *normals);
+        void makeRHSCoefficients();
+        void combineRHSCoefficients(std::vector<Vector3d> const &VField, std::vector<double> &RHS) const;
+        bool hasRHSCoefficients() const {return !m_RHSCoef.empty();}
 
         void addWakeContribution();
         void computeStabilityDerivatives(  double alphaeq, double u0, Vector3d const &CoG, bool bFuseMi, StabDerivatives &SD, Vector3d &Force0, Vector3d &Moment0);
         void computeTranslationDerivatives(double alphaeq, double u0, Vector3d const &CoG, bool bFuseMi, StabDerivatives &SD, Vector3d &Force0, Vector3d &Moment0);
         void computeAngularDerivatives(    double alphaeq, double u0, Vector3d const &CoG, bool bFuseMi, StabDerivatives &SD);
+        void perturbationForces(double alphaeq, Vector3d const &CoG, bool bFuseMi,
+                                std::vector<double> const *RHS[6], double const *Sigma, std::vector<std::vector<Vector3d>> const &VField,
+                                Vector3d Force[6], Vector3d Moment[6]) const;
 
         void traceLog(const QString &str) const;
         void traceStdLog(const std::string &str) const;
@@ -118,7 +192,11 @@ class FL5LIB_EXPORT PanelAnalysis
         Polar3d const *polar3d() const {return m_pPolar3d;}
 
         int nVortonRows() const {return int(m_Vorton.size());}
-        void clearVortons() {m_Vorton.clear();}
+        void clearVortons() {m_Vorton.clear(); m_VortonTree.clear();}
+        void makeVortonTree();
+        /** Sets the opening angle of the vorton and panel trees of this analysis, in place of the polar's
+         *  and of the global setting; 0 to use these */
+        void setTreeTheta(double theta) {m_TreeTheta = theta>0.0 ? theta : 0.0;}
         void getVortonVelocity(Vector3d const &C, double vtncorelength, Vector3d &VelVtn, bool bMultiThread=false) const;
         void getVortonRowVelocity(int iRow, Vector3d const &C, double vtncorelength, Vector3d *VelVtn) const;
         void getVortonVelocityGradient(Vector3d const &C, double *G) const;
@@ -127,17 +205,92 @@ class FL5LIB_EXPORT PanelAnalysis
         virtual void testResults(double alpha, double beta, double QInf) const = 0;
 
         static void setMultiThread(bool bMulti) {s_bMultiThread=bMulti;}
-        static void setMaxThreadCount(int maxthreads) {s_MaxThreads=maxthreads;}
+        static bool bMultiThread() {return s_bMultiThread;}
+        static void setMaxThreadCount(int maxthreads);
+        static int maxThreadCount() {return s_MaxThreads;}
+        void setThreadCount(int nThreads);
+        int threadCount() const {return m_nThreads;}
+        static void setBlasThreads(int nThreads);
+        static int blasThreads() {return s_BlasThreads;}
+        int blasThreadCount() const;
         static void setDoublePrecision(bool bDouble) {s_bDoublePrecision=bDouble;}
         static bool bDoublePrecision() {return s_bDoublePrecision;}
+        /** In mixed precision mode, the matrix is factorized in single precision and the solutions are refined with
+         *  double precision residuals; only active with double precision */
+        static void setMixedPrecision(bool bMixed) {s_bMixedPrecision=bMixed;}
+        static bool bMixedPrecision() {return s_bDoublePrecision && s_bMixedPrecision;}
+        static void setRefinementSettings(int maxsteps, double tolerance) {s_MaxRefinementSteps=maxsteps; s_RefinementTolerance=tolerance;}
+        /** In low-rank update mode, the sequences in which only a part of the matrix changes between two operating points,
+         *  e.g. control sweeps which move a flap, update the reference factorization instead of making a new one;
+         *  requires two more matrices of the same size in memory. Only active with double precision */
+        static void setLowRankUpdate(bool bUpdate) {s_bLowRankUpdate=bUpdate;}
+        static bool bLowRankUpdate() {return s_bLowRankUpdate;}
+        /** Sets the max. rank of the update as a fraction of the matrix size, above which the matrix is refactorized */
+        static void setMaxUpdateFraction(double fraction) {s_MaxUpdateFraction=fraction;}
+        /** If true and a CUDA device is available, the dense matrix is factorized on the device, whose copy of the factors
+         *  is used for the back-substitutions; the CPU is used whenever the device cannot be used */
+        static void setGpuSolver(bool bGpu) {s_bGpuSolver=bGpu;}
+        static bool bGpuSolver() {return s_bGpuSolver;}
+        /** If true and the application runs as an MPI job of several ranks, the matrix of the methods which support
+         *  the matrix-free mode is assembled by tiles on all the ranks and factorized with ScaLAPACK, so that its size
+         *  is limited by the memory of the whole cluster; all the ranks must run the same analyses in the same order */
+        static void setDistributedSolver(bool bDistributed) {s_bDistributedSolver=bDistributed;}
+        static bool bDistributedSolver() {return s_bDistributedSolver;}
+
+        /** The opening angle of the panel tree used for the off-body velocities; 0 reverts to the direct sum */
+        static void setPanelTreeTheta(double theta) {s_PanelTreeTheta=theta;}
+        static double panelTreeTheta() {return s_PanelTreeTheta;}
 
         static void clearDebugPts() {s_DebugPts.clear(); s_DebugVecs.clear();}
 
 
     protected:
         bool LUfactorize();
+        bool gpuFactorize(bool bDouble);
+        void releaseGpuFactors();
+        bool distributedFactorize();
         virtual void backSubUnitRHS(double *uRHS, double *vRHS, double*wRHS, double *pRHS, double *qRHS, double*rRHS);
         bool backSubRHS(std::vector<double> &RHS);
+        bool backSubRHSBlock(double *RHS, int nRHS);
+        bool LUsolve(double *RHS, int nRHS, bool bDouble, bool bTranspose=false) const;
+        bool backSubRefined(double *RHS, int nRHS, bool bTranspose=false);
+        bool backSubFrozen(double *RHS, int nRHS);
+        bool refinedSolve(PanelAnalysis const *pLU, bool bDoubleLU, double *RHS, int nRHS, bool bTranspose, int maxsteps, double &maxres) const;
+        void residual(double const *B, double const *X, double *R, int nRHS, bool bTranspose) const;
+        void applyFactorizationUpdate(double *RHS, int nRHS) const;
+
+        bool bIterativeSolve() const;
+        void hashMatrixSettings(std::uint64_t &h) const;
+        std::uint64_t sharedBlockKey() const;
+        bool fetchSharedBlock();
+        void storeSharedBlock();
+        static void hashPanel(std::uint64_t &h, Panel const &panel);
+        static void hashPanelGeometry(std::uint64_t &h, Panel const &panel);
+        virtual void makePanelTreeElements(double const *Mu, double const *Sigma, std::vector<PanelTree::Element> &elements) const {(void)Mu; (void)Sigma; elements.clear();}
+        void makeImplicitMatrix();
+        void makePanelSoA();
+        double matrixCoef(int i, int k) const;
+        void addMatrixCoef(int i, int k, double d)
+        {
+            if(!hasDenseMatrix())
+            {
+                int iw = m_WakeColumn.at(k);
+                if(iw>=0) m_WakeCoef[size_t(i)*m_WakeColumnList.size()+iw] += d;
+            }
+            else if(s_bDoublePrecision) m_aijd[size_t(i)*size_t(matSize())+k] += d;
+            else                        m_aijf[size_t(i)*size_t(matSize())+k] += float(d);
+        }
+
+        bool reserveMemory(size_t nBytes, size_t &reserved);
+        void releaseMemory(size_t &reserved);
+
+        bool makeBlockJacobiPreconditioner();
+        void applyBlockJacobiPreconditioner(double *x) const;
+        void makeMultilevelPreconditioner();
+        void addAggregatedMatrix(std::vector<int> const &agg, int nAgg, double *Ac) const;
+        void applyPreconditioner(double *x) const;
+        void systemMatVec(double const *x, double *y) const;
+        bool solveIterative(double *RHS, int nRHS);
 
     protected:
 
@@ -145,14 +298,57 @@ class FL5LIB_EXPORT PanelAnalysis
 
         Polar3d const *m_pPolar3d;
 
-        std::vector<double> m_aijd;  /**< the matrix of panel influences - double precision; std::vector is limited to 2 GB and is unusable*/
-        std::vector<float>  m_aijf;  /**< the matrix of panel influences - single precision; std::vector is limited to 2 GB and is unusable*/
+        std::vector<double, MappedAllocator<double>> m_aijd;  /**< the matrix of panel influences - double precision; mapped to a scratch file if MappedStorage is enabled */
+        std::vector<float, MappedAllocator<float>>   m_aijf;  /**< the matrix of panel influences - single precision; mapped to a scratch file if MappedStorage is enabled */
         std::vector<int>    m_ipiv;  /** the array of pivot indices for the LAPACK LU solver */
+        std::uint64_t m_FactorizationKey;  /**< the key of the current factorization in the LUCache, or 0 */
+
+        int m_SharedBlockFirst;              /**< the first panel of the block shared through the InfluenceBlockCache */
+        int m_SharedBlockSize;               /**< the number of panels of the shared block, or 0 if none */
+        std::vector<double> m_SharedBlock;   /**< the shared block fetched from the cache, row-major; empty if it must be computed */
+
+        // low-rank update of the reference factorization: A = A0 + U.Vt
+        std::vector<double, MappedAllocator<double>> m_aijRef;  /**< the reference matrix A0, before factorization; empty if none */
+        std::vector<double, MappedAllocator<double>> m_LURef;   /**< the LU factors of A0 while the new matrix is assembled in m_aijd; then scratch */
+        std::vector<int>    m_ipivRef;       /**< the pivot indices of the LU factors of A0 */
+        std::vector<int>    m_UpdateRows;    /**< the rows of A-A0 included in the update */
+        std::vector<int>    m_UpdateCols;    /**< the columns of A-A0 included in the update, less the rows in m_UpdateRows */
+        std::vector<double> m_UpdateDRows;   /**< the rows m_UpdateRows of A-A0, row-major */
+        std::vector<double> m_UpdateZ;       /**< A0^-1.U, column-major */
+        std::vector<double> m_UpdateK;       /**< the LU factors of the capacitance matrix I+Vt.A0^-1.U, column-major */
+        std::vector<int>    m_UpdatePiv;     /**< the pivot indices of the capacitance matrix */
+
+        PanelAnalysis const *m_pFrozenPA;    /**< the analysis of a nearby geometry whose LU factors are used to solve the matrix assembled in m_aijd; not owned */
+
+        GpuSolver *m_pGpuSolver;             /**< the device copy of the LU factors, held as long as they match those of the host; owned */
+        DistributedSolver *m_pDistributedSolver; /**< the local tiles of the distributed LU factors; owned */
+        bool m_bDistributed;                 /**< true if the matrix is not stored on this rank, and is factorized by the DistributedSolver */
+
+        PanelSoA m_PanelSoA;                 /**< the packed panel geometry for the far-field kernels of the matrix assembly */
+
+        // compressed representation of the influence matrix
+        bool m_bCompressed;                  /**< true if the influence matrix is stored in m_HMatrix instead of m_aijd/m_aijf */
+        bool m_bMatrixFree;                  /**< true if the influence matrix is not stored, and its coefficients are evaluated at each matrix-vector product */
+        bool m_bPrecomputedDownwash;         /**< true if the Trefftz plane velocities have been superposed from the unit solutions */
+        HMatrix m_HMatrix;                   /**< the influence of the body panels */
+        std::vector<int> m_WakeColumn;       /**< for each column, the index of its wake coefficients in m_WakeCoef, or -1 if the panel does not shed a wake */
+        std::vector<int> m_WakeColumnList;   /**< the columns of the trailing panels */
+        std::vector<double> m_WakeCoef;      /**< the wake contribution to the trailing panels' columns, row-major; used when the dense matrix is not stored */
+
+        // block-Jacobi preconditioner for the iterative solver; one block per contiguous run of rows belonging to the same surface
+        std::vector<int>    m_PrecondStart;  /**< the index of the first row of each diagonal block; the last element is matSize() */
+        std::vector<size_t> m_PrecondOffset; /**< the offset of each block's LU factors in m_PrecondLU */
+        std::vector<double> m_PrecondLU;     /**< the LU factors of the diagonal blocks */
+        std::vector<int>    m_PrecondPiv;    /**< the pivot indices of the diagonal blocks, indexed as the rows */
+        MultilevelPrecond   m_Multilevel;    /**< the coarse-level corrections added to the block-Jacobi preconditioner; empty if not used */
+        std::vector<std::vector<double>> m_LastSolution; /**< the last solution for each RHS column, used as the initial guess of the next solve */
 
 
         // unit RHS for the 6 motion d.o.f
         std::vector<double> m_uRHS, m_vRHS, m_wRHS;
         std::vector<double> m_pRHS, m_qRHS, m_rRHS;
+        std::vector<double> m_UnitSigma;     /**< the source strengths of the six unit motions, interleaved by panel; made by makeUnitRHSVectors() */
+        std::vector<Vector3d> m_RHSCoef;     /**< for each RHS row, the vector which gives the row's RHS from the velocity of the row's panel; made by makeRHSCoefficients() */
 
         // for control derivatives
 
@@ -166,6 +362,9 @@ class FL5LIB_EXPORT PanelAnalysis
         std::vector<double> m_Mu;                /**< The array of doublet strengths, or vortex circulations, associated to the panels. 1 value/panel in the case of the quad methods, 3 values/panel in the case of the triangular methods */
         std::vector<double> m_Sigma;             /**< The array of resulting source strengths of the analysis. 1 value/panel for all methods. */
 
+        size_t m_MatrixBytes;     /**< the memory reserved in the MemoryBudget for the influence matrix */
+        size_t m_ReferenceBytes;  /**< the memory reserved in the MemoryBudget for the matrices of the low-rank update */
+
         bool m_bCancel; /** to interrupt the matrix solver only; */
 
         bool m_bSequence;           /**< true if the calculation is should be performed for a range of aoa */
@@ -173,25 +372,37 @@ class FL5LIB_EXPORT PanelAnalysis
         bool m_bMatrixError;
 
         xfl::enumAnalysisStatus m_AnalysisStatus;
+        int m_nThreads;             /** the number of threads used by this analysis, at most s_MaxThreads */
         int m_nBlocks;              /** the number of row blocks for multithreading */
 
+        static constexpr int MAXSTACKBLOCKS = 256;  /**< the block count up to which the per-point block sums are not heap allocated */
+        static constexpr int VELOCITYTILE = 64;     /**< the max. number of target points evaluated at once by the batched panel kernels */
+
         int m_nStations;          /**< the number of chordwise strips,
                                    which is also the number of panels or stations in the spanwise direction,
                                    which is also the number of wake columns*/
 
 
         std::vector<std::vector<Vorton>> m_Vorton; /** The array of vorton rows. Vortons are organized in rows. Each row is located in a crossflow plane. The number of vortons is variable for each row, due to vortex stretching and vorton redistribution. */
+        VortonTree m_VortonTree;            /** The octree of the vortons for the far-field evaluation of their velocities; empty if unused */
+        PanelTree m_PanelTree;              /** The octree of the panels for the far-field evaluation of the off-body velocities; empty if unused */
+        double m_TreeTheta;                 /** the opening angle of both trees if positive, in place of the default settings */
         std::vector<Vortex> m_VortexNeg;    /** The array of negating vortices at the trailing edge of the trailing wake panel of each wake column. cf. Willis 2005 fig. 3*/
 
 
         static bool s_bDoublePrecision;
+        static bool s_bMixedPrecision;
+        static int s_MaxRefinementSteps;       /**< the max. number of iterative refinement steps in mixed precision mode */
+        static double s_RefinementTolerance;   /**< the relative residual at which the iterative refinement stops */
+        static int s_MaxFrozenSteps;           /**< the max. number of defect correction steps with a frozen factorization */
+        static bool s_bLowRankUpdate;
+        static double s_MaxUpdateFraction;     /**< the max. rank of the low-rank update, as a fraction of the matrix size */
+        static bool s_bGpuSolver;
+        static bool s_bDistributedSolver;
+        static double s_PanelTreeTheta;        /**< the opening angle of the panel tree, or 0 to disable it */
         static bool s_bMultiThread;
         static int s_MaxThreads;
-
-        mutable double const *tmp_Mu;
-        mutable double const *tmp_Sigma;
-        mutable double tmp_coreradius;
-        mutable bool tmp_bWakeOnly;
+        static int s_BlasThreads;              /**< the number of threads of the MKL calls, or 0 to use m_nThreads */
 
     public:
         static std::vector<Vector3d> s_DebugPts;
@@ -0,0 +1,65 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <vector>
+
+#include <fl5lib_global.h>
+#include <vector3d.h>
+
+class Panel;
+
+/**
+ * @class PanelSoA
+ * @brief A packed structure-of-arrays copy of the panel geometry used by the far-field kernels.
+ *
+ * The loops of the far-field kernels have no branches and no calls, and operate on contiguous arrays,
+ * so that the compiler can evaluate one field point against 4 or 8 panels at once (SSE2, AVX2 or AVX-512
+ * depending on the target flags).
+ * The panels which are too close to the field point for the far-field formula are flagged,
+ * and their influence is left to the exact per-panel methods.
+ */
+class FL5LIB_EXPORT PanelSoA
+{
+    public:
+        PanelSoA() = default;
+
+        void clear();
+        void resize(int n);
+        int size() const {return int(m_x.size());}
+
+        void setPanel(int i, Panel const &panel, Vector3d const &refpt, bool bFarFieldEligible);
+
+        void doubletFarFieldPotential(Vector3d const &C, double inplaneprecision, double *phi, unsigned char *bNear) const;
+        void addDoubletFarFieldPotential(Vector3d const &C, double inplaneprecision, double coef, double *phi, unsigned char *bNear) const;
+
+    private:
+        std::vector<double> m_x, m_y, m_z;      /**< the reference point of the far-field formula */
+        std::vector<double> m_nx, m_ny, m_nz;   /**< the panel's normal */
+        std::vector<double> m_Area;
+        std::vector<double> m_FFDist;           /**< the distance beyond which the far-field formula applies, i.e. RFF x panel size; infinite if the formula does not apply, e.g. for VLM panels */
+};
+
@@ -0,0 +1,146 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include <fl5lib_global.h>
+#include <vector3d.h>
+
+/**
+ * @class PanelTree
+ * @brief An octree of the panels and wake panels for the far-field evaluation of their induced velocities.
+ *
+ * Each element is reduced for the far field to a point source of strength sigma.A and to
+ * a point doublet of moment mu.A.n located at the panel's centre.
+ * Each node holds the monopole and dipole moments of its elements about their centroid.
+ * A node is used in place of its elements when its size seen from the evaluation point is
+ * less than the opening angle theta; the elements of the near leaves are evaluated with the
+ * exact panel kernels supplied by the caller.
+ * Since the first neglected term is the quadrupole, the relative error of a far node is of the
+ * order of its size seen from the point, so that theta should be kept below about 0.3.
+ * The tree is a snapshot of the doublet and source strengths and must be rebuilt each time they change.
+ */
+class FL5LIB_EXPORT PanelTree
+{
+    public:
+        /** A panel or a wake panel reduced to its far-field moments */
+        struct Element
+        {
+            Vector3d m_Position;      /**< the centre of the panel */
+            double m_Radius{0};       /**< the radius of the sphere centred on m_Position which contains the panel */
+            double m_Source{0};       /**< the source strength times the area */
+            Vector3d m_Dipole;        /**< the doublet strength times the area times the normal */
+            int m_Panel{-1};          /**< the index of the panel, or of the panel which sheds the wake panel */
+            int m_Wake{-1};           /**< the index of the wake panel, or -1 for a panel */
+        };
+
+    private:
+        struct Node
+        {
+            Vector3d m_Center;        /**< the center of the cubic cell */
+            double m_HalfSize{0};     /**< the half width of the cell */
+            Vector3d m_Expansion;     /**< the centroid of the elements, about which the moments are taken */
+            double m_Radius{0};       /**< the radius of the sphere centred on m_Expansion which contains the elements */
+            double m_Source{0};       /**< the sum of the sources */
+            Vector3d m_Dipole;        /**< the sum of the doublets and of the first moment of the sources */
+            int m_First{0};           /**< the index of the first element of the cell in m_Element */
+            int m_Count{0};           /**< the number of elements in the cell */
+            int m_Child[8]{-1,-1,-1,-1,-1,-1,-1,-1};
+            bool m_bLeaf{true};
+        };
+
+    public:
+        PanelTree();
+
+        void clear() {m_Node.clear(); m_Element.clear(); m_pMu=m_pSigma=nullptr;}
+        void build(std::vector<Element> const &elements, double const *Mu, double const *Sigma);
+        bool isEmpty() const {return m_Element.empty();}
+
+        /** Returns true if the tree was built for these arrays of doublet and source strengths */
+        bool isBuiltFor(double const *Mu, double const *Sigma) const {return !isEmpty() && Mu==m_pMu && Sigma==m_pSigma;}
+
+        void setTheta(double theta) {m_Theta=theta;}
+        double theta() const {return m_Theta;}
+
+        /**
+         * Returns in V the velocity induced at point C by the elements.
+         * nearField(Element const &, Vector3d const &C, Vector3d &v) returns in v
+         * the exact velocity induced at point C by an element of a near leaf.
+         */
+        template<typename NearField>
+        void inducedVelocity(Vector3d const &C, Vector3d &V, NearField const &nearField) const
+        {
+            V.reset();
+            if(m_Node.empty()) return;
+
+            Vector3d v;
+            // a fixed stack, since the traversal is made for each field point
+            int stack[s_MaxStack];
+            int nStack = 0;
+            stack[nStack++] = 0;
+            while(nStack>0)
+            {
+                Node const &node = m_Node.at(stack[--nStack]);
+
+                if(isFarField(node, C))
+                {
+                    farFieldVelocity(node, C, v);
+                    V += v;
+                }
+                else if(node.m_bLeaf)
+                {
+                    for(int i=node.m_First; i<node.m_First+node.m_Count; i++)
+                    {
+                        nearField(m_Element.at(i), C, v);
+                        V += v;
+                    }
+                }
+                else
+                {
+                    for(int io=0; io<8; io++)
+                        if(node.m_Child[io]>=0) stack[nStack++] = node.m_Child[io];
+                }
+            }
+        }
+
+    private:
+        int makeNode(Vector3d const &center, double halfsize, int first, int count, int depth);
+        bool isFarField(Node const &node, Vector3d const &C) const;
+        void farFieldVelocity(Node const &node, Vector3d const &C, Vector3d &V) const;
+
+    private:
+        std::vector<Node> m_Node;         /**< the root is the first node */
+        std::vector<Element> m_Element;   /**< the elements, sorted so that the elements of each cell are contiguous */
+        double m_Theta;                   /**< the opening angle criterion */
+
+        double const *m_pMu;              /**< the doublet strengths for which the tree was built; used only as a key */
+        double const *m_pSigma;           /**< the source strengths for which the tree was built; used only as a key */
+
+        static int s_LeafSize;
+        static constexpr int s_MaxDepth = 20;
+        static constexpr int s_MaxStack = 7*s_MaxDepth+1;   /**< the depth-first traversal pops one node and pushes at most 8 per level */
+};
+
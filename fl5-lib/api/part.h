@@ -118,6 +118,8 @@ class FL5LIB_EXPORT Part
 
         virtual bool serializePartFl5(QDataStream &ar, bool bIsStoring);
 
+        size_t memoryFootprint() const {return m_TriMesh.memoryFootprint();}
+
         // INERTIA
         // all inertia properties are defined in the part's body axis
 
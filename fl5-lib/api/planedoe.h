@@ -0,0 +1,140 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <fl5lib_global.h>
+#include <planepolar.h>
+
+class PlaneXfl;
+
+
+/**
+ * @class PlaneDoE
+ * @brief Runs a design of experiments on the variants of a base plane.
+ *
+ * The variants are defined by a full-factorial or Latin-hypercube sampling of the variables
+ * used by the plane optimizer, i.e. mass, CoG, span, chord, sweep and twist, and of the section
+ * geometry. Each variant is rebuilt from the base plane in a worker context when it is analysed,
+ * so the memory used does not depend on the number of variants. The results are stored in a
+ * columnar table with one row per operating point.
+ *
+ * The variants are grouped by geometry; the first variant of a group is analysed before the others,
+ * so that they find its factorization in the LUCache. The contexts are kept from one variant to the next,
+ * so that the plane's connection data is reused for the parts which have not changed.
+ */
+class FL5LIB_EXPORT PlaneDoE
+{
+    public:
+        enum enumSampling {FULLFACTORIAL, LATINHYPERCUBE};
+
+        /** The variable types; the types before SPAN do not modify the geometry */
+        enum enumField {MASS, COGX, COGZ, SPAN, ROOTCHORD, SWEEP, TIPTWIST, SECTIONCHORD, SECTIONTWIST, SECTIONOFFSET, SECTIONDIHEDRAL};
+
+        struct Variable
+        {
+            enumField m_Field{MASS};
+            int m_iWing{0};          /**< the index of the wing, for the wing and section variables */
+            int m_iSection{0};       /**< the index of the section, for the section variables */
+            double m_Min{0.0};
+            double m_Max{0.0};
+            int m_nLevels{2};        /**< the number of values of a full-factorial sampling */
+
+            bool isGeometric() const {return m_Field>=SPAN;}
+            std::string name() const;
+        };
+
+    private:
+        struct Context;
+
+    public:
+        PlaneDoE();
+        ~PlaneDoE();
+
+        void setBase(PlaneXfl const *pPlane, PlanePolar const *pPolar);
+        void setOppList(std::vector<double> const &opplist) {m_OppList=opplist;}
+
+        void addVariable(Variable const &var) {m_Variable.push_back(var);}
+        void clearVariables() {m_Variable.clear();}
+        int nVariables() const {return int(m_Variable.size());}
+
+        void setSampling(enumSampling sampling, int nSamples=0, unsigned int seed=0);
+        int nVariants() const;
+        double sampleValue(int iVariant, int iVar) const;
+
+        bool run();
+        void cancel();
+
+        int nFailed() const {return m_nFailed;}
+        std::string const &log() const {return m_Log;}
+
+        int nRows() const {return m_Columns.empty() ? 0 : int(m_Columns.front().size());}
+        int nColumns() const {return int(m_ColumnNames.size());}
+        std::string const &columnName(int iCol) const {return m_ColumnNames.at(iCol);}
+        std::vector<double> const &column(int iCol) const {return m_Columns.at(iCol);}
+
+        std::string exportToString(std::string const &separator) const;
+        bool writeColumns(std::string const &pathname) const;
+
+    private:
+        void makeSamples();
+        void makeColumns();
+        std::vector<std::vector<int>> geometryGroups() const;
+        bool runVariant(int iVariant, Context &ctx);
+        void makeVariant(int iVariant, PlaneXfl &plane, PlanePolar &polar) const;
+
+        Context *acquireContext();
+        void releaseContext(Context *pCtx);
+        void clearContexts();
+
+    private:
+        PlaneXfl const *m_pBasePlane;
+        PlanePolar m_BasePolar;
+        std::vector<double> m_OppList;
+
+        std::vector<Variable> m_Variable;
+        enumSampling m_Sampling;
+        int m_nSamples;                          /**< the number of variants of a Latin-hypercube sampling */
+        unsigned int m_Seed;
+        std::vector<std::vector<double>> m_LHSValues;   /**< the Latin-hypercube samples, one array per variable */
+
+        std::vector<std::string> m_ColumnNames;
+        std::vector<std::vector<double>> m_Columns;
+        std::mutex m_ResultMutex;
+
+        std::vector<Context*> m_Contexts;        /**< all the contexts */
+        std::vector<Context*> m_FreeContexts;    /**< the contexts not in use by a worker */
+        std::mutex m_ContextMutex;
+
+        std::atomic<bool> m_bCancel;
+        std::atomic<int> m_nFailed;
+        std::string m_Log;
+};
+
@@ -105,7 +105,10 @@ class FL5LIB_EXPORT PlaneOpp : public Opp3d
         bool isOut() const {return m_bOut;}
 
         bool serializePOppXFL(QDataStream &ar, bool bIsStoring);
-        bool serializeFl5(QDataStream &ar, bool bIsStoring);
+        bool serializeFl5(QDataStream &ar, bool bIsStoring, bool bDeferFields=false);
+
+        size_t memoryFootprint() const override;
+        void clearFields() override;
 
         void getProperties(const Plane *pPlane, const PlanePolar *pWPolar, std::string &properties) const;
 
@@ -0,0 +1,81 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+
+#include <QByteArray>
+
+#include <fl5lib_global.h>
+
+class PlaneOpp;
+
+
+/**
+ * @class PlaneOppCache
+ * @brief A process-wide cache of the operating points computed by the plane tasks.
+ *
+ * The polars re-run with overlapping operating point lists after changes which do not affect
+ * the flow, e.g. a new name, a new style or an extended range, recompute the same points.
+ * An entry is identified by a hash of the mesh, of the aerodynamic specification of the polar,
+ * of the operating point's angles and speed and of the solver settings, so that the points which
+ * match are copied from the cache and only the new points are solved.
+ * The operating points are stored serialized and evicted in LRU order when the memory budget is exceeded.
+ */
+class FL5LIB_EXPORT PlaneOppCache
+{
+    private:
+        struct Entry
+        {
+            std::uint64_t m_Key{0};
+            QByteArray m_Data;
+        };
+
+    public:
+        static PlaneOpp *fetch(std::uint64_t key);
+        static void store(std::uint64_t key, PlaneOpp *pPOpp);
+        static void clear();
+
+        static void setEnabled(bool bEnabled) {s_bEnabled=bEnabled;}
+        static bool isEnabled() {return s_bEnabled;}
+
+        /** Sets the max. memory used by the cache, in MB */
+        static void setMaxMemory(double MB) {s_MaxMemory=MB;}
+        static double maxMemory() {return s_MaxMemory;}
+        static double memorySize();
+
+    private:
+        static size_t totalSize();
+
+    private:
+        static std::list<Entry> s_Entries;    /**< the most recently used entry first */
+        static std::mutex s_Mutex;
+        static bool s_bEnabled;
+        static double s_MaxMemory;
+};
+
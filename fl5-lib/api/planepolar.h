@@ -90,6 +90,7 @@ class FL5LIB_EXPORT PlanePolar : public Polar3d
 
         double variable(int iVariable, int index) const;
         virtual double getVariable(int iVar, int index) const;
+        virtual void getColumn(int iVar, std::vector<double> &values) const;
         virtual void setData(int iVariable, int index, double value);
 
         virtual void insertDataPointAt(int index, bool bAfter);
@@ -101,6 +102,8 @@ class FL5LIB_EXPORT PlanePolar : public Polar3d
         virtual bool serializeFl5v726(QDataStream &ar, bool bIsStoring) override;
         virtual bool serializeFl5v750(QDataStream &ar, bool bIsStoring) override;
 
+        size_t memoryFootprint() const;
+
         void setPlane(Plane const *pPlane) {m_pPlane = pPlane;}
 
         std::string const &planeName()  const {return m_PlaneName;}      /**< returns the name of the polar's parent object as a QString object. */
@@ -227,6 +230,8 @@ class FL5LIB_EXPORT PlanePolar : public Polar3d
         double massCtrl(double ctrl) const;
         Vector3d CoGCtrl(double ctrl) const;
 
+        bool differsOnlyInInertia(PlanePolar const *pWPolar) const;
+
         AeroForces const &aeroForce(int index) const {return m_AF.at(index);}
 
         static std::vector<std::string> const &variableNames() {return s_VariableNames;}
@@ -27,14 +27,22 @@
 #include <planepolar.h>
 
 
+/**
+ * @class PlanePolarExt
+ * @brief A polar imported from an external source, which stores the values of the variables rather than the aerodynamic forces.
+ *
+ * The values are held in a single block, one column per variable; each column has room for capacity() points
+ * so that the points are appended and inserted without reallocating the block each time.
+ */
 class FL5LIB_EXPORT PlanePolarExt : public PlanePolar
 {
     public:
         PlanePolarExt();
 
         double getVariable(int iVariable, int index) const override;
+        void getColumn(int iVariable, std::vector<double> &values) const override;
         void setData(int iVariable, int index, double value) override;
-        int dataSize() const override;
+        int dataSize() const override {return m_nPoints;}
         void resizeData(int newsize) override;
         bool serializeFl5v726(QDataStream &ar, bool bIsStoring) override;
         bool serializeFl5v750(QDataStream &ar, bool bIsStoring) override;
@@ -44,7 +52,17 @@ class FL5LIB_EXPORT PlanePolarExt : public PlanePolar
         void insertDataPointAt(int index, bool bAfter) override;
         void removeAt(int index) override;
 
+        int capacity() const {return m_Capacity;}
+        void reserve(int capacity);
+        /** @return a pointer to the dataSize() contiguous values of the variable */
+        double const *column(int iVariable) const {return m_Data.data() + size_t(iVariable)*size_t(m_Capacity);}
+
     private:
-        std::vector<std::vector<double>> m_data;
-};
+        double *column(int iVariable) {return m_Data.data() + size_t(iVariable)*size_t(m_Capacity);}
 
+    private:
+        std::vector<double> m_Data;   /**< the values, variable by variable; each column holds m_Capacity values of which the first m_nPoints are used */
+        int m_nVariables;
+        int m_nPoints;
+        int m_Capacity;
+};
@@ -27,12 +27,14 @@
 #include <vector>
 #include <map>
 #include <string>
+#include <thread>
 
 #include <task3d.h>
 #include <t8opp.h>
 #include <aeroforces.h>
 #include <spandistribs.h>
 #include <stabderivatives.h>
+#include <taskcheckpoint.h>
 #include <vorton.h>
 
 class Plane;
@@ -45,9 +47,11 @@ class Surface;
 class Panel3;
 class Panel4;
 class AngleControl;
+class Foil;
 class Polar;
 class XFoilTask;
 class NeuralFoilPolarCache;
+class PolarMeshGenerator;
 
 
 class FL5LIB_EXPORT PlaneTask : public Task3d
@@ -63,11 +67,23 @@ class FL5LIB_EXPORT PlaneTask : public Task3d
         void setStabOppList(const std::vector<double> &opplist);
         void setT8OppList(const std::vector<T8Opp> &ranges);
 
+        std::vector<double> const &oppList()     const {return m_AngleList;}
+        std::vector<double> const &ctrlOppList() const {return m_T6CtrlList;}
+        std::vector<double> const &stabOppList() const {return m_T7CtrlList;}
+        std::vector<T8Opp>  const &t8OppList()   const {return m_T8Opps;}
+
         double ctrl() const {return m_Ctrl;}
         double aoa()  const {return m_Alpha;}
 
         void setObjects(Plane *pPlane, PlanePolar *pWPolar);
+        /** Sets the analysis of a nearby geometry whose LU factors are reused to solve the linear system, e.g. for the
+         *  perturbations of a sensitivity analysis; must remain unchanged while this task runs; nullptr to clear */
+        void setReferenceAnalysis(PanelAnalysis const *pRefPA) {m_pRefPA=pRefPA;}
         std::vector<PlaneOpp*> const & planeOppList() const {return m_PlaneOppList;}
+        /** Sets the T1 to T5, T7 and T8 polars which differ from the task's polar only in mass, CoG or inertia;
+         *  their operating points are built from the task's flow solutions without solving the flow again.
+         *  The polars which do not qualify are skipped with a message in the log. */
+        void setLoadingPolars(std::vector<PlanePolar*> const &polars) {m_LoadingPolars=polars;}
 
         Plane *plane()  const {return m_pPlane;}
         PlanePolar*wPolar() const {return m_pPlPolar;}
@@ -77,6 +93,14 @@ class FL5LIB_EXPORT PlaneTask : public Task3d
         void getVelocityVector(Vector3d const &C, double coreradius, bool bMultiThread, Vector3d &velocity) const;
 
         void setComputeDerivatives(bool b) {m_bDerivatives=b;}
+        bool bComputeDerivatives() const {return m_bDerivatives;}
+
+        /** If true, the fixed wake polars of type 1 to 5 and 8 keep the unit solutions after the run,
+         *  so that superposeOpp() can make other operating points without solving the flow again */
+        void setKeepUnitSolutions(bool b) {m_bKeepUnitSolutions=b;}
+        bool hasUnitSolutions() const {return m_uVUnit.size()>0;}
+        static bool canSuperpose(PlanePolar const *pPolar);
+        PlaneOpp *superposeOpp(double alpha, double beta, double QInf);
 
         void run() override;
 
@@ -89,8 +113,30 @@ class FL5LIB_EXPORT PlaneTask : public Task3d
         static double viscRelaxFactor() {return s_ViscRelax;}
         static bool bViscInitVTwist() {return s_bViscInitTwist;}
         static void setViscInitVTwist(bool bInit) {s_bViscInitTwist=bInit;}
-
-    private:
+        /** If true, the relaxation factor of the viscous loop is adapted at each iteration using Aitken's method */
+        static bool bViscAitken() {return s_bViscAitken;}
+        static void setViscAitken(bool bAitken) {s_bViscAitken=bAitken;}
+
+        /** If true, the fixed wake polars superpose the Trefftz plane velocities of the three unit solutions
+         *  rather than re-evaluating them at each operating point */
+        static bool bSuperposeDownwash() {return s_bSuperposeDownwash;}
+        static void setSuperposeDownwash(bool b) {s_bSuperposeDownwash=b;}
+
+        /** If true, the operating points of the T6 and T8 sweeps are built in a second stage
+         *  which overlaps the solution of the next point */
+        static bool bPipelined() {return s_bPipelined;}
+        static void setPipelined(bool b) {s_bPipelined=b;}
+
+        /** If true, the triangular meshes with intersecting or overlapping panels are rejected before the matrix is built;
+         *  the gap is relative to the panels' shortest edge, see TriMesh::checkIntersections() */
+        static bool bCheckIntersections() {return s_bCheckIntersections;}
+        static void setCheckIntersections(bool b) {s_bCheckIntersections=b;}
+        static double intersectionGap() {return s_IntersectionGap;}
+        static void setIntersectionGap(double gap) {s_IntersectionGap=gap;}
+
+        void traceStdLog(std::string const &str) override;
+
+    protected:
         bool T123458Loop();
         bool T6Loop();
         bool T7Loop();
@@ -106,9 +152,12 @@ class FL5LIB_EXPORT PlaneTask : public Task3d
         void computeInviscidAero(const std::vector<Panel3> &panel3, const double *Cp3Vtx, const PlanePolar *pWPolar, double Alpha, AeroForces &AF) const;
         void computeInducedForces(double alpha, double beta, double QInf);
         void computeInducedDrag(double alpha, double beta, double QInf);
+        void makeUnitTrefftzVelocities(std::vector<std::vector<Vector3d>> unitVd[3]);
+        void combineUnitTrefftzVelocities(double alpha, double beta, std::vector<std::vector<Vector3d>> const unitVd[3]);
         bool computeViscousDrag(WingXfl *pWing, double alpha, double beta, double QInf, const PlanePolar *pWPolar, Vector3d const &cog, int iStation0, SpanDistribs &SpanResFF, std::string &logmsg) const;
         bool computeViscousDragOTF(WingXfl *pWing, double alpha, double beta, double QInf, const PlanePolar *pWPolar, Vector3d const &cog, const AngleControl &TEFlapAngles, SpanDistribs &SpanResFF, std::string &logmsg);
-        bool computeSurfaceDragOTF(Surface const &surf, int iStartStation, double theta, SpanDistribs &spandist);
+        void makeSurfaceDragOTF(Surface const &surf, int iStartStation, double theta, SpanDistribs const &spandist, Foil *sideFoil, Polar *sidePolar) const;
+        bool collectSurfaceDragOTF(Surface const &surf, int iStartStation, Polar const *sidePolar, SpanDistribs &spandist);
         bool computeSectionDragOTF(XFoilTask *pTask) const;
 
 #ifdef NEURALFOIL_ENABLED
@@ -131,19 +180,36 @@ class FL5LIB_EXPORT PlaneTask : public Task3d
         void makeVortonRow(int qrhs) override;
 
         bool updateVirtualTwist(double QInf, double &error, std::string &log);
+        void resetViscousRelaxation();
 
         bool setLinearSolution();
 
         bool computeStability(PlaneOpp *pPOpp, bool bOutput);
 
-        void storePOpp(PlaneOpp *pPOpp);
+        void storePOpp(PlaneOpp *pPOpp, int iOpp=-1);
 
-    private:
+        std::vector<PlanePolar*> makeLoadingPolarList();
+
+        std::uint64_t checkpointKey() const;
+        std::uint64_t oppKey(T8Opp const &t8opp) const;
+        void openCheckpoint();
+
+        PlaneTask *makePostTask();
+        void launchPostTask(double ctrl, double alpha, double beta, double phi, double QInf, double mass, Vector3d const &CoG, bool bInGeomAxes);
+        void finishPostTask();
+
+        void startPolarMesh(PlaneXfl const *pPlaneXfl);
+        void finishPolarMesh();
+
+    protected:
 
         Plane *m_pPlane;
         PlanePolar *m_pPlPolar;
         std::vector<PlaneOpp*> m_PlaneOppList;
 
+        PanelAnalysis const *m_pRefPA;   /**< the analysis whose factorization is reused, or nullptr */
+        std::vector<PlanePolar*> m_LoadingPolars; /**< the polars which share the flow solutions of the task's polar */
+
         bool m_bDerivatives;       /**< if true, computes the eigenthings when running a T123458 polar */
 
         double m_Ctrl;             /**< the oppoint currently calculated */
@@ -167,15 +233,40 @@ class FL5LIB_EXPORT PlaneTask : public Task3d
 
         std::vector<double> m_gamma;    /**< the virtual twist angle for each span section; cf. Computationally Efficient Transonic and Viscous Potential Flow Aero-Structural Method for Rapid Multidisciplinary Design Optimization of Aeroelastic Wing Shaping Control, by Eric Ting and Daniel Chaparro,  Advanced Modeling and Simulation (AMS) Seminar Series, Advanced Advanced Air Air Vehicles Transport Program Technology Project NASA Ames Research Center, June 28, 2017 */
 
+        std::vector<double> m_ViscResidual; /**< the virtual twist corrections of the previous viscous iteration */
+        double m_ViscOmega;                 /**< the relaxation factor of the previous viscous iteration */
+        double m_ViscRms;                   /**< the rms of the virtual twist corrections of the previous viscous iteration */
+        int m_iViscMax;                     /**< the plane station of the largest correction of the previous viscous iteration */
+
+        TaskCheckpoint m_Checkpoint;        /**< the persistent state from which the task is resumed if interrupted; closed if checkpoints are disabled */
+        std::vector<std::uint64_t> m_OppKeys; /**< the keys of the T8 operating points in the PlaneOppCache, or 0 if the point is not cached */
+
+        bool m_bKeepUnitSolutions;                      /**< if true, the unit solutions are kept after the T123458 loop */
+        std::vector<Vector3d> m_uVUnit, m_vVUnit, m_wVUnit;  /**< the on-body velocities of the unit solutions, or empty if not kept */
+        std::vector<std::vector<Vector3d>> m_UnitVd[3]; /**< the Trefftz plane velocities of the unit solutions, or empty if not kept */
+
 #ifdef NEURALFOIL_ENABLED
         std::map<std::string, NeuralFoilPolarCache*> m_NFPolarCaches;  /**< Per-foil polar caches for NF interpolated mode */
 #endif
 
+        // the second stage of the pipelined sweeps
+        PlaneTask *m_pMasterTask;        /**< the task which launched this post-processing task, or nullptr */
+        PlaneTask *m_pPostTask;          /**< the post-processing task in flight, or nullptr */
+        PlaneOpp *m_pPostPOpp;           /**< the operating point built by the post-processing task */
+        std::thread m_PostThread;
+
+        PolarMeshGenerator *m_pPolarMesh; /**< the generator of the missing foil polars, running while the analysis is initialized, or nullptr */
+
     private:
         static bool s_bViscInitTwist;
         static double s_ViscRelax;
         static double s_ViscAlphaPrecision;
         static int s_ViscMaxIter;
+        static bool s_bViscAitken;
+        static bool s_bSuperposeDownwash;
+        static bool s_bPipelined;
+        static bool s_bCheckIntersections;
+        static double s_IntersectionGap;
 
 };
 
@@ -102,6 +102,8 @@ class FL5LIB_EXPORT PlaneXfl : public Plane
         bool serializePlaneXFL(QDataStream &ar, bool bIsStoring);
         bool serializePlaneFl5(QDataStream &ar, bool bIsStoring) override;
 
+        size_t memoryFootprint() const override;
+
         bool hasMainWing() const override;
         bool hasOtherWing() const override;
 //        bool hasWing2() const override;
@@ -244,7 +246,6 @@ class FL5LIB_EXPORT PlaneXfl : public Plane
         void setThickBuild(bool b) {m_bThickBuild=b;}
         bool isThickBuild() const {return m_bThickBuild;}
 
-
     private:
 
         bool m_bThickBuild;
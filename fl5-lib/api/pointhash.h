@@ -0,0 +1,76 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <vector3d.h>
+
+/**
+ * @class PointHash
+ * @brief A uniform grid of points hashed on their quantised coordinates, used to find coincident nodes and edges in linear time.
+ *
+ * With a cell size greater or equal to the search precision, all the points which are the same as a given point
+ * to within the precision are stored in one of the 27 cells surrounding the point.
+ * The hash only returns candidates; the caller is responsible for the exact test.
+ */
+class FL5LIB_EXPORT PointHash
+{
+    private:
+        struct CellKey
+        {
+            int64_t m_i{0}, m_j{0}, m_k{0};
+            bool operator==(CellKey const &key) const {return m_i==key.m_i && m_j==key.m_j && m_k==key.m_k;}
+        };
+
+        struct CellKeyHash
+        {
+            size_t operator()(CellKey const &key) const
+            {
+                return size_t(key.m_i*73856093) ^ size_t(key.m_j*19349663) ^ size_t(key.m_k*83492791);
+            }
+        };
+
+    public:
+        PointHash(double cellsize);
+
+        void clear() {m_Cell.clear();}
+        void reserve(int nPoints) {m_Cell.reserve(nPoints);}
+        double cellSize() const {return m_CellSize;}
+
+        void insert(Vector3d const &pt, int index);
+        void candidates(Vector3d const &pt, std::vector<int> &indexes) const;
+
+    private:
+        CellKey cellKey(Vector3d const &pt) const;
+
+    private:
+        std::unordered_map<CellKey, std::vector<int>, CellKeyHash> m_Cell;
+        double m_CellSize;
+};
+
@@ -26,6 +26,8 @@
 #pragma once
 
 
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include <xflobject.h>
@@ -50,6 +52,48 @@ class FL5LIB_EXPORT Polar : public XflObject
         enum enumPolarVariable {ALPHA, CTRL, CL, CD, CDE4, CDP, CM, HMOM, CPMIN, CLCD, CL32CD, CLM12, RE, XCP, XTRTOP, XTRBOT, XLSTOP, XLSBOT, XTSTOP, XTSBOT};
 
 
+        /** A monotone piecewise cubic Hermite curve y(x), which does not overshoot the data between the nodes */
+        struct FittedCurve
+        {
+            std::vector<double> m_x;    /**< the strictly increasing abscissas */
+            std::vector<double> m_y;    /**< the smoothed values at the nodes */
+            std::vector<double> m_dy;   /**< the Fritsch-Carlson slopes at the nodes */
+
+            bool covers(double x) const {return m_x.size()>=2 && m_x.front()<=x && x<=m_x.back();}
+            void make(std::vector<double> const &x, std::vector<double> const &y, bool bSmooth);
+            double value(double x) const;
+        };
+
+        /**
+         * The smoothed representations of the main variables of the polar, as functions of the aoa
+         * on the sorted run of aoa values, and as functions of Cl on the monotonic run of Cl values around Cl=0.
+         */
+        struct InterpolationFit
+        {
+            static int fitIndex(enumPolarVariable var);
+
+            std::vector<FittedCurve> m_AlphaCurves;  /**< one curve per fitted variable, cf. fitIndex() */
+            std::vector<FittedCurve> m_ClCurves;     /**< one curve per fitted variable, cf. fitIndex() */
+        };
+
+
+        /**
+         * The data precomputed from the polar's points for repeated interpolations;
+         * valid as long as dataRevision() is unchanged.
+         */
+        struct InterpolationIndex
+        {
+            int m_Revision{-1};     /**< the data revision of the polar when the index was made */
+            double m_ClMin{0}, m_ClMax{0};
+            double m_AlphaMin{0}, m_AlphaMax{0};
+            int m_iClZero{0};       /**< the point closest to Cl=0, from which the Cl interpolation starts */
+            int m_iClUp{0};         /**< the last point of the non-decreasing run of Cl values from m_iClZero upwards */
+            int m_iClDown{0};       /**< the first point of the non-decreasing run of Cl values ending at m_iClZero */
+            int m_iAlphaUp{0};      /**< the last point of the non-decreasing run of aoa values from the first point */
+            bool m_bFitted{false};  /**< the value of bFittedInterpolation() when the index was made */
+            std::shared_ptr<InterpolationFit const> m_pFit;   /**< the smoothed curves, or nullptr; shared by the copies of the index */
+        };
+
 
     public:
         Polar();
@@ -58,6 +102,15 @@ class FL5LIB_EXPORT Polar : public XflObject
         double interpolateFromAlpha(double alpha, Polar::enumPolarVariable PlrVar, bool &bOutAlpha) const;
         double interpolateFromCl(double Cl, Polar::enumPolarVariable PlrVar, bool &bOutCl) const;
 
+        void makeInterpolationIndex(InterpolationIndex &index) const;
+        double interpolateFromAlpha(double alpha, Polar::enumPolarVariable PlrVar, bool &bOutAlpha, InterpolationIndex const &index) const;
+        double interpolateFromCl(double Cl, Polar::enumPolarVariable PlrVar, bool &bOutCl, InterpolationIndex const &index) const;
+
+        /** changed each time the points are changed by the methods of this class, to a value which is unique
+         *  among all the polars; the code which writes directly into the data arrays should call setDataModified() */
+        int dataRevision() const {return m_DataRevision;}
+        void setDataModified() {m_DataRevision = ++s_LastDataRevision;}
+
         void addOpPointData(OpPoint *pOpPoint);
 
         void addPoint(double Alpha, double Cd, double Cdp, double Cl, double Cm, double HMom, double Cpmn, double Reynolds, double XCp, double Ctrl,
@@ -96,7 +149,7 @@ class FL5LIB_EXPORT Polar : public XflObject
         void setAoaSpec(double alpha) {m_aoaSpec = alpha;}
 
         double Reynolds() const {return m_Reynolds;}
-        void setReynolds(double Re) {m_Reynolds = Re;}
+        void setReynolds(double Re) {m_Reynolds = Re; setDataModified();}
 
         double Mach()   const  {return m_Mach;}
         void setMach(double M) {m_Mach=M;}
@@ -144,6 +197,8 @@ class FL5LIB_EXPORT Polar : public XflObject
         bool serializePolarXFL(QDataStream &ar, bool bIsStoring);
         bool serializePolarFl5(QDataStream &ar, bool bIsStoring);
 
+        size_t memoryFootprint() const;
+
         const std::vector<double> &getVariable(int iVar) const;
         bool hasData() const {return m_Alpha.size()>0;}
         int dataSize() const {return int(m_Alpha.size());}
@@ -155,6 +210,11 @@ class FL5LIB_EXPORT Polar : public XflObject
         void setBLMethod(BL::enumBLMethod blmethod) {m_BLMethod=blmethod;}
 
 
+        /** If true, the indexed interpolations evaluate smoothed monotone cubic fits of the Cl, Cd, Cdp, Cm and transition
+         *  points instead of interpolating the raw points linearly; the points past the stall are still interpolated linearly */
+        static bool bFittedInterpolation() {return s_bFittedInterpolation;}
+        static void setFittedInterpolation(bool bFitted) {s_bFittedInterpolation=bFitted;}
+
         static int variableCount() {return int(s_VariableNames.size());}
         static std::string variableName(int iVar) {return (iVar>=0 && iVar<variableCount()) ? s_VariableNames.at(iVar) : std::string(); }
         static std::vector<std::string> const &variableNames() {return s_VariableNames;}
@@ -202,8 +262,12 @@ class FL5LIB_EXPORT Polar : public XflObject
 
         BL::enumBLMethod m_BLMethod;
 
+        int m_DataRevision;
+
 
+        static std::atomic<int> s_LastDataRevision;
         static std::vector<std::string> s_VariableNames;
+        static bool s_bFittedInterpolation;
 
 };
 
@@ -26,18 +26,29 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+
 #include <bspline.h>
 #include <extradrag.h>
 #include <objects_global.h>
 #include <xflobject.h>
 
 class Inertia;
+class Opp3d;
 
 class FL5LIB_EXPORT Polar3d : public XflObject
 {
     friend class  BoatOpp;
     friend class  XflXmlReader;
 
+    public:
+        /** The policy which selects the operating points stored with their panel fields; the others keep only their scalar results */
+        enum enumFieldRetention {RETAINALL, RETAINEVERYNTH, RETAINTRIMMED, RETAINMATCHING, RETAINNONE};
+
+        /** The test of the RETAINMATCHING policy; the arguments are the operating point and its index in the analysis sequence */
+        typedef std::function<bool(Opp3d const*, int)> RetentionPredicate;
+
     public:
         Polar3d();
         virtual ~Polar3d() = default;
@@ -98,6 +109,7 @@ class FL5LIB_EXPORT Polar3d : public XflObject
         double vortonCoreSize()   const {return m_VortonCoreSize;}
         double VPWMaxLength()     const {return m_VPWMaxLength;}
         int VPWIterations()       const {return m_VPWIterations;}
+        double vortonTreeTheta()  const {return m_VortonTreeTheta;}
 
         void setVortonWake(bool bVW)       {m_bVortonWake = bVW;}
         void setVortonL0(double l0)        {m_VortonL0=l0;}
@@ -105,6 +117,7 @@ class FL5LIB_EXPORT Polar3d : public XflObject
         void setVortonCoreSize(double l)   {m_VortonCoreSize=l;}
         void setVPWMaxLength(double l)     {m_VPWMaxLength=l;}
         void setVPWIterations(int n)       {m_VPWIterations=n;}
+        void setVortonTreeTheta(double th) {m_VortonTreeTheta=th;}
 
         int NXBufferWakePanels() const;
 
@@ -143,6 +156,21 @@ class FL5LIB_EXPORT Polar3d : public XflObject
         int neuralFoilModelSize() const {return m_NFModelSize;}
         void setNeuralFoilModelSize(int size) {m_NFModelSize=size;}
 
+        bool bIterativeSolver() const {return m_bIterativeSolver;}
+        void setIterativeSolver(bool b) {m_bIterativeSolver=b;}
+        double iterativeTolerance() const {return m_IterativeTolerance;}
+        void setIterativeTolerance(double tol) {m_IterativeTolerance=tol;}
+        int iterativeMaxIter() const {return m_IterativeMaxIter;}
+        void setIterativeMaxIter(int n) {m_IterativeMaxIter=n;}
+        bool bCompressedMatrix() const {return m_bCompressedMatrix;}
+        void setCompressedMatrix(bool b) {m_bCompressedMatrix=b;}
+        double compressionTolerance() const {return m_CompressionTolerance;}
+        void setCompressionTolerance(double tol) {m_CompressionTolerance=tol;}
+        bool bMatrixFree() const {return m_bMatrixFree;}
+        void setMatrixFree(bool b) {m_bMatrixFree=b;}
+        bool bMultilevelPrecond() const {return m_bMultilevelPrecond;}
+        void setMultilevelPrecond(bool b) {m_bMultilevelPrecond=b;}
+
         bool isViscFromCl() const {return m_bViscFromCl;}
         void setViscFromCl(bool bFromCl) {m_bViscFromCl=bFromCl;}
 
@@ -254,6 +282,19 @@ class FL5LIB_EXPORT Polar3d : public XflObject
         BSpline &AVLSpline() {return m_AVLSpline;}
         BSpline const &AVLSpline() const {return m_AVLSpline;}
 
+        enumFieldRetention fieldRetention() const {return m_FieldRetention;}
+        void setFieldRetention(enumFieldRetention policy) {m_FieldRetention=policy;}
+        int retentionInterval() const {return m_RetentionInterval;}
+        void setRetentionInterval(int n) {m_RetentionInterval = n<1 ? 1 : n;}
+        /** Sets the test of the RETAINMATCHING policy; the predicate is not saved in the project files */
+        void setRetentionPredicate(RetentionPredicate const &predicate) {m_RetentionPredicate=predicate;}
+        bool retainsFields(Opp3d const *pOpp, int iOpp) const;
+
+        /** changed each time the points are changed by the methods of the derived classes, to a value which is unique
+         *  among all the 3d polars; the code which writes directly into the data arrays should call setDataModified() */
+        int dataRevision() const {return m_DataRevision;}
+        void setDataModified() {m_DataRevision = ++s_LastDataRevision;}
+
     protected:
         int  m_PolarFormat;        /**< the identification number which references the format used to serialize the data */
 
@@ -300,6 +341,15 @@ class FL5LIB_EXPORT Polar3d : public XflObject
         double   m_VortonCoreSize;     /**< the vorton's core size in meters used to calculate the mollification factor */
         double   m_VPWMaxLength;       /**< vortons further downstream than this length will be discarded - MAC units */
         int      m_VPWIterations;      /**< the number of VPW iterations */
+        double   m_VortonTreeTheta;    /**< the opening angle of the octree used to evaluate the vorton velocities; 0 for the direct sum */
+
+        bool     m_bIterativeSolver;     /**< true if the linear system is solved with preconditioned GMRES instead of dense LU */
+        double   m_IterativeTolerance;   /**< the GMRES convergence criterion on the residual relative to the RHS */
+        int      m_IterativeMaxIter;     /**< the max. number of GMRES iterations */
+        bool     m_bCompressedMatrix;    /**< true if the influence matrix is stored in hierarchical form with low-rank far-field blocks; implies the iterative solver */
+        double   m_CompressionTolerance; /**< the relative accuracy of the low-rank blocks */
+        bool     m_bMatrixFree;          /**< true if the influence matrix is not stored and is recomputed at each iteration of the iterative solver */
+        bool     m_bMultilevelPrecond;   /**< true if the block-Jacobi preconditioner of the iterative solver is completed with the coarse levels of a mesh hierarchy */
 
         bool     m_bAutoInertia;       /**< true if the inertia to be taken into account is the one of the parent plane */
 
@@ -313,6 +363,14 @@ class FL5LIB_EXPORT Polar3d : public XflObject
         bool m_bAVLDrag;
         mutable BSpline m_AVLSpline;
 
+        enumFieldRetention m_FieldRetention;      /**< the operating points which keep their Cp, doublet, source and vorton arrays */
+        int m_RetentionInterval;                  /**< the interval of the RETAINEVERYNTH policy */
+        RetentionPredicate m_RetentionPredicate;  /**< the test of the RETAINMATCHING policy; all the fields are kept if unset */
+
+        int m_DataRevision;
+
+        static std::atomic<int> s_LastDataRevision;
+
 
 };
 
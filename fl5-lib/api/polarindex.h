@@ -0,0 +1,68 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#pragma once
+
+#include <vector>
+
+#include <fl5lib_global.h>
+
+class PlanePolar;
+class BoatPolar;
+
+
+/**
+ * @class PolarIndex
+ * @brief The values of a pair of polar variables sorted by the first one, for interpolation and lookup in O(log n).
+ *
+ * The index is made once from the polar and is independent of it afterwards, so that it may be queried concurrently;
+ * it must be made again if the polar's points change. If the first variable is not monotonic along the polar,
+ * e.g. the lift coefficient beyond the stall, the interpolation is made between the points which are adjacent in x.
+ */
+class FL5LIB_EXPORT PolarIndex
+{
+    public:
+        PolarIndex() = default;
+        PolarIndex(PlanePolar const &polar, int iXVar, int iYVar) {make(polar, iXVar, iYVar);}
+
+        void make(PlanePolar const &polar, int iXVar, int iYVar);
+        void make(BoatPolar const &polar, int iXVar, int iYVar);
+        void make(std::vector<double> const &x, std::vector<double> const &y);
+
+        int size() const {return int(m_X.size());}
+        bool isEmpty() const {return m_X.empty();}
+        double xMin() const {return m_X.size() ? m_X.front() : 0.0;}
+        double xMax() const {return m_X.size() ? m_X.back()  : 0.0;}
+
+        bool interpolate(double x, double &y) const;
+        double value(double x) const;
+        int nearestPoint(double x) const;
+
+    private:
+        std::vector<double> m_X, m_Y;   /**< the values sorted by x */
+        std::vector<int> m_Point;       /**< the index in the polar of each sorted value */
+};
+
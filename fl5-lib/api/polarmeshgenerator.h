@@ -0,0 +1,123 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+#include <constants.h>
+#include <t8opp.h>
+#include <xfoilbatchengine.h>
+
+class Foil;
+class Polar;
+class PlaneXfl;
+class PlanePolar;
+
+
+/**
+ * @class PolarMeshGenerator
+ * @brief Computes with XFoil the type 1 foil polars which are missing for the interpolation of a plane's viscous drag.
+ *
+ * The Reynolds range of each foil is inferred from the chords of the strips on which the foil is used
+ * and from the range of speeds of the plane polar. The range is covered by log-spaced Reynolds numbers;
+ * those which are close to the Reynolds number of one of the foil's existing type 1 polars are skipped.
+ * The missing polars are computed in the background by an XFoilBatchEngine, so that they overlap
+ * the construction of the 3D analysis, and are inserted in the current ObjectStore by finish().
+ */
+class FL5LIB_EXPORT PolarMeshGenerator
+{
+    public:
+        PolarMeshGenerator();
+        ~PolarMeshGenerator();
+
+        bool inferSpeedRange(PlanePolar const *pWPolar, std::vector<double> const &oppList,
+                             std::vector<double> const &ctrlList, std::vector<T8Opp> const &t8Opps);
+        void setSpeedRange(double vMin, double vMax) {m_VMin=vMin; m_VMax=vMax;}
+        double vMin() const {return m_VMin;}
+        double vMax() const {return m_VMax;}
+
+        int makeJobs(PlaneXfl const *pPlane, PlanePolar const *pWPolar, std::string &log);
+        int nJobs() const {return int(m_Polars.size());}
+
+        void start();
+        int finish(std::string &log);
+        void cancel() {m_Engine.cancel();}
+        bool isRunning() const {return m_Engine.isRunning();}
+
+        static std::vector<double> reValues(double reMin, double reMax, int nValues);
+
+        /** If true, the plane tasks with interpolated viscous polars generate the missing foil polars before the analysis */
+        static bool isEnabled() {return s_bEnabled;}
+        static void setEnabled(bool bEnabled) {s_bEnabled=bEnabled;}
+
+        /** The number of log-spaced Reynolds numbers which cover each foil's range */
+        static int nReValues() {return s_nReValues;}
+        static void setNReValues(int n) {s_nReValues=std::max(2, n);}
+
+        /** The factor by which the Reynolds range is widened on either side */
+        static double reSafetyFactor() {return s_ReSafety;}
+        static void setReSafetyFactor(double f) {s_ReSafety=std::max(1.0, f);}
+
+        /** The aoa range of the generated polars, in degrees */
+        static double alphaMin() {return s_AlphaMin;}
+        static double alphaMax() {return s_AlphaMax;}
+        static double alphaInc() {return s_AlphaInc;}
+        static void setAlphaRange(double amin, double amax, double ainc) {s_AlphaMin=amin; s_AlphaMax=amax; s_AlphaInc=ainc;}
+
+        /** The range of lift coefficients from which the speeds of the balanced polars are estimated */
+        static double CLMin() {return s_CLMin;}
+        static double CLMax() {return s_CLMax;}
+        static void setCLRange(double clmin, double clmax) {s_CLMin=clmin; s_CLMax=clmax;}
+
+    private:
+        /** A foil used by the plane, and the range of the chords on which it is used */
+        struct FoilChords
+        {
+            Foil const *m_pFoil{nullptr};
+            double m_ChordMin{LARGEVALUE};
+            double m_ChordMax{0.0};
+        };
+
+        void clear();
+
+    private:
+        double m_VMin, m_VMax;
+
+        std::vector<Foil*> m_Foils;      /**< the base geometry copies analyzed by the jobs; owned */
+        std::vector<Polar*> m_Polars;    /**< the polars being computed, until they are inserted in the store; owned */
+
+        XFoilBatchEngine m_Engine;
+
+        static bool s_bEnabled;
+        static int s_nReValues;
+        static double s_ReSafety;
+        static double s_AlphaMin, s_AlphaMax, s_AlphaInc;
+        static double s_CLMin, s_CLMax;
+};
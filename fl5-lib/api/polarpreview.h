@@ -0,0 +1,73 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include <resultsink.h>
+#include <t8opp.h>
+
+class Plane;
+class PlaneXfl;
+class PlanePolar;
+
+
+/**
+ * @class PolarPreview
+ * @brief Fills a polar with provisional results from a coarse VLM analysis, pending the results of the full analysis.
+ *
+ * The preview is a fixed wake VLM analysis of a copy of the plane, without the fuselage panels, whose chordwise and
+ * spanwise panel counts are divided by the decimation factor; the viscous polars interpolate the foil polars.
+ * The provisional points are added to the polar as they are computed. The preview is then set as the result sink
+ * of the full analysis of the same operating points: the full results replace the provisional points in the polar,
+ * and removeProvisional() removes those which have not been replaced, e.g. if the full analysis was cancelled.
+ */
+class FL5LIB_EXPORT PolarPreview : public ResultSink
+{
+    public:
+        PolarPreview();
+
+        static bool canPreview(Plane const *pPlane, PlanePolar const *pPolar);
+
+        void setDecimation(int factor) {m_Decimation = factor<1 ? 1 : factor;}
+
+        bool run(PlaneXfl const *pPlaneXfl, PlanePolar *pPolar, std::vector<double> const &opplist, std::vector<T8Opp> const &t8opps);
+        void removeProvisional();
+        int nProvisional() const;
+
+        void addPlaneOpp(PlaneOpp *pPOpp) override;
+
+    private:
+        bool isSamePoint(T8Opp const &pt, double alpha, double beta, double QInf) const;
+
+    private:
+        PlanePolar *m_pPolar;
+        int m_Decimation;
+        bool m_bPreviewing;             /**< true while the coarse analysis runs */
+        std::vector<T8Opp> m_Points;    /**< the provisional points which have not been replaced */
+        mutable std::mutex m_Mutex;
+};
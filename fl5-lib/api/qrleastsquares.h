@@ -24,7 +24,9 @@
 
 #pragma once
 
+#include <vector>
 
+#include <fl5lib_global.h>
 
 
 void  swapcolumns(int *p, int i, int j);
@@ -38,3 +40,27 @@ void  mat_vec(const double *mat, int rows, int cols, const double *vec, double *
 
 void testQRLeastSquare();
 
+
+/**
+ * @class BandedLeastSquares
+ * @brief Solves the least-squares problems whose matrix rows have at most bandwidth consecutive non-zero coefficients,
+ * e.g. the collocation matrices of the B-splines.
+ *
+ * The rows are added one at a time and are rotated into the upper triangular band of R with Givens rotations,
+ * so that the matrix is never stored, the cost is O(rows.bandwidth²) and the normal equations, whose condition
+ * number is the square of the matrix's, are not formed.
+ */
+class FL5LIB_EXPORT BandedLeastSquares
+{
+    public:
+        BandedLeastSquares(int nCols, int bandWidth, int nRhs=1);
+
+        void addRow(int firstCol, double const *coefs, double const *rhs, double weight=1.0);
+        bool solve(double *sol) const;
+
+    private:
+        int m_nCols, m_BandWidth, m_nRhs;
+        std::vector<double> m_R;    /**< the band of R, bandwidth values per row starting on the diagonal */
+        std::vector<double> m_QtB;  /**< Qt.b, nRhs values per row */
+};
+
@@ -53,6 +53,8 @@ class FL5LIB_EXPORT QuadMesh : public XflMesh
 
         void rotate(double alpha, double beta, double phi) override;
 
+        size_t memoryFootprint() const override;
+
 
         void getFreeEdges(std::vector<Segment3d> &freeedges, std::vector<QPair<int, int> > &pairerrors) const;
 
@@ -0,0 +1,116 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+class Plane;
+class PlanePolar;
+
+
+/**
+ * @class ReducedModel
+ * @brief A surrogate of a plane's aerodynamics over an (alpha, beta) envelope, evaluated without any panel solve.
+ *
+ * The envelope is sampled on a grid of aoa and sideslip angles by a single T8 run of the PlaneTask,
+ * i.e. one factorization and the combination of the unit solutions, with the stability derivatives of each point.
+ * The model holds at each node of the grid:
+ *   - the force and moment coefficients CL, CD, CY, Cl, Cm, Cn, with the sign conventions of AeroForces;
+ *   - the non-dimensional rate derivatives of StabDerivatives, i.e. CXq, CZq, Cmq, CYp, CYr, Clp, Clr, Cnp, Cnr.
+ * and a POD of the Cp or of the doublet fields, made by the method of snapshots, from which the field at any
+ * point of the envelope is rebuilt with the interpolated modal coefficients.
+ *
+ * The coefficients are interpolated bilinearly and clamped to the envelope; the rates add the linear
+ * contributions of the rate derivatives. An evaluation is a few dozen operations, so that the model can be
+ * used for real-time 6-dof simulations. The model is saved to and read from a single binary file.
+ */
+class FL5LIB_EXPORT ReducedModel
+{
+    public:
+        enum enumField {CPFIELD, GAMMAFIELD};
+
+        /** The indexes of the values stored at each node */
+        enum enumValue {CL, CD, CY, CLROLL, CM, CN, CXQ, CZQ, CMQ, CYP, CYR, CLP, CLR, CNP, CNR, NVALUES};
+
+        /** The coefficients at a point of the envelope, in wind axes */
+        struct Coefficients
+        {
+            double m_CL{0}, m_CD{0}, m_CY{0};
+            double m_Cl{0}, m_Cm{0}, m_Cn{0};
+        };
+
+    public:
+        ReducedModel();
+
+        bool build(Plane *pPlane, PlanePolar const *pPolar, std::vector<double> const &alphas, std::vector<double> const &betas,
+                   enumField field, int maxModes);
+        bool isEmpty() const {return m_Alpha.empty();}
+        void clear();
+
+        bool save(std::string const &path) const;
+        bool load(std::string const &path);
+
+        Coefficients evaluate(double alpha, double beta, double p=0.0, double q=0.0, double r=0.0) const;
+        double value(enumValue iValue, double alpha, double beta) const;
+        void modalCoefficients(double alpha, double beta, double *a) const;
+        void field(double alpha, double beta, std::vector<double> &f) const;
+
+        int nAlpha() const {return int(m_Alpha.size());}
+        int nBeta() const {return int(m_Beta.size());}
+        int nModes() const {return m_nModes;}
+        int fieldSize() const {return int(m_Mean.size());}
+        enumField fieldType() const {return m_Field;}
+        /** The fraction of the energy of the field fluctuations captured by the retained modes */
+        double podEnergy() const {return m_Energy;}
+        double velocity() const {return m_QInf;}
+
+        std::string const &log() const {return m_Log;}
+
+    private:
+        void weights(double alpha, double beta, int *node, double *w) const;
+        void makePOD(std::vector<std::vector<double>> const &snapshots, int maxModes);
+
+    private:
+        std::vector<double> m_Alpha;     /**< the aoa of the grid nodes, in ascending order, in degrees */
+        std::vector<double> m_Beta;      /**< the sideslip angles of the grid nodes, in ascending order, in degrees */
+        std::vector<double> m_Values;    /**< NVALUES values per node, the alpha index varying fastest */
+
+        enumField m_Field;
+        int m_nModes;
+        double m_Energy;
+        std::vector<float> m_Mean;       /**< the mean field */
+        std::vector<float> m_Modes;      /**< the orthonormal POD modes, fieldSize() values per mode */
+        std::vector<double> m_Coefs;     /**< the modal coefficients, nModes values per node */
+
+        double m_QInf;                   /**< the velocity at which the envelope was sampled */
+        double m_RefArea, m_RefChord, m_RefSpan;
+
+        std::string m_Log;
+};
+
@@ -0,0 +1,101 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <QByteArray>
+
+#include <fl5lib_global.h>
+
+class QFile;
+class PlaneOpp;
+class BoatOpp;
+class OpPoint;
+
+
+/**
+ * @class ResultSink
+ * @brief The interface to which the analysis tasks push each operating point as soon as it has been computed.
+ *
+ * The sink is called from the task's thread, and may be shared by tasks running concurrently.
+ * The operating point remains owned by the task, and may be deleted as soon as the call returns.
+ */
+class FL5LIB_EXPORT ResultSink
+{
+    public:
+        virtual ~ResultSink() = default;
+
+        virtual void addPlaneOpp(PlaneOpp *) {}
+        virtual void addBoatOpp(BoatOpp *) {}
+        virtual void addOpPoint(OpPoint *) {}
+};
+
+
+/**
+ * @class FileResultSink
+ * @brief A ResultSink which appends each operating point to a results file.
+ *
+ * Each operating point is written as an independent record made of its type, its size and its
+ * fl5 serialization, and the file is flushed after each record. The operating points do not need
+ * to be kept in memory, and a run which is interrupted leaves all the completed records readable;
+ * a truncated last record is ignored by readResults().
+ */
+class FL5LIB_EXPORT FileResultSink : public ResultSink
+{
+    public:
+        enum enumRecord {PLANEOPP, BOATOPP, OPPOINT};
+
+    public:
+        FileResultSink();
+        ~FileResultSink() override;
+
+        bool open(std::string const &pathname, bool bAppend=false);
+        void close();
+        bool isOpen() const {return m_pFile!=nullptr;}
+        std::string const &pathName() const {return m_PathName;}
+        int nRecords() const {return m_nRecords;}
+
+        void addPlaneOpp(PlaneOpp *pPOpp) override;
+        void addBoatOpp(BoatOpp *pBtOpp) override;
+        void addOpPoint(OpPoint *pOpp) override;
+
+        static bool readResults(std::string const &pathname,
+                                std::vector<PlaneOpp*> &planeopps, std::vector<BoatOpp*> &boatopps, std::vector<OpPoint*> &oppoints);
+
+    private:
+        void writeRecord(enumRecord type, QByteArray const &data);
+
+    private:
+        QFile *m_pFile;
+        std::string m_PathName;
+        int m_nRecords;
+        std::mutex m_Mutex;
+};
+
@@ -27,6 +27,7 @@
 
 
 
+#include <cstdint>
 #include <vector>
 
 
@@ -114,6 +115,7 @@ class FL5LIB_EXPORT Sail : public Part
         virtual void flipXZ() = 0;
 
         virtual Vector3d point(double xrel, double zrel, xfl::enumSurfacePosition pos=xfl::MIDSURFACE) const =0;
+        virtual void getGrid(std::vector<double> const &xrel, std::vector<double> const &zrel, std::vector<Vector3d> &grid) const;
         virtual Node edgeNode(double xrel, double zrel, xfl::enumSurfacePosition pos=xfl::MIDSURFACE) const;
         virtual Vector3d normal(double xrel, double zrel, xfl::enumSurfacePosition pos=xfl::MIDSURFACE) const;
         virtual void makeSurface() = 0;
@@ -134,6 +136,9 @@ class FL5LIB_EXPORT Sail : public Part
         void setRuledMesh(bool bRuled) {m_bRuledMesh=bRuled;}
         virtual void makeTriPanels(Vector3d const &Tack);
         virtual void makeRuledMesh(Vector3d const &);
+        std::uint64_t meshHash(Vector3d const &Tack) const;
+        /** Forces the next call to makeTriPanels() to rebuild the mesh */
+        void clearMeshHash() {m_MeshHash=0;}
 
         void mergeRefNodes(Node const& src, Node const&dest);
 
@@ -249,6 +254,7 @@ class FL5LIB_EXPORT Sail : public Part
 
         std::vector<int> m_TopTEIndexes, m_BotMidTEIndexes;
         std::vector<Triangle3d> m_RefTriangles; /** the array of triangles used to construct the triangle mesh */
+        std::uint64_t m_MeshHash;  /** the hash of the data from which m_TriMesh was built, or 0 if the mesh is not valid */
 
         std::vector<std::vector<EdgeSplit>> m_EdgeSplit; // for each face<each edge>
 
@@ -62,6 +62,7 @@ class FL5LIB_EXPORT SailNurbs : public Sail
 
         Node edgeNode(double xrel, double zrel, xfl::enumSurfacePosition pos=xfl::MIDSURFACE) const override;
         Vector3d point(double xrel, double zrel, xfl::enumSurfacePosition pos=xfl::MIDSURFACE) const override;
+        void getGrid(std::vector<double> const &xrel, std::vector<double> const &zrel, std::vector<Vector3d> &grid) const override;
         Vector3d normal(double xrel, double zrel, xfl::enumSurfacePosition pos=xfl::MIDSURFACE) const override;
 
         void setColor(fl5Color const &clr) override;
@@ -26,6 +26,7 @@
 
 #include <vector>
 #include <linestyle.h>
+#include <objectstore.h>
 
 #include <fl5lib_global.h>
 
@@ -38,22 +39,23 @@ class BoatOpp;
 
 namespace SailObjects
 {
-    extern std::vector<Boat*> s_oaBoat;
-    extern std::vector<BoatPolar*> s_oaBtPolar;
-    extern std::vector<BoatOpp*> s_oaBtOpp;
-    extern BoatOpp *s_pLastBtOpp;
+    /** The store which is current in the calling thread */
+    FL5LIB_EXPORT inline ObjectStore &store() {return ObjectStore::current();}
+
     extern int s_SailDarkFactor;
 
 
-    FL5LIB_EXPORT inline int nBoats()    {return int(s_oaBoat.size());}
-    FL5LIB_EXPORT inline int nBtPolars() {return int(s_oaBtPolar.size());}
-    FL5LIB_EXPORT inline int nBtOpps()   {return int(s_oaBtOpp.size());}
+    FL5LIB_EXPORT inline int nBoats()    {return int(store().m_oaBoat.size());}
+    FL5LIB_EXPORT inline int nBtPolars() {return int(store().m_oaBtPolar.size());}
+    FL5LIB_EXPORT inline int nBtOpps()   {return int(store().m_oaBtOpp.size());}
 
-    FL5LIB_EXPORT inline std::vector<Boat*>      const& boats() {return s_oaBoat;}
-    FL5LIB_EXPORT inline std::vector<BoatPolar*> const& boatPolars() {return s_oaBtPolar;}
-    FL5LIB_EXPORT inline std::vector<BoatOpp*>   const& boatOpps() {return s_oaBtOpp;}
+    FL5LIB_EXPORT inline std::vector<Boat*>      const& boats() {return store().m_oaBoat;}
+    FL5LIB_EXPORT inline std::vector<BoatPolar*> const& boatPolars() {return store().m_oaBtPolar;}
+    FL5LIB_EXPORT inline std::vector<BoatOpp*>   const& boatOpps() {return store().m_oaBtOpp;}
 
     FL5LIB_EXPORT void deleteObjects();
+    FL5LIB_EXPORT void invalidateIndex();
+    FL5LIB_EXPORT size_t memoryFootprint();
     FL5LIB_EXPORT void deleteBoat(Boat *pBoat, bool bDeleteBtPolars);
     FL5LIB_EXPORT void deleteBtPolar(BoatPolar *pBtPolar);
     FL5LIB_EXPORT void deleteBtPolars(Boat *pBoat);
@@ -66,28 +68,28 @@ namespace SailObjects
     FL5LIB_EXPORT void removeBtPolarAt(int idx);
     FL5LIB_EXPORT void removeBtOppAt(int idx);
 
-    FL5LIB_EXPORT inline Boat *boat(int idx)         {if(idx>=0 && idx<nBoats())    return s_oaBoat.at(idx);    else return nullptr;}
-    FL5LIB_EXPORT inline BoatPolar *btPolar(int idx) {if(idx>=0 && idx<nBtPolars()) return s_oaBtPolar.at(idx); else return nullptr;}
-    FL5LIB_EXPORT inline BoatOpp *btOpp(int idx)     {if(idx>=0 && idx<nBtOpps())   return s_oaBtOpp.at(idx);   else return nullptr;}
+    FL5LIB_EXPORT inline Boat *boat(int idx)         {if(idx>=0 && idx<nBoats())    return store().m_oaBoat.at(idx);    else return nullptr;}
+    FL5LIB_EXPORT inline BoatPolar *btPolar(int idx) {if(idx>=0 && idx<nBtPolars()) return store().m_oaBtPolar.at(idx); else return nullptr;}
+    FL5LIB_EXPORT inline BoatOpp *btOpp(int idx)     {if(idx>=0 && idx<nBtOpps())   return store().m_oaBtOpp.at(idx);   else return nullptr;}
 
     FL5LIB_EXPORT BoatOpp *btOpp(Boat const *pBoat, BoatPolar const*pPolar, std::string const &oppname);
 
-    FL5LIB_EXPORT inline void setLastBtOpp(BoatOpp *pBtOpp) {s_pLastBtOpp=pBtOpp;}
-    FL5LIB_EXPORT inline BoatOpp *lastBtOpp()   {return s_pLastBtOpp;}
+    FL5LIB_EXPORT inline void setLastBtOpp(BoatOpp *pBtOpp) {store().m_pLastBtOpp=pBtOpp;}
+    FL5LIB_EXPORT inline BoatOpp *lastBtOpp()   {return store().m_pLastBtOpp;}
     FL5LIB_EXPORT BoatOpp* getBoatOppObject(Boat*pBoat, BoatPolar *pBtPolar, double ctrl);
     FL5LIB_EXPORT void storeBtOpps(BoatPolar *pBtPolar, const std::vector<BoatOpp *> &BtOppList);
 
     FL5LIB_EXPORT Boat*       boat(const std::string &BoatName);
     FL5LIB_EXPORT BoatPolar* btPolar(const Boat *pBoat, const std::string &BPolarName);
     FL5LIB_EXPORT BoatOpp *  getBoatOpp(const Boat *pBoat, const BoatPolar *pBPolar, double x);
-    FL5LIB_EXPORT inline Boat* appendBoat(Boat*pBoat) {s_oaBoat.push_back(pBoat); return pBoat;}
-    FL5LIB_EXPORT inline void appendBtPolar(BoatPolar *pBPolar) {s_oaBtPolar.push_back(pBPolar);}
-    FL5LIB_EXPORT inline void appendBtOpp(BoatOpp *pBOpp) {s_oaBtOpp.push_back(pBOpp);}
+    FL5LIB_EXPORT inline Boat* appendBoat(Boat*pBoat) {store().m_oaBoat.push_back(pBoat); invalidateIndex(); return pBoat;}
+    FL5LIB_EXPORT inline void appendBtPolar(BoatPolar *pBPolar) {store().m_oaBtPolar.push_back(pBPolar); invalidateIndex();}
+    FL5LIB_EXPORT inline void appendBtOpp(BoatOpp *pBOpp) {store().m_oaBtOpp.push_back(pBOpp); invalidateIndex();}
 
     FL5LIB_EXPORT void insertThisBoat(Boat*pBoat);
-    FL5LIB_EXPORT inline void insertThisBoat(int idx, Boat*pBoat) {s_oaBoat.insert(s_oaBoat.begin()+idx, pBoat);}
+    FL5LIB_EXPORT inline void insertThisBoat(int idx, Boat*pBoat) {store().m_oaBoat.insert(store().m_oaBoat.begin()+idx, pBoat); invalidateIndex();}
     FL5LIB_EXPORT void insertBtPolar(BoatPolar *pBtPolar);
-    FL5LIB_EXPORT inline void insertBtPolar(int idx, BoatPolar *pBPolar) {s_oaBtPolar.insert(s_oaBtPolar.begin()+idx, pBPolar);}
+    FL5LIB_EXPORT inline void insertBtPolar(int idx, BoatPolar *pBPolar) {store().m_oaBtPolar.insert(store().m_oaBtPolar.begin()+idx, pBPolar); invalidateIndex();}
     FL5LIB_EXPORT void insertBtOpp(BoatOpp *pBtOpp);
 
     FL5LIB_EXPORT bool boatExists(std::string const &boatname);
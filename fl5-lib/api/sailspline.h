@@ -73,6 +73,7 @@ class FL5LIB_EXPORT SailSpline : public Sail
         bool serializeSailFl5(QDataStream &ar, bool bIsStoring) override;
 
         Vector3d point(double xrel, double zrel, xfl::enumSurfacePosition pos=xfl::MIDSURFACE) const override;
+        void getGrid(std::vector<double> const &xrel, std::vector<double> const &zrel, std::vector<Vector3d> &grid) const override;
 
         void duplicate(Sail const *pSail) override;
         void setColor(fl5Color const &clr) override;
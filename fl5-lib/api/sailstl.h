@@ -65,5 +65,19 @@ class FL5LIB_EXPORT SailStl : public ExternalSail
         void setTriangles(std::vector<Triangle3d> const &triangles) override;
 
         void properties(std::string &sailprops, std::string const &prefx, bool bFull=false) const override;
+
+        bool isSimplified() const {return int(m_RefTriangles.size())!=m_Triangulation.nTriangles();}
+
+        static void setSimplification(int maxtriangles, double edgelength) {s_MaxTriangles=maxtriangles; s_SimplifiedEdgeLength=edgelength;}
+        static int maxTriangles() {return s_MaxTriangles;}
+        static double simplifiedEdgeLength() {return s_SimplifiedEdgeLength;}
+
+    private:
+        void twistTriangles(std::vector<Triangle3d> &triangles, double deltatwist) const;
+        void scaleTrianglesAR(std::vector<Triangle3d> &triangles, double ratio) const;
+
+    private:
+        static int s_MaxTriangles;              /**< imported triangulations with more triangles are decimated to this count; 0 to keep them as they are */
+        static double s_SimplifiedEdgeLength;   /**< if greater than 0, imported triangulations are decimated to this edge length instead */
 };
 
@@ -45,6 +45,8 @@ struct FL5LIB_EXPORT SpanDistribs
 
         bool serializeSpanResultsFl5(QDataStream &ar, bool bIsStoring);
 
+        size_t memoryFootprint() const;
+
         void clearGeometry();
 
         double stripLift(int m, double qDyn) const;
@@ -59,6 +59,7 @@ class FL5LIB_EXPORT Spline
         virtual bool updateSpline() = 0;
         virtual void makeCurve() = 0;
         virtual Vector2d splinePoint(double u) const = 0;
+        virtual void splinePoints(double const *u, int n, Vector2d *pt) const;
         virtual void splineDerivative(double u, double &dx, double &dy) const = 0;
         Vector2d splineNormal(double u) const;
 
@@ -0,0 +1,116 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <vector>
+
+#include <fl5lib_global.h>
+
+class PlaneOpp;
+
+
+/**
+ * @class StabResponse
+ * @brief Integrates in one batch the time responses of the linearized longitudinal and lateral systems of many operating points.
+ *
+ * Each scenario is defined by an operating point, the choice of the longitudinal or lateral system, an initial state
+ * and optionally an AVL-type control and a control history. The system is [x'] = [A][x] + [B].u(t) with the
+ * state and control matrices of the operating point, in the same units as in the PlaneOpp.
+ *
+ * All scenarios share the same time step. Since the systems are linear and time-invariant, the step is the affine map
+ *     x(t+dt) = [Phi].x(t) + [G0].u(t) + [Gm].u(t+dt/2) + [G1].u(t+dt)
+ * which is made once for each operating point, system and control, either from the matrix exponential, i.e. exactly for
+ * control histories linear over each step, or from the RK4 scheme, i.e. identical to the step by step integration.
+ * The control histories are sampled once at the step times, so that a step of a scenario is about 30 operations
+ * and the scenarios are integrated concurrently in the thread pool.
+ */
+class FL5LIB_EXPORT StabResponse
+{
+    public:
+        enum enumMethod {EXPONENTIAL, RK4};
+
+        struct Scenario
+        {
+            PlaneOpp const *m_pPOpp{nullptr};
+            bool m_bLongitudinal{true};
+            double m_y0[4]{0,0,0,0};     /**< the initial state: u, w, q, theta or v, p, r, phi */
+            int m_iCtrl{-1};             /**< the index of the AVL control, or -1 for a free response */
+            int m_iInput{-1};            /**< the index of the control history, as returned by addInput() */
+        };
+
+    public:
+        StabResponse();
+
+        void setMethod(enumMethod method) {m_Method=method;}
+        void setTime(double totalTime, double dt);
+        /** Stores one state every n steps */
+        void setOutputInterval(int n) {m_OutputInterval = n<1 ? 1 : n;}
+
+        void clear();
+        int addInput(std::vector<double> const &time, std::vector<double> const &value);
+        int addScenario(Scenario const &scenario);
+        int addModalScenario(PlaneOpp const *pPOpp, bool bLongitudinal, int iMode, double amplitude=1.0);
+
+        void run();
+
+        int nScenarios() const {return int(m_Scenarios.size());}
+        int nSteps() const {return m_nSteps;}
+        int nOutputs() const {return m_nSteps/m_OutputInterval+1;}
+        double outputTime(int iOut) const {return double(iOut*m_OutputInterval)*m_dt;}
+
+        /** @return the number of states stored for the scenario; less than nOutputs() if the response diverged */
+        int nResults(int iScenario) const {return m_nResults.at(iScenario);}
+        /** @return a pointer to the 4 components of the state of the scenario at the output index */
+        double const *state(int iScenario, int iOut) const {return m_Y.data() + (size_t(iScenario)*size_t(nOutputs()) + size_t(iOut))*4;}
+
+    private:
+        /** The affine map of one time step */
+        struct StepMap
+        {
+            double m_Phi[16]{};
+            double m_G0[4]{}, m_Gm[4]{}, m_G1[4]{};
+        };
+
+        static void makeExponentialMap(double const *A, double const *B, double dt, StepMap &map);
+        static void makeRK4Map(double const *A, double const *B, double dt, StepMap &map);
+        void sampleInputs();
+        void integrate(int iScenario, StepMap const &map);
+
+    private:
+        enumMethod m_Method;
+        double m_TotalTime;
+        double m_dt;
+        int m_nSteps;
+        int m_OutputInterval;
+
+        std::vector<Scenario> m_Scenarios;
+        std::vector<std::vector<double>> m_InputTime, m_InputValue;
+        std::vector<std::vector<double>> m_InputSamples;  /**< the control values at t=i.dt/2, for each history */
+
+        std::vector<double> m_Y;            /**< nOutputs() states of 4 components per scenario */
+        std::vector<int> m_nResults;
+};
+
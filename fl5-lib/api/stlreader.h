@@ -0,0 +1,80 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+#include <triangle3d.h>
+
+
+/**
+ * @class StlReader
+ * @brief Reads the triangles of binary and text STL files.
+ *
+ * The file is memory-mapped and parsed in blocks on the ThreadPool. The binary records are decoded
+ * in place; the text file is split at facet boundaries and each part is parsed independently.
+ * The facets are collected first and the triangles are built in a second parallel pass.
+ * The vertices of the triangles are re-ordered where needed so that their orientation is the same
+ * as the facet's normal.
+ */
+class FL5LIB_EXPORT StlReader
+{
+    public:
+        StlReader();
+
+        bool readFile(std::string const &pathname, double unitfactor, std::vector<Triangle3d> &triangles);
+
+        bool isText() const {return m_bText;}
+        std::string const &solidName() const {return m_SolidName;}
+        std::string const &log() const {return m_Log;}
+        int nInverted() const {return m_nInverted;}
+        Vector3d const &boxMin() const {return m_BoxMin;}
+        Vector3d const &boxMax() const {return m_BoxMax;}
+
+        /** May be set from any thread to interrupt the reading */
+        void cancel() {m_bCancel=true;}
+
+        static bool isTextFormat(char const *data, size_t size);
+
+    private:
+        bool readBinary(char const *data, size_t size, std::vector<double> &facets);
+        bool readText(char const *data, size_t size, std::vector<double> &facets);
+        void makeTriangles(std::vector<double> const &facets, double unitfactor, std::vector<Triangle3d> &triangles);
+
+    private:
+        bool m_bText;
+        std::string m_SolidName;
+        std::string m_Log;
+        int m_nInverted;
+        Vector3d m_BoxMin, m_BoxMax;
+        std::atomic<bool> m_bCancel;
+};
+
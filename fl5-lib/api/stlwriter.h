@@ -0,0 +1,110 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+#include <triangle3d.h>
+
+class Surface;
+class WingXfl;
+
+
+/**
+ * @class StlWriter
+ * @brief Writes the triangulation of a list of parts to a binary STL, text STL or OBJ file.
+ *
+ * The parts are streamed to the file one after the other: the triangles of the wings are made and written
+ * one surface at a time, and the existing triangulations of the other parts, e.g. the cached triangles of
+ * the fuselages and sails, are referenced without copy and written in chunks. The records of each chunk are
+ * encoded in parallel in the thread pool and written with a single call, so that the memory used by the
+ * export does not depend on the total number of triangles.
+ * The triangle count of the binary file is written in the header once all parts have been written.
+ * The writing may be cancelled from another thread, in which case the incomplete file is removed.
+ */
+class FL5LIB_EXPORT StlWriter
+{
+    public:
+        enum enumFormat {BINARYSTL, TEXTSTL, OBJ};
+
+    public:
+        StlWriter();
+
+        void setFormat(enumFormat format) {m_Format=format;}
+        /** Sets the factor by which the coordinates are multiplied when written */
+        void setScaleFactor(double factor) {m_ScaleFactor=factor;}
+        /** Sets the number of panels of each wing surface in the chordwise and spanwise directions */
+        void setResolution(int nChordPanels, int nSpanPanels) {m_nChordPanels=std::max(1,nChordPanels); m_nSpanPanels=std::max(1,nSpanPanels);}
+        void setMultiThreaded(bool bMultiThreaded) {m_bMultiThreaded=bMultiThreaded;}
+
+        void clearParts() {m_Part.clear();}
+        void addWing(WingXfl const *pWing);
+        void addTriangles(std::string const &name, std::vector<Triangle3d> const &triangles);
+        int nParts() const {return int(m_Part.size());}
+
+        bool write(std::string const &pathname, std::string const &solidname);
+
+        int nTriangles() const {return m_nTriangles;}
+        /** Returns the fraction of the export which has been written; may be called from any thread */
+        double progress() const {return m_nSteps>0 ? double(m_iStep)/double(m_nSteps) : 0.0;}
+        std::string const &log() const {return m_Log;}
+
+        /** May be set from any thread to interrupt the writing */
+        void cancel() {m_bCancel=true;}
+
+        static void makeSurfaceTriangles(Surface const &surf, int nChordPanels, int nSpanPanels, std::vector<Triangle3d> &triangles);
+        static void makeWingTriangles(WingXfl const *pWing, int nChordPanels, int nSpanPanels, std::vector<Triangle3d> &triangles);
+
+    private:
+        /** A part to export; either a wing, the triangles of which are made at the time of writing, or a list of triangles */
+        struct ExportPart
+        {
+            std::string m_Name;
+            WingXfl const *m_pWing{nullptr};
+            std::vector<Triangle3d> const *m_pTriangles{nullptr};
+        };
+
+        void encodeTriangles(Triangle3d const *triangles, int n, int iFirst, std::string &buffer) const;
+
+    private:
+        enumFormat m_Format;
+        double m_ScaleFactor;
+        int m_nChordPanels, m_nSpanPanels;
+        bool m_bMultiThreaded;
+
+        std::vector<ExportPart> m_Part;
+
+        int m_nTriangles;
+        std::atomic<int> m_iStep, m_nSteps;
+        std::string m_Log;
+        std::atomic<bool> m_bCancel;
+};
+
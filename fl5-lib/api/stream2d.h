@@ -72,6 +72,7 @@ class FL5LIB_EXPORT Stream2d
         void resizeSourceArrays();
 
         void getVelocity(double alpha, double qinf, const Vector2d &pt, Vector2d &vel, bool bSigma=true) const;
+        void getVelocities(double alpha, double qinf, std::vector<Vector2d> const &pts, std::vector<Vector2d> &vel, bool bSigma=true) const;
 
         double streamValue(double alpha, double qinf, Vector2d const &pt) const;
 
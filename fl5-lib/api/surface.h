@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 
@@ -145,7 +146,10 @@ class FL5LIB_EXPORT Surface
         void setFlap();
 
         void makeSideNodes(Fuse const *pTranslatedFuse, bool bDebug=false);
-        void makeSideNodeTask(int l, Fuse const *pTranslatedFuse, double alpha_dA, double alpha_dB);
+        std::uint64_t sideNodeKey(Fuse const *pTranslatedFuse) const;
+        bool reuseSideNodes(Surface const &surf, Fuse const *pTranslatedFuse);
+        void makeSideNodeTask(int l, double alpha_dA, double alpha_dB);
+        void intersectSideNodes(Fuse const *pTranslatedFuse);
 
         void setTwist(bool bQuarterChord);
         void setTwist2();
@@ -304,6 +308,7 @@ class FL5LIB_EXPORT Surface
     private :
 
         int m_Index;               /**< the index of the surface in the wing's array of surfaces; debug use only */
+        std::uint64_t m_SideNodeKey;  /**< the key of the data used to make the side nodes, or 0 if the side nodes are not up to date */
 
         bool m_bIsInSymPlane;      /**< true if the Surface is positioned in the symetry xz plane defined by y=0. Case of a single fin. */
         bool m_bTEFlap;            /**< true if the Surface has a flap on the trailing edge */
@@ -24,12 +24,15 @@
 
 #pragma once
 
+#include <algorithm>
 #include <vector>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
 
 #include <fl5lib_global.h>
+#include <kernelstats.h>
+#include <taskprofile.h>
 #include <vorton.h>
 #include <utils.h>
 
@@ -52,9 +55,14 @@ struct VPWReport
 
 
 class Polar3d;
+class Opp3d;
 class PanelAnalysis;
 class P4Analysis;
 class P3Analysis;
+class ResultSink;
+class LiveChannel;
+class ConvergenceMonitor;
+class ObjectStore;
 
 class FL5LIB_EXPORT Task3d
 {
@@ -81,22 +89,56 @@ class FL5LIB_EXPORT Task3d
         int nRHS() const {return m_nRHS;}
 
         void advectVortons(double alpha, double beta, double QInf, int qrhs);
-        void advectVortonRow(std::vector<Vorton> *thisrow);
+        void advectVortonBatch(Vorton **vtn, int nVtn) const;
+        void manageVortons();
 
 
         void stopVPWIterations() {m_bStopVPWIterations = true;}
+        bool hasVPWConverged(Vector3d const &Force, Vector3d &LastForce, int &nSteady) const;
 
 
         void setKeepOpps(bool b) {m_bKeepOpps=b;}
+        /** Sets the doublet densities at the vertices of the triangles, three per panel, from which the iterative solver
+         *  starts for the first operating point, e.g. those interpolated from a coarser mesh; unused by the dense LU */
+        void setInitialGuess(std::vector<double> const &mu3) {m_InitialGuess=mu3;}
+        /** Sets the sink to which each operating point is pushed on completion; not owned by the task */
+        void setResultSink(ResultSink *pSink) {m_pResultSink=pSink;}
+        /** Sets the channel through which the wake, the residuals and the completed operating points are streamed to the GUI;
+         * not owned by the task. If set, the live wake is published there rather than in the message queue */
+        void setLiveChannel(LiveChannel *pChannel) {m_pLiveChannel=pChannel;}
+        LiveChannel *liveChannel() const {return m_pLiveChannel;}
+        /** Sets the monitor to which the residuals of the viscous loop and of the LLT iterations are reported; not owned by the task */
+        void setConvergenceMonitor(ConvergenceMonitor *pMonitor) {m_pConvergenceMonitor=pMonitor;}
         void outputToStdIO(bool b) {m_bStdOut=b;}
 
+        /** Sets the number of threads available to this task when several tasks share the cores; 0 to use all of them */
+        void setThreadCount(int nThreads) {m_nThreads=std::max(0, nThreads);}
+        int threadCount() const {return m_nThreads;}
+
+        /** Sets the store in which the task looks up the foil polars and stores its results;
+         * defaults to the store which was current in the thread which created the task */
+        void setStore(ObjectStore *pStore) {m_pStore=pStore;}
+        ObjectStore *store() const {return m_pStore;}
+
+        /** The phase timers and the counters of the task; cleared at the start of PlaneTask::run() */
+        TaskProfile const &profile() const {return m_Profile;}
+        TaskProfile &profile() {return m_Profile;}
+
 
         void traceVPWLog(double ctrl);
         void traceLog(const QString &str);
 
+        void applyFieldRetention(Polar3d const *pPolar, Opp3d *pOpp, int iOpp);
+
 
 
         virtual void traceStdLog(const std::string &str);
+        void clearMessages();
+
+        /** Sets the max. number of messages waiting in the queue; the next messages are dropped until the calling
+         *  thread has read the queue, so that the tasks of batch runs without a reader have bounded memory */
+        static void setMaxQueuedMessages(int n) {s_MaxQueuedMessages=std::max(0,n);}
+        static int maxQueuedMessages() {return s_MaxQueuedMessages;}
 
 
         static void setVortonStretch(bool bStretch) {s_bVortonStretch=bStretch;}
@@ -110,12 +152,30 @@ class FL5LIB_EXPORT Task3d
         static void setLiveUpdate(bool bLive) {s_bLiveUpdate=bLive;}
         static bool bLiveUpdate() {return s_bLiveUpdate;}
 
+        /** The relative change of the far field force below which the VPW iterations are considered converged; 0 to disable */
+        static void setVPWTolerance(double tol) {s_VPWTolerance=tol;}
+        static double VPWTolerance() {return s_VPWTolerance;}
+
+        /** The number of vortons advected together by each task of advectVortons() */
+        static void setVortonBatchSize(int n) {s_VortonBatchSize=std::max(1,n);}
+        static int vortonBatchSize() {return s_VortonBatchSize;}
+
+        /** The number of active vortons above which the nearby vortons are merged by manageVortons(); 0 to disable */
+        static void setMaxVortons(int n) {s_MaxVortons=std::max(0,n);}
+        static int maxVortons() {return s_MaxVortons;}
+
         static void setCancelled(bool bCancel) {s_bCancel=bCancel;}
 
     protected:
+        void traceKernelStats(KernelStats::Totals const &start);
+
         virtual void makeVortonRow(int qrhs) = 0;
         virtual void loop() = 0;
 
+        /** The velocity of the undisturbed flow at point P used to advect the vortons; the uniform free stream by default.
+         *  Called concurrently from the advection threads */
+        virtual Vector3d onsetVelocity(Vector3d const &P) const {(void)P; return tmp_VInf;}
+
 
 
     protected:
@@ -135,25 +195,48 @@ class FL5LIB_EXPORT Task3d
 
         xfl::enumAnalysisStatus m_AnalysisStatus;
 
+        ObjectStore *m_pStore;      /**< the store of the project to which the task's objects belong */
+
         // temp variables used in the parallelization of vorton row advects
         double const *tmp_Mu;
         double const *tmp_Sigma;
         double tmp_dt;
         double tmp_vortonwakelength;
         Vector3d tmp_VInf;
+        std::vector<std::vector<Vorton>> tmp_NewVortons;  /**< reused by each advection, so that the steady iterations do not allocate */
+        std::vector<Vorton*> tmp_ActiveVortons;
 
         bool m_bKeepOpps;
         bool m_bStdOut;
 
+        std::vector<double> m_InitialGuess;  /**< the initial guess of the iterative solver, as the vertex doublet densities */
+
+        ResultSink *m_pResultSink;
+        LiveChannel *m_pLiveChannel;
+        ConvergenceMonitor *m_pConvergenceMonitor;
+
+        int m_nThreads;             /**< the thread budget of this task, or 0 if unconstrained */
+
+        TaskProfile m_Profile;
+
 
         static int s_MaxNRHS;
 
         static bool s_bVortonRedist;  /** option for vorton redistribution */
         static bool s_bVortonStretch;      /** option for vorton strength exchange */
         static bool s_bLiveUpdate;
+        static double s_VPWTolerance;
+        static int s_VortonBatchSize;
+        static int s_MaxVortons;
 
         static bool s_bCancel;
 
+        static int s_MaxQueuedMessages;  /**< the max. number of unread messages, or 0 for no limit */
+
+    private:
+        void postReport(VPWReport const &report);
+        int m_nDroppedMessages;     /**< the number of messages dropped since the queue was last read */
+
     public:
         // thread related variables to share the message queue with the calling threa
         std::mutex m_mtx;
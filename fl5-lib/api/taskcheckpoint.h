@@ -0,0 +1,118 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <QElapsedTimer>
+
+#include <fl5lib_global.h>
+#include <vector3d.h>
+#include <vortex.h>
+#include <vorton.h>
+
+class PlaneOpp;
+
+
+/**
+ * @class TaskCheckpoint
+ * @brief A persistent store of the state of a running plane task, from which an interrupted task is resumed.
+ *
+ * The checkpoint of a task is identified by a hash of the plane's mesh, of the polar's specification and of
+ * the list of operating points, so that resubmitting the same task after it has been cancelled or after the
+ * process has been killed picks up the files of the previous run, and any change leads to a new checkpoint.
+ *
+ * Three files are written in the checkpoint directory:
+ *   - the LU factorization of the influence matrix, with the key of the matrix which was factorized;
+ *   - the completed operating points, appended as they are computed;
+ *   - the state of the operating point in progress of the vorton wake polars: the vortons,
+ *     the virtual twist of the viscous loop and the convergence history of the wake iterations.
+ *     This file is rewritten at most once per interval.
+ * The files are removed when the task finishes without being cancelled.
+ */
+class FL5LIB_EXPORT TaskCheckpoint
+{
+    public:
+        /** The state of the wake iterations of an operating point, from which they are resumed */
+        struct WakeState
+        {
+            int m_iOpp{-1};               /**< the index of the operating point */
+            int m_iWake{0};               /**< the index of the next wake iteration; 0 if the point has not been started */
+            bool m_bConvergedLast{false}; /**< true if the viscous loop of the previous point converged */
+            double m_QInf{1.0};
+            double m_QInfStab{1.0};
+            Vector3d m_LastForce;
+            int m_nSteady{0};
+            std::vector<double> m_gamma;  /**< the virtual twist of the span stations */
+            std::vector<std::vector<Vorton>> m_Vortons;
+            std::vector<Vortex> m_VortexNeg;
+        };
+
+    public:
+        TaskCheckpoint();
+
+        void open(std::uint64_t key);
+        void close() {m_Key=0; m_Done.clear();}
+        bool isOpen() const {return m_Key!=0;}
+        std::uint64_t key() const {return m_Key;}
+
+        bool loadFactorization(std::uint64_t matrixkey, int n, bool bDouble, double *aijd, size_t nd, float *aijf, size_t nf, std::vector<int> &ipiv) const;
+        void storeFactorization(std::uint64_t matrixkey, int n, bool bDouble, double const *aijd, size_t nd, float const *aijf, size_t nf, std::vector<int> const &ipiv) const;
+
+        std::vector<std::pair<int, PlaneOpp*>> loadOpps();
+        void appendOpp(int iOpp, PlaneOpp *pPOpp);
+        bool isDone(int iOpp) const {return iOpp>=0 && iOpp<int(m_Done.size()) && m_Done.at(iOpp);}
+
+        bool loadWakeState(WakeState &state) const;
+        bool isWakeStateDue() const;
+        void storeWakeState(WakeState &state);
+
+        void remove();
+
+        static bool isEnabled() {return s_bEnabled;}
+        static void setEnabled(bool bEnabled) {s_bEnabled=bEnabled;}
+
+        static std::string directory();
+        static void setDirectory(std::string const &dir) {s_Dir=dir;}
+
+        /** Sets the min. time in s between two writes of the wake state */
+        static void setInterval(double seconds) {s_Interval=seconds;}
+        static double interval() {return s_Interval;}
+
+    private:
+        std::string filePath(char const *extension) const;
+
+    private:
+        std::uint64_t m_Key;         /**< the key of the task, or 0 if the checkpoint is closed */
+        std::vector<bool> m_Done;    /**< the operating points which have been stored, by index */
+        QElapsedTimer m_StateTimer;  /**< the time since the last write of the wake state */
+
+        static bool s_bEnabled;
+        static std::string s_Dir;    /**< the checkpoint directory; if empty, a subdirectory of the system's temporary directory */
+        static double s_Interval;
+};
+
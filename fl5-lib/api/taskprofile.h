@@ -0,0 +1,141 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+
+/**
+ * @class TaskProfile
+ * @brief The phase timers and the counters of one analysis task.
+ *
+ * The phases are timed by TaskProfile::Scope objects and may be nested. Each phase is aggregated
+ * by its path from the root, e.g. "operating point/Trefftz drag", so that the same phase reached from
+ * two places is reported twice. The phases are opened by the task's thread; the work done in
+ * parallel inside a phase is accounted to that phase.
+ * The counters may be incremented from any thread.
+ * Each closed phase is also recorded as an event, up to a limit, for the Chrome trace view.
+ */
+class FL5LIB_EXPORT TaskProfile
+{
+    public:
+        enum enumCounter {INFLUENCECOEFS, LUFACTORIZATIONS, LUCACHEHITS, RHSSOLVED, VISCOUSLOOPS, VPWITERATIONS, NEWTONITERATIONS, VORTONSADVECTED, VORTONSMERGED, NCOUNTERS};
+
+        struct Phase
+        {
+            std::string m_Name;
+            int m_Parent{-1};      /**< the index of the enclosing phase, or -1 for a root phase */
+            int m_Depth{0};
+            int64_t m_nCalls{0};
+            double m_Seconds{0.0};
+            int64_t m_nAllocs{0};  /**< the heap allocations of all threads during the phase; only counted with FL5_ALLOC_STATS */
+        };
+
+        /**
+         * @class Scope
+         * @brief Times the enclosed block as a phase of the profile; does nothing if the profile is null or profiling is disabled.
+         * The name must be a literal or otherwise outlive the scope.
+         */
+        class FL5LIB_EXPORT Scope
+        {
+            public:
+                Scope(TaskProfile *pProfile, char const *name);
+                ~Scope();
+                Scope(Scope const&) = delete;
+                Scope &operator=(Scope const&) = delete;
+
+            private:
+                TaskProfile *m_pProfile;
+                int m_iPhase;
+                std::chrono::steady_clock::time_point m_Start;
+                int64_t m_nAllocsStart;
+        };
+
+    public:
+        TaskProfile();
+        TaskProfile(TaskProfile const&) = delete;
+        TaskProfile &operator=(TaskProfile const&) = delete;
+
+        void clear();
+
+        void count(enumCounter c, int64_t n=1) {if(s_bEnabled) m_Counter[c].fetch_add(n, std::memory_order_relaxed);}
+        int64_t counter(enumCounter c) const {return m_Counter[c].load(std::memory_order_relaxed);}
+
+        std::vector<Phase> phases() const;
+        std::string phasePath(int iPhase) const;
+        double seconds(std::string const &path) const;
+        int64_t nCalls(std::string const &path) const;
+
+        void merge(TaskProfile const &other, int tid=1);
+
+        std::string summary() const;
+        std::string toJson() const;
+        std::string toChromeTrace(std::string const &processname) const;
+        bool writeJson(std::string const &pathname) const;
+        bool writeChromeTrace(std::string const &pathname, std::string const &processname) const;
+
+        static char const *counterName(enumCounter c);
+
+        static void setEnabled(bool bEnabled) {s_bEnabled=bEnabled;}
+        static bool isEnabled() {return s_bEnabled;}
+        /** The maximum number of events kept for the Chrome trace; the aggregated phases are not limited */
+        static void setMaxEvents(int nMax) {s_MaxEvents=nMax;}
+        static int maxEvents() {return s_MaxEvents;}
+
+    private:
+        struct Event
+        {
+            int m_iPhase{0};
+            int m_Tid{0};           /**< 0 for the task's thread, other values for the merged profiles */
+            double m_Start{0.0};    /**< µs from the profile's origin */
+            double m_Duration{0.0}; /**< µs */
+        };
+
+        int openPhase(char const *name);
+        void closePhase(int iPhase, std::chrono::steady_clock::time_point const &start, std::chrono::steady_clock::time_point const &end, int64_t nAllocs);
+        int findPhase(int iParent, std::string const &name) const;
+        int findPath(std::string const &path) const;
+        std::string pathNoLock(int iPhase) const;
+
+    private:
+        mutable std::mutex m_Mutex;
+        std::vector<Phase> m_Phase;
+        std::vector<int> m_Stack;      /**< the indexes of the open phases */
+        std::vector<Event> m_Event;
+        int m_nDroppedEvents;
+        std::chrono::steady_clock::time_point m_Origin;
+        std::array<std::atomic<int64_t>, NCOUNTERS> m_Counter;
+
+        static bool s_bEnabled;
+        static int s_MaxEvents;
+};
@@ -0,0 +1,142 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+class ObjectStore;
+
+/**
+ * @class ThreadPool
+ * @brief A process-wide pool of persistent worker threads.
+ *
+ * Each worker owns a double-ended task queue. A worker pops its own tasks from the back
+ * and steals from the front of the other queues when its own is empty, so that uneven
+ * blocks do not leave cores idle.
+ * The thread calling parallelFor() takes part in the work while it waits, so that nested
+ * calls from inside a task are safe.
+ * The tasks run with the ObjectStore of the calling thread.
+ * Once the queues have grown to their working size, a loop makes no heap allocation.
+ *
+ * When the pool is NUMA-aware, the workers are pinned to the NUMA nodes in turn, and the loops
+ * called from a thread pinned to a node only run on that node's workers and on the calling thread,
+ * so that concurrent analyses pinned to different nodes each keep their memory traffic local.
+ */
+class FL5LIB_EXPORT ThreadPool
+{
+    private:
+        /** The state shared by the tasks of one call to parallelFor() */
+        struct Loop
+        {
+            std::function<void(int)> const *m_pTask{nullptr};
+            ObjectStore *m_pStore{nullptr};
+            int m_nRemaining{0};
+            std::mutex m_Mutex;
+            std::condition_variable m_Done;
+        };
+
+        /** A queued task: the index of one iteration of a loop */
+        struct Task
+        {
+            Loop *m_pLoop{nullptr};
+            int m_Index{0};
+        };
+
+        /** A worker's queue, as a ring buffer which keeps its capacity */
+        struct Worker
+        {
+            bool isEmpty() const {return m_nTasks==0;}
+            void pushBack(Task const &task);
+            Task popBack();
+            Task popFront();
+
+            std::vector<Task> m_Ring;
+            size_t m_Head{0};
+            size_t m_nTasks{0};
+            int m_Node{-1};         /**< the NUMA node to which the worker is pinned, or -1 */
+            std::mutex m_Mutex;
+        };
+
+    public:
+        ~ThreadPool();
+
+        static ThreadPool &pool();
+
+        static void setMaxThreadCount(int nThreads);
+        static int maxThreadCount();
+
+        static void setNumaAware(bool bNuma);
+        static bool isNumaAware() {return s_bNumaAware;}
+
+        /** The number of blocks into which a loop should be split for the given thread count;
+         * more blocks than threads are used so that the work can be balanced by stealing. */
+        static int nBlocks(int nThreads) {return nThreads<=1 ? 1 : nThreads*s_BlocksPerThread;}
+
+        void parallelFor(int nTasks, std::function<void(int)> const &task);
+
+        /** Avoids the copy of the callable into a std::function, which allocates when its captures are large */
+        template<typename Callable>
+        void parallelFor(int nTasks, Callable const &task)
+        {
+            parallelFor(nTasks, std::function<void(int)>([&task](int i){task(i);}));
+        }
+
+        int nWorkers() const {return int(m_Threads.size());}
+
+    private:
+        ThreadPool();
+        void start(int nThreads);
+        void stop();
+        void workerLoop(int iWorker);
+        bool runOneTask(int iWorker, int node);
+        void push(Task const &task, int node);
+        static void runTask(Task const &task);
+
+    private:
+        std::vector<std::thread> m_Threads;
+        std::vector<Worker*> m_Workers;
+        std::vector<std::vector<int>> m_NodeWorkers; /**< the indexes of the workers pinned to each node; empty if the pool is not NUMA-aware */
+
+        std::mutex m_WakeMutex;
+        std::condition_variable m_WakeCondition;
+        std::atomic<int> m_nQueued;
+        std::atomic<int> m_NextWorker;
+        bool m_bStop;
+
+        std::mutex m_ResizeMutex;
+
+        static int s_MaxThreads;        /**< the thread count set by setMaxThreadCount(), or 0 to use the hardware's */
+        static int s_BlocksPerThread;
+        static bool s_bNumaAware;
+};
+
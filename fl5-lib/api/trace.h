@@ -39,4 +39,7 @@ namespace xfl
     void FL5LIB_EXPORT trace(QString const &msg, double f);
     void FL5LIB_EXPORT trace(QString const &msg, const QString &txt);
 
+    void FL5LIB_EXPORT startupMark(QString const &phase);
+    QString FL5LIB_EXPORT startupReport();
+
 }
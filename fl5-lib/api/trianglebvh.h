@@ -0,0 +1,89 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <node.h>
+#include <triangle3d.h>
+
+/**
+ * @class TriangleBVH
+ * @brief A bounding volume hierarchy over a list of triangles, for the fast intersection of segments and lines
+ * and the search of the triangles close to a box.
+ *
+ * The tree only stores the indices of the triangles; the list used to build the tree must be passed
+ * to each query, and the tree must be rebuilt or cleared each time the triangles move.
+ * The build is thread-safe, so that the tree can be made on first use by concurrent queries.
+ */
+class FL5LIB_EXPORT TriangleBVH
+{
+    private:
+        struct BVHNode
+        {
+            Vector3d m_Min;     /**< the lower corner of the bounding box */
+            Vector3d m_Max;     /**< the upper corner of the bounding box */
+            int m_First{0};     /**< the index of the first triangle of a leaf in m_Index, or of the right child of an inner node */
+            int m_Count{0};     /**< the number of triangles of a leaf, 0 for an inner node; the left child of an inner node is the next node */
+        };
+
+    public:
+        TriangleBVH();
+        TriangleBVH(TriangleBVH const &bvh);
+        TriangleBVH &operator=(TriangleBVH const &bvh);
+
+        void build(std::vector<Triangle3d> const &triangles);
+        void clear();
+        bool isBuilt() const {return m_bBuilt.load();}
+        int nTriangles() const {return int(m_Index.size());}
+
+        bool intersectSegment(std::vector<Triangle3d> const &triangles, Vector3d const &A, Vector3d const &B, Node &I) const;
+        bool intersectLine(std::vector<Triangle3d> const &triangles, Vector3d const &A, Vector3d const &B, Node &I) const;
+        int nearestTriangle(std::vector<Triangle3d> const &triangles, Vector3d const &A, Vector3d const &B, Node &I) const;
+        int intersectSegments(std::vector<Triangle3d> const &triangles, int nSegs, Vector3d const *A, Vector3d const *B, Node *I, bool *bIntersect, bool bMultiThreaded) const;
+        void overlappingTriangles(Vector3d const &boxmin, Vector3d const &boxmax, std::vector<int> &list) const;
+
+        static void setLeafSize(int nLeaf) {s_LeafSize = std::max(1, nLeaf);}
+        static int leafSize() {return s_LeafSize;}
+
+    private:
+        int makeNode(std::vector<Triangle3d> const &triangles, std::vector<Vector3d> const &centroid, int first, int count);
+        bool intersect(std::vector<Triangle3d> const &triangles, Vector3d const &A, Vector3d const &B, bool bSegment, Node &I, int &iTriangle) const;
+        static bool hitBox(BVHNode const &node, Vector3d const &A, Vector3d const &U, bool bSegment, double &tenter);
+
+    private:
+        std::vector<BVHNode> m_Node;   /**< the root is the first node */
+        std::vector<int> m_Index;      /**< the indices of the triangles, sorted so that the triangles of each leaf are contiguous */
+
+        std::atomic<bool> m_bBuilt;
+        mutable std::mutex m_BuildMutex;
+
+        static int s_LeafSize;
+};
+
@@ -33,6 +33,7 @@
 #include <triangulation.h>
 
 class Node;
+class PointHash;
 
 class FL5LIB_EXPORT TriMesh : public XflMesh
 {
@@ -60,6 +61,8 @@ class FL5LIB_EXPORT TriMesh : public XflMesh
 
         int cleanNullTriangles();
 
+        int refinePanels(std::vector<bool> const &bRefine, std::vector<int> &parent, std::vector<double> &weights, std::string &logmsg);
+
         void addPanel(Panel3 const &p3);
         void addPanels(std::vector<Panel3>const &panel3list) {m_Panel3.insert(m_Panel3.end(), panel3list.begin(), panel3list.end());}
         void addPanels(std::vector<Panel3>const &panel3list, Vector3d const &position);
@@ -81,15 +84,18 @@ class FL5LIB_EXPORT TriMesh : public XflMesh
 
         void copyConnections(TriMesh const &mesh3);
 
-        void checkElementSize(double minsize, std::vector<int> &elements, std::vector<double> &size);
+        void checkElementSize(double minsize, std::vector<int> &elements, std::vector<double> &size) const;
 
         void serializePanelsFl5(QDataStream &ar, bool bIsStoring);
         void serializeMeshFl5(  QDataStream &ar, bool bIsStoring);
 
+        size_t memoryFootprint() const override;
+
         void makeMeshFromTriangles(const std::vector<Triangle3d> &triangulation, int firstindex, xfl::enumSurfacePosition pos, std::string &logmsg, const std::string &prefix);
         void makeMeshTriangleBlock();
 
         void checkPanels(std::string &logmsg, bool bSkinny, bool bMinAngle, bool bMinArea, bool bMinSize, std::vector<int> &skinnylist, std::vector<int> &minanglelist, std::vector<int> &minarealist, std::vector<int> &minsizelist, double qualityfactor, double minangle, double minarea, double minsize);
+        int checkIntersections(std::string &logmsg, double gap, std::vector<int> &intersectlist, std::vector<int> &overlaplist, bool bMultiThreaded) const;
 
         void removePanelAt(int index);
         void removeLastPanel() {m_Panel3.pop_back();}
@@ -141,7 +147,7 @@ class FL5LIB_EXPORT TriMesh : public XflMesh
         static void setCancelled(bool bCancel) {s_bCancel=bCancel;}
 
     private:
-        void connectPanelBlock(int iBlock, bool bConnectTE);
+        void connectPanelBlock(int iBlock, bool bConnectTE, double maxdistance, PointHash const &edgehash);
 
         void savePanels(QDataStream &ar);
         void loadPanels(QDataStream &ar);
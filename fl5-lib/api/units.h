@@ -66,6 +66,8 @@ namespace Units
     extern std::vector<std::string> g_InertiaUnitLabels;
 
     extern int g_FluidUnitType;//0= International, 1= Imperial
+
+    extern int g_Revision;      /**< Incremented each time the conversion factors are set. */
     extern std::vector<std::string> g_DensityUnitLabels;
     extern std::vector<std::string> g_ViscosityUnitLabels;
 
@@ -126,6 +128,9 @@ namespace Units
     FL5LIB_EXPORT inline void setInertiaUnitIndex(int index)  {g_InertiaUnitIndex   = index;}
 
     FL5LIB_EXPORT inline int fluidUnitType() {return g_FluidUnitType;}
+
+    /** Returns a value which changes each time the conversion factors are set, so that the values cached in custom units can be invalidated */
+    FL5LIB_EXPORT inline int revision() {return g_Revision;}
     FL5LIB_EXPORT inline void setFluidUnitType(int type) {g_FluidUnitType=type;}
 
 
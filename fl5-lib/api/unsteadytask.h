@@ -0,0 +1,122 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <planetask.h>
+
+
+/**
+ * @class UnsteadyTask
+ * @brief The time-marching panel analysis of a rigid plane in a non-uniform, unsteady flow, e.g. a gust or a manoeuvre.
+ *
+ * The geometry is fixed in body axes, so that the influence matrix is made and factorized once for the whole run.
+ * At each time step:
+ *   - the onset velocity of each panel is made from the free stream, the motion of the body and the gust field,
+ *     to which the velocities induced by the vortons are added;
+ *   - the RHS are combined from the coefficients of makeRHSCoefficients() and back-substituted;
+ *   - the vortons are advected, a new row is shed from the trailing wake panels, and the excess vortons are merged.
+ * The time step is the time taken by the free stream to travel the polar's vorton step, i.e. dt = L0.MAC/QInf.
+ * The velocities induced by the vortons on the panels and on the vortons themselves are evaluated with their octree,
+ * and those of the panels on the vortons with the panel tree, so that a step costs a back-substitution plus O(N.log(N)).
+ *
+ * The polar must be a fixed speed polar with the vorton wake enabled. The time history of the forces is
+ * stored in the task; no operating point is added to the polar.
+ */
+class FL5LIB_EXPORT UnsteadyTask : public PlaneTask
+{
+    public:
+        /** The state of the plane at one time step; the forces are in body axes and in N/q */
+        struct Sample
+        {
+            double m_Time{0};
+            Vector3d m_Force;           /**< the total force */
+            Vector3d m_UnsteadyForce;   /**< the contribution of the rate of change of the potential to the total force */
+            double m_CL{0};
+            double m_CD{0};
+            double m_CY{0};
+            int m_nVortons{0};
+        };
+
+        /** Returns at time t the velocity V of the reference point relative to the air at rest, and the rotation rates Omega,
+         *  in body axes, excluding the steady free stream; called from the advection threads, so must be reentrant */
+        typedef std::function<void(double t, Vector3d &V, Vector3d &Omega)> Kinematics;
+
+        /** Returns the velocity of the air at point P and time t, in body axes, in addition to the free stream;
+         *  called from the advection threads, so must be reentrant */
+        typedef std::function<Vector3d(Vector3d const &P, double t)> GustField;
+
+    public:
+        UnsteadyTask();
+
+        void setFlightCondition(double alpha, double beta) {m_Alpha=alpha; m_Beta=beta;}
+        void setTimeSteps(int nSteps) {m_nSteps=std::max(0, nSteps);}
+        void setKinematics(Kinematics const &kinematics) {m_Kinematics=kinematics;}
+        void setGust(GustField const &gust) {m_Gust=gust;}
+        /** Sets the point about which the rotation rates are applied; defaults to the polar's CoG */
+        void setReferencePoint(Vector3d const &P) {m_RefPoint=P; m_bRefPoint=true;}
+
+        int nTimeSteps() const {return m_nSteps;}
+        double timeStep() const {return m_dt;}
+        std::vector<Sample> const &history() const {return m_History;}
+
+        void loop() override;
+
+        static GustField oneMinusCosineGust(double amplitude, double length, double x0, double QInf);
+
+        /** The opening angle of the vorton and panel trees during the time marching; 0 to use the polar's and the global settings */
+        static void setTreeTheta(double theta) {s_TreeTheta=std::max(0.0, theta);}
+        static double treeTheta() {return s_TreeTheta;}
+
+    protected:
+        Vector3d onsetVelocity(Vector3d const &P) const override;
+
+    private:
+        bool factorize();
+        void makeOnsetField(std::vector<Vector3d> const &VVPW, std::vector<Vector3d> &VField) const;
+        Vector3d potentialIntegral() const;
+
+    private:
+        int m_nSteps;               /**< the number of time steps */
+        double m_dt;                /**< the time step, s */
+        double m_Time;              /**< the time of the step being calculated, s */
+
+        Vector3d m_VInf;            /**< the steady free stream, in body axes */
+        Vector3d m_VBody;           /**< the velocity of the reference point at the current time, in body axes */
+        Vector3d m_Omega;           /**< the rotation rates at the current time, in body axes */
+        Vector3d m_RefPoint;
+        bool m_bRefPoint;
+
+        Kinematics m_Kinematics;
+        GustField m_Gust;
+
+        std::vector<Sample> m_History;
+
+        static double s_TreeTheta;
+};
+
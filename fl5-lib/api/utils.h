@@ -32,6 +32,7 @@
 #include <vector>
 
 #include <QDataStream>
+#include <QStringList>
 
 
 #define ALPHAstr      std::string("\u03B1")
@@ -72,6 +73,8 @@
 #include <fl5lib_global.h>
 #include <fl5color.h>
 
+class QTextStream;
+
 
 
 namespace xfl
@@ -104,6 +107,7 @@ namespace xfl
 
     FL5LIB_EXPORT  int   randomInt(int range);
     FL5LIB_EXPORT  float randomfloat(float fmax);
+    FL5LIB_EXPORT  fl5Color randomfl5Color(bool bLightColor=true);
 
 
     FL5LIB_EXPORT  void readString(QDataStream &ar, std::string &strong);
@@ -112,17 +116,76 @@ namespace xfl
 
     FL5LIB_EXPORT  int readValues(const std::string &theline, float val[], int nValues);
     FL5LIB_EXPORT  void readFloat(QDataStream &inStream, float &f);
+    /** The stored bytes of an array of values, read from a stream and decoded later on */
+    struct ArrayBlock
+    {
+        int m_nValues{0};
+        bool m_bPacked{false};     /**< true if written by writePackedArray(), false if written as a sequence of ar << float(x) */
+        bool m_bFixed16{false};
+        bool m_bSingle{true};
+        bool m_bBigEndian{true};
+        double m_Min{0}, m_Max{0};
+        QByteArray m_Data;
+    };
+
+    FL5LIB_EXPORT  bool readFloatArray(QDataStream &ar, double *values, int n);
+    FL5LIB_EXPORT  void writeFloatArray(QDataStream &ar, double const *values, int n);
+    FL5LIB_EXPORT  void writePackedArray(QDataStream &ar, double const *values, int n, bool bFixed16);
+    FL5LIB_EXPORT  bool readPackedArray(QDataStream &ar, double *values, int n);
+    FL5LIB_EXPORT  bool readFloatBlock(QDataStream &ar, int n, ArrayBlock &block);
+    FL5LIB_EXPORT  bool readPackedBlock(QDataStream &ar, int n, ArrayBlock &block);
+    FL5LIB_EXPORT  bool decodeArrayBlock(ArrayBlock const &block, double *values);
+    FL5LIB_EXPORT  void writeFloatColumns(QDataStream &ar, std::vector<double const*> const &columns, int n);
+    FL5LIB_EXPORT  bool readFloatColumns(QDataStream &ar, std::vector<double*> const &columns, int n);
+    FL5LIB_EXPORT  void writeRawBlock(QDataStream &ar, std::vector<char> const &buffer);
+    FL5LIB_EXPORT  bool readRawBlock(QDataStream &ar, std::vector<char> &buffer, size_t size);
+
+    /**
+     * Encodes and decodes in memory the values of fixed-size records as ar << x and ar >> x would,
+     * honouring the stream's version, floating point precision and byte order, so that an array
+     * of records is written with writeRawBlock() and read with readRawBlock() without changing the format.
+     */
+    class FL5LIB_EXPORT RecordCodec
+    {
+        public:
+            explicit RecordCodec(QDataStream const &ar);
+
+            int floatSize()  const {return m_FloatSize;}
+            int doubleSize() const {return m_DoubleSize;}
+
+            void putInt(char *&p, qint32 i) const;
+            void putBool(char *&p, bool b) const {*p++ = b ? 1 : 0;}
+            void putFloat(char *&p, float f) const;
+            void putDouble(char *&p, double d) const;
+
+            qint32 getInt(char const *&p) const;
+            bool getBool(char const *&p) const {return *p++!=0;}
+            float getFloat(char const *&p) const;
+            double getDouble(char const *&p) const;
+
+        private:
+            bool m_bBigEndian;
+            int m_FloatSize, m_DoubleSize;
+    };
+
     FL5LIB_EXPORT  void writeFloat(QDataStream &outStream, float f);
 
     FL5LIB_EXPORT  bool stringToFile(std::string const &string, std::string const &path);
     FL5LIB_EXPORT  bool stringFromFile(std::string &string, std::string const &path);
+    FL5LIB_EXPORT  void appendToLog(std::string &log, std::string const &str, size_t maxSize);
 
 
     FL5LIB_EXPORT  bool stringToBool(QString const &str);
     FL5LIB_EXPORT  QString boolToString(bool b);
 
+    FL5LIB_EXPORT  QStringList findFiles(const QString &startDir, const QStringList &filters, bool bRecursive);
+    FL5LIB_EXPORT  bool findFile(QString const &filename, QString const &startDir, const QStringList &filters, bool bRecursive, QString &filePathName);
+    FL5LIB_EXPORT  bool readAVLString(QTextStream &in, int &Line, QString &strong);
+
     FL5LIB_EXPORT std::string MklVersion();
 
+    FL5LIB_EXPORT size_t peakMemoryUsage();
+
     /** @enum The status of the 3d analysis */
     enum enumAnalysisStatus {PENDING, RUNNING, CANCELLED, FINISHED};
 
@@ -0,0 +1,151 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include <fl5lib_global.h>
+#include <vector3d.h>
+
+class CartesianFrame;
+
+
+/**
+ * A std allocator which aligns the arrays on 64 bytes, i.e. on a cache line and on the width of the AVX-512 registers,
+ * so that the vectorized loops start on an aligned address.
+ */
+template <typename T, std::size_t Alignment=64>
+class AlignedAllocator
+{
+    public:
+        typedef T value_type;
+
+        template <typename U> struct rebind {typedef AlignedAllocator<U, Alignment> other;};
+
+        AlignedAllocator() = default;
+        template <typename U> AlignedAllocator(AlignedAllocator<U, Alignment> const &) {}
+
+        T *allocate(std::size_t n)
+        {
+            return static_cast<T*>(::operator new(n*sizeof(T), std::align_val_t(Alignment)));
+        }
+
+        void deallocate(T *p, std::size_t) noexcept
+        {
+            ::operator delete(p, std::align_val_t(Alignment));
+        }
+
+        template <typename U> bool operator==(AlignedAllocator<U, Alignment> const &) const {return true;}
+        template <typename U> bool operator!=(AlignedAllocator<U, Alignment> const &) const {return false;}
+};
+
+
+/**
+ * @class Vector3Array
+ * @brief A packed structure-of-arrays of 3d vectors, with the x, y and z components in separate aligned arrays.
+ *
+ * Vector3d has a vtable and the Nodes hold their connections, so that the arrays of structs interleave the components
+ * with unrelated data and their loops cannot be vectorized. The bulk operations of this class are branchless loops over
+ * contiguous components, so that the compiler processes 4 or 8 vectors at once depending on the target flags.
+ * The arrays are loaded from and stored to any array of objects derived from Vector3d.
+ *
+ * The float variant is used to build the display buffers and in the mixed-precision kernels;
+ * the operations are evaluated in the precision of the components.
+ */
+template <typename T>
+class FL5LIB_EXPORT Vector3Array
+{
+    public:
+        Vector3Array() = default;
+        explicit Vector3Array(int n) {resize(n);}
+
+        void clear() {resize(0);}
+        void resize(int n) {m_x.resize(n); m_y.resize(n); m_z.resize(n);}
+        int size() const {return int(m_x.size());}
+        bool isEmpty() const {return m_x.empty();}
+
+        void set(int i, Vector3d const &V) {m_x[i]=T(V.x); m_y[i]=T(V.y); m_z[i]=T(V.z);}
+        Vector3d at(int i) const {return Vector3d(double(m_x.at(i)), double(m_y.at(i)), double(m_z.at(i)));}
+
+        /** Loads the components of n objects derived from Vector3d */
+        template <typename V> void load(V const *pts, int n)
+        {
+            resize(n);
+            for(int i=0; i<n; i++) {m_x[i]=T(pts[i].x); m_y[i]=T(pts[i].y); m_z[i]=T(pts[i].z);}
+        }
+        template <typename V> void load(std::vector<V> const &pts) {load(pts.data(), int(pts.size()));}
+
+        /** Stores the components in the first size() objects of the array; the other members of the objects are left untouched */
+        template <typename V> void store(V *pts) const
+        {
+            for(int i=0; i<size(); i++) {pts[i].x=double(m_x[i]); pts[i].y=double(m_y[i]); pts[i].z=double(m_z[i]);}
+        }
+        template <typename V> void store(std::vector<V> &pts) const {store(pts.data());}
+
+        void translate(double tx, double ty, double tz);
+        void translate(Vector3d const &T_) {translate(T_.x, T_.y, T_.z);}
+        void scale(double sx, double sy, double sz);
+        void transform(double const *M);
+        void rotate(Vector3d const &R, double angle);
+        void rotate(Vector3d const &O, Vector3d const &R, double angle);
+        void addScaled(double a, Vector3Array const &V);
+
+        void globalToLocal(CartesianFrame const &frame);
+        void localToGlobal(CartesianFrame const &frame);
+        void globalToLocalPosition(CartesianFrame const &frame);
+        void localToGlobalPosition(CartesianFrame const &frame);
+
+        void dot(Vector3Array const &V, T *result) const;
+        void cross(Vector3Array const &V, Vector3Array &result) const;
+        void norm(T *result) const;
+        void normalize();
+
+        void interleave(float *xyz) const;
+
+        T *x() {return m_x.data();}
+        T *y() {return m_y.data();}
+        T *z() {return m_z.data();}
+        T const *x() const {return m_x.data();}
+        T const *y() const {return m_y.data();}
+        T const *z() const {return m_z.data();}
+
+    private:
+        static void rotationMatrix(Vector3d const &R, double angle, double *M);
+
+    private:
+        std::vector<T, AlignedAllocator<T>> m_x, m_y, m_z;
+};
+
+
+typedef Vector3Array<double> Vector3dArray;
+typedef Vector3Array<float>  Vector3fArray;
+
+extern template class Vector3Array<double>;
+extern template class Vector3Array<float>;
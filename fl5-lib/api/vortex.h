@@ -24,6 +24,8 @@
 
 
 #pragma once
+#include <vector>
+
 #include <QDataStream>
 
 #include <segment3d.h>
@@ -43,6 +45,7 @@ class FL5LIB_EXPORT Vortex : public Segment3d
         double circulation() const {return m_Circulation;}
 
         bool serializeFl5(QDataStream &ar, bool bIsStoring);
+        static bool serializeArrayFl5(QDataStream &ar, std::vector<Vortex> &vortices, bool bIsStoring);
 
         void getInducedVelocity(Vector3d const &C, Vector3d &vel, double coreradius, enumVortex vortexmodel=POTENTIAL) const;
 
@@ -25,6 +25,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include <QDataStream>
 
@@ -82,7 +83,10 @@ class FL5LIB_EXPORT Vorton
 
         void translate(Vector3d const &T) {m_Position += T;}
 
+        void merge(Vorton const &other);
+
         bool serializeFl5(QDataStream &ar, bool bIsStoring);
+        static bool serializeArrayFl5(QDataStream &ar, std::vector<Vorton> &vortons, bool bIsStoring);
 
         float xf() const {return m_Position.xf();}
         float yf() const {return m_Position.yf();}
@@ -0,0 +1,82 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <vector>
+
+#include <vorton.h>
+
+/**
+ * @class VortonTree
+ * @brief An octree of vortons for the Barnes-Hut evaluation of the induced velocities and gradients.
+ *
+ * Each node holds an equivalent vorton located at the vorticity-weighted centroid of its vortons,
+ * with a vorticity equal to their sum.
+ * A node is used in place of its vortons when its size seen from the evaluation point is
+ * less than the opening angle theta; theta=0 reverts to the direct sum.
+ * The tree is a snapshot and must be rebuilt each time the vortons move.
+ */
+class FL5LIB_EXPORT VortonTree
+{
+    private:
+        struct Node
+        {
+            Vector3d m_Center;        /**< the center of the cubic cell */
+            double m_HalfSize{0};     /**< the half width of the cell */
+            Vorton m_Equivalent;      /**< the equivalent vorton of the cell */
+            int m_First{0};           /**< the index of the first vorton of the cell in m_Vorton */
+            int m_Count{0};           /**< the number of vortons in the cell */
+            int m_Child[8]{-1,-1,-1,-1,-1,-1,-1,-1};
+            bool m_bLeaf{true};
+        };
+
+    public:
+        VortonTree();
+
+        void clear() {m_Node.clear(); m_Vorton.clear();}
+        void build(std::vector<std::vector<Vorton>> const &vortonrows);
+        bool isEmpty() const {return m_Vorton.empty();}
+
+        void setTheta(double theta) {m_Theta=theta;}
+        double theta() const {return m_Theta;}
+
+        void inducedVelocity(Vector3d const &C, double CoreSize, Vector3d &V) const;
+        void velocityGradient(Vector3d const &C, double CoreSize, double *G) const;
+
+    private:
+        int makeNode(Vector3d const &center, double halfsize, int first, int count, int depth);
+        bool isFarField(Node const &node, Vector3d const &C) const;
+
+    private:
+        std::vector<Node> m_Node;     /**< the root is the first node */
+        std::vector<Vorton> m_Vorton; /**< the active vortons, sorted so that the vortons of each cell are contiguous */
+        double m_Theta;               /**< the opening angle criterion */
+
+        static int s_LeafSize;
+        static constexpr int s_MaxDepth = 20;
+        static constexpr int s_MaxStack = 7*s_MaxDepth+1;   /**< the depth-first traversal pops one node and pushes at most 8 per level */
+};
+
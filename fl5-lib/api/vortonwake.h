@@ -0,0 +1,97 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <QDataStream>
+
+#include <vorton.h>
+#include <vortontree.h>
+
+
+/**
+ * @class VortonWake
+ * @brief The compact storage of the vorton wake of an operating point.
+ *
+ * The positions and vortex vectors are stored in single precision, in one array per component, with one flag per
+ * vorton for its active state; the volumes, which are only used during the analysis, are not stored.
+ * The rows are stored one after the other, and their sizes are kept so that the row and column structure of the wake
+ * is available for display.
+ * The octree used to evaluate the induced velocities is built from the stored vortons the first time it is
+ * required, and is shared by the threads which evaluate velocities concurrently.
+ */
+class FL5LIB_EXPORT VortonWake
+{
+    public:
+        VortonWake();
+        VortonWake(VortonWake const &wake);
+        VortonWake &operator=(VortonWake const &wake);
+
+        void clear();
+        void set(std::vector<std::vector<Vorton>> const &vortonrows);
+        void appendRow(std::vector<Vorton> const &row);
+        void makeVortons(std::vector<std::vector<Vorton>> &vortonrows) const;
+        Vorton vorton(int i) const;
+
+        bool isEmpty() const {return m_X.empty();}
+        int nRows() const {return int(m_RowStart.size())-1;}
+        int rowSize(int ir) const {return m_RowStart.at(ir+1)-m_RowStart.at(ir);}
+        /** Returns the index in the arrays of the vorton ic of row ir */
+        int index(int ir, int ic) const {return m_RowStart.at(ir)+ic;}
+        int count() const {return int(m_X.size());}
+
+        float xf(int i) const {return m_X.at(i);}
+        float yf(int i) const {return m_Y.at(i);}
+        float zf(int i) const {return m_Z.at(i);}
+        Vector3d position(int i) const {return Vector3d(m_X.at(i), m_Y.at(i), m_Z.at(i));}
+        Vector3d vortex(int i) const {return Vector3d(m_Wx.at(i), m_Wy.at(i), m_Wz.at(i));}
+        bool isActive(int i) const {return m_Active.at(i)!=0;}
+        /** Returns the position of the first vorton of the row, which must not be empty */
+        Vector3d rowFront(int ir) const {return position(m_RowStart.at(ir));}
+
+        void inducedVelocity(Vector3d const &C, double CoreSize, Vector3d &V) const;
+
+        bool serializeFl5(QDataStream &ar, bool bIsStoring);
+
+        size_t bytes() const;
+
+    private:
+        void buildTree() const;
+
+    private:
+        std::vector<int> m_RowStart;                   /**< the index of the first vorton of each row, and the total count */
+        std::vector<float> m_X, m_Y, m_Z;              /**< the positions */
+        std::vector<float> m_Wx, m_Wy, m_Wz;           /**< the vortex vectors */
+        std::vector<unsigned char> m_Active;
+
+        mutable VortonTree m_Tree;                     /**< built on the first velocity evaluation */
+        mutable std::atomic<bool> m_bTree;
+        mutable std::mutex m_TreeMutex;
+};
+
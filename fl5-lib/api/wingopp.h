@@ -59,6 +59,8 @@ class FL5LIB_EXPORT WingOpp
         bool serializeWingOppXFL(QDataStream &ar, bool bIsStoring);
         bool serializeWingOppFl5(QDataStream &ar, bool bIsStoring);
 
+        size_t memoryFootprint() const;
+
         double maxLift() const;
         void createWOpp(const WingXfl *pWing, const PlanePolar *pWPolar, const SpanDistribs &distribs, const AeroForces &AF);
 
@@ -45,6 +45,7 @@ class PlaneOpp;
 class Panel3;
 class Panel4;
 class PointMass;
+class Fuse;
 class Triangle3d;
 class Segment3d;
 
@@ -80,6 +81,7 @@ class FL5LIB_EXPORT WingXfl : public Part
         xfl::enumType wingType() const {return m_WingType;}
         void setWingType(xfl::enumType type) {m_WingType = type;}
 
+        /** The spans, areas and MAC are computed once in computeGeometry(), which is called after each edit of the sections */
         double planformSpan()  const {return m_PlanformSpan;}
         double projectedSpan() const {return m_ProjectedSpan;}
         double planformArea()  const {return m_PlanformArea;}
@@ -169,6 +171,7 @@ class FL5LIB_EXPORT WingXfl : public Part
         WingSection *pSection(int iSec);
 
         void clearSurfaces() {m_Surface.clear();}
+        void reuseSideNodes(Fuse const *pTranslatedFuse, std::vector<int> &rebuild);
 
 
         std::vector<Panel3> const &panels() const {return m_TriMesh.panels();}
@@ -340,6 +343,7 @@ class FL5LIB_EXPORT WingXfl : public Part
     private:
         std::vector<WingSection> m_Section;         /**< the array of wing sections. A WingSection extends between a foil and the next. */
         std::vector<Surface> m_Surface;             /**< the array of Surface objects associated to the wing */
+        std::vector<Surface> m_PreviousSurface;     /**< the surfaces replaced by the last call to createSurfaces(), whose side nodes may be reused */
         std::vector<int> m_StripStartNodes;         /**< the indexes of the nodes at the start of each wingsection */
 
         static double s_MinSurfaceLength;       /**< wing minimum panel size ; panels of less length are ignored */
@@ -0,0 +1,106 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+class Opp3d;
+class QuadMesh;
+class TriMesh;
+
+
+/**
+ * @class XdmfWriter
+ * @brief Writes the panel results of a list of operating points as an XDMF time series, for post-processing in ParaView.
+ *
+ * The mesh is written once in a binary file, and the fields of each operating point in a binary file of its own,
+ * as raw arrays of native doubles which are written directly from the result vectors. The XDMF file describes the
+ * arrays and references the binary files by offset, so that neither HDF5 nor a VTK library is required.
+ * The panels are written with separate vertices, so that the fields which hold three values per triangular panel,
+ * i.e. the Cp, gamma and sigma of the triangle methods, are vertex fields without conversion, and the fields
+ * which hold one value per panel are cell fields. The vorton wakes are written as a second time series of points.
+ * The operating points are written concurrently in the thread pool.
+ */
+class FL5LIB_EXPORT XdmfWriter
+{
+    public:
+        XdmfWriter();
+
+        void setMultiThreaded(bool bMultiThreaded) {m_bMultiThreaded=bMultiThreaded;}
+
+        bool write(std::string const &dirpath, std::string const &basename, TriMesh const &trimesh, QuadMesh const &quadmesh,
+                   std::vector<Opp3d const*> const &opps);
+
+        int nWritten() const {return m_nWritten;}
+        std::string const &log() const {return m_Log;}
+
+        /** May be set from any thread to interrupt the writing */
+        void cancel() {m_bCancel=true;}
+
+    private:
+        /** An array of a binary file */
+        struct Array
+        {
+            std::string m_Name;
+            bool m_bCell{false};       /**< true for one value per panel, false for one value per vertex */
+            double const *m_pData{nullptr};
+            size_t m_Count{0};
+            size_t m_Offset{0};        /**< the position of the array in the file, in bytes */
+        };
+
+        /** The content of the binary file of an operating point */
+        struct OppFile
+        {
+            Opp3d const *m_pOpp{nullptr};
+            std::string m_FileName;
+            std::vector<Array> m_Arrays;
+            std::vector<double> m_NodeValues;   /**< the node values gathered at the panel vertices */
+            std::vector<double> m_Vortons;      /**< the positions then the vortex vectors of the vortons */
+            size_t m_nVortons{0};
+            bool m_bWritten{false};
+        };
+
+        bool writeMesh(std::string const &pathname, TriMesh const &trimesh, QuadMesh const &quadmesh, bool bTriangles);
+        void makeOppFile(OppFile &oppfile, TriMesh const &trimesh, bool bTriangles) const;
+        bool writeOppFile(std::string const &dirpath, OppFile &oppfile) const;
+        bool writeXml(std::string const &pathname, std::string const &meshfilename, std::vector<OppFile> const &oppfiles) const;
+
+    private:
+        bool m_bMultiThreaded;
+
+        int m_nCells;
+        int m_nVertices;          /**< the number of vertices of a panel, 3 or 4 */
+
+        int m_nWritten;
+        std::string m_Log;
+        std::atomic<bool> m_bCancel;
+};
+
@@ -28,6 +28,7 @@
 
 #include <panel3.h>
 #include <node.h>
+#include <quaternion.h>
 
 
 class Node;
@@ -52,6 +53,9 @@ class FL5LIB_EXPORT XflMesh
         virtual void getLastTrailingPoint(Vector3d &pt) const = 0;
 
         virtual void rotate(double alpha, double beta, double phi) = 0;
+        static Quaternion rotationQuaternion(double alpha, double beta, double phi);
+
+        virtual size_t memoryFootprint() const;
 
 
 
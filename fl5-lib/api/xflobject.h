@@ -39,6 +39,8 @@ class FL5LIB_EXPORT XflObject
 
     public:
         virtual std::string name() const {return m_Name;}
+        /** The stored name, without copy; the operating points compute their name() instead */
+        std::string const &nameRef() const {return m_Name;}
         void setName(std::string const &name) {m_Name = name;}
 
         fl5Color const &lineColor() const {return m_theStyle.m_Color;}
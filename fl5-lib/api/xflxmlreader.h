@@ -48,6 +48,9 @@ class FL5LIB_EXPORT XflXmlReader : public QXmlStreamReader
         virtual ~XflXmlReader();
 
     protected:
+        int readValues(double *values, int nMax);
+        bool readVector(Vector3d &V, double unit);
+
         bool readTheStyle(LineStyle &theStyle);
         bool readColor(fl5Color &color);
         bool readPointMass(PointMass &pm, double massUnit, double lengthUnit);
@@ -0,0 +1,131 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+#include <analysisrange.h>
+
+class Foil;
+class Polar;
+class OpPoint;
+class ResultSink;
+class XFoilTask;
+
+
+/** A (foil, polar, ranges) analysis to be processed by the XFoilBatchEngine */
+struct XFoilJob
+{
+    Foil *m_pFoil{nullptr};               /**< the foil to analyze; must remain valid until the job has finished; its flaps are modified during the analysis */
+    Polar *m_pPolar{nullptr};             /**< the polar to which the results are added on the fly */
+    std::vector<AnalysisRange> m_Ranges;  /**< the aoa, Cl, Re or theta ranges, depending on the polar type */
+    bool m_bAlpha{true};                  /**< true if the ranges of type 1 and 2 polars are aoa ranges, false if Cl ranges */
+    bool m_bKeepOpps{false};              /**< true if the operating points should be returned in the result */
+    ResultSink *m_pResultSink{nullptr};   /**< if set, the sink to which the operating points are pushed as they are computed */
+    std::function<bool(Polar const &)> m_StopCondition;  /**< if set, called from the worker thread after each operating point; the job stops when it returns true */
+};
+
+
+/** The outcome of an XFoilJob, delivered through the result callback */
+struct XFoilJobResult
+{
+    int m_iJob{-1};                       /**< the index of the job, in the order of addJob() */
+    Foil *m_pFoil{nullptr};
+    Polar *m_pPolar{nullptr};
+    std::vector<OpPoint*> m_OpPoints;     /**< the operating points if the job requested them; the receiver takes ownership */
+    bool m_bErrors{false};
+    bool m_bCancelled{false};
+    bool m_bStopped{false};               /**< true if the job was stopped by its stop condition */
+    std::string m_Log;
+};
+
+
+/**
+ * @class XFoilBatchEngine
+ * @brief Runs a list of XFoil jobs on a fixed number of worker threads.
+ *
+ * Each worker owns an XFoilTask which is reused from one job to the next, so that the
+ * XFoil instance and its matrices are only allocated once per worker.
+ * The jobs are scheduled by decreasing estimated cost so that a long job does not
+ * start last and leave the other workers idle at the end of the batch.
+ * The jobs already stored in the XFoilResultCache are read back instead of being computed.
+ * The callbacks are called from the worker threads, one at a time.
+ */
+class FL5LIB_EXPORT XFoilBatchEngine
+{
+    public:
+        XFoilBatchEngine();
+        ~XFoilBatchEngine();
+
+        void setWorkerCount(int nWorkers);
+        int workerCount() const {return m_nWorkers;}
+
+        void addJob(XFoilJob const &job);
+        void clearJobs();
+        int nJobs() const {return int(m_Jobs.size());}
+        int nFinished() const {return m_nFinished.load();}
+
+        void setStartCallback(std::function<void(XFoilJob const &, int)> const &callback) {m_StartCallback=callback;}
+        void setResultCallback(std::function<void(XFoilJobResult &)> const &callback) {m_ResultCallback=callback;}
+
+        void start();
+        void wait();
+        void run() {start(); wait();}
+        void cancel();
+        bool isCancelled() const {return m_pCancelToken->load();}
+        bool isRunning() const {return !m_Threads.empty();}
+
+        static double estimatedCost(XFoilJob const &job);
+
+    private:
+        void workerLoop(int iWorker);
+
+    private:
+        int m_nWorkers;
+
+        std::vector<XFoilJob> m_Jobs;
+        std::vector<int> m_Order;              /**< the job indexes, in the order of execution */
+        std::atomic<int> m_iNext;
+        std::atomic<int> m_nFinished;
+
+        std::vector<std::unique_ptr<XFoilTask>> m_Workers;
+        std::vector<std::thread> m_Threads;
+
+        std::shared_ptr<std::atomic<bool>> m_pCancelToken;
+
+        std::mutex m_CallbackMutex;
+        std::function<void(XFoilJob const &, int)> m_StartCallback;
+        std::function<void(XFoilJobResult &)> m_ResultCallback;
+};
+
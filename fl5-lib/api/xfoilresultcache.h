@@ -0,0 +1,103 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+#include <analysisrange.h>
+
+class Foil;
+class Polar;
+class XFoilTask;
+
+
+/**
+ * @class XFoilResultCache
+ * @brief A persistent, content-addressed store of XFoil results.
+ *
+ * The entries are keyed by a hash of the foil's node coordinates and flap settings and of the
+ * analysis parameters, i.e. Re, Mach, NCrit, the forced transitions and the flap angle, so that
+ * identical analyses of the same geometry are read back instead of recomputed, including from one
+ * session to the next. Renaming a foil or a polar does not invalidate the entries; changing any node
+ * or parameter does.
+ *
+ * Two kinds of files are stored in the cache directory:
+ *   - the Cl-Re points of the on-the-fly drag calculations of the 3d analyses, one file per section
+ *     foil and settings, appended as new points are computed;
+ *   - the polar data computed by the batch analyses, one file per foil, polar and range set.
+ * Only converged results are cached. The operating points are not stored.
+ */
+class FL5LIB_EXPORT XFoilResultCache
+{
+    public:
+        /** The result of an on-the-fly calculation at a given Cl and Re */
+        struct OtfPoint
+        {
+            double m_Cd{0};
+            double m_XTrTop{1};
+            double m_XTrBot{1};
+        };
+
+    public:
+        static bool isEnabled() {return s_bEnabled;}
+        static void setEnabled(bool bEnabled) {s_bEnabled=bEnabled;}
+
+        static std::string cacheDirectory();
+        static void setCacheDirectory(std::string const &dir);
+
+        static uint64_t foilKey(Foil const &foil, Polar const &polar, XFoilTask const &task);
+        static uint64_t jobKey(Foil const &foil, Polar const &polar, XFoilTask const &task, std::vector<AnalysisRange> const &ranges, bool bAlpha);
+
+        static bool findPoint(uint64_t key, double Re, double Cl, OtfPoint &pt);
+        static void storePoint(uint64_t key, double Re, double Cl, OtfPoint const &pt);
+
+        static bool loadPolar(uint64_t key, Polar &polar);
+        static void storePolar(uint64_t key, Polar const &polar);
+
+        static void clear();
+
+    private:
+        static std::string filePath(uint64_t key, char const *extension);
+        static std::map<std::pair<int64_t, int64_t>, OtfPoint> &points(uint64_t key);
+        static std::pair<int64_t, int64_t> pointIndex(double Re, double Cl);
+
+    private:
+        static bool s_bEnabled;
+        static std::string s_CacheDir;   /**< the cache directory; if empty, a subdirectory of the system's temporary directory */
+
+        /** the OTF points read from the files or computed in this session, by foil key */
+        static std::unordered_map<uint64_t, std::map<std::pair<int64_t, int64_t>, OtfPoint>> s_Points;
+        static std::mutex s_Mutex;
+};
+
@@ -26,7 +26,12 @@
 #pragma once
 
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
 #include <mutex>
 #include <queue>
 
@@ -37,10 +42,14 @@
 #include <foil.h>
 #include <xfoil.h>
 #include <analysisrange.h>
+#include <taskprofile.h>
 #include <utils.h>
 
 class Polar;
 class OpPoint;
+class ResultSink;
+class LiveChannel;
+class ConvergenceMonitor;
 
 
 struct FoilAnalysis
@@ -91,6 +100,7 @@ class FL5LIB_EXPORT XFoilTask
         void initializeBL();
 
         XFoil const &XFoilInstance() const {return m_XFoilInstance;}
+        size_t memoryFootprint() const {return sizeof(*this) - sizeof(XFoil) + m_XFoilInstance.memoryFootprint();}
 
         void clearLog();
         std::string const &log() const {return m_Log;}
@@ -99,29 +109,90 @@ class FL5LIB_EXPORT XFoilTask
         void setClRange(double vMin, double vMax, double vDelta);
 
         void setKeepOpps(bool b) {m_bKeepOpps = b;}
+        /** Sets the sink to which each operating point is pushed on completion; not owned by the task */
+        void setResultSink(ResultSink *pSink) {m_pResultSink = pSink;}
+        /** Sets the channel to which the BL residuals and the operating points are streamed; not owned by the task */
+        void setLiveChannel(LiveChannel *pChannel) {m_pLiveChannel = pChannel;}
+        /** Sets the monitor to which the residuals of each viscous iteration are reported; not owned by the task */
+        void setConvergenceMonitor(ConvergenceMonitor *pMonitor) {m_pConvergenceMonitor = pMonitor;}
 
         bool bAlpha()   const   {return m_bAlpha;}
         void setAoAAnalysis(bool b) {m_bAlpha=b;}
 
         void clearOpps() {m_OpPoints.clear();}
 
+        /** The phase timers and the Newton iteration count of the task since its initialization */
+        TaskProfile const &profile() const {return m_Profile;}
+
         void traceLog(const QString &str);
         void traceStdLog(const std::string &str);
 
         static void setCancelled(bool b);
 
+        /** Sets the max. number of unread messages in the queue, beyond which the messages are dropped; 0 for no limit */
+        static void setMaxQueuedMessages(int n) {s_MaxQueuedMessages=std::max(0,n);}
+        /** Sets the max. number of characters of the task's log; the oldest lines are discarded first; 0 for no limit */
+        static void setMaxLogSize(int n) {s_MaxLogSize=std::max(0,n);}
+
+        /** Shares a cancellation token with this task, which may be set from any thread to stop
+         *  this task only; setCancelled() still stops all the tasks. */
+        void setCancelToken(std::shared_ptr<std::atomic<bool>> const &pToken);
+        std::shared_ptr<std::atomic<bool>> const &cancelToken() const {return m_pCancelToken;}
+        void cancel() {m_pCancelToken->store(true);}
+        bool cancelRequested() const {return s_bCancel || m_pCancelToken->load() || m_bStopped;}
+
+        /** Sets the condition checked each time an operating point has been added to the polar;
+         *  the remaining points of the analysis are skipped as soon as it returns true */
+        void setStopCondition(std::function<bool(Polar const &)> const &condition) {m_StopCondition=condition;}
+        bool isStopped() const {return m_bStopped;}
+
+        /** the settings of this task, initialized from the process-wide defaults at construction */
+        int iterLimit() const {return m_IterLim;}
+        void setIterLimit(int maxiter) {m_IterLim=maxiter;}
+        double VAccel() const {return m_VAccel;}
+        void setVAccel(double accel);
+        void setFullReport(bool bFull);
+        bool bAdaptiveSequence() const {return m_bAdaptiveSequence;}
+        void setAdaptiveSequence(bool b) {m_bAdaptiveSequence=b;}
+        int nSegments() const {return m_nSegments;}
+        void setSegments(int nSegments) {m_nSegments=std::max(1, nSegments);}
+
         static int maxIterations() {return s_IterLim;}
         static void setMaxIterations(int maxiter) {s_IterLim=maxiter;}
 
+        static bool bDefaultAdaptiveSequence() {return s_bAdaptiveSequence;}
+        static void setDefaultAdaptiveSequence(bool b) {s_bAdaptiveSequence=b;}
+
+        static int defaultSegments() {return s_nSegments;}
+        static void setDefaultSegments(int nSegments) {s_nSegments=std::max(1, nSegments);}
+
         static double CdError() {return s_CdError;}
         static double setCdError(double cderr) {return s_CdError=cderr;}
 
+        static bool bStoreBLStations() {return s_bStoreBLStations;}
+        static void setStoreBLStations(bool b) {s_bStoreBLStations=b;}
+
+        static void clearPreparedFoils();
+        static int maxPreparedFoils() {return s_MaxPreparedFoils;}
+        static void setMaxPreparedFoils(int nFoils);
+
     private:
         int loop();
+        int viscousIterations();
         bool alphaSequence(bool bAlpha);
         bool thetaSequence();
         bool ReSequence();
         void addXFoilData(OpPoint *pOpp, XFoil &xfoil, const Foil *pFoil);
+        bool initXFoilGeometry(int npts, double const *x, double const *y, double *nx, double *ny);
+        void applyRunSettings();
+        bool marchSequence(bool bAlpha, AnalysisRange const &range);
+        bool adaptiveSequence(bool bAlpha, AnalysisRange const &range);
+        bool segmentedSequence(bool bAlpha, AnalysisRange const &range);
+        std::vector<double> rangeTargets(bool bAlpha, AnalysisRange const &range) const;
+        bool solvePoint(bool bAlpha, double value, int &iterations);
+        void storeOpPoint();
+        void publishOpPoint(OpPoint *pOpPoint);
+        void checkStopCondition();
 
         bool processClRange(Polar *pPolar, const AnalysisRange &range);
 
@@ -141,18 +212,46 @@ class FL5LIB_EXPORT XFoilTask
         bool m_bAlpha;             /**< true if performing an analysis based on aoa, false if based on Cl */
 
         bool m_bKeepOpps;
+        ResultSink *m_pResultSink;
+        LiveChannel *m_pLiveChannel;
+        ConvergenceMonitor *m_pConvergenceMonitor;
 
         std::string m_Log;
+        int m_nDroppedMessages;     /**< the number of messages dropped since the queue was last read */
 
         xfl::enumAnalysisStatus m_AnalysisStatus;
 
         std::vector<AnalysisRange> m_AnalysisRange;
 
-        static bool s_bCancel;            /**< True if the user has asked to cancel the analysis */
+        int m_IterLim;
+        bool m_bAdaptiveSequence;
+        int m_nSegments;           /**< the number of continuation segments of an aoa or Cl range which are run concurrently */
+        bool m_bDeferResults;      /**< if true, the converged points are kept in m_Deferred instead of being added to the polar */
+        std::vector<OpPoint*> m_Deferred;
+        double m_VAccel;
+        bool m_bFullReport;
+        std::function<bool(Polar const &)> m_StopCondition;
+        bool m_bStopped;           /**< true if the stop condition has been met */
+        std::shared_ptr<std::atomic<bool>> m_pCancelToken;
+
+        TaskProfile m_Profile;
+
+        static std::atomic<bool> s_bCancel; /**< True if the user has asked to cancel all the analyses */
 
-        static int  s_IterLim;
+        static int  s_IterLim;            /**< the default iteration limit for new tasks */
+        static bool s_bAdaptiveSequence;  /**< the default sequence mode for new tasks; if true, the aoa and Cl ranges are processed by continuation with adaptive steps */
+        static int s_nSegments;           /**< the default number of continuation segments for new tasks; 1 to process the ranges sequentially */
         static bool s_bAutoInitBL;        /**< true if the BL initialization is left to the code's decision */
         static double s_CdError;          /**< discard points with |Cd| less than this value: these operating points are likely erroneous (spurious?) */
+        static bool s_bStoreBLStations;   /**< if false, the opps only keep the BL displacement surfaces and not the arrays which are used to plot the BL variables */
+        static int s_MaxQueuedMessages;
+        static int s_MaxLogSize;
+
+        /** The XFoil instances prepared for the most recently analyzed geometries, the last used first;
+         *  they hold the inviscid factorization which does not depend on Re, Mach, NCrit or the trips */
+        static std::list<std::pair<uint64_t, std::shared_ptr<XFoil const>>> s_PreparedFoils;
+        static std::mutex s_PreparedMutex;
+        static int s_MaxPreparedFoils;
 
 
     public:
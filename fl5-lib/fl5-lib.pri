@@ -6,7 +6,10 @@ HEADERS += \
     $$PWD/api/xmlplanepolarreader.h \
     $$PWD/api/xmlplanepolarwriter.h \
     $$PWD/math/testmatrix.h \
+    api/adaptivemesh.h \
+    api/aeroelasticloop.h \
     api/aeroforces.h \
+    api/allocstats.h \
     api/analysisrange.h \
     api/anglecontrol.h \
     api/api.h \
@@ -24,10 +27,14 @@ HEADERS += \
     api/bspline3d.h \
     api/cartesianframe.h \
     api/cartesianframe2d.h \
+    api/columnfile.h \
     api/constants.h \
+    api/convergencemonitor.h \
     api/ctrlrange.h \
     api/cubicinterpolation.h \
     api/cubicspline.h \
+    api/delaunay2d.h \
+    api/distributedsolver.h \
     api/edgesplit.h \
     api/eigenvalues.h \
     api/enums_objects.h \
@@ -39,6 +46,8 @@ HEADERS += \
     api/fl5object.h \
     api/flow5events.h \
     api/foil.h \
+    api/foildatabase.h \
+    api/foilpipeline.h \
     api/frame.h \
     api/fuse.h \
     api/fuseflatfaces.h \
@@ -52,27 +61,40 @@ HEADERS += \
     api/geom_global.h \
     api/geom_params.h \
     api/gmshparams.h \
+    api/gpusolver.h \
     api/gqtriangle.h \
     api/hanning.h \
+    api/hmatrix.h \
     api/hermiteinterpolation.h \
     api/inertia.h \
+    api/influenceblockcache.h \
+    api/kernelstats.h \
     api/linestyle.h \
+    api/livechannel.h \
     api/llttask.h \
+    api/lucache.h \
+    api/mappedstorage.h \
+    api/memorybudget.h \
     api/mathelem.h \
     api/matrix.h \
     api/mctriangle.h \
     api/mesh_globals.h \
+    api/meshsimplifier.h \
+    api/multilevelprecond.h \
     api/naca4spline.h \
     api/node.h \
     api/node2d.h \
+    api/numa.h \
     api/nurbssurface.h \
     api/objects2d.h \
     api/objects2d_globals.h \
     api/objects3d.h \
+    api/objectstore.h \
     api/objects_global.h \
     api/objects_params.h \
     api/occ_globals.h \
     api/occmeshparams.h \
+    api/occtessellationcache.h \
     api/opp3d.h \
     api/oppoint.h \
     api/optstructures.h \
@@ -86,22 +108,33 @@ HEADERS += \
     api/panel4.h \
     api/panelanalysis.h \
     api/panelprecision.h \
+    api/panelsoa.h \
+    api/paneltree.h \
     api/part.h \
     api/plane.h \
+    api/planedoe.h \
+    api/fieldsampler.h \
     api/planeopp.h \
+    api/planeoppcache.h \
     api/planestl.h \
     api/planetask.h \
     api/planexfl.h \
     api/pointmass.h \
+    api/pointhash.h \
     api/pointspline.h \
     api/polar.h \
     api/polar3d.h \
+    api/polarindex.h \
+    api/polarmeshgenerator.h \
+    api/polarpreview.h \
     api/pslg2d.h \
     api/qrleastsquares.h \
     api/quad2d.h \
     api/quad3d.h \
     api/quadmesh.h \
     api/quaternion.h \
+    api/reducedmodel.h \
+    api/resultsink.h \
     api/rungekutta.h \
     api/s7spline.h \
     api/sail.h \
@@ -115,33 +148,48 @@ HEADERS += \
     api/segment2d.h \
     api/segment3d.h \
     api/sgsmooth.h \
+    api/stlreader.h \
+    api/stlwriter.h \
     api/spandistribs.h \
     api/spline.h \
     api/splinefoil.h \
     api/stabderivatives.h \
+    api/stabresponse.h \
     api/stream2d.h \
     api/surface.h \
     api/t8opp.h \
     api/task3d.h \
+    api/taskcheckpoint.h \
+    api/taskprofile.h \
     api/testpanels.h \
+    api/threadpool.h \
     api/trace.h \
     api/triangle2d.h \
     api/triangle3d.h \
+    api/trianglebvh.h \
     api/triangulation.h \
     api/trimesh.h \
     api/units.h \
+    api/unsteadytask.h \
     api/utils.h \
     api/vector2d.h \
     api/vector3d.h \
+    api/vector3darray.h \
     api/vortex.h \
     api/vorton.h \
+    api/vortontree.h \
+    api/vortonwake.h \
     api/wingopp.h \
     api/wingsailsection.h \
     api/wingsection.h \
     api/wingxfl.h \
+    api/xdmfwriter.h \
     api/xflmesh.h \
     api/xflobject.h \
+    api/xfoilbatchengine.h \
+    api/xfoilresultcache.h \
     api/xfoiltask.h \
+    api/neuralfoilnet.h \
     api/neuralfoiltask.h \
     api/xml_globals.h \
     api/xmlpolarreader.h \
@@ -171,17 +219,34 @@ SOURCES += \
     $$PWD/utils/fl5core.cpp \
     $$PWD/xml/xplane/xmlplanepolarreader.cpp \
     $$PWD/xml/xplane/xmlplanepolarwriter.cpp \
+    analysis3d/adaptivemesh.cpp \
+    analysis3d/aeroelasticloop.cpp \
     analysis3d/boattask.cpp \
+    analysis3d/distributedsolver.cpp \
+    analysis3d/gpusolver.cpp \
+    analysis3d/influenceblockcache.cpp \
     analysis3d/llttask.cpp \
+    analysis3d/lucache.cpp \
     analysis3d/p3analysis.cpp \
     analysis3d/p3linanalysis.cpp \
     analysis3d/p3unianalysis.cpp \
     analysis3d/p4analysis.cpp \
     analysis3d/panelanalysis.cpp \
+    analysis3d/planedoe.cpp \
+    analysis3d/planeoppcache.cpp \
+    analysis3d/fieldsampler.cpp \
     analysis3d/planetask.cpp \
+    analysis3d/polarmeshgenerator.cpp \
+    analysis3d/polarpreview.cpp \
+    analysis3d/reducedmodel.cpp \
+    analysis3d/neuralfoilnet.cpp \
     analysis3d/neuralfoiltask.cpp \
+    analysis3d/stabresponse.cpp \
     analysis3d/task3d.cpp \
+    analysis3d/taskcheckpoint.cpp \
+    analysis3d/unsteadytask.cpp \
     api/api.cpp \
+    geom/geom2d/delaunay2d.cpp \
     geom/geom2d/node2d.cpp \
     geom/geom2d/pslg2d.cpp \
     geom/geom2d/quad2d.cpp \
@@ -195,29 +260,39 @@ SOURCES += \
     geom/geom2d/vector2d.cpp \
     geom/geom3d/bspline3d.cpp \
     geom/geom3d/frame.cpp \
+    geom/geom3d/meshsimplifier.cpp \
     geom/geom3d/node.cpp \
     geom/geom3d/nurbssurface.cpp \
+    geom/geom3d/pointhash.cpp \
     geom/geom3d/quad3d.cpp \
     geom/geom3d/quaternion.cpp \
     geom/geom3d/segment3d.cpp \
     geom/geom3d/triangle3d.cpp \
+    geom/geom3d/trianglebvh.cpp \
     geom/geom3d/triangulation.cpp \
     geom/geom3d/vector3d.cpp \
+    geom/geom3d/vector3darray.cpp \
     geom/geom_globals/geom_global.cpp \
     math/cubicinterpolation.cpp \
     math/gaussquadrature.cpp \
     math/hanning.cpp \
     math/hermiteinterpolation.cpp \
+    math/hmatrix.cpp \
     math/mathelem.cpp \
     math/matrix.cpp \
+    math/multilevelprecond.cpp \
     math/qrleastsquares.cpp \
     math/rungekutta.cpp \
     math/sgsmooth.cpp \
     objects2d/analysis2d/stream2d.cpp \
+    objects2d/analysis2d/xfoilbatchengine.cpp \
+    objects2d/analysis2d/xfoilresultcache.cpp \
     objects2d/analysis2d/xfoiltask.cpp \
     objects2d/foilobjects/bldata.cpp \
     objects2d/foilobjects/blxfoil.cpp \
     objects2d/foilobjects/foil.cpp \
+    objects2d/foilobjects/foildatabase.cpp \
+    objects2d/foilobjects/foilpipeline.cpp \
     objects2d/foilobjects/oppoint.cpp \
     objects2d/foilobjects/panel2d.cpp \
     objects2d/foilobjects/polar.cpp \
@@ -230,10 +305,12 @@ SOURCES += \
     objects3d/analysis3d/opp3d.cpp \
     objects3d/analysis3d/planeopp.cpp \
     objects3d/analysis3d/polar3d.cpp \
+    objects3d/analysis3d/polarindex.cpp \
     objects3d/analysis3d/spandistribs.cpp \
     objects3d/analysis3d/stabderivatives.cpp \
     objects3d/analysis3d/wingopp.cpp \
     objects3d/globals/objects_global.cpp \
+    objects3d/globals/objectstore.cpp \
     objects3d/objects3d.cpp \
     objects3d/planeobjects/fuse/fuse.cpp \
     objects3d/planeobjects/fuse/fuseflatfaces.cpp \
@@ -266,6 +343,7 @@ SOURCES += \
     objects3d/sailobjects/splines7/s7spline.cpp \
     occ/occ_globals.cpp \
     occ/occmeshparams.cpp \
+    occ/occtessellationcache.cpp \
     panels/mesh/mesh_globals.cpp\
     panels/mesh/quadmesh.cpp \
     panels/mesh/trimesh.cpp \
@@ -275,16 +353,34 @@ SOURCES += \
     panels/panels/panel.cpp \
     panels/panels/panel3.cpp \
     panels/panels/panel4.cpp \
+    panels/panels/panelsoa.cpp \
+    panels/panels/paneltree.cpp \
     panels/panels/testpanels.cpp \
     panels/panels/vortex.cpp \
     panels/panels/vorton.cpp \
+    panels/panels/vortontree.cpp \
+    panels/panels/vortonwake.cpp \
     panels/shell/edgesplit.cpp \
+    utils/allocstats.cpp \
     utils/apilog.cpp \
+    utils/columnfile.cpp \
+    utils/convergencemonitor.cpp \
     utils/fileio.cpp \
     utils/fl5color.cpp \
+    utils/kernelstats.cpp \
+    utils/livechannel.cpp \
+    utils/mappedstorage.cpp \
+    utils/memorybudget.cpp \
+    utils/numa.cpp \
+    utils/resultsink.cpp \
+    utils/stlreader.cpp \
+    utils/stlwriter.cpp \
+    utils/taskprofile.cpp \
+    utils/threadpool.cpp \
     utils/trace.cpp \
     utils/units.cpp \
     utils/utils.cpp \
+    utils/xdmfwriter.cpp \
     xml/foil/xmlpolarreader.cpp \
     xml/foil/xmlpolarwriter.cpp \
     xml/fuse/xmlfusereader.cpp \
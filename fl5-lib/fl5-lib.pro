@@ -10,6 +10,8 @@ DEFINES += FL5LIB_LIBRARY
 DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 
+#DEFINES += FL5_KERNEL_STATS    # compiles the panel kernel counters, enabled at run time with KernelStats::setEnabled()
+#DEFINES += FL5_ALLOC_STATS     # counts the heap allocations of each TaskProfile phase; replaces the global operator new
 
 CONFIG += c++17
 
@@ -30,6 +32,13 @@ linux-g++ {
 
     DEFINES += LINUX_OS
 
+    # allows the vectorization of the loops which call sqrt() or divide, e.g. the far-field panel kernels;
+    # the code does not use errno nor floating point exceptions
+    QMAKE_CXXFLAGS += -fno-math-errno -fno-trapping-math
+
+    # uncomment to use the host's full instruction set, e.g. AVX2 or AVX-512
+#    QMAKE_CXXFLAGS += -march=native
+
     isEmpty(PREFIX){
         PREFIX = /usr/local
     }
@@ -75,6 +84,26 @@ linux-g++ {
         LIBS += -llapack -llapacke
     }
 
+    #uncomment to factorize the dense panel matrices on a CUDA device, cf. PanelAnalysis::setGpuSolver()
+#    CONFIG += CUDA_SOLVER
+
+    CUDA_SOLVER {
+        #------------ CUDA / cuSOLVER --------------------
+        DEFINES += FL5_CUDA
+        INCLUDEPATH += /usr/local/cuda/include
+        LIBS += -L/usr/local/cuda/lib64 -lcudart -lcusolver
+    }
+
+    #uncomment to distribute the dense panel matrices over the ranks of an MPI job, cf. PanelAnalysis::setDistributedSolver()
+#    CONFIG += MPI_SOLVER
+
+    MPI_SOLVER {
+        #------------ MPI / ScaLAPACK --------------------
+        DEFINES += FL5_MPI
+        INCLUDEPATH += /usr/include/x86_64-linux-gnu/openmpi/include
+        LIBS += -lscalapack-openmpi -lmpi
+    }
+
 
     #----------- OPENCASCADE -------------
     #   Ensure that the paths to the binary libraries
@@ -89,7 +118,10 @@ linux-g++ {
     #----------- PYTHON / PYBIND11 (for NeuralFoil) -------------
     #   Python embedding for NeuralFoil on-the-fly calculations
     #   Requires Python 3.13 development headers and pybind11 (Ubuntu 25.10+)
+    #   Without NEURALFOIL_PYTHON and the Python lines below, NeuralFoil runs on the
+    #   native kernel only and requires the exported model files
         DEFINES += NEURALFOIL_ENABLED
+        DEFINES += NEURALFOIL_PYTHON
         INCLUDEPATH += /usr/include/python3.13
         INCLUDEPATH += $$PWD/../../venv/lib/python3.13/site-packages/pybind11/include
         LIBS += -lpython3.13
@@ -0,0 +1,1033 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+
+#include <delaunay2d.h>
+#include <constants.h>
+#include <pslg2d.h>
+#include <triangle2d.h>
+
+
+namespace
+{
+    /** The relative tolerances of the predicates; the points are in the unit box */
+    double const s_OrientEps = 1.e-12;
+    double const s_CircleEps = 1.e-11;
+    double const s_MergeDistance = 1.e-10;
+
+    Vector2d const s_SuperVertex[3] = {{-100.0, -100.0}, {100.0, -100.0}, {0.5, 100.0}};
+
+    /** @return 1 if c is on the left of a->b, -1 if on the right, 0 if aligned within the tolerance */
+    int orientation(Vector2d const &a, Vector2d const &b, Vector2d const &c)
+    {
+        double const abx=b.x-a.x, aby=b.y-a.y;
+        double const acx=c.x-a.x, acy=c.y-a.y;
+        double const det = abx*acy - aby*acx;
+        double const tol = s_OrientEps * (abx*abx+aby*aby + acx*acx+acy*acy);
+        if(det> tol) return  1;
+        if(det<-tol) return -1;
+        return 0;
+    }
+
+    /** @return the index of the point of the unit square along the Hilbert curve of order 16 */
+    uint64_t hilbertIndex(Vector2d const &pt)
+    {
+        uint32_t const n = 1u<<16;
+        uint32_t ix = uint32_t(std::min(std::max(pt.x, 0.0), 1.0)*double(n-1));
+        uint32_t iy = uint32_t(std::min(std::max(pt.y, 0.0), 1.0)*double(n-1));
+        uint64_t d = 0;
+        for(uint32_t s=n/2; s>0; s/=2)
+        {
+            uint32_t rx = (ix & s) ? 1 : 0;
+            uint32_t ry = (iy & s) ? 1 : 0;
+            d += uint64_t(s)*uint64_t(s)*uint64_t((3*rx)^ry);
+            if(ry==0)
+            {
+                if(rx==1)
+                {
+                    ix = n-1-ix;
+                    iy = n-1-iy;
+                }
+                std::swap(ix, iy);
+            }
+        }
+        return d;
+    }
+}
+
+
+Delaunay2d::Delaunay2d()
+{
+    m_MaxLength = 0.0;
+    m_MinAngle = 25.0;
+    m_MaxTriangles = 100000;
+    m_MinLength = 0.0;
+
+    m_Scale = 1.0;
+    m_Last = 0;
+    m_nInside = 0;
+    m_nSplitSegments = 0;
+}
+
+
+void Delaunay2d::clear()
+{
+    m_Pt.clear();
+    m_Mapped.clear();
+    m_bMapped.clear();
+    m_VtxTri.clear();
+    m_Tri.clear();
+    m_FreeTri.clear();
+    m_Seg.clear();
+    m_NewTri.clear();
+    m_Nodes.clear();
+    m_Triangles.clear();
+    m_Log.clear();
+    m_Last = 0;
+    m_nInside = 0;
+    m_nSplitSegments = 0;
+}
+
+
+/**
+ * Triangulates the domain on the left of the segments of the PSLGs.
+ * @param pslgs the contours and the holes of the domain; the segments of each PSLG are split during the refinement if the PSLG is splittable.
+ * @param bRefine if false, only the vertices of the PSLGs are triangulated.
+ * @return true if all the segments have been recovered.
+ */
+bool Delaunay2d::triangulate(std::vector<PSLG2d> const &pslgs, bool bRefine)
+{
+    clear();
+
+    std::vector<Vector2d> pts;
+    std::vector<char> flags;
+    for(PSLG2d const &pslg : pslgs)
+    {
+        for(Segment2d const &seg : pslg)
+        {
+            pts.push_back(seg.vertexAt(0));
+            pts.push_back(seg.vertexAt(1));
+            flags.push_back(seg.isSplittable() ? 2 : 1);
+        }
+    }
+    if(pts.size()<6)
+    {
+        m_Log = "   Delaunay2d: the PSLG has less than three segments\n";
+        return false;
+    }
+
+    double xmin=pts.front().x, xmax=xmin, ymin=pts.front().y, ymax=ymin;
+    for(Vector2d const &pt : pts)
+    {
+        xmin = std::min(xmin, pt.x);   xmax = std::max(xmax, pt.x);
+        ymin = std::min(ymin, pt.y);   ymax = std::max(ymax, pt.y);
+    }
+    m_Scale = std::max(xmax-xmin, ymax-ymin);
+    if(m_Scale<=0.0)
+    {
+        m_Log = "   Delaunay2d: the PSLG is degenerate\n";
+        return false;
+    }
+    m_Origin.set(xmin, ymin);
+    for(Vector2d &pt : pts) pt = (pt-m_Origin)/m_Scale;
+
+    makeSuperTriangle();
+
+    // the shortest edge which is refined for its angles, to stop the refinement near the small input angles
+    if(m_MaxLength>0.0) m_MinLength = 0.02*m_MaxLength;
+    else                m_MinLength = 1.e-3*m_Scale*sqrt(2.0);
+
+    std::vector<int> order;
+    insertionOrder(pts, order);
+    std::vector<int> vidx(pts.size(), -1);
+    for(int k : order)
+    {
+        vidx[k] = insertPoint(pts.at(k), m_Last);
+        if(vidx[k]<0)
+        {
+            m_Log += "   Delaunay2d: failed to insert a PSLG vertex\n";
+            return false;
+        }
+    }
+
+    bool bRecovered = true;
+    std::vector<Segment> pending;
+    for(int is=int(flags.size())-1; is>=0; is--)
+    {
+        if(vidx[2*is]!=vidx[2*is+1])
+            pending.push_back({vidx[2*is], vidx[2*is+1], flags[is]});
+    }
+    while(pending.size())
+    {
+        Segment seg = pending.back();
+        pending.pop_back();
+        if(!recoverSegment(seg, pending)) bRecovered = false;
+    }
+    if(!bRecovered) m_Log += "   Delaunay2d: some segments could not be recovered\n";
+
+    if(!markInside())
+    {
+        m_Log += "   Delaunay2d: the PSLG is not closed or not oriented with the domain on the left of the segments\n";
+        return false;
+    }
+
+    if(bRefine) refine();
+
+    makeOutput();
+    return bRecovered;
+}
+
+
+void Delaunay2d::makeSuperTriangle()
+{
+    for(int i=0; i<3; i++)
+    {
+        m_Pt.push_back(s_SuperVertex[i]);
+        m_Mapped.push_back({});
+        m_bMapped.push_back(false);
+        m_VtxTri.push_back(0);
+    }
+    int t = newTriangle();
+    Tri &tr = m_Tri[t];
+    tr.m_v[0] = 0;
+    tr.m_v[1] = 1;
+    tr.m_v[2] = 2;
+    m_Last = t;
+}
+
+
+/**
+ * Makes the biased randomized insertion order: the points are shuffled, split in rounds of doubling size,
+ * and each round is sorted along the Hilbert curve.
+ */
+void Delaunay2d::insertionOrder(std::vector<Vector2d> const &pts, std::vector<int> &order) const
+{
+    int const n = int(pts.size());
+    order.resize(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937 gen(5489u); // fixed seed, so that the meshes are reproducible
+    std::shuffle(order.begin(), order.end(), gen);
+
+    std::vector<uint64_t> key(n);
+    for(int i=0; i<n; i++) key[i] = hilbertIndex(pts.at(i));
+
+    int hi = n;
+    while(hi>0)
+    {
+        int lo = hi/2;
+        std::sort(order.begin()+lo, order.begin()+hi, [&key](int a, int b) {return key[a]<key[b];});
+        hi = lo;
+    }
+}
+
+
+int Delaunay2d::newTriangle()
+{
+    int t = -1;
+    if(m_FreeTri.size())
+    {
+        t = m_FreeTri.back();
+        m_FreeTri.pop_back();
+        m_Tri[t] = Tri();
+    }
+    else
+    {
+        t = int(m_Tri.size());
+        m_Tri.push_back(Tri());
+    }
+    m_Tri[t].m_bAlive = true;
+    return t;
+}
+
+
+/** Walks from the triangle tstart to the triangle which contains the point, with the visibility walk. */
+int Delaunay2d::locate(Vector2d const &pt, int tstart) const
+{
+    int t = tstart;
+    if(t<0 || t>=int(m_Tri.size()) || !m_Tri.at(t).m_bAlive)
+    {
+        t = -1;
+        for(int i=0; i<int(m_Tri.size()); i++)
+            if(m_Tri.at(i).m_bAlive) {t=i; break;}
+        if(t<0) return -1;
+    }
+
+    int const maxiter = int(m_Tri.size())+10;
+    int k = 0;
+    for(int iter=0; iter<maxiter; iter++)
+    {
+        Tri const &tr = m_Tri.at(t);
+        int next = -2;
+        for(int j=0; j<3; j++)
+        {
+            int i = (j+k)%3;
+            if(orientation(m_Pt[tr.m_v[(i+1)%3]], m_Pt[tr.m_v[(i+2)%3]], pt)<0)
+            {
+                next = tr.m_n[i];
+                break;
+            }
+        }
+        if(next==-2) return t;
+        if(next<0)   return -1; // outside the super-triangle
+        t = next;
+        k = (k+1)%3; // change the first edge tested, to break the cycles of the degenerate configurations
+    }
+
+    // not converged, should not happen
+    for(int it=0; it<int(m_Tri.size()); it++)
+    {
+        Tri const &tr = m_Tri.at(it);
+        if(!tr.m_bAlive) continue;
+        if(orientation(m_Pt[tr.m_v[0]], m_Pt[tr.m_v[1]], pt)>=0 &&
+           orientation(m_Pt[tr.m_v[1]], m_Pt[tr.m_v[2]], pt)>=0 &&
+           orientation(m_Pt[tr.m_v[2]], m_Pt[tr.m_v[0]], pt)>=0) return it;
+    }
+    return -1;
+}
+
+
+bool Delaunay2d::inCircle(int t, Vector2d const &p) const
+{
+    Tri const &tr = m_Tri.at(t);
+    Vector2d const &a = m_Pt[tr.m_v[0]];
+    Vector2d const &b = m_Pt[tr.m_v[1]];
+    Vector2d const &c = m_Pt[tr.m_v[2]];
+    double const adx=a.x-p.x, ady=a.y-p.y;
+    double const bdx=b.x-p.x, bdy=b.y-p.y;
+    double const cdx=c.x-p.x, cdy=c.y-p.y;
+    double const alift = adx*adx+ady*ady;
+    double const blift = bdx*bdx+bdy*bdy;
+    double const clift = cdx*cdx+cdy*cdy;
+    double const det = alift*(bdx*cdy-cdx*bdy) + blift*(cdx*ady-adx*cdy) + clift*(adx*bdy-bdx*ady);
+    double const scale = alift+blift+clift;
+    return det > s_CircleEps*scale*scale;
+}
+
+
+Vector2d Delaunay2d::circumCentre(int t) const
+{
+    Tri const &tr = m_Tri.at(t);
+    Vector2d const &a = m_Pt[tr.m_v[0]];
+    Vector2d const b = m_Pt[tr.m_v[1]]-a;
+    Vector2d const c = m_Pt[tr.m_v[2]]-a;
+    double const d = 2.0*(b.x*c.y-b.y*c.x);
+    if(fabs(d)<1.e-300) return (m_Pt[tr.m_v[0]]+m_Pt[tr.m_v[1]]+m_Pt[tr.m_v[2]])/3.0;
+    double const b2 = b.x*b.x+b.y*b.y;
+    double const c2 = c.x*c.x+c.y*c.y;
+    return {a.x + (c.y*b2-b.y*c2)/d, a.y + (b.x*c2-c.x*b2)/d};
+}
+
+
+/**
+ * Inserts the point with the Bowyer-Watson algorithm: the triangles whose circumcircle contains the point and which
+ * are visible from the point without crossing a segment are replaced by the fan of the cavity's edges about the point.
+ * @param tstart the triangle from which the point is located
+ * @param tsplit, isplit if tsplit>=0, the point is the midpoint of the segment isplit of the triangle tsplit, which is split
+ * @return the index of the point, the index of the existing point if the point is coincident, or -1 if it could not be inserted
+ */
+int Delaunay2d::insertPoint(Vector2d const &pt, int tstart, int tsplit, int isplit)
+{
+    m_NewTri.clear();
+
+    int t = tsplit>=0 ? tsplit : locate(pt, tstart);
+    if(t<0) return -1;
+
+    for(int iv=0; iv<3; iv++)
+    {
+        int v = m_Tri.at(t).m_v[iv];
+        if((m_Pt.at(v)-pt).norm()<s_MergeDistance) return v;
+    }
+
+    int sa=-1, sb=-1;
+    char sc=0;
+    if(tsplit>=0)
+    {
+        Tri const &tr = m_Tri.at(tsplit);
+        sa = tr.m_v[(isplit+1)%3];
+        sb = tr.m_v[(isplit+2)%3];
+        sc = tr.m_c[isplit];
+    }
+    auto isSplitEdge = [sa,sb](int a, int b) {return sa>=0 && ((a==sa && b==sb) || (a==sb && b==sa));};
+
+    std::vector<int> cavity = {t};
+    auto inCavity = [&cavity](int it) {return std::find(cavity.begin(), cavity.end(), it)!=cavity.end();};
+
+    for(uint k=0; k<cavity.size(); k++)
+    {
+        Tri const &tr = m_Tri.at(cavity.at(k));
+        for(int i=0; i<3; i++)
+        {
+            int nb = tr.m_n[i];
+            if(nb<0 || inCavity(nb)) continue;
+            bool bSplit = isSplitEdge(tr.m_v[(i+1)%3], tr.m_v[(i+2)%3]);
+            if(tr.m_c[i] && !bSplit) continue;
+            if(bSplit || inCircle(nb, pt)) cavity.push_back(nb);
+        }
+    }
+
+    struct BoundaryEdge
+    {
+        int m_a, m_b, m_nb;
+        char m_c;
+        bool m_bInside;
+    };
+    std::vector<BoundaryEdge> boundary;
+
+    // the cavity must be star-shaped from the point; with the rounding errors, add the triangles of the degenerate edges
+    for(int pass=0; pass<8; pass++)
+    {
+        boundary.clear();
+        int nAdded = 0;
+        for(uint k=0; k<cavity.size(); k++)
+        {
+            Tri const &tr = m_Tri.at(cavity.at(k));
+            for(int i=0; i<3; i++)
+            {
+                int nb = tr.m_n[i];
+                if(nb>=0 && inCavity(nb)) continue;
+                int a = tr.m_v[(i+1)%3];
+                int b = tr.m_v[(i+2)%3];
+                if(orientation(m_Pt[a], m_Pt[b], pt)<=0)
+                {
+                    if(nb<0 || tr.m_c[i]) return -1; // the point is on a segment or outside the super-triangle
+                    cavity.push_back(nb);
+                    nAdded++;
+                    break;
+                }
+                boundary.push_back({a, b, nb, tr.m_c[i], tr.m_bInside});
+            }
+        }
+        if(nAdded==0) break;
+        if(pass==7) return -1;
+    }
+
+    int ip = int(m_Pt.size());
+    m_Pt.push_back(pt);
+    m_Mapped.push_back({});
+    m_bMapped.push_back(false);
+    m_VtxTri.push_back(-1);
+
+    for(int it : cavity)
+    {
+        if(m_Tri.at(it).m_bInside) m_nInside--;
+        m_Tri[it].m_bAlive = false;
+        m_FreeTri.push_back(it);
+    }
+
+    for(BoundaryEdge const &be : boundary)
+    {
+        int nt = newTriangle();
+        Tri &tr = m_Tri[nt];
+        tr.m_v[0] = ip;
+        tr.m_v[1] = be.m_a;
+        tr.m_v[2] = be.m_b;
+        tr.m_n[0] = be.m_nb;
+        tr.m_c[0] = be.m_c;
+        tr.m_c[1] = (be.m_b==sa || be.m_b==sb) ? sc : 0;
+        tr.m_c[2] = (be.m_a==sa || be.m_a==sb) ? sc : 0;
+        tr.m_bInside = be.m_bInside;
+        if(tr.m_bInside) m_nInside++;
+
+        if(be.m_nb>=0)
+        {
+            Tri &nb = m_Tri[be.m_nb];
+            for(int j=0; j<3; j++)
+            {
+                if(nb.m_v[(j+1)%3]==be.m_b && nb.m_v[(j+2)%3]==be.m_a) nb.m_n[j] = nt;
+            }
+        }
+        m_VtxTri[be.m_a] = nt;
+        m_VtxTri[be.m_b] = nt;
+        m_NewTri.push_back(nt);
+    }
+    m_VtxTri[ip] = m_NewTri.front();
+
+    // link the fan
+    for(int nt : m_NewTri)
+    {
+        Tri &tr = m_Tri[nt];
+        for(int ot : m_NewTri)
+        {
+            if(ot==nt) continue;
+            Tri const &other = m_Tri.at(ot);
+            if(other.m_v[1]==tr.m_v[2]) tr.m_n[1] = ot; // edge b-ip
+            if(other.m_v[2]==tr.m_v[1]) tr.m_n[2] = ot; // edge ip-a
+        }
+    }
+
+    if(tsplit>=0) m_nSplitSegments++;
+    m_Last = m_NewTri.front();
+    return ip;
+}
+
+
+/** Flips the edge i of the triangle t, which must be free and the diagonal of a convex quadrilateral */
+void Delaunay2d::flip(int t, int i)
+{
+    Tri const T1 = m_Tri.at(t);
+    int t2 = T1.m_n[i];
+    Tri const T2 = m_Tri.at(t2);
+
+    int j = 0;
+    for(j=0; j<3; j++) if(T2.m_n[j]==t) break;
+
+    int p = T1.m_v[i];
+    int u = T1.m_v[(i+1)%3];
+    int v = T1.m_v[(i+2)%3];
+    int q = T2.m_v[j];
+
+    int A = T1.m_n[(i+1)%3];  char cA = T1.m_c[(i+1)%3];  // edge v-p
+    int B = T1.m_n[(i+2)%3];  char cB = T1.m_c[(i+2)%3];  // edge p-u
+    int C = T2.m_n[(j+1)%3];  char cC = T2.m_c[(j+1)%3];  // edge u-q
+    int D = T2.m_n[(j+2)%3];  char cD = T2.m_c[(j+2)%3];  // edge q-v
+
+    Tri &N1 = m_Tri[t];
+    N1.m_v[0] = p;   N1.m_v[1] = u;   N1.m_v[2] = q;
+    N1.m_n[0] = C;   N1.m_n[1] = t2;  N1.m_n[2] = B;
+    N1.m_c[0] = cC;  N1.m_c[1] = 0;   N1.m_c[2] = cB;
+    N1.m_bAccepted = false;
+
+    Tri &N2 = m_Tri[t2];
+    N2.m_v[0] = q;   N2.m_v[1] = v;   N2.m_v[2] = p;
+    N2.m_n[0] = A;   N2.m_n[1] = t;   N2.m_n[2] = D;
+    N2.m_c[0] = cA;  N2.m_c[1] = 0;   N2.m_c[2] = cD;
+    N2.m_bAccepted = false;
+
+    if(A>=0) for(int k=0; k<3; k++) if(m_Tri[A].m_n[k]==t)  m_Tri[A].m_n[k] = t2;
+    if(C>=0) for(int k=0; k<3; k++) if(m_Tri[C].m_n[k]==t2) m_Tri[C].m_n[k] = t;
+
+    m_VtxTri[p] = t;
+    m_VtxTri[u] = t;
+    m_VtxTri[q] = t;
+    m_VtxTri[v] = t2;
+}
+
+
+/** @return the triangle which has the oriented edge a->b, and in iedge the index of the edge, or -1 if the edge does not exist */
+int Delaunay2d::edgeTriangle(int a, int b, int &iedge) const
+{
+    int t0 = m_VtxTri.at(a);
+    int t = t0;
+    for(int iter=0; iter<10000 && t>=0; iter++)
+    {
+        Tri const &tr = m_Tri.at(t);
+        int k = 0;
+        for(k=0; k<3; k++) if(tr.m_v[k]==a) break;
+        if(k==3) return -1;
+        if(tr.m_v[(k+1)%3]==b)
+        {
+            iedge = (k+2)%3;
+            return t;
+        }
+        t = tr.m_n[(k+1)%3]; // rotate counter-clockwise about a
+        if(t==t0) break;
+    }
+    return -1;
+}
+
+
+void Delaunay2d::setSegmentFlag(int t, int i, char c)
+{
+    m_Tri[t].m_c[i] = c;
+    int nb = m_Tri.at(t).m_n[i];
+    if(nb<0) return;
+    for(int j=0; j<3; j++) if(m_Tri.at(nb).m_n[j]==t) m_Tri[nb].m_c[j] = c;
+}
+
+
+/**
+ * Recovers the segment by flipping the edges which it crosses, then restores the Delaunay property of the new edges.
+ * If the segment passes through a vertex, the remaining part is appended to the pending segments.
+ */
+bool Delaunay2d::recoverSegment(Segment const &seg, std::vector<Segment> &pending)
+{
+    int const a = seg.m_a;
+    int b = seg.m_b;
+    int ie = -1;
+
+    int t = edgeTriangle(a, b, ie);
+    if(t>=0)
+    {
+        setSegmentFlag(t, ie, seg.m_c);
+        m_Seg.push_back(seg);
+        return true;
+    }
+
+    Vector2d const &A = m_Pt.at(a);
+
+    // find the first crossed edge about a
+    std::vector<std::pair<int,int>> crossed; // the crossed edges, left vertex first
+    int t0 = m_VtxTri.at(a);
+    t = t0;
+    int tcross=-1;
+    for(int iter=0; iter<10000 && t>=0; iter++)
+    {
+        Tri const &tr = m_Tri.at(t);
+        int k = 0;
+        for(k=0; k<3; k++) if(tr.m_v[k]==a) break;
+        int v1 = tr.m_v[(k+1)%3];
+        int v2 = tr.m_v[(k+2)%3];
+        Vector2d const &B = m_Pt.at(b);
+        int o1 = orientation(A, m_Pt[v1], B);
+        int o2 = orientation(A, m_Pt[v2], B);
+        if(o1==0 && (m_Pt[v1]-A).dot(B-A)>0.0)
+        {
+            pending.push_back({v1, b, seg.m_c});
+            return recoverSegment({a, v1, seg.m_c}, pending);
+        }
+        if(o2==0 && (m_Pt[v2]-A).dot(B-A)>0.0)
+        {
+            pending.push_back({v2, b, seg.m_c});
+            return recoverSegment({a, v2, seg.m_c}, pending);
+        }
+        if(o1>0 && o2<0)
+        {
+            tcross = t;
+            crossed.push_back({v2, v1});
+            break;
+        }
+        t = tr.m_n[(k+1)%3];
+        if(t==t0) break;
+    }
+    if(tcross<0) return false;
+
+    // walk along the segment to list the crossed edges
+    t = tcross;
+    for(int iter=0; iter<100000; iter++)
+    {
+        int L = crossed.back().first;
+        int R = crossed.back().second;
+        Tri const &tr = m_Tri.at(t);
+        int i = 0;
+        for(i=0; i<3; i++)
+            if((tr.m_v[(i+1)%3]==R && tr.m_v[(i+2)%3]==L) || (tr.m_v[(i+1)%3]==L && tr.m_v[(i+2)%3]==R)) break;
+        if(i==3) return false;
+        if(tr.m_c[i])
+        {
+            m_Log += "   Delaunay2d: intersecting segments\n";
+            return false;
+        }
+        int t2 = tr.m_n[i];
+        if(t2<0) return false;
+        Tri const &tr2 = m_Tri.at(t2);
+        int w = -1;
+        for(int k=0; k<3; k++) if(tr2.m_v[k]!=L && tr2.m_v[k]!=R) w = tr2.m_v[k];
+        if(w==b) break;
+        int ow = orientation(A, m_Pt.at(b), m_Pt.at(w));
+        if(ow==0)
+        {
+            // the segment passes through w
+            pending.push_back({w, b, seg.m_c});
+            b = w;
+            break;
+        }
+        if(ow>0) crossed.push_back({w, R});
+        else     crossed.push_back({L, w});
+        t = t2;
+    }
+
+    Vector2d const B = m_Pt.at(b);
+    auto crossesSegment = [this, &A, &B, a, b](int p, int q)
+    {
+        if(p==a || p==b || q==a || q==b) return false;
+        return orientation(A, B, m_Pt[p])*orientation(A, B, m_Pt[q])<0 &&
+               orientation(m_Pt[p], m_Pt[q], A)*orientation(m_Pt[p], m_Pt[q], B)<0;
+    };
+
+    std::vector<std::pair<int,int>> queue(crossed.begin(), crossed.end());
+    std::vector<std::pair<int,int>> newedges;
+    size_t head = 0;
+    size_t const maxflips = 100*(crossed.size()+1)*(crossed.size()+1);
+    size_t nflips = 0;
+    while(head<queue.size())
+    {
+        if(nflips++>maxflips) return false;
+        std::pair<int,int> e = queue[head++];
+        int te = edgeTriangle(e.first, e.second, ie);
+        if(te<0) te = edgeTriangle(e.second, e.first, ie);
+        if(te<0) continue;
+        Tri const &tr = m_Tri.at(te);
+        int t2 = tr.m_n[ie];
+        if(t2<0) continue;
+        int p = tr.m_v[ie];
+        int u = tr.m_v[(ie+1)%3];
+        int v = tr.m_v[(ie+2)%3];
+        int q = -1;
+        for(int k=0; k<3; k++) if(m_Tri.at(t2).m_v[k]!=u && m_Tri.at(t2).m_v[k]!=v) q = m_Tri.at(t2).m_v[k];
+
+        if(orientation(m_Pt[p], m_Pt[u], m_Pt[q])<=0 || orientation(m_Pt[q], m_Pt[v], m_Pt[p])<=0)
+        {
+            // not convex, try again once the other edges have been flipped
+            queue.push_back(e);
+            continue;
+        }
+        flip(te, ie);
+        if(crossesSegment(p, q)) queue.push_back({p, q});
+        else                     newedges.push_back({p, q});
+    }
+
+    t = edgeTriangle(a, b, ie);
+    if(t<0) return false;
+    setSegmentFlag(t, ie, seg.m_c);
+    m_Seg.push_back({a, b, seg.m_c});
+
+    // restore the Delaunay property of the new edges
+    for(int pass=0; pass<100; pass++)
+    {
+        bool bFlipped = false;
+        for(std::pair<int,int> &e : newedges)
+        {
+            int te = edgeTriangle(e.first, e.second, ie);
+            if(te<0) continue;
+            Tri const &tr = m_Tri.at(te);
+            int t2 = tr.m_n[ie];
+            if(tr.m_c[ie] || t2<0) continue;
+            int u = tr.m_v[(ie+1)%3];
+            int v = tr.m_v[(ie+2)%3];
+            int q = -1;
+            for(int k=0; k<3; k++) if(m_Tri.at(t2).m_v[k]!=u && m_Tri.at(t2).m_v[k]!=v) q = m_Tri.at(t2).m_v[k];
+            if(!inCircle(te, m_Pt[q])) continue;
+            int p = tr.m_v[ie];
+            if(orientation(m_Pt[p], m_Pt[u], m_Pt[q])<=0 || orientation(m_Pt[q], m_Pt[v], m_Pt[p])<=0) continue;
+            flip(te, ie);
+            e = {p, q};
+            bFlipped = true;
+        }
+        if(!bFlipped) break;
+    }
+    return true;
+}
+
+
+/**
+ * Marks the triangles inside the domain with a flood fill from the left side of the recovered segments.
+ * @return false if the domain reaches the super-triangle, i.e. if the contour is open or reversed.
+ */
+bool Delaunay2d::markInside()
+{
+    for(Tri &tr : m_Tri) tr.m_bInside = false;
+    m_nInside = 0;
+
+    std::vector<int> stack;
+    for(Segment const &seg : m_Seg)
+    {
+        int ie = -1;
+        int t = edgeTriangle(seg.m_a, seg.m_b, ie);
+        if(t>=0 && !m_Tri.at(t).m_bInside)
+        {
+            m_Tri[t].m_bInside = true;
+            stack.push_back(t);
+        }
+    }
+
+    bool bClosed = true;
+    while(stack.size())
+    {
+        int t = stack.back();
+        stack.pop_back();
+        m_nInside++;
+        Tri const &tr = m_Tri.at(t);
+        for(int i=0; i<3; i++)
+        {
+            if(tr.m_v[i]<3) bClosed = false;
+            int nb = tr.m_n[i];
+            if(tr.m_c[i] || nb<0 || m_Tri.at(nb).m_bInside) continue;
+            m_Tri[nb].m_bInside = true;
+            stack.push_back(nb);
+        }
+    }
+    return bClosed && m_nInside>0;
+}
+
+
+Vector3d const &Delaunay2d::mapped(int iv) const
+{
+    if(!m_bMapped.at(iv))
+    {
+        Vector2d pt = m_Origin + m_Pt.at(iv)*m_Scale;
+        m_Mapped[iv] = m_Mapping(pt.x, pt.y);
+        m_bMapped[iv] = true;
+    }
+    return m_Mapped.at(iv);
+}
+
+
+/**
+ * @return true if the triangle is larger than the size target, measured on the mapped triangle if there is a mapping,
+ * or if it has an angle less than the min. angle, measured in the plane.
+ */
+bool Delaunay2d::isBad(int t) const
+{
+    Tri const &tr = m_Tri.at(t);
+    double l[3]{0,0,0};
+    double lmax = 0.0;
+    double lmin = 1.e100;
+    for(int i=0; i<3; i++)
+    {
+        int a = tr.m_v[(i+1)%3];
+        int b = tr.m_v[(i+2)%3];
+        l[i] = (m_Pt[b]-m_Pt[a]).norm()*m_Scale;
+        double lm = m_Mapping ? mapped(a).distanceTo(mapped(b)) : l[i];
+        // the fixed segments cannot be split, hence are ignored for the size target
+        if(tr.m_c[i]!=1) lmax = std::max(lmax, lm);
+        lmin = std::min(lmin, lm);
+    }
+    if(m_MaxLength>0.0 && lmax>m_MaxLength) return true;
+
+    int imin = 0;
+    for(int i=1; i<3; i++) if(l[i]<l[imin]) imin = i;
+    if(m_MinAngle<=0.0 || lmin<m_MinLength) return false;
+    double la = l[(imin+1)%3];
+    double lb = l[(imin+2)%3];
+    if(la*lb<=0.0) return false;
+    double cosa = (la*la + lb*lb - l[imin]*l[imin])/(2.0*la*lb);
+    return acos(std::min(std::max(cosa, -1.0), 1.0)) < m_MinAngle*PI/180.0;
+}
+
+
+/**
+ * Walks from the triangle t to the triangle which contains the point along the straight line from the triangle's centroid.
+ * @param iblocked the index of the segment which stops the walk, or -1
+ * @return the triangle which contains the point, or which holds the segment iblocked, or -1 if the walk failed
+ */
+int Delaunay2d::walkTo(int t, Vector2d const &pt, int &iblocked) const
+{
+    iblocked = -1;
+    Tri const &tr0 = m_Tri.at(t);
+    Vector2d g = (m_Pt[tr0.m_v[0]]+m_Pt[tr0.m_v[1]]+m_Pt[tr0.m_v[2]])/3.0;
+
+    int cur = t;
+    int prev = -1;
+    for(int iter=0; iter<int(m_Tri.size()); iter++)
+    {
+        Tri const &tr = m_Tri.at(cur);
+        int iexit = -1;
+        bool bInside = true;
+        for(int i=0; i<3; i++)
+        {
+            Vector2d const &A = m_Pt[tr.m_v[(i+1)%3]];
+            Vector2d const &B = m_Pt[tr.m_v[(i+2)%3]];
+            if(orientation(A, B, pt)>=0) continue;
+            bInside = false;
+            if(prev>=0 && tr.m_n[i]==prev) continue;
+            if(orientation(g, pt, A)*orientation(g, pt, B)<=0)
+            {
+                iexit = i;
+                break;
+            }
+        }
+        if(bInside) return cur;
+        if(iexit<0) return -1;
+        if(tr.m_c[iexit])
+        {
+            iblocked = iexit;
+            return cur;
+        }
+        if(tr.m_n[iexit]<0) return -1;
+        prev = cur;
+        cur = tr.m_n[iexit];
+    }
+    return -1;
+}
+
+
+/**
+ * Finds a segment of the triangle or of its neighbours whose diametral circle contains the point.
+ * @return the triangle which holds the segment, on the side of the point, and in iedge the index of the segment, or -1
+ */
+int Delaunay2d::encroachedSegment(int t, Vector2d const &pt, int &iedge) const
+{
+    int const candidates[4] = {t, m_Tri.at(t).m_n[0], m_Tri.at(t).m_n[1], m_Tri.at(t).m_n[2]};
+    for(int tc : candidates)
+    {
+        if(tc<0) continue;
+        Tri const &tr = m_Tri.at(tc);
+        if(!tr.m_bInside) continue;
+        for(int i=0; i<3; i++)
+        {
+            if(!tr.m_c[i]) continue;
+            Vector2d const &A = m_Pt[tr.m_v[(i+1)%3]];
+            Vector2d const &B = m_Pt[tr.m_v[(i+2)%3]];
+            if((A-pt).dot(B-pt)<0.0)
+            {
+                iedge = i;
+                return tc;
+            }
+        }
+    }
+    iedge = -1;
+    return -1;
+}
+
+
+/**
+ * Inserts the circumcentre or the off-centre of the triangle, or splits the segment which the circumcentre encroaches.
+ * @return true if a point has been inserted
+ */
+bool Delaunay2d::refineTriangle(int t)
+{
+    Vector2d cc = circumCentre(t);
+
+    // use the off-centre if it is closer to the shortest edge than the circumcentre,
+    // i.e. the apex of the isosceles triangle built on the shortest edge with the min. angle at the apex
+    if(m_MinAngle>0.0)
+    {
+        Tri const &tr = m_Tri.at(t);
+        int imin = 0;
+        double lmin = 1.e100;
+        for(int i=0; i<3; i++)
+        {
+            double l = (m_Pt[tr.m_v[(i+2)%3]]-m_Pt[tr.m_v[(i+1)%3]]).norm();
+            if(l<lmin) {lmin=l; imin=i;}
+        }
+        Vector2d M = (m_Pt[tr.m_v[(imin+1)%3]]+m_Pt[tr.m_v[(imin+2)%3]])/2.0;
+        double dc = (cc-M).norm();
+        double h = lmin/2.0/tan(m_MinAngle*PI/180.0/2.0);
+        if(dc>h && dc>0.0) cc = M + (cc-M)*(h/dc);
+    }
+
+    int iblocked = -1;
+    int tc = walkTo(t, cc, iblocked);
+    if(tc<0)
+    {
+        m_Tri[t].m_bAccepted = true;
+        return false;
+    }
+
+    // a segment encroached by the circumcentre is split instead
+    bool const bInside = iblocked<0;
+    int const tcc = tc;
+    if(iblocked<0)
+    {
+        int te = encroachedSegment(tc, cc, iblocked);
+        if(te>=0) tc = te;
+    }
+
+    int np = int(m_Pt.size());
+    int ip = -1;
+    if(iblocked>=0)
+    {
+        Tri const &tr = m_Tri.at(tc);
+        Vector2d const &A = m_Pt[tr.m_v[(iblocked+1)%3]];
+        Vector2d const &B = m_Pt[tr.m_v[(iblocked+2)%3]];
+        if(tr.m_c[iblocked]==2)
+        {
+            if((B-A).norm()*m_Scale<2.0*m_MinLength)
+            {
+                m_Tri[t].m_bAccepted = true;
+                return false;
+            }
+            ip = insertPoint((A+B)/2.0, tc, tc, iblocked);
+        }
+        else
+        {
+            // a fixed segment: insert the apex of the equilateral triangle built on the segment, if it encroaches nothing,
+            // else the circumcentre if it is inside the domain and far enough from the segment to make no sliver with it
+            Vector2d AB = B-A;
+            Vector2d apex = (A+B)/2.0 + Vector2d(-AB.y, AB.x)*(sqrt(3.0)/2.0); // the triangle tc is on the left of A->B
+            int iapex=-1, iedge=-1;
+            int ta = walkTo(tc, apex, iapex);
+            if(ta>=0 && iapex<0 && encroachedSegment(ta, apex, iedge)<0) ip = insertPoint(apex, ta);
+            double const dist = fabs(AB.x*(cc.y-A.y)-AB.y*(cc.x-A.x))/AB.norm();
+            if(ip<np && bInside && dist>0.5*AB.norm()*tan(m_MinAngle*PI/180.0)) ip = insertPoint(cc, tcc);
+        }
+    }
+    else
+        ip = insertPoint(cc, tc);
+
+    if(ip<np)
+    {
+        if(m_Tri.at(t).m_bAlive) m_Tri[t].m_bAccepted = true;
+        return false;
+    }
+    return true;
+}
+
+
+/** Refines the inside triangles until they satisfy the size and angle targets, or until the max. number of triangles */
+void Delaunay2d::refine()
+{
+    std::vector<int> stack;
+    for(int t=0; t<int(m_Tri.size()); t++)
+        if(m_Tri.at(t).m_bAlive && m_Tri.at(t).m_bInside) stack.push_back(t);
+
+    while(stack.size())
+    {
+        if(m_MaxTriangles>0 && m_nInside>=m_MaxTriangles)
+        {
+            m_Log += "   Delaunay2d: the refinement has been stopped at the max. number of triangles\n";
+            break;
+        }
+        int t = stack.back();
+        stack.pop_back();
+        Tri const &tr = m_Tri.at(t);
+        if(!tr.m_bAlive || !tr.m_bInside || tr.m_bAccepted) continue;
+        if(!isBad(t)) continue;
+
+        if(refineTriangle(t))
+        {
+            if(m_Tri.at(t).m_bAlive) stack.push_back(t);
+            stack.insert(stack.end(), m_NewTri.begin(), m_NewTri.end());
+        }
+    }
+}
+
+
+void Delaunay2d::makeOutput()
+{
+    m_Nodes.clear();
+    m_Triangles.clear();
+    std::vector<int> nodeindex(m_Pt.size(), -1);
+    for(Tri const &tr : m_Tri)
+    {
+        if(!tr.m_bAlive || !tr.m_bInside) continue;
+        std::array<int,3> tri;
+        for(int i=0; i<3; i++)
+        {
+            int v = tr.m_v[i];
+            if(nodeindex[v]<0)
+            {
+                nodeindex[v] = int(m_Nodes.size());
+                m_Nodes.push_back(m_Origin + m_Pt[v]*m_Scale);
+            }
+            tri[i] = nodeindex[v];
+        }
+        m_Triangles.push_back(tri);
+    }
+}
+
+
+void Delaunay2d::makeTriangles(std::vector<Triangle2d> &triangles) const
+{
+    triangles.clear();
+    triangles.reserve(m_Triangles.size());
+    for(std::array<int,3> const &tri : m_Triangles)
+        triangles.push_back(Triangle2d(m_Nodes.at(tri[0]), m_Nodes.at(tri[1]), m_Nodes.at(tri[2])));
+}
@@ -31,6 +31,7 @@
 #include <geom_global.h>
 #include <mathelem.h>
 #include <matrix.h>
+#include <qrleastsquares.h>
 
 BSpline::BSpline() : Spline()
 {
@@ -46,9 +47,9 @@ void BSpline::makeCurve()
     if (m_CtrlPt.size()>=2)
     {
         double t = 0;
-        double u = 0;
         double increment = 1.0/double(outputSize() - 1);
 
+        std::vector<double> u(m_Output.size(), 0.0);
         for (int j=0; j<int(m_Output.size()); j++)
         {
 //            double u = bunchedParameter(m_BunchDistrib, m_BunchAmp, t);
@@ -56,19 +57,18 @@ void BSpline::makeCurve()
             {
                 case Spline::NOBUNCH:
                 case Spline::UNIFORM:
-                    u = t;
+                    u[j] = t;
                     break;
                 case Spline::SIGMOID:
-                    u = sigmoid(-m_BunchAmp, t);
+                    u[j] = sigmoid(-m_BunchAmp, t);
                     break;
                 case Spline::DOUBLESIG:
-                    u = doubleSigmoid(-m_BunchAmp, t);
+                    u[j] = doubleSigmoid(-m_BunchAmp, t);
                     break;
             }
-
-            m_Output[j] = splinePoint(u);
             t += increment;
         }
+        splinePoints(u.data(), int(u.size()), m_Output.data());
         m_Output.back() = m_CtrlPt.back();
     }
     else
@@ -79,7 +79,78 @@ void BSpline::makeCurve()
 }
 
 
+/**
+ * Returns true if the knot vector is the clamped vector of size n+degree+1 made by splineKnots(),
+ * in which case the basis functions may be evaluated on the knot spans only.
+ */
+bool BSpline::hasClampedKnots() const
+{
+    int nCtrl = ctrlPointCount();
+    if(m_degree<0 || m_degree>geom::MAXSPANDEGREE || m_degree>=nCtrl) return false;
+    if(int(m_knot.size())!=nCtrl+m_degree+1) return false;
+    if(int(m_Weight.size())!=nCtrl) return false;
+    return true;
+}
+
+
 Vector2d BSpline::splinePoint(double t) const
+{
+    Vector2d pt;
+    splinePoints(&t, 1, &pt);
+    return pt;
+}
+
+
+/**
+ * Evaluates the spline at the n parameters u.
+ * Only the degree+1 basis functions which are non-zero in the parameter's knot span are computed.
+ * The span is searched from the previous one, so that increasing parameters are located in
+ * constant time on average.
+ */
+void BSpline::splinePoints(double const *u, int n, Vector2d *pt) const
+{
+    if(!hasClampedKnots())
+    {
+        for(int i=0; i<n; i++) pt[i] = splinePoint_ref(u[i]);
+        return;
+    }
+
+    int nCtrl = ctrlPointCount();
+    double N[geom::MAXSPANDEGREE+1];
+    int s = -1;
+    for(int i=0; i<n; i++)
+    {
+        double t = std::min(u[i], 0.99999);
+        s = geom::knotSpan(m_knot, nCtrl, m_degree, t, s);
+        if(s<0)
+        {
+            pt[i] = splinePoint_ref(u[i]);
+            continue;
+        }
+
+        geom::spanBasis(m_knot.data(), s, m_degree, t, N);
+
+        double x(0), y(0), w(0);
+        for(int a=0; a<=m_degree; a++)
+        {
+            int k = s-m_degree+a;
+            double b = N[a] * m_Weight[k];
+            x += m_CtrlPt[k].x * b;
+            y += m_CtrlPt[k].y * b;
+            w += b;
+        }
+        if(w>0)
+        {
+            x *= 1.0/w;
+            y *= 1.0/w;
+        }
+        pt[i].set(x,y);
+    }
+}
+
+
+/** The recursive evaluation over all the control points, used if the knots are not clamped */
+Vector2d BSpline::splinePoint_ref(double t) const
 {
     double x(0), y(0);
     double w(0);
@@ -103,6 +174,29 @@ Vector2d BSpline::splinePoint(double t) const
 
 /** returns the vector (dC.x/dt, dC.y/dt) */
 void BSpline::splineDerivative(double t, double &dx, double &dy) const
+{
+    t=std::min(t, 0.99999);
+    int s = hasClampedKnots() ? geom::knotSpan(m_knot, ctrlPointCount(), m_degree, t) : -1;
+    if(s<0)
+    {
+        splineDerivative_ref(t, dx, dy);
+        return;
+    }
+
+    double dN[geom::MAXSPANDEGREE+1];
+    geom::spanBasisDerivative(m_knot.data(), s, m_degree, t, dN);
+    dx=0.0;
+    dy=0.0;
+    for(int a=0; a<=m_degree; a++)
+    {
+        int k = s-m_degree+a;
+        dx += m_CtrlPt[k].x * dN[a];
+        dy += m_CtrlPt[k].y * dN[a];
+    }
+}
+
+
+void BSpline::splineDerivative_ref(double t, double &dx, double &dy) const
 {
     double np(0);
     dx=0.0;
@@ -315,54 +409,49 @@ bool BSpline::approximate(int degree, int nPts, std::vector<Node2d> const& node)
     m_CtrlPt.back().set(node.back());
     splineKnots();
 
-    // the resulting curves passes through the first and last input points
-    // build the intermediate points
-    std::vector<double> Nij((h-1)*(n-1), 0);
-    std::vector<double> tNij((h-1)*(n-1), 0);
-    std::vector<double> tk(n+1, 0);
-    int nCols = h-1;
-    int nRows = n-1;
+    // the resulting curve passes through the first and last input points
+    // build the intermediate points as the least square solution of N.P = Q
+    // each row of N holds at most p+1 consecutive non-zero basis values, so only the band is assembled
+    int const nCols = h-1;
+    BandedLeastSquares lsq(nCols, p+1, 2);
 
-    for(int k=0; k<=n; k++) tk[k] = double(k)/double(n); // n+1 values
-
-    for(int i=1; i<n; i++)
+    std::vector<double> N(p+1), coefs(p+1);
+    double rhs[2];
+    int s = -1;
+    for(int k=1; k<n; k++)
     {
-        int r=i-1; // row index
-        for(int j=1; j<h; j++)
+        double tk = double(k)/double(n);
+
+        if(p<=geom::MAXSPANDEGREE) s = geom::knotSpan(m_knot, h+1, p, tk, s);
+        else                       s = -1;
+        if(s>=0) geom::spanBasis(m_knot.data(), s, p, tk, N.data());
+        else
         {
-            int c=j-1; // col index
-            double b = geom::basis(j, p, tk[i], m_knot.data());
-            Nij[r*nCols+c]  = b;
-            tNij[c*nRows+r] = b;
+            s = p;
+            while(s<h && m_knot[s+1]<=tk) s++;
+            for(int a=0; a<=p; a++) N[a] = geom::basis(s-p+a, p, tk, m_knot.data());
         }
-    }
-
-    std::vector<double> NtN(nRows*nRows);
-    matrix::matMult(tNij.data(), Nij.data(), NtN.data(), nCols, nRows, nCols, 1);
 
-
-    //make the RHS
-    std::vector<double> Q(2*(h-1));
-    for(int i=1; i<h; i++)
-    {
-        int r = i-1;
-        Q[r]      = 0.0;
-        Q[(h-1)+r]= 0.0;
-        for(int k=1; k<n; k++)
+        // basis functions 0 and h multiply the fixed end points and are moved to the RHS
+        double b0(0), bh(0);
+        for(int a=0; a<=p; a++)
         {
-            double b = geom::basis(i, p, tk[k], m_knot.data());
-            double Qkx = node.at(k).x - geom::basis(0, p, tk[k], m_knot.data()) * node.front().x - geom::basis(h, p, tk[k], m_knot.data()) * node.back().x;
-            double Qky = node.at(k).y - geom::basis(0, p, tk[k], m_knot.data()) * node.front().y - geom::basis(h, p, tk[k], m_knot.data()) * node.back().y;
-            Q[r]       += b*Qkx;
-            Q[(h-1)+r] += b*Qky;
+            int j = s-p+a;
+            coefs[a] = N[a];
+            if(j==0) {b0 = N[a]; coefs[a] = 0.0;}
+            if(j==h) {bh = N[a]; coefs[a] = 0.0;}
         }
-    }
+        rhs[0] = node.at(k).x - b0*node.front().x - bh*node.back().x;
+        rhs[1] = node.at(k).y - b0*node.front().y - bh*node.back().y;
 
-//solveLinearSystem(int rank, double *M, int nrhs, double *rhs, int nThreads)
-assert(Q.size()>=2);
-    int res = matrix::solveLinearSystem(h-1, NtN.data(), 2, Q.data());
+        // column index of the first basis function is j-1
+        int firstcol = s-p-1;
+        if(firstcol<0) lsq.addRow(0, coefs.data()+1, rhs);
+        else           lsq.addRow(firstcol, coefs.data(), rhs);
+    }
 
-    if(res!=0)
+    std::vector<double> sol(2*nCols);
+    if(!lsq.solve(sol.data()))
     {
         m_bSingular = true;
         return false;
@@ -371,7 +460,7 @@ assert(Q.size()>=2);
     for(int i=1; i<h; i++)
     {
         int r=i-1;
-        m_CtrlPt[i].set(Q[r], Q[(h-1)+r]);
+        m_CtrlPt[i].set(sol[r], sol[1*(h-1)+r]);
     }
     updateSpline();
     makeCurve();
@@ -543,6 +543,42 @@ Vector2d CubicSpline::splinePoint(double u) const
 }
 
 
+/**
+ * Evaluates the spline at the n parameters u.
+ * For increasing parameters, the segment search starts from the previous segment.
+ */
+void CubicSpline::splinePoints(double const *u, int n, Vector2d *pt) const
+{
+    if(nCtrlPoints()<2)
+    {
+        for(int i=0; i<n; i++) pt[i].set(0.0,0.0);
+        return;
+    }
+
+    int nSegs = int(m_segVal.size())-1;
+    int iSeg = 0;
+    for(int i=0; i<n; i++)
+    {
+        double t = u[i];
+        if(i>0 && t<u[i-1]) iSeg = 0;
+        while(iSeg<nSegs && t>m_segVal.at(iSeg+1)) iSeg++;
+
+        if(iSeg<nSegs)
+        {
+            double const *cx = m_cx.data() + 4*iSeg;
+            double const *cy = m_cy.data() + 4*iSeg;
+            pt[i].x = cx[0]*t*t*t + cx[1]*t*t + cx[2]*t + cx[3];
+            pt[i].y = cy[0]*t*t*t + cy[1]*t*t + cy[2]*t + cy[3];
+        }
+        else
+        {
+            //  return the last control point;
+            pt[i].set(m_CtrlPt.back().x, m_CtrlPt.back().y);
+        }
+    }
+}
+
+
 void CubicSpline::rePanel(int N)
 {
     if(nCtrlPoints()<=2) return;
@@ -561,7 +597,8 @@ void CubicSpline::rePanel(int N)
     for(uint i=1; i<length.size(); i++) length[i] = length[i-1] + m_ArcLengths.at(i-1);
     for(uint i=1; i<length.size(); i++) length[i] *= 1.0/l;
 
-    double u(0);
+    double u(0), uprev(0);
+    uint jstart = 0;
     for(int i=0; i<N; i++)
     {
         double t = double(i)/double(N-1);
@@ -570,10 +607,14 @@ void CubicSpline::rePanel(int N)
         else if(m_BunchType==Spline::SIGMOID)   u = sigmoid(-m_BunchAmp, t);
         else                                    u = t; // UNIFORM length spacing
 
-        for(uint j=0; j<m_segVal.size()-1; j++)
+        // the bunched parameters are increasing, so the search starts from the last segment found
+        if(u<uprev) jstart = 0;
+        uprev = u;
+        for(uint j=jstart; j<m_segVal.size()-1; j++)
         {
             if(u<=length.at(j+1))
             {
+                jstart = j;
                 u = m_segVal.at(j) + (u-length.at(j))/(length.at(j+1)-length.at(j)) * (m_segVal.at(j+1)-m_segVal.at(j)); // space evenly
                 m_Output[i].x = m_cx.at(j*4)*u*u*u + m_cx.at(j*4+1)*u*u + m_cx.at(j*4+2)*u + m_cx.at(j*4+3);
                 m_Output[i].y = m_cy.at(j*4)*u*u*u + m_cy.at(j*4+1)*u*u + m_cy.at(j*4+2)*u + m_cy.at(j*4+3);
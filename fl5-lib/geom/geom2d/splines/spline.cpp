@@ -506,7 +506,8 @@ double Spline::closest(double xin, double yin, float precision) const
     double u(0);
     double dmax=1.e10;
 
-    Vector2d pt;
+    std::vector<double> useq(nsplit);
+    std::vector<Vector2d> pts(nsplit);
 
     float umin=0.0;
     float umax=1.0;
@@ -519,19 +520,25 @@ double Spline::closest(double xin, double yin, float precision) const
     do
     {
         u = umin;
+        for(int i=0; i<nsplit; i++)
+        {
+            useq[i] = u;
+            u+=dt;
+        }
+        splinePoints(useq.data(), nsplit, pts.data());
+
         bImproved = false;
         for(int i=0; i<nsplit; i++)
         {
-            pt = splinePoint(u);
+            Vector2d const &pt = pts.at(i);
             dist = sqrt((xin-pt.x)*(xin-pt.x)+(yin-pt.y)*(yin-pt.y));
             if(dist<dmax)
             {
-                uc=u;
+                uc=useq.at(i);
                 dmax = dist;
                 bImproved = true;
                 if(dist<=precision) break;
             }
-            u+=dt;
         }
 
         if(fabs(uc)<precision)     return 0.0;
@@ -668,6 +675,17 @@ void Spline::scale(double ratio)
 }
 
 
+/**
+ * Evaluates the spline at the n parameters u.
+ * The default evaluates the points one at a time; the derived classes may take
+ * advantage of sorted parameters to locate the spline segments incrementally.
+ */
+void Spline::splinePoints(double const *u, int n, Vector2d *pt) const
+{
+    for(int i=0; i<n; i++) pt[i] = splinePoint(u[i]);
+}
+
+
 Vector2d Spline::splineNormal(double u) const
 {
     double  dx(0),  dy(0);
@@ -27,6 +27,7 @@
 #include <geom_global.h>
 #include <mathelem.h>
 #include <matrix.h>
+#include <qrleastsquares.h>
 
 BSpline3d::BSpline3d()
 {
@@ -267,19 +268,84 @@ void BSpline3d::makeCurve()
         t = 0;
         increment = 1.0/double(outputSize() - 1);
 
+        std::vector<double> u(m_Output.size());
         for (int j=0; j<outputSize(); j++)
         {
-            double u = bunchedParameter(m_BunchDist, m_BunchAmp, t);
-            splinePoint(u, m_Output[j]);
+            u[j] = bunchedParameter(m_BunchDist, m_BunchAmp, t);
             t += increment;
         }
+        splinePoints(u.data(), outputSize(), m_Output.data());
         m_Output.back() = m_CtrlPt.back();
     }
     m_bSingular = false;
 }
 
 
+/**
+ * Returns true if the knot vector is the clamped vector of size n+degree+1 made by splineKnots(),
+ * in which case the basis functions may be evaluated on the knot spans only.
+ */
+bool BSpline3d::hasClampedKnots() const
+{
+    int nCtrl = nCtrlPoints();
+    if(m_degree<0 || m_degree>geom::MAXSPANDEGREE || m_degree>=nCtrl) return false;
+    if(int(m_knot.size())!=nCtrl+m_degree+1) return false;
+    if(int(m_Weight.size())!=nCtrl) return false;
+    return true;
+}
+
+
 void BSpline3d::splinePoint(double t, Vector3d &pt) const
+{
+    splinePoints(&t, 1, &pt);
+}
+
+
+/**
+ * Evaluates the spline at the n parameters t.
+ * Only the degree+1 basis functions which are non-zero in the parameter's knot span are computed.
+ * The span is searched from the previous one, so that increasing parameters are located in
+ * constant time on average.
+ */
+void BSpline3d::splinePoints(double const *t, int n, Vector3d *pt) const
+{
+    if(!hasClampedKnots())
+    {
+        for(int i=0; i<n; i++) splinePoint_ref(t[i], pt[i]);
+        return;
+    }
+
+    int nCtrl = nCtrlPoints();
+    double N[geom::MAXSPANDEGREE+1];
+    int s = -1;
+    for(int i=0; i<n; i++)
+    {
+        s = geom::knotSpan(m_knot, nCtrl, m_degree, t[i], s);
+        if(s<0)
+        {
+            splinePoint_ref(t[i], pt[i]);
+            continue;
+        }
+
+        geom::spanBasis(m_knot.data(), s, m_degree, t[i], N);
+
+        double x(0), y(0), z(0), w(0);
+        for(int a=0; a<=m_degree; a++)
+        {
+            int k = s-m_degree+a;
+            double b = N[a] * m_Weight[k];
+            x += m_CtrlPt[k].x * b;
+            y += m_CtrlPt[k].y * b;
+            z += m_CtrlPt[k].z * b;
+            w += b;
+        }
+        pt[i].set(x/w, y/w, z/w);
+    }
+}
+
+
+/** The recursive evaluation over all the control points, used if the knots are not clamped */
+void BSpline3d::splinePoint_ref(double t, Vector3d &pt) const
 {
     double w=0.0;
     pt.reset();
@@ -384,54 +450,50 @@ bool BSpline3d::approximate(int degree, int nPts, const std::vector<Vector3d> &p
     m_CtrlPt.back().set(pts.back());
     splineKnots();
 
-    // the resulting curves passes through the first and last input points
-    // build the intermediate points
-    std::vector<double> Nij((h-1)*(n-1), 0);
-    std::vector<double> tNij((h-1)*(n-1), 0);
-    std::vector<double> tk(n+1, 0);
-    int nCols = h-1;
-    int nRows = n-1;
-
-    for(int k=0; k<=n; k++) tk[k] = double(k)/double(n); // n+1 values
+    // the resulting curve passes through the first and last input points
+    // build the intermediate points as the least square solution of N.P = Q
+    // each row of N holds at most p+1 consecutive non-zero basis values, so only the band is assembled
+    int const nCols = h-1;
+    BandedLeastSquares lsq(nCols, p+1, 3);
 
-    for(int i=1; i<n; i++)
+    std::vector<double> N(p+1), coefs(p+1);
+    double rhs[3];
+    int s = -1;
+    for(int k=1; k<n; k++)
     {
-        int r=i-1; // row index
-        for(int j=1; j<h; j++)
+        double tk = double(k)/double(n);
+
+        if(p<=geom::MAXSPANDEGREE) s = geom::knotSpan(m_knot, h+1, p, tk, s);
+        else                       s = -1;
+        if(s>=0) geom::spanBasis(m_knot.data(), s, p, tk, N.data());
+        else
         {
-            int c=j-1; // col index
-            double b = geom::basis(j, p, tk[i], m_knot.data());
-            Nij[r*nCols+c]  = b;
-            tNij[c*nRows+r] = b;
+            s = p;
+            while(s<h && m_knot[s+1]<=tk) s++;
+            for(int a=0; a<=p; a++) N[a] = geom::basis(s-p+a, p, tk, m_knot.data());
         }
-    }
 
-    std::vector<double> NtN(nRows*nRows);
-    matrix::matMult(tNij.data(), Nij.data(), NtN.data(), nCols, nRows, nCols, 1);
-
-    //make the RHS
-    std::vector<double> Q(3*(h-1));
-    for(int i=1; i<h; i++)
-    {
-        int r = i-1;
-        Q[        r] = 0.0;
-        Q[  (h-1)+r] = 0.0;
-        Q[2*(h-1)+r] = 0.0;
-        for(int k=1; k<n; k++)
+        // basis functions 0 and h multiply the fixed end points and are moved to the RHS
+        double b0(0), bh(0);
+        for(int a=0; a<=p; a++)
         {
-            double b = geom::basis(i, p, tk[k], m_knot.data());
-            double Qkx = pts[k].x - geom::basis(0, p, tk[k], m_knot.data()) * pts.front().x - geom::basis(h, p, tk[k], m_knot.data()) * pts.back().x;
-            double Qky = pts[k].y - geom::basis(0, p, tk[k], m_knot.data()) * pts.front().y - geom::basis(h, p, tk[k], m_knot.data()) * pts.back().y;
-            double Qkz = pts[k].z - geom::basis(0, p, tk[k], m_knot.data()) * pts.front().z - geom::basis(h, p, tk[k], m_knot.data()) * pts.back().z;
-            Q[        r] += b*Qkx;
-            Q[  (h-1)+r] += b*Qky;
-            Q[2*(h-1)+r] += b*Qkz;
+            int j = s-p+a;
+            coefs[a] = N[a];
+            if(j==0) {b0 = N[a]; coefs[a] = 0.0;}
+            if(j==h) {bh = N[a]; coefs[a] = 0.0;}
         }
+        rhs[0] = pts.at(k).x - b0*pts.front().x - bh*pts.back().x;
+        rhs[1] = pts.at(k).y - b0*pts.front().y - bh*pts.back().y;
+        rhs[2] = pts.at(k).z - b0*pts.front().z - bh*pts.back().z;
+
+        // column index of the first basis function is j-1
+        int firstcol = s-p-1;
+        if(firstcol<0) lsq.addRow(0, coefs.data()+1, rhs);
+        else           lsq.addRow(firstcol, coefs.data(), rhs);
     }
 
-    int res = matrix::solveLinearSystem(h-1, NtN.data(), 3, Q.data());
-
-    if(res!=0)
+    std::vector<double> sol(3*nCols);
+    if(!lsq.solve(sol.data()))
     {
         m_bSingular = true;
         return false;
@@ -440,12 +502,12 @@ bool BSpline3d::approximate(int degree, int nPts, const std::vector<Vector3d> &p
     for(int i=1; i<h; i++)
     {
         int r=i-1;
-        m_CtrlPt[i].set(Q[r], Q[(h-1)+r], Q[2*(h-1)+r]);
+        m_CtrlPt[i].set(sol[r], sol[1*(h-1)+r], sol[2*(h-1)+r]);
     }
     updateSpline();
     makeCurve();
 
-    return m_bSingular;
+    return true;
 }
 
 
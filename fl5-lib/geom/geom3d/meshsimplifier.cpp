@@ -0,0 +1,367 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+
+#include <meshsimplifier.h>
+#include <constants.h>
+#include <pointhash.h>
+
+
+namespace
+{
+    /** A grid cell at a given refinement level; the free edge vertices are kept in their own cells */
+    struct ClusterKey
+    {
+        int64_t m_i{0}, m_j{0}, m_k{0};
+        bool m_bBoundary{false};
+        bool operator==(ClusterKey const &key) const {return m_i==key.m_i && m_j==key.m_j && m_k==key.m_k && m_bBoundary==key.m_bBoundary;}
+    };
+
+    struct ClusterKeyHash
+    {
+        size_t operator()(ClusterKey const &key) const
+        {
+            return size_t(key.m_i*73856093) ^ size_t(key.m_j*19349663) ^ size_t(key.m_k*83492791) ^ size_t(key.m_bBoundary);
+        }
+    };
+
+    /** The symmetric 4x4 quadric of a set of planes: the six terms of n.nT, the three of n.d, and d.d */
+    typedef std::array<double, 10> Quadric;
+
+    void addPlane(Quadric &q, Vector3d const &n, double d, double weight)
+    {
+        q[0] += weight*n.x*n.x;  q[1] += weight*n.x*n.y;  q[2] += weight*n.x*n.z;
+        q[3] += weight*n.y*n.y;  q[4] += weight*n.y*n.z;  q[5] += weight*n.z*n.z;
+        q[6] += weight*n.x*d;    q[7] += weight*n.y*d;    q[8] += weight*n.z*d;
+        q[9] += weight*d*d;
+    }
+}
+
+
+MeshSimplifier::MeshSimplifier()
+{
+    m_MaxTriangles = 0;
+    m_EdgeLength = 0.0;
+    m_MaxNormalAngle = 20.0;
+    m_MaxLevels = 3;
+}
+
+
+/**
+ * Decimates the triangles to the target edge length if it has been set, or else to the target triangle count.
+ * @return false and leaves the output empty if the triangles do not need to be decimated.
+ */
+bool MeshSimplifier::simplify(std::vector<Triangle3d> const &triangles, std::vector<Triangle3d> &simplified)
+{
+    simplified.clear();
+
+    if(triangles.size()<4) return false;
+    if(m_EdgeLength<=0.0 && (m_MaxTriangles<=0 || int(triangles.size())<=m_MaxTriangles)) return false;
+
+    Vector3d bmin( 1.e30,  1.e30,  1.e30);
+    Vector3d bmax(-1.e30, -1.e30, -1.e30);
+    double area = 0.0;
+    for(Triangle3d const &t3d : triangles)
+    {
+        for(int iv=0; iv<3; iv++)
+        {
+            Vector3d const &pt = t3d.vertexAt(iv);
+            bmin.set(std::min(bmin.x, pt.x), std::min(bmin.y, pt.y), std::min(bmin.z, pt.z));
+            bmax.set(std::max(bmax.x, pt.x), std::max(bmax.y, pt.y), std::max(bmax.z, pt.z));
+        }
+        area += t3d.area();
+    }
+    double diag = bmin.distanceTo(bmax);
+    if(diag<LENGTHPRECISION || area<LENGTHPRECISION*LENGTHPRECISION) return false;
+
+    weld(triangles, std::max(diag*1.0e-7, PRECISION));
+
+    // a grid of size h makes about two triangles per cell on the surface
+    double h = m_EdgeLength>0.0 ? m_EdgeLength : sqrt(2.0*area/double(m_MaxTriangles));
+    for(int iter=0; iter<4; iter++)
+    {
+        cluster(h);
+        makeTriangles(triangles, simplified);
+        if(m_EdgeLength>0.0 || int(simplified.size())<=m_MaxTriangles) break;
+        h *= sqrt(double(simplified.size())/double(m_MaxTriangles)) * 1.05;
+    }
+
+    if(simplified.empty() || simplified.size()>=triangles.size())
+    {
+        simplified.clear();
+        return false;
+    }
+    return true;
+}
+
+
+/** Merges the coincident vertices, and flags the vertices of the free edges */
+void MeshSimplifier::weld(std::vector<Triangle3d> const &triangles, double precision)
+{
+    int nTriangles = int(triangles.size());
+    m_Node.clear();
+    m_TriNode.resize(3*nTriangles);
+
+    PointHash hash(precision);
+    hash.reserve(3*nTriangles);
+    std::vector<int> candidates;
+    for(int it=0; it<nTriangles; it++)
+    {
+        for(int iv=0; iv<3; iv++)
+        {
+            Vector3d const &pt = triangles.at(it).vertexAt(iv);
+            hash.candidates(pt, candidates);
+            int idx = -1;
+            for(int ic : candidates)
+            {
+                if(m_Node.at(ic).isSame(pt, precision))
+                {
+                    idx = ic;
+                    break;
+                }
+            }
+            if(idx<0)
+            {
+                idx = int(m_Node.size());
+                m_Node.push_back(pt);
+                hash.insert(pt, idx);
+            }
+            m_TriNode[3*it+iv] = idx;
+        }
+    }
+
+    int nNodes = int(m_Node.size());
+    m_NodeNormal.assign(nNodes, Vector3d());
+    m_NodeArea.assign(nNodes, 0.0);
+    std::unordered_map<uint64_t, int> edgecount;
+    edgecount.reserve(3*nTriangles);
+    for(int it=0; it<nTriangles; it++)
+    {
+        Triangle3d const &t3d = triangles.at(it);
+        for(int iv=0; iv<3; iv++)
+        {
+            int n0 = m_TriNode[3*it+iv];
+            int n1 = m_TriNode[3*it+(iv+1)%3];
+            m_NodeNormal[n0] += t3d.normal()*t3d.area();
+            m_NodeArea[n0]   += t3d.area();
+            uint64_t key = (uint64_t(std::min(n0,n1))<<32) | uint64_t(std::max(n0,n1));
+            edgecount[key]++;
+        }
+    }
+
+    m_bBoundary.assign(nNodes, false);
+    m_FreeEdge.clear();
+    for(int it=0; it<nTriangles; it++)
+    {
+        for(int iv=0; iv<3; iv++)
+        {
+            int n0 = m_TriNode[3*it+iv];
+            int n1 = m_TriNode[3*it+(iv+1)%3];
+            uint64_t key = (uint64_t(std::min(n0,n1))<<32) | uint64_t(std::max(n0,n1));
+            if(edgecount.at(key)!=1) continue;
+            m_bBoundary[n0] = m_bBoundary[n1] = true;
+            m_FreeEdge.push_back({n0, n1, it});
+        }
+    }
+}
+
+
+/**
+ * Assigns the vertices to the clusters and places the clusters.
+ * A cell is split if the normals of the triangles around its vertices spread more than the maximum angle.
+ */
+void MeshSimplifier::cluster(double cellsize)
+{
+    int nNodes = int(m_Node.size());
+    double cosmax = cos(m_MaxNormalAngle*PI/180.0);
+
+    m_Cluster.assign(nNodes, -1);
+    m_ClusterPos.clear();
+    std::vector<double> clustersize; // the size of the cell of each cluster
+
+    std::unordered_map<ClusterKey, int, ClusterKeyHash> cells;
+    std::vector<Vector3d> cellnormal;
+    std::vector<double> cellarea;
+    std::vector<int> cellcluster;
+    std::vector<int> nodecell(nNodes, -1);
+
+    for(int level=0; level<=m_MaxLevels; level++)
+    {
+        double cs = cellsize/double(1<<level);
+        cells.clear();
+        cellnormal.clear();
+        cellarea.clear();
+
+        ClusterKey key;
+        for(int in=0; in<nNodes; in++)
+        {
+            if(m_Cluster.at(in)>=0) continue;
+            Vector3d const &pt = m_Node.at(in);
+            key.m_i = int64_t(std::floor(pt.x/cs));
+            key.m_j = int64_t(std::floor(pt.y/cs));
+            key.m_k = int64_t(std::floor(pt.z/cs));
+            key.m_bBoundary = m_bBoundary.at(in);
+            auto it = cells.find(key);
+            int ic = 0;
+            if(it==cells.end())
+            {
+                ic = int(cellnormal.size());
+                cells[key] = ic;
+                cellnormal.push_back(Vector3d());
+                cellarea.push_back(0.0);
+            }
+            else ic = it->second;
+            cellnormal[ic] += m_NodeNormal.at(in);
+            cellarea[ic]   += m_NodeArea.at(in);
+            nodecell[in] = ic;
+        }
+
+        cellcluster.assign(cellnormal.size(), -1);
+        for(int in=0; in<nNodes; in++)
+        {
+            if(m_Cluster.at(in)>=0) continue;
+            int ic = nodecell.at(in);
+            bool bFlat = cellnormal.at(ic).norm() >= cosmax*cellarea.at(ic);
+            if(!bFlat && level<m_MaxLevels) continue;
+            if(cellcluster.at(ic)<0)
+            {
+                cellcluster[ic] = int(m_ClusterPos.size());
+                m_ClusterPos.push_back(Vector3d());
+                clustersize.push_back(cs);
+            }
+            m_Cluster[in] = cellcluster.at(ic);
+        }
+    }
+
+    // accumulate the quadrics of the triangles' planes, and of the planes normal to the free edges
+    int nClusters = int(m_ClusterPos.size());
+    std::vector<Quadric> quadric(nClusters);
+    for(Quadric &q : quadric) q.fill(0.0);
+    std::vector<int> count(nClusters, 0);
+
+    for(int in=0; in<nNodes; in++)
+    {
+        m_ClusterPos[m_Cluster.at(in)] += m_Node.at(in);
+        count[m_Cluster.at(in)]++;
+    }
+    for(int ic=0; ic<nClusters; ic++) m_ClusterPos[ic] *= 1.0/double(count.at(ic));
+
+    int nTriangles = int(m_TriNode.size())/3;
+    for(int it=0; it<nTriangles; it++)
+    {
+        Vector3d const &p0 = m_Node.at(m_TriNode[3*it]);
+        Vector3d const &p1 = m_Node.at(m_TriNode[3*it+1]);
+        Vector3d const &p2 = m_Node.at(m_TriNode[3*it+2]);
+        Vector3d N = (p1-p0)*(p2-p0);
+        double a2 = N.norm();
+        if(a2<PRECISION) continue;
+        N *= 1.0/a2;
+        double d = -N.dot(p0);
+        for(int iv=0; iv<3; iv++) addPlane(quadric[m_Cluster.at(m_TriNode[3*it+iv])], N, d, 0.5*a2);
+    }
+
+    for(std::array<int,3> const &edge : m_FreeEdge)
+    {
+        int it = edge[2];
+        Vector3d const &p0 = m_Node.at(m_TriNode[3*it]);
+        Vector3d const &p1 = m_Node.at(m_TriNode[3*it+1]);
+        Vector3d const &p2 = m_Node.at(m_TriNode[3*it+2]);
+        Vector3d N = (p1-p0)*(p2-p0);
+        Vector3d const &A = m_Node.at(edge[0]);
+        Vector3d const &B = m_Node.at(edge[1]);
+        Vector3d E = B-A;
+        double l = E.norm();
+        if(N.norm()<PRECISION || l<PRECISION) continue;
+        Vector3d C = E*N;
+        C.normalize();
+        double d = -C.dot(A);
+        addPlane(quadric[m_Cluster.at(edge[0])], C, d, l*l);
+        addPlane(quadric[m_Cluster.at(edge[1])], C, d, l*l);
+    }
+
+    // place each cluster at the minimum of its quadric, relative to the mean of its vertices,
+    // unless the quadric is singular, i.e. the cluster is flat or on a single crease
+    for(int ic=0; ic<nClusters; ic++)
+    {
+        Quadric const &q = quadric.at(ic);
+        double w = q[0]+q[3]+q[5];
+        if(w<PRECISION) continue;
+        Vector3d const &M = m_ClusterPos.at(ic);
+        double a[9] = {q[0]/w, q[1]/w, q[2]/w,
+                       q[1]/w, q[3]/w, q[4]/w,
+                       q[2]/w, q[4]/w, q[5]/w};
+        double r[3];
+        r[0] = -(q[6] + q[0]*M.x + q[1]*M.y + q[2]*M.z)/w;
+        r[1] = -(q[7] + q[1]*M.x + q[3]*M.y + q[4]*M.z)/w;
+        r[2] = -(q[8] + q[2]*M.x + q[4]*M.y + q[5]*M.z)/w;
+
+        double det = a[0]*(a[4]*a[8]-a[5]*a[7]) - a[1]*(a[3]*a[8]-a[5]*a[6]) + a[2]*(a[3]*a[7]-a[4]*a[6]);
+        if(det<1.0e-3) continue;
+
+        Vector3d delta;
+        delta.x = (r[0]*(a[4]*a[8]-a[5]*a[7]) - a[1]*(r[1]*a[8]-a[5]*r[2]) + a[2]*(r[1]*a[7]-a[4]*r[2]))/det;
+        delta.y = (a[0]*(r[1]*a[8]-a[5]*r[2]) - r[0]*(a[3]*a[8]-a[5]*a[6]) + a[2]*(a[3]*r[2]-r[1]*a[6]))/det;
+        delta.z = (a[0]*(a[4]*r[2]-r[1]*a[7]) - a[1]*(a[3]*r[2]-r[1]*a[6]) + r[0]*(a[3]*a[7]-a[4]*a[6]))/det;
+
+        if(delta.norm()<=clustersize.at(ic)) m_ClusterPos[ic] += delta;
+    }
+}
+
+
+/** Keeps one copy of each triangle whose vertices are in three different clusters, unless it is folded over its original */
+void MeshSimplifier::makeTriangles(std::vector<Triangle3d> const &triangles, std::vector<Triangle3d> &simplified) const
+{
+    simplified.clear();
+    std::set<std::array<int,3>> done;
+    int nTriangles = int(triangles.size());
+    for(int it=0; it<nTriangles; it++)
+    {
+        int c0 = m_Cluster.at(m_TriNode[3*it]);
+        int c1 = m_Cluster.at(m_TriNode[3*it+1]);
+        int c2 = m_Cluster.at(m_TriNode[3*it+2]);
+        if(c0==c1 || c1==c2 || c2==c0) continue;
+
+        std::array<int,3> key = {c0, c1, c2};
+        std::sort(key.begin(), key.end());
+        if(done.count(key)) continue;
+
+        Vector3d const &S0 = m_ClusterPos.at(c0);
+        Vector3d const &S1 = m_ClusterPos.at(c1);
+        Vector3d const &S2 = m_ClusterPos.at(c2);
+        Vector3d N = (S1-S0)*(S2-S0);
+        if(N.norm()<PRECISION) continue;
+        if(N.dot(triangles.at(it).normal())<=0.0) continue;
+
+        done.insert(key);
+        simplified.push_back(Triangle3d(Node(S0), Node(S1), Node(S2)));
+    }
+}
+
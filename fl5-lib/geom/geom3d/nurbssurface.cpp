@@ -33,7 +33,6 @@
 #include <triangle3d.h>
 
 
-
 /**
  * The public constructor.
  * @param iAxis defines direction of the u parameter; v is in the y-direction
@@ -122,21 +121,48 @@ double NURBSSurface::getu(double pos, double v) const
 
     double u1 = 0.0, u2 = 1.0;
 
+    bool bLocal = hasLocalBasis();
+
+    // the sum of the v-basis functions is the same for all frames and is evaluated once
+    double cv = 0.0;
+    if(bLocal)
+    {
+        int sv = geom::knotSpan(m_vKnot, framePointCount(), m_ivDegree, v);
+        if(sv>=0)
+        {
+            double Nv[geom::MAXSPANDEGREE+1];
+            geom::spanBasis(m_vKnot.data(), sv, m_ivDegree, v, Nv);
+            for(int b=0; b<=m_ivDegree; b++) cv += Nv[b];
+        }
+    }
+    else
+    {
+        for(int jv=0; jv<framePointCount(); jv++) cv += geom::basis(jv, m_ivDegree, v, m_vKnot.data());
+    }
+
 //    v = 0.0;//use top line, but doesn't matter
     while(fabs(u2-u1)>1.0e-6 && iter<100)
     {
         double u=(u1+u2)/2.0;
         double zz = 0.0;
-        for(int iu=0; iu<frameCount(); iu++) //browse all points
+        if(bLocal)
+        {
+            int su = geom::knotSpan(m_uKnot, frameCount(), m_iuDegree, u);
+            if(su>=0)
+            {
+                double Nu[geom::MAXSPANDEGREE+1];
+                geom::spanBasis(m_uKnot.data(), su, m_iuDegree, u, Nu);
+                for(int a=0; a<=m_iuDegree; a++)
+                    zz += m_Frame.at(su-m_iuDegree+a).position().dir(m_uAxis) * cv * Nu[a];
+            }
+        }
+        else
         {
-            double zh = 0.0;
-            for(int jv=0; jv<framePointCount(); jv++)
+            for(int iu=0; iu<frameCount(); iu++) //browse all points
             {
-                double c =  geom::basis(jv, m_ivDegree, v, m_vKnot.data());
-                zh += m_Frame[iu].position().dir(m_uAxis) * c;
+                double b = geom::basis(iu, m_iuDegree, u, m_uKnot.data());
+                zz += m_Frame[iu].position().dir(m_uAxis) * cv * b;
             }
-            double b = geom::basis(iu, m_iuDegree, u, m_uKnot.data());
-            zz += zh * b;
         }
         if(zz>pos) u2 = u;
         else       u1 = u;
@@ -169,11 +195,13 @@ double NURBSSurface::getv(double pos, double u) const
     double v1=0.0, v2=1.0;
 
     Vector3d pt;
+    std::vector<Vector3d> curve; // u is constant, so that the u-basis is evaluated once
+    getuCurve(u, curve);
 //    v = 0.0;//use top line, but doesn't matter
     while(fabs(v2-v1)>1.0e-6 && iter<100)
     {
         v=(v1+v2)/2.0;
-        getPoint(u,v, pt);
+        getCurvePoint(u, curve, v, pt);
         if(fabs(pt.dir(m_vAxis)-pos)<0.0001) return v;
         if(pt.dir(m_vAxis)>pos) v2 = v;
         else                    v1 = v;
@@ -206,10 +234,13 @@ double NURBSSurface::getvIntersect(double u, Vector3d r) const
     r.normalize();
     v1 = 0.0; v2 = 1.0;
 
+    std::vector<Vector3d> curve; // u is constant, so that the u-basis is evaluated once
+    getuCurve(u, curve);
+
     while(fabs(sine)>1.0e-4 && iter<100)
     {
         v=(v1+v2)/2.0;
-        getPoint(u, v, t_R);
+        getCurvePoint(u, curve, v, t_R);
         t_R.x = 0.0;
         t_R.normalize();//t_R is the unit radial vector for u,v
 
@@ -229,12 +260,342 @@ double NURBSSurface::getvIntersect(double u, Vector3d r) const
  * Returns the point corresponding to the pair of parameters (u,v)
  * Assumes that the knots have been set previously
  *
- * Scans the u-direction first, then v-direction
+ * Only the degree+1 basis functions which are non-zero in the knot spans of u and v are evaluated.
  * @param u the specified u-parameter
  * @param v the specified v-parameter
  * @param Pt a reference to the point defined by the pair (u,v)
 */
 void NURBSSurface::getPoint(double u, double v, Vector3d &Pt) const
+{
+    if(u<0.0)  u=0.0;
+    if(v<0.0)  v=0.0;
+    if(u>=1.0) u=0.99999999999;
+    if(v>=1.0) v=0.99999999999;
+
+    int su=-1, sv=-1;
+    if(hasLocalBasis())
+    {
+        su = geom::knotSpan(m_uKnot, frameCount(),      m_iuDegree, u);
+        sv = geom::knotSpan(m_vKnot, framePointCount(), m_ivDegree, v);
+    }
+    if(su<0 || sv<0)
+    {
+        getPoint_ref(u, v, Pt);
+        return;
+    }
+
+    double Nu[geom::MAXSPANDEGREE+1], Nv[geom::MAXSPANDEGREE+1];
+    geom::spanBasis(m_uKnot.data(), su, m_iuDegree, u, Nu);
+    geom::spanBasis(m_vKnot.data(), sv, m_ivDegree, v, Nv);
+    spanPoint(su, Nu, sv, Nv, nullptr, Pt);
+}
+
+
+/**
+ * Sums the contributions of the control points which are active in the knot spans su and sv.
+ * @param net the control points rotated with their frame's angle, or nullptr if the rotation should be made on the fly
+ */
+void NURBSSurface::spanPoint(int su, double const *Nu, int sv, double const *Nv, Vector3d const *net, Vector3d &Pt) const
+{
+    int nPts = framePointCount();
+    Vector3d V, Vv, rpt;
+    double totalweight = 0.0;
+
+    for(int a=0; a<=m_iuDegree; a++)
+    {
+        int iu = su-m_iuDegree+a;
+        Frame const &uframe = m_Frame.at(iu);
+        bool bRotate = fabs(uframe.angle())>ANGLEPRECISION; //degrees
+        Vv.set(0.0,0.0,0.0);
+        double wx = 0.0;
+        for(int b=0; b<=m_ivDegree; b++)
+        {
+            int jv = sv-m_ivDegree+b;
+            double cs = Nv[b] * weight(m_EdgeWeightv, jv, nPts);
+
+            if(net) rpt = net[iu*nPts+jv];
+            else
+            {
+                rpt = uframe.ctrlPointAt(jv);
+                if(bRotate) rpt.rotateY(uframe.position(), uframe.angle());
+            }
+
+            Vv.x += rpt.x * cs;
+            Vv.y += rpt.y * cs;
+            Vv.z += rpt.z * cs;
+
+            wx += cs;
+        }
+        double bs = Nu[a] * weight(m_EdgeWeightu, iu, frameCount());
+
+        V.x += Vv.x * bs;
+        V.y += Vv.y * bs;
+        V.z += Vv.z * bs;
+
+        totalweight += wx * bs;
+    }
+
+    Pt.x = V.x / totalweight;
+    Pt.y = V.y / totalweight;
+    Pt.z = V.z / totalweight;
+}
+
+
+/** Makes the array of control points rotated with their frame's angle, with the frame points contiguous */
+void NURBSSurface::makeCtrlNet(std::vector<Vector3d> &net) const
+{
+    int nPts = framePointCount();
+    net.resize(frameCount()*nPts);
+    for(int iu=0; iu<frameCount(); iu++)
+    {
+        Frame const &uframe = m_Frame.at(iu);
+        bool bRotate = fabs(uframe.angle())>ANGLEPRECISION; //degrees
+        for(int jv=0; jv<nPts; jv++)
+        {
+            Vector3d &rpt = net[iu*nPts+jv];
+            rpt = uframe.ctrlPointAt(jv);
+            if(bRotate) rpt.rotateY(uframe.position(), uframe.angle());
+        }
+    }
+}
+
+
+/**
+ * Returns the points for the arrays of parameters u[] and v[] in one pass.
+ * The control net is rotated once for all the points.
+ */
+void NURBSSurface::getPoints(int nPts, double const *u, double const *v, Vector3d *Pt) const
+{
+    if(!hasLocalBasis())
+    {
+        for(int i=0; i<nPts; i++) getPoint(u[i], v[i], Pt[i]);
+        return;
+    }
+
+    std::vector<Vector3d> net;
+    makeCtrlNet(net);
+
+    double Nu[geom::MAXSPANDEGREE+1], Nv[geom::MAXSPANDEGREE+1];
+    for(int i=0; i<nPts; i++)
+    {
+        double ui = std::max(0.0, std::min(u[i], 0.99999999999));
+        double vi = std::max(0.0, std::min(v[i], 0.99999999999));
+        int su = geom::knotSpan(m_uKnot, frameCount(),      m_iuDegree, ui);
+        int sv = geom::knotSpan(m_vKnot, framePointCount(), m_ivDegree, vi);
+        if(su<0 || sv<0)
+        {
+            getPoint_ref(ui, vi, Pt[i]);
+            continue;
+        }
+        geom::spanBasis(m_uKnot.data(), su, m_iuDegree, ui, Nu);
+        geom::spanBasis(m_vKnot.data(), sv, m_ivDegree, vi, Nv);
+        spanPoint(su, Nu, sv, Nv, net.data(), Pt[i]);
+    }
+}
+
+
+/**
+ * Returns the grid of points for the tensor product of the parameters u[] and v[]; the point (iu, iv) is at index iu*v.size()+iv.
+ * The basis functions are evaluated once for each value of u and of v.
+ */
+void NURBSSurface::getGrid(std::vector<double> const &u, std::vector<double> const &v, std::vector<Vector3d> &grid) const
+{
+    int nu = int(u.size());
+    int nv = int(v.size());
+    grid.resize(nu*nv);
+
+    if(!hasLocalBasis())
+    {
+        for(int iu=0; iu<nu; iu++)
+            for(int iv=0; iv<nv; iv++) getPoint(u.at(iu), v.at(iv), grid[iu*nv+iv]);
+        return;
+    }
+
+    std::vector<Vector3d> net;
+    makeCtrlNet(net);
+
+    int pu = m_iuDegree+1, pv = m_ivDegree+1;
+    std::vector<int> su(nu), sv(nv);
+    std::vector<double> Nu(nu*pu), Nv(nv*pv), uc(nu), vc(nv);
+    for(int iu=0; iu<nu; iu++)
+    {
+        uc[iu] = std::max(0.0, std::min(u.at(iu), 0.99999999999));
+        su[iu] = geom::knotSpan(m_uKnot, frameCount(), m_iuDegree, uc.at(iu));
+        if(su.at(iu)>=0) geom::spanBasis(m_uKnot.data(), su.at(iu), m_iuDegree, uc.at(iu), Nu.data()+iu*pu);
+    }
+    for(int iv=0; iv<nv; iv++)
+    {
+        vc[iv] = std::max(0.0, std::min(v.at(iv), 0.99999999999));
+        sv[iv] = geom::knotSpan(m_vKnot, framePointCount(), m_ivDegree, vc.at(iv));
+        if(sv.at(iv)>=0) geom::spanBasis(m_vKnot.data(), sv.at(iv), m_ivDegree, vc.at(iv), Nv.data()+iv*pv);
+    }
+
+    for(int iu=0; iu<nu; iu++)
+    {
+        for(int iv=0; iv<nv; iv++)
+        {
+            if(su.at(iu)<0 || sv.at(iv)<0)
+                getPoint_ref(uc.at(iu), vc.at(iv), grid[iu*nv+iv]);
+            else
+                spanPoint(su.at(iu), Nu.data()+iu*pu, sv.at(iv), Nv.data()+iv*pv, net.data(), grid[iu*nv+iv]);
+        }
+    }
+}
+
+
+/**
+ * Makes the control points of the isoparametric curve at u, i.e. the frame points combined with the
+ * u-basis functions and normalized by the u-weights, so that the points of the curve can be evaluated
+ * with the v-basis functions only; used for the searches along v at constant u.
+ * @param curve the control points of the curve, or an empty array if the surface has no local basis at u
+ */
+void NURBSSurface::getuCurve(double u, std::vector<Vector3d> &curve) const
+{
+    curve.clear();
+    if(!hasLocalBasis()) return;
+
+    u = std::max(0.0, std::min(u, 0.99999999999));
+    int su = geom::knotSpan(m_uKnot, frameCount(), m_iuDegree, u);
+    if(su<0) return;
+
+    double Nu[geom::MAXSPANDEGREE+1];
+    geom::spanBasis(m_uKnot.data(), su, m_iuDegree, u, Nu);
+
+    int nPts = framePointCount();
+    curve.assign(nPts, Vector3d());
+    Vector3d rpt;
+    double wu = 0.0;
+    for(int a=0; a<=m_iuDegree; a++)
+    {
+        int iu = su-m_iuDegree+a;
+        Frame const &uframe = m_Frame.at(iu);
+        bool bRotate = fabs(uframe.angle())>ANGLEPRECISION; //degrees
+        double bs = Nu[a] * weight(m_EdgeWeightu, iu, frameCount());
+        for(int jv=0; jv<nPts; jv++)
+        {
+            rpt = uframe.ctrlPointAt(jv);
+            if(bRotate) rpt.rotateY(uframe.position(), uframe.angle());
+            curve[jv].x += rpt.x * bs;
+            curve[jv].y += rpt.y * bs;
+            curve[jv].z += rpt.z * bs;
+        }
+        wu += bs;
+    }
+    for(int jv=0; jv<nPts; jv++) curve[jv] *= 1.0/wu;
+}
+
+
+/**
+ * Returns the point (u,v) from the isoparametric curve made by getuCurve(u),
+ * or from the surface if the curve is empty.
+ */
+void NURBSSurface::getCurvePoint(double u, std::vector<Vector3d> const &curve, double v, Vector3d &Pt) const
+{
+    v = std::max(0.0, std::min(v, 0.99999999999));
+    int sv = curve.empty() ? -1 : geom::knotSpan(m_vKnot, framePointCount(), m_ivDegree, v);
+    if(sv<0)
+    {
+        getPoint(u, v, Pt);
+        return;
+    }
+
+    double Nv[geom::MAXSPANDEGREE+1];
+    geom::spanBasis(m_vKnot.data(), sv, m_ivDegree, v, Nv);
+
+    int nPts = framePointCount();
+    Vector3d V;
+    double totalweight = 0.0;
+    for(int b=0; b<=m_ivDegree; b++)
+    {
+        int jv = sv-m_ivDegree+b;
+        double cs = Nv[b] * weight(m_EdgeWeightv, jv, nPts);
+        V.x += curve.at(jv).x * cs;
+        V.y += curve.at(jv).y * cs;
+        V.z += curve.at(jv).z * cs;
+        totalweight += cs;
+    }
+    Pt.x = V.x / totalweight;
+    Pt.y = V.y / totalweight;
+    Pt.z = V.z / totalweight;
+}
+
+
+void NURBSSurface::getNormal(double u, double v, Vector3d &N) const
+{
+    u=std::max(u, 1e-4);
+    v=std::max(v, 1e-4);
+    u=std::min(u, 1.0-1.e-4);
+    v=std::min(v, 1.0-1.e-4);
+
+    int su=-1, sv=-1;
+    if(hasLocalBasis())
+    {
+        su = geom::knotSpan(m_uKnot, frameCount(),      m_iuDegree, u);
+        sv = geom::knotSpan(m_vKnot, framePointCount(), m_ivDegree, v);
+    }
+    if(su<0 || sv<0)
+    {
+        getNormal_ref(u, v, N);
+        return;
+    }
+
+    double Nu[geom::MAXSPANDEGREE+1], Nv[geom::MAXSPANDEGREE+1];
+    double dNu[geom::MAXSPANDEGREE+1], dNv[geom::MAXSPANDEGREE+1];
+    geom::spanBasis(m_uKnot.data(), su, m_iuDegree, u, Nu);
+    geom::spanBasis(m_vKnot.data(), sv, m_ivDegree, v, Nv);
+    geom::spanBasisDerivative(m_uKnot.data(), su, m_iuDegree, u, dNu);
+    geom::spanBasisDerivative(m_vKnot.data(), sv, m_ivDegree, v, dNv);
+
+    Vector3d Su, Sv, rpt;
+    for(int a=0; a<=m_iuDegree; a++)
+    {
+        Frame const &uframe = m_Frame.at(su-m_iuDegree+a);
+        bool bRotate = fabs(uframe.angle())>0.01; //degrees
+        for(int b=0; b<=m_ivDegree; b++)
+        {
+            rpt = uframe.ctrlPointAt(sv-m_ivDegree+b);
+            if(bRotate) rpt.rotateY(uframe.position(), uframe.angle());
+
+            double cu = dNu[a]*Nv[b];
+            double cv = Nu[a]*dNv[b];
+            Su.x += rpt.x * cu;
+            Su.y += rpt.y * cu;
+            Su.z += rpt.z * cu;
+            Sv.x += rpt.x * cv;
+            Sv.y += rpt.y * cv;
+            Sv.z += rpt.z * cv;
+        }
+    }
+
+    N = (Su * Sv).normalized();
+}
+
+
+/**
+ * Returns true if the basis functions can be evaluated on the knot spans,
+ * i.e. if the knot vectors are consistent with the degrees and the point counts
+ */
+bool NURBSSurface::hasLocalBasis() const
+{
+    if(m_iuDegree<0 || m_iuDegree>geom::MAXSPANDEGREE) return false;
+    if(m_ivDegree<0 || m_ivDegree>geom::MAXSPANDEGREE) return false;
+    if(frameCount()<=m_iuDegree || framePointCount()<=m_ivDegree) return false;
+    if(int(m_uKnot.size())!=frameCount()+m_iuDegree+1) return false;
+    if(int(m_vKnot.size())!=framePointCount()+m_ivDegree+1) return false;
+    return true;
+}
+
+
+/**
+ * Reference implementation of getPoint() with the recursive evaluation of all the basis functions;
+ * used when the knot vectors are inconsistent with the degrees and the point counts.
+ *
+ * Scans the u-direction first, then v-direction
+ * @param u the specified u-parameter
+ * @param v the specified v-parameter
+ * @param Pt a reference to the point defined by the pair (u,v)
+*/
+void NURBSSurface::getPoint_ref(double u, double v, Vector3d &Pt) const
 {
     Vector3d V, Vv, rpt;
     double wx=0, totalweight=0, cs=0, bs=0;
@@ -282,7 +643,8 @@ void NURBSSurface::getPoint(double u, double v, Vector3d &Pt) const
 }
 
 
-void NURBSSurface::getNormal(double u, double v, Vector3d &N) const
+/** Reference implementation of getNormal() */
+void NURBSSurface::getNormal_ref(double u, double v, Vector3d &N) const
 {
     Vector3d Su, Sv, Vv, rpt;
     double cs=0, bs=0;
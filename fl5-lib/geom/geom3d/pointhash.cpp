@@ -0,0 +1,76 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <cmath>
+
+#include <pointhash.h>
+
+
+/** @param cellsize the size of the grid cells, which should be greater or equal to the precision of the searches */
+PointHash::PointHash(double cellsize)
+{
+    m_CellSize = std::max(cellsize, 1.0e-12);
+}
+
+
+PointHash::CellKey PointHash::cellKey(Vector3d const &pt) const
+{
+    CellKey key;
+    key.m_i = int64_t(std::floor(pt.x/m_CellSize));
+    key.m_j = int64_t(std::floor(pt.y/m_CellSize));
+    key.m_k = int64_t(std::floor(pt.z/m_CellSize));
+    return key;
+}
+
+
+void PointHash::insert(Vector3d const &pt, int index)
+{
+    m_Cell[cellKey(pt)].push_back(index);
+}
+
+
+/** Returns the indexes of the points stored in the cell of pt and in its neighbours, in order of insertion in each cell */
+void PointHash::candidates(Vector3d const &pt, std::vector<int> &indexes) const
+{
+    indexes.clear();
+    CellKey key0 = cellKey(pt);
+    CellKey key;
+    for(int i=-1; i<=1; i++)
+    {
+        key.m_i = key0.m_i+i;
+        for(int j=-1; j<=1; j++)
+        {
+            key.m_j = key0.m_j+j;
+            for(int k=-1; k<=1; k++)
+            {
+                key.m_k = key0.m_k+k;
+                auto it = m_Cell.find(key);
+                if(it!=m_Cell.end()) indexes.insert(indexes.end(), it->second.begin(), it->second.end());
+            }
+        }
+    }
+}
+
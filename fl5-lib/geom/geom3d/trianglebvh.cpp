@@ -0,0 +1,359 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <cmath>
+#include <limits>
+
+#include <trianglebvh.h>
+#include <threadpool.h>
+
+
+int TriangleBVH::s_LeafSize = 4;
+
+
+TriangleBVH::TriangleBVH()
+{
+    m_bBuilt = false;
+}
+
+
+/** The copy constructor; the mutex is not copied */
+TriangleBVH::TriangleBVH(TriangleBVH const &bvh)
+{
+    std::lock_guard<std::mutex> lock(bvh.m_BuildMutex);
+    m_Node  = bvh.m_Node;
+    m_Index = bvh.m_Index;
+    m_bBuilt = bvh.m_bBuilt.load();
+}
+
+
+TriangleBVH &TriangleBVH::operator=(TriangleBVH const &bvh)
+{
+    if(this==&bvh) return *this;
+    std::scoped_lock lock(m_BuildMutex, bvh.m_BuildMutex);
+    m_Node  = bvh.m_Node;
+    m_Index = bvh.m_Index;
+    m_bBuilt = bvh.m_bBuilt.load();
+    return *this;
+}
+
+
+void TriangleBVH::clear()
+{
+    std::lock_guard<std::mutex> lock(m_BuildMutex);
+    m_Node.clear();
+    m_Index.clear();
+    m_bBuilt = false;
+}
+
+
+/**
+ * Builds the tree by recursive median splits of the triangle centroids along the longest axis.
+ * Does nothing if the tree has already been built, so that concurrent callers only build it once.
+ */
+void TriangleBVH::build(std::vector<Triangle3d> const &triangles)
+{
+    std::lock_guard<std::mutex> lock(m_BuildMutex);
+    if(m_bBuilt.load()) return;
+
+    m_Node.clear();
+    m_Index.clear();
+
+    std::vector<Vector3d> centroid(triangles.size());
+    for(uint it=0; it<triangles.size(); it++)
+    {
+        Triangle3d const &t3 = triangles.at(it);
+        if(t3.isNull()) continue;
+        m_Index.push_back(int(it));
+        centroid[it] = (t3.vertexAt(0)+t3.vertexAt(1)+t3.vertexAt(2))/3.0;
+    }
+
+    if(!m_Index.empty())
+    {
+        m_Node.reserve(2*m_Index.size()/s_LeafSize+1);
+        makeNode(triangles, centroid, 0, int(m_Index.size()));
+    }
+
+    m_bBuilt = true;
+}
+
+
+/** Creates the node of the triangles [first, first+count[ of m_Index and recursively splits it in two */
+int TriangleBVH::makeNode(std::vector<Triangle3d> const &triangles, std::vector<Vector3d> const &centroid, int first, int count)
+{
+    int in = int(m_Node.size());
+    m_Node.push_back(BVHNode());
+
+    // the boxes are slightly inflated to match the edge tolerance of the triangle tests
+    Vector3d boxmin( std::numeric_limits<double>::max(),  std::numeric_limits<double>::max(),  std::numeric_limits<double>::max());
+    Vector3d boxmax(-std::numeric_limits<double>::max(), -std::numeric_limits<double>::max(), -std::numeric_limits<double>::max());
+    Vector3d cmin = boxmin, cmax = boxmax;
+    for(int i=first; i<first+count; i++)
+    {
+        Triangle3d const &t3 = triangles.at(m_Index.at(i));
+        Vector3d tmin = t3.vertexAt(0), tmax = t3.vertexAt(0);
+        for(int iv=1; iv<3; iv++)
+        {
+            Vector3d const &S = t3.vertexAt(iv);
+            tmin.set(std::min(tmin.x, S.x), std::min(tmin.y, S.y), std::min(tmin.z, S.z));
+            tmax.set(std::max(tmax.x, S.x), std::max(tmax.y, S.y), std::max(tmax.z, S.z));
+        }
+        Vector3d ext = tmax-tmin;
+        double pad = 1.0e-5*std::max(std::max(ext.x, ext.y), ext.z) + 1.0e-12;
+        boxmin.set(std::min(boxmin.x, tmin.x-pad), std::min(boxmin.y, tmin.y-pad), std::min(boxmin.z, tmin.z-pad));
+        boxmax.set(std::max(boxmax.x, tmax.x+pad), std::max(boxmax.y, tmax.y+pad), std::max(boxmax.z, tmax.z+pad));
+
+        Vector3d const &C = centroid.at(m_Index.at(i));
+        cmin.set(std::min(cmin.x, C.x), std::min(cmin.y, C.y), std::min(cmin.z, C.z));
+        cmax.set(std::max(cmax.x, C.x), std::max(cmax.y, C.y), std::max(cmax.z, C.z));
+    }
+
+    BVHNode node;
+    node.m_Min = boxmin;
+    node.m_Max = boxmax;
+
+    if(count<=s_LeafSize)
+    {
+        node.m_First = first;
+        node.m_Count = count;
+        m_Node[in] = node;
+        return in;
+    }
+
+    Vector3d cext = cmax-cmin;
+    int axis = 0;
+    if(cext.y>cext.dir(axis)) axis = 1;
+    if(cext.z>cext.dir(axis)) axis = 2;
+
+    int half = count/2;
+    std::nth_element(m_Index.begin()+first, m_Index.begin()+first+half, m_Index.begin()+first+count,
+                     [&centroid, axis](int i0, int i1) {return centroid.at(i0).dir(axis)<centroid.at(i1).dir(axis);});
+
+    makeNode(triangles, centroid, first, half);
+    node.m_First = makeNode(triangles, centroid, first+half, count-half);
+    node.m_Count = 0;
+    m_Node[in] = node;
+    return in;
+}
+
+
+/**
+ * Slab test of the line A+t.U with the node's box.
+ * @param bSegment if true, the parameter t is restricted to [0,1]
+ * @param tenter the smallest value of |t| inside the box, used to sort and prune the nodes.
+ */
+bool TriangleBVH::hitBox(BVHNode const &node, Vector3d const &A, Vector3d const &U, bool bSegment, double &tenter)
+{
+    double tmin = bSegment ? 0.0 : -std::numeric_limits<double>::max();
+    double tmax = bSegment ? 1.0 :  std::numeric_limits<double>::max();
+
+    for(int k=0; k<3; k++)
+    {
+        double a  = A.dir(k);
+        double u  = U.dir(k);
+        double lo = node.m_Min.dir(k);
+        double hi = node.m_Max.dir(k);
+        if(fabs(u)<1.0e-300)
+        {
+            if(a<lo || a>hi) return false;
+            continue;
+        }
+        double t0 = (lo-a)/u;
+        double t1 = (hi-a)/u;
+        if(t0>t1) std::swap(t0, t1);
+        tmin = std::max(tmin, t0);
+        tmax = std::min(tmax, t1);
+        if(tmin>tmax) return false;
+    }
+
+    if(tmin<=0.0 && tmax>=0.0) tenter = 0.0;
+    else                       tenter = std::min(fabs(tmin), fabs(tmax));
+    return true;
+}
+
+
+bool TriangleBVH::intersect(std::vector<Triangle3d> const &triangles, Vector3d const &A, Vector3d const &B, bool bSegment, Node &I, int &iTriangle) const
+{
+    iTriangle = -1;
+    if(m_Node.empty()) return false;
+
+    Vector3d U = B-A;
+    double U2 = U.dot(U);
+    if(U2<=0.0) return false;
+    Vector3d Udir = U/sqrt(U2);
+
+    double tbest = std::numeric_limits<double>::max();
+    bool bIntersect = false;
+    Vector3d Int;
+
+    int stack[128];
+    int nstack = 0;
+    double tenter = 0.0;
+    if(!hitBox(m_Node.front(), A, U, bSegment, tenter)) return false;
+    stack[nstack++] = 0;
+
+    while(nstack>0)
+    {
+        BVHNode const &node = m_Node.at(stack[--nstack]);
+
+        if(node.m_Count>0)
+        {
+            for(int i=node.m_First; i<node.m_First+node.m_Count; i++)
+            {
+                int it = m_Index.at(i);
+                Triangle3d const &t3 = triangles.at(it);
+                bool bHit = bSegment ? t3.intersectSegmentInside(A, B, Int, true) : t3.intersectRayInside(A, Udir, Int);
+                if(!bHit) continue;
+                double t = fabs((Int-A).dot(U))/U2;
+                if(t<tbest)
+                {
+                    tbest = t;
+                    I = Int;
+                    I.setNormal(t3.normal());
+                    iTriangle = it;
+                }
+                bIntersect = true;
+            }
+            continue;
+        }
+
+        // push the farther child first, so that the nearer one is visited next and tightens the bound
+        int ileft  = int(&node-m_Node.data())+1;
+        int iright = node.m_First;
+        double tleft=0, tright=0;
+        bool bLeft  = hitBox(m_Node.at(ileft),  A, U, bSegment, tleft)  && tleft<=tbest;
+        bool bRight = hitBox(m_Node.at(iright), A, U, bSegment, tright) && tright<=tbest;
+        if(bLeft && bRight)
+        {
+            if(tleft<tright) {stack[nstack++] = iright; stack[nstack++] = ileft;}
+            else             {stack[nstack++] = ileft;  stack[nstack++] = iright;}
+        }
+        else if(bLeft)  stack[nstack++] = ileft;
+        else if(bRight) stack[nstack++] = iright;
+    }
+
+    return bIntersect;
+}
+
+
+/**
+ * Intersects the segment [A,B] with the triangles.
+ * @param I the intersection point closest to A, with the normal of the intersected triangle
+ * @return true if an intersection was found
+ */
+bool TriangleBVH::intersectSegment(std::vector<Triangle3d> const &triangles, Vector3d const &A, Vector3d const &B, Node &I) const
+{
+    int it=-1;
+    return intersect(triangles, A, B, true, I, it);
+}
+
+
+/**
+ * Intersects the infinite line (A,B) with the triangles; same as Triangulation::intersect().
+ * @param I the intersection point closest to A, on either side of A
+ */
+bool TriangleBVH::intersectLine(std::vector<Triangle3d> const &triangles, Vector3d const &A, Vector3d const &B, Node &I) const
+{
+    int it=-1;
+    return intersect(triangles, A, B, false, I, it);
+}
+
+
+/**
+ * Finds the triangle first intersected by the segment [A,B], e.g. to pick the triangle under the mouse
+ * with the segment from the near to the far plane of the view.
+ * @param I the intersection point closest to A, with the normal of the intersected triangle
+ * @return the index of the triangle in the list, or -1 if the segment does not intersect the triangles
+ */
+int TriangleBVH::nearestTriangle(std::vector<Triangle3d> const &triangles, Vector3d const &A, Vector3d const &B, Node &I) const
+{
+    int it=-1;
+    intersect(triangles, A, B, true, I, it);
+    return it;
+}
+
+
+/**
+ * Intersects a batch of segments [A_i,B_i] with the triangles.
+ * @return the number of segments which intersect the triangles
+ */
+int TriangleBVH::intersectSegments(std::vector<Triangle3d> const &triangles, int nSegs, Vector3d const *A, Vector3d const *B, Node *I,
+                                   bool *bIntersect, bool bMultiThreaded) const
+{
+    if(bMultiThreaded)
+    {
+        int nBlocks = std::min(nSegs, ThreadPool::nBlocks(ThreadPool::maxThreadCount()));
+        ThreadPool::pool().parallelFor(nBlocks, [&](int iBlock)
+        {
+            int iStart = iBlock*nSegs/nBlocks;
+            int iMax   = (iBlock+1)*nSegs/nBlocks;
+            int it=-1;
+            for(int i=iStart; i<iMax; i++) bIntersect[i] = intersect(triangles, A[i], B[i], true, I[i], it);
+        });
+    }
+    else
+    {
+        int it=-1;
+        for(int i=0; i<nSegs; i++) bIntersect[i] = intersect(triangles, A[i], B[i], true, I[i], it);
+    }
+
+    int nHits = 0;
+    for(int i=0; i<nSegs; i++) if(bIntersect[i]) nHits++;
+    return nHits;
+}
+
+
+/**
+ * Lists the triangles whose leaf boxes overlap the box [boxmin, boxmax], i.e. the candidates for the
+ * intersection or the contact with an object inside the box. The list is not sorted.
+ */
+void TriangleBVH::overlappingTriangles(Vector3d const &boxmin, Vector3d const &boxmax, std::vector<int> &list) const
+{
+    list.clear();
+    if(m_Node.empty()) return;
+
+    int stack[128];
+    int nstack = 0;
+    stack[nstack++] = 0;
+
+    while(nstack>0)
+    {
+        BVHNode const &node = m_Node.at(stack[--nstack]);
+
+        if(node.m_Max.x<boxmin.x || node.m_Min.x>boxmax.x) continue;
+        if(node.m_Max.y<boxmin.y || node.m_Min.y>boxmax.y) continue;
+        if(node.m_Max.z<boxmin.z || node.m_Min.z>boxmax.z) continue;
+
+        if(node.m_Count>0)
+        {
+            for(int i=node.m_First; i<node.m_First+node.m_Count; i++) list.push_back(m_Index.at(i));
+            continue;
+        }
+
+        stack[nstack++] = node.m_First;
+        stack[nstack++] = int(&node-m_Node.data())+1;
+    }
+}
+
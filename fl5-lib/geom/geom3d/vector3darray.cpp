@@ -0,0 +1,246 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#include <cmath>
+
+#include <vector3darray.h>
+#include <cartesianframe.h>
+#include <constants.h>
+
+
+/**
+ * Fills the row-major matrix of the rotation about the axis R by the angle in degrees,
+ * with the same convention as Vector3d::rotate(); the axis is not normalized.
+ */
+template <typename T>
+void Vector3Array<T>::rotationMatrix(Vector3d const &R, double angle, double *M)
+{
+    double ca = cos(angle *PI/180.0);
+    double sa = sin(angle *PI/180.0);
+    double ux = R.x, uy = R.y, uz = R.z;
+
+    M[0] =  ca+ux*ux*(1-ca);      M[1] = ux*uy*(1-ca)-uz*sa;    M[2] = ux*uz*(1-ca)+uy*sa;
+    M[3] = uy*ux*(1-ca)+uz*sa;    M[4] =  ca+uy*uy*(1-ca);      M[5] = uy*uz*(1-ca)-ux*sa;
+    M[6] = uz*ux*(1-ca)-uy*sa;    M[7] = uz*uy*(1-ca)+ux*sa;    M[8] =  ca+uz*uz*(1-ca);
+}
+
+
+template <typename T>
+void Vector3Array<T>::translate(double tx, double ty, double tz)
+{
+    T *px = m_x.data(), *py = m_y.data(), *pz = m_z.data();
+    T const ax=T(tx), ay=T(ty), az=T(tz);
+    int const n = size();
+    for(int i=0; i<n; i++) px[i] += ax;
+    for(int i=0; i<n; i++) py[i] += ay;
+    for(int i=0; i<n; i++) pz[i] += az;
+}
+
+
+template <typename T>
+void Vector3Array<T>::scale(double sx, double sy, double sz)
+{
+    T *px = m_x.data(), *py = m_y.data(), *pz = m_z.data();
+    T const ax=T(sx), ay=T(sy), az=T(sz);
+    int const n = size();
+    for(int i=0; i<n; i++) px[i] *= ax;
+    for(int i=0; i<n; i++) py[i] *= ay;
+    for(int i=0; i<n; i++) pz[i] *= az;
+}
+
+
+/** Multiplies each vector by the row-major 3x3 matrix M */
+template <typename T>
+void Vector3Array<T>::transform(double const *M)
+{
+    T *__restrict px = m_x.data();
+    T *__restrict py = m_y.data();
+    T *__restrict pz = m_z.data();
+    T const m0=T(M[0]), m1=T(M[1]), m2=T(M[2]);
+    T const m3=T(M[3]), m4=T(M[4]), m5=T(M[5]);
+    T const m6=T(M[6]), m7=T(M[7]), m8=T(M[8]);
+    int const n = size();
+    for(int i=0; i<n; i++)
+    {
+        T const x0=px[i], y0=py[i], z0=pz[i];
+        px[i] = m0*x0 + m1*y0 + m2*z0;
+        py[i] = m3*x0 + m4*y0 + m5*z0;
+        pz[i] = m6*x0 + m7*y0 + m8*z0;
+    }
+}
+
+
+/** Rotates the vectors about the axis R by the angle in degrees, as Vector3d::rotate(R, angle) */
+template <typename T>
+void Vector3Array<T>::rotate(Vector3d const &R, double angle)
+{
+    double M[9];
+    rotationMatrix(R, angle, M);
+    transform(M);
+}
+
+
+/** Rotates the points about the axis R through O by the angle in degrees, as Vector3d::rotate(O, R, angle) */
+template <typename T>
+void Vector3Array<T>::rotate(Vector3d const &O, Vector3d const &R, double angle)
+{
+    if(fabs(R.norm())<0.00001) return;
+    translate(-O.x, -O.y, -O.z);
+    rotate(R, angle);
+    translate(O.x, O.y, O.z);
+}
+
+
+/** this = this + a.V */
+template <typename T>
+void Vector3Array<T>::addScaled(double a, Vector3Array const &V)
+{
+    T const ta = T(a);
+    int const n = std::min(size(), V.size());
+    T *px = m_x.data(), *py = m_y.data(), *pz = m_z.data();
+    T const *vx = V.m_x.data(), *vy = V.m_y.data(), *vz = V.m_z.data();
+    for(int i=0; i<n; i++) px[i] += ta*vx[i];
+    for(int i=0; i<n; i++) py[i] += ta*vy[i];
+    for(int i=0; i<n; i++) pz[i] += ta*vz[i];
+}
+
+
+/** Converts the vectors to the frame's components; the vectors are directions, i.e. the origin is ignored */
+template <typename T>
+void Vector3Array<T>::globalToLocal(CartesianFrame const &frame)
+{
+    transform(frame.rotationMatrix());
+}
+
+
+/** Converts the frame's components to global vectors; the vectors are directions */
+template <typename T>
+void Vector3Array<T>::localToGlobal(CartesianFrame const &frame)
+{
+    Vector3d const &I = frame.Idir();
+    Vector3d const &J = frame.Jdir();
+    Vector3d const &K = frame.Kdir();
+    double const M[9] = {I.x, J.x, K.x,
+                         I.y, J.y, K.y,
+                         I.z, J.z, K.z};
+    transform(M);
+}
+
+
+template <typename T>
+void Vector3Array<T>::globalToLocalPosition(CartesianFrame const &frame)
+{
+    Vector3d const &O = frame.origin();
+    translate(-O.x, -O.y, -O.z);
+    globalToLocal(frame);
+}
+
+
+template <typename T>
+void Vector3Array<T>::localToGlobalPosition(CartesianFrame const &frame)
+{
+    localToGlobal(frame);
+    Vector3d const &O = frame.origin();
+    translate(O.x, O.y, O.z);
+}
+
+
+/** Fills the result array with the size() dot products of the vectors of this and V */
+template <typename T>
+void Vector3Array<T>::dot(Vector3Array const &V, T *__restrict result) const
+{
+    T const *px = m_x.data(), *py = m_y.data(), *pz = m_z.data();
+    T const *vx = V.m_x.data(), *vy = V.m_y.data(), *vz = V.m_z.data();
+    int const n = std::min(size(), V.size());
+    for(int i=0; i<n; i++)
+        result[i] = px[i]*vx[i] + py[i]*vy[i] + pz[i]*vz[i];
+}
+
+
+/** result = this x V; result is resized and may not be this or V */
+template <typename T>
+void Vector3Array<T>::cross(Vector3Array const &V, Vector3Array &result) const
+{
+    int const n = std::min(size(), V.size());
+    result.resize(n);
+    T const *px = m_x.data(), *py = m_y.data(), *pz = m_z.data();
+    T const *vx = V.m_x.data(), *vy = V.m_y.data(), *vz = V.m_z.data();
+    T *__restrict rx = result.m_x.data();
+    T *__restrict ry = result.m_y.data();
+    T *__restrict rz = result.m_z.data();
+    for(int i=0; i<n; i++)
+    {
+        rx[i] = py[i]*vz[i] - pz[i]*vy[i];
+        ry[i] = pz[i]*vx[i] - px[i]*vz[i];
+        rz[i] = px[i]*vy[i] - py[i]*vx[i];
+    }
+}
+
+
+template <typename T>
+void Vector3Array<T>::norm(T *__restrict result) const
+{
+    T const *px = m_x.data(), *py = m_y.data(), *pz = m_z.data();
+    int const n = size();
+    for(int i=0; i<n; i++)
+        result[i] = std::sqrt(px[i]*px[i] + py[i]*py[i] + pz[i]*pz[i]);
+}
+
+
+/** Normalizes the vectors; the null vectors are left unchanged */
+template <typename T>
+void Vector3Array<T>::normalize()
+{
+    T *px = m_x.data(), *py = m_y.data(), *pz = m_z.data();
+    int const n = size();
+    for(int i=0; i<n; i++)
+    {
+        T const l = std::sqrt(px[i]*px[i] + py[i]*py[i] + pz[i]*pz[i]);
+        T const s = l>T(0) ? T(1)/l : T(1);
+        px[i] *= s;
+        py[i] *= s;
+        pz[i] *= s;
+    }
+}
+
+
+/** Writes the vectors as x,y,z float triplets, i.e. in the layout of the OpenGL vertex buffers */
+template <typename T>
+void Vector3Array<T>::interleave(float *__restrict xyz) const
+{
+    T const *px = m_x.data(), *py = m_y.data(), *pz = m_z.data();
+    int const n = size();
+    for(int i=0; i<n; i++)
+    {
+        xyz[3*i  ] = float(px[i]);
+        xyz[3*i+1] = float(py[i]);
+        xyz[3*i+2] = float(pz[i]);
+    }
+}
+
+
+template class Vector3Array<double>;
+template class Vector3Array<float>;
@@ -773,9 +773,91 @@ double geom::basisDerivative(int i, int deg, double t, double const *knots)
 }
 
 
+/**
+ * Returns the index s of the knot span such that knots[s]<=t<knots[s+1], or -1 if all the basis functions are zero at t.
+ * Assumes a clamped knot vector of size nCtrl+deg+1.
+ */
+int geom::knotSpan(std::vector<double> const &knots, int nCtrl, int deg, double t)
+{
+    if(t<knots.at(deg) || t>=knots.at(nCtrl)) return -1;
+    int lo = deg, hi = nCtrl;
+    while(hi-lo>1)
+    {
+        int mid = (lo+hi)/2;
+        if(t<knots.at(mid)) hi = mid;
+        else                lo = mid;
+    }
+    return lo;
+}
+
+
+/**
+ * Same as knotSpan(), starting the search from the span sPrevious of the last evaluation.
+ * For increasing values of t the span is found by stepping forward, so that a sorted
+ * sequence of n parameters is processed in O(n + number of knots).
+ */
+int geom::knotSpan(std::vector<double> const &knots, int nCtrl, int deg, double t, int sPrevious)
+{
+    if(sPrevious<deg || sPrevious>=nCtrl || t<knots.at(sPrevious)) return knotSpan(knots, nCtrl, deg, t);
+    if(t>=knots.at(nCtrl)) return -1;
+    int s = sPrevious;
+    while(t>=knots.at(s+1)) s++;
+    return s;
+}
+
+
+/**
+ * Computes the deg+1 basis functions N_{s-deg,deg}...N_{s,deg} which are non-zero in the knot span s.
+ * This is the non-recursive form of the Cox-de Boor formula.
+ */
+void geom::spanBasis(double const *knots, int s, int deg, double t, double *N)
+{
+    double left[MAXSPANDEGREE+1], right[MAXSPANDEGREE+1];
+    N[0] = 1.0;
+    for(int j=1; j<=deg; j++)
+    {
+        left[j]  = t-knots[s+1-j];
+        right[j] = knots[s+j]-t;
+        double saved = 0.0;
+        for(int r=0; r<j; r++)
+        {
+            double temp = N[r]/(right[r+1]+left[j-r]);
+            N[r] = saved + right[r+1]*temp;
+            saved = left[j-r]*temp;
+        }
+        N[j] = saved;
+    }
+}
+
+
+/** Computes the derivatives of the deg+1 basis functions which are non-zero in the knot span s */
+void geom::spanBasisDerivative(double const *knots, int s, int deg, double t, double *dN)
+{
+    for(int a=0; a<=deg; a++) dN[a] = 0.0;
+    if(deg==0) return;
+
+    double N1[MAXSPANDEGREE+1];
+    spanBasis(knots, s, deg-1, t, N1); // N_{s-deg+1,deg-1}...N_{s,deg-1}
+
+    for(int a=0; a<=deg; a++)
+    {
+        int i = s-deg+a;
+        if(a>=1 && fabs(knots[i+deg]-knots[i])>KNOTPRECISION)
+            dN[a] += double(deg)/(knots[i+deg]-knots[i]) * N1[a-1];
+        if(a<deg && fabs(knots[i+deg+1]-knots[i+1])>KNOTPRECISION)
+            dN[a] -= double(deg)/(knots[i+deg+1]-knots[i+1]) * N1[a];
+    }
+}
+
+
 void geom::makeNurbsTriangulation(NURBSSurface const &nurbs, int nx, int nh, std::vector<Triangle3d> &triangles)
 {
-    Vector3d S00, S01, S10, S11;
+    // evaluate the grid of nodes in one pass
+    std::vector<double> u(nx+1), v(nh+1);
+    for(int k=0; k<=nx; k++) u[k] = double(k)/double(nx);
+    for(int l=0; l<=nh; l++) v[l] = double(l)/double(nh);
+    std::vector<Vector3d> grid;
+    nurbs.getGrid(u, v, grid);
 
     // make the left side
     triangles.resize(nx*nh*2);
@@ -783,26 +865,17 @@ void geom::makeNurbsTriangulation(NURBSSurface const &nurbs, int nx, int nh, std
     int it=0;
     for (int k=0; k<nx; k++)
     {
-        double uk  = double(k)   /double(nx);
-        double uk1 = double(k+1) /double(nx);
-
-        double vl=0.0;
-        nurbs.getPoint(uk,  vl, S00);
-        nurbs.getPoint(uk1, vl, S10);
-
         for (int l=0; l<nh; l++)
         {
-            double vl1 = double(l+1) / double(nh);
-            nurbs.getPoint(uk,  vl1, S01);
-            nurbs.getPoint(uk1, vl1, S11);
+            Vector3d const &S00 = grid.at( k   *(nh+1)+l);
+            Vector3d const &S10 = grid.at((k+1)*(nh+1)+l);
+            Vector3d const &S01 = grid.at( k   *(nh+1)+l+1);
+            Vector3d const &S11 = grid.at((k+1)*(nh+1)+l+1);
 
             if(!S00.isSame(S01) && !S01.isSame(S11) && !S11.isSame(S00))
                 triangles[it++] = {S00, S01, S11};
             if(!S00.isSame(S11) && !S11.isSame(S10) && !S10.isSame(S00))
                 triangles[it++] = {S00, S11, S10};
-            S00 = S01;
-            S10 = S11;
-//            vl = vl1;
         }
     }
     //squeeze
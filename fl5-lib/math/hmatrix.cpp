@@ -0,0 +1,481 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <hmatrix.h>
+#include <threadpool.h>
+
+
+HMatrix::HMatrix()
+{
+    m_Tolerance = 1.0e-5;
+    m_Eta       = 2.0;
+    m_LeafSize  = 32;
+}
+
+
+void HMatrix::clear()
+{
+    m_RowPerm.clear();
+    m_ColPerm.clear();
+    m_RowTree.clear();
+    m_ColTree.clear();
+    m_Block.clear();
+}
+
+
+/**
+ * Builds the cluster trees, the block partition and the block approximations.
+ * @param rowpts the points associated to the rows, e.g. the collocation points.
+ * @param colpts the points associated to the columns, e.g. the panel centroids.
+ * @param coef the callback returning the coefficient of the matrix in row i and column j, in the original ordering.
+ * @return false if there is nothing to build.
+ */
+bool HMatrix::build(std::vector<Vector3d> const &rowpts, std::vector<Vector3d> const &colpts,
+                    std::function<double(int,int)> const &coef)
+{
+    clear();
+    if(rowpts.empty() || colpts.empty()) return false;
+
+    makeClusterTree(rowpts, m_RowPerm, m_RowTree);
+    makeClusterTree(colpts, m_ColPerm, m_ColTree);
+
+    makeBlockTree(0,0);
+
+    // the blocks are independent; the large ones first for a better balance
+    std::vector<int> order(m_Block.size());
+    for(int ib=0; ib<int(order.size()); ib++) order[ib] = ib;
+    std::sort(order.begin(), order.end(), [this](int a, int b)
+    {
+        return size_t(m_RowTree.at(m_Block.at(a).m_RowCluster).size())*size_t(m_ColTree.at(m_Block.at(a).m_ColCluster).size())
+             > size_t(m_RowTree.at(m_Block.at(b).m_RowCluster).size())*size_t(m_ColTree.at(m_Block.at(b).m_ColCluster).size());
+    });
+
+    ThreadPool::pool().parallelFor(int(order.size()), [this, &order, &coef](int i)
+    {
+        fillBlock(m_Block[order.at(i)], coef);
+    });
+
+    return true;
+}
+
+
+void HMatrix::makeClusterTree(std::vector<Vector3d> const &pts, std::vector<int> &perm, std::vector<Cluster> &tree) const
+{
+    int n = int(pts.size());
+    perm.resize(n);
+    for(int i=0; i<n; i++) perm[i] = i;
+    tree.clear();
+    tree.reserve(2*(n/std::max(m_LeafSize/2,1)+1));
+    splitCluster(pts, perm, tree, 0, n);
+}
+
+
+/** Creates the cluster of the points [first, last[ and recursively splits it along the largest dimension of its box */
+int HMatrix::splitCluster(std::vector<Vector3d> const &pts, std::vector<int> &perm, std::vector<Cluster> &tree, int first, int last) const
+{
+    int ic = int(tree.size());
+    tree.push_back(Cluster());
+
+    Cluster c;
+    c.m_First = first;
+    c.m_Last  = last;
+    c.m_BoxMin = c.m_BoxMax = pts.at(perm.at(first));
+    for(int i=first+1; i<last; i++)
+    {
+        Vector3d const &pt = pts.at(perm.at(i));
+        c.m_BoxMin.set(std::min(c.m_BoxMin.x, pt.x), std::min(c.m_BoxMin.y, pt.y), std::min(c.m_BoxMin.z, pt.z));
+        c.m_BoxMax.set(std::max(c.m_BoxMax.x, pt.x), std::max(c.m_BoxMax.y, pt.y), std::max(c.m_BoxMax.z, pt.z));
+    }
+
+    if(last-first>m_LeafSize)
+    {
+        Vector3d ext = c.m_BoxMax-c.m_BoxMin;
+        int idim = 0;
+        if(ext.y>ext.x && ext.y>=ext.z) idim = 1;
+        else if(ext.z>ext.x && ext.z>ext.y) idim = 2;
+
+        int mid = (first+last)/2;
+        std::nth_element(perm.begin()+first, perm.begin()+mid, perm.begin()+last, [&pts, idim](int a, int b)
+        {
+            Vector3d pa = pts.at(a), pb = pts.at(b);
+            return pa[idim]<pb[idim];
+        });
+
+        c.m_Child[0] = splitCluster(pts, perm, tree, first, mid);
+        c.m_Child[1] = splitCluster(pts, perm, tree, mid, last);
+    }
+
+    tree[ic] = c;
+    return ic;
+}
+
+
+bool HMatrix::isAdmissible(Cluster const &rc, Cluster const &cc) const
+{
+    // distance between the two boxes
+    double d2 = 0.0;
+    double const rmin[] = {rc.m_BoxMin.x, rc.m_BoxMin.y, rc.m_BoxMin.z};
+    double const rmax[] = {rc.m_BoxMax.x, rc.m_BoxMax.y, rc.m_BoxMax.z};
+    double const cmin[] = {cc.m_BoxMin.x, cc.m_BoxMin.y, cc.m_BoxMin.z};
+    double const cmax[] = {cc.m_BoxMax.x, cc.m_BoxMax.y, cc.m_BoxMax.z};
+    for(int i=0; i<3; i++)
+    {
+        double gap = std::max(0.0, std::max(cmin[i]-rmax[i], rmin[i]-cmax[i]));
+        d2 += gap*gap;
+    }
+    double diam = std::min(rc.diameter(), cc.diameter());
+    return d2>0.0 && diam < m_Eta*sqrt(d2);
+}
+
+
+void HMatrix::makeBlockTree(int irc, int icc)
+{
+    Cluster const &rc = m_RowTree.at(irc);
+    Cluster const &cc = m_ColTree.at(icc);
+
+    if(isAdmissible(rc, cc) || (rc.isLeaf() && cc.isLeaf()))
+    {
+        Block b;
+        b.m_RowCluster = irc;
+        b.m_ColCluster = icc;
+        b.m_bLowRank = isAdmissible(rc, cc);
+        m_Block.push_back(b);
+        return;
+    }
+
+    if(rc.isLeaf() || (!cc.isLeaf() && cc.size()>rc.size()))
+    {
+        makeBlockTree(irc, cc.m_Child[0]);
+        makeBlockTree(irc, cc.m_Child[1]);
+    }
+    else if(cc.isLeaf())
+    {
+        makeBlockTree(rc.m_Child[0], icc);
+        makeBlockTree(rc.m_Child[1], icc);
+    }
+    else
+    {
+        for(int i=0; i<2; i++)
+            for(int j=0; j<2; j++)
+                makeBlockTree(rc.m_Child[i], cc.m_Child[j]);
+    }
+}
+
+
+void HMatrix::fillBlock(Block &block, std::function<double(int,int)> const &coef) const
+{
+    if(block.m_bLowRank)
+    {
+        if(ACA(block, coef)) return;
+        // not compressible enough, store in full
+        block.m_bLowRank = false;
+    }
+
+    Cluster const &rc = m_RowTree.at(block.m_RowCluster);
+    Cluster const &cc = m_ColTree.at(block.m_ColCluster);
+    int nr = rc.size();
+    int nc = cc.size();
+    block.m_U.clear();
+    block.m_V.clear();
+    block.m_Rank = 0;
+    block.m_D.resize(size_t(nr)*size_t(nc));
+    for(int i=0; i<nr; i++)
+    {
+        int row = m_RowPerm.at(rc.m_First+i);
+        for(int j=0; j<nc; j++)
+            block.m_D[size_t(i)*nc+j] = coef(row, m_ColPerm.at(cc.m_First+j));
+    }
+}
+
+
+/**
+ * Adaptive cross approximation with partial pivoting.
+ * The stopping criterion is |u_k|.|v_k| < tolerance x |S_k|, where S_k is the current approximation,
+ * whose Frobenius norm is updated incrementally.
+ * @return false if the rank needed to reach the tolerance makes the low-rank form larger than the full block.
+ */
+bool HMatrix::ACA(Block &block, std::function<double(int,int)> const &coef) const
+{
+    Cluster const &rc = m_RowTree.at(block.m_RowCluster);
+    Cluster const &cc = m_ColTree.at(block.m_ColCluster);
+    int nr = rc.size();
+    int nc = cc.size();
+    int maxrank = (nr*nc)/(nr+nc); // beyond this rank the full block is smaller
+
+    std::vector<double> &U = block.m_U;
+    std::vector<double> &V = block.m_V;
+    U.clear();
+    V.clear();
+    U.reserve(size_t(nr)*size_t(maxrank));
+    V.reserve(size_t(nc)*size_t(maxrank));
+
+    std::vector<bool> bUsedRow(nr, false);
+    std::vector<double> row(nc), col(nr);
+    double norm2S = 0.0;
+    int istar = 0;
+    int k = 0;
+
+    while(k<maxrank)
+    {
+        // the residual of row istar
+        bUsedRow[istar] = true;
+        int irow = m_RowPerm.at(rc.m_First+istar);
+        for(int j=0; j<nc; j++) row[j] = coef(irow, m_ColPerm.at(cc.m_First+j));
+        for(int l=0; l<k; l++)
+        {
+            double ul = U[size_t(l)*nr+istar];
+            double const *vl = V.data()+size_t(l)*nc;
+            for(int j=0; j<nc; j++) row[j] -= ul*vl[j];
+        }
+
+        int jstar = 0;
+        for(int j=1; j<nc; j++) if(fabs(row[j])>fabs(row[jstar])) jstar = j;
+
+        if(fabs(row[jstar])<1.0e-30)
+        {
+            // this row is already exactly represented; try the next unused one
+            istar = -1;
+            for(int i=0; i<nr; i++) if(!bUsedRow[i]) {istar=i; break;}
+            if(istar<0) break;
+            continue;
+        }
+
+        double pivot = row[jstar];
+        for(int j=0; j<nc; j++) row[j] /= pivot;
+
+        // the residual of column jstar
+        int icol = m_ColPerm.at(cc.m_First+jstar);
+        for(int i=0; i<nr; i++) col[i] = coef(m_RowPerm.at(rc.m_First+i), icol);
+        for(int l=0; l<k; l++)
+        {
+            double vl = V[size_t(l)*nc+jstar];
+            double const *ul = U.data()+size_t(l)*nr;
+            for(int i=0; i<nr; i++) col[i] -= vl*ul[i];
+        }
+
+        double norm2u=0.0, norm2v=0.0;
+        for(int i=0; i<nr; i++) norm2u += col[i]*col[i];
+        for(int j=0; j<nc; j++) norm2v += row[j]*row[j];
+
+        for(int l=0; l<k; l++)
+        {
+            double uu=0.0, vv=0.0;
+            double const *ul = U.data()+size_t(l)*nr;
+            double const *vl = V.data()+size_t(l)*nc;
+            for(int i=0; i<nr; i++) uu += col[i]*ul[i];
+            for(int j=0; j<nc; j++) vv += row[j]*vl[j];
+            norm2S += 2.0*uu*vv;
+        }
+        norm2S += norm2u*norm2v;
+
+        U.insert(U.end(), col.begin(), col.end());
+        V.insert(V.end(), row.begin(), row.end());
+        k++;
+
+        if(norm2u*norm2v <= m_Tolerance*m_Tolerance*norm2S) break;
+
+        // next pivot row: the largest entry of the new column among the unused rows
+        istar = -1;
+        for(int i=0; i<nr; i++)
+        {
+            if(bUsedRow[i]) continue;
+            if(istar<0 || fabs(col[i])>fabs(col[istar])) istar = i;
+        }
+        if(istar<0) break;
+    }
+
+    if(k>=maxrank) return false;
+
+    block.m_Rank = k;
+    U.shrink_to_fit();
+    V.shrink_to_fit();
+    return true;
+}
+
+
+/** y = A.x, in the original ordering */
+/**
+ * Adds to the nAgg x nAgg row-major matrix Ac the sums of the coefficients over each pair of row and column aggregates,
+ * i.e. the Galerkin product R.A.P with piecewise constant transfer operators.
+ * The low-rank blocks are summed through their factors, so that the cost is that of one matrix-vector product.
+ * @param rowagg the aggregate of each row, in the original ordering
+ * @param colagg the aggregate of each column, in the original ordering
+ */
+void HMatrix::addAggregatedMatrix(std::vector<int> const &rowagg, std::vector<int> const &colagg, int nAgg, double *Ac) const
+{
+    std::vector<int> rowlocal(nAgg, -1), collocal(nAgg, -1);
+    std::vector<int> rowlist, collist;
+    std::vector<double> Uc, Vc;
+
+    for(Block const &b : m_Block)
+    {
+        Cluster const &rc = m_RowTree.at(b.m_RowCluster);
+        Cluster const &cc = m_ColTree.at(b.m_ColCluster);
+        int nbr = rc.size();
+        int nbc = cc.size();
+
+        if(b.m_bLowRank)
+        {
+            // the aggregated factors, one row per distinct aggregate of the block
+            rowlist.clear();
+            collist.clear();
+            for(int i=0; i<nbr; i++)
+            {
+                int I = rowagg.at(m_RowPerm.at(rc.m_First+i));
+                if(rowlocal.at(I)<0) {rowlocal[I] = int(rowlist.size()); rowlist.push_back(I);}
+            }
+            for(int j=0; j<nbc; j++)
+            {
+                int K = colagg.at(m_ColPerm.at(cc.m_First+j));
+                if(collocal.at(K)<0) {collocal[K] = int(collist.size()); collist.push_back(K);}
+            }
+
+            int nri = int(rowlist.size());
+            int nci = int(collist.size());
+            Uc.assign(size_t(nri)*b.m_Rank, 0.0);
+            Vc.assign(size_t(nci)*b.m_Rank, 0.0);
+            for(int l=0; l<b.m_Rank; l++)
+            {
+                double const *ul = b.m_U.data()+size_t(l)*nbr;
+                double const *vl = b.m_V.data()+size_t(l)*nbc;
+                for(int i=0; i<nbr; i++) Uc[size_t(rowlocal.at(rowagg.at(m_RowPerm.at(rc.m_First+i))))*b.m_Rank+l] += ul[i];
+                for(int j=0; j<nbc; j++) Vc[size_t(collocal.at(colagg.at(m_ColPerm.at(cc.m_First+j))))*b.m_Rank+l] += vl[j];
+            }
+
+            for(int ii=0; ii<nri; ii++)
+            {
+                double *Ai = Ac + size_t(rowlist.at(ii))*size_t(nAgg);
+                for(int jj=0; jj<nci; jj++)
+                {
+                    double sum = 0.0;
+                    for(int l=0; l<b.m_Rank; l++) sum += Uc.at(size_t(ii)*b.m_Rank+l)*Vc.at(size_t(jj)*b.m_Rank+l);
+                    Ai[collist.at(jj)] += sum;
+                }
+            }
+
+            for(int I : rowlist) rowlocal[I] = -1;
+            for(int K : collist) collocal[K] = -1;
+        }
+        else
+        {
+            for(int i=0; i<nbr; i++)
+            {
+                double const *di = b.m_D.data()+size_t(i)*nbc;
+                double *Ai = Ac + size_t(rowagg.at(m_RowPerm.at(rc.m_First+i)))*size_t(nAgg);
+                for(int j=0; j<nbc; j++) Ai[colagg.at(m_ColPerm.at(cc.m_First+j))] += di[j];
+            }
+        }
+    }
+}
+
+
+void HMatrix::matVec(double const *x, double *y) const
+{
+    int nr = nRows();
+    int nc = nCols();
+
+    std::vector<double> xp(nc);
+    for(int j=0; j<nc; j++) xp[j] = x[m_ColPerm.at(j)];
+
+    // each task accumulates its share of the blocks in its own vector
+    int nTasks = std::max(1, std::min(ThreadPool::nBlocks(ThreadPool::maxThreadCount()), int(m_Block.size())));
+    std::vector<std::vector<double>> yp(nTasks, std::vector<double>(nr, 0.0));
+
+    ThreadPool::pool().parallelFor(nTasks, [this, nTasks, &xp, &yp](int iTask)
+    {
+        std::vector<double> &y = yp[iTask];
+        std::vector<double> t;
+        for(int ib=iTask; ib<int(m_Block.size()); ib+=nTasks)
+        {
+            Block const &b = m_Block.at(ib);
+            Cluster const &rc = m_RowTree.at(b.m_RowCluster);
+            Cluster const &cc = m_ColTree.at(b.m_ColCluster);
+            int nbr = rc.size();
+            int nbc = cc.size();
+            double const *xb = xp.data()+cc.m_First;
+            double *yb = y.data()+rc.m_First;
+            if(b.m_bLowRank)
+            {
+                t.assign(b.m_Rank, 0.0);
+                for(int l=0; l<b.m_Rank; l++)
+                {
+                    double const *vl = b.m_V.data()+size_t(l)*nbc;
+                    for(int j=0; j<nbc; j++) t[l] += vl[j]*xb[j];
+                }
+                for(int l=0; l<b.m_Rank; l++)
+                {
+                    double const *ul = b.m_U.data()+size_t(l)*nbr;
+                    for(int i=0; i<nbr; i++) yb[i] += ul[i]*t[l];
+                }
+            }
+            else
+            {
+                for(int i=0; i<nbr; i++)
+                {
+                    double const *di = b.m_D.data()+size_t(i)*nbc;
+                    double sum = 0.0;
+                    for(int j=0; j<nbc; j++) sum += di[j]*xb[j];
+                    yb[i] += sum;
+                }
+            }
+        }
+    });
+
+    for(int i=0; i<nr; i++)
+    {
+        double sum = 0.0;
+        for(int it=0; it<nTasks; it++) sum += yp[it][i];
+        y[m_RowPerm.at(i)] = sum;
+    }
+}
+
+
+/** @return the memory used by the block approximations, in bytes */
+size_t HMatrix::memorySize() const
+{
+    size_t mem = 0;
+    for(Block const &b : m_Block)
+        mem += (b.m_U.size() + b.m_V.size() + b.m_D.size())*sizeof(double);
+    return mem;
+}
+
+
+int HMatrix::nLowRankBlocks() const
+{
+    int n=0;
+    for(Block const &b : m_Block) if(b.m_bLowRank) n++;
+    return n;
+}
+
+
+int HMatrix::nFullBlocks() const
+{
+    return int(m_Block.size())-nLowRankBlocks();
+}
+
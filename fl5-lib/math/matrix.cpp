@@ -28,6 +28,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <algorithm>
 #include <cassert>
 #include <thread>
 
@@ -1585,6 +1586,19 @@ int matrix::solveLinearSystem(int rank, float *M, int nrhs, float *rhs, int nThr
 
 
 int matrix::solveLinearSystem(int rank, double *M, int nrhs, double *rhs, int nThreads)
+{
+    std::vector<int> ipiv;
+    int info = LUfactorize(rank, M, ipiv, nThreads);
+    if(info!=0) return info;
+    return LUbackSubstitute(rank, M, ipiv, nrhs, rhs);
+}
+
+
+/**
+ * Factorizes in place the row major matrix M of size rank x rank.
+ * @return the LAPACK info value, i.e. 0 if successful.
+ */
+int matrix::LUfactorize(int rank, double *M, std::vector<int> &ipiv, int nThreads)
 {
 #ifdef INTEL_MKL
     if(nThreads>0)
@@ -1596,21 +1610,131 @@ int matrix::solveLinearSystem(int rank, double *M, int nrhs, double *rhs, int nT
     (void)nThreads;
 #endif
 
-    // LAPACK methods are implemented in column-major order so use the transpose matrix
-    char trans = 'T';
-    lapack_int nl=0, lda=0, ldb=0, info=0;
-    std::vector<lapack_int> ipiv(rank);
+    // LAPACK methods are implemented in column-major order so factorize the transpose matrix
+    lapack_int nl = rank;
+    lapack_int lda = rank;
+    lapack_int info = 0;
+    ipiv.resize(rank);
 
-    nl = rank;
-    lda = rank;
+    dgetrf_(&nl, &nl, M, &lda, reinterpret_cast<lapack_int*>(ipiv.data()), &info);
 
-    dgetrf_(&nl, &nl, M, &lda, ipiv.data(), &info);
+    return int(info);
+}
 
-    if(info>0 || info <0)
+
+namespace
+{
+    inline void getrf(lapack_int m, lapack_int n, double *A, lapack_int lda, lapack_int *ipiv, lapack_int &info) {dgetrf_(&m, &n, A, &lda, ipiv, &info);}
+    inline void getrf(lapack_int m, lapack_int n, float  *A, lapack_int lda, lapack_int *ipiv, lapack_int &info) {sgetrf_(&m, &n, A, &lda, ipiv, &info);}
+
+    /** B = L^-1.B with L the unit lower triangle of A */
+    inline void trsm(int m, int n, double const *A, int lda, double *B, int ldb)
     {
-//        xfl::trace("dgetrf_ error:",info);
-        return int(info);
+        cblas_dtrsm(CblasColMajor, CblasLeft, CblasLower, CblasNoTrans, CblasUnit, m, n, 1.0, A, lda, B, ldb);
+    }
+    inline void trsm(int m, int n, float const *A, int lda, float *B, int ldb)
+    {
+        cblas_strsm(CblasColMajor, CblasLeft, CblasLower, CblasNoTrans, CblasUnit, m, n, 1.0f, A, lda, B, ldb);
+    }
+
+    /** C = C - A.B */
+    inline void gemm(int m, int n, int k, double const *A, int lda, double const *B, int ldb, double *C, int ldc)
+    {
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, m, n, k, -1.0, A, lda, B, ldb, 1.0, C, ldc);
     }
+    inline void gemm(int m, int n, int k, float const *A, int lda, float const *B, int ldb, float *C, int ldc)
+    {
+        cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, m, n, k, -1.0f, A, lda, B, ldb, 1.0f, C, ldc);
+    }
+
+    /** Applies the row interchanges ipiv[i0..i1[, 1-based, to the columns c0 to c1-1 */
+    template<typename T>
+    void swapRows(T *M, int lda, int const *ipiv, int i0, int i1, int c0, int c1)
+    {
+        for(int c=c0; c<c1; c++)
+        {
+            T *col = M + size_t(c)*size_t(lda);
+            for(int i=i0; i<i1; i++)
+            {
+                int p = ipiv[i]-1;
+                if(p!=i) std::swap(col[i], col[p]);
+            }
+        }
+    }
+
+    /**
+     * The right-looking blocked LU of LAPACK's getrf, written out so that the cancellation can be polled between two panels.
+     * Each panel is factorized by getrf, and the trailing matrix is updated by trsm and gemm, so that the
+     * factors and the pivots are those of a direct call to getrf with the same block size.
+     */
+    template<typename T>
+    int blockedLU(int n, T *M, int *ipiv, std::function<bool()> const &isCancelled, int nb)
+    {
+        size_t lda = size_t(n);
+        int info = 0;
+        for(int j=0; j<n; j+=nb)
+        {
+            if(isCancelled && isCancelled()) return -1;
+
+            int jb = std::min(nb, n-j);
+            T *Ajj = M + size_t(j) + size_t(j)*lda;
+
+            // factorize the panel A[j:n, j:j+jb]
+            lapack_int iinfo = 0;
+            getrf(n-j, jb, Ajj, lapack_int(n), reinterpret_cast<lapack_int*>(ipiv+j), iinfo);
+            if(info==0 && iinfo>0) info = int(iinfo)+j;
+            for(int i=j; i<j+jb; i++) ipiv[i] += j;
+
+            // apply the interchanges to the columns on the left and on the right of the panel
+            swapRows(M, n, ipiv, j, j+jb, 0, j);
+            if(j+jb<n)
+            {
+                swapRows(M, n, ipiv, j, j+jb, j+jb, n);
+
+                T *Ajr = M + size_t(j)    + size_t(j+jb)*lda;   // the block row of U
+                T *Alj = M + size_t(j+jb) + size_t(j)*lda;      // the block column of L
+                T *Arr = M + size_t(j+jb) + size_t(j+jb)*lda;   // the trailing matrix
+                trsm(jb, n-j-jb, Ajj, n, Ajr, n);
+                gemm(n-j-jb, n-j-jb, jb, Alj, n, Ajr, n, Arr, n);
+            }
+        }
+        return info;
+    }
+}
+
+
+/**
+ * Factorizes in place the matrix M of size rank x rank, with the same layout and the same pivots as LAPACK's getrf,
+ * and calls isCancelled() before each block of columns, so that the factorization of a large matrix can be interrupted
+ * within the time of one trailing update rather than that of the whole factorization.
+ * @return the LAPACK info value, i.e. 0 if successful, or -1 if the factorization was interrupted.
+ */
+int matrix::LUfactorizeBlocked(int rank, double *M, int *ipiv, std::function<bool()> const &isCancelled, int blockSize)
+{
+    return blockedLU(rank, M, ipiv, isCancelled, std::max(16, blockSize));
+}
+
+
+int matrix::LUfactorizeBlocked(int rank, float *M, int *ipiv, std::function<bool()> const &isCancelled, int blockSize)
+{
+    return blockedLU(rank, M, ipiv, isCancelled, std::max(16, blockSize));
+}
+
+
+/**
+ * Solves the nrhs systems with the LU factors made by LUfactorize().
+ * The rhs vectors are stored one after the other and are overwritten by the solutions.
+ * @return the LAPACK info value, i.e. 0 if successful.
+ */
+int matrix::LUbackSubstitute(int rank, double const *LU, std::vector<int> const &ipiv, int nrhs, double *rhs)
+{
+    char trans = 'T';
+    lapack_int nl = rank;
+    lapack_int lda = rank;
+    lapack_int ldb = 1;
+    lapack_int info = 0;
+    double *M = const_cast<double*>(LU);
+    lapack_int *piv = const_cast<lapack_int*>(reinterpret_cast<lapack_int const*>(ipiv.data()));
 
     // apparently LAPACK expects rhs to be row major same as the matrix
     // so need to perform back substitutions one at a time
@@ -1618,14 +1742,13 @@ int matrix::solveLinearSystem(int rank, double *M, int nrhs, double *rhs, int nT
     {
         ldb = 1;
 #ifdef OPENBLAS
-        dgetrs_(&trans, &nl, &ldb, M, &lda, ipiv.data(), rhs+k*rank, &nl, &info, 1);
+        dgetrs_(&trans, &nl, &ldb, M, &lda, piv, rhs+k*rank, &nl, &info, 1);
 #elif defined INTEL_MKL
-        dgetrs_(&trans, &nl, &ldb, M, &lda, ipiv.data(), rhs+k*rank, &nl, &info);
+        dgetrs_(&trans, &nl, &ldb, M, &lda, piv, rhs+k*rank, &nl, &info);
 #elif defined ACCELERATE
-        dgetrs_(&trans, &nl, &ldb, M, &lda, ipiv.data(), rhs+k*rank, &nl, &info);
+        dgetrs_(&trans, &nl, &ldb, M, &lda, piv, rhs+k*rank, &nl, &info);
 #endif
 
-
         if(info!=0)
         {
 //            xfl::trace("dgetrs_ error:",info);
@@ -1844,3 +1967,117 @@ void matrix::matVecMult(double const *A, double const *V, double *res, int nRows
 
 
 
+
+
+int matrix::GMRES(int n, std::function<void(double const*, double*)> const &matvec,
+                  std::function<void(double*)> const &precond,
+                  double const *b, double *x, int restart, int maxiter, double tolerance, double &residual)
+{
+    restart = std::max(1, std::min(restart, n));
+
+    double bnorm = 0.0;
+    for(int i=0; i<n; i++) bnorm += b[i]*b[i];
+    bnorm = sqrt(bnorm);
+    if(bnorm<PRECISION)
+    {
+        memset(x, 0, n*sizeof(double));
+        residual = 0.0;
+        return 0;
+    }
+
+    std::vector<double> V(size_t(n)*size_t(restart+1)); // the Krylov basis, one vector after the other
+    std::vector<double> Z(size_t(n)*size_t(restart));   // the preconditioned basis vectors
+    std::vector<double> H(size_t(restart+1)*size_t(restart), 0.0); // the Hessenberg matrix, column-wise
+    std::vector<double> cs(restart), sn(restart), g(restart+1), y(restart);
+    std::vector<double> r(n);
+
+    int iter = 0;
+    residual = 1.0;
+
+    while(iter<maxiter)
+    {
+        // r = b - A.x
+        matvec(x, r.data());
+        double beta = 0.0;
+        for(int i=0; i<n; i++)
+        {
+            r[i] = b[i]-r[i];
+            beta += r[i]*r[i];
+        }
+        beta = sqrt(beta);
+        residual = beta/bnorm;
+        if(residual<tolerance) return iter;
+
+        for(int i=0; i<n; i++) V[i] = r[i]/beta;
+        std::fill(g.begin(), g.end(), 0.0);
+        g[0] = beta;
+
+        int k=0;
+        for(k=0; k<restart && iter<maxiter; k++, iter++)
+        {
+            double *zk = Z.data() + size_t(k)*n;
+            double *w  = V.data() + size_t(k+1)*n;
+            memcpy(zk, V.data()+size_t(k)*n, n*sizeof(double));
+            if(precond) precond(zk);
+            matvec(zk, w);
+
+            // modified Gram-Schmidt
+            double *hk = H.data() + size_t(k)*(restart+1);
+            for(int j=0; j<=k; j++)
+            {
+                double const *vj = V.data() + size_t(j)*n;
+                double h = 0.0;
+                for(int i=0; i<n; i++) h += w[i]*vj[i];
+                hk[j] = h;
+                for(int i=0; i<n; i++) w[i] -= h*vj[i];
+            }
+            double wnorm = 0.0;
+            for(int i=0; i<n; i++) wnorm += w[i]*w[i];
+            wnorm = sqrt(wnorm);
+            hk[k+1] = wnorm;
+            if(wnorm>PRECISION)
+                for(int i=0; i<n; i++) w[i] /= wnorm;
+
+            // apply the previous Givens rotations to the new column
+            for(int j=0; j<k; j++)
+            {
+                double tmp = cs[j]*hk[j] + sn[j]*hk[j+1];
+                hk[j+1]    =-sn[j]*hk[j] + cs[j]*hk[j+1];
+                hk[j]      = tmp;
+            }
+            double d = sqrt(hk[k]*hk[k]+hk[k+1]*hk[k+1]);
+            if(d<PRECISION) d = PRECISION;
+            cs[k] = hk[k]/d;
+            sn[k] = hk[k+1]/d;
+            hk[k]   = d;
+            hk[k+1] = 0.0;
+            g[k+1] = -sn[k]*g[k];
+            g[k]   =  cs[k]*g[k];
+
+            residual = fabs(g[k+1])/bnorm;
+            if(residual<tolerance || wnorm<=PRECISION)
+            {
+                k++;
+                iter++;
+                break;
+            }
+        }
+
+        // solve the upper triangular system H.y=g and update x = x + Z.y
+        for(int j=k-1; j>=0; j--)
+        {
+            double sum = g[j];
+            for(int l=j+1; l<k; l++) sum -= H[size_t(l)*(restart+1)+j]*y[l];
+            y[j] = sum/H[size_t(j)*(restart+1)+j];
+        }
+        for(int j=0; j<k; j++)
+        {
+            double const *zj = Z.data() + size_t(j)*n;
+            for(int i=0; i<n; i++) x[i] += y[j]*zj[i];
+        }
+
+        if(residual<tolerance) return iter;
+    }
+
+    return -1;
+}
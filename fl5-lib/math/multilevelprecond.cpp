@@ -0,0 +1,264 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include <multilevelprecond.h>
+#include <matrix.h>
+#include <threadpool.h>
+
+
+MultilevelPrecond::MultilevelPrecond()
+{
+    m_MaxCoarseSize = 1500;
+}
+
+
+void MultilevelPrecond::clear()
+{
+    m_Level.clear();
+    m_CoarseLU.clear();
+    m_CoarsePiv.clear();
+}
+
+
+/**
+ * Builds the hierarchy of aggregates and the coarse operators.
+ * @param nRowsPerNode the number of rows of the system for each node of the graph, e.g. 3 for the linear triangles;
+ * the rows of node n are the rows n*nRowsPerNode+i.
+ * @param neighbours the nodes connected to each node; the graph is assumed to be symmetric.
+ * @param group the group of each node; nodes of different groups are not merged unless the graph cannot be coarsened otherwise.
+ * @param coef the callback returning the coefficient of the fine matrix in row i and column k; used for the diagonals
+ * of the intermediate levels.
+ * @param coarseOperator the callback which adds to the row-major array the Galerkin operator R.A.P of the coarsest level,
+ * given the coarse row of each fine row and the number of coarse rows.
+ * @return false if the system is too small to need coarse levels or if the coarsest level is singular;
+ * the preconditioner is then left empty.
+ */
+bool MultilevelPrecond::build(int nRowsPerNode, std::vector<std::vector<int>> const &neighbours, std::vector<int> const &group,
+                              std::function<double(int,int)> const &coef,
+                              std::function<void(std::vector<int> const &, int, double*)> const &coarseOperator)
+{
+    // the intermediate levels are smoothed as long as the diagonal costs less than a few matrix-vector products
+    int const MAXSMOOTHEDSIZE = 64;
+
+    clear();
+
+    int nr = std::max(1, nRowsPerNode);
+    int nNodes = int(neighbours.size());
+    int N = nNodes*nr;
+    if(N<=m_MaxCoarseSize) return false;
+
+    std::vector<std::vector<int>> nbrs = neighbours;
+    std::vector<int> grp = group;
+    grp.resize(nNodes, 0);
+    std::vector<int> nodeagg(nNodes);
+    std::iota(nodeagg.begin(), nodeagg.end(), 0);
+
+    int n = nNodes;
+    std::vector<int> agg;
+    while(n*nr>m_MaxCoarseSize)
+    {
+        int na = aggregate(nbrs, grp, agg);
+        if(na>n*4/5)
+        {
+            // the groups are too small to be coarsened further; merge across them
+            std::vector<int> nogroup(n, 0);
+            na = aggregate(nbrs, nogroup, agg);
+            if(na>n*4/5) break;
+        }
+
+        // the graph of the new level
+        std::vector<std::vector<int>> cnbrs(na);
+        std::vector<int> cgrp(na, 0);
+        for(int a=0; a<n; a++)
+        {
+            cgrp[agg.at(a)] = grp.at(a);
+            for(int b : nbrs.at(a))
+            {
+                if(agg.at(b)!=agg.at(a)) cnbrs[agg.at(a)].push_back(agg.at(b));
+            }
+        }
+        for(std::vector<int> &cn : cnbrs)
+        {
+            std::sort(cn.begin(), cn.end());
+            cn.erase(std::unique(cn.begin(), cn.end()), cn.end());
+        }
+        nbrs.swap(cnbrs);
+        grp.swap(cgrp);
+        for(int &ia : nodeagg) ia = agg.at(ia);
+        n = na;
+
+        Level level;
+        level.m_nRows = n*nr;
+        level.m_Aggregate.resize(N);
+        for(int r=0; r<N; r++) level.m_Aggregate[r] = nodeagg.at(r/nr)*nr + r%nr;
+        m_Level.push_back(std::move(level));
+    }
+
+    // the size of the coarsest level is bounded by the cost of its dense factorization
+    if(m_Level.empty() || m_Level.back().m_nRows>4*m_MaxCoarseSize)
+    {
+        clear();
+        return false;
+    }
+
+    for(int l=0; l<nLevels()-1; l++)
+    {
+        Level &level = m_Level[l];
+        int nc = level.m_nRows;
+        if(N>MAXSMOOTHEDSIZE*nc) continue;
+
+        // the fine rows of each aggregate
+        std::vector<int> first(nc+1, 0), rows(N);
+        for(int r=0; r<N; r++) first[level.m_Aggregate.at(r)+1]++;
+        for(int J=0; J<nc; J++) first[J+1] += first.at(J);
+        std::vector<int> pos(first.begin(), first.end()-1);
+        for(int r=0; r<N; r++) rows[pos[level.m_Aggregate.at(r)]++] = r;
+
+        level.m_InvDiag.resize(nc);
+        ThreadPool::pool().parallelFor(nc, [&level, &first, &rows, &coef](int J)
+        {
+            double d = 0.0;
+            for(int i=first.at(J); i<first.at(J+1); i++)
+            {
+                for(int k=first.at(J); k<first.at(J+1); k++) d += coef(rows.at(i), rows.at(k));
+            }
+            level.m_InvDiag[J] = std::abs(d)>0.0 ? 1.0/d : 0.0;
+        });
+    }
+
+    Level const &coarse = m_Level.back();
+    int nc = coarse.m_nRows;
+    m_CoarseLU.assign(size_t(nc)*size_t(nc), 0.0);
+    coarseOperator(coarse.m_Aggregate, nc, m_CoarseLU.data());
+    if(matrix::LUfactorize(nc, m_CoarseLU.data(), m_CoarsePiv)!=0)
+    {
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Makes one level of aggregates in three passes: a node whose neighbours of the same group are all free
+ * makes a new aggregate with them, then the remaining nodes join an adjacent aggregate of the same group,
+ * and the nodes left make their own aggregate.
+ * @return the number of aggregates.
+ */
+int MultilevelPrecond::aggregate(std::vector<std::vector<int>> const &neighbours, std::vector<int> const &group, std::vector<int> &agg)
+{
+    int n = int(neighbours.size());
+    agg.assign(n, -1);
+    int na = 0;
+
+    for(int a=0; a<n; a++)
+    {
+        if(agg.at(a)>=0) continue;
+        bool bFree = true;
+        for(int b : neighbours.at(a))
+        {
+            if(group.at(b)==group.at(a) && agg.at(b)>=0)
+            {
+                bFree = false;
+                break;
+            }
+        }
+        if(!bFree) continue;
+
+        agg[a] = na;
+        for(int b : neighbours.at(a))
+        {
+            if(group.at(b)==group.at(a)) agg[b] = na;
+        }
+        na++;
+    }
+
+    // join the aggregates of the first pass only, so that the aggregates do not grow in chains
+    std::vector<int> seeded = agg;
+    for(int a=0; a<n; a++)
+    {
+        if(agg.at(a)>=0) continue;
+        for(int b : neighbours.at(a))
+        {
+            if(group.at(b)==group.at(a) && seeded.at(b)>=0)
+            {
+                agg[a] = seeded.at(b);
+                break;
+            }
+        }
+    }
+
+    for(int a=0; a<n; a++)
+    {
+        if(agg.at(a)<0) agg[a] = na++;
+    }
+
+    return na;
+}
+
+
+/**
+ * Adds the coarse-level corrections of the residual r to x.
+ * @param r the residual, of the size of the fine system.
+ * @param x the result of the fine-level smoother, in input; the preconditioned vector, in output
+ */
+void MultilevelPrecond::addCorrection(double const *r, double *x) const
+{
+    if(m_Level.empty()) return;
+
+    int N = int(m_Level.front().m_Aggregate.size());
+    std::vector<double> rc;
+    for(int l=0; l<nLevels(); l++)
+    {
+        Level const &level = m_Level.at(l);
+        bool bCoarsest = l==nLevels()-1;
+        if(!bCoarsest && level.m_InvDiag.empty()) continue;
+
+        rc.assign(level.m_nRows, 0.0);
+        for(int i=0; i<N; i++) rc[level.m_Aggregate.at(i)] += r[i];
+
+        if(bCoarsest) matrix::LUbackSubstitute(level.m_nRows, m_CoarseLU.data(), m_CoarsePiv, 1, rc.data());
+        else
+        {
+            for(int J=0; J<level.m_nRows; J++) rc[J] *= level.m_InvDiag.at(J);
+        }
+
+        for(int i=0; i<N; i++) x[i] += rc.at(level.m_Aggregate.at(i));
+    }
+}
+
+
+size_t MultilevelPrecond::memorySize() const
+{
+    size_t n = m_CoarseLU.size()*sizeof(double) + m_CoarsePiv.size()*sizeof(int);
+    for(Level const &level : m_Level)
+        n += level.m_Aggregate.size()*sizeof(int) + level.m_InvDiag.size()*sizeof(double);
+    return n;
+}
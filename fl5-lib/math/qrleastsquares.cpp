@@ -23,6 +23,7 @@
 *****************************************************************************/
 
 #include <cmath>
+#include <algorithm>
 #include <cstring>
 
 #include <qrleastsquares.h>
@@ -338,3 +339,93 @@ void testQRLeastSquare()
     delete [] c;
     delete [] x;
 }
+
+
+BandedLeastSquares::BandedLeastSquares(int nCols, int bandWidth, int nRhs)
+{
+    m_nCols = nCols;
+    m_BandWidth = bandWidth;
+    m_nRhs = nRhs;
+    m_R.assign(size_t(nCols)*size_t(bandWidth), 0.0);
+    m_QtB.assign(size_t(nCols)*size_t(nRhs), 0.0);
+}
+
+
+/**
+ * Adds a row of the system and rotates it into R.
+ * @param firstCol the column of the first coefficient
+ * @param coefs the bandwidth coefficients of the row, from firstCol; the coefficients beyond the last column are ignored
+ * @param rhs the nRhs right hand side values of the row
+ * @param weight the factor applied to the row and to its right hand side values
+ */
+void BandedLeastSquares::addRow(int firstCol, double const *coefs, double const *rhs, double weight)
+{
+    int const bw = m_BandWidth;
+    std::vector<double> w(bw), z(m_nRhs);
+    for(int k=0; k<bw; k++) w[k] = (firstCol+k<m_nCols) ? coefs[k]*weight : 0.0;
+    for(int r=0; r<m_nRhs; r++) z[r] = rhs[r]*weight;
+
+    for(int col=std::max(firstCol, 0); col<m_nCols; col++)
+    {
+        if(fabs(w[0])>0.0)
+        {
+            double *Rrow = m_R.data() + size_t(col)*size_t(bw);
+            double *Brow = m_QtB.data() + size_t(col)*size_t(m_nRhs);
+            double rho = sqrt(Rrow[0]*Rrow[0] + w[0]*w[0]);
+            double c = Rrow[0]/rho;
+            double s = w[0]/rho;
+            for(int k=0; k<bw; k++)
+            {
+                double x = Rrow[k];
+                double y = w[k];
+                Rrow[k] =  c*x + s*y;
+                w[k]    = -s*x + c*y;
+            }
+            for(int r=0; r<m_nRhs; r++)
+            {
+                double x = Brow[r];
+                double y = z[r];
+                Brow[r] =  c*x + s*y;
+                z[r]    = -s*x + c*y;
+            }
+        }
+
+        // the row now starts on the next column
+        bool bZero = true;
+        for(int k=0; k<bw-1; k++)
+        {
+            w[k] = w[k+1];
+            if(fabs(w[k])>0.0) bZero = false;
+        }
+        w[bw-1] = 0.0;
+        if(bZero) break;
+    }
+}
+
+
+/**
+ * Solves R.x = Qt.b by back substitution.
+ * @param sol the nCols solution values of each right hand side, i.e. sol[irhs*nCols+i]
+ * @return false if R is singular, i.e. if some columns are not covered by enough rows
+ */
+bool BandedLeastSquares::solve(double *sol) const
+{
+    int const bw = m_BandWidth;
+    double rmax = 0.0;
+    for(int i=0; i<m_nCols; i++) rmax = std::max(rmax, fabs(m_R[size_t(i)*size_t(bw)]));
+    if(rmax<=0.0) return false;
+
+    for(int i=m_nCols-1; i>=0; i--)
+    {
+        double const *Rrow = m_R.data() + size_t(i)*size_t(bw);
+        if(fabs(Rrow[0])<PRECISION*rmax) return false;
+        for(int r=0; r<m_nRhs; r++)
+        {
+            double sum = m_QtB[size_t(i)*size_t(m_nRhs)+size_t(r)];
+            for(int k=1; k<bw && i+k<m_nCols; k++)
+                sum -= Rrow[k] * sol[size_t(r)*size_t(m_nCols)+size_t(i+k)];
+            sol[size_t(r)*size_t(m_nCols)+size_t(i)] = sum/Rrow[0];
+        }
+    }
+    return true;
+}
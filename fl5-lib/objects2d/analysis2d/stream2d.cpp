@@ -34,6 +34,7 @@
 #include <matrix.h>
 #include <panel2d.h>
 #include <sgsmooth.h>
+#include <threadpool.h>
 #include <vector2d.h>
 #include <utils.h>
 
@@ -181,8 +182,7 @@ bool Stream2d::calcSolution(double alpha, double Q)
 
     // get the viscous contribution to vorticities
 
-    double *gamm = new double(m_matsize);
-    memset(gamm, 0, m_matsize*sizeof(double));
+    std::vector<double> gamm(m_matsize, 0.0);
 
     bool bTrace = false;
 
@@ -196,13 +196,11 @@ bool Stream2d::calcSolution(double alpha, double Q)
 
 //    for(int ip=0; ip<m_Panel.size(); ip++)        qDebug(" %4d    %g", ip, m_Panel.at(ip).length());
 
-    matrix::matVecMultLapack(m_bpij.data(), m_srcBL.data(), gamm, m_matsize, int(m_Panel.size()));
+    matrix::matVecMultLapack(m_bpij.data(), m_srcBL.data(), gamm.data(), m_matsize, int(m_Panel.size()));
 
     for(uint i=0; i<m_gamma_src.size(); i++)
         m_gamma_src[i] = gamm[i];
 
-    delete gamm;
-
     return true;
 }
 
@@ -524,6 +522,29 @@ void Stream2d::getVelocity(double alpha, double qinf, Vector2d const & pt, Vecto
 }
 
 
+/**
+ * @brief Returns the velocities at an array of points, e.g. the nodes of a display grid.
+ * The points are split in blocks evaluated on the thread pool.
+ */
+void Stream2d::getVelocities(double alpha, double qinf, std::vector<Vector2d> const &pts, std::vector<Vector2d> &vel, bool bSigma) const
+{
+    int nPts = int(pts.size());
+    vel.resize(pts.size());
+    if(nPts==0) return;
+
+    int nBlocks = std::min(nPts, ThreadPool::nBlocks(ThreadPool::maxThreadCount()));
+    int blocksize = (nPts+nBlocks-1)/nBlocks;
+
+    ThreadPool::pool().parallelFor(nBlocks, [&](int iBlock)
+    {
+        int i0 = iBlock*blocksize;
+        int i1 = std::min(nPts, i0+blocksize);
+        for(int i=i0; i<i1; i++)
+            getVelocity(alpha, qinf, pts.at(i), vel[i], bSigma);
+    });
+}
+
+
 double Stream2d::streamValue(double alpha, double qinf, Vector2d const &pt) const
 {
     double psi = 0.0;
@@ -0,0 +1,222 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <numeric>
+
+#include <xfoilbatchengine.h>
+#include <foil.h>
+#include <oppoint.h>
+#include <polar.h>
+#include <threadpool.h>
+#include <xfoilresultcache.h>
+#include <xfoiltask.h>
+
+
+XFoilBatchEngine::XFoilBatchEngine()
+{
+    m_nWorkers = ThreadPool::maxThreadCount();
+    m_iNext = 0;
+    m_nFinished = 0;
+    m_pCancelToken = std::make_shared<std::atomic<bool>>(false);
+}
+
+
+XFoilBatchEngine::~XFoilBatchEngine()
+{
+    if(isRunning())
+    {
+        cancel();
+        wait();
+    }
+}
+
+
+/** Sets the number of worker threads; must not be called while the engine is running */
+void XFoilBatchEngine::setWorkerCount(int nWorkers)
+{
+    if(isRunning()) return;
+    m_nWorkers = nWorkers>0 ? nWorkers : ThreadPool::maxThreadCount();
+}
+
+
+void XFoilBatchEngine::addJob(XFoilJob const &job)
+{
+    if(isRunning()) return;
+    m_Jobs.push_back(job);
+}
+
+
+void XFoilBatchEngine::clearJobs()
+{
+    if(isRunning()) return;
+    m_Jobs.clear();
+    m_Order.clear();
+}
+
+
+/**
+ * A relative estimate of the job's duration: the number of operating points
+ * times the cost of one viscous iteration, which grows with the square of the node count.
+ */
+double XFoilBatchEngine::estimatedCost(XFoilJob const &job)
+{
+    if(!job.m_pFoil || !job.m_pPolar) return 0.0;
+
+    int nPoints = 0;
+    for(AnalysisRange const &range : job.m_Ranges)
+    {
+        if(range.isActive()) nPoints += range.nValues();
+    }
+    double nNodes = double(job.m_pFoil->nNodes());
+    return double(std::max(nPoints, 1)) * nNodes*nNodes;
+}
+
+
+/** Starts the workers and returns immediately; the jobs are processed by decreasing estimated cost */
+void XFoilBatchEngine::start()
+{
+    if(isRunning()) return;
+
+    m_pCancelToken->store(false);
+    m_iNext = 0;
+    m_nFinished = 0;
+
+    std::vector<double> cost(m_Jobs.size());
+    for(size_t i=0; i<m_Jobs.size(); i++) cost[i] = estimatedCost(m_Jobs.at(i));
+    m_Order.resize(m_Jobs.size());
+    std::iota(m_Order.begin(), m_Order.end(), 0);
+    std::stable_sort(m_Order.begin(), m_Order.end(), [&cost](int i, int j){return cost[i]>cost[j];});
+
+    int nThreads = std::max(1, std::min(m_nWorkers, int(m_Jobs.size())));
+
+    // the tasks are allocated once per run and reused from one job to the next;
+    // they take the current default settings at construction
+    m_Workers.clear();
+    for(int i=0; i<nThreads; i++)
+    {
+        m_Workers.push_back(std::make_unique<XFoilTask>());
+        m_Workers.back()->setCancelToken(m_pCancelToken);
+    }
+
+    for(int i=0; i<nThreads; i++)
+        m_Threads.push_back(std::thread(&XFoilBatchEngine::workerLoop, this, i));
+}
+
+
+/** Blocks until all the jobs have been processed, or skipped if the batch has been cancelled */
+void XFoilBatchEngine::wait()
+{
+    for(std::thread &thread : m_Threads) thread.join();
+    m_Threads.clear();
+}
+
+
+/** Stops the running jobs of this engine only; the other analyses in the process are not affected */
+void XFoilBatchEngine::cancel()
+{
+    m_pCancelToken->store(true);
+}
+
+
+void XFoilBatchEngine::workerLoop(int iWorker)
+{
+    XFoilTask *pTask = m_Workers.at(iWorker).get();
+
+    while(true)
+    {
+        int iOrder = m_iNext.fetch_add(1);
+        if(iOrder>=int(m_Order.size())) break;
+
+        int iJob = m_Order.at(iOrder);
+        XFoilJob &job = m_Jobs[iJob];
+
+        XFoilJobResult result;
+        result.m_iJob   = iJob;
+        result.m_pFoil  = job.m_pFoil;
+        result.m_pPolar = job.m_pPolar;
+
+        if(!isCancelled() && job.m_pFoil && job.m_pPolar)
+        {
+            if(m_StartCallback)
+            {
+                std::lock_guard<std::mutex> lock(m_CallbackMutex);
+                m_StartCallback(job, iJob);
+            }
+
+            // the cache holds the polar data only, so jobs which return or stream their operating points are always computed;
+            // the results are stored only if the polar was empty, so that the entry does not include points of other runs
+            uint64_t cacheKey = 0;
+            bool bStore = false;
+            if(XFoilResultCache::isEnabled() && !job.m_bKeepOpps && !job.m_pResultSink && !job.m_StopCondition)
+            {
+                cacheKey = XFoilResultCache::jobKey(*job.m_pFoil, *job.m_pPolar, *pTask, job.m_Ranges, job.m_bAlpha);
+                bStore = !job.m_pPolar->hasData();
+            }
+
+            if(cacheKey && XFoilResultCache::loadPolar(cacheKey, *job.m_pPolar))
+            {
+                result.m_Log = "Read from the result cache\n";
+            }
+            else
+            {
+                pTask->clearOpps();
+                pTask->clearLog();
+                pTask->setAoAAnalysis(job.m_bAlpha);
+                pTask->setAnalysisRanges(job.m_Ranges);
+                pTask->setResultSink(job.m_pResultSink);
+                pTask->setStopCondition(job.m_StopCondition);
+                if(pTask->initialize(*job.m_pFoil, job.m_pPolar, job.m_bKeepOpps))
+                {
+                    pTask->run();
+                    result.m_bErrors = pTask->hasErrors();
+                    result.m_bStopped = pTask->isStopped();
+                }
+                else
+                    result.m_bErrors = true;
+
+                result.m_OpPoints = pTask->operatingPoints();
+                result.m_Log = pTask->log();
+                pTask->clearOpps();
+
+                if(bStore && !pTask->cancelRequested()) XFoilResultCache::storePolar(cacheKey, *job.m_pPolar);
+            }
+        }
+        result.m_bCancelled = isCancelled();
+
+        m_nFinished++;
+
+        if(m_ResultCallback)
+        {
+            std::lock_guard<std::mutex> lock(m_CallbackMutex);
+            m_ResultCallback(result);
+        }
+        else
+        {
+            for(OpPoint *pOpp : result.m_OpPoints) delete pOpp;
+        }
+    }
+}
+
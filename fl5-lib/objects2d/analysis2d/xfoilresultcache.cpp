@@ -0,0 +1,305 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include <xfoilresultcache.h>
+#include <foil.h>
+#include <polar.h>
+#include <xfoiltask.h>
+
+
+bool XFoilResultCache::s_bEnabled(false);
+std::string XFoilResultCache::s_CacheDir;
+std::unordered_map<uint64_t, std::map<std::pair<int64_t, int64_t>, XFoilResultCache::OtfPoint>> XFoilResultCache::s_Points;
+std::mutex XFoilResultCache::s_Mutex;
+
+
+/** incremented when the content of the keys or of the files changes, so that older entries are ignored */
+static int const s_CacheFormat = 2;
+
+/** the number of values stored for each polar point */
+static int const s_nPolarValues = 16;
+
+
+static void hashBytes(uint64_t &key, void const *data, size_t size)
+{
+    // FNV-1a
+    unsigned char const *bytes = static_cast<unsigned char const*>(data);
+    for(size_t i=0; i<size; i++)
+    {
+        key ^= bytes[i];
+        key *= 1099511628211ULL;
+    }
+}
+
+
+static void hashInt(uint64_t &key, int i)       {hashBytes(key, &i, sizeof(int));}
+static void hashDouble(uint64_t &key, double d) {hashBytes(key, &d, sizeof(double));}
+
+
+std::string XFoilResultCache::cacheDirectory()
+{
+    if(!s_CacheDir.empty()) return s_CacheDir;
+    std::error_code ec;
+    std::filesystem::path dir = std::filesystem::temp_directory_path(ec);
+    if(ec) return std::string();
+    return (dir/"flow5_xfoil_cache").string();
+}
+
+
+/** Sets the directory of the cache files; the results already loaded in memory are kept */
+void XFoilResultCache::setCacheDirectory(std::string const &dir)
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    s_CacheDir = dir;
+}
+
+
+/**
+ * The key of the results of the foil, in its current geometry, for the analysis parameters of the polar
+ * and the settings of the task which decide which points converge and to which values.
+ * The polar's name, style and data are not part of the key.
+ */
+uint64_t XFoilResultCache::foilKey(Foil const &foil, Polar const &polar, XFoilTask const &task)
+{
+    uint64_t key = 14695981039346656037ULL;
+    hashInt(key, s_CacheFormat);
+
+    hashInt(key, foil.nNodes());
+    for(int i=0; i<foil.nNodes(); i++)
+    {
+        hashDouble(key, foil.x(i));
+        hashDouble(key, foil.y(i));
+    }
+    hashInt(key, foil.hasTEFlap() ? 1 : 0);
+    hashDouble(key, foil.TEXHinge());
+    hashDouble(key, foil.TEYHinge());
+    hashInt(key, foil.hasLEFlap() ? 1 : 0);
+    hashDouble(key, foil.LEXHinge());
+    hashDouble(key, foil.LEYHinge());
+    hashDouble(key, foil.LEFlapAngle());
+
+    hashInt(key, int(polar.type()));
+    hashInt(key, polar.ReType());
+    hashInt(key, polar.MaType());
+    hashDouble(key, polar.Reynolds());
+    hashDouble(key, polar.Mach());
+    hashDouble(key, polar.aoaSpec());
+    hashDouble(key, polar.NCrit());
+    hashDouble(key, polar.XTripTop());
+    hashDouble(key, polar.XTripBot());
+    hashDouble(key, polar.TEFlapAngle());
+
+    hashInt(key, task.iterLimit());
+    hashDouble(key, task.VAccel());
+    hashInt(key, task.bAdaptiveSequence() ? 1 : 0);
+    hashInt(key, task.nSegments());
+    hashDouble(key, XFoilTask::CdError());
+
+    return key;
+}
+
+
+/** The key of the results of a batch analysis of the foil and polar over the given ranges */
+uint64_t XFoilResultCache::jobKey(Foil const &foil, Polar const &polar, XFoilTask const &task, std::vector<AnalysisRange> const &ranges, bool bAlpha)
+{
+    uint64_t key = foilKey(foil, polar, task);
+    hashInt(key, bAlpha ? 1 : 0);
+    for(AnalysisRange const &range : ranges)
+    {
+        if(!range.isActive()) continue;
+        hashDouble(key, range.m_vStart);
+        hashDouble(key, range.m_vEnd);
+        hashDouble(key, range.m_vInc);
+    }
+    return key;
+}
+
+
+std::string XFoilResultCache::filePath(uint64_t key, char const *extension)
+{
+    std::string dir = cacheDirectory();
+    if(dir.empty()) return std::string();
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "xf_%016llx.%s", static_cast<unsigned long long>(key), extension);
+    return (std::filesystem::path(dir)/name).string();
+}
+
+
+/** The points are matched at 1 unit of Re and 1.e-6 of Cl */
+std::pair<int64_t, int64_t> XFoilResultCache::pointIndex(double Re, double Cl)
+{
+    return {std::llround(Re), std::llround(Cl*1.0e6)};
+}
+
+
+/** The OTF points of the key, read from the cache file on first access; the caller must hold the lock */
+std::map<std::pair<int64_t, int64_t>, XFoilResultCache::OtfPoint> &XFoilResultCache::points(uint64_t key)
+{
+    auto it = s_Points.find(key);
+    if(it!=s_Points.end()) return it->second;
+
+    std::map<std::pair<int64_t, int64_t>, OtfPoint> &pts = s_Points[key];
+
+    std::ifstream file(filePath(key, "otf"), std::ios::binary);
+    double rec[5];
+    while(file.read(reinterpret_cast<char*>(rec), sizeof(rec)))
+    {
+        // a partial record at the end of an interrupted write is ignored
+        pts[pointIndex(rec[0], rec[1])] = {rec[2], rec[3], rec[4]};
+    }
+    return pts;
+}
+
+
+bool XFoilResultCache::findPoint(uint64_t key, double Re, double Cl, OtfPoint &pt)
+{
+    if(!s_bEnabled) return false;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    std::map<std::pair<int64_t, int64_t>, OtfPoint> const &pts = points(key);
+    auto it = pts.find(pointIndex(Re, Cl));
+    if(it==pts.end()) return false;
+    pt = it->second;
+    return true;
+}
+
+
+/** Adds a converged OTF point to the cache and appends it to the key's file */
+void XFoilResultCache::storePoint(uint64_t key, double Re, double Cl, OtfPoint const &pt)
+{
+    if(!s_bEnabled) return;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    std::map<std::pair<int64_t, int64_t>, OtfPoint> &pts = points(key);
+    if(!pts.insert({pointIndex(Re, Cl), pt}).second) return; // already stored
+
+    std::string path = filePath(key, "otf");
+    if(path.empty()) return;
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    // the cache remains valid in memory for this session if the file cannot be written
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    double rec[5] = {Re, Cl, pt.m_Cd, pt.m_XTrTop, pt.m_XTrBot};
+    file.write(reinterpret_cast<char const*>(rec), sizeof(rec));
+}
+
+
+/**
+ * Adds the cached data of the key to the polar.
+ * @return false if there is no entry for this key, in which case the polar is unchanged.
+ */
+bool XFoilResultCache::loadPolar(uint64_t key, Polar &polar)
+{
+    if(!s_bEnabled) return false;
+
+    std::vector<double> values;
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        std::ifstream file(filePath(key, "plr"), std::ios::binary);
+        if(!file) return false;
+
+        int format=0, n=0;
+        if(!file.read(reinterpret_cast<char*>(&format), sizeof(int)) || format!=s_CacheFormat) return false;
+        if(!file.read(reinterpret_cast<char*>(&n), sizeof(int)) || n<=0) return false;
+
+        values.resize(size_t(n)*s_nPolarValues);
+        if(!file.read(reinterpret_cast<char*>(values.data()), std::streamsize(values.size()*sizeof(double)))) return false;
+    }
+
+    for(size_t i=0; i<values.size(); i+=s_nPolarValues)
+    {
+        double const *v = values.data()+i;
+        polar.addPoint(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10], v[11], v[12], v[13], v[14], v[15]);
+    }
+    return true;
+}
+
+
+/** Writes the data of the polar to the key's file, replacing any previous entry */
+void XFoilResultCache::storePolar(uint64_t key, Polar const &polar)
+{
+    if(!s_bEnabled || !polar.hasData()) return;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+
+    std::string path = filePath(key, "plr");
+    if(path.empty()) return;
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    // written to a temporary file first so that a concurrent or interrupted write never leaves a partial entry
+    std::string temppath = path + ".tmp";
+    {
+        std::ofstream file(temppath, std::ios::binary | std::ios::trunc);
+        int n = polar.dataSize();
+        file.write(reinterpret_cast<char const*>(&s_CacheFormat), sizeof(int));
+        file.write(reinterpret_cast<char const*>(&n), sizeof(int));
+        for(int i=0; i<n; i++)
+        {
+            double v[s_nPolarValues] = {polar.m_Alpha.at(i), polar.m_Cd.at(i), polar.m_Cdp.at(i), polar.m_Cl.at(i),
+                                        polar.m_Cm.at(i), polar.m_HMom.at(i), polar.m_Cpmn.at(i), polar.m_Re.at(i),
+                                        polar.m_XCp.at(i), polar.m_Control.at(i), polar.m_XTrTop.at(i), polar.m_XTrBot.at(i),
+                                        polar.m_XLamSepTop.at(i), polar.m_XLamSepBot.at(i), polar.m_XTurbSepTop.at(i), polar.m_XTurbSepBot.at(i)};
+            file.write(reinterpret_cast<char const*>(v), sizeof(v));
+        }
+        if(!file)
+        {
+            file.close();
+            std::filesystem::remove(temppath, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(temppath, path, ec);
+}
+
+
+/** Clears the results loaded in memory and deletes the cache files */
+void XFoilResultCache::clear()
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    s_Points.clear();
+
+    std::string dir = cacheDirectory();
+    if(dir.empty()) return;
+
+    std::error_code ec;
+    std::vector<std::filesystem::path> files;
+    for(std::filesystem::directory_iterator it(dir, ec), end; !ec && it!=end; it.increment(ec))
+    {
+        std::filesystem::path const &p = it->path();
+        std::string name = p.filename().string();
+        if(name.rfind("xf_", 0)==0 && (p.extension()==".otf" || p.extension()==".plr" || p.extension()==".tmp"))
+            files.push_back(p);
+    }
+    for(std::filesystem::path const &p : files) std::filesystem::remove(p, ec);
+}
+
@@ -32,17 +32,32 @@
 
 
 #include <xfoiltask.h>
+#include <xfoilresultcache.h>
 #include <foil.h>
 #include <oppoint.h>
 #include <polar.h>
+#include <convergencemonitor.h>
+#include <livechannel.h>
+#include <resultsink.h>
+#include <threadpool.h>
 #include <geom_params.h>
 #include <constants.h>
+#include <utils.h>
 
 
-bool XFoilTask::s_bCancel   = false;
+std::atomic<bool> XFoilTask::s_bCancel(false);
 double XFoilTask::s_CdError = 1.0e-3;
 
 int XFoilTask::s_IterLim=100;
+bool XFoilTask::s_bAdaptiveSequence=false;
+int XFoilTask::s_nSegments=1;
+bool XFoilTask::s_bStoreBLStations=true;
+int XFoilTask::s_MaxQueuedMessages=10000;
+int XFoilTask::s_MaxLogSize=1<<20;
+
+std::list<std::pair<uint64_t, std::shared_ptr<XFoil const>>> XFoilTask::s_PreparedFoils;
+std::mutex XFoilTask::s_PreparedMutex;
+int XFoilTask::s_MaxPreparedFoils=16;
 
 
 XFoilTask::XFoilTask()
@@ -53,7 +68,22 @@ XFoilTask::XFoilTask()
     m_bViscous = true; // always true
     m_bAlpha   = true;
 
+    m_pResultSink = nullptr;
+    m_pLiveChannel = nullptr;
+    m_pConvergenceMonitor = nullptr;
+
     m_bErrors = false;
+    m_bStopped = false;
+    m_nDroppedMessages = 0;
+
+    m_IterLim     = s_IterLim;
+    m_bAdaptiveSequence = s_bAdaptiveSequence;
+    m_nSegments = s_nSegments;
+    m_bDeferResults = false;
+    m_VAccel      = XFoil::VAccel();
+    m_bFullReport = XFoil::bFullReport();
+    m_pCancelToken = std::make_shared<std::atomic<bool>>(false);
+    applyRunSettings();
 }
 
 
@@ -64,6 +94,36 @@ void XFoilTask::setCancelled(bool b)
 }
 
 
+void XFoilTask::setCancelToken(std::shared_ptr<std::atomic<bool>> const &pToken)
+{
+    m_pCancelToken = pToken ? pToken : std::make_shared<std::atomic<bool>>(false);
+    m_XFoilInstance.setCancelToken(m_pCancelToken);
+}
+
+
+void XFoilTask::setVAccel(double accel)
+{
+    m_VAccel = accel;
+    m_XFoilInstance.setRunVAccel(accel);
+}
+
+
+void XFoilTask::setFullReport(bool bFull)
+{
+    m_bFullReport = bFull;
+    m_XFoilInstance.setRunFullReport(bFull);
+}
+
+
+/** Copies the settings of this task to the XFoil instance, e.g. after it has been reset from a prepared foil */
+void XFoilTask::applyRunSettings()
+{
+    m_XFoilInstance.setRunVAccel(m_VAccel);
+    m_XFoilInstance.setRunFullReport(m_bFullReport);
+    m_XFoilInstance.setCancelToken(m_pCancelToken);
+}
+
+
 void XFoilTask::setAlphaRange(double vMin, double vMax, double vDelta)
 {
     m_bAlpha = true;
@@ -88,6 +148,15 @@ void XFoilTask::setClRange(double vMin, double vMax, double vDelta)
 }
 
 
+void XFoilTask::clearLog()
+{
+    std::unique_lock<std::mutex> lck(m_mtx);
+    m_Log.clear();
+    std::queue<std::string>().swap(m_theMsgQueue);
+    m_nDroppedMessages = 0;
+}
+
+
 void XFoilTask::traceLog(QString const &str)
 {
     traceStdLog(str.toStdString());
@@ -98,16 +167,29 @@ void XFoilTask::traceStdLog(std::string const &str)
 {
     // Access the Q under the lock:
     std::unique_lock<std::mutex> lck(m_mtx);
-    m_theMsgQueue.push(str);
-    m_cv.notify_all();
+    if(s_MaxQueuedMessages>0 && int(m_theMsgQueue.size())>=s_MaxQueuedMessages)
+    {
+        // no one is reading the queue, e.g. in a batch run
+        m_nDroppedMessages++;
+    }
+    else
+    {
+        if(m_nDroppedMessages>0)
+        {
+            m_theMsgQueue.push("   ... " + std::to_string(m_nDroppedMessages) + " messages were dropped\n");
+            m_nDroppedMessages = 0;
+        }
+        m_theMsgQueue.push(str);
+        m_cv.notify_all();
+    }
 
-    m_Log.append(str);
+    xfl::appendToLog(m_Log, str, size_t(s_MaxLogSize));
 }
 
 
 void XFoilTask::run()
 {
-    if(s_bCancel || !m_pPolar || !m_pFoil)
+    if(cancelRequested() || !m_pPolar || !m_pFoil)
     {
         m_AnalysisStatus = xfl::FINISHED;
     }
@@ -115,9 +197,12 @@ void XFoilTask::run()
     {
         m_AnalysisStatus = xfl::RUNNING;
 
-        if(m_pPolar->isFixedaoaPolar())     ReSequence();
-        else if(m_pPolar->isControlPolar()) thetaSequence();
-        else                                alphaSequence(m_bAlpha);
+        {
+            TaskProfile::Scope phase(&m_Profile, "analysis");
+            if(m_pPolar->isFixedaoaPolar())     ReSequence();
+            else if(m_pPolar->isControlPolar()) thetaSequence();
+            else                                alphaSequence(m_bAlpha);
+        }
 
         m_AnalysisStatus = xfl::FINISHED;
 
@@ -130,6 +215,87 @@ void XFoilTask::run()
 }
 
 
+void XFoilTask::clearPreparedFoils()
+{
+    std::lock_guard<std::mutex> lock(s_PreparedMutex);
+    s_PreparedFoils.clear();
+}
+
+
+void XFoilTask::setMaxPreparedFoils(int nFoils)
+{
+    std::lock_guard<std::mutex> lock(s_PreparedMutex);
+    s_MaxPreparedFoils = std::max(0, nFoils);
+    while(int(s_PreparedFoils.size())>s_MaxPreparedFoils) s_PreparedFoils.pop_back();
+}
+
+
+/**
+ * Initializes the XFoil instance with the geometry, reusing the paneling and the inviscid
+ * factorization of a previous task if the same geometry has already been prepared.
+ * The prepared instance is shared read-only; the large matrices are copied on write by the
+ * instance which is reinitialized from it, so that an Re or Mach sweep over the same foil
+ * factorizes the vorticity influence matrix only once.
+ * The analysis parameters must be set afterwards with initXFoilAnalysis().
+ */
+bool XFoilTask::initXFoilGeometry(int npts, double const *x, double const *y, double *nx, double *ny)
+{
+    // FNV-1a hash of the node coordinates
+    uint64_t key = 14695981039346656037ULL;
+    auto hashBytes = [&key](void const *data, size_t size)
+    {
+        unsigned char const *bytes = static_cast<unsigned char const*>(data);
+        for(size_t i=0; i<size; i++)
+        {
+            key ^= bytes[i];
+            key *= 1099511628211ULL;
+        }
+    };
+    hashBytes(&npts, sizeof(int));
+    hashBytes(x, size_t(npts)*sizeof(double));
+    hashBytes(y, size_t(npts)*sizeof(double));
+
+    std::shared_ptr<XFoil const> pPrepared;
+    {
+        std::lock_guard<std::mutex> lock(s_PreparedMutex);
+        for(auto it=s_PreparedFoils.begin(); it!=s_PreparedFoils.end(); it++)
+        {
+            if(it->first==key)
+            {
+                pPrepared = it->second;
+                s_PreparedFoils.splice(s_PreparedFoils.begin(), s_PreparedFoils, it);
+                break;
+            }
+        }
+    }
+
+    if(pPrepared)
+    {
+        m_XFoilInstance = *pPrepared;
+        applyRunSettings();
+        for(int k=0; k<npts; k++)
+        {
+            nx[k] = pPrepared->nx[k+1];
+            ny[k] = pPrepared->ny[k+1];
+        }
+        return true;
+    }
+
+    if(!m_XFoilInstance.initXFoilGeometry(npts, x, y, nx, ny))
+        return false;
+
+    if(s_MaxPreparedFoils<=0 || !m_XFoilInstance.prepareInviscid())
+        return true; // the factorization will be made on the first operating point
+
+    std::shared_ptr<XFoil> pNew = std::make_shared<XFoil>(m_XFoilInstance);
+    pNew->setCancelToken(nullptr); // the prepared instance must not keep this task's token alive
+    std::lock_guard<std::mutex> lock(s_PreparedMutex);
+    s_PreparedFoils.push_front({key, pNew});
+    while(int(s_PreparedFoils.size())>s_MaxPreparedFoils) s_PreparedFoils.pop_back();
+    return true;
+}
+
+
 bool XFoilTask::initialize(FoilAnalysis *pFoilAnalysis, bool bKeepOpps)
 {
     return initialize(pFoilAnalysis->m_Foil, pFoilAnalysis->m_pPolar, bKeepOpps);
@@ -138,11 +304,13 @@ bool XFoilTask::initialize(FoilAnalysis *pFoilAnalysis, bool bKeepOpps)
 
 bool XFoilTask::initialize(Foil &foil, Polar *pPolar, bool bKeepOpps)
 {
+    // the interactive analyses cancel with the global flags; concurrent jobs should use their own token
     s_bCancel = false;
 
     m_bKeepOpps = bKeepOpps;
 
     m_bErrors = false;
+    m_bStopped = false;
     m_pFoil = &foil;
     m_pPolar = pPolar;
 
@@ -150,6 +318,9 @@ bool XFoilTask::initialize(Foil &foil, Polar *pPolar, bool bKeepOpps)
 
     XFoil::s_bCancel = false;
 
+    m_Profile.clear();
+    TaskProfile::Scope phase(&m_Profile, "initialization");
+
     std::vector<double> x(m_pFoil->nNodes()), y(m_pFoil->nNodes()), nx(m_pFoil->nNodes()), ny(m_pFoil->nNodes());
     for(int i=0; i<m_pFoil->nNodes(); i++)
     {
@@ -159,7 +330,7 @@ bool XFoilTask::initialize(Foil &foil, Polar *pPolar, bool bKeepOpps)
         ny[i] = m_pFoil->normal(i).y;
     }
 
-    if(!m_XFoilInstance.initXFoilGeometry(m_pFoil->nNodes(), x.data(), y.data(), nx.data(), ny.data()))
+    if(!initXFoilGeometry(m_pFoil->nNodes(), x.data(), y.data(), nx.data(), ny.data()))
         return false;
 
     bool bViscous = true;
@@ -215,6 +386,9 @@ bool XFoilTask::processCl(int k)
         m_pPolar->m_Cd[k]      = m_XFoilInstance.cd;
         m_pPolar->m_XTrTop[k]  = m_XFoilInstance.xoctr[1];
         m_pPolar->m_XTrBot[k]  = m_XFoilInstance.xoctr[2];
+        if(XFoilResultCache::isEnabled())
+            XFoilResultCache::storePoint(XFoilResultCache::foilKey(*m_pFoil, *m_pPolar, *this), m_pPolar->m_Re.at(k), m_pPolar->m_Cl.at(k),
+                                         {m_XFoilInstance.cd, m_XFoilInstance.xoctr[1], m_XFoilInstance.xoctr[2]});
     }
     else
     {
@@ -276,7 +450,7 @@ bool XFoilTask::processClRange(Polar *pPolar, AnalysisRange const &range)
 
     do
     {
-        if(s_bCancel) break;
+        if(cancelRequested()) break;
 
         m_XFoilInstance.lalfa = false;
         m_XFoilInstance.alfa = 0.0;
@@ -347,9 +521,11 @@ bool XFoilTask::processClList()
     traceLog("   Initializing BL\n");
     initializeBL();
 
+    uint64_t cacheKey = XFoilResultCache::isEnabled() ? XFoilResultCache::foilKey(*m_pFoil, *m_pPolar, *this) : 0;
+
     for(uint icl=0; icl<m_pPolar->m_Cl.size(); icl++)
     {
-        if(s_bCancel) break;
+        if(cancelRequested()) break;
 
         double Cl = m_pPolar->m_Cl.at(icl);
 
@@ -363,6 +539,18 @@ bool XFoilTask::processClList()
 
         str = QString::asprintf("   Re=%g  Cl=%g ", m_pPolar->m_Re.at(icl), m_pPolar->m_Cl.at(icl));
         traceLog(str);
+
+        XFoilResultCache::OtfPoint cached;
+        if(XFoilResultCache::findPoint(cacheKey, m_pPolar->m_Re.at(icl), Cl, cached))
+        {
+            traceLog("   ...read from the result cache\n");
+            m_pPolar->m_Control[icl] = 1.0;
+            m_pPolar->m_Cd[icl]      = cached.m_Cd;
+            m_pPolar->m_XTrTop[icl]  = cached.m_XTrTop;
+            m_pPolar->m_XTrBot[icl]  = cached.m_XTrBot;
+            continue;
+        }
+
         if(!m_XFoilInstance.speccl())
         {
             str = "Invalid Analysis Settings\nCpCalc: local speed too large\n Compressibility corrections invalid";
@@ -387,6 +575,7 @@ bool XFoilTask::processClList()
             m_pPolar->m_Cd[icl]     = m_XFoilInstance.cd;
             m_pPolar->m_XTrTop[icl] = m_XFoilInstance.xoctr[1];
             m_pPolar->m_XTrBot[icl] = m_XFoilInstance.xoctr[2];
+            XFoilResultCache::storePoint(cacheKey, m_pPolar->m_Re.at(icl), Cl, {m_XFoilInstance.cd, m_XFoilInstance.xoctr[1], m_XFoilInstance.xoctr[2]});
         }
         else
         {
@@ -413,10 +602,6 @@ void XFoilTask::initializeBL()
 /** aoa or Cl ranges */
 bool XFoilTask::alphaSequence(bool bAlpha)
 {
-    QString str;
-
-    double SpMin(0), SpMax(0), SpInc(0);
-
     m_pFoil->setTEFlapAngle(m_pPolar->TEFlapAngle());
     m_pFoil->setFlaps();
     int npts = m_pFoil->nNodes();
@@ -430,7 +615,7 @@ bool XFoilTask::alphaSequence(bool bAlpha)
         ny[i] = m_pFoil->normal(i).y;
     }
 
-    if(!m_XFoilInstance.initXFoilGeometry(npts, x.data(), y.data(), nx.data(), ny.data()))
+    if(!initXFoilGeometry(npts, x.data(), y.data(), nx.data(), ny.data()))
         return false;
 
     bool bViscous = true;
@@ -442,7 +627,7 @@ bool XFoilTask::alphaSequence(bool bAlpha)
 
     for (uint iSeries=0; iSeries<m_AnalysisRange.size(); iSeries++)
     {
-        if(s_bCancel) break;
+        if(cancelRequested()) break;
         AnalysisRange const &range = m_AnalysisRange.at(iSeries);
         if(range.isActive())
         {
@@ -456,133 +641,499 @@ bool XFoilTask::alphaSequence(bool bAlpha)
 
         initializeBL();
 
-        int iter=0;
-        SpMin = range.m_vStart;
-        SpMax = range.m_vEnd;
-        SpInc = fabs(range.m_vInc);
-        if(SpMax<SpMin) SpInc = -SpInc;
+        if(m_nSegments>1 && int(rangeTargets(bAlpha, range).size())>=2*m_nSegments)
+        {
+            if(!segmentedSequence(bAlpha, range)) return false;
+            continue;
+        }
+
+        if(m_bAdaptiveSequence)
+        {
+            if(!adaptiveSequence(bAlpha, range)) return false;
+            continue;
+        }
 
-        double alphadeg = SpMin;
-        double Cl       = SpMin; // could use alphadeg instead
+        if(!marchSequence(bAlpha, range)) return false;
+    }
 
-        do
+    return true;
+}
+
+
+/** Processes the range by increments, starting from the instance's current BL */
+bool XFoilTask::marchSequence(bool bAlpha, AnalysisRange const &range)
+{
+    QString str;
+    double SpMin(0), SpMax(0), SpInc(0);
+
+    int iter=0;
+    SpMin = range.m_vStart;
+    SpMax = range.m_vEnd;
+    SpInc = fabs(range.m_vInc);
+    if(SpMax<SpMin) SpInc = -SpInc;
+
+    double alphadeg = SpMin;
+    double Cl       = SpMin; // could use alphadeg instead
+
+    do
+    {
+        if(cancelRequested()) break;
+
+        if(bAlpha)
         {
-            if(s_bCancel) break;
+            m_XFoilInstance.alfa = alphadeg * PI/180.0;
+            m_XFoilInstance.lalfa = true;
+            m_XFoilInstance.qinf = 1.0;
+            str = "   " + ALPHAch;
+            str.append(QString::asprintf(" = %7.3f°", alphadeg));
+            traceLog(str);
 
-            if(bAlpha)
+
+            // here we go!
+            if (!m_XFoilInstance.specal())
             {
-                m_XFoilInstance.alfa = alphadeg * PI/180.0;
-                m_XFoilInstance.lalfa = true;
-                m_XFoilInstance.qinf = 1.0;
-                str = "   " + ALPHAch;
-                str.append(QString::asprintf(" = %7.3f°", alphadeg));
+                str = "Invalid Analysis Settings\nCpCalc: local speed too large\n Compressibility corrections invalid";
                 traceLog(str);
+                m_bErrors = true;
+                return false;
+            }
+        }
+        else
+        {
+            m_XFoilInstance.lalfa = false;
+            m_XFoilInstance.alfa = 0.0;
+            m_XFoilInstance.qinf = 1.0;
+            m_XFoilInstance.clspec = Cl;
+            str = QString::asprintf("   Cl = %7.3f", Cl);
+            traceLog(str);
+            if(!m_XFoilInstance.speccl())
+            {
+                m_bErrors = true;
+                return false;
+            }
+        }
 
+        m_XFoilInstance.lwake = false;
+        m_XFoilInstance.lvconv = false;
 
-                // here we go!
-                if (!m_XFoilInstance.specal())
-                {
-                    str = "Invalid Analysis Settings\nCpCalc: local speed too large\n Compressibility corrections invalid";
-                    traceLog(str);
-                    m_bErrors = true;
-                    return false;
-                }
+        int iterations = loop();
+
+        if(m_XFoilInstance.lvconv)
+        {
+            str = QString::asprintf("   ...converged after %3d iterations / Cl=%9.5f  Cd=%9.5f\n", iterations, m_XFoilInstance.cl, m_XFoilInstance.cd);
+            traceLog(str);
+
+            storeOpPoint();
+        }
+        else
+        {
+            str = QString::asprintf("   ...unconverged after %3d iterations\n", iterations);
+            traceLog(str);
+            traceLog("      ...initializing BL\n");
+            m_XFoilInstance.lblini = false;
+            m_XFoilInstance.lipan = false;
+
+            m_bErrors = true;
+        }
+
+        if(m_bFullReport)
+        {
+            traceStdLog(m_XFoilInstance.report());
+        }
+
+        alphadeg += SpInc;
+        Cl       += SpInc;
+
+        if(SpMin<=SpMax)
+        {
+            if(bAlpha)
+            {
+                if(alphadeg>SpMax+AOAPRECISION) break;
+                if(fabs(SpInc)<AOAPRECISION) break;
             }
             else
             {
-                m_XFoilInstance.lalfa = false;
-                m_XFoilInstance.alfa = 0.0;
-                m_XFoilInstance.qinf = 1.0;
-                m_XFoilInstance.clspec = Cl;
-                str = QString::asprintf("   Cl = %7.3f", Cl);
-                traceLog(str);
-                if(!m_XFoilInstance.speccl())
-                {
-                    m_bErrors = true;
-                    return false;
-                }
+                if(Cl>SpMax+CLPRECISION) break;
+                if(fabs(SpInc)<CLPRECISION) break;
             }
+        }
+        else
+        {
+            if(bAlpha)
+            {
+                if(alphadeg<SpMax-AOAPRECISION) break;
+                if(fabs(SpInc)<AOAPRECISION) break;
+            }
+            else
+            {
+                if(Cl<SpMax-CLPRECISION) break;
+                if(fabs(SpInc)<CLPRECISION) break;
+            }
+        }
 
-            m_XFoilInstance.lwake = false;
-            m_XFoilInstance.lvconv = false;
+    } while(iter++<1000); // failsafe limit
+
+    return true;
+}
+
+
+/** Stores the converged operating point in the polar, unless its Cd is spurious */
+void XFoilTask::storeOpPoint()
+{
+    if(m_XFoilInstance.cd<s_CdError)
+    {
+        traceLog(QString::asprintf("      ...discarding operating point with spurious Cd=%g\n", m_XFoilInstance.cd));
+        return;
+    }
+
+    OpPoint *pOpPoint = new OpPoint;
+    pOpPoint->setFoilName(m_pFoil->name());
+    pOpPoint->setPolarName(m_pPolar->name());
+    pOpPoint->setTheStyle(m_pPolar->theStyle());
+    pOpPoint->setPolarType(m_pPolar->type());
+    addXFoilData(pOpPoint, m_XFoilInstance, m_pFoil);
+    pOpPoint->setTheta(m_pPolar->TEFlapAngle());
+
+    if(m_bDeferResults) m_Deferred.push_back(pOpPoint); // published when the segments of the range are merged
+    else                publishOpPoint(pOpPoint);
+}
+
+
+/** Adds the operating point to the polar and to the sink, and keeps it or deletes it */
+void XFoilTask::publishOpPoint(OpPoint *pOpPoint)
+{
+    m_pPolar->addOpPointData(pOpPoint); // store the data on the fly; a polar is only used by one task at a time
+
+    if(m_pResultSink) m_pResultSink->addOpPoint(pOpPoint);
+    if(m_bKeepOpps)
+    {
+        m_OpPoints.push_back(pOpPoint);
+        if(m_pLiveChannel) m_pLiveChannel->publishOpPoint(pOpPoint);
+    }
+    else delete pOpPoint;
+
+    checkStopCondition();
+}
+
+
+void XFoilTask::checkStopCondition()
+{
+    if(m_StopCondition && m_pPolar && m_StopCondition(*m_pPolar))
+    {
+        if(!m_bStopped) traceStdLog("   ...stop condition met, skipping the remaining operating points\n");
+        m_bStopped = true;
+    }
+}
 
-            int iterations = loop();
+
+/**
+ * Runs the viscous solution at the specified aoa in degrees or Cl.
+ * @return false if the inviscid solution is invalid, in which case the sequence should be stopped.
+ */
+bool XFoilTask::solvePoint(bool bAlpha, double value, int &iterations)
+{
+    if(bAlpha)
+    {
+        m_XFoilInstance.alfa = value * PI/180.0;
+        m_XFoilInstance.lalfa = true;
+        m_XFoilInstance.qinf = 1.0;
+        if (!m_XFoilInstance.specal())
+        {
+            traceLog("Invalid Analysis Settings\nCpCalc: local speed too large\n Compressibility corrections invalid");
+            m_bErrors = true;
+            return false;
+        }
+    }
+    else
+    {
+        m_XFoilInstance.lalfa = false;
+        m_XFoilInstance.alfa = 0.0;
+        m_XFoilInstance.qinf = 1.0;
+        m_XFoilInstance.clspec = value;
+        if(!m_XFoilInstance.speccl())
+        {
+            m_bErrors = true;
+            return false;
+        }
+    }
+
+    m_XFoilInstance.lwake = false;
+    m_XFoilInstance.lvconv = false;
+
+    iterations = loop();
+    return true;
+}
+
+
+/**
+ * Processes the range by continuation: each point of the range is reached in one or more steps,
+ * each one starting from the BL of the last converged point.
+ * When a point fails, the instance is restored to the last converged point and the step is halved
+ * towards the failed point, instead of reinitializing the BL; the step is doubled back up to the
+ * range's increment when the points converge quickly.
+ * Only the points of the range are stored; the intermediate steps only carry the BL state.
+ */
+bool XFoilTask::adaptiveSequence(bool bAlpha, AnalysisRange const &range)
+{
+    double const precision = bAlpha ? AOAPRECISION : CLPRECISION;
+    double const hMax = fabs(range.m_vInc);
+    double const hMin = hMax/4.0;          // at most two bisections, each failed attempt costs a full iteration limit
+
+    std::vector<double> targets = rangeTargets(bAlpha, range);
+
+    std::unique_ptr<XFoil> pCheckpoint;    // the instance at the last converged point
+    bool bConverged = false;               // true if the instance holds a converged solution
+    double vLast = 0.0;
+    double h = hMax;
+
+    for(double target : targets)
+    {
+        while(!cancelRequested())
+        {
+            double v = target;
+            if(bConverged && fabs(target-vLast)>h+precision)
+                v = target>vLast ? vLast+h : vLast-h;
+            bool bTarget = fabs(v-target)<precision;
+
+            if(bAlpha) traceLog("   " + ALPHAch + QString::asprintf(" = %7.3f°", v));
+            else       traceLog(QString::asprintf("   Cl = %7.3f", v));
+            if(!bTarget) traceLog(" (intermediate step)");
+
+            int iterations = 0;
+            if(!solvePoint(bAlpha, v, iterations)) return false;
+
+            if(m_bFullReport) traceStdLog(m_XFoilInstance.report());
 
             if(m_XFoilInstance.lvconv)
             {
-                str = QString::asprintf("   ...converged after %3d iterations / Cl=%9.5f  Cd=%9.5f\n", iterations, m_XFoilInstance.cl, m_XFoilInstance.cd);
-                traceLog(str);
+                traceLog(QString::asprintf("   ...converged after %3d iterations / Cl=%9.5f  Cd=%9.5f\n", iterations, m_XFoilInstance.cl, m_XFoilInstance.cd));
+                if(bTarget) storeOpPoint();
 
-                if(m_XFoilInstance.cd<s_CdError)
-                {
-                    str = QString::asprintf("      ...discarding operating point with spurious Cd=%g\n", m_XFoilInstance.cd);
-                    traceLog(str);
-                }
-                else
-                {
-                    OpPoint *pOpPoint = new OpPoint;
-                    pOpPoint->setFoilName(m_pFoil->name());
-                    pOpPoint->setPolarName(m_pPolar->name());
-                    pOpPoint->setTheStyle(m_pPolar->theStyle());
-                    pOpPoint->setPolarType(m_pPolar->type());
-                    addXFoilData(pOpPoint, m_XFoilInstance, m_pFoil);
-                    m_pPolar->addOpPointData(pOpPoint); // store the data on the fly; a polar is only used by one task at a time
-                    pOpPoint->setTheta(m_pPolar->TEFlapAngle());
+                if(pCheckpoint) *pCheckpoint = m_XFoilInstance;
+                else            pCheckpoint = std::make_unique<XFoil>(m_XFoilInstance);
+                bConverged = true;
+                vLast = v;
 
-                    if(m_bKeepOpps) m_OpPoints.push_back(pOpPoint);
-                    else delete pOpPoint;
-                }
+                if(iterations<=m_IterLim/10) h = std::min(2.0*h, hMax);
+
+                if(bTarget) break;
+            }
+            else if(bConverged && h>hMin+precision)
+            {
+                traceLog(QString::asprintf("   ...unconverged after %3d iterations, reducing the step\n", iterations));
+                m_XFoilInstance = *pCheckpoint;
+                h = std::max(0.5*h, hMin);
             }
             else
             {
-                str = QString::asprintf("   ...unconverged after %3d iterations\n", iterations);
-                traceLog(str);
+                traceLog(QString::asprintf("   ...unconverged after %3d iterations\n", iterations));
                 traceLog("      ...initializing BL\n");
                 m_XFoilInstance.lblini = false;
                 m_XFoilInstance.lipan = false;
-
                 m_bErrors = true;
+
+                bConverged = false;
+                h = hMax;
+                break;
             }
+        }
+        if(cancelRequested()) break;
+    }
+
+    return true;
+}
+
+
+/** The values of the points of an aoa or Cl range, from its start to its end */
+std::vector<double> XFoilTask::rangeTargets(bool bAlpha, AnalysisRange const &range) const
+{
+    double const precision = bAlpha ? AOAPRECISION : CLPRECISION;
+    double const hMax = fabs(range.m_vInc);
+
+    std::vector<double> targets;
+    double inc = range.m_vEnd>=range.m_vStart ? hMax : -hMax;
+    for(int i=0; i<1000; i++) // failsafe limit
+    {
+        double v = range.m_vStart + double(i)*inc;
+        if(inc>=0.0 ? v>range.m_vEnd+precision : v<range.m_vEnd-precision) break;
+        targets.push_back(v);
+        if(hMax<precision) break;
+    }
+    return targets;
+}
+
+
+/**
+ * Processes the range in continuation segments which are run concurrently on the thread pool.
+ * The range is split at its point closest to zero, e.g. alpha=0, and the segments march away from it
+ * on each side. The first points of the segments are solved beforehand in a coarse sequential pass
+ * which steps from one segment to the next away from the seed, so that each segment starts from a
+ * neighbouring converged BL; a segment whose first point has not converged starts from a new BL.
+ * The operating points are added to the polar in the order of the range once all the segments have
+ * completed, so that the stop condition is only evaluated at that time.
+ */
+bool XFoilTask::segmentedSequence(bool bAlpha, AnalysisRange const &range)
+{
+    struct Segment
+    {
+        int m_iStart{0};                    /**< the index of the segment's point closest to the seed */
+        int m_iEnd{0};                      /**< the index of the segment's point furthest from the seed */
+        int m_Dir{1};                       /**< the direction of the march in the range's points */
+        int m_iFirst{0};                    /**< the index of the first point left to the segment's march */
+        std::unique_ptr<XFoil> m_pStart;    /**< the instance converged at the first point, or null if the segment starts from a new BL */
+    };
+
+    std::vector<double> targets = rangeTargets(bAlpha, range);
+    int const nPts = int(targets.size());
+    int const nSeg = std::min(m_nSegments, nPts);
+
+    int i0 = 0;
+    for(int i=1; i<nPts; i++)
+        if(fabs(targets.at(i))<fabs(targets.at(i0))) i0 = i;
+
+    // the segments on each side of the seed are in proportion to the number of points;
+    // the seed is the first point of the first segment towards the end of the range
+    int const nUp = nPts-i0;
+    int const nDown = i0;
+    int nSegDown = nDown==0 ? 0 : std::max(1, int(std::round(double(nSeg*nDown)/double(nPts))));
+    nSegDown = std::min(nSegDown, nSeg-1);
+    int nSegUp = std::min(nSeg-nSegDown, nUp);
+
+    std::vector<Segment> segments(nSegUp+nSegDown);
+    for(int k=0; k<nSegUp; k++)
+    {
+        Segment &seg = segments[k];
+        seg.m_iStart = i0 + (k*nUp)/nSegUp;
+        seg.m_iEnd   = i0 + ((k+1)*nUp)/nSegUp - 1;
+        seg.m_Dir    = 1;
+    }
+    for(int k=0; k<nSegDown; k++)
+    {
+        Segment &seg = segments[nSegUp+k];
+        seg.m_iStart = i0-1 - (k*nDown)/nSegDown;
+        seg.m_iEnd   = i0   - ((k+1)*nDown)/nSegDown;
+        seg.m_Dir    = -1;
+    }
 
-            if(XFoil::s_bFullReport)
+    traceLog(QString::asprintf("   Processing the range in %d concurrent segments from %7.3f\n", int(segments.size()), targets.at(i0)));
+
+    //---- coarse pass: the first point of each segment, starting from the seed on each side
+    m_bDeferResults = true;
+    bool bValid = true;
+    for(int side=0; side<2 && bValid; side++)
+    {
+        int k0 = side==0 ? 0      : nSegUp;
+        int k1 = side==0 ? nSegUp : nSegUp+nSegDown;
+        if(k0>=k1) continue;
+
+        XFoil const *pLast = side==0 ? nullptr : segments.front().m_pStart.get(); // the last converged start on this side
+        if(side==1)
+        {
+            if(pLast) m_XFoilInstance = *pLast;
+            else      initializeBL();
+        }
+
+        for(int k=k0; k<k1; k++)
+        {
+            if(cancelRequested()) break;
+            Segment &seg = segments[k];
+            double v = targets.at(seg.m_iStart);
+
+            if(bAlpha) traceLog("   " + ALPHAch + QString::asprintf(" = %7.3f°", v));
+            else       traceLog(QString::asprintf("   Cl = %7.3f", v));
+
+            int iterations = 0;
+            if(!solvePoint(bAlpha, v, iterations))
             {
-                traceStdLog(m_XFoilInstance.report());
+                bValid = false;
+                break;
             }
 
-            alphadeg += SpInc;
-            Cl       += SpInc;
+            if(m_bFullReport) traceStdLog(m_XFoilInstance.report());
 
-            if(SpMin<=SpMax)
+            if(m_XFoilInstance.lvconv)
             {
-                if(bAlpha)
-                {
-                    if(alphadeg>SpMax+AOAPRECISION) break;
-                    if(fabs(SpInc)<AOAPRECISION) break;
-                }
-                else
-                {
-                    if(Cl>SpMax+CLPRECISION) break;
-                    if(fabs(SpInc)<CLPRECISION) break;
-                }
+                traceLog(QString::asprintf("   ...converged after %3d iterations / Cl=%9.5f  Cd=%9.5f\n", iterations, m_XFoilInstance.cl, m_XFoilInstance.cd));
+                storeOpPoint();
+                seg.m_pStart = std::make_unique<XFoil>(m_XFoilInstance);
+                seg.m_iFirst = seg.m_iStart + seg.m_Dir;
+                pLast = seg.m_pStart.get();
             }
             else
             {
-                if(bAlpha)
-                {
-                    if(alphadeg<SpMax-AOAPRECISION) break;
-                    if(fabs(SpInc)<AOAPRECISION) break;
-                }
-                else
-                {
-                    if(Cl<SpMax-CLPRECISION) break;
-                    if(fabs(SpInc)<CLPRECISION) break;
-                }
+                traceLog(QString::asprintf("   ...unconverged after %3d iterations, left to the segment\n", iterations));
+                seg.m_iFirst = seg.m_iStart;
+                if(pLast) m_XFoilInstance = *pLast;
+                else      initializeBL();
             }
+        }
+    }
 
-        } while(iter++<1000); // failsafe limit
+    //---- fine pass: each segment marches on its own task from its first point
+    std::vector<std::unique_ptr<XFoilTask>> tasks(segments.size());
+    std::vector<int> bSegmentValid(segments.size(), 1);
+    for(uint k=0; k<segments.size() && bValid && !cancelRequested(); k++)
+    {
+        Segment const &seg = segments.at(k);
+        if((seg.m_iEnd-seg.m_iFirst)*seg.m_Dir<0) continue; // all done in the coarse pass
+
+        tasks[k] = std::make_unique<XFoilTask>();
+        XFoilTask &task = *tasks[k];
+        task.m_pFoil             = m_pFoil;
+        task.m_pPolar            = m_pPolar;
+        task.m_bAlpha            = m_bAlpha;
+        task.m_IterLim           = m_IterLim;
+        task.m_bAdaptiveSequence = m_bAdaptiveSequence;
+        task.m_VAccel            = m_VAccel;
+        task.m_bFullReport       = m_bFullReport;
+        task.m_pCancelToken      = m_pCancelToken;
+        task.m_bDeferResults     = true;
+        task.m_XFoilInstance     = seg.m_pStart ? *seg.m_pStart : m_XFoilInstance;
+        task.applyRunSettings();
+        if(!seg.m_pStart) task.initializeBL();
     }
 
-    return true;
+    ThreadPool::pool().parallelFor(int(tasks.size()), [&](int k)
+    {
+        if(!tasks[k]) return;
+        Segment const &seg = segments.at(k);
+        AnalysisRange segrange(true, targets.at(seg.m_iFirst), targets.at(seg.m_iEnd), range.m_vInc);
+        if(tasks[k]->m_bAdaptiveSequence) bSegmentValid[k] = tasks[k]->adaptiveSequence(bAlpha, segrange);
+        else                              bSegmentValid[k] = tasks[k]->marchSequence(bAlpha, segrange);
+    });
+
+    //---- merge the segments in the order of the range
+    m_bDeferResults = false;
+    for(uint k=0; k<tasks.size(); k++)
+    {
+        if(!tasks[k]) continue;
+        XFoilTask &task = *tasks[k];
+        Segment const &seg = segments.at(k);
+        traceStdLog(QString::asprintf("\n   Segment [%7.3f  %7.3f]\n", targets.at(seg.m_iFirst), targets.at(seg.m_iEnd)).toStdString());
+        traceStdLog(task.m_Log);
+        m_Deferred.insert(m_Deferred.end(), task.m_Deferred.begin(), task.m_Deferred.end());
+        task.m_Deferred.clear();
+        m_Profile.merge(task.m_Profile, int(k)+1);
+        if(task.m_bErrors) m_bErrors = true;
+        if(!bSegmentValid.at(k)) bValid = false;
+    }
+
+    bool bAscending = range.m_vEnd>=range.m_vStart;
+    std::stable_sort(m_Deferred.begin(), m_Deferred.end(), [bAlpha, bAscending](OpPoint const *p0, OpPoint const *p1)
+    {
+        double v0 = bAlpha ? p0->aoa() : p0->m_Cl;
+        double v1 = bAlpha ? p1->aoa() : p1->m_Cl;
+        return bAscending ? v0<v1 : v0>v1;
+    });
+
+    for(OpPoint *pOpPoint : m_Deferred)
+    {
+        if(m_bStopped) delete pOpPoint; // a sequential run would not have reached this point
+        else           publishOpPoint(pOpPoint);
+    }
+    m_Deferred.clear();
+
+    return bValid;
 }
 
 
@@ -615,7 +1166,7 @@ bool XFoilTask::thetaSequence()
 
     for (uint iSeries=0; iSeries<m_AnalysisRange.size(); iSeries++)
     {
-        if(s_bCancel) break;
+        if(cancelRequested()) break;
         AnalysisRange const &range = m_AnalysisRange.at(iSeries);
         if(range.isActive())
         {
@@ -642,7 +1193,7 @@ bool XFoilTask::thetaSequence()
 
         for(int iter=0; iter<nTheta; iter++)
         {
-            if(s_bCancel) break;
+            if(cancelRequested()) break;
 
             m_XFoilInstance.alfa = alphadeg * PI/180.0;
             m_XFoilInstance.lalfa = true;
@@ -706,8 +1257,11 @@ bool XFoilTask::thetaSequence()
                     addXFoilData(pOpPoint, m_XFoilInstance, m_pFoil);
                     m_pPolar->addOpPointData(pOpPoint); // store the data on the fly; a polar is only used by one task at a time
 
+                    if(m_pResultSink) m_pResultSink->addOpPoint(pOpPoint);
                     if(m_bKeepOpps) m_OpPoints.push_back(pOpPoint);
                     else delete pOpPoint;
+
+                    checkStopCondition();
                 }
             }
             else
@@ -721,7 +1275,7 @@ bool XFoilTask::thetaSequence()
                 m_bErrors = true;
             }
 
-            if(XFoil::s_bFullReport)
+            if(m_bFullReport)
             {
                 traceStdLog(m_XFoilInstance.report());
             }
@@ -757,7 +1311,7 @@ bool XFoilTask::ReSequence()
         ny[i] = m_pFoil->normal(i).y;
     }
 
-    if(!m_XFoilInstance.initXFoilGeometry(npts, x.data(), y.data(), nx.data(), ny.data()))
+    if(!initXFoilGeometry(npts, x.data(), y.data(), nx.data(), ny.data()))
         return false;
 
     bool bViscous = true;
@@ -769,7 +1323,7 @@ bool XFoilTask::ReSequence()
 
     for (uint iSeries=0; iSeries<m_AnalysisRange.size(); iSeries++)
     {
-        if(s_bCancel) break;
+        if(cancelRequested()) break;
         AnalysisRange const &range = m_AnalysisRange.at(iSeries);
         if(range.isActive())
         {
@@ -838,11 +1392,14 @@ bool XFoilTask::ReSequence()
             pOpPoint->setPolarType(m_pPolar->type());
             m_pPolar->addOpPointData(pOpPoint);
 
+            if(m_pResultSink) m_pResultSink->addOpPoint(pOpPoint);
             if(m_bKeepOpps) m_OpPoints.push_back(pOpPoint);
             else delete pOpPoint;
 
+            checkStopCondition();
+
 
-            if(XFoil::s_bFullReport)
+            if(m_bFullReport)
             {
                 traceStdLog(m_XFoilInstance.report());
             }
@@ -864,8 +1421,21 @@ bool XFoilTask::ReSequence()
 }
 
 
+/** Iterates the viscous solution of the current point, and notifies the convergence monitor of its end */
 int XFoilTask::loop()
 {
+    int iterations = viscousIterations();
+    if(m_pConvergenceMonitor)
+        m_pConvergenceMonitor->onPointEnd(ResidualSample::XFOIL, m_XFoilInstance.lalfa ? m_XFoilInstance.alfa*180.0/PI : m_XFoilInstance.clspec,
+                                          m_XFoilInstance.lvconv, iterations);
+    return iterations;
+}
+
+
+int XFoilTask::viscousIterations()
+{
+    TaskProfile::Scope phase(&m_Profile, "viscous iterations");
+
     int iterations = -1;
     if(!m_XFoilInstance.viscal())
     {
@@ -874,16 +1444,49 @@ int XFoilTask::loop()
         return -1;
     }
 
-    while(iterations<s_IterLim && !m_XFoilInstance.lvconv && !s_bCancel)
+    while(iterations<m_IterLim && !m_XFoilInstance.lvconv && !cancelRequested())
     {
         if(m_XFoilInstance.ViscousIter())
         {
             iterations++;
+            m_Profile.count(TaskProfile::NEWTONITERATIONS);
+            if(m_pLiveChannel) m_pLiveChannel->publishResidual(m_XFoilInstance.lalfa ? m_XFoilInstance.alfa*180.0/PI : m_XFoilInstance.clspec,
+                                                               iterations, m_XFoilInstance.rmsbl);
+            if(m_pConvergenceMonitor)
+            {
+                ResidualSample sample;
+                sample.m_Solver      = ResidualSample::XFOIL;
+                sample.m_Ctrl        = m_XFoilInstance.lalfa ? m_XFoilInstance.alfa*180.0/PI : m_XFoilInstance.clspec;
+                sample.m_Iter        = iterations;
+                sample.m_Rms         = m_XFoilInstance.BLRmsChange();
+                sample.m_Max         = m_XFoilInstance.BLMaxChange();
+                sample.m_MaxLocation = m_XFoilInstance.BLMaxChangeStation();
+                sample.m_MaxSide     = m_XFoilInstance.BLMaxChangeSide();
+                sample.m_Relax       = m_XFoilInstance.BLRelaxation();
+                sample.m_Value       = m_XFoilInstance.cl;
+
+                ConvergenceMonitor::enumAction action = m_pConvergenceMonitor->onIteration(sample);
+                if(action==ConvergenceMonitor::ABORT)
+                {
+                    m_XFoilInstance.lvconv = false;
+                    iterations = m_IterLim;
+                }
+                else if(action==ConvergenceMonitor::RESEED && !m_XFoilInstance.lvconv)
+                {
+                    // restart from the inviscid solution; the iterations already made still count towards the limit
+                    m_XFoilInstance.lblini = false;
+                    if(!m_XFoilInstance.viscal())
+                    {
+                        m_XFoilInstance.lvconv = false;
+                        return -1;
+                    }
+                }
+            }
         }
-        else iterations = s_IterLim;
+        else iterations = m_IterLim;
     }
 
-    if(s_bCancel)  return -1;// to exit loop
+    if(cancelRequested())  return -1;// to exit loop
 
     if(!m_XFoilInstance.ViscalEnd())
     {
@@ -895,7 +1498,7 @@ int XFoilTask::loop()
         return iterations;
     }
 
-    if(iterations>=s_IterLim && !m_XFoilInstance.lvconv)
+    if(iterations>=m_IterLim && !m_XFoilInstance.lvconv)
     {
         m_XFoilInstance.fcpmin();// Is it of any use?
         return iterations;
@@ -966,12 +1569,29 @@ void XFoilTask::addXFoilData(OpPoint *pOpp, XFoil &xfoil, Foil const *pFoil)
         pOpp->setHingeMoments(pFoil);
     }
 
-    if(!xfoil.lvisc || !xfoil.lvconv)    return;
-
 //---- add boundary layer on both sides of airfoil
     pOpp->m_BLXFoil.nd1=0;
     pOpp->m_BLXFoil.nd2=0;
     pOpp->m_BLXFoil.nd3=0;
+    // the top surface is stored with nd1+1 points, also if there is no BL
+    pOpp->m_BLXFoil.xd1.assign(1, 0.0);
+    pOpp->m_BLXFoil.yd1.assign(1, 0.0);
+    pOpp->m_BLXFoil.xd2.clear();
+    pOpp->m_BLXFoil.yd2.clear();
+    pOpp->m_BLXFoil.xd3.clear();
+    pOpp->m_BLXFoil.yd3.clear();
+
+    if(!xfoil.lvisc || !xfoil.lvconv)    return;
+
+    // only the points in use are stored
+    int nWake = xfoil.nbl[2]-xfoil.iblte[2];
+    pOpp->m_BLXFoil.xd1.assign(xfoil.n+1, 0.0);
+    pOpp->m_BLXFoil.yd1.assign(xfoil.n+1, 0.0);
+    pOpp->m_BLXFoil.xd2.assign(nWake+1, 0.0);
+    pOpp->m_BLXFoil.yd2.assign(nWake+1, 0.0);
+    pOpp->m_BLXFoil.xd3.assign(nWake+1, 0.0);
+    pOpp->m_BLXFoil.yd3.assign(nWake+1, 0.0);
+
     for (is=1; is<=2; is++)
     {
         for (ibl=2; ibl<=xfoil.iblte[is];ibl++)
@@ -1032,24 +1652,34 @@ void XFoilTask::addXFoilData(OpPoint *pOpp, XFoil &xfoil, Foil const *pFoil)
     pOpp->m_BLXFoil.tklam = xfoil.tklam;
     pOpp->m_BLXFoil.qinf = xfoil.qinf;
 
-    memcpy(pOpp->m_BLXFoil.thet, xfoil.thet, IVX * ISX * sizeof(double));
-    memcpy(pOpp->m_BLXFoil.tau,  xfoil.tau,  IVX * ISX * sizeof(double));
-    memcpy(pOpp->m_BLXFoil.ctau, xfoil.ctau, IVX * ISX * sizeof(double));
-    memcpy(pOpp->m_BLXFoil.ctq,  xfoil.ctq,  IVX * ISX * sizeof(double));
-    memcpy(pOpp->m_BLXFoil.dis,  xfoil.dis,  IVX * ISX * sizeof(double));
-    memcpy(pOpp->m_BLXFoil.uedg, xfoil.uedg, IVX * ISX * sizeof(double));
-    memcpy(pOpp->m_BLXFoil.dstr, xfoil.dstr, IVX * ISX * sizeof(double));
-    memcpy(pOpp->m_BLXFoil.delt, xfoil.delt, IVX * ISX * sizeof(double));
     memcpy(pOpp->m_BLXFoil.itran, xfoil.itran, 3 * sizeof(int));
 
     xfoil.createXBL();
-    xfoil.fillHk();
-    xfoil.fillRTheta();
-    memcpy(pOpp->m_BLXFoil.xbl, xfoil.xbl, IVX * ISX * sizeof(double));
-    memcpy(pOpp->m_BLXFoil.Hk, xfoil.Hk, IVX * ISX * sizeof(double));
-    memcpy(pOpp->m_BLXFoil.RTheta, xfoil.RTheta, IVX * ISX * sizeof(double));
     pOpp->m_BLXFoil.nside1 = xfoil.m_nSide1;
     pOpp->m_BLXFoil.nside2 = xfoil.m_nSide2;
+
+    if(!s_bStoreBLStations)
+    {
+        pOpp->m_BLXFoil.clearStations();
+        return;
+    }
+
+    xfoil.fillHk();
+    xfoil.fillRTheta();
+
+    // the stations up to the end of the wake on either side, rather than the whole IVX range
+    int nStations = std::min(std::max(xfoil.m_nSide1, xfoil.m_nSide2)+1, IVX);
+    pOpp->m_BLXFoil.thet.assign(xfoil.thet, nStations);
+    pOpp->m_BLXFoil.tau.assign( xfoil.tau,  nStations);
+    pOpp->m_BLXFoil.ctau.assign(xfoil.ctau, nStations);
+    pOpp->m_BLXFoil.ctq.assign( xfoil.ctq,  nStations);
+    pOpp->m_BLXFoil.dis.assign( xfoil.dis,  nStations);
+    pOpp->m_BLXFoil.uedg.assign(xfoil.uedg, nStations);
+    pOpp->m_BLXFoil.dstr.assign(xfoil.dstr, nStations);
+    pOpp->m_BLXFoil.delt.assign(xfoil.delt, nStations);
+    pOpp->m_BLXFoil.xbl.assign( xfoil.xbl,  nStations);
+    pOpp->m_BLXFoil.Hk.assign(  xfoil.Hk,   nStations);
+    pOpp->m_BLXFoil.RTheta.assign(xfoil.RTheta, nStations);
 }
 
 
@@ -23,9 +23,11 @@
 *****************************************************************************/
 
 
+#include <algorithm>
 #include <cstring>
 
 #include <blxfoil.h>
+#include <utils.h>
 
 BLXFoil::BLXFoil()
 {
@@ -34,29 +36,52 @@ BLXFoil::BLXFoil()
     nd2 = 0;
     nd3 = 0;
 
+    // the top surface is stored with nd1+1 points
+    xd1.assign(1, 0.0);
+    yd1.assign(1, 0.0);
+
     tklam = qinf = 0.0;
 
-    memset(xd1,    0, sizeof(xd1));
-    memset(xd2,    0, sizeof(xd2));
-    memset(xd3,    0, sizeof(xd3));
-    memset(yd1,    0, sizeof(yd1));
-    memset(yd2,    0, sizeof(yd2));
-    memset(yd3,    0, sizeof(yd3));
-    memset(thet,   0, sizeof(thet));
-    memset(tau,    0, sizeof(tau));
-    memset(ctau,   0, sizeof(ctau));
-    memset(ctq,    0, sizeof(ctq));
-    memset(dis,    0, sizeof(dis));
-    memset(dstr,   0, sizeof(dstr));
-    memset(delt,   0, sizeof(delt));
-    memset(uedg,   0, sizeof(uedg));
-    memset(xbl,    0, sizeof(xbl));
-    memset(Hk,     0, sizeof(Hk));
-    memset(RTheta, 0, sizeof(RTheta));
     memset(itran,  0, sizeof(itran));
 }
 
 
+/**
+ * Releases the station arrays, which are only used to plot the BL variables and are not saved.
+ * The displacement surfaces xd and yd are kept.
+ */
+void BLXFoil::clearStations()
+{
+    dstr.clear();
+    delt.clear();
+    thet.clear();
+    tau.clear();
+    dis.clear();
+    ctau.clear();
+    ctq.clear();
+    uedg.clear();
+    xbl.clear();
+    Hk.clear();
+    RTheta.clear();
+}
+
+
+size_t BLXFoil::memoryFootprint() const
+{
+    size_t n = (xd1.capacity()+yd1.capacity()+xd2.capacity()+yd2.capacity()+xd3.capacity()+yd3.capacity())*sizeof(double);
+    n += dstr.bytes() + delt.bytes() + thet.bytes() + tau.bytes() + dis.bytes() + ctau.bytes();
+    n += ctq.bytes() + uedg.bytes() + xbl.bytes() + Hk.bytes() + RTheta.bytes();
+    return n;
+}
+
+
+/** Pads the array with zeros to the number of points which are written, as were the former fixed size arrays */
+static void padColumn(std::vector<double> &column, int n)
+{
+    if(int(column.size())<n) column.resize(std::max(n, 0), 0.0);
+}
+
+
 void BLXFoil::serialize(QDataStream &ar, bool bIsStoring)
 {
     double dble=0.0;
@@ -72,9 +97,12 @@ void BLXFoil::serialize(QDataStream &ar, bool bIsStoring)
         ar << nside1 << nside2;
 
         ar << nd1 << nd2 << nd3;
-        for (int k=0; k<=nd1; k++)  ar << float(xd1[k]) << float(yd1[k]);
-        for (int k=0; k<nd2; k++)   ar << float(xd2[k]) << float(yd2[k]);
-        for (int k=0; k<nd3; k++)    ar << float(xd3[k]) << float(yd3[k]);
+        for(std::vector<double> *pColumn : {&xd1, &yd1}) padColumn(*pColumn, nd1+1);
+        for(std::vector<double> *pColumn : {&xd2, &yd2}) padColumn(*pColumn, nd2);
+        for(std::vector<double> *pColumn : {&xd3, &yd3}) padColumn(*pColumn, nd3);
+        xfl::writeFloatColumns(ar, {xd1.data(), yd1.data()}, nd1+1);
+        xfl::writeFloatColumns(ar, {xd2.data(), yd2.data()}, nd2);
+        xfl::writeFloatColumns(ar, {xd3.data(), yd3.data()}, nd3);
 
         // dynamic space allocation for the future storage of more data, without need to change the format
         nIntSpares=0;
@@ -88,31 +116,20 @@ void BLXFoil::serialize(QDataStream &ar, bool bIsStoring)
     }
     else
     {
-        float f0(0.0f), f1(0.0f);
-
         ar >> ArchiveFormat;
 
         ar >> nside1 >> nside2;
 
         ar >> nd1 >> nd2 >> nd3;
-        for (int k=0; k<=nd1; k++)
-        {
-            ar >> f0 >> f1;
-            xd1[k] = double(f0);
-            yd1[k] = double(f1);
-        }
-        for (int k=0; k<nd2; k++)
-        {
-            ar >> f0 >> f1;
-            xd2[k] = double(f0);
-            yd2[k] = double(f1);
-        }
-        for (int k=0; k<nd3; k++)
-        {
-            ar >> f0 >> f1;
-            xd3[k] = double(f0);
-            yd3[k] = double(f1);
-        }
+        xd1.resize(nd1+1);
+        yd1.resize(nd1+1);
+        xd2.resize(nd2);
+        yd2.resize(nd2);
+        xd3.resize(nd3);
+        yd3.resize(nd3);
+        xfl::readFloatColumns(ar, {xd1.data(), yd1.data()}, nd1+1);
+        xfl::readFloatColumns(ar, {xd2.data(), yd2.data()}, nd2);
+        xfl::readFloatColumns(ar, {xd3.data(), yd3.data()}, nd3);
 
         // space allocation
         ar >> nIntSpares;
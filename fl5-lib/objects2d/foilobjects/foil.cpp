@@ -23,11 +23,14 @@
 *****************************************************************************/
 
 
+#include <algorithm>
+
 #include <QString>
 #include <QDataStream>
 
 
 #include <foil.h>
+#include <memorybudget.h>
 
 #include <bspline.h>
 #include <constants.h>
@@ -40,6 +43,44 @@
 #define MIDPOINTCOUNT 103
 
 
+namespace
+{
+    /** Returns true if the x-coordinates of the points are strictly increasing */
+    bool isXIncreasing(std::vector<Node2d> const &pts)
+    {
+        for(uint i=1; i<pts.size(); i++)
+        {
+            if(pts.at(i).x<=pts.at(i-1).x) return false;
+        }
+        return true;
+    }
+
+
+    /**
+     * Returns the index i of the first segment such that pts[i].x<pts[i+1].x and pts[i].x<=x<=pts[i+1].x,
+     * or -1 if there is none. The search is made by bisection if the x-coordinates are strictly increasing.
+     */
+    int xSegment(std::vector<Node2d> const &pts, double x, bool bIncreasing)
+    {
+        if(pts.size()<2) return -1;
+        if(bIncreasing)
+        {
+            auto it = std::lower_bound(pts.begin()+1, pts.end(), x, [](Node2d const &nd, double xval) {return nd.x<xval;});
+            if(it==pts.end()) return -1;
+            int i = int(it-pts.begin())-1;
+            if(pts.at(i).x<=x) return i;
+            return -1;
+        }
+
+        for(uint i=0; i<pts.size()-1; i++)
+        {
+            if(pts.at(i).x<pts.at(i+1).x && pts.at(i).x<=x && x<=pts.at(i+1).x) return int(i);
+        }
+        return -1;
+    }
+}
+
+
 Foil::Foil()
 {
     resetFoil();
@@ -92,6 +133,7 @@ void Foil::resetFoil()
     m_Bot.clear();
     m_BaseTop.clear();
     m_BaseBot.clear();
+    updateSearchFlags();
 
     m_bTEFlap     = false;
     m_TEFlapAngle = 0.0;
@@ -439,6 +481,19 @@ void Foil::applyBase()
             m_Node[sizeExt+i-1].y = m_Bot.at(i).y;
         }
     }
+    updateSearchFlags();
+}
+
+
+/**
+ * Checks the ordering of the current top, bottom and camber line points after they have been rebuilt.
+ * Must be called by each method which modifies these arrays.
+ */
+void Foil::updateSearchFlags()
+{
+    m_bTopIncreasing    = isXIncreasing(m_Top);
+    m_bBotIncreasing    = isXIncreasing(m_Bot);
+    m_bCbLineIncreasing = isXIncreasing(m_CbLine);
 }
 
 
@@ -495,6 +550,9 @@ void Foil::copy(Foil const &SrcFoil, bool bMeta, bool bForceDeepCopy)
     m_CbLine  = SrcFoil.m_CbLine;
     m_Top   = SrcFoil.m_Top;
     m_Bot   = SrcFoil.m_Bot;
+    m_bTopIncreasing    = SrcFoil.m_bTopIncreasing;
+    m_bBotIncreasing    = SrcFoil.m_bBotIncreasing;
+    m_bCbLineIncreasing = SrcFoil.m_bCbLineIncreasing;
 
     if(bForceDeepCopy)
     {
@@ -763,16 +821,14 @@ Vector2d Foil::midYRel(double sRel, Vector2d &N) const
         return m_CbLine.back();
     }
 
-    for (uint i=0; i<m_CbLine.size()-1; i++)
+    int i = xSegment(m_CbLine, x, m_bCbLineIncreasing);
+    if(i>=0)
     {
-        if (m_CbLine.at(i).x < m_CbLine.at(i+1).x && m_CbLine.at(i).x <= x && x<=m_CbLine.at(i+1).x )
-        {
-            double nabs = sqrt(  (m_CbLine.at(i+1).x-m_CbLine.at(i).x) * (m_CbLine.at(i+1).x-m_CbLine.at(i).x)
-                               + (m_CbLine.at(i+1).y-m_CbLine.at(i).y) * (m_CbLine.at(i+1).y-m_CbLine.at(i).y));
-            N.x = (-m_CbLine.at(i+1).y + m_CbLine.at(i).y)/nabs;
-            N.y = ( m_CbLine.at(i+1).x - m_CbLine.at(i).x)/nabs;
-            return m_CbLine.at(i) + (m_CbLine.at(i+1)-m_CbLine.at(i)) /(m_CbLine.at(i+1).x-m_CbLine.at(i).x) * (x-m_CbLine.at(i).x);
-        }
+        double nabs = sqrt(  (m_CbLine.at(i+1).x-m_CbLine.at(i).x) * (m_CbLine.at(i+1).x-m_CbLine.at(i).x)
+                           + (m_CbLine.at(i+1).y-m_CbLine.at(i).y) * (m_CbLine.at(i+1).y-m_CbLine.at(i).y));
+        N.x = (-m_CbLine.at(i+1).y + m_CbLine.at(i).y)/nabs;
+        N.y = ( m_CbLine.at(i+1).x - m_CbLine.at(i).x)/nabs;
+        return m_CbLine.at(i) + (m_CbLine.at(i+1)-m_CbLine.at(i)) /(m_CbLine.at(i+1).x-m_CbLine.at(i).x) * (x-m_CbLine.at(i).x);
     }
     assert(true); // should never get here
 
@@ -812,16 +868,14 @@ Vector2d Foil::upperYRel(double xRel, Vector2d &N) const
     }
 
 
-    for (uint i=0; i<m_Top.size()-1; i++)
+    int i = xSegment(m_Top, x, m_bTopIncreasing);
+    if(i>=0)
     {
-        if (m_Top.at(i).x < m_Top.at(i+1).x && m_Top.at(i).x <= x && x<=m_Top.at(i+1).x )
-        {
-            double nabs = sqrt(  (m_Top.at(i+1).x-m_Top.at(i).x) * (m_Top.at(i+1).x-m_Top.at(i).x)
-                               + (m_Top.at(i+1).y-m_Top.at(i).y) * (m_Top.at(i+1).y-m_Top.at(i).y));
-            N.x = (-m_Top.at(i+1).y + m_Top.at(i).y)/nabs;
-            N.y = ( m_Top.at(i+1).x - m_Top.at(i).x)/nabs;
-            return m_Top.at(i) + (m_Top.at(i+1)-m_Top.at(i)) /(m_Top.at(i+1).x-m_Top.at(i).x) * (x-m_Top.at(i).x);
-        }
+        double nabs = sqrt(  (m_Top.at(i+1).x-m_Top.at(i).x) * (m_Top.at(i+1).x-m_Top.at(i).x)
+                           + (m_Top.at(i+1).y-m_Top.at(i).y) * (m_Top.at(i+1).y-m_Top.at(i).y));
+        N.x = (-m_Top.at(i+1).y + m_Top.at(i).y)/nabs;
+        N.y = ( m_Top.at(i+1).x - m_Top.at(i).x)/nabs;
+        return m_Top.at(i) + (m_Top.at(i+1)-m_Top.at(i)) /(m_Top.at(i+1).x-m_Top.at(i).x) * (x-m_Top.at(i).x);
     }
     assert(true); // should never get here
     N.x = 1.0;
@@ -863,17 +917,15 @@ Vector2d Foil::lowerYRel(double xRel, Vector2d &N) const
         return m_Bot.back();
     }
 
-    for(uint i=0; i<m_Bot.size()-1; i++)
+    int i = xSegment(m_Bot, x, m_bBotIncreasing);
+    if(i>=0)
     {
-        if (m_Bot.at(i).x<m_Bot.at(i+1).x && m_Bot.at(i).x<= x && x<=m_Bot.at(i+1).x )
-        {
-            double nabs = sqrt((m_Bot.at(i+1).x-m_Bot.at(i).x) * (m_Bot.at(i+1).x-m_Bot.at(i).x)
-                               + (m_Bot.at(i+1).y-m_Bot.at(i).y) * (m_Bot.at(i+1).y-m_Bot.at(i).y));
-            N.x = ( m_Bot.at(i+1).y - m_Bot.at(i).y)/nabs;
-            N.y = (-m_Bot.at(i+1).x + m_Bot.at(i).x)/nabs;
-            return (m_Bot.at(i) + (m_Bot.at(i+1)-m_Bot.at(i))
-                    /(m_Bot.at(i+1).x-m_Bot.at(i).x) * (x-m_Bot.at(i).x));
-        }
+        double nabs = sqrt((m_Bot.at(i+1).x-m_Bot.at(i).x) * (m_Bot.at(i+1).x-m_Bot.at(i).x)
+                           + (m_Bot.at(i+1).y-m_Bot.at(i).y) * (m_Bot.at(i+1).y-m_Bot.at(i).y));
+        N.x = ( m_Bot.at(i+1).y - m_Bot.at(i).y)/nabs;
+        N.y = (-m_Bot.at(i+1).x + m_Bot.at(i).x)/nabs;
+        return (m_Bot.at(i) + (m_Bot.at(i+1)-m_Bot.at(i))
+                /(m_Bot.at(i+1).x-m_Bot.at(i).x) * (x-m_Bot.at(i).x));
     }
 
     assert(true); //should never get here
@@ -1609,7 +1661,11 @@ void Foil::setFlaps()
     m_Bot = m_BaseBot;
     m_CbLine = m_BaseCbLine;
 
-    if(!m_bLEFlap && !m_bTEFlap) return;
+    if(!m_bLEFlap && !m_bTEFlap)
+    {
+        updateSearchFlags();
+        return;
+    }
 
     // modify the current geometry, not the base geometry
     if(m_bLEFlap && fabs(m_LEFlapAngle)>FLAPANGLEPRECISION)
@@ -1633,6 +1689,7 @@ void Foil::setFlaps()
         m_Node[sizeExt+i-1].x = m_Bot.at(i).x;
         m_Node[sizeExt+i-1].y = m_Bot.at(i).y;
     }
+    updateSearchFlags();
 }
 
 
@@ -1773,7 +1830,11 @@ bool Foil::serializeXfl(QDataStream &ar, bool bIsStoring)
 }
 
 
-bool Foil::serializeFl5(QDataStream &ar, bool bIsStoring)
+/**
+ * If bBaseNodes is false, an empty array of base nodes is stored; the caller is then responsible for
+ * providing the nodes on loading, from another record of the archive with the same geometry.
+ */
+bool Foil::serializeFl5(QDataStream &ar, bool bIsStoring, bool bBaseNodes)
 {
     int kj(0), n(0);
     QString strange;
@@ -1809,8 +1870,9 @@ bool Foil::serializeFl5(QDataStream &ar, bool bIsStoring)
         }
         ar << n;
 
-        ar << nBaseNodes(); // store as int!
-        for (int l=0; l<nBaseNodes(); l++)
+        n = bBaseNodes ? nBaseNodes() : 0;
+        ar << n; // store as int!
+        for (int l=0; l<n; l++)
         {
             ar <<m_BaseNode[l].x << m_BaseNode[l].y;
         }
@@ -2076,7 +2138,44 @@ bool Foil::rePanel(int nPanels, double amplitude)
 }
 
 
+/**
+ * Opens or closes the trailing edge to the specified gap, by moving the base nodes of each side
+ * by an amount which decays exponentially from the trailing edge.
+ * @param gap the new gap, as a fraction of the chord
+ * @param blendLength the fraction of the chord over which the displacement is blended
+ */
+void Foil::setTEGap(double gap, double blendLength)
+{
+    double dg = (gap-TEGap());
+    double chordlength = length();
 
+    int n = std::min(m_CubicSpline.ctrlPointCount(), nBaseNodes());
+    for(int i=0; i<n; i++)
+    {
+        double arg = m_TE.x - m_CubicSpline.controlPoint(i).x;
+        //decay exponentially
+        double dth = exp(-arg/(1.0-blendLength)*chordlength);
+        double u = double(i) / double(m_CubicSpline.ctrlPointCount()-1);
+        if(u<m_CSfracLE)
+        {
+            // top surface
+            setBaseNode(i, xb(i), yb(i) + dth * dg/2.0);
+        }
+        else
+        {
+            // bot surface
+            setBaseNode(i, xb(i), yb(i) - dth * dg/2.0);
+        }
+    }
 
+    initGeometry();
+}
 
 
+size_t Foil::memoryFootprint() const
+{
+    return sizeof(Foil)
+         + MemoryBudget::bytes(m_BaseNode) + MemoryBudget::bytes(m_BaseTop) + MemoryBudget::bytes(m_BaseBot)
+         + MemoryBudget::bytes(m_Node)     + MemoryBudget::bytes(m_Top)     + MemoryBudget::bytes(m_Bot)
+         + MemoryBudget::bytes(m_CbLine)   + MemoryBudget::bytes(m_BaseCbLine) + MemoryBudget::bytes(m_Thickness);
+}
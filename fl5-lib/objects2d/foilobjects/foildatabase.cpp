@@ -0,0 +1,460 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <queue>
+
+#include <foildatabase.h>
+
+#include <constants.h>
+#include <foil.h>
+#include <foilpipeline.h>
+#include <objects2d.h>
+#include <objects2d_globals.h>
+#include <polar.h>
+#include <qrleastsquares.h>
+#include <threadpool.h>
+
+
+/** incremented when the content of the index file changes, so that older files are rejected */
+static int const s_DatabaseFormat = 1;
+
+
+/** The cosine-spaced stations, clustered at the LE and the TE; x=0 is excluded since y=0 there */
+std::vector<double> const &FoilDatabase::stations()
+{
+    static std::vector<double> const xs = []
+    {
+        std::vector<double> x(s_nStations);
+        for(int i=0; i<s_nStations; i++) x[i] = 0.5*(1.0-cos(PI*double(i+1)/double(s_nStations)));
+        return x;
+    }();
+    return xs;
+}
+
+
+/**
+ * Fits to the surface y(x) = sqrt(x)(1-x) sum_i A_i B_i(x) + x yTE, where the B_i are the Bernstein
+ * polynomials of order s_nCST-1, in the least square sense at the stations.
+ */
+void FoilDatabase::fitCST(std::vector<double> const &y, double yTE, double *coefs)
+{
+    std::vector<double> const &xs = stations();
+    // the TE station has a null class function and does not constrain the fit
+    int rows = s_nStations-1;
+    int n = s_nCST-1;
+
+    std::vector<double> A(size_t(rows)*s_nCST), b(rows);
+    for(int i=0; i<rows; i++)
+    {
+        double x = xs.at(i);
+        double c = sqrt(x)*(1.0-x);
+        for(int j=0; j<s_nCST; j++)
+        {
+            double binomial = std::tgamma(n+1)/std::tgamma(j+1)/std::tgamma(n-j+1);
+            A[size_t(i)*s_nCST+j] = c * binomial * pow(x, j) * pow(1.0-x, n-j);
+        }
+        b[i] = y.at(i) - x*yTE;
+    }
+    QRLeastSquares(A.data(), b.data(), coefs, rows, s_nCST);
+}
+
+
+/**
+ * Builds the descriptors and the resampled shape of a normalized and derotated copy of the foil.
+ * @return false if the geometry could not be built.
+ */
+bool FoilDatabase::makeEntry(Foil const &foil, Entry &entry, std::vector<float> &shape)
+{
+    if(foil.nBaseNodes()<=0) return false;
+
+    Foil normalized;
+    normalized.copy(foil, false);
+
+    FoilPipeline pipeline;
+    pipeline.addDeRotate();
+    pipeline.addNormalize();
+    if(!pipeline.process(normalized)) return false;
+
+    entry.m_Name = foil.name();
+
+    Descriptors &d = entry.m_Descriptors;
+    d.m_Thickness  = normalized.maxThickness();
+    d.m_XThickness = normalized.xThickness();
+    d.m_Camber     = normalized.maxCamber();
+    d.m_XCamber    = normalized.xCamber();
+    d.m_TEGap      = normalized.TEGap();
+
+    std::vector<double> const &xs = stations();
+    std::vector<double> ytop(s_nStations), ybot(s_nStations);
+    Vector2d N;
+    double yLE = normalized.LE().y;
+    for(int i=0; i<s_nStations; i++)
+    {
+        ytop[i] = normalized.upperYRel(xs.at(i), N).y - yLE;
+        ybot[i] = normalized.lowerYRel(xs.at(i), N).y - yLE;
+    }
+
+    fitCST(ytop, ytop.back(), entry.m_CSTTop);
+    fitCST(ybot, ybot.back(), entry.m_CSTBot);
+    // the LE radius of a CST surface is A0²/2
+    d.m_LERadius = 0.25*(entry.m_CSTTop[0]*entry.m_CSTTop[0] + entry.m_CSTBot[0]*entry.m_CSTBot[0]);
+
+    shape.resize(2*s_nStations);
+    for(int i=0; i<s_nStations; i++)
+    {
+        shape[i]             = float(ytop.at(i));
+        shape[s_nStations+i] = float(ybot.at(i));
+    }
+    return true;
+}
+
+
+int FoilDatabase::indexOf(std::string const &path) const
+{
+    for(int i=0; i<nEntries(); i++)
+    {
+        if(m_Entries.at(i).m_Path==path) return i;
+    }
+    return -1;
+}
+
+
+/**
+ * Indexes the foil under the path of its file; an existing entry with the same path is replaced.
+ * @return the index of the entry, or -1 if the foil's geometry is invalid.
+ */
+int FoilDatabase::addFoil(Foil const &foil, std::string const &path)
+{
+    Entry entry;
+    std::vector<float> shape;
+    if(!makeEntry(foil, entry, shape)) return -1;
+    entry.m_Path = path;
+
+    int i = indexOf(path);
+    if(i>=0)
+    {
+        m_Entries[i] = entry;
+        std::copy(shape.begin(), shape.end(), m_Shapes.begin()+ptrdiff_t(i)*2*s_nStations);
+        return i;
+    }
+    m_Entries.push_back(entry);
+    m_Shapes.insert(m_Shapes.end(), shape.begin(), shape.end());
+    return nEntries()-1;
+}
+
+
+/**
+ * Reads and indexes the foil files concurrently; the foils are not kept in memory.
+ * @return the number of files indexed.
+ */
+int FoilDatabase::addFiles(std::vector<std::string> const &paths, std::string &log)
+{
+    int nFiles = int(paths.size());
+    std::vector<Entry> entries(nFiles);
+    std::vector<std::vector<float>> shapes(nFiles);
+    std::vector<char> success(nFiles, 0);
+
+    ThreadPool::pool().parallelFor(nFiles, [&](int i)
+    {
+        Foil foil;
+        int iLineError = 0;
+        if(!objects::readFoilFile(paths.at(i), &foil, iLineError)) return;
+        if(makeEntry(foil, entries[i], shapes[i])) success[i] = 1;
+    });
+
+    int nAdded = 0;
+    for(int i=0; i<nFiles; i++)
+    {
+        if(!success[i])
+        {
+            log += "   Could not index the file " + paths.at(i) + "\n";
+            continue;
+        }
+        entries[i].m_Path = paths.at(i);
+        int ie = indexOf(paths.at(i));
+        if(ie>=0)
+        {
+            m_Entries[ie] = entries[i];
+            std::copy(shapes[i].begin(), shapes[i].end(), m_Shapes.begin()+ptrdiff_t(ie)*2*s_nStations);
+        }
+        else
+        {
+            m_Entries.push_back(entries[i]);
+            m_Shapes.insert(m_Shapes.end(), shapes[i].begin(), shapes[i].end());
+        }
+        nAdded++;
+    }
+    return nAdded;
+}
+
+
+void FoilDatabase::removeEntry(int i)
+{
+    if(i<0 || i>=nEntries()) return;
+    m_Entries.erase(m_Entries.begin()+i);
+    m_Shapes.erase(m_Shapes.begin()+ptrdiff_t(i)*2*s_nStations, m_Shapes.begin()+ptrdiff_t(i+1)*2*s_nStations);
+}
+
+
+/**
+ * The k entries closest to the target, sorted by increasing distance. The distance is the rms
+ * difference of the resampled coordinates; the sum over an entry is abandoned once it exceeds
+ * the current k-th best distance.
+ */
+std::vector<FoilDatabase::Match> FoilDatabase::nearestShape(float const *target, int k, Filter const &filter) const
+{
+    std::vector<Match> matches;
+    if(k<=0) return matches;
+
+    // a max-heap of the best distances found so far, the largest on top
+    auto compare = [](Match const &a, Match const &b) {return a.m_Distance<b.m_Distance;};
+    std::priority_queue<Match, std::vector<Match>, decltype(compare)> best(compare);
+
+    int nValues = 2*s_nStations;
+    for(int i=0; i<nEntries(); i++)
+    {
+        if(filter && !filter(i)) continue;
+
+        double bound = int(best.size())<k ? LARGEVALUE : best.top().m_Distance;
+        float const *s = shape(i);
+        double d2 = 0.0;
+        for(int j=0; j<nValues && d2<bound; j++)
+        {
+            double dy = double(s[j]-target[j]);
+            d2 += dy*dy;
+        }
+        if(d2>=bound) continue;
+
+        if(int(best.size())==k) best.pop();
+        best.push({i, d2});
+    }
+
+    matches.resize(best.size());
+    for(int i=int(best.size())-1; i>=0; i--)
+    {
+        matches[i] = best.top();
+        matches[i].m_Distance = sqrt(matches[i].m_Distance/double(nValues));
+        best.pop();
+    }
+    return matches;
+}
+
+
+/** The k indexed foils closest in shape to the target foil */
+std::vector<FoilDatabase::Match> FoilDatabase::nearest(Foil const &target, int k, Filter const &filter) const
+{
+    Entry entry;
+    std::vector<float> targetshape;
+    if(!makeEntry(target, entry, targetshape)) return std::vector<Match>();
+    return nearestShape(targetshape.data(), k, filter);
+}
+
+
+/** The k indexed foils closest in shape to the entry, excluding the entry itself */
+std::vector<FoilDatabase::Match> FoilDatabase::nearest(int iEntry, int k, Filter const &filter) const
+{
+    if(iEntry<0 || iEntry>=nEntries()) return std::vector<Match>();
+    return nearestShape(shape(iEntry), k, [&filter, iEntry](int i) {return i!=iEntry && (!filter || filter(i));});
+}
+
+
+/**
+ * The k entries closest to the target descriptors. Each descriptor's difference is scaled by
+ * a typical variation and by its weight; a null weight ignores the descriptor.
+ */
+std::vector<FoilDatabase::Match> FoilDatabase::nearest(Descriptors const &target, Descriptors const &weights, int k, Filter const &filter) const
+{
+    std::vector<Match> matches;
+    for(int i=0; i<nEntries(); i++)
+    {
+        if(filter && !filter(i)) continue;
+        Descriptors const &d = m_Entries.at(i).m_Descriptors;
+        double dist = 0.0;
+        auto add = [&dist](double x, double xt, double w, double scale) {dist += w * (x-xt)*(x-xt)/scale/scale;};
+        add(d.m_Thickness,  target.m_Thickness,  weights.m_Thickness,  0.01);
+        add(d.m_XThickness, target.m_XThickness, weights.m_XThickness, 0.1);
+        add(d.m_Camber,     target.m_Camber,     weights.m_Camber,     0.01);
+        add(d.m_XCamber,    target.m_XCamber,    weights.m_XCamber,    0.1);
+        add(d.m_LERadius,   target.m_LERadius,   weights.m_LERadius,   0.005);
+        add(d.m_TEGap,      target.m_TEGap,      weights.m_TEGap,      0.005);
+        matches.push_back({i, sqrt(dist)});
+    }
+
+    int n = std::min(std::max(k, 0), int(matches.size()));
+    std::partial_sort(matches.begin(), matches.begin()+n, matches.end(), [](Match const &a, Match const &b) {return a.m_Distance<b.m_Distance;});
+    matches.resize(n);
+    return matches;
+}
+
+
+/**
+ * Reads the entry's foil from its file.
+ * @return a new foil owned by the caller, or nullptr if the file could not be read.
+ */
+Foil *FoilDatabase::loadFoil(int i) const
+{
+    if(i<0 || i>=nEntries()) return nullptr;
+    Foil *pFoil = new Foil;
+    int iLineError = 0;
+    if(!objects::readFoilFile(m_Entries.at(i).m_Path, pFoil, iLineError))
+    {
+        delete pFoil;
+        return nullptr;
+    }
+    return pFoil;
+}
+
+
+/**
+ * Searches the k nearest neighbours of the target in order of distance for one which has been analysed,
+ * i.e. which has a fixed speed polar with data in the current ObjectStore, and returns its polar
+ * with the Reynolds number closest to Re. The polar gives an estimate of the aoa at which
+ * the target reaches a given Cl, from which an analysis can be started.
+ * @return the polar, or nullptr if no neighbour has been analysed.
+ */
+Polar *FoilDatabase::nearestAnalysedPolar(Foil const &target, double Re, int k) const
+{
+    if(Re<=0.0) return nullptr;
+    std::vector<Match> const matches = nearest(target, k);
+    for(Match const &match : matches)
+    {
+        std::string const &name = m_Entries.at(match.m_Index).m_Name;
+        Polar *pBest = nullptr;
+        double bestgap = LARGEVALUE;
+        for(int ip=0; ip<Objects2d::nPolars(); ip++)
+        {
+            Polar *pPolar = Objects2d::polar(ip);
+            if(pPolar->foilName()!=name || !pPolar->isFixedSpeedPolar() || !pPolar->hasData() || pPolar->Reynolds()<=0.0) continue;
+            double gap = fabs(log(pPolar->Reynolds()/Re));
+            if(gap<bestgap)
+            {
+                bestgap = gap;
+                pBest = pPolar;
+            }
+        }
+        if(pBest) return pBest;
+    }
+    return nullptr;
+}
+
+
+static void writeString(std::ofstream &file, std::string const &str)
+{
+    int n = int(str.size());
+    file.write(reinterpret_cast<char const*>(&n), sizeof(int));
+    file.write(str.data(), n);
+}
+
+
+static bool readString(std::ifstream &file, std::string &str)
+{
+    int n = 0;
+    if(!file.read(reinterpret_cast<char*>(&n), sizeof(int)) || n<0 || n>65536) return false;
+    str.resize(n);
+    return bool(file.read(&str[0], n));
+}
+
+
+/**
+ * Reads the index file, replacing the current entries.
+ * @return false if the file could not be read or has another format, in which case the database is empty.
+ */
+bool FoilDatabase::load(std::string const &path)
+{
+    clear();
+
+    std::ifstream file(path, std::ios::binary);
+    if(!file) return false;
+
+    int header[4] = {0,0,0,0};
+    if(!file.read(reinterpret_cast<char*>(header), sizeof(header))) return false;
+    if(header[0]!=s_DatabaseFormat || header[1]!=s_nStations || header[2]!=s_nCST || header[3]<0) return false;
+
+    int n = header[3];
+    m_Entries.resize(n);
+    m_Shapes.resize(size_t(n)*2*s_nStations);
+    for(int i=0; i<n; i++)
+    {
+        Entry &entry = m_Entries[i];
+        Descriptors &d = entry.m_Descriptors;
+        double values[6];
+        if(   !readString(file, entry.m_Name) || !readString(file, entry.m_Path)
+           || !file.read(reinterpret_cast<char*>(values), sizeof(values))
+           || !file.read(reinterpret_cast<char*>(entry.m_CSTTop), sizeof(entry.m_CSTTop))
+           || !file.read(reinterpret_cast<char*>(entry.m_CSTBot), sizeof(entry.m_CSTBot))
+           || !file.read(reinterpret_cast<char*>(m_Shapes.data()+size_t(i)*2*s_nStations), 2*s_nStations*sizeof(float)))
+        {
+            clear();
+            return false;
+        }
+        d.m_Thickness  = values[0];
+        d.m_XThickness = values[1];
+        d.m_Camber     = values[2];
+        d.m_XCamber    = values[3];
+        d.m_LERadius   = values[4];
+        d.m_TEGap      = values[5];
+    }
+    return true;
+}
+
+
+/** Writes the index file, through a temporary file so that an interrupted write leaves the previous file intact */
+bool FoilDatabase::save(std::string const &path) const
+{
+    std::error_code ec;
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if(!parent.empty()) std::filesystem::create_directories(parent, ec);
+
+    std::string temppath = path + ".tmp";
+    {
+        std::ofstream file(temppath, std::ios::binary | std::ios::trunc);
+        int header[4] = {s_DatabaseFormat, s_nStations, s_nCST, nEntries()};
+        file.write(reinterpret_cast<char const*>(header), sizeof(header));
+        for(int i=0; i<nEntries(); i++)
+        {
+            Entry const &entry = m_Entries.at(i);
+            Descriptors const &d = entry.m_Descriptors;
+            double values[6] = {d.m_Thickness, d.m_XThickness, d.m_Camber, d.m_XCamber, d.m_LERadius, d.m_TEGap};
+            writeString(file, entry.m_Name);
+            writeString(file, entry.m_Path);
+            file.write(reinterpret_cast<char const*>(values), sizeof(values));
+            file.write(reinterpret_cast<char const*>(entry.m_CSTTop), sizeof(entry.m_CSTTop));
+            file.write(reinterpret_cast<char const*>(entry.m_CSTBot), sizeof(entry.m_CSTBot));
+            file.write(reinterpret_cast<char const*>(shape(i)), 2*s_nStations*sizeof(float));
+        }
+        if(!file)
+        {
+            file.close();
+            std::filesystem::remove(temppath, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(temppath, path, ec);
+    return !ec;
+}
+
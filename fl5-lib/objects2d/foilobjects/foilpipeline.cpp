@@ -0,0 +1,202 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <cmath>
+
+#include <foilpipeline.h>
+
+#include <constants.h>
+#include <foil.h>
+#include <geom_params.h>
+#include <polar.h>
+#include <threadpool.h>
+#include <xfoilbatchengine.h>
+
+
+void FoilPipeline::addNormalize()
+{
+    Operation op;
+    op.m_Type = NORMALIZE;
+    m_Operations.push_back(op);
+}
+
+
+void FoilPipeline::addDeRotate()
+{
+    Operation op;
+    op.m_Type = DEROTATE;
+    m_Operations.push_back(op);
+}
+
+
+void FoilPipeline::addRePanel(int nPanels, double amplitude)
+{
+    Operation op;
+    op.m_Type = REPANEL;
+    op.m_nPanels = nPanels;
+    op.m_Amplitude = amplitude;
+    m_Operations.push_back(op);
+}
+
+
+void FoilPipeline::addTEGap(double gap, double blendLength)
+{
+    Operation op;
+    op.m_Type = TEGAP;
+    op.m_Gap = gap;
+    op.m_Blend = blendLength;
+    m_Operations.push_back(op);
+}
+
+
+void FoilPipeline::addTEFlap(double xhinge, double yhinge, double angle)
+{
+    Operation op;
+    op.m_Type = TEFLAP;
+    op.m_XHinge = xhinge;
+    op.m_YHinge = yhinge;
+    op.m_Angle = angle;
+    m_Operations.push_back(op);
+}
+
+
+void FoilPipeline::addLEFlap(double xhinge, double yhinge, double angle)
+{
+    Operation op;
+    op.m_Type = LEFLAP;
+    op.m_XHinge = xhinge;
+    op.m_YHinge = yhinge;
+    op.m_Angle = angle;
+    m_Operations.push_back(op);
+}
+
+
+/**
+ * Applies the operations in sequence to the foil, in the same way as the foil edition dialogs.
+ * The flaps are made permanent, so that each operation applies to the geometry left by the previous one.
+ * @return false if the foil has no nodes or if an operation failed.
+ */
+bool FoilPipeline::process(Foil &foil) const
+{
+    if(foil.nBaseNodes()<=0) return false;
+
+    // the spline, the mid line and the LE are up to date
+    bool bGeometry = false;
+
+    for(Operation const &op : m_Operations)
+    {
+        if(!bGeometry)
+        {
+            if(!foil.initGeometry()) return false;
+            bGeometry = true;
+        }
+
+        switch(op.m_Type)
+        {
+            case NORMALIZE:
+                foil.normalizeGeometry();
+                bGeometry = false;
+                break;
+            case DEROTATE:
+                foil.deRotate();
+                bGeometry = false;
+                break;
+            case REPANEL:
+                if(!foil.rePanel(op.m_nPanels, op.m_Amplitude)) return false;
+                bGeometry = false;
+                break;
+            case TEGAP:
+                foil.setTEGap(op.m_Gap, op.m_Blend); // rebuilds the geometry
+                break;
+            case TEFLAP:
+            case LEFLAP:
+            {
+                if(fabs(op.m_Angle)<FLAPANGLEPRECISION) break;
+                if(op.m_Type==TEFLAP) foil.setTEFlapData(true, op.m_XHinge, op.m_YHinge, op.m_Angle);
+                else                  foil.setLEFlapData(true, op.m_XHinge, op.m_YHinge, op.m_Angle);
+                foil.setFlaps();
+                foil.makeModPermanent(); // also clears the flaps
+                bGeometry = false;
+                break;
+            }
+        }
+    }
+
+    if(!bGeometry) return foil.initGeometry();
+    return true;
+}
+
+
+/**
+ * Processes the foils concurrently on the ThreadPool; the foils are modified in place.
+ * @param pSuccess if not null, is filled with the outcome for each foil.
+ * @return the number of foils processed successfully.
+ */
+int FoilPipeline::run(std::vector<Foil*> const &foils, std::vector<bool> *pSuccess) const
+{
+    int nFoils = int(foils.size());
+    std::vector<char> success(nFoils, 0);
+
+    ThreadPool::pool().parallelFor(nFoils, [&](int i)
+    {
+        if(foils.at(i)) success[i] = process(*foils.at(i)) ? 1 : 0;
+    });
+
+    int nOk = 0;
+    if(pSuccess) pSuccess->resize(nFoils);
+    for(int i=0; i<nFoils; i++)
+    {
+        if(success[i]) nOk++;
+        if(pSuccess) (*pSuccess)[i] = success[i];
+    }
+    return nOk;
+}
+
+
+/**
+ * Adds to the engine one job per foil, each with a new polar which has the specification of polarSpec.
+ * The foils and the returned polars must remain valid until the engine has finished; the caller owns the polars.
+ */
+std::vector<Polar*> FoilPipeline::queueJobs(XFoilBatchEngine &engine, std::vector<Foil*> const &foils, Polar const &polarSpec,
+                                            std::vector<AnalysisRange> const &ranges, bool bAlpha)
+{
+    std::vector<Polar*> polars;
+    for(Foil *pFoil : foils)
+    {
+        if(!pFoil || pFoil->nNodes()<=0) continue;
+
+        Polar *pPolar = new Polar;
+        pPolar->copySpecification(polarSpec);
+        pPolar->setFoilName(pFoil->name());
+        polars.push_back(pPolar);
+
+        XFoilJob job;
+        job.m_pFoil  = pFoil;
+        job.m_pPolar = pPolar;
+        job.m_Ranges = ranges;
+        job.m_bAlpha = bAlpha;
+        engine.addJob(job);
+    }
+    return polars;
+}
@@ -26,6 +26,7 @@
 
 
 #include <oppoint.h>
+#include <memorybudget.h>
 
 #include <foil.h>
 #include <polar.h>
@@ -283,6 +284,12 @@ bool OpPoint::serializeOppXFL(QDataStream &ar, bool bIsStoring, int ArchiveForma
             m_Qv[k] = double(f0);
             m_Qi[k] = double(f1);
         }
+        m_BLXFoil.xd1.resize(m_BLXFoil.nd1+1);
+        m_BLXFoil.yd1.resize(m_BLXFoil.nd1+1);
+        m_BLXFoil.xd2.resize(m_BLXFoil.nd2);
+        m_BLXFoil.yd2.resize(m_BLXFoil.nd2);
+        m_BLXFoil.xd3.resize(m_BLXFoil.nd3);
+        m_BLXFoil.yd3.resize(m_BLXFoil.nd3);
         for (k=0; k<=m_BLXFoil.nd1; k++)
         {
             ar >> f0 >> f1;
@@ -366,8 +373,14 @@ bool OpPoint::serializeOppFl5(QDataStream &ar, bool bIsStoring)
         }*/
 
         ar << int(m_Qi.size());
-        for (uint l=0; l<m_Qi.size(); l++)     ar << float(m_Cpv[l]) << float(m_Cpi[l]);
-        for (uint l=0; l<m_Qi.size(); l++)     ar << float(m_Qv[l])  << float(m_Qi[l]);
+        std::vector<double> Cp(2*m_Qi.size());
+        for (uint l=0; l<m_Qi.size(); l++)
+        {
+            Cp[2*l]   = double(m_Cpv[l]);
+            Cp[2*l+1] = double(m_Cpi[l]);
+        }
+        xfl::writeFloatArray(ar, Cp.data(), int(Cp.size()));
+        xfl::writeFloatColumns(ar, {m_Qv.data(),  m_Qi.data()},  int(m_Qi.size()));
 
         if(m_BLMethod==BL::XFOIL)
         {
@@ -433,20 +446,16 @@ bool OpPoint::serializeOppFl5(QDataStream &ar, bool bIsStoring)
         resizeSurfacePoints(n);
         if(ArchiveFormat>=500002)
         {
+            std::vector<double> Cp(2*size_t(std::max(n,0)));
+            if(!xfl::readFloatArray(ar, Cp.data(), int(Cp.size()))) return false;
             for (int l=0; l<n; l++)
             {
-                ar >> f0 >> f1;
-                m_Cpv[l] = double(f0);
-                m_Cpi[l] = double(f1);
+                m_Cpv[l] = float(Cp[2*l]);
+                m_Cpi[l] = float(Cp[2*l+1]);
             }
         }
 
-        for (int l=0; l<n; l++)
-        {
-            ar >> f0 >> f1;
-            m_Qv[l] = double(f0);
-            m_Qi[l] = double(f1);
-        }
+        if(!xfl::readFloatColumns(ar, {m_Qv.data(), m_Qi.data()}, n)) return false;
 
         if(ArchiveFormat>=500004)
         {
@@ -546,3 +555,9 @@ void OpPoint::resizeSurfacePoints(int N)
     std::fill(m_Qv.begin(), m_Qv.end(), 0.0);
 }
 
+
+size_t OpPoint::memoryFootprint() const
+{
+    return sizeof(OpPoint) + MemoryBudget::bytes(m_Cpi) + MemoryBudget::bytes(m_Cpv) + MemoryBudget::bytes(m_Qv) + MemoryBudget::bytes(m_Qi)
+            + m_BLXFoil.memoryFootprint();
+}
@@ -22,6 +22,7 @@
 
 *****************************************************************************/
 
+#include <algorithm>
 #include <sstream>
 #include <QString>
 #include <QTextStream>
@@ -30,14 +31,19 @@
 #include <constants.h>
 #include <foil.h>
 #include <polar.h>
+#include <memorybudget.h>
 #include <oppoint.h>
 #include <geom_params.h>
 #include <fl5core.h>
+#include <sgsmooth.h>
 
 std::vector<std::string> Polar::s_VariableNames = {ALPHAstr + " ("+DEGstr + ")", THETAstr + " ("+DEGstr + ")", "Cl", "Cd", "Cdp", "Cm",
                                      "HMom", "Cpmin", "Cl/Cd", "|Cl|^(3/2)/Cd", "1/sqrt(Cl)", "Re", "XCp",
                                      "Xtr_top", "Xtr_bot"};
 
+bool Polar::s_bFittedInterpolation = false;
+std::atomic<int> Polar::s_LastDataRevision(0);
+
 Polar::Polar() : XflObject()
 {
     m_Reynolds = 1.0e6;
@@ -56,6 +62,7 @@ Polar::Polar() : XflObject()
     m_FoilName.clear();
     m_Name.clear();
 
+    setDataModified();
 }
 
 
@@ -74,6 +81,8 @@ Polar::Polar(double Re, double NCrit, double xTrTop, double xTrBot, BL::enumBLMe
     m_XTripBot = xTrBot;
     m_FoilName.clear();
     m_Name.clear();
+
+    setDataModified();
 }
 
 
@@ -175,6 +184,7 @@ void Polar::exportToString(std::string &outstring, bool bDataOnly, bool bCSV) co
 
 void Polar::reset()
 {
+    setDataModified();
     m_Alpha.clear();
     m_Control.clear();
     m_Cl.clear();
@@ -274,6 +284,7 @@ void Polar::addOpPointData(OpPoint *pOpPoint)
 
 void Polar::replaceOppDataAt(int pos, OpPoint const *pOpp)
 {
+    setDataModified();
     if(pos<0 || pos>= int(m_Alpha.size())) return;
 
     m_Alpha[pos]   =  pOpp->aoa();
@@ -315,6 +326,7 @@ void Polar::replaceOppDataAt(int pos, OpPoint const *pOpp)
 
 void Polar::insertOppDataAt(int i, OpPoint const *pOpp)
 {
+    setDataModified();
     m_Alpha.insert(      m_Alpha.begin()+i, pOpp->aoa());
     m_Control.insert(    m_Control.begin()+i, pOpp->theta());
     m_Cd.insert(         m_Cd.begin()+i, pOpp->m_Cd);
@@ -429,6 +441,7 @@ void Polar::copySpecification(Polar const*pPolar)
 
 void Polar::copySpecification(Polar const &polar)
 {
+    setDataModified();
     m_Name        = polar.m_Name;
     m_FoilName    = polar.m_FoilName;
 
@@ -453,6 +466,7 @@ void Polar::copySpecification(Polar const &polar)
 
 void Polar::removePoint(int i)
 {
+    setDataModified();
     m_Alpha.erase(m_Alpha.begin() + i);
     m_Control.erase(m_Control.begin() + i);
     m_Cl.erase(m_Cl.begin() + i);
@@ -477,6 +491,7 @@ void Polar::removePoint(int i)
 
 void Polar::insertPoint(int i)
 {
+    setDataModified();
     m_Alpha.insert(m_Alpha.begin()+i, 0.0);
     m_Control.insert(m_Control.begin()+i, 0.0);
     m_Cl.insert(m_Cl.begin()+i, 0.0);
@@ -680,6 +695,7 @@ void Polar::getLinearizedCl(double &Alpha0, double &slope) const
 
 void Polar::setType(xfl::enumPolarType type)
 {
+    setDataModified();
     m_Type =type;
     switch (m_Type)
     {
@@ -804,6 +820,7 @@ std::string Polar::properties()
 
 bool Polar::serializePolarXFL(QDataStream &ar, bool bIsStoring)
 {
+    if(!bIsStoring) setDataModified();
     double dble(0.0);
     bool boolean(false);
     int i(0), k(0), n(0);
@@ -920,6 +937,7 @@ bool Polar::serializePolarXFL(QDataStream &ar, bool bIsStoring)
 
 bool Polar::serializePolarFl5(QDataStream &ar, bool bIsStoring)
 {
+    if(!bIsStoring) setDataModified();
     int nIntSpares(0);
     int nDbleSpares(0);
 
@@ -979,18 +997,10 @@ bool Polar::serializePolarFl5(QDataStream &ar, bool bIsStoring)
         nVariables = 12; // change to add new variables
         ar << nVariables;
         ar << int(m_Alpha.size());
-        for (uint l=0; l< m_Alpha.size(); l++)
-        {
-            ar << float(m_Alpha.at(l)) << float(m_Cd.at(l));
-            ar << float(m_Cdp.at(l))   << float(m_Cl.at(l)) << float(m_Cm.at(l));
-            ar << float(m_HMom.at(l))  << float(m_Cpmn.at(l));
-            ar << float(m_Re.at(l));
-            ar << float(m_XCp.at(l));
-            ar << float(m_Control.at(l));
-            ar << float(m_XTrTop.at(l)) << float(m_XTrBot.at(l));
-            ar << float(m_XLamSepTop.at(l)) << float(m_XLamSepBot.at(l));
-            ar << float(m_XTurbSepTop.at(l)) << float(m_XTurbSepBot.at(l));
-        }
+        xfl::writeFloatColumns(ar, {m_Alpha.data(), m_Cd.data(), m_Cdp.data(), m_Cl.data(), m_Cm.data(),
+                                    m_HMom.data(), m_Cpmn.data(), m_Re.data(), m_XCp.data(), m_Control.data(),
+                                    m_XTrTop.data(), m_XTrBot.data(), m_XLamSepTop.data(), m_XLamSepBot.data(),
+                                    m_XTurbSepTop.data(), m_XTurbSepBot.data()}, int(m_Alpha.size()));
 
         // dynamic space allocation for the future storage of more data, without need to change the format
         nIntSpares=0;
@@ -1005,10 +1015,6 @@ bool Polar::serializePolarFl5(QDataStream &ar, bool bIsStoring)
     }
     else
     {
-        //read variables
-        float Alpha, Cd(0), Cdp(0), Cl(0), Cm(0), HMom(0), Cpmn(0), Re(0), XCp(0), Ctrl(0);
-        float XTr1(0), XTr2(0), XLSTop(0), XLSBot(0), XTSTop(0), XTSBot(0);
-
         ar >> ArchiveFormat;
         if (ArchiveFormat<500000 || ArchiveFormat>501000) return false;
 
@@ -1063,12 +1069,13 @@ bool Polar::serializePolarFl5(QDataStream &ar, bool bIsStoring)
 
         ar >> nVariables;
         ar >> n;
+        if(n<0) return false;
+        std::vector<double> values(size_t(n)*16);
+        if(!xfl::readFloatArray(ar, values.data(), 16*n)) return false;
         for (int i=0; i< n; i++)
         {
-            ar >> Alpha >> Cd >> Cdp >> Cl >> Cm >> HMom >> Cpmn >> Re >> XCp >> Ctrl;
-            ar >> XTr1 >> XTr2 >> XLSTop >> XLSBot >> XTSTop >>XTSBot;
-            addPoint(double(Alpha), double(Cd), double(Cdp), double(Cl), double(Cm), double(HMom), double(Cpmn), double(Re), double(XCp), double(Ctrl),
-                     double(XTr1), double(XTr2), double(XLSTop), double(XLSBot), double(XTSTop), double(XTSBot));
+            double const *v = values.data() + 16*size_t(i);
+            addPoint(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10], v[11], v[12], v[13], v[14], v[15]);
         }
 
         // space allocation
@@ -1296,8 +1303,284 @@ double Polar::interpolateFromCl(double Cl, Polar::enumPolarVariable PlrVar, bool
 }
 
 
+/**
+ * Makes the curve through the points (x, y), where x is strictly increasing.
+ * If bSmooth is true, the values are first smoothed by a parabolic Savitzky-Golay filter on five points,
+ * which removes the scatter of the converged XFoil points without shifting the stall.
+ */
+void Polar::FittedCurve::make(std::vector<double> const &x, std::vector<double> const &y, bool bSmooth)
+{
+    m_x = x;
+    m_y = y;
+    int n = int(m_x.size());
+    m_dy.assign(n, 0.0);
+    if(n<2) return;
+
+    if(bSmooth)
+    {
+        std::vector<double> ysm;
+        if(sgsmooth::smooth_nonuniform(2, 2, m_x, m_y, ysm)) m_y.swap(ysm);
+    }
+
+    std::vector<double> d(n-1);
+    for(int i=0; i<n-1; i++) d[i] = (m_y[i+1]-m_y[i])/(m_x[i+1]-m_x[i]);
+
+    m_dy[0]   = d.front();
+    m_dy[n-1] = d.back();
+    for(int i=1; i<n-1; i++)
+    {
+        // zero slope at the local extrema, weighted harmonic mean elsewhere
+        if(d[i-1]*d[i]<=0.0) continue;
+        double h0 = m_x[i]  -m_x[i-1];
+        double h1 = m_x[i+1]-m_x[i];
+        double w1 = 2.0*h1+h0;
+        double w2 = h1+2.0*h0;
+        m_dy[i] = (w1+w2)/(w1/d[i-1]+w2/d[i]);
+    }
+}
+
+
+/** Evaluates the curve; the interval is located by bisection */
+double Polar::FittedCurve::value(double x) const
+{
+    int n = int(m_x.size());
+    auto it = std::upper_bound(m_x.begin(), m_x.end(), x);
+    int k = std::max(0, std::min(int(it-m_x.begin())-1, n-2));
+
+    double h = m_x[k+1]-m_x[k];
+    double t = (x-m_x[k])/h;
+    double t2 = t*t;
+    double t3 = t2*t;
+    return (2.0*t3-3.0*t2+1.0)*m_y[k] + (t3-2.0*t2+t)*h*m_dy[k] + (-2.0*t3+3.0*t2)*m_y[k+1] + (t3-t2)*h*m_dy[k+1];
+}
+
+
+/** The variables represented by the fitted curves */
+static Polar::enumPolarVariable const s_FitVariables[] = {Polar::CL, Polar::CD, Polar::CDP, Polar::CM, Polar::XTRTOP, Polar::XTRBOT};
+
+
+/** Returns the position of the variable in the arrays of curves, or -1 if the variable is not fitted */
+int Polar::InterpolationFit::fitIndex(enumPolarVariable var)
+{
+    switch(var)
+    {
+        case Polar::CL:     return 0;
+        case Polar::CD:     return 1;
+        case Polar::CDP:    return 2;
+        case Polar::CM:     return 3;
+        case Polar::XTRTOP: return 4;
+        case Polar::XTRBOT: return 5;
+        default:            return -1;
+    }
+}
+
+
+/**
+ * Makes the curves of the fitted variables on the points [iFirst, iLast] of the array par, which is non-decreasing
+ * on these points; the points closer than the precision of the linear interpolation are merged.
+ */
+static void makeFitCurves(Polar const &polar, std::vector<double> const &par, int iFirst, int iLast, Polar::enumPolarVariable parVar,
+                          std::vector<Polar::FittedCurve> &curves)
+{
+    std::vector<int> nodes;
+    for(int i=iFirst; i<=iLast; i++)
+    {
+        if(nodes.empty() || par.at(i)-par.at(nodes.back())>=0.00001) nodes.push_back(i);
+    }
+
+    std::vector<double> x(nodes.size()), y(nodes.size());
+    for(size_t j=0; j<nodes.size(); j++) x[j] = par.at(nodes.at(j));
+
+    int nVars = int(sizeof(s_FitVariables)/sizeof(s_FitVariables[0]));
+    curves.resize(nVars);
+    for(int iv=0; iv<nVars; iv++)
+    {
+        std::vector<double> const &var = polar.getPlrVariable(s_FitVariables[iv]);
+        if(var.size()!=par.size()) continue;
+        for(size_t j=0; j<nodes.size(); j++) y[j] = var.at(nodes.at(j));
+        curves[iv].make(x, y, s_FitVariables[iv]!=parVar);
+    }
+}
+
+
+/**
+ * Precomputes the limits of the polar and the monotonic runs of its aoa and Cl values,
+ * so that the indexed interpolations locate the points by bisection instead of by scanning.
+ * If bFittedInterpolation() is true, also makes the smoothed curves on these runs.
+ */
+void Polar::makeInterpolationIndex(InterpolationIndex &index) const
+{
+    index.m_Revision = m_DataRevision;
+    getAlphaLimits(index.m_AlphaMin, index.m_AlphaMax);
+    getClLimits(index.m_ClMin, index.m_ClMax);
+
+    int n = int(m_Cl.size());
+    index.m_iClZero = 0;
+    if(n>0)
+    {
+        double dist = fabs(m_Cl.at(0));
+        for (int i=1; i<n; i++)
+        {
+            if (fabs(m_Cl.at(i))< dist)
+            {
+                dist = fabs(m_Cl.at(i));
+                index.m_iClZero = i;
+            }
+        }
+    }
+
+    int pt = index.m_iClZero;
+    index.m_iClUp = pt;
+    while(index.m_iClUp+1<n && m_Cl.at(index.m_iClUp)<=m_Cl.at(index.m_iClUp+1)) index.m_iClUp++;
+    index.m_iClDown = pt;
+    while(index.m_iClDown>0 && m_Cl.at(index.m_iClDown-1)<=m_Cl.at(index.m_iClDown)) index.m_iClDown--;
+
+    int na = int(m_Alpha.size());
+    index.m_iAlphaUp = 0;
+    while(index.m_iAlphaUp+1<na && m_Alpha.at(index.m_iAlphaUp)<=m_Alpha.at(index.m_iAlphaUp+1)) index.m_iAlphaUp++;
+
+    index.m_bFitted = s_bFittedInterpolation;
+    index.m_pFit.reset();
+    if(s_bFittedInterpolation && n>=2 && na==n)
+    {
+        std::shared_ptr<InterpolationFit> pFit = std::make_shared<InterpolationFit>();
+        makeFitCurves(*this, m_Alpha, 0, index.m_iAlphaUp, Polar::ALPHA, pFit->m_AlphaCurves);
+        makeFitCurves(*this, m_Cl, index.m_iClDown, index.m_iClUp, Polar::CL, pFit->m_ClCurves);
+        index.m_pFit = pFit;
+    }
+}
+
+
+/**
+ * Same result as interpolateFromAlpha(alpha, PlrVar, bOutAlpha), using an index made for
+ * the current data of this polar.
+ * The points are located by bisection in the sorted part of the aoa array, which for regular polars is the whole array.
+ */
+double Polar::interpolateFromAlpha(double alpha, Polar::enumPolarVariable PlrVar, bool &bOutAlpha, InterpolationIndex const &index) const
+{
+    std::vector<double> const &pX = getPlrVariable(PlrVar);
+
+    if(alpha<index.m_AlphaMin)
+    {
+        bOutAlpha = true;
+        return pX.front();
+    }
+
+    if(alpha>index.m_AlphaMax)
+    {
+        bOutAlpha = true;
+        return pX.back();
+    }
+
+    if(index.m_pFit)
+    {
+        int iFit = InterpolationFit::fitIndex(PlrVar);
+        if(iFit>=0 && index.m_pFit->m_AlphaCurves.at(iFit).covers(alpha)) return index.m_pFit->m_AlphaCurves.at(iFit).value(alpha);
+    }
+
+    int n = int(m_Alpha.size());
+    int iStart = index.m_iAlphaUp;
+    // the first point of the sorted run greater than alpha closes the first matching segment
+    auto itUp = std::upper_bound(m_Alpha.begin(), m_Alpha.begin()+index.m_iAlphaUp+1, alpha);
+    int j = int(itUp-m_Alpha.begin());
+    if(j>0 && j<=index.m_iAlphaUp) iStart = j-1;
+
+    for (int i=iStart; i<n-1; i++)
+    {
+        if(m_Alpha.at(i)<=alpha && alpha<m_Alpha.at(i+1))
+        {
+            //interpolate
+            if(m_Alpha.at(i+1)-m_Alpha.at(i)<0.00001)//do not divide by zero
+                return pX.at(i);
+            else
+            {
+                double u = (alpha - m_Alpha.at(i)) /(m_Alpha.at(i+1)-m_Alpha.at(i));
+                return pX.at(i) + u * (pX.at(i+1)-pX.at(i));
+            }
+        }
+    }
+
+    bOutAlpha = true;
+    return 0.0;
+}
+
+
+/**
+ * Same result as interpolateFromCl(Cl, PlrVar, bOutCl), using an index made for the current
+ * data of this polar.
+ * The search starts from the point closest to Cl=0 as in the non-indexed version; the points are located
+ * by bisection in the monotonic runs on either side of this point and by scanning beyond them, i.e. past the stall.
+ */
+double Polar::interpolateFromCl(double Cl, Polar::enumPolarVariable PlrVar, bool &bOutCl, InterpolationIndex const &index) const
+{
+    std::vector <double> const &pX = getPlrVariable(PlrVar);
+
+    if(Cl < index.m_ClMin)
+    {
+        bOutCl = true;
+        if(pX.size()) return pX.front();
+        else          return 0.0;
+    }
+    else if(Cl > index.m_ClMax)
+    {
+        bOutCl= true;
+        if(pX.size()) return pX.back();
+        else          return 0.0;
+    }
+
+    // the curves span the same monotonic run as the bisection below
+    if(index.m_pFit)
+    {
+        int iFit = InterpolationFit::fitIndex(PlrVar);
+        if(iFit>=0 && index.m_pFit->m_ClCurves.at(iFit).covers(Cl)) return index.m_pFit->m_ClCurves.at(iFit).value(Cl);
+    }
+
+    int pt = index.m_iClZero;
+    if(Cl<m_Cl.at(pt))
+    {
+        // the last point of the run less than Cl opens the first matching segment
+        int iStart = index.m_iClDown;
+        auto itLow = std::lower_bound(m_Cl.begin()+index.m_iClDown, m_Cl.begin()+pt, Cl);
+        int k = int(itLow-m_Cl.begin())-1;
+        if(k>=index.m_iClDown) iStart = k+1;
+
+        for (int i=iStart; i>0; i--)
+        {
+            if(Cl<= m_Cl.at(i) && Cl > m_Cl.at(i-1))
+            {
+                if(fabs(m_Cl.at(i)-m_Cl.at(i-1)) < 0.00001) return pX.at(i); //do not divide by zero
+                double u = (Cl - m_Cl.at(i-1)) /(m_Cl.at(i)-m_Cl.at(i-1));
+                return pX.at(i-1) + u * (pX.at(i)-pX.at(i-1));
+            }
+        }
+    }
+    else
+    {
+        // the first point of the run greater than Cl closes the first matching segment
+        int iStart = index.m_iClUp;
+        auto itUp = std::upper_bound(m_Cl.begin()+pt, m_Cl.begin()+index.m_iClUp+1, Cl);
+        int j = int(itUp-m_Cl.begin());
+        if(j<=index.m_iClUp) iStart = j-1;
+
+        for (int i=iStart; i<int(m_Cl.size())-1; i++)
+        {
+            if(m_Cl.at(i) <=Cl && Cl < m_Cl.at(i+1))
+            {
+                if(fabs(m_Cl.at(i+1)-m_Cl.at(i)) < 0.00001) return pX.at(i); //do not divide by zero
+                double u = (Cl - m_Cl.at(i)) / (m_Cl.at(i+1)-m_Cl.at(i));
+                return pX.at(i) + u * (pX.at(i+1)-pX.at(i));
+            }
+        }
+    }
+
+    bOutCl = true;
+    return 0.0;
+}
+
+
 void Polar::resizeData(int n)
 {
+    setDataModified();
     m_Alpha.resize(n);
     m_Cl.resize(n);
     m_XCp.resize(n);
@@ -1385,3 +1668,15 @@ int Polar::compareTo(Polar const*pPolar) const
     return 1;
 }
 
+
+size_t Polar::memoryFootprint() const
+{
+    return sizeof(Polar)
+         + MemoryBudget::bytes(m_Alpha)      + MemoryBudget::bytes(m_Cl)          + MemoryBudget::bytes(m_XCp)
+         + MemoryBudget::bytes(m_Cd)         + MemoryBudget::bytes(m_Cdp)         + MemoryBudget::bytes(m_Cm)
+         + MemoryBudget::bytes(m_XTrTop)     + MemoryBudget::bytes(m_XTrBot)      + MemoryBudget::bytes(m_XLamSepTop)
+         + MemoryBudget::bytes(m_XLamSepBot) + MemoryBudget::bytes(m_XTurbSepTop) + MemoryBudget::bytes(m_XTurbSepBot)
+         + MemoryBudget::bytes(m_HMom)       + MemoryBudget::bytes(m_Cpmn)        + MemoryBudget::bytes(m_ClCd)
+         + MemoryBudget::bytes(m_Cl32Cd)     + MemoryBudget::bytes(m_RtCl)        + MemoryBudget::bytes(m_Re)
+         + MemoryBudget::bytes(m_Control);
+}
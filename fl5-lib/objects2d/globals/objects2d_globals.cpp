@@ -25,6 +25,9 @@
 #include <fstream>
 #include <string>
 
+#include <QStringList>
+#include <QTextStream>
+
 
 #include <objects2d_globals.h>
 
@@ -551,4 +554,191 @@ bool objects::serializeFoil(Foil *pFoil, QDataStream &ar)
 }
 
 
+/**
+ * Reads a polar from a text file written by XFoil's PACC command.
+ * @return a pointer to the new Polar, owned by the caller, or nullptr if the file could not be read.
+ */
+Polar *objects::importXFoilPolar(QFile &txtFile, QString &logmsg)
+{
+    double Re(0), alpha(0), CL(0), CD(0), CDp(0), CM(0), Xt(0), Xb(0),Cpmn(0), HMom(0);
+    QString FoilName;
+    QString strong, strange, str;
+    bool bRead = false;
+
+    if (!txtFile.open(QIODevice::ReadOnly))
+    {
+        strange = "Could not open the file "+txtFile.fileName();
+        logmsg += strange;
+        return nullptr;
+    }
+    Polar *pPolar = new Polar;
+
+    QTextStream in(&txtFile);
+    int Line = 0;
+    bool bOK=false, bOK2=false;
+
+    xfl::readAVLString(in, Line, strong);    // XFoil or XFLR5 version
+    xfl::readAVLString(in, Line, strong);    // Foil Name
+
+    FoilName = strong.right(strong.length()-22).trimmed();
+//    FoilName = FoilName.trimmed();
+
+    pPolar->setFoilName(FoilName.toStdString());
+
+    xfl::readAVLString(in, Line, strong);// analysis type
+
+    int retype = strong.mid(0,2).toInt(&bOK);
+    if(bOK) pPolar->setReType(retype);
+    int matype = strong.mid(2,2).toInt(&bOK2);
+    if(bOK) pPolar->setMaType(matype);
+
+    if(!bOK || !bOK2)
+    {
+        str = QString::asprintf("Error reading line %d: Unrecognized Mach and Reynolds type.\nThe polar(s) will not be stored.",Line);
+        delete pPolar;
+        logmsg += str+"\n";
+
+        return nullptr;
+    }
+    if     (pPolar->ReType() ==1 && pPolar->MaType() ==1) pPolar->setType(xfl::T1POLAR);
+    else if(pPolar->ReType() ==2 && pPolar->MaType() ==2) pPolar->setType(xfl::T2POLAR);
+    else if(pPolar->ReType() ==3 && pPolar->MaType() ==1) pPolar->setType(xfl::T3POLAR);
+    else                                                  pPolar->setType(xfl::T1POLAR);
+
+    bRead = xfl::readAVLString(in, Line, strong);
+    if(!bRead || strong.length() < 34)
+    {
+        str = QString::asprintf("Error reading line %d. The polar(s) will not be stored.",Line);
+        delete pPolar;
+
+        logmsg += str+"\n";
+        return nullptr;
+    }
+
+    double xtr = strong.mid(9,6).toDouble(&bOK);
+    if(bOK) pPolar->setXTripBot(xtr);
+    if(!bOK)
+    {
+        str = QString::asprintf("Error reading Bottom Transition value at line %d. The polar(s) will not be stored.",Line);
+        delete pPolar;
+        logmsg += str+"\n";
+        return nullptr;
+    }
+
+    xtr = strong.mid(28,6).toDouble(&bOK);
+    if(bOK) pPolar->setXTripTop(xtr);
+
+    if(!bOK)
+    {
+        str = QString::asprintf("Error reading Top Transition value at line %d. The polar(s) will not be stored.",Line);
+        delete pPolar;
+
+        logmsg += str+"\n";
+        return nullptr;
+    }
+
+    // Mach     Re     NCrit
+    bRead = xfl::readAVLString(in, Line, strong);// blank line
+    if(!bRead || strong.length() < 50)
+    {
+        str = QString::asprintf("Error reading line %d. The polar(s) will not be stored.",Line);
+        delete pPolar;
+        logmsg += str+"\n";
+        return nullptr;
+    }
+
+    double Ma = strong.mid(8,6).toDouble(&bOK);
+    if(!bOK)
+    {
+        str = QString::asprintf("Error reading Mach Number at line %d. The polar(s) will not be stored.",Line);
+        delete pPolar;
+        logmsg += str+"\n";
+        return nullptr;
+    }
+    else
+        pPolar->setMach(Ma);
+
+    Re = strong.mid(24,10).toDouble(&bOK);
+    if(!bOK)
+    {
+        str = QString::asprintf("Error reading Reynolds Number at line %d. The polar(s) will not be stored.",Line);
+        delete pPolar;
+        logmsg += str+"\n";
+        return nullptr;
+    }
+    Re *=1000000.0;
+    pPolar->setReynolds(Re);
+
+    double ncrit = strong.mid(52,8).toDouble(&bOK);
+    if(bOK) pPolar->setNCrit(ncrit);
+    if(!bOK)
+    {
+        str = QString::asprintf("Error reading NCrit at line %d. The polar(s) will not be stored.",Line);
+        delete pPolar;
+        logmsg += str+"\n";
+        return nullptr;
+    }
+
+    xfl::readAVLString(in, Line, strong);// column titles
+    bRead = xfl::readAVLString(in, Line, strong);// underscores
+
+
+    while(bRead && !in.atEnd())
+    {
+        bRead = xfl::readAVLString(in, Line, strong);// polar data
+        if(strong.length())
+        {
+            if(strong.length())
+            {
+                //                textline = strong.toLatin1();
+                //                text = textline.constData();
+                //                res = sscanf(text, "%lf%lf%lf%lf%lf%lf%lf%lf%lf", &alpha, &CL, &CD, &CDp, &CM, &Xt, &Xb, &Cpmn, &HMom);
+
+                //Do this the Qt way
+                QStringList values;
+#if QT_VERSION >= 0x050F00
+                values = strong.split(" ", Qt::SkipEmptyParts);
+#else
+                values = strong.split(" ", QString::SkipEmptyParts);
+#endif
+
+                if(values.length()>=7)
+                {
+                    alpha  = values.at(0).toDouble();
+                    CL     = values.at(1).toDouble();
+                    CD     = values.at(2).toDouble();
+                    CDp    = values.at(3).toDouble();
+                    CM     = values.at(4).toDouble();
+                    Xt     = values.at(5).toDouble();
+                    Xb     = values.at(6).toDouble();
+
+                    if(values.length() >= 9)
+                    {
+                        Cpmn    = values.at(7).toDouble();
+                        HMom    = values.at(8).toDouble();
+                        pPolar->addPoint(alpha, CD, CDp, CL, CM, Cpmn, HMom, Re, 0, 0, Xt, Xb, 0, 0, 0, 0);
+                    }
+                    else
+                    {
+                        pPolar->addPoint(alpha, CD, CDp, CL, CM, 0.0, 0.0,Re,0.0,0.0, Xt, Xb, 0, 0, 0, 0);
+
+                    }
+                }
+            }
+        }
+    }
+    txtFile.close();
+
+    Re = pPolar->Reynolds()/1000000.0;
+    QString name = QString("T%1_Re%2_M%3")
+            .arg(pPolar->type()+1)
+            .arg(Re,0,'f',2)
+            .arg(pPolar->Mach(),0,'f',2);
+    str = QString("_N%1").arg(pPolar->NCrit(),0,'f',1);
+    name += str;
+    pPolar->setName(name.toStdString());
+
+
+    return pPolar;
+}
 
@@ -23,6 +23,10 @@
 *****************************************************************************/
 
 
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
 #include <objects2d.h>
 
 #include <constants.h>
@@ -31,41 +35,157 @@
 #include <oppoint.h>
 #include <geom_params.h>
 
-std::vector<Foil*> Objects2d::s_oaFoil;
 
 
-std::vector<Polar*>   Objects2d::s_oaPolar;
-std::vector<OpPoint*> Objects2d::s_oaOpp;
+/**
+ * Clears the polar index and the name indexes of the foils and of the polars; to be called each time
+ * the foil or polar arrays, or the names of their objects, are modified
+ */
+void Objects2d::invalidatePolarIndex()
+{
+    ObjectStore &store = ObjectStore::current();
+    {
+        std::unique_lock<std::shared_mutex> lock(store.m_PolarIndexMutex);
+        store.m_PolarIndex.clear();
+    }
+    std::unique_lock<std::shared_mutex> lock(store.m_NameIndexMutex);
+    store.m_FoilIndex.clear();
+    store.m_FoilPolarIndex.clear();
+}
+
+
+/** The parent key of the foils in the name index */
+static std::string const s_NoParent;
+
+
+static void buildFoilIndex(NameIndex<std::string, Foil> &index)
+{
+    for(Foil *pFoil : Objects2d::foils()) index.add(s_NoParent, pFoil->nameRef(), pFoil);
+}
+
+
+static void buildFoilPolarIndex(NameIndex<std::string, Polar> &index)
+{
+    for(Polar *pPolar : Objects2d::polars()) index.add(pPolar->foilName(), pPolar->nameRef(), pPolar);
+}
+
+
+static bool isPolarIndexCurrent(std::vector<PolarIndexEntry> const &entries)
+{
+    for(PolarIndexEntry const &entry : entries)
+    {
+        if(entry.m_Revision!=entry.m_pPolar->dataRevision()) return false;
+        if(entry.m_bFixedSpeed!=entry.m_pPolar->isFixedSpeedPolar()) return false;
+        if(entry.m_Index.m_bFitted!=Polar::bFittedInterpolation()) return false;
+    }
+    return true;
+}
+
+
+/**
+ * Returns a copy of the index entries of the foil's polars, rebuilding them if the polars' data has changed.
+ * The store's mutex allows the interpolation functions to be called concurrently from the 3d analysis threads.
+ */
+static std::vector<PolarIndexEntry> foilPolarIndex(Foil const *pFoil)
+{
+    ObjectStore &store = ObjectStore::current();
+    {
+        std::shared_lock<std::shared_mutex> lock(store.m_PolarIndexMutex);
+        auto it = store.m_PolarIndex.find(pFoil->name());
+        if(it!=store.m_PolarIndex.end() && isPolarIndexCurrent(it->second)) return it->second;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(store.m_PolarIndexMutex);
+    std::vector<PolarIndexEntry> &entries = store.m_PolarIndex[pFoil->name()];
+    if(entries.size() && isPolarIndexCurrent(entries)) return entries; // rebuilt by another thread in the meantime
+
+    entries.clear();
+    for(int i=0; i<Objects2d::nPolars(); i++)
+    {
+        Polar const *pPolar = Objects2d::polarAt(i);
+        if(pPolar->foilName().compare(pFoil->name())!=0) continue;
+        PolarIndexEntry entry;
+        entry.m_pPolar = pPolar;
+        entry.m_Revision = pPolar->dataRevision();
+        entry.m_bFixedSpeed = pPolar->isFixedSpeedPolar();
+        pPolar->makeInterpolationIndex(entry.m_Index);
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+
+/**
+ * Finds in a single pass the two polars of the foil which enclose the Reynolds number,
+ * i.e. the last polar in the array with Reynolds<Re and the first one with Reynolds>Re.
+ * Either pointer is set to null if there is no such polar.
+ */
+static void bracketingPolars(Foil const *pFoil, double Re, Polar const *&pPolar1, Polar const *&pPolar2)
+{
+    pPolar1 = nullptr;
+    pPolar2 = nullptr;
+    for (int i=0; i<Objects2d::nPolars(); i++)
+    {
+        Polar const *pPolar = Objects2d::polarAt(i);
+        if(pPolar->foilName() != pFoil->name()) continue;
+        if(pPolar->Reynolds() < Re) pPolar1 = pPolar;
+        else if(!pPolar2 && pPolar->Reynolds() > Re) pPolar2 = pPolar;
+    }
+}
 
 
 void Objects2d::deleteObjects()
 {
+    invalidatePolarIndex();
     for (int i=nFoils()-1; i>=0; i--)
     {
-        delete s_oaFoil.at(i);
+        delete store().m_oaFoil.at(i);
     }
-    s_oaFoil.clear();
+    store().m_oaFoil.clear();
 
     for (int i=nPolars()-1; i>=0; i--)
     {
-        Polar *pPolar = s_oaPolar.at(i);
-        s_oaPolar.erase(s_oaPolar.begin()+i);
+        Polar *pPolar = store().m_oaPolar.at(i);
+        store().m_oaPolar.erase(store().m_oaPolar.begin()+i);
         delete pPolar;
     }
     for (int i=Objects2d::nOpPoints()-1; i>=0; i--)
     {
-        OpPoint *pOpp = s_oaOpp.at(i);
-        s_oaOpp.erase(s_oaOpp.begin()+i);
+        OpPoint *pOpp = store().m_oaOpp.at(i);
+        store().m_oaOpp.erase(store().m_oaOpp.begin()+i);
         delete pOpp;
     }
 }
 
 
+/** The memory used by the foils, the polars and the operating points, in bytes */
+size_t Objects2d::memoryFootprint()
+{
+    size_t n = 0;
+    for(Foil const *pFoil : store().m_oaFoil)   n += pFoil->memoryFootprint();
+    for(Polar const *pPolar : store().m_oaPolar) n += pPolar->memoryFootprint();
+    for(OpPoint const *pOpp : store().m_oaOpp)  n += pOpp->memoryFootprint();
+    return n;
+}
+
+
+/**
+ * Returns the foil with the name, through the name index.
+ * The foils which have been renamed without renameThisFoil() are not in the index and are found by a linear search.
+ */
 Foil* Objects2d::foil(const std::string &name)
 {
-    for (int i=0; i<nFoils(); i++)
-        if(s_oaFoil.at(i)->name()==name)
-            return s_oaFoil.at(i);
+    Foil *pIndexed = store().findIndexed(store().m_FoilIndex, s_NoParent, name, buildFoilIndex);
+    if(pIndexed && pIndexed->nameRef()==name) return pIndexed;
+
+    for(Foil *pFoil : foils())
+    {
+        if(pFoil->nameRef()==name)
+        {
+            invalidatePolarIndex(); // out of date
+            return pFoil;
+        }
+    }
     return nullptr;
 }
 
@@ -73,12 +193,16 @@ Foil* Objects2d::foil(const std::string &name)
 Polar* Objects2d::polar(std::string const &foilname, std::string const &polarname)
 {
     if(!polarname.length()) return nullptr;
-    for(int i=0; i<nPolars(); i++)
+
+    Polar *pIndexed = store().findIndexed(store().m_FoilPolarIndex, foilname, polarname, buildFoilPolarIndex);
+    if(pIndexed && pIndexed->foilName()==foilname && pIndexed->nameRef()==polarname) return pIndexed;
+
+    for(Polar *pPolar : polars())
     {
-        if(foilname.compare(s_oaPolar.at(i)->foilName())==0)
+        if(pPolar->foilName()==foilname && pPolar->nameRef()==polarname)
         {
-            if(polarname.compare(s_oaPolar.at(i)->name())==0)
-                return s_oaPolar.at(i);
+            invalidatePolarIndex(); // out of date
+            return pPolar;
         }
     }
     return nullptr;
@@ -88,22 +212,23 @@ Polar* Objects2d::polar(std::string const &foilname, std::string const &polarnam
 Foil* Objects2d::foil(int index)
 {
     if(index<0 || index>=nFoils()) return nullptr;
-    return s_oaFoil.at(index);
+    return store().m_oaFoil.at(index);
 }
 
 
 Foil const* Objects2d::foilAt(int index)
 {
     if(index<0 || index>=nFoils()) return nullptr;
-    return s_oaFoil.at(index);
+    return store().m_oaFoil.at(index);
 }
 
 
 void Objects2d::insertThisFoil(Foil *pFoil)
 {
     if(!pFoil) return;
+    invalidatePolarIndex();
 
-    for(Foil *pOldFoil : s_oaFoil)
+    for(Foil *pOldFoil : store().m_oaFoil)
     {
         if(pOldFoil==pFoil) return; // nothing to do, already stored;
     }
@@ -113,7 +238,7 @@ void Objects2d::insertThisFoil(Foil *pFoil)
     //check if it's an overwrite
     for (int i=0; i<nFoils(); i++)
     {
-        Foil*pOldFoil = s_oaFoil.at(i);
+        Foil*pOldFoil = store().m_oaFoil.at(i);
         if(pOldFoil && pOldFoil->name()==oldFoilName && pOldFoil!=pFoil)
         {
             // delete the old foil and its children objects
@@ -125,14 +250,14 @@ void Objects2d::insertThisFoil(Foil *pFoil)
     bool bInserted(false);
     for (int i=0; i<nFoils(); i++)
     {
-        if(pFoil->name().compare(s_oaFoil.at(i)->name())<0)
+        if(pFoil->name().compare(store().m_oaFoil.at(i)->name())<0)
         {
-            s_oaFoil.insert(s_oaFoil.begin()+i, pFoil);
+            store().m_oaFoil.insert(store().m_oaFoil.begin()+i, pFoil);
             bInserted = true;
             break;
         }
     }
-    if(!bInserted) s_oaFoil.push_back(pFoil);
+    if(!bInserted) store().m_oaFoil.push_back(pFoil);
 }
 
 
@@ -174,23 +299,24 @@ void Objects2d::addOpPoint(OpPoint *pNewOpp, bool bStoreOpp)
 Foil * Objects2d::deleteFoil(Foil const *pFoil)
 {
     if(!pFoil || !pFoil->name().length()) return nullptr;
+    invalidatePolarIndex();
 
     for (int j=nOpPoints()-1; j>=0; j--)
     {
-        OpPoint *pOpPoint = s_oaOpp.at(j);
+        OpPoint *pOpPoint = store().m_oaOpp.at(j);
         if(pOpPoint->foilName() == pFoil->name())
         {
-            s_oaOpp.erase(s_oaOpp.begin()+j);
+            store().m_oaOpp.erase(store().m_oaOpp.begin()+j);
             delete pOpPoint;
         }
     }
 
     for (int j=nPolars()-1; j>=0; j--)
     {
-        Polar* pPolar = s_oaPolar.at(j);
+        Polar* pPolar = store().m_oaPolar.at(j);
         if(pPolar->foilName() == pFoil->name())
         {
-            s_oaPolar.erase(s_oaPolar.begin()+j);
+            store().m_oaPolar.erase(store().m_oaPolar.begin()+j);
             delete pPolar;
         }
     }
@@ -198,14 +324,14 @@ Foil * Objects2d::deleteFoil(Foil const *pFoil)
     Foil *pNewCurFoil(nullptr);
     for (int i=0; i<nFoils(); i++)
     {
-        if(s_oaFoil.at(i)==pFoil)
-            s_oaFoil.erase(s_oaFoil.begin()+i);
+        if(store().m_oaFoil.at(i)==pFoil)
+            store().m_oaFoil.erase(store().m_oaFoil.begin()+i);
     }
     delete pFoil;
 
     if(!pNewCurFoil && nFoils()>0)
     {
-        pNewCurFoil = s_oaFoil.front();
+        pNewCurFoil = store().m_oaFoil.front();
     }
     return pNewCurFoil;
 }
@@ -217,10 +343,10 @@ bool Objects2d::deleteOpp(OpPoint *pOpp)
 
     for (int iOpp=0; iOpp<nOpPoints(); iOpp++)
     {
-        OpPoint* pOldOpp =s_oaOpp.at(iOpp);
+        OpPoint* pOldOpp =store().m_oaOpp.at(iOpp);
         if (pOpp == pOldOpp)
         {
-            s_oaOpp.erase(s_oaOpp.begin()+iOpp);
+            store().m_oaOpp.erase(store().m_oaOpp.begin()+iOpp);
             delete pOpp;
             return true;
         }
@@ -232,25 +358,26 @@ bool Objects2d::deleteOpp(OpPoint *pOpp)
 void Objects2d::deletePolar(Polar *pPolar)
 {
     if(!pPolar) return;
+    invalidatePolarIndex();
 
     // start by removing all OpPoints
     for (int l=nOpPoints()-1; l>=0; l--)
     {
-        OpPoint *pOpPoint = s_oaOpp.at(l);
+        OpPoint *pOpPoint = store().m_oaOpp.at(l);
         if (pOpPoint->polarName()  == pPolar->name() &&
             pOpPoint->foilName() == pPolar->foilName())
         {
-            s_oaOpp.erase(s_oaOpp.begin()+l);
+            store().m_oaOpp.erase(store().m_oaOpp.begin()+l);
             delete pOpPoint;
         }
     }
 
     for (int iPolar=0; iPolar<nPolars(); iPolar++)
     {
-        Polar* pOldPolar = s_oaPolar.at(iPolar);
+        Polar* pOldPolar = store().m_oaPolar.at(iPolar);
         if (pPolar == pOldPolar)
         {
-            s_oaPolar.erase(s_oaPolar.begin()+iPolar);
+            store().m_oaPolar.erase(store().m_oaPolar.begin()+iPolar);
             delete pOldPolar;
             break;
         }
@@ -273,11 +400,11 @@ OpPoint* Objects2d::insertOpPoint(OpPoint *pNewPoint)
     // first add the OpPoint to the OpPoint Array for the current FoilName
     for (int i=0; i<nOpPoints(); i++)
     {
-        OpPoint *pOpPoint = s_oaOpp[i];
+        OpPoint *pOpPoint = store().m_oaOpp[i];
         if (pNewPoint->foilName().compare(pOpPoint->foilName())<0)
         {
             //insert point
-            s_oaOpp.insert(s_oaOpp.begin()+i, pNewPoint);
+            store().m_oaOpp.insert(store().m_oaOpp.begin()+i, pNewPoint);
             return pNewPoint;
         }
         else if (pNewPoint->foilName() == pOpPoint->foilName() && pNewPoint->polarName()==pOpPoint->polarName())
@@ -289,15 +416,15 @@ OpPoint* Objects2d::insertOpPoint(OpPoint *pNewPoint)
                     //replace the existing point
                     pNewPoint->setTheStyle(pOpPoint->theStyle());
 
-                    s_oaOpp.erase(s_oaOpp.begin()+i);
+                    store().m_oaOpp.erase(store().m_oaOpp.begin()+i);
                     delete pOpPoint;
-                    s_oaOpp.insert(s_oaOpp.begin()+i, pNewPoint);
+                    store().m_oaOpp.insert(store().m_oaOpp.begin()+i, pNewPoint);
                     return pNewPoint;
                 }
                 else if (pNewPoint->theta() < pOpPoint->theta())
                 {
                     //insert point
-                    s_oaOpp.insert(s_oaOpp.begin()+i, pNewPoint);
+                    store().m_oaOpp.insert(store().m_oaOpp.begin()+i, pNewPoint);
                     return pNewPoint;
                 }
             }
@@ -308,15 +435,15 @@ OpPoint* Objects2d::insertOpPoint(OpPoint *pNewPoint)
                     //replace the existing point
                     pNewPoint->setTheStyle(pOpPoint->theStyle());
 
-                    s_oaOpp.erase(s_oaOpp.begin()+i);
+                    store().m_oaOpp.erase(store().m_oaOpp.begin()+i);
                     delete pOpPoint;
-                    s_oaOpp.insert(s_oaOpp.begin()+i, pNewPoint);
+                    store().m_oaOpp.insert(store().m_oaOpp.begin()+i, pNewPoint);
                     return pNewPoint;
                 }
                 else if (pNewPoint->Reynolds() < pOpPoint->Reynolds())
                 {
                     //insert point
-                    s_oaOpp.insert(s_oaOpp.begin()+i, pNewPoint);
+                    store().m_oaOpp.insert(store().m_oaOpp.begin()+i, pNewPoint);
                     return pNewPoint;
                 }
             }
@@ -327,15 +454,15 @@ OpPoint* Objects2d::insertOpPoint(OpPoint *pNewPoint)
                     //replace the existing point
                     pNewPoint->setTheStyle(pOpPoint->theStyle());
 
-                    s_oaOpp.erase(s_oaOpp.begin()+i);
+                    store().m_oaOpp.erase(store().m_oaOpp.begin()+i);
                     delete pOpPoint;
-                    s_oaOpp.insert(s_oaOpp.begin()+i, pNewPoint);
+                    store().m_oaOpp.insert(store().m_oaOpp.begin()+i, pNewPoint);
                     return pNewPoint;
                 }
                 else if (pNewPoint->aoa() < pOpPoint->aoa())
                 {
                     //insert point
-                    s_oaOpp.insert(s_oaOpp.begin()+i, pNewPoint);
+                    store().m_oaOpp.insert(store().m_oaOpp.begin()+i, pNewPoint);
                     return pNewPoint;
                 }
             }
@@ -343,19 +470,20 @@ OpPoint* Objects2d::insertOpPoint(OpPoint *pNewPoint)
         }
     }
 
-    s_oaOpp.push_back(pNewPoint);
+    store().m_oaOpp.push_back(pNewPoint);
     return pNewPoint;
 }
 
 
 void Objects2d::renamePolar(Polar *pPolar, std::string const &newplrname)
 {
+    invalidatePolarIndex();
     pPolar->setName(newplrname);
     for(int i=0; i<nPolars(); i++)
     {
-        if(s_oaPolar.at(i)==pPolar)
+        if(store().m_oaPolar.at(i)==pPolar)
         {
-            s_oaPolar.erase(s_oaPolar.begin()+i);
+            store().m_oaPolar.erase(store().m_oaPolar.begin()+i);
             insertPolar(pPolar);
         }
     }
@@ -365,29 +493,30 @@ void Objects2d::renamePolar(Polar *pPolar, std::string const &newplrname)
 void Objects2d::insertPolar(Polar *pPolar)
 {
     if(!pPolar) return;
+    invalidatePolarIndex();
 
     bool bInserted = false;
 
     for (int ip=0; ip<nPolars(); ip++)
     {
-        Polar *pOldPlr = s_oaPolar.at(ip);
+        Polar *pOldPlr = store().m_oaPolar.at(ip);
         if (pOldPlr->name().compare(pPolar->name())==0 &&
             pOldPlr->foilName().compare(pPolar->foilName())==0)
         {
             deletePolar(pOldPlr);
-            s_oaPolar.insert(s_oaPolar.begin()+ip, pPolar);
+            store().m_oaPolar.insert(store().m_oaPolar.begin()+ip, pPolar);
             return;
         }
     }
 
     for (int j=0; j<nPolars(); j++)
     {
-        Polar const*pOldPlr = s_oaPolar.at(j);
+        Polar const*pOldPlr = store().m_oaPolar.at(j);
 
         //first index is the parent foil name
         if (pPolar->foilName().compare(pOldPlr->foilName())<0)
         {
-            s_oaPolar.insert(s_oaPolar.begin()+j, pPolar);
+            store().m_oaPolar.insert(store().m_oaPolar.begin()+j, pPolar);
             bInserted = true;
             break;
         }
@@ -396,7 +525,7 @@ void Objects2d::insertPolar(Polar *pPolar)
             //next index is the BL method
             if(pPolar->BLMethod() < pOldPlr->BLMethod())
             {
-                s_oaPolar.insert(s_oaPolar.begin()+j, pPolar);
+                store().m_oaPolar.insert(store().m_oaPolar.begin()+j, pPolar);
                 bInserted = true;
                 break;
             }
@@ -405,7 +534,7 @@ void Objects2d::insertPolar(Polar *pPolar)
                 //next index is the polar type
                 if(pPolar->type() < pOldPlr->type())
                 {
-                    s_oaPolar.insert(s_oaPolar.begin()+j, pPolar);
+                    store().m_oaPolar.insert(store().m_oaPolar.begin()+j, pPolar);
                     bInserted = true;
                     break;
                 }
@@ -416,7 +545,7 @@ void Objects2d::insertPolar(Polar *pPolar)
                         //Type 4, sort by Alphas
                         if(pPolar->m_aoaSpec < pOldPlr->m_aoaSpec)
                         {
-                            s_oaPolar.insert(s_oaPolar.begin()+j, pPolar);
+                            store().m_oaPolar.insert(store().m_oaPolar.begin()+j, pPolar);
                             bInserted = true;
                             break;
                         }
@@ -426,14 +555,14 @@ void Objects2d::insertPolar(Polar *pPolar)
                         //sort by ReNbr
                         if(pPolar->Reynolds() < pOldPlr->Reynolds())
                         {
-                            s_oaPolar.insert(s_oaPolar.begin()+j, pPolar);
+                            store().m_oaPolar.insert(store().m_oaPolar.begin()+j, pPolar);
                             bInserted = true;
                             break;
                         }
                         //sort by Name
     /*                    if(pPolar->name().compare(pOldPlr->name())<0)
                         {
-                            s_oaPolar.insert(j, pPolar);
+                            store().m_oaPolar.insert(j, pPolar);
                             bInserted = true;
                             break;
                         }*/
@@ -444,7 +573,7 @@ void Objects2d::insertPolar(Polar *pPolar)
     }
     if(!bInserted)
     {
-        s_oaPolar.push_back(pPolar);
+        store().m_oaPolar.push_back(pPolar);
     }
 }
 
@@ -453,7 +582,7 @@ Polar* Objects2d::polar(const Foil *pFoil, xfl::enumPolarType type, BL::enumBLMe
 {
     for (int i=0; i<nPolars(); i++)
     {
-        Polar *pPolar =  s_oaPolar.at(i);
+        Polar *pPolar =  store().m_oaPolar.at(i);
         if (    pPolar->foilName() == pFoil->name() &&
                 pPolar->BLMethod() == method &&
                 pPolar->type() == type &&
@@ -468,41 +597,32 @@ Polar* Objects2d::polar(const Foil *pFoil, xfl::enumPolarType type, BL::enumBLMe
 
 Polar *Objects2d::polar(Foil const*pFoil, std::string const &PolarName)
 {
-    if (!PolarName.length()) return nullptr;
     if (!pFoil)        return nullptr;
-
-    for (int i=0; i<nPolars(); i++)
-    {
-        Polar *pPolar =  s_oaPolar.at(i);
-        if (pPolar->foilName() == pFoil->name() &&  pPolar->name() == PolarName)
-        {
-            return pPolar;
-        }
-    }
-    return nullptr;
+    return polar(pFoil->nameRef(), PolarName);
 }
 
 
 void Objects2d::deleteFoilResults(Foil *pFoil, bool bDeletePolars)
 {
+    invalidatePolarIndex();
     for (int j=nOpPoints()-1; j>=0; j--)
     {
-        OpPoint *pOpPoint = s_oaOpp[j];
+        OpPoint *pOpPoint = store().m_oaOpp[j];
         if(pOpPoint->foilName() == pFoil->name())
         {
-            s_oaOpp.erase(s_oaOpp.begin()+j);
+            store().m_oaOpp.erase(store().m_oaOpp.begin()+j);
             delete pOpPoint;
         }
     }
 
     for (int j=nPolars()-1; j>=0; j--)
     {
-        Polar *pPolar = s_oaPolar.at(j);
+        Polar *pPolar = store().m_oaPolar.at(j);
         if(pPolar->foilName() == pFoil->name())
         {
             if(bDeletePolars)
             {
-                s_oaPolar.erase(s_oaPolar.begin()+j);
+                store().m_oaPolar.erase(store().m_oaPolar.begin()+j);
                 delete pPolar;
             }
             else
@@ -540,14 +660,14 @@ double Objects2d::getPlrPointFromCl(Foil const*pFoil, double Re, double Cl, Pola
     }
 
     // make an array of relevant polars
-    std::vector<Polar const*>polars;
+    std::vector<PolarIndexEntry> const entries = foilPolarIndex(pFoil);
+    std::vector<PolarIndexEntry const*>polars;
 
-    for (int i=0; i<nPolars(); i++)
+    for (PolarIndexEntry const &entry : entries)
     {
-       Polar const *pPolar = s_oaPolar.at(i);
-       if(pPolar->isFixedSpeedPolar() && pPolar->foilName().compare(pFoil->name())==0 && pPolar->hasData())
+       if(entry.m_bFixedSpeed && entry.m_pPolar->hasData())
        {
-            polars.push_back(pPolar);
+            polars.push_back(&entry);
        }
     }
 
@@ -561,57 +681,52 @@ double Objects2d::getPlrPointFromCl(Foil const*pFoil, double Re, double Cl, Pola
     {
         //interpolate Cl on this polar
         bOutRe = true;
-        return polars.front()->interpolateFromCl(Cl, PlrVar, bOutCl);
+        return polars.front()->m_pPolar->interpolateFromCl(Cl, PlrVar, bOutCl, polars.front()->m_Index);
     }
 
     //more than one polar - interpolate between  - tough job
 
     //First Find the two polars with Reynolds number surrounding the specified Re
-    Polar const * pPolar1 = nullptr;
-    Polar const * pPolar2 = nullptr;
+    PolarIndexEntry const * pEntry1 = nullptr;
+    PolarIndexEntry const * pEntry2 = nullptr;
 
     //Type 1 Polars are sorted by crescending Re Number
 
     //if Re is less than that of the first polar, use this one
-    for (uint i=0; i<polars.size(); i++)
+    if (Re < polars.front()->m_pPolar->Reynolds())
     {
-        Polar const *pPolar = polars.at(i);
-
-        if (Re < pPolar->Reynolds())
-        {
-            bOutRe = true;
-            return pPolar->interpolateFromCl(Cl, PlrVar, bOutCl);
-            break;
-        }
-        break;
-
+        bOutRe = true;
+        return polars.front()->m_pPolar->interpolateFromCl(Cl, PlrVar, bOutCl, polars.front()->m_Index);
     }
 
     // if not Find the two polars
     for (uint i=0; i<polars.size(); i++)
     {
-        Polar const *pPolar = polars.at(i);
+        PolarIndexEntry const *pEntry = polars.at(i);
 
-        // we have found the first type 1 polar for this foil
-        pPolar->getClLimits(Clmin, Clmax);
-        if (pPolar->Reynolds() <= Re)
+        Clmin = pEntry->m_Index.m_ClMin;
+        Clmax = pEntry->m_Index.m_ClMax;
+        if (pEntry->m_pPolar->Reynolds() <= Re)
         {
             if(Clmin <= Cl && Cl <= Clmax)
             {
-                pPolar1 = pPolar;
+                pEntry1 = pEntry;
             }
         }
         else
         {
             if(Clmin <= Cl && Cl <= Clmax)
             {
-                pPolar2 = pPolar;
+                pEntry2 = pEntry;
                 break;
             }
         }
 
     }
 
+    Polar const * pPolar1 = pEntry1 ? pEntry1->m_pPolar : nullptr;
+    Polar const * pPolar2 = pEntry2 ? pEntry2->m_pPolar : nullptr;
+
     if (!pPolar2)
     {
         //then Re is greater than that of any polar
@@ -623,7 +738,7 @@ double Objects2d::getPlrPointFromCl(Foil const*pFoil, double Re, double Cl, Pola
             bOutCl = true;
             return 0.000;
         }
-        return pPolar1->interpolateFromCl(Cl, PlrVar, bOutCl);
+        return pPolar1->interpolateFromCl(Cl, PlrVar, bOutCl, pEntry1->m_Index);
     }
     else
     {
@@ -642,7 +757,7 @@ double Objects2d::getPlrPointFromCl(Foil const*pFoil, double Re, double Cl, Pola
             bOutCl = true;
             return 0.000;
         }
-        Var1 = pPolar1->interpolateFromCl(Cl, PlrVar, bOutCl);
+        Var1 = pPolar1->interpolateFromCl(Cl, PlrVar, bOutCl, pEntry1->m_Index);
 
         if(!pPolar2->m_Cl.size())
         {
@@ -650,7 +765,7 @@ double Objects2d::getPlrPointFromCl(Foil const*pFoil, double Re, double Cl, Pola
             bOutCl = true;
             return 0.000;
         }
-        Var2 = pPolar2->interpolateFromCl(Cl, PlrVar, bOutCl);
+        Var2 = pPolar2->interpolateFromCl(Cl, PlrVar, bOutCl, pEntry2->m_Index);
 
         // then interpolate Variable
 
@@ -714,14 +829,14 @@ double Objects2d::getPlrPointFromAlpha(Foil const*pFoil, double Re, double Alpha
         return 0.000;
     }
 
-    std::vector<Polar const*>polars;
+    std::vector<PolarIndexEntry> const entries = foilPolarIndex(pFoil);
+    std::vector<PolarIndexEntry const*>polars;
 
-    for (int i=0; i<nPolars(); i++)
+    for (PolarIndexEntry const &entry : entries)
     {
-        Polar const *pPolar = polarAt(i);
-        if(pPolar->isFixedSpeedPolar() && pPolar->foilName().compare(pFoil->name())==0)
+        if(entry.m_bFixedSpeed)
         {
-            polars.push_back(pPolar);
+            polars.push_back(&entry);
         }
     }
     if(!polars.size())
@@ -732,23 +847,22 @@ double Objects2d::getPlrPointFromAlpha(Foil const*pFoil, double Re, double Alpha
 
     //more than one polar - interpolate between
     //First Find the two polars with Reynolds number surrounding wanted Re
-    Polar const *pPolar1 = nullptr;
-    Polar const *pPolar2 = nullptr;
+    PolarIndexEntry const *pEntry1 = nullptr;
+    PolarIndexEntry const *pEntry2 = nullptr;
 
     //Type 1 Polars are sorted by crescending Re Number
 
     //if Re is less than that of the first polar, use this one
     for (uint i=0; i<polars.size(); i++)
     {
-        Polar const *pPolar = polars.at(i);
+        Polar const *pPolar = polars.at(i)->m_pPolar;
         if(pPolar->dataSize()>0)
         {
             // we have found the first type 1 polar for this foil
             if (Re<pPolar->Reynolds())
             {
                 bOutRe = true;
-                return pPolar->interpolateFromAlpha(Alpha, PlrVar, bOutAlpha);
-                break;
+                return pPolar->interpolateFromAlpha(Alpha, PlrVar, bOutAlpha, polars.at(i)->m_Index);
             }
             break;
         }
@@ -757,21 +871,24 @@ double Objects2d::getPlrPointFromAlpha(Foil const*pFoil, double Re, double Alpha
     // if not find the two polars surrounding the Re number
     for (uint i=0; i<polars.size(); i++)
     {
-        Polar const *pPolar = polars.at(i);
+        Polar const *pPolar = polars.at(i)->m_pPolar;
         if(pPolar->dataSize()>0)
         {
             if (pPolar->Reynolds() <= Re)
             {
-                pPolar1 = pPolar;
+                pEntry1 = polars.at(i);
             }
             else
             {
-                pPolar2 = pPolar;
+                pEntry2 = polars.at(i);
                 break;
             }
         }
     }
 
+    Polar const *pPolar1 = pEntry1 ? pEntry1->m_pPolar : nullptr;
+    Polar const *pPolar2 = pEntry2 ? pEntry2->m_pPolar : nullptr;
+
     if (!pPolar2)
     {
         //then Re is greater than that of any polar
@@ -783,7 +900,7 @@ double Objects2d::getPlrPointFromAlpha(Foil const*pFoil, double Re, double Alpha
             return 0.000;
         }
 
-        return pPolar1->interpolateFromAlpha(Alpha, PlrVar, bOutAlpha);
+        return pPolar1->interpolateFromAlpha(Alpha, PlrVar, bOutAlpha, pEntry1->m_Index);
     }
     else
     {
@@ -796,7 +913,7 @@ double Objects2d::getPlrPointFromAlpha(Foil const*pFoil, double Re, double Alpha
             bOutAlpha = true;
             return 0.000;
         }
-        Var1 = pPolar1->interpolateFromAlpha(Alpha, PlrVar, bOutAlpha);
+        Var1 = pPolar1->interpolateFromAlpha(Alpha, PlrVar, bOutAlpha, pEntry1->m_Index);
 
 
         if(!pPolar2->m_Alpha.size())
@@ -806,7 +923,7 @@ double Objects2d::getPlrPointFromAlpha(Foil const*pFoil, double Re, double Alpha
             return 0.000;
         }
 
-        Var2 = pPolar2->interpolateFromAlpha(Alpha, PlrVar, bOutAlpha);
+        Var2 = pPolar2->interpolateFromAlpha(Alpha, PlrVar, bOutAlpha, pEntry2->m_Index);
         // then interpolate Variable
 
         double v = (Re - pPolar1->Reynolds()) / (pPolar2->Reynolds() - pPolar1->Reynolds());
@@ -837,8 +954,7 @@ void Objects2d::getLinearizedPolar(Foil const*pFoil0, Foil const*pFoil1, double
     double AlphaTemp1(0), AlphaTemp2(0), SlopeTemp1(0), SlopeTemp2(0);
 
     //Find the two polars which enclose the Reynolds number
-    int size = 0;
-    Polar const *pPolar(nullptr), *pPolar1(nullptr), *pPolar2(nullptr);
+    Polar const *pPolar1(nullptr), *pPolar2(nullptr);
 
     if(!pFoil0)
     {
@@ -846,36 +962,7 @@ void Objects2d::getLinearizedPolar(Foil const*pFoil0, Foil const*pFoil1, double
     }
     else
     {
-        pPolar1 = nullptr;
-        pPolar2 = nullptr;
-        for (int i=0; i<nPolars(); i++)
-        {
-            pPolar = polarAt(i);
-            if(pPolar->foilName() == pFoil0->name()) size++;
-        }
-        if(size)
-        {
-            for (int i=0; i<nPolars(); i++)
-            {
-                pPolar = polarAt(i);
-                if(pPolar->foilName() == pFoil0->name())
-                {
-                    if(pPolar->Reynolds() < Re) pPolar1 = pPolar;
-                }
-            }
-            for (int i=0; i<nPolars(); i++)
-            {
-                pPolar = polarAt(i);
-                if(pPolar->foilName() == pFoil0->name())
-                {
-                    if(pPolar->Reynolds() > Re)
-                    {
-                        pPolar2 = pPolar;
-                        break;
-                    }
-                }
-            }
-        }
+        bracketingPolars(pFoil0, Re, pPolar1, pPolar2);
         if(pPolar1 && pPolar2)
         {
             pPolar1->getLinearizedCl(AlphaTemp1, SlopeTemp1);
@@ -899,36 +986,7 @@ void Objects2d::getLinearizedPolar(Foil const*pFoil0, Foil const*pFoil1, double
     }
     else
     {
-        pPolar1 = nullptr;
-        pPolar2 = nullptr;
-        for (int i=0; i<nPolars(); i++)
-        {
-            pPolar = polarAt(i);
-            if(pPolar->foilName() == pFoil1->name()) size++;
-        }
-        if(size)
-        {
-            for (int i=0; i<nPolars(); i++)
-            {
-                pPolar = polarAt(i);
-                if(pPolar->foilName() == pFoil1->name())
-                {
-                    if(pPolar->Reynolds() < Re) pPolar1 = pPolar;
-                }
-            }
-            for (int i=0; i<nPolars(); i++)
-            {
-                pPolar = polarAt(i);
-                if(pPolar->foilName() == pFoil1->name())
-                {
-                    if(pPolar->Reynolds() > Re)
-                    {
-                        pPolar2 = pPolar;
-                        break;
-                    }
-                }
-            }
-        }
+        bracketingPolars(pFoil1, Re, pPolar1, pPolar2);
         if(pPolar1 && pPolar2)
         {
             pPolar1->getLinearizedCl(AlphaTemp1, SlopeTemp1);
@@ -964,44 +1022,13 @@ double Objects2d::getZeroLiftAngle(Foil const *pFoil0, Foil const*pFoil1, double
     double Alpha00(0), Alpha01(0);
 
     //Find the two polars which enclose Reynolds
-    bool bPolar = false;
     Polar const *pPolar1(nullptr);
     Polar const *pPolar2(nullptr);
 
     if(!pFoil0) Alpha00 = 0.0;
     else
     {
-        pPolar1 = nullptr;
-        pPolar2 = nullptr;
-        bPolar = false;
-        for (int i=0; i<nPolars(); i++)
-        {
-            Polar const *pPolar = polarAt(i);
-            if(pPolar->foilName() == pFoil0->name()) {bPolar=true; break;}
-        }
-        if(bPolar)
-        {
-            for (int i=0; i<nPolars(); i++)
-            {
-                Polar const *pPolar = polarAt(i);
-                if(pPolar->foilName() == pFoil0->name())
-                {
-                    if(pPolar->Reynolds() < Re) pPolar1 = pPolar;
-                }
-            }
-            for (int i=0; i<nPolars(); i++)
-            {
-                Polar const *pPolar = polarAt(i);
-                if(pPolar->foilName() == pFoil0->name())
-                {
-                    if(pPolar->Reynolds() > Re)
-                    {
-                        pPolar2 = pPolar;
-                        break;
-                    }
-                }
-            }
-        }
+        bracketingPolars(pFoil0, Re, pPolar1, pPolar2);
         if(pPolar1 && pPolar2)
         {
             a01 = pPolar1->getZeroLiftAngle();
@@ -1022,37 +1049,7 @@ double Objects2d::getZeroLiftAngle(Foil const *pFoil0, Foil const*pFoil1, double
     if(!pFoil1) Alpha01 = 0.0;
     else
     {
-        pPolar1 = nullptr;
-        pPolar2 = nullptr;
-        bPolar = false;
-        for (int i=0; i<nPolars(); i++)
-        {
-            Polar const *pPolar = polarAt(i);
-            if(pPolar->foilName() == pFoil1->name())  {bPolar=true; break;}
-        }
-        if(bPolar)
-        {
-            for (int i=0; i<nPolars(); i++)
-            {
-                Polar const *pPolar = polarAt(i);
-                if(pPolar->foilName() == pFoil1->name())
-                {
-                    if(pPolar->Reynolds() < Re) pPolar1 = pPolar;
-                }
-            }
-            for (int i=0; i<nPolars(); i++)
-            {
-                Polar const *pPolar = polarAt(i);
-                if(pPolar->foilName() == pFoil1->name())
-                {
-                    if(pPolar->Reynolds() > Re)
-                    {
-                        pPolar2 = pPolar;
-                        break;
-                    }
-                }
-            }
-        }
+        bracketingPolars(pFoil1, Re, pPolar1, pPolar2);
         if(pPolar1 && pPolar2)
         {
             a01 = pPolar1->getZeroLiftAngle();
@@ -1089,43 +1086,13 @@ void Objects2d::getStallAngles(Foil const *pFoilA, Foil const *pFoilB, double Re
     double posB=0, negB=0;
 
     //Find the two polars which enclose Reynolds
-    int size = 0;
     Polar const *pPolar1=nullptr;
     Polar const *pPolar2=nullptr;
 
     if(!pFoilA) {posA = negA = 0.0;}
     else
     {
-        pPolar1 = nullptr;
-        pPolar2 = nullptr;
-        for (int i=0; i<nPolars(); i++)
-        {
-            Polar const *pPolar = polarAt(i);
-            if(pPolar->foilName() == pFoilA->name()) size++;
-        }
-        if(size)
-        {
-            for (int i=0; i<nPolars(); i++)
-            {
-                Polar const *pPolar = polarAt(i);
-                if(pPolar->foilName() == pFoilA->name())
-                {
-                    if(pPolar->Reynolds() < Re) pPolar1 = pPolar;
-                }
-            }
-            for (int i=0; i<nPolars(); i++)
-            {
-                Polar const*pPolar = polarAt(i);
-                if(pPolar->foilName() == pFoilA->name())
-                {
-                    if(pPolar->Reynolds() > Re)
-                    {
-                        pPolar2 = pPolar;
-                        break;
-                    }
-                }
-            }
-        }
+        bracketingPolars(pFoilA, Re, pPolar1, pPolar2);
         if(pPolar1 && pPolar2)
         {
             double pos1=0, pos2=0;
@@ -1142,36 +1109,7 @@ void Objects2d::getStallAngles(Foil const *pFoilA, Foil const *pFoilB, double Re
     if(!pFoilB) {posB = negB = 0.0;}
     else
     {
-        pPolar1 = nullptr;
-        pPolar2 = nullptr;
-        for (int i=0; i<nPolars(); i++)
-        {
-            Polar const *pPolar = polarAt(i);
-            if(pPolar->foilName() == pFoilB->name()) size++;
-        }
-        if(size)
-        {
-            for (int i=0; i<nPolars(); i++)
-            {
-                Polar const *pPolar = polarAt(i);
-                if(pPolar->foilName() == pFoilB->name())
-                {
-                    if(pPolar->Reynolds() < Re) pPolar1 = pPolar;
-                }
-            }
-            for (int i=0; i<nPolars(); i++)
-            {
-                Polar const *pPolar = polarAt(i);
-                if(pPolar->foilName() == pFoilB->name())
-                {
-                    if(pPolar->Reynolds() > Re)
-                    {
-                        pPolar2 = pPolar;
-                        break;
-                    }
-                }
-            }
-        }
+        bracketingPolars(pFoilB, Re, pPolar1, pPolar2);
         if(pPolar1 && pPolar2)
         {
             double pos1=0, pos2=0;
@@ -1241,7 +1179,7 @@ OpPoint *Objects2d::opPointAt(Foil const*pFoil, Polar const*pPolar, double OppPa
     for (int i=0; i<nOpPoints(); i++)
     {
         if(!pPolar) return nullptr;
-        pOpPoint = s_oaOpp.at(i);
+        pOpPoint = store().m_oaOpp.at(i);
         //since alphas are calculated at 1/100th
         if (pOpPoint->foilName() == pFoil->name())
         {
@@ -1288,7 +1226,7 @@ void Objects2d::setPolarStyle(Polar *pPolar, LineStyle const &ls, bool bStyle, b
 
     for(int ipp=nOpPoints()-1; ipp>=0; ipp--)
     {
-        OpPoint *pOpp = s_oaOpp.at(ipp);
+        OpPoint *pOpp = store().m_oaOpp.at(ipp);
         if(pOpp->foilName().compare(pFoil->name())==0 && pOpp->polarName().compare(pPolar->name())==0)
         {
             if(bStyle) pOpp->setLineStipple(ls.m_Stipple);
@@ -1317,7 +1255,7 @@ void Objects2d::setFoilStyle(Foil *pFoil, const LineStyle &ls, bool bStyle, bool
     OpPoint *pLastOpp = nullptr;
     for(int iwp=0; iwp<nPolars(); iwp++)
     {
-        Polar *pPolar = s_oaPolar.at(iwp);
+        Polar *pPolar = store().m_oaPolar.at(iwp);
         if(pPolar->foilName().compare(pFoil->name())==0)
         {
             if(bStyle) pPolar->setLineStipple(ls.m_Stipple);
@@ -1334,7 +1272,7 @@ void Objects2d::setFoilStyle(Foil *pFoil, const LineStyle &ls, bool bStyle, bool
     }
     for(int ipp=0; ipp<nOpPoints(); ipp++)
     {
-        OpPoint *pOpp = s_oaOpp.at(ipp);
+        OpPoint *pOpp = store().m_oaOpp.at(ipp);
         if(pOpp->foilName().compare(pFoil->name())==0)
         {
             if(bStyle)pOpp->setLineStipple(ls.m_Stipple);
@@ -1360,7 +1298,7 @@ void Objects2d::setFoilVisible(Foil *pFoil, bool bVisible, bool bChildrenOnly)
 
     for(int iwp=0; iwp<nPolars(); iwp++)
     {
-        Polar *pPolar = s_oaPolar.at(iwp);
+        Polar *pPolar = store().m_oaPolar.at(iwp);
         if(pPolar->foilName().compare(pFoil->name())==0)
         {
             pPolar->setVisible(bVisible);
@@ -1368,7 +1306,7 @@ void Objects2d::setFoilVisible(Foil *pFoil, bool bVisible, bool bChildrenOnly)
     }
     for(int ipp=0; ipp<nOpPoints(); ipp++)
     {
-        OpPoint *pPOpp = s_oaOpp.at(ipp);
+        OpPoint *pPOpp = store().m_oaOpp.at(ipp);
         if(pPOpp->foilName().compare(pFoil->name())==0)
         {
             pPOpp->setVisible(bVisible);
@@ -1386,7 +1324,7 @@ void Objects2d::setPolarVisible(Polar *pPolar, bool bVisible)
 
     for(int ipp=0; ipp<nOpPoints(); ipp++)
     {
-        OpPoint *pOpp = s_oaOpp.at(ipp);
+        OpPoint *pOpp = store().m_oaOpp.at(ipp);
         if(pOpp->foilName().compare(pFoil->name())==0)
         {
             if(pOpp->polarName().compare(pPolar->name())==0)
@@ -1450,13 +1388,85 @@ Polar *Objects2d::createPolar(Foil const*pFoil, xfl::enumPolarType PolarType, do
 
 bool Objects2d::foilExists(std::string const &FoilName, Qt::CaseSensitivity )
 {
-    for (int i=0; i<nFoils(); i++)
+    return foil(FoilName)!=nullptr;
+}
+
+
+/**
+ * Returns a hash of the foil's node coordinates, either of the base nodes or of the active, i.e. flapped, nodes.
+ * The coordinates are hashed bit for bit, so that foils with the same hash have the same geometry but for
+ * the rare collisions; use isSameGeometry() to confirm.
+ */
+uint64_t Objects2d::foilHash(Foil const *pFoil, bool bBaseNodes)
+{
+    // 64-bit FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    auto addBytes = [&hash](void const *pData, size_t nBytes)
     {
-        Foil *pFoil = s_oaFoil.at(i);
-        if(pFoil->name().compare(FoilName)==0) return true;
+        unsigned char const *pByte = static_cast<unsigned char const*>(pData);
+        for(size_t i=0; i<nBytes; i++)
+        {
+            hash ^= pByte[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    if(!pFoil) return hash;
+
+    int n = bBaseNodes ? pFoil->nBaseNodes() : pFoil->nNodes();
+    addBytes(&n, sizeof(int));
+    for(int i=0; i<n; i++)
+    {
+        // +0.0 so that -0.0 and 0.0 hash the same
+        double x = (bBaseNodes ? pFoil->xb(i) : pFoil->x(i)) + 0.0;
+        double y = (bBaseNodes ? pFoil->yb(i) : pFoil->y(i)) + 0.0;
+        addBytes(&x, sizeof(double));
+        addBytes(&y, sizeof(double));
     }
+    return hash;
+}
 
-    return false;
+
+/** Returns true if the two foils have exactly the same base nodes */
+bool Objects2d::isSameGeometry(Foil const *pFoilA, Foil const *pFoilB)
+{
+    if(!pFoilA || !pFoilB) return false;
+    if(pFoilA->nBaseNodes()!=pFoilB->nBaseNodes()) return false;
+    for(int i=0; i<pFoilA->nBaseNodes(); i++)
+    {
+        if(pFoilA->xb(i)!=pFoilB->xb(i) || pFoilA->yb(i)!=pFoilB->yb(i)) return false;
+    }
+    return true;
+}
+
+
+/**
+ * For each foil of the list, returns the index of the first foil earlier in the list with the same base geometry,
+ * or -1 if the foil's geometry is the first of its kind.
+ * Used to store the geometry of the near-duplicate foils only once per archive.
+ */
+std::vector<int> Objects2d::geometrySources(std::vector<Foil*> const &foilList)
+{
+    std::vector<int> sources(foilList.size(), -1);
+    std::unordered_map<uint64_t, std::vector<int>> firstOfKind;
+
+    for(size_t i=0; i<foilList.size(); i++)
+    {
+        Foil const *pFoil = foilList.at(i);
+        if(!pFoil || pFoil->nBaseNodes()==0) continue;
+
+        std::vector<int> &bucket = firstOfKind[foilHash(pFoil, true)];
+        for(int j : bucket)
+        {
+            if(isSameGeometry(foilList.at(j), pFoil))
+            {
+                sources[i] = j;
+                break;
+            }
+        }
+        if(sources[i]<0) bucket.push_back(int(i));
+    }
+    return sources;
 }
 
 
@@ -1464,7 +1474,7 @@ std::vector<std::string> Objects2d::foilNames()
 {
     std::vector<std::string> list;
     for (int i=0; i<nFoils(); i++)
-        list.push_back(s_oaFoil.at(i)->name());
+        list.push_back(store().m_oaFoil.at(i)->name());
     return list;
 }
 
@@ -1476,7 +1486,7 @@ std::vector<std::string> Objects2d::polarList(Foil const*pFoil, BL::enumBLMethod
     {
         for(int i=0; i<nPolars(); i++)
         {
-            Polar const *pPolar = s_oaPolar.at(i);
+            Polar const *pPolar = store().m_oaPolar.at(i);
             if(pPolar->foilName()==pFoil->name())
             {
                  if(method==BL::NOBLMETHOD || pPolar->BLMethod()==method)
@@ -1490,12 +1500,13 @@ std::vector<std::string> Objects2d::polarList(Foil const*pFoil, BL::enumBLMethod
 
 void Objects2d::renameThisFoil(Foil *pFoil, const std::string &newFoilName)
 {
+    invalidatePolarIndex();
     std::string oldFoilName = pFoil->name();
 
     int pos = -1;
     for (int i=0; i<nFoils(); i++)
     {
-        if(s_oaFoil.at(i)==pFoil)
+        if(store().m_oaFoil.at(i)==pFoil)
         {
             pos = i;
             break;
@@ -1508,23 +1519,23 @@ void Objects2d::renameThisFoil(Foil *pFoil, const std::string &newFoilName)
     pFoil->setName(newFoilName);
 
     // remove an re-insert in alphabetical order
-    s_oaFoil.erase(s_oaFoil.begin()+pos);
+    store().m_oaFoil.erase(store().m_oaFoil.begin()+pos);
     bool bInserted = false;
     for(int i=0; i<nFoils(); i++)
     {
-        if(pFoil->name().compare(s_oaFoil.at(i)->name())<0)
+        if(pFoil->name().compare(store().m_oaFoil.at(i)->name())<0)
         {
-            s_oaFoil.insert(s_oaFoil.begin()+i, pFoil);
+            store().m_oaFoil.insert(store().m_oaFoil.begin()+i, pFoil);
             bInserted = true;
             break;
         }
     }
-    if(!bInserted) s_oaFoil.push_back(pFoil);
+    if(!bInserted) store().m_oaFoil.push_back(pFoil);
 
     //rename its children objects
     for (int iPolar=0; iPolar<nPolars(); iPolar++)
     {
-        Polar* pOldPolar = s_oaPolar.at(iPolar);
+        Polar* pOldPolar = store().m_oaPolar.at(iPolar);
         if(pOldPolar->foilName() == oldFoilName)
         {
             pOldPolar->setFoilName(newFoilName);
@@ -1533,7 +1544,7 @@ void Objects2d::renameThisFoil(Foil *pFoil, const std::string &newFoilName)
 
     for (int iOpp=0; iOpp<nOpPoints(); iOpp++)
     {
-        OpPoint *pOpPoint = s_oaOpp.at(iOpp);
+        OpPoint *pOpPoint = store().m_oaOpp.at(iOpp);
         if(pOpPoint->foilName() == oldFoilName)
         {
             pOpPoint->setFoilName(newFoilName);
@@ -1548,7 +1559,7 @@ void Objects2d::cancelTEFlapAngles()
 
     for(int ifoil=0; ifoil<nFoils(); ifoil++)
     {
-        Foil *pFoil = s_oaFoil.at(ifoil);
+        Foil *pFoil = store().m_oaFoil.at(ifoil);
         if(pFoil->hasTEFlap() && fabs(pFoil->TEFlapAngle())>FLAPANGLEPRECISION)
         {
             pFoil->setTEFlapAngle(0.0);
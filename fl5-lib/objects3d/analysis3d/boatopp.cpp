@@ -30,6 +30,7 @@
 
 
 #include <boatopp.h>
+#include <memorybudget.h>
 
 
 #include <boat.h>
@@ -93,15 +94,21 @@ BoatOpp::BoatOpp(Boat *pBoat, BoatPolar *pBtPolar, int nPanel3, int nPanel4)
 }
 
 
-bool BoatOpp::serializeBoatOppFl5(QDataStream &ar, bool bIsStoring)
+/**
+ * @param bDeferFields if true when loading, the panel field arrays are left to be decoded by decodePendingFields()
+ */
+bool BoatOpp::serializeBoatOppFl5(QDataStream &ar, bool bIsStoring, bool bDeferFields)
 {
     // 100001: first file format
     // 100002: added lift and drag
     // 100003: added vortons and negating vortices
     // 100004: Modified the format of AeroForces serialization
     // 100005: beta20 - Added the roration about Ry
+    // 100006: added packed field arrays; only written if requested, so that the files remain readable by older versions
+    // 100007: added the compact vorton wake, with packed field arrays; only written if requested
 
-    int ArchiveFormat=100005;
+    int ArchiveFormat = s_FieldStorage==RAWFLOAT ? 100005 : 100006;
+    if(s_WakeStorage==FLOATWAKE) ArchiveFormat = 100007;
 
     float f(0),g(0),h(0);
 
@@ -155,24 +162,27 @@ bool BoatOpp::serializeBoatOppFl5(QDataStream &ar, bool bIsStoring)
         if(isQuadMethod())           N = m_nPanel4;
         else if(isTriangleMethod())  N = 3*m_nPanel3;
         ar << N;
-        for (int p=0; p<N; p++) ar << float(m_Cp[p]) << float(m_gamma[p]) << float(m_sigma[p]);
-
-
-        ar << int(m_Vorton.size());
-        for(uint ir=0; ir<m_Vorton.size(); ir++)
+        if(ArchiveFormat>=100006)
+        {
+            bool bFixed16 = s_FieldStorage==PACKEDFIXED16;
+            xfl::writePackedArray(ar, m_Cp.data(),    N, bFixed16);
+            xfl::writePackedArray(ar, m_gamma.data(), N, bFixed16);
+            xfl::writePackedArray(ar, m_sigma.data(), N, bFixed16);
+        }
+        else
         {
-            ar <<int(m_Vorton.at(ir).size());
-            for(uint ic=0; ic<m_Vorton.at(ir).size(); ic++)
+            std::vector<double> values(3*size_t(N));
+            for (int p=0; p<N; p++)
             {
-                m_Vorton[ir][ic].serializeFl5(ar, bIsStoring);
+                values[3*p]   = m_Cp[p];
+                values[3*p+1] = m_gamma[p];
+                values[3*p+2] = m_sigma[p];
             }
+            xfl::writeFloatArray(ar, values.data(), 3*N);
         }
 
-        ar << int(m_VortexNeg.size());
-        for(uint iv=0; iv<m_VortexNeg.size(); iv++)
-        {
-            m_VortexNeg[iv].serializeFl5(ar, bIsStoring);
-        }
+
+        writeWakeFl5(ar, ArchiveFormat>=100007);
 
 
         // dynamic space allocation for the future storage of more data, without need to change the format
@@ -242,12 +252,15 @@ bool BoatOpp::serializeBoatOppFl5(QDataStream &ar, bool bIsStoring)
         m_Cp.resize(N);
         m_gamma.resize(N);
         m_sigma.resize(N);
-        for (int p=0; p<N; p++)
+        if(ArchiveFormat>=100006)
         {
-            ar >> f >> g >> h;
-            m_Cp[p]    = double(f);
-            m_gamma[p]     = double(g);
-            m_sigma[p] = double(h);
+            if(!readFields(ar, true, N, {CPFIELD},    bDeferFields)) return false;
+            if(!readFields(ar, true, N, {GAMMAFIELD}, bDeferFields)) return false;
+            if(!readFields(ar, true, N, {SIGMAFIELD}, bDeferFields)) return false;
+        }
+        else
+        {
+            if(!readFields(ar, false, 3*N, {CPFIELD, GAMMAFIELD, SIGMAFIELD}, bDeferFields)) return false;
         }
 
         m_nPanel4 = m_nPanel3 = 0;
@@ -256,24 +269,7 @@ bool BoatOpp::serializeBoatOppFl5(QDataStream &ar, bool bIsStoring)
 
         if(ArchiveFormat>=100003)
         {
-            ar >> n;
-            m_Vorton.resize(n);
-            for(uint ir=0; ir<m_Vorton.size(); ir++)
-            {
-                ar >> n;
-                m_Vorton[ir].resize(n);
-                for(uint ic=0; ic<m_Vorton.at(ir).size(); ic++)
-                {
-                    m_Vorton[ir][ic].serializeFl5(ar, bIsStoring);
-                }
-            }
-
-            ar >> n;
-            m_VortexNeg.resize(n);
-            for(int iv=0; iv<n; iv++)
-            {
-                m_VortexNeg[iv].serializeFl5(ar, bIsStoring);
-            }
+            if(!readWakeFl5(ar, ArchiveFormat>=100007)) return false;
         }
 
         // space allocation
@@ -604,3 +600,10 @@ void BoatOpp::exportPanel3DataToString(Boat const*pBoat,
 
     data = paneldata.toStdString();
 }
+
+
+size_t BoatOpp::memoryFootprint() const
+{
+    return sizeof(BoatOpp) + Opp3d::memoryFootprint()
+            + MemoryBudget::bytes(m_SailAngle) + MemoryBudget::bytes(m_SailForceFF) + MemoryBudget::bytes(m_SailForceSum);
+}
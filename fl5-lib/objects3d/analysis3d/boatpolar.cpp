@@ -28,6 +28,7 @@
 
 
 #include <boatpolar.h>
+#include <memorybudget.h>
 #include <boatopp.h>
 #include <boat.h>
 #include <sail.h>
@@ -187,6 +188,7 @@ void BoatPolar::addPoint(BoatOpp const *pBtOpp)
         m_Phi.push_back(pBtOpp->phi());
         m_AC.push_back(pBtOpp->aeroForces());
     }
+    setDataModified();
 }
 
 
@@ -670,6 +672,7 @@ void BoatPolar::clearData()
     m_Beta.clear();
     m_Phi.clear();
     m_AC.clear();
+    setDataModified();
 }
 
 
@@ -785,6 +788,7 @@ void BoatPolar::copy(const BoatPolar *pBoatPolar)
     m_VInf = pBoatPolar->m_VInf;
     m_Phi  = pBoatPolar->m_Phi;
     m_AC   = pBoatPolar->m_AC;
+    setDataModified();
 }
 
 
@@ -796,6 +800,7 @@ void BoatPolar::remove(int i)
     m_Beta.erase(m_Beta.begin()+i);
     m_Phi.erase( m_Phi.begin()+i);
     m_AC.erase(  m_AC.begin()+i);
+    setDataModified();
 }
 
 
@@ -807,6 +812,7 @@ void BoatPolar::insertDataPointAt(int index, bool bAfter)
     m_Beta.insert(m_Beta.begin()+index,0.0);
     m_Phi.insert( m_Phi.begin() +index,0.0);
     m_AC.insert(  m_AC.begin()  +index,AeroForces());
+    setDataModified();
 }
 
 
@@ -920,4 +926,9 @@ void BoatPolar::apparentWind(double ctrl, double z, Vector3d &AWS) const
 }
 
 
-
+size_t BoatPolar::memoryFootprint() const
+{
+    return sizeof(BoatPolar)
+         + MemoryBudget::bytes(m_Ctrl) + MemoryBudget::bytes(m_VInf) + MemoryBudget::bytes(m_Beta)
+         + MemoryBudget::bytes(m_Phi)  + MemoryBudget::bytes(m_AC);
+}
@@ -26,8 +26,12 @@
 #define _MATH_DEFINES_DEFINED
 
 #include <opp3d.h>
+#include <memorybudget.h>
 
 
+Opp3d::enumFieldStorage Opp3d::s_FieldStorage(Opp3d::RAWFLOAT);
+Opp3d::enumWakeStorage Opp3d::s_WakeStorage(Opp3d::DOUBLEWAKE);
+
 Opp3d::Opp3d() : XflObject()
 {
     m_nPanel3 = 0;
@@ -51,31 +55,96 @@ Opp3d::Opp3d() : XflObject()
 }
 
 
-void Opp3d::getVortonVelocity(Vector3d const &pt, double CoreSize, Vector3d &V) const
+/**
+ * Reads a block of n field values, written either as packed or as a sequence of floats.
+ * The values are interleaved in the given arrays, which must have been sized beforehand.
+ * @param bDefer if true, the block is kept to be decoded by decodePendingFields(), possibly from another thread.
+ */
+bool Opp3d::readFields(QDataStream &ar, bool bPacked, int n, std::vector<enumField> const &arrays, bool bDefer)
+{
+    PendingField field;
+    field.m_Arrays = arrays;
+    bool bRead = bPacked ? xfl::readPackedBlock(ar, n, field.m_Block) : xfl::readFloatBlock(ar, n, field.m_Block);
+    if(!bRead) return false;
+
+    m_PendingFields.push_back(std::move(field));
+    if(bDefer) return true;
+    return decodePendingFields();
+}
+
+
+/** Decodes the field blocks left pending by readFields(). Independent objects may be decoded concurrently. */
+bool Opp3d::decodePendingFields()
 {
-    Vector3d vel;
-    V.set(0.,0.,0.);
-    for(uint ir=0; ir<m_Vorton.size(); ir++)
+    bool bOk = true;
+    std::vector<double> *pArray[] = {&m_Cp, &m_gamma, &m_sigma};
+    for(PendingField const &field : m_PendingFields)
     {
-        for(uint jc=0; jc<m_Vorton.at(ir).size(); jc++)
+        int k = int(field.m_Arrays.size());
+        int n = field.m_Block.m_nValues;
+        if(k<=0 || n%k!=0) {bOk = false; continue;}
+        for(enumField iArray : field.m_Arrays)
+        {
+            if(int(pArray[iArray]->size())<n/k) bOk = false;
+        }
+        if(!bOk) continue;
+
+        if(k==1)
+        {
+            if(!xfl::decodeArrayBlock(field.m_Block, pArray[field.m_Arrays.front()]->data())) bOk = false;
+            continue;
+        }
+
+        std::vector<double> values(n);
+        if(!xfl::decodeArrayBlock(field.m_Block, values.data())) {bOk = false; continue;}
+        for(int i=0; i<n; i++)
         {
-            Vorton const &vtn = m_Vorton.at(ir).at(jc);
-            if(vtn.isActive())
-            {
-                vtn.inducedVelocity(pt, CoreSize, vel);
-                V += vel;
-
-                if(m_bGround)
-                {
-                    Vector3d VG, CG(pt.x, pt.y, -pt.z-2.0*m_GroundHeight);
-                    vtn.inducedVelocity(pt, CoreSize, VG);
-                    V.x += VG.x;
-                    V.y += VG.y;
-                    V.z -= VG.z;
-                }
-            }
+            (*pArray[field.m_Arrays.at(i%k)])[i/k] = values[i];
         }
     }
+    m_PendingFields.clear();
+    return bOk;
+}
+
+
+/**
+ * Releases the panel fields and the vortons, keeping the scalar results.
+ * The panel counts are reset so that the operating point is saved and loaded without fields.
+ */
+void Opp3d::clearFields()
+{
+    std::vector<double>().swap(m_Cp);
+    std::vector<double>().swap(m_gamma);
+    std::vector<double>().swap(m_sigma);
+    std::vector<double>().swap(m_NodeValue);
+    m_VortonWake.clear();
+    std::vector<Vortex>().swap(m_VortexNeg);
+    std::vector<PendingField>().swap(m_PendingFields);
+    m_nPanel4 = m_nPanel3 = 0;
+}
+
+
+/** Keeps the wake in its compact form, unless the storage option discards the wakes */
+void Opp3d::setVortons(std::vector<std::vector<Vorton>> const &vortons)
+{
+    if(s_WakeStorage==NOWAKE) m_VortonWake.clear();
+    else                      m_VortonWake.set(vortons);
+}
+
+
+/** Returns the velocity induced by the stored wake, evaluated with the wake's octree */
+void Opp3d::getVortonVelocity(Vector3d const &pt, double CoreSize, Vector3d &V) const
+{
+    m_VortonWake.inducedVelocity(pt, CoreSize, V);
+
+    if(m_bGround)
+    {
+        Vector3d VG, CG(pt.x, pt.y, -pt.z-2.0*m_GroundHeight);
+        m_VortonWake.inducedVelocity(CG, CoreSize, VG);
+        V.x += VG.x;
+        V.y += VG.y;
+        V.z -= VG.z;
+    }
 }
 
 
@@ -83,23 +152,81 @@ void Opp3d::getVortonVelocity(Vector3d const &pt, double CoreSize, Vector3d &V)
 std::vector<Vector3d> Opp3d::vortonLines() const
 {
     std::vector<Vector3d> seg;
-    for(int ir=0; ir<int(m_Vorton.size()-1); ir++)
+    for(int ir=0; ir<m_VortonWake.nRows()-1; ir++)
     {
-        for(int ic=0; ic<int(m_Vorton.at(ir).size()); ic++)
+        int nc = std::min(m_VortonWake.rowSize(ir), m_VortonWake.rowSize(ir+1));
+        for(int ic=0; ic<nc; ic++)
         {
-            seg.push_back(m_Vorton.at(ir  ).at(ic).position());
-            seg.push_back(m_Vorton.at(ir+1).at(ic).position());
+            seg.push_back(m_VortonWake.position(m_VortonWake.index(ir,   ic)));
+            seg.push_back(m_VortonWake.position(m_VortonWake.index(ir+1, ic)));
         }
     }
     return seg;
 }
 
 
-int Opp3d::vortonCount() const
+/**
+ * Writes the wake, in the compact format or as rows of vortons in the legacy format.
+ * No wake is written if the storage option discards the wakes.
+ */
+void Opp3d::writeWakeFl5(QDataStream &ar, bool bCompact)
 {
-    if(m_Vorton.size()==0) return 0;
-    return int(m_Vorton.size() * m_Vorton.front().size());
+    VortonWake nowake;
+    std::vector<Vortex> novortex;
+    VortonWake &wake = s_WakeStorage==NOWAKE ? nowake : m_VortonWake;
+    std::vector<Vortex> &vortexneg = s_WakeStorage==NOWAKE ? novortex : m_VortexNeg;
+
+    if(bCompact)
+    {
+        wake.serializeFl5(ar, true);
+    }
+    else
+    {
+        ar << wake.nRows();
+        std::vector<Vorton> row;
+        for(int ir=0; ir<wake.nRows(); ir++)
+        {
+            // one row at a time, so that the full wake is not expanded in double precision
+            row.resize(wake.rowSize(ir));
+            for(int ic=0; ic<int(row.size()); ic++) row[ic] = wake.vorton(wake.index(ir, ic));
+            Vorton::serializeArrayFl5(ar, row, true);
+        }
+    }
+    Vortex::serializeArrayFl5(ar, vortexneg, true);
 }
 
 
+bool Opp3d::readWakeFl5(QDataStream &ar, bool bCompact)
+{
+    if(bCompact)
+    {
+        if(!m_VortonWake.serializeFl5(ar, false)) return false;
+    }
+    else
+    {
+        m_VortonWake.clear();
+        int n=0;
+        ar >> n;
+        if(n<0) return false;
+        std::vector<Vorton> row;
+        for(int ir=0; ir<n; ir++)
+        {
+            if(!Vorton::serializeArrayFl5(ar, row, false)) return false;
+            m_VortonWake.appendRow(row);
+        }
+    }
 
+    if(!Vortex::serializeArrayFl5(ar, m_VortexNeg, false)) return false;
+    return true;
+}
+
+
+/** The memory used by the operating point, in bytes, including the field blocks which have not yet been decoded */
+size_t Opp3d::memoryFootprint() const
+{
+    size_t n = MemoryBudget::bytes(m_Cp) + MemoryBudget::bytes(m_gamma) + MemoryBudget::bytes(m_sigma)
+             + m_VortonWake.bytes() + MemoryBudget::bytes(m_VortexNeg) + MemoryBudget::bytes(m_NodeValue)
+             + MemoryBudget::bytes(m_PendingFields);
+    for(PendingField const &field : m_PendingFields) n += size_t(field.m_Block.m_Data.size());
+    return n;
+}
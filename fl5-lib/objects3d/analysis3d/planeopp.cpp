@@ -38,6 +38,7 @@
 
 #include <planepolar.h>
 #include <planeopp.h>
+#include <memorybudget.h>
 #include <wingopp.h>
 
 #include <constants.h>
@@ -582,9 +583,9 @@ void PlaneOpp::getProperties(Plane const *pPlane, PlanePolar const *pWPolar, std
         props += strange;
     }
 
-    if(m_Vorton.size())
+    if(hasVortons())
     {
-        strange = QString::asprintf("Vortons: %d rows x %d columns", int(m_Vorton.size()), int(m_Vorton.front().size()));
+        strange = QString::asprintf("Vortons: %d rows x %d columns", m_VortonWake.nRows(), m_VortonWake.rowSize(0));
         props += "\n" + strange;
     }
 
@@ -661,7 +662,6 @@ bool PlaneOpp::serializePOppXFL(QDataStream &ar, bool bIsStoring)
 {
     bool boolean(false);
     int k(0), n(0);
-    float f0(0), f1(0), f2(0);
     double dble(0), dbl1(0), dbl2(0);
     QString strange;
 
@@ -737,12 +737,13 @@ bool PlaneOpp::serializePOppXFL(QDataStream &ar, bool bIsStoring)
             m_Cp.resize(m_nPanel4);
             m_sigma.resize(m_nPanel4);
             m_gamma.resize(m_nPanel4);
+            std::vector<double> values(3*m_Cp.size());
+            if(!xfl::readFloatArray(ar, values.data(), 3*m_nPanel4)) return false;
             for (k=0; k<m_nPanel4; k++)
             {
-                ar >> f0 >> f1 >> f2;
-                m_Cp[k]    = double(f0);
-                m_sigma[k] = double(f1);
-                m_gamma[k]     = double(f2);
+                m_Cp[k]    = values[3*k];
+                m_sigma[k] = values[3*k+1];
+                m_gamma[k] = values[3*k+2];
             }
         }
         else if (isTriangleMethod())
@@ -751,21 +752,9 @@ bool PlaneOpp::serializePOppXFL(QDataStream &ar, bool bIsStoring)
             m_Cp.resize(N);
             m_gamma.resize(N);
             m_sigma.resize(m_nPanel3);
-            for (k=0; k<N; k++)
-            {
-                ar >> f0;
-                m_Cp[k] = double(f0);
-            }
-            for (k=0; k<N; k++)
-            {
-                ar >> f0;
-                m_gamma[k] = double(f0);
-            }
-            for (k=0; k<m_nPanel3; k++)
-            {
-                ar >> f0;
-                m_sigma[k] = double(f0);
-            }
+            if(!xfl::readFloatArray(ar, m_Cp.data(),    N))          return false;
+            if(!xfl::readFloatArray(ar, m_gamma.data(), N))          return false;
+            if(!xfl::readFloatArray(ar, m_sigma.data(), m_nPanel3))  return false;
         }
 
 
@@ -856,13 +845,15 @@ bool PlaneOpp::serializePOppXFL(QDataStream &ar, bool bIsStoring)
 }
 
 
-bool PlaneOpp::serializeFl5(QDataStream &ar, bool bIsStoring)
+/**
+ * @param bDeferFields if true when loading, the panel field arrays are left to be decoded by decodePendingFields()
+ */
+bool PlaneOpp::serializeFl5(QDataStream &ar, bool bIsStoring, bool bDeferFields)
 {
     int nIntSpares(0);
     int nDbleSpares(0);
     bool boolean(false);
     int k(0), n(0);
-    float f0(0), f1(0), f2(0);
     QString strange;
 
     double dble(0), dbl1(0), dbl2(0);
@@ -875,7 +866,11 @@ bool PlaneOpp::serializeFl5(QDataStream &ar, bool bIsStoring)
     // 500014: beta 18: added multiple control matrices
     // 500015: beta 18: Modified the format of AeroForces serialization
     // 500016: v7.21: Addded free surface effect
-    int ArchiveFormat = 500016;
+    // 500017: added packed field arrays; only written if requested, so that the files remain readable by older versions
+    // 500018: added the compact vorton wake, with packed field arrays; only written if requested
+    int ArchiveFormat = s_FieldStorage==RAWFLOAT ? 500016 : 500017;
+    if(s_WakeStorage==FLOATWAKE) ArchiveFormat = 500018;
+    bool bFixed16 = s_FieldStorage==PACKEDFIXED16;
 
     if(bIsStoring)
     {
@@ -931,16 +926,31 @@ bool PlaneOpp::serializeFl5(QDataStream &ar, bool bIsStoring)
 
         ar << m_bGround << m_bFreeSurface << m_GroundHeight;
 
-        if(isQuadMethod())
+        if(ArchiveFormat>=500017)
+        {
+            int N = isQuadMethod() ? m_nPanel4 : (isTriangleMethod() ? 3*m_nPanel3 : 0);
+            int NS = isQuadMethod() ? m_nPanel4 : (isTriangleMethod() ? m_nPanel3 : 0);
+            xfl::writePackedArray(ar, m_Cp.data(),    N,  bFixed16);
+            xfl::writePackedArray(ar, m_gamma.data(), N,  bFixed16);
+            xfl::writePackedArray(ar, m_sigma.data(), NS, bFixed16);
+        }
+        else if(isQuadMethod())
         {
-            for (k=0; k<m_nPanel4; k++) ar<<float(m_Cp.at(k))<<float(m_sigma.at(k))<<float(m_gamma.at(k));
+            std::vector<double> values(3*size_t(m_nPanel4));
+            for (k=0; k<m_nPanel4; k++)
+            {
+                values[3*k]   = m_Cp.at(k);
+                values[3*k+1] = m_sigma.at(k);
+                values[3*k+2] = m_gamma.at(k);
+            }
+            xfl::writeFloatArray(ar, values.data(), 3*m_nPanel4);
         }
         else if (isTriangleMethod())
         {
             int N3 = 3*m_nPanel3;
-            for (k=0; k<N3; k++) ar<<float(m_Cp.at(k));
-            for (k=0; k<N3; k++) ar<<float(m_gamma.at(k));
-            for (k=0; k<m_nPanel3; k++) ar<<float(m_sigma.at(k));
+            xfl::writeFloatArray(ar, m_Cp.data(),    N3);
+            xfl::writeFloatArray(ar, m_gamma.data(), N3);
+            xfl::writeFloatArray(ar, m_sigma.data(), m_nPanel3);
         }
 
 
@@ -994,21 +1004,7 @@ bool PlaneOpp::serializeFl5(QDataStream &ar, bool bIsStoring)
         ar << m_phiPH.real() << m_phiPH.imag();
         ar << m_phiDR.real() << m_phiDR.imag();
 
-        ar << int(m_Vorton.size());
-        for(uint ir=0; ir<m_Vorton.size(); ir++)
-        {
-            ar <<int(m_Vorton.at(ir).size());
-            for(uint ic=0; ic<m_Vorton.at(ir).size(); ic++)
-            {
-                m_Vorton[ir][ic].serializeFl5(ar, bIsStoring);
-            }
-        }
-
-        ar << int(m_VortexNeg.size());
-        for(uint iv=0; iv<m_VortexNeg.size(); iv++)
-        {
-            m_VortexNeg[iv].serializeFl5(ar, bIsStoring);
-        }
+        writeWakeFl5(ar, ArchiveFormat>=500018);
 
         ar << 0;
         ar << 0;
@@ -1074,18 +1070,23 @@ bool PlaneOpp::serializeFl5(QDataStream &ar, bool bIsStoring)
             ar >> m_GroundHeight;
         }
 
-        if(isQuadMethod())
+        if(ArchiveFormat>=500017)
+        {
+            int N = isQuadMethod() ? m_nPanel4 : (isTriangleMethod() ? 3*m_nPanel3 : 0);
+            int NS = isQuadMethod() ? m_nPanel4 : (isTriangleMethod() ? m_nPanel3 : 0);
+            m_Cp.resize(N);
+            m_gamma.resize(N);
+            m_sigma.resize(NS);
+            if(!readFields(ar, true, N,  {CPFIELD},    bDeferFields)) return false;
+            if(!readFields(ar, true, N,  {GAMMAFIELD}, bDeferFields)) return false;
+            if(!readFields(ar, true, NS, {SIGMAFIELD}, bDeferFields)) return false;
+        }
+        else if(isQuadMethod())
         {
             m_Cp.resize(m_nPanel4);
             m_sigma.resize(m_nPanel4);
             m_gamma.resize(m_nPanel4);
-            for (k=0; k<m_nPanel4; k++)
-            {
-                ar >> f0 >> f1 >> f2;
-                m_Cp[k]    = double(f0);
-                m_sigma[k] = double(f1);
-                m_gamma[k]     = double(f2);
-            }
+            if(!readFields(ar, false, 3*m_nPanel4, {CPFIELD, SIGMAFIELD, GAMMAFIELD}, bDeferFields)) return false;
         }
         else if (isTriangleMethod())
         {
@@ -1093,21 +1094,9 @@ bool PlaneOpp::serializeFl5(QDataStream &ar, bool bIsStoring)
             m_Cp.resize(N);
             m_gamma.resize(N);
             m_sigma.resize(m_nPanel3);
-            for (k=0; k<N; k++)
-            {
-                ar >> f0;
-                m_Cp[k] = double(f0);
-            }
-            for (k=0; k<N; k++)
-            {
-                ar >> f0;
-                m_gamma[k] = double(f0);
-            }
-            for (k=0; k<m_nPanel3; k++)
-            {
-                ar >> f0;
-                m_sigma[k] = double(f0);
-            }
+            if(!readFields(ar, false, N,         {CPFIELD},    bDeferFields)) return false;
+            if(!readFields(ar, false, N,         {GAMMAFIELD}, bDeferFields)) return false;
+            if(!readFields(ar, false, m_nPanel3, {SIGMAFIELD}, bDeferFields)) return false;
         }
 
         int pos = 0;
@@ -1116,6 +1105,7 @@ bool PlaneOpp::serializeFl5(QDataStream &ar, bool bIsStoring)
             if(!m_WingOpp[iw].serializeWingOppFl5(ar, bIsStoring))
                 return false;
 
+            if(m_Cp.empty()) continue; // saved without its fields
             m_WingOpp[iw].m_dCp    = m_Cp.data()    + pos;
             m_WingOpp[iw].m_dG     = m_gamma.data() + pos;
             m_WingOpp[iw].m_dSigma = m_sigma.data() + pos;
@@ -1222,24 +1212,7 @@ bool PlaneOpp::serializeFl5(QDataStream &ar, bool bIsStoring)
         {
             if(ArchiveFormat>=500012)
             {
-                ar >> n;
-                m_Vorton.resize(n);
-                for(uint ir=0; ir<m_Vorton.size(); ir++)
-                {
-                    ar >> n;
-                    m_Vorton[ir].resize(n);
-                    for(uint ic=0; ic<m_Vorton.at(ir).size(); ic++)
-                    {
-                        m_Vorton[ir][ic].serializeFl5(ar, bIsStoring);
-                    }
-                }
-
-                ar >> n;
-                m_VortexNeg.resize(n);
-                for(int iv=0; iv<n; iv++)
-                {
-                    m_VortexNeg[iv].serializeFl5(ar, bIsStoring);
-                }
+                if(!readWakeFl5(ar, ArchiveFormat>=500018)) return false;
             }
 
             ar >> nIntSpares;
@@ -1556,3 +1529,22 @@ void PlaneOpp::outputEigen(std::string &logmsg)
     }
     logmsg = log.toStdString();
 }
+
+
+void PlaneOpp::clearFields()
+{
+    Opp3d::clearFields();
+    for(WingOpp &wopp : m_WingOpp)
+    {
+        wopp.m_dCp = wopp.m_dG = wopp.m_dSigma = nullptr;
+    }
+}
+
+
+size_t PlaneOpp::memoryFootprint() const
+{
+    size_t n = sizeof(PlaneOpp) + Opp3d::memoryFootprint();
+    n += MemoryBudget::bytes(m_WingOpp) + MemoryBudget::bytes(m_BLong) + MemoryBudget::bytes(m_BLat) + MemoryBudget::bytes(m_FuseAF);
+    for(WingOpp const &wopp : m_WingOpp) n += wopp.memoryFootprint();
+    return n;
+}
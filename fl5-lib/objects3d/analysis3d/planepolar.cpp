@@ -25,9 +25,11 @@
 #define _MATH_DEFINES_DEFINED
 
 #include <QString>
+#include <QDataStream>
 
 
 #include <planepolar.h>
+#include <memorybudget.h>
 
 #include <constants.h>
 #include <geom_global.h>
@@ -205,6 +207,7 @@ void PlanePolar::insertPOppDataAt(int pos, PlaneOpp const *pPOpp)
     m_CoG_z.insert(m_CoG_z.begin()+pos, 0.0);
 
     calculatePoint(pos);
+    setDataModified();
 }
 
 
@@ -237,6 +240,7 @@ void PlanePolar::insertDataAt(int pos, double Alpha, double Beta, double Phi, do
     m_Mass_var.insert(m_Mass_var.begin()+pos, 0.0);
     m_CoG_x.insert(m_CoG_x.begin()+pos, 0.0);
     m_CoG_z.insert(m_CoG_z.begin()+pos, 0.0);
+    setDataModified();
 }
 
 
@@ -257,134 +261,58 @@ void PlanePolar::resizeData(int newsize)
 
     m_AF.resize(newsize);
     m_EV.resize(newsize);
+    setDataModified();
 }
 
 
+/**
+ * Inserts the results of the operating point in the sorted arrays, or replaces those of the point
+ * with the same operating parameters. The position is found by bisection.
+ */
 void PlanePolar::addPlaneOpPointData(PlaneOpp const *pPOpp)
 {
-    bool bInserted(false);
-    double d(0.001);
-    int size = dataSize();
+    double const d(0.001);
 
-    if(size)
+    // true if the point i is sorted before the new point and is not replaced by it
+    auto before = [this, pPOpp, d](int i)
     {
-        for (int i=0; i<size; i++)
+        if(m_Type<xfl::T4POLAR)    return m_Alpha.at(i)     <= pPOpp->alpha()-d;
+        if(isFixedaoaPolar())      return m_QInfinite.at(i) <= pPOpp->m_QInf-d;   // type 4, sort by speed
+        if(isBetaPolar())          return m_Beta.at(i)      <= pPOpp->beta()-d;    // type 5, sort by sideslip angle
+        if(isStabilityPolar() || isControlPolar())
+            return m_Ctrl.at(i) <= pPOpp->ctrl()-d;                                // sort by control value
+        if(isType8Polar())
         {
-            if(m_Type<xfl::T4POLAR)
-            {
-                if (fabs(pPOpp->alpha()-m_Alpha.at(i)) < d)
-                {
-                    replacePOppDataAt(i, pPOpp);
-                    bInserted = true;
-                    break;
-                }
-                else if (pPOpp->alpha() < m_Alpha.at(i))
-                {
-                    insertPOppDataAt(i, pPOpp);
-                    bInserted = true;
-                    break;
-                }
-            }
-            else if(isFixedaoaPolar())
-            {
-                // type 4, sort by speed
-                if (fabs(pPOpp->m_QInf - m_QInfinite.at(i)) < d)
-                {
-                    // then erase former result
-                    replacePOppDataAt(i, pPOpp);
-                    bInserted = true;
-                    break;
-                }
-                else if (pPOpp->m_QInf < m_QInfinite.at(i))
-                {
-                    // sort by crescending speed
-                    insertPOppDataAt(i, pPOpp);
-                    bInserted = true;
-                    break;
-                }
-            }
-            else if(isBetaPolar())
-            {
-                // type 5, sort by sideslip angle
-                if (fabs(pPOpp->beta() - m_Beta.at(i)) < d)
-                {
-                    // then erase former result
-                    replacePOppDataAt(i, pPOpp);
-                    bInserted = true;
-                    break;
-                }
-                else if (pPOpp->beta() < m_Beta.at(i))
-                {
-                    // sort by crescending speed
-                    insertPOppDataAt(i, pPOpp);
-                    bInserted = true;
-                    break;
-                }
-            }
-            else if(isStabilityPolar() || isControlPolar())
-            {
-                // Control or stability analysis, sort by control value
-                if (fabs(pPOpp->ctrl() - m_Ctrl.at(i))<d)
-                {
-                    // then erase former result
-                    replacePOppDataAt(i, pPOpp);
-                    bInserted = true;
-                    break;
-                }
-                else if (pPOpp->ctrl() < m_Ctrl.at(i))
-                {
-                    // sort by crescending control values
-                    insertPOppDataAt(i, pPOpp);
-                    bInserted = true;
-                    break;
-                }
-            }
-            else if(isType8Polar())
-            {
-                // Type 8 analysis, sort by alpha then beta then QInf
-                if (fabs(pPOpp->alpha()-m_Alpha.at(i))<d)
-                {
-                    if (fabs(pPOpp->beta() - m_Beta.at(i)) < d)
-                    {
-                        if (fabs(pPOpp->m_QInf - m_QInfinite.at(i)) < d)
-                        {
-                            // then erase former result
-                            replacePOppDataAt(i, pPOpp);
-                            bInserted = true;
-                            break;
-                        }
-                        else if (pPOpp->m_QInf < m_QInfinite.at(i))
-                        {
-                            // sort by crescending speed
-                            insertPOppDataAt(i, pPOpp);
-                            bInserted = true;
-                            break;
-                        }
-                    }
-                    else if (pPOpp->beta() < m_Beta.at(i))
-                    {
-                        // sort by crescending speed
-                        insertPOppDataAt(i, pPOpp);
-                        bInserted = true;
-                        break;
-                    }
-                }
-                else if (pPOpp->alpha() < m_Alpha.at(i))
-                {
-                    insertPOppDataAt(i, pPOpp);
-                    bInserted = true;
-                    break;
-                }
-            }
+            // Type 8 analysis, sort by alpha then beta then QInf
+            if(fabs(pPOpp->alpha()-m_Alpha.at(i))>=d) return m_Alpha.at(i) < pPOpp->alpha();
+            if(fabs(pPOpp->beta() -m_Beta.at(i)) >=d) return m_Beta.at(i)  < pPOpp->beta();
+            return m_QInfinite.at(i) <= pPOpp->m_QInf-d;
         }
-    }
+        return true; // appended
+    };
+
+    auto same = [this, pPOpp, d](int i)
+    {
+        if(m_Type<xfl::T4POLAR)    return fabs(pPOpp->alpha()-m_Alpha.at(i)) < d;
+        if(isFixedaoaPolar())      return fabs(pPOpp->m_QInf-m_QInfinite.at(i)) < d;
+        if(isBetaPolar())          return fabs(pPOpp->beta()-m_Beta.at(i)) < d;
+        if(isStabilityPolar() || isControlPolar())
+            return fabs(pPOpp->ctrl()-m_Ctrl.at(i)) < d;
+        if(isType8Polar())
+            return fabs(pPOpp->alpha()-m_Alpha.at(i))<d && fabs(pPOpp->beta()-m_Beta.at(i))<d && fabs(pPOpp->m_QInf-m_QInfinite.at(i))<d;
+        return false;
+    };
 
-    if(!bInserted)
+    int lo=0, hi=dataSize();
+    while(lo<hi)
     {
-        // data is appended at the end
-        int size = dataSize();
-        insertPOppDataAt(size, pPOpp);
+        int mid = (lo+hi)/2;
+        if(before(mid)) lo = mid+1;
+        else            hi = mid;
     }
+
+    if(lo<dataSize() && same(lo)) replacePOppDataAt(lo, pPOpp);    // then erase former result
+    else                          insertPOppDataAt(lo, pPOpp);
 }
 
 
@@ -532,6 +460,15 @@ double PlanePolar::variable(int iVariable, int index) const
 }
 
 
+/** Fills the array with the values of the variable at each point */
+void PlanePolar::getColumn(int iVar, std::vector<double> &values) const
+{
+    int n = dataSize();
+    values.resize(size_t(n));
+    for(int i=0; i<n; i++) values[i] = getVariable(iVar, i);
+}
+
+
 double PlanePolar::getVariable(int iVar, int index) const
 {
     Vector3d WindD = objects::windDirection(m_Alpha.at(index), m_Beta.at(index));
@@ -711,6 +648,7 @@ void PlanePolar::removeAt(int index)
     m_EV.erase(m_EV.begin()+index);
 
     m_QInfinite.erase(m_QInfinite.begin()+index);
+    setDataModified();
 }
 
 
@@ -732,6 +670,7 @@ void PlanePolar::insertDataPointAt(int index, bool bAfter)
     m_XNP.insert(m_XNP.begin()+index, 0);
     m_EV.insert(m_EV.begin()+index, EigenValues());
     m_QInfinite.insert(m_QInfinite.begin()+index, 0);
+    setDataModified();
 }
 
 
@@ -756,6 +695,7 @@ void PlanePolar::clearWPolarData()
     m_EV.clear();
 
     m_QInfinite.clear();
+    setDataModified();
 }
 
 
@@ -809,6 +749,7 @@ void PlanePolar::copy(const PlanePolar *pWPolar)
         m_CoG_z.push_back(     pWPolar-> m_CoG_z.at(i));
 
     }
+    setDataModified();
 }
 
 
@@ -1039,6 +980,8 @@ bool PlanePolar::serializeWPlrXFL(QDataStream &ar, bool bIsStoring)
     int i(0), k(0), n(0);
     double dble(0);
     double r0(0), r1(0), r2(0), r3(0), r4(0), r5(0), r6(0), r7(0);
+
+    if(!bIsStoring) setDataModified();
     double i0(0), i1(0), i2(0), i3(0), i4(0), i5(0), i6(0), i7(0);
     QString strange;
 
@@ -2290,6 +2233,7 @@ void PlanePolar::recalcExtraDrag()
             m_AF[i].addExtraDrag(CDv * m_RefArea);
         }
     }
+    setDataModified();
 }
 
 
@@ -2353,6 +2297,43 @@ Vector3d PlanePolar::CoGCtrl(double ctrl) const
 }
 
 
+/**
+ * @return true if the polar's specification differs from this polar's only in the name, the style,
+ * the operating ranges, the mass, the CoG and the inertia tensor, so that both polars have the same
+ * flow solutions at unit speed; the comparison is made on the serialized specifications.
+ */
+bool PlanePolar::differsOnlyInInertia(PlanePolar const *pWPolar) const
+{
+    if(!pWPolar || pWPolar->type()!=type()) return false;
+
+    PlanePolar ref, spec;
+    ref.duplicateSpec(this);
+    spec.duplicateSpec(pWPolar);
+
+    spec.setName(ref.name());
+    spec.setPlaneName(ref.planeName());
+    spec.setTheStyle(ref.theStyle());
+    spec.m_OperatingRange = ref.m_OperatingRange;
+    spec.m_AngleRange     = ref.m_AngleRange;
+    spec.m_InertiaRange   = ref.m_InertiaRange;
+    spec.m_bAutoInertia   = ref.m_bAutoInertia;
+    spec.m_Mass           = ref.m_Mass;
+    spec.m_CoG            = ref.m_CoG;
+    spec.setInertiaTensor(ref.Ixx(), ref.Iyy(), ref.Izz(), ref.Ixz());
+
+    QByteArray refbytes, specbytes;
+    {
+        QDataStream ar(&refbytes, QIODevice::WriteOnly);
+        ref.serializeFl5v750(ar, true);
+    }
+    {
+        QDataStream ar(&specbytes, QIODevice::WriteOnly);
+        spec.serializeFl5v750(ar, true);
+    }
+    return refbytes==specbytes;
+}
+
+
 /** Returns the fuse drag as N/q */
 double PlanePolar::fuseDrag(Fuse const *pFuse, double QInf) const
 {
@@ -2423,4 +2404,11 @@ double PlanePolar::PrandtlSchlichtingCoef(double Re) const
 }
 
 
-
+size_t PlanePolar::memoryFootprint() const
+{
+    return sizeof(PlanePolar)
+         + MemoryBudget::bytes(m_Alpha)    + MemoryBudget::bytes(m_Ctrl)  + MemoryBudget::bytes(m_Beta)
+         + MemoryBudget::bytes(m_Phi)      + MemoryBudget::bytes(m_QInfinite) + MemoryBudget::bytes(m_AF)
+         + MemoryBudget::bytes(m_XNP)      + MemoryBudget::bytes(m_Mass_var)  + MemoryBudget::bytes(m_CoG_x)
+         + MemoryBudget::bytes(m_CoG_z)    + MemoryBudget::bytes(m_MaxBending) + MemoryBudget::bytes(m_EV);
+}
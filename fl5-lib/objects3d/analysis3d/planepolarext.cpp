@@ -24,52 +24,88 @@
 
 /** @class This class defines a polar imported from an external source */
 
+#include <algorithm>
+
 #include <planepolarext.h>
 
 PlanePolarExt::PlanePolarExt() : PlanePolar()
 {
     m_Type = xfl::EXTERNALPOLAR;
     m_AnalysisMethod = xfl::NOMETHOD;
-    m_data.resize(variableCount());
+    m_nVariables = variableCount();
+    m_nPoints  = 0;
+    m_Capacity = 0;
 }
 
 
-int PlanePolarExt::dataSize() const
+/** Makes room for the given number of points in each column; the block grows geometrically so that the insertions are amortized. */
+void PlanePolarExt::reserve(int capacity)
 {
-    if(m_data.size()) return int(m_data.at(0).size());
-    return 0;
+    if(capacity<=m_Capacity) return;
+    int newcapacity = std::max(capacity, std::max(8, 2*m_Capacity));
+
+    std::vector<double> data(size_t(m_nVariables)*size_t(newcapacity), 0.0);
+    for(int iVar=0; iVar<m_nVariables; iVar++)
+    {
+        double const *col = column(iVar);
+        std::copy(col, col+m_nPoints, data.begin() + std::ptrdiff_t(iVar)*newcapacity);
+    }
+    m_Data.swap(data);
+    m_Capacity = newcapacity;
 }
 
 
 void PlanePolarExt::resizeData(int newsize)
 {
-    for(uint iVar=0; iVar<m_data.size(); iVar++)
-        m_data[iVar].resize(newsize);
+    newsize = std::max(newsize, 0);
+    reserve(newsize);
+    for(int iVar=0; iVar<m_nVariables && newsize>m_nPoints; iVar++)
+    {
+        double *col = column(iVar);
+        std::fill(col+m_nPoints, col+newsize, 0.0);
+    }
+    m_nPoints = newsize;
+    setDataModified();
 }
 
 
 double PlanePolarExt::getVariable(int iVariable, int index) const
 {
-    if(iVariable<0 || iVariable>variableCount()) return 0.0;
-    if(index<0 || index>int(m_data.at(0).size()))  return 0.0;
-    return m_data.at(iVariable).at(index);
+    if(iVariable<0 || iVariable>=m_nVariables) return 0.0;
+    if(index<0 || index>=m_nPoints)  return 0.0;
+    return column(iVariable)[index];
+}
+
+
+void PlanePolarExt::getColumn(int iVariable, std::vector<double> &values) const
+{
+    if(iVariable<0 || iVariable>=m_nVariables)
+    {
+        values.assign(size_t(m_nPoints), 0.0);
+        return;
+    }
+    double const *col = column(iVariable);
+    values.assign(col, col+m_nPoints);
 }
 
 
 void PlanePolarExt::setData(int iVariable, int index, double value)
 {
-    if(iVariable<0 || iVariable>=variableCount()) return;
-    if(index<0 || index>=int(m_data.at(iVariable).size()))  return;
+    if(iVariable<0 || iVariable>=m_nVariables) return;
+    if(index<0 || index>=m_nPoints)  return;
 
-    m_data[iVariable][index] = value;
+    column(iVariable)[index] = value;
+    setDataModified();
 }
 
 
 void PlanePolarExt::clearData()
 {
-    m_data.resize(variableCount());
-    for(uint ivar=0; ivar<m_data.size(); ivar++)
-        m_data[ivar].clear();
+    m_Data.clear();
+    m_nVariables = variableCount();
+    m_nPoints  = 0;
+    m_Capacity = 0;
+    setDataModified();
 }
 
 
@@ -78,20 +114,28 @@ void PlanePolarExt::insertDataPointAt(int index, bool bAfter)
     if(index<0 || index>=dataSize()) return;
     if(bAfter) index++;
 
-    for(uint ivar=0; ivar<m_data.size(); ivar++)
+    reserve(m_nPoints+1);
+    for(int iVar=0; iVar<m_nVariables; iVar++)
     {
-        m_data[ivar].insert(m_data[ivar].begin()+index,0.0);
+        double *col = column(iVar);
+        std::copy_backward(col+index, col+m_nPoints, col+m_nPoints+1);
+        col[index] = 0.0;
     }
+    m_nPoints++;
+    setDataModified();
 }
 
 
 void PlanePolarExt::removeAt(int index)
 {
     if(index<0 || index>=dataSize()) return;
-    for(uint ivar=0; ivar<m_data.size(); ivar++)
+    for(int iVar=0; iVar<m_nVariables; iVar++)
     {
-        m_data[ivar].erase(m_data[ivar].begin()+index);
+        double *col = column(iVar);
+        std::copy(col+index+1, col+m_nPoints, col+index);
     }
+    m_nPoints--;
+    setDataModified();
 }
 
 
@@ -105,7 +149,13 @@ void PlanePolarExt::copy(PlanePolar const *pWPolar)
 
     PlanePolarExt const *pWPolarExt = dynamic_cast<PlanePolarExt const*>(pWPolar);
     if(pWPolarExt)
-        m_data = pWPolarExt->m_data;
+    {
+        m_Data       = pWPolarExt->m_Data;
+        m_nVariables = pWPolarExt->m_nVariables;
+        m_nPoints    = pWPolarExt->m_nPoints;
+        m_Capacity   = pWPolarExt->m_Capacity;
+        setDataModified();
+    }
 }
 
 
@@ -135,9 +185,8 @@ bool PlanePolarExt::serializeFl5v726(QDataStream &ar, bool bIsStoring)
         int nSpares=0;
         ar >> nSpares;
         ar >> nDataPoints;
-        if(abs(n)>10000) return false;
-        for(uint ivar=0; ivar<m_data.size(); ivar++)
-            m_data[ivar].resize(nDataPoints);
+        if(nDataPoints<0) return false;
+        resizeData(nDataPoints);
 
         int nStoredVariables = variableCount();
         if     (m_PolarFormat<500013) nStoredVariables = 54;
@@ -155,8 +204,7 @@ bool PlanePolarExt::serializeFl5v726(QDataStream &ar, bool bIsStoring)
             for(int ipt=0; ipt<nDataPoints; ipt++)
             {
                 ar >> dble;
-                if(ivar<int(m_data.size()) && ipt < int(m_data[ivar].size()))
-                    m_data[ivar][ipt] = dble;
+                if(ivar<m_nVariables) column(ivar)[ipt] = dble;
             }
             ivar++;
         }
@@ -196,11 +244,12 @@ bool PlanePolarExt::serializeFl5v750(QDataStream &ar, bool bIsStoring)
         dble=0.0;
         ar << nSpares;
         ar << dataSize();
-        for(uint ivar=0; ivar<m_data.size(); ivar++)
+        for(int ivar=0; ivar<m_nVariables; ivar++)
         {
-            for(uint i=0; i<m_data.at(ivar).size(); i++)
+            double const *col = column(ivar);
+            for(int i=0; i<m_nPoints; i++)
             {
-                ar<<m_data.at(ivar).at(i);
+                ar<<col[i];
                 for(int js=0; js<nSpares; js++) ar<<dble;
             }
         }
@@ -223,9 +272,8 @@ bool PlanePolarExt::serializeFl5v750(QDataStream &ar, bool bIsStoring)
         int nSpares=0;
         ar >> nSpares;
         ar >> nDataPoints;
-        if(abs(n)>10000) return false;
-        for(uint ivar=0; ivar<m_data.size(); ivar++)
-            m_data[ivar].resize(nDataPoints);
+        if(nDataPoints<0) return false;
+        resizeData(nDataPoints);
 
         int nStoredVariables = variableCount();
 
@@ -235,8 +283,7 @@ bool PlanePolarExt::serializeFl5v750(QDataStream &ar, bool bIsStoring)
             for(int ipt=0; ipt<nDataPoints; ipt++)
             {
                 ar >> dble;
-                if(ivar<int(m_data.size()) && ipt < int(m_data[ivar].size()))
-                    m_data[ivar][ipt] = dble;
+                if(ivar<m_nVariables) column(ivar)[ipt] = dble;
             }
             ivar++;
         }
@@ -27,13 +27,21 @@
 #define _MATH_DEFINES_DEFINED
 
 
+#include <cmath>
+
 #include <polar3d.h>
 #include <constants.h>
 #include <inertia.h>
+#include <opp3d.h>
+
+
+std::atomic<int> Polar3d::s_LastDataRevision(0);
+
 
 Polar3d::Polar3d()
 {
     setDefaults();
+    setDataModified();
 }
 
 
@@ -69,6 +77,18 @@ void Polar3d::setDefaults()
     m_VortonCoreSize     = 1.0;   // x MAC
     m_VPWMaxLength       = 30.0;  // x MAC
     m_VPWIterations      = 35;
+    m_VortonTreeTheta    = 0.0;
+
+    m_bIterativeSolver   = false;
+    m_IterativeTolerance = 1.0e-6;
+    m_IterativeMaxIter   = 200;
+    m_bCompressedMatrix  = false;
+    m_CompressionTolerance = 1.0e-5;
+    m_bMatrixFree        = false;
+    m_bMultilevelPrecond = false;
+
+    m_FieldRetention    = RETAINALL;
+    m_RetentionInterval = 1;
     m_nXWakePanel4    = 5;
     m_TotalWakeLengthFactor = 30.0;
     m_WakePanelFactor = 1.1;
@@ -114,6 +134,17 @@ void Polar3d::duplicateSpec(const Polar3d *pPolar3d)
     m_VortonCoreSize        = pPolar3d->m_VortonCoreSize;
     m_VPWMaxLength          = pPolar3d->m_VPWMaxLength;
     m_VPWIterations         = pPolar3d->m_VPWIterations;
+    m_VortonTreeTheta       = pPolar3d->m_VortonTreeTheta;
+    m_bIterativeSolver      = pPolar3d->m_bIterativeSolver;
+    m_IterativeTolerance    = pPolar3d->m_IterativeTolerance;
+    m_IterativeMaxIter      = pPolar3d->m_IterativeMaxIter;
+    m_bCompressedMatrix     = pPolar3d->m_bCompressedMatrix;
+    m_CompressionTolerance  = pPolar3d->m_CompressionTolerance;
+    m_bMatrixFree           = pPolar3d->m_bMatrixFree;
+    m_bMultilevelPrecond    = pPolar3d->m_bMultilevelPrecond;
+    m_FieldRetention        = pPolar3d->m_FieldRetention;
+    m_RetentionInterval     = pPolar3d->m_RetentionInterval;
+    m_RetentionPredicate    = pPolar3d->m_RetentionPredicate;
     m_BC                    = pPolar3d->m_BC;
 
     m_bGround               = pPolar3d->m_bGround;
@@ -176,6 +207,8 @@ bool Polar3d::serializeFl5v726(QDataStream &ar, bool bIsStoring)
     bool boolean(false);
     int k(0), n(0);
 
+    if(!bIsStoring) setDataModified();
+
     double dble(0.0);
     int nIntExtra(0);
     int nDbleExtra(0);
@@ -352,6 +385,8 @@ bool Polar3d::serializeFl5v750(QDataStream &ar, bool bIsStoring)
     bool boolean(false);
     int integer(0);
     double dble(0.0);
+
+    if(!bIsStoring) setDataModified();
     int n(0);
     QString strange;
 
@@ -440,9 +475,24 @@ bool Polar3d::serializeFl5v750(QDataStream &ar, bool bIsStoring)
         // First spare bool used for m_bNeuralFoilOTF, second for m_bNeuralFoilInterp
         ar << m_bNeuralFoilOTF;
         ar << m_bNeuralFoilInterp;
-        for(int i=3; i<10; i++) ar <<boolean;
-        for(int i=0; i<20; i++) ar <<integer;
-        for(int i=0; i<20; i++) ar <<dble;
+        // third spare bool, first spare int and first spare double used for the iterative solver
+        // fourth spare bool and second spare double used for the compressed matrix
+        // fifth spare bool used for the matrix-free mode
+        // sixth spare bool used for the multilevel preconditioner
+        // third spare double used for the vorton tree
+        // second and third spare ints used for the field retention policy
+        ar << m_bIterativeSolver;
+        ar << m_bCompressedMatrix;
+        ar << m_bMatrixFree;
+        ar << m_bMultilevelPrecond;
+        for(int i=7; i<10; i++) ar <<boolean;
+        ar << m_IterativeMaxIter;
+        ar << int(m_FieldRetention) << m_RetentionInterval;
+        for(int i=3; i<20; i++) ar <<integer;
+        ar << m_IterativeTolerance;
+        ar << m_CompressionTolerance;
+        ar << m_VortonTreeTheta;
+        for(int i=3; i<20; i++) ar <<dble;
 
         return true;
     }
@@ -536,15 +586,58 @@ bool Polar3d::serializeFl5v750(QDataStream &ar, bool bIsStoring)
         // First spare bool used for m_bNeuralFoilOTF, second for m_bNeuralFoilInterp
         ar >> m_bNeuralFoilOTF;
         ar >> m_bNeuralFoilInterp;
-        for(int i=3; i<10; i++) ar >> boolean;
-        for(int i=0; i<20; i++) ar >> integer;
-        for(int i=0; i<20; i++) ar >> dble;
+        // third spare bool, first spare int and first spare double used for the iterative solver
+        // fourth spare bool and second spare double used for the compressed matrix
+        // fifth spare bool used for the matrix-free mode
+        // sixth spare bool used for the multilevel preconditioner
+        // third spare double used for the vorton tree
+        // second and third spare ints used for the field retention policy
+        ar >> m_bIterativeSolver;
+        ar >> m_bCompressedMatrix;
+        ar >> m_bMatrixFree;
+        ar >> m_bMultilevelPrecond;
+        for(int i=7; i<10; i++) ar >> boolean;
+        ar >> m_IterativeMaxIter;
+        ar >> integer;
+        m_FieldRetention = (integer>=RETAINALL && integer<=RETAINNONE) ? enumFieldRetention(integer) : RETAINALL;
+        ar >> m_RetentionInterval;
+        for(int i=3; i<20; i++) ar >> integer;
+        ar >> m_IterativeTolerance;
+        ar >> m_CompressionTolerance;
+        ar >> m_VortonTreeTheta;
+        for(int i=3; i<20; i++) ar >> dble;
+        // files saved before the iterative solver have zeros in the spares
+        if(m_IterativeMaxIter<=0)      m_IterativeMaxIter   = 200;
+        if(m_IterativeTolerance<=0.0)  m_IterativeTolerance = 1.0e-6;
+        if(m_CompressionTolerance<=0.0) m_CompressionTolerance = 1.0e-5;
+        if(m_RetentionInterval<=0)     m_RetentionInterval  = 1;
 
         return true;
     }
 }
 
 
+/**
+ * Returns true if the operating point should be stored with its panel fields.
+ * The control and stability polars are trimmed by construction; the points of the other
+ * polars are considered trimmed if their pitching moment coefficient is negligible.
+ * @param iOpp the index of the operating point in the sequence of the analysis; the points of unknown index,
+ * i.e. -1, keep their fields under the RETAINEVERYNTH policy
+ */
+bool Polar3d::retainsFields(Opp3d const *pOpp, int iOpp) const
+{
+    switch(m_FieldRetention)
+    {
+        case RETAINALL:      return true;
+        case RETAINNONE:     return false;
+        case RETAINEVERYNTH: return iOpp<0 || iOpp%m_RetentionInterval==0;
+        case RETAINTRIMMED:  return isType6() || isType7() || std::abs(pOpp->aeroForces().Cm())<1.0e-3;
+        case RETAINMATCHING: return !m_RetentionPredicate || m_RetentionPredicate(pOpp, iOpp);
+    }
+    return true;
+}
+
+
 void Polar3d::setInertia(Inertia const &inertia)
 {
     m_Mass = inertia.totalMass();
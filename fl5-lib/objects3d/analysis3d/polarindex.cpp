@@ -0,0 +1,120 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <numeric>
+
+#include <polarindex.h>
+#include <boatpolar.h>
+#include <planepolar.h>
+
+
+void PolarIndex::make(PlanePolar const &polar, int iXVar, int iYVar)
+{
+    std::vector<double> x, y;
+    polar.getColumn(iXVar, x);
+    polar.getColumn(iYVar, y);
+    make(x, y);
+}
+
+
+void PolarIndex::make(BoatPolar const &polar, int iXVar, int iYVar)
+{
+    int n = polar.dataSize();
+    std::vector<double> x(n), y(n);
+    for(int i=0; i<n; i++)
+    {
+        x[i] = polar.getVariable(iXVar, i);
+        y[i] = polar.getVariable(iYVar, i);
+    }
+    make(x, y);
+}
+
+
+void PolarIndex::make(std::vector<double> const &x, std::vector<double> const &y)
+{
+    int n = int(std::min(x.size(), y.size()));
+    m_Point.resize(n);
+    std::iota(m_Point.begin(), m_Point.end(), 0);
+    // the polars are usually sorted by their first variables already
+    std::stable_sort(m_Point.begin(), m_Point.end(), [&x](int i, int j) {return x[i]<x[j];});
+
+    m_X.resize(n);
+    m_Y.resize(n);
+    for(int k=0; k<n; k++)
+    {
+        m_X[k] = x[m_Point[k]];
+        m_Y[k] = y[m_Point[k]];
+    }
+}
+
+
+/**
+ * Interpolates linearly the second variable at the value x of the first.
+ * @return false if x is outside the range of the polar, in which case y is left unchanged.
+ */
+bool PolarIndex::interpolate(double x, double &y) const
+{
+    if(m_X.empty() || x<m_X.front() || x>m_X.back()) return false;
+
+    auto it = std::upper_bound(m_X.begin(), m_X.end(), x);
+    int k = int(it-m_X.begin());
+    if(k>=size()) k = size()-1;
+    if(k<=0)
+    {
+        y = m_Y.front();
+        return true;
+    }
+
+    double dx = m_X[k]-m_X[k-1];
+    double t = dx>0.0 ? (x-m_X[k-1])/dx : 1.0;
+    y = m_Y[k-1] + t*(m_Y[k]-m_Y[k-1]);
+    return true;
+}
+
+
+/** Returns the interpolated value, or the value at the nearest end point if x is out of range. */
+double PolarIndex::value(double x) const
+{
+    if(m_X.empty()) return 0.0;
+    if(x<=m_X.front()) return m_Y.front();
+    if(x>=m_X.back())  return m_Y.back();
+    double y = 0.0;
+    interpolate(x, y);
+    return y;
+}
+
+
+/** @return the index in the polar of the point whose first variable is closest to x, or -1 if the polar is empty. */
+int PolarIndex::nearestPoint(double x) const
+{
+    if(m_X.empty()) return -1;
+    auto it = std::lower_bound(m_X.begin(), m_X.end(), x);
+    int k = int(it-m_X.begin());
+    if(k>=size()) return m_Point.back();
+    if(k>0 && x-m_X[k-1] <= m_X[k]-x) k--;
+    return m_Point[k];
+}
+
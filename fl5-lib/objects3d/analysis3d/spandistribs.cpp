@@ -29,6 +29,7 @@
 #include <QDataStream>
 
 #include <spandistribs.h>
+#include <memorybudget.h>
 #include <wingxfl.h>
 
 SpanDistribs::SpanDistribs()
@@ -212,6 +213,15 @@ double SpanDistribs::stripLift(int m, double qDyn) const
 }
 
 
-
-
-
+size_t SpanDistribs::memoryFootprint() const
+{
+    return MemoryBudget::bytes(m_Ai)         + MemoryBudget::bytes(m_Alpha_0)    + MemoryBudget::bytes(m_Cl)
+         + MemoryBudget::bytes(m_ICd)        + MemoryBudget::bytes(m_PCd)        + MemoryBudget::bytes(m_Re)
+         + MemoryBudget::bytes(m_XTrTop)     + MemoryBudget::bytes(m_XTrBot)     + MemoryBudget::bytes(m_CmViscous)
+         + MemoryBudget::bytes(m_CmPressure) + MemoryBudget::bytes(m_CmC4)       + MemoryBudget::bytes(m_XCPSpanRel)
+         + MemoryBudget::bytes(m_XCPSpanAbs) + MemoryBudget::bytes(m_BendingMoment) + MemoryBudget::bytes(m_VTwist)
+         + MemoryBudget::bytes(m_Gamma)      + MemoryBudget::bytes(m_bConverged) + MemoryBudget::bytes(m_Vd)
+         + MemoryBudget::bytes(m_F)          + MemoryBudget::bytes(m_Chord)      + MemoryBudget::bytes(m_Offset)
+         + MemoryBudget::bytes(m_Twist)      + MemoryBudget::bytes(m_StripArea)  + MemoryBudget::bytes(m_StripPos)
+         + MemoryBudget::bytes(m_PtC4);
+}
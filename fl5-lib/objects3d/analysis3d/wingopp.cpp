@@ -25,6 +25,7 @@
 #define _MATH_DEFINES_DEFINED
 
 #include <wingopp.h>
+#include <memorybudget.h>
 #include <wingxfl.h>
 
 #include <geom_global.h>
@@ -300,3 +301,9 @@ bool WingOpp::serializeWingOppFl5(QDataStream &ar, bool bIsStoring)
     return true;
 }
 
+
+/** The heap memory used by the WingOpp; the object itself is accounted for by its parent PlaneOpp */
+size_t WingOpp::memoryFootprint() const
+{
+    return MemoryBudget::bytes(m_FlapMoment) + m_SpanDistrib.memoryFootprint();
+}
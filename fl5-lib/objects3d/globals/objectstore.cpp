@@ -0,0 +1,85 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <objectstore.h>
+
+#include <objects2d.h>
+#include <objects3d.h>
+#include <sailobjects.h>
+
+
+/** The store of the thread, or nullptr to use the default store */
+static thread_local ObjectStore *t_pCurrentStore = nullptr;
+
+
+ObjectStore::~ObjectStore()
+{
+    deleteObjects();
+}
+
+
+/** Deletes all the objects of this store */
+void ObjectStore::deleteObjects()
+{
+    ScopedStore scope(this);
+    Objects2d::deleteObjects();
+    Objects3d::deleteObjects();
+    SailObjects::deleteObjects();
+}
+
+
+/** The process-wide store; never destroyed, so that its objects are released by the application's own clean-up */
+ObjectStore *ObjectStore::defaultStore()
+{
+    static ObjectStore *s_pDefaultStore = new ObjectStore;
+    return s_pDefaultStore;
+}
+
+
+ObjectStore &ObjectStore::current()
+{
+    return t_pCurrentStore ? *t_pCurrentStore : *defaultStore();
+}
+
+
+/** Sets the store of the calling thread; nullptr selects the default store */
+void ObjectStore::setCurrent(ObjectStore *pStore)
+{
+    t_pCurrentStore = pStore==defaultStore() ? nullptr : pStore;
+}
+
+
+ScopedStore::ScopedStore(ObjectStore *pStore)
+{
+    m_pPrevious = &ObjectStore::current();
+    ObjectStore::setCurrent(pStore);
+}
+
+
+ScopedStore::~ScopedStore()
+{
+    ObjectStore::setCurrent(m_pPrevious);
+}
+
@@ -25,7 +25,10 @@
 #define _MATH_DEFINES_DEFINED
 
 
+#include <mutex>
+
 #include <QCoreApplication>
+#include <QDataStream>
 #include <QtConcurrent/QtConcurrent>
 
 
@@ -40,48 +43,77 @@
 #include <planexfl.h>
 #include <surface.h>
 #include <utils.h>
+#include <wingxfl.h>
 #include <planepolar.h>
 #include <planepolarext.h>
 
 
 int Objects3d::s_Index=0;
-std::vector<Plane*>        Objects3d::s_oaPlane;
-std::vector<PlanePolar*>   Objects3d::s_oaPlanePolar;
-std::vector<PlaneOpp*>     Objects3d::s_oaPlaneOpp;
+
+
+/** The parent key of the planes in the name index */
+static std::string const s_NoParent;
+
+
+static void buildPlaneIndex(NameIndex<std::string, Plane> &index)
+{
+    for(Plane *pPlane : Objects3d::planes()) index.add(s_NoParent, pPlane->nameRef(), pPlane);
+}
+
+
+static void buildPlPolarIndex(NameIndex<std::string, PlanePolar> &index)
+{
+    for(PlanePolar *pWPolar : Objects3d::planePolars()) index.add(pWPolar->planeName(), pWPolar->nameRef(), pWPolar);
+}
+
+
+/** The operating points are keyed by their polar; their names are computed once for each build of the index */
+static void buildPOppIndex(NameIndex<PlanePolar const*, PlaneOpp> &index)
+{
+    // the polars are indexed locally, since the builder may not use the store's indexes
+    NameIndex<std::string, PlanePolar> polars;
+    buildPlPolarIndex(polars);
+    for(PlaneOpp *pPOpp : Objects3d::planeOpps())
+    {
+        PlanePolar const *pWPolar = polars.find(pPOpp->planeName(), pPOpp->polarName());
+        if(pWPolar) index.add(pWPolar, pPOpp->name(), pPOpp);
+    }
+}
+
+
+/** Clears the name indexes; to be called each time the arrays of planes, polars or operating points, or the names of their objects, are modified */
+void Objects3d::invalidateIndex()
+{
+    ObjectStore &s = store();
+    std::unique_lock<std::shared_mutex> lock(s.m_NameIndexMutex);
+    s.m_PlaneIndex.clear();
+    s.m_PlPolarIndex.clear();
+    s.m_POppIndex.clear();
+}
 
 
 int Objects3d::newUniquePartIndex()
 {
-    // may be accessed by different threads simultaneously e.g. from MOPSO3d class
-    QMutex mutex;
-    mutex.lock();
+    // may be accessed by different threads simultaneously e.g. from the PSO tasks
+    static std::mutex s_IndexMutex;
+    std::lock_guard<std::mutex> lock(s_IndexMutex);
     s_Index++;
-    mutex.unlock();
     return s_Index;
 }
 
 
 bool Objects3d::planeExists(std::string const &planeName)
 {
-    Plane *pOldPlane = nullptr;
-
-    for (int i=0; i<nPlanes(); i++)
-    {
-        pOldPlane = s_oaPlane.at(i);
-        if (pOldPlane->name() == planeName)
-        {
-            return true;
-        }
-    }
-    return false;
+    return plane(planeName)!=nullptr;
 }
 
 
 Plane *Objects3d::addPlane(Plane *pPlane)
 {
+    invalidateIndex();
     for (int i=0; i<nPlanes(); i++)
     {
-        Plane *pOldPlane = s_oaPlane.at(i);
+        Plane *pOldPlane = store().m_oaPlane.at(i);
         if (pOldPlane->name().compare(pPlane->name())==0)
         {
             //a plane with this name already exists
@@ -90,7 +122,7 @@ Plane *Objects3d::addPlane(Plane *pPlane)
 
             // if its an old plane with the same name, delete and insert at its place
             deletePlane(pOldPlane);
-            s_oaPlane.insert(s_oaPlane.begin()+i, pPlane);
+            store().m_oaPlane.insert(store().m_oaPlane.begin()+i, pPlane);
             return pPlane;
         }
     }
@@ -98,28 +130,32 @@ Plane *Objects3d::addPlane(Plane *pPlane)
     // the plane does not exist, just insert in alphabetical order
     for (int j=0; j<nPlanes(); j++)
     {
-        Plane const *pOldPlane = s_oaPlane.at(j);
+        Plane const *pOldPlane = store().m_oaPlane.at(j);
         if (pPlane->name().compare(pOldPlane->name())<0)
         {
-            s_oaPlane.insert(s_oaPlane.begin()+j, pPlane);
+            store().m_oaPlane.insert(store().m_oaPlane.begin()+j, pPlane);
             return pPlane;
         }
     }
 
     //could not be inserted, append
-    s_oaPlane.push_back(pPlane);
+    store().m_oaPlane.push_back(pPlane);
     return pPlane;
 }
 
 
 void Objects3d::insertPlaneOpp(PlaneOpp *pPOpp)
 {
+    invalidateIndex();
+    // may be called by plane tasks running concurrently
+    std::lock_guard<std::mutex> lock(store().m_InsertMutex);
+
     PlaneOpp *pOldPOpp = nullptr;
     bool bIsInserted = false;
 
     for (int i=0; i<nPOpps(); i++)
     {
-        pOldPOpp = s_oaPlaneOpp.at(i);
+        pOldPOpp = store().m_oaPlaneOpp.at(i);
         if (pPOpp->planeName().compare(pOldPOpp->planeName())==0)
         {
             if (pPOpp->polarName().compare(pOldPOpp->polarName())==0)
@@ -135,15 +171,15 @@ void Objects3d::insertPlaneOpp(PlaneOpp *pPOpp)
                             //replace the existing point
                             pPOpp->setTheStyle(pOldPOpp->theStyle());
 
-                            s_oaPlaneOpp.erase(s_oaPlaneOpp.begin()+i);
+                            store().m_oaPlaneOpp.erase(store().m_oaPlaneOpp.begin()+i);
                             delete pOldPOpp;
-                            s_oaPlaneOpp.insert(s_oaPlaneOpp.begin()+i, pPOpp);
+                            store().m_oaPlaneOpp.insert(store().m_oaPlaneOpp.begin()+i, pPOpp);
                             return;
                         }
                         else if (pPOpp->alpha() < pOldPOpp->alpha())
                         {
                             //insert point
-                            s_oaPlaneOpp.insert(s_oaPlaneOpp.begin()+i, pPOpp);
+                            store().m_oaPlaneOpp.insert(store().m_oaPlaneOpp.begin()+i, pPOpp);
                             return;
                         }
                         break;
@@ -155,15 +191,15 @@ void Objects3d::insertPlaneOpp(PlaneOpp *pPOpp)
                             //replace the existing point
                             pPOpp->setTheStyle(pOldPOpp->theStyle());
 
-                            s_oaPlaneOpp.erase(s_oaPlaneOpp.begin()+i);
+                            store().m_oaPlaneOpp.erase(store().m_oaPlaneOpp.begin()+i);
                             delete pOldPOpp;
-                            s_oaPlaneOpp.insert(s_oaPlaneOpp.begin()+i, pPOpp);
+                            store().m_oaPlaneOpp.insert(store().m_oaPlaneOpp.begin()+i, pPOpp);
                             return;
                         }
                         else if (pPOpp->beta() < pOldPOpp->beta())
                         {
                             //insert point
-                            s_oaPlaneOpp.insert(s_oaPlaneOpp.begin()+i, pPOpp);
+                            store().m_oaPlaneOpp.insert(store().m_oaPlaneOpp.begin()+i, pPOpp);
                             return;
                         }
                         break;
@@ -176,15 +212,15 @@ void Objects3d::insertPlaneOpp(PlaneOpp *pPOpp)
                             //replace the existing point
                             pPOpp->setTheStyle(pOldPOpp->theStyle());
 
-                            s_oaPlaneOpp.erase(s_oaPlaneOpp.begin()+i);
+                            store().m_oaPlaneOpp.erase(store().m_oaPlaneOpp.begin()+i);
                             delete pOldPOpp;
-                            s_oaPlaneOpp.insert(s_oaPlaneOpp.begin()+i, pPOpp);
+                            store().m_oaPlaneOpp.insert(store().m_oaPlaneOpp.begin()+i, pPOpp);
                             return;
                         }
                         else if (pPOpp->ctrl() < pOldPOpp->ctrl())
                         {
                             //insert point
-                            s_oaPlaneOpp.insert(s_oaPlaneOpp.begin()+i, pPOpp);
+                            store().m_oaPlaneOpp.insert(store().m_oaPlaneOpp.begin()+i, pPOpp);
                             return;
                         }
                         break;
@@ -201,29 +237,29 @@ void Objects3d::insertPlaneOpp(PlaneOpp *pPOpp)
                                     //replace the existing point
                                     pPOpp->setTheStyle(pOldPOpp->theStyle());
 
-                                    s_oaPlaneOpp.erase(s_oaPlaneOpp.begin()+i);
+                                    store().m_oaPlaneOpp.erase(store().m_oaPlaneOpp.begin()+i);
                                     delete pOldPOpp;
-                                    s_oaPlaneOpp.insert(s_oaPlaneOpp.begin()+i, pPOpp);
+                                    store().m_oaPlaneOpp.insert(store().m_oaPlaneOpp.begin()+i, pPOpp);
                                     return;
                                 }
                                 else if (pPOpp->QInf() < pOldPOpp->QInf())
                                 {
                                     //insert point
-                                    s_oaPlaneOpp.insert(s_oaPlaneOpp.begin()+i, pPOpp);
+                                    store().m_oaPlaneOpp.insert(store().m_oaPlaneOpp.begin()+i, pPOpp);
                                     return;
                                 }
                             }
                             else if (pPOpp->beta() < pOldPOpp->beta())
                             {
                                 //insert point
-                                s_oaPlaneOpp.insert(s_oaPlaneOpp.begin()+i, pPOpp);
+                                store().m_oaPlaneOpp.insert(store().m_oaPlaneOpp.begin()+i, pPOpp);
                                 return;
                             }
                         }
                         else if (pPOpp->alpha() < pOldPOpp->alpha())
                         {
                             //insert point
-                            s_oaPlaneOpp.insert(s_oaPlaneOpp.begin()+i, pPOpp);
+                            store().m_oaPlaneOpp.insert(store().m_oaPlaneOpp.begin()+i, pPOpp);
                             return;
                         }
                         break;
@@ -235,24 +271,25 @@ void Objects3d::insertPlaneOpp(PlaneOpp *pPOpp)
         }
     }
 
-    if (!bIsInserted)     s_oaPlaneOpp.push_back(pPOpp);
+    if (!bIsInserted)     store().m_oaPlaneOpp.push_back(pPOpp);
 }
 
 
 void Objects3d::addPlPolar(PlanePolar *pWPolar)
 {
+    invalidateIndex();
     if(!pWPolar) return;
     Plane const *pPlane = planeAt(pWPolar->planeName());
     pWPolar->setPlane(pPlane);
 
     for (int ip=0; ip<nPolars(); ip++)
     {
-        PlanePolar *pOldWPlr = s_oaPlanePolar.at(ip);
+        PlanePolar *pOldWPlr = store().m_oaPlanePolar.at(ip);
         if (pOldWPlr->name()==pWPolar->name() && pOldWPlr->planeName()==pWPolar->planeName())
         {
-            s_oaPlanePolar.erase(s_oaPlanePolar.begin()+ip);
+            store().m_oaPlanePolar.erase(store().m_oaPlanePolar.begin()+ip);
             delete pOldWPlr;
-            s_oaPlanePolar.insert(s_oaPlanePolar.begin()+ip, pWPolar);
+            store().m_oaPlanePolar.insert(store().m_oaPlanePolar.begin()+ip, pWPolar);
             return;
         }
     }
@@ -260,11 +297,11 @@ void Objects3d::addPlPolar(PlanePolar *pWPolar)
     //if it doesn't exist, find its place in alphabetical order and insert it
     for (int j=0; j<nPolars(); j++)
     {
-        PlanePolar *pOldWPlr = s_oaPlanePolar.at(j);
+        PlanePolar *pOldWPlr = store().m_oaPlanePolar.at(j);
         //first key is the Plane name
         if(pWPolar->planeName().compare(pOldWPlr->planeName())<0)
         {
-            s_oaPlanePolar.insert(s_oaPlanePolar.begin()+j, pWPolar);
+            store().m_oaPlanePolar.insert(store().m_oaPlanePolar.begin()+j, pWPolar);
             return;
         }
         else if (pWPolar->planeName() == pOldWPlr->planeName())
@@ -272,23 +309,24 @@ void Objects3d::addPlPolar(PlanePolar *pWPolar)
             // sort by polar name
             if(pWPolar->name().compare(pOldWPlr->name())<0)
             {
-                s_oaPlanePolar.insert(s_oaPlanePolar.begin()+j, pWPolar);
+                store().m_oaPlanePolar.insert(store().m_oaPlanePolar.begin()+j, pWPolar);
                 return;
             }
         }
     }
 
-    s_oaPlanePolar.push_back(pWPolar);
+    store().m_oaPlanePolar.push_back(pWPolar);
 }
 
 
 void Objects3d::appendPlPolar(PlanePolar *pWPolar)
 {
+    invalidateIndex();
     if(!pWPolar) return;
     Plane const *pPlane = planeAt(pWPolar->planeName());
     pWPolar->setPlane(pPlane);
 
-    s_oaPlanePolar.push_back(pWPolar);
+    store().m_oaPlanePolar.push_back(pWPolar);
 }
 
 
@@ -298,6 +336,7 @@ void Objects3d::appendPlPolar(PlanePolar *pWPolar)
  */
 void Objects3d::deletePlane(Plane *pPlane, bool bDeleteResults)
 {
+    invalidateIndex();
     if(!pPlane || !pPlane->name().length()) return;
 
     if(bDeleteResults)
@@ -305,10 +344,10 @@ void Objects3d::deletePlane(Plane *pPlane, bool bDeleteResults)
 
     for (int i=nPlanes()-1; i>=0; i--)
     {
-        Plane *pOldPlane = s_oaPlane.at(i);
+        Plane *pOldPlane = store().m_oaPlane.at(i);
         if (pOldPlane == pPlane)
         {
-            s_oaPlane.erase(s_oaPlane.begin()+i);
+            store().m_oaPlane.erase(store().m_oaPlane.begin()+i);
             delete pPlane;
             break;
         }
@@ -322,25 +361,26 @@ void Objects3d::deletePlane(Plane *pPlane, bool bDeleteResults)
  */
 void Objects3d::deletePlPolar(PlanePolar *pPlPolar)
 {
+    invalidateIndex();
     //remove and delete its children POpps from the array
     if(!pPlPolar)return;
 
     for (int l=nPOpps()-1;l>=0; l--)
     {
-        PlaneOpp *pPOpp = s_oaPlaneOpp.at(l);
+        PlaneOpp *pPOpp = store().m_oaPlaneOpp.at(l);
         if (pPOpp->planeName()==pPlPolar->planeName() && pPOpp->polarName()==pPlPolar->name())
         {
-            s_oaPlaneOpp.erase(s_oaPlaneOpp.begin()+l);
+            store().m_oaPlaneOpp.erase(store().m_oaPlaneOpp.begin()+l);
             delete pPOpp;
         }
     }
 
     for(int ipb=0; ipb<nPolars(); ipb++)
     {
-        PlanePolar *pOldWPolar = s_oaPlanePolar.at(ipb);
+        PlanePolar *pOldWPolar = store().m_oaPlanePolar.at(ipb);
         if(pOldWPolar==pPlPolar)
         {
-            s_oaPlanePolar.erase(s_oaPlanePolar.begin()+ipb);
+            store().m_oaPlanePolar.erase(store().m_oaPlanePolar.begin()+ipb);
             delete pPlPolar;
             break;
         }
@@ -354,15 +394,16 @@ void Objects3d::deletePlPolar(PlanePolar *pPlPolar)
  */
 void Objects3d::deletePlaneOpp(PlaneOpp *pPOpp)
 {
+    invalidateIndex();
     //remove and delete the POpp from the array
     if(!pPOpp)return;
 
     for (int l=nPOpps()-1;l>=0; l--)
     {
-        PlaneOpp *pOldPOpp = s_oaPlaneOpp.at(l);
+        PlaneOpp *pOldPOpp = store().m_oaPlaneOpp.at(l);
         if (pOldPOpp==pPOpp)
         {
-            s_oaPlaneOpp.erase(s_oaPlaneOpp.begin()+l);
+            store().m_oaPlaneOpp.erase(store().m_oaPlaneOpp.begin()+l);
             delete pOldPOpp;
         }
     }
@@ -375,15 +416,16 @@ void Objects3d::deletePlaneOpp(PlaneOpp *pPOpp)
  */
 void Objects3d::deletePlaneResults(const Plane *pPlane, bool bDeletePolars)
 {
+    invalidateIndex();
     if(!pPlane || !pPlane->name().length()) return;
 
     //first remove all POpps associated to the plane
     for (int i=nPOpps()-1; i>=0; i--)
     {
-        PlaneOpp *pPOpp = s_oaPlaneOpp.at(i);
+        PlaneOpp *pPOpp = store().m_oaPlaneOpp.at(i);
         if(pPOpp->planeName() == pPlane->name())
         {
-            s_oaPlaneOpp.erase(s_oaPlaneOpp.begin()+i);
+            store().m_oaPlaneOpp.erase(store().m_oaPlaneOpp.begin()+i);
             delete pPOpp;
         }
     }
@@ -391,12 +433,12 @@ void Objects3d::deletePlaneResults(const Plane *pPlane, bool bDeletePolars)
     //next delete all WPolars associated to the plane
     for (int i=nPolars()-1; i>=0; i--)
     {
-        PlanePolar* pWPolar = s_oaPlanePolar.at(i);
+        PlanePolar* pWPolar = store().m_oaPlanePolar.at(i);
         if (pWPolar->planeName() == pPlane->name())
         {
             if(bDeletePolars)
             {
-                s_oaPlanePolar.erase(s_oaPlanePolar.begin()+i);
+                store().m_oaPlanePolar.erase(store().m_oaPlanePolar.begin()+i);
                 delete pWPolar;
             }
             else
@@ -409,17 +451,35 @@ void Objects3d::deletePlaneResults(const Plane *pPlane, bool bDeletePolars)
 }
 
 
+/**
+ * Deletes the results of the plane's polars which take their inertia from the plane, i.e. the results
+ * which are invalidated by a change of the plane's mass, CoG or inertia; the other results are kept.
+ */
+void Objects3d::deleteInertiaResults(const Plane *pPlane)
+{
+    if(!pPlane || !pPlane->name().length()) return;
+
+    for (int i=nPolars()-1; i>=0; i--)
+    {
+        PlanePolar* pWPolar = store().m_oaPlanePolar.at(i);
+        if (pWPolar->planeName()==pPlane->name() && pWPolar->bAutoInertia() && !pWPolar->isExternalPolar())
+            deleteWPolarResults(pWPolar);
+    }
+}
+
+
 void Objects3d::deleteExternalPolars(Plane const*pPlane)
 {
+    invalidateIndex();
     if(!pPlane) return;
 
     //next delete all WPolars associated to the plane
     for (int i=nPolars()-1; i>=0; i--)
     {
-        PlanePolar* pWPolar = s_oaPlanePolar.at(i);
+        PlanePolar* pWPolar = store().m_oaPlanePolar.at(i);
         if (pWPolar->planeName() == pPlane->name() && pWPolar->isExternalPolar())
         {
-            s_oaPlanePolar.erase(s_oaPlanePolar.begin()+i);
+            store().m_oaPlanePolar.erase(store().m_oaPlanePolar.begin()+i);
             delete pWPolar;
         }
     }
@@ -428,6 +488,7 @@ void Objects3d::deleteExternalPolars(Plane const*pPlane)
 
 void Objects3d::deleteWPolarResults(PlanePolar *pWPolar)
 {
+    invalidateIndex();
     pWPolar->clearWPolarData();
     for(int i=Objects3d::nPOpps()-1; i>=0; --i)
     {
@@ -441,21 +502,31 @@ void Objects3d::deleteWPolarResults(PlanePolar *pWPolar)
 }
 
 
+/**
+ * Returns the operating point of the polar with the name, through the name index.
+ * The objects which have been renamed without renamePlane() or renamePlPolar(), and the operating points
+ * whose name has changed with the units, are not in the index and are found by a linear search.
+ */
 PlaneOpp *Objects3d::planeOpp(Plane const *pPlane, PlanePolar const*pWPolar, std::string const &oppname)
 {
     if(!pPlane || !pWPolar) return nullptr;
-    std::string planename = pPlane->name();
-    std::string plpolarname = pWPolar->name();
+    std::string const &planename = pPlane->nameRef();
+    std::string const &plpolarname = pWPolar->nameRef();
 
-    for (int i=0; i<nPOpps(); i++)
+    // the polar may be a copy of the stored polar
+    PlanePolar const *pStoredPolar = wPolar(pPlane, plpolarname);
+    if(pStoredPolar)
     {
-        PlaneOpp* pPOpp = s_oaPlaneOpp.at(i);
-        std::string poppplanename = pPOpp->planeName();
-        std::string popppolarname = pPOpp->polarName();
-        std::string poppname = pPOpp->name();
+        PlaneOpp *pIndexed = store().findIndexed(store().m_POppIndex, pStoredPolar, oppname, buildPOppIndex);
+        if(pIndexed && pIndexed->planeName()==planename && pIndexed->polarName()==plpolarname && pIndexed->name()==oppname)
+            return pIndexed;
+    }
 
-        if (poppplanename==planename && popppolarname==plpolarname && poppname==oppname)
+    for(PlaneOpp *pPOpp : planeOpps())
+    {
+        if (pPOpp->planeName()==planename && pPOpp->polarName()==plpolarname && pPOpp->name()==oppname)
         {
+            if(pStoredPolar) invalidateIndex(); // out of date
             return pPOpp;
         }
     }
@@ -466,12 +537,18 @@ PlaneOpp *Objects3d::planeOpp(Plane const *pPlane, PlanePolar const*pWPolar, std
 PlanePolar* Objects3d::wPolar(const Plane *pPlane, std::string const &WPolarName)
 {
     if(!pPlane) return nullptr;
+    std::string const &planename = pPlane->nameRef();
+
+    PlanePolar *pIndexed = store().findIndexed(store().m_PlPolarIndex, planename, WPolarName, buildPlPolarIndex);
+    if(pIndexed && pIndexed->planeName()==planename && pIndexed->nameRef()==WPolarName) return pIndexed;
 
-    for (int i=0; i<nPolars(); i++)
+    for(PlanePolar *pWPolar : planePolars())
     {
-        PlanePolar *pWPolar = s_oaPlanePolar.at(i);
-        if (pWPolar->planeName()==pPlane->name() && pWPolar->name()== WPolarName)
+        if (pWPolar->planeName()==planename && pWPolar->nameRef()==WPolarName)
+        {
+            invalidateIndex(); // out of date
             return pWPolar;
+        }
     }
     return nullptr;
 }
@@ -479,11 +556,16 @@ PlanePolar* Objects3d::wPolar(const Plane *pPlane, std::string const &WPolarName
 
 Plane * Objects3d::plane(std::string const &PlaneName)
 {
-    Plane* pPlane = nullptr;
-    for (int i=0; i<nPlanes(); i++)
+    Plane *pIndexed = store().findIndexed(store().m_PlaneIndex, s_NoParent, PlaneName, buildPlaneIndex);
+    if(pIndexed && pIndexed->nameRef()==PlaneName) return pIndexed;
+
+    for(Plane *pPlane : planes())
     {
-        pPlane = s_oaPlane.at(i);
-        if (pPlane->name() == PlaneName) return pPlane;
+        if (pPlane->nameRef()==PlaneName)
+        {
+            invalidateIndex(); // out of date
+            return pPlane;
+        }
     }
     return nullptr;
 }
@@ -491,35 +573,41 @@ Plane * Objects3d::plane(std::string const &PlaneName)
 
 const Plane *Objects3d::planeAt(std::string const &PlaneName)
 {
-    Plane* pPlane = nullptr;
-    for (int i=0; i<nPlanes(); i++)
-    {
-        pPlane = s_oaPlane.at(i);
-        if (pPlane->name() == PlaneName) return pPlane;
-    }
-    return nullptr;
+    return plane(PlaneName);
 }
 
+/** The memory used by the planes, the plane polars and the operating points, in bytes */
+size_t Objects3d::memoryFootprint()
+{
+    size_t n = 0;
+    for(Plane const *pPlane : store().m_oaPlane)           n += pPlane->memoryFootprint();
+    for(PlanePolar const *pWPolar : store().m_oaPlanePolar) n += pWPolar->memoryFootprint();
+    for(PlaneOpp const *pPOpp : store().m_oaPlaneOpp)      n += pPOpp->memoryFootprint();
+    return n;
+}
+
+
 void Objects3d::deleteObjects()
 {
+    invalidateIndex();
     for (int i=nPlanes()-1; i>=0; i--)
     {
-        Plane *pPlane = s_oaPlane.at(i);
-        s_oaPlane.erase(s_oaPlane.begin()+i);
+        Plane *pPlane = store().m_oaPlane.at(i);
+        store().m_oaPlane.erase(store().m_oaPlane.begin()+i);
         if(pPlane) delete pPlane;
     }
 
     for (int i=nPolars()-1; i>=0; i--)
     {
-        PlanePolar *pWPolar = s_oaPlanePolar.at(i);
-        s_oaPlanePolar.erase(s_oaPlanePolar.begin()+i);
+        PlanePolar *pWPolar = store().m_oaPlanePolar.at(i);
+        store().m_oaPlanePolar.erase(store().m_oaPlanePolar.begin()+i);
         if(pWPolar) delete pWPolar;
     }
 
     for (int i=nPOpps()-1; i>=0; i--)
     {
-        PlaneOpp *pPOpp = s_oaPlaneOpp.at(i);
-        s_oaPlaneOpp.erase(s_oaPlaneOpp.begin()+i);
+        PlaneOpp *pPOpp = store().m_oaPlaneOpp.at(i);
+        store().m_oaPlaneOpp.erase(store().m_oaPlaneOpp.begin()+i);
         if(pPOpp) delete pPOpp;
     }
 }
@@ -531,7 +619,7 @@ void Objects3d::setPlPolarColor(Plane const *pPlane, PlanePolar *pWPolar, int da
     fl5Color clr = pPlane->lineColor();
     for(int ip=0; ip<nPolars(); ip++)
     {
-        if(s_oaPlanePolar.at(ip)->planeName().compare(pPlane->name())==0)
+        if(store().m_oaPlanePolar.at(ip)->planeName().compare(pPlane->name())==0)
         {
             clr = clr.darker(darkfactor);
         }
@@ -548,7 +636,7 @@ void Objects3d::setPlaneStyle(Plane *pPlane, LineStyle const &ls, bool bStipple,
 
     for(int iwp=0; iwp<nPolars(); iwp++)
     {
-        PlanePolar *pWPolar = s_oaPlanePolar.at(iwp);
+        PlanePolar *pWPolar = store().m_oaPlanePolar.at(iwp);
         if(pWPolar->planeName().compare(pPlane->name())==0)
         {
             if(bStipple) pWPolar->setLineStipple(ls.m_Stipple);
@@ -574,7 +662,7 @@ void Objects3d::setPlaneVisible(const Plane *pPlane, bool bVisible, bool bStabil
 
     for(int iwp=0; iwp<nPolars(); iwp++)
     {
-        PlanePolar *pWPolar = s_oaPlanePolar.at(iwp);
+        PlanePolar *pWPolar = store().m_oaPlanePolar.at(iwp);
         if(pWPolar->planeName().compare(pPlane->name())==0)
         {
             /*            if(bStabilityPolarsOnly)
@@ -587,7 +675,7 @@ void Objects3d::setPlaneVisible(const Plane *pPlane, bool bVisible, bool bStabil
     }
     for(int ipp=0; ipp<nPOpps(); ipp++)
     {
-        PlaneOpp *pPOpp = s_oaPlaneOpp.at(ipp);
+        PlaneOpp *pPOpp = store().m_oaPlaneOpp.at(ipp);
         if(pPOpp->planeName().compare(pPlane->name())==0)
         {
             if(bStabilityPolarsOnly)
@@ -610,7 +698,7 @@ void Objects3d::setPlPolarVisible(PlanePolar *pWPolar, bool bVisible)
 
     for(int ipp=0; ipp<nPOpps(); ipp++)
     {
-        PlaneOpp *pPOpp = s_oaPlaneOpp.at(ipp);
+        PlaneOpp *pPOpp = store().m_oaPlaneOpp.at(ipp);
         if(pPOpp->planeName().compare(pPlane->name())==0)
         {
             if(pPOpp->polarName().compare(pWPolar->name())==0)
@@ -624,7 +712,7 @@ bool Objects3d::hasResults(const Plane *pPlane)
 {
     for(int j=0; j<nPolars(); j++)
     {
-        PlanePolar const *pWPolar = s_oaPlanePolar.at(j);
+        PlanePolar const *pWPolar = store().m_oaPlanePolar.at(j);
         if(pWPolar->planeName()==pPlane->name() && pWPolar->dataSize())
         {
             return true;
@@ -633,7 +721,7 @@ bool Objects3d::hasResults(const Plane *pPlane)
 
     for (int i=0; i<nPOpps(); i++)
     {
-        PlaneOpp const *pPOpp = s_oaPlaneOpp.at(i);
+        PlaneOpp const *pPOpp = store().m_oaPlaneOpp.at(i);
         if(pPOpp->planeName() == pPlane->name())
         {
             return true;
@@ -644,11 +732,111 @@ bool Objects3d::hasResults(const Plane *pPlane)
 }
 
 
+/** @return true if one of the polars which take their inertia from the plane has results */
+bool Objects3d::hasInertiaResults(const Plane *pPlane)
+{
+    for(int j=0; j<nPolars(); j++)
+    {
+        PlanePolar const *pWPolar = store().m_oaPlanePolar.at(j);
+        if(pWPolar->planeName()!=pPlane->name() || !pWPolar->bAutoInertia() || pWPolar->isExternalPolar()) continue;
+        if(pWPolar->dataSize() || hasPOpps(pWPolar)) return true;
+    }
+    return false;
+}
+
+
+namespace
+{
+    Plane *copyPlane(Plane const *pPlane)
+    {
+        Plane *pCopy = nullptr;
+        if(pPlane->isXflType()) pCopy = new PlaneXfl;
+        else                    pCopy = new PlaneSTL;
+        pCopy->duplicate(pPlane);
+        return pCopy;
+    }
+
+    QByteArray planeBytes(Plane *pPlane)
+    {
+        QByteArray bytes;
+        QDataStream ar(&bytes, QIODevice::WriteOnly);
+        pPlane->serializePlaneFl5(ar, true);
+        return bytes;
+    }
+
+    /** Copies the inertia of the plane and of its parts from the source to the destination plane */
+    void copyPlaneInertia(Plane const *pSrc, Plane *pDest)
+    {
+        pDest->setAutoInertia(pSrc->bAutoInertia());
+        pDest->setInertia(pSrc->inertia());
+        for(int iw=0; iw<std::min(pSrc->nWings(), pDest->nWings()); iw++)
+        {
+            pDest->wing(iw)->copyInertia(*pSrc->wingAt(iw));
+            pDest->wing(iw)->setAutoInertia(pSrc->wingAt(iw)->bAutoInertia());
+        }
+        for(int ifuse=0; ifuse<std::min(pSrc->nFuse(), pDest->nFuse()); ifuse++)
+        {
+            pDest->fuse(ifuse)->copyInertia(*pSrc->fuseAt(ifuse));
+            pDest->fuse(ifuse)->setAutoInertia(pSrc->fuseAt(ifuse)->bAutoInertia());
+        }
+    }
+
+    /** Copies the name, the description and the styles of the plane and of its parts */
+    void copyPlaneStyle(Plane const *pSrc, Plane *pDest)
+    {
+        pDest->setName(pSrc->name());
+        pDest->copyMetaData(pSrc);
+        for(int iw=0; iw<std::min(pSrc->nWings(), pDest->nWings()); iw++)
+        {
+            pDest->wing(iw)->setTheStyle(pSrc->wingAt(iw)->theStyle());
+            pDest->wing(iw)->setDescription(pSrc->wingAt(iw)->description());
+        }
+        for(int ifuse=0; ifuse<std::min(pSrc->nFuse(), pDest->nFuse()); ifuse++)
+        {
+            pDest->fuse(ifuse)->setTheStyle(pSrc->fuseAt(ifuse)->theStyle());
+            pDest->fuse(ifuse)->setDescription(pSrc->fuseAt(ifuse)->description());
+        }
+    }
+}
+
+
+/**
+ * Classifies the modifications of the plane by their impact on the results, so that the results which
+ * are not affected are kept: the style and description edits affect no result, the inertia edits affect only
+ * the polars which take their inertia from the plane, all other edits affect all results.
+ * The classification is made by comparing the serialized planes after copying the style, then the inertia,
+ * of the original plane onto a copy of the modified plane; any difference is treated as a geometry change.
+ */
+Objects3d::enumPlaneEdit Objects3d::planeEditType(Plane const *pPlane, Plane const *pModPlane)
+{
+    if(!pPlane || !pModPlane || pPlane->isXflType()!=pModPlane->isXflType()) return GEOMETRYEDIT;
+    if(pPlane->nWings()!=pModPlane->nWings() || pPlane->nFuse()!=pModPlane->nFuse()) return GEOMETRYEDIT;
+
+    Plane *pRef = copyPlane(pPlane);
+    Plane *pMod = copyPlane(pModPlane);
+
+    QByteArray refbytes = planeBytes(pRef);
+
+    enumPlaneEdit edit = GEOMETRYEDIT;
+    copyPlaneStyle(pPlane, pMod);
+    if(planeBytes(pMod)==refbytes) edit = STYLEEDIT;
+    else
+    {
+        copyPlaneInertia(pPlane, pMod);
+        if(planeBytes(pMod)==refbytes) edit = INERTIAEDIT;
+    }
+
+    delete pRef;
+    delete pMod;
+    return edit;
+}
+
+
 bool Objects3d::hasPOpps(const Plane *pPlane)
 {
     for (int i=0; i<nPOpps(); i++)
     {
-        PlaneOpp const *pPOpp = s_oaPlaneOpp.at(i);
+        PlaneOpp const *pPOpp = store().m_oaPlaneOpp.at(i);
         if(pPOpp->planeName() == pPlane->name())
         {
             return true;
@@ -663,7 +851,7 @@ bool Objects3d::hasPOpps(PlanePolar const *pWPolar)
 {
     for (int i=0; i<nPOpps(); i++)
     {
-        PlaneOpp const *pPOpp = s_oaPlaneOpp.at(i);
+        PlaneOpp const *pPOpp = store().m_oaPlaneOpp.at(i);
         if(pPOpp->planeName() == pWPolar->planeName() && pPOpp->polarName()==pWPolar->name())
         {
             return true;
@@ -676,6 +864,7 @@ bool Objects3d::hasPOpps(PlanePolar const *pWPolar)
 
 void Objects3d::insertPlPolar(PlanePolar *pWPolar)
 {
+    invalidateIndex();
     if(!pWPolar) return;
 
     for (int j=0; j<nPolars();j++)
@@ -685,7 +874,7 @@ void Objects3d::insertPlPolar(PlanePolar *pWPolar)
         //first index is the parent plane's name
         if (pWPolar->planeName().compare(pOldWPolar->planeName())<0)
         {
-            s_oaPlanePolar.insert(s_oaPlanePolar.begin()+j, pWPolar);
+            store().m_oaPlanePolar.insert(store().m_oaPlanePolar.begin()+j, pWPolar);
             return;
         }
         else if(pOldWPolar->planeName().compare(pWPolar->planeName())==0)
@@ -693,13 +882,13 @@ void Objects3d::insertPlPolar(PlanePolar *pWPolar)
             // second index is the polar name
             if(pWPolar->name().compare(pOldWPolar->name())<0)
             {
-                s_oaPlanePolar.insert(s_oaPlanePolar.begin()+j, pWPolar);
+                store().m_oaPlanePolar.insert(store().m_oaPlanePolar.begin()+j, pWPolar);
                 return;
             }
             else if(pWPolar->name().compare(pOldWPolar->name())==0)
             {
                 delete pOldWPolar; // delete the old polar
-                s_oaPlanePolar[j] = pWPolar; // and replace it
+                store().m_oaPlanePolar[j] = pWPolar; // and replace it
                 return;
             }
         }
@@ -725,7 +914,7 @@ void Objects3d::setPlPolarPOppStyle(PlanePolar const* pWPolar, bool bStipple, bo
     PlaneOpp *pLastPOpp = nullptr;
     for(int ipp=0; ipp<nPOpps(); ipp++)
     {
-        PlaneOpp *pPOpp = s_oaPlaneOpp.at(ipp);
+        PlaneOpp *pPOpp = store().m_oaPlaneOpp.at(ipp);
         if(pWPolar->hasPOpp(pPOpp)) pLastPOpp = pPOpp;
     }
 
@@ -738,7 +927,7 @@ void Objects3d::setPlPolarPOppStyle(PlanePolar const* pWPolar, bool bStipple, bo
 
     for(int ipp=nPOpps()-1; ipp>=0; ipp--)
     {
-        PlaneOpp *pPOpp = s_oaPlaneOpp.at(ipp);
+        PlaneOpp *pPOpp = store().m_oaPlaneOpp.at(ipp);
         if(pWPolar->hasPOpp(pPOpp))
         {
             if(bStipple) pPOpp->setLineStipple(pWPolar->lineStipple());
@@ -754,6 +943,7 @@ void Objects3d::setPlPolarPOppStyle(PlanePolar const* pWPolar, bool bStipple, bo
 
 void Objects3d::insertPlane(Plane *pModPlane)
 {
+    invalidateIndex();
     bool bInserted = false;
 
     QString planename = QString::fromStdString(pModPlane->name());
@@ -789,7 +979,7 @@ void Objects3d::updateFoilName(std::string const &oldName, std::string const &ne
 {
     for(int ip=0; ip<nPlanes(); ip++)
     {
-        Plane  *pPlane = Objects3d::s_oaPlane.at(ip);
+        Plane  *pPlane = Objects3d::store().m_oaPlane.at(ip);
         for(int iw=0;  iw<pPlane->nWings(); iw++)
         {
             WingXfl *pWingXfl = pPlane->wing(iw);
@@ -806,10 +996,11 @@ void Objects3d::updateFoilName(std::string const &oldName, std::string const &ne
 
 void Objects3d::cleanObjects(std::string &log)
 {
+    invalidateIndex();
     log.clear();
     for (int i=nPOpps()-1; i>=0; i--)
     {
-        PlaneOpp* pPOpp = s_oaPlaneOpp.at(i);
+        PlaneOpp* pPOpp = store().m_oaPlaneOpp.at(i);
         Plane const*pPlane = plane(pPOpp->planeName());
         PlanePolar const *pWPolar = wPolar(pPlane, pPOpp->polarName());
         if(!pPlane || !pWPolar)
@@ -820,13 +1011,13 @@ void Objects3d::cleanObjects(std::string &log)
                     pPOpp->polarName() + " / " +
                     pPOpp->name()      + "\n";
             delete pPOpp;
-            s_oaPlaneOpp.erase(s_oaPlaneOpp.begin()+i);
+            store().m_oaPlaneOpp.erase(store().m_oaPlaneOpp.begin()+i);
         }
     }
 
     for(int i=nPolars()-1; i>=0; i--)
     {
-        PlanePolar  *pOldWPolar = s_oaPlanePolar[i];
+        PlanePolar  *pOldWPolar = store().m_oaPlanePolar[i];
         Plane const*pPlane = plane(pOldWPolar->planeName());
         if(!pPlane)
         {
@@ -842,7 +1033,7 @@ void Objects3d::updatePlPolarstoV750()
 {
     for(int i=nPolars()-1; i>=0; i--)
     {
-        PlanePolar  *pOldWPolar = s_oaPlanePolar[i];
+        PlanePolar  *pOldWPolar = store().m_oaPlanePolar[i];
         Plane const*pPlane = plane(pOldWPolar->planeName());
         if(!pPlane)
         {
@@ -861,6 +1052,7 @@ void Objects3d::updatePlPolarstoV750()
 
 void Objects3d::renamePlane(Plane*pPlane, std::string const &newname)
 {
+    invalidateIndex();
     if(!pPlane) return;
 
     std::string const &OldName = pPlane->name();
@@ -888,6 +1080,7 @@ void Objects3d::renamePlane(Plane*pPlane, std::string const &newname)
 
 void Objects3d::renamePlPolar(PlanePolar *pWPolar, const std::string &newname)
 {
+    invalidateIndex();
     if(!pWPolar) return;
 
     std::string const &planename = pWPolar->planeName();
@@ -908,7 +1101,7 @@ void Objects3d::renamePlPolar(PlanePolar *pWPolar, const std::string &newname)
 
 bool Objects3d::containsPOpp(PlaneOpp *pPOpp)
 {
-    if(std::find(s_oaPlaneOpp.begin(), s_oaPlaneOpp.end(), pPOpp) != s_oaPlaneOpp.end())
+    if(std::find(store().m_oaPlaneOpp.begin(), store().m_oaPlaneOpp.end(), pPOpp) != store().m_oaPlaneOpp.end())
     {
         return true;
     }
@@ -24,6 +24,7 @@
 
 #include <QString>
 
+#include <memory>
 #include <string>
 
 #include <BRepBuilderAPI_Sewing.hxx>
@@ -48,6 +49,8 @@
 #include <occ_globals.h>
 #include <panel3.h>
 #include <panel4.h>
+#include <segment3d.h>
+#include <threadpool.h>
 #include <units.h>
 
 
@@ -88,6 +91,7 @@ Fuse::Fuse(const Fuse &aFuse)
     m_MaxFrameArea = aFuse.m_MaxFrameArea;
 
     m_BaseTriangulation = aFuse.m_BaseTriangulation;
+    m_BaseBVH = aFuse.m_BaseBVH;
     m_Triangulation = aFuse.m_Triangulation;
 
     m_Shape = aFuse.m_Shape;
@@ -101,6 +105,23 @@ Fuse::Fuse(const Fuse &aFuse)
 
 
 void Fuse::duplicateFuse(Fuse const &aFuse)
+{
+    Fuse::duplicateFuseDefinition(aFuse);
+
+    m_BaseTriangulation = aFuse.m_BaseTriangulation;
+    m_BaseBVH = aFuse.m_BaseBVH;
+    m_Triangulation = aFuse.m_Triangulation;
+
+    m_TriMesh     = aFuse.m_TriMesh;
+}
+
+
+/**
+ * Copies the data which define the fuse, but not the triangulations and the mesh which are made from it.
+ * The OCC shapes are handles to the same shared geometry, so that their copy is cheap.
+ * Used by the editors to take the undo snapshots, since the geometry is rebuilt when a snapshot is restored.
+ */
+void Fuse::duplicateFuseDefinition(Fuse const &aFuse)
 {
     duplicatePart(aFuse);
     m_bLocked = false;
@@ -111,14 +132,9 @@ void Fuse::duplicateFuse(Fuse const &aFuse)
     m_MaxHeight    = aFuse.m_MaxHeight;
     m_MaxFrameArea = aFuse.m_MaxFrameArea;
 
-    m_BaseTriangulation = aFuse.m_BaseTriangulation;
-    m_Triangulation = aFuse.m_Triangulation;
-
     m_Shape = aFuse.m_Shape;
     m_Shell = aFuse.m_Shell;
 
-    m_TriMesh     = aFuse.m_TriMesh;
-
     m_MaxElementSize = aFuse.m_MaxElementSize;
     m_OccTessParams = aFuse.m_OccTessParams;
 }
@@ -292,6 +308,7 @@ void Fuse::scale(double XFactor, double YFactor, double ZFactor)
 {
     for(int it=0; it<m_BaseTriangulation.nTriangles(); it++)
         m_BaseTriangulation.triangle(it).scale(XFactor, YFactor, ZFactor);
+    m_BaseBVH.clear();
 
     for(int it=0; it<m_Triangulation.nTriangles(); it++) m_Triangulation.triangle(it).scale(XFactor, YFactor, ZFactor);
     m_Length *= XFactor;
@@ -308,6 +325,7 @@ void Fuse::translate(Vector3d const &T)
     {
         m_BaseTriangulation.triangle(it).translate(T);
     }
+    m_BaseBVH.clear();
 
     for(int it=0; it<m_Triangulation.nTriangles(); it++)
     {
@@ -323,6 +341,7 @@ void Fuse::translate(Vector3d const &T)
 void Fuse::rotate(Vector3d const &origin, Vector3d const &axis, double theta)
 {
     m_BaseTriangulation.rotate(origin, axis, theta);
+    m_BaseBVH.clear();
     m_Triangulation.rotate(origin, axis, theta);
 }
 
@@ -586,11 +605,21 @@ void Fuse::getProperties(std::string &properties, const std::string &prefx, bool
 }
 
 
+/** Returns the bounding volume hierarchy of the base triangulation, and builds it on first use */
+TriangleBVH const &Fuse::baseBVH() const
+{
+    if(!m_BaseBVH.isBuilt()) m_BaseBVH.build(m_BaseTriangulation.triangles());
+    return m_BaseBVH;
+}
+
+
 /** used in gl3dFuseView */
 bool Fuse::intersectFuseTriangulation(Vector3d const &A, Vector3d const &B, Vector3d &I) const
 {
-    Vector3d N;
-    return m_BaseTriangulation.intersect(A, B, I, N);
+    Node nd;
+    bool b = baseBVH().intersectLine(m_BaseTriangulation.triangles(), A, B, nd);
+    if(b) I = nd;
+    return b;
 }
 
 
@@ -635,6 +664,88 @@ bool Fuse::intersectFuse(Vector3d const &A, Vector3d const &B, Vector3d &I, bool
 }
 
 
+/**
+ * Intersects a batch of segments with the fuse, in parallel.
+ * The segments are first intersected with the base triangulation. The exact intersection with the
+ * shapes is only searched on a short part of the segment around the hit so that the faces far from it
+ * are not crossed, and on the full segment if this fails.
+ * The segments which miss the triangulation, extended by the same margin,
+ * are considered as missing the fuse and cost no query of the shapes.
+ * Falls back on one exact query per segment if the fuse has no base triangulation.
+ * @param I the intersection points closest to the segments' first vertex
+ * @param bIntersect true for each segment which intersects the fuse
+ * @return the number of segments which intersect the fuse
+ */
+int Fuse::intersectFuse(std::vector<Segment3d> const &segs, std::vector<Vector3d> &I, std::vector<bool> &bIntersect, bool bRightSide) const
+{
+    int nSegs = int(segs.size());
+    I.resize(nSegs);
+    bIntersect.assign(nSegs, false);
+    if(nSegs==0) return 0;
+
+    std::unique_ptr<bool[]> bHit(new bool[nSegs]()); // std::vector<bool> may not be written concurrently
+
+    bool bTessellation = m_BaseTriangulation.nTriangles()>0;
+    std::vector<Node> hit;
+    std::vector<Vector3d> A, B;
+    if(bTessellation)
+    {
+        // refine on 10% of the segment's length on each side of the hit
+        A.resize(nSegs);
+        B.resize(nSegs);
+        for(int i=0; i<nSegs; i++)
+        {
+            Vector3d U = segs.at(i).vertexAt(1) - segs.at(i).vertexAt(0);
+            A[i] = segs.at(i).vertexAt(0) - U*0.1;
+            B[i] = segs.at(i).vertexAt(1) + U*0.1;
+        }
+        hit.resize(nSegs);
+        baseBVH().intersectSegments(m_BaseTriangulation.triangles(), nSegs, A.data(), B.data(), hit.data(), bHit.get(), true);
+    }
+
+    int nBlocks = std::min(nSegs, ThreadPool::nBlocks(ThreadPool::maxThreadCount()));
+    ThreadPool::pool().parallelFor(nBlocks, [&](int iBlock)
+    {
+        int iStart = iBlock*nSegs/nBlocks;
+        int iMax   = (iBlock+1)*nSegs/nBlocks;
+        for(int i=iStart; i<iMax; i++)
+        {
+            Segment3d const &seg = segs.at(i);
+            if(!bTessellation)
+            {
+                bHit[i] = intersectFuse(seg.vertexAt(0), seg.vertexAt(1), I[i], bRightSide);
+                continue;
+            }
+            if(!bHit[i]) continue;
+
+            if(m_Shape.IsEmpty())
+            {
+                // the triangulation is the fuse's geometry
+                I[i] = hit.at(i);
+                continue;
+            }
+
+            Vector3d dU = (seg.vertexAt(1) - seg.vertexAt(0))*0.1;
+            Vector3d Ic;
+            bool bExact = intersectFuse(hit.at(i)-dU, hit.at(i)+dU, Ic, bRightSide);
+            // keep the point only if it is in the segment
+            if(bExact) bExact = Ic.distanceTo(seg.vertexAt(0))<seg.length() && Ic.distanceTo(seg.vertexAt(1))<seg.length();
+            if(!bExact) bExact = intersectFuse(seg.vertexAt(0), seg.vertexAt(1), Ic, bRightSide);
+            bHit[i] = bExact;
+            if(bExact) I[i] = Ic;
+        }
+    });
+
+    int nHits = 0;
+    for(int i=0; i<nSegs; i++)
+    {
+        bIntersect[i] = bHit[i];
+        if(bIntersect[i]) nHits++;
+    }
+    return nHits;
+}
+
+
 Fuse::enumType Fuse::bodyPanelType(std::string strPanelType)
 {
     if(strPanelType.compare("FLATPANELS")==0) return Fuse::FlatFace;
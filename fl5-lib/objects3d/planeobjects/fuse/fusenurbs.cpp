@@ -46,8 +46,6 @@ int FuseNurbs::makeQuadMesh(int idx0, const Vector3d &pos)
 {
     m_Panel4.clear();
 
-    double uk(0.0), uk1(0.0), v(0.0);
-
     std::vector<Vector3d> refnode;
 
     Vector3d LA, LB, TA, TB;
@@ -63,17 +61,20 @@ int FuseNurbs::makeQuadMesh(int idx0, const Vector3d &pos)
     double dpy=pos.y;
     double dpz=pos.z;
 
-    if(int(m_XPanelPos.size())<nx) return 0;
+    if(int(m_XPanelPos.size())<nx+1) return 0;
 
     fullSize = idx0 + 2*nx*nh;
     //start with left side... same as for wings
+    // the nodes of the left side in one batch
+    std::vector<double> u(m_XPanelPos.begin(), m_XPanelPos.begin()+nx+1), v(nh+1);
+    for (int l=0; l<=nh; l++) v[l] = double(l) / double(nh);
+    std::vector<Vector3d> grid;
+    getGrid(u, v, false, grid);
+
     for (int k=0; k<nx; k++)
     {
-        uk  = m_XPanelPos.at(k);
-        uk1 = m_XPanelPos.at(k+1);
-
-        getPoint(uk,  0, false, LB);
-        getPoint(uk1, 0, false, TB);
+        LB = grid.at( k   *(nh+1));
+        TB = grid.at((k+1)*(nh+1));
 
         LB.x += dpx;
         LB.y += dpy;
@@ -87,9 +88,8 @@ int FuseNurbs::makeQuadMesh(int idx0, const Vector3d &pos)
             m_Panel4.push_back({});
             Panel4 &p4 = m_Panel4.back();
             //start with left side... same as for wings
-            v = double(l+1) / double(nh);
-            getPoint(uk,  v, false, LA);
-            getPoint(uk1, v, false, TA);
+            LA = grid.at( k   *(nh+1)+l+1);
+            TA = grid.at((k+1)*(nh+1)+l+1);
 
             LA.x += dpx;
             LA.y += dpy;
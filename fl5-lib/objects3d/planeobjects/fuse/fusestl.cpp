@@ -194,16 +194,17 @@ bool FuseStl::serializePartFl5(QDataStream &ar, bool bIsStoring)
         std::string logmsg;
         makeDefaultTriMesh(logmsg, "");
         m_BaseTriangulation.setTriangles(m_Triangulation.triangles());
+        m_BaseBVH.clear();
     }
     return true;
 }
 
 
 // Intersects the triangulation, but not precise enough if the triangulation is coarse
-bool FuseStl::intersectFuse(const Vector3d &A, const Vector3d &B, Vector3d &I, bool bMultiThreaded) const
+bool FuseStl::intersectFuse(const Vector3d &A, const Vector3d &B, Vector3d &I, bool) const
 {
     Node nd;
-    bool b = geom::intersectTriangles(m_BaseTriangulation.triangles(), A, B, nd, bMultiThreaded);
+    bool b = baseBVH().intersectSegment(m_BaseTriangulation.triangles(), A, B, nd);
     I = nd;
     return b;
 }
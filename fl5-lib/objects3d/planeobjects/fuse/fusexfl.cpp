@@ -57,6 +57,9 @@
 
 #include <constants.h>
 #include <frame.h>
+#include <fuseflatfaces.h>
+#include <fusenurbs.h>
+#include <fusesections.h>
 #include <geom_global.h>
 #include <occ_globals.h>
 #include <panel3.h>
@@ -82,6 +85,7 @@ FuseXfl::FuseXfl(Fuse::enumType fusetype) : Fuse()
     m_Name = "xfl type fuse";
 
     m_iHighlightFrame  = -1;
+    m_ShapeKey = 0;
 
     m_nxNurbsPanels = 11;
     m_nhNurbsPanels = 5;
@@ -258,7 +262,38 @@ void FuseXfl::duplicateFuse(const Fuse &aFuse)
 void FuseXfl::duplicateFuseXfl(const FuseXfl &aFuseXfl)
 {
     Fuse::duplicateFuse(aFuseXfl);
+    copyXflDefinition(aFuseXfl);
+}
+
+
+void FuseXfl::duplicateFuseDefinition(const Fuse &aFuse)
+{
+    FuseXfl const&xflfuse = dynamic_cast<const FuseXfl&>(aFuse);
+    Fuse::duplicateFuseDefinition(xflfuse);
+    copyXflDefinition(xflfuse);
+}
+
+
+/**
+ * @return a new fuse of the same type which holds only the definition of this fuse, i.e. without its triangulations and mesh.
+ * This is a fraction of the size of a full copy, and is what the undo stack of the editors needs.
+ */
+FuseXfl *FuseXfl::snapshot() const
+{
+    FuseXfl *pFuse = nullptr;
+    switch(m_FuseType)
+    {
+        case Fuse::FlatFace: pFuse = new FuseFlatFaces; break;
+        case Fuse::Sections: pFuse = new FuseSections;  break;
+        default:             pFuse = new FuseNurbs;     break;
+    }
+    pFuse->duplicateFuseDefinition(*this);
+    return pFuse;
+}
 
+
+void FuseXfl::copyXflDefinition(const FuseXfl &aFuseXfl)
+{
     //copy the splined surface data
     m_nxNurbsPanels = aFuseXfl.m_nxNurbsPanels;
     m_nhNurbsPanels = aFuseXfl.m_nhNurbsPanels;
@@ -277,6 +312,7 @@ void FuseXfl::duplicateFuseXfl(const FuseXfl &aFuseXfl)
     {
         m_RightSideShell.Append(iterator.Value());
     }
+    m_ShapeKey = aFuseXfl.m_ShapeKey;
 
     m_iHighlightFrame = -1;
 }
@@ -292,13 +328,62 @@ void FuseXfl::makeFuseGeometry()
     makeBodyFaces();
 
     std::string logmsg;
-    makeShape(logmsg);
-    makeShellsFromShapes();
+
+    // the OCC shapes are only rebuilt if the frames have changed since the last build,
+    // so that the edits which leave the geometry unchanged and the calls before meshing or export are cheap
+    uint64_t key = shapeKey();
+    if(key!=m_ShapeKey || m_Shape.IsEmpty() || m_Shell.IsEmpty())
+    {
+        makeShape(logmsg);
+        makeShellsFromShapes();
+        m_ShapeKey = m_Shape.IsEmpty() ? 0 : key;
+    }
 
     computeSurfaceProperties(logmsg, "");
 }
 
 
+/**
+ * Returns a key of the data from which the shapes are built: the fuse type, the NURBS degrees,
+ * knots and edge weights, and the frames' positions and control points.
+ */
+uint64_t FuseXfl::shapeKey() const
+{
+    // FNV-1a
+    uint64_t key = 14695981039346656037ULL;
+    auto hashBytes = [&key](void const *data, size_t size)
+    {
+        unsigned char const *bytes = static_cast<unsigned char const*>(data);
+        for(size_t i=0; i<size; i++)
+        {
+            key ^= bytes[i];
+            key *= 1099511628211ULL;
+        }
+    };
+
+    int props[] = {int(m_FuseType), m_nurbs.uDegree(), m_nurbs.vDegree(), frameCount(), framePointCount()};
+    hashBytes(props, sizeof(props));
+    double weights[] = {m_nurbs.uEdgeWeight(), m_nurbs.vEdgeWeight()};
+    hashBytes(weights, sizeof(weights));
+    if(m_nurbs.uKnot().size()) hashBytes(m_nurbs.uKnot().data(), m_nurbs.uKnot().size()*sizeof(double));
+    if(m_nurbs.vKnot().size()) hashBytes(m_nurbs.vKnot().data(), m_nurbs.vKnot().size()*sizeof(double));
+
+    for(int iFrame=0; iFrame<frameCount(); iFrame++)
+    {
+        Frame const &fr = m_nurbs.frameAt(iFrame);
+        double pos[] = {fr.position().x, fr.position().y, fr.position().z, fr.angle()};
+        hashBytes(pos, sizeof(pos));
+        for(int j=0; j<fr.nCtrlPoints(); j++)
+        {
+            Vector3d const &pt = fr.pointAt(j);
+            double xyz[] = {pt.x, pt.y, pt.z};
+            hashBytes(xyz, sizeof(xyz));
+        }
+    }
+    return key;
+}
+
+
 int FuseXfl::makeShape(std::string &log)
 {
     m_Shape.Clear();
@@ -332,22 +417,29 @@ void FuseXfl::computeSurfaceProperties(std::string &msg, const std::string &pref
     m_MaxHeight = 0.0;
     m_MaxFrameArea = 0.0;
 
+    // the hoop points of all the frames in one batch
+    int nh = 20;
+    std::vector<Vector3d> framegrid;
+    if(isSplineType() || isSectionType())
+    {
+        std::vector<double> uf(nurbs().frameCount()), vh(nh);
+        for(int i=0; i<nurbs().frameCount(); i++) uf[i] = getu(frame(i).position().x);
+        double hinc = 1.0/double(nh-1);
+        for (int k=0; k<nh; k++) vh[k] = double(k)*hinc;
+        m_nurbs.getGrid(uf, vh, framegrid);
+    }
+
     for(int i=0; i<nurbs().frameCount(); i++)
     {
         rightpoints.clear();
         double halfwidth = 0;
         if(isSplineType() || isSectionType())
         {
-            int nh = 20;
-            double hinc = 1.0/double(nh-1);
-            double u = getu(frame(i).position().x);
-            double v = 0.0;
             for (int k=0; k<nh; k++)
             {
-                getPoint(u,v,true, Point);
+                Point = framegrid.at(i*nh+k);
                 rightpoints.push_back(Point);
                 halfwidth = std::max(halfwidth, fabs(Point.y));
-                v += hinc;
             }
         }
         else if(isFlatFaceType())
@@ -486,12 +578,14 @@ double FuseXfl::getSectionArcLength(double x) const
     double length = 0.0;
     double ux = getu(x);
     Vector3d Pt, Pt1;
-    getPoint(ux, 0.0, true, Pt1);
+    std::vector<Vector3d> curve; // the section is at constant u
+    m_nurbs.getuCurve(ux, curve);
+    m_nurbs.getCurvePoint(ux, curve, 0.0, Pt1);
 
     int NPoints = 10;//why not?
     for(int i=1; i<=NPoints; i++)
     {
-        getPoint(ux, double(i)/double(NPoints), true, Pt);
+        m_nurbs.getCurvePoint(ux, curve, double(i)/double(NPoints), Pt);
         length += sqrt((Pt.y-Pt1.y)*(Pt.y-Pt1.y) + (Pt.z-Pt1.z)*(Pt.z-Pt1.z));
         Pt1.y = Pt.y;
         Pt1.z = Pt.z;
@@ -524,6 +618,19 @@ void FuseXfl::getPoint(double u, double v, bool bRight, Vector3d &Pt) const
 }
 
 
+/**
+ * Calculates the points for the tensor product of the parameters u[] and v[] in one batch;
+ * the point (iu, iv) is at index iu*v.size()+iv.
+ * @param bRight if true, the points are returned for the right side, and for the left side if false
+ */
+void FuseXfl::getGrid(std::vector<double> const &u, std::vector<double> const &v, bool bRight, std::vector<Vector3d> &grid) const
+{
+    m_nurbs.getGrid(u, v, grid);
+    if(!bRight)
+        for(uint i=0; i<grid.size(); i++) grid[i].y = -grid[i].y;
+}
+
+
 /**
  * Returns the absolute position of a point on the NURBS from its parametric coordinates.
  * @param u the value of the parameter in the longitudinal direction
@@ -576,10 +683,14 @@ double FuseXfl::getv(double u, Vector3d r, bool bRight) const
     r.normalize();
     v1 = 0.0; v2 = 1.0;
 
+    std::vector<Vector3d> curve; // u is constant, so that the u-basis is evaluated once
+    m_nurbs.getuCurve(u, curve);
+
     while(fabs(sine)>1.0e-4 && iter<200)
     {
         v=(v1+v2)/2.0;
-        t_R = Point(u, v, bRight);
+        m_nurbs.getCurvePoint(u, curve, v, t_R);
+        if(!bRight) t_R.y = -t_R.y;
         t_R.x = 0.0;
         t_R.normalize();//t_R is the unit radial vector for u,v
 
@@ -957,6 +1068,8 @@ void FuseXfl::translateFrame(Vector3d T, int FrameID)
  */
 void FuseXfl::translate(const Vector3d &T)
 {
+    bool bShapesUpToDate = m_ShapeKey!=0 && m_ShapeKey==shapeKey();
+
     Fuse::translate(T);
     for (int i=0; i<frameCount(); i++)
     {
@@ -967,6 +1080,8 @@ void FuseXfl::translate(const Vector3d &T)
     occ::translateShapes(m_Shape, T);
     occ::translateShapes(m_Shell, T);
     occ::translateShapes(m_RightSideShell, T);
+    // the shapes have moved with the frames
+    m_ShapeKey = bShapesUpToDate ? shapeKey() : 0;
     translateTriPanels(T.x, T.y, T.z);
 }
 
@@ -1421,31 +1536,27 @@ int FuseXfl::makeSurfaceTriangulation(int axialres, int hoopres)
 
 void FuseXfl::makeSplineTriangulation(int nx, int nh)
 {
-    Vector3d S00, S01, S10, S11;
+    // evaluate the grid of nodes in one pass, on the left side
+    std::vector<double> u(nx+1), v(nh+1);
+    for(int k=0; k<=nx; k++) u[k] = double(k)/double(nx);
+    for(int l=0; l<=nh; l++) v[l] = double(l)/double(nh);
+    std::vector<Vector3d> grid;
+    getGrid(u, v, false, grid);
 
     // make the left side
     for (int k=0; k<nx; k++)
     {
-        double uk  = double(k)   /double(nx);
-        double uk1 = double(k+1) /double(nx);
-
-        double vl=0.0;
-        getPoint(uk,  vl, false, S00);
-        getPoint(uk1, vl, false, S10);
-
         for (int l=0; l<nh; l++)
         {
-            double vl1 = double(l+1) / double(nh);
-            getPoint(uk,  vl1, false, S01);
-            getPoint(uk1, vl1, false, S11);
+            Vector3d const &S00 = grid.at( k   *(nh+1)+l);
+            Vector3d const &S10 = grid.at((k+1)*(nh+1)+l);
+            Vector3d const &S01 = grid.at( k   *(nh+1)+l+1);
+            Vector3d const &S11 = grid.at((k+1)*(nh+1)+l+1);
 
             if(!S00.isSame(S01) && !S01.isSame(S11) && !S11.isSame(S00))
                 m_Triangulation.appendTriangle(Triangle3d(S00, S01, S11));
             if(!S00.isSame(S11) && !S11.isSame(S10) && !S10.isSame(S00))
                 m_Triangulation.appendTriangle(Triangle3d(S00, S11, S10));
-            S00 = S01;
-            S10 = S11;
-//            vl = vl1;
         }
     }
 
@@ -1988,6 +2099,8 @@ void FuseXfl::appendRightSideShell(const TopoDS_Shell &rightsideshell)
 
     LeftBodyShell = TopoDS::Shell(trfSym.Shape());
     m_Shell.Append(LeftBodyShell);
+
+    m_ShapeKey = 0; // the shells no longer match the shapes
 }
 
 
@@ -2014,25 +2127,21 @@ void FuseXfl::toFlatType(std::vector<double> const &fracpos, int nh)
     newnurbs.setFrameCount(nx);
     newnurbs.setFramePointCount(nh+1);
 
-    Vector3d Pt;
+    std::vector<double> v(nh+1);
+    for (int k=0; k<=nh; k++) v[k] = double(k)/double(nh);
+    std::vector<Vector3d> grid;
+    m_nurbs.getGrid(fracpos, v, grid);
 
     for (int i=0; i<nx; i++)
     {
         Frame &pFrame = newnurbs.frame(i);
 
-//        double u  = double(i)/double(nx);
-        double u = fracpos.at(i);
-        m_nurbs.getPoint(u,  0,  Pt);
-
-        pFrame.setXPosition(Pt.x);
+        pFrame.setXPosition(grid.at(i*(nh+1)).x);
         pFrame.setZPosition(0.0);
 
         for (int k=0; k<=nh; k++)
         {
-            double v = double(k)/double(nh);
-            m_nurbs.getPoint(u, v, Pt);
-
-            pFrame.setCtrlPoint(k, Pt);
+            pFrame.setCtrlPoint(k, grid.at(i*(nh+1)+k));
         }
     }
     m_nurbs.copy(newnurbs);
@@ -27,6 +27,7 @@
 #include <QDebug>
 
 #include <planexfl.h>
+#include <memorybudget.h>
 #include <fusenurbs.h>
 #include <fuseflatfaces.h>
 #include <fusesections.h>
@@ -43,6 +44,7 @@
 #include <units.h>
 #include <utils.h>
 #include <constants.h>
+#include <threadpool.h>
 
 
 
@@ -363,12 +365,20 @@ void PlaneXfl::createWingSideNodes()
         pTranslatedFuse->translate(fusePos(0));
     }
 
+    // the surfaces whose side nodes need to be rebuilt are independent, and are made concurrently
+    std::vector<std::pair<int,int>> rebuild;
+    std::vector<int> surfaces;
     for(int iw=0; iw<nWings(); iw++)
     {
-        WingXfl *pWing = wing(iw);
-        for (int j=0; j<pWing->nSurfaces(); j++)
-            pWing->surface(j).makeSideNodes(pTranslatedFuse);
+        wing(iw)->reuseSideNodes(pTranslatedFuse, surfaces);
+        for(int j : surfaces) rebuild.push_back({iw, j});
     }
+
+    ThreadPool::pool().parallelFor(int(rebuild.size()), [this, &rebuild, pTranslatedFuse](int i)
+    {
+        wing(rebuild.at(i).first)->surface(rebuild.at(i).second).makeSideNodes(pTranslatedFuse);
+    });
+
     if(pTranslatedFuse) delete pTranslatedFuse;
 }
 
@@ -2349,3 +2359,10 @@ void PlaneXfl::setFlaps(PlanePolar const *pWPolar, std::string &outstr)
 }
 
 
+size_t PlaneXfl::memoryFootprint() const
+{
+    size_t n = Plane::memoryFootprint() + m_RefQuadMesh.memoryFootprint() + m_QuadMesh.memoryFootprint();
+    for(WingXfl const &wing : m_Wing) n += sizeof(WingXfl) + wing.memoryFootprint();
+    for(Fuse const *pFuse : m_Fuse)   n += pFuse->memoryFootprint();
+    return n;
+}
@@ -41,6 +41,8 @@
 
 #include <geom_global.h>
 #include <quaternion.h>
+#include <segment3d.h>
+#include <threadpool.h>
 #include <vector3d.h>
 
 #include <bspline3d.h>
@@ -53,6 +55,7 @@ std::vector<Vector3d> Surface::s_DebugVecs;
 Surface::Surface()
 {
     m_Index = -1;
+    m_SideNodeKey = 0;
 
     m_bTEFlap = false;
 
@@ -174,6 +177,7 @@ void Surface::copy(Surface const &aSurface)
     m_SideB_Top = aSurface.m_SideB_Top;
     m_SideA_Bot = aSurface.m_SideA_Bot;
     m_SideB_Bot = aSurface.m_SideB_Bot;
+    m_SideNodeKey = aSurface.m_SideNodeKey;
 
     m_FirstStripPanelIndex = aSurface.m_FirstStripPanelIndex;
     m_LastStripPanelIndex  = aSurface.m_LastStripPanelIndex;
@@ -831,6 +835,8 @@ void Surface::makeSideNodes(Fuse const*pTranslatedFuse, bool bDebug)
     if(sindA<-1.0) sindA = -1.0;
     tmp_alpha_dA = asin(sindA);
 
+    m_SideNodeKey = sideNodeKey(pTranslatedFuse);
+
     V = m_Normal * m_NormalB;
     U = (m_TB-m_LB).normalized();
     double sindB = -V.dot(U);
@@ -850,28 +856,35 @@ void Surface::makeSideNodes(Fuse const*pTranslatedFuse, bool bDebug)
 
     if(bMultihread)
     {
-        std::vector<std::thread> threads;
-        for (int l=0; l<=m_NXPanels; l++)
+        ThreadPool::pool().parallelFor(m_NXPanels+1, [this](int l)
         {
-
-//            futureSync.addFuture(QtConcurrent::run(&Surface::makeSideNodeTask, this, l, pTranslatedFuse, m_xPointA.at(l), m_xPointB.at(l)));
-            threads.push_back(std::thread(&Surface::makeSideNodeTask, this, l, pTranslatedFuse, m_xPointA.at(l), m_xPointB.at(l)));
-
-        }
-
+            makeSideNodeTask(l, m_xPointA.at(l), m_xPointB.at(l));
+        });
+    }
+    else
+    {
         for (int l=0; l<=m_NXPanels; l++)
         {
-            threads[l].join();
+            makeSideNodeTask(l, m_xPointA.at(l), m_xPointB.at(l));
         }
-//        std::cout << "makeSideNodes joined all " << m_NXPanels << "threads" <<std::endl;
     }
-    else
+
+    intersectSideNodes(pTranslatedFuse);
+
+    // force nodes into the xz symmetry plane to compensate for construction errors
+    for (int l=0; l<=m_NXPanels; l++)
     {
-        for (int l=0; l<=m_NXPanels; l++)
+        if(l==0 || l==m_NXPanels+1)
         {
-            makeSideNodeTask(l, pTranslatedFuse, m_xPointA.at(l), m_xPointB.at(l));
+            if(fabs(m_SideA[l].y)    <SYMMETRYPRECISION) m_SideA[l].y     = 0.0;
+            if(fabs(m_SideA_Top[l].y)<SYMMETRYPRECISION) m_SideA_Top[l].y = 0.0;
+            if(fabs(m_SideA_Bot[l].y)<SYMMETRYPRECISION) m_SideA_Bot[l].y = 0.0;
+            if(fabs(m_SideB[l].y)    <SYMMETRYPRECISION) m_SideB[l].y     = 0.0;
+            if(fabs(m_SideB_Top[l].y)<SYMMETRYPRECISION) m_SideB_Top[l].y = 0.0;
+            if(fabs(m_SideB_Bot[l].y)<SYMMETRYPRECISION) m_SideB_Bot[l].y = 0.0;
         }
     }
+
     if(bDebug)
     {
         auto t1 = std::chrono::high_resolution_clock::now();
@@ -899,9 +912,84 @@ void Surface::makeSideNodes(Fuse const*pTranslatedFuse, bool bDebug)
 }
 
 
-void Surface::makeSideNodeTask(int l, Fuse const *pTranslatedFuse, double xRelA, double xRelB)
+/**
+ * Returns a FNV-1a key of the data which defines the side nodes: the corner points, the normals and the twist,
+ * the chordwise distributions and the geometry of the two foils.
+ * The center surfaces which are intersected with a fuse depend also on the fuse's geometry; their key is 0
+ * so that they are always rebuilt.
+ */
+std::uint64_t Surface::sideNodeKey(Fuse const *pTranslatedFuse) const
+{
+    if(pTranslatedFuse && m_bIsCenterSurf && (m_bIsLeftSurf || m_bIsRightSurf)) return 0;
+
+    std::uint64_t key = 14695981039346656037ULL;
+    auto hashBytes = [&key](void const *data, size_t size)
+    {
+        unsigned char const *bytes = static_cast<unsigned char const*>(data);
+        for(size_t i=0; i<size; i++)
+        {
+            key ^= bytes[i];
+            key *= 1099511628211ULL;
+        }
+    };
+
+    double geom[] = {m_LA.x, m_LA.y, m_LA.z, m_LB.x, m_LB.y, m_LB.z, m_TA.x, m_TA.y, m_TA.z, m_TB.x, m_TB.y, m_TB.z,
+                     m_Normal.x, m_Normal.y, m_Normal.z, m_NormalA.x, m_NormalA.y, m_NormalA.z, m_NormalB.x, m_NormalB.y, m_NormalB.z,
+                     m_TwistA, m_TwistB};
+    hashBytes(geom, sizeof(geom));
+    int props[] = {m_NXPanels, int(m_xPointA.size()), int(m_xPointB.size())};
+    hashBytes(props, sizeof(props));
+    if(m_xPointA.size()) hashBytes(m_xPointA.data(), m_xPointA.size()*sizeof(double));
+    if(m_xPointB.size()) hashBytes(m_xPointB.data(), m_xPointB.size()*sizeof(double));
+
+    for(Foil const *pFoil : {foilA(), foilB()})
+    {
+        if(!pFoil)
+        {
+            int none = -1;
+            hashBytes(&none, sizeof(none));
+            continue;
+        }
+        int n = pFoil->nNodes();
+        hashBytes(&n, sizeof(n));
+        for(int k=0; k<n; k++)
+        {
+            double xy[] = {pFoil->x(k), pFoil->y(k)};
+            hashBytes(xy, sizeof(xy));
+        }
+        double flap[] = {pFoil->hasTEFlap() ? 1.0 : 0.0, pFoil->TEXHinge(), pFoil->TEFlapAngle()};
+        hashBytes(flap, sizeof(flap));
+    }
+
+    return key==0 ? 1 : key;
+}
+
+
+/**
+ * Copies the side nodes of a surface made previously, if they were made from the same data.
+ * @return true if the side nodes have been copied, false if they need to be rebuilt with makeSideNodes()
+ */
+bool Surface::reuseSideNodes(Surface const &surf, Fuse const *pTranslatedFuse)
+{
+    if(surf.m_SideNodeKey==0) return false;
+    std::uint64_t key = sideNodeKey(pTranslatedFuse);
+    if(key!=surf.m_SideNodeKey) return false;
+
+    m_SideA     = surf.m_SideA;
+    m_SideB     = surf.m_SideB;
+    m_SideA_Top = surf.m_SideA_Top;
+    m_SideB_Top = surf.m_SideB_Top;
+    m_SideA_Bot = surf.m_SideA_Bot;
+    m_SideB_Bot = surf.m_SideB_Bot;
+    tmp_alpha_dA = surf.tmp_alpha_dA;
+    tmp_alpha_dB = surf.tmp_alpha_dB;
+    m_SideNodeKey = key;
+    return true;
+}
+
+
+void Surface::makeSideNodeTask(int l, double xRelA, double xRelB)
 {
-    Vector3d I;
     double cosdA = cos(tmp_alpha_dA);
     double alpha_dA = tmp_alpha_dA * 180.0/PI;
     double cosdB = cos(tmp_alpha_dB);
@@ -966,78 +1054,61 @@ void Surface::makeSideNodeTask(int l, Fuse const *pTranslatedFuse, double xRelA,
     m_SideB[l].rotate(m_LB, axis, alpha_dB);
     m_SideB_Top[l].rotate(m_LB, axis, alpha_dB);
     m_SideB_Bot[l].rotate(m_LB, axis, alpha_dB);
+}
+
 
-    if(pTranslatedFuse && m_bIsCenterSurf && m_bIsLeftSurf)
+/**
+ * Moves the side nodes of a center surface to their intersection with the fuse.
+ * The mid, top and bottom chords of all the stations are intersected together in one batch.
+ */
+void Surface::intersectSideNodes(Fuse const *pTranslatedFuse)
+{
+    if(!pTranslatedFuse || !m_bIsCenterSurf) return;
+    if(!m_bIsLeftSurf && !m_bIsRightSurf) return;
+
+    // the segments are oriented from the side away from the fuse
+    int n = m_NXPanels+1;
+    std::vector<Segment3d> segs(3*n);
+    for (int l=0; l<n; l++)
     {
-        if(pTranslatedFuse->intersectFuse(m_SideA.at(l),     m_SideB.at(l),     I, false))
+        if(m_bIsLeftSurf)
         {
-            double d0 = I.distanceTo(m_SideA.at(l));
-            double d1 = m_SideB.at(l).distanceTo(m_SideA.at(l));
-            if(d0<d1)
-            {
-                m_SideB[l] = I;
-                m_bJoinRight = false;
-            }
+            segs[3*l  ].setNodes(m_SideA.at(l),     m_SideB.at(l));
+            segs[3*l+1].setNodes(m_SideA_Bot.at(l), m_SideB_Bot.at(l));
+            segs[3*l+2].setNodes(m_SideA_Top.at(l), m_SideB_Top.at(l));
         }
-        if(pTranslatedFuse->intersectFuse(m_SideA_Bot.at(l), m_SideB_Bot.at(l), I, false))
-        {
-            double d0 = I.distanceTo(m_SideA_Bot.at(l));
-            double d1 = m_SideB_Bot.at(l).distanceTo(m_SideA_Bot.at(l));
-            if(d0<d1)
-            {
-                m_SideB_Bot[l] = I;
-                m_bJoinRight = false;
-            }
-        }
-        if(pTranslatedFuse->intersectFuse(m_SideA_Top.at(l), m_SideB_Top.at(l), I, false))
+        else
         {
-            double d0 = I.distanceTo(m_SideA_Top.at(l));
-            double d1 = m_SideB_Top.at(l).distanceTo(m_SideA_Top.at(l));
-            if(d0<d1)
-             {
-                m_SideB_Top[l] = I;
-                m_bJoinRight = false;
-            }
+            segs[3*l  ].setNodes(m_SideB.at(l),     m_SideA.at(l));
+            segs[3*l+1].setNodes(m_SideB_Bot.at(l), m_SideA_Bot.at(l));
+            segs[3*l+2].setNodes(m_SideB_Top.at(l), m_SideA_Top.at(l));
         }
     }
-    else if(pTranslatedFuse && m_bIsCenterSurf && m_bIsRightSurf)
+
+    std::vector<Vector3d> I;
+    std::vector<bool> bIntersect;
+    pTranslatedFuse->intersectFuse(segs, I, bIntersect, !m_bIsLeftSurf);
+
+    for (int l=0; l<n; l++)
     {
-        if(pTranslatedFuse->intersectFuse(m_SideB.at(l),     m_SideA.at(l),     I, true))
-        {
-//                if(sqrt(I.y*I.y+I.z*I.z)>sqrt(m_SideA.at(l).y*m_SideA.at(l).y+m_SideA.at(l).z*m_SideA.at(l).z))
-            if(I.distanceTo(m_SideB.at(l))<m_SideA.at(l).distanceTo(m_SideB.at(l)))
-            {
-                m_SideA[l]=I;
-            }
-        }
-        if(pTranslatedFuse->intersectFuse(m_SideB_Bot.at(l), m_SideA_Bot.at(l), I, true))
+        Node *side[] = {&m_SideB[l], &m_SideB_Bot[l], &m_SideB_Top[l]};
+        if(!m_bIsLeftSurf)
         {
-//                if(sqrt(I.y*I.y+I.z*I.z)>sqrt(m_SideA_Bot.at(l).y*m_SideA_Bot.at(l).y+m_SideA_Bot.at(l).z*m_SideA_Bot.at(l).z))
-            if(I.distanceTo(m_SideB_Bot.at(l))<m_SideA_Bot.at(l).distanceTo(m_SideB_Bot.at(l)))
-            {
-                m_SideA_Bot[l]=I;
-            }
+            side[0] = &m_SideA[l];
+            side[1] = &m_SideA_Bot[l];
+            side[2] = &m_SideA_Top[l];
         }
-        if(pTranslatedFuse->intersectFuse(m_SideB_Top.at(l), m_SideA_Top.at(l), I, true))
+        for(int k=0; k<3; k++)
         {
-//                if(sqrt(I.y*I.y+I.z*I.z)>sqrt(m_SideA_Top.at(l).y*m_SideA_Top.at(l).y+m_SideA_Top.at(l).z*m_SideA_Top.at(l).z))
-            if(I.distanceTo(m_SideB_Top.at(l))<m_SideA_Top.at(l).distanceTo(m_SideB_Top.at(l)))
+            Segment3d const &seg = segs.at(3*l+k);
+            if(!bIntersect.at(3*l+k)) continue;
+            if(I.at(3*l+k).distanceTo(seg.vertexAt(0))<seg.length())
             {
-                m_SideA_Top[l]=I;
+                *side[k] = I.at(3*l+k);
+                if(m_bIsLeftSurf) m_bJoinRight = false;
             }
         }
     }
-
-    // force nodes into the xz symmetry plane to compensate for construction errors
-    if(l==0 || l==m_NXPanels+1)
-    {
-        if(fabs(m_SideA[l].y)    <SYMMETRYPRECISION) m_SideA[l].y     = 0.0;
-        if(fabs(m_SideA_Top[l].y)<SYMMETRYPRECISION) m_SideA_Top[l].y = 0.0;
-        if(fabs(m_SideA_Bot[l].y)<SYMMETRYPRECISION) m_SideA_Bot[l].y = 0.0;
-        if(fabs(m_SideB[l].y)    <SYMMETRYPRECISION) m_SideB[l].y     = 0.0;
-        if(fabs(m_SideB_Top[l].y)<SYMMETRYPRECISION) m_SideB_Top[l].y = 0.0;
-        if(fabs(m_SideB_Bot[l].y)<SYMMETRYPRECISION) m_SideB_Bot[l].y = 0.0;
-    }
 }
 
 
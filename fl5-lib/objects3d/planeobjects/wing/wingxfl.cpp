@@ -190,6 +190,29 @@ void WingXfl::computeGeometry()
 }
 
 
+/**
+ * Copies the side nodes of the surfaces which are unchanged since the previous call to createSurfaces(),
+ * e.g. when only another wing or another section of this wing has been modified. The previous surfaces
+ * are matched on their keys, so that the surfaces which have only been renumbered are also reused.
+ * @param rebuild the indexes of the surfaces whose side nodes must be made with Surface::makeSideNodes()
+ */
+void WingXfl::reuseSideNodes(Fuse const *pTranslatedFuse, std::vector<int> &rebuild)
+{
+    rebuild.clear();
+    for(int jSurf=0; jSurf<nSurfaces(); jSurf++)
+    {
+        Surface &surf = m_Surface[jSurf];
+        bool bReused = false;
+        for(uint jPrev=0; jPrev<m_PreviousSurface.size() && !bReused; jPrev++)
+        {
+            bReused = surf.reuseSideNodes(m_PreviousSurface.at(jPrev), pTranslatedFuse);
+        }
+        if(!bReused) rebuild.push_back(jSurf);
+    }
+    m_PreviousSurface.clear();
+}
+
+
 int WingXfl::makeTriPanels(int ip3start, int indStart, bool bThickSurfaces)
 {
     m_StripStartNodes.clear();
@@ -435,6 +458,8 @@ void WingXfl::createSurfaces(Vector3d const &Toffset, double XTilt, double YTilt
         }
     }
 
+    // keep the previous surfaces, so that the side nodes of the unchanged surfaces can be reused
+    m_PreviousSurface.swap(m_Surface);
     clearSurfaces(); // to make sure that all the data is reset
     if(m_bTwoSided) m_Surface.resize(2*nSurf);
     else            m_Surface.resize(nSurf);
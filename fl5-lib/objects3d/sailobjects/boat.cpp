@@ -37,6 +37,7 @@
 #include <sailstl.h>
 #include <boatpolar.h>
 #include <boatopp.h>
+#include <threadpool.h>
 #include <fuse.h>
 #include <fuseocc.h>
 #include <fusestl.h>
@@ -103,17 +104,18 @@ Boat::~Boat()
 /** Makes the reference triangular mesh, with sails in their rest position */
 void Boat::makeRefTriMesh(bool bIncludeHull, bool bMultiThread)
 {
-    (void)bMultiThread;
-
     m_RefTriMesh.clearMesh();
 
+    // each sail is triangulated in its own mesh, so that the sails can be meshed concurrently
+    auto makeSailPanels = [this](int is) {m_Sail[is]->makeTriPanels(m_Sail[is]->m_LE);};
+    if(bMultiThread) ThreadPool::pool().parallelFor(nSails(), makeSailPanels);
+    else             for(int is=0; is<nSails(); is++) makeSailPanels(is);
+
     int p0=0;
     for(int is=0; is<nSails(); is++)
     {
         Sail *pSail = m_Sail[is];
 
-        pSail->makeTriPanels(pSail->m_LE);
-
         m_RefTriMesh.appendMesh(pSail->triMesh());
         pSail->setFirstPanel3Index(p0);
         p0 += pSail->nPanel3();
@@ -140,21 +142,33 @@ void Boat::makeRefTriMesh(bool bIncludeHull, bool bMultiThread)
 
     if(bIncludeHull)
     {
+        // the index ranges of the hulls are set first, so that the hulls, whose panel frames are rebuilt,
+        // can be copied concurrently
+        int np = m_RefTriMesh.nPanels();
+        int nn = m_RefTriMesh.nNodes();
         for(int ihull=0; ihull<nHulls(); ihull++)
         {
             Fuse *pFuse = m_Hull.at(ihull);
             if(!pFuse) continue;
+            pFuse->setFirstPanel3Index(np);
+            pFuse->setFirstNodeIndex(nn);
+            np += pFuse->nPanel3();
+            nn += pFuse->panel3NodeCount();
+        }
+        // global resize faster than pushing the panels one by one
+        m_RefTriMesh.panels().resize(np);
+        m_RefTriMesh.nodes().resize(nn);
 
-            pFuse->setFirstPanel3Index(m_RefTriMesh.nPanels());
-            pFuse->setFirstNodeIndex(m_RefTriMesh.nNodes());
+        auto copyHull = [this](int ihull)
+        {
+            Fuse *pFuse = m_Hull.at(ihull);
+            if(!pFuse) return;
 
-            int p3index = m_RefTriMesh.nPanels();
-            // global resize faster than pushing the panels one by one
-            m_RefTriMesh.panels().resize(m_RefTriMesh.nPanels()+pFuse->nPanel3());
+            int p3index = pFuse->firstPanel3Index();
 
             // set the panel and nodes one by one with new indexes and positions
             Node S[3];
-            int n0 = m_RefTriMesh.nNodes();
+            int n0 = pFuse->firstNodeIndex();
             for(int i3=0; i3<pFuse->nPanel3(); i3++)
             {
                 Panel3 const &pf3 = pFuse->panel3At(i3);
@@ -175,8 +189,6 @@ void Boat::makeRefTriMesh(bool bIncludeHull, bool bMultiThread)
             }
 
             int ndindex = n0;
-            m_RefTriMesh.nodes().resize(m_RefTriMesh.nNodes()+pFuse->nodes().size());
-
             for(int in=0; in<pFuse->panel3NodeCount(); in++)
             {
                 m_RefTriMesh.setNode(ndindex, pFuse->panel3Node(in));
@@ -184,7 +196,9 @@ void Boat::makeRefTriMesh(bool bIncludeHull, bool bMultiThread)
                 m_RefTriMesh.node(ndindex).setIndex(ndindex);
                 ndindex++;
             }
-        }
+        };
+        if(bMultiThread) ThreadPool::pool().parallelFor(nHulls(), copyHull);
+        else             for(int ihull=0; ihull<nHulls(); ihull++) copyHull(ihull);
     }
 
     m_RefTriMesh.setNodePanels();
@@ -193,12 +207,13 @@ void Boat::makeRefTriMesh(bool bIncludeHull, bool bMultiThread)
 
 void Boat::makeConnections()
 {
-    for(int is=0; is<nSails(); is++)
+    // each sail is connected within its own index range, so that the sails can be connected concurrently
+    ThreadPool::pool().parallelFor(nSails(), [this](int is)
     {
         Sail const*pSail = m_Sail[is];
         m_RefTriMesh.makeConnectionsFromNodePosition2(pSail->firstPanel3Index(), pSail->nPanel3(), 0.0001);
 //        m_RefTriMesh.makeConnectionsFromNodeIndexes(pSail->firstPanel3Index(), pSail->nPanel3(), pSail->firstPanel3Index(), pSail->nPanel3());
-    }
+    });
 }
 
 
@@ -811,45 +826,50 @@ std::string Boat::properties(bool bFull) const
 void Boat::rotateMesh(BoatPolar const*pBtPolar, double phi, double Ry, double ctrl, std::vector<Panel3> &panels) const
 {
     if(!pBtPolar) return;
+    if(!pBtPolar->isTriangleMethod()) return;
+
+    // The sails are rotated around their leading edges, then all the panels around the Y axis by Ry,
+    // then around the X axis by the bank angle. The rotations of each part are composed into
+    // one transform S -> T + Qt(S-O), so that each panel's frame is rebuilt once.
+    if(fabs(Ry) <=ANGLEPRECISION) Ry  = 0.0;
+    if(fabs(phi)<=ANGLEPRECISION) phi = 0.0;
+    Quaternion const QtBoat = Quaternion(phi, Vector3d(1.0,0.0,0.0)) * Quaternion(Ry, Vector3d(0.0,1.0,0.0));
+
+    std::vector<Quaternion> Qt(nSails()+1, QtBoat); // the last is the hull's
+    std::vector<Vector3d> O(nSails()+1), T(nSails()+1);
+    std::vector<int> part(panels.size(), nSails());
+    bool bRotateHull = fabs(Ry)>0.0 || fabs(phi)>0.0;
+    bool bRotate = bRotateHull;
 
-    //rotate the sails around their leading edges
     for(int is=0; is<nSails(); is++)
     {
         Sail const*pSail = sailAt(is);
-        Vector3d axis = pSail->leadingEdgeAxis().normalized();
-        Vector3d tack = pSail->position() + pSail->tack();
-
         double angle = pBtPolar->sailAngle(is, ctrl);
-        if(fabs(angle)>ANGLEPRECISION)
-        {
-            if(pBtPolar->isTriangleMethod())
-            {
-                for(int ip=pSail->firstPanel3Index(); ip<pSail->firstPanel3Index()+pSail->nPanel3(); ip++)
-                {
-                    panels[ip].rotate(tack, axis, angle);
-                }
-            }
-        }
-    }
+        if(fabs(angle)<=ANGLEPRECISION) continue;
 
-    //apply the rotation angle around the Y axis
-    if(pBtPolar->isTriangleMethod())
+        Vector3d axis = pSail->leadingEdgeAxis().normalized();
+        O[is] = pSail->position() + pSail->tack();
+        QtBoat.conjugate(O[is], T[is]);
+        Qt[is] = QtBoat * Quaternion(angle, axis);
+        for(int ip=pSail->firstPanel3Index(); ip<pSail->firstPanel3Index()+pSail->nPanel3(); ip++)
+            part[ip] = is;
+        bRotate = true;
+    }
+    if(!bRotate) return;
+
+    int nPanel3 = int(panels.size());
+    int nBlocks = std::min(ThreadPool::nBlocks(ThreadPool::maxThreadCount()), std::max(1, nPanel3/1000));
+    int blockSize = nPanel3/nBlocks + 1;
+    ThreadPool::pool().parallelFor(nBlocks, [&panels, &part, &Qt, &O, &T, bRotateHull, nPanel3, blockSize](int iBlock)
     {
-        Vector3d O(0.0,0.0,0.0);
-        if(fabs(Ry)>ANGLEPRECISION)
-        {
-            for(uint i3=0; i3<panels.size(); i3++)
-                panels[i3].rotate(O,Vector3d(0.0,1.0,0.0), Ry);
-        }
-
-        //apply the bank angle
-
-        if(fabs(phi)>ANGLEPRECISION)
+        int iMax = std::min((iBlock+1)*blockSize, nPanel3);
+        for(int i3=iBlock*blockSize; i3<iMax; i3++)
         {
-            for(uint i3=0; i3<panels.size(); i3++)
-                panels[i3].rotate(O,Vector3d(1.0,0.0,0.0), phi);
+            int ip = part[i3];
+            if(ip==int(Qt.size())-1 && !bRotateHull) continue;
+            panels[i3].transform(Qt[ip], O[ip], T[ip]);
         }
-    }
+    });
 }
 
 
@@ -30,50 +30,99 @@
 #include <boatpolar.h>
 #include <boatopp.h>
 
-std::vector<Boat*> SailObjects::s_oaBoat;
-std::vector<BoatPolar*> SailObjects::s_oaBtPolar;
-std::vector<BoatOpp*> SailObjects::s_oaBtOpp;
-
-BoatOpp *SailObjects::s_pLastBtOpp = nullptr;
 
 int SailObjects::s_SailDarkFactor=105;
 
 
+/** The parent key of the boats in the name index */
+static std::string const s_NoParent;
+
+
+static void buildBoatIndex(NameIndex<std::string, Boat> &index)
+{
+    for(Boat *pBoat : SailObjects::boats()) index.add(s_NoParent, pBoat->nameRef(), pBoat);
+}
+
+
+static void buildBtPolarIndex(NameIndex<std::string, BoatPolar> &index)
+{
+    for(BoatPolar *pBtPolar : SailObjects::boatPolars()) index.add(pBtPolar->boatName(), pBtPolar->nameRef(), pBtPolar);
+}
+
+
+/** The operating points are keyed by their polar; their names are computed once for each build of the index */
+static void buildBtOppIndex(NameIndex<BoatPolar const*, BoatOpp> &index)
+{
+    // the polars are indexed locally, since the builder may not use the store's indexes
+    NameIndex<std::string, BoatPolar> polars;
+    buildBtPolarIndex(polars);
+    for(BoatOpp *pBtOpp : SailObjects::boatOpps())
+    {
+        BoatPolar const *pBtPolar = polars.find(pBtOpp->boatName(), pBtOpp->polarName());
+        if(pBtPolar) index.add(pBtPolar, pBtOpp->name(), pBtOpp);
+    }
+}
+
+
+/** Clears the name indexes; to be called each time the arrays of boats, polars or operating points, or the names of their objects, are modified */
+void SailObjects::invalidateIndex()
+{
+    ObjectStore &s = store();
+    std::unique_lock<std::shared_mutex> lock(s.m_NameIndexMutex);
+    s.m_BoatIndex.clear();
+    s.m_BtPolarIndex.clear();
+    s.m_BtOppIndex.clear();
+}
+
+
+
+/** The memory used by the boats, the boat polars and the operating points, in bytes */
+size_t SailObjects::memoryFootprint()
+{
+    size_t n = 0;
+    for(Boat const *pBoat : store().m_oaBoat)           n += pBoat->memoryFootprint();
+    for(BoatPolar const *pBtPolar : store().m_oaBtPolar) n += pBtPolar->memoryFootprint();
+    for(BoatOpp const *pBtOpp : store().m_oaBtOpp)      n += pBtOpp->memoryFootprint();
+    return n;
+}
+
 
 void SailObjects::deleteObjects()
 {
+    invalidateIndex();
     for(int i=0; i<nBoats(); i++)
     {
-        delete s_oaBoat[i];
+        delete store().m_oaBoat[i];
     }
-    s_oaBoat.clear();
+    store().m_oaBoat.clear();
 
     for(int i=0; i<nBtPolars(); i++)
     {
-        delete s_oaBtPolar[i];
+        delete store().m_oaBtPolar[i];
     }
-    s_oaBtPolar.clear();
+    store().m_oaBtPolar.clear();
 
     for(int i=0; i<nBtOpps(); i++)
     {
-        delete s_oaBtOpp[i];
+        delete store().m_oaBtOpp[i];
     }
-    s_oaBtOpp.clear();
+    store().m_oaBtOpp.clear();
 }
 
 
 void SailObjects::deleteBoat(Boat *pBoat, bool bDeleteBtPolars)
 {
+    invalidateIndex();
     if(!pBoat) return;
 
     if(bDeleteBtPolars) deleteBtPolars(pBoat);
 
     for(int i=0; i<nBoats(); i++)
     {
-        if(s_oaBoat.at(i)==pBoat)
+        if(store().m_oaBoat.at(i)==pBoat)
         {
             delete pBoat;
-            s_oaBoat.erase(s_oaBoat.begin()+i);
+            store().m_oaBoat.erase(store().m_oaBoat.begin()+i);
             return;
         }
     }
@@ -84,7 +133,7 @@ void SailObjects::deleteBtPolars(Boat *pBoat)
     if(!pBoat) return;
     for(int i=nBtPolars()-1; i>=0; i--)
     {
-        BoatPolar *pBtPlr = s_oaBtPolar.at(i);
+        BoatPolar *pBtPlr = store().m_oaBtPolar.at(i);
         if(pBtPlr->boatName()==pBoat->name())
         {
             deleteBtPolar(pBtPlr);
@@ -95,13 +144,14 @@ void SailObjects::deleteBtPolars(Boat *pBoat)
 
 void SailObjects::deleteBtPolar(BoatPolar *pBtPolar)
 {
+    invalidateIndex();
     deleteBtPolarOpps(pBtPolar);
     for(int i=0; i<nBtPolars(); i++)
     {
-        if(s_oaBtPolar.at(i) == pBtPolar)
+        if(store().m_oaBtPolar.at(i) == pBtPolar)
         {
             delete pBtPolar;
-            s_oaBtPolar.erase(s_oaBtPolar.begin()+i);
+            store().m_oaBtPolar.erase(store().m_oaBtPolar.begin()+i);
             return;
         }
     }
@@ -110,45 +160,50 @@ void SailObjects::deleteBtPolar(BoatPolar *pBtPolar)
 /** @todo do not expose, does not free */
 void SailObjects::removeBoatAt(int idx)
 {
+    invalidateIndex();
     if(idx>=0 && idx<nBoats())
-    s_oaBoat.erase(s_oaBoat.begin()+idx);
+    store().m_oaBoat.erase(store().m_oaBoat.begin()+idx);
 }
 
 
 void SailObjects::removeBtPolarAt(int idx)
 {
+    invalidateIndex();
     if(idx>=0 && idx<nBtPolars())
-    s_oaBtPolar.erase(s_oaBtPolar.begin()+idx);
+    store().m_oaBtPolar.erase(store().m_oaBtPolar.begin()+idx);
 }
 
 
 void SailObjects::removeBtOppAt(int idx)
 {
+    invalidateIndex();
     if(idx>=0 && idx<nBtOpps())
-    s_oaBtOpp.erase(s_oaBtOpp.begin()+idx);
+    store().m_oaBtOpp.erase(store().m_oaBtOpp.begin()+idx);
 }
 
 
 void SailObjects::deleteAllBtOpps()
 {
+    invalidateIndex();
     for(int i=0; i<nBtOpps(); i++)
     {
-        delete s_oaBtOpp.at(i);
+        delete store().m_oaBtOpp.at(i);
     }
-    s_oaBtOpp.clear();
+    store().m_oaBtOpp.clear();
 }
 
 
 void SailObjects::deleteBoatBtOpps(Boat *pBoat)
 {
+    invalidateIndex();
     if(!pBoat) return;
     for(int i=nBtOpps()-1; i>=0; i--)
     {
-        BoatOpp *pBtOpp = s_oaBtOpp.at(i);
+        BoatOpp *pBtOpp = store().m_oaBtOpp.at(i);
         if(pBtOpp->boatName()==pBoat->name())
         {
             delete pBtOpp;
-            s_oaBtOpp.erase(s_oaBtOpp.begin()+i);
+            store().m_oaBtOpp.erase(store().m_oaBtOpp.begin()+i);
         }
     }
 }
@@ -156,14 +211,15 @@ void SailObjects::deleteBoatBtOpps(Boat *pBoat)
 
 void SailObjects::deleteBtPolarOpps(BoatPolar *pBtPolar)
 {
+    invalidateIndex();
     if(!pBtPolar) return;
     for(int i=nBtOpps()-1; i>=0; i--)
     {
-        BoatOpp *pBtOpp = s_oaBtOpp.at(i);
+        BoatOpp *pBtOpp = store().m_oaBtOpp.at(i);
         if(pBtOpp->boatName()==pBtPolar->boatName() && pBtOpp->polarName()==pBtPolar->name())
         {
             delete pBtOpp;
-            s_oaBtOpp.erase(s_oaBtOpp.begin()+i);
+            store().m_oaBtOpp.erase(store().m_oaBtOpp.begin()+i);
         }
     }
 }
@@ -177,7 +233,7 @@ void SailObjects::setBoatStyle(Boat *pBoat, LineStyle const &ls, bool bStyle, bo
     BoatOpp *pLastBOpp = nullptr;
     for(int iwp=0; iwp<nBtPolars(); iwp++)
     {
-        BoatPolar *pBtPolar = s_oaBtPolar.at(iwp);
+        BoatPolar *pBtPolar = store().m_oaBtPolar.at(iwp);
         if(pBtPolar->boatName().compare(pBoat->name())==0)
         {
             if(bStyle) pBtPolar->setLineStipple(ls.m_Stipple);
@@ -194,7 +250,7 @@ void SailObjects::setBoatStyle(Boat *pBoat, LineStyle const &ls, bool bStyle, bo
     }
     for(int ipp=0; ipp<nBtOpps(); ipp++)
     {
-        BoatOpp *pBtOpp = s_oaBtOpp.at(ipp);
+        BoatOpp *pBtOpp = store().m_oaBtOpp.at(ipp);
         if(pBtOpp->boatName().compare(pBoat->name())==0)
         {
             if(bStyle) pBtOpp->setLineStipple(ls.m_Stipple);
@@ -223,7 +279,7 @@ void SailObjects::setBPolarStyle(BoatPolar *pBPolar, LineStyle const &ls, bool b
 
     for(int ipp=nBtOpps()-1; ipp>=0; ipp--)
     {
-        BoatOpp *pBtOpp = s_oaBtOpp.at(ipp);
+        BoatOpp *pBtOpp = store().m_oaBtOpp.at(ipp);
         if(pBtOpp->boatName().compare(pBoat->name())==0 && pBtOpp->polarName().compare(pBPolar->name())==0)
         {
             if(bStyle) pBtOpp->setLineStipple(ls.m_Stipple);
@@ -241,12 +297,22 @@ void SailObjects::setBPolarStyle(BoatPolar *pBPolar, LineStyle const &ls, bool b
 }
 
 
+/**
+ * Returns the boat with the name, through the name index.
+ * The boats which have been renamed directly are not in the index and are found by a linear search.
+ */
 Boat * SailObjects::boat(const std::string &boatName)
 {
-    for (int i=0; i<nBoats(); i++)
+    Boat *pIndexed = store().findIndexed(store().m_BoatIndex, s_NoParent, boatName, buildBoatIndex);
+    if(pIndexed && pIndexed->nameRef()==boatName) return pIndexed;
+
+    for(Boat *pBoat : boats())
     {
-        Boat* pBoat = s_oaBoat.at(i);
-        if (pBoat->name() == boatName) return pBoat;
+        if (pBoat->nameRef()==boatName)
+        {
+            invalidateIndex(); // out of date
+            return pBoat;
+        }
     }
     return nullptr;
 }
@@ -265,7 +331,7 @@ BoatOpp * SailObjects::getBoatOpp(Boat const *pBoat, BoatPolar const* pBPolar, d
 
     for (int i=0; i<nBtOpps(); i++)
     {
-        pBOpp = s_oaBtOpp.at(i);
+        pBOpp = store().m_oaBtOpp.at(i);
         if ((pBOpp->boatName() == pBoat->name()) && (pBOpp->polarName() == pBPolar->name()))
         {
             if (fabs(pBOpp->ctrl() - x)<0.001)  return pBOpp;
@@ -284,12 +350,18 @@ BoatOpp * SailObjects::getBoatOpp(Boat const *pBoat, BoatPolar const* pBPolar, d
 BoatPolar* SailObjects::btPolar(Boat const *pBoat, std::string const &BtPolarName)
 {
     if(!pBoat) return nullptr;
+    std::string const &boatname = pBoat->nameRef();
+
+    BoatPolar *pIndexed = store().findIndexed(store().m_BtPolarIndex, boatname, BtPolarName, buildBtPolarIndex);
+    if(pIndexed && pIndexed->boatName()==boatname && pIndexed->nameRef()==BtPolarName) return pIndexed;
 
-    for (int i=0; i<nBtPolars(); i++)
+    for(BoatPolar *pBtPolar : boatPolars())
     {
-        BoatPolar *pWPolar = s_oaBtPolar.at(i);
-        if (pWPolar->boatName()==pBoat->name() && pWPolar->name()== BtPolarName)
-            return pWPolar;
+        if (pBtPolar->boatName()==boatname && pBtPolar->nameRef()==BtPolarName)
+        {
+            invalidateIndex(); // out of date
+            return pBtPolar;
+        }
     }
     return nullptr;
 }
@@ -301,7 +373,7 @@ void SailObjects::setWPolarColor(Boat *pBoat, BoatPolar *pBPolar)
     fl5Color clr = pBoat->lineColor();
     for(int ip=0; ip<nBtPolars(); ip++)
     {
-        if(s_oaBtPolar.at(ip)->boatName().compare(pBoat->name())==0)
+        if(store().m_oaBtPolar.at(ip)->boatName().compare(pBoat->name())==0)
         {
             clr = clr.darker(s_SailDarkFactor);
         }
@@ -317,7 +389,7 @@ void SailObjects::setBoatVisible(Boat *pPlane, bool bVisible)
 
     for(int iwp=0; iwp<nBtPolars(); iwp++)
     {
-        BoatPolar *pBPolar = s_oaBtPolar.at(iwp);
+        BoatPolar *pBPolar = store().m_oaBtPolar.at(iwp);
         if(pBPolar->boatName().compare(pPlane->name())==0)
         {
             pBPolar->setVisible(bVisible);
@@ -325,7 +397,7 @@ void SailObjects::setBoatVisible(Boat *pPlane, bool bVisible)
     }
     for(int ipp=0; ipp<nBtOpps(); ipp++)
     {
-        BoatOpp *pBOpp = s_oaBtOpp.at(ipp);
+        BoatOpp *pBOpp = store().m_oaBtOpp.at(ipp);
         if(pBOpp->boatName().compare(pPlane->name())==0)
         {
             pBOpp->setVisible(bVisible);
@@ -343,7 +415,7 @@ void SailObjects::setBPolarVisible(BoatPolar *pBPolar, bool bVisible)
 
     for(int ipp=0; ipp<nBtOpps(); ipp++)
     {
-        BoatOpp *pBtOpp = s_oaBtOpp.at(ipp);
+        BoatOpp *pBtOpp = store().m_oaBtOpp.at(ipp);
         if(pBtOpp->boatName().compare(pBoat->name())==0)
         {
             if(pBtOpp->polarName().compare(pBPolar->name())==0)
@@ -360,17 +432,7 @@ void SailObjects::setBPolarVisible(BoatPolar *pBPolar, bool bVisible)
 */
 bool SailObjects::boatExists(std::string const &boatname)
 {
-    Boat *pOldBoat;
-
-    for (int i=0; i<nBoats(); i++)
-    {
-        pOldBoat = s_oaBoat.at(i);
-        if (pOldBoat->name() == boatname)
-        {
-            return true;
-        }
-    }
-    return false;
+    return boat(boatname)!=nullptr;
 }
 
 
@@ -380,6 +442,7 @@ bool SailObjects::boatExists(std::string const &boatname)
  */
 void SailObjects::deleteBoatResults(Boat *pBoat, bool bDeletePolars)
 {
+    invalidateIndex();
     if(!pBoat || !pBoat->name().length()) return ;
     BoatPolar* pBtPolar;
     BoatOpp * pBtOpp;
@@ -387,10 +450,10 @@ void SailObjects::deleteBoatResults(Boat *pBoat, bool bDeletePolars)
     //first remove all POpps associated to the Boat
     for (int i=nBtOpps()-1; i>=0; i--)
     {
-        pBtOpp = s_oaBtOpp.at(i);
+        pBtOpp = store().m_oaBtOpp.at(i);
         if(pBtOpp->boatName() == pBoat->name())
         {
-            s_oaBtOpp.erase(s_oaBtOpp.begin()+i);
+            store().m_oaBtOpp.erase(store().m_oaBtOpp.begin()+i);
             delete pBtOpp;
         }
     }
@@ -398,12 +461,12 @@ void SailObjects::deleteBoatResults(Boat *pBoat, bool bDeletePolars)
     //next delete all WPolars associated to the Boat
     for (int i=nBtPolars()-1; i>=0; i--)
     {
-        pBtPolar = s_oaBtPolar.at(i);
+        pBtPolar = store().m_oaBtPolar.at(i);
         if (pBtPolar->boatName() == pBoat->name())
         {
             if(bDeletePolars /*|| pWPolar->isControlPolar() || pWPolar->isStabilityPolar()*/)
             {
-                s_oaBtPolar.erase(s_oaBtPolar.begin()+i);
+                store().m_oaBtPolar.erase(store().m_oaBtPolar.begin()+i);
                 delete pBtPolar;
                 pBtPolar = nullptr;
             }
@@ -418,12 +481,13 @@ void SailObjects::deleteBoatResults(Boat *pBoat, bool bDeletePolars)
 
 void SailObjects::insertBtOpp(BoatOpp *pBtOpp)
 {
+    invalidateIndex();
     BoatOpp *pOldBtOpp = nullptr;
     bool bIsInserted = false;
 
     for (int i=0; i<nBtOpps(); i++)
     {
-        pOldBtOpp = s_oaBtOpp.at(i);
+        pOldBtOpp = store().m_oaBtOpp.at(i);
         if (pBtOpp->boatName() == pOldBtOpp->boatName())
         {
             if (pBtOpp->polarName() == pOldBtOpp->polarName())
@@ -433,16 +497,16 @@ void SailObjects::insertBtOpp(BoatOpp *pBtOpp)
                     //replace existing point
                     pBtOpp->setTheStyle(pOldBtOpp->theStyle());
 
-                    s_oaBtOpp.erase(s_oaBtOpp.begin()+i);
+                    store().m_oaBtOpp.erase(store().m_oaBtOpp.begin()+i);
                     delete pOldBtOpp;
-                    s_oaBtOpp.insert(s_oaBtOpp.begin()+i, pBtOpp);
+                    store().m_oaBtOpp.insert(store().m_oaBtOpp.begin()+i, pBtOpp);
                     bIsInserted = true;
                     i = nBtOpps();// to break
                 }
                 else if (pBtOpp->ctrl() > pOldBtOpp->ctrl())
                 {
                     //insert point
-                    s_oaBtOpp.insert(s_oaBtOpp.begin()+i, pBtOpp);
+                    store().m_oaBtOpp.insert(store().m_oaBtOpp.begin()+i, pBtOpp);
                     bIsInserted = true;
                     i = nBtOpps();// to break
                 }
@@ -450,15 +514,16 @@ void SailObjects::insertBtOpp(BoatOpp *pBtOpp)
         }
     }
 
-    if (!bIsInserted)     s_oaBtOpp.push_back(pBtOpp);
+    if (!bIsInserted)     store().m_oaBtOpp.push_back(pBtOpp);
 }
 
 
 void SailObjects::storeBtOpps(BoatPolar *pBtPolar, std::vector<BoatOpp*> const &BtOppList)
 {
+    invalidateIndex();
     if(!pBtPolar || BtOppList.size()==0)
     {
-        s_pLastBtOpp = nullptr;
+        store().m_pLastBtOpp = nullptr;
         return;
     }
     fl5Color clr = pBtPolar->lineColor();
@@ -473,7 +538,7 @@ void SailObjects::storeBtOpps(BoatPolar *pBtPolar, std::vector<BoatOpp*> const &
 
         for (int i=0; i<nBtOpps(); i++)
         {
-            BoatOpp *pOldBtOpp = s_oaBtOpp.at(i);
+            BoatOpp *pOldBtOpp = store().m_oaBtOpp.at(i);
             if (pBtOpp->boatName() == pOldBtOpp->boatName())
             {
                 if (pBtOpp->polarName() == pOldBtOpp->polarName())
@@ -483,16 +548,16 @@ void SailObjects::storeBtOpps(BoatPolar *pBtPolar, std::vector<BoatOpp*> const &
                         //replace existing point
                         pBtOpp->setTheStyle(pOldBtOpp->theStyle());
 
-                        s_oaBtOpp.erase(s_oaBtOpp.begin()+i);
+                        store().m_oaBtOpp.erase(store().m_oaBtOpp.begin()+i);
                         delete pOldBtOpp;
-                        s_oaBtOpp.insert(s_oaBtOpp.begin()+i, pBtOpp);
+                        store().m_oaBtOpp.insert(store().m_oaBtOpp.begin()+i, pBtOpp);
                         bIsInserted = true;
                         i = nBtOpps();// to break
                     }
                     else if (pBtOpp->ctrl() > pOldBtOpp->ctrl())
                     {
                         //insert point
-                        s_oaBtOpp.insert(s_oaBtOpp.begin()+i, pBtOpp);
+                        store().m_oaBtOpp.insert(store().m_oaBtOpp.begin()+i, pBtOpp);
                         bIsInserted = true;
                         i = nBtOpps();// to break
                     }
@@ -500,8 +565,8 @@ void SailObjects::storeBtOpps(BoatPolar *pBtPolar, std::vector<BoatOpp*> const &
                 }
             }
         }
-        if (!bIsInserted) s_oaBtOpp.push_back(pBtOpp);
-        s_pLastBtOpp = pBtOpp;
+        if (!bIsInserted) store().m_oaBtOpp.push_back(pBtOpp);
+        store().m_pLastBtOpp = pBtOpp;
     }
 }
 
@@ -533,27 +598,29 @@ BoatOpp* SailObjects::getBoatOppObject(Boat*pBoat, BoatPolar *pBtPolar,
 
 void SailObjects::insertThisBoat(Boat*pNewBoat)
 {
+    invalidateIndex();
     for(int ib=0; ib<nBoats(); ib++)
     {
-        Boat *const pOldBoat = s_oaBoat.at(ib);
+        Boat *const pOldBoat = store().m_oaBoat.at(ib);
         if(pNewBoat->name().compare(pOldBoat->name())<0)
         {
-            s_oaBoat.insert(s_oaBoat.begin()+ib, pNewBoat);
+            store().m_oaBoat.insert(store().m_oaBoat.begin()+ib, pNewBoat);
             return;
         }
     }
-    s_oaBoat.push_back(pNewBoat);
+    store().m_oaBoat.push_back(pNewBoat);
 }
 
 
 void SailObjects::insertBtPolar(BoatPolar *pBtPolar)
 {
+    invalidateIndex();
     for(int ib=0; ib<nBtPolars(); ib++)
     {
-        BoatPolar *const pOldBtPolar = s_oaBtPolar.at(ib);
+        BoatPolar *const pOldBtPolar = store().m_oaBtPolar.at(ib);
         if(pBtPolar->name().compare(pOldBtPolar->name())<0)
         {
-            s_oaBtPolar.insert(s_oaBtPolar.begin()+ib, pBtPolar);
+            store().m_oaBtPolar.insert(store().m_oaBtPolar.begin()+ib, pBtPolar);
             return;
         }
         else if(pBtPolar->name().compare(pOldBtPolar->name())==0)
@@ -561,13 +628,13 @@ void SailObjects::insertBtPolar(BoatPolar *pBtPolar)
             if(pBtPolar->boatName().compare(pOldBtPolar->boatName())==0)
             {
                 deleteBtPolar(pOldBtPolar);
-                s_oaBtPolar.insert(s_oaBtPolar.begin()+ib, pBtPolar);
+                store().m_oaBtPolar.insert(store().m_oaBtPolar.begin()+ib, pBtPolar);
             }
-            else s_oaBtPolar.insert(s_oaBtPolar.begin()+ib, pBtPolar);
+            else store().m_oaBtPolar.insert(store().m_oaBtPolar.begin()+ib, pBtPolar);
             return;
         }
     }
-    s_oaBtPolar.push_back(pBtPolar);
+    store().m_oaBtPolar.push_back(pBtPolar);
 }
 
 
@@ -577,7 +644,7 @@ bool SailObjects::hasResults(Boat const*pBoat)
     BoatPolar *pBtPolar;
     for(int j=0; j<nBtPolars(); j++)
     {
-        pBtPolar = s_oaBtPolar.at(j);
+        pBtPolar = store().m_oaBtPolar.at(j);
         if(pBtPolar->name()==pBoat->name() && pBtPolar->dataSize())
         {
             return true;
@@ -586,7 +653,7 @@ bool SailObjects::hasResults(Boat const*pBoat)
 
     for (int i=0; i<nBtOpps(); i++)
     {
-        BoatOpp *pBtOpp = s_oaBtOpp.at(i);
+        BoatOpp *pBtOpp = store().m_oaBtOpp.at(i);
         if(pBtOpp->boatName() == pBoat->name())
         {
             return true;
@@ -615,7 +682,7 @@ std::vector<std::string> SailObjects::polarNames(Boat const*pBoat)
     {
         for(int i=0; i<nBtPolars(); i++)
         {
-            BoatPolar const *pPolar = s_oaBtPolar.at(i);
+            BoatPolar const *pPolar = store().m_oaBtPolar.at(i);
             if(pPolar->boatName()==pBoat->name())
                 names.push_back(pPolar->name());
         }
@@ -624,20 +691,30 @@ std::vector<std::string> SailObjects::polarNames(Boat const*pBoat)
 }
 
 
+/**
+ * Returns the operating point of the polar with the name, through the name index.
+ * The operating points whose name has changed with the units are not in the index and are found by a linear search.
+ */
 BoatOpp *SailObjects::btOpp(Boat const *pBoat, BoatPolar const*pPolar, std::string const &oppname)
 {
     if(!pBoat || !pPolar) return nullptr;
-    std::string btname = pBoat->name();
-    std::string polarname = pPolar->name();
+    std::string const &btname = pBoat->nameRef();
+    std::string const &polarname = pPolar->nameRef();
 
-    for (BoatOpp *pBtOpp : s_oaBtOpp)
+    // the polar may be a copy of the stored polar
+    BoatPolar const *pStoredPolar = btPolar(pBoat, polarname);
+    if(pStoredPolar)
     {
-        std::string poppbtname = pBtOpp->boatName();
-        std::string popppolarname = pBtOpp->polarName();
-        std::string poppname = pBtOpp->name();
+        BoatOpp *pIndexed = store().findIndexed(store().m_BtOppIndex, pStoredPolar, oppname, buildBtOppIndex);
+        if(pIndexed && pIndexed->boatName()==btname && pIndexed->polarName()==polarname && pIndexed->name()==oppname)
+            return pIndexed;
+    }
 
-        if (poppbtname==btname && popppolarname==polarname && poppname==oppname)
+    for (BoatOpp *pBtOpp : boatOpps())
+    {
+        if (pBtOpp->boatName()==btname && pBtOpp->polarName()==polarname && pBtOpp->name()==oppname)
         {
+            if(pStoredPolar) invalidateIndex(); // out of date
             return pBtOpp;
         }
     }
@@ -38,6 +38,7 @@
 #include <panel3.h>
 #include <panel4.h>
 #include <geom_global.h>
+#include <lucache.h>
 
 int Sail::s_iXRes = 37;
 int Sail::s_iZRes = 31;
@@ -53,6 +54,8 @@ Sail::Sail() : Part()
 
     m_LE.reset();
 
+    m_MeshHash = 0;
+
     m_bRuledMesh = true;
     m_NXPanels      = 7;
     m_XDistrib      = xfl::TANH;
@@ -99,6 +102,7 @@ void Sail::duplicate(Sail const*pSail)
     m_MaxElementSize  = pSail->m_MaxElementSize;
 
     m_TriMesh         = pSail->m_TriMesh;
+    m_MeshHash        = pSail->m_MeshHash;
 
     m_SpanResFF       = pSail->m_SpanResFF;
     m_SpanResSum      = pSail->m_SpanResSum;
@@ -162,8 +166,9 @@ bool Sail::serializeSailFl5(QDataStream &ar, bool bIsStoring)
     // 500004: beta 18: added reference the reference chord
     // 500005: beta 19: added free mesh parameters
     // 500006: v7.03:   added edge split parameters
+    // 500007: v7.04:   added the analysis mesh and its hash
 
-    int ArchiveFormat=500006;// identifies the format of the file
+    int ArchiveFormat=500007;// identifies the format of the file
     int nIntSpares=0;
     int nDbleSpares=0;
 
@@ -212,6 +217,15 @@ bool Sail::serializeSailFl5(QDataStream &ar, bool bIsStoring)
                 m_EdgeSplit[i][j].serialize(ar, bIsStoring);
         }
 
+        // store the mesh only if it is up to date with the geometry, so that it is not rebuilt on load
+        bool bMesh = m_MeshHash!=0 && m_TriMesh.nPanels()>0 && m_MeshHash==meshHash(m_LE);
+        ar << bMesh;
+        if(bMesh)
+        {
+            ar << quint64(m_MeshHash);
+            m_TriMesh.serializeMeshFl5(ar, bIsStoring);
+        }
+
         ar << 0; // nIntSpares
         ar << 0; // nDoubleSpares
         return true;
@@ -249,7 +263,7 @@ bool Sail::serializeSailFl5(QDataStream &ar, bool bIsStoring)
             case 7: m_XDistrib=xfl::INV_EXP;      break;
         }
 
-        if(ArchiveFormat<=500006)
+        if(ArchiveFormat<=510000)
         {
             ar >> n;
 /*            switch(n)
@@ -299,6 +313,22 @@ bool Sail::serializeSailFl5(QDataStream &ar, bool bIsStoring)
             }
         }
 
+        m_MeshHash = 0;
+        if(ArchiveFormat>=500007)
+        {
+            // the hash is checked against the loaded geometry at the first call to makeTriPanels()
+            bool bMesh = false;
+            ar >> bMesh;
+            if(bMesh)
+            {
+                quint64 h=0;
+                ar >> h;
+                m_TriMesh.serializeMeshFl5(ar, bIsStoring);
+                for(int i3=0; i3<m_TriMesh.nPanels(); i3++) m_TriMesh.panel(i3).setFromSTL(true);
+                m_MeshHash = std::uint64_t(h);
+            }
+        }
+
         // space allocation
         ar >> nIntSpares;
         ar >> nDbleSpares;
@@ -308,27 +338,40 @@ bool Sail::serializeSailFl5(QDataStream &ar, bool bIsStoring)
 }
 
 
+/**
+ * Returns the points of the sail for the tensor product of xrel[] and zrel[]; the point (ix, iz) is at index iz*xrel.size()+ix.
+ * The default is to evaluate each point; the sails defined by sections evaluate the grid in one batch.
+ */
+void Sail::getGrid(std::vector<double> const &xrel, std::vector<double> const &zrel, std::vector<Vector3d> &grid) const
+{
+    int nx = int(xrel.size());
+    grid.resize(nx*zrel.size());
+    for(uint iz=0; iz<zrel.size(); iz++)
+        for(int ix=0; ix<nx; ix++) grid[iz*nx+ix] = point(xrel.at(ix), zrel.at(iz));
+}
+
+
 void Sail::makeTriangulation(int nx, int nh)
 {
     Vector3d S00, S01, S10, S11;
-    double uk(0), uk1(0), vl(0), vl1(0);
 
     m_Triangulation.clear();
 
+    std::vector<double> u(nx+1), v(nh+1);
+    for(int k=0; k<=nx; k++) u[k] = double(k)/double(nx);
+    for(int l=0; l<=nh; l++) v[l] = double(l)/double(nh);
+    std::vector<Vector3d> grid;
+    getGrid(u, v, grid);
+
     for (int k=0; k<nx; k++)
     {
-        uk  = double(k)   /double(nx);
-        uk1 = double(k+1) /double(nx);
-
-        vl=0.0;
-        S00 = point(uk,  vl);
-        S10 = point(uk1, vl);
+        S00 = grid.at(k);
+        S10 = grid.at(k+1);
 
         for (int l=0; l<nh; l++)
         {
-            vl1 = double(l+1) / double(nh);
-            S01 = point(uk,  vl1);
-            S11 = point(uk1, vl1);
+            S01 = grid.at((l+1)*(nx+1)+k);
+            S11 = grid.at((l+1)*(nx+1)+k+1);
 
             if(!S00.isSame(S01) && !S01.isSame(S11) && !S11.isSame(S00))
                 m_Triangulation.appendTriangle(Triangle3d(S00, S01, S11));
@@ -372,9 +415,43 @@ void Sail::mergeRefNodes(Node const& src, Node const&dest)
 }
 
 
+/**
+ * @return the hash of the data from which the mesh is built, i.e. the reference triangles, the trailing edge indexes,
+ * the surface type and the position of the tack.
+ * The coordinates are hashed in single precision, since this is the precision with which they are stored in the project files.
+ */
+std::uint64_t Sail::meshHash(Vector3d const &Tack) const
+{
+    std::uint64_t h = LUCache::hashSeed();
+    LUCache::hash(h, int(m_bThinSurface));
+    LUCache::hash(h, int(m_RefTriangles.size()));
+    float f[9];
+    for(Triangle3d const &t3d : m_RefTriangles)
+    {
+        for(int iv=0; iv<3; iv++)
+        {
+            Node const &vtx = t3d.vertexAt(iv);
+            f[3*iv] = vtx.xf();    f[3*iv+1] = vtx.yf();    f[3*iv+2] = vtx.zf();
+        }
+        LUCache::hash(h, f, sizeof(f));
+    }
+    f[0] = Tack.xf();    f[1] = Tack.yf();    f[2] = Tack.zf();
+    LUCache::hash(h, f, 3*sizeof(float));
+
+    LUCache::hash(h, int(m_BotMidTEIndexes.size()));
+    if(m_BotMidTEIndexes.size()) LUCache::hash(h, m_BotMidTEIndexes.data(), m_BotMidTEIndexes.size()*sizeof(int));
+    LUCache::hash(h, int(m_TopTEIndexes.size()));
+    if(m_TopTEIndexes.size())    LUCache::hash(h, m_TopTEIndexes.data(),    m_TopTEIndexes.size()*sizeof(int));
+
+    return h==0 ? 1 : h; // 0 is reserved for invalid meshes
+}
+
+
 /**
  * Cleans the array of reference triangles to remove those with low area, then
- * builds a panel3 for each reference triangle */
+ * builds a panel3 for each reference triangle.
+ * The mesh is not rebuilt if it was made, or loaded from the project file, from the same data.
+ */
 void Sail::makeTriPanels(Vector3d const &Tack)
 {
     std::string log, prefix;
@@ -390,6 +467,9 @@ void Sail::makeTriPanels(Vector3d const &Tack)
         }
     }
 
+    std::uint64_t h = meshHash(Tack);
+    if(m_MeshHash==h && m_TriMesh.nPanels()>0) return;
+
     m_TriMesh.makeMeshFromTriangles(m_RefTriangles, 0, pos, log, prefix);
     m_TriMesh.translatePanels(Tack);
 
@@ -397,6 +477,8 @@ void Sail::makeTriPanels(Vector3d const &Tack)
     setTEfromIndexes();
     std::vector<int> errors;
     m_TriMesh.connectTrailingEdges(errors);
+
+    m_MeshHash = h;
 }
 
 
@@ -855,14 +937,17 @@ void Sail::makeRuledMesh(Vector3d const &LE)
     xfl::getPointDistribution(xfrac, nx, m_XDistrib);
     xfl::getPointDistribution(zfrac, nz, m_ZDistrib);
 
+    // the vertical lines are numbered from the trailing edge
+    std::vector<double> xrel(xfrac.rbegin(), xfrac.rend());
+    std::vector<Vector3d> grid;
+    getGrid(xrel, zfrac, grid);
+
     for(int i=0; i<nz+1; i++) // for each horizontal line
     {
-        double zrel = zfrac[i];
         for(int j=0; j<nx+1; j++)  // for each vertical line
         {
             Node &nd = nodes[i*(nx+1) + j];
-            double xrel = xfrac[nx-j];
-            nd.setPosition(point(xrel,zrel) + LE);
+            nd.setPosition(grid.at(i*(nx+1) + j) + LE);
             nd.setSurfacePosition(xfl::MIDSURFACE);
         }
     }
@@ -109,6 +109,13 @@ Vector3d SailNurbs::point(double xrel, double zrel, xfl::enumSurfacePosition ) c
 }
 
 
+/** The z-parameter is the NURBS' u-parameter, so that the grid is the NURBS grid of (zrel, xrel) */
+void SailNurbs::getGrid(std::vector<double> const &xrel, std::vector<double> const &zrel, std::vector<Vector3d> &grid) const
+{
+    m_nurbs.getGrid(zrel, xrel, grid);
+}
+
+
 Vector3d SailNurbs::normal(double xrel, double zrel, xfl::enumSurfacePosition ) const
 {
     Vector3d N;
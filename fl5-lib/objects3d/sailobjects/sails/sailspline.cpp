@@ -481,6 +481,61 @@ Vector3d SailSpline::point(double xrel, double zrel, xfl::enumSurfacePosition )
 }
 
 
+/**
+ * Same as point() on the grid, but each section's spline is evaluated and rotated once for each value of xrel
+ * instead of twice for each point of the grid.
+ */
+void SailSpline::getGrid(std::vector<double> const &xrel, std::vector<double> const &zrel, std::vector<Vector3d> &grid) const
+{
+    int nx = int(xrel.size());
+    int nz = int(zrel.size());
+    grid.assign(nx*nz, Vector3d());
+    if(sectionCount()<2) return;
+
+    // the points of the sections
+    std::vector<Vector3d> secpt(sectionCount()*nx);
+    for(int is=0; is<sectionCount(); is++)
+    {
+        for(int ix=0; ix<nx; ix++)
+        {
+            double x = std::max(0.00001, std::min(xrel.at(ix), 0.99999));
+            Vector2d p = m_Spline.at(is)->splinePoint(x);
+            Vector3d &pt = secpt[is*nx+ix];
+            pt.set(p.x, p.y, m_Position.at(is).z);
+            pt.rotateY(m_Position.at(is), m_Ry.at(is));
+        }
+    }
+
+    for(int iz=0; iz<nz; iz++)
+    {
+        double z = m_Position.front().z + zrel.at(iz) * (m_Position.back().z-m_Position.front().z);
+
+        int isec = -1;
+        double tau=1.0;
+        for(int i=0; i<sectionCount()-1; i++)
+        {
+            if(m_Position.at(i).z<=z && z <=m_Position.at(i+1).z)
+            {
+                double dz =  (m_Position[i+1].z - m_Position[i].z);
+                if(fabs(dz)>0.0) tau = (z-m_Position[i].z) / dz;
+                else             tau = 0.0;
+                isec = i;
+                break;
+            }
+        }
+        if(isec<0) continue;
+
+        for(int ix=0; ix<nx; ix++)
+        {
+            if(xrel.at(ix)<0 || xrel.at(ix)>1.0) continue;
+            Vector3d const &pt0 = secpt.at(isec*nx+ix);
+            Vector3d const &pt1 = secpt.at((isec+1)*nx+ix);
+            grid[iz*nx+ix].set(pt0.x*(1.0-tau)+pt1.x*tau, pt0.y*(1.0-tau)+pt1.y*tau, pt0.z*(1.0-tau)+pt1.z*tau);
+        }
+    }
+}
+
+
 double SailSpline::luffLength() const
 {
     if(m_Position.size()<2) return 1.0;
@@ -29,11 +29,16 @@
 
 #include <sailstl.h>
 
+#include <meshsimplifier.h>
 #include <trimesh.h>
 #include <units.h>
 #include <utils.h>
 
 
+int SailStl::s_MaxTriangles = 10000;
+double SailStl::s_SimplifiedEdgeLength = 0.0;
+
+
 SailStl::SailStl() : ExternalSail()
 {
     m_theStyle.m_Color.setRgba(151,201,249,125);
@@ -51,7 +56,8 @@ bool SailStl::serializeSailFl5(QDataStream &ar, bool bIsStoring)
     // 500001: new fl5 format
     // 500002: added top TE indexes in beta 18
     // 500003: brand new format
-    int ArchiveFormat = 500003;
+    // 500004: added the display triangulation of simplified sails
+    int ArchiveFormat = 500004;
 
     if(bIsStoring)
     {
@@ -71,6 +77,17 @@ bool SailStl::serializeSailFl5(QDataStream &ar, bool bIsStoring)
 
         ar << int(m_TopTEIndexes.size());
         for(int idx : m_TopTEIndexes)      ar << idx;
+
+        // the original triangulation, only if the panels have been simplified
+        n = isSimplified() ? m_Triangulation.nTriangles() : 0;
+        ar << n;
+        for(int i=0; i<n; i++)
+        {
+            Triangle3d const &t3d = m_Triangulation.triangleAt(i);
+            ar << t3d.vertexAt(0).xf() << t3d.vertexAt(0).yf() << t3d.vertexAt(0).zf();
+            ar << t3d.vertexAt(1).xf() << t3d.vertexAt(1).yf() << t3d.vertexAt(1).zf();
+            ar << t3d.vertexAt(2).xf() << t3d.vertexAt(2).yf() << t3d.vertexAt(2).zf();
+        }
     }
     else
     {
@@ -123,10 +140,6 @@ bool SailStl::serializeSailFl5(QDataStream &ar, bool bIsStoring)
                 m_RefTriangles[i3].setTriangle(V0, V1, V2);
             }
 
-            m_Triangulation.setTriangles(m_RefTriangles);
-            m_Triangulation.makeNodes();
-            m_Triangulation.makeNodeNormals();
-
             ar >> n;
             for(int i=0; i<n; i++)
             {
@@ -140,6 +153,30 @@ bool SailStl::serializeSailFl5(QDataStream &ar, bool bIsStoring)
                 ar >> k;
                 m_TopTEIndexes.push_back(k);
             }
+
+            std::vector<Triangle3d> display;
+            if(ArchiveFormat>=500004)
+            {
+                ar >> n;
+                display.resize(n);
+                for(int i3=0; i3<n; i3++)
+                {
+                    ar >> xf >> yf >> zf;
+                    V0.set(double(xf), double(yf), double(zf));
+
+                    ar >> xf >> yf >> zf;
+                    V1.set(double(xf), double(yf), double(zf));
+
+                    ar >> xf >> yf >> zf;
+                    V2.set(double(xf), double(yf), double(zf));
+
+                    display[i3].setTriangle(V0, V1, V2);
+                }
+            }
+
+            m_Triangulation.setTriangles(display.size() ? display : m_RefTriangles);
+            m_Triangulation.makeNodes();
+            m_Triangulation.makeNodeNormals();
         }
 
         computeProperties();
@@ -156,11 +193,22 @@ void SailStl::makeTriangulation(int , int )
 }
 
 
+/**
+ * Sets the imported triangles. If there are too many for the panel analysis, the panels
+ * are made from a decimated copy and the original triangulation is only kept for display
+ * and for the geometric properties.
+ */
 void SailStl::setTriangles(std::vector<Triangle3d> const &triangles)
 {
     m_Triangulation.clear();
     m_Triangulation.setTriangles(triangles);
-    m_RefTriangles = triangles;
+
+    MeshSimplifier simplifier;
+    simplifier.setMaxTriangles(s_MaxTriangles);
+    simplifier.setEdgeLength(s_SimplifiedEdgeLength);
+    if(!simplifier.simplify(triangles, m_RefTriangles))
+        m_RefTriangles = triangles;
+
     computeProperties();
 }
 
@@ -237,22 +285,26 @@ void SailStl::properties(std::string &sailprops, const std::string &prefx, bool
     strange = QString::asprintf("   Aspect ratio = %7.3f ", aspectRatio());
     props += frontspacer + strange+"\n";
 
-    strange = QString::asprintf("   Triangle count = %d", m_Triangulation.nTriangles());
+    strange = QString::asprintf("   Triangle count = %d", int(m_RefTriangles.size()));
     props += frontspacer + strange;
+    if(isSimplified())
+    {
+        strange = QString::asprintf("\n   Simplified from %d triangles", m_Triangulation.nTriangles());
+        props += frontspacer + strange;
+    }
 
     sailprops = props.toStdString();
 }
 
 
-void SailStl::scaleTwist(double newtwist)
+void SailStl::twistTriangles(std::vector<Triangle3d> &triangles, double deltatwist) const
 {
-    double deltatwist = newtwist-twist();
     Vector3d LE;
     Vector3d Luff = m_Head-m_Tack;
     double zrel=0;
-    for(uint it=0; it<m_RefTriangles.size(); it++)
+    for(uint it=0; it<triangles.size(); it++)
     {
-        Triangle3d &t3d = m_RefTriangles[it];
+        Triangle3d &t3d = triangles[it];
         for(int ivtx=0; ivtx<3; ivtx++)
         {
             Vector3d &S = t3d.vertex(ivtx);
@@ -262,8 +314,16 @@ void SailStl::scaleTwist(double newtwist)
         }
         t3d.setTriangle();
     }
+}
+
+
+void SailStl::scaleTwist(double newtwist)
+{
+    double deltatwist = newtwist-twist();
 
-    m_Triangulation.setTriangles(m_RefTriangles);
+    if(isSimplified()) twistTriangles(m_Triangulation.triangles(), deltatwist);
+    twistTriangles(m_RefTriangles, deltatwist);
+    if(!isSimplified()) m_Triangulation.setTriangles(m_RefTriangles);
     m_Triangulation.makeNodes();
     m_Triangulation.makeNodeNormals();
 
@@ -290,24 +350,9 @@ void SailStl::scaleAR(double newAR)
 
     double ratio = sqrt(newAR/ar);
 
-    Vector3d LE;
-    Vector3d Luff = m_Head-m_Tack;
-    double zrel=0;
-    for(uint it=0; it<m_RefTriangles.size(); it++)
-    {
-        Triangle3d &t3d = m_RefTriangles[it];
-        for(int ivtx=0; ivtx<3; ivtx++)
-        {
-            Vector3d &S = t3d.vertex(ivtx);
-            zrel = (S.z-m_Tack.z)/(m_Head.z-m_Tack.z);
-            LE.set(m_Tack + Luff*zrel);
-            S.x = LE.x + (S.x-LE.x)/ratio;
-            S.z = m_Tack.z + (S.z-m_Tack.z)*ratio;
-        }
-        t3d.setTriangle();
-    }
-
-    m_Triangulation.setTriangles(m_RefTriangles);
+    if(isSimplified()) scaleTrianglesAR(m_Triangulation.triangles(), ratio);
+    scaleTrianglesAR(m_RefTriangles, ratio);
+    if(!isSimplified()) m_Triangulation.setTriangles(m_RefTriangles);
     m_Triangulation.makeNodes();
     m_Triangulation.makeNodeNormals();
 
@@ -326,3 +371,22 @@ void SailStl::scaleAR(double newAR)
 }
 
 
+void SailStl::scaleTrianglesAR(std::vector<Triangle3d> &triangles, double ratio) const
+{
+    Vector3d LE;
+    Vector3d Luff = m_Head-m_Tack;
+    double zrel=0;
+    for(uint it=0; it<triangles.size(); it++)
+    {
+        Triangle3d &t3d = triangles[it];
+        for(int ivtx=0; ivtx<3; ivtx++)
+        {
+            Vector3d &S = t3d.vertex(ivtx);
+            zrel = (S.z-m_Tack.z)/(m_Head.z-m_Tack.z);
+            LE.set(m_Tack + Luff*zrel);
+            S.x = LE.x + (S.x-LE.x)/ratio;
+            S.z = m_Tack.z + (S.z-m_Tack.z)*ratio;
+        }
+        t3d.setTriangle();
+    }
+}
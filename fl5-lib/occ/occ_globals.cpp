@@ -67,6 +67,7 @@
 #include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
 #include <TopoDS_Builder.hxx>
+#include <TopoDS_Compound.hxx>
 #include <TopoDS_FrozenShape.hxx>
 #include <TopoDS_UnCompatibleShapes.hxx>
 #include <TopoDS_Wire.hxx>
@@ -80,9 +81,11 @@
 #include <wingxfl.h>
 #include <fuse.h>
 #include <occmeshparams.h>
+#include <occtessellationcache.h>
 #include <geom_global.h>
 #include <nurbssurface.h>
 #include <bspline3d.h>
+#include <threadpool.h>
 
 std::string occ::shapeType(TopoDS_Shape const &aShape)
 {
@@ -580,24 +583,36 @@ void occ::findEdges(TopoDS_Shape const &theshape, TopoDS_ListOfShape &edges, std
 }
 
 
-/** returns the edge lengths of the box which bounds the shape */
+/**
+ * Returns the edge lengths of the box which bounds the shape; the input values are extended with the boxes of the faces.
+ * The boxes of the faces are made in parallel on the thread pool.
+ */
 void occ::shapeBoundingBox(TopoDS_Shape const &shape, double &Xmin, double &Ymin, double &Zmin, double &Xmax, double &Ymax, double &Zmax)
 {
+    std::vector<TopoDS_Shape> faces;
     TopExp_Explorer shapeExplorer;
-    double xmin=0, ymin=0, zmin=0;
-    double xmax=0, ymax=0, zmax=0;
     for (shapeExplorer.Init(shape, TopAbs_FACE); shapeExplorer.More(); shapeExplorer.Next())
+        faces.push_back(shapeExplorer.Current());
+
+    int nFaces = int(faces.size());
+    std::vector<double> bounds(size_t(nFaces)*6);
+    ThreadPool::pool().parallelFor(nFaces, [&faces, &bounds](int iFace)
     {
-        TopoDS_Shape aSub = shapeExplorer.Current();
         Bnd_Box box;
-        BRepBndLib::Add(aSub, box); // Use triangulation in this case.
-        box.Get(xmin, ymin, zmin, xmax, ymax, zmax);
-        Xmin = std::min(xmin, Xmin);
-        Ymin = std::min(ymin, Ymin);
-        Zmin = std::min(zmin, Zmin);
-        Xmax = std::max(xmax, Xmax);
-        Ymax = std::max(ymax, Ymax);
-        Zmax = std::max(zmax, Zmax);
+        BRepBndLib::Add(faces[iFace], box); // Use triangulation in this case.
+        double *b = bounds.data()+size_t(iFace)*6;
+        box.Get(b[0], b[1], b[2], b[3], b[4], b[5]);
+    });
+
+    for(int iFace=0; iFace<nFaces; iFace++)
+    {
+        double const *b = bounds.data()+size_t(iFace)*6;
+        Xmin = std::min(b[0], Xmin);
+        Ymin = std::min(b[1], Ymin);
+        Zmin = std::min(b[2], Zmin);
+        Xmax = std::max(b[3], Xmax);
+        Ymax = std::max(b[4], Ymax);
+        Zmax = std::max(b[5], Zmax);
     }
 }
 
@@ -1660,88 +1675,110 @@ void occ::makeFaceRuledTriangulation(TopoDS_Face const &face, std::vector<Vector
 }
 
 
-int occ::shapeTriangulationWithOcc(const TopoDS_Shape &shape, OccMeshParams const &params, std::vector<Triangle3d> &triangles)
+/**
+ * Appends the OCC triangulation of the face to the array, oriented as the face.
+ * The face must have been meshed.
+ */
+static void faceTriangles(TopoDS_Face const &aFace, std::vector<Triangle3d> &triangles)
 {
-    BRepTools::Clean(shape);
-    if(params.isRelativeDeflection())
-        BRepMesh_IncrementalMesh(shape, params.deflectionRelative(), params.isRelativeDeflection(),
-                                 params.angularDeviation()*PI/180.0, true);
-    else
-        BRepMesh_IncrementalMesh(shape, params.deflectionAbsolute(), params.isRelativeDeflection(),
-                                 params.angularDeviation()*PI/180.0, true);
-    TopExp_Explorer shapeExplorer;
+    TopLoc_Location location;
+    Handle(Poly_Triangulation) hTriangulation = BRep_Tool::Triangulation(aFace, location);
+    if(hTriangulation.IsNull()) return;
 
-    int nFace = 0;
-    for (shapeExplorer.Init(shape,TopAbs_FACE); shapeExplorer.More(); shapeExplorer.Next())
+    triangles.reserve(triangles.size()+hTriangulation->NbTriangles());
+    for (int i=1; i<=hTriangulation->NbTriangles(); i++)
     {
-        TopoDS_Face aFace = TopoDS::Face(shapeExplorer.Current());
-        TopLoc_Location location;
-        Handle(Poly_Triangulation) hTriangulation = BRep_Tool::Triangulation(aFace, location);
+        const Poly_Triangle& tri = hTriangulation->Triangle(i);
+        const Vector3d p1(hTriangulation->Node(tri(1)).X(), hTriangulation->Node(tri(1)).Y(), hTriangulation->Node(tri(1)).Z());
+        const Vector3d p2(hTriangulation->Node(tri(2)).X(), hTriangulation->Node(tri(2)).Y(), hTriangulation->Node(tri(2)).Z());
+        const Vector3d p3(hTriangulation->Node(tri(3)).X(), hTriangulation->Node(tri(3)).Y(), hTriangulation->Node(tri(3)).Z());
 
-        if(hTriangulation.IsNull())
-        {
-        }
-        else
-        {
-            for (int i=1; i<=hTriangulation->NbTriangles(); i++)
-            {
-                const Poly_Triangle& tri = hTriangulation->Triangle(i);
-                const Vector3d p1(hTriangulation->Node(tri(1)).X(), hTriangulation->Node(tri(1)).Y(), hTriangulation->Node(tri(1)).Z());
-                const Vector3d p2(hTriangulation->Node(tri(2)).X(), hTriangulation->Node(tri(2)).Y(), hTriangulation->Node(tri(2)).Z());
-                const Vector3d p3(hTriangulation->Node(tri(3)).X(), hTriangulation->Node(tri(3)).Y(), hTriangulation->Node(tri(3)).Z());
-
-                if(aFace.Orientation()==TopAbs_FORWARD) triangles.push_back({p1,p2,p3});
-                else                                    triangles.push_back({p1,p3,p2});
-            }
-        }
-        nFace++;
+        if(aFace.Orientation()==TopAbs_FORWARD) triangles.push_back({p1,p2,p3});
+        else                                    triangles.push_back({p1,p3,p2});
     }
-    (void)nFace;
-    return int(triangles.size());
 }
 
 
-int occ::shellTriangulationWithOcc(const TopoDS_Shell &shell, OccMeshParams const &params, std::vector<Triangle3d> &triangles)
+/**
+ * Triangulates the faces of the shape, reading the unchanged faces from the OccTessellationCache.
+ * The faces which are not in the cache are cleaned and meshed together in a single parallel call
+ * to OCC's incremental mesher, so that the edges which they share are discretized once.
+ * The keys and the triangles of the faces are computed in parallel on the thread pool.
+ */
+static int triangulateFaces(TopoDS_Shape const &shape, OccMeshParams const &params, std::vector<Triangle3d> &triangles)
 {
-    BRepTools::Clean(shell);
-    if(params.isRelativeDeflection())
-        BRepMesh_IncrementalMesh(shell, params.deflectionRelative(), params.isRelativeDeflection(),
-                                 params.angularDeviation()*PI/180.0, true);
-    else
-        BRepMesh_IncrementalMesh(shell, params.deflectionAbsolute(), params.isRelativeDeflection(),
-                                 params.angularDeviation()*PI/180.0, true);
+    std::vector<TopoDS_Face> faces;
     TopExp_Explorer shapeExplorer;
+    for (shapeExplorer.Init(shape,TopAbs_FACE); shapeExplorer.More(); shapeExplorer.Next())
+        faces.push_back(TopoDS::Face(shapeExplorer.Current()));
 
-    int nFace = 0;
-    for (shapeExplorer.Init(shell,TopAbs_FACE); shapeExplorer.More(); shapeExplorer.Next())
-    {
-        TopoDS_Face aFace = TopoDS::Face(shapeExplorer.Current());
-        TopLoc_Location location;
-        Handle(Poly_Triangulation) hTriangulation = BRep_Tool::Triangulation(aFace, location);
+    int nFaces = int(faces.size());
+    bool bCache = OccTessellationCache::isEnabled();
+    std::vector<uint64_t> keys(nFaces, 0);
+    std::vector<std::vector<Triangle3d>> facetriangles(nFaces);
+    std::vector<char> bFound(nFaces, 0);
 
-        if(hTriangulation.IsNull())
+    if(bCache)
+    {
+        ThreadPool::pool().parallelFor(nFaces, [&](int iFace)
         {
-        }
+            keys[iFace] = OccTessellationCache::faceKey(faces[iFace], params);
+            bFound[iFace] = OccTessellationCache::findFace(keys[iFace], facetriangles[iFace]) ? 1 : 0;
+        });
+    }
+
+    std::vector<int> missed;
+    TopoDS_Compound compound;
+    BRep_Builder builder;
+    builder.MakeCompound(compound);
+    for(int iFace=0; iFace<nFaces; iFace++)
+    {
+        if(bFound[iFace]) continue;
+        missed.push_back(iFace);
+        // clean the face so that it is re-meshed with the current parameters
+        BRepTools::Clean(faces[iFace]);
+        builder.Add(compound, faces[iFace]);
+    }
+
+    if(missed.size())
+    {
+        if(params.isRelativeDeflection())
+            BRepMesh_IncrementalMesh(compound, params.deflectionRelative(), params.isRelativeDeflection(),
+                                     params.angularDeviation()*PI/180.0, true);
         else
-        {
-            for (int i=1; i<=hTriangulation->NbTriangles(); i++)
-            {
-                const Poly_Triangle& tri = hTriangulation->Triangle(i);
-                const Vector3d p1 = Vector3d(hTriangulation->Node(tri(1)).X(), hTriangulation->Node(tri(1)).Y(), hTriangulation->Node(tri(1)).Z());
-                const Vector3d p2 = Vector3d(hTriangulation->Node(tri(2)).X(), hTriangulation->Node(tri(2)).Y(), hTriangulation->Node(tri(2)).Z());
-                const Vector3d p3 = Vector3d(hTriangulation->Node(tri(3)).X(), hTriangulation->Node(tri(3)).Y(), hTriangulation->Node(tri(3)).Z());
+            BRepMesh_IncrementalMesh(compound, params.deflectionAbsolute(), params.isRelativeDeflection(),
+                                     params.angularDeviation()*PI/180.0, true);
 
-                if(aFace.Orientation()==TopAbs_FORWARD) triangles.push_back({p1,p2,p3});
-                else                                    triangles.push_back({p1,p3,p2});
-            }
-        }
-        nFace++;
+        ThreadPool::pool().parallelFor(int(missed.size()), [&](int i)
+        {
+            int iFace = missed[i];
+            faceTriangles(faces[iFace], facetriangles[iFace]);
+            if(bCache) OccTessellationCache::storeFace(keys[iFace], facetriangles[iFace]);
+        });
     }
-    (void)nFace;
+
+    size_t nTriangles = triangles.size();
+    for(std::vector<Triangle3d> const &facetri : facetriangles) nTriangles += facetri.size();
+    triangles.reserve(nTriangles);
+    for(std::vector<Triangle3d> const &facetri : facetriangles)
+        triangles.insert(triangles.end(), facetri.begin(), facetri.end());
+
     return int(triangles.size());
 }
 
 
+int occ::shapeTriangulationWithOcc(const TopoDS_Shape &shape, OccMeshParams const &params, std::vector<Triangle3d> &triangles)
+{
+    return triangulateFaces(shape, params, triangles);
+}
+
+
+int occ::shellTriangulationWithOcc(const TopoDS_Shell &shell, OccMeshParams const &params, std::vector<Triangle3d> &triangles)
+{
+    return triangulateFaces(shell, params, triangles);
+}
+
+
 bool occ::importCADShapes(std::string const &filename, TopoDS_ListOfShape &shapes,
                           double &dimension, std::string &logmsg)
 {
@@ -1781,9 +1818,51 @@ bool occ::importBRep(std::string const &filename, TopoDS_ListOfShape &shapes, do
 }
 
 
+/**
+ * Returns the largest diagonal of the parametric bounds of the shape's faces, as a reference length of the shape.
+ * @return false if the length could not be calculated, in which case the error message is set.
+ */
+static bool shapeReferenceLength(TopoDS_Shape const &shape, double &dimension, std::string &error)
+{
+    dimension = 0.0;
+    BRepAdaptor_Surface adaptor;
+    TopExp_Explorer shapeExplorer;
+    for (shapeExplorer.Init(shape, TopAbs_FACE); shapeExplorer.More(); shapeExplorer.Next())
+    {
+        gp_Pnt P00,P01, P10, P11;
+        TopoDS_Face face = TopoDS::Face(shapeExplorer.Current());
+        adaptor.Initialize(face);
+        try
+        {
+            double umin = adaptor.FirstUParameter();
+            double umax = adaptor.LastUParameter();
+            double vmin = adaptor.FirstVParameter();
+            double vmax = adaptor.LastVParameter();
+            adaptor.D0(umin, vmin, P00);
+            adaptor.D0(umin, vmax, P01);
+            adaptor.D0(umax, vmax, P11);
+            adaptor.D0(umax, vmin, P10);
+        }
+        catch(Geom_UndefinedValue const &ex)
+        {
+            error  = "Exception raised when calculating object length: " + std::string(ex.GetMessageString());
+            error += "\n";
+            error += "Aborting\n";
+            return false;
+        }
+
+        dimension = std::max(dimension, P00.Distance(P11));
+        dimension = std::max(dimension, P01.Distance(P10));
+    }
+    return true;
+}
+
+
 bool occ::importSTEP(const std::string &filename, TopoDS_ListOfShape &shapes, double &dimension, std::string &logmsg)
 {
-    std::string msg;
+    // the file is read only once for as long as it is unchanged
+    if(OccTessellationCache::findSTEP(filename, shapes, dimension, logmsg)) return true;
+
     QString logg;
     QString strange;
 
@@ -1839,18 +1918,21 @@ bool occ::importSTEP(const std::string &filename, TopoDS_ListOfShape &shapes, do
         int nbr = aReader.NbRootsForTransfer();
         QString strong;
 
+        // the roots are transferred one at a time by the reader's transfer process;
+        // the analysis of the transferred shapes is then made in parallel
+        std::vector<TopoDS_Shape> rootshapes;
+        std::vector<int> nRootShapes(std::max(nbr, 0), 0);
+        std::vector<QString> rootlog(std::max(nbr, 0));
         for (Standard_Integer n=1; n<=nbr; n++)
         {
             try
             {
                 strong = QString::asprintf("   Transferring  root %d/%d\n", n, nbr);
-                logg += strong;
 
                 aReader.ClearShapes();
                 bool bOk = aReader.TransferRoot(n);
                 int nbs = aReader.NbShapes();
-                strong = QString::asprintf("      Loading %d shape(s)\n", nbs);
-                logg += strong;
+                rootlog[n-1] = strong + QString::asprintf("      Loading %d shape(s)\n", nbs);
 
 
                 IFSelect_PrintCount mode = IFSelect_ItemsByEntity;
@@ -1860,13 +1942,10 @@ bool occ::importSTEP(const std::string &filename, TopoDS_ListOfShape &shapes, do
                 {
                     for (int i=1; i<=nbs; i++)
                     {
-                        TopoDS_Shape aShape = aReader.Shape(i);
-                        shapes.Append(aShape);
-                        listShapeContent(aShape, msg, "      ");
-                        logg += QString::fromStdString(msg);
+                        rootshapes.push_back(aReader.Shape(i));
+                        nRootShapes[n-1]++;
                     }
                 }
-                logg += "\n";
             }
             catch(...)
             {
@@ -1875,55 +1954,37 @@ bool occ::importSTEP(const std::string &filename, TopoDS_ListOfShape &shapes, do
             }
         }
 
+        int nShapes = int(rootshapes.size());
+        std::vector<std::string> contents(nShapes), errors(nShapes);
+        std::vector<double> dimensions(nShapes, 0.0);
+        ThreadPool::pool().parallelFor(nShapes, [&](int iShape)
+        {
+            listShapeContent(rootshapes[iShape], contents[iShape], "      ");
+            shapeReferenceLength(rootshapes[iShape], dimensions[iShape], errors[iShape]);
+        });
+
+        int iShape = 0;
+        for(int n=0; n<nbr; n++)
+        {
+            logg += rootlog[n];
+            for(int k=0; k<nRootShapes[n]; k++, iShape++) logg += QString::fromStdString(contents[iShape]);
+            logg += "\n";
+        }
+
+        for(TopoDS_Shape const &aShape : rootshapes) shapes.Append(aShape);
         strange = QString::asprintf("   Imported %d shape(s)\n", shapes.Extent());
         logg += strange;
 
         // get some kind of reference dimension
         dimension=0.0;
-        BRepAdaptor_Surface adaptor;
-        for(TopoDS_ListIteratorOfListOfShape bodyIt(shapes); bodyIt.More(); bodyIt.Next())
+        for(int i=0; i<nShapes; i++)
         {
-            TopExp_Explorer shapeExplorer;
-            int iFace=0;
-            for (shapeExplorer.Init(bodyIt.Value(), TopAbs_FACE); shapeExplorer.More(); shapeExplorer.Next())
+            if(errors[i].length())
             {
-                double dx=0, dy=0, dz=0, d0=0, d1=0;
-                gp_Pnt P00,P01, P10, P11;
-                TopoDS_Face face = TopoDS::Face(shapeExplorer.Current());
-                adaptor.Initialize(face);
-                try
-                {
-                    double umin = adaptor.FirstUParameter();
-                    double umax = adaptor.LastUParameter();
-                    double vmin = adaptor.FirstVParameter();
-                    double vmax = adaptor.LastVParameter();
-                    adaptor.D0(umin, vmin, P00);
-                    adaptor.D0(umin, vmax, P01);
-                    adaptor.D0(umax, vmax, P11);
-                    adaptor.D0(umax, vmin, P10);
-                }
-                catch(Geom_UndefinedValue const &ex)
-                {
-
-                    strange  = "Exception raised when calculating object length: " + QString::fromStdString(ex.GetMessageString());
-                    strange += "\n";
-                    strange += "Aborting\n";
-                    logg += strange;
-
-                    return false;
-                }
-
-                dx = P00.X()-P11.X();   dy = P00.Y()-P11.Y();   dz = P00.Z()-P11.Z();
-                d0 = sqrt(dx*dx+dy*dy+dz*dz);
-                dimension = std::max(d0, dimension);
-
-                dx = P01.X()-P10.X();   dy = P01.Y()-P10.Y();   dz = P01.Z()-P10.Z();
-                d1 = sqrt(dx*dx+dy*dy+dz*dz);
-                dimension = std::max(d1, dimension);
-
-                iFace++;
+                logg += QString::fromStdString(errors[i]);
+                return false;
             }
-            (void)iFace;
+            dimension = std::max(dimension, dimensions[i]);
         }
 
         strong = QString::asprintf("   Reference length to display the model= %7.2f meters\n\n", dimension);
@@ -1947,6 +2008,7 @@ bool occ::importSTEP(const std::string &filename, TopoDS_ListOfShape &shapes, do
     logg += strange;
 
     logmsg = logg.toStdString();
+    OccTessellationCache::storeSTEP(filename, shapes, dimension, logmsg);
     return true;
 }
 
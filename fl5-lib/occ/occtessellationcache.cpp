@@ -0,0 +1,391 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepTools.hxx>
+#include <BRep_Builder.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <TopTools_FormatVersion.hxx>
+#include <TopTools_ListIteratorOfListOfShape.hxx>
+
+#include <occtessellationcache.h>
+#include <occmeshparams.h>
+
+
+bool OccTessellationCache::s_bEnabled(true);
+bool OccTessellationCache::s_bPersistent(false);
+std::string OccTessellationCache::s_CacheDir;
+std::unordered_map<uint64_t, std::vector<Triangle3d>> OccTessellationCache::s_Faces;
+std::unordered_map<std::string, OccTessellationCache::StepImport> OccTessellationCache::s_Steps;
+std::mutex OccTessellationCache::s_Mutex;
+
+
+/** incremented when the content of the keys or of the files changes, so that older entries are ignored */
+static int const s_CacheFormat = 1;
+
+
+static void hashBytes(uint64_t &key, void const *data, size_t size)
+{
+    // FNV-1a
+    unsigned char const *bytes = static_cast<unsigned char const*>(data);
+    for(size_t i=0; i<size; i++)
+    {
+        key ^= bytes[i];
+        key *= 1099511628211ULL;
+    }
+}
+
+
+static void hashInt(uint64_t &key, int i)       {hashBytes(key, &i, sizeof(int));}
+static void hashDouble(uint64_t &key, double d) {hashBytes(key, &d, sizeof(double));}
+
+
+std::string OccTessellationCache::cacheDirectory()
+{
+    if(!s_CacheDir.empty()) return s_CacheDir;
+    std::error_code ec;
+    std::filesystem::path dir = std::filesystem::temp_directory_path(ec);
+    if(ec) return std::string();
+    return (dir/"flow5_occ_cache").string();
+}
+
+
+/** Sets the directory of the cache files; the triangulations already loaded in memory are kept */
+void OccTessellationCache::setCacheDirectory(std::string const &dir)
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    s_CacheDir = dir;
+}
+
+
+/**
+ * The key of the triangulation of the face for the mesh parameters.
+ * The face is hashed through its BRep description without its triangulation, so that two copies
+ * of the same face share the key, and any change to the face's geometry or location changes it.
+ */
+uint64_t OccTessellationCache::faceKey(TopoDS_Face const &face, OccMeshParams const &params)
+{
+    uint64_t key = 14695981039346656037ULL;
+    hashInt(key, s_CacheFormat);
+
+    std::ostringstream stream;
+    BRepTools::Write(face, stream, Standard_False, Standard_False, TopTools_FormatVersion_CURRENT);
+    std::string const brep = stream.str();
+    hashBytes(key, brep.data(), brep.size());
+    hashInt(key, int(face.Orientation()));
+
+    hashInt(key, params.isRelativeDeflection() ? 1 : 0);
+    if(params.isRelativeDeflection()) hashDouble(key, params.deflectionRelative());
+    else                              hashDouble(key, params.deflectionAbsolute());
+    hashDouble(key, params.angularDeviation());
+
+    return key;
+}
+
+
+std::string OccTessellationCache::filePath(uint64_t key)
+{
+    std::string dir = cacheDirectory();
+    if(dir.empty()) return std::string();
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "occ_%016llx.tri", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(dir)/name).string();
+}
+
+
+/**
+ * Returns the triangulation of the face with this key, read from the cache file on first access if persistence is enabled.
+ * @return false if there is no entry for this key, in which case the array is unchanged.
+ */
+bool OccTessellationCache::findFace(uint64_t key, std::vector<Triangle3d> &triangles)
+{
+    if(!s_bEnabled) return false;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    auto it = s_Faces.find(key);
+    if(it!=s_Faces.end())
+    {
+        triangles = it->second;
+        return true;
+    }
+
+    if(!s_bPersistent) return false;
+
+    std::ifstream file(filePath(key), std::ios::binary);
+    if(!file) return false;
+
+    int format=0, n=0;
+    if(!file.read(reinterpret_cast<char*>(&format), sizeof(int)) || format!=s_CacheFormat) return false;
+    if(!file.read(reinterpret_cast<char*>(&n), sizeof(int)) || n<0) return false;
+
+    std::vector<double> values(size_t(n)*9);
+    if(!file.read(reinterpret_cast<char*>(values.data()), std::streamsize(values.size()*sizeof(double)))) return false;
+
+    std::vector<Triangle3d> &facetriangles = s_Faces[key];
+    facetriangles.reserve(n);
+    for(size_t i=0; i<values.size(); i+=9)
+    {
+        double const *v = values.data()+i;
+        facetriangles.push_back({Vector3d(v[0], v[1], v[2]), Vector3d(v[3], v[4], v[5]), Vector3d(v[6], v[7], v[8])});
+    }
+    triangles = facetriangles;
+    return true;
+}
+
+
+/** Adds the triangulation of a face to the cache and writes it to the key's file if persistence is enabled */
+void OccTessellationCache::storeFace(uint64_t key, std::vector<Triangle3d> const &triangles)
+{
+    if(!s_bEnabled) return;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    s_Faces[key] = triangles;
+
+    if(!s_bPersistent) return;
+
+    std::string path = filePath(key);
+    if(path.empty()) return;
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    // written to a temporary file first so that an interrupted write never leaves a partial entry
+    std::string temppath = path + ".tmp";
+    {
+        std::ofstream file(temppath, std::ios::binary | std::ios::trunc);
+        int n = int(triangles.size());
+        file.write(reinterpret_cast<char const*>(&s_CacheFormat), sizeof(int));
+        file.write(reinterpret_cast<char const*>(&n), sizeof(int));
+        for(Triangle3d const &t3 : triangles)
+        {
+            double v[9];
+            for(int ivtx=0; ivtx<3; ivtx++)
+            {
+                v[3*ivtx]   = t3.vertexAt(ivtx).x;
+                v[3*ivtx+1] = t3.vertexAt(ivtx).y;
+                v[3*ivtx+2] = t3.vertexAt(ivtx).z;
+            }
+            file.write(reinterpret_cast<char const*>(v), sizeof(v));
+        }
+        if(!file)
+        {
+            file.close();
+            std::filesystem::remove(temppath, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(temppath, path, ec);
+}
+
+
+bool OccTessellationCache::fileStamp(std::string const &filename, std::uintmax_t &size, std::time_t &time)
+{
+    std::error_code ec;
+    size = std::filesystem::file_size(filename, ec);
+    if(ec) return false;
+    std::filesystem::file_time_type ftime = std::filesystem::last_write_time(filename, ec);
+    if(ec) return false;
+    time = std::time_t(std::chrono::duration_cast<std::chrono::seconds>(ftime.time_since_epoch()).count());
+    return true;
+}
+
+
+/**
+ * Returns a copy of the shapes imported from the STEP file, if the file has not changed since it was imported.
+ * The shapes are copied so that the caller may modify them without altering the cached import.
+ * If persistence is enabled, the import is read from its sidecar file when it is not in memory.
+ */
+bool OccTessellationCache::findSTEP(std::string const &filename, TopoDS_ListOfShape &shapes, double &dimension, std::string &logmsg)
+{
+    if(!s_bEnabled) return false;
+
+    std::uintmax_t size=0;
+    std::time_t time=0;
+    if(!fileStamp(filename, size, time)) return false;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    auto it = s_Steps.find(filename);
+    if(it==s_Steps.end() || it->second.m_Size!=size || it->second.m_Time!=time)
+    {
+        if(!s_bPersistent) return false;
+        StepImport import;
+        if(!readSTEPFile(stepFilePath(filename, size, time), import)) return false;
+        import.m_Size = size;
+        import.m_Time = time;
+        it = s_Steps.insert_or_assign(filename, import).first;
+    }
+    StepImport const &import = it->second;
+
+    for(TopTools_ListIteratorOfListOfShape shapeIt(import.m_Shapes); shapeIt.More(); shapeIt.Next())
+    {
+        BRepBuilderAPI_Copy copier(shapeIt.Value(), Standard_True, Standard_False);
+        shapes.Append(copier.Shape());
+    }
+    dimension = import.m_Dimension;
+    logmsg = import.m_LogMsg;
+    return true;
+}
+
+
+void OccTessellationCache::storeSTEP(std::string const &filename, TopoDS_ListOfShape const &shapes, double dimension, std::string const &logmsg)
+{
+    if(!s_bEnabled) return;
+
+    StepImport import;
+    if(!fileStamp(filename, import.m_Size, import.m_Time)) return;
+
+    for(TopTools_ListIteratorOfListOfShape shapeIt(shapes); shapeIt.More(); shapeIt.Next())
+    {
+        BRepBuilderAPI_Copy copier(shapeIt.Value(), Standard_True, Standard_False);
+        import.m_Shapes.Append(copier.Shape());
+    }
+    import.m_Dimension = dimension;
+    import.m_LogMsg = logmsg;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    s_Steps[filename] = import;
+
+    if(s_bPersistent) writeSTEPFile(stepFilePath(filename, import.m_Size, import.m_Time), import);
+}
+
+
+/** The sidecar file of the STEP file's import, named after a hash of the file's path and stamp */
+std::string OccTessellationCache::stepFilePath(std::string const &filename, std::uintmax_t size, std::time_t time)
+{
+    std::string dir = cacheDirectory();
+    if(dir.empty()) return std::string();
+
+    uint64_t key = 14695981039346656037ULL;
+    hashInt(key, s_CacheFormat);
+    std::error_code ec;
+    std::string abspath = std::filesystem::absolute(filename, ec).string();
+    if(ec) abspath = filename;
+    hashBytes(key, abspath.data(), abspath.size());
+    hashBytes(key, &size, sizeof(size));
+    hashBytes(key, &time, sizeof(time));
+
+    char name[40];
+    std::snprintf(name, sizeof(name), "occ_step_%016llx.brep", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(dir)/name).string();
+}
+
+
+/**
+ * Reads an import from its sidecar file: a header with the format, the reference dimension and the
+ * length of the log, the log, then the shapes as the children of a single BRep compound.
+ */
+bool OccTessellationCache::readSTEPFile(std::string const &path, StepImport &import)
+{
+    if(path.empty()) return false;
+    std::ifstream file(path, std::ios::binary);
+    if(!file) return false;
+
+    int format=0;
+    size_t loglength=0;
+    if(!(file >> format) || format!=s_CacheFormat) return false;
+    if(!(file >> import.m_Dimension >> loglength)) return false;
+    file.get(); // the end of the header line
+    import.m_LogMsg.resize(loglength);
+    if(!file.read(import.m_LogMsg.data(), std::streamsize(loglength))) return false;
+
+    TopoDS_Shape compound;
+    BRep_Builder builder;
+    try
+    {
+        BRepTools::Read(compound, file, builder);
+    }
+    catch(...)
+    {
+        return false;
+    }
+    if(compound.IsNull()) return false;
+
+    import.m_Shapes.Clear();
+    for(TopoDS_Iterator it(compound); it.More(); it.Next()) import.m_Shapes.Append(it.Value());
+    return true;
+}
+
+
+void OccTessellationCache::writeSTEPFile(std::string const &path, StepImport const &import)
+{
+    if(path.empty()) return;
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    TopoDS_Compound compound;
+    BRep_Builder builder;
+    builder.MakeCompound(compound);
+    for(TopTools_ListIteratorOfListOfShape shapeIt(import.m_Shapes); shapeIt.More(); shapeIt.Next())
+        builder.Add(compound, shapeIt.Value());
+
+    // written to a temporary file first so that an interrupted write never leaves a partial entry
+    std::string temppath = path + ".tmp";
+    {
+        std::ofstream file(temppath, std::ios::binary | std::ios::trunc);
+        file.precision(17);
+        file << s_CacheFormat << " " << import.m_Dimension << " " << import.m_LogMsg.size() << "\n";
+        file.write(import.m_LogMsg.data(), std::streamsize(import.m_LogMsg.size()));
+        // the triangulations are not written, the faces are re-meshed through the face cache
+        BRepTools::Write(compound, file, Standard_False, Standard_False, TopTools_FormatVersion_CURRENT);
+        if(!file)
+        {
+            file.close();
+            std::filesystem::remove(temppath, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(temppath, path, ec);
+}
+
+
+/** Clears the entries loaded in memory and deletes the cache files */
+void OccTessellationCache::clear()
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    s_Faces.clear();
+    s_Steps.clear();
+
+    std::string dir = cacheDirectory();
+    if(dir.empty()) return;
+
+    std::error_code ec;
+    std::vector<std::filesystem::path> files;
+    for(std::filesystem::directory_iterator it(dir, ec), end; !ec && it!=end; it.increment(ec))
+    {
+        std::filesystem::path const &p = it->path();
+        std::string name = p.filename().string();
+        if(name.rfind("occ_", 0)==0 && (p.extension()==".tri" || p.extension()==".brep" || p.extension()==".tmp"))
+            files.push_back(p);
+    }
+    for(std::filesystem::path const &p : files) std::filesystem::remove(p, ec);
+}
+
@@ -26,7 +26,9 @@
 
 
 #include <quadmesh.h>
+#include <memorybudget.h>
 #include <geom_global.h>
+#include <threadpool.h>
 #include <units.h>
 #include <utils.h>
 
@@ -56,10 +58,16 @@ int QuadMesh::nWakeColumns() const
 
 void QuadMesh::rotate(double alpha, double beta, double phi)
 {
-    for(int i=0; i<nPanels(); i++)
+    // one composed rotation and one frame per panel, rather than three rotations of each node
+    Quaternion const Qt = rotationQuaternion(alpha, beta, phi);
+
+    int nBlocks = std::min(ThreadPool::nBlocks(ThreadPool::maxThreadCount()), std::max(1, nPanels()/1000));
+    int blockSize = nPanels()/nBlocks + 1;
+    ThreadPool::pool().parallelFor(nBlocks, [this, &Qt, blockSize](int iBlock)
     {
-        m_Panel4[i].rotate(alpha, beta, phi);
-    }
+        int iMax = std::min((iBlock+1)*blockSize, nPanels());
+        for(int i4=iBlock*blockSize; i4<iMax; i4++) m_Panel4[i4].rotate(Qt);
+    });
 }
 
 
@@ -463,6 +471,7 @@ void QuadMesh::addPanels(std::vector<Panel4>const &Panel4list)
 }
 
 
-
-
-
+size_t QuadMesh::memoryFootprint() const
+{
+    return XflMesh::memoryFootprint() + MemoryBudget::bytes(m_Panel4) + MemoryBudget::bytes(m_WakePanel4);
+}
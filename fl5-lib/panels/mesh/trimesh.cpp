@@ -24,14 +24,21 @@
 
 #include <QString>
 
+#include <array>
+#include <cmath>
+#include <map>
 #include <string>
 #include <iostream>
-#include <thread>
 
 
 #include <trimesh.h>
+#include <memorybudget.h>
 
+#include <pointhash.h>
+#include <threadpool.h>
+#include <trianglebvh.h>
 #include <units.h>
+#include <vector3darray.h>
 #include <utils.h>
 
 bool TriMesh::s_bCancel = false;
@@ -53,14 +60,14 @@ void TriMesh::rotate(double alpha, double beta, double phi)
 {
 //    auto t0 = std::chrono::high_resolution_clock::now();
 
-    Vector3d Origin;
+    // the three rotations are composed once, then each node is rotated in a single step
+    Quaternion const Qt = rotationQuaternion(alpha, beta, phi);
 
     for(uint in=0; in<m_Node.size(); in++)
     {
         Node &nd = m_Node[in];
-        if(fabs(phi)>ANGLEPRECISION)            nd.rotateX(Origin, phi);
-        if(fabs(beta)>ANGLEPRECISION)           nd.rotateZ(Origin, beta);
-        if(fabs(alpha)>ANGLEPRECISION)          nd.rotateY(Origin, alpha);
+        Qt.conjugate(nd);
+        Qt.conjugate(nd.normal());
     }
 
     rebuildPanelsFromNodes(m_Panel3, m_Node);
@@ -81,10 +88,15 @@ void TriMesh::rotatePanels(Vector3d const &O, Vector3d const &axis, double theta
         p3.rotate(O, axis, theta);
     }
 
-    for(uint in=0; in<m_Node.size(); in++)
-    {
-        m_Node[in].rotate(O, axis, theta);
-    }
+    // same as Node::rotate(), with the positions and the normals packed in vectorizable arrays
+    int const nn = nodeCount();
+    Vector3dArray pos, normal(nn);
+    pos.load(m_Node);
+    for(int in=0; in<nn; in++) normal.set(in, m_Node.at(in).normal());
+    pos.rotate(O, axis, theta);
+    normal.rotate(axis, theta);
+    pos.store(m_Node);
+    for(int in=0; in<nn; in++) m_Node[in].setNormal(normal.at(in));
 }
 
 
@@ -101,10 +113,11 @@ void TriMesh::translatePanels(double tx, double ty, double tz)
     {
         m_Panel3[i3].translate(tx, ty, tz);
     }
-    for(uint in=0; in<m_Node.size(); in++)
-    {
-        m_Node[in].translate(tx, ty, tz);
-    }
+
+    Vector3dArray pos;
+    pos.load(m_Node);
+    pos.translate(tx, ty, tz);
+    pos.store(m_Node);
 }
 
 
@@ -113,13 +126,24 @@ int TriMesh::makeNodeArrayFromPanels(int firstnodeindex, std::string &logmsg, st
 {
     clearNodes();
     m_Node.reserve(nPanels()*2);
+
+    PointHash nodehash(s_NodeMergeDistance);
+    nodehash.reserve(nPanels());
+    std::vector<int> candidates;
+
     for(int i3=0; i3<nPanels(); i3++)
     {
         Panel3 &p3 = m_Panel3[i3];
 
         for(int iv=0; iv<3; iv++)
         {
-            int iNode = isNode(p3.vertexAt(iv), s_NodeMergeDistance);
+            // same as isNode(): the last added node is preferred
+            int iNode = -1;
+            nodehash.candidates(p3.vertexAt(iv), candidates);
+            for(int idx : candidates)
+            {
+                if(idx>iNode && m_Node.at(idx).isSame(p3.vertexAt(iv), s_NodeMergeDistance)) iNode = idx;
+            }
 
             if(iNode>=0)
             {
@@ -134,6 +158,7 @@ int TriMesh::makeNodeArrayFromPanels(int firstnodeindex, std::string &logmsg, st
             if(iNode<0)
             {
                 iNode = nodeCount();
+                nodehash.insert(p3.vertexAt(iv), iNode);
                 addNode(p3.vertexAt(iv));
                 lastNode().setIndex(firstnodeindex + nodeCount()-1);
                 lastNode().setSurfacePosition(p3.surfacePosition());
@@ -240,6 +265,11 @@ void TriMesh::getMeshInfo(std::string &logmsg) const
 }
 
 
+/**
+ * Lists the panels which fail the quality tests.
+ * The metrics of the panels are independent and are evaluated concurrently in the thread pool;
+ * the lists and the log are then made in the order of the panels.
+ */
 void TriMesh::checkPanels(std::string &logmsg,
                           bool bSkinny, bool bMinAngle, bool bMinArea, bool bMinSize,
                           std::vector<int> &skinnylist, std::vector<int> &minanglelist, std::vector<int>&minarealist, std::vector<int>&minsizelist,
@@ -248,26 +278,56 @@ void TriMesh::checkPanels(std::string &logmsg,
     QString strong;
     QString log;
 
+    if(bSkinny) Panel3::setQualityFactor(qualityfactor);
+
+    int n3 = nPanels();
+    std::vector<double> quality(n3,0), radius(n3,0), shortest(n3,0), angle(n3,0), minlength(n3,0);
+    std::vector<unsigned char> skinny(n3,0), lowangle(n3,0);
+
+    int nBlocks = std::min(ThreadPool::nBlocks(ThreadPool::maxThreadCount()), std::max(1, n3/1000));
+    int blockSize = n3/nBlocks + 1;
+    ThreadPool::pool().parallelFor(nBlocks, [&](int iBlock)
+    {
+        int iMax = std::min((iBlock+1)*blockSize, n3);
+        for(int i3=iBlock*blockSize; i3<iMax; i3++)
+        {
+            Panel3 const &p3 = m_Panel3.at(i3);
+            if(bSkinny)
+            {
+                quality[i3] = p3.qualityFactor(radius[i3], shortest[i3]);
+                skinny[i3] = p3.isSkinny() ? 1 : 0;
+            }
+            if(bMinAngle)
+            {
+                lowangle[i3] = p3.isLowAngle(minangle) ? 1 : 0;
+                if(lowangle[i3]) angle[i3] = p3.minAngle();
+            }
+            if(bMinSize)
+            {
+                double length(LARGEVALUE);
+                for(int iedge=0; iedge<3; iedge++) length = std::min(length, p3.edge(iedge).length());
+                minlength[i3] = length;
+            }
+        }
+    });
+
     //list skinny triangles
     int count(0);
-    double q(0),r(0),e(0);
 
     if(bSkinny)
     {
-        Panel3::setQualityFactor(qualityfactor);
-        for(int i3=0; i3<nPanels(); i3++)
+        for(int i3=0; i3<n3; i3++)
         {
             Panel3 const &p3 = m_Panel3.at(i3);
-            q = p3.qualityFactor(r,e);
-            if(p3.isSkinny())
+            if(skinny.at(i3))
             {
                 skinnylist.push_back(p3.index());
                 count++;
-                strong = QString::asprintf("   Panel %4d is skinny:  qual.=%5.2f", p3.index(), q);
+                strong = QString::asprintf("   Panel %4d is skinny:  qual.=%5.2f", p3.index(), quality.at(i3));
                 log += strong;
-                strong = QString::asprintf(", CC radius=%5.2f", r*Units::mtoUnit());
+                strong = QString::asprintf(", CC radius=%5.2f", radius.at(i3)*Units::mtoUnit());
                 log += strong + Units::lengthUnitQLabel();
-                strong = QString::asprintf(", min. edge=%5.2f", e*Units::mtoUnit());
+                strong = QString::asprintf(", min. edge=%5.2f", shortest.at(i3)*Units::mtoUnit());
                 log += strong + Units::lengthUnitQLabel() + "\n";
             }
         }
@@ -287,14 +347,14 @@ void TriMesh::checkPanels(std::string &logmsg,
     {
         count=0;
 
-        for(int i3=0; i3<nPanels(); i3++)
+        for(int i3=0; i3<n3; i3++)
         {
             Panel3 const &p3 = m_Panel3.at(i3);
-            if(p3.isLowAngle(minangle))
+            if(lowangle.at(i3))
             {
                 minanglelist.push_back(p3.index());
                 count++;
-                strong = QString::asprintf("   Panel %4d has min angle %5.1f", p3.index(), p3.minAngle());
+                strong = QString::asprintf("   Panel %4d has min angle %5.1f", p3.index(), angle.at(i3));
                 strong += DEGch + "\n";
                 log += strong;
             }
@@ -319,7 +379,7 @@ void TriMesh::checkPanels(std::string &logmsg,
         // list triangles with area below threshold
         count=0;
 
-        for(int i3=0; i3<nPanels(); i3++)
+        for(int i3=0; i3<n3; i3++)
         {
             Panel3 const &p3 = m_Panel3.at(i3);
             if(fabs(p3.area())<minarea)
@@ -329,7 +389,6 @@ void TriMesh::checkPanels(std::string &logmsg,
                 strong = QString::asprintf("   Panel %4d has area %9g ", p3.index(), p3.area()*Units::m2toUnit());
                 log += strong + Units::areaUnitQLabel() +"\n";
             }
-            //                else m_PanelHightlight.insert(i3, false);
         }
 
 
@@ -349,22 +408,14 @@ void TriMesh::checkPanels(std::string &logmsg,
         // list triangles with edge length below threshold
         count=0;
 
-        for(int i3=0; i3<nPanels(); i3++)
+        for(int i3=0; i3<n3; i3++)
         {
             Panel3 const &p3 = m_Panel3.at(i3);
-            double length(LARGEVALUE);
-            for(int iedge=0; iedge<3; iedge++)
-            {
-                if(p3.edge(iedge).length()<length)
-                {
-                    length = p3.edge(iedge).length();
-                }
-            }
-            if(length<minsize)
+            if(minlength.at(i3)<minsize)
             {
                 minsizelist.push_back(p3.index());
                 count++;
-                strong = QString::asprintf("   Panel %4d has edge length %9g ", p3.index(), length*Units::mtoUnit());
+                strong = QString::asprintf("   Panel %4d has edge length %9g ", p3.index(), minlength.at(i3)*Units::mtoUnit());
                 log += strong + Units::lengthUnitQLabel() +"\n";
             }
         }
@@ -385,6 +436,161 @@ void TriMesh::checkPanels(std::string &logmsg,
 }
 
 
+/**
+ * Finds the pairs of panels which intersect or which overlap, e.g. at the junction of two parts
+ * meshed separately, or when a part is duplicated. Such meshes make the influence matrix singular
+ * or ill-conditioned, and are best rejected before the matrix is built.
+ *
+ * Two panels intersect if an edge of one crosses the inside of the other. Two panels overlap if they
+ * are nearly parallel and the centroid of one projects inside the other at a distance less than
+ * gap times the shortest edge of either panel. The panels that share a node, by index or by position,
+ * are not tested, since they are connected.
+ *
+ * The candidate pairs are found with a bounding volume hierarchy of the panels, and the panels are
+ * processed concurrently in the thread pool.
+ * @param gap the max. distance of overlapping panels, relative to the panels' shortest edge
+ * @param intersectlist the indexes of the intersecting panels, sorted
+ * @param overlaplist the indexes of the overlapping panels, sorted
+ * @return the number of pairs of intersecting or overlapping panels
+ */
+int TriMesh::checkIntersections(std::string &logmsg, double gap, std::vector<int> &intersectlist, std::vector<int> &overlaplist, bool bMultiThreaded) const
+{
+    logmsg.clear();
+    intersectlist.clear();
+    overlaplist.clear();
+
+    int n3 = nPanels();
+    std::vector<Triangle3d> triangles(n3);
+    std::vector<double> shortest(n3, 0.0);
+    for(int i3=0; i3<n3; i3++)
+    {
+        Panel3 const &p3 = m_Panel3.at(i3);
+        triangles[i3] = Triangle3d(p3.vertexAt(0), p3.vertexAt(1), p3.vertexAt(2));
+        shortest[i3] = triangles.at(i3).minEdgeLength();
+    }
+
+    TriangleBVH bvh;
+    bvh.build(triangles);
+
+    double const PARALLEL = cos(5.0*PI/180.0);
+
+    struct PanelPair
+    {
+        int m_i0, m_i1;
+        bool m_bIntersect;
+    };
+
+    int nBlocks = bMultiThreaded ? std::min(ThreadPool::nBlocks(ThreadPool::maxThreadCount()), std::max(1, n3/500)) : 1;
+    int blockSize = n3/nBlocks + 1;
+    std::vector<std::vector<PanelPair>> blockpairs(nBlocks);
+
+    ThreadPool::pool().parallelFor(nBlocks, [&](int iBlock)
+    {
+        std::vector<int> candidates;
+        Vector3d I, proj;
+        int iMax = std::min((iBlock+1)*blockSize, n3);
+        for(int i0=iBlock*blockSize; i0<iMax; i0++)
+        {
+            Triangle3d const &t0 = triangles.at(i0);
+            if(t0.isNull()) continue;
+            Panel3 const &p0 = m_Panel3.at(i0);
+
+            Vector3d boxmin = t0.vertexAt(0), boxmax = t0.vertexAt(0);
+            for(int iv=1; iv<3; iv++)
+            {
+                Vector3d const &S = t0.vertexAt(iv);
+                boxmin.set(std::min(boxmin.x, S.x), std::min(boxmin.y, S.y), std::min(boxmin.z, S.z));
+                boxmax.set(std::max(boxmax.x, S.x), std::max(boxmax.y, S.y), std::max(boxmax.z, S.z));
+            }
+            double pad = gap*shortest.at(i0);
+            boxmin -= Vector3d(pad, pad, pad);
+            boxmax += Vector3d(pad, pad, pad);
+
+            bvh.overlappingTriangles(boxmin, boxmax, candidates);
+            for(int i1 : candidates)
+            {
+                if(i1<=i0) continue; // each pair once
+                Triangle3d const &t1 = triangles.at(i1);
+                Panel3 const &p1 = m_Panel3.at(i1);
+
+                double tol = gap*std::min(shortest.at(i0), shortest.at(i1));
+
+                bool bConnected = false;
+                for(int iv=0; iv<3 && !bConnected; iv++)
+                {
+                    if(p1.hasVertex(p0.nodeIndex(iv))) bConnected = true;
+                    for(int jv=0; jv<3 && !bConnected; jv++)
+                        if(t0.vertexAt(iv).isSame(t1.vertexAt(jv), std::max(tol, LENGTHPRECISION))) bConnected = true;
+                }
+                if(bConnected) continue;
+
+                // overlap
+                if(fabs(t0.normal().dot(t1.normal()))>PARALLEL)
+                {
+                    bool bOverlap = false;
+                    if(t1.containsPointProjection(t0.CoG_g(), proj, 0.0) && (proj-t0.CoG_g()).norm()<tol) bOverlap = true;
+                    if(t0.containsPointProjection(t1.CoG_g(), proj, 0.0) && (proj-t1.CoG_g()).norm()<tol) bOverlap = true;
+                    if(bOverlap)
+                    {
+                        blockpairs[iBlock].push_back({i0, i1, false});
+                        continue;
+                    }
+                }
+
+                // intersection: an edge crosses the inside of the other triangle away from the edge's ends
+                bool bIntersect = false;
+                for(int k=0; k<2 && !bIntersect; k++)
+                {
+                    Triangle3d const &ta = k==0 ? t0 : t1;
+                    Triangle3d const &tb = k==0 ? t1 : t0;
+                    for(int ie=0; ie<3 && !bIntersect; ie++)
+                    {
+                        Segment3d const &seg = ta.edge(ie);
+                        if(!tb.intersectSegmentInside(seg, I, false)) continue;
+                        if(I.distanceTo(seg.vertexAt(0))>tol && I.distanceTo(seg.vertexAt(1))>tol) bIntersect = true;
+                    }
+                }
+                if(bIntersect) blockpairs[iBlock].push_back({i0, i1, true});
+            }
+        }
+    });
+
+    QString log, strong;
+    int nPairs = 0;
+    for(std::vector<PanelPair> const &pairs : blockpairs)
+    {
+        for(PanelPair const &pp : pairs)
+        {
+            int i0 = m_Panel3.at(pp.m_i0).index();
+            int i1 = m_Panel3.at(pp.m_i1).index();
+            std::vector<int> &list = pp.m_bIntersect ? intersectlist : overlaplist;
+            list.push_back(i0);
+            list.push_back(i1);
+            if(pp.m_bIntersect) strong = QString::asprintf("   Panels %4d and %4d intersect\n", i0, i1);
+            else                strong = QString::asprintf("   Panels %4d and %4d overlap\n", i0, i1);
+            log += strong;
+            nPairs++;
+        }
+    }
+
+    for(std::vector<int> *pList : {&intersectlist, &overlaplist})
+    {
+        std::sort(pList->begin(), pList->end());
+        pList->erase(std::unique(pList->begin(), pList->end()), pList->end());
+    }
+
+    if(nPairs==0) log += "   No intersecting or overlapping panels found\n\n";
+    else
+    {
+        strong = QString::asprintf("   Found %d intersecting and %d overlapping panels\n\n", int(intersectlist.size()), int(overlaplist.size()));
+        log += strong;
+    }
+
+    logmsg = log.toStdString();
+    return nPairs;
+}
+
+
 void TriMesh::listPanels(bool bConnections)
 {
     QString strange;
@@ -511,14 +717,32 @@ void TriMesh::makeConnectionsFromNodePosition2(int i0, int np0, double MERGEDIST
         return;
     }
 
+    // hash the edges on their mid-points; two edges which are the same to within the merge distance
+    // have mid-points in neighbouring cells
+    PointHash edgehash(MERGEDISTANCE);
+    edgehash.reserve(3*np0);
+    for(int it=i0; it<i0+np0; it++)
+    {
+        for(int ie=0; ie<3; ie++) edgehash.insert(panelAt(it).edge(ie).midPoint(), it);
+    }
+
+    std::vector<int> candidates, neighbours;
     for(int it0=i0; it0<i0+np0; it0++)
     {
         Panel3 &p0 = panel(it0);
-        // search starting from the base panel's index
-        // since neighbours are likely to have a close index
         if(p0.neighbourCount()==3) continue;  // no further connections for this panel
 
-        for(int it1=i0; it1<i0+np0; it1++)
+        // only the panels with an edge close to one of p0's edges can be connected
+        neighbours.clear();
+        for(int ie=0; ie<3; ie++)
+        {
+            edgehash.candidates(p0.edge(ie).midPoint(), candidates);
+            neighbours.insert(neighbours.end(), candidates.begin(), candidates.end());
+        }
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+
+        for(int it1 : neighbours)
         {
             if(it0==it1) continue; // do not connect the panel to itself
             Panel3 &p1 = panel(it1);
@@ -588,136 +812,86 @@ void TriMesh::makeConnectionsFromNodePosition(bool bConnectTE, bool bMultiThread
 {
     s_bCancel = false;
 
-    if(bMultiThread)
-    {
-        int nThreads = std::thread::hardware_concurrency();
+    double const MAXDISTANCE = 1.e-4;
 
-        m_nBlocks = nThreads;
-    }
-    else
-        m_nBlocks = 1;
+    if(bMultiThread) m_nBlocks = ThreadPool::nBlocks(ThreadPool::maxThreadCount());
+    else             m_nBlocks = 1;
 
     // Find neighbours with common edge.
     // If the panel is trailing, do not connect to the opposite surface to prevent incorrect Cp calculations
     clearConnections();
 
-    if(bMultiThread)
+    // hash the edges on their mid-points; two edges which are the same to within the merge distance
+    // have mid-points in neighbouring cells
+    PointHash edgehash(MAXDISTANCE);
+    edgehash.reserve(3*nPanels());
+    for(int i3=0; i3<nPanels(); i3++)
     {
-        std::vector<std::thread> threads;
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            threads.push_back(std::thread(&TriMesh::connectPanelBlock, this, iBlock, bConnectTE));
-        }
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            threads[iBlock].join();
-        }
-//        std::cout << "TriMesh::makeConnectionsFromNodePosition joined all " << m_nBlocks << " threads" <<std::endl;
-
+        for(int ie=0; ie<3; ie++) edgehash.insert(m_Panel3.at(i3).edge(ie).midPoint(), i3);
     }
-    else
+
+    ThreadPool::pool().parallelFor(m_nBlocks, [this, bConnectTE, MAXDISTANCE, &edgehash](int iBlock)
     {
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            connectPanelBlock(iBlock, bConnectTE);
-        }
-    }
+        connectPanelBlock(iBlock, bConnectTE, MAXDISTANCE, edgehash);
+    });
 
 //    listMesh(true);
 }
 
 
-void TriMesh::connectPanelBlock(int iBlock, bool bConnectTE)
+void TriMesh::connectPanelBlock(int iBlock, bool bConnectTE, double maxdistance, PointHash const &edgehash)
 {
-    double const MAXDISTANCE = 1.e-4;
     int blockSize = int(double(nPanels())/double(m_nBlocks)) +1;
     int iStart = iBlock*blockSize;
     int maxRows = nPanels();
     int iMax = std::min(iStart+blockSize, maxRows);
 
+    std::vector<int> candidates, neighbours;
+
     // set panel neighbours
     for(int it0=iStart; it0<iMax; it0++)
     {
         Panel3 &p3 = m_Panel3[it0];
-        // search starting from the base panel's index
-        // since neighbour indexes are likely to be close
 
-        int it2m = it0;
-        int it2p = it0;
+        // only the panels with an edge close to one of p3's edges can be connected
+        neighbours.clear();
+        for(int ie=0; ie<3; ie++)
+        {
+            edgehash.candidates(p3.edge(ie).midPoint(), candidates);
+            for(int it2 : candidates) if(it2!=it0) neighbours.push_back(it2);
+        }
 
-        do
+        // visit the panels in the order of the outward search from the base panel's index, i.e. it0+1, it0-1, it0+2...
+        // so that the result is the same as with the exhaustive search for non-manifold meshes
+        std::sort(neighbours.begin(), neighbours.end(), [it0](int i0, int i1)
         {
-            it2m--;
-            it2p++;
-//            if(p3.neighbourCount()==3) break;
-            if(it2p<nPanels())
-            {
-                Panel3 const & p2 = m_Panel3.at(it2p);
+            int d0 = std::abs(i0-it0), d1 = std::abs(i1-it0);
+            return d0!=d1 ? d0<d1 : i0>i1;
+        });
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
 
-                if(p3.isTrailing() && !bConnectTE)
-                {
-                    if(!p2.isOppositeSurface(p3.surfacePosition())) // do not connect opposite Trailing edge panels
-                    {
-                        for(int iEdge=0; iEdge<3; iEdge++)
-                        {
-                            int nEdge = p3.edgeIndex(p2.edge(iEdge), MAXDISTANCE);
-                            if(nEdge>=0)
-                            {
-                                p3.setNeighbour(it2p, nEdge);
-                                break;
-                            }
-                        }
-                    }
-                }
-                else
-                {
-                    for(int ie=0; ie<3; ie++)
-                    {
-                        int nEdge = p3.edgeIndex(p2.edge(ie), MAXDISTANCE);
-                        if(nEdge>=0)
-                        {
-                            p3.setNeighbour(it2p, nEdge);
-                            break;
-                        }
-                    }
-                }
-            }
+        int dist = 0;
+        for(int it2 : neighbours)
+        {
+            int d = std::abs(it2-it0);
+            if(d>dist && p3.neighbourCount()>=3) break;
+            dist = d;
 
-            if(it2m>=0)
-            {
-                Panel3 const & p2 = m_Panel3.at(it2m);
+            Panel3 const & p2 = m_Panel3.at(it2);
 
-                if(p3.isTrailing() && !bConnectTE)
-                {
-                    if(!p2.isOppositeSurface(p3.surfacePosition())) // do not connect opposite Trailing edge panels
-                    {
-                        for(int iEdge=0; iEdge<3; iEdge++)
-                        {
-                            int nEdge = p3.edgeIndex(p2.edge(iEdge), MAXDISTANCE);
-                            if(nEdge>=0)
-                            {
-                                p3.setNeighbour(it2m, nEdge);
-                                break;
-                            }
-                        }
-                    }
-                }
-                else
+            // do not connect opposite Trailing edge panels
+            if(p3.isTrailing() && !bConnectTE && p2.isOppositeSurface(p3.surfacePosition())) continue;
+
+            for(int ie=0; ie<3; ie++)
+            {
+                int nEdge = p3.edgeIndex(p2.edge(ie), maxdistance);
+                if(nEdge>=0)
                 {
-                    for(int ie=0; ie<3; ie++)
-                    {
-                        int nEdge = p3.edgeIndex(p2.edge(ie), MAXDISTANCE);
-                        if(nEdge>=0)
-                        {
-                            p3.setNeighbour(it2m, nEdge);
-                            break;
-                        }
-                    }
+                    p3.setNeighbour(it2, nEdge);
+                    break;
                 }
             }
         }
-        while(p3.neighbourCount()<3 && (it2p<nPanels() || it2m>=0));
 
         if(s_bCancel) break;
     }
@@ -820,29 +994,48 @@ void TriMesh::makeConnectionsFromNodeIndexes(int i0, int n0, int i1, int n1)
 }
 
 
+/**
+ * Makes the lists of the neighbour nodes and triangles of each node.
+ * Single pass over the panels; the panels are visited in the same order for each node
+ * as in a node by node search, so that the lists are unchanged.
+ */
 void TriMesh::connectNodes()
 {
     for(int in=0; in<nNodes(); in++)
+        m_Node[in].clearNeighbourNodes();
+
+    for(int i3=0; i3<nPanels(); i3++)
     {
-        Node& nd = m_Node[in];
-        nd.clearNeighbourNodes();
-        for(int i3=0; i3<nPanels(); i3++)
+        Panel3 const &p3 = m_Panel3.at(i3);
+        for(int ivtx=0; ivtx<3; ivtx++)
         {
-            Panel3 const &p3 = panel(i3);
-            if(p3.hasVertex(in))
+            int in = p3.nodeIndex(ivtx);
+            if(in<0 || in>=nNodes()) continue;
+            // process each node only once if the panel is degenerate
+            bool bDone = false;
+            for(int jvtx=0; jvtx<ivtx; jvtx++)
             {
-                if(p3.isTrailingEdgeNode(in))
-                {
-                    // connect only if triangle is on same side as node
-                    if(p3.surfacePosition()!=nd.surfacePosition())  continue;
-                }
-                // add all the panel's vertices as neighbours.
-                nd.addTriangleIndex(p3.index());
-                nd.addNeighbourIndex(p3.nodeIndex(0));
-                nd.addNeighbourIndex(p3.nodeIndex(1));
-                nd.addNeighbourIndex(p3.nodeIndex(2));
+                if(p3.nodeIndex(jvtx)==in) bDone = true;
             }
+            if(bDone) continue;
+
+            Node& nd = m_Node[in];
+            if(p3.isTrailingEdgeNode(in))
+            {
+                // connect only if triangle is on same side as node
+                if(p3.surfacePosition()!=nd.surfacePosition())  continue;
+            }
+            // add all the panel's vertices as neighbours.
+            nd.addTriangleIndex(p3.index());
+            nd.addNeighbourIndex(p3.nodeIndex(0));
+            nd.addNeighbourIndex(p3.nodeIndex(1));
+            nd.addNeighbourIndex(p3.nodeIndex(2));
         }
+    }
+
+    for(int in=0; in<nNodes(); in++)
+    {
+        Node& nd = m_Node[in];
         if(nd.neighbourNodeCount()==0)
         {
             // hanging node
@@ -882,6 +1075,138 @@ int TriMesh::cleanNullTriangles()
 }
 
 
+/**
+ * Splits the flagged triangles in four at the mid-points of their edges, and keeps the mesh conforming:
+ * a triangle with two split edges is split in four as well, and the triangle with one split edge in two.
+ * The edges are matched by the positions of their end points, so that the triangles of different parts
+ * and the top and bottom triangles on each side of a trailing edge are split consistently.
+ * The children keep the parent's properties; those which lie on the parent's trailing edge, i.e. its edge 0,
+ * remain trailing, with their own edge 0 on the trailing edge.
+ * The node array is rebuilt; the connections must be made again.
+ * @param bRefine the flag of each panel
+ * @param parent the index of the parent of each new panel
+ * @param weights the weights of the parent's vertices for each vertex of the new panels, 9 per panel,
+ *        so that the vertex values of a solution can be transferred to the new mesh
+ * @return the number of panels which have been split
+ */
+int TriMesh::refinePanels(std::vector<bool> const &bRefine, std::vector<int> &parent, std::vector<double> &weights, std::string &logmsg)
+{
+    typedef std::array<std::int64_t,3> PointKey;
+    typedef std::pair<PointKey, PointKey> EdgeKey;
+
+    double const d = s_NodeMergeDistance>0.0 ? s_NodeMergeDistance : 1.e-6;
+    auto pointKey = [d](Vector3d const &P) {return PointKey{std::llround(P.x/d), std::llround(P.y/d), std::llround(P.z/d)};};
+    auto edgeKey  = [&pointKey](Vector3d const &A, Vector3d const &B)
+    {
+        PointKey ka = pointKey(A), kb = pointKey(B);
+        return ka<kb ? EdgeKey(ka,kb) : EdgeKey(kb,ka);
+    };
+
+    int N = nPanels();
+    // the edges are numbered by their first vertex: edge k joins vertices k and k+1
+    std::vector<std::array<EdgeKey,3>> edges(N);
+    std::map<EdgeKey, bool> split;
+    for(int i3=0; i3<N; i3++)
+    {
+        Panel3 const &p3 = m_Panel3.at(i3);
+        for(int k=0; k<3; k++)
+        {
+            edges[i3][k] = edgeKey(p3.vertexAt(k), p3.vertexAt(k+1));
+            bool &bSplit = split[edges[i3][k]];
+            if(i3<int(bRefine.size()) && bRefine.at(i3)) bSplit = true;
+        }
+    }
+
+    // closure: the triangles with two split edges are split in four
+    bool bChanged = true;
+    while(bChanged)
+    {
+        bChanged = false;
+        for(int i3=0; i3<N; i3++)
+        {
+            int nSplit = 0;
+            for(int k=0; k<3; k++) if(split.at(edges[i3][k])) nSplit++;
+            if(nSplit==2)
+            {
+                for(int k=0; k<3; k++) split[edges[i3][k]] = true;
+                bChanged = true;
+            }
+        }
+    }
+
+    // the local vertices: 0, 1, 2, then the mid-points 3=(0,1), 4=(1,2), 5=(2,0)
+    static double const w[6][3] = {{1,0,0}, {0,1,0}, {0,0,1}, {0.5,0.5,0}, {0,0.5,0.5}, {0.5,0,0.5}};
+    std::vector<Panel3> panels;
+    panels.reserve(N*2);
+    parent.clear();
+    weights.clear();
+    int nSplitPanels = 0;
+
+    for(int i3=0; i3<N; i3++)
+    {
+        Panel3 const &p3 = m_Panel3.at(i3);
+        bool s[3];
+        int nSplit = 0;
+        for(int k=0; k<3; k++)
+        {
+            s[k] = split.at(edges[i3][k]);
+            if(s[k]) nSplit++;
+        }
+
+        std::vector<std::array<int,3>> children;
+        if(nSplit==0)      children = {{0,1,2}};
+        else if(nSplit==3) children = {{0,3,5}, {3,1,4}, {5,4,2}, {3,4,5}};
+        else if(s[0])      children = {{0,3,2}, {3,1,2}};
+        else if(s[1])      children = {{0,1,4}, {0,4,2}};
+        else               children = {{0,1,5}, {5,1,2}};
+
+        if(nSplit>0) nSplitPanels++;
+
+        Node vtx[6];
+        for(int iv=0; iv<3; iv++) vtx[iv] = p3.vertexAt(iv);
+        vtx[3] = Node((p3.vertexAt(0)+p3.vertexAt(1))*0.5);
+        vtx[4] = Node((p3.vertexAt(1)+p3.vertexAt(2))*0.5);
+        vtx[5] = Node((p3.vertexAt(2)+p3.vertexAt(0))*0.5);
+
+        for(std::array<int,3> c : children)
+        {
+            // a child with two vertices on the trailing edge 1-2 is rotated so that they are its vertices 1 and 2
+            bool bTrailing = false;
+            if(p3.isTrailing())
+            {
+                auto onTE = [](int iv) {return iv==1 || iv==2 || iv==4;};
+                for(int r=0; r<3 && !bTrailing; r++)
+                {
+                    if(!onTE(c[0]) && onTE(c[1]) && onTE(c[2])) bTrailing = true;
+                    else std::rotate(c.begin(), c.begin()+1, c.end());
+                }
+            }
+
+            panels.push_back(Panel3(vtx[c[0]], vtx[c[1]], vtx[c[2]]));
+            Panel3 &child = panels.back();
+            child.setSurfacePosition(p3.surfacePosition());
+            child.setFromSTL(p3.bFromSTL());
+            child.setLeftSidePanel(p3.isLeftSidePanel());
+            child.setTrailing(bTrailing);
+            child.setIndex(int(panels.size())-1);
+
+            parent.push_back(i3);
+            for(int iv=0; iv<3; iv++) weights.insert(weights.end(), w[c[iv]], w[c[iv]]+3);
+        }
+    }
+
+    m_Panel3 = std::move(panels);
+    m_WakePanel3.clear();
+
+    QString strong = QString::asprintf("Split %d panels: %d panels increased to %d\n", nSplitPanels, N, nPanels());
+    logmsg += strong.toStdString();
+
+    std::string prefix;
+    makeNodeArrayFromPanels(0, logmsg, prefix);
+    return nSplitPanels;
+}
+
+
 int TriMesh::cleanDoubleNodes(double precision, std::string &logmsg, std::string const &prefx)
 {
     return cleanDoubleNodes(m_Panel3, m_Node, precision, logmsg, prefx);
@@ -894,66 +1219,77 @@ int TriMesh::cleanDoubleNodes(std::vector<Panel3> &panel3, std::vector<Node> &no
     QString log;
     QString prefix = QString::fromStdString(prefx);
 
-    std::vector<int> doublenodes;
+    int nNodes = int(nodes.size());
+
+    // map each node to the first node at the same position; only the nodes which are kept are hashed
+    PointHash nodehash(precision);
+    nodehash.reserve(nNodes);
+    std::vector<int> candidates;
+    std::vector<int> target(nNodes);
+    int nDouble = 0;
+    for(int in=0; in<nNodes; in++)
+    {
+        target[in] = in;
+        nodehash.candidates(nodes.at(in), candidates);
+        for(int ic : candidates)
+        {
+            if(ic<target[in] && nodes.at(ic).isSame(nodes.at(in), precision)) target[in] = ic;
+        }
+
+        if(target[in]!=in)
+        {
+            // make a middle node
+            nodes[in].setPosition(nodes.at(target[in]));
+            nDouble++;
+        }
+        else
+            nodehash.insert(nodes.at(in), in);
+    }
+
+    // re-index the triangles with the duplicate nodes
     std::vector<int> modpanels;
-    for(uint in0=0; in0<nodes.size(); in0++)
+    for(int i3=0; i3<int(panel3.size()); i3++)
     {
-        for(int in1=in0+1; in1<int(nodes.size()); in1++)
+        Panel3 &p3 = panel3[i3];
+        bool bModified = false;
+        for(int iv=0; iv<3; iv++)
         {
-            if(nodes.at(in1).isSame(nodes.at(in0), precision))
+            int idx = p3.nodeIndex(iv);
+            if(idx>=0 && idx<nNodes && target.at(idx)!=idx)
             {
-                // make a middle node
-                nodes[in1].setPosition(nodes.at(in0));
-                // re-index the triangles with node in1
-                for(int i3=0; i3<int(panel3.size()); i3++)
-                {
-                    Panel3 &p3 = panel3[i3];
-                    if(p3.nodeIndex(0)==in1)
-                    {
-                        p3.setVertex(0, nodes[in0]);
-                        if(std::find(modpanels.begin(), modpanels.end(), p3.index()) == modpanels.end())
-                            modpanels.push_back(i3);
-                    }
-                    if(p3.nodeIndex(1)==in1)
-                    {
-                        p3.setVertex(1, nodes[in0]);
-                        if(std::find(modpanels.begin(), modpanels.end(), p3.index()) == modpanels.end())
-                            modpanels.push_back(i3);
-                    }
-                    if(p3.nodeIndex(2)==in1)
-                    {
-                        p3.setVertex(2, nodes[in0]);
-                        if(std::find(modpanels.begin(), modpanels.end(), p3.index()) == modpanels.end())
-                            modpanels.push_back(i3);
-                    }
-                }
-                // add in1 to the list of nodes to remove
-                if((std::find(doublenodes.begin(), doublenodes.end(), in1) == doublenodes.end()))
-                    doublenodes.push_back(in1);
+                p3.setVertex(iv, nodes[target.at(idx)]);
+                bModified = true;
             }
         }
+        if(bModified) modpanels.push_back(i3);
     }
 
-    std::sort(doublenodes.begin(), doublenodes.end());
     // remove the duplicate nodes
-    for(int in=int(doublenodes.size())-1; in>=0; in--)
+    int nKept = 0;
+    for(int in=0; in<nNodes; in++)
     {
-        nodes.erase(nodes.begin() + doublenodes.at(in));
+        if(target.at(in)==in)
+        {
+            if(nKept!=in) nodes[nKept] = nodes.at(in);
+            nKept++;
+        }
     }
+    nodes.resize(nKept);
 
-    log = prefix + QString::asprintf("Removed %d nodes\n", int(doublenodes.size()));
+    log = prefix + QString::asprintf("Removed %d nodes\n", nDouble);
     log += prefix + QString::asprintf("New node count is %d \n", int(nodes.size()));
 
     if(modpanels.size())
     {
+        // the modified panels are in increasing order, so that the null panels can be erased from the end
         for(int i3=int(modpanels.size())-1; i3>=0; i3--)
         {
             Panel3 &p3 = panel3[modpanels.at(i3)];
             p3.setFrame();
             if(p3.isNullTriangle())
             {
-                panel3.erase(panel3.begin()+modpanels.at(i3));
                 log += prefix + QString::asprintf("removing null panel %d\n", p3.index());
+                panel3.erase(panel3.begin()+modpanels.at(i3));
             }
             else
             {
@@ -965,7 +1301,7 @@ int TriMesh::cleanDoubleNodes(std::vector<Panel3> &panel3, std::vector<Node> &no
     log += "\n";
 
     logmsg = log.toStdString();
-    return int(doublenodes.size());
+    return nDouble;
 }
 
 
@@ -1057,12 +1393,10 @@ int TriMesh::mergeFuseToWingNodes(double precision, std::string &logmsg, const s
 
 void TriMesh::scale(double sx, double sy, double sz)
 {
-    for(int in=0; in<nodeCount(); in++)
-    {
-        m_Node[in].x *= sx;
-        m_Node[in].y *= sy;
-        m_Node[in].z *= sz;
-    }
+    Vector3dArray pos;
+    pos.load(m_Node);
+    pos.scale(sx, sy, sz);
+    pos.store(m_Node);
 
     for(int i3=0; i3<nPanels(); i3++)
     {
@@ -1382,11 +1716,19 @@ bool TriMesh::setPanel(int index, Panel3 const &p3)
 
 void TriMesh::rebuildPanelsFromNodes(std::vector<Panel3> &panel3, std::vector<Node> const &node)
 {
-    for(int i3=0; i3<int(panel3.size()); i3++)
-    {
-        Panel3 &p3 = panel3[i3];
-        p3.setFrame(node[p3.nodeIndex(0)], node[p3.nodeIndex(1)], node[p3.nodeIndex(2)]);
-    }
+    // the frames are independent
+    int nPanel3 = int(panel3.size());
+    int nBlocks = std::min(ThreadPool::nBlocks(ThreadPool::maxThreadCount()), std::max(1, nPanel3/1000));
+    int blockSize = nPanel3/nBlocks + 1;
+    ThreadPool::pool().parallelFor(nBlocks, [&panel3, &node, nPanel3, blockSize](int iBlock)
+    {
+        int iMax = std::min((iBlock+1)*blockSize, nPanel3);
+        for(int i3=iBlock*blockSize; i3<iMax; i3++)
+        {
+            Panel3 &p3 = panel3[i3];
+            p3.setFrame(node[p3.nodeIndex(0)], node[p3.nodeIndex(1)], node[p3.nodeIndex(2)]);
+        }
+    });
 }
 
 
@@ -1624,20 +1966,27 @@ bool TriMesh::mergeNodes(int srcindex, int destindex, bool bDiscardNullPanels, s
 void TriMesh::getFreeEdges(std::vector<Segment3d> &freeedges) const
 {
     freeedges.clear();
-    for(int i3=0; i3<nPanels(); i3++)
+
+    // the blocks are listed separately and appended in order, so that the list is the same as in a serial scan
+    int n3 = nPanels();
+    int nBlocks = std::min(ThreadPool::nBlocks(ThreadPool::maxThreadCount()), std::max(1, n3/1000));
+    int blockSize = n3/nBlocks + 1;
+    std::vector<std::vector<Segment3d>> blockedges(nBlocks);
+    ThreadPool::pool().parallelFor(nBlocks, [this, &blockedges, n3, blockSize](int iBlock)
     {
-        Panel3 const &p3 = m_Panel3.at(i3);
-        for(int i=0; i<3; i++)
+        int iMax = std::min((iBlock+1)*blockSize, n3);
+        for(int i3=iBlock*blockSize; i3<iMax; i3++)
         {
-//            if(p3.neighbourEdgeIndex(0)!=i && p3.neighbourEdgeIndex(1)!=i && p3.neighbourEdgeIndex(2)!=i)
-            if(p3.neighbour(i)<0)
+            Panel3 const &p3 = m_Panel3.at(i3);
+            for(int i=0; i<3; i++)
             {
                 // this edge is a free edge
-                Segment3d const &seg = p3.edge(i);
-                freeedges.push_back(seg);
+                if(p3.neighbour(i)<0) blockedges[iBlock].push_back(p3.edge(i));
             }
         }
-    }
+    });
+
+    for(std::vector<Segment3d> const &edges : blockedges) freeedges.insert(freeedges.end(), edges.begin(), edges.end());
 }
 
 
@@ -1671,15 +2020,22 @@ void TriMesh::savePanels(QDataStream &ar)
     ar << ArchiveFormat;
     ar << panelCount();
 
+    // the panels are encoded in one block, in the layout of ar << x
+    xfl::RecordCodec codec(ar);
+    std::vector<char> buffer(size_t(panelCount())*size_t(9*codec.floatSize()+1));
+    char *p = buffer.data();
     for(int i3=0; i3<panelCount(); i3++)
     {
         Panel3 const &p3 = panel(i3);
         for(int in=0; in<3; in++)
         {
-            ar << p3.node(in).xf() << p3.node(in).yf() << p3.node(in).zf();
+            codec.putFloat(p, p3.node(in).xf());
+            codec.putFloat(p, p3.node(in).yf());
+            codec.putFloat(p, p3.node(in).zf());
         }
-        ar << p3.isPositiveOrientation();
+        codec.putBool(p, p3.isPositiveOrientation());
     }
+    xfl::writeRawBlock(ar, buffer);
 
     // dynamic space allocation for the future storage of more data, without need to change the format
     nIntSpares=0;
@@ -1699,22 +2055,29 @@ void TriMesh::loadPanels(QDataStream &ar)
     int n=0;
     double dble=0.0;
     int ArchiveFormat=0;// identifies the format of the file
-    bool bPositiveOrientation=false;
     int n3=0;
-    float f0=0,f1=0,f2=0;
     Vector3d S[3];
     ar >> ArchiveFormat;
     ar >> n3;
 
     clearMesh();
+
+    xfl::RecordCodec codec(ar);
+    std::vector<char> buffer;
+    if(n3<0 || !xfl::readRawBlock(ar, buffer, size_t(n3)*size_t(9*codec.floatSize()+1))) return;
+
+    m_Panel3.reserve(n3);
+    char const *p = buffer.data();
     for(int i3=0; i3<n3; i3++)
     {
         for(int in=0; in<3; in++)
         {
-            ar >> f0 >> f1 >> f2;
-            S[in].set(double(f0), double(f1), double(f2));
+            double x = double(codec.getFloat(p));
+            double y = double(codec.getFloat(p));
+            double z = double(codec.getFloat(p));
+            S[in].set(x, y, z);
         }
-        ar >> bPositiveOrientation;
+        codec.getBool(p); // the orientation
         addPanel({S[0], S[1], S[2]});
         lastPanel().setSurfacePosition(xfl::FUSESURFACE);
     }
@@ -2094,26 +2457,46 @@ void TriMesh::removePanelAt(int index)
 }
 
 
-void TriMesh::checkElementSize(double minsize, std::vector<int> &elements, std::vector<double> &size)
+void TriMesh::checkElementSize(double minsize, std::vector<int> &elements, std::vector<double> &size) const
 {
     elements.clear();
     size.clear();
-    for(int i3=0; i3<nPanels(); i3++)
+
+    // the first edge shorter than the limit of each panel, or -1 if none
+    int n3 = nPanels();
+    std::vector<double> critical(n3, -1.0);
+    int nBlocks = std::min(ThreadPool::nBlocks(ThreadPool::maxThreadCount()), std::max(1, n3/1000));
+    int blockSize = n3/nBlocks + 1;
+    ThreadPool::pool().parallelFor(nBlocks, [this, &critical, minsize, n3, blockSize](int iBlock)
     {
-        Panel3 const &p3 = m_Panel3.at(i3);
-        for(int iedge=0; iedge<3; iedge++)
+        int iMax = std::min((iBlock+1)*blockSize, n3);
+        for(int i3=iBlock*blockSize; i3<iMax; i3++)
         {
-            double length = p3.edge(iedge).length();
-            if(length<minsize*50.0)
+            Panel3 const &p3 = m_Panel3.at(i3);
+            for(int iedge=0; iedge<3; iedge++)
             {
-                elements.push_back(p3.index());
-                size.push_back(length);
-                break;
+                double length = p3.edge(iedge).length();
+                if(length<minsize*50.0)
+                {
+                    critical[i3] = length;
+                    break;
+                }
             }
         }
+    });
+
+    for(int i3=0; i3<n3; i3++)
+    {
+        if(critical.at(i3)>=0.0)
+        {
+            elements.push_back(m_Panel3.at(i3).index());
+            size.push_back(critical.at(i3));
+        }
     }
 }
 
 
-
-
+size_t TriMesh::memoryFootprint() const
+{
+    return XflMesh::memoryFootprint() + MemoryBudget::bytes(m_Panel3) + MemoryBudget::bytes(m_WakePanel3);
+}
@@ -27,6 +27,8 @@
 
 
 #include <xflmesh.h>
+#include <constants.h>
+#include <memorybudget.h>
 #include <objects_global.h>
 
 double XflMesh::s_NodeMergeDistance=1.e-4; // 0.1mm
@@ -58,3 +60,29 @@ void XflMesh::listNodes()
         qDebug("%s", strange.toStdString().c_str());
     }
 }
+
+
+/** The memory held by the nodes, including their connection arrays */
+size_t XflMesh::memoryFootprint() const
+{
+    size_t n = MemoryBudget::bytes(m_Node);
+    for(Node const &nd : m_Node) n += MemoryBudget::bytes(nd.triangleIndexes()) + MemoryBudget::bytes(nd.nodeNeighbourIndexes());
+    return n;
+}
+
+
+/**
+ * Composes the rotations of rotate(alpha, beta, phi) into one quaternion:
+ * first about the x-axis by phi, then about the z-axis by beta, then about the y-axis by alpha.
+ * The angles below ANGLEPRECISION are ignored, as in the sequential rotations.
+ * @param alpha the angle about the y-axis, in degrees
+ * @param beta the angle about the z-axis, in degrees
+ * @param phi the angle about the x-axis, in degrees
+ */
+Quaternion XflMesh::rotationQuaternion(double alpha, double beta, double phi)
+{
+    if(fabs(alpha)<=ANGLEPRECISION) alpha = 0.0;
+    if(fabs(beta) <=ANGLEPRECISION) beta  = 0.0;
+    if(fabs(phi)  <=ANGLEPRECISION) phi   = 0.0;
+    return Quaternion(alpha, Vector3d(0,1,0)) * Quaternion(beta, Vector3d(0,0,1)) * Quaternion(phi, Vector3d(1,0,0));
+}
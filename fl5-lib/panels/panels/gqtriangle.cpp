@@ -59,108 +59,17 @@ double GQTriangle::testIntegral()
 
 void GQTriangle::makeCoeffs(int order)
 {
-    if(order<1) order = 3;
-    if(order>8) order = 8;
-    m_iOrder = order;
+    m_iOrder = ruleOrder(order);
     m_point.clear();
     m_weight.clear();
-    switch(order)
+    gq::withTriangleRule(m_iOrder, [this](auto rule)
     {
-        case 1:
+        using Rule = GQTriangleRule<decltype(rule)::value>;
+        for(int i=0; i<Rule::nPoints; i++)
         {
-            m_point.push_back({0.33333333333333, 0.33333333333333});  m_weight.push_back(1.00000000000000);
-            break;
+            m_point.push_back({Rule::nodes[i].x, Rule::nodes[i].y});
+            m_weight.push_back(Rule::nodes[i].w);
         }
-        case 2:
-        {
-            m_point.push_back({0.16666666666667, 0.16666666666667});  m_weight.push_back(0.33333333333333);
-            m_point.push_back({0.16666666666667, 0.66666666666667});  m_weight.push_back(0.33333333333333);
-            m_point.push_back({0.66666666666667, 0.16666666666667});  m_weight.push_back(0.33333333333333);
-            break;
-        }
-        default:
-        case 3:
-        {
-            m_point.push_back({0.33333333333333, 0.33333333333333});  m_weight.push_back(-0.56250000000000);
-            m_point.push_back({0.20000000000000, 0.20000000000000});  m_weight.push_back(0.52083333333333);
-            m_point.push_back({0.20000000000000, 0.60000000000000});  m_weight.push_back(0.52083333333333);
-            m_point.push_back({0.60000000000000, 0.20000000000000});  m_weight.push_back(0.52083333333333);
-            break;
-        }
-        case 4:
-        {
-            m_point.push_back({0.44594849091597, 0.44594849091597});  m_weight.push_back(0.22338158967801);
-            m_point.push_back({0.44594849091597, 0.10810301816807});  m_weight.push_back(0.22338158967801);
-            m_point.push_back({0.10810301816807, 0.44594849091597});  m_weight.push_back(0.22338158967801);
-            m_point.push_back({0.09157621350977, 0.09157621350977});  m_weight.push_back(0.10995174365532);
-            m_point.push_back({0.09157621350977, 0.81684757298046});  m_weight.push_back(0.10995174365532);
-            m_point.push_back({0.81684757298046, 0.09157621350977});  m_weight.push_back(0.10995174365532);
-            break;
-        }
-        case 5:
-        {
-
-            m_point.push_back({0.33333333333333, 0.33333333333333});  m_weight.push_back(0.22500000000000);
-            m_point.push_back({0.47014206410511, 0.47014206410511});  m_weight.push_back(0.13239415278851);
-            m_point.push_back({0.47014206410511, 0.05971587178977});  m_weight.push_back(0.13239415278851);
-            m_point.push_back({0.05971587178977, 0.47014206410511});  m_weight.push_back(0.13239415278851);
-            m_point.push_back({0.10128650732346, 0.10128650732346});  m_weight.push_back(0.12593918054483);
-            m_point.push_back({0.10128650732346, 0.79742698535309});  m_weight.push_back(0.12593918054483);
-            m_point.push_back({0.79742698535309, 0.10128650732346});  m_weight.push_back(0.12593918054483);
-            break;
-        }
-        case 6:
-        {
-            m_point.push_back({0.24928674517091, 0.24928674517091});  m_weight.push_back(0.11678627572638);
-            m_point.push_back({0.24928674517091, 0.50142650965818});  m_weight.push_back(0.11678627572638);
-            m_point.push_back({0.50142650965818, 0.24928674517091});  m_weight.push_back(0.11678627572638);
-            m_point.push_back({0.06308901449150, 0.06308901449150});  m_weight.push_back(0.05084490637021);
-            m_point.push_back({0.06308901449150, 0.87382197101700});  m_weight.push_back(0.05084490637021);
-            m_point.push_back({0.87382197101700, 0.06308901449150});  m_weight.push_back(0.05084490637021);
-            m_point.push_back({0.31035245103378, 0.63650249912140});  m_weight.push_back(0.08285107561837);
-            m_point.push_back({0.63650249912140, 0.05314504984482});  m_weight.push_back(0.08285107561837);
-            m_point.push_back({0.05314504984482, 0.31035245103378});  m_weight.push_back(0.08285107561837);
-            m_point.push_back({0.63650249912140, 0.31035245103378});  m_weight.push_back(0.08285107561837);
-            m_point.push_back({0.31035245103378, 0.05314504984482});  m_weight.push_back(0.08285107561837);
-            m_point.push_back({0.05314504984482, 0.63650249912140});  m_weight.push_back(0.08285107561837);
-            break;
-        }
-        case 7:
-        {
-            m_point.push_back({0.33333333333333, 0.33333333333333});  m_weight.push_back(-0.14957004446768);
-            m_point.push_back({0.26034596607904, 0.26034596607904});  m_weight.push_back(0.17561525743321);
-            m_point.push_back({0.26034596607904, 0.47930806784192});  m_weight.push_back(0.17561525743321);
-            m_point.push_back({0.47930806784192, 0.26034596607904});  m_weight.push_back(0.17561525743321);
-            m_point.push_back({0.06513010290222, 0.06513010290222});  m_weight.push_back(0.05334723560884);
-            m_point.push_back({0.06513010290222, 0.86973979419557});  m_weight.push_back(0.05334723560884);
-            m_point.push_back({0.86973979419557, 0.06513010290222});  m_weight.push_back(0.05334723560884);
-            m_point.push_back({0.31286549600487, 0.63844418856981});  m_weight.push_back(0.07711376089026);
-            m_point.push_back({0.63844418856981, 0.04869031542532});  m_weight.push_back(0.07711376089026);
-            m_point.push_back({0.04869031542532, 0.31286549600487});  m_weight.push_back(0.07711376089026);
-            m_point.push_back({0.63844418856981, 0.31286549600487});  m_weight.push_back(0.07711376089026);
-            m_point.push_back({0.31286549600487, 0.04869031542532});  m_weight.push_back(0.07711376089026);
-            m_point.push_back({0.04869031542532, 0.63844418856981});  m_weight.push_back(0.07711376089026);
-            break;
-        }
-        case 8:
-        {
-            m_point.push_back({0.33333333333333, 0.33333333333333});  m_weight.push_back(0.14431560767779);
-            m_point.push_back({0.45929258829272, 0.45929258829272});  m_weight.push_back(0.09509163426728);
-            m_point.push_back({0.45929258829272, 0.08141482341455});  m_weight.push_back(0.09509163426728);
-            m_point.push_back({0.08141482341455, 0.45929258829272});  m_weight.push_back(0.09509163426728);
-            m_point.push_back({0.17056930775176, 0.17056930775176});  m_weight.push_back(0.10321737053472);
-            m_point.push_back({0.17056930775176, 0.65886138449648});  m_weight.push_back(0.10321737053472);
-            m_point.push_back({0.65886138449648, 0.17056930775176});  m_weight.push_back(0.10321737053472);
-            m_point.push_back({0.05054722831703, 0.05054722831703});  m_weight.push_back(0.03245849762320);
-            m_point.push_back({0.05054722831703, 0.89890554336594});  m_weight.push_back(0.03245849762320);
-            m_point.push_back({0.89890554336594, 0.05054722831703});  m_weight.push_back(0.03245849762320);
-            m_point.push_back({0.26311282963464, 0.72849239295540});  m_weight.push_back(0.02723031417443);
-            m_point.push_back({0.72849239295540, 0.00839477740996});  m_weight.push_back(0.02723031417443);
-            m_point.push_back({0.00839477740996, 0.26311282963464});  m_weight.push_back(0.02723031417443);
-            m_point.push_back({0.72849239295540, 0.26311282963464});  m_weight.push_back(0.02723031417443);
-            m_point.push_back({0.26311282963464, 0.00839477740996});  m_weight.push_back(0.02723031417443);
-            m_point.push_back({0.00839477740996, 0.72849239295540});  m_weight.push_back(0.02723031417443);
-            break;
-        }
-    }
+    });
 }
+
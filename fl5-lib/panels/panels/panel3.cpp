@@ -29,6 +29,7 @@
 
 #include <constants.h>
 #include <geom_global.h>
+#include <kernelstats.h>
 #include <matrix.h>
 #include <mctriangle.h>
 #include <node.h>
@@ -37,7 +38,6 @@
 #include <utils.h>
 #include <vortex.h>
 
-GQTriangle Panel3::s_gq;
 int Panel3::s_iQuadratureOrder = 5;
 double Panel3::s_Quality = 1.414;
 bool Panel3::s_bUseNintcheuFata = true;
@@ -193,6 +193,8 @@ void Panel3::setFrame()
     m_Sl[2].set(m_CF.globalToLocal(m_S[2]-m_O));
     m_CoG_l.set(m_CF.globalToLocal(m_CoG_g-m_O));
 
+    makeNFConstants();
+
     // calculate the matrix to transform local coordinates in homogeneous barycentric coordinates
     m_gmat[0] = 1.0;     m_gmat[1] = m_Sl[0].x;     m_gmat[2] = m_Sl[0].y;
     m_gmat[3] = 1.0;     m_gmat[4] = m_Sl[1].x;     m_gmat[5] = m_Sl[1].y;
@@ -209,24 +211,24 @@ void Panel3::setFrame()
 //    if(m_SignedArea<0.0 || !m_bPositiveOrientation)  qDebug(" index=%3d   %1d  %g", m_index, m_bPositiveOrientation, m_SignedArea);
 
     // calculate the integrals of x.b_i(x,y) and y.b_i(x,y) - needed later for distant field approximation
-    GQTriangle gq(5); // x.basis functions are second order
+    using Rule = GQTriangleRule<5>; // x.basis functions are second order
     double integrand_x=0, integrand_y=0;
     double sum_x[]{0.0,0.0,0.0}, sum_y[] {0.0,0.0,0.0};
 
     sum_x[0]=sum_x[1]=sum_x[2]=0.0;
     sum_y[0]=sum_y[1]=sum_y[2]=0.0;
 
-    for(int i=0; i<gq.nPoints(); i++)
+    for(int i=0; i<Rule::nPoints; i++)
     {
-        double x = m_Sl[0].x*(1.0-gq.points().at(i).x-gq.points().at(i).y) + m_Sl[1].x*gq.points().at(i).x + m_Sl[2].x*gq.points().at(i).y;
-        double y = m_Sl[0].y*(1.0-gq.points().at(i).x-gq.points().at(i).y) + m_Sl[1].y*gq.points().at(i).x + m_Sl[2].y*gq.points().at(i).y;
+        double x = m_Sl[0].x*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].x*Rule::nodes[i].x + m_Sl[2].x*Rule::nodes[i].y;
+        double y = m_Sl[0].y*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].y*Rule::nodes[i].x + m_Sl[2].y*Rule::nodes[i].y;
 
         for(int l=0; l<3; l++)
         {
-            integrand_x = gq.weights().at(i) * x*basis(x,y,l);
+            integrand_x = Rule::nodes[i].w * x*basis(x,y,l);
             sum_x[l] += integrand_x;
 
-            integrand_y = gq.weights().at(i) * y*basis(x,y,l);
+            integrand_y = Rule::nodes[i].w * y*basis(x,y,l);
             sum_y[l] += integrand_y;
 
         }
@@ -240,12 +242,6 @@ void Panel3::setFrame()
 }
 
 
-void Panel3::makeGQCoeffs()
-{
-    s_gq.makeCoeffs(s_iQuadratureOrder);
-}
-
-
 /** Initializes member variables to zero */
 void Panel3::initialize()
 {
@@ -314,17 +310,26 @@ void Panel3::scalePanel(double sx, double sy, double sz)
  */
 void Panel3::sourceQuadraturePotential(Vector3d ptGlobal, double &phi) const
 {
+    gq::withTriangleRule(s_iQuadratureOrder, [&](auto rule){sourceQuadraturePotential<decltype(rule)::value>(ptGlobal, phi);});
+}
+
+
+template<int order>
+void Panel3::sourceQuadraturePotential(Vector3d ptGlobal, double &phi) const
+{
+    KERNEL_COUNT(QUADRATURE);
     Vector3d ptL = globalToLocalPosition(ptGlobal);
     double sumPhi = 0.0;
 
-    for(uint i=0; i<s_gq.points().size(); i++)
+    using Rule = GQTriangleRule<order>;
+    for(int i=0; i<Rule::nPoints; i++)
     {
-        double x = m_Sl[0].x*(1.0-s_gq.points().at(i).x-s_gq.points().at(i).y) + m_Sl[1].x*s_gq.points().at(i).x + m_Sl[2].x*s_gq.points().at(i).y;
-        double y = m_Sl[0].y*(1.0-s_gq.points().at(i).x-s_gq.points().at(i).y) + m_Sl[1].y*s_gq.points().at(i).x + m_Sl[2].y*s_gq.points().at(i).y;
+        double x = m_Sl[0].x*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].x*Rule::nodes[i].x + m_Sl[2].x*Rule::nodes[i].y;
+        double y = m_Sl[0].y*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].y*Rule::nodes[i].x + m_Sl[2].y*Rule::nodes[i].y;
 
         double r = sqrt((ptL.x-x)*(ptL.x-x) + (ptL.y-y)*(ptL.y-y) + ptL.z*ptL.z);
 
-        sumPhi +=   (-1.0 /r) * s_gq.weights().at(i);
+        sumPhi +=   (-1.0 /r) * Rule::nodes[i].w;
     }
     phi = sumPhi * fabs(m_SignedArea);
 }
@@ -339,20 +344,29 @@ void Panel3::sourceQuadraturePotential(Vector3d ptGlobal, double &phi) const
  */
 void Panel3::sourceQuadratureVelocity(Vector3d ptGlobal, Vector3d &V) const
 {
+    gq::withTriangleRule(s_iQuadratureOrder, [&](auto rule){sourceQuadratureVelocity<decltype(rule)::value>(ptGlobal, V);});
+}
+
+
+template<int order>
+void Panel3::sourceQuadratureVelocity(Vector3d ptGlobal, Vector3d &V) const
+{
+    KERNEL_COUNT(QUADRATURE);
     Vector3d ptL = globalToLocalPosition(ptGlobal);
     Vector3d sumV(0.0,0,0);
 
-    for(uint i=0; i<s_gq.points().size(); i++)
+    using Rule = GQTriangleRule<order>;
+    for(int i=0; i<Rule::nPoints; i++)
     {
-        double x = m_Sl[0].x*(1.0-s_gq.points().at(i).x-s_gq.points().at(i).y) + m_Sl[1].x*s_gq.points().at(i).x + m_Sl[2].x*s_gq.points().at(i).y;
-        double y = m_Sl[0].y*(1.0-s_gq.points().at(i).x-s_gq.points().at(i).y) + m_Sl[1].y*s_gq.points().at(i).x + m_Sl[2].y*s_gq.points().at(i).y;
+        double x = m_Sl[0].x*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].x*Rule::nodes[i].x + m_Sl[2].x*Rule::nodes[i].y;
+        double y = m_Sl[0].y*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].y*Rule::nodes[i].x + m_Sl[2].y*Rule::nodes[i].y;
 
         double r = sqrt((ptL.x-x)*(ptL.x-x) + (ptL.y-y)*(ptL.y-y) + ptL.z*ptL.z);
 
         double r3 = r*r*r;
-        sumV.x +=   (ptL.x /r3) * s_gq.weights().at(i);
-        sumV.y +=   (ptL.y /r3) * s_gq.weights().at(i);
-        sumV.z +=   (ptL.z /r3) * s_gq.weights().at(i);
+        sumV.x +=   (ptL.x /r3) * Rule::nodes[i].w;
+        sumV.y +=   (ptL.y /r3) * Rule::nodes[i].w;
+        sumV.z +=   (ptL.z /r3) * Rule::nodes[i].w;
     }
     V = sumV * fabs(m_SignedArea);
 }
@@ -382,7 +396,7 @@ void Panel3::sourceQuadratureVelocity(Vector3d ptGlobal, Vector3d &V) const
  */
 void Panel3::computeMCIntegrals(const Vector3d &FieldPtGlobal, bool bInPlane, double *G1, double *G3, double *G5, bool bGradients)const
 {
-
+    KERNEL_COUNT(MCINTEGRALS);
     MCTriangle trP01, trP12, trP20;
     Vector3d Normal(0.0,0.0,1.0);
 
@@ -429,6 +443,31 @@ void Panel3::rotate(Vector3d const &HA, Vector3d const &Axis, double angle)
 }
 
 
+/**
+ * Applies the rigid transform S -> T + Qt(S-O) to the vertices, rotates their normals,
+ * and rebuilds the frame once, so that a sequence of rotations composed in Qt costs one setFrame().
+ * @param Qt the composed rotation
+ * @param O the centre of the rotation
+ * @param T the transformed position of O
+ */
+void Panel3::transform(Quaternion const &Qt, Vector3d const &O, Vector3d const &T)
+{
+    Vector3d VTemp;
+    for(int i=0; i<3; i++)
+    {
+        VTemp.x = m_S[i].x - O.x;
+        VTemp.y = m_S[i].y - O.y;
+        VTemp.z = m_S[i].z - O.z;
+        Qt.conjugate(VTemp);
+        m_S[i].x = VTemp.x + T.x;
+        m_S[i].y = VTemp.y + T.y;
+        m_S[i].z = VTemp.z + T.z;
+        Qt.conjugate(m_S[i].normal());
+    }
+    setFrame();
+}
+
+
 std::string Panel3::properties(bool bLong) const
 {
     QString props, strange;
@@ -561,43 +600,44 @@ void Panel3::translate(double tx, double ty, double tz)
  */
 void Panel3::quadratureIntegrals(Vector3d Pt, double *I1, double *I3, double *I5) const
 {
+    KERNEL_COUNT(QUADRATURE);
     Vector3d Ptl = globalToLocalPosition(Pt);
     Vector3d R;
     double sumPotential[3];
     sumPotential[0] = sumPotential[1] = sumPotential[2] = 0.0;
-    GQTriangle gq(8);
+    using Rule = GQTriangleRule<8>;
 
     I1[0]=I1[1]=I1[2]=0.0;
     I3[0]=I3[1]=I3[2]=I3[3]=I3[4]=I3[5]=0.0;
     I5[0]=I5[1]=I5[2]=I5[3]=I5[4]=I5[5]=0.0;
 
-    for(uint i=0; i<gq.points().size(); i++)
+    for(int i=0; i<Rule::nPoints; i++)
     {
-        double x = m_Sl[0].x*(1.0-gq.points().at(i).x-gq.points().at(i).y) + m_Sl[1].x*gq.points().at(i).x + m_Sl[2].x*gq.points().at(i).y;
-        double y = m_Sl[0].y*(1.0-gq.points().at(i).x-gq.points().at(i).y) + m_Sl[1].y*gq.points().at(i).x + m_Sl[2].y*gq.points().at(i).y;
+        double x = m_Sl[0].x*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].x*Rule::nodes[i].x + m_Sl[2].x*Rule::nodes[i].y;
+        double y = m_Sl[0].y*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].y*Rule::nodes[i].x + m_Sl[2].y*Rule::nodes[i].y;
         //qDebug(" %13.7f   %13.7f",x,y);
         R = Ptl - Vector3d(x,y,0.0);
         double r  = R.norm();
         double r3 = r*r*r;
         double r5 = r*r*r*r*r;
 
-        I1[0] +=  (1/r) * gq.weights().at(i);
-        I1[1] +=  (x/r) * gq.weights().at(i);
-        I1[2] +=  (y/r) * gq.weights().at(i);
+        I1[0] +=  (1/r) * Rule::nodes[i].w;
+        I1[1] +=  (x/r) * Rule::nodes[i].w;
+        I1[2] +=  (y/r) * Rule::nodes[i].w;
 
-        I3[0] +=  (1/r3)   * gq.weights().at(i);
-        I3[1] +=  (x/r3)   * gq.weights().at(i);
-        I3[2] +=  (y/r3)   * gq.weights().at(i);
-        I3[3] +=  (x*x/r3) * gq.weights().at(i);
-        I3[4] +=  (x*y/r3) * gq.weights().at(i);
-        I3[5] +=  (y*y/r3) * gq.weights().at(i);
+        I3[0] +=  (1/r3)   * Rule::nodes[i].w;
+        I3[1] +=  (x/r3)   * Rule::nodes[i].w;
+        I3[2] +=  (y/r3)   * Rule::nodes[i].w;
+        I3[3] +=  (x*x/r3) * Rule::nodes[i].w;
+        I3[4] +=  (x*y/r3) * Rule::nodes[i].w;
+        I3[5] +=  (y*y/r3) * Rule::nodes[i].w;
 
-        I5[0] +=  (1/r5)   * gq.weights().at(i);
-        I5[1] +=  (x/r5)   * gq.weights().at(i);
-        I5[2] +=  (y/r5)   * gq.weights().at(i);
-        I5[3] +=  (x*x/r5) * gq.weights().at(i);
-        I5[4] +=  (x*y/r5) * gq.weights().at(i);
-        I5[5] +=  (y*y/r5) * gq.weights().at(i);
+        I5[0] +=  (1/r5)   * Rule::nodes[i].w;
+        I5[1] +=  (x/r5)   * Rule::nodes[i].w;
+        I5[2] +=  (y/r5)   * Rule::nodes[i].w;
+        I5[3] +=  (x*x/r5) * Rule::nodes[i].w;
+        I5[4] +=  (x*y/r5) * Rule::nodes[i].w;
+        I5[5] +=  (y*y/r5) * Rule::nodes[i].w;
     }
 
     for(int i=0; i<3; i++) I1[i] *= fabs(m_SignedArea);
@@ -942,37 +982,66 @@ void Panel3::computeNFIntegrals_ref(Vector3d const &FieldPt, double *G1, double
  *
  * @todo optimize for speed
  */
+/**
+ * Makes the edge directions, the vertex angles and the edge frame orientations used by computeNFIntegrals(),
+ * which only depend on the panel's local vertices.
+ */
+void Panel3::makeNFConstants()
+{
+    Vector3d EdgeL[3];
+    EdgeL[0].set(m_Sl[1].x-m_Sl[0].x, m_Sl[1].y-m_Sl[0].y, m_Sl[1].z-m_Sl[0].z);
+    EdgeL[1].set(m_Sl[2].x-m_Sl[1].x, m_Sl[2].y-m_Sl[1].y, m_Sl[2].z-m_Sl[1].z);
+    EdgeL[2].set(m_Sl[0].x-m_Sl[2].x, m_Sl[0].y-m_Sl[2].y, m_Sl[0].z-m_Sl[2].z);
+
+    Vector3d *u = m_NFu;
+    for(int i=0; i<3; i++)    u[i].set(EdgeL[i].normalized());
+    u[3].set(u[0]);
+
+    // calculate vertex angles
+    double det(0), dot(0);
+    dot =  u[0].x*(-u[2].x) + u[0].y*(-u[2].y);
+    det =  u[0].x*(-u[2].y) - u[0].y*(-u[2].x);
+    m_NFTheta[0] = atan2(det, dot);
+
+    dot =  u[1].x*(-u[0].x) + u[1].y*(-u[0].y);
+    det =  u[1].x*(-u[0].y) - u[1].y*(-u[0].x);
+    m_NFTheta[1] = atan2(det, dot);
+
+    dot =  u[2].x*(-u[1].x) + u[2].y*(-u[1].y);
+    det =  u[2].x*(-u[1].y) - u[2].y*(-u[1].x);
+    m_NFTheta[2] = atan2(det, dot);
+
+    for(int i=0; i<3; i++)
+    {
+        assert(m_NFTheta[i]>=0.0);
+    }
+    // check that sum of internal angles = PI
+    assert(fabs(m_NFTheta[0]+m_NFTheta[1]+m_NFTheta[2]-PI)<0.0001);
+
+    // implement eq. 21
+    double alfa1 = PI-m_NFTheta[1];
+    double alfa2 = PI+m_NFTheta[0];
+    m_NFCosa[0]=1.0;           m_NFSina[0]=0.0;
+    m_NFCosa[1]=cos(alfa1);    m_NFSina[1]=sin(alfa1);
+    m_NFCosa[2]=cos(alfa2);    m_NFSina[2]=sin(alfa2);
+}
+
+
 void Panel3::computeNFIntegrals(Vector3d const &FieldPtGlobal, double *G1, double *G3, double *G5, bool bGradients) const
 {
+    KERNEL_COUNT(NFINTEGRALS);
      double N1[] = {0,0,0};
      double N3[] = {0,0,0,0,0,0};
      double N5[] = {0,0,0,0,0,0};
 
      Vector3d FieldPtLocal;
      m_CF.globalToLocalPosition(FieldPtGlobal, FieldPtLocal);
-     Vector3d EdgeL[3];
-     Vector3d NormalL;
-     Vector3d u[4];
+     Vector3d NormalL(0,0, 1.0);
+     Vector3d const *u = m_NFu; // the normalized local edges
 
      //unneeded
      Vector3d R(FieldPtLocal-m_Sl[0]);
 
-     // make normalized local edges
-     EdgeL[0].x = m_Sl[1].x-m_Sl[0].x;
-     EdgeL[0].y = m_Sl[1].y-m_Sl[0].y;
-     EdgeL[0].z = m_Sl[1].z-m_Sl[0].z;
-     EdgeL[1].x = m_Sl[2].x-m_Sl[1].x;
-     EdgeL[1].y = m_Sl[2].y-m_Sl[1].y;
-     EdgeL[1].z = m_Sl[2].z-m_Sl[1].z;
-     EdgeL[2].x = m_Sl[0].x-m_Sl[2].x;
-     EdgeL[2].y = m_Sl[0].y-m_Sl[2].y;
-     EdgeL[2].z = m_Sl[0].z-m_Sl[2].z;
-
-     NormalL.set(0,0, 1.0);
-
-     for(int i=0; i<3; i++)    u[i].set(EdgeL[i].normalized());
-     u[3].set(u[0]);
-
      // make edge-aligned cartesian frames centered on field point
      CartesianFrame NFe[3];
      for(int i=0; i<3; i++)
@@ -1022,34 +1091,10 @@ void Panel3::computeNFIntegrals(Vector3d const &FieldPtGlobal, double *G1, doubl
      r[1] = Sl[1]-FieldPtLocal;
      r[2] = Sl[2]-FieldPtLocal;*/
 
-     // calculate vertex angles
-     double theta[3], det, dot;
-     dot =  u[0].x*(-u[2].x) + u[0].y*(-u[2].y);
-     det =  u[0].x*(-u[2].y) - u[0].y*(-u[2].x);
-     theta[0] = atan2(det, dot);
-
-     dot =  u[1].x*(-u[0].x) + u[1].y*(-u[0].y);
-     det =  u[1].x*(-u[0].y) - u[1].y*(-u[0].x);
-     theta[1] = atan2(det, dot);
-
-     dot =  u[2].x*(-u[1].x) + u[2].y*(-u[1].y);
-     det =  u[2].x*(-u[1].y) - u[2].y*(-u[1].x);
-     theta[2] = atan2(det, dot);
-
-     for(int i=0; i<3; i++)
-     {
-         assert(theta[i]>=0.0);
-     }
-     // check that sum of internal angles = PI
-     //    qDebug(" theta[] =  %13.7f  %13.7f  %13.7f", theta[0], theta[1], theta[2]);
-
-     assert(fabs(theta[0]+theta[1]+theta[2]-PI)<0.0001);
-
-     // implement eq. 21
-     double alfa[3], cosa[3], sina[3];
-     alfa[0]=0.0;              cosa[0]=1.0;               sina[0]=0.0;
-     alfa[1]=PI-theta[1];      cosa[1]=cos(alfa[1]);      sina[1]=sin(alfa[1]);
-     alfa[2]=PI+theta[0];      cosa[2]=cos(alfa[2]);      sina[2]=sin(alfa[2]);
+     // the vertex angles and the orientations of the edge frames, i.a.w. eq. 21
+     double const *theta = m_NFTheta;
+     double const *cosa = m_NFCosa;
+     double const *sina = m_NFSina;
 
      /*
      //  unneeded: introduce in R³ a local coordinate system {x; ξ, ζ, η} associated with the triangle E_q
@@ -1496,6 +1541,7 @@ void Panel3::doubletN4023Velocity(Vector3d const &C, bool , Vector3d &V, double
 
     if(bUseRFF && pjk> s_RFF*m_MaxSize)
     {
+        KERNEL_COUNT(DOUBLETVELOCITYFAR);
         // use far-field formula
 
         double pjk2=pjk*pjk;
@@ -1512,6 +1558,8 @@ void Panel3::doubletN4023Velocity(Vector3d const &C, bool , Vector3d &V, double
         return;
     }
 
+    KERNEL_COUNT(DOUBLETVELOCITYNEAR);
+
     for (int i=0; i<3; i++)
     {
         ax  = C.x - m_S[i].x;
@@ -1584,11 +1632,14 @@ void Panel3::doubletN4023Potential(Vector3d const &C, bool bSelf, double &phi, d
 
     if(bUseRFF && pjk> s_RFF*m_MaxSize)
     {
+        KERNEL_COUNT(DOUBLETPOTENTIALFAR);
         // use far-field formula
         phi = -PN * m_Area /(pjk*pjk*pjk);
         return;
     }
 
+    KERNEL_COUNT(DOUBLETPOTENTIALNEAR);
+
     for (int i=0; i<3; i++)
     {
         a.x  = C.x - m_S[i].x;
@@ -1664,11 +1715,14 @@ void Panel3::sourceN4023Potential(Vector3d const &C, bool , double &phi, double
 
     if(pjk> s_RFF*m_MaxSize)
     {
+        KERNEL_COUNT(SOURCEPOTENTIALFAR);
         // use far-field formula
         phi = -m_Area /pjk;
         return;
     }
 
+    KERNEL_COUNT(SOURCEPOTENTIALNEAR);
+
     for (int i=0; i<3; i++)
     {
         a.x  = C.x - m_S[i].x;
@@ -1794,6 +1848,7 @@ void Panel3::sourceN4023Velocity(Vector3d const &C, bool bSelf, Vector3d &Vel, d
 
     if(pjk> s_RFF*m_MaxSize)
     {
+        KERNEL_COUNT(SOURCEVELOCITYFAR);
         // use far-field formula
         Vel.x = PJK.x * m_Area/pjk/pjk/pjk;
         Vel.y = PJK.y * m_Area/pjk/pjk/pjk;
@@ -1801,6 +1856,8 @@ void Panel3::sourceN4023Velocity(Vector3d const &C, bool bSelf, Vector3d &Vel, d
         return;
     }
 
+    KERNEL_COUNT(SOURCEVELOCITYNEAR);
+
     for (int i=0; i<3; i++)
     {
         ax  = C.x - m_S[i].x;
@@ -1908,6 +1965,7 @@ void Panel3::sourcePotential(Vector3d const &Pt, bool bSelf, double &phi) const
     double r = sqrt(Ptl.x*Ptl.x+Ptl.y*Ptl.y+Ptl.z*Ptl.z);
     if(r>s_RFF*m_MaxSize)
     {
+        KERNEL_COUNT(INTEGRALSFAR);
         phi = -m_Area/r;
         return;
     }
@@ -1954,6 +2012,7 @@ void Panel3::sourceVelocity(Vector3d const& Pt, bool bSelf, Vector3d &Velocity)
     double r = sqrt(Ptl.x*Ptl.x+Ptl.y*Ptl.y+Ptl.z*Ptl.z);
     if(r>s_RFF*m_MaxSize)
     {
+        KERNEL_COUNT(INTEGRALSFAR);
         Vector3d vel;
         double invr3 = 1.0/(r*r*r);
         vel.x = Ptl.x*m_Area * invr3;
@@ -2025,6 +2084,7 @@ void Panel3::doubletBasisPotential(Vector3d const &ptGlobal, bool bSelf, double
 
     if(bUseRFF && r>s_RFF*m_MaxSize)
     {
+        KERNEL_COUNT(INTEGRALSFAR);
         phi[0]=phi[1]=phi[2] = -Ptl.z/r/r/r *m_Area/3.0;
         return;
     }
@@ -2085,6 +2145,7 @@ void Panel3::doubletBasisVelocity(Vector3d const &ptGlobal, Vector3d *V, bool bU
 
     if(bUseRFF && r>s_RFF*m_MaxSize)
     {
+        KERNEL_COUNT(INTEGRALSFAR);
         double invr3 = 1.0/r/r/r;
         double invr5 = invr3/r/r;
         Vl[0].x = Ptl.z*invr5*(Ptl.x*m_Area-bx[0]);
@@ -2174,15 +2235,24 @@ void Panel3::doubletBasisVelocity(Vector3d const &ptGlobal, Vector3d *V, bool bU
  */
 void Panel3::doubletQuadraturePotential(Vector3d Pt, double *phi) const
 {
+    gq::withTriangleRule(s_iQuadratureOrder, [&](auto rule){doubletQuadraturePotential<decltype(rule)::value>(Pt, phi);});
+}
+
+
+template<int order>
+void Panel3::doubletQuadraturePotential(Vector3d Pt, double *phi) const
+{
+    KERNEL_COUNT(QUADRATURE);
     Vector3d Ptl = globalToLocalPosition(Pt);
     Vector3d r;
     double sumPotential[3];
     sumPotential[0] = sumPotential[1] = sumPotential[2] = 0.0;
 
-    for(uint i=0; i<s_gq.points().size(); i++)
+    using Rule = GQTriangleRule<order>;
+    for(int i=0; i<Rule::nPoints; i++)
     {
-        double x = m_Sl[0].x*(1.0-s_gq.points().at(i).x-s_gq.points().at(i).y) + m_Sl[1].x*s_gq.points().at(i).x + m_Sl[2].x*s_gq.points().at(i).y;
-        double y = m_Sl[0].y*(1.0-s_gq.points().at(i).x-s_gq.points().at(i).y) + m_Sl[1].y*s_gq.points().at(i).x + m_Sl[2].y*s_gq.points().at(i).y;
+        double x = m_Sl[0].x*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].x*Rule::nodes[i].x + m_Sl[2].x*Rule::nodes[i].y;
+        double y = m_Sl[0].y*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].y*Rule::nodes[i].x + m_Sl[2].y*Rule::nodes[i].y;
 
         r = Ptl - Vector3d(x,y,0.0);
         double dist = r.norm();
@@ -2192,9 +2262,9 @@ void Panel3::doubletQuadraturePotential(Vector3d Pt, double *phi) const
         double dist = sqrt(r.x*r.x+r.y*r.y+r.z*r.z);*/
         double r3 = dist*dist*dist;
 
-        sumPotential[0] +=  basis(x,y,0) * (-Ptl.z /r3) * s_gq.weights().at(i);
-        sumPotential[1] +=  basis(x,y,1) * (-Ptl.z /r3) * s_gq.weights().at(i);
-        sumPotential[2] +=  basis(x,y,2) * (-Ptl.z /r3) * s_gq.weights().at(i);
+        sumPotential[0] +=  basis(x,y,0) * (-Ptl.z /r3) * Rule::nodes[i].w;
+        sumPotential[1] +=  basis(x,y,1) * (-Ptl.z /r3) * Rule::nodes[i].w;
+        sumPotential[2] +=  basis(x,y,2) * (-Ptl.z /r3) * Rule::nodes[i].w;
     }
     phi[0] = sumPotential[0] * fabs(m_SignedArea);
     phi[1] = sumPotential[1] * fabs(m_SignedArea);
@@ -2211,16 +2281,25 @@ void Panel3::doubletQuadraturePotential(Vector3d Pt, double *phi) const
  */
 void Panel3::doubletQuadratureVelocity(Vector3d Pt, Vector3d *V) const
 {
+    gq::withTriangleRule(s_iQuadratureOrder, [&](auto rule){doubletQuadratureVelocity<decltype(rule)::value>(Pt, V);});
+}
+
+
+template<int order>
+void Panel3::doubletQuadratureVelocity(Vector3d Pt, Vector3d *V) const
+{
+    KERNEL_COUNT(QUADRATURE);
     if(!V) return;
     Vector3d Ptl = globalToLocalPosition(Pt);
     Vector3d r;
     double b[]{0,0,0};
     Vector3d sumvelocity[3];
 
-    for(uint i=0; i<s_gq.points().size(); i++)
+    using Rule = GQTriangleRule<order>;
+    for(int i=0; i<Rule::nPoints; i++)
     {
-        double x = m_Sl[0].x*(1.0-s_gq.points().at(i).x-s_gq.points().at(i).y) + m_Sl[1].x*s_gq.points().at(i).x + m_Sl[2].x*s_gq.points().at(i).y;
-        double y = m_Sl[0].y*(1.0-s_gq.points().at(i).x-s_gq.points().at(i).y) + m_Sl[1].y*s_gq.points().at(i).x + m_Sl[2].y*s_gq.points().at(i).y;
+        double x = m_Sl[0].x*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].x*Rule::nodes[i].x + m_Sl[2].x*Rule::nodes[i].y;
+        double y = m_Sl[0].y*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].y*Rule::nodes[i].x + m_Sl[2].y*Rule::nodes[i].y;
 
         r = Ptl - Vector3d(x,y,0.0);
         double dist = r.norm();
@@ -2236,9 +2315,9 @@ void Panel3::doubletQuadratureVelocity(Vector3d Pt, Vector3d *V) const
 
         for(int l=0; l<3; l++)
         {
-            sumvelocity[l].x  +=  3.0 * b[l] * (Ptl.x-x)* Ptl.z/r5       * s_gq.weights().at(i);
-            sumvelocity[l].y  +=  3.0 * b[l] * (Ptl.y-y)* Ptl.z/r5       * s_gq.weights().at(i);
-            sumvelocity[l].z  += b[l] *(-1.0/r3 + 3.0*Ptl.z*Ptl.z/r5 )   * s_gq.weights().at(i);
+            sumvelocity[l].x  +=  3.0 * b[l] * (Ptl.x-x)* Ptl.z/r5       * Rule::nodes[i].w;
+            sumvelocity[l].y  +=  3.0 * b[l] * (Ptl.y-y)* Ptl.z/r5       * Rule::nodes[i].w;
+            sumvelocity[l].z  += b[l] *(-1.0/r3 + 3.0*Ptl.z*Ptl.z/r5 )   * Rule::nodes[i].w;
         }
     }
     for(int l=0; l<3; l++)
@@ -2248,6 +2327,136 @@ void Panel3::doubletQuadratureVelocity(Vector3d Pt, Vector3d *V) const
     }
 }
 
+/**
+ * Batched version of doubletBasisVelocity() for the nPts points of array ptGlobal;
+ * the three velocities induced at point ip are returned in V[3*ip], V[3*ip+1] and V[3*ip+2].
+ * The far field formula is first evaluated at all the points in a branch-free loop over the targets,
+ * then the near field points are overwritten with the exact integrals.
+ */
+void Panel3::doubletBasisVelocity(int nPts, Vector3d const *ptGlobal, Vector3d *V, bool bUseRFF) const
+{
+    if(nPts==1) return doubletBasisVelocity(ptGlobal[0], V, bUseRFF);
+
+    double const rff = s_RFF*m_MaxSize;
+
+    if(bUseRFF)
+    {
+        Vector3d Vl[3];
+        for(int ip=0; ip<nPts; ip++)
+        {
+            Vector3d const Ptl = globalToLocalPosition(ptGlobal[ip]);
+            double r2 = Ptl.x*Ptl.x+Ptl.y*Ptl.y+Ptl.z*Ptl.z;
+            double invr3 = 1.0/(r2*sqrt(r2));
+            double invr5 = invr3/r2;
+            double vz = (-invr3+ 3.0*Ptl.z*Ptl.z*invr5) *m_Area/3.0;
+            for(int k=0; k<3; k++)
+            {
+                Vl[k].x = Ptl.z*invr5*(Ptl.x*m_Area-bx[k]);
+                Vl[k].y = Ptl.z*invr5*(Ptl.y*m_Area-by[k]);
+                Vl[k].z = vz;
+                V[3*ip+k] = localToGlobal(Vl[k]);
+            }
+        }
+    }
+
+    int nFar = 0;
+    for(int ip=0; ip<nPts; ip++)
+    {
+        if(bUseRFF)
+        {
+            Vector3d const Ptl = globalToLocalPosition(ptGlobal[ip]);
+            if(Ptl.norm()>rff)
+            {
+                nFar++;
+                continue;
+            }
+        }
+        doubletBasisVelocity(ptGlobal[ip], V+3*ip, false);
+    }
+    KERNEL_COUNTS(INTEGRALSFAR, nFar);
+}
+
+
+/**
+ * Batched version of doubletN4023Velocity() for the nPts points of array C.
+ * The far field formula is first evaluated at all the points, then the near field points are overwritten.
+ */
+void Panel3::doubletN4023Velocity(int nPts, Vector3d const *C, Vector3d *V, double coreradius, bool bUseRFF) const
+{
+    if(nPts==1) return doubletN4023Velocity(C[0], false, V[0], coreradius, bUseRFF);
+
+    double const rff = s_RFF*m_MaxSize;
+
+    if(bUseRFF)
+    {
+        for(int ip=0; ip<nPts; ip++)
+        {
+            double PJKx = C[ip].x - m_CoG_g.x;
+            double PJKy = C[ip].y - m_CoG_g.y;
+            double PJKz = C[ip].z - m_CoG_g.z;
+
+            double PN   = PJKx*m_Normal.x + PJKy*m_Normal.y + PJKz*m_Normal.z;
+            double pjk2 = PJKx*PJKx + PJKy*PJKy + PJKz*PJKz;
+            double coef = m_Area/(pjk2*pjk2*sqrt(pjk2));
+
+            V[ip].x = (PJKx*3.0*PN - m_Normal.x*pjk2) * coef;
+            V[ip].y = (PJKy*3.0*PN - m_Normal.y*pjk2) * coef;
+            V[ip].z = (PJKz*3.0*PN - m_Normal.z*pjk2) * coef;
+        }
+    }
+
+    int nFar = 0;
+    for(int ip=0; ip<nPts; ip++)
+    {
+        if(bUseRFF && C[ip].distanceTo(m_CoG_g)>rff)
+        {
+            nFar++;
+            continue;
+        }
+        doubletN4023Velocity(C[ip], false, V[ip], coreradius, false);
+    }
+    KERNEL_COUNTS(DOUBLETVELOCITYFAR, nFar);
+}
+
+
+/**
+ * Batched version of sourceN4023Velocity() for the nPts points of array C; the points which coincide with the panel's
+ * centre of gravity are evaluated as self-influences.
+ * The far field formula is first evaluated at all the points, then the near field points are overwritten.
+ */
+void Panel3::sourceN4023Velocity(int nPts, Vector3d const *C, Vector3d *Vel, double coreradius) const
+{
+    if(nPts==1) return sourceN4023Velocity(C[0], C[0].isSame(m_CoG_g), Vel[0], coreradius);
+
+    double const rff = s_RFF*m_MaxSize;
+
+    for(int ip=0; ip<nPts; ip++)
+    {
+        double PJKx = C[ip].x - m_CoG_g.x;
+        double PJKy = C[ip].y - m_CoG_g.y;
+        double PJKz = C[ip].z - m_CoG_g.z;
+        double pjk2 = PJKx*PJKx + PJKy*PJKy + PJKz*PJKz;
+        double coef = m_Area/(pjk2*sqrt(pjk2));
+
+        Vel[ip].x = PJKx * coef;
+        Vel[ip].y = PJKy * coef;
+        Vel[ip].z = PJKz * coef;
+    }
+
+    int nFar = 0;
+    for(int ip=0; ip<nPts; ip++)
+    {
+        if(C[ip].distanceTo(m_CoG_g)>rff)
+        {
+            nFar++;
+            continue;
+        }
+        sourceN4023Velocity(C[ip], C[ip].isSame(m_CoG_g), Vel[ip], coreradius);
+    }
+    KERNEL_COUNTS(SOURCEVELOCITYFAR, nFar);
+}
+
+
 /**
 * Finds the intersection point of a ray with the panel.
 * The ray is defined by a point and a direction vector.
@@ -2294,6 +2503,13 @@ bool Panel3::intersect(Vector3d const &A, Vector3d const &U, Vector3d &I) const
  * on the sourcepanel with the basis functions of this panel.
  */
 void Panel3::scalarProductSourcePotential(const Panel3 &SourcePanel, bool bSelf, double *sp) const
+{
+    gq::withTriangleRule(s_iQuadratureOrder, [&](auto rule){scalarProductSourcePotential<decltype(rule)::value>(SourcePanel, bSelf, sp);});
+}
+
+
+template<int order>
+void Panel3::scalarProductSourcePotential(const Panel3 &SourcePanel, bool bSelf, double *sp) const
 {
     Vector3d ptGlobal;
     double phiSource(0);
@@ -2301,10 +2517,11 @@ void Panel3::scalarProductSourcePotential(const Panel3 &SourcePanel, bool bSelf,
     double sum[]{0,0,0};
     double x(0), y(0);
 
-    for(uint i=0; i<s_gq.points().size(); i++)
+    using Rule = GQTriangleRule<order>;
+    for(int i=0; i<Rule::nPoints; i++)
     {
-        x = m_Sl[0].x*(1.0-s_gq.points().at(i).x-s_gq.points().at(i).y) + m_Sl[1].x*s_gq.points().at(i).x + m_Sl[2].x*s_gq.points().at(i).y;
-        y = m_Sl[0].y*(1.0-s_gq.points().at(i).x-s_gq.points().at(i).y) + m_Sl[1].y*s_gq.points().at(i).x + m_Sl[2].y*s_gq.points().at(i).y;
+        x = m_Sl[0].x*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].x*Rule::nodes[i].x + m_Sl[2].x*Rule::nodes[i].y;
+        y = m_Sl[0].y*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].y*Rule::nodes[i].x + m_Sl[2].y*Rule::nodes[i].y;
 
         //convert the local panel point to global coordinates
         localToGlobalPosition(x,y,0.0, ptGlobal.x, ptGlobal.y, ptGlobal.z);
@@ -2316,7 +2533,7 @@ void Panel3::scalarProductSourcePotential(const Panel3 &SourcePanel, bool bSelf,
         //scalar product with basis function
         for(int l=0; l<3; l++)
         {
-            integrand = phiSource * basis(x,y,l) * s_gq.weights().at(i);
+            integrand = phiSource * basis(x,y,l) * Rule::nodes[i].w;
             sum[l] += integrand;
         }
     }
@@ -2331,6 +2548,13 @@ void Panel3::scalarProductSourcePotential(const Panel3 &SourcePanel, bool bSelf,
  * on the sourcepanel with the basis functions of this panel.
  */
 void Panel3::scalarProductSourceVelocity(Panel3 const &SourcePanel, bool bSelf, double *sp) const
+{
+    gq::withTriangleRule(s_iQuadratureOrder, [&](auto rule){scalarProductSourceVelocity<decltype(rule)::value>(SourcePanel, bSelf, sp);});
+}
+
+
+template<int order>
+void Panel3::scalarProductSourceVelocity(Panel3 const &SourcePanel, bool bSelf, double *sp) const
 {
     if(!sp) return;
 
@@ -2339,10 +2563,11 @@ void Panel3::scalarProductSourceVelocity(Panel3 const &SourcePanel, bool bSelf,
     double integrand(0);
     double sum[]{0,0,0};
 
-    for(uint i=0; i<s_gq.points().size(); i++)
+    using Rule = GQTriangleRule<order>;
+    for(int i=0; i<Rule::nPoints; i++)
     {
-        double x = m_Sl[0].x*(1.0-s_gq.points().at(i).x-s_gq.points().at(i).y) + m_Sl[1].x*s_gq.points().at(i).x + m_Sl[2].x*s_gq.points().at(i).y;
-        double y = m_Sl[0].y*(1.0-s_gq.points().at(i).x-s_gq.points().at(i).y) + m_Sl[1].y*s_gq.points().at(i).x + m_Sl[2].y*s_gq.points().at(i).y;
+        double x = m_Sl[0].x*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].x*Rule::nodes[i].x + m_Sl[2].x*Rule::nodes[i].y;
+        double y = m_Sl[0].y*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].y*Rule::nodes[i].x + m_Sl[2].y*Rule::nodes[i].y;
 
         //convert the local panel point to global coordinates
         localToGlobalPosition(x,y,0.0, ptGlobal.x, ptGlobal.y, ptGlobal.z);
@@ -2354,7 +2579,7 @@ void Panel3::scalarProductSourceVelocity(Panel3 const &SourcePanel, bool bSelf,
         //scalar product with basis function
         for(int l=0; l<3; l++)
         {
-            integrand = -Vel.dot(m_Normal) * basis(x,y,l) * s_gq.weights().at(i);
+            integrand = -Vel.dot(m_Normal) * basis(x,y,l) * Rule::nodes[i].w;
             sum[l] += integrand;
         }
     }
@@ -2369,16 +2594,24 @@ void Panel3::scalarProductSourceVelocity(Panel3 const &SourcePanel, bool bSelf,
  * of this panel using Gaussian quadrature.
  */
 void Panel3::scalarProductDoubletPotential(Panel3 const &DoubletPanel, bool bSelf, double *sp) const
+{
+    gq::withTriangleRule(s_iQuadratureOrder, [&](auto rule){scalarProductDoubletPotential<decltype(rule)::value>(DoubletPanel, bSelf, sp);});
+}
+
+
+template<int order>
+void Panel3::scalarProductDoubletPotential(Panel3 const &DoubletPanel, bool bSelf, double *sp) const
 {
     Vector3d ptGlobal;
     double integrand(0);
     double sum[]{0,0,0,0,0,0,0,0,0};
     double phi[]{0,0,0};
 
-    for(uint i=0; i<s_gq.points().size(); i++)
+    using Rule = GQTriangleRule<order>;
+    for(int i=0; i<Rule::nPoints; i++)
     {
-        double x = m_Sl[0].x*(1.0-s_gq.points().at(i).x-s_gq.points().at(i).y) + m_Sl[1].x*s_gq.points().at(i).x + m_Sl[2].x*s_gq.points().at(i).y;
-        double y = m_Sl[0].y*(1.0-s_gq.points().at(i).x-s_gq.points().at(i).y) + m_Sl[1].y*s_gq.points().at(i).x + m_Sl[2].y*s_gq.points().at(i).y;
+        double x = m_Sl[0].x*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].x*Rule::nodes[i].x + m_Sl[2].x*Rule::nodes[i].y;
+        double y = m_Sl[0].y*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].y*Rule::nodes[i].x + m_Sl[2].y*Rule::nodes[i].y;
 
         localToGlobalPosition(x,y,0.0, ptGlobal.x, ptGlobal.y, ptGlobal.z);
         DoubletPanel.doubletBasisPotential(ptGlobal, bSelf, phi, true);
@@ -2387,7 +2620,7 @@ void Panel3::scalarProductDoubletPotential(Panel3 const &DoubletPanel, bool bSel
         {
             for(int l=0; l<3; l++)
             {
-                integrand = phi[l] * basis(x,y,k) * s_gq.weights().at(i);
+                integrand = phi[l] * basis(x,y,k) * Rule::nodes[i].w;
                 sum[3*k+l] += integrand;
             }
         }
@@ -2403,6 +2636,13 @@ void Panel3::scalarProductDoubletPotential(Panel3 const &DoubletPanel, bool bSel
  * of this panel using Gaussian quadrature.
  */
 void Panel3::scalarProductDoubletVelocity(const Panel3 &DoubletPanel, double *sp) const
+{
+    gq::withTriangleRule(s_iQuadratureOrder, [&](auto rule){scalarProductDoubletVelocity<decltype(rule)::value>(DoubletPanel, sp);});
+}
+
+
+template<int order>
+void Panel3::scalarProductDoubletVelocity(const Panel3 &DoubletPanel, double *sp) const
 {
     Vector3d ptGlobal;
     Vector3d V[3];
@@ -2410,10 +2650,11 @@ void Panel3::scalarProductDoubletVelocity(const Panel3 &DoubletPanel, double *sp
     double integrand(0);
     double sum[]{0,0,0,0,0,0,0,0,0};
 
-    for(uint i=0; i<s_gq.points().size(); i++)
+    using Rule = GQTriangleRule<order>;
+    for(int i=0; i<Rule::nPoints; i++)
     {
-        double x = m_Sl[0].x*(1.0-s_gq.points().at(i).x-s_gq.points().at(i).y) + m_Sl[1].x*s_gq.points().at(i).x + m_Sl[2].x*s_gq.points().at(i).y;
-        double y = m_Sl[0].y*(1.0-s_gq.points().at(i).x-s_gq.points().at(i).y) + m_Sl[1].y*s_gq.points().at(i).x + m_Sl[2].y*s_gq.points().at(i).y;
+        double x = m_Sl[0].x*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].x*Rule::nodes[i].x + m_Sl[2].x*Rule::nodes[i].y;
+        double y = m_Sl[0].y*(1.0-Rule::nodes[i].x-Rule::nodes[i].y) + m_Sl[1].y*Rule::nodes[i].x + m_Sl[2].y*Rule::nodes[i].y;
 
         localToGlobalPosition(x,y,0.0, ptGlobal.x, ptGlobal.y, ptGlobal.z);
         DoubletPanel.doubletBasisVelocity(ptGlobal, V, true);
@@ -2422,7 +2663,7 @@ void Panel3::scalarProductDoubletVelocity(const Panel3 &DoubletPanel, double *sp
         {
             for(int l=0; l<3; l++)
             {
-                integrand = V[l].dot(m_Normal) * basis(x,y,k) * s_gq.weights().at(i);
+                integrand = V[l].dot(m_Normal) * basis(x,y,k) * Rule::nodes[i].w;
                 sum[3*k+l] += integrand;
             }
         }
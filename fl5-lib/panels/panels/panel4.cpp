@@ -259,6 +259,21 @@ void Panel4::rotate(double alpha, double beta, double phi)
 }
 
 
+/**
+ * Rotates the nodes and their normals about the origin with a composed rotation, and rebuilds the frame once.
+ * @param Qt the rotation, made for instance by XflMesh::rotationQuaternion()
+ */
+void Panel4::rotate(Quaternion const &Qt)
+{
+    for(int i=0; i<4; i++)
+    {
+        Qt.conjugate(m_Node[i]);
+        Qt.conjugate(m_Node[i].normal());
+    }
+    setPanelFrame();
+}
+
+
 void Panel4::rotate(Vector3d const &HA, Vector3d const &Axis, double angle)
 {
     for(int i=0; i<4; i++)
@@ -763,6 +778,74 @@ void Panel4::doubletVortexVelocity(Vector3d const &C, Vector3d &V, double corera
 }
 
 
+/**
+ * Batched version of doubletVortexVelocity() for the nPts points of array C.
+ * The far field formula is first evaluated at all the points in a branch-free loop over the targets,
+ * then the near field points are overwritten with the velocities induced by the ring's four vortices.
+ */
+void Panel4::doubletVortexVelocity(int nPts, Vector3d const *C, Vector3d *V, double coreradius, bool bUseRFF) const
+{
+    if(nPts==1) return doubletVortexVelocity(C[0], V[0], coreradius, bUseRFF);
+
+    double const rff = s_RFF*m_MaxSize;
+
+    if(bUseRFF)
+    {
+        for(int ip=0; ip<nPts; ip++)
+        {
+            double PJKx = C[ip].x - m_CollPt.x;
+            double PJKy = C[ip].y - m_CollPt.y;
+            double PJKz = C[ip].z - m_CollPt.z;
+
+            double PN   = PJKx*m_Normal.x + PJKy*m_Normal.y + PJKz*m_Normal.z;
+            double pjk2 = PJKx*PJKx + PJKy*PJKy + PJKz*PJKz;
+            double coef = m_Area/(pjk2*pjk2*sqrt(pjk2));
+
+            V[ip].x = (PJKx*3.0*PN - m_Normal.x*pjk2) * coef;
+            V[ip].y = (PJKy*3.0*PN - m_Normal.y*pjk2) * coef;
+            V[ip].z = (PJKz*3.0*PN - m_Normal.z*pjk2) * coef;
+        }
+    }
+
+    for(int ip=0; ip<nPts; ip++)
+    {
+        if(bUseRFF && C[ip].distanceTo(m_CollPt)>rff) continue;
+        doubletVortexVelocity(C[ip], V[ip], coreradius, false);
+    }
+}
+
+
+/**
+ * Batched version of sourceN4023Velocity() for the nPts points of array C, none of which is the panel's own collocation point.
+ * The far field formula is first evaluated at all the points, then the near field points are overwritten.
+ */
+void Panel4::sourceN4023Velocity(int nPts, Vector3d const *C, Vector3d *Vel, double coreradius) const
+{
+    if(nPts==1) return sourceN4023Velocity(C[0], false, Vel[0], coreradius);
+
+    double const rff = s_RFF*m_MaxSize;
+
+    for(int ip=0; ip<nPts; ip++)
+    {
+        double PJKx = C[ip].x - m_CollPt.x;
+        double PJKy = C[ip].y - m_CollPt.y;
+        double PJKz = C[ip].z - m_CollPt.z;
+        double pjk2 = PJKx*PJKx + PJKy*PJKy + PJKz*PJKz;
+        double coef = m_Area/(pjk2*sqrt(pjk2));
+
+        Vel[ip].x = PJKx * coef;
+        Vel[ip].y = PJKy * coef;
+        Vel[ip].z = PJKz * coef;
+    }
+
+    for(int ip=0; ip<nPts; ip++)
+    {
+        if(C[ip].distanceTo(m_CollPt)>rff) continue;
+        sourceN4023Velocity(C[ip], false, Vel[ip], coreradius);
+    }
+}
+
+
 double Panel4::width() const
 {
     double l0 =  sqrt( (LB().y - LA().y)*(LB().y - LA().y) +(LB().z - LA().z)*(LB().z - LA().z));
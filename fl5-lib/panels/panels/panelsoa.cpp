@@ -0,0 +1,134 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <cmath>
+#include <limits>
+
+#include <panelsoa.h>
+#include <panel.h>
+
+
+void PanelSoA::clear()
+{
+    resize(0);
+}
+
+
+void PanelSoA::resize(int n)
+{
+    m_x.resize(n);
+    m_y.resize(n);
+    m_z.resize(n);
+    m_nx.resize(n);
+    m_ny.resize(n);
+    m_nz.resize(n);
+    m_Area.resize(n);
+    m_FFDist.resize(n);
+}
+
+
+/**
+ * @param refpt the point from which the distance is measured in the far-field formula,
+ * i.e. the collocation point for quads and the centroid for triangles.
+ */
+void PanelSoA::setPanel(int i, Panel const &panel, Vector3d const &refpt, bool bFarFieldEligible)
+{
+    m_x[i] = refpt.x;
+    m_y[i] = refpt.y;
+    m_z[i] = refpt.z;
+    m_nx[i] = panel.normal().x;
+    m_ny[i] = panel.normal().y;
+    m_nz[i] = panel.normal().z;
+    m_Area[i] = panel.area();
+    // an infinite distance excludes the panel from the far-field formula without a test in the kernel loop
+    m_FFDist[i] = bFarFieldEligible ? Panel::RFF()*panel.minSize() : std::numeric_limits<double>::infinity();
+}
+
+
+/**
+ * Evaluates the far-field potential of the unit doublet panels at point C, i.e. -A.(PC.N)/|PC|^3,
+ * with the same sequence of operations as the per-panel methods.
+ * @param inplaneprecision the distance to the panel's plane below which the potential is set to 0; 0 to disable
+ * @param phi the array of potentials, set to 0 for the panels flagged as near
+ * @param bNear the array of flags set to 1 for the panels which require the exact formula
+ */
+void PanelSoA::doubletFarFieldPotential(Vector3d const &C, double inplaneprecision, double *phi, unsigned char *bNear) const
+{
+    int n = size();
+    double const *x  = m_x.data();
+    double const *y  = m_y.data();
+    double const *z  = m_z.data();
+    double const *nx = m_nx.data();
+    double const *ny = m_ny.data();
+    double const *nz = m_nz.data();
+    double const *area   = m_Area.data();
+    double const *ffdist = m_FFDist.data();
+
+    for(int i=0; i<n; i++)
+    {
+        double dx = C.x - x[i];
+        double dy = C.y - y[i];
+        double dz = C.z - z[i];
+        double pn = dx*nx[i] + dy*ny[i] + dz*nz[i];
+        double r  = sqrt(dx*dx + dy*dy + dz*dz);
+        bool bFar = r>ffdist[i];
+        double p = -pn * area[i] /r/r/r;
+        phi[i]   = (bFar && std::fabs(pn)>=inplaneprecision) ? p : 0.0;
+        bNear[i] = bFar ? 0 : 1;
+    }
+}
+
+
+/**
+ * Adds coef times the far-field potential at point C to the array phi, and flags the panels which are near C.
+ * Used for the ground and free surface images, which are evaluated as the influence of the panels at the
+ * symmetric point below the surface, so that the image geometry is never built.
+ */
+void PanelSoA::addDoubletFarFieldPotential(Vector3d const &C, double inplaneprecision, double coef, double *phi, unsigned char *bNear) const
+{
+    int n = size();
+    double const *x  = m_x.data();
+    double const *y  = m_y.data();
+    double const *z  = m_z.data();
+    double const *nx = m_nx.data();
+    double const *ny = m_ny.data();
+    double const *nz = m_nz.data();
+    double const *area   = m_Area.data();
+    double const *ffdist = m_FFDist.data();
+
+    for(int i=0; i<n; i++)
+    {
+        double dx = C.x - x[i];
+        double dy = C.y - y[i];
+        double dz = C.z - z[i];
+        double pn = dx*nx[i] + dy*ny[i] + dz*nz[i];
+        double r  = sqrt(dx*dx + dy*dy + dz*dz);
+        bool bFar = r>ffdist[i];
+        double p = -pn * area[i] /r/r/r;
+        phi[i]  += (bFar && std::fabs(pn)>=inplaneprecision) ? p*coef : 0.0;
+        bNear[i] = bFar ? bNear[i] : 1;
+    }
+}
+
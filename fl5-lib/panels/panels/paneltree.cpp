@@ -0,0 +1,162 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <cmath>
+
+#include <paneltree.h>
+
+
+int PanelTree::s_LeafSize = 8;
+
+
+PanelTree::PanelTree()
+{
+    m_Theta = 0.3;
+    m_pMu = m_pSigma = nullptr;
+}
+
+
+/**
+ * Builds the octree from the elements made with the doublet and source strengths Mu and Sigma;
+ * the arrays are only kept as a key to check that a later query uses the same strengths.
+ */
+void PanelTree::build(std::vector<Element> const &elements, double const *Mu, double const *Sigma)
+{
+    clear();
+    m_Element = elements;
+    if(m_Element.empty()) return;
+
+    m_pMu = Mu;
+    m_pSigma = Sigma;
+
+    Vector3d boxmin = m_Element.front().m_Position;
+    Vector3d boxmax = boxmin;
+    for(Element const &elem : m_Element)
+    {
+        Vector3d const &pos = elem.m_Position;
+        boxmin.set(std::min(boxmin.x, pos.x), std::min(boxmin.y, pos.y), std::min(boxmin.z, pos.z));
+        boxmax.set(std::max(boxmax.x, pos.x), std::max(boxmax.y, pos.y), std::max(boxmax.z, pos.z));
+    }
+    Vector3d ext = boxmax-boxmin;
+    double halfsize = std::max(std::max(ext.x, ext.y), ext.z)/2.0 * 1.0001 + 1.0e-9;
+
+    m_Node.reserve(2*m_Element.size()/s_LeafSize+1);
+    makeNode((boxmin+boxmax)*0.5, halfsize, 0, int(m_Element.size()), 0);
+}
+
+
+/** Creates the cell of the elements [first, first+count[ and recursively splits it in octants */
+int PanelTree::makeNode(Vector3d const &center, double halfsize, int first, int count, int depth)
+{
+    int in = int(m_Node.size());
+    m_Node.push_back(Node());
+
+    Node node;
+    node.m_Center   = center;
+    node.m_HalfSize = halfsize;
+    node.m_First    = first;
+    node.m_Count    = count;
+
+    // the moments about the centroid of the elements
+    Vector3d pos;
+    for(int i=first; i<first+count; i++) pos += m_Element.at(i).m_Position;
+    pos *= 1.0/double(count);
+    node.m_Expansion = pos;
+
+    for(int i=first; i<first+count; i++)
+    {
+        Element const &elem = m_Element.at(i);
+        node.m_Source += elem.m_Source;
+        node.m_Dipole += (elem.m_Position-pos)*elem.m_Source + elem.m_Dipole;
+        node.m_Radius = std::max(node.m_Radius, elem.m_Position.distanceTo(pos)+elem.m_Radius);
+    }
+
+    if(count>s_LeafSize && depth<s_MaxDepth)
+    {
+        node.m_bLeaf = false;
+
+        // group the elements by octant with in-place partitions on z, then y, then x
+        auto octant = [&center](Element const &elem)
+        {
+            Vector3d const &p = elem.m_Position;
+            return (p.x>center.x ? 1 : 0) + (p.y>center.y ? 2 : 0) + (p.z>center.z ? 4 : 0);
+        };
+        auto itFirst = m_Element.begin()+first;
+        auto itLast  = itFirst+count;
+        auto itZ = std::partition(itFirst, itLast, [&octant](Element const &elem){return (octant(elem)&4)==0;});
+        for(auto const &half : {std::make_pair(itFirst, itZ), std::make_pair(itZ, itLast)})
+        {
+            auto itY = std::partition(half.first, half.second, [&octant](Element const &elem){return (octant(elem)&2)==0;});
+            std::partition(half.first, itY,         [&octant](Element const &elem){return (octant(elem)&1)==0;});
+            std::partition(itY,        half.second, [&octant](Element const &elem){return (octant(elem)&1)==0;});
+        }
+
+        int start = first;
+        double h = halfsize/2.0;
+        for(int io=0; io<8; io++)
+        {
+            int end = start;
+            while(end<first+count && octant(m_Element.at(end))==io) end++;
+            if(end>start)
+            {
+                Vector3d c(center.x + ((io&1) ? h : -h),
+                           center.y + ((io&2) ? h : -h),
+                           center.z + ((io&4) ? h : -h));
+                node.m_Child[io] = makeNode(c, h, start, end-start, depth+1);
+            }
+            start = end;
+        }
+    }
+
+    m_Node[in] = node;
+    return in;
+}
+
+
+bool PanelTree::isFarField(Node const &node, Vector3d const &C) const
+{
+    if(m_Theta<=0.0) return false;
+    double d = node.m_Expansion.distanceTo(C);
+    return 2.0*node.m_Radius < m_Theta*d;
+}
+
+
+/** Returns in V the velocity induced at point C by the monopole and the dipole of the node, with the scaling of the panel kernels */
+void PanelTree::farFieldVelocity(Node const &node, Vector3d const &C, Vector3d &V) const
+{
+    Vector3d R = C-node.m_Expansion;
+    double r2 = R.x*R.x + R.y*R.y + R.z*R.z;
+    double r  = sqrt(r2);
+    double r3 = r2*r;
+    double r5 = r3*r2;
+    Vector3d const &D = node.m_Dipole;
+    double RD = R.x*D.x + R.y*D.y + R.z*D.z;
+
+    V.x = R.x*node.m_Source/r3 + (3.0*R.x*RD - D.x*r2)/r5;
+    V.y = R.y*node.m_Source/r3 + (3.0*R.y*RD - D.y*r2)/r5;
+    V.z = R.z*node.m_Source/r3 + (3.0*R.z*RD - D.z*r2)/r5;
+}
+
@@ -26,6 +26,7 @@
 
 #include <vortex.h>
 #include <panelprecision.h>
+#include <utils.h>
 
 Vortex::enumVortex Vortex::s_VortexModel = Vortex::LAMB_OSEEN;
 double Vortex::s_CoreRadius = 1.e-6;
@@ -78,6 +79,62 @@ bool Vortex::serializeFl5(QDataStream &ar, bool bIsStoring)
 }
 
 
+/**
+ * Serializes the size of the array followed by its vortices, in the format of serializeFl5(),
+ * encoded and decoded in one block.
+ */
+bool Vortex::serializeArrayFl5(QDataStream &ar, std::vector<Vortex> &vortices, bool bIsStoring)
+{
+    int const ArchiveFormat = 500001;
+    xfl::RecordCodec codec(ar);
+    size_t recordsize = 4 + 7*codec.doubleSize();
+    std::vector<char> buffer;
+
+    if(bIsStoring)
+    {
+        ar << int(vortices.size());
+        buffer.resize(vortices.size()*recordsize);
+        char *p = buffer.data();
+        for(Vortex const &vtx : vortices)
+        {
+            codec.putInt(p, ArchiveFormat);
+            for(int i=0; i<2; i++)
+            {
+                codec.putDouble(p, vtx.m_S[i].x);
+                codec.putDouble(p, vtx.m_S[i].y);
+                codec.putDouble(p, vtx.m_S[i].z);
+            }
+            codec.putDouble(p, vtx.m_Circulation);
+        }
+        xfl::writeRawBlock(ar, buffer);
+    }
+    else
+    {
+        int n(0);
+        ar >> n;
+        if(ar.status()!=QDataStream::Ok || n<0) return false;
+        if(!xfl::readRawBlock(ar, buffer, size_t(n)*recordsize)) return false;
+
+        vortices.resize(n);
+        char const *p = buffer.data();
+        for(Vortex &vtx : vortices)
+        {
+            if(codec.getInt(p)!=ArchiveFormat) return false;
+            Node S[2];
+            for(int i=0; i<2; i++)
+            {
+                S[i].x = codec.getDouble(p);
+                S[i].y = codec.getDouble(p);
+                S[i].z = codec.getDouble(p);
+            }
+            vtx.m_Circulation = codec.getDouble(p);
+            vtx.setNodes(S[0], S[1]);
+        }
+    }
+    return true;
+}
+
+
 
 /**
  * Returns the velocity induced by the vortex defined by the segment AB with unit strength
@@ -31,6 +31,7 @@
 
 #include <vorton.h>
 #include <constants.h>
+#include <utils.h>
 
 
 bool Vorton::s_bMollify=true; /** @todo debug only, remove */
@@ -75,6 +76,37 @@ void Vorton::setCirculation(double gamma)
 }
 
 
+/**
+ * Merges the other vorton into this one, which is moved so that the sum of the vortex vectors is conserved,
+ * as well as the linear impulse 1/2.Sum(x*omega) to within its component along the merged vortex,
+ * which a single particle cannot carry and which is zero if the two vortices are aligned.
+ * The other vorton is left unchanged and should be deactivated by the caller.
+ */
+void Vorton::merge(Vorton const &other)
+{
+    Vector3d omega = m_Omega + other.m_Omega;
+    double w0 = circulation();
+    double w1 = other.circulation();
+
+    // the circulation-weighted centroid
+    Vector3d pos = m_Position;
+    if(w0+w1>0.0) pos = (m_Position*w0 + other.m_Position*w1)*(1.0/(w0+w1));
+
+    // the displacement normal to the merged vortex which restores the impulse
+    double omega2 = omega.dot(omega);
+    if(omega2>0.0)
+    {
+        Vector3d impulse = m_Position*m_Omega + other.m_Position*other.m_Omega;
+        Vector3d R = impulse - pos*omega;
+        pos += (omega*R)*(1.0/omega2);
+    }
+
+    m_Position = pos;
+    m_Omega = omega;
+    m_Volume += other.m_Volume;
+}
+
+
 /**
  * Returns the velocity gradient G of the velocity vector
  * G is a 3x3 tensor such that g_ij = dV_j/dx_i.
@@ -176,3 +208,59 @@ bool Vorton::serializeFl5(QDataStream &ar, bool bIsStoring)
     }
     return true;
 }
+
+
+/**
+ * Serializes the size of the array followed by its vortons, in the format of serializeFl5(),
+ * encoded and decoded in one block.
+ */
+bool Vorton::serializeArrayFl5(QDataStream &ar, std::vector<Vorton> &vortons, bool bIsStoring)
+{
+    int const ArchiveFormat = 500001;
+    xfl::RecordCodec codec(ar);
+    size_t recordsize = 4 + 7*codec.doubleSize() + 1;
+    std::vector<char> buffer;
+
+    if(bIsStoring)
+    {
+        ar << int(vortons.size());
+        buffer.resize(vortons.size()*recordsize);
+        char *p = buffer.data();
+        for(Vorton const &vtn : vortons)
+        {
+            codec.putInt(p, ArchiveFormat);
+            codec.putDouble(p, vtn.m_Position.x);
+            codec.putDouble(p, vtn.m_Position.y);
+            codec.putDouble(p, vtn.m_Position.z);
+            codec.putDouble(p, vtn.m_Omega.x);
+            codec.putDouble(p, vtn.m_Omega.y);
+            codec.putDouble(p, vtn.m_Omega.z);
+            codec.putDouble(p, vtn.m_Volume);
+            codec.putBool(p, vtn.m_bActive);
+        }
+        xfl::writeRawBlock(ar, buffer);
+    }
+    else
+    {
+        int n(0);
+        ar >> n;
+        if(ar.status()!=QDataStream::Ok || n<0) return false;
+        if(!xfl::readRawBlock(ar, buffer, size_t(n)*recordsize)) return false;
+
+        vortons.resize(n);
+        char const *p = buffer.data();
+        for(Vorton &vtn : vortons)
+        {
+            if(codec.getInt(p)!=ArchiveFormat) return false;
+            vtn.m_Position.x = codec.getDouble(p);
+            vtn.m_Position.y = codec.getDouble(p);
+            vtn.m_Position.z = codec.getDouble(p);
+            vtn.m_Omega.x    = codec.getDouble(p);
+            vtn.m_Omega.y    = codec.getDouble(p);
+            vtn.m_Omega.z    = codec.getDouble(p);
+            vtn.m_Volume     = codec.getDouble(p);
+            vtn.m_bActive    = codec.getBool(p);
+        }
+    }
+    return true;
+}
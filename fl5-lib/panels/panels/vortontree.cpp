@@ -0,0 +1,219 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <cstring>
+
+#include <vortontree.h>
+
+
+int VortonTree::s_LeafSize = 8;
+
+
+VortonTree::VortonTree()
+{
+    m_Theta = 0.5;
+}
+
+
+/** Builds the octree from the active vortons of all the rows */
+void VortonTree::build(std::vector<std::vector<Vorton>> const &vortonrows)
+{
+    clear();
+
+    for(std::vector<Vorton> const &row : vortonrows)
+        for(Vorton const &vtn : row)
+            if(vtn.isActive()) m_Vorton.push_back(vtn);
+
+    if(m_Vorton.empty()) return;
+
+    Vector3d boxmin = m_Vorton.front().position();
+    Vector3d boxmax = boxmin;
+    for(Vorton const &vtn : m_Vorton)
+    {
+        Vector3d const &pos = vtn.position();
+        boxmin.set(std::min(boxmin.x, pos.x), std::min(boxmin.y, pos.y), std::min(boxmin.z, pos.z));
+        boxmax.set(std::max(boxmax.x, pos.x), std::max(boxmax.y, pos.y), std::max(boxmax.z, pos.z));
+    }
+    Vector3d ext = boxmax-boxmin;
+    double halfsize = std::max(std::max(ext.x, ext.y), ext.z)/2.0 * 1.0001 + 1.0e-9;
+
+    m_Node.reserve(2*m_Vorton.size()/s_LeafSize+1);
+    makeNode((boxmin+boxmax)*0.5, halfsize, 0, int(m_Vorton.size()), 0);
+}
+
+
+/** Creates the cell of the vortons [first, first+count[ and recursively splits it in octants */
+int VortonTree::makeNode(Vector3d const &center, double halfsize, int first, int count, int depth)
+{
+    int in = int(m_Node.size());
+    m_Node.push_back(Node());
+
+    Node node;
+    node.m_Center   = center;
+    node.m_HalfSize = halfsize;
+    node.m_First    = first;
+    node.m_Count    = count;
+
+    // the equivalent vorton
+    Vector3d omega, pos;
+    double weight = 0.0;
+    for(int i=first; i<first+count; i++)
+    {
+        Vorton const &vtn = m_Vorton.at(i);
+        double w = vtn.circulation();
+        omega += vtn.vortex();
+        pos   += vtn.position()*w;
+        weight += w;
+    }
+    if(weight>0.0) pos = pos*(1.0/weight);
+    else           pos = center;
+    node.m_Equivalent.setPosition(pos);
+    node.m_Equivalent.setVortex(omega);
+
+    if(count>s_LeafSize && depth<s_MaxDepth)
+    {
+        node.m_bLeaf = false;
+
+        // group the vortons by octant with in-place partitions on z, then y, then x,
+        // since a sort would allocate a merge buffer for each cell each time the tree is rebuilt
+        auto octant = [&center](Vorton const &vtn)
+        {
+            Vector3d const &p = vtn.position();
+            return (p.x>center.x ? 1 : 0) + (p.y>center.y ? 2 : 0) + (p.z>center.z ? 4 : 0);
+        };
+        auto itFirst = m_Vorton.begin()+first;
+        auto itLast  = itFirst+count;
+        auto itZ = std::partition(itFirst, itLast, [&octant](Vorton const &vtn){return (octant(vtn)&4)==0;});
+        for(auto const &half : {std::make_pair(itFirst, itZ), std::make_pair(itZ, itLast)})
+        {
+            auto itY = std::partition(half.first, half.second, [&octant](Vorton const &vtn){return (octant(vtn)&2)==0;});
+            std::partition(half.first, itY,         [&octant](Vorton const &vtn){return (octant(vtn)&1)==0;});
+            std::partition(itY,        half.second, [&octant](Vorton const &vtn){return (octant(vtn)&1)==0;});
+        }
+
+        int start = first;
+        double h = halfsize/2.0;
+        for(int io=0; io<8; io++)
+        {
+            int end = start;
+            while(end<first+count && octant(m_Vorton.at(end))==io) end++;
+            if(end>start)
+            {
+                Vector3d c(center.x + ((io&1) ? h : -h),
+                           center.y + ((io&2) ? h : -h),
+                           center.z + ((io&4) ? h : -h));
+                node.m_Child[io] = makeNode(c, h, start, end-start, depth+1);
+            }
+            start = end;
+        }
+    }
+
+    m_Node[in] = node;
+    return in;
+}
+
+
+bool VortonTree::isFarField(Node const &node, Vector3d const &C) const
+{
+    if(m_Theta<=0.0) return false;
+    double d = node.m_Equivalent.position().distanceTo(C);
+    return 2.0*node.m_HalfSize < m_Theta*d;
+}
+
+
+/** Returns in V the velocity induced at point C by the vortons */
+void VortonTree::inducedVelocity(Vector3d const &C, double CoreSize, Vector3d &V) const
+{
+    V.reset();
+    if(m_Node.empty()) return;
+
+    Vector3d v;
+    // a fixed stack, since the traversal is made for each field point
+    int stack[s_MaxStack];
+    int nStack = 0;
+    stack[nStack++] = 0;
+    while(nStack>0)
+    {
+        Node const &node = m_Node.at(stack[--nStack]);
+
+        if(isFarField(node, C))
+        {
+            node.m_Equivalent.inducedVelocity(C, CoreSize, v);
+            V += v;
+        }
+        else if(node.m_bLeaf)
+        {
+            for(int i=node.m_First; i<node.m_First+node.m_Count; i++)
+            {
+                m_Vorton.at(i).inducedVelocity(C, CoreSize, v);
+                V += v;
+            }
+        }
+        else
+        {
+            for(int io=0; io<8; io++)
+                if(node.m_Child[io]>=0) stack[nStack++] = node.m_Child[io];
+        }
+    }
+}
+
+
+/** Returns in G the gradient of the velocity induced at point C by the vortons; g_ij = dV_j/dx_i */
+void VortonTree::velocityGradient(Vector3d const &C, double CoreSize, double *G) const
+{
+    memset(G, 0, 9*sizeof(double));
+    if(m_Node.empty()) return;
+
+    double g[9];
+    // a fixed stack, since the traversal is made for each field point
+    int stack[s_MaxStack];
+    int nStack = 0;
+    stack[nStack++] = 0;
+    while(nStack>0)
+    {
+        Node const &node = m_Node.at(stack[--nStack]);
+
+        if(isFarField(node, C))
+        {
+            node.m_Equivalent.velocityGradient(C, CoreSize, g);
+            for(int k=0; k<9; k++) G[k] += g[k];
+        }
+        else if(node.m_bLeaf)
+        {
+            for(int i=node.m_First; i<node.m_First+node.m_Count; i++)
+            {
+                m_Vorton.at(i).velocityGradient(C, CoreSize, g);
+                for(int k=0; k<9; k++) G[k] += g[k];
+            }
+        }
+        else
+        {
+            for(int io=0; io<8; io++)
+                if(node.m_Child[io]>=0) stack[nStack++] = node.m_Child[io];
+        }
+    }
+}
+
@@ -0,0 +1,224 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <vortonwake.h>
+
+#include <memorybudget.h>
+#include <utils.h>
+
+
+VortonWake::VortonWake()
+{
+    m_RowStart.push_back(0);
+    m_bTree = false;
+}
+
+
+VortonWake::VortonWake(VortonWake const &wake)
+{
+    m_bTree = false;
+    *this = wake;
+}
+
+
+/** Copies the vortons; the octree is not copied and is rebuilt on demand */
+VortonWake &VortonWake::operator=(VortonWake const &wake)
+{
+    if(this==&wake) return *this;
+
+    m_RowStart = wake.m_RowStart;
+    m_X  = wake.m_X;
+    m_Y  = wake.m_Y;
+    m_Z  = wake.m_Z;
+    m_Wx = wake.m_Wx;
+    m_Wy = wake.m_Wy;
+    m_Wz = wake.m_Wz;
+    m_Active = wake.m_Active;
+
+    std::lock_guard<std::mutex> lock(m_TreeMutex);
+    m_Tree.clear();
+    m_bTree = false;
+    return *this;
+}
+
+
+void VortonWake::clear()
+{
+    std::vector<int>(1,0).swap(m_RowStart);
+    std::vector<float>().swap(m_X);
+    std::vector<float>().swap(m_Y);
+    std::vector<float>().swap(m_Z);
+    std::vector<float>().swap(m_Wx);
+    std::vector<float>().swap(m_Wy);
+    std::vector<float>().swap(m_Wz);
+    std::vector<unsigned char>().swap(m_Active);
+
+    std::lock_guard<std::mutex> lock(m_TreeMutex);
+    m_Tree.clear();
+    m_bTree = false;
+}
+
+
+void VortonWake::set(std::vector<std::vector<Vorton>> const &vortonrows)
+{
+    clear();
+
+    size_t n = 0;
+    for(std::vector<Vorton> const &row : vortonrows) n += row.size();
+    m_RowStart.reserve(vortonrows.size()+1);
+    m_X.reserve(n);   m_Y.reserve(n);   m_Z.reserve(n);
+    m_Wx.reserve(n);  m_Wy.reserve(n);  m_Wz.reserve(n);
+    m_Active.reserve(n);
+
+    for(std::vector<Vorton> const &row : vortonrows) appendRow(row);
+}
+
+
+void VortonWake::appendRow(std::vector<Vorton> const &row)
+{
+    for(Vorton const &vtn : row)
+    {
+        m_X.push_back(vtn.position().xf());
+        m_Y.push_back(vtn.position().yf());
+        m_Z.push_back(vtn.position().zf());
+        m_Wx.push_back(vtn.vortex().xf());
+        m_Wy.push_back(vtn.vortex().yf());
+        m_Wz.push_back(vtn.vortex().zf());
+        m_Active.push_back(vtn.isActive() ? 1 : 0);
+    }
+    m_RowStart.push_back(int(m_X.size()));
+
+    m_bTree = false;
+}
+
+
+Vorton VortonWake::vorton(int i) const
+{
+    Vorton vtn;
+    vtn.setPosition(position(i));
+    vtn.setVortex(vortex(i));
+    vtn.setActive(isActive(i));
+    return vtn;
+}
+
+
+/** Expands the wake in rows of vortons, e.g. to initialize an analysis; the volumes are set to zero */
+void VortonWake::makeVortons(std::vector<std::vector<Vorton>> &vortonrows) const
+{
+    vortonrows.resize(nRows());
+    for(int ir=0; ir<nRows(); ir++)
+    {
+        std::vector<Vorton> &row = vortonrows[ir];
+        row.resize(rowSize(ir));
+        for(int ic=0; ic<rowSize(ir); ic++) row[ic] = vorton(index(ir, ic));
+    }
+}
+
+
+void VortonWake::buildTree() const
+{
+    std::lock_guard<std::mutex> lock(m_TreeMutex);
+    if(m_bTree) return;
+
+    std::vector<std::vector<Vorton>> vortonrows;
+    makeVortons(vortonrows);
+    m_Tree.build(vortonrows);
+    m_bTree = true;
+}
+
+
+/** Returns in V the velocity induced at point C by the vortons; may be called concurrently from several threads */
+void VortonWake::inducedVelocity(Vector3d const &C, double CoreSize, Vector3d &V) const
+{
+    V.reset();
+    if(isEmpty()) return;
+    if(!m_bTree) buildTree();
+    m_Tree.inducedVelocity(C, CoreSize, V);
+}
+
+
+/**
+ * Serializes the wake in its compact form: the row sizes, then the columns of the positions and vortex vectors in
+ * single precision, then the active flags.
+ */
+bool VortonWake::serializeFl5(QDataStream &ar, bool bIsStoring)
+{
+    int const ArchiveFormat = 100001;
+    xfl::RecordCodec codec(ar);
+    std::vector<char> buffer;
+
+    if(bIsStoring)
+    {
+        ar << ArchiveFormat;
+        ar << nRows() << count();
+
+        buffer.resize(size_t(nRows())*4 + size_t(count())*(6*codec.floatSize()+1));
+        char *p = buffer.data();
+        for(int ir=0; ir<nRows(); ir++) codec.putInt(p, rowSize(ir));
+        for(std::vector<float> const *pColumn : {&m_X, &m_Y, &m_Z, &m_Wx, &m_Wy, &m_Wz})
+            for(float f : *pColumn) codec.putFloat(p, f);
+        for(unsigned char active : m_Active) codec.putBool(p, active!=0);
+        xfl::writeRawBlock(ar, buffer);
+    }
+    else
+    {
+        clear();
+
+        int format=0, nrows=0, n=0;
+        ar >> format;
+        if(format<100000 || format>100001) return false;
+        ar >> nrows >> n;
+        if(ar.status()!=QDataStream::Ok || nrows<0 || n<0) return false;
+        if(!xfl::readRawBlock(ar, buffer, size_t(nrows)*4 + size_t(n)*(6*codec.floatSize()+1))) return false;
+
+        char const *p = buffer.data();
+        m_RowStart.resize(nrows+1);
+        for(int ir=0; ir<nrows; ir++)
+        {
+            int size = codec.getInt(p);
+            if(size<0) return false;
+            m_RowStart[ir+1] = m_RowStart[ir] + size;
+        }
+        if(m_RowStart.back()!=n) return false;
+
+        for(std::vector<float> *pColumn : {&m_X, &m_Y, &m_Z, &m_Wx, &m_Wy, &m_Wz})
+        {
+            pColumn->resize(n);
+            for(float &f : *pColumn) f = codec.getFloat(p);
+        }
+        m_Active.resize(n);
+        for(unsigned char &active : m_Active) active = codec.getBool(p) ? 1 : 0;
+    }
+    return true;
+}
+
+
+size_t VortonWake::bytes() const
+{
+    return MemoryBudget::bytes(m_RowStart)
+         + MemoryBudget::bytes(m_X)  + MemoryBudget::bytes(m_Y)  + MemoryBudget::bytes(m_Z)
+         + MemoryBudget::bytes(m_Wx) + MemoryBudget::bytes(m_Wy) + MemoryBudget::bytes(m_Wz)
+         + MemoryBudget::bytes(m_Active);
+}
@@ -289,6 +289,58 @@ def analyze_foil_at_alphas(
         }
 
 
+def export_native_model(model_size: str, filename: str) -> dict:
+    """
+    Write the weights and biases of a NeuralFoil network to the binary file read by
+    the native C++ kernel (NeuralFoilNet), so that the analyses no longer need Python.
+
+    File layout, little-endian:
+        b'NFNN', int32 version (1), int32 number of layers,
+        then for each layer: int32 n_out, int32 n_in,
+        float64 weight[n_out][n_in], float64 bias[n_out]
+
+    Args:
+        model_size: NeuralFoil model size (xxsmall to xxxlarge)
+        filename: Path of the file to write; the directory is created if necessary
+
+    Returns:
+        Dictionary with 'success', 'n_layers' and 'error' (if failed)
+    """
+    try:
+        import glob
+        import struct
+        import neuralfoil
+
+        package_dir = os.path.dirname(os.path.abspath(neuralfoil.__file__))
+        candidates = glob.glob(os.path.join(package_dir, '**', f'nn-{model_size}.npz'), recursive=True)
+        if not candidates:
+            return {'success': False, 'error': f'nn-{model_size}.npz not found in {package_dir}'}
+
+        nn_params = dict(np.load(candidates[0]))
+        layer_indices = sorted(set(int(key.split('.')[1]) for key in nn_params.keys() if key.startswith('net.')))
+
+        directory = os.path.dirname(os.path.abspath(filename))
+        os.makedirs(directory, exist_ok=True)
+
+        # written to a temporary file first so that a reader never sees a partial model
+        temp_filename = filename + '.tmp'
+        with open(temp_filename, 'wb') as f:
+            f.write(b'NFNN')
+            f.write(struct.pack('<ii', 1, len(layer_indices)))
+            for i in layer_indices:
+                w = np.ascontiguousarray(nn_params[f'net.{i}.weight'], dtype='<f8')
+                b = np.ascontiguousarray(nn_params[f'net.{i}.bias'], dtype='<f8').reshape(-1)
+                f.write(struct.pack('<ii', w.shape[0], w.shape[1]))
+                f.write(w.tobytes())
+                f.write(b.tobytes())
+        os.replace(temp_filename, filename)
+
+        return {'success': True, 'n_layers': len(layer_indices)}
+
+    except Exception as e:
+        return {'success': False, 'error': str(e)}
+
+
 def run_cli_mode():
     """
     CLI mode: Read JSON input from stdin, process, write JSON output to stdout.
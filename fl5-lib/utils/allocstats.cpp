@@ -0,0 +1,84 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <allocstats.h>
+
+
+#ifdef FL5_ALLOC_STATS
+
+namespace
+{
+    // a relaxed increment is small compared to the cost of malloc itself
+    std::atomic<int64_t> g_nAllocs(0);
+    std::atomic<int64_t> g_nBytes(0);
+
+    void *countedAlloc(std::size_t size) noexcept
+    {
+        g_nAllocs.fetch_add(1, std::memory_order_relaxed);
+        g_nBytes.fetch_add(int64_t(size), std::memory_order_relaxed);
+        return std::malloc(size ? size : 1);
+    }
+}
+
+
+void *operator new(std::size_t size)
+{
+    void *p = countedAlloc(size);
+    if(!p) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](std::size_t size)
+{
+    void *p = countedAlloc(size);
+    if(!p) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(std::size_t size, std::nothrow_t const &) noexcept   {return countedAlloc(size);}
+void *operator new[](std::size_t size, std::nothrow_t const &) noexcept {return countedAlloc(size);}
+
+void operator delete(void *p) noexcept                                  {std::free(p);}
+void operator delete[](void *p) noexcept                                {std::free(p);}
+void operator delete(void *p, std::size_t) noexcept                     {std::free(p);}
+void operator delete[](void *p, std::size_t) noexcept                   {std::free(p);}
+void operator delete(void *p, std::nothrow_t const &) noexcept          {std::free(p);}
+void operator delete[](void *p, std::nothrow_t const &) noexcept        {std::free(p);}
+
+
+bool AllocStats::isCompiled() {return true;}
+int64_t AllocStats::count()   {return g_nAllocs.load(std::memory_order_relaxed);}
+int64_t AllocStats::bytes()   {return g_nBytes.load(std::memory_order_relaxed);}
+
+#else
+
+bool AllocStats::isCompiled() {return false;}
+int64_t AllocStats::count()   {return 0;}
+int64_t AllocStats::bytes()   {return 0;}
+
+#endif
@@ -0,0 +1,388 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <QFile>
+#include <QtEndian>
+
+#include <columnfile.h>
+
+#include <boatpolar.h>
+#include <opp3d.h>
+#include <planepolar.h>
+#include <polar.h>
+
+
+namespace
+{
+    char const COLUMNSIGNATURE[8] = {'F','L','5','C','O','L','S','\0'};
+    int const COLUMNFORMAT = 100001; // first columnar format
+
+    /** the values per write when the values must be converted to little-endian */
+    int const CHUNKSIZE = 4096;
+
+    /** The stored columns of a foil polar, and the names with which they are written */
+    struct PolarColumn
+    {
+        char const *m_Name;
+        std::vector<double> Polar::*m_pColumn;
+    };
+
+    PolarColumn const s_PolarColumns[] = {
+        {"alpha",        &Polar::m_Alpha},
+        {"theta",        &Polar::m_Control},
+        {"Cl",           &Polar::m_Cl},
+        {"Cd",           &Polar::m_Cd},
+        {"Cdp",          &Polar::m_Cdp},
+        {"Cm",           &Polar::m_Cm},
+        {"XCp",          &Polar::m_XCp},
+        {"Xtr_top",      &Polar::m_XTrTop},
+        {"Xtr_bot",      &Polar::m_XTrBot},
+        {"XLamSep_top",  &Polar::m_XLamSepTop},
+        {"XLamSep_bot",  &Polar::m_XLamSepBot},
+        {"XTurbSep_top", &Polar::m_XTurbSepTop},
+        {"XTurbSep_bot", &Polar::m_XTurbSepBot},
+        {"HMom",         &Polar::m_HMom},
+        {"Cpmin",        &Polar::m_Cpmn},
+        {"Cl/Cd",        &Polar::m_ClCd},
+        {"Cl^(3/2)/Cd",  &Polar::m_Cl32Cd},
+        {"1/sqrt(Cl)",   &Polar::m_RtCl},
+        {"Re",           &Polar::m_Re}
+    };
+
+    bool readInt(QFile &file, int &value)
+    {
+        char buffer[4];
+        if(file.read(buffer, 4)!=4) return false;
+        value = qFromLittleEndian<qint32>(buffer);
+        return true;
+    }
+
+    bool readString(QFile &file, std::string &str)
+    {
+        int length = 0;
+        if(!readInt(file, length) || length<0) return false;
+        str.resize(size_t(length));
+        return length==0 || file.read(&str[0], length)==length;
+    }
+}
+
+
+ColumnFile::ColumnFile()
+{
+    m_pFile = nullptr;
+    m_bError = false;
+}
+
+
+ColumnFile::~ColumnFile()
+{
+    close();
+}
+
+
+bool ColumnFile::open(std::string const &pathname)
+{
+    close();
+    m_bError = false;
+
+    m_pFile = new QFile(QString::fromStdString(pathname));
+    if(!m_pFile->open(QIODevice::WriteOnly|QIODevice::Truncate))
+    {
+        delete m_pFile;
+        m_pFile = nullptr;
+        return false;
+    }
+
+    if(m_pFile->write(COLUMNSIGNATURE, 8)!=8) m_bError = true;
+    writeInt(COLUMNFORMAT);
+    return !m_bError;
+}
+
+
+/** Closes the file; returns false if any of the writes has failed */
+bool ColumnFile::close()
+{
+    if(!m_pFile) return !m_bError;
+    m_pFile->close();
+    delete m_pFile;
+    m_pFile = nullptr;
+    return !m_bError;
+}
+
+
+bool ColumnFile::writeInt(int value)
+{
+    if(!m_pFile) return false;
+    char buffer[4];
+    qToLittleEndian<qint32>(value, buffer);
+    if(m_pFile->write(buffer, 4)!=4) m_bError = true;
+    return !m_bError;
+}
+
+
+bool ColumnFile::writeString(std::string const &str)
+{
+    writeInt(int(str.size()));
+    if(m_pFile && str.size() && m_pFile->write(str.data(), qint64(str.size()))!=qint64(str.size())) m_bError = true;
+    return !m_bError;
+}
+
+
+bool ColumnFile::writeText(std::string const &name, std::string const &value)
+{
+    writeInt(TEXT);
+    writeString(name);
+    return writeString(value);
+}
+
+
+/** Writes the values straight from the caller's array on little-endian platforms */
+bool ColumnFile::writeDataset(std::string const &name, double const *values, int nRows, int nCols)
+{
+    nRows = std::max(nRows, 0);
+    nCols = std::max(nCols, 0);
+    writeInt(DATASET);
+    writeString(name);
+    writeInt(nRows);
+    writeInt(nCols);
+    if(!m_pFile || m_bError) return false;
+
+    qint64 nValues = qint64(nRows)*qint64(nCols);
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    qint64 nBytes = nValues*qint64(sizeof(double));
+    if(nBytes && m_pFile->write(reinterpret_cast<char const*>(values), nBytes)!=nBytes) m_bError = true;
+#else
+    std::vector<quint64> buffer(CHUNKSIZE);
+    for(qint64 i0=0; i0<nValues && !m_bError; i0+=CHUNKSIZE)
+    {
+        qint64 n = std::min(qint64(CHUNKSIZE), nValues-i0);
+        for(qint64 i=0; i<n; i++)
+        {
+            quint64 u = 0;
+            std::memcpy(&u, values+i0+i, sizeof(double));
+            buffer[i] = qToLittleEndian(u);
+        }
+        qint64 nBytes = n*qint64(sizeof(double));
+        if(m_pFile->write(reinterpret_cast<char const*>(buffer.data()), nBytes)!=nBytes) m_bError = true;
+    }
+#endif
+    return !m_bError;
+}
+
+
+/**
+ * Writes the panel Cp values of the operating points as a dataset with one row per operating point.
+ * The rows of operating points with less panels than the largest one are completed with NaNs.
+ */
+bool ColumnFile::writeOppsCp(std::vector<Opp3d const*> const &opps)
+{
+    if(opps.empty()) return !m_bError;
+
+    size_t nCols = 0;
+    std::vector<double> ctrl(opps.size()), alpha(opps.size()), beta(opps.size()), qinf(opps.size());
+    for(size_t io=0; io<opps.size(); io++)
+    {
+        Opp3d const *pOpp = opps.at(io);
+        nCols = std::max(nCols, pOpp->Cp().size());
+        ctrl[io]  = pOpp->ctrl();
+        alpha[io] = pOpp->alpha();
+        beta[io]  = pOpp->beta();
+        qinf[io]  = pOpp->QInf();
+    }
+    writeColumn("opp_ctrl",  ctrl);
+    writeColumn("opp_alpha", alpha);
+    writeColumn("opp_beta",  beta);
+    writeColumn("opp_QInf",  qinf);
+
+    std::vector<double> Cp(opps.size()*nCols, std::numeric_limits<double>::quiet_NaN());
+    for(size_t io=0; io<opps.size(); io++)
+    {
+        std::vector<double> const &oppCp = opps.at(io)->Cp();
+        std::copy(oppCp.begin(), oppCp.end(), Cp.begin()+std::ptrdiff_t(io*nCols));
+    }
+    return writeDataset("Cp", Cp.data(), int(opps.size()), int(nCols));
+}
+
+
+/** Reads all the records of a file; returns false if the file is not a column file or is truncated */
+bool ColumnFile::readFile(std::string const &pathname, std::vector<Record> &records)
+{
+    records.clear();
+    QFile file(QString::fromStdString(pathname));
+    if(!file.open(QIODevice::ReadOnly)) return false;
+
+    char signature[8];
+    int format = 0;
+    if(file.read(signature, 8)!=8 || std::memcmp(signature, COLUMNSIGNATURE, 8)!=0) return false;
+    if(!readInt(file, format) || format<100001 || format>COLUMNFORMAT) return false;
+
+    while(!file.atEnd())
+    {
+        Record record;
+        int kind = -1;
+        if(!readInt(file, kind) || !readString(file, record.m_Name)) return false;
+
+        if(kind==TEXT)
+        {
+            record.m_Kind = TEXT;
+            if(!readString(file, record.m_Text)) return false;
+        }
+        else if(kind==DATASET)
+        {
+            record.m_Kind = DATASET;
+            if(!readInt(file, record.m_nRows) || !readInt(file, record.m_nCols)) return false;
+            if(record.m_nRows<0 || record.m_nCols<0) return false;
+            qint64 nValues = qint64(record.m_nRows)*qint64(record.m_nCols);
+            qint64 nBytes = nValues*qint64(sizeof(double));
+            if(nBytes>file.size()-file.pos()) return false;
+            record.m_Values.resize(size_t(nValues));
+            if(nBytes && file.read(reinterpret_cast<char*>(record.m_Values.data()), nBytes)!=nBytes) return false;
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+            for(double &value : record.m_Values)
+            {
+                quint64 u = 0;
+                std::memcpy(&u, &value, sizeof(double));
+                u = qFromLittleEndian(u);
+                std::memcpy(&value, &u, sizeof(double));
+            }
+#endif
+        }
+        else
+            return false;
+
+        records.push_back(std::move(record));
+    }
+    return true;
+}
+
+
+/** Writes the stored arrays of the polar without copying them */
+bool ColumnFile::exportPolar(std::string const &pathname, Polar const &polar)
+{
+    ColumnFile cf;
+    if(!cf.open(pathname)) return false;
+
+    cf.writeText("polar", polar.name());
+    cf.writeText("foil",  polar.foilName());
+    cf.writeText("type",  std::to_string(int(polar.type())));
+    for(PolarColumn const &column : s_PolarColumns)
+        cf.writeColumn(column.m_Name, polar.*column.m_pColumn);
+
+    return cf.close();
+}
+
+
+/** The variables of plane polars are derived from the aerodynamic forces of each point; each is evaluated into one column */
+bool ColumnFile::exportPlanePolar(std::string const &pathname, PlanePolar const &plpolar, std::vector<Opp3d const*> const &opps)
+{
+    ColumnFile cf;
+    if(!cf.open(pathname)) return false;
+
+    cf.writeText("polar", plpolar.name());
+    cf.writeText("plane", plpolar.planeName());
+
+    std::vector<double> values;
+    for(int iVar=0; iVar<PlanePolar::variableCount(); iVar++)
+    {
+        plpolar.getColumn(iVar, values);
+        cf.writeColumn(PlanePolar::variableName(iVar), values);
+    }
+
+    cf.writeOppsCp(opps);
+    return cf.close();
+}
+
+
+bool ColumnFile::exportBoatPolar(std::string const &pathname, BoatPolar const &btpolar, std::vector<Opp3d const*> const &opps)
+{
+    ColumnFile cf;
+    if(!cf.open(pathname)) return false;
+
+    cf.writeText("polar", btpolar.name());
+    cf.writeText("boat",  btpolar.boatName());
+
+    int n = btpolar.dataSize();
+    std::vector<double> values(n);
+    for(int iVar=0; iVar<BoatPolar::variableCount(); iVar++)
+    {
+        for(int i=0; i<n; i++) values[i] = btpolar.getVariable(iVar, i);
+        cf.writeColumn(BoatPolar::variableName(iVar), values);
+    }
+
+    cf.writeOppsCp(opps);
+    return cf.close();
+}
+
+
+/**
+ * Reads the columns of a file written by exportPolar() into the polar's arrays.
+ * The arrays which are not in the file are set to 0.
+ */
+bool ColumnFile::importPolar(std::string const &pathname, Polar &polar)
+{
+    std::vector<Record> records;
+    if(!readFile(pathname, records)) return false;
+
+    int n = -1;
+    for(Record const &record : records)
+    {
+        if(record.m_Kind!=DATASET || record.m_nCols!=1) continue;
+        for(PolarColumn const &column : s_PolarColumns)
+        {
+            if(record.m_Name==column.m_Name)
+            {
+                if(n>=0 && record.m_nRows!=n) return false; // inconsistent column sizes
+                n = record.m_nRows;
+            }
+        }
+    }
+    if(n<0) return false;
+
+    polar.resizeData(n);
+    for(PolarColumn const &column : s_PolarColumns)
+        std::fill((polar.*column.m_pColumn).begin(), (polar.*column.m_pColumn).end(), 0.0);
+
+    for(Record &record : records)
+    {
+        if(record.m_Kind==TEXT)
+        {
+            if     (record.m_Name=="polar") polar.setName(record.m_Text);
+            else if(record.m_Name=="foil")  polar.setFoilName(record.m_Text);
+            continue;
+        }
+        if(record.m_nCols!=1) continue;
+        for(PolarColumn const &column : s_PolarColumns)
+        {
+            if(record.m_Name==column.m_Name) polar.*column.m_pColumn = std::move(record.m_Values);
+        }
+    }
+    return true;
+}
+
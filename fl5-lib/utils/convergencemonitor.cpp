@@ -0,0 +1,108 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <algorithm>
+
+#include <convergencemonitor.h>
+
+
+StagnationMonitor::StagnationMonitor(int window, double reduction, bool bReseed)
+{
+    m_Window = std::max(1, window);
+    m_Reduction = reduction;
+    m_bReseed = bReseed;
+    m_bRecord = true;
+}
+
+
+ConvergenceMonitor::enumAction StagnationMonitor::onIteration(ResidualSample const &sample)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    History &history = m_Active[std::this_thread::get_id()];
+    if(history.m_Sample.empty() || history.m_Solver!=sample.m_Solver || history.m_Ctrl!=sample.m_Ctrl
+       || sample.m_Iter<history.m_Sample.back().m_Iter)
+    {
+        history = History();
+        history.m_Solver = sample.m_Solver;
+        history.m_Ctrl = sample.m_Ctrl;
+    }
+    history.m_Sample.push_back(sample);
+
+    int nSamples = int(history.m_Sample.size());
+    if(nSamples-history.m_iWindowStart<=m_Window) return CONTINUE;
+    ResidualSample const &first = history.m_Sample.at(nSamples-1-m_Window);
+    if(sample.m_Rms<m_Reduction*first.m_Rms) return CONTINUE;
+
+    if(m_bReseed && history.m_nReseeds==0)
+    {
+        history.m_nReseeds++;
+        history.m_iWindowStart = nSamples; // the samples before the reseed do not belong to the next window
+        return RESEED;
+    }
+    history.m_bAborted = true;
+    return ABORT;
+}
+
+
+void StagnationMonitor::onPointEnd(ResidualSample::enumSolver solver, double ctrl, bool bConverged, int)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Active.find(std::this_thread::get_id());
+    History history;
+    if(it!=m_Active.end())
+    {
+        history = it->second;
+        m_Active.erase(it);
+    }
+    history.m_Solver = solver;
+    history.m_Ctrl = ctrl;
+    history.m_bConverged = bConverged;
+    if(!m_bRecord) history.m_Sample.clear();
+    m_Done.push_back(history);
+}
+
+
+/** @return the histories of the completed points, in the order of their completion */
+std::vector<StagnationMonitor::History> StagnationMonitor::histories() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Done;
+}
+
+
+int StagnationMonitor::nAborted() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    int n = 0;
+    for(History const &history : m_Done) if(history.m_bAborted) n++;
+    return n;
+}
+
+
+void StagnationMonitor::clear()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Active.clear();
+    m_Done.clear();
+}
@@ -26,6 +26,10 @@
 
 #define _MATH_DEFINES_DEFINED
 
+#include <algorithm>
+#include <atomic>
+
+#include <QBuffer>
 #include <QCoreApplication>
 #include <QFile>
 #include <QFileInfo>
@@ -51,9 +55,31 @@
 #include <polar.h>
 #include <sailobjects.h>
 #include <splinefoil.h>
+#include <threadpool.h>
 #include <units.h>
 
 
+/**
+ * Decodes on the thread pool the field arrays of the operating points which have been loaded with deferred fields.
+ * The operating points are independent, so that the decoding scales with the number of cores.
+ */
+static bool decodePendingFields(std::vector<Opp3d*> const &opps)
+{
+    if(opps.empty()) return true;
+
+    int nTasks = std::max(1, std::min(ThreadPool::nBlocks(ThreadPool::maxThreadCount()), int(opps.size())));
+    std::atomic<bool> bOk(true);
+    ThreadPool::pool().parallelFor(nTasks, [nTasks, &opps, &bOk](int iTask)
+    {
+        for(int i=iTask; i<int(opps.size()); i+=nTasks)
+        {
+            if(!opps.at(i)->decodePendingFields()) bOk = false;
+        }
+    });
+    return bOk;
+}
+
+
 bool FileIO::s_bSaveOpps(false);
 bool FileIO::s_bSavePOpps(true);
 bool FileIO::s_bSaveBtOpps(true);
@@ -102,7 +128,7 @@ void FileIO::onLoadProject(const QString &filename)
         }
         else if(end==".fl5")
         {
-            bRead = serializeProjectFl5(ar, false);
+            bRead = loadProjectFl5(XFile);
             outputMessage("\n");
         }
 
@@ -127,6 +153,33 @@ void FileIO::onLoadProject(const QString &filename)
 }
 
 
+/**
+ * Loads a .fl5 project from a file open for reading.
+ * The file is memory-mapped if possible, so that the archive is deserialized directly from
+ * the page cache rather than through the file device's read buffer.
+ */
+bool FileIO::loadProjectFl5(QFile &XFile)
+{
+    qint64 size = XFile.size();
+    uchar *pData = size>0 ? XFile.map(0, size) : nullptr;
+    if(!pData)
+    {
+        QDataStream ar(&XFile);
+        return serializeProjectFl5(ar, false);
+    }
+
+    QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<char const*>(pData), size);
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::ReadOnly);
+    QDataStream ar(&buffer);
+    bool bRead = serializeProjectFl5(ar, false);
+    buffer.close();
+
+    XFile.unmap(pData);
+    return bRead;
+}
+
+
 bool FileIO::serializeProjectFl5(QDataStream &ar, bool bIsStoring)
 {
     int ArchiveFormat(0);
@@ -693,7 +746,9 @@ bool FileIO::serialize2dObjectsFl5(QDataStream &ar, bool bIsStoring, int Archive
 {
     int n(0), k(0);
 
-    int Archive2dFormat = 500750; // v750: added archive2dformat to serialization
+    int Archive2dFormat = 500760;
+    // 500750: added archive2dformat to serialization
+    // 500760: the foils with the same geometry as a previous foil reference its base nodes
 
     if (bIsStoring)
     {
@@ -712,15 +767,36 @@ bool FileIO::serialize2dObjectsFl5(QDataStream &ar, bool bIsStoring, int Archive
         strange = QString::asprintf("   Reading %d foils\n", n);
         outputMessage(strange);
 
+        std::vector<Foil const*> loadedFoils; // the foils of this archive, in the order of the records
         for(int i=0; i<n; i++)
         {
+            int iSource = -1;
+            if(Archive2dFormat>=500760) ar >> iSource;
+
             Foil *pFoil = new Foil();
-            if(pFoil->serializeFl5(ar, bIsStoring))
+            bool bLoaded = pFoil->serializeFl5(ar, bIsStoring);
+            if(bLoaded && iSource>=0)
+            {
+                if(iSource<int(loadedFoils.size()) && loadedFoils.at(iSource))
+                {
+                    pFoil->setBaseNodes(loadedFoils.at(iSource)->baseNodes());
+                    pFoil->initGeometry();
+                }
+                else
+                    bLoaded = false;
+            }
+
+            if(bLoaded)
             {
                 // delete any former foil with that name - necessary in the case of project insertion to avoid duplication
                 // there is a risk that old plane results are not consisent with the new foil, but difficult to avoid that
                 Foil *pOldFoil = Objects2d::foil(pFoil->name());
-                if(pOldFoil) Objects2d::deleteFoil(pOldFoil);
+                if(pOldFoil)
+                {
+                    std::replace(loadedFoils.begin(), loadedFoils.end(), static_cast<Foil const*>(pOldFoil), static_cast<Foil const*>(nullptr));
+                    Objects2d::deleteFoil(pOldFoil);
+                }
+                loadedFoils.push_back(pFoil);
                 Objects2d::appendFoil(pFoil);
                 strange = QString::asprintf("      foil %s... loaded\n", pFoil->name().c_str());
                 outputMessage(strange);
@@ -805,7 +881,7 @@ bool FileIO::storeFoilsFl5(std::vector<Foil*>const &FoilSelection, QDataStream &
 
     int nPlr0=0;
 
-    int Archive2dFormat = 500750; // v750: added archive2dformat to serialization
+    int Archive2dFormat = 500760; // v760: shared geometry references, cf. serialize2dObjectsFl5()
 
     ar <<Archive2dFormat;
 
@@ -829,12 +905,16 @@ bool FileIO::storeFoilsFl5(std::vector<Foil*>const &FoilSelection, QDataStream &
 
     outputMessage(QString::asprintf("      Saving %d foils\n", nFoils));
 
+    // store the geometry of identical foils only once
+    std::vector<int> sources = Objects2d::geometrySources(FoilList);
+
     for(uint iFoil=0; iFoil<FoilList.size(); iFoil++)
     {
         Foil *pFoil = FoilList.at(iFoil);
         if(pFoil)
         {
-            pFoil->serializeFl5(ar, bIsStoring);
+            ar << sources.at(iFoil);
+            pFoil->serializeFl5(ar, bIsStoring, sources.at(iFoil)<0);
             // count the associated polars
             for (int iplr=0; iplr<Objects2d::nPolars(); iplr++)
             {
@@ -1114,7 +1194,7 @@ bool FileIO::serialize3dObjectsFl5(QDataStream &ar, bool bIsStoring, int Archive
         for(int i=0; i<n; i++)
         {
             pPOpp = new PlaneOpp();
-            if(pPOpp->serializeFl5(ar, bIsStoring))
+            if(pPOpp->serializeFl5(ar, bIsStoring, true))
             {
                 pPlane = Objects3d::plane(pPOpp->planeName());
                 pWPolar = Objects3d::wPolar(pPlane, pPOpp->polarName());
@@ -1133,6 +1213,18 @@ bool FileIO::serialize3dObjectsFl5(QDataStream &ar, bool bIsStoring, int Archive
                 return false;
             }
         }
+
+        // decode the panel arrays of the operating points which have been kept
+        std::vector<Opp3d*> pending;
+        for(PlaneOpp *pPlaneOpp : Objects3d::planeOpps())
+        {
+            if(pPlaneOpp->hasPendingFields()) pending.push_back(pPlaneOpp);
+        }
+        if(!decodePendingFields(pending))
+        {
+            outputMessage("      error decoding the plane operating point arrays\n");
+            return false;
+        }
     }
     return true;
 }
@@ -1276,7 +1368,7 @@ bool FileIO::serializeBtObjectsFl5(QDataStream &ar, bool bIsStoring)
         for(int i=0; i<n; i++)
         {
             pBtOpp = new BoatOpp();
-            if(pBtOpp->serializeBoatOppFl5(ar, bIsStoring))
+            if(pBtOpp->serializeBoatOppFl5(ar, bIsStoring, true))
             {
                 //just append, since POpps have been sorted when first inserted
                 pBoat = SailObjects::boat(pBtOpp->boatName());
@@ -1296,6 +1388,17 @@ bool FileIO::serializeBtObjectsFl5(QDataStream &ar, bool bIsStoring)
             }
         }
 
+        std::vector<Opp3d*> pending;
+        for(BoatOpp *pBoatOpp : SailObjects::boatOpps())
+        {
+            if(pBoatOpp->hasPendingFields()) pending.push_back(pBoatOpp);
+        }
+        if(!decodePendingFields(pending))
+        {
+            outputMessage("      error decoding the boat operating point arrays\n");
+            return false;
+        }
+
         // space allocation
         ar >> nIntSpares;
         for (int i=0; i<nIntSpares; i++) ar >> n;
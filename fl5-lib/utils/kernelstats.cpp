@@ -0,0 +1,248 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include <kernelstats.h>
+
+
+std::atomic<bool> KernelStats::s_bEnabled(false);
+
+
+namespace
+{
+    struct alignas(64) ThreadBlock
+    {
+        ThreadBlock()
+        {
+            for(std::atomic<int64_t> &c : m_Count) c.store(0);
+            for(auto &h : m_Histogram) for(std::atomic<int64_t> &b : h) b.store(0);
+        }
+
+        std::array<std::atomic<int64_t>, KernelStats::NCOUNTERS> m_Count;
+        std::array<std::array<std::atomic<int64_t>, KernelStats::NBINS>, KernelStats::NHISTOGRAMS> m_Histogram;
+    };
+
+    std::mutex g_Mutex;
+    std::vector<ThreadBlock*> g_Blocks;     /**< the blocks of the running threads */
+    KernelStats::Totals g_Retired;          /**< the counts of the threads which have exited */
+
+
+    /** each block has a single writer, so that a relaxed load and store are enough and avoid the locked add */
+    inline void increment(std::atomic<int64_t> &value, int64_t n=1)
+    {
+        value.store(value.load(std::memory_order_relaxed)+n, std::memory_order_relaxed);
+    }
+
+
+    void addBlock(ThreadBlock const &block, KernelStats::Totals &totals)
+    {
+        for(int c=0; c<KernelStats::NCOUNTERS; c++)
+            totals.m_Count[c] += block.m_Count[c].load(std::memory_order_relaxed);
+        for(int h=0; h<KernelStats::NHISTOGRAMS; h++)
+            for(int b=0; b<KernelStats::NBINS; b++)
+                totals.m_Histogram[h][b] += block.m_Histogram[h][b].load(std::memory_order_relaxed);
+    }
+
+
+    struct ThreadSlot
+    {
+        ~ThreadSlot()
+        {
+            if(!m_pBlock) return;
+            std::lock_guard<std::mutex> lock(g_Mutex);
+            addBlock(*m_pBlock, g_Retired);
+            for(uint i=0; i<g_Blocks.size(); i++)
+            {
+                if(g_Blocks.at(i)==m_pBlock)
+                {
+                    g_Blocks.erase(g_Blocks.begin()+i);
+                    break;
+                }
+            }
+            delete m_pBlock;
+        }
+
+        ThreadBlock &block()
+        {
+            if(!m_pBlock)
+            {
+                m_pBlock = new ThreadBlock;
+                std::lock_guard<std::mutex> lock(g_Mutex);
+                g_Blocks.push_back(m_pBlock);
+            }
+            return *m_pBlock;
+        }
+
+        ThreadBlock *m_pBlock{nullptr};
+    };
+
+    thread_local ThreadSlot t_Slot;
+}
+
+
+bool KernelStats::isCompiled()
+{
+#ifdef FL5_KERNEL_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+void KernelStats::addCount(enumCounter c, int64_t n)
+{
+    increment(t_Slot.block().m_Count[c], n);
+}
+
+
+void KernelStats::addSample(enumHistogram h, int64_t value)
+{
+    int bin = 0;
+    while(value>0 && bin<NBINS-1)
+    {
+        value >>= 1;
+        bin++;
+    }
+    increment(t_Slot.block().m_Histogram[h][bin]);
+}
+
+
+KernelStats::Totals KernelStats::Totals::operator-(Totals const &start) const
+{
+    Totals diff = *this;
+    for(int c=0; c<NCOUNTERS; c++) diff.m_Count[c] -= start.m_Count[c];
+    for(int h=0; h<NHISTOGRAMS; h++)
+        for(int b=0; b<NBINS; b++) diff.m_Histogram[h][b] -= start.m_Histogram[h][b];
+    return diff;
+}
+
+
+/** @return the sums of the counts of all the threads since the start of the process or the last reset */
+KernelStats::Totals KernelStats::snapshot()
+{
+    std::lock_guard<std::mutex> lock(g_Mutex);
+    Totals totals = g_Retired;
+    for(ThreadBlock const *pBlock : g_Blocks) addBlock(*pBlock, totals);
+    return totals;
+}
+
+
+/** Clears the counts; should not be called while the kernels are running, since the workers' late writes may be lost or kept */
+void KernelStats::reset()
+{
+    std::lock_guard<std::mutex> lock(g_Mutex);
+    g_Retired = Totals();
+    for(ThreadBlock *pBlock : g_Blocks)
+    {
+        for(std::atomic<int64_t> &c : pBlock->m_Count) c.store(0, std::memory_order_relaxed);
+        for(auto &h : pBlock->m_Histogram) for(std::atomic<int64_t> &b : h) b.store(0, std::memory_order_relaxed);
+    }
+}
+
+
+char const *KernelStats::counterName(enumCounter c)
+{
+    switch(c)
+    {
+        case DOUBLETVELOCITYNEAR:  return "N4023 doublet velocity, near field";
+        case DOUBLETVELOCITYFAR:   return "N4023 doublet velocity, far field";
+        case DOUBLETPOTENTIALNEAR: return "N4023 doublet potential, near field";
+        case DOUBLETPOTENTIALFAR:  return "N4023 doublet potential, far field";
+        case SOURCEVELOCITYNEAR:   return "N4023 source velocity, near field";
+        case SOURCEVELOCITYFAR:    return "N4023 source velocity, far field";
+        case SOURCEPOTENTIALNEAR:  return "N4023 source potential, near field";
+        case SOURCEPOTENTIALFAR:   return "N4023 source potential, far field";
+        case INTEGRALSFAR:         return "linear/uniform kernels, far field";
+        case NFINTEGRALS:          return "Nintcheu Fata integrals";
+        case MCINTEGRALS:          return "Carley integrals";
+        case QUADRATURE:           return "Gauss quadratures";
+        case NCOUNTERS:            break;
+    }
+    return "";
+}
+
+
+char const *KernelStats::histogramName(enumHistogram h)
+{
+    switch(h)
+    {
+        case P3VELOCITYBLOCK:     return "P3Analysis::velocityVectorBlock panels";
+        case P4VELOCITYBLOCK:     return "P4Analysis::velocityVectorBlock panels";
+        case VELOCITYRANGEPOINTS: return "P3Analysis::velocityVectorRange points";
+        case NHISTOGRAMS:         break;
+    }
+    return "";
+}
+
+
+/** @return the counts and the non-empty histograms as text, for the task logs */
+std::string KernelStats::report(Totals const &totals)
+{
+    std::ostringstream out;
+    char line[256];
+
+    out << "   Panel kernel statistics\n";
+    for(int c=0; c<NCOUNTERS; c++)
+    {
+        if(!totals.m_Count[c]) continue;
+        snprintf(line, sizeof(line), "      %-42s %14lld\n", counterName(enumCounter(c)), static_cast<long long>(totals.m_Count[c]));
+        out << line;
+    }
+
+    // the far field fractions of the N4023 kernels, which depend on Panel::RFF()
+    for(int c=DOUBLETVELOCITYNEAR; c<INTEGRALSFAR; c+=2)
+    {
+        int64_t n = totals.m_Count[c]+totals.m_Count[c+1];
+        if(!n) continue;
+        std::string name = counterName(enumCounter(c));
+        name = name.substr(0, name.find(','));
+        snprintf(line, sizeof(line), "      %-42s %13.1f%% far field\n", name.c_str(), double(totals.m_Count[c+1])/double(n)*100.0);
+        out << line;
+    }
+
+    for(int h=0; h<NHISTOGRAMS; h++)
+    {
+        int64_t n = 0;
+        for(int64_t count : totals.m_Histogram[h]) n += count;
+        if(!n) continue;
+
+        out << "      " << histogramName(enumHistogram(h)) << ":\n";
+        for(int b=0; b<NBINS; b++)
+        {
+            if(!totals.m_Histogram[h][b]) continue;
+            long long lo = b==0 ? 0 : 1LL<<(b-1);
+            long long hi = b==0 ? 1 : 1LL<<b;
+            if(b==NBINS-1) snprintf(line, sizeof(line), "         >=%-18lld", lo);
+            else           snprintf(line, sizeof(line), "         [%lld, %lld[%*s", lo, hi, 1, "");
+            out << line;
+            snprintf(line, sizeof(line), " %14lld %6.1f%%\n", static_cast<long long>(totals.m_Histogram[h][b]), double(totals.m_Histogram[h][b])/double(n)*100.0);
+            out << line;
+        }
+    }
+    return out.str();
+}
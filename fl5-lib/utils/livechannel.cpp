@@ -0,0 +1,138 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+
+#include <livechannel.h>
+
+
+LiveChannel::LiveChannel(int capacity)
+{
+    size_t n = 2;
+    while(n<size_t(std::max(capacity, 2))) n *= 2;
+    m_Ring.resize(n);
+    m_Mask = n-1;
+
+    m_Head = 0;
+    m_Tail = 0;
+    m_bWakePending = false;
+    m_nDropped = 0;
+}
+
+
+bool LiveChannel::push(LiveFrame &&frame)
+{
+    size_t head = m_Head.load(std::memory_order_relaxed);
+    if(head-m_Tail.load(std::memory_order_acquire)>m_Mask)
+    {
+        m_nDropped++;
+        return false;
+    }
+    m_Ring[head & m_Mask] = std::move(frame);
+    m_Head.store(head+1, std::memory_order_release);
+    return true;
+}
+
+
+/** Publishes a copy of the wake, unless the previous snapshot has not been taken yet */
+bool LiveChannel::publishWake(double ctrl, std::vector<std::vector<Vorton>> const &vortons)
+{
+    if(m_bWakePending.load(std::memory_order_acquire)) return false;
+
+    LiveFrame frame;
+    frame.m_Type = LiveFrame::WAKE;
+    frame.m_Ctrl = ctrl;
+    frame.m_pVortons = std::make_shared<std::vector<std::vector<Vorton>> const>(vortons);
+
+    m_bWakePending.store(true, std::memory_order_release);
+    if(push(std::move(frame))) return true;
+    m_bWakePending.store(false, std::memory_order_release);
+    return false;
+}
+
+
+bool LiveChannel::publishResidual(double ctrl, int iter, double value)
+{
+    LiveFrame frame;
+    frame.m_Type  = LiveFrame::RESIDUAL;
+    frame.m_Ctrl  = ctrl;
+    frame.m_Iter  = iter;
+    frame.m_Value = value;
+    return push(std::move(frame));
+}
+
+
+bool LiveChannel::publishPlaneOpp(PlaneOpp const *pPOpp)
+{
+    if(!pPOpp) return false;
+    LiveFrame frame;
+    frame.m_Type = LiveFrame::PLANEOPP;
+    frame.m_pPlaneOpp = pPOpp;
+    return push(std::move(frame));
+}
+
+
+bool LiveChannel::publishBoatOpp(BoatOpp const *pBtOpp)
+{
+    if(!pBtOpp) return false;
+    LiveFrame frame;
+    frame.m_Type = LiveFrame::BOATOPP;
+    frame.m_pBoatOpp = pBtOpp;
+    return push(std::move(frame));
+}
+
+
+bool LiveChannel::publishOpPoint(OpPoint const *pOpp)
+{
+    if(!pOpp) return false;
+    LiveFrame frame;
+    frame.m_Type = LiveFrame::OPPOINT;
+    frame.m_pOpPoint = pOpp;
+    return push(std::move(frame));
+}
+
+
+/** Moves the oldest frame out of the channel; returns false if the channel is empty */
+bool LiveChannel::pop(LiveFrame &frame)
+{
+    size_t tail = m_Tail.load(std::memory_order_relaxed);
+    if(tail==m_Head.load(std::memory_order_acquire)) return false;
+
+    frame = std::move(m_Ring[tail & m_Mask]);
+    m_Ring[tail & m_Mask] = LiveFrame(); // release the snapshot now rather than when the slot is reused
+    m_Tail.store(tail+1, std::memory_order_release);
+
+    if(frame.m_Type==LiveFrame::WAKE) m_bWakePending.store(false, std::memory_order_release);
+    return true;
+}
+
+
+/** Discards the unread frames; consumer side */
+void LiveChannel::clear()
+{
+    LiveFrame frame;
+    while(pop(frame)) {}
+}
+
@@ -0,0 +1,154 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+
+#if defined WIN_OS
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+#include <mappedstorage.h>
+
+
+std::unordered_map<void*, size_t> MappedStorage::s_Mapped;
+std::mutex MappedStorage::s_Mutex;
+bool MappedStorage::s_bEnabled(false);
+std::string MappedStorage::s_ScratchDir;
+double MappedStorage::s_Threshold(64.0);
+
+
+void *MappedStorage::allocate(size_t nBytes)
+{
+    if(nBytes==0) nBytes = 1;
+
+    if(s_bEnabled && double(nBytes)>s_Threshold*1024.0*1024.0)
+    {
+        void *p = mapScratchFile(nBytes);
+        if(p)
+        {
+            std::lock_guard<std::mutex> lock(s_Mutex);
+            s_Mapped[p] = nBytes;
+            return p;
+        }
+        // fall back on the heap if the file could not be created
+    }
+    return std::malloc(nBytes);
+}
+
+
+void MappedStorage::deallocate(void *p)
+{
+    if(!p) return;
+
+    size_t nBytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        auto it = s_Mapped.find(p);
+        if(it!=s_Mapped.end())
+        {
+            nBytes = it->second;
+            s_Mapped.erase(it);
+        }
+    }
+
+    if(nBytes>0) unmap(p, nBytes);
+    else         std::free(p);
+}
+
+
+/** @return true if the array was mapped to a scratch file */
+bool MappedStorage::isMapped(void const *p)
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    return s_Mapped.find(const_cast<void*>(p))!=s_Mapped.end();
+}
+
+
+void *MappedStorage::mapScratchFile(size_t nBytes)
+{
+    static std::atomic<int> s_Counter(0);
+
+    std::error_code ec;
+    std::filesystem::path dir = s_ScratchDir.empty() ? std::filesystem::temp_directory_path(ec) : std::filesystem::path(s_ScratchDir);
+    if(ec) return nullptr;
+
+    std::string filename = "fl5_matrix_" + std::to_string(s_Counter.fetch_add(1)) + "_";
+
+#if defined WIN_OS
+    filename += std::to_string(GetCurrentProcessId()) + ".tmp";
+    std::string path = (dir/filename).string();
+
+    HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ|GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                               FILE_ATTRIBUTE_TEMPORARY|FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if(hFile==INVALID_HANDLE_VALUE) return nullptr;
+
+    unsigned long long sz = nBytes;
+    HANDLE hMap = CreateFileMappingA(hFile, nullptr, PAGE_READWRITE, DWORD(sz>>32), DWORD(sz&0xffffffff), nullptr);
+    void *p = nullptr;
+    if(hMap)
+    {
+        p = MapViewOfFile(hMap, FILE_MAP_ALL_ACCESS, 0, 0, nBytes);
+        CloseHandle(hMap); // the view keeps the mapping alive
+    }
+    CloseHandle(hFile);    // the file is deleted when the view is closed
+    return p;
+#else
+    filename += std::to_string(getpid()) + ".tmp";
+    std::string path = (dir/filename).string();
+
+    int fd = open(path.c_str(), O_RDWR|O_CREAT|O_EXCL, 0600);
+    if(fd<0) return nullptr;
+    unlink(path.c_str()); // the file is deleted when the mapping is released
+
+    if(ftruncate(fd, off_t(nBytes))!=0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    void *p = mmap(nullptr, nBytes, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(p==MAP_FAILED) return nullptr;
+    return p;
+#endif
+}
+
+
+void MappedStorage::unmap(void *p, size_t nBytes)
+{
+#if defined WIN_OS
+    (void)nBytes;
+    UnmapViewOfFile(p);
+#else
+    munmap(p, nBytes);
+#endif
+}
+
@@ -0,0 +1,73 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <QString>
+
+#include <memorybudget.h>
+
+
+double MemoryBudget::s_Budget = 0.0;
+std::atomic<size_t> MemoryBudget::s_Reserved(0);
+
+
+/** Returns true if nBytes can be reserved in addition to the current reservations */
+bool MemoryBudget::fits(size_t nBytes)
+{
+    if(!isLimited()) return true;
+    return double(s_Reserved.load()) + double(nBytes) <= s_Budget*1024.0*1024.0;
+}
+
+
+/**
+ * Reserves nBytes against the budget; the reservations of concurrent analyses are accumulated.
+ * @return false if the reservation would exceed the budget, in which case nothing is reserved.
+ */
+bool MemoryBudget::reserve(size_t nBytes)
+{
+    size_t current = s_Reserved.load();
+    do
+    {
+        if(isLimited() && double(current)+double(nBytes) > s_Budget*1024.0*1024.0) return false;
+    }
+    while(!s_Reserved.compare_exchange_weak(current, current+nBytes));
+    return true;
+}
+
+
+void MemoryBudget::release(size_t nBytes)
+{
+    size_t current = s_Reserved.load();
+    while(!s_Reserved.compare_exchange_weak(current, current>nBytes ? current-nBytes : 0)) {}
+}
+
+
+std::string MemoryBudget::sizeString(size_t nBytes)
+{
+    double b = double(nBytes);
+    if(b<1024.0)                return QString::asprintf("%.0f B",  b).toStdString();
+    if(b<1024.0*1024.0)         return QString::asprintf("%.1f kB", b/1024.0).toStdString();
+    if(b<1024.0*1024.0*1024.0)  return QString::asprintf("%.1f MB", b/1024.0/1024.0).toStdString();
+    return QString::asprintf("%.2f GB", b/1024.0/1024.0/1024.0).toStdString();
+}
@@ -0,0 +1,156 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+#include <numa.h>
+
+
+std::vector<std::vector<int>> Numa::s_NodeCpus;
+
+namespace
+{
+    thread_local int t_Node = -1;
+    std::once_flag s_TopologyFlag;
+}
+
+
+int Numa::nNodes()
+{
+    std::call_once(s_TopologyFlag, &Numa::readTopology);
+    return int(s_NodeCpus.size());
+}
+
+
+std::vector<int> const &Numa::nodeCpus(int node)
+{
+    std::call_once(s_TopologyFlag, &Numa::readTopology);
+    return s_NodeCpus.at(node);
+}
+
+
+/** Parses a list of cpus in the kernel's format, e.g. "0-7,16-23" */
+std::vector<int> Numa::parseCpuList(char const *list)
+{
+    std::vector<int> cpus;
+    char const *p = list;
+    while(*p)
+    {
+        char *end = nullptr;
+        long first = std::strtol(p, &end, 10);
+        if(end==p) break;
+        long last = first;
+        p = end;
+        if(*p=='-')
+        {
+            last = std::strtol(p+1, &end, 10);
+            p = end;
+        }
+        for(long cpu=first; cpu<=last; cpu++) cpus.push_back(int(cpu));
+        while(*p==',' || *p=='\n' || *p==' ') p++;
+    }
+    return cpus;
+}
+
+
+/** Reads the cpus of each online node; the host is a single node if the topology is not available */
+void Numa::readTopology()
+{
+    s_NodeCpus.clear();
+
+#ifdef Q_OS_LINUX
+    for(int node=0; node<1024; node++)
+    {
+        char path[128];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        FILE *fp = fopen(path, "r");
+        if(!fp) break;
+        char list[4096] = {0};
+        bool bRead = fgets(list, sizeof(list), fp)!=nullptr;
+        fclose(fp);
+        if(!bRead) break;
+        std::vector<int> cpus = parseCpuList(list);
+        if(!cpus.empty()) s_NodeCpus.push_back(cpus);
+    }
+#endif
+
+    if(s_NodeCpus.empty())
+    {
+        std::vector<int> cpus;
+        for(int i=0; i<int(std::thread::hardware_concurrency()); i++) cpus.push_back(i);
+        s_NodeCpus.push_back(cpus);
+    }
+}
+
+
+/**
+ * Restricts the calling thread to the cpus of the node.
+ * @return true if the thread has been pinned; always false on the platforms other than Linux.
+ */
+bool Numa::pinCurrentThread(int node)
+{
+    if(node<0 || node>=nNodes()) return false;
+
+#ifdef Q_OS_LINUX
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(int cpu : s_NodeCpus.at(node)) CPU_SET(cpu, &set);
+    if(pthread_setaffinity_np(pthread_self(), sizeof(set), &set)!=0) return false;
+    t_Node = node;
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+void Numa::unpinCurrentThread()
+{
+    if(t_Node<0) return;
+
+#ifdef Q_OS_LINUX
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(std::vector<int> const &cpus : s_NodeCpus)
+        for(int cpu : cpus) CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+    t_Node = -1;
+}
+
+
+int Numa::currentThreadNode()
+{
+    return t_Node;
+}
@@ -0,0 +1,209 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <QDataStream>
+#include <QFile>
+
+#include <resultsink.h>
+
+#include <boatopp.h>
+#include <oppoint.h>
+#include <planeopp.h>
+
+
+namespace
+{
+    int const RESULTSMAGIC  = 0x464c3552; // "FL5R"
+    int const RESULTSFORMAT = 100001;     // first results file format
+
+    void setStreamFormat(QDataStream &ar)
+    {
+        ar.setVersion(QDataStream::Qt_4_5);
+        ar.setByteOrder(QDataStream::LittleEndian);
+    }
+}
+
+
+FileResultSink::FileResultSink()
+{
+    m_pFile = nullptr;
+    m_nRecords = 0;
+}
+
+
+FileResultSink::~FileResultSink()
+{
+    close();
+}
+
+
+/**
+ * Opens the results file and writes its header.
+ * @param bAppend if true and the file exists, the records are appended to the existing ones.
+ */
+bool FileResultSink::open(std::string const &pathname, bool bAppend)
+{
+    close();
+
+    QFile *pFile = new QFile(QString::fromStdString(pathname));
+    QIODevice::OpenMode mode = bAppend ? QIODevice::WriteOnly|QIODevice::Append : QIODevice::WriteOnly|QIODevice::Truncate;
+    if(!pFile->open(mode))
+    {
+        delete pFile;
+        return false;
+    }
+
+    if(pFile->size()==0)
+    {
+        QDataStream ar(pFile);
+        setStreamFormat(ar);
+        ar << RESULTSMAGIC << RESULTSFORMAT;
+        pFile->flush();
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_pFile = pFile;
+    m_PathName = pathname;
+    m_nRecords = 0;
+    return true;
+}
+
+
+void FileResultSink::close()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(m_pFile)
+    {
+        m_pFile->close();
+        delete m_pFile;
+        m_pFile = nullptr;
+    }
+}
+
+
+void FileResultSink::addPlaneOpp(PlaneOpp *pPOpp)
+{
+    if(!pPOpp || !isOpen()) return;
+    QByteArray data;
+    QDataStream ar(&data, QIODevice::WriteOnly);
+    setStreamFormat(ar);
+    pPOpp->serializeFl5(ar, true);
+    writeRecord(PLANEOPP, data);
+}
+
+
+void FileResultSink::addBoatOpp(BoatOpp *pBtOpp)
+{
+    if(!pBtOpp || !isOpen()) return;
+    QByteArray data;
+    QDataStream ar(&data, QIODevice::WriteOnly);
+    setStreamFormat(ar);
+    pBtOpp->serializeBoatOppFl5(ar, true);
+    writeRecord(BOATOPP, data);
+}
+
+
+void FileResultSink::addOpPoint(OpPoint *pOpp)
+{
+    if(!pOpp || !isOpen()) return;
+    QByteArray data;
+    QDataStream ar(&data, QIODevice::WriteOnly);
+    setStreamFormat(ar);
+    pOpp->serializeOppFl5(ar, true);
+    writeRecord(OPPOINT, data);
+}
+
+
+/** The operating points are serialized by the calling task, only the write to the file is serialized */
+void FileResultSink::writeRecord(enumRecord type, QByteArray const &data)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(!m_pFile) return;
+
+    QDataStream ar(m_pFile);
+    setStreamFormat(ar);
+    ar << int(type) << data;
+    m_pFile->flush();
+    m_nRecords++;
+}
+
+
+/**
+ * Reads the operating points stored in a results file; the objects are created on the heap and ownership
+ * is transferred to the caller.
+ * @return false if the file could not be opened or is not a results file.
+ */
+bool FileResultSink::readResults(std::string const &pathname,
+                                 std::vector<PlaneOpp*> &planeopps, std::vector<BoatOpp*> &boatopps, std::vector<OpPoint*> &oppoints)
+{
+    QFile file(QString::fromStdString(pathname));
+    if(!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream ar(&file);
+    setStreamFormat(ar);
+
+    int magic(0), format(0);
+    ar >> magic >> format;
+    if(magic!=RESULTSMAGIC || format<100001 || format>RESULTSFORMAT) return false;
+
+    while(!ar.atEnd())
+    {
+        int type(-1);
+        QByteArray data;
+        ar >> type >> data;
+        if(ar.status()!=QDataStream::Ok) break; // the record was truncated by an interrupted run
+
+        QDataStream record(data);
+        setStreamFormat(record);
+        switch(type)
+        {
+            case PLANEOPP:
+            {
+                PlaneOpp *pPOpp = new PlaneOpp;
+                if(pPOpp->serializeFl5(record, false)) planeopps.push_back(pPOpp);
+                else delete pPOpp;
+                break;
+            }
+            case BOATOPP:
+            {
+                BoatOpp *pBtOpp = new BoatOpp;
+                if(pBtOpp->serializeBoatOppFl5(record, false)) boatopps.push_back(pBtOpp);
+                else delete pBtOpp;
+                break;
+            }
+            case OPPOINT:
+            {
+                OpPoint *pOpp = new OpPoint;
+                if(pOpp->serializeOppFl5(record, false)) oppoints.push_back(pOpp);
+                else delete pOpp;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
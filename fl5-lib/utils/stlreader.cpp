@@ -0,0 +1,505 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+#include <QFile>
+#include <QtEndian>
+
+#include <stlreader.h>
+
+#include <constants.h>
+#include <threadpool.h>
+
+
+namespace
+{
+    /** the minimal size of a text file above which it is parsed in parallel blocks */
+    size_t const PARALLELTEXTSIZE = 1<<20;
+
+    bool isBlank(char c) {return c==' ' || c=='\t' || c=='\r' || c=='\f' || c=='\v';}
+
+    void skipBlanks(char const *&p, char const *end)
+    {
+        while(p<end && isBlank(*p)) p++;
+    }
+
+    /** Returns true if the next word is the lower-case keyword, ignoring case, and advances past it */
+    bool readKeyword(char const *&p, char const *end, char const *keyword)
+    {
+        skipBlanks(p, end);
+        char const *q = p;
+        for(; *keyword; keyword++, q++)
+        {
+            if(q>=end || std::tolower(static_cast<unsigned char>(*q))!=*keyword) return false;
+        }
+        if(q<end && !isBlank(*q)) return false;
+        p = q;
+        return true;
+    }
+
+    /**
+     * Reads a floating point number and advances past it.
+     * Unlike strtod(), this does not depend on the locale and does not require a null-terminated string.
+     */
+    bool readNumber(char const *&p, char const *end, double &value)
+    {
+        skipBlanks(p, end);
+        char const *q = p;
+
+        bool bNeg = false;
+        if(q<end && (*q=='-' || *q=='+'))
+        {
+            bNeg = *q=='-';
+            q++;
+        }
+
+        unsigned long long mantissa = 0;
+        int nDigits = 0, exponent = 0;
+        bool bDigits = false;
+        for(; q<end && std::isdigit(static_cast<unsigned char>(*q)); q++)
+        {
+            bDigits = true;
+            if(nDigits<19) {mantissa = mantissa*10 + (*q-'0'); if(mantissa) nDigits++;}
+            else exponent++;
+        }
+        if(q<end && *q=='.')
+        {
+            q++;
+            for(; q<end && std::isdigit(static_cast<unsigned char>(*q)); q++)
+            {
+                bDigits = true;
+                if(nDigits<19) {mantissa = mantissa*10 + (*q-'0'); if(mantissa) nDigits++; exponent--;}
+            }
+        }
+        if(!bDigits) return false;
+
+        if(q<end && (*q=='e' || *q=='E'))
+        {
+            char const *e = q+1;
+            bool bNegExp = false;
+            if(e<end && (*e=='-' || *e=='+'))
+            {
+                bNegExp = *e=='-';
+                e++;
+            }
+            if(e<end && std::isdigit(static_cast<unsigned char>(*e)))
+            {
+                int exp10 = 0;
+                for(; e<end && std::isdigit(static_cast<unsigned char>(*e)); e++)
+                    exp10 = std::min(exp10*10 + (*e-'0'), 9999);
+                exponent += bNegExp ? -exp10 : exp10;
+                q = e;
+            }
+        }
+
+        if(q<end && !isBlank(*q)) return false;
+
+        value = double(mantissa);
+        if(exponent>0)      value *= std::pow(10.0, exponent);
+        else if(exponent<0) value /= std::pow(10.0, -exponent);
+        if(bNeg) value = -value;
+
+        p = q;
+        return true;
+    }
+
+    char const *nextLine(char const *p, char const *end)
+    {
+        p = static_cast<char const*>(std::memchr(p, '\n', size_t(end-p)));
+        return p ? p+1 : end;
+    }
+
+    char const *lineEnd(char const *p, char const *end)
+    {
+        char const *q = static_cast<char const*>(std::memchr(p, '\n', size_t(end-p)));
+        return q ? q : end;
+    }
+
+    /** The facets read from a part of a text file */
+    struct TextBlock
+    {
+        std::vector<double> m_Facets;
+        char const *m_pError{nullptr};  /**< the position of the line where the parsing failed, if any */
+        std::string m_Error;
+        bool m_bEnd{false};             /**< true if the block contains the endsolid keyword */
+    };
+
+    /** Parses the facets in [begin, end[, which must start on a facet boundary */
+    void parseTextBlock(char const *begin, char const *end, TextBlock &block)
+    {
+        enum {FACET, OUTERLOOP, VERTEX, ENDLOOP, ENDFACET} state = FACET;
+        double rec[12];
+        int iv = 0;
+
+        for(char const *line=begin; line<end; line=nextLine(line, end))
+        {
+            char const *le = lineEnd(line, end);
+            char const *p = line;
+            skipBlanks(p, le);
+            if(p>=le) continue;
+
+            bool bOk = false;
+            switch(state)
+            {
+                case FACET:
+                {
+                    if(readKeyword(p, le, "endsolid"))
+                    {
+                        block.m_bEnd = true;
+                        return;
+                    }
+                    if(!readKeyword(p, le, "facet") || !readKeyword(p, le, "normal"))
+                    {
+                        block.m_Error = "keyword 'facet normal' not found";
+                        break;
+                    }
+                    bOk = readNumber(p, le, rec[0]) && readNumber(p, le, rec[1]) && readNumber(p, le, rec[2]);
+                    if(!bOk) block.m_Error = "could not read the 3 components of the normal";
+                    state = OUTERLOOP;
+                    break;
+                }
+                case OUTERLOOP:
+                {
+                    bOk = readKeyword(p, le, "outer") && readKeyword(p, le, "loop");
+                    if(!bOk) block.m_Error = "keyword 'outer loop' not found";
+                    state = VERTEX;
+                    iv = 0;
+                    break;
+                }
+                case VERTEX:
+                {
+                    if(!readKeyword(p, le, "vertex"))
+                    {
+                        block.m_Error = "keyword 'vertex' not found";
+                        break;
+                    }
+                    bOk = readNumber(p, le, rec[3+3*iv]) && readNumber(p, le, rec[4+3*iv]) && readNumber(p, le, rec[5+3*iv]);
+                    if(!bOk) block.m_Error = "could not read 3 values";
+                    iv++;
+                    if(iv==3) state = ENDLOOP;
+                    break;
+                }
+                case ENDLOOP:
+                {
+                    bOk = readKeyword(p, le, "endloop");
+                    if(!bOk) block.m_Error = "keyword 'endloop' not found";
+                    state = ENDFACET;
+                    break;
+                }
+                case ENDFACET:
+                {
+                    bOk = readKeyword(p, le, "endfacet");
+                    if(!bOk) block.m_Error = "keyword 'endfacet' not found";
+                    block.m_Facets.insert(block.m_Facets.end(), rec, rec+12);
+                    state = FACET;
+                    break;
+                }
+            }
+
+            if(!bOk)
+            {
+                block.m_pError = line;
+                return;
+            }
+        }
+
+        if(state!=FACET)
+        {
+            block.m_pError = end;
+            block.m_Error = "unexpected end of file";
+        }
+    }
+
+    /** Returns the start of the first line at or after p which begins a facet or ends the solid */
+    char const *facetBoundary(char const *p, char const *end)
+    {
+        for(; p<end; p=nextLine(p, end))
+        {
+            char const *le = lineEnd(p, end);
+            char const *q = p;
+            if(readKeyword(q, le, "facet") || readKeyword(q, le, "endsolid")) return p;
+        }
+        return end;
+    }
+}
+
+
+StlReader::StlReader()
+{
+    m_bText = false;
+    m_nInverted = 0;
+    m_bCancel = false;
+}
+
+
+/**
+ * Tests the first two lines of the data: a text file starts with the keyword "solid", followed
+ * by a facet; some binary files also use the keyword "solid" in their header.
+ */
+bool StlReader::isTextFormat(char const *data, size_t size)
+{
+    char const *end = data + std::min(size, size_t(80));
+    char const *le = lineEnd(data, end);
+    std::string first(data, size_t(le-data));
+    if(first.find("solid")==std::string::npos) return false;
+
+    end = data+size;
+    char const *line = nextLine(data, end);
+    le = lineEnd(line, end);
+    std::string second(line, size_t(le-line));
+    std::transform(second.begin(), second.end(), second.begin(), [](unsigned char c){return char(std::tolower(c));});
+    return second.find("facet")!=std::string::npos;
+}
+
+
+/**
+ * Reads the triangles of the file.
+ * @param unitfactor the factor which converts the file's length unit to meters.
+ * @return false if the file could not be read or if the reading was cancelled; the reason is in the log.
+ */
+bool StlReader::readFile(std::string const &pathname, double unitfactor, std::vector<Triangle3d> &triangles)
+{
+    m_Log.clear();
+    m_SolidName.clear();
+    m_nInverted = 0;
+    m_bCancel = false;
+    triangles.clear();
+
+    QFile file(QString::fromStdString(pathname));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        m_Log = "Unable to open the file: " + pathname + "\n";
+        return false;
+    }
+
+    qint64 size = file.size();
+    uchar *pData = size>0 ? file.map(0, size) : nullptr;
+    QByteArray bytes;
+    char const *data = reinterpret_cast<char const*>(pData);
+    if(!pData)
+    {
+        // fall back on a copy if the file cannot be mapped
+        bytes = file.readAll();
+        data = bytes.constData();
+        size = bytes.size();
+    }
+
+    std::vector<double> facets;
+    m_bText = isTextFormat(data, size_t(size));
+    bool bRead = m_bText ? readText(data, size_t(size), facets) : readBinary(data, size_t(size), facets);
+
+    if(pData) file.unmap(pData);
+    file.close();
+
+    if(!bRead || m_bCancel) return false;
+
+    makeTriangles(facets, unitfactor, triangles);
+    return !m_bCancel;
+}
+
+
+/** Decodes the 50 byte records of the binary file, which store the normal and the vertices as 12 little-endian floats */
+bool StlReader::readBinary(char const *data, size_t size, std::vector<double> &facets)
+{
+    m_SolidName = "STL_binary_solid";
+    if(size<84)
+    {
+        m_Log = "Error reading the binary file header\n";
+        return false;
+    }
+
+    size_t nTriangles = qFromLittleEndian<quint32>(data+80);
+    size_t nRecords = (size-84)/50;
+    if(nRecords<nTriangles)
+    {
+        m_Log += "The file is truncated: read " + std::to_string(nRecords) + " of " + std::to_string(nTriangles) + " triangles\n";
+        nTriangles = nRecords;
+    }
+
+    facets.resize(12*nTriangles);
+
+    int nBlocks = std::min(ThreadPool::nBlocks(ThreadPool::maxThreadCount()), std::max(1, int(nTriangles/1000)));
+    ThreadPool::pool().parallelFor(nBlocks, [&](int iBlock)
+    {
+        if(m_bCancel) return;
+        size_t i0 = nTriangles* size_t(iBlock)    / size_t(nBlocks);
+        size_t i1 = nTriangles*(size_t(iBlock)+1) / size_t(nBlocks);
+        for(size_t i=i0; i<i1; i++)
+        {
+            char const *p = data + 84 + 50*i;
+            double *f = facets.data() + 12*i;
+            for(int k=0; k<12; k++)
+            {
+                quint32 u = qFromLittleEndian<quint32>(p+4*k);
+                float x = 0;
+                std::memcpy(&x, &u, sizeof(float));
+                f[k] = double(x);
+            }
+        }
+    });
+
+    return true;
+}
+
+
+/** Parses the text file; the facets are read in blocks in parallel and the blocks are then merged in order */
+bool StlReader::readText(char const *data, size_t size, std::vector<double> &facets)
+{
+    char const *end = data+size;
+
+    // the header is the first non-empty line
+    char const *line = data;
+    char const *le = line;
+    char const *p = line;
+    for(; line<end; line=nextLine(line, end))
+    {
+        le = lineEnd(line, end);
+        p = line;
+        skipBlanks(p, le);
+        if(p<le) break;
+    }
+
+    std::string header(p, size_t(le-p));
+    std::string lowerheader(header);
+    std::transform(lowerheader.begin(), lowerheader.end(), lowerheader.begin(), [](unsigned char c){return char(std::tolower(c));});
+    size_t pos = lowerheader.find("solid");
+    if(pos==std::string::npos)
+    {
+        m_Log = "Error reading header: keyword 'solid' not found\n";
+        return false;
+    }
+    m_SolidName = header.erase(pos, 5);
+    m_SolidName.erase(0, m_SolidName.find_first_not_of(" \t\r"));
+    m_SolidName.erase(m_SolidName.find_last_not_of(" \t\r")+1);
+
+    char const *begin = nextLine(line, end);
+
+    int nBlocks = size<PARALLELTEXTSIZE ? 1 : ThreadPool::nBlocks(ThreadPool::maxThreadCount());
+    std::vector<char const*> bounds(nBlocks+1, end);
+    bounds[0] = begin;
+    for(int ib=1; ib<nBlocks; ib++)
+    {
+        char const *start = begin + size_t(end-begin)*size_t(ib)/size_t(nBlocks);
+        start = std::max(start, bounds[ib-1]);
+        if(start>begin && start<end && *(start-1)!='\n') start = nextLine(start, end);
+        bounds[ib] = facetBoundary(start, end);
+    }
+
+    std::vector<TextBlock> blocks(nBlocks);
+    ThreadPool::pool().parallelFor(nBlocks, [&](int ib)
+    {
+        if(m_bCancel) return;
+        parseTextBlock(bounds[ib], bounds[ib+1], blocks[ib]);
+    });
+    if(m_bCancel) return false;
+
+    size_t nValues = 0;
+    for(TextBlock const &block : blocks)
+    {
+        if(block.m_pError)
+        {
+            int iLine = 1 + int(std::count(data, block.m_pError, '\n'));
+            m_Log = "Error reading triangles: " + block.m_Error + " on line " + std::to_string(iLine) + "\n";
+            return false;
+        }
+        nValues += block.m_Facets.size();
+        if(block.m_bEnd) break; // ignore the next solids, if any
+    }
+
+    facets.reserve(nValues);
+    for(TextBlock const &block : blocks)
+    {
+        facets.insert(facets.end(), block.m_Facets.begin(), block.m_Facets.end());
+        if(block.m_bEnd) break;
+    }
+
+    return true;
+}
+
+
+/** Builds the triangles from the facets in parallel blocks, and reduces the bounding box and the count of inverted facets */
+void StlReader::makeTriangles(std::vector<double> const &facets, double unitfactor, std::vector<Triangle3d> &triangles)
+{
+    int nTriangles = int(facets.size()/12);
+    triangles.resize(nTriangles);
+
+    int nBlocks = std::min(ThreadPool::nBlocks(ThreadPool::maxThreadCount()), std::max(1, nTriangles/1000));
+    std::vector<Vector3d> boxmin(nBlocks, Vector3d( LARGEVALUE,  LARGEVALUE,  LARGEVALUE));
+    std::vector<Vector3d> boxmax(nBlocks, Vector3d(-LARGEVALUE, -LARGEVALUE, -LARGEVALUE));
+    std::vector<int> ninverted(nBlocks, 0);
+
+    ThreadPool::pool().parallelFor(nBlocks, [&](int iBlock)
+    {
+        if(m_bCancel) return;
+        int i0 = int(qint64(nTriangles)* iBlock   /nBlocks);
+        int i1 = int(qint64(nTriangles)*(iBlock+1)/nBlocks);
+        Vector3d &bmin = boxmin[iBlock];
+        Vector3d &bmax = boxmax[iBlock];
+        for(int i=i0; i<i1; i++)
+        {
+            double const *f = facets.data() + 12*i;
+            Triangle3d &t3d = triangles[i];
+            for(int iv=0; iv<3; iv++)
+            {
+                double x = f[3+3*iv]*unitfactor;
+                double y = f[4+3*iv]*unitfactor;
+                double z = f[5+3*iv]*unitfactor;
+                bmin.x = std::min(x, bmin.x);   bmax.x = std::max(x, bmax.x);
+                bmin.y = std::min(y, bmin.y);   bmax.y = std::max(y, bmax.y);
+                bmin.z = std::min(z, bmin.z);   bmax.z = std::max(z, bmax.z);
+                t3d.setVertex(iv, x, y, z);
+            }
+            t3d.setTriangle();
+
+            Vector3d N(f[0], f[1], f[2]);
+            if(t3d.normal().dot(N)<0.0)
+            {
+                // re-order vertices to have a positive oriented triangle
+                Vector3d tmp = t3d.vertexAt(1);
+                t3d.setVertex(1, t3d.vertexAt(2));
+                t3d.setVertex(2, tmp);
+                t3d.setTriangle();
+                ninverted[iBlock]++;
+            }
+            t3d.setNormal(N);
+        }
+    });
+
+    m_BoxMin.set( LARGEVALUE,  LARGEVALUE,  LARGEVALUE);
+    m_BoxMax.set(-LARGEVALUE, -LARGEVALUE, -LARGEVALUE);
+    m_nInverted = 0;
+    for(int ib=0; ib<nBlocks; ib++)
+    {
+        m_BoxMin.x = std::min(m_BoxMin.x, boxmin[ib].x);   m_BoxMax.x = std::max(m_BoxMax.x, boxmax[ib].x);
+        m_BoxMin.y = std::min(m_BoxMin.y, boxmin[ib].y);   m_BoxMax.y = std::max(m_BoxMax.y, boxmax[ib].y);
+        m_BoxMin.z = std::min(m_BoxMin.z, boxmin[ib].z);   m_BoxMax.z = std::max(m_BoxMax.z, boxmax[ib].z);
+        m_nInverted += ninverted[ib];
+    }
+}
+
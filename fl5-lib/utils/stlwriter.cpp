@@ -0,0 +1,425 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <QFile>
+#include <QtEndian>
+
+#include <stlwriter.h>
+
+#include <foil.h>
+#include <surface.h>
+#include <threadpool.h>
+#include <wingxfl.h>
+
+
+namespace
+{
+    /** the number of triangles of a list which are encoded and written at once */
+    int const CHUNKSIZE = 1<<16;
+
+    /** the size of a triangle record in a binary STL file */
+    int const RECORDSIZE = 50;
+
+    bool writeBlock(QFile &file, std::string const &buffer)
+    {
+        if(buffer.empty()) return true;
+        return file.write(buffer.data(), qint64(buffer.size()))==qint64(buffer.size());
+    }
+
+    void writeFloat(char *&p, double value)
+    {
+        float f = float(value);
+        quint32 u=0;
+        memcpy(&u, &f, sizeof(float));
+        qToLittleEndian(u, p);
+        p += sizeof(quint32);
+    }
+}
+
+
+StlWriter::StlWriter()
+{
+    m_Format = BINARYSTL;
+    m_ScaleFactor = 1.0;
+    m_nChordPanels = 13;
+    m_nSpanPanels = 17;
+    m_bMultiThreaded = true;
+
+    m_nTriangles = 0;
+    m_iStep = m_nSteps = 0;
+    m_bCancel = false;
+}
+
+
+void StlWriter::addWing(WingXfl const *pWing)
+{
+    if(!pWing) return;
+    ExportPart part;
+    part.m_Name = pWing->name();
+    part.m_pWing = pWing;
+    m_Part.push_back(part);
+}
+
+
+/** Adds a list of triangles; the list is referenced and must remain valid until the file has been written */
+void StlWriter::addTriangles(std::string const &name, std::vector<Triangle3d> const &triangles)
+{
+    ExportPart part;
+    part.m_Name = name;
+    part.m_pTriangles = &triangles;
+    m_Part.push_back(part);
+}
+
+
+/**
+ * Writes the triangles of the parts to the file.
+ * @param solidname the name of the solid in a text STL file
+ * @return true if the file has been written
+ */
+bool StlWriter::write(std::string const &pathname, std::string const &solidname)
+{
+    m_Log.clear();
+    m_nTriangles = 0;
+    m_bCancel = false;
+
+    m_iStep = 0;
+    int nSteps = 0;
+    for(ExportPart const &part : m_Part)
+    {
+        if(part.m_pWing) nSteps += part.m_pWing->nSurfaces();
+        else             nSteps += (int(part.m_pTriangles->size())+CHUNKSIZE-1)/CHUNKSIZE;
+    }
+    m_nSteps = nSteps;
+
+    QFile file(QString::fromStdString(pathname));
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        m_Log += "StlWriter: could not open the file " + pathname + "\n";
+        return false;
+    }
+
+    std::string name = solidname;
+    for(char &c : name) if(c==' ') c='_';
+
+    std::string buffer;
+    bool bOk = true;
+    switch(m_Format)
+    {
+        case BINARYSTL:
+        {
+            // 80 character header, avoid the word "solid"; the count is written once known
+            buffer.assign(80, ' ');
+            buffer.replace(0, 16, "--- STL file ---");
+            buffer.append(4, '\0');
+            break;
+        }
+        case TEXTSTL:
+            buffer = "solid " + name + "\n";
+            break;
+        case OBJ:
+            buffer = "# flow5 export\n";
+            break;
+    }
+    bOk = writeBlock(file, buffer);
+
+    std::vector<Triangle3d> surfacetriangles;
+    for(uint ip=0; ip<m_Part.size() && bOk && !m_bCancel; ip++)
+    {
+        ExportPart const &part = m_Part.at(ip);
+
+        if(m_Format==OBJ)
+        {
+            std::string objname = part.m_Name;
+            for(char &c : objname) if(c==' ') c='_';
+            bOk = writeBlock(file, "o " + objname + "\n");
+        }
+
+        int nPartTriangles = 0;
+        if(part.m_pWing)
+        {
+            for(int is=0; is<part.m_pWing->nSurfaces() && bOk && !m_bCancel; is++)
+            {
+                surfacetriangles.clear();
+                makeSurfaceTriangles(part.m_pWing->surfaceAt(is), m_nChordPanels, m_nSpanPanels, surfacetriangles);
+                encodeTriangles(surfacetriangles.data(), int(surfacetriangles.size()), m_nTriangles, buffer);
+                bOk = writeBlock(file, buffer);
+                m_nTriangles   += int(surfacetriangles.size());
+                nPartTriangles += int(surfacetriangles.size());
+                m_iStep++;
+            }
+        }
+        else
+        {
+            std::vector<Triangle3d> const &triangles = *part.m_pTriangles;
+            for(int i0=0; i0<int(triangles.size()) && bOk && !m_bCancel; i0+=CHUNKSIZE)
+            {
+                int n = std::min(CHUNKSIZE, int(triangles.size())-i0);
+                encodeTriangles(triangles.data()+i0, n, m_nTriangles, buffer);
+                bOk = writeBlock(file, buffer);
+                m_nTriangles   += n;
+                nPartTriangles += n;
+                m_iStep++;
+            }
+        }
+
+        if(bOk && !m_bCancel)
+            m_Log += "   " + part.m_Name + ": " + std::to_string(nPartTriangles) + " triangles\n";
+    }
+
+    if(bOk && !m_bCancel)
+    {
+        if(m_Format==BINARYSTL)
+        {
+            char count[4];
+            qToLittleEndian(quint32(m_nTriangles), count);
+            bOk = file.seek(80) && file.write(count, 4)==4;
+        }
+        else if(m_Format==TEXTSTL)
+        {
+            bOk = writeBlock(file, "endsolid " + name + "\n");
+        }
+    }
+
+    file.close();
+
+    if(m_bCancel)
+    {
+        file.remove();
+        m_Log += "StlWriter: export cancelled\n";
+        return false;
+    }
+    if(!bOk)
+    {
+        m_Log += "StlWriter: error writing the file " + pathname + "\n";
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Encodes the records of the triangles in the buffer in the writer's format.
+ * @param iFirst the index of the first triangle in the file, used to number the vertices of the OBJ faces
+ */
+void StlWriter::encodeTriangles(Triangle3d const *triangles, int n, int iFirst, std::string &buffer) const
+{
+    buffer.clear();
+    if(n<=0) return;
+
+    int nBlocks = 1;
+    if(m_bMultiThreaded) nBlocks = std::min(ThreadPool::nBlocks(ThreadPool::maxThreadCount()), std::max(1, n/1000));
+    int blockSize = n/nBlocks+1;
+
+    double const scale = m_ScaleFactor;
+
+    if(m_Format==BINARYSTL)
+    {
+        // fixed size records, encoded in place
+        buffer.resize(size_t(n)*RECORDSIZE);
+        auto encodeBlock = [&](int iBlock)
+        {
+            int iStart = iBlock*blockSize;
+            int iEnd   = std::min(iStart+blockSize, n);
+            for(int it=iStart; it<iEnd; it++)
+            {
+                Triangle3d const &t3 = triangles[it];
+                char *p = &buffer[size_t(it)*RECORDSIZE];
+                writeFloat(p, t3.normal().x);
+                writeFloat(p, t3.normal().y);
+                writeFloat(p, t3.normal().z);
+                for(int iv=0; iv<3; iv++)
+                {
+                    writeFloat(p, t3.vertexAt(iv).x*scale);
+                    writeFloat(p, t3.vertexAt(iv).y*scale);
+                    writeFloat(p, t3.vertexAt(iv).z*scale);
+                }
+                p[0] = p[1] = 0; // attribute byte count
+            }
+        };
+
+        if(nBlocks>1) ThreadPool::pool().parallelFor(nBlocks, encodeBlock);
+        else          encodeBlock(0);
+        return;
+    }
+
+    // text records, encoded per block then joined in order
+    std::vector<std::string> blocktext(nBlocks);
+    auto encodeBlock = [&](int iBlock)
+    {
+        int iStart = iBlock*blockSize;
+        int iEnd   = std::min(iStart+blockSize, n);
+        std::string &text = blocktext[iBlock];
+        char line[256];
+        for(int it=iStart; it<iEnd; it++)
+        {
+            Triangle3d const &t3 = triangles[it];
+            if(m_Format==TEXTSTL)
+            {
+                snprintf(line, sizeof(line), "  facet normal %13.7e %13.7e %13.7e\n    outer loop\n", t3.normal().x, t3.normal().y, t3.normal().z);
+                text += line;
+                for(int iv=0; iv<3; iv++)
+                {
+                    snprintf(line, sizeof(line), "      vertex %13.7e %13.7e %13.7e\n",
+                             t3.vertexAt(iv).x*scale, t3.vertexAt(iv).y*scale, t3.vertexAt(iv).z*scale);
+                    text += line;
+                }
+                text += "    endloop\n  endfacet\n";
+            }
+            else
+            {
+                // the vertices are not shared, so that the faces of the part do not depend on the other chunks
+                for(int iv=0; iv<3; iv++)
+                {
+                    snprintf(line, sizeof(line), "v %.8g %.8g %.8g\n",
+                             t3.vertexAt(iv).x*scale, t3.vertexAt(iv).y*scale, t3.vertexAt(iv).z*scale);
+                    text += line;
+                }
+                long long iv0 = 3LL*(iFirst+it)+1;
+                snprintf(line, sizeof(line), "f %lld %lld %lld\n", iv0, iv0+1, iv0+2);
+                text += line;
+            }
+        }
+    };
+
+    if(nBlocks>1) ThreadPool::pool().parallelFor(nBlocks, encodeBlock);
+    else          encodeBlock(0);
+
+    size_t size = 0;
+    for(std::string const &text : blocktext) size += text.size();
+    buffer.reserve(size);
+    for(std::string const &text : blocktext) buffer += text;
+}
+
+
+/**
+ * Makes the triangles of the top and bottom surfaces of a wing surface, of its trailing edge if the foils
+ * have a gap, and of its tip patches. The intersections with the fuselage are not taken into account.
+ */
+void StlWriter::makeSurfaceTriangles(Surface const &surf, int nChordPanels, int nSpanPanels, std::vector<Triangle3d> &triangles)
+{
+    Vector3d Pt[3];
+    std::vector<Node> PtTopLeft(nChordPanels+1);
+    std::vector<Node> PtTopRight(nChordPanels+1);
+    std::vector<Node> PtBotLeft(nChordPanels+1);
+    std::vector<Node> PtBotRight(nChordPanels+1);
+
+    surf.getSidePoints_1(xfl::TOPSURFACE, nullptr, PtTopLeft, PtTopRight, nChordPanels+1, xfl::COSINE);
+    surf.getSidePoints_1(xfl::BOTSURFACE, nullptr, PtBotLeft, PtBotRight, nChordPanels+1, xfl::COSINE);
+
+    Foil const *pFoilA = surf.foilA();
+    Foil const *pFoilB = surf.foilB();
+    bool bTEGap = (pFoilA && pFoilA->TEGap()>0) || (pFoilB && pFoilB->TEGap()>0);
+
+    auto addTriangle = [&triangles](Vector3d const *vertex)
+    {
+        Triangle3d t3d(vertex);
+        if(!t3d.isNull()) triangles.push_back(t3d);
+    };
+
+    triangles.reserve(triangles.size() + size_t(nSpanPanels)*size_t(4*nChordPanels+2) + size_t(4*nChordPanels));
+
+    for(int is=0; is<nSpanPanels; is++)
+    {
+        double tauA = double(is)   /double(nSpanPanels);
+        double tauB = double(is+1) /double(nSpanPanels);
+
+        //top surface
+        for(int ic=0; ic<nChordPanels; ic++)
+        {
+            Pt[0] = PtTopLeft[ic]   * (1.0-tauA) + PtTopRight[ic]   * tauA;
+            Pt[1] = PtTopLeft[ic+1] * (1.0-tauA) + PtTopRight[ic+1] * tauA;
+            Pt[2] = PtTopLeft[ic]   * (1.0-tauB) + PtTopRight[ic]   * tauB;
+            addTriangle(Pt);
+
+            Pt[0] = PtTopLeft[ic+1] * (1.0-tauA) + PtTopRight[ic+1] * tauA;
+            Pt[1] = PtTopLeft[ic+1] * (1.0-tauB) + PtTopRight[ic+1] * tauB;
+            Pt[2] = PtTopLeft[ic]   * (1.0-tauB) + PtTopRight[ic]   * tauB;
+            addTriangle(Pt);
+        }
+
+        // bot surface
+        for(int ic=0; ic<nChordPanels; ic++)
+        {
+            Pt[0] = PtBotLeft[ic]   * (1.0-tauA) + PtBotRight[ic]   * tauA;
+            Pt[1] = PtBotLeft[ic]   * (1.0-tauB) + PtBotRight[ic]   * tauB;
+            Pt[2] = PtBotLeft[ic+1] * (1.0-tauA) + PtBotRight[ic+1] * tauA;
+            addTriangle(Pt);
+
+            Pt[0] = PtBotLeft[ic+1] * (1.0-tauA) + PtBotRight[ic+1] * tauA;
+            Pt[1] = PtBotLeft[ic]   * (1.0-tauB) + PtBotRight[ic]   * tauB;
+            Pt[2] = PtBotLeft[ic+1] * (1.0-tauB) + PtBotRight[ic+1] * tauB;
+            addTriangle(Pt);
+        }
+
+        // trailing edge panels if gap on either side
+        if(bTEGap)
+        {
+            Pt[0] = PtBotLeft.back() * (1.0-tauA) + PtBotRight.back() * tauA;
+            Pt[1] = PtTopLeft.back() * (1.0-tauB) + PtTopRight.back() * tauB;
+            Pt[2] = PtTopLeft.back() * (1.0-tauA) + PtTopRight.back() * tauA;
+            addTriangle(Pt);
+
+            Pt[0] = PtBotLeft.back() * (1.0-tauA) + PtBotRight.back() * tauA;
+            Pt[1] = PtBotLeft.back() * (1.0-tauB) + PtBotRight.back() * tauB;
+            Pt[2] = PtTopLeft.back() * (1.0-tauB) + PtTopRight.back() * tauB;
+            addTriangle(Pt);
+        }
+    }
+
+    //tip patches
+    if(surf.isTipLeft())
+    {
+        for(int ic=0; ic<nChordPanels; ic++)
+        {
+            Pt[0] = PtBotLeft[ic];   Pt[1] = PtTopLeft[ic+1]; Pt[2] = PtTopLeft[ic];
+            addTriangle(Pt);
+            Pt[0] = PtBotLeft[ic];   Pt[1] = PtBotLeft[ic+1]; Pt[2] = PtTopLeft[ic+1];
+            addTriangle(Pt);
+        }
+    }
+
+    if(surf.isTipRight())
+    {
+        for(int ic=0; ic<nChordPanels; ic++)
+        {
+            Pt[0] = PtBotRight[ic];  Pt[1] = PtTopRight[ic];   Pt[2] = PtTopRight[ic+1];
+            addTriangle(Pt);
+            Pt[0] = PtBotRight[ic];  Pt[1] = PtTopRight[ic+1]; Pt[2] = PtBotRight[ic+1];
+            addTriangle(Pt);
+        }
+    }
+}
+
+
+/** For STL export --> fuse intersections not taken into account */
+void StlWriter::makeWingTriangles(WingXfl const *pWing, int nChordPanels, int nSpanPanels, std::vector<Triangle3d> &triangles)
+{
+    for(int j=0; j<pWing->nSurfaces(); j++)
+        makeSurfaceTriangles(pWing->surfaceAt(j), nChordPanels, nSpanPanels, triangles);
+}
@@ -0,0 +1,417 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <allocstats.h>
+#include <taskprofile.h>
+
+
+bool TaskProfile::s_bEnabled(true);
+int TaskProfile::s_MaxEvents(100000);
+
+
+namespace
+{
+    std::string jsonString(std::string const &str)
+    {
+        std::string escaped = "\"";
+        for(char c : str)
+        {
+            if     (c=='"')  escaped += "\\\"";
+            else if(c=='\\') escaped += "\\\\";
+            else if(c=='\n') escaped += "\\n";
+            else             escaped += c;
+        }
+        return escaped + "\"";
+    }
+}
+
+
+TaskProfile::Scope::Scope(TaskProfile *pProfile, char const *name)
+{
+    m_pProfile = (pProfile && s_bEnabled) ? pProfile : nullptr;
+    m_iPhase = m_pProfile ? m_pProfile->openPhase(name) : -1;
+    m_nAllocsStart = AllocStats::count();
+    if(m_pProfile) m_Start = std::chrono::steady_clock::now();
+}
+
+
+TaskProfile::Scope::~Scope()
+{
+    if(m_pProfile) m_pProfile->closePhase(m_iPhase, m_Start, std::chrono::steady_clock::now(), AllocStats::count()-m_nAllocsStart);
+}
+
+
+TaskProfile::TaskProfile()
+{
+    m_nDroppedEvents = 0;
+    m_Origin = std::chrono::steady_clock::now();
+    for(std::atomic<int64_t> &c : m_Counter) c.store(0);
+}
+
+
+void TaskProfile::clear()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Phase.clear();
+    m_Stack.clear();
+    m_Event.clear();
+    m_nDroppedEvents = 0;
+    m_Origin = std::chrono::steady_clock::now();
+    for(std::atomic<int64_t> &c : m_Counter) c.store(0);
+}
+
+
+char const *TaskProfile::counterName(enumCounter c)
+{
+    switch(c)
+    {
+        case INFLUENCECOEFS:     return "influence_coefficients";
+        case LUFACTORIZATIONS:   return "lu_factorizations";
+        case LUCACHEHITS:        return "lu_cache_hits";
+        case RHSSOLVED:          return "rhs_solved";
+        case VISCOUSLOOPS:       return "viscous_loops";
+        case VPWITERATIONS:      return "vpw_iterations";
+        case NEWTONITERATIONS:   return "newton_iterations";
+        case VORTONSADVECTED:    return "vortons_advected";
+        case VORTONSMERGED:      return "vortons_merged";
+        case NCOUNTERS:          break;
+    }
+    return "";
+}
+
+
+int TaskProfile::findPhase(int iParent, std::string const &name) const
+{
+    for(int i=0; i<int(m_Phase.size()); i++)
+    {
+        if(m_Phase.at(i).m_Parent==iParent && m_Phase.at(i).m_Name==name) return i;
+    }
+    return -1;
+}
+
+
+int TaskProfile::openPhase(char const *name)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    int iParent = m_Stack.empty() ? -1 : m_Stack.back();
+    int iPhase = findPhase(iParent, name);
+    if(iPhase<0)
+    {
+        Phase phase;
+        phase.m_Name = name;
+        phase.m_Parent = iParent;
+        phase.m_Depth = iParent<0 ? 0 : m_Phase.at(iParent).m_Depth+1;
+        m_Phase.push_back(phase);
+        iPhase = int(m_Phase.size())-1;
+    }
+    m_Stack.push_back(iPhase);
+    return iPhase;
+}
+
+
+void TaskProfile::closePhase(int iPhase, std::chrono::steady_clock::time_point const &start, std::chrono::steady_clock::time_point const &end, int64_t nAllocs)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(iPhase<0 || iPhase>=int(m_Phase.size())) return; // cleared while the phase was open
+
+    double duration = std::chrono::duration<double>(end-start).count();
+    m_Phase[iPhase].m_nCalls++;
+    m_Phase[iPhase].m_Seconds += duration;
+    m_Phase[iPhase].m_nAllocs += nAllocs;
+
+    std::vector<int>::iterator it = std::find(m_Stack.begin(), m_Stack.end(), iPhase);
+    if(it!=m_Stack.end()) m_Stack.erase(it, m_Stack.end());
+
+    if(int(m_Event.size())<s_MaxEvents)
+    {
+        Event event;
+        event.m_iPhase = iPhase;
+        event.m_Start = std::chrono::duration<double, std::micro>(start-m_Origin).count();
+        event.m_Duration = duration*1.0e6;
+        m_Event.push_back(event);
+    }
+    else m_nDroppedEvents++;
+}
+
+
+std::string TaskProfile::pathNoLock(int iPhase) const
+{
+    std::string path;
+    for(int i=iPhase; i>=0; i=m_Phase.at(i).m_Parent)
+        path = path.empty() ? m_Phase.at(i).m_Name : m_Phase.at(i).m_Name + "/" + path;
+    return path;
+}
+
+
+int TaskProfile::findPath(std::string const &path) const
+{
+    for(int i=0; i<int(m_Phase.size()); i++)
+    {
+        if(pathNoLock(i)==path) return i;
+    }
+    return -1;
+}
+
+
+std::vector<TaskProfile::Phase> TaskProfile::phases() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Phase;
+}
+
+
+std::string TaskProfile::phasePath(int iPhase) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(iPhase<0 || iPhase>=int(m_Phase.size())) return std::string();
+    return pathNoLock(iPhase);
+}
+
+
+/** @return the total time in seconds spent in the phase with the given path, or 0 if the phase was never entered. */
+double TaskProfile::seconds(std::string const &path) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    int iPhase = findPath(path);
+    return iPhase<0 ? 0.0 : m_Phase.at(iPhase).m_Seconds;
+}
+
+
+int64_t TaskProfile::nCalls(std::string const &path) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    int iPhase = findPath(path);
+    return iPhase<0 ? 0 : m_Phase.at(iPhase).m_nCalls;
+}
+
+
+/**
+ * Adds the phases, the events and the counters of another profile, typically the one of a
+ * sub-task which ran in another thread. The phases are merged by path from the root.
+ * @param tid the lane of the other profile's events in the Chrome trace.
+ */
+void TaskProfile::merge(TaskProfile const &other, int tid)
+{
+    if(&other==this) return;
+
+    std::vector<Phase> otherphases;
+    std::vector<Event> otherevents;
+    std::chrono::steady_clock::time_point otherorigin;
+    {
+        std::lock_guard<std::mutex> lock(other.m_Mutex);
+        otherphases = other.m_Phase;
+        otherevents = other.m_Event;
+        otherorigin = other.m_Origin;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    // the phases are stored after their parent, so the parents are mapped first
+    std::vector<int> map(otherphases.size(), -1);
+    for(uint i=0; i<otherphases.size(); i++)
+    {
+        Phase const &phase = otherphases.at(i);
+        int iParent = phase.m_Parent<0 ? -1 : map.at(phase.m_Parent);
+        int iPhase = findPhase(iParent, phase.m_Name);
+        if(iPhase<0)
+        {
+            Phase newphase = phase;
+            newphase.m_Parent = iParent;
+            newphase.m_nCalls = 0;
+            newphase.m_Seconds = 0.0;
+            m_Phase.push_back(newphase);
+            iPhase = int(m_Phase.size())-1;
+        }
+        m_Phase[iPhase].m_nCalls  += phase.m_nCalls;
+        m_Phase[iPhase].m_Seconds += phase.m_Seconds;
+        m_Phase[iPhase].m_nAllocs += phase.m_nAllocs;
+        map[i] = iPhase;
+    }
+
+    double shift = std::chrono::duration<double, std::micro>(otherorigin-m_Origin).count();
+    for(Event const &event : otherevents)
+    {
+        if(int(m_Event.size())>=s_MaxEvents)
+        {
+            m_nDroppedEvents++;
+            continue;
+        }
+        Event newevent = event;
+        newevent.m_iPhase = map.at(event.m_iPhase);
+        newevent.m_Tid = tid;
+        newevent.m_Start += shift;
+        m_Event.push_back(newevent);
+    }
+
+    for(int c=0; c<NCOUNTERS; c++)
+        m_Counter[c].fetch_add(other.m_Counter[c].load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+
+/** @return a text table of the phases and of the non-zero counters, for the task's log. */
+std::string TaskProfile::summary() const
+{
+    std::vector<Phase> phases = this->phases();
+
+    double total = 0.0;
+    for(Phase const &phase : phases) if(phase.m_Parent<0) total += phase.m_Seconds;
+
+    bool bAllocs = AllocStats::isCompiled();
+
+    std::ostringstream out;
+    out << "   Phase                                       calls      time (s)      %";
+    out << (bAllocs ? "   allocations\n" : "\n");
+
+    // depth-first, so that each phase is listed under its parent
+    std::vector<int> stack;
+    for(int i=int(phases.size())-1; i>=0; i--) if(phases.at(i).m_Parent<0) stack.push_back(i);
+    while(!stack.empty())
+    {
+        int i = stack.back();
+        stack.pop_back();
+        Phase const &phase = phases.at(i);
+
+        std::string name = std::string(2*size_t(phase.m_Depth), ' ') + phase.m_Name;
+        char line[256];
+        snprintf(line, sizeof(line), "   %-40s %10lld %13.4f %6.1f", name.c_str(), static_cast<long long>(phase.m_nCalls),
+                 phase.m_Seconds, total>0.0 ? phase.m_Seconds/total*100.0 : 0.0);
+        out << line;
+        if(bAllocs)
+        {
+            snprintf(line, sizeof(line), " %13lld", static_cast<long long>(phase.m_nAllocs));
+            out << line;
+        }
+        out << "\n";
+
+        for(int j=int(phases.size())-1; j>=0; j--) if(phases.at(j).m_Parent==i) stack.push_back(j);
+    }
+
+    for(int c=0; c<NCOUNTERS; c++)
+    {
+        int64_t value = counter(enumCounter(c));
+        if(value) out << "   " << counterName(enumCounter(c)) << ": " << value << "\n";
+    }
+    return out.str();
+}
+
+
+/**
+ * @return the aggregated phases and the counters as a JSON object;
+ * the self time of a phase excludes the time of its sub-phases.
+ */
+std::string TaskProfile::toJson() const
+{
+    std::vector<Phase> phases;
+    int nDropped = 0;
+    std::vector<std::string> paths;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        phases = m_Phase;
+        nDropped = m_nDroppedEvents;
+        for(int i=0; i<int(m_Phase.size()); i++) paths.push_back(pathNoLock(i));
+    }
+
+    std::vector<double> self(phases.size());
+    for(uint i=0; i<phases.size(); i++) self[i] = phases.at(i).m_Seconds;
+    for(uint i=0; i<phases.size(); i++) if(phases.at(i).m_Parent>=0) self[phases.at(i).m_Parent] -= phases.at(i).m_Seconds;
+
+    std::ostringstream out;
+    out.precision(9);
+    out << "{\n  \"phases\": [";
+    for(uint i=0; i<phases.size(); i++)
+    {
+        Phase const &phase = phases.at(i);
+        out << (i ? ",\n" : "\n") << "    {\"path\": " << jsonString(paths.at(i))
+            << ", \"name\": " << jsonString(phase.m_Name)
+            << ", \"depth\": " << phase.m_Depth
+            << ", \"calls\": " << phase.m_nCalls
+            << ", \"seconds\": " << phase.m_Seconds
+            << ", \"self_seconds\": " << std::max(0.0, self.at(i));
+        if(AllocStats::isCompiled()) out << ", \"allocations\": " << phase.m_nAllocs;
+        out << "}";
+    }
+    out << "\n  ],\n  \"counters\": {";
+    for(int c=0; c<NCOUNTERS; c++)
+        out << (c ? ",\n" : "\n") << "    " << jsonString(counterName(enumCounter(c))) << ": " << counter(enumCounter(c));
+    out << "\n  },\n  \"dropped_events\": " << nDropped << "\n}\n";
+    return out.str();
+}
+
+
+/**
+ * @return the recorded phases in the Chrome trace event format, which can be opened
+ * in chrome://tracing or in Perfetto; the counters are appended at the end of the trace.
+ */
+std::string TaskProfile::toChromeTrace(std::string const &processname) const
+{
+    std::vector<Phase> phases;
+    std::vector<Event> events;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        phases = m_Phase;
+        events = m_Event;
+    }
+
+    std::ostringstream out;
+    out.precision(15);
+    out << "{\"traceEvents\": [\n";
+    out << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": " << jsonString(processname) << "}}";
+
+    double tend = 0.0;
+    for(Event const &event : events)
+    {
+        out << ",\n  {\"name\": " << jsonString(phases.at(event.m_iPhase).m_Name)
+            << ", \"cat\": \"flow5\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.m_Tid
+            << ", \"ts\": " << event.m_Start << ", \"dur\": " << event.m_Duration << "}";
+        tend = std::max(tend, event.m_Start+event.m_Duration);
+    }
+
+    out << ",\n  {\"name\": \"counters\", \"ph\": \"C\", \"pid\": 1, \"tid\": 0, \"ts\": " << tend << ", \"args\": {";
+    for(int c=0; c<NCOUNTERS; c++)
+        out << (c ? ", " : "") << jsonString(counterName(enumCounter(c))) << ": " << counter(enumCounter(c));
+    out << "}}\n], \"displayTimeUnit\": \"ms\"}\n";
+    return out.str();
+}
+
+
+bool TaskProfile::writeJson(std::string const &pathname) const
+{
+    std::ofstream file(pathname);
+    if(!file.is_open()) return false;
+    file << toJson();
+    return file.good();
+}
+
+
+bool TaskProfile::writeChromeTrace(std::string const &pathname, std::string const &processname) const
+{
+    std::ofstream file(pathname);
+    if(!file.is_open()) return false;
+    file << toChromeTrace(processname);
+    return file.good();
+}
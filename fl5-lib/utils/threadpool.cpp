@@ -0,0 +1,306 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+
+#include <threadpool.h>
+#include <numa.h>
+#include <objectstore.h>
+
+
+int ThreadPool::s_MaxThreads(0);
+int ThreadPool::s_BlocksPerThread(4);
+bool ThreadPool::s_bNumaAware(false);
+
+
+ThreadPool::ThreadPool()
+{
+    m_nQueued = 0;
+    m_NextWorker = 0;
+    m_bStop = false;
+    start(maxThreadCount());
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    stop();
+}
+
+
+ThreadPool &ThreadPool::pool()
+{
+    static ThreadPool s_Pool;
+    return s_Pool;
+}
+
+
+/**
+ * Returns the total number of threads used by parallelFor().
+ * Defaults to the hardware's thread count, which is only queried on first use
+ * so that loading the library does not run any code.
+ */
+int ThreadPool::maxThreadCount()
+{
+    if(s_MaxThreads>0) return s_MaxThreads;
+    static int const s_HardwareThreads = std::max(1, int(std::thread::hardware_concurrency()));
+    return s_HardwareThreads;
+}
+
+
+/**
+ * Sets the total number of threads used by parallelFor(), including the calling thread.
+ * The pool is restarted if the count has changed; must not be called while a loop is running.
+ */
+void ThreadPool::setMaxThreadCount(int nThreads)
+{
+    nThreads = std::max(1, nThreads);
+    ThreadPool &tp = pool();
+    std::lock_guard<std::mutex> lock(tp.m_ResizeMutex);
+    if(nThreads==maxThreadCount() && tp.nWorkers()==nThreads-1) return;
+    s_MaxThreads = nThreads;
+    tp.stop();
+    tp.start(nThreads);
+}
+
+
+/**
+ * Pins the workers to the NUMA nodes in turn, and keeps the loops called from a pinned thread on its node.
+ * Has no effect on a single node host. The pool is restarted; must not be called while a loop is running.
+ */
+void ThreadPool::setNumaAware(bool bNuma)
+{
+    ThreadPool &tp = pool();
+    std::lock_guard<std::mutex> lock(tp.m_ResizeMutex);
+    if(bNuma==s_bNumaAware) return;
+    s_bNumaAware = bNuma;
+    tp.stop();
+    tp.start(maxThreadCount());
+}
+
+
+void ThreadPool::start(int nThreads)
+{
+    m_bStop = false;
+    int nWorkers = std::max(0, nThreads-1); // the calling thread is the last worker
+    int nNodes = s_bNumaAware ? Numa::nNodes() : 1;
+    if(nNodes>1) m_NodeWorkers.resize(nNodes);
+    for(int i=0; i<nWorkers; i++)
+    {
+        m_Workers.push_back(new Worker);
+        if(nNodes>1)
+        {
+            m_Workers.back()->m_Node = i%nNodes;
+            m_NodeWorkers[i%nNodes].push_back(i);
+        }
+    }
+    for(int i=0; i<nWorkers; i++) m_Threads.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+}
+
+
+void ThreadPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_WakeMutex);
+        m_bStop = true;
+    }
+    m_WakeCondition.notify_all();
+
+    for(size_t i=0; i<m_Threads.size(); i++) m_Threads[i].join();
+    m_Threads.clear();
+
+    for(size_t i=0; i<m_Workers.size(); i++) delete m_Workers[i];
+    m_Workers.clear();
+    m_NodeWorkers.clear();
+}
+
+
+void ThreadPool::Worker::pushBack(Task const &task)
+{
+    if(m_nTasks==m_Ring.size())
+    {
+        // unroll the ring into a larger one; the capacity is kept for the next loops
+        std::vector<Task> ring(std::max<size_t>(16, 2*m_Ring.size()));
+        for(size_t i=0; i<m_nTasks; i++) ring[i] = m_Ring[(m_Head+i)%m_Ring.size()];
+        m_Ring.swap(ring);
+        m_Head = 0;
+    }
+    m_Ring[(m_Head+m_nTasks)%m_Ring.size()] = task;
+    m_nTasks++;
+}
+
+
+ThreadPool::Task ThreadPool::Worker::popBack()
+{
+    m_nTasks--;
+    return m_Ring[(m_Head+m_nTasks)%m_Ring.size()];
+}
+
+
+ThreadPool::Task ThreadPool::Worker::popFront()
+{
+    Task task = m_Ring[m_Head];
+    m_Head = (m_Head+1)%m_Ring.size();
+    m_nTasks--;
+    return task;
+}
+
+
+/** Queues the task on the next worker, or on the next worker of the node if the node is not negative */
+void ThreadPool::push(Task const &task, int node)
+{
+    int iWorker = 0;
+    if(node>=0) iWorker = m_NodeWorkers[node][m_NextWorker.fetch_add(1) % int(m_NodeWorkers[node].size())];
+    else        iWorker = m_NextWorker.fetch_add(1) % int(m_Workers.size());
+    Worker *pWorker = m_Workers[iWorker];
+    std::lock_guard<std::mutex> lock(pWorker->m_Mutex);
+    pWorker->pushBack(task);
+    m_nQueued++;
+}
+
+
+/** Runs one iteration of a loop in the loop's store, and notifies the caller of parallelFor() if it was the last one */
+void ThreadPool::runTask(Task const &task)
+{
+    Loop &loop = *task.m_pLoop;
+    {
+        ScopedStore scope(loop.m_pStore);
+        (*loop.m_pTask)(task.m_Index);
+    }
+    std::lock_guard<std::mutex> lock(loop.m_Mutex);
+    loop.m_nRemaining--;
+    if(loop.m_nRemaining==0) loop.m_Done.notify_all();
+}
+
+
+/**
+ * Runs one queued task if any is available.
+ * The worker's own queue is served from the back, the others are stolen from the front.
+ * @param iWorker the index of the worker, or -1 if called from a thread outside the pool.
+ * @param node the NUMA node of the calling thread, whose tasks are the only ones stolen, or -1 to steal from all the workers.
+ * @return true if a task was run.
+ */
+bool ThreadPool::runOneTask(int iWorker, int node)
+{
+    Task task;
+    bool bFound = false;
+    int nWorkers = int(m_Workers.size());
+
+    if(iWorker>=0)
+    {
+        Worker *pWorker = m_Workers[iWorker];
+        std::lock_guard<std::mutex> lock(pWorker->m_Mutex);
+        if(!pWorker->isEmpty())
+        {
+            task = pWorker->popBack();
+            bFound = true;
+        }
+    }
+
+    for(int k=1; !bFound && k<=nWorkers; k++)
+    {
+        int iVictim = (std::max(iWorker, 0) + k) % nWorkers;
+        if(iVictim==iWorker) continue;
+        Worker *pVictim = m_Workers[iVictim];
+        if(node>=0 && pVictim->m_Node!=node) continue;
+        std::lock_guard<std::mutex> lock(pVictim->m_Mutex);
+        if(!pVictim->isEmpty())
+        {
+            task = pVictim->popFront();
+            bFound = true;
+        }
+    }
+
+    if(!bFound) return false;
+
+    m_nQueued--;
+    runTask(task);
+    return true;
+}
+
+
+void ThreadPool::workerLoop(int iWorker)
+{
+    int node = m_Workers[iWorker]->m_Node;
+    if(node>=0) Numa::pinCurrentThread(node);
+
+    while(true)
+    {
+        if(runOneTask(iWorker, node)) continue;
+
+        std::unique_lock<std::mutex> lock(m_WakeMutex);
+        m_WakeCondition.wait(lock, [this]{return m_bStop || m_nQueued.load()>0;});
+        if(m_bStop && m_nQueued.load()<=0) return;
+    }
+}
+
+
+/**
+ * Runs task(i) for i in [0, nTasks[ on the pool and returns when all the tasks have completed.
+ * The calling thread executes queued tasks while it waits.
+ */
+void ThreadPool::parallelFor(int nTasks, std::function<void(int)> const &task)
+{
+    if(nTasks<=0) return;
+
+    if(nTasks==1 || m_Workers.empty())
+    {
+        for(int i=0; i<nTasks; i++) task(i);
+        return;
+    }
+
+    // the queued tasks only hold the index and the loop, so that pushing them does not allocate
+    Loop loop;
+    loop.m_pTask = &task;
+    loop.m_pStore = &ObjectStore::current(); // the tasks run in the caller's store, whichever thread picks them up
+    loop.m_nRemaining = nTasks;
+
+    // a thread pinned to a node keeps its loop on the node's workers
+    int node = m_NodeWorkers.empty() ? -1 : Numa::currentThreadNode();
+    if(node>=int(m_NodeWorkers.size()) || (node>=0 && m_NodeWorkers[node].empty())) node = -1;
+
+    for(int i=0; i<nTasks; i++) push({&loop, i}, node);
+
+    {
+        // taking the lock ensures that no worker misses the notification
+        std::lock_guard<std::mutex> lock(m_WakeMutex);
+    }
+    m_WakeCondition.notify_all();
+
+    while(true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(loop.m_Mutex);
+            if(loop.m_nRemaining==0) break;
+        }
+
+        if(!runOneTask(-1, node))
+        {
+            std::unique_lock<std::mutex> lock(loop.m_Mutex);
+            loop.m_Done.wait_for(lock, std::chrono::microseconds(200), [&loop]{return loop.m_nRemaining==0;});
+        }
+    }
+}
+
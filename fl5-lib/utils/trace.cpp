@@ -23,8 +23,11 @@
 *****************************************************************************/
 
 #include <iostream>
+#include <mutex>
+#include <vector>
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QTextStream>
 
 
@@ -33,6 +36,24 @@
 bool xfl::g_bTrace = false;
 QFile *xfl::g_pTraceFile = nullptr;
 
+
+namespace
+{
+    /** The phases of the startup, timed from the first mark */
+    struct StartupTrace
+    {
+        QElapsedTimer m_Timer;
+        std::vector<std::pair<QString, qint64>> m_Marks;
+        std::mutex m_Mutex;
+    };
+
+    StartupTrace &startupTrace()
+    {
+        static StartupTrace s_Trace;
+        return s_Trace;
+    }
+}
+
 /**
 * Outputs in a debug file the current time and the value of the integer passed as an input parameter.
 * The file is in the user's default temporary directory with the name Trace.log
@@ -158,3 +179,42 @@ void xfl::trace(const QString &msg, QString const &txt)
     std::cout<<(msg + " " + txt).toStdString();
 }
 
+
+
+/**
+* Records the end of a phase of the application's startup.
+* The first call starts the clock; the phases are listed with their duration by startupReport()
+* and are also written to the trace if it is enabled.
+*@param phase the name of the phase which has just completed
+*/
+void xfl::startupMark(QString const &phase)
+{
+    StartupTrace &st = startupTrace();
+    qint64 t = 0;
+    {
+        std::lock_guard<std::mutex> lock(st.m_Mutex);
+        if(!st.m_Timer.isValid()) st.m_Timer.start();
+        t = st.m_Timer.elapsed();
+        st.m_Marks.push_back({phase, t});
+    }
+    trace(QString::asprintf("Startup: %6lld ms  ", t) + phase + "\n");
+}
+
+
+/**
+* Returns the list of the startup phases with their end time and their duration in ms.
+*/
+QString xfl::startupReport()
+{
+    StartupTrace &st = startupTrace();
+    std::lock_guard<std::mutex> lock(st.m_Mutex);
+
+    QString report = "Startup times:\n";
+    qint64 tprev = 0;
+    for(std::pair<QString, qint64> const &mark : st.m_Marks)
+    {
+        report += QString::asprintf("   %6lld ms  (+%5lld ms)  ", mark.second, mark.second-tprev) + mark.first + "\n";
+        tprev = mark.second;
+    }
+    return report;
+}
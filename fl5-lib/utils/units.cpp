@@ -60,6 +60,8 @@ int Units::g_InertiaUnitIndex  = 0;
 
 int Units::g_FluidUnitType(0);
 
+int Units::g_Revision(0);
+
 
 double Units::toCustomUnit(int index)
 {
@@ -368,6 +370,8 @@ void Units::setUnitConversionFactors()
             break;
         }
     }
+
+    g_Revision++;
 }
 
 
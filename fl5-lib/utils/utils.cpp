@@ -22,14 +22,30 @@
 
 *****************************************************************************/
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <QDir>
+#include <QRandomGenerator>
 #include <QString>
+#include <QTextStream>
+#include <QtEndian>
 #include <time.h>
 
 #include <QString>
 
+#ifdef Q_OS_WIN
+  #ifndef PSAPI_VERSION
+    #define PSAPI_VERSION 2  // the K32 functions exported by kernel32
+  #endif
+  #include <windows.h>
+  #include <psapi.h>
+#else
+  #include <sys/resource.h>
+#endif
+
 #if defined ACCELERATE
   #include <Accelerate/Accelerate.h>
   #define lapack_int int
@@ -263,6 +279,381 @@ void xfl::readFloat(QDataStream &inStream, float &f)
 }
 
 
+/**
+ * Reads the bytes of n values which have been stored as ar << float(x), without decoding them.
+ * The stream's version, floating point precision and byte order are recorded in the block.
+ * @return false if the stream does not hold n values.
+ */
+bool xfl::readFloatBlock(QDataStream &ar, int n, ArrayBlock &block)
+{
+    block = ArrayBlock();
+    block.m_nValues = std::max(n, 0);
+    block.m_bSingle = ar.version()<QDataStream::Qt_4_6 || ar.floatingPointPrecision()==QDataStream::SinglePrecision;
+    block.m_bBigEndian = ar.byteOrder()==QDataStream::BigEndian;
+    if(n<=0) return true;
+
+    int size = block.m_bSingle ? 4 : 8;
+    block.m_Data.resize(n*size);
+    if(ar.readRawData(block.m_Data.data(), n*size)!=n*size)
+    {
+        ar.setStatus(QDataStream::ReadPastEnd);
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Reads the bytes of an array written by writePackedArray(), without uncompressing them.
+ * @return false if the block does not hold n values.
+ */
+bool xfl::readPackedBlock(QDataStream &ar, int n, ArrayBlock &block)
+{
+    block = ArrayBlock();
+    block.m_bPacked = true;
+
+    ar >> block.m_nValues >> block.m_bFixed16;
+    if(block.m_bFixed16) ar >> block.m_Min >> block.m_Max;
+    ar >> block.m_Data;
+
+    return block.m_nValues==n && ar.status()==QDataStream::Ok;
+}
+
+
+/**
+ * Decodes a block read by readFloatBlock() or readPackedBlock().
+ * The values are rounded to single precision as they would be by ar >> f.
+ * Blocks are independent and may be decoded concurrently.
+ * @param values the destination array, of size block.m_nValues.
+ * @return false if the data does not hold the expected number of values.
+ */
+bool xfl::decodeArrayBlock(ArrayBlock const &block, double *values)
+{
+    int n = block.m_nValues;
+    if(n<=0) return true;
+
+    if(block.m_bPacked)
+    {
+        QByteArray raw = qUncompress(block.m_Data);
+        if(block.m_bFixed16)
+        {
+            if(raw.size()!=n*int(sizeof(quint16))) return false;
+            char const *p = raw.constData();
+            double scale = (block.m_Max-block.m_Min)/65535.0;
+            for(int i=0; i<n; i++, p+=sizeof(quint16))
+                values[i] = block.m_Min + double(qFromLittleEndian<quint16>(p)) * scale;
+        }
+        else
+        {
+            if(raw.size()!=n*int(sizeof(float))) return false;
+            char const *p = raw.constData();
+            for(int i=0; i<n; i++, p+=sizeof(float))
+            {
+                quint32 u = qFromLittleEndian<quint32>(p);
+                float f(0);
+                memcpy(&f, &u, sizeof(float));
+                values[i] = double(f);
+            }
+        }
+        return true;
+    }
+
+    int size = block.m_bSingle ? 4 : 8;
+    if(block.m_Data.size()!=n*size) return false;
+
+    char const *p = block.m_Data.constData();
+    for(int i=0; i<n; i++, p+=size)
+    {
+        if(block.m_bSingle)
+        {
+            quint32 u = block.m_bBigEndian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p);
+            float f(0);
+            memcpy(&f, &u, sizeof(float));
+            values[i] = double(f);
+        }
+        else
+        {
+            quint64 u = block.m_bBigEndian ? qFromBigEndian<quint64>(p) : qFromLittleEndian<quint64>(p);
+            double d(0);
+            memcpy(&d, &u, sizeof(double));
+            values[i] = double(float(d));
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Writes in a single block n values as they would be written by ar << float(x),
+ * honouring the stream's version, floating point precision and byte order.
+ */
+void xfl::writeFloatArray(QDataStream &ar, double const *values, int n)
+{
+    if(n<=0) return;
+
+    bool bSingle = ar.version()<QDataStream::Qt_4_6 || ar.floatingPointPrecision()==QDataStream::SinglePrecision;
+    bool bBigEndian = ar.byteOrder()==QDataStream::BigEndian;
+    int size = bSingle ? 4 : 8;
+
+    std::vector<char> buffer(size_t(n)*size_t(size));
+    char *p = buffer.data();
+    for(int i=0; i<n; i++, p+=size)
+    {
+        float f = float(values[i]);
+        if(bSingle)
+        {
+            quint32 u(0);
+            memcpy(&u, &f, sizeof(float));
+            if(bBigEndian) qToBigEndian<quint32>(u, p); else qToLittleEndian<quint32>(u, p);
+        }
+        else
+        {
+            double d = double(f);
+            quint64 u(0);
+            memcpy(&u, &d, sizeof(double));
+            if(bBigEndian) qToBigEndian<quint64>(u, p); else qToLittleEndian<quint64>(u, p);
+        }
+    }
+    ar.writeRawData(buffer.data(), int(buffer.size()));
+}
+
+
+/**
+ * Reads in a single block n values which have been stored as ar << float(x).
+ * @return false if the stream does not hold n values.
+ */
+bool xfl::readFloatArray(QDataStream &ar, double *values, int n)
+{
+    ArrayBlock block;
+    if(!readFloatBlock(ar, n, block)) return false;
+    return decodeArrayBlock(block, values);
+}
+
+
+/**
+ * Writes in a single block the n rows of the columns, interleaved as they would be written
+ * by a loop of ar << float(column[0][i]) << float(column[1][i])...
+ */
+void xfl::writeFloatColumns(QDataStream &ar, std::vector<double const*> const &columns, int n)
+{
+    int nc = int(columns.size());
+    if(n<=0 || nc==0) return;
+
+    std::vector<double> values(size_t(n)*size_t(nc));
+    for(int i=0; i<n; i++)
+        for(int ic=0; ic<nc; ic++) values[size_t(i)*nc+ic] = columns[ic][i];
+    writeFloatArray(ar, values.data(), int(values.size()));
+}
+
+
+/**
+ * Reads in a single block n rows of interleaved values written by writeFloatColumns()
+ * or by the equivalent loop of ar << float(x).
+ * @return false if the stream does not hold the values.
+ */
+bool xfl::readFloatColumns(QDataStream &ar, std::vector<double*> const &columns, int n)
+{
+    int nc = int(columns.size());
+    if(n<=0 || nc==0) return true;
+
+    std::vector<double> values(size_t(n)*size_t(nc));
+    if(!readFloatArray(ar, values.data(), int(values.size()))) return false;
+    for(int i=0; i<n; i++)
+        for(int ic=0; ic<nc; ic++) columns[ic][i] = values[size_t(i)*nc+ic];
+    return true;
+}
+
+
+void xfl::writeRawBlock(QDataStream &ar, std::vector<char> const &buffer)
+{
+    size_t const chunk = size_t(1)<<30;
+    for(size_t pos=0; pos<buffer.size(); pos+=chunk)
+        ar.writeRawData(buffer.data()+pos, int(std::min(chunk, buffer.size()-pos)));
+}
+
+
+/**
+ * Reads size bytes in the buffer.
+ * @return false if the stream does not hold them.
+ */
+bool xfl::readRawBlock(QDataStream &ar, std::vector<char> &buffer, size_t size)
+{
+    buffer.resize(size);
+    size_t const chunk = size_t(1)<<30;
+    for(size_t pos=0; pos<size; pos+=chunk)
+    {
+        int len = int(std::min(chunk, size-pos));
+        if(ar.readRawData(buffer.data()+pos, len)!=len)
+        {
+            ar.setStatus(QDataStream::ReadPastEnd);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+xfl::RecordCodec::RecordCodec(QDataStream const &ar)
+{
+    m_bBigEndian = ar.byteOrder()==QDataStream::BigEndian;
+    if(ar.version()<QDataStream::Qt_4_6)
+    {
+        m_FloatSize  = 4;
+        m_DoubleSize = 8;
+    }
+    else
+    {
+        m_FloatSize = m_DoubleSize = ar.floatingPointPrecision()==QDataStream::SinglePrecision ? 4 : 8;
+    }
+}
+
+
+void xfl::RecordCodec::putInt(char *&p, qint32 i) const
+{
+    if(m_bBigEndian) qToBigEndian<qint32>(i, p); else qToLittleEndian<qint32>(i, p);
+    p += 4;
+}
+
+
+qint32 xfl::RecordCodec::getInt(char const *&p) const
+{
+    qint32 i = m_bBigEndian ? qFromBigEndian<qint32>(p) : qFromLittleEndian<qint32>(p);
+    p += 4;
+    return i;
+}
+
+
+/** Writes 4 or 8 bytes, as QDataStream converts the values to the stream's precision */
+static void putReal(char *&p, double d, int size, bool bBigEndian)
+{
+    if(size==4)
+    {
+        float f = float(d);
+        quint32 u(0);
+        memcpy(&u, &f, sizeof(float));
+        if(bBigEndian) qToBigEndian<quint32>(u, p); else qToLittleEndian<quint32>(u, p);
+    }
+    else
+    {
+        quint64 u(0);
+        memcpy(&u, &d, sizeof(double));
+        if(bBigEndian) qToBigEndian<quint64>(u, p); else qToLittleEndian<quint64>(u, p);
+    }
+    p += size;
+}
+
+
+static double getReal(char const *&p, int size, bool bBigEndian)
+{
+    double d(0);
+    if(size==4)
+    {
+        quint32 u = bBigEndian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p);
+        float f(0);
+        memcpy(&f, &u, sizeof(float));
+        d = double(f);
+    }
+    else
+    {
+        quint64 u = bBigEndian ? qFromBigEndian<quint64>(p) : qFromLittleEndian<quint64>(p);
+        memcpy(&d, &u, sizeof(double));
+    }
+    p += size;
+    return d;
+}
+
+
+void xfl::RecordCodec::putFloat(char *&p, float f) const
+{
+    putReal(p, double(f), m_FloatSize, m_bBigEndian);
+}
+
+
+void xfl::RecordCodec::putDouble(char *&p, double d) const
+{
+    putReal(p, d, m_DoubleSize, m_bBigEndian);
+}
+
+
+float xfl::RecordCodec::getFloat(char const *&p) const
+{
+    return float(getReal(p, m_FloatSize, m_bBigEndian));
+}
+
+
+double xfl::RecordCodec::getDouble(char const *&p) const
+{
+    return getReal(p, m_DoubleSize, m_bBigEndian);
+}
+
+
+/**
+ * Writes n values quantized either to single precision or to 16-bit fixed point scaled on the
+ * array's range, then compressed. The 16-bit quantization falls back to single precision if
+ * the array holds non-finite values.
+ * The block is read back by readPackedArray().
+ */
+void xfl::writePackedArray(QDataStream &ar, double const *values, int n, bool bFixed16)
+{
+    double vmin(0), vmax(0);
+    if(bFixed16 && n>0)
+    {
+        vmin = vmax = values[0];
+        for(int i=0; i<n; i++)
+        {
+            if(!std::isfinite(values[i]))
+            {
+                bFixed16 = false;
+                break;
+            }
+            vmin = std::min(vmin, values[i]);
+            vmax = std::max(vmax, values[i]);
+        }
+    }
+
+    QByteArray raw;
+    if(bFixed16)
+    {
+        double range = vmax-vmin;
+        raw.resize(n*int(sizeof(quint16)));
+        char *p = raw.data();
+        for(int i=0; i<n; i++, p+=sizeof(quint16))
+        {
+            quint16 q = range>0.0 ? quint16(std::lround((values[i]-vmin)/range*65535.0)) : 0;
+            qToLittleEndian<quint16>(q, p);
+        }
+    }
+    else
+    {
+        raw.resize(n*int(sizeof(float)));
+        char *p = raw.data();
+        for(int i=0; i<n; i++, p+=sizeof(float))
+        {
+            float f = float(values[i]);
+            quint32 u(0);
+            memcpy(&u, &f, sizeof(float));
+            qToLittleEndian<quint32>(u, p);
+        }
+    }
+
+    ar << n << bFixed16;
+    if(bFixed16) ar << vmin << vmax;
+    ar << qCompress(raw, 1);
+}
+
+
+/**
+ * Reads a block written by writePackedArray().
+ * @return false if the block does not hold n values.
+ */
+bool xfl::readPackedArray(QDataStream &ar, double *values, int n)
+{
+    ArrayBlock block;
+    if(!readPackedBlock(ar, n, block)) return false;
+    return decodeArrayBlock(block, values);
+}
+
+
 void xfl::writeFloat(QDataStream &outStream, float f)
 {
     char buffer[4];
@@ -284,6 +675,35 @@ int xfl::randomInt(int range)
     return std::rand() % range;
 }
 
+
+/** Returns a saturated colour of random hue; light colours are intended for dark backgrounds */
+fl5Color xfl::randomfl5Color(bool bLightColor)
+{
+    int h = QRandomGenerator::global()->bounded(360);
+    int s = QRandomGenerator::global()->bounded(155)+100;
+    int v = QRandomGenerator::global()->bounded(80)+120;
+    if(bLightColor) v += 55;
+
+    // HSV to RGB
+    double S = double(s)/255.0;
+    double V = double(v)/255.0;
+    double C = V*S;
+    double X = C * (1.0 - std::abs(std::fmod(double(h)/60.0, 2.0) - 1.0));
+    double m = V-C;
+    double r=0, g=0, b=0;
+    switch(h/60)
+    {
+        case 0:  r=C; g=X; b=0; break;
+        case 1:  r=X; g=C; b=0; break;
+        case 2:  r=0; g=C; b=X; break;
+        case 3:  r=0; g=X; b=C; break;
+        case 4:  r=X; g=0; b=C; break;
+        default: r=C; g=0; b=X; break;
+    }
+
+    return fl5Color(short(std::round((r+m)*255.0)), short(std::round((g+m)*255.0)), short(std::round((b+m)*255.0)), 255);
+}
+
 /*
 fl5Color xfl::randomObjectColor(bool )
 {
@@ -329,6 +749,24 @@ float xfl::getBlue(float tau)
 }
 
 
+/**
+ * Appends the string to the log and keeps the log's size less than maxSize, so that the logs of the long batch runs
+ * are bounded. The oldest lines are discarded first, by blocks of half the max. size so that the trimming is rare.
+ * @param maxSize the max. number of characters of the log, or 0 for no limit
+ */
+void xfl::appendToLog(std::string &log, std::string const &str, size_t maxSize)
+{
+    log.append(str);
+    if(maxSize==0 || log.size()<=maxSize) return;
+
+    size_t pos = log.find('\n', log.size()-maxSize/2);
+    if(pos==std::string::npos) pos = log.size()-maxSize/2;
+    else                       pos++;
+    log.erase(0, pos);
+    log.insert(0, "   ...\n");
+}
+
+
 bool xfl::stringToFile(std::string const &string, std::string const &path)
 {
     std::ofstream outstream;
@@ -375,6 +813,88 @@ QString xfl::boolToString(bool b)
     return b ? "true" : "false";
 }
 
+
+/** from Qt examples WordCount
+ * startDir = QDir::home().absolutePath()
+ * filters = QStringList() << "*.cpp" << "*.h" ;
+*/
+QStringList xfl::findFiles(const QString &startDir, QStringList const &filters, bool bRecursive)
+{
+    QStringList names;
+    QDir dir(startDir);
+
+    for (QString const &file : dir.entryList(filters, QDir::Files))
+    {
+        names += startDir + '/' + file;
+    }
+
+    if(bRecursive)
+    {
+        for(QString const& subdir : dir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot))
+        {
+            names += findFiles(startDir + '/' + subdir, filters, bRecursive);
+        }
+    }
+
+    return names;
+}
+
+
+bool xfl::findFile(QString const &filename, QString const &startDir, QStringList const &filters, bool bRecursive, QString &filePathName)
+{
+    QDir dir(startDir);
+
+    for(QString const &file : dir.entryList(filters, QDir::Files))
+    {
+        if(file.compare(filename, Qt::CaseInsensitive)==0)
+        {
+            filePathName = startDir + '/' + file;
+            return true;
+        }
+    }
+
+    if(bRecursive)
+    {
+        for(QString const &subdir : dir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot))
+        {
+            if(findFile(filename, startDir + '/' + subdir, filters, bRecursive, filePathName))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+
+/**
+ * Reads one line from an AVL-format text file
+ */
+bool xfl::readAVLString(QTextStream &in, int &Line, QString &strong)
+{
+    bool isCommentLine = true;
+    int pos=0;
+    if(in.atEnd()) return false;
+
+    while(isCommentLine && !in.atEnd())
+    {
+        isCommentLine = false;
+
+        strong = in.readLine();
+
+        strong = strong.trimmed();
+        pos = strong.indexOf("#",0);
+        if(pos>=0) strong = strong.left(pos);
+        pos = strong.indexOf("!",0);
+        if(pos>=0) strong = strong.left(pos);
+
+        if(strong.isEmpty()) isCommentLine = true;
+
+        Line++;
+    }
+
+    return true;
+}
+
 std::string xfl::MklVersion()
 {
     QString strange;
@@ -391,3 +911,20 @@ std::string xfl::MklVersion()
 }
 
 
+/** Returns the high-water mark of the process' resident memory in bytes, or 0 if unavailable */
+size_t xfl::peakMemoryUsage()
+{
+#if defined Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS pmc;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return size_t(pmc.PeakWorkingSetSize);
+    return 0;
+#else
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage)!=0) return 0;
+  #if defined Q_OS_MAC
+    return size_t(usage.ru_maxrss);       // bytes
+  #else
+    return size_t(usage.ru_maxrss)*1024;  // kilobytes
+  #endif
+#endif
+}
@@ -0,0 +1,373 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <cstdint>
+#include <cstdio>
+
+#include <QFile>
+
+#include <xdmfwriter.h>
+
+#include <opp3d.h>
+#include <quadmesh.h>
+#include <threadpool.h>
+#include <trimesh.h>
+#include <vorton.h>
+
+
+namespace
+{
+    bool writeBlock(QFile &file, void const *data, size_t nBytes)
+    {
+        if(nBytes==0) return true;
+        return file.write(static_cast<char const*>(data), qint64(nBytes))==qint64(nBytes);
+    }
+
+    std::string xmlEscaped(std::string const &str)
+    {
+        std::string escaped;
+        escaped.reserve(str.size());
+        for(char c : str)
+        {
+            switch(c)
+            {
+                case '&':  escaped += "&amp;";  break;
+                case '<':  escaped += "&lt;";   break;
+                case '>':  escaped += "&gt;";   break;
+                case '"':  escaped += "&quot;"; break;
+                default:   escaped += c;        break;
+            }
+        }
+        return escaped;
+    }
+
+    std::string dataItem(std::string const &filename, char const *numbertype, int precision, std::string const &dimensions, size_t offset)
+    {
+        return "<DataItem Format=\"Binary\" Endian=\"Native\" NumberType=\"" + std::string(numbertype) +
+               "\" Precision=\"" + std::to_string(precision) + "\" Dimensions=\"" + dimensions +
+               "\" Seek=\"" + std::to_string(offset) + "\">" + xmlEscaped(filename) + "</DataItem>";
+    }
+}
+
+
+XdmfWriter::XdmfWriter()
+{
+    m_bMultiThreaded = true;
+    m_nCells = m_nVertices = 0;
+    m_nWritten = 0;
+    m_bCancel = false;
+}
+
+
+/**
+ * Writes the mesh and the fields of the operating points in the directory, as the files basename.xmf,
+ * basename_mesh.bin and one basename_nnnnn.bin file per operating point.
+ * The operating points must have been computed with the same method, i.e. on the same mesh; those
+ * whose panel count differs from the mesh are skipped.
+ * @return true if the files have been written
+ */
+bool XdmfWriter::write(std::string const &dirpath, std::string const &basename, TriMesh const &trimesh, QuadMesh const &quadmesh,
+                       std::vector<Opp3d const*> const &opps)
+{
+    m_Log.clear();
+    m_nWritten = 0;
+    m_bCancel = false;
+
+    if(opps.empty() || !opps.front())
+    {
+        m_Log += "XdmfWriter: no operating point to write\n";
+        return false;
+    }
+
+    bool bTriangles = opps.front()->isTriangleMethod();
+    m_nVertices = bTriangles ? 3 : 4;
+    m_nCells    = bTriangles ? trimesh.nPanels() : quadmesh.nPanels();
+    if(m_nCells<=0)
+    {
+        m_Log += "XdmfWriter: the mesh has no panels\n";
+        return false;
+    }
+
+    std::string meshfilename = basename + "_mesh.bin";
+    if(!writeMesh(dirpath + "/" + meshfilename, trimesh, quadmesh, bTriangles)) return false;
+
+    std::vector<OppFile> oppfiles;
+    oppfiles.reserve(opps.size());
+    for(uint io=0; io<opps.size(); io++)
+    {
+        Opp3d const *pOpp = opps.at(io);
+        if(!pOpp) continue;
+        int nPanels = bTriangles ? pOpp->nPanel3() : pOpp->nPanel4();
+        if(pOpp->isTriangleMethod()!=bTriangles || nPanels!=m_nCells)
+        {
+            m_Log += "XdmfWriter: skipping " + pOpp->title(false) + ", computed on a different mesh\n";
+            continue;
+        }
+        oppfiles.emplace_back();
+        OppFile &oppfile = oppfiles.back();
+        oppfile.m_pOpp = pOpp;
+        char suffix[16];
+        snprintf(suffix, sizeof(suffix), "_%05d.bin", int(io));
+        oppfile.m_FileName = basename + suffix;
+    }
+
+    auto task = [&](int io)
+    {
+        if(m_bCancel) return;
+        OppFile &oppfile = oppfiles[io];
+        makeOppFile(oppfile, trimesh, bTriangles);
+        oppfile.m_bWritten = writeOppFile(dirpath, oppfile);
+        // release the gathered copies once written
+        oppfile.m_NodeValues = std::vector<double>();
+        oppfile.m_Vortons = std::vector<double>();
+    };
+
+    int nOpps = int(oppfiles.size());
+    if(m_bMultiThreaded) ThreadPool::pool().parallelFor(nOpps, task);
+    else                 for(int io=0; io<nOpps; io++) task(io);
+
+    for(OppFile const &oppfile : oppfiles)
+    {
+        if(oppfile.m_bWritten) m_nWritten++;
+        else if(!m_bCancel) m_Log += "XdmfWriter: error writing the file " + oppfile.m_FileName + "\n";
+    }
+
+    if(m_bCancel)
+    {
+        m_Log += "XdmfWriter: cancelled\n";
+        return false;
+    }
+
+    return writeXml(dirpath + "/" + basename + ".xmf", meshfilename, oppfiles);
+}
+
+
+/** Writes the vertex coordinates, then the connectivity, of the panels with separate vertices */
+bool XdmfWriter::writeMesh(std::string const &pathname, TriMesh const &trimesh, QuadMesh const &quadmesh, bool bTriangles)
+{
+    size_t nPts = size_t(m_nCells)*size_t(m_nVertices);
+    std::vector<double> xyz(3*nPts);
+    std::vector<int32_t> conn(nPts);
+    for(int ic=0; ic<m_nCells; ic++)
+    {
+        for(int iv=0; iv<m_nVertices; iv++)
+        {
+            Node const &vtx = bTriangles ? trimesh.panelAt(ic).vertexAt(iv) : quadmesh.panelAt(ic).vertex(iv);
+            size_t ip = size_t(ic)*size_t(m_nVertices) + size_t(iv);
+            xyz[3*ip]   = vtx.x;
+            xyz[3*ip+1] = vtx.y;
+            xyz[3*ip+2] = vtx.z;
+            conn[ip] = int32_t(ip);
+        }
+    }
+
+    QFile file(QString::fromStdString(pathname));
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        m_Log += "XdmfWriter: could not open the file " + pathname + "\n";
+        return false;
+    }
+    bool bOk = writeBlock(file, xyz.data(), xyz.size()*sizeof(double)) &&
+               writeBlock(file, conn.data(), conn.size()*sizeof(int32_t));
+    file.close();
+    if(!bOk) m_Log += "XdmfWriter: error writing the file " + pathname + "\n";
+    return bOk;
+}
+
+
+/** Lists the arrays of the operating point and their offsets in its binary file */
+void XdmfWriter::makeOppFile(OppFile &oppfile, TriMesh const &trimesh, bool bTriangles) const
+{
+    Opp3d const *pOpp = oppfile.m_pOpp;
+    size_t nPts  = size_t(m_nCells)*size_t(m_nVertices);
+    size_t nCells = size_t(m_nCells);
+
+    auto addField = [&](char const *name, std::vector<double> const &values)
+    {
+        Array array;
+        array.m_Name = name;
+        array.m_pData = values.data();
+        array.m_Count = values.size();
+        if(bTriangles && values.size()==nPts) array.m_bCell = false;
+        else if(values.size()==nCells)         array.m_bCell = true;
+        else return; // not a panel field, or not computed
+        oppfile.m_Arrays.push_back(array);
+    };
+
+    addField("Cp",    pOpp->Cp());
+    addField("gamma", pOpp->gamma());
+    addField("sigma", pOpp->sigma());
+
+    if(bTriangles && pOpp->isTriLinearMethod())
+    {
+        size_t nNodes = size_t(trimesh.nNodes());
+        bool bHasNodeValues = false;
+        for(size_t in=0; in<nNodes; in++)
+        {
+            if(pOpp->nodeValue(int(in))!=0.0) {bHasNodeValues=true; break;}
+        }
+        if(bHasNodeValues)
+        {
+            oppfile.m_NodeValues.resize(nPts);
+            for(int ic=0; ic<m_nCells; ic++)
+            {
+                Panel3 const &p3 = trimesh.panelAt(ic);
+                for(int iv=0; iv<3; iv++) oppfile.m_NodeValues[size_t(3*ic+iv)] = pOpp->nodeValue(p3.nodeIndex(iv));
+            }
+            addField("node_values", oppfile.m_NodeValues);
+        }
+    }
+
+    size_t offset = 0;
+    for(Array &array : oppfile.m_Arrays)
+    {
+        array.m_Offset = offset;
+        offset += array.m_Count*sizeof(double);
+    }
+
+    if(pOpp->hasVortons())
+    {
+        VortonWake const &wake = pOpp->vortonWake();
+        size_t nv = size_t(wake.count());
+        oppfile.m_nVortons = nv;
+        oppfile.m_Vortons.resize(6*nv);
+        for(size_t iv=0; iv<nv; iv++)
+        {
+            Vector3d const pos   = wake.position(int(iv));
+            Vector3d const omega = wake.vortex(int(iv));
+            oppfile.m_Vortons[3*iv]        = pos.x;
+            oppfile.m_Vortons[3*iv+1]      = pos.y;
+            oppfile.m_Vortons[3*iv+2]      = pos.z;
+            oppfile.m_Vortons[3*(nv+iv)]   = omega.x;
+            oppfile.m_Vortons[3*(nv+iv)+1] = omega.y;
+            oppfile.m_Vortons[3*(nv+iv)+2] = omega.z;
+        }
+    }
+}
+
+
+bool XdmfWriter::writeOppFile(std::string const &dirpath, OppFile &oppfile) const
+{
+    QFile file(QString::fromStdString(dirpath + "/" + oppfile.m_FileName));
+    if(!file.open(QIODevice::WriteOnly)) return false;
+
+    bool bOk = true;
+    for(Array const &array : oppfile.m_Arrays)
+    {
+        bOk = bOk && writeBlock(file, array.m_pData, array.m_Count*sizeof(double));
+    }
+    // the vortons follow the fields; the connectivity of the points is implicit
+    bOk = bOk && writeBlock(file, oppfile.m_Vortons.data(), oppfile.m_Vortons.size()*sizeof(double));
+    if(oppfile.m_nVortons>0)
+    {
+        std::vector<int32_t> conn(oppfile.m_nVortons);
+        for(size_t i=0; i<conn.size(); i++) conn[i] = int32_t(i);
+        bOk = bOk && writeBlock(file, conn.data(), conn.size()*sizeof(int32_t));
+    }
+    file.close();
+    return bOk;
+}
+
+
+bool XdmfWriter::writeXml(std::string const &pathname, std::string const &meshfilename, std::vector<OppFile> const &oppfiles) const
+{
+    size_t nPts = size_t(m_nCells)*size_t(m_nVertices);
+    std::string topology = m_nVertices==3 ? "Triangle" : "Quadrilateral";
+    std::string geometry = dataItem(meshfilename, "Float", 8, std::to_string(nPts)+" 3", 0);
+    std::string connectivity = dataItem(meshfilename, "Int", 4, std::to_string(m_nCells)+" "+std::to_string(m_nVertices), nPts*3*sizeof(double));
+
+    bool bVortons = false;
+    for(OppFile const &oppfile : oppfiles) if(oppfile.m_bWritten && oppfile.m_nVortons>0) bVortons = true;
+
+    std::string xml;
+    xml += "<?xml version=\"1.0\" ?>\n";
+    xml += "<Xdmf Version=\"2.0\">\n";
+    xml += "  <Domain>\n";
+    xml += "    <Grid Name=\"Panels\" GridType=\"Collection\" CollectionType=\"Temporal\">\n";
+    int iTime = 0;
+    for(OppFile const &oppfile : oppfiles)
+    {
+        if(!oppfile.m_bWritten) continue;
+        xml += "      <Grid Name=\"" + xmlEscaped(oppfile.m_pOpp->title(false)) + "\" GridType=\"Uniform\">\n";
+        xml += "        <Time Value=\"" + std::to_string(iTime) + "\"/>\n";
+        xml += "        <Topology TopologyType=\"" + topology + "\" NumberOfElements=\"" + std::to_string(m_nCells) + "\">\n";
+        xml += "          " + connectivity + "\n";
+        xml += "        </Topology>\n";
+        xml += "        <Geometry GeometryType=\"XYZ\">\n";
+        xml += "          " + geometry + "\n";
+        xml += "        </Geometry>\n";
+        for(Array const &array : oppfile.m_Arrays)
+        {
+            xml += "        <Attribute Name=\"" + array.m_Name + "\" AttributeType=\"Scalar\" Center=\"" + (array.m_bCell ? "Cell" : "Node") + "\">\n";
+            xml += "          " + dataItem(oppfile.m_FileName, "Float", 8, std::to_string(array.m_Count), array.m_Offset) + "\n";
+            xml += "        </Attribute>\n";
+        }
+        xml += "      </Grid>\n";
+        iTime++;
+    }
+    xml += "    </Grid>\n";
+
+    if(bVortons)
+    {
+        xml += "    <Grid Name=\"Vortons\" GridType=\"Collection\" CollectionType=\"Temporal\">\n";
+        iTime = 0;
+        for(OppFile const &oppfile : oppfiles)
+        {
+            if(!oppfile.m_bWritten) continue;
+            size_t nv = oppfile.m_nVortons;
+            size_t offset = 0;
+            for(Array const &array : oppfile.m_Arrays) offset += array.m_Count*sizeof(double);
+
+            xml += "      <Grid Name=\"" + xmlEscaped(oppfile.m_pOpp->title(false)) + "_vortons\" GridType=\"Uniform\">\n";
+            xml += "        <Time Value=\"" + std::to_string(iTime) + "\"/>\n";
+            if(nv>0)
+            {
+                std::string dims = std::to_string(nv)+" 3";
+                xml += "        <Topology TopologyType=\"Polyvertex\" NumberOfElements=\"" + std::to_string(nv) + "\" NodesPerElement=\"1\">\n";
+                xml += "          " + dataItem(oppfile.m_FileName, "Int", 4, std::to_string(nv), offset + 6*nv*sizeof(double)) + "\n";
+                xml += "        </Topology>\n";
+                xml += "        <Geometry GeometryType=\"XYZ\">\n";
+                xml += "          " + dataItem(oppfile.m_FileName, "Float", 8, dims, offset) + "\n";
+                xml += "        </Geometry>\n";
+                xml += "        <Attribute Name=\"vortex\" AttributeType=\"Vector\" Center=\"Node\">\n";
+                xml += "          " + dataItem(oppfile.m_FileName, "Float", 8, dims, offset + 3*nv*sizeof(double)) + "\n";
+                xml += "        </Attribute>\n";
+            }
+            xml += "      </Grid>\n";
+            iTime++;
+        }
+        xml += "    </Grid>\n";
+    }
+
+    xml += "  </Domain>\n";
+    xml += "</Xdmf>\n";
+
+    QFile file(QString::fromStdString(pathname));
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    bool bOk = writeBlock(file, xml.data(), xml.size());
+    file.close();
+    return bOk;
+}
+
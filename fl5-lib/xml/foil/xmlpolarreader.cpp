@@ -41,11 +41,11 @@ bool XmlPolarReader::readXMLPolarFile()
 {
     if (readNextStartElement())
     {
-        if (name().toString().compare("Foil_Polar", Qt::CaseInsensitive)==0 && attributes().value("version").toString().compare("1.0", Qt::CaseInsensitive)==0)
+        if (name().compare(QLatin1String("Foil_Polar"), Qt::CaseInsensitive)==0 && attributes().value("version").toString().compare("1.0", Qt::CaseInsensitive)==0)
         {
             while(!atEnd() && !hasError() && readNextStartElement() )
             {
-                if (name().toString().compare(QString("Polar"), Qt::CaseInsensitive)==0)
+                if (name().compare(QLatin1String("Polar"), Qt::CaseInsensitive)==0)
                 {
                     readPolar(m_pPolar);
                 }
@@ -67,49 +67,49 @@ bool XmlPolarReader::readPolar(Polar *pPolar)
 {
     while(!atEnd() && !hasError() && readNextStartElement())
     {
-        if (name().toString().compare(QString("polar_name"),Qt::CaseInsensitive) ==0)
+        if (name().compare(QLatin1String("polar_name"),Qt::CaseInsensitive) ==0)
         {
             pPolar->setName(readElementText().toStdString());
         }
-        else if (name().toString().compare(QString("foil_name"),Qt::CaseInsensitive) ==0)
+        else if (name().compare(QLatin1String("foil_name"),Qt::CaseInsensitive) ==0)
         {
             pPolar->setFoilName(readElementText().toStdString());
         }
-        else if (name().toString().compare(QString("type"),Qt::CaseInsensitive) ==0)
+        else if (name().compare(QLatin1String("type"),Qt::CaseInsensitive) ==0)
         {
             pPolar->setType(xml::polarType(readElementText()));
         }
-        else if (name().toString().compare(QString("method"),Qt::CaseInsensitive) ==0)
+        else if (name().compare(QLatin1String("method"),Qt::CaseInsensitive) ==0)
         {
             QString method = readElementText();
             if     (method.compare("XFoil", Qt::CaseInsensitive)==0)        pPolar->setBLMethod(BL::XFOIL);
             else pPolar->setBLMethod(BL::XFOIL);
         }
-        else if (name().compare(QString("Fixed_Reynolds"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Fixed_Reynolds"), Qt::CaseInsensitive)==0)
         {
             pPolar->setReynolds(readElementText().toDouble());
         }
-        else if (name().compare(QString("Fixed_AOA"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Fixed_AOA"), Qt::CaseInsensitive)==0)
         {
             pPolar->setAoaSpec(readElementText().toDouble());
         }
-        else if (name().toString().compare(QString("Forced_Top_Transition"),Qt::CaseInsensitive) ==0)
+        else if (name().compare(QLatin1String("Forced_Top_Transition"),Qt::CaseInsensitive) ==0)
         {
             pPolar->setXTripTop(readElementText().toDouble());
         }
-        else if (name().toString().compare(QString("Forced_Bottom_Transition"),Qt::CaseInsensitive) ==0)
+        else if (name().compare(QLatin1String("Forced_Bottom_Transition"),Qt::CaseInsensitive) ==0)
         {
             pPolar->setXTripBot(readElementText().toDouble());
         }
-        else if (name().toString().compare(QString("Reynolds_Type"),Qt::CaseInsensitive) ==0)
+        else if (name().compare(QLatin1String("Reynolds_Type"),Qt::CaseInsensitive) ==0)
         {
             pPolar->setReType(readElementText().toInt());
         }
-        else if (name().toString().compare(QString("Mach_Type"),Qt::CaseInsensitive) ==0)
+        else if (name().compare(QLatin1String("Mach_Type"),Qt::CaseInsensitive) ==0)
         {
             pPolar->setMaType(readElementText().toInt());
         }
-        else if (name().toString().compare(QString("NCrit"),Qt::CaseInsensitive) ==0)
+        else if (name().compare(QLatin1String("NCrit"),Qt::CaseInsensitive) ==0)
         {
             pPolar->setNCrit(readElementText().toDouble());
         }
@@ -47,19 +47,19 @@ bool XmlFuseReader::readXMLFuseFile()
 
     if (readNextStartElement())
     {
-        if (name().toString().compare("xflfuse", Qt::CaseInsensitive)==0 && attributes().value("version").toString() == "1.0")
+        if (name().compare(QLatin1String("xflfuse"), Qt::CaseInsensitive)==0 && attributes().value("version").toString() == "1.0")
         {
             while(!atEnd() && !hasError() && readNextStartElement() )
             {
-                if (name().toString().compare(QString("units"), Qt::CaseInsensitive)==0)
+                if (name().compare(QLatin1String("units"), Qt::CaseInsensitive)==0)
                 {
                     while(!atEnd() && !hasError() && readNextStartElement() )
                     {
-                        if (name().compare(QString("length_unit_to_meter"),      Qt::CaseInsensitive)==0)
+                        if (name().compare(QLatin1String("length_unit_to_meter"),      Qt::CaseInsensitive)==0)
                         {
                             lengthunit = readElementText().trimmed().toDouble();
                         }
-                        else if (name().compare(QString("mass_unit_to_kg"),      Qt::CaseInsensitive)==0)
+                        else if (name().compare(QLatin1String("mass_unit_to_kg"),      Qt::CaseInsensitive)==0)
                         {
                             massunit = readElementText().trimmed().toDouble();
                         }
@@ -67,7 +67,7 @@ bool XmlFuseReader::readXMLFuseFile()
                             skipCurrentElement();
                     }
                 }
-                else if (name().toString().compare(QString("body"), Qt::CaseInsensitive)==0)
+                else if (name().compare(QLatin1String("body"), Qt::CaseInsensitive)==0)
                 {
                     m_pFuseXfl = new FuseNurbs;
                     readFuseXfl(m_pFuseXfl, lengthunit, massunit);
@@ -26,6 +26,7 @@
 
 
 #include <QFileInfo>
+#include <QLocale>
 
 #include <QDir>
 
@@ -40,6 +41,7 @@
 #include <objects2d_globals.h>
 #include <pointmass.h>
 #include <polar3d.h>
+#include <vector3d.h>
 #include <wingxfl.h>
 #include <xml_globals.h>
 
@@ -60,18 +62,58 @@ XflXmlReader::~XflXmlReader()
 {
 }
 
+
+/**
+ * Reads the comma or space separated values of the current element's text, without splitting
+ * it into a list of strings. A value which cannot be read is set to 0, as QString::toDouble() does.
+ * @return the number of values read.
+ */
+int XflXmlReader::readValues(double *values, int nMax)
+{
+    QString const text = readElementText();
+    QChar const *d = text.constData();
+    int len = int(text.length());
+    QLocale const c = QLocale::c();
+
+    int n=0, i=0;
+    while(i<len && n<nMax)
+    {
+        while(i<len && (d[i].isSpace() || d[i]==QChar(','))) i++;
+        int j=i;
+        while(j<len && !d[j].isSpace() && d[j]!=QChar(',')) j++;
+        if(j>i)
+        {
+            bool bOk = false;
+            double value = c.toDouble(QStringView(d+i, j-i), &bOk);
+            values[n++] = bOk ? value : 0.0;
+        }
+        i=j;
+    }
+    return n;
+}
+
+
+/** Reads the x,y,z coordinates of the current element; the vector is left unchanged if less than 3 values are read. */
+bool XflXmlReader::readVector(Vector3d &V, double unit)
+{
+    double xyz[3]{0,0,0};
+    if(readValues(xyz, 3)<3) return false;
+    V.set(xyz[0]*unit, xyz[1]*unit, xyz[2]*unit);
+    return true;
+}
+
 bool XflXmlReader::readTheStyle(LineStyle &theStyle)
 {
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if      (name().compare(QString("Width"), Qt::CaseInsensitive)==0)
+        if      (name().compare(QLatin1String("Width"), Qt::CaseInsensitive)==0)
         {
             theStyle.m_Width = 1;
             bool bOk = false;
             int w = readElementText().trimmed().toInt(&bOk);
             if(bOk) theStyle.m_Width = w;
         }
-        else if (name().compare(QString("Stipple"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Stipple"), Qt::CaseInsensitive)==0)
         {
             theStyle.m_Stipple = Line::SOLID; // the default
 
@@ -83,7 +125,7 @@ bool XflXmlReader::readTheStyle(LineStyle &theStyle)
             else if(stipple.compare("DASHDOTDOT", Qt::CaseInsensitive)==0) theStyle.m_Stipple = Line::DASHDOTDOT;
             else if(stipple.compare("NOLINE",     Qt::CaseInsensitive)==0) theStyle.m_Stipple = Line::NOLINE;
         }
-        else if (name().compare(QString("PointStyle"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("PointStyle"), Qt::CaseInsensitive)==0)
         {
             theStyle.m_Symbol = Line::NOSYMBOL;
 
@@ -104,7 +146,7 @@ bool XflXmlReader::readTheStyle(LineStyle &theStyle)
             else if(ptstyle.compare("TRIANGLEFILLED",     Qt::CaseInsensitive)==0) theStyle.m_Symbol = Line::TRIANGLE_F;
             else if(ptstyle.compare("TRIANGLEFILLED_INV", Qt::CaseInsensitive)==0) theStyle.m_Symbol = Line::TRIANGLE_INV_F;
         }
-        else if (name().compare(QString("Color"), Qt::CaseInsensitive)==0) readColor(theStyle.m_Color);
+        else if (name().compare(QLatin1String("Color"), Qt::CaseInsensitive)==0) readColor(theStyle.m_Color);
         else skipCurrentElement();
     }
     return !hasError();
@@ -116,10 +158,10 @@ bool XflXmlReader::readColor(fl5Color &color)
     color.setRgba(0,0,0,255);
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if      (name().compare(QString("red"),   Qt::CaseInsensitive)==0)  color.setRed(readElementText().trimmed().toInt());
-        else if (name().compare(QString("green"), Qt::CaseInsensitive)==0)  color.setGreen(readElementText().trimmed().toInt());
-        else if (name().compare(QString("blue"),  Qt::CaseInsensitive)==0)  color.setBlue(readElementText().trimmed().toInt());
-        else if (name().compare(QString("alpha"), Qt::CaseInsensitive)==0)  color.setAlpha(readElementText().trimmed().toInt());
+        if      (name().compare(QLatin1String("red"),   Qt::CaseInsensitive)==0)  color.setRed(readElementText().trimmed().toInt());
+        else if (name().compare(QLatin1String("green"), Qt::CaseInsensitive)==0)  color.setGreen(readElementText().trimmed().toInt());
+        else if (name().compare(QLatin1String("blue"),  Qt::CaseInsensitive)==0)  color.setBlue(readElementText().trimmed().toInt());
+        else if (name().compare(QLatin1String("alpha"), Qt::CaseInsensitive)==0)  color.setAlpha(readElementText().trimmed().toInt());
         else skipCurrentElement();
     }
     return !hasError();
@@ -130,17 +172,12 @@ bool XflXmlReader::readPointMass(PointMass &pm, double massUnit, double lengthUn
 {
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if      (name().compare(QString("tag"), Qt::CaseInsensitive)==0)  pm.setTag(readElementText().trimmed().toStdString());
-        else if (name().compare(QString("mass"), Qt::CaseInsensitive)==0) pm.setMass(readElementText().trimmed().toDouble()*massUnit);
-        else if (name().compare(QString("coordinates"), Qt::CaseInsensitive)==0)
+        if      (name().compare(QLatin1String("tag"), Qt::CaseInsensitive)==0)  pm.setTag(readElementText().trimmed().toStdString());
+        else if (name().compare(QLatin1String("mass"), Qt::CaseInsensitive)==0) pm.setMass(readElementText().trimmed().toDouble()*massUnit);
+        else if (name().compare(QLatin1String("coordinates"), Qt::CaseInsensitive)==0)
         {
-            QStringList coordList = readElementText().simplified().split(",");
-            if(coordList.length()>=3)
-            {
-                pm.setXPosition(coordList.at(0).toDouble()*lengthUnit);
-                pm.setYPosition(coordList.at(1).toDouble()*lengthUnit);
-                pm.setZPosition(coordList.at(2).toDouble()*lengthUnit);
-            }
+            Vector3d pos;
+            if(readVector(pos, lengthUnit)) pm.setPosition(pos);
         }
         else skipCurrentElement();
     }
@@ -152,51 +189,38 @@ bool XflXmlReader::readNurbs(NURBSSurface &nurbs, std::vector<int> &xpanels, dou
 {
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if      (name().compare(QString("u_degree"),           Qt::CaseInsensitive)==0) nurbs.setuDegree(readElementText().toInt());
-        else if (name().compare(QString("v_degree"),           Qt::CaseInsensitive)==0) nurbs.setvDegree(readElementText().toInt());
-        else if (name().compare(QString("uAxis"),              Qt::CaseInsensitive)==0) nurbs.setUAxis(readElementText().toInt());
-        else if (name().compare(QString("vAxis"),              Qt::CaseInsensitive)==0) nurbs.setVAxis(readElementText().toInt());
-        else if (name().compare(QString("uEdgeWeight"),        Qt::CaseInsensitive)==0) nurbs.setuEdgeWeight(readElementText().toDouble());
-        else if (name().compare(QString("vEdgeWeight"),        Qt::CaseInsensitive)==0) nurbs.setvEdgeWeight(readElementText().toDouble());
-        else if (name().compare(QString("Bunch_amplitude"),    Qt::CaseInsensitive)==0) nurbs.setBunchAmplitude(readElementText().toDouble());
-        else if (name().compare(QString("Bunch_distribution"), Qt::CaseInsensitive)==0) nurbs.setBunchDistribution(readElementText().toDouble());
-        else if (name().compare(QString("Frame"),              Qt::CaseInsensitive)==0)
+        if      (name().compare(QLatin1String("u_degree"),           Qt::CaseInsensitive)==0) nurbs.setuDegree(readElementText().toInt());
+        else if (name().compare(QLatin1String("v_degree"),           Qt::CaseInsensitive)==0) nurbs.setvDegree(readElementText().toInt());
+        else if (name().compare(QLatin1String("uAxis"),              Qt::CaseInsensitive)==0) nurbs.setUAxis(readElementText().toInt());
+        else if (name().compare(QLatin1String("vAxis"),              Qt::CaseInsensitive)==0) nurbs.setVAxis(readElementText().toInt());
+        else if (name().compare(QLatin1String("uEdgeWeight"),        Qt::CaseInsensitive)==0) nurbs.setuEdgeWeight(readElementText().toDouble());
+        else if (name().compare(QLatin1String("vEdgeWeight"),        Qt::CaseInsensitive)==0) nurbs.setvEdgeWeight(readElementText().toDouble());
+        else if (name().compare(QLatin1String("Bunch_amplitude"),    Qt::CaseInsensitive)==0) nurbs.setBunchAmplitude(readElementText().toDouble());
+        else if (name().compare(QLatin1String("Bunch_distribution"), Qt::CaseInsensitive)==0) nurbs.setBunchDistribution(readElementText().toDouble());
+        else if (name().compare(QLatin1String("Frame"),              Qt::CaseInsensitive)==0)
         {
             Frame &frame = nurbs.appendNewFrame();
             frame.clearCtrlPoints();
             xpanels.push_back(1);
             while(!atEnd() && !hasError() && readNextStartElement() )
             {
-                if (name().compare(QString("Angle"), Qt::CaseInsensitive)==0)
+                if (name().compare(QLatin1String("Angle"), Qt::CaseInsensitive)==0)
                 {
                     frame.setAngle(readElementText().toDouble());
                 }
-                else if (name().compare(QString("x_panels"), Qt::CaseInsensitive)==0)
+                else if (name().compare(QLatin1String("x_panels"), Qt::CaseInsensitive)==0)
                 {
                     xpanels.back() = readElementText().toInt();
                 }
-                else if (name().compare(QString("Position"), Qt::CaseInsensitive)==0)
+                else if (name().compare(QLatin1String("Position"), Qt::CaseInsensitive)==0)
                 {
-                    QStringList coordList = readElementText().simplified().split(",");
-                    if(coordList.length()>=3)
-                    {
-                        double x = coordList.at(0).toDouble()*lengthUnit;
-                        double y = coordList.at(1).toDouble()*lengthUnit;
-                        double z = coordList.at(2).toDouble()*lengthUnit;
-                        frame.setPosition(Vector3d(x,y,z));
-                    }
+                    Vector3d pos;
+                    if(readVector(pos, lengthUnit)) frame.setPosition(pos);
                 }
-                else if (name().compare(QString("point"), Qt::CaseInsensitive)==0)
+                else if (name().compare(QLatin1String("point"), Qt::CaseInsensitive)==0)
                 {
                     Vector3d ctrlPt;
-                    QStringList coordList = readElementText().simplified().split(",");
-                    if(coordList.length()>=3)
-                    {
-                        ctrlPt.x = coordList.at(0).toDouble()*lengthUnit;
-                        ctrlPt.y = coordList.at(1).toDouble()*lengthUnit;
-                        ctrlPt.z = coordList.at(2).toDouble()*lengthUnit;
-                        frame.appendPoint(ctrlPt);
-                    }
+                    if(readVector(ctrlPt, lengthUnit)) frame.appendPoint(ctrlPt);
                 }
             }
         }
@@ -211,11 +235,11 @@ bool XflXmlReader::readFluidData(double &viscosity, double &density)
 {
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if (name().compare(QString("Viscosity"), Qt::CaseInsensitive)==0)
+        if (name().compare(QLatin1String("Viscosity"), Qt::CaseInsensitive)==0)
         {
             viscosity = readElementText().toDouble();
         }
-        else if (name().compare(QString("Density"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Density"), Qt::CaseInsensitive)==0)
         {
             density = readElementText().toDouble();
         }
@@ -230,11 +254,11 @@ void XflXmlReader::readInertia(Inertia &inertia, double lengthunit, double massu
 {
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if (name().compare(QString("Mass"), Qt::CaseInsensitive)==0)
+        if (name().compare(QLatin1String("Mass"), Qt::CaseInsensitive)==0)
         {
             inertia.setStructuralMass(readElementText().toDouble()*massunit);
         }
-        else if (name().compare(QString("CoG"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("CoG"), Qt::CaseInsensitive)==0)
         {
             QStringList coordList = readElementText().simplified().split(",");
             if(coordList.length()>=3)
@@ -244,23 +268,23 @@ void XflXmlReader::readInertia(Inertia &inertia, double lengthunit, double massu
                 inertia.setCoG_s(x,0.0,z);
             }
         }
-        else if (name().compare(QString("CoG_Ixx"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("CoG_Ixx"), Qt::CaseInsensitive)==0)
         {
             inertia.setIxx_s(readElementText().toDouble()*inertiaunit);
         }
-        else if (name().compare(QString("CoG_Iyy"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("CoG_Iyy"), Qt::CaseInsensitive)==0)
         {
             inertia.setIyy_s(readElementText().toDouble()*inertiaunit);
         }
-        else if (name().compare(QString("CoG_Izz"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("CoG_Izz"), Qt::CaseInsensitive)==0)
         {
             inertia.setIzz_s(readElementText().toDouble()*inertiaunit);
         }
-        else if (name().compare(QString("CoG_Izz"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("CoG_Izz"), Qt::CaseInsensitive)==0)
         {
             inertia.setIxz_s(readElementText().toDouble()*inertiaunit);
         }
-        else if (name().compare(QString("Point_Mass"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Point_Mass"), Qt::CaseInsensitive)==0)
         {
             PointMass pm;
             readPointMass(pm, massunit, lengthunit);
@@ -276,7 +300,7 @@ bool XflXmlReader::readExtraDrag(std::vector<ExtraDrag> &extra, double areaunit)
 {
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if (name().compare(QString("Drag"), Qt::CaseInsensitive)==0)
+        if (name().compare(QLatin1String("Drag"), Qt::CaseInsensitive)==0)
         {
             QStringList coordList = readElementText().simplified().split(",");
             if(coordList.size()==3)
@@ -300,43 +324,43 @@ bool XflXmlReader::readUnits(double &lengthunit, double &massunit, double &veloc
     // changed tags in v7.50, kept legacy ones active
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if (name().compare(QString("length_unit_to_meter"),      Qt::CaseInsensitive)==0)
+        if (name().compare(QLatin1String("length_unit_to_meter"),      Qt::CaseInsensitive)==0)
         {
             lengthunit = readElementText().toDouble();
         }
-        else if (name().compare(QString("meter_to_length_unit"), Qt::CaseInsensitive)==0) // changed tag in v7.50
+        else if (name().compare(QLatin1String("meter_to_length_unit"), Qt::CaseInsensitive)==0) // changed tag in v7.50
         {
             lengthunit = readElementText().toDouble();
         }
-        else if (name().compare(QString("mass_unit_to_kg"),      Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("mass_unit_to_kg"),      Qt::CaseInsensitive)==0)
         {
             massunit = readElementText().toDouble();
         }
-        else if (name().compare(QString("kg_to_mass_unit"),      Qt::CaseInsensitive)==0) // changed tag in v7.50
+        else if (name().compare(QLatin1String("kg_to_mass_unit"),      Qt::CaseInsensitive)==0) // changed tag in v7.50
         {
             massunit = readElementText().toDouble();
         }
-        else if (name().compare(QString("speed_unit_to_ms"),      Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("speed_unit_to_ms"),      Qt::CaseInsensitive)==0)
         {
             velocityunit = readElementText().toDouble();
         }
-        else if (name().compare(QString("ms_to_speed_unit"),      Qt::CaseInsensitive)==0) // changed tag in v7.50
+        else if (name().compare(QLatin1String("ms_to_speed_unit"),      Qt::CaseInsensitive)==0) // changed tag in v7.50
         {
             velocityunit = readElementText().toDouble();
         }
-        else if (name().compare(QString("area_unit_to_m2"),       Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("area_unit_to_m2"),       Qt::CaseInsensitive)==0)
         {
             areaunit = readElementText().toDouble();
         }
-        else if (name().compare(QString("m2_to_area_unit"),       Qt::CaseInsensitive)==0) // changed tag in v7.50
+        else if (name().compare(QLatin1String("m2_to_area_unit"),       Qt::CaseInsensitive)==0) // changed tag in v7.50
         {
             areaunit = readElementText().toDouble();
         }
-        else if (name().compare(QString("inertia_unit_to_kgm2"),  Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("inertia_unit_to_kgm2"),  Qt::CaseInsensitive)==0)
         {
             inertiaunit = readElementText().toDouble();
         }
-        else if (name().compare(QString("kgm2_to_inertia_unit"),  Qt::CaseInsensitive)==0) // changed tag in v7.50
+        else if (name().compare(QLatin1String("kgm2_to_inertia_unit"),  Qt::CaseInsensitive)==0) // changed tag in v7.50
         {
             inertiaunit = readElementText().toDouble();
         }
@@ -351,43 +375,43 @@ bool XflXmlReader::readWakeData(Polar3d &polar3d)
 {
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if (name().compare(QString("FlatPanelWake"),                    Qt::CaseInsensitive)==0)
+        if (name().compare(QLatin1String("FlatPanelWake"),                    Qt::CaseInsensitive)==0)
         {
             polar3d.setVortonWake(!xfl::stringToBool(readElementText()));
         }
-        else if (name().compare(QString("NX"),                          Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("NX"),                          Qt::CaseInsensitive)==0)
         {
             polar3d.setNXWakePanel4(readElementText().toInt());
         }
-        else if (name().compare(QString("ProgressionFactor"),           Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("ProgressionFactor"),           Qt::CaseInsensitive)==0)
         {
             polar3d.setWakePanelFactor(readElementText().toDouble());
         }
-        else if (name().compare(QString("LengthFactor"),                Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("LengthFactor"),                Qt::CaseInsensitive)==0)
         {
             polar3d.setTotalWakeLengthFactor(readElementText().toDouble());
         }
-        else if (name().compare(QString("VPW_BufferWakeLength"),        Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("VPW_BufferWakeLength"),        Qt::CaseInsensitive)==0)
         {
             polar3d.setBufferWakeFactor(readElementText().toDouble());
         }
-        else if (name().compare(QString("VPW_FirstStep"),               Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("VPW_FirstStep"),               Qt::CaseInsensitive)==0)
         {
             polar3d.setVortonL0(readElementText().toDouble());
         }
-/*        else if (name().compare(QString("VPW_GeomFactor"),              Qt::CaseInsensitive)==0)
+/*        else if (name().compare(QLatin1String("VPW_GeomFactor"),              Qt::CaseInsensitive)==0)
         {
             polar3d.setVortonXFactor(readElementText().toDouble());
         }*/
-        else if (name().compare(QString("VPW_MaxLength"),               Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("VPW_MaxLength"),               Qt::CaseInsensitive)==0)
         {
             polar3d.setVPWMaxLength(readElementText().toDouble());
         }
-        else if (name().compare(QString("Vorton_Core_Size"),            Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Vorton_Core_Size"),            Qt::CaseInsensitive)==0)
         {
             polar3d.setVortonCoreSize(readElementText().toDouble());
         }
-        else if (name().compare(QString("VPW_Iterations"),              Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("VPW_Iterations"),              Qt::CaseInsensitive)==0)
         {
             polar3d.setVPWIterations(readElementText().toInt());
         }
@@ -407,33 +431,33 @@ bool XflXmlReader::readFuseXfl(FuseXfl *pFuseXfl, double lengthUnit, double mass
 
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if (name().toString().compare(QString("name"),Qt::CaseInsensitive) ==0)
+        if (name().compare(QLatin1String("name"),Qt::CaseInsensitive) ==0)
         {
             pFuseXfl->setName(readElementText().trimmed().toStdString());
         }
-        else if (name().toString().compare(QString("color"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("color"), Qt::CaseInsensitive)==0)
         {
             fl5Color clr;
             readColor(clr);
             pFuseXfl->setColor(clr);
         }
-        else if (name().toString().compare(QString("description"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("description"), Qt::CaseInsensitive)==0)
         {
             pFuseXfl->setDescription(readElementText().trimmed().toStdString());
         }
-        else if (name().compare(QString("AutoInertia"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("AutoInertia"), Qt::CaseInsensitive)==0)
         {
             pFuseXfl->setAutoInertia(readElementText().trimmed().compare(QString("true"), Qt::CaseInsensitive)==0);
         }
-        else if (name().compare(QString("Inertia"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Inertia"), Qt::CaseInsensitive)==0)
         {
             while(!atEnd() && !hasError() && readNextStartElement() )
             {
-                if (name().compare(QString("volume_mass"), Qt::CaseInsensitive)==0)
+                if (name().compare(QLatin1String("volume_mass"), Qt::CaseInsensitive)==0)
                 {
                     pFuseXfl->setStructuralMass(readElementText().toDouble());
                 }
-                else if (name().compare(QString("point_mass"), Qt::CaseInsensitive)==0)
+                else if (name().compare(QLatin1String("point_mass"), Qt::CaseInsensitive)==0)
                 {
                     pFuseXfl->appendPointMass({});
                     readPointMass(pFuseXfl->inertia().lastPointMass(), massUnit, lengthUnit);
@@ -442,28 +466,21 @@ bool XflXmlReader::readFuseXfl(FuseXfl *pFuseXfl, double lengthUnit, double mass
                     skipCurrentElement();
             }
         }
-        else if (name().compare(QString("position"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("position"), Qt::CaseInsensitive)==0)
         {
-            QStringList coordList = readElementText().simplified().split(",");
-            if(coordList.length()>=3)
-            {
-                Vector3d position;
-                position.x = coordList.at(0).toDouble()*lengthUnit;
-                position.y = coordList.at(1).toDouble()*lengthUnit;
-                position.z = coordList.at(2).toDouble()*lengthUnit;
-                pFuseXfl->setPosition(position);
-            }
+            Vector3d position;
+            if(readVector(position, lengthUnit)) pFuseXfl->setPosition(position);
         }
-        else if (name().compare(QString("type"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("type"), Qt::CaseInsensitive)==0)
         {
             if(readElementText().trimmed().compare(QString("NURBS"), Qt::CaseInsensitive)==0) pFuseXfl->setFuseType(Fuse::NURBS);
             else                                                                              pFuseXfl->setFuseType(Fuse::FlatFace);
         }
-        else if (name().compare(QString("x_panels"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("x_panels"), Qt::CaseInsensitive)==0)
             pFuseXfl->setNxNurbsPanels(readElementText().toInt());
-        else if (name().compare(QString("hoop_panels"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("hoop_panels"), Qt::CaseInsensitive)==0)
             pFuseXfl->setNhNurbsPanels(readElementText().toInt());
-        else if (name().compare(QString("Panel_Stripes"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Panel_Stripes"), Qt::CaseInsensitive)==0)
         {
             while(!atEnd() && !hasError() && readNextStartElement() )
             {
@@ -473,7 +490,7 @@ bool XflXmlReader::readFuseXfl(FuseXfl *pFuseXfl, double lengthUnit, double mass
                 }
             }
         }
-        else if (name().compare(QString("NURBS"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("NURBS"), Qt::CaseInsensitive)==0)
         {
             std::vector<int> xPanels;
             readNurbs(pFuseXfl->nurbs(), xPanels, lengthUnit);
@@ -516,11 +533,11 @@ bool XflXmlReader::readWing(WingXfl *pWing, Vector3d &WingLE, double &Rx, double
 
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if (name().compare(QString("name"),                 Qt::CaseInsensitive)==0)
+        if (name().compare(QLatin1String("name"),                 Qt::CaseInsensitive)==0)
         {
             pWing->setName(readElementText().trimmed().toStdString());
         }
-        else if (name().compare(QString("type"),           Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("type"),           Qt::CaseInsensitive)==0)
         {
             pWing->setWingType(xml::wingType(readElementText()));
             /** @todo improve */
@@ -528,111 +545,105 @@ bool XflXmlReader::readWing(WingXfl *pWing, Vector3d &WingLE, double &Rx, double
             else if(pWing->wingType()==WingXfl::SECONDWING) pPlane->hasSecondWing() = true;
             else if(pWing->wingType()==xfl::Fin)        pPlane->hasFin() = true;*/
         }
-        else if (name().compare(QString("color"),           Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("color"),           Qt::CaseInsensitive)==0)
         {
             fl5Color clr;
             readColor(clr);
             pWing->setColor(clr);
         }
-        else if (name().compare(QString("description"),     Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("description"),     Qt::CaseInsensitive)==0)
         {
             pWing->setDescription(readElementText().trimmed().toStdString());
         }
-        else if (name().compare(QString("position"),        Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("position"),        Qt::CaseInsensitive)==0)
         {
-            QStringList coordList = readElementText().simplified().split(",");
-            if(coordList.length()>=3)
-            {
-                WingLE.x = coordList.at(0).toDouble()*lengthUnit;
-                WingLE.y = coordList.at(1).toDouble()*lengthUnit;
-                WingLE.z = coordList.at(2).toDouble()*lengthUnit;
-            }
+            readVector(WingLE, lengthUnit);
         }
-        else if (name().compare(QString("Tip_Strips"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Tip_Strips"), Qt::CaseInsensitive)==0)
         {
             pWing->setNTipStrips(readElementText().trimmed().toInt());
         }
-        else if (name().compare(QString("Rx_angle"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Rx_angle"), Qt::CaseInsensitive)==0)
         {
             Rx = readElementText().trimmed().toDouble();
         }
-        else if (name().compare(QString("Ry_angle"),Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Ry_angle"),Qt::CaseInsensitive)==0)
         {
             Ry = readElementText().trimmed().toDouble();
         }
-        else if (name().compare(QString("symmetric"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("symmetric"), Qt::CaseInsensitive)==0)
         {
             pWing->setsymmetric(readElementText().trimmed().compare(QString("true"), Qt::CaseInsensitive)==0);
         }
-        else if (name().compare(QString("Two_Sided"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Two_Sided"), Qt::CaseInsensitive)==0)
         {
             pWing->setTwoSided(readElementText().trimmed().compare(QString("true"), Qt::CaseInsensitive)==0);
         }
-        else if (name().compare(QString("Closed_Inner_Side"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Closed_Inner_Side"), Qt::CaseInsensitive)==0)
         {
             pWing->setClosedInnerSide(readElementText().trimmed().compare(QString("true"), Qt::CaseInsensitive)==0);
         }
-        else if (name().compare(QString("AutoInertia"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("AutoInertia"), Qt::CaseInsensitive)==0)
         {
             pWing->setAutoInertia(readElementText().trimmed().compare(QString("true"), Qt::CaseInsensitive)==0);
         }
-        else if (name().compare(QString("Inertia"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Inertia"), Qt::CaseInsensitive)==0)
         {
             readInertia(pWing->inertia(), lengthUnit, massUnit, inertiaUnit);
         }
-        else if (name().compare(QString("Sections"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Sections"), Qt::CaseInsensitive)==0)
         {
             while(!atEnd() && !hasError() && readNextStartElement() )
             {
-                if (name().compare(QString("Section"), Qt::CaseInsensitive)==0)
+                if (name().compare(QLatin1String("Section"), Qt::CaseInsensitive)==0)
                 {
                     pWing->appendWingSection({});
                     WingSection*pWingSec = &pWing->tipSection();
                     while(!atEnd() && !hasError() && readNextStartElement() )
                     {
-                        if (name().compare(QString("x_number_of_panels"), Qt::CaseInsensitive)==0)
+                        if (name().compare(QLatin1String("x_number_of_panels"), Qt::CaseInsensitive)==0)
                         {
                             pWingSec->m_NXPanels = readElementText().trimmed().toInt();
                         }
-                        else if (name().compare(QString("y_number_of_panels"), Qt::CaseInsensitive)==0)
+                        else if (name().compare(QLatin1String("y_number_of_panels"), Qt::CaseInsensitive)==0)
                         {
                             pWingSec->m_NYPanels = readElementText().trimmed().toInt();
                         }
-                        else if (name().compare(QString("x_panel_distribution"), Qt::CaseInsensitive)==0)
+                        else if (name().compare(QLatin1String("x_panel_distribution"), Qt::CaseInsensitive)==0)
                         {
                             QString strPanelDist = readElementText().trimmed();
                             pWingSec->m_XPanelDist = xfl::distributionType(strPanelDist.toStdString());
                         }
-                        else if (name().compare(QString("y_panel_distribution"), Qt::CaseInsensitive)==0)
+                        else if (name().compare(QLatin1String("y_panel_distribution"), Qt::CaseInsensitive)==0)
                         {
                             QString strPanelDist = readElementText().trimmed();
                             pWingSec->m_YPanelDist = xfl::distributionType(strPanelDist.toStdString());
                         }
-                        else if (name().compare(QString("Chord"), Qt::CaseInsensitive)==0)
+                        else if (name().compare(QLatin1String("Chord"), Qt::CaseInsensitive)==0)
                         {
                             pWingSec->m_Chord = readElementText().trimmed().toDouble()*lengthUnit;
                         }
-                        else if (name().compare(QString("y_position"), Qt::CaseInsensitive)==0)
+                        else if (name().compare(QLatin1String("y_position"), Qt::CaseInsensitive)==0)
                         {
                             pWingSec->m_YPosition = readElementText().toDouble()*lengthUnit;
                         }
-                        else if (name().compare(QString("xOffset"), Qt::CaseInsensitive)==0)
+                        else if (name().compare(QLatin1String("xOffset"), Qt::CaseInsensitive)==0)
                         {
                             pWingSec->m_Offset = readElementText().trimmed().toDouble()*lengthUnit;
                         }
-                        else if (name().compare(QString("Dihedral"), Qt::CaseInsensitive)==0)
+                        else if (name().compare(QLatin1String("Dihedral"), Qt::CaseInsensitive)==0)
                         {
                             pWingSec->m_Dihedral = readElementText().trimmed().toDouble();
                         }
-                        else if (name().compare(QString("Twist"), Qt::CaseInsensitive)==0)
+                        else if (name().compare(QLatin1String("Twist"), Qt::CaseInsensitive)==0)
                         {
                             pWingSec->m_Twist = readElementText().trimmed().toDouble();
                         }
-                        else if (name().compare(QString("Left_Side_FoilName"), Qt::CaseInsensitive)==0)
+                        else if (name().compare(QLatin1String("Left_Side_FoilName"), Qt::CaseInsensitive)==0)
                         {
                             pWingSec->m_LeftFoilName = readElementText().trimmed().toStdString();
                         }
-                        else if (name().compare(QString("Left_Side_Foil_File"), Qt::CaseInsensitive)==0)
+                        else if (name().compare(QLatin1String("Left_Side_Foil_File"), Qt::CaseInsensitive)==0)
                         {
                             QString filename = m_Path + QDir::separator() + readElementText().trimmed();
 
@@ -655,11 +666,11 @@ bool XflXmlReader::readWing(WingXfl *pWing, Vector3d &WingLE, double &Rx, double
 
                             }
                         }
-                        else if (name().compare(QString("Right_Side_FoilName"), Qt::CaseInsensitive)==0)
+                        else if (name().compare(QLatin1String("Right_Side_FoilName"), Qt::CaseInsensitive)==0)
                         {
                             pWingSec->m_RightFoilName = readElementText().trimmed().toStdString();
                         }
-                        else if (name().compare(QString("Right_Side_Foil_File"), Qt::CaseInsensitive)==0)
+                        else if (name().compare(QLatin1String("Right_Side_Foil_File"), Qt::CaseInsensitive)==0)
                         {
                             QString filename = m_Path + QDir::separator() + readElementText().trimmed();
 
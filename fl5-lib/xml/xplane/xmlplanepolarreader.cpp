@@ -72,11 +72,11 @@ bool XmlPlanePolarReader::readXMLPolarFile()
 
             while(!atEnd() && !hasError() && readNextStartElement() )
             {
-                if (name().toString().compare(QString("units"), Qt::CaseInsensitive)==0)
+                if (name().compare(QLatin1String("units"), Qt::CaseInsensitive)==0)
                 {
                     readUnits(lengthunit, massunit, velocityunit, areaunit, inertiaunit);
                 }
-                else if (name().toString().compare(QString("Polar"), Qt::CaseInsensitive)==0)
+                else if (name().compare(QLatin1String("Polar"), Qt::CaseInsensitive)==0)
                 {
                     m_pPlPolar = new PlanePolar;
                     readWPolar(m_pPlPolar, lengthunit, areaunit, massunit, velocityunit, inertiaunit);
@@ -111,119 +111,119 @@ void XmlPlanePolarReader::readWPolar(PlanePolar *pPlPolar, double lengthunit, do
 {
     while(!atEnd() && !hasError() && readNextStartElement())
     {
-        if (name().toString().compare(QString("polar_name"), Qt::CaseInsensitive) ==0)
+        if (name().compare(QLatin1String("polar_name"), Qt::CaseInsensitive) ==0)
         {
             pPlPolar->setName(readElementText().trimmed().toStdString());
         }
-        else if (name().toString().compare(QString("the_style"), Qt::CaseInsensitive) ==0)
+        else if (name().compare(QLatin1String("the_style"), Qt::CaseInsensitive) ==0)
         {
             LineStyle ls;
             readTheStyle(ls);
             pPlPolar->setTheStyle(ls);
         }
-        else if (name().toString().compare(QString("plane_name"), Qt::CaseInsensitive) ==0)
+        else if (name().compare(QLatin1String("plane_name"), Qt::CaseInsensitive) ==0)
         {
             pPlPolar->setPlaneName(readElementText().toStdString());
         }
-        else if (name().toString().compare(QString("type"), Qt::CaseInsensitive) ==0)
+        else if (name().compare(QLatin1String("type"), Qt::CaseInsensitive) ==0)
         {
             pPlPolar->setType(xml::polarType(readElementText()));
         }
-        else if (name().toString().compare(QString("method"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("method"), Qt::CaseInsensitive)==0)
         {
             pPlPolar->setAnalysisMethod(xml::analysisMethod(readElementText()));
         }
-        else if (name().compare(QString("Include_Fuse_Moments"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Include_Fuse_Moments"), Qt::CaseInsensitive)==0)
         {
             pPlPolar->setIncludeFuseMi(xfl::stringToBool(readElementText()));
         }
-        else if (name().compare(QString("Thin_Surfaces"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Thin_Surfaces"), Qt::CaseInsensitive)==0)
         {
             pPlPolar->setThinSurfaces(xfl::stringToBool(readElementText()));
         }
-        else if (name().compare(QString("Ground_Effect"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Ground_Effect"), Qt::CaseInsensitive)==0)
         {
             pPlPolar->setGroundEffect(xfl::stringToBool(readElementText()));
         }
-        else if (name().compare(QString("Free_Surface"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Free_Surface"), Qt::CaseInsensitive)==0)
         {
             pPlPolar->setFreeSurfaceEffect(xfl::stringToBool(readElementText()));
         }
-        else if (name().compare(QString("Ground_Height"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Ground_Height"), Qt::CaseInsensitive)==0)
         {
             pPlPolar->setGroundHeight(readElementText().toDouble()*lengthunit); /** @todo min and max */
         }
-        else if (name().compare(QString("Fluid"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Fluid"), Qt::CaseInsensitive)==0)
         {
             double nu(0), rho(0);
             readFluidData(nu, rho);
             pPlPolar->setViscosity(nu);
             pPlPolar->setDensity(rho);
         }
-        else if (name().compare(QString("Fixed_Velocity"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Fixed_Velocity"), Qt::CaseInsensitive)==0)
         {
             pPlPolar->setVelocity(readElementText().toDouble()*velocityunit);
         }
-        else if (name().compare(QString("Fixed_AOA"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Fixed_AOA"), Qt::CaseInsensitive)==0)
         {
             pPlPolar->setAlphaSpec(readElementText().toDouble());
         }
-        else if (name().compare(QString("Wake"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Wake"), Qt::CaseInsensitive)==0)
         {
             readWakeData(*pPlPolar);
         }
-        else if (name().compare(QString("Reference_Dimensions"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Reference_Dimensions"), Qt::CaseInsensitive)==0)
         {
             readReferenceDimensions(lengthunit, areaunit);
         }
-        else if (name().compare(QString("Viscous_Analysis"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Viscous_Analysis"), Qt::CaseInsensitive)==0)
         {
             readViscosity();
         }
-        else if (name().compare(QString("ExtraDrag"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("ExtraDrag"), Qt::CaseInsensitive)==0)
         {
             std::vector<ExtraDrag> extra;
             readExtraDrag(extra, areaunit);
             pPlPolar->setExtraDrag(extra);
         }
-        else if (name().compare(QString("Use_plane_inertia"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Use_plane_inertia"), Qt::CaseInsensitive)==0)
         {
             bool bInertia = xfl::stringToBool(readElementText());
             pPlPolar->setAutoInertia(bInertia);
         }
-        else if (name().compare(QString("Inertia"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Inertia"), Qt::CaseInsensitive)==0)
         {
             readWPolarInertia(pPlPolar, lengthunit, massunit, inertiaunit);
         }
-        else if (name().compare(QString("Inertia_gains"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Inertia_gains"), Qt::CaseInsensitive)==0)
         {
 //            readInertiaGains(lengthunit, massunit, inertiaunit); // deprecated in beta 18
         }
-        else if (name().compare(QString("Surface_angles"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Surface_angles"), Qt::CaseInsensitive)==0)
         {
 //            readAngleCoeffs(); // deprecated in v713
         }
-        else if (name().compare(QString("Flap_settings"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Flap_settings"), Qt::CaseInsensitive)==0)
         {
             readFlapSettings();
         }
-        else if (name().compare(QString("AVL_controls"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("AVL_controls"), Qt::CaseInsensitive)==0)
         {
             readAVLControls();
         }
-        else if (name().compare(QString("Operating_range"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Operating_range"), Qt::CaseInsensitive)==0)
         {
             readOperatingRange(velocityunit);
         }
-        else if (name().compare(QString("Inertia_range"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Inertia_range"), Qt::CaseInsensitive)==0)
         {
             readInertiaRange(lengthunit, massunit);
         }
-        else if (name().compare(QString("Angle_range"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Angle_range"), Qt::CaseInsensitive)==0)
         {
             readAngleRange();
         }
-        else if (name().compare(QString("Fuselage_Drag"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Fuselage_Drag"), Qt::CaseInsensitive)==0)
         {
             readFuselageDrag();
         }
@@ -237,23 +237,23 @@ void XmlPlanePolarReader::readReferenceDimensions(double lengthunit, double area
 {
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if (name().compare(QString("Reference_Dimensions"), Qt::CaseInsensitive)==0)
+        if (name().compare(QLatin1String("Reference_Dimensions"), Qt::CaseInsensitive)==0)
         {
             m_pPlPolar->setReferenceDim(xml::referenceDimension(readElementText()));
         }
-        else if (name().compare(QString("Reference_Area"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Reference_Area"), Qt::CaseInsensitive)==0)
         {
             m_pPlPolar->setReferenceArea(readElementText().toDouble()*areaunit);
         }
-        else if (name().compare(QString("Reference_Span_Length"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Reference_Span_Length"), Qt::CaseInsensitive)==0)
         {
             m_pPlPolar->setReferenceSpanLength(readElementText().toDouble()*lengthunit);
         }
-        else if (name().compare(QString("Reference_Chord_Length"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Reference_Chord_Length"), Qt::CaseInsensitive)==0)
         {
             m_pPlPolar->setReferenceChordLength(readElementText().toDouble()*lengthunit);
         }
-        else if (name().compare(QString("Include_Other_Wing_Area"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Include_Other_Wing_Area"), Qt::CaseInsensitive)==0)
         {
             m_pPlPolar->setIncludeOtherWingAreas(xfl::stringToBool(readElementText()));
         }
@@ -296,16 +296,16 @@ void XmlPlanePolarReader::readAVLControls()
     m_pPlPolar->clearAVLCtrls();
     while(!atEnd() && !hasError() && readNextStartElement())
     {
-        if(name().toString().compare("control", Qt::CaseInsensitive)==0)
+        if(name().compare(QLatin1String("control"), Qt::CaseInsensitive)==0)
         {
             AngleControl avlc;
             while(!atEnd() && !hasError() && readNextStartElement() )
             {
-                if(name().toString().compare("name", Qt::CaseInsensitive)==0)
+                if(name().compare(QLatin1String("name"), Qt::CaseInsensitive)==0)
                 {
                     avlc.setName(readElementText().toStdString());
                 }
-                else if(name().toString().compare("gains", Qt::CaseInsensitive)==0)
+                else if(name().compare(QLatin1String("gains"), Qt::CaseInsensitive)==0)
                 {
                     QString strange(readElementText().simplified());
                     QStringList fields = strange.split(" ");
@@ -333,7 +333,7 @@ void XmlPlanePolarReader::readInertiaRange(double lengthunit, double massunit)
         double cmin=0.0, cmax=0.0;
         std::string ctrlname;
 
-        if(name().toString().compare("Mass", Qt::CaseInsensitive)==0)
+        if(name().compare(QLatin1String("Mass"), Qt::CaseInsensitive)==0)
         {
             ctrlname = "Mass";
             QStringList ctrllist = readElementText().simplified().split(" ");
@@ -348,7 +348,7 @@ void XmlPlanePolarReader::readInertiaRange(double lengthunit, double massunit)
             }
             m_pPlPolar->m_InertiaRange[0] = CtrlRange(ctrlname, cmin, cmax);
         }
-        else if(name().toString().compare("CoG_x", Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("CoG_x"), Qt::CaseInsensitive)==0)
         {
             ctrlname = "CoG_x";
             QStringList ctrllist = readElementText().simplified().split(" ");
@@ -363,7 +363,7 @@ void XmlPlanePolarReader::readInertiaRange(double lengthunit, double massunit)
             }
             m_pPlPolar->m_InertiaRange[1] = CtrlRange(ctrlname, cmin, cmax);
         }
-        else if(name().toString().compare("CoG_z", Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("CoG_z"), Qt::CaseInsensitive)==0)
         {
             ctrlname = "CoG_z";
             QStringList ctrllist = readElementText().simplified().split(" ");
@@ -432,11 +432,11 @@ void XmlPlanePolarReader::readOperatingRange(double velocityunit)
         double cmin=0.0, cmax=0.0;
         std::string ctrlname;
 
-        if(name().toString().compare("Adjusted_velocity", Qt::CaseInsensitive)==0)
+        if(name().compare(QLatin1String("Adjusted_velocity"), Qt::CaseInsensitive)==0)
         {
             m_pPlPolar->setAdjustedVelocity(xfl::stringToBool(readElementText()));
         }
-        else if (name().toString().compare("Velocity", Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Velocity"), Qt::CaseInsensitive)==0)
         {
             ctrlname = "Velocity";
             QStringList ctrllist = readElementText().simplified().split(" ");
@@ -451,7 +451,7 @@ void XmlPlanePolarReader::readOperatingRange(double velocityunit)
             }
             m_pPlPolar->m_OperatingRange[0] = CtrlRange(ctrlname, cmin, cmax);
         }
-        else if(name().toString().compare("alpha", Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("alpha"), Qt::CaseInsensitive)==0)
         {
             ctrlname = "Alpha";
             QStringList ctrllist = readElementText().simplified().split(" ");
@@ -466,7 +466,7 @@ void XmlPlanePolarReader::readOperatingRange(double velocityunit)
             }
             m_pPlPolar->m_OperatingRange[1] = CtrlRange(ctrlname, cmin, cmax);
         }
-        else if(name().toString().compare("Beta", Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("Beta"), Qt::CaseInsensitive)==0)
         {
             ctrlname = "Beta";
             QStringList ctrllist = readElementText().simplified().split(" ");
@@ -481,7 +481,7 @@ void XmlPlanePolarReader::readOperatingRange(double velocityunit)
             }
             m_pPlPolar->m_OperatingRange[2] = CtrlRange(ctrlname, cmin, cmax);
         }
-        else if(name().toString().compare("Phi", Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("Phi"), Qt::CaseInsensitive)==0)
         {
             ctrlname = "Phi";
             QStringList ctrllist = readElementText().simplified().split(" ");
@@ -505,31 +505,31 @@ void XmlPlanePolarReader::readViscosity()
 {
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if (name().compare(QString("Is_Viscous_Analysis"), Qt::CaseInsensitive)==0)
+        if (name().compare(QLatin1String("Is_Viscous_Analysis"), Qt::CaseInsensitive)==0)
         {
             m_pPlPolar->setViscous(xfl::stringToBool(readElementText()));
         }
-        else if (name().compare(QString("From_CL"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("From_CL"), Qt::CaseInsensitive)==0)
         {
             m_pPlPolar->setViscFromCl(xfl::stringToBool(readElementText()));
         }
-        else if (name().compare(QString("XFoil_OnTheFly"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("XFoil_OnTheFly"), Qt::CaseInsensitive)==0)
         {
             m_pPlPolar->setViscOnTheFly(xfl::stringToBool(readElementText()));
         }
-        else if (name().compare(QString("NCrit"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("NCrit"), Qt::CaseInsensitive)==0)
         {
             m_pPlPolar->setNCrit(readElementText().toDouble());
         }
-        else if (name().compare(QString("XTrTop"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("XTrTop"), Qt::CaseInsensitive)==0)
         {
             m_pPlPolar->setXTrTop(readElementText().toDouble());
         }
-        else if (name().compare(QString("XTrBot"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("XTrBot"), Qt::CaseInsensitive)==0)
         {
             m_pPlPolar->setXTrBot(readElementText().toDouble());
         }       
-        else if (name().compare(QString("TransAtHinge"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("TransAtHinge"), Qt::CaseInsensitive)==0)
         {
             m_pPlPolar->setTransAtHinge(xfl::stringToBool(readElementText()));
         }
@@ -543,11 +543,11 @@ void XmlPlanePolarReader::readFuselageDrag()
 {
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if (name().compare(QString("Friction_Drag"), Qt::CaseInsensitive)==0)
+        if (name().compare(QLatin1String("Friction_Drag"), Qt::CaseInsensitive)==0)
         {
             m_pPlPolar->setIncludeFuseDrag(xfl::stringToBool(readElementText()));
         }
-        else if (name().compare(QString("Friction_Drag_Method"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Friction_Drag_Method"), Qt::CaseInsensitive)==0)
         {
             QString strange = readElementText();
             int index = strange.indexOf("Karman", Qt::CaseInsensitive);
@@ -575,11 +575,11 @@ bool XmlPlanePolarReader::readWPolarInertia(PlanePolar *pPlPolar, double lengthu
 {
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if (name().compare(QString("Mass"), Qt::CaseInsensitive)==0)
+        if (name().compare(QLatin1String("Mass"), Qt::CaseInsensitive)==0)
         {
             pPlPolar->setMass(readElementText().toDouble()*massunit);
         }
-        else if (name().compare(QString("CoG"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("CoG"), Qt::CaseInsensitive)==0)
         {
             QStringList coordList = readElementText().simplified().split(",");
             if(coordList.length()>=3)
@@ -589,19 +589,19 @@ bool XmlPlanePolarReader::readWPolarInertia(PlanePolar *pPlPolar, double lengthu
                 pPlPolar->setCoGz(coordList.at(2).toDouble()*lengthunit);
             }
         }
-        else if (name().compare(QString("CoG_Ixx"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("CoG_Ixx"), Qt::CaseInsensitive)==0)
         {
             pPlPolar->setIxx(readElementText().toDouble()*inertiaunit);
         }
-        else if (name().compare(QString("CoG_Iyy"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("CoG_Iyy"), Qt::CaseInsensitive)==0)
         {
             pPlPolar->setIyy(readElementText().toDouble()*inertiaunit);
         }
-        else if (name().compare(QString("CoG_Izz"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("CoG_Izz"), Qt::CaseInsensitive)==0)
         {
             pPlPolar->setIzz(readElementText().toDouble()*inertiaunit);
         }
-        else if (name().compare(QString("CoG_Ixz"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("CoG_Ixz"), Qt::CaseInsensitive)==0)
         {
             pPlPolar->setIxz(readElementText().toDouble()*inertiaunit);
         }
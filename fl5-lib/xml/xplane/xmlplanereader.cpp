@@ -51,11 +51,11 @@ bool XmlPlaneReader::readFile()
         {
             while(!atEnd() && !hasError() && readNextStartElement() )
             {
-                if (name().toString().compare(QString("units"), Qt::CaseInsensitive)==0)
+                if (name().compare(QLatin1String("units"), Qt::CaseInsensitive)==0)
                 {
                     readUnits(lengthunit, massunit, velocityunit, areaunit, inertiaunit);
                 }
-                else if (name().toString().compare(QString("plane"), Qt::CaseInsensitive)==0)
+                else if (name().compare(QLatin1String("plane"), Qt::CaseInsensitive)==0)
                 {
                     m_pPlane = new PlaneXfl();
                     readPlane(m_pPlane, lengthunit, massunit, inertiaunit);
@@ -80,25 +80,25 @@ bool XmlPlaneReader::readPlane(PlaneXfl *pPlane, double lengthUnit, double massU
 {
     while(!atEnd() && !hasError() && readNextStartElement())
     {
-        if (name().toString().compare(QString("Name"),Qt::CaseInsensitive) ==0)
+        if (name().compare(QLatin1String("Name"),Qt::CaseInsensitive) ==0)
         {
             pPlane->setName(readElementText().trimmed().toStdString());
         }
-        else if (name().toString().compare(QString("description"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("description"), Qt::CaseInsensitive)==0)
         {
             pPlane->setDescription(readElementText().toStdString());
         }
-        else if (name().toString().compare(QString("The_Style"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("The_Style"), Qt::CaseInsensitive)==0)
         {
             LineStyle ls;
             readTheStyle(ls);
             pPlane->setTheStyle(ls);
         }
-        else if (name().compare(QString("inertia"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("inertia"), Qt::CaseInsensitive)==0)
         {
             while(!atEnd() && !hasError() && readNextStartElement() )
             {
-                if (name().compare(QString("point_mass"), Qt::CaseInsensitive)==0)
+                if (name().compare(QLatin1String("point_mass"), Qt::CaseInsensitive)==0)
                 {
                     PointMass pm;
                     readPointMass(pm, massUnit, lengthUnit);
@@ -108,7 +108,7 @@ bool XmlPlaneReader::readPlane(PlaneXfl *pPlane, double lengthUnit, double massU
                     skipCurrentElement();
             }
         }
-        else if (name().toString().compare(QString("body"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("body"), Qt::CaseInsensitive)==0)
         {
             FuseXfl *pFuseXfl = new FuseNurbs;
             if(!readFuseXfl(pFuseXfl, lengthUnit, massUnit))
@@ -121,7 +121,7 @@ bool XmlPlaneReader::readPlane(PlaneXfl *pPlane, double lengthUnit, double massU
             pFuseXfl->makeDefaultTriMesh(logmsg, prefix);
             m_pPlane->addFuse(pFuseXfl);
         }
-        else if (name().toString().compare(QString("wing"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("wing"), Qt::CaseInsensitive)==0)
         {
             WingXfl newWing;
             m_pPlane->addWing();
@@ -45,15 +45,15 @@ bool XmlWingReader::readXMLWingFile()
 
     if (readNextStartElement())
     {
-        if (name().toString().compare("xflwing", Qt::CaseInsensitive)==0 && attributes().value("version").toString().compare("1.0", Qt::CaseInsensitive)==0)
+        if (name().compare(QLatin1String("xflwing"), Qt::CaseInsensitive)==0 && attributes().value("version").toString().compare("1.0", Qt::CaseInsensitive)==0)
         {
             while(!atEnd() && !hasError() && readNextStartElement() )
             {
-                if (name().toString().compare(QString("units"), Qt::CaseInsensitive)==0)
+                if (name().compare(QLatin1String("units"), Qt::CaseInsensitive)==0)
                 {
                     readUnits(lengthunit, massunit, velocityunit, areaunit, inertiaunit);
                 }
-                else if (name().toString().compare(QString("wing"), Qt::CaseInsensitive)==0)
+                else if (name().compare(QLatin1String("wing"), Qt::CaseInsensitive)==0)
                 {
                     m_pWing = new WingXfl;
                     Vector3d V;
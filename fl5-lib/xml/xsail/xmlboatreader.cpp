@@ -63,11 +63,11 @@ bool XmlBoatReader::readXMLBoatFile()
         {
             while(!atEnd() && !hasError() && readNextStartElement() )
             {
-                if (name().toString().compare(QString("units"), Qt::CaseInsensitive)==0)
+                if (name().compare(QLatin1String("units"), Qt::CaseInsensitive)==0)
                 {
                     readUnits(lengthunit, massunit, velocityunit, areaunit, inertiaunit);
                 }
-                else if (name().toString().compare(QString("Boat"), Qt::CaseInsensitive)==0)
+                else if (name().compare(QLatin1String("Boat"), Qt::CaseInsensitive)==0)
                 {
                     m_pBoat = new Boat;
                     readBoat(m_pBoat, lengthunit, areaunit, massunit);
@@ -100,21 +100,21 @@ bool XmlBoatReader::readBoat(Boat *pBoat, double lengthunit, double areaunit, do
     }
     while(!atEnd() && !hasError() && readNextStartElement())
     {
-        if (name().toString().compare(QString("Name"),Qt::CaseInsensitive) ==0)
+        if (name().compare(QLatin1String("Name"),Qt::CaseInsensitive) ==0)
         {
             pBoat->setName(readElementText().trimmed().toStdString());
         }
-        else if (name().toString().compare(QString("description"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("description"), Qt::CaseInsensitive)==0)
         {
             pBoat->setDescription(readElementText().toStdString());
         }
-        else if(name().toString().compare(QString("The_Style"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("The_Style"), Qt::CaseInsensitive)==0)
         {
             LineStyle ls;
             readTheStyle(ls);
             pBoat->setTheStyle(ls);
         }
-        else if (name().toString().compare(QString("body"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("body"), Qt::CaseInsensitive)==0)
         {
             FuseXfl *pFuseXfl = pBoat->appendNewXflHull();
             if(!readFuseXfl(pFuseXfl, lengthunit, massunit))
@@ -123,7 +123,7 @@ bool XmlBoatReader::readBoat(Boat *pBoat, double lengthunit, double areaunit, do
             }
             pFuseXfl->makeFuseGeometry();
         }
-        else if (name().toString().compare(QString("NURBSSail"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("NURBSSail"), Qt::CaseInsensitive)==0)
         {
             SailNurbs *pSail = new SailNurbs;
             Vector3d sailLE;
@@ -136,7 +136,7 @@ bool XmlBoatReader::readBoat(Boat *pBoat, double lengthunit, double areaunit, do
             }
             else return false;
         }
-        else if (name().toString().compare(QString("SplineSail"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("SplineSail"), Qt::CaseInsensitive)==0)
         {
             SailSpline *pSail = new SailSpline;
             Vector3d sailLE;
@@ -149,7 +149,7 @@ bool XmlBoatReader::readBoat(Boat *pBoat, double lengthunit, double areaunit, do
             }
             else return false;
         }
-        else if (name().toString().compare(QString("WingSail"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("WingSail"), Qt::CaseInsensitive)==0)
         {
             SailWing *pWSail = new SailWing;
             Vector3d sailLE;
@@ -51,7 +51,7 @@ bool XmlBtPolarReader::readXMLPolarFile()
 
     if(readNextStartElement())
     {
-        if (name().compare(QString("xflboatpolar"), Qt::CaseInsensitive)==0)
+        if (name().compare(QLatin1String("xflboatpolar"), Qt::CaseInsensitive)==0)
         {
             // get version
             QString strange = attributes().value("version").toString();
@@ -71,11 +71,11 @@ bool XmlBtPolarReader::readXMLPolarFile()
 
             while(!atEnd() && !hasError() && readNextStartElement())
             {
-                if (name().toString().compare(QString("units"), Qt::CaseInsensitive)==0)
+                if (name().compare(QLatin1String("units"), Qt::CaseInsensitive)==0)
                 {
                     readUnits(lengthunit, massunit, velocityunit, inertiaunit, areaunit);
                 }
-                else if (name().toString().compare(QString("Polar"), Qt::CaseInsensitive)==0)
+                else if (name().compare(QLatin1String("Polar"), Qt::CaseInsensitive)==0)
                 {
                     m_pBtPolar = new BoatPolar;
                     readBtPolar(m_pBtPolar, lengthunit, areaunit, velocityunit);
@@ -104,49 +104,49 @@ bool XmlBtPolarReader::readBtPolar(BoatPolar *pBtPolar, double lengthunit, doubl
 {
     while(!atEnd() && !hasError() && readNextStartElement())
     {
-        if (name().toString().compare(QString("polar_name"), Qt::CaseInsensitive) ==0)
+        if (name().compare(QLatin1String("polar_name"), Qt::CaseInsensitive) ==0)
         {
             pBtPolar->setName(readElementText().trimmed().toStdString());
         }
-        else if (name().toString().compare(QString("boat_name"), Qt::CaseInsensitive) ==0)
+        else if (name().compare(QLatin1String("boat_name"), Qt::CaseInsensitive) ==0)
         {
             pBtPolar->setBoatName(readElementText().toStdString());
         }
-        else if(name().toString().compare(QString("The_Style"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("The_Style"), Qt::CaseInsensitive)==0)
         {
             LineStyle ls;
             readTheStyle(ls);
             pBtPolar->setTheStyle(ls);
         }
-        else if (name().toString().compare(QString("method"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("method"), Qt::CaseInsensitive)==0)
         {
             pBtPolar->setAnalysisMethod(xml::analysisMethod(readElementText()));
         }
-        else if (name().compare(QString("Reference_Dimensions"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Reference_Dimensions"), Qt::CaseInsensitive)==0)
         {
             readReferenceDimensions(lengthunit, areaunit);
         }
-        else if (name().compare(QString("Ground_Effect"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Ground_Effect"), Qt::CaseInsensitive)==0)
         {
             pBtPolar->setGroundEffect(xfl::stringToBool(readElementText()));
         }
-        else if (name().compare(QString("Wake"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Wake"), Qt::CaseInsensitive)==0)
         {
             readWakeData(*pBtPolar);
         }
-        else if (name().compare(QString("Fluid"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Fluid"), Qt::CaseInsensitive)==0)
         {
             readFluidData(pBtPolar->m_Viscosity, pBtPolar->m_Density);
         }
-        else if (name().compare(QString("ExtraDrag"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("ExtraDrag"), Qt::CaseInsensitive)==0)
         {
             readExtraDrag(m_pBtPolar->m_ExtraDrag, areaunit);
         }
-        else if (name().compare(QString("Wind_gradient"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Wind_gradient"), Qt::CaseInsensitive)==0)
         {
             readWindSpline(m_pBtPolar->windSpline());
         }
-        else if (name().compare(QString("CoG"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("CoG"), Qt::CaseInsensitive)==0)
         {
             QStringList coordList = readElementText().simplified().split(",");
             if(coordList.length()>=3)
@@ -156,7 +156,7 @@ bool XmlBtPolarReader::readBtPolar(BoatPolar *pBtPolar, double lengthunit, doubl
                 pBtPolar->m_CoG.z = coordList.at(2).toDouble()*lengthunit;
             }
         }
-        else if(name().compare(QString("Boat_Speed"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("Boat_Speed"), Qt::CaseInsensitive)==0)
         {
             QStringList datalist = readElementText().simplified().split(",");
             if(datalist.size()==2)
@@ -165,7 +165,7 @@ bool XmlBtPolarReader::readBtPolar(BoatPolar *pBtPolar, double lengthunit, doubl
                 pBtPolar->setVBtMax(datalist.at(1).toDouble() * velocityunit);
             }
         }
-        else if(name().compare(QString("TWS"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("TWS"), Qt::CaseInsensitive)==0)
         {
             QStringList datalist = readElementText().simplified().split(",");
             if(datalist.size()==2)
@@ -174,7 +174,7 @@ bool XmlBtPolarReader::readBtPolar(BoatPolar *pBtPolar, double lengthunit, doubl
                 pBtPolar->setQInfMax(datalist.at(1).toDouble() * velocityunit);
             }
         }
-        else if(name().compare(QString("TWA"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("TWA"), Qt::CaseInsensitive)==0)
         {
             QStringList datalist = readElementText().simplified().split(",");
             if(datalist.size()==2)
@@ -183,7 +183,7 @@ bool XmlBtPolarReader::readBtPolar(BoatPolar *pBtPolar, double lengthunit, doubl
                 pBtPolar->setTwaMax(datalist.at(1).toDouble());
             }
         }
-        else if(name().compare(QString("Phi"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("Phi"), Qt::CaseInsensitive)==0)
         {
             QStringList datalist = readElementText().simplified().split(",");
             if(datalist.size()==2)
@@ -192,7 +192,7 @@ bool XmlBtPolarReader::readBtPolar(BoatPolar *pBtPolar, double lengthunit, doubl
                 pBtPolar->setPhiMax(datalist.at(1).toDouble());
             }
         }
-        else if(name().compare(QString("Ry"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("Ry"), Qt::CaseInsensitive)==0)
         {
             QStringList datalist = readElementText().simplified().split(",");
             if(datalist.size()==2)
@@ -201,7 +201,7 @@ bool XmlBtPolarReader::readBtPolar(BoatPolar *pBtPolar, double lengthunit, doubl
                 pBtPolar->setRyMax(datalist.at(1).toDouble());
             }
         }
-        else if(name().compare(QString("SailAngles"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("SailAngles"), Qt::CaseInsensitive)==0)
         {
             readSailAngles();
         }
@@ -218,8 +218,8 @@ bool XmlBtPolarReader::readWindSpline(BSpline &spline)
     spline.clearControlPoints();
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if      (name().compare(QString("degree"), Qt::CaseInsensitive)==0) spline.setDegree(readElementText().toInt());
-        else if (name().compare(QString("point"),  Qt::CaseInsensitive)==0)
+        if      (name().compare(QLatin1String("degree"), Qt::CaseInsensitive)==0) spline.setDegree(readElementText().toInt());
+        else if (name().compare(QLatin1String("point"),  Qt::CaseInsensitive)==0)
         {
             Vector2d ctrlPt;
             QStringList coordList = readElementText().simplified().split(",");
@@ -271,15 +271,15 @@ void XmlBtPolarReader::readReferenceDimensions(double lengthunit, double areauni
 {
     while(!atEnd() && !hasError() && readNextStartElement() )
     {
-        if (name().compare(QString("Reference_Dimensions"), Qt::CaseInsensitive)==0)
+        if (name().compare(QLatin1String("Reference_Dimensions"), Qt::CaseInsensitive)==0)
         {
             m_pBtPolar->setReferenceDim(xml::referenceDimension(readElementText()));
         }
-        else if (name().compare(QString("Reference_Area"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Reference_Area"), Qt::CaseInsensitive)==0)
         {
             m_pBtPolar->setReferenceArea(readElementText().toDouble()*areaunit);
         }
-        else if (name().compare(QString("Reference_Chord_Length"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Reference_Chord_Length"), Qt::CaseInsensitive)==0)
         {
             m_pBtPolar->setReferenceChordLength(readElementText().toDouble()*lengthunit);
         }
@@ -53,23 +53,23 @@ bool XmlSailReader::readXMLSailFile()
         {
             while(!atEnd() && !hasError() && readNextStartElement() )
             {
-                if (name().toString().compare(QString("units"), Qt::CaseInsensitive)==0)
+                if (name().compare(QLatin1String("units"), Qt::CaseInsensitive)==0)
                 {
                     readUnits(lengthunit, massunit, velocityunit, areaunit, inertiaunit);
                 }
-                else if (name().toString().compare(QString("SplineSail"), Qt::CaseInsensitive)==0)
+                else if (name().compare(QLatin1String("SplineSail"), Qt::CaseInsensitive)==0)
                 {
                     SailSpline*pSS = new SailSpline;
                     m_pSail = pSS;
                     readSplineSail(pSS, pos, lengthunit, areaunit);
                 }
-                else if (name().toString().compare(QString("NURBSSail"), Qt::CaseInsensitive)==0)
+                else if (name().compare(QLatin1String("NURBSSail"), Qt::CaseInsensitive)==0)
                 {
                     SailNurbs*pNS = new SailNurbs;
                     m_pSail = pNS;
                     readNURBSSail(pNS, pos, lengthunit, areaunit);
                 }
-                else if (name().toString().compare(QString("WingSail"), Qt::CaseInsensitive)==0)
+                else if (name().compare(QLatin1String("WingSail"), Qt::CaseInsensitive)==0)
                 {
                     SailWing*pWS = new SailWing;
                     m_pSail = pWS;
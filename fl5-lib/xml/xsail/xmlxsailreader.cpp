@@ -48,21 +48,21 @@ bool XmlXSailReader::readNURBSSail(SailNurbs *pNSail, Vector3d &position, double
     pNSail->nurbs().clearFrames();
     while(!atEnd() && !hasError() && readNextStartElement())
     {
-        if (name().toString().compare(QString("name"),Qt::CaseInsensitive) ==0)
+        if (name().compare(QLatin1String("name"),Qt::CaseInsensitive) ==0)
         {
             pNSail->setName(readElementText().trimmed().toStdString());
         }
-        else if(name().toString().compare(QString("The_Style"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("The_Style"), Qt::CaseInsensitive)==0)
         {
             LineStyle ls;
             readTheStyle(ls);
             pNSail->setTheStyle(ls);
         }
-        else if (name().toString().compare(QString("Description"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Description"), Qt::CaseInsensitive)==0)
         {
             pNSail->setDescription(readElementText().trimmed().toStdString());
         }
-        else if (name().compare(QString("Position"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Position"), Qt::CaseInsensitive)==0)
         {
             QStringList coordList = readElementText().simplified().split(",");
             if(coordList.length()>=3)
@@ -72,33 +72,33 @@ bool XmlXSailReader::readNURBSSail(SailNurbs *pNSail, Vector3d &position, double
                 position.z = coordList.at(2).toDouble()*lengthunit;
             }
         }
-        else if(name().compare(QString("Reference_area"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("Reference_area"), Qt::CaseInsensitive)==0)
         {
            pNSail->setRefArea(readElementText().toDouble()/areaunit);
         }
-        else if(name().compare(QString("Reference_chord"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("Reference_chord"), Qt::CaseInsensitive)==0)
         {
             pNSail->setRefChord(readElementText().toDouble()/lengthunit);
         }
-        else if (name().compare(QString("x_panels"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("x_panels"), Qt::CaseInsensitive)==0)
         {
             pNSail->setNXPanels(readElementText().toInt());
         }
-        else if (name().compare(QString("z_panels"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("z_panels"), Qt::CaseInsensitive)==0)
         {
             pNSail->setNZPanels(readElementText().toInt());
         }
-        else if (name().compare(QString("x_panel_distribution"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("x_panel_distribution"), Qt::CaseInsensitive)==0)
         {
             QString strPanelDist = readElementText().trimmed();
             pNSail->setXDistType(xfl::distributionType(strPanelDist.toStdString()));
         }
-        else if (name().compare(QString("z_panel_distribution"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("z_panel_distribution"), Qt::CaseInsensitive)==0)
         {
             QString strPanelDist = readElementText().trimmed();
             pNSail->setZDistType(xfl::distributionType(strPanelDist.toStdString()));
         }
-        else if (name().compare(QString("NURBS"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("NURBS"), Qt::CaseInsensitive)==0)
         {
             std::vector<int> xpanels;   // dummy arg
             readNurbs(pNSail->nurbs(), xpanels, lengthunit);
@@ -130,21 +130,21 @@ bool XmlXSailReader::readSplineSail(SailSpline *pSSail, Vector3d &position, doub
 
     while(!atEnd() && !hasError() && readNextStartElement())
     {
-        if (name().toString().compare(QString("name"),Qt::CaseInsensitive) ==0)
+        if (name().compare(QLatin1String("name"),Qt::CaseInsensitive) ==0)
         {
             pSSail->setName(readElementText().trimmed().toStdString());
         }
-        else if(name().toString().compare(QString("The_Style"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("The_Style"), Qt::CaseInsensitive)==0)
         {
             LineStyle ls;
             readTheStyle(ls);
             pSSail->setTheStyle(ls);
         }
-        else if (name().toString().compare(QString("Description"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Description"), Qt::CaseInsensitive)==0)
         {
             pSSail->setDescription(readElementText().trimmed().toStdString());
         }
-        else if (name().compare(QString("Position"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Position"), Qt::CaseInsensitive)==0)
         {
             QStringList coordList = readElementText().simplified().split(",");
             if(coordList.length()>=3)
@@ -155,15 +155,15 @@ bool XmlXSailReader::readSplineSail(SailSpline *pSSail, Vector3d &position, doub
             }
             pSSail->setPosition(position);
         }
-        else if(name().compare(QString("Reference_area"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("Reference_area"), Qt::CaseInsensitive)==0)
         {
            pSSail->setRefArea(readElementText().toDouble()/areaunit);
         }
-        else if(name().compare(QString("Reference_chord"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("Reference_chord"), Qt::CaseInsensitive)==0)
         {
             pSSail->setRefChord(readElementText().toDouble()/lengthunit);
         }
-        else if (name().compare(QString("Type"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Type"), Qt::CaseInsensitive)==0)
         {
             QString type = readElementText();
             if     (type.compare("BSPLINE", Qt::CaseInsensitive)==0)      pSSail->setSplineType(Spline::BSPLINE);
@@ -172,24 +172,24 @@ bool XmlXSailReader::readSplineSail(SailSpline *pSSail, Vector3d &position, doub
             else if(type.compare("POINTSPLINE", Qt::CaseInsensitive)==0)  pSSail->setSplineType(Spline::POINT);
             else pSSail->setSplineType(Spline::BSPLINE); // hope for the best
         }
-        else if (name().compare(QString("x_panels"), Qt::CaseInsensitive)==0) pSSail->setNXPanels(readElementText().toInt());
-        else if (name().compare(QString("x_panel_distribution"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("x_panels"), Qt::CaseInsensitive)==0) pSSail->setNXPanels(readElementText().toInt());
+        else if (name().compare(QLatin1String("x_panel_distribution"), Qt::CaseInsensitive)==0)
         {
             QString strPanelDist = readElementText().trimmed();
             pSSail->setXDistType(xfl::distributionType(strPanelDist.toStdString()));
         }
-        else if (name().compare(QString("z_panels"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("z_panels"), Qt::CaseInsensitive)==0)
         {
             nzpanels.push_back(readElementText().toInt());
         }
-        else if (name().compare(QString("z_panel_distribution"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("z_panel_distribution"), Qt::CaseInsensitive)==0)
         {
             QString strPanelDist = readElementText().trimmed();
             distribs.push_back(xfl::distributionType(strPanelDist.toStdString()));
         }
 
          //read splines
-        else if (name().compare(QString("Section"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Section"), Qt::CaseInsensitive)==0)
         {
             positions.push_back(Vector3d());
             ry.push_back(0.0);
@@ -199,7 +199,7 @@ bool XmlXSailReader::readSplineSail(SailSpline *pSSail, Vector3d &position, doub
 
             while(!atEnd() && !hasError() && readNextStartElement() )
             {
-                if (name().compare(QString("Position"), Qt::CaseInsensitive)==0)
+                if (name().compare(QLatin1String("Position"), Qt::CaseInsensitive)==0)
                 {
                     QStringList coordList = readElementText().simplified().split(",");
                     if(coordList.length()>=3)
@@ -211,15 +211,15 @@ bool XmlXSailReader::readSplineSail(SailSpline *pSSail, Vector3d &position, doub
 
                     }
                 }
-                else if (name().compare(QString("Ry"), Qt::CaseInsensitive)==0)
+                else if (name().compare(QLatin1String("Ry"), Qt::CaseInsensitive)==0)
                 {
                     ry.back() = readElementText().toDouble();
                 }
-                else if (name().compare(QString("Degree"), Qt::CaseInsensitive)==0)
+                else if (name().compare(QLatin1String("Degree"), Qt::CaseInsensitive)==0)
                 {
                     degree.back() = readElementText().toDouble();
                 }
-                else if (name().compare(QString("point"), Qt::CaseInsensitive)==0)
+                else if (name().compare(QLatin1String("point"), Qt::CaseInsensitive)==0)
                 {
                     double x=0,y=0,w=0;
                     QStringList coordList = readElementText().simplified().split(",");
@@ -288,21 +288,21 @@ bool XmlXSailReader::readWingSail(SailWing *pWSail, Vector3d &position, double l
     while(!atEnd() && !hasError() && readNextStartElement())
     {
 
-        if (name().toString().compare(QString("name"),Qt::CaseInsensitive) ==0)
+        if (name().compare(QLatin1String("name"),Qt::CaseInsensitive) ==0)
         {
             pWSail->setName(readElementText().trimmed().toStdString());
         }
-        else if(name().toString().compare(QString("The_Style"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("The_Style"), Qt::CaseInsensitive)==0)
         {
             LineStyle ls;
             readTheStyle(ls);
             pWSail->setTheStyle(ls);
         }
-        else if (name().toString().compare(QString("Description"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Description"), Qt::CaseInsensitive)==0)
         {
             pWSail->setDescription(readElementText().trimmed().toStdString());
         }
-        else if (name().compare(QString("Position"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Position"), Qt::CaseInsensitive)==0)
         {
             QStringList coordList = readElementText().simplified().split(",");
             if(coordList.length()>=3)
@@ -313,16 +313,16 @@ bool XmlXSailReader::readWingSail(SailWing *pWSail, Vector3d &position, double l
             }
             pWSail->setPosition(position);
         }
-        else if(name().compare(QString("Reference_area"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("Reference_area"), Qt::CaseInsensitive)==0)
         {
            pWSail->setRefArea(readElementText().toDouble()/areaunit);
         }
-        else if(name().compare(QString("Reference_chord"), Qt::CaseInsensitive)==0)
+        else if(name().compare(QLatin1String("Reference_chord"), Qt::CaseInsensitive)==0)
         {
             pWSail->setRefChord(readElementText().toDouble()/lengthunit);
         }
         //read sections
-        else if (name().compare(QString("Section"), Qt::CaseInsensitive)==0)
+        else if (name().compare(QLatin1String("Section"), Qt::CaseInsensitive)==0)
         {
             pWSail->appendNewSection();
             WingSailSection &sec = pWSail->gaffSection();
@@ -0,0 +1,427 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+/** @file
+ *
+ * The Python module "fl5" which exposes the foil and plane analyses of fl5-lib.
+ *
+ * The result arrays are NumPy views of the C++ buffers: no data is copied, and a view
+ * keeps its Python owner alive. The objects themselves belong to the fl5-lib database,
+ * so a view is only valid until its object is modified by a new analysis or deleted,
+ * e.g. by delete_objects().
+ *
+ * The analyses release the GIL while they run, so that several tasks may be run
+ * concurrently from Python threads.
+ */
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <api.h>
+#include <enums_objects.h>
+#include <foil.h>
+#include <objects2d.h>
+#include <objects3d.h>
+#include <oppoint.h>
+#include <planeopp.h>
+#include <planepolar.h>
+#include <planetask.h>
+#include <planexfl.h>
+#include <polar.h>
+#include <spandistribs.h>
+#include <threadpool.h>
+#include <wingopp.h>
+#include <wingxfl.h>
+#include <xfoiltask.h>
+
+namespace py = pybind11;
+
+
+namespace
+{
+    /** The objects stored in the fl5-lib database are deleted by the database, never by Python */
+    template<typename T>
+    using dbholder = std::unique_ptr<T, py::nodelete>;
+
+
+    /** Returns a 1d array which views the vector's buffer and keeps the owner alive */
+    template<typename T>
+    py::array_t<T> view(std::vector<T> &values, py::handle owner)
+    {
+        return py::array_t<T>({py::ssize_t(values.size())}, {py::ssize_t(sizeof(T))}, values.data(), owner);
+    }
+
+
+    /** Returns a (stations, ISX) array which views one of XFoil's boundary layer arrays; the second index is the side */
+    py::array_t<double> blView(BLArray &values, py::handle owner)
+    {
+        return py::array_t<double>({py::ssize_t(values.nStations()), py::ssize_t(ISX)},
+                                   {py::ssize_t(ISX*sizeof(double)), py::ssize_t(sizeof(double))},
+                                   values.data(), owner);
+    }
+
+
+    /** Binds a read-only property which returns a view of the vector member */
+    template<typename Class, typename C, typename T>
+    void defView(Class &cls, const char *name, std::vector<T> C::*member, const char *doc)
+    {
+        cls.def_property_readonly(name, [member](py::object self)
+        {
+            C &obj = self.cast<C&>();
+            return view(obj.*member, self);
+        }, doc);
+    }
+
+
+    template<typename Class, typename C>
+    void defBLView(Class &cls, const char *name, BLArray BLXFoil::*member, const char *doc)
+    {
+        cls.def_property_readonly(name, [member](py::object self)
+        {
+            C &obj = self.cast<C&>();
+            return blView(obj.m_BLXFoil.*member, self);
+        }, doc);
+    }
+
+
+    /** Builds a new array from a polar's aero forces; these coefficients are not stored as columns */
+    template<typename Func>
+    py::array_t<double> planePolarColumn(PlanePolar const &polar, Func coef)
+    {
+        py::array_t<double> column(py::ssize_t(polar.m_AF.size()));
+        auto data = column.mutable_unchecked<1>();
+        for(size_t i=0; i<polar.m_AF.size(); i++) data(py::ssize_t(i)) = coef(polar.m_AF.at(i));
+        return column;
+    }
+}
+
+
+PYBIND11_MODULE(fl5, m)
+{
+    m.doc() = "Python bindings to the foil and plane analyses of fl5-lib";
+
+    py::enum_<xfl::enumPolarType>(m, "PolarType")
+        .value("T1", xfl::T1POLAR)
+        .value("T2", xfl::T2POLAR)
+        .value("T3", xfl::T3POLAR)
+        .value("T4", xfl::T4POLAR)
+        .value("T5", xfl::T5POLAR)
+        .value("T6", xfl::T6POLAR)
+        .value("T7", xfl::T7POLAR)
+        .value("T8", xfl::T8POLAR);
+
+    py::enum_<xfl::enumAnalysisMethod>(m, "AnalysisMethod")
+        .value("LLT",        xfl::LLT)
+        .value("VLM1",       xfl::VLM1)
+        .value("VLM2",       xfl::VLM2)
+        .value("QUADS",      xfl::QUADS)
+        .value("TRILINEAR",  xfl::TRILINEAR)
+        .value("TRIUNIFORM", xfl::TRIUNIFORM);
+
+
+    //------------------ Objects ------------------
+    py::class_<XflObject, dbholder<XflObject>>(m, "XflObject")
+        .def_property("name", &XflObject::name, &XflObject::setName);
+
+
+    py::class_<Foil, XflObject, dbholder<Foil>>(m, "Foil")
+        .def("repanel", &Foil::rePanel, py::arg("npanels"), py::arg("amplitude"))
+        .def("set_te_flap", &Foil::setTEFlapData, py::arg("bflap"), py::arg("xhinge"), py::arg("yhinge"), py::arg("angle"))
+        .def("properties", &Foil::properties, py::arg("long")=false);
+
+
+    py::class_<Polar, XflObject, dbholder<Polar>> polar(m, "Polar");
+    polar.def_property_readonly("foil_name", &Polar::foilName)
+         .def("properties", &Polar::properties)
+         .def("export", [](Polar const &plr, bool bCSV)
+         {
+             std::string str;
+             plr.exportToString(str, false, bCSV);
+             return str;
+         }, py::arg("csv")=true);
+    defView(polar, "alpha",       &Polar::m_Alpha,      "the aoa values, in degrees");
+    defView(polar, "cl",          &Polar::m_Cl,         "the lift coefficients");
+    defView(polar, "cd",          &Polar::m_Cd,         "the drag coefficients");
+    defView(polar, "cdp",         &Polar::m_Cdp,        "the pressure drag coefficients");
+    defView(polar, "cm",          &Polar::m_Cm,         "the pitching moment coefficients");
+    defView(polar, "xtr_top",     &Polar::m_XTrTop,     "the transition points on the top surface");
+    defView(polar, "xtr_bot",     &Polar::m_XTrBot,     "the transition points on the bottom surface");
+    defView(polar, "hinge_moment",&Polar::m_HMom,       "the flap hinge moments");
+    defView(polar, "cpmn",        &Polar::m_Cpmn,       "the minimum pressure coefficients");
+    defView(polar, "cl_cd",       &Polar::m_ClCd,       "the glide ratios");
+    defView(polar, "xcp",         &Polar::m_XCp,        "the centre of pressure positions");
+    defView(polar, "re",          &Polar::m_Re,         "the Reynolds numbers");
+    defView(polar, "control",     &Polar::m_Control,    "the control values");
+
+
+    py::class_<OpPoint, XflObject, dbholder<OpPoint>> opp(m, "OpPoint");
+    opp.def_property_readonly("foil_name",  &OpPoint::foilName)
+       .def_property_readonly("polar_name", &OpPoint::polarName)
+       .def_readonly("alpha",    &OpPoint::m_Alpha)
+       .def_readonly("reynolds", &OpPoint::m_Reynolds)
+       .def_readonly("mach",     &OpPoint::m_Mach)
+       .def_readonly("cl",       &OpPoint::m_Cl)
+       .def_readonly("cd",       &OpPoint::m_Cd)
+       .def_readonly("cm",       &OpPoint::m_Cm)
+       .def_readonly("xtr_top",  &OpPoint::m_XTrTop)
+       .def_readonly("xtr_bot",  &OpPoint::m_XTrBot)
+       .def_readonly("viscous",  &OpPoint::m_bViscResults)
+       .def_property_readonly("bl_points", [](OpPoint const &o)
+       {
+           return py::make_tuple(o.m_BLXFoil.nside1, o.m_BLXFoil.nside2);
+       }, "the number of BL points on the top and bottom sides, wake included");
+    defView(opp, "cp_viscous",   &OpPoint::m_Cpv, "the viscous pressure coefficients at the foil's nodes");
+    defView(opp, "cp_inviscid",  &OpPoint::m_Cpi, "the inviscid pressure coefficients at the foil's nodes");
+    defView(opp, "qv",           &OpPoint::m_Qv,  "the viscous surface speeds at the foil's nodes");
+    defView(opp, "qi",           &OpPoint::m_Qi,  "the inviscid surface speeds at the foil's nodes");
+    defBLView<decltype(opp), OpPoint>(opp, "xbl",    &BLXFoil::xbl,    "the x-coordinates of the BL stations, indexed [station, side]");
+    defBLView<decltype(opp), OpPoint>(opp, "uedg",   &BLXFoil::uedg,   "the BL edge velocities, indexed [station, side]");
+    defBLView<decltype(opp), OpPoint>(opp, "dstr",   &BLXFoil::dstr,   "the displacement thicknesses, indexed [station, side]");
+    defBLView<decltype(opp), OpPoint>(opp, "thet",   &BLXFoil::thet,   "the momentum thicknesses, indexed [station, side]");
+    defBLView<decltype(opp), OpPoint>(opp, "tau",    &BLXFoil::tau,    "the wall shear stresses, indexed [station, side]");
+    defBLView<decltype(opp), OpPoint>(opp, "ctau",   &BLXFoil::ctau,   "the max shear coefficients, indexed [station, side]");
+    defBLView<decltype(opp), OpPoint>(opp, "hk",     &BLXFoil::Hk,     "the kinematic shape parameters, indexed [station, side]");
+    defBLView<decltype(opp), OpPoint>(opp, "rtheta", &BLXFoil::RTheta, "the momentum thickness Reynolds numbers, indexed [station, side]");
+
+
+    py::class_<WingSection, dbholder<WingSection>>(m, "WingSection")
+        .def_property("chord",      &WingSection::chord,     &WingSection::setChord)
+        .def_property("y_position", &WingSection::yPosition, &WingSection::setYPosition)
+        .def_property("offset",     &WingSection::offset,    &WingSection::setXOffset)
+        .def_property("dihedral",   &WingSection::dihedral,  &WingSection::setDihedral)
+        .def_property("twist",      &WingSection::twist,     &WingSection::setTwist)
+        .def_property("nx",         &WingSection::nXPanels,  &WingSection::setNX)
+        .def_property("ny",         &WingSection::nYPanels,  &WingSection::setNY)
+        .def_property("left_foil",  &WingSection::leftFoilName,  &WingSection::setLeftFoilName)
+        .def_property("right_foil", &WingSection::rightFoilName, &WingSection::setRightFoilName);
+
+
+    py::class_<WingXfl, dbholder<WingXfl>>(m, "Wing")
+        .def_property_readonly("n_sections", &WingXfl::nSections)
+        .def("section", [](WingXfl &w, int isec) -> WingSection&
+        {
+            if(isec<0 || isec>=w.nSections()) throw py::index_error();
+            return w.section(isec);
+        }, py::return_value_policy::reference_internal)
+        .def("insert_section", &WingXfl::insertSection)
+        .def_property_readonly("mac",  &WingXfl::MAC)
+        .def_property_readonly("span", &WingXfl::planformSpan);
+
+
+    py::class_<PlaneXfl, XflObject, dbholder<PlaneXfl>>(m, "Plane")
+        .def_property_readonly("n_wings", &PlaneXfl::nWings)
+        .def("wing", [](PlaneXfl &p, int iw)
+        {
+            if(iw<0 || iw>=p.nWings()) throw py::index_error();
+            return p.wing(iw);
+        }, py::return_value_policy::reference_internal)
+        .def("make_plane", &PlaneXfl::makePlane, py::arg("thick_surfaces")=false, py::arg("ignore_fuse_panels")=false, py::arg("make_trimesh")=true,
+             "rebuilds the surfaces and the mesh; must be called after the geometry has been modified")
+        .def_property_readonly("mac",            &PlaneXfl::mac)
+        .def_property_readonly("span",           &PlaneXfl::span)
+        .def_property_readonly("projected_span", &PlaneXfl::projectedSpan)
+        .def("projected_area", &PlaneXfl::projectedArea, py::arg("other_wings")=false)
+        .def("planform_area",  &PlaneXfl::planformArea,  py::arg("other_wings")=false);
+
+
+    py::class_<PlanePolar, XflObject, dbholder<PlanePolar>> plpolar(m, "PlanePolar");
+    plpolar.def_property_readonly("plane_name", &PlanePolar::planeName)
+           .def_property_readonly("size", &PlanePolar::dataSize)
+           .def("set_type",            &PlanePolar::setType)
+           .def("set_analysis_method", &PlanePolar::setAnalysisMethod)
+           .def("set_velocity",        &PlanePolar::setVelocity)
+           .def("set_alpha",           &PlanePolar::setAlphaSpec)
+           .def("set_beta",            &PlanePolar::setBeta)
+           .def("set_mass",            &PlanePolar::setMass)
+           .def("set_cog", [](PlanePolar &p, double x, double z) {p.setCoGx(x); p.setCoGz(z);}, py::arg("x"), py::arg("z"))
+           .def("set_viscous",         &PlanePolar::setViscous)
+           .def("set_visc_on_the_fly", &PlanePolar::setViscOnTheFly)
+           .def("set_thin_surfaces",   &PlanePolar::setThinSurfaces)
+           .def("set_density",         &PlanePolar::setDensity)
+           .def("set_viscosity",       &PlanePolar::setViscosity)
+           .def("export", &PlanePolar::exportToString, py::arg("separator")=", ")
+           .def_property_readonly("cl", [](PlanePolar const &p) {return planePolarColumn(p, [](AeroForces const &af){return af.CL();});},
+                                  "the lift coefficients; a new array, since they are computed from the stored forces")
+           .def_property_readonly("cd", [](PlanePolar const &p) {return planePolarColumn(p, [](AeroForces const &af){return af.CD();});},
+                                  "the drag coefficients; a new array, since they are computed from the stored forces")
+           .def_property_readonly("cm", [](PlanePolar const &p) {return planePolarColumn(p, [](AeroForces const &af){return af.Cm();});},
+                                  "the pitching moment coefficients; a new array, since they are computed from the stored forces");
+    defView(plpolar, "alpha",       &PlanePolar::m_Alpha,      "the angles of attack, in degrees");
+    defView(plpolar, "beta",        &PlanePolar::m_Beta,       "the sideslip angles, in degrees");
+    defView(plpolar, "phi",         &PlanePolar::m_Phi,        "the bank angles, in degrees");
+    defView(plpolar, "ctrl",        &PlanePolar::m_Ctrl,       "the control values");
+    defView(plpolar, "qinf",        &PlanePolar::m_QInfinite,  "the free stream speeds, in m/s");
+    defView(plpolar, "xnp",         &PlanePolar::m_XNP,        "the neutral point positions");
+    defView(plpolar, "max_bending", &PlanePolar::m_MaxBending, "the bending moments at the root chord");
+
+
+    py::class_<SpanDistribs, dbholder<SpanDistribs>> span(m, "SpanDistribs");
+    span.def_property_readonly("size", &SpanDistribs::nStations);
+    defView(span, "position",       &SpanDistribs::m_StripPos,      "the span positions of the stations");
+    defView(span, "chord",          &SpanDistribs::m_Chord,         "the chords of the strips");
+    defView(span, "area",           &SpanDistribs::m_StripArea,     "the areas of the strips");
+    defView(span, "cl",             &SpanDistribs::m_Cl,            "the lift coefficients of the strips");
+    defView(span, "icd",            &SpanDistribs::m_ICd,           "the induced drag coefficients of the strips");
+    defView(span, "pcd",            &SpanDistribs::m_PCd,           "the viscous drag coefficients of the strips");
+    defView(span, "ai",             &SpanDistribs::m_Ai,            "the induced angles, in degrees");
+    defView(span, "re",             &SpanDistribs::m_Re,            "the Reynolds numbers of the strips");
+    defView(span, "gamma",          &SpanDistribs::m_Gamma,         "the circulations on the strips");
+    defView(span, "xtr_top",        &SpanDistribs::m_XTrTop,        "the upper transition locations");
+    defView(span, "xtr_bot",        &SpanDistribs::m_XTrBot,        "the lower transition locations");
+    defView(span, "bending_moment", &SpanDistribs::m_BendingMoment, "the bending moments");
+
+
+    py::class_<PlaneOpp, XflObject, dbholder<PlaneOpp>> popp(m, "PlaneOpp");
+    popp.def_property_readonly("alpha", &PlaneOpp::alpha)
+        .def_property_readonly("beta",  &PlaneOpp::beta)
+        .def_property_readonly("ctrl",  &PlaneOpp::ctrl)
+        .def_property_readonly("qinf",  &PlaneOpp::QInf)
+        .def_property_readonly("cl", [](PlaneOpp const &p) {return p.aeroForces().CL();})
+        .def_property_readonly("cd", [](PlaneOpp const &p) {return p.aeroForces().CD();})
+        .def_property_readonly("cm", [](PlaneOpp const &p) {return p.aeroForces().Cm();})
+        .def_property_readonly("cp",    [](py::object self) {return view(self.cast<PlaneOpp&>().Cp(),    self);}, "the pressure coefficients on the panels")
+        .def_property_readonly("gamma", [](py::object self) {return view(self.cast<PlaneOpp&>().gamma(), self);}, "the vortex or doublet strengths")
+        .def_property_readonly("sigma", [](py::object self) {return view(self.cast<PlaneOpp&>().sigma(), self);}, "the source strengths")
+        .def_property_readonly("n_wings", &PlaneOpp::nWOpps)
+        .def("span_distribs", [](PlaneOpp &p, int iw) -> SpanDistribs&
+        {
+            if(iw<0 || iw>=p.nWOpps()) throw py::index_error();
+            return const_cast<SpanDistribs&>(p.WOpp(iw).spanResults());
+        }, py::return_value_policy::reference_internal, py::arg("iwing"));
+
+
+    //------------------ Tasks ------------------
+    py::class_<XFoilTask>(m, "XFoilTask")
+        .def(py::init<>())
+        .def("initialize", [](XFoilTask &task, Foil &foil, Polar *pPolar)
+        {
+            return task.initialize(foil, pPolar, true);
+        }, py::arg("foil"), py::arg("polar"))
+        .def("append_range", [](XFoilTask &task, double vmin, double vmax, double vinc)
+        {
+            task.appendRange(true, vmin, vmax, vinc);
+        }, py::arg("min"), py::arg("max"), py::arg("inc"),
+           "appends a range of aoa, Cl or Re values depending on the polar type; the ranges are run in order")
+        .def("clear_ranges", &XFoilTask::clearRanges)
+        .def("run", [](XFoilTask &task)
+        {
+            {
+                py::gil_scoped_release release;
+                task.run();
+            }
+            // the operating points are handed over to the database, which is only
+            // modified with the GIL held
+            py::list opps;
+            for(OpPoint *pOpp : task.operatingPoints())
+            {
+                OpPoint *pStored = Objects2d::insertOpPoint(pOpp);
+                if(pStored) opps.append(py::cast(pStored, py::return_value_policy::reference));
+            }
+            task.clearOpps();
+            return opps;
+        }, "runs the analysis without the GIL and returns the operating points; the results are also appended to the polar")
+        .def_property_readonly("has_errors", &XFoilTask::hasErrors)
+        .def_property_readonly("log", &XFoilTask::log);
+
+
+    py::class_<PlaneTask>(m, "PlaneTask")
+        .def(py::init<>())
+        .def("set_objects", [](PlaneTask &task, PlaneXfl *pPlane, PlanePolar *pPolar)
+        {
+            task.setKeepOpps(true);
+            task.setObjects(pPlane, pPolar);
+        }, py::arg("plane"), py::arg("polar"))
+        .def("set_opp_list", &PlaneTask::setOppList, py::arg("values"),
+             "the aoa, speed or control values to calculate, depending on the polar type")
+        .def("set_thread_count", &PlaneTask::setThreadCount, py::arg("nthreads"),
+             "the number of threads used by this task, or 0 to use all")
+        .def("set_compute_derivatives", &PlaneTask::setComputeDerivatives)
+        .def("run", [](PlaneTask &task)
+        {
+            {
+                py::gil_scoped_release release;
+                task.run();
+            }
+            py::list opps;
+            for(PlaneOpp *pPOpp : task.planeOppList())
+                opps.append(py::cast(pPOpp, py::return_value_policy::reference));
+            return opps;
+        }, "runs the analysis without the GIL and returns the operating points; the results are also appended to the polar")
+        .def_property_readonly("has_errors", &PlaneTask::hasErrors);
+
+
+    //------------------ Database ------------------
+    m.def("make_naca_foil", &foil::makeNacaFoil, py::arg("digits"), py::arg("name"),
+          py::return_value_policy::reference, "makes a NACA 4 or 5 digit foil and stores it");
+    m.def("load_foil", &foil::loadFoil, py::arg("pathname"),
+          py::return_value_policy::reference, "loads a foil from a .dat file and stores it");
+    m.def("foil", &foil::foil, py::arg("name"), py::return_value_policy::reference);
+
+    m.def("create_polar", [](Foil const *pFoil, std::string const &name, xfl::enumPolarType type,
+                             double spec, double mach, double ncrit, double xtrtop, double xtrbot)
+    {
+        Polar *pPolar = Objects2d::createPolar(pFoil, type, spec, mach, ncrit, xtrtop, xtrbot);
+        if(!pPolar) return pPolar;
+        pPolar->setName(name);
+        Objects2d::insertPolar(pPolar);
+        return pPolar;
+    }, py::arg("foil"), py::arg("name"), py::arg("type")=xfl::T1POLAR, py::arg("re")=1.0e5, py::arg("mach")=0.0,
+       py::arg("ncrit")=9.0, py::arg("xtr_top")=1.0, py::arg("xtr_bot")=1.0,
+       py::return_value_policy::reference, "creates a foil polar and stores it");
+
+    m.def("make_default_plane", [](std::string const &name)
+    {
+        PlaneXfl *pPlane = new PlaneXfl;
+        pPlane->setName(name);
+        Objects3d::insertPlane(pPlane);
+        pPlane->makeDefaultPlane();
+        pPlane->makePlane(false, false, true);
+        return pPlane;
+    }, py::arg("name"), py::return_value_policy::reference,
+       "makes the default plane of the plane editor and stores it; edit the wings then call make_plane()");
+
+    m.def("create_plane_polar", [](PlaneXfl *pPlane, std::string const &name, xfl::enumPolarType type, xfl::enumAnalysisMethod method)
+    {
+        PlanePolar *pPolar = new PlanePolar;
+        pPolar->setName(name);
+        pPolar->setPlaneName(pPlane->name());
+        pPolar->setType(type);
+        pPolar->setAnalysisMethod(method);
+        pPolar->setReferenceDim(xfl::PROJECTED);
+        pPolar->setReferenceArea(pPlane->projectedArea());
+        pPolar->setReferenceSpanLength(pPlane->projectedSpan());
+        pPolar->setReferenceChordLength(pPlane->mac());
+        Objects3d::insertPlPolar(pPolar);
+        return pPolar;
+    }, py::arg("plane"), py::arg("name"), py::arg("type")=xfl::T1POLAR, py::arg("method")=xfl::TRIUNIFORM,
+       py::return_value_policy::reference, "creates a plane polar with the plane's projected reference dimensions and stores it");
+
+    m.def("save_project", &globals::saveFl5Project, py::arg("pathname"));
+    m.def("delete_objects", &globals::deleteObjects,
+          "deletes all the objects; the Python references and the array views become invalid");
+    m.def("set_max_threads", &ThreadPool::setMaxThreadCount, py::arg("nthreads"),
+          "sets the number of threads of the process-wide pool; must not be called while an analysis is running");
+}
@@ -6,4 +6,6 @@ SUBDIRS = \
     XFoil-lib \
     fl5-lib \
     fl5-app \
+    fl5-cli \
+    fl5-bench \
 